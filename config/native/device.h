@@ -0,0 +1,177 @@
+#ifndef DEVICE_H
+#define DEVICE_H
+
+/**
+ * @file device.h
+ * @brief Host stand-in for the vendor device header (POSIX simulation).
+ *
+ * Provides the CMSIS subset that chip-independent sources use, backed by
+ * the POSIX port (src/port/posix/):
+ *
+ *   DWT->CYCCNT          CLOCK_MONOTONIC in ns (SystemCoreClock is 1 GHz)
+ *   __LDREXW/__STREXW    exclusive monitor, cleared by every emulated interrupt;
+ *                        with two simulated cores __STREXW lets the other run
+ *   __get_IPSR()         exception number of the running emulated interrupt
+ *   NVIC_*               software interrupt lines SWI0..SWI3, and TIM5 for the
+ *                        high-resolution timer's compare (RTOS_USE_HRTIMER)
+ *   __WFI()              sleep until the next signal
+ */
+
+#include <stdint.h>
+#include <time.h>
+
+/* ======================== Interrupt Lines ================================ */
+
+/** Emulated lines; an application defines SWIn_IRQHandler() to use one. */
+typedef enum
+{
+    PendSV_IRQn  = -2,
+    SysTick_IRQn = -1,
+    SWI0_IRQn    = 0,
+    SWI1_IRQn    = 1,
+    SWI2_IRQn    = 2,
+    SWI3_IRQn    = 3,
+    TIM5_IRQn    = 4 /**< Raised by the host timer behind hardware_env_hrtimer_*() */
+} IRQn_Type;
+
+#define PORT_POSIX_NUM_IRQS 5U
+
+void port_posix_set_pending_irq(IRQn_Type irq);
+void port_posix_enable_irq(IRQn_Type irq, uint32_t enable);
+void port_posix_wait_for_interrupt(void);
+void port_posix_exclusive_window(void);
+
+static inline void NVIC_SetPendingIRQ(IRQn_Type irq)
+{
+    port_posix_set_pending_irq(irq);
+}
+
+static inline void NVIC_EnableIRQ(IRQn_Type irq)
+{
+    port_posix_enable_irq(irq, 1U);
+}
+
+static inline void NVIC_DisableIRQ(IRQn_Type irq)
+{
+    port_posix_enable_irq(irq, 0U);
+}
+
+/* One interrupt level: every line runs at kernel priority */
+static inline void NVIC_SetPriority(IRQn_Type irq, uint32_t priority)
+{
+    (void) irq;
+    (void) priority;
+}
+
+/* ======================== Core Registers ================================= */
+
+extern uint32_t          SystemCoreClock;
+extern volatile uint32_t g_port_active_irq; /**< IPSR: 0 in a task */
+extern volatile uint32_t g_port_primask;    /**< __disable_irq() state */
+
+static inline uint32_t __get_IPSR(void)
+{
+    return g_port_active_irq;
+}
+
+static inline void __disable_irq(void)
+{
+    g_port_primask = 1U;
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+}
+
+static inline void __enable_irq(void)
+{
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+    g_port_primask = 0U;
+}
+
+/* Single host thread: a compiler barrier orders accesses against the signal handler */
+#define __DMB() __atomic_signal_fence(__ATOMIC_SEQ_CST)
+#define __DSB() __atomic_signal_fence(__ATOMIC_SEQ_CST)
+#define __ISB() __atomic_signal_fence(__ATOMIC_SEQ_CST)
+#define __NOP() __asm volatile("nop")
+#define __WFI() port_posix_wait_for_interrupt()
+
+#define __BKPT(value) __builtin_trap()
+
+static inline uint32_t __CLZ(uint32_t value)
+{
+    return (value == 0U) ? 32U : (uint32_t) __builtin_clz(value);
+}
+
+/* ======================== Exclusive Monitor ============================== */
+
+extern volatile uintptr_t g_port_exclusive_addr; /**< Monitored word, 0 = open */
+extern uint32_t           g_port_exclusive_value;
+
+/* The monitor opens before the load: an interrupt anywhere after this
+ * closes it, so a value another task's __LDREXW left in
+ * g_port_exclusive_value is never compared against */
+static inline uint32_t __LDREXW(volatile uint32_t *addr)
+{
+    g_port_exclusive_addr = (uintptr_t) addr;
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+
+    uint32_t value         = *addr;
+    g_port_exclusive_value = value;
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+
+    return value;
+}
+
+/* Fails if an interrupt ran since the __LDREXW; the compare-and-swap also
+ * catches an interrupt that writes the word between the check and the store */
+static inline uint32_t __STREXW(uint32_t value, volatile uint32_t *addr)
+{
+    port_posix_exclusive_window();
+
+    uint32_t expected = g_port_exclusive_value;
+
+    if (g_port_exclusive_addr != (uintptr_t) addr)
+    {
+        return 1U;
+    }
+    g_port_exclusive_addr = 0U;
+
+    return __atomic_compare_exchange_n(addr, &expected, value, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST) ? 0U : 1U;
+}
+
+static inline void __CLREX(void)
+{
+    g_port_exclusive_addr = 0U;
+}
+
+/* ======================== Cycle Counter ================================== */
+
+typedef struct
+{
+    volatile uint32_t CTRL;
+    volatile uint32_t CYCCNT; /**< Refreshed on every DWT access; writes are ignored */
+} DWT_Type;
+
+typedef struct
+{
+    volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+#define DWT_CTRL_CYCCNTENA_Msk     (1UL << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk (1UL << 24)
+
+extern DWT_Type       g_port_dwt;
+extern CoreDebug_Type g_port_core_debug;
+
+static inline DWT_Type *port_posix_dwt(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    g_port_dwt.CYCCNT = (uint32_t) ((uint64_t) now.tv_sec * 1000000000ULL + (uint64_t) now.tv_nsec);
+
+    return &g_port_dwt;
+}
+
+#define DWT       (port_posix_dwt())
+#define CoreDebug (&g_port_core_debug)
+
+#endif /* DEVICE_H */
@@ -0,0 +1,32 @@
+#ifndef RTOS_CONFIG_NATIVE_H
+#define RTOS_CONFIG_NATIVE_H
+
+/* Values defined here take precedence over the defaults in config.h. */
+
+#include "clock_config.h" // IWYU pragma: keep
+
+/* The emulated DWT->CYCCNT counts nanoseconds */
+#define RTOS_SYSTEM_CLOCK_HZ (1000000000U)
+
+/* Task and heap limits of the Nucleo-F446RE, so tests see the target's budgets */
+#ifndef RTOS_MAX_TASKS
+#define RTOS_MAX_TASKS (10U)
+#endif
+#define RTOS_DEFAULT_TASK_STACK_SIZE (768U)
+#define RTOS_MINIMUM_TASK_STACK_SIZE (256U)
+
+#ifndef RTOS_TOTAL_HEAP_SIZE
+#define RTOS_TOTAL_HEAP_SIZE (8192U)
+#endif
+
+#define RTOS_ENABLE_STACK_OVERFLOW_CHECK (1U)
+
+/* Log flush wake-up on an emulated software interrupt line */
+#define LOG_FLUSH_WAKE_IRQn       SWI0_IRQn
+#define LOG_FLUSH_WAKE_IRQHandler SWI0_IRQHandler
+
+/* Spare line for the ISR tests (tests/scheduler/test_common.h) */
+#define TEST_SPARE_IRQn       SWI1_IRQn
+#define TEST_SPARE_IRQHandler SWI1_IRQHandler
+
+#endif /* RTOS_CONFIG_NATIVE_H */
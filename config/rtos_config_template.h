@@ -17,16 +17,52 @@
 // #define RTOS_MAX_TASK_PRIORITIES    (8U)
 // #define RTOS_DEFAULT_TASK_STACK_SIZE (768U)
 // #define RTOS_MINIMUM_TASK_STACK_SIZE (256U)
+// #define RTOS_TASK_NOTIFY_ARRAY_ENTRIES (3U)
+// #define RTOS_TASK_NAME_HASH_BUCKETS (8U)
 
 /* ======================== Scheduler ===================================== */
 // #define RTOS_SCHEDULER_TYPE RTOS_SCHEDULER_PREEMPTIVE_SP
 // #define RTOS_TIME_SLICE_TICKS       (20)
+// #define RTOS_SCHEDULER_STATS        (0U)  /* drop the switch/wake counters from the switch path */
+// #define RTOS_USE_PREEMPTION_THRESHOLD (1U)  /* preemptive_sp only */
+// #define RTOS_SMP_CORES              (2U)  /* needs PORT_NUM_CORES >= 2 */
+
+/* ======================== Timers ======================================== */
+// #define RTOS_USE_TIMING_WHEEL       (1U)
+// #define RTOS_TIMING_WHEEL_SLOT_BITS (5U)
+// #define RTOS_TIMING_WHEEL_LEVELS    (4U)
+// #define RTOS_USE_HRTIMER            (1U)  /* owns TIM5 on the Nucleo boards */
+// #define RTOS_HRTIMER_MAX_TIMERS     (8U)
+// #define RTOS_HRTIMER_IRQ_PRIO       (8U)  /* kernel-safe: >= 8 */
+
+/* ======================== Power ========================================= */
+// #define RTOS_TICKLESS_IDLE           (1U)
+// #define RTOS_TICKLESS_MIN_IDLE_TICKS (2U)
+// #define RTOS_USE_LOW_POWER           (1U)  /* needs RTOS_TICKLESS_IDLE */
+// #define RTOS_POWER_DEEPEST_MODE      (1U)  /* 0 sleep, 1 stop, 2 standby */
+// #define RTOS_POWER_STOP_MIN_IDLE_TICKS    (10U)
+// #define RTOS_POWER_STANDBY_MIN_IDLE_TICKS (5000U)
 
 /* ======================== Memory ======================================== */
 // #define RTOS_TOTAL_HEAP_SIZE        (8192U)
+// #define RTOS_HEAP_REGION            RTOS_REGION_SRAM2  /* tags from memory_map.h */
+// #define RTOS_TCB_POOL_REGION        RTOS_REGION_SRAM2
+// #define RTOS_KERNEL_STACK_REGION    RTOS_REGION_SRAM2
+// #define RTOS_DMA_BUFFER_REGION      RTOS_REGION_DMA    /* Cortex-M7: DMA-reachable SRAM */
+// #define RTOS_FAST_CODE              RTOS_REGION_ITCM
+// #define RTOS_FAST_CODE_IN_ITCM      (1U)
+// #define RTOS_QUEUE_ZERO_COPY_CACHE_MAINT (1U)
+// #define RTOS_AO_MAX_EVENT_POOLS (3U)
+// #define RTOS_AO_MAX_NEST_DEPTH (6U)
+// #define RTOS_WORKQUEUE_MAX_WORKERS (4U)
+// #define RTOS_WORKQUEUE_STEALING (1U)
 
 /* ======================== Features ====================================== */
 // #define RTOS_ENABLE_STACK_OVERFLOW_CHECK (1U)
+// #define RTOS_ENABLE_STACK_WATERMARK (1U)
+// #define RTOS_STACK_SCAN_WORDS       (32U)
+// #define RTOS_STACK_GUARD_MPU        (1U)
+// #define RTOS_STACK_GUARD_SIZE       (32U)
 
 /* ======================== Debug ========================================= */
 // #define RTOS_ASSERT_ENABLED (1U)
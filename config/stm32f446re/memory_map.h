@@ -21,6 +21,29 @@
 #define SRAM_SIZE      (128UL * 1024UL) /* 128KB */
 #define SRAM_END_ADDR  (SRAM_BASE_ADDR + SRAM_SIZE - 1)
 
+/*
+ * SRAM is two banks on separate bus-matrix slave ports, so a CPU access to
+ * one never waits behind DMA traffic to the other. The F446 has no CCM RAM;
+ * SRAM2 is the place for latency-critical stacks, with DMA buffers (UART,
+ * ADC) left in SRAM1.
+ */
+#define SRAM1_BASE_ADDR (SRAM_BASE_ADDR)
+#define SRAM1_SIZE      (112UL * 1024UL) /* 112KB */
+#define SRAM2_BASE_ADDR (SRAM1_BASE_ADDR + SRAM1_SIZE)
+#define SRAM2_SIZE      (16UL * 1024UL) /* 16KB */
+
+/*
+ * Region tags for static objects, matching the output sections in
+ * ldscripts/STM32F446RETx_FLASH.ld:
+ *
+ *     static uint32_t ctrl_stack[256] RTOS_REGION_SRAM2 __attribute__((aligned(8)));
+ *
+ * SRAM2 is NOLOAD: it is not zeroed at reset, so tag only buffers whose
+ * owner initializes them (task stacks, queue storage, the TCB pool, the heap).
+ */
+#define RTOS_REGION_SRAM1 /* default .bss */
+#define RTOS_REGION_SRAM2 __attribute__((section(".sram2")))
+
 /* Stack and Heap Configuration */
 #define MAIN_STACK_SIZE  (2048UL) /* 2KB main stack */
 #define MAIN_STACK_START (SRAM_END_ADDR + 1)
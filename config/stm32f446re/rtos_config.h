@@ -9,13 +9,17 @@
 /* System clock — Nucleo-F446RE runs at 84 MHz */
 #define RTOS_SYSTEM_CLOCK_HZ (84000000U)
 
-/* Task limits */
-#define RTOS_MAX_TASKS               (10U)
+/* Task limits (a test env with more tasks raises the pool and heap) */
+#ifndef RTOS_MAX_TASKS
+#define RTOS_MAX_TASKS (10U)
+#endif
 #define RTOS_DEFAULT_TASK_STACK_SIZE (768U)
 #define RTOS_MINIMUM_TASK_STACK_SIZE (256U)
 
 /* Heap */
+#ifndef RTOS_TOTAL_HEAP_SIZE
 #define RTOS_TOTAL_HEAP_SIZE (8192U)
+#endif
 
 #define RTOS_ENABLE_STACK_OVERFLOW_CHECK (1U)
 
@@ -0,0 +1,14 @@
+#ifndef DEVICE_H
+#define DEVICE_H
+
+/**
+ * @file device.h
+ * @brief Vendor device header for the STM32H7 family.
+ *
+ * Chip-independent sources include this instead of naming the vendor
+ * header, so the same tree builds for every board under config/.
+ */
+
+#include "stm32h7xx_hal.h" // IWYU pragma: export
+
+#endif /* DEVICE_H */
@@ -0,0 +1,61 @@
+#ifndef MEMORY_MAP_H
+#define MEMORY_MAP_H
+
+#include <stdint.h>
+
+/**
+ * @file memory_map.h
+ * @brief STM32H743ZI Memory Layout Definitions
+ *
+ * This file defines the memory layout and addresses specific to the
+ * STM32H743ZI (Nucleo-H743ZI) microcontroller.
+ */
+
+/* Flash Memory Layout */
+#define FLASH_BASE_ADDR (0x08000000UL)
+#define FLASH_SIZE      (2048UL * 1024UL) /* 2MB */
+#define FLASH_END_ADDR  (FLASH_BASE_ADDR + FLASH_SIZE - 1)
+
+/*
+ * Tightly coupled memories: single-cycle, never cached, but not reachable
+ * by the DMA1/DMA2 controllers. ldscripts/STM32H743ZITx_FLASH.ld puts
+ * .data, .bss, the main stack and .noinit in DTCM, so every kernel
+ * structure (g_kernel, ready lists, TCBs, kernel stacks) lives there.
+ */
+#define ITCM_BASE_ADDR (0x00000000UL)
+#define ITCM_SIZE      (64UL * 1024UL) /* 64KB */
+#define DTCM_BASE_ADDR (0x20000000UL)
+#define DTCM_SIZE      (128UL * 1024UL) /* 128KB */
+
+/* SRAM: D1 AXI SRAM and D2 SRAM1-3, cached and DMA-reachable */
+#define SRAM_BASE_ADDR    (0x24000000UL)
+#define SRAM_SIZE         (512UL * 1024UL) /* 512KB AXI SRAM */
+#define SRAM_END_ADDR     (SRAM_BASE_ADDR + SRAM_SIZE - 1)
+#define SRAM_D2_BASE_ADDR (0x30000000UL)
+#define SRAM_D2_SIZE      (288UL * 1024UL) /* 288KB SRAM1-3 */
+
+/*
+ * Region tags for static objects, matching the output sections in
+ * ldscripts/STM32H743ZITx_FLASH.ld:
+ *
+ *     static uint8_t adc_buf[512] RTOS_REGION_DMA __attribute__((aligned(32)));
+ *
+ * RTOS_REGION_DMA is NOLOAD AXI SRAM and write-back cached: clean a buffer
+ * with rtos_port_dcache_clean() before DMA reads it, and invalidate it with
+ * rtos_port_dcache_invalidate() (line-aligned) after DMA wrote it.
+ */
+#define RTOS_REGION_DTCM /* default .bss */
+#define RTOS_REGION_DMA  __attribute__((section(".dma_buffer")))
+#define RTOS_REGION_ITCM __attribute__((section(".itcm_text")))
+
+/* Kernel placement (see config.h) */
+#define RTOS_DMA_BUFFER_REGION RTOS_REGION_DMA
+#define RTOS_FAST_CODE         RTOS_REGION_ITCM
+#define RTOS_FAST_CODE_IN_ITCM (1U)
+
+/* Stack and Heap Configuration */
+#define MAIN_STACK_SIZE  (4096UL) /* 4KB main stack */
+#define MAIN_STACK_START (DTCM_BASE_ADDR + DTCM_SIZE)
+#define MAIN_STACK_END   (MAIN_STACK_START - MAIN_STACK_SIZE)
+
+#endif /* MEMORY_MAP_H */
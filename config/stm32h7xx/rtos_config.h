@@ -0,0 +1,22 @@
+#ifndef RTOS_CONFIG_STM32H7XX_H
+#define RTOS_CONFIG_STM32H7XX_H
+
+/* Values defined here take precedence over the defaults in config.h. */
+
+#include "clock_config.h" // IWYU pragma: keep
+#include "memory_map.h"   // IWYU pragma: keep
+
+/* System clock — Nucleo-H743ZI boots from the 64 MHz HSI */
+#define RTOS_SYSTEM_CLOCK_HZ (64000000U)
+
+/* Task limits */
+#define RTOS_MAX_TASKS               (16U)
+#define RTOS_DEFAULT_TASK_STACK_SIZE (1024U)
+#define RTOS_MINIMUM_TASK_STACK_SIZE (256U)
+
+/* Heap (DTCM, with the rest of .bss) */
+#define RTOS_TOTAL_HEAP_SIZE (32768U)
+
+#define RTOS_ENABLE_STACK_OVERFLOW_CHECK (1U)
+
+#endif /* RTOS_CONFIG_STM32H7XX_H */
@@ -73,6 +73,28 @@ void rtos_delay_until(rtos_tick_t *const prev_wake_time, rtos_tick_t time_increm
  */
 void rtos_yield(void);
 
+/**
+ * @brief Suspend the scheduler, keeping interrupts enabled
+ *
+ * For long task-side sequences that must not be interleaved with other
+ * tasks but need not hold off interrupts: the caller keeps the CPU, ISRs
+ * still run, and tasks they make ready wait on a pending-ready list.
+ * Nests; each call needs one rtos_scheduler_resume(). Task context only,
+ * and the caller must not block until it resumes. With RTOS_SMP_CORES > 1
+ * switching stops on every core.
+ */
+void rtos_scheduler_suspend(void);
+
+/**
+ * @brief Undo one rtos_scheduler_suspend()
+ *
+ * The outermost call makes the pending tasks ready, catches up on the ticks
+ * that passed, and switches once if a task now outranks the caller.
+ *
+ * @return RTOS_SUCCESS, or RTOS_ERROR_INVALID_STATE if not suspended
+ */
+rtos_status_t rtos_scheduler_resume(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,247 @@
+#ifndef RTOS_ACTIVE_H
+#define RTOS_ACTIVE_H
+
+#include "VRTOS.h"
+#include "mempool.h"
+#include "queue.h"
+#include "queue_set.h"
+#include "rtos_types.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file active.h
+ * @brief Active objects: event-driven hierarchical state machines on queues
+ *
+ * An active object is a hierarchical state machine with an event queue. It
+ * handles one event at a time to completion, so its state needs no locks.
+ * Events are blocks from fixed-size mempools. A post queues a pointer, not a
+ * copy, and each event counts the queues that still hold it. The block goes
+ * back to its pool after the last handler has run.
+ *
+ *     typedef struct { rtos_ao_event_t super; uint16_t value; } sample_evt_t;
+ *
+ *     sample_evt_t *e = RTOS_AO_EVENT_NEW(sample_evt_t, SIG_SAMPLE);
+ *     if (e != NULL)
+ *     {
+ *         e->value = adc_read();
+ *         rtos_ao_post(&logger.super, &e->super, 0U);
+ *     }
+ *
+ * Several active objects of the same priority share one task through an
+ * rtos_ao_group_t. The task takes one event per object in turn, so a busy
+ * object cannot starve the others. It sleeps on a queue set of their queues
+ * when all are empty, so a group holds at most RTOS_QUEUE_SET_MAX_MEMBERS
+ * objects.
+ *
+ * State handlers follow the usual HSM shape. Signals the state does not
+ * handle fall to the default case, which names the parent:
+ *
+ *     static rtos_ao_ret_t blinky_on(rtos_ao_t *me, const rtos_ao_event_t *e)
+ *     {
+ *         switch (e->sig)
+ *         {
+ *         case RTOS_AO_SIG_ENTRY:
+ *             led_on();
+ *             return RTOS_AO_HANDLED();
+ *         case SIG_TICK:
+ *             return RTOS_AO_TRAN(me, blinky_off);
+ *         default:
+ *             return RTOS_AO_SUPER(me, blinky_active);
+ *         }
+ *     }
+ *
+ * Transitions are local: a transition to a substate does not exit the
+ * source, and one to a superstate does not exit and re-enter the target.
+ * A transition from a state to itself exits and re-enters it. A state that
+ * handles RTOS_AO_SIG_INIT with RTOS_AO_TRAN() to a direct or indirect
+ * substate names its default substate; entry drills down these transitions.
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** Event signal */
+typedef uint16_t rtos_ao_signal_t;
+
+/* Reserved signals, sent by the dispatcher */
+#define RTOS_AO_SIG_EMPTY ((rtos_ao_signal_t) 0U) /**< Asks a state for its parent */
+#define RTOS_AO_SIG_ENTRY ((rtos_ao_signal_t) 1U) /**< State entered */
+#define RTOS_AO_SIG_EXIT  ((rtos_ao_signal_t) 2U) /**< State exited */
+#define RTOS_AO_SIG_INIT  ((rtos_ao_signal_t) 3U) /**< Take the default substate transition */
+#define RTOS_AO_SIG_USER  ((rtos_ao_signal_t) 4U) /**< First application signal */
+
+/**
+ * @brief Event header; application events embed it as their first member
+ */
+typedef struct rtos_ao_event
+{
+    rtos_ao_signal_t sig;  /**< Signal */
+    uint8_t          pool; /**< Pool index + 1, 0 = static event (never freed) */
+    volatile uint8_t refs; /**< Queues and handlers still holding the event */
+} rtos_ao_event_t;
+
+/** Initializer of a static (const or global) event */
+#define RTOS_AO_STATIC_EVENT(signal) {.sig = (signal), .pool = 0U, .refs = 0U}
+
+/**
+ * @brief What a state handler did with an event
+ */
+typedef enum
+{
+    RTOS_AO_RET_HANDLED = 0, /**< Consumed */
+    RTOS_AO_RET_IGNORED,     /**< Consumed with no effect (top state only) */
+    RTOS_AO_RET_TRAN,        /**< Transition to the state in ->temp */
+    RTOS_AO_RET_SUPER        /**< Not handled here; the parent is in ->temp */
+} rtos_ao_ret_t;
+
+typedef struct rtos_ao rtos_ao_t;
+
+/** State handler. Objects that embed rtos_ao_t first cast `me` back. */
+typedef rtos_ao_ret_t (*rtos_ao_state_t)(rtos_ao_t *me, const rtos_ao_event_t *e);
+
+/* State handler return statements */
+#define RTOS_AO_HANDLED()          (RTOS_AO_RET_HANDLED)
+#define RTOS_AO_TRAN(me, target)   ((me)->temp = (rtos_ao_state_t) (target), RTOS_AO_RET_TRAN)
+#define RTOS_AO_SUPER(me, parent)  ((me)->temp = (rtos_ao_state_t) (parent), RTOS_AO_RET_SUPER)
+
+struct rtos_ao_group;
+
+/**
+ * @brief Active object (fields are private; embed it as the first member)
+ */
+struct rtos_ao
+{
+    rtos_ao_state_t       state;    /**< Current leaf state */
+    rtos_ao_state_t       temp;     /**< Target or parent returned by a handler */
+    rtos_queue_handle_t   queue;    /**< Event pointer queue */
+    rtos_queue_static_t   queue_cb; /**< Its control block */
+    struct rtos_ao_group *group;    /**< Group whose task runs the object */
+    struct rtos_ao       *next;     /**< Group list link, in start order */
+};
+
+/**
+ * @brief Active objects sharing one task
+ */
+typedef struct rtos_ao_group
+{
+    rtos_ao_t       *head; /**< Started objects */
+    rtos_queue_set_t set;  /**< Their queues */
+} rtos_ao_group_t;
+
+/**
+ * @brief Top state: the parent of every outermost state; ignores all events
+ */
+rtos_ao_ret_t rtos_ao_top(rtos_ao_t *me, const rtos_ao_event_t *e);
+
+/**
+ * @brief Add an event pool (before any event is allocated)
+ *
+ * rtos_ao_event_new() takes the first pool whose blocks fit, so pools are
+ * added in increasing block size.
+ *
+ * @return RTOS_SUCCESS, RTOS_ERROR_INVALID_PARAM (NULL, or blocks smaller
+ *         than the last pool's), or RTOS_ERROR_FULL past RTOS_AO_MAX_EVENT_POOLS
+ */
+rtos_status_t rtos_ao_pool_add(rtos_mempool_t *pool);
+
+/**
+ * @brief Allocate a dynamic event from task context (never blocks)
+ * @param size Event size including the header, at least sizeof(rtos_ao_event_t)
+ * @return The event with sig set and no references, or NULL when no pool
+ *         fits or the fitting pool is empty (the pool's fail_count records it)
+ */
+rtos_ao_event_t *rtos_ao_event_new(size_t size, rtos_ao_signal_t sig);
+
+/**
+ * @brief rtos_ao_event_new() for ISRs at kernel priority
+ */
+rtos_ao_event_t *rtos_ao_event_new_from_isr(size_t size, rtos_ao_signal_t sig);
+
+/** Typed rtos_ao_event_new(): RTOS_AO_EVENT_NEW(my_evt_t, SIG_X) */
+#define RTOS_AO_EVENT_NEW(type, sig) ((type *) rtos_ao_event_new(sizeof(type), (sig)))
+
+/**
+ * @brief Take a reference from task context
+ *
+ * Only needed to post one new event to several objects: a receiver may
+ * handle and free it before the next post unless the sender holds it.
+ * Release with rtos_ao_event_gc() after the last post.
+ */
+void rtos_ao_event_ref(const rtos_ao_event_t *e);
+
+/**
+ * @brief Drop a reference; the last one frees a dynamic event
+ *
+ * The group task calls this after dispatch. A task that allocated an event
+ * and gave up on posting it calls it too; with no reference taken, the
+ * event is freed at once. Static events are left alone.
+ */
+void rtos_ao_event_gc(const rtos_ao_event_t *e);
+
+/**
+ * @brief Start an active object on a group
+ *
+ * Creates the object's queue over caller storage, takes the initial
+ * transition in the caller's context (entry actions run here), then joins
+ * the group. Start every object before the group's task first runs.
+ *
+ * @param initial Initial target state, entered from rtos_ao_top
+ * @param storage Array of queue_length event pointers
+ * @return RTOS_SUCCESS, RTOS_ERROR_INVALID_PARAM, or as
+ *         rtos_queue_create_static() / rtos_queue_set_add_queue()
+ */
+rtos_status_t rtos_ao_start(rtos_ao_group_t *group, rtos_ao_t *me, rtos_ao_state_t initial,
+                            const rtos_ao_event_t **storage, uint32_t queue_length);
+
+/**
+ * @brief Post an event to an object's queue (zero copy)
+ *
+ * Takes a reference for the queue. An event that cannot be queued is
+ * released again, so a newly allocated event is freed on failure.
+ *
+ * @param timeout_ticks Wait while the queue is full; 0 = no wait
+ * @return RTOS_SUCCESS, RTOS_ERROR_INVALID_PARAM, RTOS_ERROR_FULL when the
+ *         event already has 255 references, or as rtos_queue_send()
+ */
+rtos_status_t rtos_ao_post(rtos_ao_t *me, const rtos_ao_event_t *e, rtos_tick_t timeout_ticks);
+
+/*
+ * ISR variant: never waits. *higher_priority_task_woken follows
+ * rtos_queue_send_from_isr().
+ */
+rtos_status_t rtos_ao_post_from_isr(rtos_ao_t *me, const rtos_ao_event_t *e, bool *higher_priority_task_woken);
+
+/**
+ * @brief True if the object is in `state` or one of its substates
+ *
+ * Only from the object's own handlers, or while its group is not running.
+ */
+bool rtos_ao_is_in(rtos_ao_t *me, rtos_ao_state_t state);
+
+/**
+ * @brief Initialize an empty group
+ * @return RTOS_SUCCESS, or RTOS_ERROR_INVALID_PARAM
+ */
+rtos_status_t rtos_ao_group_init(rtos_ao_group_t *group);
+
+/**
+ * @brief Event loop, as the body of a normal task (parameter = the group)
+ *
+ *     rtos_task_create(rtos_ao_group_task, "AOs", RTOS_DEFAULT_TASK_STACK_SIZE,
+ *                      &group, 3, &handle);
+ *
+ * The stack must hold the deepest handler call chain. Handlers must not
+ * block: that stalls every object of the group. Never returns.
+ */
+__attribute__((__noreturn__)) void rtos_ao_group_task(void *param);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RTOS_ACTIVE_H */
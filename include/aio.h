@@ -0,0 +1,136 @@
+#ifndef RTOS_AIO_H
+#define RTOS_AIO_H
+
+#include "rtos_types.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @file aio.h
+ * @brief Asynchronous I/O Requests
+ *
+ * A request object carries one transfer from submission to completion, so
+ * a task can start several SPI, I2C or UART transfers, compute while they
+ * run and collect each result in whatever way suits it:
+ *
+ *   - rtos_io_wait() blocks until the request completes (or a timeout)
+ *   - rtos_io_is_done() polls without blocking
+ *   - a callback runs in the deferred-work daemon at completion
+ *   - a notify task is given one notification per completion (one task
+ *     taking notifications collects many requests)
+ *
+ * The driver side is two calls:
+ *
+ *     rtos_io_submit(req);                       // before starting the DMA
+ *     ...
+ *     rtos_io_complete_from_isr(req, RTOS_SUCCESS, bytes, &woken); // TC ISR
+ *
+ * Completion from the ISR only links the request onto the kernel's
+ * completion queue; the deferred daemon then runs callbacks, gives
+ * notifications and wakes waiters, in completion order, with one daemon
+ * wakeup for a burst of completions. Requires RTOS_USE_DEFERRED_WORK.
+ *
+ * A callback may resubmit its own request to chain transfers; waiters
+ * then keep waiting for the next completion. One task at a time may wait
+ * on a request.
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+struct rtos_io_request;
+struct rtos_task_control_block;
+
+/**
+ * @brief Completion callback, run by the deferred daemon
+ *
+ * Same rules as deferred work: any non-blocking API, no blocking calls.
+ */
+typedef void (*rtos_io_callback_t)(struct rtos_io_request *req);
+
+typedef enum
+{
+    RTOS_IO_IDLE = 0,   /**< Never submitted */
+    RTOS_IO_PENDING,    /**< Submitted, transfer in flight */
+    RTOS_IO_COMPLETING, /**< Completed by the driver, queued for the daemon */
+    RTOS_IO_DONE        /**< Result delivered; may be submitted again */
+} rtos_io_state_t;
+
+/**
+ * @brief Request object (caller-owned; fields other than context are private
+ *        while the request is in flight)
+ */
+typedef struct rtos_io_request
+{
+    struct rtos_io_request                  *next;        /**< Completion queue link */
+    rtos_io_callback_t                       callback;    /**< Run at completion, NULL = none */
+    void                                    *context;     /**< Free for the submitter and callback */
+    rtos_task_handle_t                       notify_task; /**< Given a notification at completion, NULL = none */
+    struct rtos_task_control_block *volatile waiter;      /**< Task blocked in rtos_io_wait() */
+    volatile uint8_t                         state;       /**< rtos_io_state_t */
+    rtos_status_t                            status;      /**< Driver's result, valid once done */
+    uint32_t                                 transferred; /**< Bytes moved, valid once done */
+} rtos_io_request_t;
+
+/**
+ * @brief Prepare a request and choose how its completions are delivered
+ * @param callback    Run by the daemon at completion, or NULL
+ * @param context     Stored in req->context
+ * @param notify_task Given one notification per completion, or NULL
+ * @return RTOS_SUCCESS, RTOS_ERROR_INVALID_PARAM, or RTOS_ERROR_INVALID_STATE
+ *         while the request is in flight
+ */
+rtos_status_t rtos_io_init(rtos_io_request_t *req, rtos_io_callback_t callback, void *context,
+                           rtos_task_handle_t notify_task);
+
+/**
+ * @brief Mark a request in flight (driver, before starting the transfer)
+ *
+ * Task or ISR context, or the request's own callback.
+ *
+ * @return RTOS_SUCCESS, RTOS_ERROR_INVALID_PARAM, or RTOS_ERROR_INVALID_STATE
+ *         (already in flight, or RTOS_USE_DEFERRED_WORK is 0)
+ */
+rtos_status_t rtos_io_submit(rtos_io_request_t *req);
+
+/**
+ * @brief Complete a request from the driver's ISR
+ * @param status      Driver result recorded in req->status
+ * @param transferred Bytes moved, recorded in req->transferred
+ * @param higher_priority_task_woken Set to true (never cleared) when the
+ *        daemon should preempt the interrupted task; may be NULL
+ * @return RTOS_SUCCESS, RTOS_ERROR_INVALID_PARAM, or RTOS_ERROR_INVALID_STATE
+ *         if the request was not in flight
+ */
+rtos_status_t rtos_io_complete_from_isr(rtos_io_request_t *req, rtos_status_t status, uint32_t transferred,
+                                        bool *higher_priority_task_woken);
+
+/**
+ * @brief Complete a request from task context (a driver that fails at start,
+ *        or finishes without an interrupt)
+ */
+rtos_status_t rtos_io_complete(rtos_io_request_t *req, rtos_status_t status, uint32_t transferred);
+
+/**
+ * @brief Block until the request is done
+ * @param timeout_ticks 0 = no wait, RTOS_MAX_DELAY = forever
+ * @return The driver's status once done; RTOS_ERROR_TIMEOUT if still in
+ *         flight at the timeout; RTOS_ERROR_INVALID_STATE if never
+ *         submitted or another task is waiting; RTOS_ERROR_INVALID_PARAM
+ */
+rtos_status_t rtos_io_wait(rtos_io_request_t *req, rtos_tick_t timeout_ticks);
+
+/**
+ * @brief True once the result is delivered (req->status and
+ *        req->transferred are valid)
+ */
+bool rtos_io_is_done(const rtos_io_request_t *req);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RTOS_AIO_H */
@@ -24,8 +24,20 @@
 #define RTOS_MAX_TASKS (8U) /**< Maximum number of tasks */
 #endif
 
+/*
+ * Every wait queue holds one head pointer per level (see wait_queue.h), and a
+ * queue embeds two: at 256 levels a queue costs over 2 KB on Cortex-M, taken
+ * from RTOS_TOTAL_HEAP_SIZE when created with rtos_queue_create().
+ */
 #ifndef RTOS_MAX_TASK_PRIORITIES
-#define RTOS_MAX_TASK_PRIORITIES (8U) /**< Maximum priority levels */
+#define RTOS_MAX_TASK_PRIORITIES (8U) /**< Maximum priority levels, 1..256 */
+#endif
+
+/* Priority range check; at 256 levels every rtos_priority_t value is valid */
+#if RTOS_MAX_TASK_PRIORITIES >= 256U
+#define RTOS_PRIORITY_IN_RANGE(p) ((void) (p), 1)
+#else
+#define RTOS_PRIORITY_IN_RANGE(p) ((p) < RTOS_MAX_TASK_PRIORITIES)
 #endif
 
 #ifndef RTOS_IDLE_TASK_PRIORITY
@@ -40,6 +52,43 @@
 #define RTOS_MINIMUM_TASK_STACK_SIZE (128U) /**< Minimum allowed task stack size */
 #endif
 
+#ifndef RTOS_TASK_NAME_HASH_BUCKETS
+#define RTOS_TASK_NAME_HASH_BUCKETS (8U) /**< rtos_task_get_by_name() hash buckets, power of 2 */
+#endif
+
+#ifndef RTOS_TASK_NOTIFY_ARRAY_ENTRIES
+#define RTOS_TASK_NOTIFY_ARRAY_ENTRIES (1U) /**< Notification slots per task (rtos_task_notify_indexed) */
+#endif
+
+#ifndef RTOS_QUEUE_SET_MAX_MEMBERS
+#define RTOS_QUEUE_SET_MAX_MEMBERS (8U) /**< Queues/semaphores/notification one queue set can hold */
+#endif
+
+/*
+ * Zero-copy queue slots handed to DMA on a data-cache core: send_commit
+ * cleans the slot, receive_peek invalidates it. Storage and item size must
+ * then be multiples of the cache line. No effect on ports without a D-cache.
+ */
+#ifndef RTOS_QUEUE_ZERO_COPY_CACHE_MAINT
+#define RTOS_QUEUE_ZERO_COPY_CACHE_MAINT (0U)
+#endif
+
+#ifndef RTOS_AO_MAX_EVENT_POOLS
+#define RTOS_AO_MAX_EVENT_POOLS (3U) /**< Mempools rtos_ao_event_new() picks from, 1..255 */
+#endif
+
+#ifndef RTOS_AO_MAX_NEST_DEPTH
+#define RTOS_AO_MAX_NEST_DEPTH (6U) /**< Deepest active-object state nesting, top state excluded */
+#endif
+
+#ifndef RTOS_WORKQUEUE_MAX_WORKERS
+#define RTOS_WORKQUEUE_MAX_WORKERS (4U) /**< Worker tasks one work queue can hold */
+#endif
+
+#ifndef RTOS_WORKQUEUE_STEALING
+#define RTOS_WORKQUEUE_STEALING (1U) /**< A worker with nothing queued takes jobs queued on the others */
+#endif
+
 /* ======================== Scheduler Configuration ======================= */
 
 #ifndef RTOS_SCHEDULER_TYPE
@@ -48,29 +97,277 @@
 
 /* Ensure enum values are available */
 #if !defined(RTOS_SCHEDULER_PREEMPTIVE_SP) || !defined(RTOS_SCHEDULER_COOPERATIVE) ||                                  \
-    !defined(RTOS_SCHEDULER_ROUND_ROBIN)
+    !defined(RTOS_SCHEDULER_ROUND_ROBIN) || !defined(RTOS_SCHEDULER_EDF)
 #include "scheduler.h" // IWYU pragma: keep
 #endif
 
+/*
+ * Preprocessor-visible scheduler id.  The rtos_scheduler_type_t enumerators
+ * are invisible to #if (they evaluate as 0), so RTOS_SCHEDULER_TYPE is mapped
+ * through these by name; numeric values are accepted as well.
+ */
+#define RTOS_SCHED_ID_RTOS_SCHEDULER_PREEMPTIVE_SP 0
+#define RTOS_SCHED_ID_RTOS_SCHEDULER_COOPERATIVE   1
+#define RTOS_SCHED_ID_RTOS_SCHEDULER_ROUND_ROBIN   2
+#define RTOS_SCHED_ID_RTOS_SCHEDULER_EDF           3
+#define RTOS_SCHED_ID_0                            0
+#define RTOS_SCHED_ID_1                            1
+#define RTOS_SCHED_ID_2                            2
+#define RTOS_SCHED_ID_3                            3
+#define RTOS_SCHED_ID_EXPAND(type)                 RTOS_SCHED_ID_##type
+#define RTOS_SCHED_ID(type)                        RTOS_SCHED_ID_EXPAND(type)
+#define RTOS_SCHEDULER_TYPE_ID                     RTOS_SCHED_ID(RTOS_SCHEDULER_TYPE)
+
 /* Scheduler-specific flags */
-#if (RTOS_SCHEDULER_TYPE == RTOS_SCHEDULER_PREEMPTIVE_SP)
+#if (RTOS_SCHEDULER_TYPE_ID == RTOS_SCHED_ID_0)
 #define RTOS_USE_PRIORITY_SCHEDULING 1
-#elif (RTOS_SCHEDULER_TYPE == RTOS_SCHEDULER_COOPERATIVE)
+#elif (RTOS_SCHEDULER_TYPE_ID == RTOS_SCHED_ID_1)
 #define RTOS_USE_COOPERATIVE_SCHEDULING 1
-#elif (RTOS_SCHEDULER_TYPE == RTOS_SCHEDULER_ROUND_ROBIN)
+#elif (RTOS_SCHEDULER_TYPE_ID == RTOS_SCHED_ID_2)
 #define RTOS_USE_ROUND_ROBIN_SCHEDULING 1
+#elif (RTOS_SCHEDULER_TYPE_ID == RTOS_SCHED_ID_3)
+#define RTOS_USE_EDF_SCHEDULING 1
+#else
+#error "RTOS_SCHEDULER_TYPE must name an rtos_scheduler_type_t value"
+#endif
+
+/*
+ * 1 = bind the rtos_scheduler_* wrappers directly to the RTOS_SCHEDULER_TYPE
+ * backend, which is compiled into scheduler.c so its operations inline.
+ * 0 = dispatch through the rtos_scheduler_t vtable selected at init.
+ */
+#ifndef RTOS_SCHEDULER_STATIC_DISPATCH
+#define RTOS_SCHEDULER_STATIC_DISPATCH (1U)
+#endif
+
+#ifndef RTOS_SCHEDULER_STATS
+#define RTOS_SCHEDULER_STATS (1U) /**< Switch, wake and list-length counters in rtos_scheduler_get_statistics() */
 #endif
 
 #ifndef RTOS_TIME_SLICE_TICKS
 #define RTOS_TIME_SLICE_TICKS 1 /**< Time slice in ticks */
 #endif
 
+/*
+ * Cores the kernel schedules tasks on (symmetric multiprocessing). Above 1
+ * each core has its own running task and idle task, a task created with
+ * RTOS_TASK_FLAG_CORE(n) runs only on core n, and a task made ready on one
+ * core preempts another through rtos_port_yield_core(). Needs a port with
+ * PORT_NUM_CORES >= RTOS_SMP_CORES whose critical sections also take the
+ * kernel spinlock, and the preemptive priority scheduler.
+ */
+#ifndef RTOS_SMP_CORES
+#define RTOS_SMP_CORES (1U)
+#endif
+
+#if RTOS_SMP_CORES < 1 || RTOS_SMP_CORES > 2
+#error "RTOS_SMP_CORES must be 1 or 2"
+#endif
+
+#if RTOS_SMP_CORES > 1 && !RTOS_USE_PRIORITY_SCHEDULING
+#error "RTOS_SMP_CORES > 1 requires RTOS_SCHEDULER_PREEMPTIVE_SP"
+#endif
+
+/*
+ * Admission control for periodic tasks created with a WCET budget.  When
+ * enabled, rtos_task_create_periodic() checks the budgeted task set
+ * (response-time analysis, or a density test under EDF) and the tick handler
+ * charges each job's ticks against its budget, counting overruns.
+ */
+#define RTOS_ADMISSION_OFF    (0U) /**< No analysis, no budget accounting */
+#define RTOS_ADMISSION_WARN   (1U) /**< Log KEVT_TASK_ADMISSION_FAIL, create the task anyway */
+#define RTOS_ADMISSION_REJECT (2U) /**< Fail the create with RTOS_ERROR_NOT_SCHEDULABLE */
+
+#ifndef RTOS_ADMISSION_CONTROL
+#define RTOS_ADMISSION_CONTROL RTOS_ADMISSION_OFF
+#endif
+
+#ifndef RTOS_USE_BUDGET_SERVER
+#define RTOS_USE_BUDGET_SERVER (0U) /**< 1 = tick-driven budget servers (rtos_task_set_budget_server) */
+#endif
+
+/*
+ * Preemption thresholds (RTOS_SCHEDULER_PREEMPTIVE_SP). While a task with a
+ * threshold runs, only tasks above the threshold preempt it, and once
+ * preempted it resumes ahead of any task it would have held off. Tasks
+ * sharing a threshold never preempt one another.
+ */
+#ifndef RTOS_USE_PREEMPTION_THRESHOLD
+#define RTOS_USE_PREEMPTION_THRESHOLD (0U) /**< 1 = rtos_task_set_preemption_threshold() */
+#endif
+
+#if RTOS_SMP_CORES > 1 && RTOS_USE_PREEMPTION_THRESHOLD
+#error "RTOS_USE_PREEMPTION_THRESHOLD supports RTOS_SMP_CORES == 1 only"
+#endif
+
+/* ======================== Footprint Configuration ======================= */
+
+/*
+ * Compact footprint for small-SRAM parts: kernel objects trade a little
+ * speed for RAM.
+ *   - Wait queues are one priority-ordered list (a head pointer) instead of
+ *     a head per priority level plus a bitmap: insert walks the waiters.
+ *   - Queues keep slot indices instead of read/write pointers; queue
+ *     lengths, item sizes and semaphore counts are 16-bit (create/init
+ *     reject larger values, unlimited semaphores stop at 65535).
+ *   - TCB state and wait-type fields are one byte, round-robin quanta
+ *     16-bit, and the optional features below default to off.
+ * rtos_tick_t stays 32-bit: absolute wake-up ticks and the wrap-safe
+ * comparisons on them need the full range at any tick rate.
+ * bench_footprint prints the resulting object sizes.
+ */
+#ifndef RTOS_FOOTPRINT_COMPACT
+#define RTOS_FOOTPRINT_COMPACT (0U)
+#endif
+
+/* Periodic tasks (rtos_task_create_periodic): release, deadline and budget fields in every TCB */
+#ifndef RTOS_USE_PERIODIC_TASKS
+#if RTOS_FOOTPRINT_COMPACT && !RTOS_USE_EDF_SCHEDULING && !RTOS_ADMISSION_CONTROL
+#define RTOS_USE_PERIODIC_TASKS (0U)
+#else
+#define RTOS_USE_PERIODIC_TASKS (1U)
+#endif
+#endif
+
+#if !RTOS_USE_PERIODIC_TASKS && (RTOS_USE_EDF_SCHEDULING || RTOS_ADMISSION_CONTROL)
+#error "EDF scheduling and admission control need RTOS_USE_PERIODIC_TASKS"
+#endif
+
+/* Event groups (event_group.c): wait bits and options in every TCB */
+#ifndef RTOS_USE_EVENT_GROUPS
+#define RTOS_USE_EVENT_GROUPS (RTOS_FOOTPRINT_COMPACT ? 0U : 1U)
+#endif
+
+/* ======================== Timer Configuration =========================== */
+
+#ifndef RTOS_USE_TIMING_WHEEL
+#define RTOS_USE_TIMING_WHEEL (0U) /**< 1 = hierarchical timing wheel for delays/timers, 0 = sorted lists */
+#endif
+
+#ifndef RTOS_TIMING_WHEEL_SLOT_BITS
+#define RTOS_TIMING_WHEEL_SLOT_BITS (5U) /**< log2 of slots per wheel level (32 slots) */
+#endif
+
+#ifndef RTOS_TIMING_WHEEL_LEVELS
+#define RTOS_TIMING_WHEEL_LEVELS (4U) /**< Wheel levels; span = 2^(SLOT_BITS * LEVELS) ticks */
+#endif
+
+/*
+ * 1 = microsecond timers and rtos_delay_us() on a 1 MHz hardware counter
+ * with output compare (TIM5 on the Nucleo boards), independent of the tick.
+ */
+#ifndef RTOS_USE_HRTIMER
+#define RTOS_USE_HRTIMER (0U)
+#endif
+
+#ifndef RTOS_HRTIMER_MAX_TIMERS
+#define RTOS_HRTIMER_MAX_TIMERS (8U) /**< Timers armed at once, including rtos_delay_us() waiters */
+#endif
+
+#ifndef RTOS_HRTIMER_IRQ_PRIO
+#define RTOS_HRTIMER_IRQ_PRIO (8U) /**< NVIC priority of the compare interrupt (kernel-safe, >= 8) */
+#endif
+
+/* ======================== Deferred Work Configuration =================== */
+
+/*
+ * 1 = start a daemon task that runs functions posted with rtos_deferred_post()
+ * (from tasks or ISRs) and all software-timer callbacks, so SysTick only
+ * checks whether a timer is due.  0 = timer callbacks run inside SysTick.
+ */
+#ifndef RTOS_USE_DEFERRED_WORK
+#define RTOS_USE_DEFERRED_WORK (1U)
+#endif
+
+#ifndef RTOS_DEFERRED_QUEUE_LENGTH
+#define RTOS_DEFERRED_QUEUE_LENGTH (16U) /**< Pending work items (power of 2) */
+#endif
+
+#ifndef RTOS_DEFERRED_TASK_PRIORITY
+#define RTOS_DEFERRED_TASK_PRIORITY (RTOS_MAX_TASK_PRIORITIES - 1U) /**< Daemon priority (highest) */
+#endif
+
+#ifndef RTOS_DEFERRED_TASK_STACK_SIZE
+#define RTOS_DEFERRED_TASK_STACK_SIZE RTOS_DEFAULT_TASK_STACK_SIZE /**< Daemon stack; callbacks run on it */
+#endif
+
+/* ======================== Power Configuration =========================== */
+
+#ifndef RTOS_TICKLESS_IDLE
+#define RTOS_TICKLESS_IDLE (0U) /**< 1 = suppress SysTick while idle until the next deadline */
+#endif
+
+#ifndef RTOS_TICKLESS_MIN_IDLE_TICKS
+#define RTOS_TICKLESS_MIN_IDLE_TICKS (2U) /**< Shorter idle periods just WFI with the tick running */
+#endif
+
+/*
+ * 1 = the tickless idle task picks a sleep depth (rtos_power_mode_t): the
+ * deepest mode not blocked by rtos_power_block(), no deeper than
+ * RTOS_POWER_DEEPEST_MODE, whose break-even idle time plus measured wake-up
+ * latency fits before the next deadline. Stop and standby are entered and
+ * left through the board's hardware_env_power_enter() / _exit().
+ */
+#ifndef RTOS_USE_LOW_POWER
+#define RTOS_USE_LOW_POWER (0U)
+#endif
+
+#ifndef RTOS_POWER_DEEPEST_MODE
+#define RTOS_POWER_DEEPEST_MODE (1U) /**< 0 = sleep, 1 = stop, 2 = standby (wakes through reset) */
+#endif
+
+#ifndef RTOS_POWER_STOP_MIN_IDLE_TICKS
+#define RTOS_POWER_STOP_MIN_IDLE_TICKS (10U) /**< Break-even idle time for stop, before wake-up latency */
+#endif
+
+#ifndef RTOS_POWER_STANDBY_MIN_IDLE_TICKS
+#define RTOS_POWER_STANDBY_MIN_IDLE_TICKS (5000U) /**< Break-even idle time for standby */
+#endif
+
+#if RTOS_USE_LOW_POWER && !RTOS_TICKLESS_IDLE
+#error "RTOS_USE_LOW_POWER requires RTOS_TICKLESS_IDLE"
+#endif
+
 /* ======================== Memory Configuration ========================== */
 
 #ifndef RTOS_TOTAL_HEAP_SIZE
 #define RTOS_TOTAL_HEAP_SIZE (16384U) /**< Total heap size for task stacks */
 #endif
 
+/*
+ * RAM region of the kernel's own buffers: a region tag from the board's
+ * memory_map.h (e.g. RTOS_REGION_SRAM2), or empty for the default .bss.
+ * Application objects choose theirs through the _create_static variants.
+ */
+#ifndef RTOS_HEAP_REGION
+#define RTOS_HEAP_REGION /**< rtos_malloc() heap */
+#endif
+
+#ifndef RTOS_TCB_POOL_REGION
+#define RTOS_TCB_POOL_REGION /**< Hot TCB parts; the cold extensions stay in .bss */
+#endif
+
+#ifndef RTOS_KERNEL_STACK_REGION
+#define RTOS_KERNEL_STACK_REGION /**< Idle and deferred-work daemon stacks */
+#endif
+
+#ifndef RTOS_DMA_BUFFER_REGION
+#define RTOS_DMA_BUFFER_REGION /**< Log TX ring: must be reachable by the DMA controller */
+#endif
+
+/*
+ * Code placement for the context-switch path (PendSV and the kernel switch),
+ * e.g. an ITCM section on Cortex-M7 boards. RTOS_FAST_CODE_IN_ITCM tells the
+ * port to copy the .itcm_text section from flash before main().
+ */
+#ifndef RTOS_FAST_CODE
+#define RTOS_FAST_CODE /**< Empty: run from flash */
+#endif
+
+#ifndef RTOS_FAST_CODE_IN_ITCM
+#define RTOS_FAST_CODE_IN_ITCM (0U)
+#endif
+
 /* ======================== Debug Configuration =========================== */
 
 #ifndef RTOS_ASSERT_ENABLED
@@ -81,4 +378,27 @@
 #define RTOS_ENABLE_STACK_OVERFLOW_CHECK (1U)
 #endif
 
+#ifndef RTOS_ENABLE_STACK_WATERMARK
+#define RTOS_ENABLE_STACK_WATERMARK (1U) /**< Paint stacks at create; the idle task measures their high-water mark */
+#endif
+
+#ifndef RTOS_STACK_SCAN_WORDS
+#define RTOS_STACK_SCAN_WORDS (32U) /**< Stack words the idle task checks per loop */
+#endif
+
+/*
+ * MPU stack guard: each switch moves one no-access MPU region onto the
+ * bottom RTOS_STACK_GUARD_SIZE bytes of the incoming task's stack, so an
+ * overflow faults (MemManage) at the first write instead of being found
+ * later by the canary check. The guard is carved from the task's own stack
+ * and costs it up to 2 * RTOS_STACK_GUARD_SIZE bytes.
+ */
+#ifndef RTOS_STACK_GUARD_MPU
+#define RTOS_STACK_GUARD_MPU (0U) /**< 1 = MPU guard region below the running task's stack */
+#endif
+
+#ifndef RTOS_STACK_GUARD_SIZE
+#define RTOS_STACK_GUARD_SIZE (32U) /**< Guard region size in bytes, power of 2 >= 32 */
+#endif
+
 #endif /* RTOS_CONFIG_H */
@@ -0,0 +1,228 @@
+#ifndef RTOS_COROUTINE_H
+#define RTOS_COROUTINE_H
+
+#include "VRTOS.h"
+#include "queue.h"
+#include "queue_set.h"
+#include "rtos_types.h"
+#include "semaphore.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @file coroutine.h
+ * @brief Stackless coroutines run by a cooperative loop inside one task
+ *
+ * A coroutine is a function that resumes where it last waited, using the
+ * switch-based protothread scheme: the resume point is the source line of
+ * the last RTOS_CO_* wait. All coroutines of a scheduler share the stack of
+ * the task that runs rtos_coroutine_sched_task(), so each one costs only its
+ * rtos_coroutine_t (20 bytes on Cortex-M) instead of a TCB and a stack.
+ *
+ *     static rtos_coroutine_result_t blink(rtos_coroutine_t *co)
+ *     {
+ *         RTOS_CO_BEGIN(co);
+ *         for (;;)
+ *         {
+ *             RTOS_CO_QUEUE_RECEIVE(co, cmd_queue, &g_cmd);
+ *             led_toggle();
+ *             RTOS_CO_DELAY(co, 100);
+ *         }
+ *         RTOS_CO_END(co);
+ *     }
+ *
+ * Rules that follow from having no stack of their own:
+ *   - Local variables do not survive a wait; keep state in statics or in a
+ *     structure that embeds the rtos_coroutine_t (reach it via ->parameter).
+ *   - RTOS_CO_* waits may only appear in the coroutine function itself, not
+ *     in functions it calls, and at most one per source line.
+ *   - No switch statement may span a wait.
+ *   - Never call a blocking RTOS API: it stalls every coroutine of the loop.
+ *
+ * The run loop sleeps on a queue set. Queues and semaphores the coroutines
+ * wait on are added with rtos_coroutine_sched_watch_queue() / _semaphore()
+ * and wake it when they become ready; delays set its timeout; anything else
+ * (a software timer callback, another task, an ISR) wakes it with
+ * rtos_coroutine_sched_wake(). Each wakeup re-polls every waiting
+ * coroutine, and passes repeat until none makes progress.
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief What a coroutine function returned to the run loop
+ */
+typedef enum
+{
+    RTOS_COROUTINE_WAITING = 0, /**< Blocked in an RTOS_CO_* wait */
+    RTOS_COROUTINE_YIELDED,     /**< Ready, ran again on the next pass */
+    RTOS_COROUTINE_ENDED        /**< Reached RTOS_CO_END / RTOS_CO_EXIT; unlinked */
+} rtos_coroutine_result_t;
+
+typedef struct rtos_coroutine rtos_coroutine_t;
+
+/** Coroutine body; must start with RTOS_CO_BEGIN and end with RTOS_CO_END */
+typedef rtos_coroutine_result_t (*rtos_coroutine_fn_t)(rtos_coroutine_t *co);
+
+/* rtos_coroutine_t.flags */
+#define RTOS_COROUTINE_FLAG_LINKED   (1U << 0) /**< On a scheduler list */
+#define RTOS_COROUTINE_FLAG_PROGRESS (1U << 1) /**< Passed a wait during this call */
+#define RTOS_COROUTINE_FLAG_DELAYED  (1U << 2) /**< Waiting for wake_tick */
+
+/**
+ * @brief Coroutine control block
+ */
+struct rtos_coroutine
+{
+    rtos_coroutine_fn_t    function;  /**< Body */
+    void                  *parameter; /**< User data */
+    struct rtos_coroutine *next;      /**< Scheduler list link */
+    rtos_tick_t            wake_tick; /**< RTOS_CO_DELAY deadline */
+    uint16_t               resume;    /**< __LINE__ of the last wait, 0 = start */
+    uint8_t                flags;     /**< RTOS_COROUTINE_FLAG_* */
+};
+
+/**
+ * @brief Coroutine scheduler: the coroutine list and the set its task sleeps on
+ */
+typedef struct rtos_coroutine_sched
+{
+    rtos_coroutine_t  *head; /**< Linked coroutines, newest first */
+    rtos_task_handle_t task; /**< Task running the loop, NULL until it starts */
+    rtos_queue_set_t   set;  /**< Watched members plus the task's notification */
+} rtos_coroutine_sched_t;
+
+/**
+ * @brief Initialize an empty scheduler
+ * @return RTOS_SUCCESS, or RTOS_ERROR_INVALID_PARAM
+ */
+rtos_status_t rtos_coroutine_sched_init(rtos_coroutine_sched_t *sched);
+
+/*
+ * Wake the loop whenever the queue / semaphore becomes ready. It joins the
+ * scheduler's queue set, so it cannot be in another set; fails as
+ * rtos_queue_set_add_queue() / _add_semaphore() do. Add before the loop
+ * starts.
+ */
+rtos_status_t rtos_coroutine_sched_watch_queue(rtos_coroutine_sched_t *sched, rtos_queue_handle_t queue);
+rtos_status_t rtos_coroutine_sched_watch_semaphore(rtos_coroutine_sched_t *sched, rtos_semaphore_t *sem);
+
+/**
+ * @brief Run loop, as the body of a normal task (parameter = the scheduler)
+ *
+ *     rtos_task_create(rtos_coroutine_sched_task, "Coro", RTOS_DEFAULT_TASK_STACK_SIZE,
+ *                      &sched, 2, &handle);
+ *
+ * The task stack must hold the deepest coroutine call chain. Never returns.
+ */
+__attribute__((__noreturn__)) void rtos_coroutine_sched_task(void *param);
+
+/**
+ * @brief Make the loop re-poll its coroutines (task context)
+ *
+ * For waits on conditions the queue set does not see. Safe before the
+ * loop starts (its first pass polls everything anyway).
+ */
+void rtos_coroutine_sched_wake(rtos_coroutine_sched_t *sched);
+
+/*
+ * ISR variant. *higher_priority_task_woken is set to true (never cleared)
+ * when the loop task should preempt the interrupted task; call
+ * rtos_port_yield() once at exit if it is set. May be NULL.
+ */
+void rtos_coroutine_sched_wake_from_isr(rtos_coroutine_sched_t *sched, bool *higher_priority_task_woken);
+
+/**
+ * @brief Start a coroutine from the top on a scheduler
+ *
+ * Callable from any task, including a coroutine of the same scheduler;
+ * the coroutine first runs on the loop's next pass. co must be zeroed
+ * (static storage) before its first start; an ended one may be restarted.
+ *
+ * @return RTOS_SUCCESS, RTOS_ERROR_INVALID_PARAM, or
+ *         RTOS_ERROR_INVALID_STATE if the coroutine is still linked
+ */
+rtos_status_t rtos_coroutine_start(rtos_coroutine_sched_t *sched, rtos_coroutine_t *co, rtos_coroutine_fn_t function,
+                                   void *parameter);
+
+/**
+ * @brief True once the coroutine has ended (or was never started)
+ */
+bool rtos_coroutine_is_done(const rtos_coroutine_t *co);
+
+/** Used by RTOS_CO_DELAY: true once wake_tick is reached, else marks the coroutine delayed */
+bool rtos_coroutine_delay_expired(rtos_coroutine_t *co);
+
+/* ======================== Coroutine Body Macros ========================== */
+
+/** First statement of a coroutine body */
+#define RTOS_CO_BEGIN(co)                                                                                              \
+    switch ((co)->resume)                                                                                              \
+    {                                                                                                                  \
+    case 0:
+
+/** Last statement of a coroutine body: the coroutine ends and is unlinked */
+#define RTOS_CO_END(co)                                                                                                \
+    }                                                                                                                  \
+    (co)->resume = 0U;                                                                                                 \
+    return RTOS_COROUTINE_ENDED
+
+/** End the coroutine from anywhere in its body */
+#define RTOS_CO_EXIT(co)                                                                                               \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        (co)->resume = 0U;                                                                                             \
+        return RTOS_COROUTINE_ENDED;                                                                                   \
+    } while (0)
+
+/** Let the other coroutines run; resume on the next pass */
+#define RTOS_CO_YIELD(co)                                                                                              \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        (co)->resume = (uint16_t) __LINE__;                                                                            \
+        return RTOS_COROUTINE_YIELDED;                                                                                 \
+    case __LINE__:;                                                                                                    \
+    } while (0)
+
+/**
+ * Wait until cond is true; cond is re-evaluated on every pass. It must be
+ * made true by a watched member, a delay, another coroutine of the same
+ * loop, or be followed by rtos_coroutine_sched_wake().
+ */
+#define RTOS_CO_AWAIT(co, cond)                                                                                        \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        (co)->resume = (uint16_t) __LINE__;                                                                            \
+        __attribute__((__fallthrough__));                                                                              \
+    case __LINE__:                                                                                                     \
+        if (!(cond))                                                                                                   \
+        {                                                                                                              \
+            return RTOS_COROUTINE_WAITING;                                                                             \
+        }                                                                                                              \
+        (co)->flags |= RTOS_COROUTINE_FLAG_PROGRESS;                                                                   \
+    } while (0)
+
+/** Wait for the given number of ticks */
+#define RTOS_CO_DELAY(co, ticks)                                                                                       \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        (co)->wake_tick = rtos_get_tick_count() + (rtos_tick_t) (ticks);                                               \
+        RTOS_CO_AWAIT((co), rtos_coroutine_delay_expired(co));                                                         \
+    } while (0)
+
+/** Wait for an item and copy it to buffer (the queue should be watched) */
+#define RTOS_CO_QUEUE_RECEIVE(co, queue, buffer)                                                                       \
+    RTOS_CO_AWAIT((co), rtos_queue_receive((queue), (buffer), 0U) == RTOS_SUCCESS)
+
+/** Wait for a semaphore count (the semaphore should be watched) */
+#define RTOS_CO_SEMAPHORE_TAKE(co, sem) RTOS_CO_AWAIT((co), rtos_semaphore_try_wait(sem) == RTOS_SEM_OK)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RTOS_COROUTINE_H */
@@ -0,0 +1,57 @@
+#ifndef RTOS_DEFERRED_H
+#define RTOS_DEFERRED_H
+
+#include "rtos_types.h"
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Deferred work function type
+ * @param parameter Argument given to rtos_deferred_post()
+ *
+ * Runs in the deferred daemon task (RTOS_DEFERRED_TASK_PRIORITY), in the
+ * order the work was posted, interleaved with software-timer callbacks.
+ * It may call any non-blocking RTOS API; blocking stalls every later work
+ * item and timer.
+ */
+typedef void (*rtos_deferred_fn_t)(void *parameter);
+
+/**
+ * @brief Queue a function for the deferred daemon (task context)
+ *
+ * Lock-free: never blocks and never masks interrupts while queuing. Wakes
+ * the daemon, which preempts the caller at once when it has the higher
+ * priority.
+ *
+ * @param function  Function to run
+ * @param parameter Argument passed to it
+ * @return RTOS_SUCCESS, RTOS_ERROR_INVALID_PARAM, RTOS_ERROR_FULL when
+ *         RTOS_DEFERRED_QUEUE_LENGTH items are pending, or
+ *         RTOS_ERROR_INVALID_STATE when RTOS_USE_DEFERRED_WORK is 0
+ */
+rtos_status_t rtos_deferred_post(rtos_deferred_fn_t function, void *parameter);
+
+/*
+ * ISR variant: same queue, no context switch inside the handler.
+ * *higher_priority_task_woken is set to true (never cleared) when the daemon
+ * should preempt the interrupted task; call rtos_port_yield() once at exit
+ * if it is set. May be NULL.
+ */
+rtos_status_t rtos_deferred_post_from_isr(rtos_deferred_fn_t function, void *parameter,
+                                          bool *higher_priority_task_woken);
+
+/**
+ * @brief Work items rejected because the queue was full, since rtos_init()
+ */
+uint32_t rtos_deferred_get_overflows(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RTOS_DEFERRED_H */
@@ -2,10 +2,11 @@
 #define EVENT_GROUP_H
 
 #include "rtos_types.h"
+#include "wait_queue.h"
 
 /**
  * @file event_group.h
- * @brief Event Group (Event Flags) API
+ * @brief Event Group (Event Flags) API (RTOS_USE_EVENT_GROUPS)
  *
  * Provides multi-event synchronization where tasks can wait for any or all
  * of a set of bits. Multiple tasks may wait on the same event group with
@@ -39,8 +40,10 @@ typedef enum
  */
 typedef struct rtos_event_group
 {
-    uint32_t                        bits;         /**< Current event bits */
-    struct rtos_task_control_block *waiting_list; /**< Head of waiting task list (priority-ordered) */
+    uint32_t          bits;         /**< Current event bits */
+    uint32_t          waited_bits;  /**< Union of the waiters' bits (may over-approximate) */
+    uint32_t          wake_pending; /**< 1 = set_bits_from_isr queued a deferred wake */
+    rtos_wait_queue_t waiters;      /**< Tasks blocked in wait_bits, by priority */
 } rtos_event_group_t;
 
 /**
@@ -68,7 +71,8 @@ rtos_eg_status_t rtos_event_group_wait_bits(rtos_event_group_t *eg, uint32_t bit
  *
  * Sets the specified bits and wakes all waiting tasks whose conditions
  * are now satisfied. Bits requested for clear-on-exit are cleared after
- * all waiters have been checked (deferred clear).
+ * all waiters have been checked (deferred clear). Setting bits no waiter
+ * asks for does not visit the waiters.
  *
  * @param eg Pointer to event group
  * @param bits_to_set Bitmask of bits to set
@@ -78,11 +82,50 @@ rtos_eg_status_t rtos_event_group_set_bits(rtos_event_group_t *eg, uint32_t bits
 
 /**
  * @brief Set bits in an event group (ISR-safe)
+ *
+ * With RTOS_USE_DEFERRED_WORK the ISR only ORs the bits in (LDREX/STREX, no
+ * interrupt masking) and, if some waiter asks for one of them, queues a
+ * single wake for the deferred daemon, which matches and unblocks the
+ * waiters in task context. Waiters are matched against the bits as they
+ * stand when the daemon runs, so a clear_bits() in between can hide the
+ * event. Without the daemon, or with RTOS_SMP_CORES > 1, the waiters are
+ * walked here.
+ *
  * @param eg Pointer to event group
  * @param bits_to_set Bitmask of bits to set
+ * @param higher_priority_task_woken Set to true (never cleared) when the
+ *        daemon or a woken task should preempt the interrupted one; call
+ *        rtos_port_yield() once at ISR exit if it is set. May be NULL.
  * @return RTOS_EG_OK on success
  */
-rtos_eg_status_t rtos_event_group_set_bits_from_isr(rtos_event_group_t *eg, uint32_t bits_to_set);
+rtos_eg_status_t rtos_event_group_set_bits_from_isr(rtos_event_group_t *eg, uint32_t bits_to_set,
+                                                    bool *higher_priority_task_woken);
+
+/**
+ * @brief Set bits and wait for a set of bits in one step (task barrier)
+ *
+ * Each participant sets its own bit and waits for all of bits_to_wait. The
+ * set, the check and the block happen in one critical section, so a
+ * participant never wakes just to block again. The last to arrive finds the
+ * condition met and does not block: it releases every waiter whose
+ * condition is now satisfied, clears bits_to_wait (together with the
+ * waiters' clear-on-exit bits) and reschedules once for all of them.
+ * Waiters behave as wait_bits(wait_all = true, clear_on_exit = true).
+ *
+ * On a timeout the caller's bits stay set, since the barrier did not
+ * complete; clear them before the group is reused.
+ *
+ * @param eg Pointer to event group
+ * @param bits_to_set Bits this participant sets (usually its own)
+ * @param bits_to_wait Bits of all participants (non-zero)
+ * @param bits_out If non-NULL, receives the bits at the moment the barrier
+ *        completed (before the clear)
+ * @param timeout_ticks Timeout in ticks (0 = no wait, RTOS_EG_MAX_WAIT = forever)
+ * @return RTOS_EG_OK when all bits were set, RTOS_EG_ERR_TIMEOUT if timed out,
+ *         RTOS_EG_ERR_INVALID for NULL, bits_to_wait == 0 or no current task
+ */
+rtos_eg_status_t rtos_event_group_sync(rtos_event_group_t *eg, uint32_t bits_to_set, uint32_t bits_to_wait,
+                                       uint32_t *bits_out, rtos_tick_t timeout_ticks);
 
 /**
  * @brief Clear bits in an event group
@@ -0,0 +1,150 @@
+#ifndef HRTIMER_H
+#define HRTIMER_H
+
+#include "rtos_types.h"
+
+#include <stdbool.h>
+
+/**
+ * @file hrtimer.h
+ * @brief Microsecond High-Resolution Timer API (RTOS_USE_HRTIMER)
+ *
+ * Software timers with 1 us resolution for protocol timeouts and short
+ * delays that the 1 ms tick cannot express.  They run off a free-running
+ * 32-bit hardware counter at 1 MHz with one output-compare channel (TIM5 on
+ * the Nucleo boards, a host timer on the POSIX port), set up by the board's
+ * hardware_env_hrtimer_*() hooks.
+ *
+ * Armed timers sit in a binary min-heap ordered by expiry, and the compare
+ * register always holds the earliest one, so arming or stopping a timer is
+ * O(log n) and there is one interrupt per expiry instead of a periodic
+ * poll.  Expiries compare by signed difference, so delays and periods are
+ * limited to RTOS_HRTIMER_MAX_DELAY_US.
+ *
+ * A callback runs either in the compare interrupt (at kernel priority, in
+ * the same context as a _from_isr API) or in the deferred daemon task
+ * (RTOS_USE_DEFERRED_WORK).  Timer objects are caller-owned and must stay
+ * valid while armed.
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Longest delay or period; within half the counter range of every other expiry */
+#define RTOS_HRTIMER_MAX_DELAY_US (1UL << 30)
+
+/**
+ * @brief Where a timer's callback runs
+ */
+typedef enum
+{
+    RTOS_HRTIMER_DISPATCH_ISR    = 0, /**< In the compare interrupt: must not block */
+    RTOS_HRTIMER_DISPATCH_DAEMON = 1, /**< Posted to the deferred daemon task */
+} rtos_hrtimer_dispatch_t;
+
+struct rtos_hrtimer;
+
+/**
+ * @brief Timer callback
+ *
+ * From the interrupt, a callback that readies a task through a _from_isr API
+ * calls rtos_port_yield() if that task should run next.  It may re-arm or
+ * stop any timer, including its own, with the _from_isr calls.
+ */
+typedef void (*rtos_hrtimer_callback_t)(struct rtos_hrtimer *timer, void *parameter);
+
+/**
+ * @brief High-resolution timer (fields are private; use the API)
+ */
+typedef struct rtos_hrtimer
+{
+    uint32_t                expiry;     /**< Counter value to fire at */
+    uint32_t                period;     /**< Re-arm interval in us, 0 = one-shot */
+    rtos_hrtimer_callback_t callback;   /**< NULL for rtos_delay_us() wake-ups */
+    void                   *parameter;  /**< Callback argument, or the task to wake */
+    uint32_t                overruns;   /**< Periods skipped because the callback fell behind */
+    uint8_t                 heap_index; /**< Position in the heap, or idle */
+    uint8_t                 dispatch;   /**< rtos_hrtimer_dispatch_t */
+} rtos_hrtimer_t;
+
+/**
+ * @brief Initialize a stopped timer
+ * @return RTOS_SUCCESS, or RTOS_ERROR_INVALID_PARAM (no callback, or
+ *         RTOS_HRTIMER_DISPATCH_DAEMON without RTOS_USE_DEFERRED_WORK)
+ */
+rtos_status_t rtos_hrtimer_init(rtos_hrtimer_t *timer, rtos_hrtimer_callback_t callback, void *parameter,
+                                rtos_hrtimer_dispatch_t dispatch);
+
+/**
+ * @brief Arm (or re-arm) a timer from a task
+ *
+ * Fires delay_us after now, then every period_us after each previous
+ * expiry, without drift.  A periodic timer whose callback falls more than a
+ * period behind skips to the next period from now and counts an overrun.
+ *
+ * @param delay_us  First expiry, 1 .. RTOS_HRTIMER_MAX_DELAY_US
+ * @param period_us 0 = one-shot, else up to RTOS_HRTIMER_MAX_DELAY_US
+ * @return RTOS_SUCCESS, RTOS_ERROR_INVALID_PARAM, or RTOS_ERROR_FULL when
+ *         RTOS_HRTIMER_MAX_TIMERS timers are already armed
+ */
+rtos_status_t rtos_hrtimer_start(rtos_hrtimer_t *timer, uint32_t delay_us, uint32_t period_us);
+
+/**
+ * @brief rtos_hrtimer_start() for ISRs at kernel priority and ISR callbacks
+ */
+rtos_status_t rtos_hrtimer_start_from_isr(rtos_hrtimer_t *timer, uint32_t delay_us, uint32_t period_us);
+
+/**
+ * @brief Disarm a timer from a task
+ *
+ * A daemon callback already posted for an earlier expiry still runs.
+ *
+ * @return RTOS_SUCCESS (also if it was not armed), or RTOS_ERROR_INVALID_PARAM
+ */
+rtos_status_t rtos_hrtimer_stop(rtos_hrtimer_t *timer);
+
+/**
+ * @brief rtos_hrtimer_stop() for ISRs at kernel priority and ISR callbacks
+ */
+rtos_status_t rtos_hrtimer_stop_from_isr(rtos_hrtimer_t *timer);
+
+/**
+ * @brief True while the timer is armed
+ */
+bool rtos_hrtimer_is_active(const rtos_hrtimer_t *timer);
+
+/**
+ * @brief Current value of the 1 MHz counter; wraps every 71.6 minutes
+ */
+uint32_t rtos_hrtimer_now(void);
+
+/**
+ * @brief Block the calling task for at least us microseconds
+ *
+ * The task sleeps on a one-shot timer instead of spinning, so lower
+ * priority tasks run meanwhile; it becomes ready in the compare interrupt.
+ * A task suspended and resumed during the delay returns early.
+ *
+ * @param us 0 returns at once; at most RTOS_HRTIMER_MAX_DELAY_US
+ * @return RTOS_SUCCESS, RTOS_ERROR_INVALID_PARAM, RTOS_ERROR_FULL, or
+ *         RTOS_ERROR_INVALID_STATE outside a task
+ */
+rtos_status_t rtos_delay_us(uint32_t us);
+
+/**
+ * @brief Start the hardware counter with no timer armed (called by rtos_init)
+ */
+void rtos_hrtimer_init_system(void);
+
+/**
+ * @brief Run expired timers and reprogram the compare (called by the board's compare interrupt)
+ */
+void rtos_hrtimer_isr(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HRTIMER_H */
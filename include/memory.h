@@ -1,9 +1,30 @@
 #ifndef MEMORY_H
 #define MEMORY_H
 
+#include "rtos_types.h"
+
 #include <stddef.h>
 #include <stdint.h>
 
+/**
+ * @brief Heap usage statistics
+ *
+ * Byte counts include the per-block header, so free_bytes can exceed the
+ * largest single allocation even with no fragmentation.  rtos_malloc rounds
+ * requests up to the next size class (1/16 of a power of two), so a request
+ * close to largest_free_block may still fail.
+ */
+typedef struct
+{
+    size_t   total_bytes;        /**< Heap capacity */
+    size_t   free_bytes;         /**< Bytes currently free */
+    size_t   largest_free_block; /**< Payload size of the largest free block */
+    size_t   peak_used_bytes;    /**< High-water mark of bytes in use */
+    uint32_t alloc_count;        /**< Successful allocations */
+    uint32_t free_count;         /**< Successful frees */
+    uint32_t failed_count;       /**< Allocations that returned NULL */
+} rtos_memory_stats_t;
+
 /**
  * @brief Initialize memory manager
  */
@@ -12,16 +33,26 @@ void rtos_memory_init(void);
 /**
  * @brief Allocate memory from the heap
  *
+ * Bounded O(1) (TLSF). Returns 8-byte aligned memory. Not ISR-safe.
+ *
  * @param size Size in bytes
  * @return void* Pointer to allocated memory or NULL
  */
 void *rtos_malloc(size_t size);
 
 /**
- * @brief Free memory (Not implemented in simple bump allocator)
+ * @brief Return memory to the heap, merging with free neighbours
  *
- * @param ptr Pointer to memory
+ * @param ptr Pointer from rtos_malloc (NULL is ignored)
  */
 void rtos_free(void *ptr);
 
+/**
+ * @brief Get heap usage statistics
+ *
+ * @param stats Output structure
+ * @return RTOS_SUCCESS, or RTOS_ERROR_INVALID_PARAM if stats is NULL
+ */
+rtos_status_t rtos_memory_get_stats(rtos_memory_stats_t *stats);
+
 #endif // MEMORY_H
@@ -0,0 +1,102 @@
+#ifndef MEMPOOL_H
+#define MEMPOOL_H
+
+#include "rtos_types.h"
+#include "wait_queue.h"
+
+/**
+ * @file mempool.h
+ * @brief Fixed-Block Memory Pool API
+ *
+ * Carves a caller-provided static buffer into equal-size blocks kept on an
+ * intrusive free list. Alloc and free are O(1) under a short BASEPRI
+ * critical section and have ISR variants, unlike rtos_malloc().
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Forward declaration for TCB */
+struct rtos_task_control_block;
+
+/** Block stride for a requested payload size (8-byte aligned, room for the free-list link) */
+#define RTOS_MEMPOOL_BLOCK_SIZE(size) ((((size) < sizeof(void *) ? sizeof(void *) : (size)) + 7U) & ~(size_t) 7U)
+
+/** Bytes of storage needed for `count` blocks of `size` bytes */
+#define RTOS_MEMPOOL_BUFFER_SIZE(size, count) (RTOS_MEMPOOL_BLOCK_SIZE(size) * (count))
+
+/**
+ * @brief Memory pool structure
+ */
+typedef struct rtos_mempool
+{
+    uint8_t                        *buffer;         /**< Start of block storage */
+    size_t                          block_size;     /**< Block stride in bytes */
+    uint32_t                        block_count;    /**< Total blocks */
+    void                           *free_list;      /**< Head of free-block list */
+    uint32_t                        free_count;     /**< Blocks currently free */
+    uint32_t                        min_free_count; /**< Low-water mark of free_count */
+    uint32_t                        fail_count;     /**< Allocations that found the pool empty */
+    rtos_wait_queue_t               waiters;        /**< Tasks blocked in alloc, by priority */
+} rtos_mempool_t;
+
+/**
+ * @brief Memory pool statistics
+ */
+typedef struct
+{
+    size_t   block_size;    /**< Block stride in bytes */
+    uint32_t block_count;   /**< Total blocks */
+    uint32_t free_count;    /**< Blocks currently free */
+    uint32_t peak_used;     /**< High-water mark of blocks in use */
+    uint32_t fail_count;    /**< Allocations that found the pool empty */
+} rtos_mempool_stats_t;
+
+/**
+ * @brief Initialize a memory pool
+ * @param pool Pointer to pool structure
+ * @param buffer 8-byte aligned storage of RTOS_MEMPOOL_BUFFER_SIZE(block_size, block_count) bytes
+ * @param block_size Payload size of each block in bytes
+ * @param block_count Number of blocks
+ * @return RTOS_SUCCESS, or RTOS_ERROR_INVALID_PARAM
+ */
+rtos_status_t rtos_mempool_init(rtos_mempool_t *pool, void *buffer, size_t block_size, uint32_t block_count);
+
+/**
+ * @brief Allocate a block, blocking while the pool is empty
+ * @param pool Pointer to pool
+ * @param timeout_ticks 0 = no wait, RTOS_MAX_DELAY = forever
+ * @return Block pointer, or NULL on timeout
+ */
+void *rtos_mempool_alloc(rtos_mempool_t *pool, rtos_tick_t timeout_ticks);
+
+/**
+ * @brief Allocate a block from an ISR (never blocks)
+ * @return Block pointer, or NULL if the pool is empty
+ */
+void *rtos_mempool_alloc_from_isr(rtos_mempool_t *pool);
+
+/**
+ * @brief Return a block to its pool, waking the highest-priority waiter
+ * @return RTOS_SUCCESS, or RTOS_ERROR_INVALID_PARAM if block is not from this pool
+ */
+rtos_status_t rtos_mempool_free(rtos_mempool_t *pool, void *block);
+
+/**
+ * @brief Return a block to its pool from an ISR
+ */
+rtos_status_t rtos_mempool_free_from_isr(rtos_mempool_t *pool, void *block);
+
+/**
+ * @brief Get pool usage statistics
+ * @return RTOS_SUCCESS, or RTOS_ERROR_INVALID_PARAM
+ */
+rtos_status_t rtos_mempool_get_stats(rtos_mempool_t *pool, rtos_mempool_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MEMPOOL_H */
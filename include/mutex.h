@@ -2,6 +2,7 @@
 #define MUTEX_H
 
 #include "rtos_types.h"
+#include "wait_queue.h"
 
 /**
  * @file mutex.h
@@ -29,10 +30,12 @@ typedef enum
 /* Minimal mutex structure. Keep fields intentionally small and extendable. */
 typedef struct rtos_mutex
 {
-    rtos_tcb_t         *owner;        /* current owner TCB (NULL if unlocked) */
-    rtos_tcb_t         *waiting_list; /* singly-linked list of waiting TCBs (uses tcb->next_waiting) */
-    struct rtos_mutex  *next_held;    /* next mutex in owner's held-mutex chain */
-    uint8_t             lock_count;   /* recursion depth for owner (future use) */
+    rtos_tcb_t         *owner;      /* current owner TCB (NULL if unlocked) */
+    rtos_wait_queue_t   waiters;    /* tasks blocked in lock, by priority (see wait_queue.h) */
+    struct rtos_mutex  *next_held;  /* next mutex in owner's held-mutex chain */
+    uint8_t             lock_count; /* recursion depth for owner, 1..255 while locked */
+    rtos_priority_t     ceiling;    /* priority ceiling (rtos_mutex_init_ceiling), 0 = inheritance */
+    bool                rwlock_writer; /* write side of an rtos_rwlock_t: its read waiters count too */
 } rtos_mutex_t;
 
 /**
@@ -42,8 +45,29 @@ typedef struct rtos_mutex
  */
 rtos_mutex_status_t rtos_mutex_init(rtos_mutex_t *m);
 
+/**
+ * Initialize a priority-ceiling mutex (immediate ceiling protocol).
+ *
+ * The owner runs at the ceiling from the moment it locks until it unlocks:
+ * one priority write on lock, no owner-chain walk when others contend. On
+ * a single core no task that also locks m can run in between, so the lock
+ * is never contended and tasks that nest ceiling mutexes cannot deadlock,
+ * as long as the owner does not block while holding it.
+ *
+ * @param m Pointer to mutex object (non-NULL)
+ * @param ceiling Highest base priority of any task that locks m
+ *                (1 to RTOS_MAX_TASK_PRIORITIES - 1)
+ * @return RTOS_MUTEX_OK on success, RTOS_MUTEX_ERR_INVALID otherwise. A lock
+ *         by a task whose base priority is above the ceiling also fails with
+ *         RTOS_MUTEX_ERR_INVALID.
+ */
+rtos_mutex_status_t rtos_mutex_init_ceiling(rtos_mutex_t *m, rtos_priority_t ceiling);
+
 /**
  * Lock/Acquire mutex. Blocks the calling task until mutex acquired or timeout expires.
+ * Mutexes are recursive: the owner may lock again (up to 255 levels) and must
+ * unlock as many times. Re-entry only bumps the count, with no atomic or
+ * critical section.
  * @param m Pointer to mutex object
  * @param timeout_ticks Timeout in system ticks. 0 means try-once (non-blocking).
  *                      (use (rtos_tick_t)-1 to wait effectively forever)
@@ -0,0 +1,182 @@
+#ifndef NETBUF_H
+#define NETBUF_H
+
+#include "mempool.h"
+#include "rtos_types.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file netbuf.h
+ * @brief Chained Packet Buffers with Header Room and Scatter-Gather Export
+ *
+ * A packet is a chain of fixed-size segments from an ISR-safe pool, in the
+ * style of lwIP pbufs. Each layer of a protocol stack works on the same
+ * chain in place:
+ *   - rtos_netbuf_alloc() leaves `reserve` bytes free in front of the first
+ *     segment's data; rtos_netbuf_push() claims them to prepend a header.
+ *   - rtos_netbuf_pull() hides a header on receive.
+ *   - rtos_netbuf_cat() links a header chain in front of a payload chain.
+ *
+ * rtos_netbuf_to_sg() turns a chain into (address, length) entries, one
+ * per non-empty segment, for a DMA driver that programs one transfer per
+ * entry from its transfer-complete interrupt (the F4/F7/H7 DMA streams have
+ * no hardware descriptor lists). rtos_netbuf_clean_dcache() writes the
+ * chain back from the data cache before a TX transfer.
+ *
+ * A chain head is one pointer, so any queue with pointer-sized items, the
+ * zero-copy slots included, hands a packet over without copying it:
+ *
+ *     void *slot;
+ *     rtos_queue_send_acquire(tx_queue, &slot, RTOS_MAX_DELAY);
+ *     *(rtos_netbuf_t **) slot = pkt;
+ *     rtos_queue_send_commit(tx_queue);
+ *
+ * Every segment counts its references, so a segment may sit in several
+ * chains, e.g. one payload behind two different headers. Freeing a chain
+ * drops a reference on each segment from the head and stops at the first
+ * that is still referenced, as the rest of the chain belongs to it.
+ * Packets are at most 65535 bytes.
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+struct rtos_netbuf_pool;
+
+/**
+ * @brief Segment header; its data area follows in the same block
+ */
+typedef struct rtos_netbuf
+{
+    struct rtos_netbuf      *next;    /**< Next segment of the packet, NULL = last */
+    uint8_t                 *payload; /**< First valid byte */
+    struct rtos_netbuf_pool *pool;    /**< Pool the block came from */
+    uint16_t                 len;     /**< Valid bytes in this segment */
+    uint16_t                 tot_len; /**< Valid bytes in this and all following segments */
+    volatile uint8_t         refs;    /**< Chains and holders of this segment */
+} rtos_netbuf_t;
+
+/** Header bytes in front of a segment's data area (8-byte aligned data) */
+#define RTOS_NETBUF_HEADER_SIZE ((sizeof(rtos_netbuf_t) + 7U) & ~(size_t) 7U)
+
+/** Bytes of storage for `count` segments of `seg_size` data bytes */
+#define RTOS_NETBUF_POOL_BUFFER_SIZE(seg_size, count) (RTOS_MEMPOOL_BUFFER_SIZE(RTOS_NETBUF_HEADER_SIZE + (seg_size), (count)))
+
+/**
+ * @brief Segment pool
+ */
+typedef struct rtos_netbuf_pool
+{
+    rtos_mempool_t blocks;   /**< Segment blocks */
+    uint16_t       seg_size; /**< Data bytes per segment */
+} rtos_netbuf_pool_t;
+
+/**
+ * @brief One contiguous piece of a packet for a DMA transfer
+ */
+typedef struct
+{
+    const void *addr; /**< Start address */
+    uint32_t    len;  /**< Bytes */
+} rtos_netbuf_sg_t;
+
+/**
+ * @brief Initialize a segment pool
+ * @param storage 8-byte aligned, RTOS_NETBUF_POOL_BUFFER_SIZE(seg_size, count) bytes
+ * @return RTOS_SUCCESS, or RTOS_ERROR_INVALID_PARAM
+ */
+rtos_status_t rtos_netbuf_pool_init(rtos_netbuf_pool_t *pool, void *storage, uint16_t seg_size, uint32_t count);
+
+/**
+ * @brief Allocate a chain for a len-byte packet from task context
+ *
+ * The first segment keeps `reserve` bytes of header room in front of the
+ * payload; the chain has as many segments as len then needs. Each segment
+ * has one reference.
+ *
+ * @param reserve Header room, less than the segment size
+ * @param timeout_ticks Wait per segment while the pool is empty; 0 = no wait
+ * @return The chain head, or NULL (no partial chain is left allocated)
+ */
+rtos_netbuf_t *rtos_netbuf_alloc(rtos_netbuf_pool_t *pool, uint16_t len, uint16_t reserve, rtos_tick_t timeout_ticks);
+
+/**
+ * @brief rtos_netbuf_alloc() for ISRs at kernel priority (never waits)
+ */
+rtos_netbuf_t *rtos_netbuf_alloc_from_isr(rtos_netbuf_pool_t *pool, uint16_t len, uint16_t reserve);
+
+/**
+ * @brief Take a reference on a chain's head segment (task or ISR context)
+ */
+void rtos_netbuf_ref(rtos_netbuf_t *nb);
+
+/**
+ * @brief Release a chain from task context
+ *
+ * Drops a reference on each segment from the head, frees the segments that
+ * reach zero and stops at the first one still referenced.
+ *
+ * @return Segments freed
+ */
+uint32_t rtos_netbuf_free(rtos_netbuf_t *nb);
+
+/**
+ * @brief rtos_netbuf_free() for ISRs at kernel priority
+ */
+uint32_t rtos_netbuf_free_from_isr(rtos_netbuf_t *nb);
+
+/**
+ * @brief Prepend n header bytes in the first segment's header room
+ * @return Start of the new header (the new payload), or NULL if the
+ *         segment has less than n bytes of room
+ */
+void *rtos_netbuf_push(rtos_netbuf_t *nb, uint16_t n);
+
+/**
+ * @brief Hide the first n bytes of the first segment (a parsed header)
+ * @return The new payload, or NULL if the segment holds less than n bytes
+ */
+void *rtos_netbuf_pull(rtos_netbuf_t *nb, uint16_t n);
+
+/**
+ * @brief Append chain tail behind chain head; head takes over tail's reference
+ * @return RTOS_SUCCESS, or RTOS_ERROR_INVALID_PARAM (NULL, or over 65535 bytes)
+ */
+rtos_status_t rtos_netbuf_cat(rtos_netbuf_t *head, rtos_netbuf_t *tail);
+
+/**
+ * @brief Number of segments in a chain
+ */
+uint32_t rtos_netbuf_count(const rtos_netbuf_t *nb);
+
+/*
+ * Copy between a chain, starting offset bytes into the packet, and a flat
+ * buffer; for code that needs a contiguous view. Return the bytes copied,
+ * fewer when the packet ends first.
+ */
+uint32_t rtos_netbuf_copy_out(const rtos_netbuf_t *nb, uint32_t offset, void *dst, uint32_t len);
+uint32_t rtos_netbuf_copy_in(rtos_netbuf_t *nb, uint32_t offset, const void *src, uint32_t len);
+
+/**
+ * @brief Describe a chain as scatter-gather entries, one per non-empty segment
+ * @return Entries written, or 0 if the chain needs more than max_entries
+ */
+uint32_t rtos_netbuf_to_sg(const rtos_netbuf_t *nb, rtos_netbuf_sg_t *sg, uint32_t max_entries);
+
+/**
+ * @brief Write a chain's valid bytes back from the D-cache before a TX DMA
+ *
+ * No effect on ports without a data cache.
+ */
+void rtos_netbuf_clean_dcache(const rtos_netbuf_t *nb);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NETBUF_H */
@@ -0,0 +1,84 @@
+#ifndef RTOS_POWER_H
+#define RTOS_POWER_H
+
+#include "rtos_types.h"
+
+#include <stdint.h>
+
+/**
+ * @file power.h
+ * @brief Idle-task sleep-depth selection (RTOS_USE_LOW_POWER)
+ *
+ * With tickless idle, each time the idle task finds nothing to run it asks
+ * rtos_power_select_mode() how deep to sleep before the next delayed-task
+ * or timer deadline:
+ *
+ *   SLEEP    WFI with the core clock running (the port's tickless path)
+ *   STOP     clocks stopped, RAM kept; the board's wake-up timer ends it and
+ *            hardware_env_power_exit() restores the clocks (STM32F4 Stop)
+ *   STANDBY  everything off but the wake-up timer; waking is a reset
+ *
+ * A mode is picked when it is allowed and the idle time covers its
+ * break-even time plus the wake-up latency measured on earlier exits. The
+ * board timer is armed that latency early, so the deadline is still met.
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Sleep depths, shallowest first
+ */
+typedef enum
+{
+    RTOS_POWER_MODE_SLEEP   = 0,
+    RTOS_POWER_MODE_STOP    = 1,
+    RTOS_POWER_MODE_STANDBY = 2,
+    RTOS_POWER_MODE_COUNT
+} rtos_power_mode_t;
+
+/**
+ * @brief Residency and wake-up statistics since rtos_init()
+ */
+typedef struct
+{
+    uint32_t entries[RTOS_POWER_MODE_COUNT];             /**< Sleeps entered per mode */
+    uint32_t residency_ticks[RTOS_POWER_MODE_COUNT];     /**< Ticks spent asleep per mode */
+    uint32_t wake_latency_cycles[RTOS_POWER_MODE_COUNT]; /**< Worst wake-up to clocks-restored */
+    uint32_t refusals;                                   /**< Deep sleeps the board declined */
+} rtos_power_stats_t;
+
+/**
+ * @brief Keep the idle task out of a mode and every deeper one
+ *
+ * Counted: a driver blocks STOP while a transfer whose clock would stop is
+ * in flight and unblocks it when done. Task or ISR context.
+ *
+ * @return RTOS_SUCCESS, or RTOS_ERROR_INVALID_PARAM (SLEEP cannot be blocked)
+ */
+rtos_status_t rtos_power_block(rtos_power_mode_t mode);
+
+/* Undo one rtos_power_block(). RTOS_ERROR_INVALID_STATE if it was not blocked. */
+rtos_status_t rtos_power_unblock(rtos_power_mode_t mode);
+
+/**
+ * @brief Deepest usable mode for an idle period
+ * @param expected_idle_ticks Ticks until the next deadline (RTOS_MAX_DELAY = none)
+ * @return RTOS_POWER_MODE_SLEEP when RTOS_USE_LOW_POWER is 0
+ */
+rtos_power_mode_t rtos_power_select_mode(rtos_tick_t expected_idle_ticks);
+
+/**
+ * @brief Copy the residency and wake-up statistics
+ * @return RTOS_SUCCESS, RTOS_ERROR_INVALID_PARAM, or
+ *         RTOS_ERROR_INVALID_STATE when RTOS_USE_LOW_POWER is 0
+ */
+rtos_status_t rtos_power_get_stats(rtos_power_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RTOS_POWER_H */
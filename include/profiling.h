@@ -13,21 +13,43 @@ extern "C"
 #define RTOS_PROFILING_SYSTEM_ENABLED 1
 #endif
 
+/* Length of the window behind the per-task CPU % from rtos_task_get_runtime_stats() */
+#ifndef RTOS_RUNTIME_WINDOW_MS
+#define RTOS_RUNTIME_WINDOW_MS 1000
+#endif
+
 /* When enabled, user code can use RTOS_USER_PROFILE_START/END macros. */
 #ifndef RTOS_PROFILING_USER_ENABLED
 #define RTOS_PROFILING_USER_ENABLED 1
 #endif
 
+/* Histogram resolution: 2^N linear sub-buckets per power of two (N=2 -> <=25 % bucket width) */
+#ifndef RTOS_PROFILE_HIST_SUB_BITS
+#define RTOS_PROFILE_HIST_SUB_BITS 2
+#endif
+
+/* Values below 2^N get exact buckets; each higher octave up to bit 31 gets 2^N */
+#define RTOS_PROFILE_HIST_BUCKETS ((32U - RTOS_PROFILE_HIST_SUB_BITS + 1U) << RTOS_PROFILE_HIST_SUB_BITS)
+
+/* Log-bucketed sample counts; attach to a stat to get percentiles */
 typedef struct
 {
-    uint32_t    min_cycles;
-    uint32_t    max_cycles;
-    uint32_t    total_cycles; /* Be careful of overflow */
-    uint32_t    count;
-    const char *name;
+    uint32_t buckets[RTOS_PROFILE_HIST_BUCKETS];
+} rtos_profile_hist_t;
+
+typedef struct
+{
+    uint32_t             min_cycles;
+    uint32_t             max_cycles;
+    uint64_t             total_cycles;
+    uint32_t             count;
+    const char          *name;
+    rtos_profile_hist_t *histogram; /* Optional (NULL = min/max/avg only) */
 } rtos_profile_stat_t;
 
-/* Atomic snapshot in both cycles and microseconds — use in tests. */
+/* Atomic snapshot in both cycles and microseconds — use in tests.
+ * Percentiles are the upper edge of the bucket holding that rank (capped at
+ * max), or 0 when the stat has no histogram. */
 typedef struct
 {
     uint32_t min_cycles;
@@ -37,6 +59,12 @@ typedef struct
     uint32_t min_us;
     uint32_t max_us;
     uint32_t avg_us;
+    uint32_t p50_cycles;
+    uint32_t p99_cycles;
+    uint32_t p999_cycles;
+    uint32_t p50_us;
+    uint32_t p99_us;
+    uint32_t p999_us;
 } rtos_profile_snapshot_t;
 
 void rtos_profiling_init(void);
@@ -84,6 +112,33 @@ extern rtos_profile_stat_t g_prof_tick;
 extern rtos_profile_stat_t g_prof_pendsv_full;
 extern rtos_profile_stat_t g_prof_tick_jitter;
 extern rtos_profile_stat_t g_prof_scheduling_latency;
+extern rtos_profile_stat_t g_prof_idle_sleep;     /**< Cycles per tickless sleep */
+extern rtos_profile_stat_t g_prof_idle_wake_late; /**< Cycles from tickless deadline to wake-up */
+extern rtos_profile_stat_t g_prof_pip_walk;       /**< Cycles per owner-chain walk (contended PIP lock) */
+
+/**
+ * Boot profile: DWT cycles of each rtos_init() phase, filled in as they run.
+ * CYCCNT starts at rtos_init() entry, so time before it (clock setup, .bss
+ * clearing) is not included.
+ */
+typedef struct
+{
+    uint32_t klog_cycles;        /**< klog_init() */
+    uint32_t memory_cycles;      /**< rtos_memory_init() */
+    uint32_t task_system_cycles; /**< rtos_task_init_system() */
+    uint32_t scheduler_cycles;   /**< rtos_scheduler_init() */
+    uint32_t port_cycles;        /**< rtos_port_init() */
+    uint32_t idle_create_cycles; /**< Idle task creation */
+    uint32_t deferred_cycles;    /**< Deferred-work daemon creation (RTOS_USE_DEFERRED_WORK) */
+    uint32_t defined_cycles;     /**< RTOS_QUEUE_DEFINE / RTOS_TASK_DEFINE objects (rtos_define.h) */
+    uint32_t init_cycles;        /**< All of rtos_init() */
+    uint32_t first_task_cycles;  /**< rtos_init() entry to first-task dispatch, application setup included */
+} rtos_boot_profile_t;
+
+extern rtos_boot_profile_t g_prof_boot;
+
+/** Ticks spent in tickless sleep; residency = this / tick count */
+extern volatile uint32_t g_prof_idle_sleep_ticks;
 
 /** Global written by PendSV ASM to pass full context switch cycle count to C */
 extern volatile uint32_t g_pendsv_cycles;
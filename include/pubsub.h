@@ -0,0 +1,174 @@
+#ifndef PUBSUB_H
+#define PUBSUB_H
+
+#include "mempool.h"
+#include "queue.h"
+#include "rtos_types.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @file pubsub.h
+ * @brief Topic-Based Publish/Subscribe Bus with Zero-Copy Messages
+ *
+ * A publisher allocates a message from the bus's mempool, fills its payload
+ * in place and publishes it to a topic. The bus pushes the message pointer
+ * onto the queue of every subscriber of that topic, so fan-out costs one
+ * pointer push per subscriber whatever the payload size. Each queued copy
+ * holds a reference; a subscriber releases the message after reading it,
+ * and the last release returns the block to the pool.
+ *
+ *     rtos_bus_msg_t *msg = rtos_bus_alloc(&bus, TOPIC_FRAME, 0);
+ *     sensor_read((frame_t *) RTOS_BUS_MSG_DATA(msg));
+ *     rtos_bus_publish(&bus, msg, 0);
+ *
+ *     rtos_bus_receive(&sub, &msg, RTOS_MAX_DELAY);   // each subscriber
+ *     use(RTOS_BUS_MSG_DATA(msg));
+ *     rtos_bus_release(msg);
+ *
+ * Subscribers are caller-owned, attached once and never detached; a
+ * subscriber with no topics gets nothing. A message is read-only once
+ * published.
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** Topics are 0 .. RTOS_BUS_MAX_TOPICS - 1 (one bit of a subscriber's mask each) */
+#define RTOS_BUS_MAX_TOPICS (32U)
+
+struct rtos_bus;
+
+/**
+ * @brief Message header; the payload follows it in the same block
+ */
+typedef struct rtos_bus_msg
+{
+    struct rtos_bus  *bus;   /**< Owning bus (gives the pool) */
+    uint16_t          topic; /**< Topic published to */
+    volatile uint16_t refs;  /**< Queues and publishers still holding it */
+} rtos_bus_msg_t;
+
+/** Payload of a message, aligned like the header */
+#define RTOS_BUS_MSG_DATA(msg) ((void *) ((rtos_bus_msg_t *) (msg) + 1))
+
+/** Mempool block size for messages carrying `payload` bytes */
+#define RTOS_BUS_BLOCK_SIZE(payload) (sizeof(rtos_bus_msg_t) + (payload))
+
+/**
+ * @brief Subscriber: a queue of message pointers and a topic mask (fields are private)
+ */
+typedef struct rtos_bus_sub
+{
+    rtos_queue_handle_t  queue;    /**< Message pointer queue */
+    rtos_queue_static_t  queue_cb; /**< Its control block */
+    volatile uint32_t    topics;   /**< Bit n = subscribed to topic n */
+    volatile uint32_t    dropped;  /**< Messages lost to a full queue */
+    struct rtos_bus_sub *next;     /**< Bus list link */
+} rtos_bus_sub_t;
+
+/**
+ * @brief Bus: message pool and subscriber list
+ */
+typedef struct rtos_bus
+{
+    rtos_mempool_t *pool; /**< Message blocks */
+    rtos_bus_sub_t *head; /**< Attached subscribers, newest first */
+} rtos_bus_t;
+
+/**
+ * @brief Initialize a bus over a pool of RTOS_BUS_BLOCK_SIZE() blocks
+ * @return RTOS_SUCCESS, or RTOS_ERROR_INVALID_PARAM (NULL, or blocks too
+ *         small for the header)
+ */
+rtos_status_t rtos_bus_init(rtos_bus_t *bus, rtos_mempool_t *pool);
+
+/**
+ * @brief Payload bytes each message of the bus can carry
+ */
+size_t rtos_bus_payload_size(const rtos_bus_t *bus);
+
+/**
+ * @brief Attach a subscriber with a queue over caller storage
+ *
+ * The subscriber starts with no topics. Its queue may be added to a queue
+ * set with rtos_bus_sub_queue().
+ *
+ * @param storage Array of queue_length message pointers
+ * @return RTOS_SUCCESS, RTOS_ERROR_INVALID_PARAM, or as rtos_queue_create_static()
+ */
+rtos_status_t rtos_bus_attach(rtos_bus_t *bus, rtos_bus_sub_t *sub, rtos_bus_msg_t **storage,
+                              uint32_t queue_length);
+
+/*
+ * Add or remove a topic. Takes effect for the next publish; messages
+ * already queued stay. RTOS_ERROR_INVALID_PARAM for a topic past
+ * RTOS_BUS_MAX_TOPICS.
+ */
+rtos_status_t rtos_bus_subscribe(rtos_bus_sub_t *sub, uint16_t topic);
+rtos_status_t rtos_bus_unsubscribe(rtos_bus_sub_t *sub, uint16_t topic);
+
+/**
+ * @brief The subscriber's queue (items are rtos_bus_msg_t *), for queue sets
+ */
+rtos_queue_handle_t rtos_bus_sub_queue(const rtos_bus_sub_t *sub);
+
+/**
+ * @brief Allocate a message for a topic from task context
+ * @param timeout_ticks Wait while the pool is empty; 0 = no wait
+ * @return The message with no references, or NULL (timeout, bad topic)
+ */
+rtos_bus_msg_t *rtos_bus_alloc(rtos_bus_t *bus, uint16_t topic, rtos_tick_t timeout_ticks);
+
+/**
+ * @brief rtos_bus_alloc() for ISRs at kernel priority (never waits)
+ */
+rtos_bus_msg_t *rtos_bus_alloc_from_isr(rtos_bus_t *bus, uint16_t topic);
+
+/**
+ * @brief Queue a message to every subscriber of its topic
+ *
+ * The publisher's hold on msg ends here: if no subscriber took it, it is
+ * freed before return. A full subscriber queue is waited on for up to
+ * timeout_ticks, then skipped and counted in its dropped field; the other
+ * subscribers still get the message.
+ *
+ * @return RTOS_SUCCESS, RTOS_ERROR_FULL if a subscriber dropped it, or
+ *         RTOS_ERROR_INVALID_PARAM
+ */
+rtos_status_t rtos_bus_publish(rtos_bus_t *bus, rtos_bus_msg_t *msg, rtos_tick_t timeout_ticks);
+
+/*
+ * ISR variant: never waits. *higher_priority_task_woken follows
+ * rtos_queue_send_from_isr().
+ */
+rtos_status_t rtos_bus_publish_from_isr(rtos_bus_t *bus, rtos_bus_msg_t *msg, bool *higher_priority_task_woken);
+
+/**
+ * @brief Take the oldest message queued to a subscriber
+ *
+ * The caller owns one reference and calls rtos_bus_release() when done.
+ *
+ * @param timeout_ticks 0 = no wait, RTOS_MAX_DELAY = forever
+ * @return RTOS_SUCCESS, RTOS_ERROR_INVALID_PARAM, or as rtos_queue_receive()
+ */
+rtos_status_t rtos_bus_receive(rtos_bus_sub_t *sub, rtos_bus_msg_t **msg, rtos_tick_t timeout_ticks);
+
+/**
+ * @brief Drop a reference from task context; the last one frees the message
+ */
+void rtos_bus_release(rtos_bus_msg_t *msg);
+
+/**
+ * @brief rtos_bus_release() for ISRs at kernel priority
+ */
+void rtos_bus_release_from_isr(rtos_bus_msg_t *msg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PUBSUB_H */
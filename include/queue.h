@@ -2,6 +2,7 @@
 #define QUEUE_H
 
 #include "rtos_types.h"
+#include "wait_queue.h"
 
 #include <stdbool.h>
 
@@ -12,22 +13,108 @@ extern "C"
 
 typedef struct rtos_queue *rtos_queue_handle_t;
 
+/* Item counts and sizes; 16-bit with RTOS_FOOTPRINT_COMPACT (create rejects larger) */
+#if RTOS_FOOTPRINT_COMPACT
+typedef uint16_t rtos_queue_count_t;
+#else
+typedef uint32_t rtos_queue_count_t;
+#endif
+
 rtos_status_t rtos_queue_create(rtos_queue_handle_t *queue_handle, uint32_t item_count, uint32_t item_size);
 
+/**
+ * @brief Caller-provided queue control block for rtos_queue_create_static()
+ *
+ * Same size and alignment as the private control block; do not touch the
+ * fields.
+ */
+typedef struct rtos_queue_static
+{
+    void              *opaque_ptrs[2];
+    rtos_queue_count_t opaque_counts[5];
+    bool               opaque_flags[3];
+    rtos_wait_queue_t  opaque_waiters[2];
+} rtos_queue_static_t;
+
+/*
+ * Create a queue without the heap: control block in *queue_buffer, items in
+ * storage (item_count * item_size bytes). Both must outlive the queue;
+ * rtos_queue_delete() releases neither.
+ */
+rtos_status_t rtos_queue_create_static(rtos_queue_handle_t *queue_handle, rtos_queue_static_t *queue_buffer,
+                                       void *storage, uint32_t item_count, uint32_t item_size);
+
 /* timeout_ticks: 0=non-blocking, RTOS_MAX_DELAY=forever */
 rtos_status_t rtos_queue_send(rtos_queue_handle_t queue_handle, const void *item_ptr, rtos_tick_t timeout_ticks);
 
 /* timeout_ticks: 0=non-blocking, RTOS_MAX_DELAY=forever */
 rtos_status_t rtos_queue_receive(rtos_queue_handle_t queue_handle, void *buffer, rtos_tick_t timeout_ticks);
 
+/*
+ * Mailbox use of a length-1 queue: overwrite never blocks and replaces the
+ * queued item, so receivers only ever see the latest one. Other lengths
+ * return RTOS_ERROR_INVALID_PARAM; RTOS_ERROR_FULL while the slot is held
+ * by send_acquire or receive_peek. The ISR variant follows the
+ * *higher_priority_task_woken contract of the ISR API below.
+ */
+rtos_status_t rtos_queue_overwrite(rtos_queue_handle_t queue_handle, const void *item_ptr);
+rtos_status_t rtos_queue_overwrite_from_isr(rtos_queue_handle_t queue_handle, const void *item_ptr,
+                                            bool *higher_priority_task_woken);
+
+/* Copy the oldest item without removing it; blocks like receive */
+rtos_status_t rtos_queue_peek(rtos_queue_handle_t queue_handle, void *buffer, rtos_tick_t timeout_ticks);
+
+/*
+ * Batch variants: block like send/receive until at least one item (or slot)
+ * is available, then move as many of item_count / max_items as fit under
+ * one critical section, with at most two memcpy calls across the wrap.
+ * The number moved is written to *items_sent / *items_received (may be NULL).
+ */
+rtos_status_t rtos_queue_send_n(rtos_queue_handle_t queue_handle, const void *items, uint32_t item_count,
+                                uint32_t *items_sent, rtos_tick_t timeout_ticks);
+rtos_status_t rtos_queue_receive_n(rtos_queue_handle_t queue_handle, void *buffer, uint32_t max_items,
+                                   uint32_t *items_received, rtos_tick_t timeout_ticks);
+
+/*
+ * ISR variants: never block (RTOS_ERROR_FULL / RTOS_ERROR_EMPTY instead).
+ * *higher_priority_task_woken is set to true (never cleared) when a woken
+ * task should preempt the interrupted one; initialise it to false, pass it
+ * to every call in the handler and call rtos_port_yield() once at exit if
+ * it is set. May be NULL.
+ */
+rtos_status_t rtos_queue_send_from_isr(rtos_queue_handle_t queue_handle, const void *item_ptr,
+                                       bool *higher_priority_task_woken);
+rtos_status_t rtos_queue_receive_from_isr(rtos_queue_handle_t queue_handle, void *buffer,
+                                          bool *higher_priority_task_woken);
+
+/*
+ * Zero-copy API. send_acquire returns the next free slot for the caller to
+ * fill in place; send_commit publishes it. receive_peek returns the oldest
+ * item in place; receive_release frees its slot. Blocking and wakeup match
+ * send/receive. One slot per side may be held at a time: while it is held
+ * the queue looks full to other producers (or empty to other consumers).
+ * commit/release without a held slot return RTOS_ERROR_INVALID_STATE.
+ */
+rtos_status_t rtos_queue_send_acquire(rtos_queue_handle_t queue_handle, void **slot, rtos_tick_t timeout_ticks);
+rtos_status_t rtos_queue_send_commit(rtos_queue_handle_t queue_handle);
+rtos_status_t rtos_queue_receive_peek(rtos_queue_handle_t queue_handle, const void **item, rtos_tick_t timeout_ticks);
+rtos_status_t rtos_queue_receive_release(rtos_queue_handle_t queue_handle);
+
 uint32_t rtos_queue_messages_waiting(rtos_queue_handle_t queue_handle);
 uint32_t rtos_queue_spaces_available(rtos_queue_handle_t queue_handle);
 bool     rtos_queue_is_full(rtos_queue_handle_t queue_handle);
 bool     rtos_queue_is_empty(rtos_queue_handle_t queue_handle);
 
-/* Warning: does not wake waiting receivers. All data is discarded. */
+/* Warning: does not wake waiting receivers. All data and held slots are discarded. */
 rtos_status_t rtos_queue_reset(rtos_queue_handle_t queue_handle);
 
+/*
+ * Frees the queue and its storage (static queues: only invalidates the
+ * handle). RTOS_ERROR_INVALID_STATE if tasks are waiting on it, a slot is
+ * held, or it is still in a queue set.
+ */
+rtos_status_t rtos_queue_delete(rtos_queue_handle_t queue_handle);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,92 @@
+#ifndef QUEUE_SET_H
+#define QUEUE_SET_H
+
+#include "config.h"
+#include "queue.h"
+#include "rtos_types.h"
+#include "semaphore.h"
+#include "wait_queue.h"
+
+/**
+ * @file queue_set.h
+ * @brief Queue Set API
+ *
+ * Lets one task block on several queues and semaphores, and optionally its
+ * own default notification slot, at once. The task blocks once on the set
+ * and is woken by whichever member becomes ready first. select() returns
+ * that member; the task then takes from it with a zero timeout:
+ *
+ *     rtos_queue_set_member_t m;
+ *     rtos_queue_set_select(&set, &m, RTOS_MAX_DELAY);
+ *     if (m == rx_queue)        rtos_queue_receive(rx_queue, &frame, 0);
+ *     else if (m == &tick_sem)  rtos_semaphore_try_wait(&tick_sem);
+ *
+ * select() does not consume anything. Members are checked in the order
+ * they were added, so earlier members win when several are ready. A task
+ * blocked on a member itself is served before the set: an item handed
+ * straight to it does not wake the set.
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** Member handle: an rtos_queue_handle_t, an rtos_semaphore_t *, or RTOS_QUEUE_SET_NOTIFICATION */
+typedef const void *rtos_queue_set_member_t;
+
+/** Member standing for the selecting task's default notification slot */
+#define RTOS_QUEUE_SET_NOTIFICATION ((rtos_queue_set_member_t) (uintptr_t) 1U)
+
+/**
+ * @brief Queue set structure
+ */
+typedef struct rtos_queue_set
+{
+    rtos_queue_set_member_t members[RTOS_QUEUE_SET_MAX_MEMBERS];      /**< In add (= check) order */
+    uint8_t                 member_types[RTOS_QUEUE_SET_MAX_MEMBERS]; /**< rtos_sync_type_t of each member */
+    uint8_t                 member_count;                             /**< Members in use */
+    rtos_wait_queue_t       waiters;                                  /**< Tasks blocked in select */
+} rtos_queue_set_t;
+
+/**
+ * @brief Initialize an empty queue set
+ * @return RTOS_SUCCESS, or RTOS_ERROR_INVALID_PARAM
+ */
+rtos_status_t rtos_queue_set_init(rtos_queue_set_t *set);
+
+/*
+ * Add a member. A queue or semaphore belongs to at most one set; it may
+ * already hold items. RTOS_ERROR_FULL when RTOS_QUEUE_SET_MAX_MEMBERS are
+ * in use, RTOS_ERROR_INVALID_STATE if already in a set.
+ *
+ * add_notification makes a set's selector wake when its own default
+ * notification slot becomes pending; read it with rtos_task_notify_wait()
+ * or _take() and a zero timeout.
+ */
+rtos_status_t rtos_queue_set_add_queue(rtos_queue_set_t *set, rtos_queue_handle_t queue);
+rtos_status_t rtos_queue_set_add_semaphore(rtos_queue_set_t *set, rtos_semaphore_t *sem);
+rtos_status_t rtos_queue_set_add_notification(rtos_queue_set_t *set);
+
+/* Remove a member. RTOS_ERROR_INVALID_STATE if it is not in this set. */
+rtos_status_t rtos_queue_set_remove(rtos_queue_set_t *set, rtos_queue_set_member_t member);
+
+/**
+ * @brief Wait until any member is ready and return it
+ *
+ * With several selectors on one set, another task may take the item first;
+ * the zero-timeout take then fails and the caller selects again.
+ *
+ * @param member Receives the ready member (NULL on error)
+ * @param timeout_ticks 0 = no wait, RTOS_MAX_DELAY = forever
+ * @return RTOS_SUCCESS, RTOS_ERROR_EMPTY (no wait), RTOS_ERROR_TIMEOUT, or
+ *         RTOS_ERROR_INVALID_PARAM
+ */
+rtos_status_t rtos_queue_set_select(rtos_queue_set_t *set, rtos_queue_set_member_t *member,
+                                    rtos_tick_t timeout_ticks);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* QUEUE_SET_H */
@@ -0,0 +1,121 @@
+#ifndef RTOS_DEFINE_H
+#define RTOS_DEFINE_H
+
+#include "VRTOS.h"
+#include "config.h"
+#include "queue.h"
+#include "rtos_assert.h"
+#include "rtos_types.h"
+#include "task.h"
+
+#include <stdint.h>
+
+/**
+ * @file rtos_define.h
+ * @brief Tasks and queues defined at file scope, created by rtos_init()
+ *
+ *     RTOS_QUEUE_DEFINE(g_cmd_queue, sizeof(cmd_t), 8);
+ *     RTOS_TASK_DEFINE(g_ctrl_task, ctrl_task_func, 1024, 2);
+ *
+ * Each definition reserves its stack or item storage statically and puts a
+ * constant descriptor in a flash section (rtos_task_defs, rtos_queue_defs).
+ * rtos_init() walks both sections once, after the kernel's own tasks:
+ * every queue first, then every task, so a task may use a queue handle
+ * from its first instruction. No heap is used, main() creates nothing, and
+ * the RAM of all defined objects shows in the link map:
+ *
+ *   - stacks and queue items go to the .rtos_objects output section
+ *     (RAM / DTCM, not zeroed) on the STM32 link scripts, and .bss on the
+ *     host; queue control blocks stay in .bss
+ *   - TCBs come from the static pool of RTOS_MAX_TASKS as for every task
+ *
+ * The handle is a global of the given name; other files reach it through
+ * RTOS_TASK_DECLARE() / RTOS_QUEUE_DECLARE(). Tasks of one priority are
+ * created in link order. If one cannot be created (no free TCB, stack too
+ * small), rtos_init() returns the error and the objects after it do not
+ * exist.
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Task descriptor, in section rtos_task_defs (private)
+ */
+typedef struct rtos_task_def
+{
+    rtos_task_function_t function;
+    const char          *name;
+    uint32_t            *stack;
+    rtos_stack_size_t    stack_size;
+    void                *parameter;
+    rtos_priority_t      priority;
+    uint8_t              flags;
+    rtos_task_handle_t  *handle;
+} rtos_task_def_t;
+
+/**
+ * @brief Queue descriptor, in section rtos_queue_defs (private)
+ */
+typedef struct rtos_queue_def
+{
+    rtos_queue_static_t *control;
+    void                *storage;
+    uint32_t             item_count;
+    uint32_t             item_size;
+    rtos_queue_handle_t *handle;
+} rtos_queue_def_t;
+
+/* Stacks and queue items; the host linker has no .rtos_objects output section */
+#if defined(RTOS_TARGET_NATIVE)
+#define RTOS_DEFINE_OBJECT_REGION
+#else
+#define RTOS_DEFINE_OBJECT_REGION __attribute__((section(".rtos_objects")))
+#endif
+
+/* Section names are C identifiers so the host linker provides __start_ / __stop_ */
+#define RTOS_DEFINE_DESCRIPTOR(kind) __attribute__((used, section(#kind), aligned(sizeof(void *))))
+
+/**
+ * @brief Define a task with a parameter and RTOS_TASK_FLAG_* creation flags
+ * @param stack_bytes Stack size in bytes, a multiple of 8
+ */
+#define RTOS_TASK_DEFINE_EX(handle_name, function, stack_bytes, priority, parameter, flags)                            \
+    RTOS_STATIC_ASSERT((stack_bytes) % 8U == 0U, "task stack size must be a multiple of 8");                           \
+    static uint32_t handle_name##_stack[(stack_bytes) / sizeof(uint32_t)] RTOS_DEFINE_OBJECT_REGION                    \
+        __attribute__((aligned(8)));                                                                                   \
+    rtos_task_handle_t           handle_name;                                                                          \
+    static const rtos_task_def_t handle_name##_def RTOS_DEFINE_DESCRIPTOR(rtos_task_defs) = {                          \
+        (function), #handle_name, handle_name##_stack, (rtos_stack_size_t) (stack_bytes), (void *) (parameter),        \
+        (priority), (uint8_t) (flags), &handle_name}
+
+/**
+ * @brief Define a task taking a NULL parameter and no flags
+ */
+#define RTOS_TASK_DEFINE(handle_name, function, stack_bytes, priority)                                                 \
+    RTOS_TASK_DEFINE_EX(handle_name, function, stack_bytes, priority, NULL, RTOS_TASK_FLAG_NONE)
+
+/**
+ * @brief Define a queue of item_count items of item_size bytes
+ */
+#define RTOS_QUEUE_DEFINE(handle_name, item_size, item_count)                                                          \
+    static uint8_t handle_name##_storage[(item_size) * (item_count)] RTOS_DEFINE_OBJECT_REGION                         \
+        __attribute__((aligned(8)));                                                                                   \
+    static rtos_queue_static_t    handle_name##_control;                                                               \
+    rtos_queue_handle_t           handle_name;                                                                         \
+    static const rtos_queue_def_t handle_name##_def RTOS_DEFINE_DESCRIPTOR(rtos_queue_defs) = {                        \
+        &handle_name##_control, handle_name##_storage, (item_count), (item_size), &handle_name}
+
+/** @brief Reach a task defined in another file */
+#define RTOS_TASK_DECLARE(handle_name) extern rtos_task_handle_t handle_name
+
+/** @brief Reach a queue defined in another file */
+#define RTOS_QUEUE_DECLARE(handle_name) extern rtos_queue_handle_t handle_name
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RTOS_DEFINE_H */
@@ -1,6 +1,10 @@
 #ifndef RTOS_PORT_H
 #define RTOS_PORT_H
 
+#include "config.h"
+#include "port_critical.h" /* chip port: static inline critical-section primitives */
+#include "power.h"
+#include "rtos_assert.h"
 #include "rtos_types.h"
 
 /**
@@ -45,40 +49,86 @@ void rtos_port_start_first_task(void);
  */
 uint32_t *rtos_port_init_task_stack(uint32_t *stack_top, rtos_task_function_t task_function, void *parameter);
 
-/**
- * @brief Enter critical section
- * 
- * Disables interrupts at or below kernel priority level.
+/*
+ * Critical sections are static inline, from the chip port's port_critical.h:
+ *
+ *   void     rtos_port_enter_critical(void);
+ *   void     rtos_port_exit_critical(void);
+ *       Mask interrupts at or below kernel priority; nestable. The nesting
+ *       depth is per task (saved with its context), so a task switched out
+ *       inside a section gets it back when it resumes.
+ *
+ *   uint32_t rtos_port_enter_critical_from_isr(void);
+ *   void     rtos_port_exit_critical_from_isr(uint32_t saved_priority);
+ *       ISR-safe pair: returns / restores the previous mask instead of
+ *       counting nesting.
+ *
+ *
+ *   uint32_t rtos_port_get_core_id(void);
+ *       Index of the calling core, 0 .. PORT_NUM_CORES - 1. Constant 0 on
+ *       single-core ports.
+ *
  * Critical (priority 0x00-0x70) interrupts can still occur.
+ *
+ * With RTOS_SMP_CORES > 1 the outermost rtos_port_enter_critical() and
+ * every rtos_port_enter_critical_from_isr() also take the kernel spinlock
+ * (a hardware spinlock or semaphore where the chip has one), so a section
+ * excludes the other cores as well as local interrupts. The nesting depth
+ * is then per core.
  */
-void rtos_port_enter_critical(void);
 
 /**
- * @brief Exit critical section
+ * @brief Write back data-cache lines covering [addr, addr + size)
+ *
+ * Call before a DMA controller reads a buffer the CPU wrote. Ports without
+ * a data cache (PORT_HAS_DCACHE == 0) implement it as a no-op.
  */
-void rtos_port_exit_critical(void);
+void rtos_port_dcache_clean(const void *addr, uint32_t size);
 
 /**
- * @brief Enter critical section from ISR
- * 
- * For use in ISR context. Returns saved BASEPRI value.
- * 
- * @return Previous BASEPRI value (for restore)
+ * @brief Discard data-cache lines covering [addr, addr + size)
+ *
+ * Call before the CPU reads a buffer a DMA controller wrote. addr and size
+ * must be multiples of PORT_DCACHE_LINE_SIZE: lines shared with other data
+ * would lose its unwritten changes. No-op without a data cache.
  */
-uint32_t rtos_port_enter_critical_from_isr(void);
+void rtos_port_dcache_invalidate(void *addr, uint32_t size);
 
 /**
- * @brief Exit critical section from ISR
- * 
- * @param saved_priority Value returned from enter_critical_from_isr
+ * @brief Compile-time check for an interrupt that calls kernel _from_isr APIs
+ *
+ * @param nvic_prio Priority as passed to NVIC_SetPriority(); it must be one
+ *                  the kernel masks. Interrupts above PORT_MAX_INTERRUPT_PRIORITY
+ *                  form the zero-latency tier and must not call the kernel.
  */
-void rtos_port_exit_critical_from_isr(uint32_t saved_priority);
+#define RTOS_ASSERT_KERNEL_IRQ_PRIORITY(nvic_prio)                                                                     \
+    RTOS_STATIC_ASSERT(PORT_IRQ_IS_KERNEL_SAFE(nvic_prio), "IRQ priority " #nvic_prio " is above the kernel mask")
 
 /**
  * @brief Force a context switch
  */
 void rtos_port_yield(void);
 
+#if RTOS_SMP_CORES > 1
+/**
+ * @brief Request a context switch on another core
+ * @param core Core index; never the calling core
+ *
+ * Sends an inter-processor interrupt whose handler pends the context switch
+ * on that core. Called with the kernel lock held.
+ */
+void rtos_port_yield_core(uint32_t core);
+
+/**
+ * @brief Start every core other than the calling one
+ *
+ * Called once by rtos_start_scheduler() on core 0. Each started core runs
+ * its own port init (tick, interrupt priorities) and then calls
+ * rtos_kernel_start_core(), which does not return.
+ */
+void rtos_port_start_secondary_cores(void);
+#endif
+
 /**
  * @brief System tick interrupt handler
  *
@@ -86,6 +136,36 @@ void rtos_port_yield(void);
  */
 void rtos_port_systick_handler(void);
 
+#if RTOS_TICKLESS_IDLE
+/**
+ * @brief Suppress the tick and sleep (tickless idle)
+ * @param expected_idle_ticks Ticks until the next kernel deadline
+ *
+ * Called from the idle task.  The port stops the periodic tick, programs a
+ * single wake-up no later than expected_idle_ticks from now (clamped to the
+ * timer's range), sleeps, and on wake reports the whole ticks that elapsed
+ * through rtos_kernel_step_tick() before restarting the periodic tick.
+ */
+void rtos_port_suppress_ticks_and_sleep(rtos_tick_t expected_idle_ticks);
+
+#if RTOS_USE_LOW_POWER
+/**
+ * @brief Enter stop or standby (idle task, RTOS_USE_LOW_POWER)
+ * @param mode  RTOS_POWER_MODE_STOP or _STANDBY
+ * @param ticks Longest sleep, programmed into the board's wake-up timer
+ *
+ * Like the tickless path, re-checks rtos_kernel_confirm_sleep() with kernel
+ * interrupts masked first. Around the WFI it calls the board's
+ * hardware_env_power_enter() / _exit(), then reports the ticks slept
+ * through rtos_kernel_step_tick() and rtos_kernel_power_record().
+ *
+ * @return false if the board cannot enter the mode now (the caller falls
+ *         back to sleep mode)
+ */
+bool rtos_port_deep_sleep(rtos_power_mode_t mode, rtos_tick_t ticks);
+#endif
+#endif
+
 #ifdef __cplusplus
 }
 #endif
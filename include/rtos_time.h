@@ -0,0 +1,66 @@
+#ifndef RTOS_TIME_H
+#define RTOS_TIME_H
+
+#include "rtos_types.h"
+
+#include <stdint.h>
+
+/**
+ * @file rtos_time.h
+ * @brief Monotonic 64-bit Time Base
+ *
+ * rtos_tick_t and DWT->CYCCNT are both 32 bits wide: the tick count wraps
+ * after 49 days at 1 kHz and the cycle counter every 25 s at 168 MHz.  The
+ * functions here extend them to 64 bits so timestamps taken far apart can
+ * be compared directly.
+ *
+ * The tick handler publishes an anchor (64-bit tick count and cycle count
+ * at that tick) into one of two slots behind a sequence counter; readers
+ * add the cycles elapsed since the anchor.  Reading takes no lock and never
+ * waits for the writer, so any context may call it, including ISRs above
+ * the kernel's BASEPRI threshold and klog_write().
+ *
+ * rtos_time_cycles64() counts core clock cycles, so it pauses while the
+ * clock is stopped in deep sleep; its low 32 bits always equal CYCCNT.
+ * rtos_time_now_ns() follows the tick count, which tickless idle and deep
+ * sleep keep up to date, and interpolates within the tick with CYCCNT.
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Tick count since rtos_init(), never wrapping
+ *
+ * The low 32 bits equal rtos_get_tick_count().
+ */
+uint64_t rtos_get_tick_count64(void);
+
+/**
+ * @brief Core clock cycles, extended to 64 bits
+ *
+ * Monotonic as long as the kernel tick runs at least once per CYCCNT wrap,
+ * which any tick rate above 1 Hz guarantees.
+ */
+uint64_t rtos_time_cycles64(void);
+
+/**
+ * @brief Nanoseconds since rtos_init()
+ *
+ * Tick-accurate across sleep and cycle-accurate within a tick, and never
+ * goes backwards.
+ */
+uint64_t rtos_time_now_ns(void);
+
+/**
+ * @brief Convert a cycle count (or difference) to nanoseconds at SystemCoreClock
+ */
+uint64_t rtos_time_cycles_to_ns(uint64_t cycles);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RTOS_TIME_H */
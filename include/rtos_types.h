@@ -29,7 +29,8 @@ typedef enum
     RTOS_ERROR_TIMEOUT,        /**< Operation timed out */
     RTOS_ERROR_FULL,           /**< Queue/Buffer is full */
     RTOS_ERROR_EMPTY,          /**< Queue/Buffer is empty */
-    RTOS_ERROR_GENERAL         /**< General error */
+    RTOS_ERROR_GENERAL,        /**< General error */
+    RTOS_ERROR_NOT_SCHEDULABLE /**< Admission control rejected the task set */
 } rtos_status_t;
 
 #define RTOS_MAX_DELAY ((rtos_tick_t) - 1)
@@ -55,7 +56,13 @@ typedef enum
     RTOS_SYNC_TYPE_SEMAPHORE,
     RTOS_SYNC_TYPE_QUEUE,
     RTOS_SYNC_TYPE_NOTIFICATION,
-    RTOS_SYNC_TYPE_EVENT_GROUP
+    RTOS_SYNC_TYPE_EVENT_GROUP,
+    RTOS_SYNC_TYPE_MEMPOOL,
+    RTOS_SYNC_TYPE_STREAM_BUFFER,
+    RTOS_SYNC_TYPE_QUEUE_SET,
+    RTOS_SYNC_TYPE_RWLOCK,
+    RTOS_SYNC_TYPE_HRTIMER,
+    RTOS_SYNC_TYPE_IO
 } rtos_sync_type_t;
 
 /* Forward Declarations */
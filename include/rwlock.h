@@ -0,0 +1,93 @@
+#ifndef RWLOCK_H
+#define RWLOCK_H
+
+#include "mutex.h"
+#include "rtos_types.h"
+#include "wait_queue.h"
+
+/**
+ * @file rwlock.h
+ * @brief Reader-Writer Lock API
+ *
+ * Any number of tasks may hold the lock for reading at once; a writer holds
+ * it alone. Writers take priority: once a writer owns or is draining the
+ * lock, new readers block, so a stream of readers cannot starve it. The
+ * uncontended read lock/unlock is a single LDREX/STREX on the state word.
+ *
+ * The write side is an embedded mutex, so writers queue by priority and a
+ * writer inherits the priority of every task (reader or writer) it blocks.
+ * Readers are not tracked individually and inherit nothing from a writer
+ * waiting for them to leave: keep read sections short.
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Reader-writer lock structure
+ */
+typedef struct rtos_rwlock
+{
+    rtos_mutex_t                    write_lock;   /**< Held by the writer; must stay first (mutex.c) */
+    volatile uint32_t               state;        /**< RWLOCK_WRITER bit | active reader count */
+    rtos_wait_queue_t               read_waiters; /**< Readers held off by a writer, by priority */
+    struct rtos_task_control_block *drain_waiter; /**< Writer waiting for the readers to leave */
+} rtos_rwlock_t;
+
+/**
+ * @brief Initialize a reader-writer lock
+ * @return RTOS_SUCCESS, or RTOS_ERROR_INVALID_PARAM
+ */
+rtos_status_t rtos_rwlock_init(rtos_rwlock_t *rw);
+
+/**
+ * @brief Lock for reading, blocking while a writer owns or waits for the lock
+ *
+ * A reader must not take the read lock again while holding it: a writer
+ * arriving in between would deadlock both.
+ *
+ * @param timeout_ticks 0 = no wait, RTOS_MAX_WAIT = forever
+ * @return RTOS_SUCCESS, RTOS_ERROR_TIMEOUT, or RTOS_ERROR_INVALID_PARAM
+ */
+rtos_status_t rtos_rwlock_read_lock(rtos_rwlock_t *rw, rtos_tick_t timeout_ticks);
+
+/**
+ * @brief Release a read lock, waking a writer waiting for the last reader
+ * @return RTOS_SUCCESS, or RTOS_ERROR_INVALID_STATE if no reader holds the lock
+ */
+rtos_status_t rtos_rwlock_read_unlock(rtos_rwlock_t *rw);
+
+/**
+ * @brief Lock for writing, blocking until other writers and all readers leave
+ *
+ * The write lock is recursive like rtos_mutex_t; take the read lock inside
+ * it and the task deadlocks with itself.
+ *
+ * @param timeout_ticks 0 = no wait, RTOS_MAX_WAIT = forever; covers both
+ *                      the wait for the writer and for the readers
+ * @return RTOS_SUCCESS, RTOS_ERROR_TIMEOUT, or RTOS_ERROR_INVALID_PARAM
+ */
+rtos_status_t rtos_rwlock_write_lock(rtos_rwlock_t *rw, rtos_tick_t timeout_ticks);
+
+/**
+ * @brief Release a write lock
+ *
+ * Hands over to the highest-priority waiter: the next writer, or every
+ * waiting reader if the top one outranks all waiting writers.
+ *
+ * @return RTOS_SUCCESS, or RTOS_ERROR_INVALID_PARAM if the caller is not the writer
+ */
+rtos_status_t rtos_rwlock_write_unlock(rtos_rwlock_t *rw);
+
+/**
+ * @brief Tasks currently holding the lock for reading
+ */
+uint32_t rtos_rwlock_get_reader_count(const rtos_rwlock_t *rw);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RWLOCK_H */
@@ -26,13 +26,41 @@ typedef enum
 {
     RTOS_SCHEDULER_PREEMPTIVE_SP = 0, /**< Preemptive static priority-based Scheduler */
     RTOS_SCHEDULER_COOPERATIVE   = 1, /**< Cooperative Scheduler */
-    RTOS_SCHEDULER_ROUND_ROBIN   = 2  /**< Round Robin Scheduler */
+    RTOS_SCHEDULER_ROUND_ROBIN   = 2, /**< Round Robin Scheduler */
+    RTOS_SCHEDULER_EDF           = 3  /**< Earliest Deadline First Scheduler */
 } rtos_scheduler_type_t;
 
 /* Deadline Types for EDF */
 typedef uint32_t rtos_deadline_t; /**< Task deadline in ticks */
 typedef uint32_t rtos_period_t;   /**< Task period in ticks */
 
+/**
+ * @brief Scheduler statistics, the same layout for every backend
+ *
+ * The counters run from rtos_scheduler_init() or the last
+ * rtos_scheduler_reset_statistics() and wrap at 2^32. Each switch is either
+ * a preemption, where the outgoing task is still ready (this includes a task
+ * that called rtos_yield() and gave way to a peer), or voluntary, where it
+ * blocked, slept, suspended itself or was deleted. A yield or PendSV that
+ * would pick the running task again is elided and counted apart. Lengths
+ * exclude the running task.
+ */
+typedef struct
+{
+    uint32_t    context_switches;   /**< Switches to a different task */
+    uint32_t    preemptions;        /**< Switches away from a task that stayed ready */
+    uint32_t    voluntary_switches; /**< Switches away from a task that blocked, slept or was suspended/deleted */
+    uint32_t    elided_switches;    /**< Yields and PendSVs that kept the running task */
+    uint32_t    tick_wakes;         /**< Delayed tasks the tick handler made ready */
+    uint32_t    suspended_ticks;    /**< Ticks that arrived with the scheduler suspended */
+    uint32_t    deadline_misses;    /**< Late jobs summed over live tasks (EDF; 0 otherwise) */
+    rtos_tick_t current_tick;       /**< Tick at the time of the call */
+    uint8_t     ready_count;        /**< Ready tasks now */
+    uint8_t     ready_high_water;   /**< Most ready tasks at once */
+    uint8_t     delayed_count;      /**< Delayed tasks now */
+    uint8_t     delayed_high_water; /**< Most delayed tasks at once */
+} rtos_scheduler_stats_t;
+
 /**
  * @brief Enhanced scheduler interface vtable
  *
@@ -72,6 +100,19 @@ struct rtos_scheduler
      */
     void (*task_completed)(rtos_scheduler_instance_t *instance, rtos_task_handle_t completed_task);
 
+    /**
+     * @brief Check whether a switch would pick the running task again
+     * @param instance Scheduler instance
+     * @param current Task running on this core, in the RUNNING state
+     * @return True if re-queuing current, task_completed() and get_next_task()
+     *         would select current; the backend has then applied whatever
+     *         task_completed() would have (e.g. a quantum refill)
+     *
+     * Lets the kernel drop a same-task switch before touching the ready
+     * lists. False always takes the full path.
+     */
+    bool (*reselects_current)(rtos_scheduler_instance_t *instance, rtos_task_handle_t current);
+
     /* =================== List Management Operations =================== */
 
     /**
@@ -120,16 +161,23 @@ struct rtos_scheduler
      */
     void (*update_delayed_tasks)(rtos_scheduler_instance_t *instance);
 
+    /**
+     * @brief Get the earliest delayed-task wake tick (optional, tickless idle)
+     * @param instance Scheduler instance
+     * @param wake_tick Receives the absolute tick of the earliest wake-up
+     * @return True if any task is delayed, false otherwise
+     */
+    bool (*get_next_wake_tick)(rtos_scheduler_instance_t *instance, rtos_tick_t *wake_tick);
+
     /* =================== Optional Debug/Statistics =================== */
 
     /**
-     * @brief Get scheduler statistics (optional)
+     * @brief Fill the backend-owned fields of the statistics (optional)
      * @param instance Scheduler instance
-     * @param stats_buffer Buffer to fill with statistics
-     * @param buffer_size Size of statistics buffer
-     * @return Number of bytes written, 0 if not supported
+     * @param stats Statistics; set ready_count, delayed_count and, for
+     *              deadline-driven backends, deadline_misses
      */
-    size_t (*get_statistics)(rtos_scheduler_instance_t *instance, void *stats_buffer, size_t buffer_size);
+    void (*get_statistics)(rtos_scheduler_instance_t *instance, rtos_scheduler_stats_t *stats);
 };
 
 /**
@@ -183,6 +231,13 @@ bool rtos_scheduler_should_preempt(rtos_task_handle_t new_task);
  */
 void rtos_scheduler_task_completed(rtos_task_handle_t completed_task);
 
+/**
+ * @brief Check whether a switch would keep the running task (kernel lock held)
+ * @param current Task running on this core, in the RUNNING state
+ * @return True if the switch can be elided
+ */
+bool rtos_scheduler_reselects_current(rtos_task_handle_t current);
+
 /* =================== List Management Operations =================== */
 
 /**
@@ -215,6 +270,54 @@ void rtos_scheduler_remove_from_delayed_list(rtos_task_handle_t task_handle);
  */
 void rtos_scheduler_update_delayed_tasks(void);
 
+/**
+ * @brief Get the earliest delayed-task wake tick via scheduler
+ * @param wake_tick Receives the absolute tick of the earliest wake-up
+ * @return True if any task is delayed (false also when unsupported)
+ */
+bool rtos_scheduler_get_next_wake_tick(rtos_tick_t *wake_tick);
+
+/* =================== Debug/Statistics =================== */
+
+/**
+ * @brief Read the scheduler statistics
+ * @param stats Receives the counters and the current list lengths
+ * @return RTOS_SUCCESS, RTOS_ERROR_INVALID_PARAM for NULL,
+ *         RTOS_ERROR_INVALID_STATE before rtos_scheduler_init()
+ *
+ * With RTOS_SCHEDULER_STATS = 0 the counters and high-water marks read 0.
+ */
+rtos_status_t rtos_scheduler_get_statistics(rtos_scheduler_stats_t *stats);
+
+/**
+ * @brief Zero the counters and set the high-water marks to the current lengths
+ */
+void rtos_scheduler_reset_statistics(void);
+
+/**
+ * @brief Write the statistics to the kernel log
+ *
+ * One KEVT_SCHED_STATS record per field (arg0 = rtos_sched_stat_id_t,
+ * arg1 = value) at info level, so the binary stream carries them to
+ * klog_decoder.py like any other event.
+ */
+void rtos_scheduler_log_statistics(void);
+
+/** @brief Field of a KEVT_SCHED_STATS record (arg0) */
+typedef enum
+{
+    RTOS_SCHED_STAT_CONTEXT_SWITCHES = 0,
+    RTOS_SCHED_STAT_PREEMPTIONS,
+    RTOS_SCHED_STAT_VOLUNTARY_SWITCHES,
+    RTOS_SCHED_STAT_ELIDED_SWITCHES,
+    RTOS_SCHED_STAT_TICK_WAKES,
+    RTOS_SCHED_STAT_SUSPENDED_TICKS,
+    RTOS_SCHED_STAT_DEADLINE_MISSES,
+    RTOS_SCHED_STAT_READY,   /**< arg1 = high-water << 8 | current */
+    RTOS_SCHED_STAT_DELAYED, /**< arg1 = high-water << 8 | current */
+    RTOS_SCHED_STAT_COUNT
+} rtos_sched_stat_id_t;
+
 #ifdef __cplusplus
 }
 #endif
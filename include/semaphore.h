@@ -2,6 +2,7 @@
 #define SEMAPHORE_H
 
 #include "rtos_types.h"
+#include "wait_queue.h"
 
 /**
  * @file semaphore.h
@@ -16,8 +17,9 @@ extern "C"
 {
 #endif
 
-/* Forward declaration for TCB */
+/* Forward declarations */
 struct rtos_task_control_block;
+struct rtos_queue_set;
 
 /* Semaphore wait timeout values */
 #define RTOS_SEM_MAX_WAIT ((rtos_tick_t) 0xFFFFFFFFU)
@@ -34,14 +36,23 @@ typedef enum
     RTOS_SEM_ERR_OVERFLOW = RTOS_ERROR_GENERAL
 } rtos_sem_status_t;
 
+/* Counts; 16-bit with RTOS_FOOTPRINT_COMPACT (init rejects larger, unlimited stops at 65535) */
+#if RTOS_FOOTPRINT_COMPACT
+typedef uint16_t rtos_sem_count_t;
+#else
+typedef uint32_t rtos_sem_count_t;
+#endif
+
 /**
  * @brief Semaphore structure
  */
 typedef struct rtos_semaphore
 {
-    uint32_t                        count;        /**< Current count */
-    uint32_t                        max_count;    /**< Maximum count (0 = unlimited) */
-    struct rtos_task_control_block *waiting_list; /**< Head of waiting task list (priority-ordered) */
+    rtos_sem_count_t  count;     /**< Current count (first: the fast paths LDREX/STREX its word) */
+    rtos_sem_count_t  max_count; /**< Maximum count (0 = unlimited) */
+    rtos_wait_queue_t waiters;   /**< Tasks blocked in wait (by priority, FIFO within one) */
+
+    struct rtos_queue_set *set; /**< Queue set this semaphore belongs to, NULL = none */
 } rtos_semaphore_t;
 
 /**
@@ -68,6 +79,21 @@ rtos_sem_status_t rtos_semaphore_wait(rtos_semaphore_t *sem, rtos_tick_t timeout
  */
 rtos_sem_status_t rtos_semaphore_signal(rtos_semaphore_t *sem);
 
+/**
+ * @brief Signal a semaphore from an ISR
+ *
+ * Never blocks and never switches context. With no waiter the count is
+ * raised with LDREX/STREX and no interrupt masking; otherwise the
+ * highest-priority waiter is made ready.
+ *
+ * @param sem Pointer to semaphore
+ * @param higher_priority_task_woken Set to true (never cleared) when the woken
+ *        task should preempt the interrupted one; call rtos_port_yield() once
+ *        at ISR exit if it is set. May be NULL.
+ * @return RTOS_SEM_OK on success, RTOS_SEM_ERR_OVERFLOW if at max
+ */
+rtos_sem_status_t rtos_semaphore_signal_from_isr(rtos_semaphore_t *sem, bool *higher_priority_task_woken);
+
 /**
  * @brief Try to acquire semaphore without blocking
  * @param sem Pointer to semaphore
@@ -0,0 +1,78 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "rtos_types.h"
+
+#include <stdbool.h>
+
+/**
+ * @file snapshot.h
+ * @brief Latest-Value Snapshot API
+ *
+ * Holds the newest value of a fixed-size record (a sensor sample, a control
+ * setpoint) for one writer and any number of readers, without any critical
+ * section or kernel call: an ISR at any priority, including above the
+ * kernel's BASEPRI threshold, may write it.  Older values are simply lost.
+ *
+ * The record is double-buffered behind a sequence counter.  The writer
+ * fills the slot readers are not being pointed at and then publishes it; a
+ * reader copies the published slot and retries only if two whole writes
+ * started during its copy.  A reader that preempts the writer therefore never
+ * waits for it.
+ *
+ * Several writers must serialise among themselves.  Readers block on
+ * nothing; pair the snapshot with a notification or semaphore to wait for
+ * a new value.
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** Bytes of storage needed for a record of `size` bytes */
+#define RTOS_SNAPSHOT_STORAGE_SIZE(size) (2U * (size))
+
+/**
+ * @brief Snapshot structure
+ */
+typedef struct rtos_snapshot
+{
+    uint8_t          *slots;    /**< Two copies of the record, size bytes apart */
+    uint32_t          size;     /**< Record size in bytes */
+    volatile uint32_t sequence; /**< 2 per write, odd while one is in progress */
+    volatile bool     written;  /**< Set once the first write is published */
+} rtos_snapshot_t;
+
+/**
+ * @brief Initialize a snapshot
+ * @param storage RTOS_SNAPSHOT_STORAGE_SIZE(size) bytes, aligned for the record
+ * @return RTOS_SUCCESS, or RTOS_ERROR_INVALID_PARAM
+ */
+rtos_status_t rtos_snapshot_init(rtos_snapshot_t *snap, void *storage, uint32_t size);
+
+/**
+ * @brief Publish a new value (single writer, any context)
+ * @return RTOS_SUCCESS, or RTOS_ERROR_INVALID_PARAM
+ */
+rtos_status_t rtos_snapshot_write(rtos_snapshot_t *snap, const void *value);
+
+/**
+ * @brief Copy the latest value (any number of readers, any context)
+ * @param version Writes the copy reflects (may be NULL); compare with a
+ *                previous read to tell whether the value is new
+ * @return RTOS_SUCCESS, RTOS_ERROR_EMPTY before the first write, or
+ *         RTOS_ERROR_INVALID_PARAM
+ */
+rtos_status_t rtos_snapshot_read(const rtos_snapshot_t *snap, void *value, uint32_t *version);
+
+/**
+ * @brief Writes published so far, without copying the value
+ */
+uint32_t rtos_snapshot_version(const rtos_snapshot_t *snap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SNAPSHOT_H */
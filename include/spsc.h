@@ -0,0 +1,95 @@
+#ifndef SPSC_H
+#define SPSC_H
+
+#include "rtos_types.h"
+
+#include <stdbool.h>
+
+/**
+ * @file spsc.h
+ * @brief Lock-Free Single-Producer Single-Consumer Channel API
+ *
+ * A ring of fixed-size items for one fixed producer (a task or an ISR) and
+ * one fixed consumer task, e.g. an ADC ISR feeding a DSP task. Each side
+ * moves only its own index, so send and receive take no critical section:
+ * an item costs a copy and two index updates with release/acquire ordering.
+ *
+ * The consumer is woken through one of its task notification slots, and only
+ * when a send finds the channel drained; sends into a non-empty channel touch
+ * no kernel state. A full channel rejects the send (RTOS_ERROR_FULL): the
+ * producer never blocks.
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief SPSC channel structure
+ *
+ * head and tail count items since init and wrap freely; head - tail is the
+ * fill level, so all capacity slots are usable.
+ */
+typedef struct rtos_spsc
+{
+    volatile uint32_t               head;         /**< Items sent (producer only) */
+    volatile uint32_t               tail;         /**< Items received (consumer only) */
+    uint8_t                        *storage;      /**< capacity * item_size bytes */
+    uint32_t                        item_size;    /**< Item size in bytes */
+    uint32_t                        mask;         /**< capacity - 1 */
+    struct rtos_task_control_block *consumer;     /**< Notified on the empty to non-empty transition */
+    uint8_t                         notify_index; /**< Consumer's notification slot */
+} rtos_spsc_t;
+
+/**
+ * @brief Initialize a channel
+ * @param storage      capacity * item_size bytes, aligned for the item type
+ * @param capacity     Items, a power of 2
+ * @param consumer     Task that receives, or NULL to poll without blocking
+ * @param notify_index Consumer's notification slot, < RTOS_TASK_NOTIFY_ARRAY_ENTRIES,
+ *                     owned by the channel
+ * @return RTOS_SUCCESS, or RTOS_ERROR_INVALID_PARAM
+ */
+rtos_status_t rtos_spsc_init(rtos_spsc_t *ch, void *storage, uint32_t item_size, uint32_t capacity,
+                             rtos_task_handle_t consumer, uint8_t notify_index);
+
+/**
+ * @brief Send one item from a task; may switch to the woken consumer
+ * @return RTOS_SUCCESS, RTOS_ERROR_FULL, or RTOS_ERROR_INVALID_PARAM
+ */
+rtos_status_t rtos_spsc_send(rtos_spsc_t *ch, const void *item);
+
+/**
+ * @brief Send one item from an ISR
+ *
+ * *higher_priority_task_woken is set to true (never cleared) when the woken
+ * consumer should preempt the interrupted task; call rtos_port_yield() once
+ * at exit if it is set. May be NULL.
+ *
+ * @return RTOS_SUCCESS, RTOS_ERROR_FULL, or RTOS_ERROR_INVALID_PARAM
+ */
+rtos_status_t rtos_spsc_send_from_isr(rtos_spsc_t *ch, const void *item, bool *higher_priority_task_woken);
+
+/**
+ * @brief Receive the oldest item, blocking on the notification while empty
+ *
+ * Only the consumer given to rtos_spsc_init() may block; with a NULL
+ * consumer timeout_ticks must be 0.
+ *
+ * @param timeout_ticks 0 = no wait, RTOS_MAX_DELAY = forever
+ * @return RTOS_SUCCESS, RTOS_ERROR_EMPTY (no wait), RTOS_ERROR_TIMEOUT, or
+ *         RTOS_ERROR_INVALID_PARAM
+ */
+rtos_status_t rtos_spsc_receive(rtos_spsc_t *ch, void *buffer, rtos_tick_t timeout_ticks);
+
+/**
+ * @brief Items waiting (exact for either side, a snapshot for anyone else)
+ */
+uint32_t rtos_spsc_count(const rtos_spsc_t *ch);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SPSC_H */
@@ -0,0 +1,171 @@
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#include "ring_buffer.h"
+#include "rtos_types.h"
+
+#include <stdbool.h>
+
+/**
+ * @file stream_buffer.h
+ * @brief Stream Buffer and Message Buffer API
+ *
+ * Byte streams for one writer and one reader (e.g. a UART RX ISR and its
+ * parser task), on a caller-provided power-of-2 ring_buffer_t.  Writes and
+ * reads copy whole spans without any critical section; one is only taken
+ * when the other side is blocked and may have to be woken.
+ *
+ * A stream buffer moves bytes; a blocked reader wakes once trigger_level
+ * bytes are buffered.  A message buffer stores each write as one message
+ * behind a 2-byte length prefix and returns whole messages only.
+ *
+ * Several writers (or several readers) must serialise among themselves,
+ * e.g. with a mutex or by writing from a single ISR.
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Forward declaration for TCB */
+struct rtos_task_control_block;
+
+/* Bytes of length prefix stored ahead of each message */
+#define RTOS_MESSAGE_BUFFER_HEADER_SIZE (2U)
+
+/** Largest message a buffer of `size` storage bytes can hold */
+#define RTOS_MESSAGE_BUFFER_MAX_MESSAGE(size) ((size) - 1U - RTOS_MESSAGE_BUFFER_HEADER_SIZE)
+
+/**
+ * @brief Stream buffer structure
+ *
+ * Holds size - 1 bytes (the ring keeps one slot free).
+ */
+typedef struct rtos_stream_buffer
+{
+    ring_buffer_t                            rb;             /**< Byte storage */
+    uint32_t                                 trigger_level;  /**< Bytes that wake a blocked reader */
+    uint32_t                                 writer_needs;   /**< Free bytes the blocked writer waits for */
+    struct rtos_task_control_block *volatile reader;         /**< Blocked reader, NULL = none */
+    struct rtos_task_control_block *volatile writer;         /**< Blocked writer, NULL = none */
+    uint8_t                                  is_message;     /**< 1 = message buffer */
+} rtos_stream_buffer_t;
+
+/**
+ * @brief Message buffer structure (a stream buffer storing framed messages)
+ */
+typedef struct rtos_message_buffer
+{
+    rtos_stream_buffer_t stream; /**< Underlying stream, trigger level 1 */
+} rtos_message_buffer_t;
+
+/* ======================== Stream Buffer ================================= */
+
+/**
+ * @brief Initialize a stream buffer
+ * @param sb Pointer to stream buffer
+ * @param storage Backing storage (4-byte aligned for word copies)
+ * @param size Storage size in bytes, a power of 2 >= 2
+ * @param trigger_level Bytes a blocked reader waits for, 1..size-1 (0 is taken as 1)
+ * @return RTOS_SUCCESS, or RTOS_ERROR_INVALID_PARAM
+ */
+rtos_status_t rtos_stream_buffer_init(rtos_stream_buffer_t *sb, uint8_t *storage, uint32_t size,
+                                      uint32_t trigger_level);
+
+/**
+ * @brief Write bytes, blocking while the buffer is full
+ *
+ * Waits until at least one byte fits, then writes as many of len as fit.
+ *
+ * @param bytes_sent Receives the number of bytes written (may be NULL)
+ * @param timeout_ticks 0 = no wait, RTOS_MAX_DELAY = forever
+ * @return RTOS_SUCCESS if any byte was written, RTOS_ERROR_FULL (no wait) or
+ *         RTOS_ERROR_TIMEOUT if none was, RTOS_ERROR_INVALID_PARAM
+ */
+rtos_status_t rtos_stream_buffer_send(rtos_stream_buffer_t *sb, const void *data, uint32_t len,
+                                      uint32_t *bytes_sent, rtos_tick_t timeout_ticks);
+
+/**
+ * @brief Read bytes, blocking while the buffer is empty
+ *
+ * Returns at once with whatever is buffered (up to max_len); if nothing is,
+ * waits until trigger_level bytes arrive or the timeout expires.
+ *
+ * @param bytes_received Receives the number of bytes read (may be NULL)
+ * @param timeout_ticks 0 = no wait, RTOS_MAX_DELAY = forever
+ * @return RTOS_SUCCESS if any byte was read, RTOS_ERROR_EMPTY (no wait) or
+ *         RTOS_ERROR_TIMEOUT if none was, RTOS_ERROR_INVALID_PARAM
+ */
+rtos_status_t rtos_stream_buffer_receive(rtos_stream_buffer_t *sb, void *buffer, uint32_t max_len,
+                                         uint32_t *bytes_received, rtos_tick_t timeout_ticks);
+
+/*
+ * ISR variants: never block (RTOS_ERROR_FULL / RTOS_ERROR_EMPTY instead).
+ * *higher_priority_task_woken is set to true (never cleared) when the woken
+ * task should preempt the interrupted one; call rtos_port_yield() once at
+ * exit if it is set. May be NULL.
+ */
+rtos_status_t rtos_stream_buffer_send_from_isr(rtos_stream_buffer_t *sb, const void *data, uint32_t len,
+                                               uint32_t *bytes_sent, bool *higher_priority_task_woken);
+rtos_status_t rtos_stream_buffer_receive_from_isr(rtos_stream_buffer_t *sb, void *buffer, uint32_t max_len,
+                                                  uint32_t *bytes_received, bool *higher_priority_task_woken);
+
+/**
+ * @brief Change the number of bytes that wakes a blocked reader
+ * @return RTOS_SUCCESS, or RTOS_ERROR_INVALID_PARAM (message buffers, out of range)
+ */
+rtos_status_t rtos_stream_buffer_set_trigger_level(rtos_stream_buffer_t *sb, uint32_t trigger_level);
+
+uint32_t rtos_stream_buffer_bytes_available(const rtos_stream_buffer_t *sb);
+uint32_t rtos_stream_buffer_spaces_available(const rtos_stream_buffer_t *sb);
+
+/* Discards all data. RTOS_ERROR_INVALID_STATE if a task is blocked on it. */
+rtos_status_t rtos_stream_buffer_reset(rtos_stream_buffer_t *sb);
+
+/* ======================== Message Buffer ================================ */
+
+/**
+ * @brief Initialize a message buffer
+ * @param mb Pointer to message buffer
+ * @param storage Backing storage
+ * @param size Storage size in bytes, a power of 2 >= 4; messages of up to
+ *        RTOS_MESSAGE_BUFFER_MAX_MESSAGE(size) bytes fit
+ * @return RTOS_SUCCESS, or RTOS_ERROR_INVALID_PARAM
+ */
+rtos_status_t rtos_message_buffer_init(rtos_message_buffer_t *mb, uint8_t *storage, uint32_t size);
+
+/**
+ * @brief Write one message, blocking until it fits whole
+ * @param timeout_ticks 0 = no wait, RTOS_MAX_DELAY = forever
+ * @return RTOS_SUCCESS, RTOS_ERROR_FULL (no wait), RTOS_ERROR_TIMEOUT, or
+ *         RTOS_ERROR_INVALID_PARAM (len 0 or too long for the buffer)
+ */
+rtos_status_t rtos_message_buffer_send(rtos_message_buffer_t *mb, const void *message, uint32_t len,
+                                       rtos_tick_t timeout_ticks);
+
+/**
+ * @brief Read the oldest message, blocking while there is none
+ * @param length Receives the message length (may be NULL)
+ * @param timeout_ticks 0 = no wait, RTOS_MAX_DELAY = forever
+ * @return RTOS_SUCCESS, RTOS_ERROR_EMPTY (no wait), RTOS_ERROR_TIMEOUT, or
+ *         RTOS_ERROR_NO_MEMORY if the message is longer than buffer_size
+ *         (it stays queued; *length still reports its size)
+ */
+rtos_status_t rtos_message_buffer_receive(rtos_message_buffer_t *mb, void *buffer, uint32_t buffer_size,
+                                          uint32_t *length, rtos_tick_t timeout_ticks);
+
+/* ISR variants, as for the stream buffer */
+rtos_status_t rtos_message_buffer_send_from_isr(rtos_message_buffer_t *mb, const void *message, uint32_t len,
+                                                bool *higher_priority_task_woken);
+rtos_status_t rtos_message_buffer_receive_from_isr(rtos_message_buffer_t *mb, void *buffer, uint32_t buffer_size,
+                                                   uint32_t *length, bool *higher_priority_task_woken);
+
+/* Bytes of the next message, 0 if the buffer is empty */
+uint32_t rtos_message_buffer_next_length(const rtos_message_buffer_t *mb);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STREAM_BUFFER_H */
@@ -1,7 +1,9 @@
 #ifndef RTOS_TASK_H
 #define RTOS_TASK_H
 
+#include "config.h"
 #include "rtos_types.h"
+#include "scheduler.h"
 
 #include <stdbool.h>
 
@@ -32,17 +34,207 @@ extern "C"
 rtos_status_t rtos_task_create(rtos_task_function_t task_function, const char *name, rtos_stack_size_t stack_size,
                                void *parameter, rtos_priority_t priority, rtos_task_handle_t *task_handle);
 
+/* Task creation flags for rtos_task_create_ex() */
+#define RTOS_TASK_FLAG_NONE   (0x00U)
+/**
+ * Task never uses the FPU.  While it runs, FPU access is revoked (Cortex-M4:
+ * CPACR CP10/CP11), so it can never build an extended exception frame and
+ * its switches never save or restore S16-S31.  A stray FP instruction in the
+ * task faults instead.  Interrupt handlers that use the FPU must not run
+ * while such a task is current.  No effect on ports without an FPU.
+ */
+#define RTOS_TASK_FLAG_NO_FPU (0x01U)
+
+/**
+ * Core affinity (RTOS_SMP_CORES > 1): the task runs only on the cores whose
+ * flags are set; without any it runs on every core. Naming a core the
+ * kernel does not schedule on is rejected as an invalid parameter.
+ */
+#define RTOS_TASK_FLAG_CORE(n)    (0x02U << (n))
+#define RTOS_TASK_FLAG_CORE_MASK  (RTOS_TASK_FLAG_CORE(0) | RTOS_TASK_FLAG_CORE(1))
+
+/**
+ * @brief Create a new task with creation flags
+ *
+ * Same as rtos_task_create() plus a RTOS_TASK_FLAG_* mask.
+ *
+ * @return RTOS_SUCCESS, RTOS_ERROR_INVALID_PARAM (including unknown flags),
+ *         or RTOS_ERROR_NO_MEMORY
+ */
+rtos_status_t rtos_task_create_ex(rtos_task_function_t task_function, const char *name, rtos_stack_size_t stack_size,
+                                  void *parameter, rtos_priority_t priority, uint8_t flags,
+                                  rtos_task_handle_t *task_handle);
+
+/**
+ * @brief Create a task on a caller-provided stack
+ *
+ * Same as rtos_task_create_ex() but never touches the heap: the stack can
+ * be placed anywhere (e.g. CCM RAM via a linker section) and is not freed
+ * when the task is deleted. The TCB comes from the static task pool as for
+ * every task.
+ *
+ * @param stack_buffer Stack memory, 8-byte aligned
+ * @param stack_size Size of stack_buffer in bytes (>= RTOS_MINIMUM_TASK_STACK_SIZE,
+ *        rounded down to a multiple of 8)
+ *
+ * @return RTOS_SUCCESS, RTOS_ERROR_INVALID_PARAM, or RTOS_ERROR_NO_MEMORY
+ *         (no free TCB)
+ */
+rtos_status_t rtos_task_create_static(rtos_task_function_t task_function, const char *name, uint32_t *stack_buffer,
+                                      rtos_stack_size_t stack_size, void *parameter, rtos_priority_t priority,
+                                      uint8_t flags, rtos_task_handle_t *task_handle);
+
+/**
+ * @brief Set a task's time-slice quantum (RTOS_SCHEDULER_ROUND_ROBIN)
+ *
+ * Tasks start with RTOS_TIME_SLICE_TICKS; call this right after creation to
+ * give batch tasks long turns (fewer switches) and interactive ones short
+ * turns within their priority band.  Other schedulers ignore the quantum.
+ *
+ * @param ticks Quantum in ticks (0 = RTOS_TIME_SLICE_TICKS)
+ *
+ * @return RTOS_SUCCESS or RTOS_ERROR_INVALID_PARAM
+ */
+rtos_status_t rtos_task_set_time_slice(rtos_task_handle_t task_handle, rtos_tick_t ticks);
+
+/**
+ * @brief Set a task's preemption threshold (RTOS_USE_PREEMPTION_THRESHOLD)
+ *
+ * While the task runs, only tasks with a priority above threshold preempt
+ * it; once preempted it resumes ahead of every task it would have held off.
+ * Give a group of tasks that exchange data the threshold of the group's
+ * highest priority and they never preempt one another, so the switches
+ * between them are only those where one blocks. Tasks above the threshold
+ * keep their normal priority preemption. Only RTOS_SCHEDULER_PREEMPTIVE_SP
+ * honours the threshold; rtos_yield() does not hand over to a task at or
+ * below it.
+ *
+ * @param threshold Priority from the task's base priority (no threshold,
+ *                  the default) to RTOS_MAX_TASK_PRIORITIES - 1
+ *
+ * @return RTOS_SUCCESS, RTOS_ERROR_INVALID_PARAM, or
+ *         RTOS_ERROR_INVALID_STATE when RTOS_USE_PREEMPTION_THRESHOLD is 0
+ */
+rtos_status_t rtos_task_set_preemption_threshold(rtos_task_handle_t task_handle, rtos_priority_t threshold);
+
+/* Current preemption threshold; the base priority when the feature is off, 0 for NULL */
+rtos_priority_t rtos_task_get_preemption_threshold(rtos_task_handle_t task_handle);
+
+/**
+ * @brief Create a periodic task
+ *
+ * The first job is released at creation; each call to
+ * rtos_task_wait_for_next_period() ends the current job and blocks until the
+ * next release, period ticks after the previous one. Under RTOS_SCHEDULER_EDF
+ * ready periodic tasks run in order of their current job's absolute deadline
+ * (release + relative_deadline), ahead of all aperiodic tasks; other
+ * schedulers use priority and only get the periodic release.
+ *
+ * With RTOS_ADMISSION_CONTROL enabled, a non-zero wcet enters the task into
+ * admission control: the budgeted task set (existing tasks plus this one) is
+ * checked with response-time analysis, or with the density test
+ * sum(wcet / relative_deadline) <= 1 under RTOS_SCHEDULER_EDF.  Tasks without
+ * a wcet are not part of the analysis.  Each tick that lands in one of the
+ * task's jobs is charged to it; a job that uses more than wcet ticks is
+ * counted once in rtos_task_get_budget_overruns().
+ *
+ * @param priority          Priority for non-EDF schedulers and mutex inheritance;
+ *                          EDF uses it only to order equal deadlines
+ * @param period            Release period in ticks (> 0)
+ * @param relative_deadline Deadline in ticks after each release (0 = period)
+ * @param wcet              Worst-case execution time per job in ticks
+ *                          (0 = no budget, <= relative_deadline)
+ *
+ * @return RTOS_SUCCESS, RTOS_ERROR_INVALID_PARAM (also when
+ *         relative_deadline > period or wcet > relative_deadline),
+ *         RTOS_ERROR_NOT_SCHEDULABLE (RTOS_ADMISSION_REJECT only),
+ *         RTOS_ERROR_NO_MEMORY, or RTOS_ERROR_INVALID_STATE when
+ *         RTOS_USE_PERIODIC_TASKS is 0
+ */
+rtos_status_t rtos_task_create_periodic(rtos_task_function_t task_function, const char *name,
+                                        rtos_stack_size_t stack_size, void *parameter, rtos_priority_t priority,
+                                        rtos_period_t period, rtos_deadline_t relative_deadline, rtos_tick_t wcet,
+                                        rtos_task_handle_t *task_handle);
+
+/**
+ * @brief End the calling periodic task's job and wait for the next release
+ *
+ * A job that ends after its deadline is counted as a deadline miss. Releases
+ * stay on the period grid, so a task that overran past its next release runs
+ * that job immediately without blocking.
+ *
+ * @return RTOS_SUCCESS, RTOS_ERROR_TIMEOUT if the finished job missed its
+ *         deadline, or RTOS_ERROR_INVALID_STATE if the caller is not periodic
+ *         (always when RTOS_USE_PERIODIC_TASKS is 0)
+ */
+rtos_status_t rtos_task_wait_for_next_period(void);
+
+/**
+ * @brief Get the absolute deadline (tick) of a task's current job
+ *
+ * @return Deadline tick, 0 for a NULL handle or when RTOS_USE_PERIODIC_TASKS
+ *         is 0 (meaningless for aperiodic tasks)
+ */
+rtos_tick_t rtos_task_get_deadline(rtos_task_handle_t task_handle);
+
+/**
+ * @brief Get the number of jobs a periodic task completed after their deadline
+ *
+ * Always 0 when RTOS_USE_PERIODIC_TASKS is 0.
+ */
+uint32_t rtos_task_get_deadline_misses(rtos_task_handle_t task_handle);
+
+/**
+ * @brief Get the number of jobs that ran past their WCET budget
+ *
+ * Always 0 unless RTOS_ADMISSION_CONTROL is enabled (which keeps
+ * RTOS_USE_PERIODIC_TASKS on) and the task has a wcet.
+ */
+uint32_t rtos_task_get_budget_overruns(rtos_task_handle_t task_handle);
+
+/**
+ * @brief Attach a deferrable budget server to a task (RTOS_USE_BUDGET_SERVER)
+ *
+ * The task keeps its current priority as the foreground priority while it
+ * has budget.  Each tick it is running costs one tick; once budget ticks
+ * are used up within a period it drops to background_priority until the
+ * next replenishment, budget refilled every period ticks.  Meant for
+ * aperiodic work (e.g. a network handler) that must not starve the tasks
+ * below it under overload.  Mutex priority inheritance still applies on top
+ * of the server priority.  Calling it again reconfigures the server and
+ * starts a full budget; budget == 0 removes the server.
+ *
+ * @param budget              Foreground ticks per period (0 = remove, <= period)
+ * @param period              Replenishment period in ticks
+ * @param background_priority Priority while exhausted, below the foreground one
+ *
+ * @return RTOS_SUCCESS, RTOS_ERROR_INVALID_PARAM, or RTOS_ERROR_INVALID_STATE
+ *         (deleted or idle task, or RTOS_USE_BUDGET_SERVER is 0)
+ */
+rtos_status_t rtos_task_set_budget_server(rtos_task_handle_t task_handle, rtos_tick_t budget, rtos_tick_t period,
+                                          rtos_priority_t background_priority);
+
+/**
+ * @brief Get the budget left in a server task's current period (0 without a server)
+ */
+rtos_tick_t rtos_task_get_server_budget(rtos_task_handle_t task_handle);
+
+/**
+ * @brief Get the number of periods in which a server task exhausted its budget
+ */
+uint32_t rtos_task_get_server_exhaustions(rtos_task_handle_t task_handle);
+
 /**
  * @brief Get the idle task's TCB (Task Control Block)
  *
- * @return Pointer to the idle task's TCB
+ * @return Pointer to the calling core's idle task TCB (NULL before rtos_init())
  */
 rtos_tcb_t *rtos_task_get_idle_task(void);
 
 /**
  * @brief Get the current running task handle
  *
- * @return Handle of the currently running task, NULL if no task running
+ * @return Handle of the task running on the calling core, NULL if none
  */
 rtos_task_handle_t rtos_task_get_current(void);
 
@@ -109,6 +301,79 @@ rtos_status_t rtos_task_delete(rtos_task_handle_t task_handle);
  */
 bool rtos_task_check_stack(rtos_task_handle_t task_handle);
 
+/**
+ * @brief Get a task's stack high-water mark as the bytes it never used
+ *
+ * Stacks are painted with PORT_STACK_FILL_VALUE at creation. The idle task
+ * rescans them RTOS_STACK_SCAN_WORDS words per loop, one task at a time, so
+ * the value can trail a new peak until the idle task has run. Counts from
+ * the lowest word above the canary (and the MPU guard, if enabled).
+ *
+ * @return Unused bytes, or 0 for NULL or when RTOS_ENABLE_STACK_WATERMARK is 0
+ */
+uint32_t rtos_task_get_stack_unused(rtos_task_handle_t task_handle);
+
+/** Stack use of every task slot, filled by rtos_task_get_memory_stats() */
+typedef struct
+{
+    uint32_t total_stack_memory;                    /**< Stack bytes of all live tasks */
+    uint32_t used_stack_memory;                     /**< Peak use: total minus never-used bytes */
+    uint32_t free_stack_memory;                     /**< Never-used bytes summed over live tasks */
+    uint8_t  total_task_slots;                      /**< RTOS_MAX_TASKS */
+    uint8_t  used_task_slots;                       /**< Slots holding a task */
+    uint8_t  free_task_slots;                       /**< Slots left for rtos_task_create() */
+    uint32_t per_task_stack_size[RTOS_MAX_TASKS];   /**< Stack size by task id, 0 = free slot */
+    uint32_t per_task_stack_unused[RTOS_MAX_TASKS]; /**< rtos_task_get_stack_unused() by task id */
+} rtos_task_memory_stats_t;
+
+/**
+ * @brief Get stack sizes and high-water marks of all tasks
+ *
+ * With RTOS_ENABLE_STACK_WATERMARK 0 the unused fields stay 0, so used
+ * equals total.
+ *
+ * @return RTOS_SUCCESS, or RTOS_ERROR_INVALID_PARAM for NULL
+ */
+rtos_status_t rtos_task_get_memory_stats(rtos_task_memory_stats_t *stats);
+
+/** Per-task CPU usage, filled by rtos_task_get_runtime_stats() */
+typedef struct
+{
+    rtos_task_id_t task_id;
+    const char    *name;
+    uint64_t       total_cycles;  /**< DWT cycles run since the task was created */
+    uint64_t       window_cycles; /**< DWT cycles run inside the reporting window */
+    uint16_t       cpu_permille;  /**< Share of the window, in 0.1 % units */
+} rtos_task_runtime_t;
+
+/** System-wide totals for the same reporting window */
+typedef struct
+{
+    uint8_t  task_count;    /**< Entries written to the task array */
+    uint64_t window_cycles; /**< Cycles covered by the window, summed over all tasks */
+    uint16_t idle_permille; /**< Idle task's share of the window, in 0.1 % units */
+} rtos_runtime_stats_t;
+
+/**
+ * @brief Get per-task CPU runtime from the DWT cycle counter
+ *
+ * Each task is charged the cycles between being switched in and switched
+ * out; interrupt time is charged to the task it interrupted. The window
+ * covers the last one to two RTOS_RUNTIME_WINDOW_MS periods and slides
+ * forward one period at a time, so percentages track recent load rather
+ * than the average since boot.
+ *
+ * Call at least once per CYCCNT wrap (~25 s at 168 MHz) if a task may run
+ * that long without being switched out.
+ *
+ * @param tasks     Array receiving one entry per live task (may be NULL if max_tasks is 0)
+ * @param max_tasks Capacity of tasks
+ * @param stats     Receives the window length and idle share
+ * @return RTOS_SUCCESS, RTOS_ERROR_INVALID_PARAM, or RTOS_ERROR_INVALID_STATE
+ *         when RTOS_PROFILING_SYSTEM_ENABLED is 0
+ */
+rtos_status_t rtos_task_get_runtime_stats(rtos_task_runtime_t *tasks, uint8_t max_tasks, rtos_runtime_stats_t *stats);
+
 typedef enum
 {
     RTOS_NOTIFY_ACTION_NONE = 0,  /**< Just set pending, don't modify value */
@@ -131,10 +396,19 @@ typedef enum
 #define RTOS_NOTIFY_CLEAR_NONE ((uint32_t) 0x00000000U) /**< Clear no bits */
 #define RTOS_NOTIFY_CLEAR_ALL  ((uint32_t) 0xFFFFFFFFU) /**< Clear all bits */
 
+/*
+ * Each task has RTOS_TASK_NOTIFY_ARRAY_ENTRIES independent notification slots.
+ * The non-indexed calls use slot RTOS_TASK_NOTIFY_DEFAULT_INDEX; the _indexed
+ * variants take the slot explicitly, and a task blocked on one slot is not
+ * woken by notifications sent to another.
+ */
+#define RTOS_TASK_NOTIFY_DEFAULT_INDEX (0U)
+
 /**
  * @brief Send a notification to a task with a specific action.
  *
- * Can be called from ISR context. Never blocks the caller.
+ * Never blocks the caller, but may switch to the woken task; from an ISR
+ * use rtos_task_notify_from_isr().
  *
  * @param task    Handle to the target task
  * @param value   Value to apply (meaning depends on action)
@@ -154,6 +428,36 @@ rtos_notify_status_t rtos_task_notify(rtos_task_handle_t task, uint32_t value, r
  */
 rtos_notify_status_t rtos_task_notify_give(rtos_task_handle_t task);
 
+/**
+ * @brief Send a notification to a task from an ISR.
+ *
+ * Same actions as rtos_task_notify(), under the ISR critical section and
+ * without switching context, so a handler that notifies several tasks
+ * pends a single PendSV at exit.
+ *
+ * @param task    Handle to the target task
+ * @param value   Value to apply (meaning depends on action)
+ * @param action  How to modify the target task's notification value
+ * @param higher_priority_task_woken Set to true (never cleared) when the woken
+ *        task should preempt the interrupted one; call rtos_port_yield() once
+ *        at ISR exit if it is set. May be NULL.
+ * @return RTOS_NOTIFY_OK on success, RTOS_NOTIFY_ERR_INVALID if task is NULL
+ */
+rtos_notify_status_t rtos_task_notify_from_isr(rtos_task_handle_t task, uint32_t value, rtos_notify_action_t action,
+                                               bool *higher_priority_task_woken);
+
+/**
+ * @brief Simplified notify from an ISR: increment the target's value.
+ *
+ * Equivalent to rtos_task_notify_from_isr(task, 0, RTOS_NOTIFY_ACTION_INCREMENT,
+ * higher_priority_task_woken).
+ *
+ * @param task  Handle to the target task
+ * @param higher_priority_task_woken See rtos_task_notify_from_isr(). May be NULL.
+ * @return RTOS_NOTIFY_OK on success
+ */
+rtos_notify_status_t rtos_task_notify_give_from_isr(rtos_task_handle_t task, bool *higher_priority_task_woken);
+
 /**
  * @brief Wait for a notification with bit-level control.
  *
@@ -177,6 +481,49 @@ rtos_notify_status_t rtos_task_notify_wait(uint32_t entry_clear_bits, uint32_t e
  */
 rtos_notify_status_t rtos_task_notify_take(bool clear_on_exit, rtos_tick_t timeout_ticks);
 
+/**
+ * @brief rtos_task_notify() on notification slot `index`.
+ *
+ * @return RTOS_NOTIFY_OK on success, RTOS_NOTIFY_ERR_INVALID if task is NULL
+ *         or index >= RTOS_TASK_NOTIFY_ARRAY_ENTRIES
+ */
+rtos_notify_status_t rtos_task_notify_indexed(rtos_task_handle_t task, uint8_t index, uint32_t value,
+                                              rtos_notify_action_t action);
+
+/**
+ * @brief rtos_task_notify_give() on notification slot `index`.
+ */
+rtos_notify_status_t rtos_task_notify_give_indexed(rtos_task_handle_t task, uint8_t index);
+
+/**
+ * @brief rtos_task_notify_from_isr() on notification slot `index`.
+ */
+rtos_notify_status_t rtos_task_notify_indexed_from_isr(rtos_task_handle_t task, uint8_t index, uint32_t value,
+                                                       rtos_notify_action_t action, bool *higher_priority_task_woken);
+
+/**
+ * @brief rtos_task_notify_give_from_isr() on notification slot `index`.
+ */
+rtos_notify_status_t rtos_task_notify_give_indexed_from_isr(rtos_task_handle_t task, uint8_t index,
+                                                            bool *higher_priority_task_woken);
+
+/**
+ * @brief rtos_task_notify_wait() on notification slot `index`.
+ *
+ * @return RTOS_NOTIFY_OK on success, RTOS_NOTIFY_ERR_TIMEOUT if timed out,
+ *         RTOS_NOTIFY_ERR_INVALID if index >= RTOS_TASK_NOTIFY_ARRAY_ENTRIES
+ */
+rtos_notify_status_t rtos_task_notify_wait_indexed(uint8_t index, uint32_t entry_clear_bits, uint32_t exit_clear_bits,
+                                                   uint32_t *value_out, rtos_tick_t timeout_ticks);
+
+/**
+ * @brief rtos_task_notify_take() on notification slot `index`.
+ *
+ * @return RTOS_NOTIFY_OK on success, RTOS_NOTIFY_ERR_TIMEOUT if timed out,
+ *         RTOS_NOTIFY_ERR_INVALID if index >= RTOS_TASK_NOTIFY_ARRAY_ENTRIES
+ */
+rtos_notify_status_t rtos_task_notify_take_indexed(uint8_t index, bool clear_on_exit, rtos_tick_t timeout_ticks);
+
 #ifdef __cplusplus
 }
 #endif
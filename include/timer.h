@@ -1,6 +1,7 @@
 #ifndef RTOS_TIMER_H
 #define RTOS_TIMER_H
 
+#include "config.h"
 #include "rtos_types.h"
 
 #ifdef __cplusplus
@@ -22,11 +23,14 @@ typedef enum
  * @param timer_handle Handle of the timer that expired
  * @param parameter User parameter provided at creation
  *
- * @warning Timer callbacks execute in ISR context (SysTick handler).
- *          They must NOT call blocking RTOS APIs (rtos_mutex_lock,
- *          rtos_semaphore_wait, rtos_delay_ms, etc.). Keep callbacks
- *          short to avoid tick jitter. Use ISR-safe APIs only
- *          (e.g. rtos_event_group_set_bits_from_isr, rtos_task_notify).
+ * With RTOS_USE_DEFERRED_WORK (default) callbacks run in the deferred
+ * daemon task, which also runs rtos_deferred_post() work; otherwise they
+ * execute in ISR context (SysTick handler).
+ *
+ * @warning Either way they must NOT call blocking RTOS APIs
+ *          (rtos_mutex_lock, rtos_semaphore_wait, rtos_delay_ms, etc.):
+ *          in the daemon that stalls every later timer and work item.
+ *          Keep callbacks short.
  */
 typedef void (*rtos_timer_callback_t)(void *timer_handle, void *parameter);
 
@@ -51,6 +55,27 @@ typedef rtos_timer_t     *rtos_timer_handle_t;
 rtos_status_t rtos_timer_create(const char *name, rtos_tick_t period_ticks, rtos_timer_mode_t mode,
                                 rtos_timer_callback_t callback, void *parameter, rtos_timer_handle_t *timer_handle);
 
+/* Pointer-sized words of private timer state (more with the daemon and the wheel) */
+#define RTOS_TIMER_STATIC_WORDS (10U + (RTOS_USE_DEFERRED_WORK ? 1U : 0U) + (RTOS_USE_TIMING_WHEEL ? 4U : 0U))
+
+/**
+ * @brief Caller-provided timer storage for rtos_timer_create_static(); contents are private
+ */
+typedef struct rtos_timer_static
+{
+    void *opaque[RTOS_TIMER_STATIC_WORDS];
+} rtos_timer_static_t;
+
+/**
+ * @brief Create a software timer in caller-provided storage
+ *
+ * Same as rtos_timer_create() without the heap. *timer_buffer must outlive
+ * the timer; rtos_timer_delete() stops it but does not release the storage.
+ */
+rtos_status_t rtos_timer_create_static(const char *name, rtos_tick_t period_ticks, rtos_timer_mode_t mode,
+                                       rtos_timer_callback_t callback, void *parameter,
+                                       rtos_timer_static_t *timer_buffer, rtos_timer_handle_t *timer_handle);
+
 /**
  * @brief Start a timer
  *
@@ -77,7 +102,27 @@ rtos_status_t rtos_timer_stop(rtos_timer_handle_t timer_handle);
 rtos_status_t rtos_timer_change_period(rtos_timer_handle_t timer_handle, rtos_tick_t new_period_ticks);
 
 /**
- * @brief Delete a timer and free resources
+ * @brief Let a timer fire up to slack_ticks late so its expiry batches with others
+ *
+ * When armed, a timer with slack fires at the earliest expiry already
+ * scheduled for another timer within [deadline, deadline + slack_ticks],
+ * or at its deadline if there is none, so timers with unrelated periods
+ * share wake-ups and tickless idle sleeps longer.  It never fires early,
+ * and an auto-reload timer's deadlines still step by exactly its period,
+ * so the lateness does not accumulate.  For auto-reload timers the slack
+ * is capped at period - 1.
+ *
+ * Takes effect the next time the timer is armed (start, change_period or
+ * reload).  0 (the default) fires exactly at the deadline.
+ *
+ * @param timer_handle Timer to modify
+ * @param slack_ticks Largest acceptable lateness in ticks
+ * @return RTOS_SUCCESS or RTOS_ERROR_INVALID_PARAM
+ */
+rtos_status_t rtos_timer_set_slack(rtos_timer_handle_t timer_handle, rtos_tick_t slack_ticks);
+
+/**
+ * @brief Delete a timer and free resources (static timers: stop only)
  *
  * @param timer_handle Timer to delete
  * @return RTOS_SUCCESS or error
@@ -86,6 +131,9 @@ rtos_status_t rtos_timer_delete(rtos_timer_handle_t timer_handle);
 
 /**
  * @brief Process timer ticks (Called by Kernel)
+ *
+ * With RTOS_USE_DEFERRED_WORK this only checks whether a timer is due and
+ * wakes the deferred daemon.
  */
 void rtos_timer_tick(void);
 
@@ -0,0 +1,314 @@
+#ifndef VRTOS_HPP
+#define VRTOS_HPP
+
+#include "config.h"
+#include "mutex.h"
+#include "queue.h"
+#include "rtos_types.h"
+#include "task.h"
+
+#include <new>
+#include <stdint.h>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @file vrtos.hpp
+ * @brief Header-only C++ wrappers over the C API
+ *
+ * Typed front ends for queues, static tasks and mutexes. Every object keeps
+ * its storage inside itself (no rtos_malloc) and sizes it at compile time,
+ * so a Queue<T, N> or Task<StackBytes> placed at namespace scope lands in
+ * .bss like the static C objects it wraps. Configuration mistakes - an
+ * empty queue, a stack below RTOS_MINIMUM_TASK_STACK_SIZE - fail to
+ * compile instead of returning RTOS_ERROR_INVALID_PARAM at run time.
+ *
+ * Constructors never touch the kernel: a global's constructor runs before
+ * rtos_init(). Call create() / start() / init() from main() or a task, and
+ * check the returned status as for the C calls. Nothing here throws,
+ * allocates or uses RTTI, so -fno-exceptions -fno-rtti builds are fine.
+ */
+
+namespace vrtos
+{
+    /**
+     * @brief Fixed-capacity queue of N items of type T
+     *
+     * T must be trivially copyable: the kernel moves items with memcpy on
+     * the ISR and reset paths and never runs destructors.
+     *
+     * Items larger than in_place_min_bytes go through the zero-copy API, so
+     * the copy into or out of the slot is a fixed-size T copy the
+     * compiler inlines (or a constructor / callback run in the slot itself
+     * with emplace() / consume()) rather than a memcpy of a run-time length.
+     * That costs a second kernel call, which small items do not win back,
+     * so they use the copying calls like the C API. Either way a held slot
+     * makes the queue look full (empty) to other senders (receivers) only
+     * for the duration of the copy.
+     */
+    template <typename T, uint32_t N> class Queue
+    {
+        static_assert(N > 0U, "Queue needs at least one slot");
+        static_assert(std::is_trivially_copyable<T>::value, "Queue items are copied with memcpy");
+        static_assert(sizeof(T) <= UINT32_MAX / N, "Queue storage does not fit in uint32_t");
+        static_assert(N <= static_cast<rtos_queue_count_t>(-1) && sizeof(T) <= static_cast<rtos_queue_count_t>(-1),
+                      "Queue length or item size does not fit rtos_queue_count_t");
+
+    public:
+        static constexpr uint32_t capacity           = N;
+        static constexpr uint32_t item_size          = sizeof(T);
+        static constexpr uint32_t in_place_min_bytes = 16U;
+        static constexpr bool     in_place           = (sizeof(T) > in_place_min_bytes);
+
+        Queue() = default;
+
+        Queue(const Queue &)            = delete;
+        Queue &operator=(const Queue &) = delete;
+
+        /** rtos_queue_create_static() on the in-object storage */
+        rtos_status_t create()
+        {
+            return rtos_queue_create_static(&handle_, &control_, storage_, N, sizeof(T));
+        }
+
+        /** rtos_queue_delete(); the object can be created again afterwards */
+        rtos_status_t destroy()
+        {
+            rtos_status_t status = rtos_queue_delete(handle_);
+            if (status == RTOS_SUCCESS)
+            {
+                handle_ = nullptr;
+            }
+            return status;
+        }
+
+        /* timeout_ticks: 0=non-blocking, RTOS_MAX_DELAY=forever */
+        rtos_status_t send(const T &item, rtos_tick_t timeout_ticks = RTOS_MAX_DELAY)
+        {
+            if (!in_place)
+            {
+                return rtos_queue_send(handle_, &item, timeout_ticks);
+            }
+
+            void         *slot   = nullptr;
+            rtos_status_t status = rtos_queue_send_acquire(handle_, &slot, timeout_ticks);
+            if (status != RTOS_SUCCESS)
+            {
+                return status;
+            }
+            ::new (slot) T(item);
+            return rtos_queue_send_commit(handle_);
+        }
+
+        /* timeout_ticks: 0=non-blocking, RTOS_MAX_DELAY=forever */
+        rtos_status_t receive(T &item, rtos_tick_t timeout_ticks = RTOS_MAX_DELAY)
+        {
+            if (!in_place)
+            {
+                return rtos_queue_receive(handle_, &item, timeout_ticks);
+            }
+
+            const void   *slot   = nullptr;
+            rtos_status_t status = rtos_queue_receive_peek(handle_, &slot, timeout_ticks);
+            if (status != RTOS_SUCCESS)
+            {
+                return status;
+            }
+            item = *static_cast<const T *>(slot);
+            return rtos_queue_receive_release(handle_);
+        }
+
+        /**
+         * @brief Construct the item directly in the next free slot
+         *
+         * No temporary and no copy whatever the size of T. Blocks like
+         * send(); the constructor runs with the slot held, so keep it short.
+         */
+        template <typename... Args> rtos_status_t emplace(rtos_tick_t timeout_ticks, Args &&...args)
+        {
+            void         *slot   = nullptr;
+            rtos_status_t status = rtos_queue_send_acquire(handle_, &slot, timeout_ticks);
+            if (status != RTOS_SUCCESS)
+            {
+                return status;
+            }
+            ::new (slot) T(std::forward<Args>(args)...);
+            return rtos_queue_send_commit(handle_);
+        }
+
+        /**
+         * @brief Hand the oldest item to fn(const T &) in place, then free its slot
+         *
+         * Blocks like receive(); fn runs with the slot held and must not
+         * block or touch this queue.
+         */
+        template <typename Fn> rtos_status_t consume(Fn &&fn, rtos_tick_t timeout_ticks = RTOS_MAX_DELAY)
+        {
+            const void   *slot   = nullptr;
+            rtos_status_t status = rtos_queue_receive_peek(handle_, &slot, timeout_ticks);
+            if (status != RTOS_SUCCESS)
+            {
+                return status;
+            }
+            fn(*static_cast<const T *>(slot));
+            return rtos_queue_receive_release(handle_);
+        }
+
+        /* ISR variants: never block; see rtos_queue_send_from_isr() */
+        rtos_status_t send_from_isr(const T &item, bool *higher_priority_task_woken)
+        {
+            return rtos_queue_send_from_isr(handle_, &item, higher_priority_task_woken);
+        }
+
+        rtos_status_t receive_from_isr(T &item, bool *higher_priority_task_woken)
+        {
+            return rtos_queue_receive_from_isr(handle_, &item, higher_priority_task_woken);
+        }
+
+        uint32_t messages_waiting() const
+        {
+            return rtos_queue_messages_waiting(handle_);
+        }
+
+        uint32_t spaces_available() const
+        {
+            return rtos_queue_spaces_available(handle_);
+        }
+
+        /* Warning: does not wake waiting receivers, like rtos_queue_reset() */
+        rtos_status_t reset()
+        {
+            return rtos_queue_reset(handle_);
+        }
+
+        /** C handle, e.g. for rtos_queue_set_add(); NULL until create() */
+        rtos_queue_handle_t handle() const
+        {
+            return handle_;
+        }
+
+    private:
+        rtos_queue_static_t control_;
+        alignas(T) uint8_t  storage_[N * sizeof(T)];
+        rtos_queue_handle_t handle_ = nullptr;
+    };
+
+    /**
+     * @brief Task with a StackBytes-byte stack inside the object
+     *
+     * Wraps rtos_task_create_static(): the TCB still comes from the static
+     * task pool, so start() can fail with RTOS_ERROR_NO_MEMORY when
+     * RTOS_MAX_TASKS are alive.
+     */
+    template <uint32_t StackBytes> class Task
+    {
+        static_assert(StackBytes >= RTOS_MINIMUM_TASK_STACK_SIZE, "Stack below RTOS_MINIMUM_TASK_STACK_SIZE");
+        static_assert((StackBytes % 8U) == 0U, "Stack size must be a multiple of 8 bytes (AAPCS alignment)");
+        static_assert(StackBytes <= static_cast<rtos_stack_size_t>(-1), "Stack size does not fit rtos_stack_size_t");
+
+    public:
+        static constexpr uint32_t stack_bytes = StackBytes;
+
+        Task() = default;
+
+        Task(const Task &)            = delete;
+        Task &operator=(const Task &) = delete;
+
+        rtos_status_t start(rtos_task_function_t task_function, const char *name, void *parameter,
+                            rtos_priority_t priority, uint8_t flags = RTOS_TASK_FLAG_NONE)
+        {
+            return rtos_task_create_static(task_function, name, stack_, StackBytes, parameter, priority, flags,
+                                           &handle_);
+        }
+
+        /** NULL until start() */
+        rtos_task_handle_t handle() const
+        {
+            return handle_;
+        }
+
+    private:
+        alignas(8) uint32_t stack_[StackBytes / sizeof(uint32_t)];
+        rtos_task_handle_t  handle_ = nullptr;
+    };
+
+    /**
+     * @brief rtos_mutex_t kept in the object
+     *
+     * init() (or init_ceiling()) once before first use, as in C.
+     */
+    class Mutex
+    {
+    public:
+        Mutex() = default;
+
+        Mutex(const Mutex &)            = delete;
+        Mutex &operator=(const Mutex &) = delete;
+
+        rtos_mutex_status_t init()
+        {
+            return rtos_mutex_init(&mutex_);
+        }
+
+        rtos_mutex_status_t init_ceiling(rtos_priority_t ceiling)
+        {
+            return rtos_mutex_init_ceiling(&mutex_, ceiling);
+        }
+
+        rtos_mutex_status_t lock(rtos_tick_t timeout_ticks = RTOS_MAX_WAIT)
+        {
+            return rtos_mutex_lock(&mutex_, timeout_ticks);
+        }
+
+        rtos_mutex_status_t unlock()
+        {
+            return rtos_mutex_unlock(&mutex_);
+        }
+
+        /** The C object, for APIs that take an rtos_mutex_t * */
+        rtos_mutex_t *native()
+        {
+            return &mutex_;
+        }
+
+    private:
+        rtos_mutex_t mutex_;
+    };
+
+    /**
+     * @brief Scoped lock: locks in the constructor, unlocks in the destructor
+     *
+     * With a timeout the lock may fail; check owns_lock() before touching
+     * the protected data. The destructor only unlocks what it locked.
+     */
+    class LockGuard
+    {
+    public:
+        explicit LockGuard(Mutex &mutex, rtos_tick_t timeout_ticks = RTOS_MAX_WAIT)
+            : mutex_(mutex), owns_(mutex.lock(timeout_ticks) == RTOS_MUTEX_OK)
+        {
+        }
+
+        ~LockGuard()
+        {
+            if (owns_)
+            {
+                mutex_.unlock();
+            }
+        }
+
+        LockGuard(const LockGuard &)            = delete;
+        LockGuard &operator=(const LockGuard &) = delete;
+
+        bool owns_lock() const
+        {
+            return owns_;
+        }
+
+    private:
+        Mutex &mutex_;
+        bool   owns_;
+    };
+} // namespace vrtos
+
+#endif /* VRTOS_HPP */
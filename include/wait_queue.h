@@ -0,0 +1,120 @@
+#ifndef WAIT_QUEUE_H
+#define WAIT_QUEUE_H
+
+#include "config.h"
+#include "prio_bitmap.h"
+#include "rtos_types.h"
+
+/**
+ * @file wait_queue.h
+ * @brief Priority wait queue shared by the sync objects
+ *
+ * One FIFO bucket per priority level plus a bitmap of non-empty buckets, so
+ * insert, remove and pop-highest are O(1) whatever the number of waiters.
+ * Each wait queue holds one head pointer per priority level plus the bitmap:
+ * 36 bytes at 8 levels, 268 at 64 and 1060 at 256 on Cortex-M (twice the
+ * pointers on a 64-bit host). Queues embed two and rwlocks two; at 256
+ * levels use RTOS_FOOTPRINT_COMPACT where that RAM matters.
+ * Waiters of equal priority are served in arrival order.
+ *
+ * With RTOS_FOOTPRINT_COMPACT the queue is a single circular list kept in
+ * priority order instead: one pointer per wait queue, O(1) pop, and an
+ * insert that walks past the waiters of higher or equal priority.
+ *
+ * Embedded in semaphores, mutexes, queues, event groups and memory pools;
+ * the functions are kernel-internal and must be called inside a critical
+ * section.
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Forward declaration for TCB */
+struct rtos_task_control_block;
+
+#if RTOS_FOOTPRINT_COMPACT
+/**
+ * @brief Wait queue structure (compact)
+ *
+ * head is the oldest highest-priority waiter; the list runs through
+ * tcb->next_waiting / prev_waiting in service order and wraps back to head.
+ */
+typedef struct rtos_wait_queue
+{
+    struct rtos_task_control_block *head; /**< Next task to serve, NULL = none */
+} rtos_wait_queue_t;
+#else
+/**
+ * @brief Wait queue structure
+ *
+ * heads[p] is the oldest waiter queued at priority p; each bucket is a
+ * circular list through tcb->next_waiting / prev_waiting.
+ */
+typedef struct rtos_wait_queue
+{
+    struct rtos_task_control_block *heads[RTOS_MAX_TASK_PRIORITIES]; /**< Oldest waiter per priority */
+    rtos_prio_bitmap_t              priorities;                      /**< Bit p set = heads[p] non-empty */
+} rtos_wait_queue_t;
+#endif
+
+/**
+ * @brief Empty a wait queue
+ */
+void rtos_wait_queue_init(rtos_wait_queue_t *wq);
+
+/**
+ * @brief Append a task to the bucket of its current priority
+ *
+ * The bucket is recorded in the TCB, so a later priority change does not
+ * break remove(); use rtos_wait_queue_requeue() to move the task.
+ */
+void rtos_wait_queue_insert(rtos_wait_queue_t *wq, struct rtos_task_control_block *task);
+
+/**
+ * @brief Unlink a task; no-op if it is not queued on this wait queue
+ */
+void rtos_wait_queue_remove(rtos_wait_queue_t *wq, struct rtos_task_control_block *task);
+
+/**
+ * @brief Unlink and return the oldest highest-priority waiter, or NULL
+ */
+struct rtos_task_control_block *rtos_wait_queue_pop(rtos_wait_queue_t *wq);
+
+/**
+ * @brief Oldest highest-priority waiter without unlinking it, or NULL
+ */
+struct rtos_task_control_block *rtos_wait_queue_peek(const rtos_wait_queue_t *wq);
+
+/**
+ * @brief Waiter after `task` in service order, or NULL
+ *
+ * With peek() this walks the queue highest priority first; fetch the next
+ * waiter before removing the current one.
+ */
+struct rtos_task_control_block *rtos_wait_queue_next(const rtos_wait_queue_t *wq,
+                                                     const struct rtos_task_control_block *task);
+
+/**
+ * @brief Move a task queued here to the bucket of its (changed) priority
+ */
+void rtos_wait_queue_requeue(rtos_wait_queue_t *wq, struct rtos_task_control_block *task);
+
+/**
+ * @brief True if no task is waiting
+ */
+static inline bool rtos_wait_queue_is_empty(const rtos_wait_queue_t *wq)
+{
+#if RTOS_FOOTPRINT_COMPACT
+    return wq->head == NULL;
+#else
+    return rtos_prio_bitmap_is_empty(&wq->priorities);
+#endif
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WAIT_QUEUE_H */
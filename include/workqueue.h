@@ -0,0 +1,194 @@
+#ifndef RTOS_WORKQUEUE_H
+#define RTOS_WORKQUEUE_H
+
+#include "VRTOS.h"
+#include "rtos_types.h"
+#include "timer.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @file workqueue.h
+ * @brief Work queues: a fixed pool of worker tasks running submitted jobs
+ *
+ * Offloading a job to a fresh task costs a TCB and stack setup, and a task
+ * per job soon exhausts the TCB pool. A work queue instead starts its
+ * workers once; a job is a caller-owned rtos_work_item_t that submission
+ * links onto a worker's list, so dispatch costs a critical section and one
+ * task notification, about the same as a queue send.
+ *
+ *     static rtos_work_item_t g_flush_work;
+ *
+ *     rtos_work_init(&g_flush_work, flush_log, NULL);
+ *     rtos_work_submit(&g_wq, &g_flush_work, RTOS_WORK_PRIO_LOW);
+ *
+ * Each worker has a high and a low priority list. Submission picks an idle
+ * worker if there is one, else the one with the fewest jobs queued. A
+ * worker takes its own high priority jobs first, then (with
+ * RTOS_WORKQUEUE_STEALING) high priority jobs queued on other workers, then
+ * low ones in the same order, so a job never waits behind a long or
+ * blocked one while another worker is free. With RTOS_SMP_CORES > 1 the
+ * workers are spread round robin over the cores.
+ *
+ * Jobs of one list run in submission order, but jobs on different workers
+ * run concurrently: a job function that shares state with others locks it.
+ * A job may block, and may resubmit or free its own item: the worker is
+ * done with the item before calling the function. Workers sleep on their
+ * task notification, so a job must not take the worker's own.
+ *
+ * Delayed work is held on a list sorted by due tick and moved to the
+ * worker lists by a one-shot software timer, so it needs
+ * RTOS_USE_DEFERRED_WORK.
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+struct rtos_work_item;
+struct rtos_workqueue;
+
+/**
+ * @brief Job function, run by a worker task; item may be resubmitted or freed
+ */
+typedef void (*rtos_work_function_t)(struct rtos_work_item *item);
+
+typedef enum
+{
+    RTOS_WORK_PRIO_LOW = 0, /**< Runs when no high priority job is queued */
+    RTOS_WORK_PRIO_HIGH     /**< Runs before every queued low priority job */
+} rtos_work_priority_t;
+
+typedef enum
+{
+    RTOS_WORK_IDLE = 0, /**< Not queued (never submitted, running or finished) */
+    RTOS_WORK_QUEUED,   /**< On a worker list */
+    RTOS_WORK_DELAYED   /**< Waiting for its due tick */
+} rtos_work_state_t;
+
+/**
+ * @brief Job (caller-owned; fields other than parameter are private while queued)
+ */
+typedef struct rtos_work_item
+{
+    struct rtos_work_item *next;      /**< Worker or delayed list link */
+    rtos_work_function_t   function;  /**< Job to run */
+    void                  *parameter; /**< Free for the submitter and the job */
+    struct rtos_workqueue *queue;     /**< Work queue while queued or delayed */
+    rtos_tick_t            due;       /**< Due tick while delayed */
+    uint8_t                worker;    /**< Worker list index while queued */
+    uint8_t                priority;  /**< rtos_work_priority_t */
+    volatile uint8_t       state;     /**< rtos_work_state_t */
+} rtos_work_item_t;
+
+/**
+ * @brief One worker task and its job lists (private)
+ */
+typedef struct rtos_worker
+{
+    struct rtos_workqueue *queue;    /**< Work queue the worker serves */
+    rtos_work_item_t      *head[2];  /**< Oldest job, per priority */
+    rtos_work_item_t      *tail[2];  /**< Newest job, per priority */
+    rtos_task_handle_t     task;     /**< Worker task */
+    uint16_t               queued;   /**< Jobs on both lists */
+    bool                   idle;     /**< Found nothing to run, waiting for a notification */
+    uint32_t               executed; /**< Jobs run by this worker */
+    uint32_t               stolen;   /**< ... of which taken from another worker's list */
+} rtos_worker_t;
+
+/**
+ * @brief Work queue (caller-owned)
+ */
+typedef struct rtos_workqueue
+{
+    rtos_worker_t       workers[RTOS_WORKQUEUE_MAX_WORKERS];
+    uint8_t             count;   /**< Workers started */
+    uint8_t             cursor;  /**< Where the least-loaded search starts */
+    rtos_work_item_t   *delayed; /**< Sorted by due tick, earliest first */
+    rtos_timer_handle_t timer;   /**< Fires at the earliest due tick */
+    rtos_timer_static_t timer_storage;
+} rtos_workqueue_t;
+
+/**
+ * @brief Per-worker counters, for rtos_workqueue_get_stats()
+ */
+typedef struct
+{
+    uint32_t executed; /**< Jobs run by the worker */
+    uint32_t stolen;   /**< Jobs it took from another worker's list */
+    uint16_t queued;   /**< Jobs on its lists now */
+} rtos_worker_stats_t;
+
+/**
+ * @brief Start a work queue's workers
+ *
+ * Worker i runs on stacks[i], stack_size bytes each (8-byte aligned), so
+ * the pool never touches the heap. Call once, before submitting.
+ *
+ * @param count      Workers, 1 .. RTOS_WORKQUEUE_MAX_WORKERS
+ * @param stacks     count stacks of stack_size bytes
+ * @param priority   Priority of every worker
+ * @return RTOS_SUCCESS, RTOS_ERROR_INVALID_PARAM, or RTOS_ERROR_NO_MEMORY
+ *         (no free TCB; the workers already created keep running)
+ */
+rtos_status_t rtos_workqueue_create(rtos_workqueue_t *wq, uint8_t count, uint32_t *const stacks[],
+                                    rtos_stack_size_t stack_size, rtos_priority_t priority);
+
+/**
+ * @brief Prepare a job
+ * @return RTOS_SUCCESS, RTOS_ERROR_INVALID_PARAM, or RTOS_ERROR_INVALID_STATE
+ *         while the item is queued
+ */
+rtos_status_t rtos_work_init(rtos_work_item_t *item, rtos_work_function_t function, void *parameter);
+
+/**
+ * @brief Queue a job to run as soon as a worker is free
+ *
+ * Task context, or the item's own job function.
+ *
+ * @return RTOS_SUCCESS, RTOS_ERROR_INVALID_PARAM, or RTOS_ERROR_INVALID_STATE
+ *         if the item is already queued or delayed
+ */
+rtos_status_t rtos_work_submit(rtos_workqueue_t *wq, rtos_work_item_t *item, rtos_work_priority_t priority);
+
+/**
+ * @brief rtos_work_submit() from an ISR
+ * @param higher_priority_task_woken Set to true (never cleared) when the
+ *        chosen worker should preempt the interrupted task; may be NULL
+ */
+rtos_status_t rtos_work_submit_from_isr(rtos_workqueue_t *wq, rtos_work_item_t *item, rtos_work_priority_t priority,
+                                        bool *higher_priority_task_woken);
+
+/**
+ * @brief Queue a job delay_ticks from now (0 = rtos_work_submit())
+ * @return As rtos_work_submit(); also RTOS_ERROR_INVALID_STATE without
+ *         RTOS_USE_DEFERRED_WORK, or the timer's error if it cannot be armed
+ */
+rtos_status_t rtos_work_submit_delayed(rtos_workqueue_t *wq, rtos_work_item_t *item, rtos_work_priority_t priority,
+                                       rtos_tick_t delay_ticks);
+
+/**
+ * @brief Take a queued or delayed job back before it starts
+ * @return RTOS_SUCCESS, RTOS_ERROR_INVALID_PARAM, or RTOS_ERROR_INVALID_STATE
+ *         if it is not queued (already running, finished or never submitted)
+ */
+rtos_status_t rtos_work_cancel(rtos_work_item_t *item);
+
+/**
+ * @brief True while the item is queued or delayed
+ */
+bool rtos_work_is_pending(const rtos_work_item_t *item);
+
+/**
+ * @brief Read one worker's counters
+ * @return RTOS_SUCCESS or RTOS_ERROR_INVALID_PARAM
+ */
+rtos_status_t rtos_workqueue_get_stats(const rtos_workqueue_t *wq, uint8_t worker, rtos_worker_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RTOS_WORKQUEUE_H */
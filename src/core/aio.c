@@ -0,0 +1,303 @@
+#include "aio.h"
+
+#include "VRTOS.h"
+#include "deferred.h"
+#include "rtos_port.h"
+#include "task.h"
+#include "task_priv.h"
+
+#include <stddef.h>
+
+/*
+ * Completions are pushed onto a LIFO list under a short critical section
+ * and the first completion of a burst posts io_drain() to the deferred
+ * daemon. The drain takes the whole list, reverses it into completion
+ * order and delivers each request: callback, then DONE, notification and
+ * waiter wakeup. A request only becomes reusable once DONE, so a submitter
+ * never races the daemon for its link.
+ *
+ * A post rejected by a full deferred queue leaves g_io_drain_posted clear,
+ * and the next completion posts again.
+ */
+
+static rtos_io_request_t *volatile g_io_completed;    /* Newest first */
+static volatile bool               g_io_drain_posted; /* io_drain() queued and not yet started */
+static rtos_io_request_t *volatile g_io_delivering;   /* Request whose callback is running */
+static volatile bool               g_io_resubmitted;  /* ... and it submitted itself again */
+
+static void io_drain(void *parameter);
+
+/* Caller holds a critical section */
+static bool io_push_locked(rtos_io_request_t *req, rtos_status_t status, uint32_t transferred)
+{
+    if (req->state != RTOS_IO_PENDING)
+    {
+        return false;
+    }
+
+    req->status      = status;
+    req->transferred = transferred;
+    req->state       = RTOS_IO_COMPLETING;
+    req->next        = g_io_completed;
+    g_io_completed   = req;
+
+    return true;
+}
+
+/* Caller holds a critical section; true if this caller must post io_drain() */
+static bool io_claim_post_locked(void)
+{
+    if (g_io_drain_posted)
+    {
+        return false;
+    }
+    g_io_drain_posted = true;
+    return true;
+}
+
+/* Caller holds a critical section. Returns the waiter to wake, if any. */
+static rtos_tcb_t *io_take_waiter_locked(rtos_io_request_t *req)
+{
+    rtos_tcb_t *task = req->waiter;
+
+    if (task != NULL)
+    {
+        req->waiter           = NULL;
+        task->blocked_on      = NULL;
+        task->blocked_on_type = RTOS_SYNC_TYPE_NONE;
+    }
+    return task;
+}
+
+static void io_deliver(rtos_io_request_t *req)
+{
+    if (req->callback != NULL)
+    {
+        g_io_resubmitted = false;
+        g_io_delivering  = req;
+        req->callback(req);
+        g_io_delivering = NULL;
+
+        /* Resubmitted by its callback (and maybe completed again since):
+         * waiters wait for the next completion */
+        if (g_io_resubmitted)
+        {
+            return;
+        }
+    }
+
+    rtos_port_enter_critical();
+    req->state       = RTOS_IO_DONE;
+    rtos_tcb_t *task = io_take_waiter_locked(req);
+    rtos_port_exit_critical();
+
+    if (req->notify_task != NULL)
+    {
+        (void) rtos_task_notify_give(req->notify_task);
+    }
+    if (task != NULL)
+    {
+        rtos_kernel_task_unblock(task);
+    }
+}
+
+/* Deferred daemon: deliver every queued completion, oldest first */
+static void io_drain(void *parameter)
+{
+    (void) parameter;
+
+    rtos_port_enter_critical();
+    rtos_io_request_t *list = g_io_completed;
+    g_io_completed          = NULL;
+    g_io_drain_posted       = false;
+    rtos_port_exit_critical();
+
+    rtos_io_request_t *ordered = NULL;
+    while (list != NULL)
+    {
+        rtos_io_request_t *next = list->next;
+        list->next              = ordered;
+        ordered                 = list;
+        list                    = next;
+    }
+
+    while (ordered != NULL)
+    {
+        /* Read before delivery: a callback may resubmit, and the ISR relink */
+        rtos_io_request_t *next = ordered->next;
+        io_deliver(ordered);
+        ordered = next;
+    }
+}
+
+/* =================== Task-Delete Cleanup =================== */
+
+void rtos_io_remove_task_from_wait(void *req_ptr, rtos_tcb_t *task)
+{
+    rtos_io_request_t *req = (rtos_io_request_t *) req_ptr;
+
+    if (req->waiter == task)
+    {
+        req->waiter = NULL;
+    }
+
+    task->blocked_on      = NULL;
+    task->blocked_on_type = RTOS_SYNC_TYPE_NONE;
+}
+
+/* =================== Public API =================== */
+
+rtos_status_t rtos_io_init(rtos_io_request_t *req, rtos_io_callback_t callback, void *context,
+                           rtos_task_handle_t notify_task)
+{
+    if (req == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+    if (req->state == RTOS_IO_PENDING || req->state == RTOS_IO_COMPLETING)
+    {
+        return RTOS_ERROR_INVALID_STATE;
+    }
+
+    req->next        = NULL;
+    req->callback    = callback;
+    req->context     = context;
+    req->notify_task = notify_task;
+    req->waiter      = NULL;
+    req->status      = RTOS_SUCCESS;
+    req->transferred = 0U;
+    req->state       = RTOS_IO_IDLE;
+
+    return RTOS_SUCCESS;
+}
+
+rtos_status_t rtos_io_submit(rtos_io_request_t *req)
+{
+    if (req == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+#if !RTOS_USE_DEFERRED_WORK
+    return RTOS_ERROR_INVALID_STATE; /* Nothing would deliver the completion */
+#else
+    rtos_status_t result = RTOS_SUCCESS;
+    uint32_t      saved  = rtos_port_enter_critical_from_isr();
+
+    /* COMPLETING is reusable only from its own callback, already unlinked */
+    if (req->state == RTOS_IO_PENDING || (req->state == RTOS_IO_COMPLETING && req != g_io_delivering))
+    {
+        result = RTOS_ERROR_INVALID_STATE;
+    }
+    else
+    {
+        if (req == g_io_delivering)
+        {
+            g_io_resubmitted = true;
+        }
+        req->state = RTOS_IO_PENDING;
+    }
+
+    rtos_port_exit_critical_from_isr(saved);
+    return result;
+#endif
+}
+
+rtos_status_t rtos_io_complete_from_isr(rtos_io_request_t *req, rtos_status_t status, uint32_t transferred,
+                                        bool *higher_priority_task_woken)
+{
+    if (req == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    uint32_t saved  = rtos_port_enter_critical_from_isr();
+    bool     queued = io_push_locked(req, status, transferred);
+    bool     post   = queued && io_claim_post_locked();
+    rtos_port_exit_critical_from_isr(saved);
+
+    if (!queued)
+    {
+        return RTOS_ERROR_INVALID_STATE;
+    }
+
+    if (post && rtos_deferred_post_from_isr(io_drain, NULL, higher_priority_task_woken) != RTOS_SUCCESS)
+    {
+        g_io_drain_posted = false;
+    }
+    return RTOS_SUCCESS;
+}
+
+rtos_status_t rtos_io_complete(rtos_io_request_t *req, rtos_status_t status, uint32_t transferred)
+{
+    if (req == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_port_enter_critical();
+    bool queued = io_push_locked(req, status, transferred);
+    bool post   = queued && io_claim_post_locked();
+    rtos_port_exit_critical();
+
+    if (!queued)
+    {
+        return RTOS_ERROR_INVALID_STATE;
+    }
+
+    if (post && rtos_deferred_post(io_drain, NULL) != RTOS_SUCCESS)
+    {
+        g_io_drain_posted = false;
+    }
+    return RTOS_SUCCESS;
+}
+
+rtos_status_t rtos_io_wait(rtos_io_request_t *req, rtos_tick_t timeout_ticks)
+{
+    if (req == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_port_enter_critical();
+
+    if (req->state == RTOS_IO_DONE)
+    {
+        rtos_port_exit_critical();
+        return req->status;
+    }
+
+    rtos_tcb_t *current_task = rtos_task_get_current();
+    if (req->state == RTOS_IO_IDLE || req->waiter != NULL || current_task == NULL)
+    {
+        rtos_port_exit_critical();
+        return RTOS_ERROR_INVALID_STATE;
+    }
+    if (timeout_ticks == 0U)
+    {
+        rtos_port_exit_critical();
+        return RTOS_ERROR_TIMEOUT;
+    }
+
+    req->waiter = current_task;
+    rtos_kernel_block_on(req, RTOS_SYNC_TYPE_IO, NULL, timeout_ticks);
+
+    /* --- Task resumes here after delivery or timeout --- */
+
+    if (current_task->blocked_on == req)
+    {
+        /* Still registered = timeout occurred */
+        rtos_io_remove_task_from_wait(req, current_task);
+        rtos_port_exit_critical();
+        return RTOS_ERROR_TIMEOUT;
+    }
+
+    rtos_status_t status = req->status;
+    rtos_port_exit_critical();
+
+    return status;
+}
+
+bool rtos_io_is_done(const rtos_io_request_t *req)
+{
+    return req != NULL && req->state == RTOS_IO_DONE;
+}
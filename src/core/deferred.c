@@ -0,0 +1,273 @@
+#include "deferred.h"
+
+#include "VRTOS.h"
+#include "kernel_priv.h"
+#include "klog.h"
+#include "rtos_port.h"
+#include "task.h"
+#include "task_priv.h"
+#include "timer_priv.h"
+
+#include <stddef.h>
+
+/* CMSIS for LDREX/STREX, DMB, IPSR */
+#include "device.h" // IWYU pragma: keep
+
+#if RTOS_USE_DEFERRED_WORK
+
+/*
+ * Deferred work queue: a lock-free multi-producer / single-consumer ring
+ * with the same slot-sequence protocol as the KLog ring (klog.c).  A
+ * producer claims position `pos` by advancing g_deferred_head with
+ * LDREX/STREX while slot_seq == pos, fills the item and publishes it with
+ * slot_seq = pos + 1.  The daemon runs a slot once slot_seq == tail + 1 and
+ * frees it with slot_seq = tail + LENGTH.
+ *
+ * The daemon sleeps on its task notification.  Each wakeup it runs the due
+ * software timers, then every published item, so a burst of posts costs one
+ * context switch.
+ */
+#define DEFERRED_MASK (RTOS_DEFERRED_QUEUE_LENGTH - 1U)
+
+RTOS_STATIC_ASSERT((RTOS_DEFERRED_QUEUE_LENGTH & DEFERRED_MASK) == 0U,
+                   "RTOS_DEFERRED_QUEUE_LENGTH must be a power of 2");
+
+typedef struct
+{
+    rtos_deferred_fn_t function;
+    void              *parameter;
+} deferred_item_t;
+
+static deferred_item_t   g_deferred_items[RTOS_DEFERRED_QUEUE_LENGTH];
+static volatile uint32_t g_deferred_seq[RTOS_DEFERRED_QUEUE_LENGTH];
+
+static volatile uint32_t g_deferred_head;      /* Next position to claim (producers) */
+static uint32_t          g_deferred_tail;      /* Next position to run (daemon only) */
+static volatile uint32_t g_deferred_overflows; /* Posts rejected on a full ring */
+
+static rtos_tcb_t *g_deferred_daemon = NULL;
+
+/* Daemon stack is static so rtos_init() allocates nothing from the heap */
+static uint32_t g_deferred_stack[RTOS_DEFERRED_TASK_STACK_SIZE / sizeof(uint32_t)] RTOS_KERNEL_STACK_REGION
+    __attribute__((aligned(8)));
+
+static void deferred_count_overflow(void)
+{
+    uint32_t n;
+    do
+    {
+        n = __LDREXW(&g_deferred_overflows);
+    } while (__STREXW(n + 1U, &g_deferred_overflows) != 0U);
+}
+
+/* Claim a slot, fill it and publish it; false if the ring is full */
+static bool deferred_enqueue(rtos_deferred_fn_t function, void *parameter)
+{
+    uint32_t pos;
+    for (;;)
+    {
+        pos = __LDREXW(&g_deferred_head);
+
+        if ((int32_t) (g_deferred_seq[pos & DEFERRED_MASK] - pos) < 0)
+        {
+            __CLREX();
+            deferred_count_overflow();
+            KLOGW(KEVT_DEFERRED_FULL, (uint32_t) (uintptr_t) function, RTOS_DEFERRED_QUEUE_LENGTH);
+            return false;
+        }
+
+        if (__STREXW(pos + 1U, &g_deferred_head) == 0U)
+        {
+            break;
+        }
+    }
+
+    g_deferred_items[pos & DEFERRED_MASK].function  = function;
+    g_deferred_items[pos & DEFERRED_MASK].parameter = parameter;
+
+    /* Item must be visible before the slot is published */
+    __DMB();
+    g_deferred_seq[pos & DEFERRED_MASK] = pos + 1U;
+
+    return true;
+}
+
+/* Run every published item; stops at a slot a preempted producer is still filling */
+static void deferred_run_pending(void)
+{
+    for (;;)
+    {
+        uint32_t idx = g_deferred_tail & DEFERRED_MASK;
+
+        if (g_deferred_seq[idx] != g_deferred_tail + 1U)
+        {
+            break;
+        }
+        __DMB();
+
+        deferred_item_t item = g_deferred_items[idx];
+
+        /* Copy must complete before the slot is handed back to producers */
+        __DMB();
+        g_deferred_seq[idx] = g_deferred_tail + RTOS_DEFERRED_QUEUE_LENGTH;
+        g_deferred_tail++;
+
+        item.function(item.parameter);
+    }
+}
+
+__attribute__((__noreturn__)) static void deferred_daemon_function(void *param)
+{
+    (void) param;
+
+    while (1)
+    {
+        rtos_task_notify_take(true, RTOS_NOTIFY_MAX_WAIT);
+
+        timer_service_expired();
+        deferred_run_pending();
+    }
+}
+
+/**
+ * @brief Reset the work queue and create the daemon task (rtos_init)
+ */
+rtos_status_t rtos_deferred_init(void)
+{
+    for (uint32_t i = 0; i < RTOS_DEFERRED_QUEUE_LENGTH; i++)
+    {
+        g_deferred_seq[i] = i;
+    }
+    g_deferred_head      = 0;
+    g_deferred_tail      = 0;
+    g_deferred_overflows = 0;
+
+    rtos_task_handle_t daemon;
+    rtos_status_t      status = rtos_task_create_static(deferred_daemon_function, "DEFER", g_deferred_stack,
+                                                        (rtos_stack_size_t) sizeof(g_deferred_stack), NULL,
+                                                        RTOS_DEFERRED_TASK_PRIORITY, RTOS_TASK_FLAG_NONE, &daemon);
+    if (status != RTOS_SUCCESS)
+    {
+        return status;
+    }
+
+    g_deferred_daemon = daemon;
+    return RTOS_SUCCESS;
+}
+
+/**
+ * @brief Give the daemon a notification without switching context
+ *
+ * The caller decides when to pend PendSV.
+ *
+ * @return true if the daemon should preempt the interrupted task
+ */
+bool rtos_deferred_wake_from_isr(void)
+{
+    bool woken = false;
+
+    if (g_deferred_daemon != NULL)
+    {
+        rtos_task_notify_give_from_isr(g_deferred_daemon, &woken);
+    }
+
+    return woken;
+}
+
+/**
+ * @brief Post from task or ISR context (kernel-internal callers)
+ *
+ * In an ISR the yield is requested right away rather than left to the
+ * handler, since the caller is not a handler that batches its own yield.
+ */
+rtos_status_t rtos_deferred_post_any(rtos_deferred_fn_t function, void *parameter)
+{
+    if (__get_IPSR() == 0U)
+    {
+        return rtos_deferred_post(function, parameter);
+    }
+
+    bool          woken  = false;
+    rtos_status_t status = rtos_deferred_post_from_isr(function, parameter, &woken);
+
+    if (woken)
+    {
+        rtos_port_yield();
+    }
+
+    return status;
+}
+
+#endif /* RTOS_USE_DEFERRED_WORK */
+
+/**
+ * @brief Queue a function for the deferred daemon (task context)
+ */
+rtos_status_t rtos_deferred_post(rtos_deferred_fn_t function, void *parameter)
+{
+#if RTOS_USE_DEFERRED_WORK
+    if (function == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    if (!deferred_enqueue(function, parameter))
+    {
+        return RTOS_ERROR_FULL;
+    }
+
+    if (g_deferred_daemon != NULL)
+    {
+        rtos_task_notify_give(g_deferred_daemon);
+    }
+
+    return RTOS_SUCCESS;
+#else
+    (void) function;
+    (void) parameter;
+    return RTOS_ERROR_INVALID_STATE;
+#endif
+}
+
+/**
+ * @brief Queue a function for the deferred daemon (ISR context)
+ */
+rtos_status_t rtos_deferred_post_from_isr(rtos_deferred_fn_t function, void *parameter,
+                                          bool *higher_priority_task_woken)
+{
+#if RTOS_USE_DEFERRED_WORK
+    if (function == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    if (!deferred_enqueue(function, parameter))
+    {
+        return RTOS_ERROR_FULL;
+    }
+
+    if (rtos_deferred_wake_from_isr() && higher_priority_task_woken != NULL)
+    {
+        *higher_priority_task_woken = true;
+    }
+
+    return RTOS_SUCCESS;
+#else
+    (void) function;
+    (void) parameter;
+    (void) higher_priority_task_woken;
+    return RTOS_ERROR_INVALID_STATE;
+#endif
+}
+
+/**
+ * @brief Work items rejected because the queue was full
+ */
+uint32_t rtos_deferred_get_overflows(void)
+{
+#if RTOS_USE_DEFERRED_WORK
+    return g_deferred_overflows;
+#else
+    return 0;
+#endif
+}
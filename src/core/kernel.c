@@ -1,20 +1,46 @@
 #include "VRTOS.h"
 #include "assert.h"
+#include "hrtimer.h"
 #include "kernel_priv.h"
 #include "klog.h"
 #include "memory.h"
+#include "preemptive_sp.h"
+#include "prof_trace.h"
 #include "profiling.h"
 #include "rtos_port.h"
 #include "scheduler.h"
 #include "task.h"
 #include "task_priv.h"
 #include "timer.h"
+#include "timer_priv.h"
 
-rtos_kernel_cb_t g_kernel = {.state               = RTOS_KERNEL_STATE_INACTIVE,
-                             .tick_count          = 0,
-                             .current_task        = NULL,
-                             .next_task           = NULL,
-                             .scheduler_suspended = 0};
+#include <string.h>
+
+#include "device.h" // IWYU pragma: keep
+
+rtos_kernel_cb_t g_kernel = {.state = RTOS_KERNEL_STATE_INACTIVE, .tick_count = 0, .scheduler_suspended = 0};
+
+/* Idle stacks are static so rtos_init() allocates nothing from the heap; one idle task per core */
+static uint32_t g_idle_stack[RTOS_SMP_CORES][RTOS_DEFAULT_TASK_STACK_SIZE / sizeof(uint32_t)] RTOS_KERNEL_STACK_REGION
+    __attribute__((aligned(8)));
+
+static const char *const g_idle_name[] = {"IDLE", "IDLE1"};
+RTOS_STATIC_ASSERT(sizeof(g_idle_name) / sizeof(g_idle_name[0]) >= RTOS_SMP_CORES, "one idle task name per core");
+
+#if RTOS_PROFILING_SYSTEM_ENABLED
+/* Cycles since *mark, which then moves to now: times consecutive boot phases */
+static inline uint32_t boot_lap(uint32_t *mark)
+{
+    uint32_t now    = rtos_profiling_get_cycles();
+    uint32_t cycles = now - *mark;
+    *mark           = now;
+    return cycles;
+}
+
+#define BOOT_LAP(field) (g_prof_boot.field = boot_lap(&boot_mark))
+#else
+#define BOOT_LAP(field) ((void) 0)
+#endif
 
 /**
  * @brief Initialize the RTOS system
@@ -29,85 +55,210 @@ rtos_status_t rtos_init(void)
     }
 
 #if RTOS_PROFILING_SYSTEM_ENABLED
-    /* Initialize profiling before anything else */
+    /* Initialize profiling before anything else; CYCCNT = 0 marks boot start */
     rtos_profiling_init();
+    uint32_t boot_mark = rtos_profiling_get_cycles();
 #endif
 
     /* Initialize kernel logger (uses DWT for timestamps, so after profiling init) */
     klog_init();
+#if RTOS_PROF_TRACE
+    prof_trace_init();
+#endif
+    BOOT_LAP(klog_cycles);
 
     g_kernel.state               = RTOS_KERNEL_STATE_INACTIVE;
     g_kernel.tick_count          = 0;
-    g_kernel.current_task        = NULL;
-    g_kernel.next_task           = NULL;
     g_kernel.scheduler_suspended = 0;
+    g_kernel.pended_ticks        = 0;
+    g_kernel.pending_ready_head  = NULL;
+    g_kernel.pending_ready_tail  = NULL;
+    memset(g_kernel.core, 0, sizeof(g_kernel.core));
+
+    /* 64-bit time starts at tick 0 and the current CYCCNT */
+    rtos_kernel_time_init();
 
     rtos_memory_init();
+    BOOT_LAP(memory_cycles);
 
     status = rtos_task_init_system();
     if (status != RTOS_SUCCESS)
     {
         return status;
     }
+    BOOT_LAP(task_system_cycles);
 
     status = rtos_scheduler_init(RTOS_SCHEDULER_TYPE);
     if (status != RTOS_SUCCESS)
     {
         return status;
     }
+    BOOT_LAP(scheduler_cycles);
 
     status = rtos_port_init();
     if (status != RTOS_SUCCESS)
     {
         return status;
     }
+    BOOT_LAP(port_cycles);
+
+    for (uint32_t i = 0; i < RTOS_SMP_CORES; i++)
+    {
+        /* Pinned with two or more cores: each core always has its own task to fall back to */
+        uint8_t flags = (RTOS_SMP_CORES > 1) ? (uint8_t) RTOS_TASK_FLAG_CORE(i) : RTOS_TASK_FLAG_NONE;
 
-    rtos_task_handle_t idle_task;
-    status = rtos_task_create(rtos_task_idle_function, "IDLE", 0, NULL, RTOS_IDLE_TASK_PRIORITY, &idle_task);
+        status = rtos_task_create_static(rtos_task_idle_function, g_idle_name[i], g_idle_stack[i],
+                                         (rtos_stack_size_t) sizeof(g_idle_stack[i]), NULL, RTOS_IDLE_TASK_PRIORITY,
+                                         flags, &g_kernel.core[i].idle_task);
+        if (status != RTOS_SUCCESS)
+        {
+            return status;
+        }
+    }
+    BOOT_LAP(idle_create_cycles);
+
+#if RTOS_USE_DEFERRED_WORK
+    status = rtos_deferred_init();
     if (status != RTOS_SUCCESS)
     {
         return status;
     }
+    BOOT_LAP(deferred_cycles);
+#endif
+
+    status = rtos_kernel_create_defined();
+    if (status != RTOS_SUCCESS)
+    {
+        return status;
+    }
+    BOOT_LAP(defined_cycles);
+
+#if RTOS_USE_HRTIMER
+    rtos_hrtimer_init_system();
+#endif
+
+#if RTOS_USE_LOW_POWER
+    rtos_kernel_power_init();
+#endif
+
+#if RTOS_PROFILING_SYSTEM_ENABLED
+    g_prof_boot.init_cycles = rtos_profiling_get_cycles();
+#endif
 
     g_kernel.state = RTOS_KERNEL_STATE_READY;
     return RTOS_SUCCESS;
 }
 
 /**
- * @brief Start the RTOS scheduler
+ * @brief Make the highest-priority ready task current on the calling core
  */
-rtos_status_t rtos_start_scheduler(void)
+static rtos_status_t kernel_select_first_task(rtos_kernel_core_t *core)
 {
-    if (g_kernel.state != RTOS_KERNEL_STATE_READY)
+    core->next_task = rtos_scheduler_get_next_task();
+    if (core->next_task == NULL)
     {
-        return RTOS_ERROR_INVALID_STATE;
+        return RTOS_ERROR_GENERAL;
     }
 
-    g_kernel.next_task = rtos_scheduler_get_next_task();
-    if (g_kernel.next_task == NULL)
+    core->current_task = core->next_task;
+
+    /* Validate state transition: first task must be READY before we promote it */
+    if (core->current_task->state != RTOS_TASK_STATE_READY)
     {
-        return RTOS_ERROR_GENERAL;
+        return RTOS_ERROR_INVALID_STATE;
     }
 
-    g_kernel.current_task = g_kernel.next_task;
+    core->current_task->state = RTOS_TASK_STATE_RUNNING;
+    rtos_scheduler_remove_from_ready_list(core->current_task);
 
-    /* Validate state transition: first task must be READY before we promote it */
-    if (g_kernel.current_task->state != RTOS_TASK_STATE_READY)
+#if RTOS_PROFILING_SYSTEM_ENABLED
+    core->slice_start = rtos_profiling_get_cycles();
+#endif
+
+    return RTOS_SUCCESS;
+}
+
+/**
+ * @brief Start the RTOS scheduler
+ */
+rtos_status_t rtos_start_scheduler(void)
+{
+    if (g_kernel.state != RTOS_KERNEL_STATE_READY)
     {
         return RTOS_ERROR_INVALID_STATE;
     }
 
-    g_kernel.current_task->state = RTOS_TASK_STATE_RUNNING;
-    rtos_scheduler_remove_from_ready_list(g_kernel.current_task);
+    rtos_kernel_core_t *core   = rtos_kernel_this_core();
+    rtos_status_t       status = kernel_select_first_task(core);
+    if (status != RTOS_SUCCESS)
+    {
+        return status;
+    }
 
     g_kernel.state = RTOS_KERNEL_STATE_RUNNING;
 
+#if RTOS_PROFILING_SYSTEM_ENABLED
+    g_prof_boot.first_task_cycles = core->slice_start; /* CYCCNT counts from rtos_init() entry */
+#endif
+
+#if RTOS_SMP_CORES > 1
+    rtos_port_start_secondary_cores();
+#endif
+
     rtos_port_start_first_task();
 
     /* Should never return */
     return RTOS_ERROR_GENERAL;
 }
 
+#if RTOS_SMP_CORES > 1
+/**
+ * @brief Secondary-core entry: run this core's first task
+ *
+ * Its pinned idle task is always ready, so selection cannot fail.
+ */
+void rtos_kernel_start_core(void)
+{
+    rtos_port_enter_critical();
+    rtos_status_t status = kernel_select_first_task(rtos_kernel_this_core());
+    rtos_port_exit_critical();
+
+    RTOS_ASSERT(status == RTOS_SUCCESS);
+    (void) status;
+
+    rtos_port_start_first_task();
+}
+
+/**
+ * @brief Interrupt every other core whose running task is outranked
+ *
+ * Called with the kernel lock held after tasks became ready, so a wakeup
+ * on one core preempts the other at once instead of waiting for its next
+ * switch.
+ */
+static void kernel_yield_remote_cores(void)
+{
+    rtos_kernel_core_t *self = rtos_kernel_this_core();
+
+    for (uint32_t i = 0; i < RTOS_SMP_CORES; i++)
+    {
+        rtos_kernel_core_t *core    = &g_kernel.core[i];
+        rtos_tcb_t         *running = core->current_task;
+
+        if (core == self || running == NULL)
+        {
+            continue;
+        }
+
+        rtos_tcb_t *ready = rtos_task_get_highest_ready_on_core(i);
+        if (ready != NULL && ready->priority > running->priority)
+        {
+            rtos_port_yield_core(i);
+        }
+    }
+}
+#endif
+
 /**
  * @brief Get current tick count
  */
@@ -126,15 +277,19 @@ void rtos_delay_ticks(rtos_tick_t ticks)
 
     rtos_port_enter_critical();
 
-    if (g_kernel.current_task == NULL)
+    rtos_tcb_t *current = rtos_kernel_this_core()->current_task;
+
+    RTOS_ASSERT(g_kernel.scheduler_suspended == 0); /* Nothing would switch us out */
+
+    if (current == NULL)
     {
         KLOGE(KEVT_NO_CURRENT_TASK, 0, 0);
         rtos_port_exit_critical();
         return;
     }
 
-    g_kernel.current_task->state = RTOS_TASK_STATE_BLOCKED;
-    rtos_scheduler_add_to_delayed_list(g_kernel.current_task, ticks);
+    current->state = RTOS_TASK_STATE_BLOCKED;
+    rtos_scheduler_add_to_delayed_list(current, ticks);
 
     rtos_port_exit_critical();
     rtos_yield();
@@ -163,6 +318,8 @@ void rtos_delay_until(rtos_tick_t *const prev_wake_time, rtos_tick_t time_increm
 
     rtos_port_enter_critical();
 
+    RTOS_ASSERT(g_kernel.scheduler_suspended == 0);
+
     rtos_tick_t current_time = g_kernel.tick_count;
     /* Use signed comparison for tick wraparound safety */
     int32_t     elapsed      = (int32_t)(current_time - *prev_wake_time);
@@ -171,15 +328,16 @@ void rtos_delay_until(rtos_tick_t *const prev_wake_time, rtos_tick_t time_increm
     if (elapsed >= 0 && (uint32_t)elapsed < time_increment)
     {
         rtos_tick_t ticks_to_delay = time_increment - (uint32_t)elapsed;
+        rtos_tcb_t *current        = rtos_kernel_this_core()->current_task;
 
-        if (g_kernel.current_task == NULL)
+        if (current == NULL)
         {
             KLOGE(KEVT_NO_CURRENT_TASK, 0, 0);
         }
         else
         {
-            g_kernel.current_task->state = RTOS_TASK_STATE_BLOCKED;
-            rtos_scheduler_add_to_delayed_list(g_kernel.current_task, ticks_to_delay);
+            current->state = RTOS_TASK_STATE_BLOCKED;
+            rtos_scheduler_add_to_delayed_list(current, ticks_to_delay);
             should_delay = true;
         }
     }
@@ -194,21 +352,150 @@ void rtos_delay_until(rtos_tick_t *const prev_wake_time, rtos_tick_t time_increm
     }
 }
 
+/* A switch now would pick the running task again (kernel lock held) */
+static inline bool kernel_keeps_current(rtos_tcb_t *current)
+{
+    return current != NULL && current->state == RTOS_TASK_STATE_RUNNING && rtos_scheduler_reselects_current(current);
+}
+
 /**
  * @brief Force task yield
  */
 void rtos_yield(void)
 {
-    rtos_port_yield();
+    rtos_port_enter_critical();
+
+    /* Nothing would replace the caller: skip the PendSV altogether */
+    bool elide = (g_kernel.state == RTOS_KERNEL_STATE_RUNNING && g_kernel.scheduler_suspended == 0 &&
+                  kernel_keeps_current(rtos_kernel_this_core()->current_task));
+
+    if (elide)
+    {
+        RTOS_SCHED_STAT_INC(elided_switches);
+    }
+
+    rtos_port_exit_critical();
+
+    if (!elide)
+    {
+        rtos_port_yield();
+    }
+}
+
+/**
+ * @brief Per-tick scheduling work: budgets, servers, delayed-task wakeups
+ *
+ * Kernel lock held. Run by the tick handler, or by rtos_scheduler_resume()
+ * once for each tick that arrived while the scheduler was suspended.
+ */
+static void kernel_tick_schedule(void)
+{
+#if RTOS_ADMISSION_CONTROL
+    for (uint32_t i = 0; i < RTOS_SMP_CORES; i++)
+    {
+        rtos_task_charge_budget(g_kernel.core[i].current_task);
+    }
+#endif
+#if RTOS_USE_BUDGET_SERVER
+    rtos_task_server_tick(rtos_kernel_this_core()->current_task);
+#endif
+
+    rtos_scheduler_update_delayed_tasks();
+#if RTOS_SMP_CORES > 1
+    kernel_yield_remote_cores();
+#endif
+}
+
+/**
+ * @brief Suspend the scheduler
+ *
+ * Interrupts stay enabled. Until the matching resume no context switch
+ * happens and the ready lists do not change: a task made ready (by an ISR,
+ * or by the caller) waits on the pending-ready list, and the tick only
+ * counts time, deferring its delayed-task and budget work.
+ */
+void rtos_scheduler_suspend(void)
+{
+    rtos_port_enter_critical();
+    RTOS_ASSERT(g_kernel.scheduler_suspended < UINT8_MAX);
+    g_kernel.scheduler_suspended++;
+    rtos_port_exit_critical();
+}
+
+/**
+ * @brief Undo one rtos_scheduler_suspend()
+ *
+ * The outermost resume moves the pending-ready tasks to the ready lists in
+ * the order they were woken, replays the pended ticks, and then requests a
+ * single context switch if a task now outranks the caller.
+ */
+rtos_status_t rtos_scheduler_resume(void)
+{
+    rtos_port_enter_critical();
+
+    if (g_kernel.scheduler_suspended == 0)
+    {
+        rtos_port_exit_critical();
+        return RTOS_ERROR_INVALID_STATE;
+    }
+
+    if (--g_kernel.scheduler_suspended > 0)
+    {
+        rtos_port_exit_critical();
+        return RTOS_SUCCESS;
+    }
+
+    rtos_tcb_t *task            = g_kernel.pending_ready_head;
+    g_kernel.pending_ready_head = NULL;
+    g_kernel.pending_ready_tail = NULL;
+
+    while (task != NULL)
+    {
+        rtos_tcb_t *next = task->next;
+
+        task->next = NULL;
+        task->flags &= (uint8_t) ~RTOS_TASK_FLAG_PENDING_READY;
+        rtos_scheduler_add_to_ready_list(task);
+        task = next;
+    }
+
+    if (g_kernel.state == RTOS_KERNEL_STATE_RUNNING)
+    {
+        for (; g_kernel.pended_ticks > 0; g_kernel.pended_ticks--)
+        {
+            kernel_tick_schedule();
+        }
+    }
+    g_kernel.pended_ticks = 0;
+
+#if RTOS_SMP_CORES > 1
+    kernel_yield_remote_cores();
+#endif
+
+    bool preempt = (g_kernel.state == RTOS_KERNEL_STATE_RUNNING &&
+                    rtos_scheduler_should_preempt(rtos_scheduler_get_next_task()));
+
+    rtos_port_exit_critical();
+
+    if (preempt)
+    {
+        rtos_yield();
+    }
+
+    return RTOS_SUCCESS;
 }
 
 /**
  * @brief System tick handler (called by port layer)
+ *
+ * With RTOS_SMP_CORES > 1 only core 0 calls it: it advances time for every
+ * core and interrupts the others when a woken task outranks theirs.
  */
 void rtos_kernel_tick_handler(void)
 {
     RTOS_SYS_PROFILE_START(tick);
     g_kernel.tick_count++;
+    rtos_kernel_time_update();
 
     rtos_timer_tick();
 
@@ -216,7 +503,18 @@ void rtos_kernel_tick_handler(void)
     {
         rtos_port_enter_critical();
 
-        rtos_scheduler_update_delayed_tasks();
+        if (g_kernel.scheduler_suspended > 0)
+        {
+            /* Replayed by rtos_scheduler_resume() */
+            g_kernel.pended_ticks++;
+            RTOS_SCHED_STAT_INC(suspended_ticks);
+            rtos_port_exit_critical();
+            RTOS_SYS_PROFILE_END(tick, &g_prof_tick);
+            return;
+        }
+
+        kernel_tick_schedule();
+
         rtos_task_handle_t next_task = rtos_scheduler_get_next_task();
 
         if (rtos_scheduler_should_preempt(next_task))
@@ -232,10 +530,118 @@ void rtos_kernel_tick_handler(void)
     RTOS_SYS_PROFILE_END(tick, &g_prof_tick);
 }
 
+#if RTOS_TICKLESS_IDLE
+
+/**
+ * @brief Ticks until the earliest delayed-task or software-timer deadline
+ * @return 0 if a deadline is already due, RTOS_MAX_DELAY if nothing is pending
+ */
+static rtos_tick_t rtos_kernel_get_expected_idle_ticks(void)
+{
+    rtos_tick_t earliest = 0;
+    rtos_tick_t wake_tick;
+    bool        pending = false;
+
+    if (rtos_scheduler_get_next_wake_tick(&wake_tick))
+    {
+        earliest = wake_tick;
+        pending  = true;
+    }
+
+    if (timer_get_next_expiry(&wake_tick) && (!pending || (int32_t)(wake_tick - earliest) < 0))
+    {
+        earliest = wake_tick;
+        pending  = true;
+    }
+
+    if (!pending)
+    {
+        return RTOS_MAX_DELAY;
+    }
+
+    int32_t remaining = (int32_t)(earliest - g_kernel.tick_count);
+    return (remaining > 0) ? (rtos_tick_t) remaining : 0;
+}
+
+/**
+ * @brief Idle-task sleep: stop the tick until the next deadline
+ *
+ * Falls back to a plain WFI when the next deadline is closer than
+ * RTOS_TICKLESS_MIN_IDLE_TICKS, and yields instead of sleeping when another
+ * task is already READY (e.g. a priority-0 peer of the idle task). With
+ * RTOS_USE_LOW_POWER, goes to stop or standby when rtos_power_select_mode()
+ * picks it and the board accepts, else to the tickless sleep.
+ */
+void rtos_kernel_idle_sleep(void)
+{
+    rtos_port_enter_critical();
+
+    bool        runnable      = (rtos_scheduler_get_next_task() != NULL);
+    rtos_tick_t expected_idle = rtos_kernel_get_expected_idle_ticks();
+
+    rtos_port_exit_critical();
+
+    if (runnable)
+    {
+        rtos_yield();
+        return;
+    }
+
+    if (expected_idle < RTOS_TICKLESS_MIN_IDLE_TICKS)
+    {
+        __WFI();
+        return;
+    }
+
+#if RTOS_USE_LOW_POWER
+    rtos_power_mode_t mode = rtos_power_select_mode(expected_idle);
+    if (mode != RTOS_POWER_MODE_SLEEP)
+    {
+        if (rtos_port_deep_sleep(mode, rtos_kernel_power_sleep_ticks(mode, expected_idle)))
+        {
+            return;
+        }
+        rtos_kernel_power_record_refusal();
+    }
+
+    rtos_tick_t sleep_start = g_kernel.tick_count;
+    rtos_port_suppress_ticks_and_sleep(expected_idle);
+    rtos_kernel_power_record(RTOS_POWER_MODE_SLEEP, g_kernel.tick_count - sleep_start, 0);
+#else
+    rtos_port_suppress_ticks_and_sleep(expected_idle);
+#endif
+}
+
+/**
+ * @brief Re-check sleep conditions with kernel interrupts masked (port callback)
+ */
+bool rtos_kernel_confirm_sleep(void)
+{
+    return (g_kernel.state == RTOS_KERNEL_STATE_RUNNING && rtos_scheduler_get_next_task() == NULL);
+}
+
+/**
+ * @brief Advance the tick count by ticks skipped during tickless sleep
+ *
+ * Called by the port with kernel interrupts masked.  No deadline lies inside the
+ * skipped window, so delayed tasks and timers are serviced by the next
+ * regular tick.
+ */
+void rtos_kernel_step_tick(rtos_tick_t ticks)
+{
+    g_kernel.tick_count += ticks;
+    rtos_kernel_time_update();
+}
+
+#endif /* RTOS_TICKLESS_IDLE */
+
 /**
  * @brief Context switch handler (called by scheduler)
+ *
+ * RTOS_FAST_CODE: runs on every PendSV, so boards with tightly coupled
+ * instruction memory place it there alongside the port's handler.
  */
-void rtos_kernel_switch_context(void)
+RTOS_FAST_CODE void rtos_kernel_switch_context(void)
 {
     if (g_kernel.scheduler_suspended > 0)
     {
@@ -246,30 +652,56 @@ void rtos_kernel_switch_context(void)
 
     rtos_port_enter_critical();
 
-    if (g_kernel.current_task != NULL)
+    rtos_kernel_core_t *core        = rtos_kernel_this_core();
+    rtos_tcb_t         *current     = core->current_task;
+    uint32_t            still_ready = 0U;
+
+    /* Same-task switch (the reason for the PendSV has gone): leave the ready lists alone */
+    if (kernel_keeps_current(current))
     {
-        if (g_kernel.current_task->state == RTOS_TASK_STATE_RUNNING)
+        RTOS_SCHED_STAT_INC(elided_switches);
+        rtos_port_exit_critical();
+        return;
+    }
+
+    if (current != NULL)
+    {
+#if RTOS_PROFILING_SYSTEM_ENABLED
+        /* Charge the outgoing slice; reuses the profiling timestamp, so no extra DWT read */
+        current->run_cycles += (uint32_t) (ctx_switch_start - core->slice_start);
+        core->slice_start = ctx_switch_start;
+#endif
+
+        if (current->state == RTOS_TASK_STATE_RUNNING)
         {
-            g_kernel.current_task->state = RTOS_TASK_STATE_READY;
-            rtos_scheduler_add_to_ready_list(g_kernel.current_task);
+            still_ready    = 1U;
+            current->state = RTOS_TASK_STATE_READY;
+            rtos_scheduler_add_to_ready_list(current);
         }
+#if RTOS_SMP_CORES > 1
+        else if (current->state == RTOS_TASK_STATE_DELETED)
+        {
+            /* Deleted from another core while running here; the stack is free from now on */
+            rtos_task_defer_release(current);
+        }
+#endif
 
-        rtos_scheduler_task_completed(g_kernel.current_task);
+        rtos_scheduler_task_completed(current);
     }
 
-    g_kernel.next_task = rtos_scheduler_get_next_task();
+    core->next_task = rtos_scheduler_get_next_task();
 
-    if (g_kernel.next_task != NULL)
+    if (core->next_task != NULL)
     {
-        rtos_scheduler_remove_from_ready_list(g_kernel.next_task);
+        rtos_scheduler_remove_from_ready_list(core->next_task);
 
 #if RTOS_PROFILING_SYSTEM_ENABLED
         /* Measure scheduling latency: time from READY to actually running */
-        if (g_kernel.next_task->ready_timestamp != 0)
+        if (core->next_task->ready_timestamp != 0)
         {
-            uint32_t latency = rtos_profiling_get_cycles() - g_kernel.next_task->ready_timestamp;
+            uint32_t latency = rtos_profiling_get_cycles() - core->next_task->ready_timestamp;
             rtos_profiling_record(&g_prof_scheduling_latency, latency);
-            g_kernel.next_task->ready_timestamp = 0;
+            core->next_task->ready_timestamp = 0;
         }
 
         /* Record full PendSV duration captured in ASM */
@@ -280,32 +712,76 @@ void rtos_kernel_switch_context(void)
         }
 #endif
 
-        g_kernel.next_task->state = RTOS_TASK_STATE_RUNNING;
-        g_kernel.current_task     = g_kernel.next_task;
+        core->next_task->state = RTOS_TASK_STATE_RUNNING;
+        core->current_task     = core->next_task;
     }
     else
     {
-        g_kernel.current_task = rtos_task_get_idle_task();
-        if (g_kernel.current_task != NULL)
+        core->current_task = core->idle_task;
+        if (core->current_task != NULL)
         {
-            rtos_scheduler_remove_from_ready_list(g_kernel.current_task);
-            g_kernel.current_task->state = RTOS_TASK_STATE_RUNNING;
+            rtos_scheduler_remove_from_ready_list(core->current_task);
+            core->current_task->state = RTOS_TASK_STATE_RUNNING;
         }
         else
         {
             KLOGE(KEVT_ERROR_GENERIC, 0, 0);
             while (1)
             {
-                __asm volatile("wfi");
+                __WFI();
             }
         }
     }
 
+#if RTOS_PROF_TRACE
+    if (core->current_task != current)
+    {
+        if (current != NULL)
+        {
+            PROF_TRACE(PEVT_TASK_SWITCH_OUT, current->task_id);
+        }
+        PROF_TRACE(PEVT_TASK_SWITCH_IN, core->current_task->task_id);
+    }
+#endif
+
+#if RTOS_SCHEDULER_STATS
+    if (core->current_task != current && current != NULL)
+    {
+        /* Branch-free split: still_ready is 0 or 1 */
+        RTOS_SCHED_STAT_INC(context_switches);
+        g_scheduler_stats.preemptions += still_ready;
+        g_scheduler_stats.voluntary_switches += 1U - still_ready;
+    }
+#else
+    (void) still_ready;
+#endif
+
     rtos_port_exit_critical();
 
     RTOS_SYS_PROFILE_END(ctx_switch, &g_prof_context_switch);
 }
 
+#if RTOS_PROFILING_SYSTEM_ENABLED
+/**
+ * @brief Charge the running task's slice up to now and restart it
+ *
+ * Caller holds the critical section. Keeps a task that is never switched out
+ * from exceeding the 2^32-cycle range of the per-switch delta, as long as
+ * someone samples the stats more often than CYCCNT wraps.
+ */
+void rtos_kernel_runtime_checkpoint(void)
+{
+    uint32_t            now  = rtos_profiling_get_cycles();
+    rtos_kernel_core_t *core = rtos_kernel_this_core();
+
+    if (core->current_task != NULL)
+    {
+        core->current_task->run_cycles += (uint32_t) (now - core->slice_start);
+    }
+    core->slice_start = now;
+}
+#endif
+
 /**
  * @brief Validate state transition and log/assert on invalid
  * @param task Task being transitioned
@@ -373,24 +849,71 @@ bool rtos_kernel_validate_transition(rtos_task_handle_t task, rtos_task_state_t
 }
 
 /**
- * @brief Move task to ready state
+ * @brief Append a task made ready while the scheduler is suspended
  */
-void rtos_kernel_task_ready(rtos_task_handle_t task)
+void rtos_kernel_pend_ready(rtos_task_handle_t task)
 {
-    if (task == NULL)
+    task->flags |= RTOS_TASK_FLAG_PENDING_READY;
+    task->next = NULL;
+
+    if (g_kernel.pending_ready_tail == NULL)
     {
-        return;
+        g_kernel.pending_ready_head = task;
     }
+    else
+    {
+        g_kernel.pending_ready_tail->next = task;
+    }
+    g_kernel.pending_ready_tail = task;
+}
 
-    rtos_port_enter_critical();
+/**
+ * @brief Unlink a parked task (suspended, deleted or re-prioritised before resume)
+ */
+void rtos_kernel_unpend_ready(rtos_task_handle_t task)
+{
+    rtos_tcb_t *prev = NULL;
+    rtos_tcb_t *cur  = g_kernel.pending_ready_head;
 
+    while (cur != NULL && cur != task)
+    {
+        prev = cur;
+        cur  = cur->next;
+    }
+
+    if (cur != NULL)
+    {
+        if (prev == NULL)
+        {
+            g_kernel.pending_ready_head = cur->next;
+        }
+        else
+        {
+            prev->next = cur->next;
+        }
+        if (g_kernel.pending_ready_tail == cur)
+        {
+            g_kernel.pending_ready_tail = prev;
+        }
+    }
+
+    task->next = NULL;
+    task->flags &= (uint8_t) ~RTOS_TASK_FLAG_PENDING_READY;
+}
+
+/**
+ * @brief Move task to ready state
+ */
+/* Must be called inside a critical section. Returns true if task should preempt the running task. */
+static bool kernel_make_ready(rtos_task_handle_t task)
+{
     if (!rtos_kernel_validate_transition(task, RTOS_TASK_STATE_READY))
     {
-        rtos_port_exit_critical();
-        return;
+        return false;
     }
 
     task->state = RTOS_TASK_STATE_READY;
+    PROF_TRACE(PEVT_TASK_UNBLOCK, task->task_id);
 
 #if RTOS_PROFILING_SYSTEM_ENABLED
     /* Only track scheduling latency for tasks above idle priority.
@@ -404,24 +927,24 @@ void rtos_kernel_task_ready(rtos_task_handle_t task)
 
     rtos_scheduler_add_to_ready_list(task);
 
-    if (g_kernel.state == RTOS_KERNEL_STATE_RUNNING)
+    /* Suspended: parked, rtos_scheduler_resume() decides on preemption */
+    if (g_kernel.state != RTOS_KERNEL_STATE_RUNNING || g_kernel.scheduler_suspended > 0)
     {
-        if (rtos_scheduler_should_preempt(task))
-        {
-            rtos_port_exit_critical();
-            rtos_yield();
-            return;
-        }
+        return false;
     }
 
-    rtos_port_exit_critical();
+    if (rtos_scheduler_should_preempt(task))
+    {
+        return true;
+    }
+
+#if RTOS_SMP_CORES > 1
+    kernel_yield_remote_cores();
+#endif
+    return false;
 }
 
-/**
- * @brief Move task to blocked state
- * @param delay_ticks Ticks to delay (0 = indefinite)
- */
-void rtos_kernel_task_block(rtos_task_handle_t task, rtos_tick_t delay_ticks)
+void rtos_kernel_task_ready(rtos_task_handle_t task)
 {
     if (task == NULL)
     {
@@ -429,35 +952,52 @@ void rtos_kernel_task_block(rtos_task_handle_t task, rtos_tick_t delay_ticks)
     }
 
     rtos_port_enter_critical();
+    bool preempt = kernel_make_ready(task);
+    rtos_port_exit_critical();
 
-    if (!rtos_kernel_validate_transition(task, RTOS_TASK_STATE_BLOCKED))
+    if (preempt)
     {
-        rtos_port_exit_critical();
-        return;
+        rtos_yield();
     }
+}
 
-    /* Only remove from ready list if task was actually in READY state.
-     * RUNNING tasks are not in the ready list. */
-    if (task->state == RTOS_TASK_STATE_READY)
-    {
-        rtos_scheduler_remove_from_ready_list(task);
-    }
+/**
+ * @brief Block the running task on a sync object
+ *
+ * Entered inside the caller's critical section. The task is pointed at
+ * object, linked into wait_list (NULL for objects that track their waiter
+ * themselves), armed with its timeout and marked BLOCKED in that one
+ * section, so no wake can land between the wait-list and delayed-list
+ * inserts. The section is left for the single yield and re-entered once
+ * the task runs again; blocked_on still equal to object then means the
+ * timeout expired.
+ *
+ * @param timeout_ticks Ticks to wait (RTOS_MAX_DELAY = forever)
+ */
+void rtos_kernel_block_on(void *object, rtos_sync_type_t type, rtos_wait_queue_t *wait_list,
+                          rtos_tick_t timeout_ticks)
+{
+    rtos_tcb_t *current = rtos_kernel_this_core()->current_task;
 
-    task->state = RTOS_TASK_STATE_BLOCKED;
+    RTOS_ASSERT(g_kernel.scheduler_suspended == 0); /* Nothing would switch us out */
 
-    if (delay_ticks > 0)
+    current->blocked_on      = object;
+    current->blocked_on_type = type;
+    if (wait_list != NULL)
     {
-        rtos_scheduler_add_to_delayed_list(task, delay_ticks);
+        rtos_wait_queue_insert(wait_list, current);
     }
 
-    if (task == g_kernel.current_task)
+    current->state = RTOS_TASK_STATE_BLOCKED;
+    PROF_TRACE(PEVT_TASK_BLOCK, current->task_id);
+    if (timeout_ticks != RTOS_MAX_DELAY)
     {
-        rtos_port_exit_critical();
-        rtos_yield();
-        return;
+        rtos_scheduler_add_to_delayed_list(current, timeout_ticks);
     }
 
     rtos_port_exit_critical();
+    rtos_yield();
+    rtos_port_enter_critical();
 }
 
 /**
@@ -476,4 +1016,27 @@ void rtos_kernel_task_unblock(rtos_task_handle_t task)
      * preventing PendSV from firing.  Delegate entirely. */
     rtos_scheduler_remove_from_delayed_list(task);
     rtos_kernel_task_ready(task);
+}
+
+/**
+ * @brief Unblock a task from ISR context without requesting a context switch
+ *
+ * The caller accumulates the result and issues one rtos_port_yield() at ISR
+ * exit, so a burst of wakeups in one handler pends PendSV once.
+ *
+ * @return true if the woken task should preempt the interrupted task
+ */
+bool rtos_kernel_task_unblock_from_isr(rtos_task_handle_t task)
+{
+    if (task == NULL || task->state != RTOS_TASK_STATE_BLOCKED)
+    {
+        return false;
+    }
+
+    rtos_port_enter_critical();
+    rtos_scheduler_remove_from_delayed_list(task);
+    bool preempt = kernel_make_ready(task);
+    rtos_port_exit_critical();
+
+    return preempt;
 }
\ No newline at end of file
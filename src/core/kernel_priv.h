@@ -1,8 +1,14 @@
 #ifndef KERNEL_PRIV_H
 #define KERNEL_PRIV_H
 
+#include "config.h"
+#include "deferred.h"
+#include "power.h"
+#include "profiling.h"
 #include "rtos_assert.h"
+#include "rtos_port.h"
 #include "rtos_types.h"
+#include "scheduler.h"
 
 /* Not for application code. */
 
@@ -15,23 +21,147 @@ typedef enum
     RTOS_KERNEL_STATE_SUSPENDED     /**< Kernel suspended */
 } rtos_kernel_state_t;
 
+/* Per-core scheduling state, one entry per RTOS_SMP_CORES */
+typedef struct
+{
+    rtos_task_handle_t current_task; /**< Task running on this core */
+    rtos_task_handle_t next_task;    /**< Next task to run on this core */
+    rtos_task_handle_t idle_task;    /**< This core's idle task */
+#if RTOS_PROFILING_SYSTEM_ENABLED
+    uint32_t slice_start; /**< CYCCNT when current_task was switched in */
+#endif
+} rtos_kernel_core_t;
+
 /* Kernel Control Block */
 typedef struct
 {
-    rtos_task_handle_t  current_task;        /**< Currently running task */
-    rtos_task_handle_t  next_task;           /**< Next task to run */
-    rtos_kernel_state_t state;               /**< Current kernel state */
-    rtos_tick_t         tick_count;          /**< System tick counter */
-    uint8_t             scheduler_suspended; /**< Scheduler suspension counter */
+    rtos_kernel_core_t  core[RTOS_SMP_CORES]; /**< Indexed by rtos_port_get_core_id() */
+    rtos_kernel_state_t state;                /**< Current kernel state */
+    rtos_tick_t         tick_count;           /**< System tick counter */
+    uint8_t             scheduler_suspended;  /**< Scheduler suspension counter */
+    rtos_tick_t         pended_ticks;         /**< Ticks whose scheduling waits for resume */
+    rtos_task_handle_t  pending_ready_head;   /**< Made ready while suspended, FIFO via next */
+    rtos_task_handle_t  pending_ready_tail;   /**< Last pending-ready task */
 } rtos_kernel_cb_t;
-RTOS_STATIC_ASSERT(offsetof(rtos_kernel_cb_t, current_task) == 0, "current_task at wrong offset in kernel_cb_t");
+RTOS_STATIC_ASSERT(offsetof(rtos_kernel_cb_t, core[0].current_task) == 0, "current_task at wrong offset in kernel_cb_t");
 
 /* Global kernel control block */
 extern rtos_kernel_cb_t g_kernel;
 
+/* Calling core's scheduling state; always &g_kernel.core[0] on a single-core port */
+static inline rtos_kernel_core_t *rtos_kernel_this_core(void)
+{
+    return &g_kernel.core[rtos_port_get_core_id()];
+}
+
+/* Core that is running task, or NULL if it is not running (kernel lock held) */
+static inline rtos_kernel_core_t *rtos_kernel_running_core(rtos_task_handle_t task)
+{
+    for (uint32_t i = 0; i < RTOS_SMP_CORES; i++)
+    {
+        if (g_kernel.core[i].current_task == task)
+        {
+            return &g_kernel.core[i];
+        }
+    }
+    return NULL;
+}
+
+#if RTOS_SMP_CORES > 1
+/* Request a context switch on core: pend it locally or interrupt the other core */
+static inline void rtos_kernel_yield_core(rtos_kernel_core_t *core)
+{
+    if (core == rtos_kernel_this_core())
+    {
+        rtos_port_yield();
+    }
+    else
+    {
+        rtos_port_yield_core((uint32_t) (core - g_kernel.core));
+    }
+}
+#endif
+
 /* Internal kernel functions */
 void rtos_kernel_tick_handler(void);
 void rtos_kernel_switch_context(void);
 bool rtos_kernel_validate_transition(rtos_task_handle_t task, rtos_task_state_t new_state);
 
+/* Scheduler suspended: park a task made ready until rtos_scheduler_resume() (kernel lock held) */
+void rtos_kernel_pend_ready(rtos_task_handle_t task);
+
+/* Take a parked task back off the pending-ready list (kernel lock held) */
+void rtos_kernel_unpend_ready(rtos_task_handle_t task);
+
+#if RTOS_SMP_CORES > 1
+/* Secondary-core entry, called by the port once that core is initialised; never returns */
+void rtos_kernel_start_core(void);
+#endif
+
+#if RTOS_PROFILING_SYSTEM_ENABLED
+/* Fold the running task's current slice into its run_cycles (critical section held) */
+void rtos_kernel_runtime_checkpoint(void);
+#endif
+
+#if RTOS_USE_DEFERRED_WORK
+/* Reset the deferred work queue and create its daemon task */
+rtos_status_t rtos_deferred_init(void);
+
+/* Notify the deferred daemon from an ISR; true if it should preempt */
+bool rtos_deferred_wake_from_isr(void);
+
+/* rtos_deferred_post() or its ISR variant, whichever fits the caller */
+rtos_status_t rtos_deferred_post_any(rtos_deferred_fn_t function, void *parameter);
+#endif
+
+#if RTOS_TICKLESS_IDLE
+/* Tickless idle: called by the idle task instead of a bare WFI */
+void rtos_kernel_idle_sleep(void);
+
+/* Port callback, kernel interrupts masked: false if a task became ready meanwhile */
+bool rtos_kernel_confirm_sleep(void);
+
+/* Port callback: account for ticks that elapsed with SysTick suppressed */
+void rtos_kernel_step_tick(rtos_tick_t ticks);
+#endif
+
+/* Scheduler statistics counters (scheduler.c), updated by the kernel and the backends (kernel lock held) */
+#if RTOS_SCHEDULER_STATS
+extern rtos_scheduler_stats_t g_scheduler_stats;
+
+#define RTOS_SCHED_STAT_INC(field) (g_scheduler_stats.field++)
+#define RTOS_SCHED_STAT_HIGH_WATER(field, count)                                                                       \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if ((uint8_t) (count) > g_scheduler_stats.field)                                                               \
+        {                                                                                                              \
+            g_scheduler_stats.field = (uint8_t) (count);                                                               \
+        }                                                                                                              \
+    } while (0)
+#else
+#define RTOS_SCHED_STAT_INC(field)               ((void) 0)
+#define RTOS_SCHED_STAT_HIGH_WATER(field, count) ((void) 0)
+#endif
+
+/* Create every RTOS_QUEUE_DEFINE / RTOS_TASK_DEFINE object (rtos_define.c), queues first */
+rtos_status_t rtos_kernel_create_defined(void);
+
+/* 64-bit time base (rtos_time.c): anchored at rtos_init(), then on every tick count change */
+void rtos_kernel_time_init(void);
+void rtos_kernel_time_update(void);
+
+#if RTOS_USE_LOW_POWER
+/* Power policy (power.c): reset at rtos_init() */
+void rtos_kernel_power_init(void);
+
+/* Wake-up timer setting for a deep sleep: the idle time less the measured wake-up latency */
+rtos_tick_t rtos_kernel_power_sleep_ticks(rtos_power_mode_t mode, rtos_tick_t expected_idle_ticks);
+
+/* Account one sleep; wake_cycles = wake-up to clocks restored, 0 if not measured */
+void rtos_kernel_power_record(rtos_power_mode_t mode, rtos_tick_t ticks, uint32_t wake_cycles);
+
+/* Count a deep sleep the board declined */
+void rtos_kernel_power_record_refusal(void);
+#endif
+
 #endif /* KERNEL_PRIV_H */
@@ -1,41 +1,388 @@
 #include "memory.h"
 
 #include "config.h"
+#include "rtos_mem.h"
+#include "rtos_port.h"
 #include "uart_tx.h"
 #include "utils.h"
 
-#include <string.h>
+/**
+ * TLSF (two-level segregated fit) heap.
+ *
+ * Free blocks are binned by size: the first level splits by power of two,
+ * the second level linearly into HEAP_SL_INDEX_COUNT classes.  Two bitmaps
+ * record which bins are non-empty, so finding a block large enough for a
+ * request is a couple of bit scans — malloc and free are O(1) regardless of
+ * how many blocks are live.  Freed blocks are merged with free physical
+ * neighbours immediately, so there are never two adjacent free blocks.
+ */
+
+#define HEAP_ALIGN_LOG2       (3U) /* 8-byte payload alignment (AAPCS stacks) */
+#define HEAP_SL_INDEX_LOG2    (4U) /* 16 second-level classes per power of two */
+#define HEAP_SL_INDEX_COUNT   (1U << HEAP_SL_INDEX_LOG2)
+#define HEAP_FL_INDEX_SHIFT   (HEAP_SL_INDEX_LOG2 + HEAP_ALIGN_LOG2)
+#define HEAP_FL_INDEX_MAX     (17U) /* Blocks up to 128 KB — all of SRAM */
+#define HEAP_FL_INDEX_COUNT   (HEAP_FL_INDEX_MAX - HEAP_FL_INDEX_SHIFT + 1U)
+#define HEAP_SMALL_BLOCK_SIZE (1U << HEAP_FL_INDEX_SHIFT)
+
+#define HEAP_BLOCK_FREE_BIT ((size_t) 1U)
+
+typedef struct heap_block
+{
+    struct heap_block *prev_phys; /**< Physically preceding block, NULL for the first */
+    size_t             size;      /**< Block size including this header; bit 0 = free */
+
+    /* Valid only while the block is free; overlaps the payload otherwise */
+    struct heap_block *next_free;
+    struct heap_block *prev_free;
+} heap_block_t;
+
+#define HEAP_BLOCK_OVERHEAD (offsetof(heap_block_t, next_free))
+#define HEAP_BLOCK_SIZE_MIN (sizeof(heap_block_t))
+#define HEAP_USABLE_SIZE    ((size_t) (RTOS_TOTAL_HEAP_SIZE & ~((1U << HEAP_ALIGN_LOG2) - 1U)))
+
+/* The end sentinel is written as a whole heap_block_t, so it keeps one in the array */
+#define HEAP_FIRST_BLOCK_SIZE (HEAP_USABLE_SIZE - sizeof(heap_block_t))
+
+RTOS_STATIC_ASSERT((HEAP_BLOCK_OVERHEAD & ((1U << HEAP_ALIGN_LOG2) - 1U)) == 0,
+                   "heap block header must preserve payload alignment");
+RTOS_STATIC_ASSERT(RTOS_TOTAL_HEAP_SIZE < (1UL << HEAP_FL_INDEX_MAX), "RTOS_TOTAL_HEAP_SIZE exceeds TLSF range");
+
+typedef struct
+{
+    uint32_t      fl_bitmap;                                             /**< Non-empty first-level bins */
+    uint32_t      sl_bitmap[HEAP_FL_INDEX_COUNT];                        /**< Non-empty second-level bins */
+    heap_block_t *free_lists[HEAP_FL_INDEX_COUNT][HEAP_SL_INDEX_COUNT]; /**< Free block list heads */
+
+    size_t   free_bytes;      /**< Sum of free block sizes */
+    size_t   min_free_bytes;  /**< Low-water mark of free_bytes */
+    uint32_t alloc_count;     /**< Successful rtos_malloc calls */
+    uint32_t free_count;      /**< Successful rtos_free calls */
+    uint32_t failed_count;    /**< rtos_malloc calls that returned NULL */
+} heap_control_t;
 
 /* Heap memory pool */
-static uint8_t g_heap_memory[RTOS_TOTAL_HEAP_SIZE];
-static size_t  g_heap_index = 0;
+static uint8_t        g_heap_memory[RTOS_TOTAL_HEAP_SIZE] RTOS_HEAP_REGION __attribute__((aligned(8)));
+static heap_control_t g_heap;
+
+static inline uint32_t heap_fls(uint32_t word)
+{
+    return 31U - (uint32_t) __builtin_clz(word);
+}
+
+static inline uint32_t heap_ffs(uint32_t word)
+{
+    return (uint32_t) __builtin_ctz(word);
+}
+
+static inline size_t heap_block_size(const heap_block_t *block)
+{
+    return block->size & ~HEAP_BLOCK_FREE_BIT;
+}
+
+static inline bool heap_block_is_free(const heap_block_t *block)
+{
+    return (block->size & HEAP_BLOCK_FREE_BIT) != 0U;
+}
+
+static inline heap_block_t *heap_block_next(const heap_block_t *block)
+{
+    return (heap_block_t *) ((uint8_t *) block + heap_block_size(block));
+}
+
+/* Bin that a block of exactly `size` bytes belongs to */
+static void heap_mapping_insert(size_t size, uint32_t *fl, uint32_t *sl)
+{
+    if (size < HEAP_SMALL_BLOCK_SIZE)
+    {
+        *fl = 0;
+        *sl = (uint32_t) size / (HEAP_SMALL_BLOCK_SIZE / HEAP_SL_INDEX_COUNT);
+    }
+    else
+    {
+        uint32_t bit = heap_fls((uint32_t) size);
+        *sl          = ((uint32_t) size >> (bit - HEAP_SL_INDEX_LOG2)) ^ HEAP_SL_INDEX_COUNT;
+        *fl          = bit - (HEAP_FL_INDEX_SHIFT - 1U);
+    }
+}
+
+/* Smallest bin whose every block is at least `size` bytes */
+static void heap_mapping_search(size_t size, uint32_t *fl, uint32_t *sl)
+{
+    if (size >= HEAP_SMALL_BLOCK_SIZE)
+    {
+        size += ((size_t) 1U << (heap_fls((uint32_t) size) - HEAP_SL_INDEX_LOG2)) - 1U;
+    }
+    heap_mapping_insert(size, fl, sl);
+}
+
+static heap_block_t *heap_find_suitable(uint32_t *fl, uint32_t *sl)
+{
+    if (*fl >= HEAP_FL_INDEX_COUNT)
+    {
+        return NULL;
+    }
+
+    uint32_t sl_map = g_heap.sl_bitmap[*fl] & (~0U << *sl);
+    if (sl_map == 0U)
+    {
+        uint32_t fl_map = g_heap.fl_bitmap & (~0U << (*fl + 1U));
+        if (fl_map == 0U)
+        {
+            return NULL;
+        }
+
+        *fl    = heap_ffs(fl_map);
+        sl_map = g_heap.sl_bitmap[*fl];
+    }
+
+    *sl = heap_ffs(sl_map);
+    return g_heap.free_lists[*fl][*sl];
+}
+
+static void heap_insert_free(heap_block_t *block)
+{
+    uint32_t fl;
+    uint32_t sl;
+
+    heap_mapping_insert(heap_block_size(block), &fl, &sl);
+
+    heap_block_t *head = g_heap.free_lists[fl][sl];
+    block->next_free   = head;
+    block->prev_free   = NULL;
+    if (head != NULL)
+    {
+        head->prev_free = block;
+    }
+
+    g_heap.free_lists[fl][sl] = block;
+    g_heap.fl_bitmap |= (1U << fl);
+    g_heap.sl_bitmap[fl] |= (1U << sl);
+
+    block->size |= HEAP_BLOCK_FREE_BIT;
+}
+
+static void heap_remove_free(heap_block_t *block)
+{
+    uint32_t fl;
+    uint32_t sl;
+
+    heap_mapping_insert(heap_block_size(block), &fl, &sl);
+
+    if (block->prev_free != NULL)
+    {
+        block->prev_free->next_free = block->next_free;
+    }
+    else
+    {
+        g_heap.free_lists[fl][sl] = block->next_free;
+        if (block->next_free == NULL)
+        {
+            g_heap.sl_bitmap[fl] &= ~(1U << sl);
+            if (g_heap.sl_bitmap[fl] == 0U)
+            {
+                g_heap.fl_bitmap &= ~(1U << fl);
+            }
+        }
+    }
+
+    if (block->next_free != NULL)
+    {
+        block->next_free->prev_free = block->prev_free;
+    }
+
+    block->size &= ~HEAP_BLOCK_FREE_BIT;
+}
+
+/* Trim a used block to `size` bytes, returning the tail to the free lists */
+static void heap_split(heap_block_t *block, size_t size)
+{
+    size_t remainder = heap_block_size(block) - size;
+
+    if (remainder < HEAP_BLOCK_SIZE_MIN)
+    {
+        return;
+    }
+
+    heap_block_t *rest = (heap_block_t *) ((uint8_t *) block + size);
+    rest->prev_phys    = block;
+    rest->size         = remainder;
+    block->size        = size;
+
+    heap_block_next(rest)->prev_phys = rest;
+    heap_insert_free(rest);
+}
 
 void rtos_memory_init(void)
 {
-    g_heap_index = 0;
-    memset(g_heap_memory, 0, sizeof(g_heap_memory));
+    /* Only block headers are ever read before being written, so the heap
+     * itself is not cleared: RTOS_HEAP_REGION may be uncleared SRAM2, and
+     * .bss was zeroed at reset anyway. */
+    rtos_mem_zero(&g_heap, sizeof(g_heap));
+
+    /* One free block spanning the heap, closed by a zero-size used sentinel
+     * so coalescing never has to bounds-check. */
+    heap_block_t *first = (heap_block_t *) g_heap_memory;
+    first->prev_phys    = NULL;
+    first->size         = HEAP_FIRST_BLOCK_SIZE;
+
+    heap_block_t *sentinel = heap_block_next(first);
+    sentinel->prev_phys    = first;
+    sentinel->size         = 0;
+
+    heap_insert_free(first);
+
+    g_heap.free_bytes     = heap_block_size(first);
+    g_heap.min_free_bytes = g_heap.free_bytes;
+
     log_debug("Memory manager initialized. Heap size: %u bytes", RTOS_TOTAL_HEAP_SIZE);
 }
 
 void *rtos_malloc(size_t size)
 {
-    ALIGN8_UP(size);
+    if (size == 0 || size > HEAP_USABLE_SIZE)
+    {
+        return NULL;
+    }
+
+    size_t block_size = ALIGN8_UP_VALUE(size) + HEAP_BLOCK_OVERHEAD;
+    if (block_size < HEAP_BLOCK_SIZE_MIN)
+    {
+        block_size = HEAP_BLOCK_SIZE_MIN;
+    }
+
+    uint32_t fl;
+    uint32_t sl;
+
+    rtos_port_enter_critical();
 
-    if (g_heap_index + size > RTOS_TOTAL_HEAP_SIZE)
+    heap_mapping_search(block_size, &fl, &sl);
+    heap_block_t *block = heap_find_suitable(&fl, &sl);
+
+    if (block == NULL)
+    {
+        /* Rounding up to the next class can skip a block that would fit;
+         * near exhaustion, try the head of the request's own class too. */
+        heap_mapping_insert(block_size, &fl, &sl);
+        if (fl < HEAP_FL_INDEX_COUNT)
+        {
+            block = g_heap.free_lists[fl][sl];
+        }
+        if (block != NULL && heap_block_size(block) < block_size)
+        {
+            block = NULL;
+        }
+    }
+
+    if (block == NULL)
     {
-        log_error("Malloc failed: need %u, free %u", (unsigned int) size,
-                  (unsigned int) (RTOS_TOTAL_HEAP_SIZE - g_heap_index));
+        g_heap.failed_count++;
+        size_t free_bytes = g_heap.free_bytes;
+        rtos_port_exit_critical();
+
+        log_error("Malloc failed: need %u, free %u", (unsigned int) size, (unsigned int) free_bytes);
         return NULL;
     }
 
-    void *ptr = &g_heap_memory[g_heap_index];
-    g_heap_index += size;
+    heap_remove_free(block);
+    heap_split(block, block_size);
+
+    g_heap.free_bytes -= heap_block_size(block);
+    if (g_heap.free_bytes < g_heap.min_free_bytes)
+    {
+        g_heap.min_free_bytes = g_heap.free_bytes;
+    }
+    g_heap.alloc_count++;
+
+    rtos_port_exit_critical();
 
-    return ptr;
+    return (uint8_t *) block + HEAP_BLOCK_OVERHEAD;
 }
 
 void rtos_free(void *ptr)
 {
-    (void) ptr;
-    /* Bump allocator cannot free individual blocks */
+    if (ptr == NULL)
+    {
+        return;
+    }
+
+    if ((uint8_t *) ptr < g_heap_memory + HEAP_BLOCK_OVERHEAD || (uint8_t *) ptr >= g_heap_memory + HEAP_USABLE_SIZE)
+    {
+        log_error("Free of non-heap pointer %p", ptr);
+        return;
+    }
+
+    heap_block_t *block = (heap_block_t *) ((uint8_t *) ptr - HEAP_BLOCK_OVERHEAD);
+
+    rtos_port_enter_critical();
+
+    if (heap_block_is_free(block))
+    {
+        rtos_port_exit_critical();
+        log_error("Double free of %p", ptr);
+        return;
+    }
+
+    g_heap.free_bytes += heap_block_size(block);
+    g_heap.free_count++;
+
+    heap_block_t *prev = block->prev_phys;
+    if (prev != NULL && heap_block_is_free(prev))
+    {
+        heap_remove_free(prev);
+        prev->size += heap_block_size(block);
+        block = prev;
+        heap_block_next(block)->prev_phys = block;
+    }
+
+    heap_block_t *next = heap_block_next(block);
+    if (heap_block_is_free(next))
+    {
+        heap_remove_free(next);
+        block->size += heap_block_size(next);
+        heap_block_next(block)->prev_phys = block;
+    }
+
+    heap_insert_free(block);
+
+    rtos_port_exit_critical();
+}
+
+rtos_status_t rtos_memory_get_stats(rtos_memory_stats_t *stats)
+{
+    if (stats == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_port_enter_critical();
+
+    /* The largest free block lives in the highest non-empty bin; blocks in
+     * one bin differ by less than a class width, so scan just that list. */
+    size_t largest = 0;
+    if (g_heap.fl_bitmap != 0U)
+    {
+        uint32_t fl = heap_fls(g_heap.fl_bitmap);
+        uint32_t sl = heap_fls(g_heap.sl_bitmap[fl]);
+
+        for (heap_block_t *block = g_heap.free_lists[fl][sl]; block != NULL; block = block->next_free)
+        {
+            if (heap_block_size(block) > largest)
+            {
+                largest = heap_block_size(block);
+            }
+        }
+    }
+
+    stats->total_bytes        = HEAP_FIRST_BLOCK_SIZE;
+    stats->free_bytes         = g_heap.free_bytes;
+    stats->largest_free_block = (largest != 0U) ? (largest - HEAP_BLOCK_OVERHEAD) : 0U;
+    stats->peak_used_bytes    = stats->total_bytes - g_heap.min_free_bytes;
+    stats->alloc_count        = g_heap.alloc_count;
+    stats->free_count         = g_heap.free_count;
+    stats->failed_count       = g_heap.failed_count;
+
+    rtos_port_exit_critical();
+
+    return RTOS_SUCCESS;
 }
@@ -0,0 +1,189 @@
+#include "power.h"
+
+#include "VRTOS.h"
+#include "kernel_priv.h"
+#include "rtos_port.h"
+
+#include <stddef.h>
+
+#include "device.h" // IWYU pragma: keep (SystemCoreClock)
+
+#if RTOS_USE_LOW_POWER
+
+RTOS_STATIC_ASSERT(RTOS_POWER_DEEPEST_MODE < RTOS_POWER_MODE_COUNT, "RTOS_POWER_DEEPEST_MODE must be 0, 1 or 2");
+
+/*
+ * Sleep-depth policy.  Only the idle task sleeps, so selection, the stats
+ * and the wake-up latency it uses are all written from the idle task with
+ * kernel interrupts masked; block counts may change from any context.
+ *
+ * The latency is the worst time the board has taken from WFI returning to
+ * its clocks being back (DWT cycles, recorded by the port).  A mode needs
+ * an idle period of its break-even time plus that latency, and its wake-up
+ * timer is armed that much early.
+ */
+static volatile uint16_t g_power_blocks[RTOS_POWER_MODE_COUNT];
+static rtos_power_stats_t g_power_stats;
+
+static const rtos_tick_t g_power_min_idle[RTOS_POWER_MODE_COUNT] = {
+    0U,
+    RTOS_POWER_STOP_MIN_IDLE_TICKS,
+    RTOS_POWER_STANDBY_MIN_IDLE_TICKS,
+};
+
+/* Worst measured wake-up latency of a mode, rounded up to whole ticks */
+static rtos_tick_t power_latency_ticks(rtos_power_mode_t mode)
+{
+    uint32_t cycles_per_tick = SystemCoreClock / RTOS_TICK_RATE_HZ;
+
+    return (g_power_stats.wake_latency_cycles[mode] + cycles_per_tick - 1U) / cycles_per_tick;
+}
+
+/**
+ * @brief Reset the block counts and statistics (rtos_init)
+ */
+void rtos_kernel_power_init(void)
+{
+    for (uint32_t m = 0; m < RTOS_POWER_MODE_COUNT; m++)
+    {
+        g_power_blocks[m]                    = 0;
+        g_power_stats.entries[m]             = 0;
+        g_power_stats.residency_ticks[m]     = 0;
+        g_power_stats.wake_latency_cycles[m] = 0;
+    }
+    g_power_stats.refusals = 0;
+}
+
+/**
+ * @brief Ticks to program into the wake-up timer for a deep sleep
+ */
+rtos_tick_t rtos_kernel_power_sleep_ticks(rtos_power_mode_t mode, rtos_tick_t expected_idle_ticks)
+{
+    if (expected_idle_ticks == RTOS_MAX_DELAY)
+    {
+        return RTOS_MAX_DELAY;
+    }
+
+    rtos_tick_t early = power_latency_ticks(mode);
+
+    return (expected_idle_ticks > early) ? (expected_idle_ticks - early) : 1U;
+}
+
+/**
+ * @brief Account one sleep (port or idle task, kernel interrupts masked or not)
+ * @param wake_cycles Wake-up to clocks-restored cycles, 0 if not measured
+ */
+void rtos_kernel_power_record(rtos_power_mode_t mode, rtos_tick_t ticks, uint32_t wake_cycles)
+{
+    rtos_port_enter_critical();
+
+    g_power_stats.entries[mode]++;
+    g_power_stats.residency_ticks[mode] += ticks;
+    if (wake_cycles > g_power_stats.wake_latency_cycles[mode])
+    {
+        g_power_stats.wake_latency_cycles[mode] = wake_cycles;
+    }
+
+    rtos_port_exit_critical();
+}
+
+/**
+ * @brief Count a deep sleep the board declined
+ */
+void rtos_kernel_power_record_refusal(void)
+{
+    rtos_port_enter_critical();
+    g_power_stats.refusals++;
+    rtos_port_exit_critical();
+}
+
+#endif /* RTOS_USE_LOW_POWER */
+
+rtos_status_t rtos_power_block(rtos_power_mode_t mode)
+{
+    if (mode == RTOS_POWER_MODE_SLEEP || mode >= RTOS_POWER_MODE_COUNT)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+#if RTOS_USE_LOW_POWER
+    uint32_t saved = rtos_port_enter_critical_from_isr();
+    g_power_blocks[mode]++;
+    rtos_port_exit_critical_from_isr(saved);
+#endif
+
+    return RTOS_SUCCESS;
+}
+
+rtos_status_t rtos_power_unblock(rtos_power_mode_t mode)
+{
+    if (mode == RTOS_POWER_MODE_SLEEP || mode >= RTOS_POWER_MODE_COUNT)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+#if RTOS_USE_LOW_POWER
+    rtos_status_t status = RTOS_SUCCESS;
+    uint32_t      saved  = rtos_port_enter_critical_from_isr();
+
+    if (g_power_blocks[mode] == 0U)
+    {
+        status = RTOS_ERROR_INVALID_STATE;
+    }
+    else
+    {
+        g_power_blocks[mode]--;
+    }
+
+    rtos_port_exit_critical_from_isr(saved);
+    return status;
+#else
+    return RTOS_SUCCESS;
+#endif
+}
+
+rtos_power_mode_t rtos_power_select_mode(rtos_tick_t expected_idle_ticks)
+{
+    rtos_power_mode_t mode = RTOS_POWER_MODE_SLEEP;
+
+#if RTOS_USE_LOW_POWER
+    for (uint32_t m = RTOS_POWER_MODE_STOP; m <= RTOS_POWER_DEEPEST_MODE; m++)
+    {
+        /* A block on a mode also rules out every deeper one */
+        if (g_power_blocks[m] != 0U)
+        {
+            break;
+        }
+
+        if (expected_idle_ticks != RTOS_MAX_DELAY &&
+            expected_idle_ticks < g_power_min_idle[m] + power_latency_ticks((rtos_power_mode_t) m))
+        {
+            break;
+        }
+
+        mode = (rtos_power_mode_t) m;
+    }
+#else
+    (void) expected_idle_ticks;
+#endif
+
+    return mode;
+}
+
+rtos_status_t rtos_power_get_stats(rtos_power_stats_t *stats)
+{
+    if (stats == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+#if RTOS_USE_LOW_POWER
+    rtos_port_enter_critical();
+    *stats = g_power_stats;
+    rtos_port_exit_critical();
+
+    return RTOS_SUCCESS;
+#else
+    return RTOS_ERROR_INVALID_STATE;
+#endif
+}
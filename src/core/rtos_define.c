@@ -0,0 +1,39 @@
+#include "rtos_define.h"
+
+#include "kernel_priv.h"
+
+#include <stddef.h>
+
+/*
+ * Section bounds: from the STM32 link scripts, or provided by the host
+ * linker for sections named like C identifiers. Weak, so an image with no
+ * definitions links with both bounds NULL and an empty walk.
+ */
+extern const rtos_task_def_t  __start_rtos_task_defs[] __attribute__((weak));
+extern const rtos_task_def_t  __stop_rtos_task_defs[] __attribute__((weak));
+extern const rtos_queue_def_t __start_rtos_queue_defs[] __attribute__((weak));
+extern const rtos_queue_def_t __stop_rtos_queue_defs[] __attribute__((weak));
+
+rtos_status_t rtos_kernel_create_defined(void)
+{
+    for (const rtos_queue_def_t *q = __start_rtos_queue_defs; q < __stop_rtos_queue_defs; q++)
+    {
+        rtos_status_t status = rtos_queue_create_static(q->handle, q->control, q->storage, q->item_count, q->item_size);
+        if (status != RTOS_SUCCESS)
+        {
+            return status;
+        }
+    }
+
+    for (const rtos_task_def_t *t = __start_rtos_task_defs; t < __stop_rtos_task_defs; t++)
+    {
+        rtos_status_t status = rtos_task_create_static(t->function, t->name, t->stack, t->stack_size, t->parameter,
+                                                       t->priority, t->flags, t->handle);
+        if (status != RTOS_SUCCESS)
+        {
+            return status;
+        }
+    }
+
+    return RTOS_SUCCESS;
+}
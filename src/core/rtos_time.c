@@ -0,0 +1,148 @@
+/*******************************************************************************
+ * File: src/core/rtos_time.c
+ * Description: Monotonic 64-bit tick, cycle and nanosecond time base
+ ******************************************************************************/
+
+#include "rtos_time.h"
+
+#include "config.h"
+#include "kernel_priv.h"
+
+#include <stddef.h>
+
+/* CMSIS for DWT, DMB, SystemCoreClock */
+#include "device.h" // IWYU pragma: keep
+
+#define TIME_NS_PER_SEC  1000000000ULL
+#define TIME_NS_PER_TICK (TIME_NS_PER_SEC / RTOS_TICK_RATE_HZ)
+
+typedef struct
+{
+    uint64_t ticks;  /* 64-bit tick count at the anchor */
+    uint64_t cycles; /* 64-bit cycle count at the anchor; low word is CYCCNT then */
+} time_anchor_t;
+
+/*
+ * Only the tick handler (or the port, with kernel interrupts masked, after
+ * tickless sleep) writes an anchor: it fills slot (seq + 1) & 1 and then
+ * advances seq.  Readers use slot seq & 1.  An update that completes during
+ * a read goes to the other slot, so the copy is only torn if seq moved by
+ * two or more, and then the reader retries.  An anchor one tick stale is
+ * still exact: the cycles since it are added from CYCCNT.
+ */
+static time_anchor_t     g_time_anchor[2];
+static volatile uint32_t g_time_seq;
+
+/* Fixed at rtos_init() from SystemCoreClock */
+static uint32_t g_time_cycles_per_tick;
+static uint64_t g_time_ns_per_cycle_q32; /* ns per cycle, 32.32 fixed point */
+
+static inline void time_read(time_anchor_t *anchor, uint32_t *now)
+{
+    uint32_t seq;
+    do
+    {
+        seq = g_time_seq;
+        __DMB();
+        *anchor = g_time_anchor[seq & 1U];
+        *now    = DWT->CYCCNT;
+        __DMB();
+    } while ((g_time_seq - seq) > 1U);
+}
+
+static void time_publish(uint64_t ticks, uint64_t cycles)
+{
+    uint32_t next = g_time_seq + 1U;
+
+    g_time_anchor[next & 1U].ticks  = ticks;
+    g_time_anchor[next & 1U].cycles = cycles;
+
+    /* Anchor contents must be visible before the slot is published */
+    __DMB();
+    g_time_seq = next;
+}
+
+/**
+ * @brief Start the time base at the current tick and CYCCNT (rtos_init)
+ *
+ * Turns the cycle counter on if profiling has not already done so.
+ */
+void rtos_kernel_time_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    g_time_cycles_per_tick  = SystemCoreClock / RTOS_TICK_RATE_HZ;
+    g_time_ns_per_cycle_q32 = (SystemCoreClock != 0U) ? ((TIME_NS_PER_SEC << 32) / SystemCoreClock) : 0U;
+
+    time_publish(g_kernel.tick_count, DWT->CYCCNT);
+}
+
+/**
+ * @brief Move the anchor to the current tick (tick handler, rtos_kernel_step_tick)
+ *
+ * Catches up however many ticks were counted since the last anchor, so the
+ * tickless path can step the count and then call this once.
+ */
+void rtos_kernel_time_update(void)
+{
+    const time_anchor_t *prev = &g_time_anchor[g_time_seq & 1U];
+    uint32_t             now  = DWT->CYCCNT;
+
+    uint64_t ticks  = prev->ticks + (rtos_tick_t) (g_kernel.tick_count - (rtos_tick_t) prev->ticks);
+    uint64_t cycles = prev->cycles + (uint32_t) (now - (uint32_t) prev->cycles);
+
+    time_publish(ticks, cycles);
+}
+
+uint64_t rtos_get_tick_count64(void)
+{
+    time_anchor_t anchor;
+    uint32_t      now;
+
+    time_read(&anchor, &now);
+
+    /* The tick handler counts before it re-anchors */
+    return anchor.ticks + (rtos_tick_t) (g_kernel.tick_count - (rtos_tick_t) anchor.ticks);
+}
+
+uint64_t rtos_time_cycles64(void)
+{
+    time_anchor_t anchor;
+    uint32_t      now;
+
+    time_read(&anchor, &now);
+
+    return anchor.cycles + (uint32_t) (now - (uint32_t) anchor.cycles);
+}
+
+uint64_t rtos_time_now_ns(void)
+{
+    time_anchor_t anchor;
+    uint32_t      now;
+
+    time_read(&anchor, &now);
+
+    /* A late or skipped tick must not carry the time past the next tick's value */
+    uint32_t into_tick = now - (uint32_t) anchor.cycles;
+    if (into_tick >= g_time_cycles_per_tick)
+    {
+        into_tick = (g_time_cycles_per_tick != 0U) ? (g_time_cycles_per_tick - 1U) : 0U;
+    }
+
+    return (anchor.ticks * TIME_NS_PER_TICK) + (((uint64_t) into_tick * g_time_ns_per_cycle_q32) >> 32);
+}
+
+uint64_t rtos_time_cycles_to_ns(uint64_t cycles)
+{
+    if (SystemCoreClock == 0U)
+    {
+        return 0;
+    }
+
+    /* Split into seconds so cycles * 10^9 cannot overflow */
+    uint64_t seconds = cycles / SystemCoreClock;
+    uint64_t rest    = cycles % SystemCoreClock;
+
+    return (seconds * TIME_NS_PER_SEC) + ((rest * TIME_NS_PER_SEC) / SystemCoreClock);
+}
@@ -1,7 +1,7 @@
 #include "VRTOS.h"
+#include "device.h" // IWYU pragma: keep
 #include "hardware_env.h"
 #include "log_flush_task.h"
-#include "stm32f4xx_hal.h" // IWYU pragma: keep
 #include "task.h"
 #include "task_priv.h"
 #include "uart_tx.h"
@@ -18,7 +18,8 @@
 
 /* =================== Tasks =================== */
 
-rtos_profile_stat_t prof_work = {UINT32_MAX, 0, 0, 0, "WorkBlock"};
+static rtos_profile_hist_t prof_work_hist;
+rtos_profile_stat_t        prof_work = {UINT32_MAX, 0, 0, 0, "WorkBlock", &prof_work_hist};
 
 /* Task that does some simulated work (highest user priority) */
 void WorkTask(void *param)
@@ -1,52 +1,262 @@
 #include "klog.h"
 
-#include "ring_buffer.h"
+#include "log_flush_task.h"
+#include "rtos_time.h"
+#include "rtt.h"
 
+#include <stdbool.h>
 #include <stddef.h>
+#include <string.h>
 
-/* CMSIS for DWT, __disable_irq, __enable_irq, IPSR */
-#include "stm32f4xx.h" // IWYU pragma: keep
-
-/* Buffer in .noinit — survives soft reset for post-mortem inspection */
-static volatile uint8_t klog_buf[KLOG_BUFFER_SIZE] __attribute__((section(".noinit")));
-static ring_buffer_t    klog_rb;
+/* CMSIS for DWT, LDREX/STREX, DMB, IPSR */
+#include "device.h" // IWYU pragma: keep
 
 /* Forward declaration — defined in kernel or stub */
 extern uint8_t rtos_get_current_task_id(void);
 
+#define KLOG_FILTER_BOOT_MASK(level) (((level) <= KLOG_RUNTIME_LEVEL) ? (uint32_t) KLOG_SUBSYS_ALL : 0U)
+
+/* .data, not .noinit: a reset always starts from the build's levels */
+volatile klog_filter_t klog_filter = {
+    KLOG_FILTER_MAGIC,
+    {KLOG_FILTER_BOOT_MASK(KLOG_LEVEL_FAULT), KLOG_FILTER_BOOT_MASK(KLOG_LEVEL_ERROR),
+     KLOG_FILTER_BOOT_MASK(KLOG_LEVEL_WARN), KLOG_FILTER_BOOT_MASK(KLOG_LEVEL_INFO),
+     KLOG_FILTER_BOOT_MASK(KLOG_LEVEL_DEBUG), KLOG_FILTER_BOOT_MASK(KLOG_LEVEL_TRACE)},
+};
+
+static volatile uint32_t klog_dropped; /* Records lost to a full ring */
+static volatile uint32_t klog_epoch;   /* High word of the cycle count last announced */
+
+static void klog_count_drop(uint32_t count)
+{
+    uint32_t n;
+    do
+    {
+        n = __LDREXW(&klog_dropped);
+    } while (__STREXW(n + count, &klog_dropped) != 0U);
+}
+
+/* ISR number from IPSR, or the current task ID */
+static inline uint8_t klog_cpu_context(void)
+{
+    uint32_t ipsr = __get_IPSR();
+    if (ipsr != 0)
+    {
+        return (uint8_t) (ipsr & 0xFF);
+    }
+    return rtos_get_current_task_id();
+}
+
+#if LOG_BACKEND_RTT
+
+#if KLOG_FLIGHT_RECORDER
+#error "KLOG_FLIGHT_RECORDER keeps records in the RAM ring; it cannot be combined with LOG_BACKEND_RTT"
+#endif
+
+/* Records go straight to the RTT KLog channel; the debugger is the consumer */
 void klog_init(void)
 {
-    ring_buffer_init(&klog_rb, (uint8_t *) klog_buf, KLOG_BUFFER_SIZE);
+    rtt_init();
+    klog_dropped = 0;
+    klog_epoch   = 0;
 }
 
-void klog_write(klog_level_t level, uint16_t event_id, uint32_t arg0, uint32_t arg1)
+static bool klog_put(klog_level_t level, uint16_t event_id, uint32_t timestamp, uint32_t arg0, uint32_t arg1)
 {
     klog_record_t record;
-
-    record.timestamp_cycles = DWT->CYCCNT;
+    record.timestamp_cycles = timestamp;
     record.event_id         = event_id;
     record.level            = (uint8_t) level;
+    record.cpu_context      = klog_cpu_context();
     record.arg0             = arg0;
     record.arg1             = arg1;
 
-    /* Detect ISR vs task context via IPSR */
-    uint32_t ipsr = __get_IPSR();
-    if (ipsr != 0)
+    if (!rtt_write(RTT_CHANNEL_KLOG, &record, sizeof(record)))
+    {
+        klog_count_drop(1U);
+        return false;
+    }
+    return true;
+}
+
+uint32_t klog_drain(klog_record_t *out, uint32_t max_records)
+{
+    (void) out;
+    (void) max_records;
+    return 0;
+}
+
+uint32_t klog_pending(void)
+{
+    return 0;
+}
+
+#else
+
+#define KLOG_SLOTS (KLOG_BUFFER_SIZE / sizeof(klog_record_t))
+
+_Static_assert((KLOG_BUFFER_SIZE % sizeof(klog_record_t)) == 0, "KLOG_BUFFER_SIZE must be a multiple of 16");
+_Static_assert((KLOG_SLOTS & (KLOG_SLOTS - 1U)) == 0, "KLOG_BUFFER_SIZE must be a power of 2");
+
+/* Records in .noinit — survive soft reset for post-mortem inspection */
+static volatile klog_record_t klog_slots[KLOG_SLOTS] __attribute__((section(".noinit")));
+
+static volatile uint32_t klog_head; /* Next position to reserve (producers) */
+static volatile uint32_t klog_tail; /* Next position to drain (written by consumer only) */
+
+#if KLOG_FLIGHT_RECORDER
+
+/*
+ * Flight recorder: lock-free multi-producer ring that never refuses a record.
+ *
+ * A producer claims position `pos` by advancing klog_head with LDREX/STREX
+ * and overwrites slot pos % SLOTS whatever it holds, then stores the
+ * position and a check word over position and record. Both go in after the
+ * record, so a record torn by a reset, or by a writer that lapped it, fails
+ * its check. A write costs the same on an empty or a full ring and never
+ * wakes the flush task.
+ *
+ * Header, records, positions and check words are all in .noinit. At boot
+ * klog_init() accepts the old ring if the header is intact and has the same
+ * geometry, keeps the slots whose check holds, and carries on numbering
+ * after the newest of them. klog_pending() / klog_drain() cover only those
+ * recovered records; the running boot's records stay in the ring for the
+ * next reset or klog_snapshot(). Each new write, KEVT_KLOG_BOOT from
+ * klog_init() first, replaces the oldest recovered record not yet drained.
+ */
+#define KLOG_RECORDER_MAGIC (0x4B4C4652U) /* "KLFR" */
+#define KLOG_RECORDER_CHECK ((uint32_t) ~(KLOG_RECORDER_MAGIC ^ (uint32_t) KLOG_SLOTS))
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t slots; /* KLOG_SLOTS of the build that wrote the ring */
+    uint32_t check; /* KLOG_RECORDER_CHECK */
+} klog_recorder_header_t;
+
+static volatile klog_recorder_header_t klog_header __attribute__((section(".noinit")));
+static volatile uint32_t               klog_slot_pos[KLOG_SLOTS] __attribute__((section(".noinit")));
+static volatile uint32_t               klog_slot_check[KLOG_SLOTS] __attribute__((section(".noinit")));
+
+static volatile uint32_t klog_saved_end; /* One past the newest recovered position */
+static volatile uint32_t klog_recovered;
+
+/* Four multiply-xor rounds over the record words, keyed by position */
+static inline uint32_t klog_record_check(uint32_t pos, const klog_record_t *record)
+{
+    uint32_t words[sizeof(klog_record_t) / sizeof(uint32_t)];
+    uint32_t h = KLOG_RECORDER_MAGIC ^ pos;
+
+    memcpy(words, record, sizeof(words));
+    for (uint32_t i = 0; i < sizeof(words) / sizeof(words[0]); i++)
     {
-        record.cpu_context = (uint8_t) (ipsr & 0xFF); /* ISR number */
+        h = (h ^ words[i]) * 0x01000193U;
+    }
+    return h;
+}
+
+/* Copy the record at pos; false if the slot holds another position or a torn record */
+static bool klog_read_slot(uint32_t pos, klog_record_t *out)
+{
+    uint32_t idx = pos & (KLOG_SLOTS - 1U);
+
+    if (klog_slot_pos[idx] != pos)
+    {
+        return false;
+    }
+    __DMB();
+    *out = klog_slots[idx];
+    __DMB();
+    return klog_slot_pos[idx] == pos && klog_slot_check[idx] == klog_record_check(pos, out);
+}
+
+/* Intact slot of the old ring: where its own position says it should be */
+static bool klog_slot_valid(uint32_t idx, uint32_t *pos)
+{
+    klog_record_t record;
+
+    *pos = klog_slot_pos[idx];
+    return (*pos & (KLOG_SLOTS - 1U)) == idx && klog_read_slot(*pos, &record);
+}
+
+void klog_init(void)
+{
+    bool     found  = false;
+    uint32_t newest = 0;
+    uint32_t span   = 0; /* newest - oldest recovered position */
+    uint32_t count  = 0;
+    uint32_t pos;
+
+    if (klog_header.magic == KLOG_RECORDER_MAGIC && klog_header.slots == KLOG_SLOTS &&
+        klog_header.check == KLOG_RECORDER_CHECK)
+    {
+        for (uint32_t i = 0; i < KLOG_SLOTS; i++)
+        {
+            if (klog_slot_valid(i, &pos) && (!found || (int32_t) (pos - newest) > 0))
+            {
+                newest = pos;
+                found  = true;
+            }
+        }
+        /* Only the last SLOTS positions belong to the old ring; anything older is stale */
+        for (uint32_t i = 0; found && i < KLOG_SLOTS; i++)
+        {
+            if (klog_slot_valid(i, &pos) && newest - pos < KLOG_SLOTS)
+            {
+                count++;
+                span = (newest - pos > span) ? newest - pos : span;
+            }
+        }
     }
     else
     {
-        record.cpu_context = rtos_get_current_task_id();
+        /* Cold boot: RAM is random, make every slot fail its position test */
+        for (uint32_t i = 0; i < KLOG_SLOTS; i++)
+        {
+            klog_slot_pos[i] = i + 1U;
+        }
+        klog_header.magic = KLOG_RECORDER_MAGIC;
+        klog_header.slots = KLOG_SLOTS;
+        klog_header.check = KLOG_RECORDER_CHECK;
     }
 
-    /* Atomic write: disable interrupts for the brief ring buffer operation */
-    uint32_t primask = __get_PRIMASK();
-    __disable_irq();
+    klog_head      = found ? newest + 1U : 0U;
+    klog_tail      = found ? newest - span : 0U;
+    klog_saved_end = klog_head;
+    klog_recovered = count;
+    klog_dropped   = 0;
+    klog_epoch     = 0;
 
-    ring_buffer_write(&klog_rb, &record, sizeof(record));
+    klog_write(KLOG_LEVEL_INFO, KEVT_KLOG_BOOT, count, klog_head);
+}
+
+static bool klog_put(klog_level_t level, uint16_t event_id, uint32_t timestamp, uint32_t arg0, uint32_t arg1)
+{
+    klog_record_t record;
+    record.timestamp_cycles = timestamp;
+    record.event_id         = event_id;
+    record.level            = (uint8_t) level;
+    record.cpu_context      = klog_cpu_context();
+    record.arg0             = arg0;
+    record.arg1             = arg1;
+
+    /* Claim the next position unconditionally: the oldest record goes */
+    uint32_t pos;
+    do
+    {
+        pos = __LDREXW(&klog_head);
+    } while (__STREXW(pos + 1U, &klog_head) != 0U);
+
+    uint32_t idx   = pos & (KLOG_SLOTS - 1U);
+    uint32_t check = klog_record_check(pos, &record);
 
-    __set_PRIMASK(primask);
+    klog_slots[idx] = record;
+
+    /* A reset or overtaking writer before these stores leaves a failing check */
+    __DMB();
+    klog_slot_check[idx] = check;
+    klog_slot_pos[idx]   = pos;
+    return true;
 }
 
 uint32_t klog_drain(klog_record_t *out, uint32_t max_records)
@@ -58,21 +268,226 @@ uint32_t klog_drain(klog_record_t *out, uint32_t max_records)
 
     uint32_t count = 0;
 
-    /* Drain under interrupt protection to ensure record integrity */
-    uint32_t primask = __get_PRIMASK();
-    __disable_irq();
+    while (count < max_records && (int32_t) (klog_saved_end - klog_tail) > 0)
+    {
+        /* Writers have lapped the drain: those recovered records are gone */
+        uint32_t oldest = klog_head - KLOG_SLOTS;
+        if ((int32_t) (oldest - klog_tail) > 0)
+        {
+            klog_count_drop(((int32_t) (klog_saved_end - oldest) > 0 ? oldest : klog_saved_end) - klog_tail);
+            klog_tail = oldest;
+            continue;
+        }
+
+        /* Never written, torn, or from an older run: skip */
+        if (klog_read_slot(klog_tail, &out[count]))
+        {
+            count++;
+        }
+        klog_tail++;
+    }
+
+    return count;
+}
+
+uint32_t klog_pending(void)
+{
+    int32_t left = (int32_t) (klog_saved_end - klog_tail);
+    return (left > 0) ? (uint32_t) left : 0U;
+}
+
+uint32_t klog_get_recovered(void)
+{
+    return klog_recovered;
+}
+
+uint32_t klog_snapshot(klog_record_t *out, uint32_t max_records)
+{
+    if (out == NULL)
+    {
+        return 0;
+    }
+
+    uint32_t n     = (max_records < KLOG_SLOTS) ? max_records : KLOG_SLOTS;
+    uint32_t head  = klog_head;
+    uint32_t count = 0;
+
+    for (uint32_t pos = head - n; pos != head; pos++)
+    {
+        if (klog_read_slot(pos, &out[count]))
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+#else
+
+/*
+ * Lock-free multi-producer / single-consumer ring of fixed 16-byte records.
+ *
+ * Each slot carries a sequence number. A producer owns position `pos` once
+ * it has advanced klog_head from pos to pos + 1 with LDREX/STREX, which
+ * succeeds only if slot_seq == pos (slot free). It fills the record and
+ * publishes it by setting slot_seq = pos + 1. The consumer reads a slot
+ * once slot_seq == tail + 1 and frees it by setting slot_seq = tail + SLOTS.
+ *
+ * Exception entry/return clears the exclusive monitor, so a producer
+ * preempted by a logging ISR retries its reservation instead of colliding.
+ * Interrupts are never masked.
+ */
+static volatile uint32_t klog_slot_seq[KLOG_SLOTS];
+
+void klog_init(void)
+{
+    for (uint32_t i = 0; i < KLOG_SLOTS; i++)
+    {
+        klog_slot_seq[i] = i;
+    }
+    klog_head    = 0;
+    klog_tail    = 0;
+    klog_dropped = 0;
+    klog_epoch   = 0;
+}
+
+static bool klog_put(klog_level_t level, uint16_t event_id, uint32_t timestamp, uint32_t arg0, uint32_t arg1)
+{
+    uint8_t cpu_context = klog_cpu_context();
+
+    /* Reserve a slot: claim klog_head only while its slot is free */
+    uint32_t pos;
+    for (;;)
+    {
+        pos = __LDREXW(&klog_head);
+
+        if ((int32_t) (klog_slot_seq[pos & (KLOG_SLOTS - 1U)] - pos) < 0)
+        {
+            __CLREX();
+            klog_count_drop(1U); /* Consumer has not freed this slot yet: full */
+            log_flush_request();
+            return false;
+        }
+
+        if (__STREXW(pos + 1U, &klog_head) == 0U)
+        {
+            break;
+        }
+    }
+
+    volatile klog_record_t *record = &klog_slots[pos & (KLOG_SLOTS - 1U)];
+    record->timestamp_cycles       = timestamp;
+    record->event_id               = event_id;
+    record->level                  = (uint8_t) level;
+    record->cpu_context            = cpu_context;
+    record->arg0                   = arg0;
+    record->arg1                   = arg1;
+
+    /* Record contents must be visible before the slot is published */
+    __DMB();
+    klog_slot_seq[pos & (KLOG_SLOTS - 1U)] = pos + 1U;
+
+    /* Positions are unique, so exactly one writer sees the fill reach the mark */
+    if ((pos + 1U) - klog_tail == KLOG_FLUSH_WATERMARK)
+    {
+        log_flush_request();
+    }
+    return true;
+}
+
+uint32_t klog_drain(klog_record_t *out, uint32_t max_records)
+{
+    if (out == NULL || max_records == 0)
+    {
+        return 0;
+    }
+
+    uint32_t count = 0;
 
     while (count < max_records)
     {
-        uint32_t bytes = ring_buffer_read(&klog_rb, &out[count], sizeof(klog_record_t));
-        if (bytes < sizeof(klog_record_t))
+        uint32_t idx = klog_tail & (KLOG_SLOTS - 1U);
+
+        /* Stops at an empty slot or one a preempted producer is still filling */
+        if (klog_slot_seq[idx] != klog_tail + 1U)
         {
             break;
         }
+        __DMB();
+
+        out[count] = klog_slots[idx];
+
+        /* Copy must complete before the slot is handed back to producers */
+        __DMB();
+        klog_slot_seq[idx] = klog_tail + KLOG_SLOTS;
+        klog_tail++;
         count++;
     }
 
-    __set_PRIMASK(primask);
-
     return count;
 }
+
+uint32_t klog_pending(void)
+{
+    return klog_head - klog_tail;
+}
+
+#endif /* KLOG_FLIGHT_RECORDER */
+
+#endif /* LOG_BACKEND_RTT */
+
+/*
+ * Records carry the low word of rtos_time_cycles64(), which is CYCCNT.  The
+ * first record after the high word changes is preceded by KEVT_TIME_EPOCH
+ * (arg0 = low word, arg1 = high word), so a decoder can rebuild 64-bit
+ * timestamps from any point in the stream.  klog_epoch only moves once the
+ * marker is in the buffer; a dropped marker is retried by the next write,
+ * and two writers racing at the change may both emit one.
+ */
+void klog_write(klog_level_t level, uint16_t event_id, uint32_t arg0, uint32_t arg1)
+{
+    uint64_t now   = rtos_time_cycles64();
+    uint32_t epoch = (uint32_t) (now >> 32);
+
+    if (epoch != klog_epoch && klog_put(KLOG_LEVEL_INFO, KEVT_TIME_EPOCH, (uint32_t) now, (uint32_t) now, epoch))
+    {
+        klog_epoch = epoch;
+    }
+
+    (void) klog_put(level, event_id, (uint32_t) now, arg0, arg1);
+}
+
+uint32_t klog_get_dropped(void)
+{
+    return klog_dropped;
+}
+
+void klog_filter_set(uint32_t subsys_mask, klog_level_t max_level)
+{
+    subsys_mask &= (uint32_t) KLOG_SUBSYS_ALL;
+
+    for (uint32_t level = KLOG_LEVEL_ERROR; level < KLOG_LEVEL_COUNT; level++)
+    {
+        volatile uint32_t *mask = &klog_filter.level_mask[level];
+        uint32_t           m;
+        do
+        {
+            m = __LDREXW(mask);
+            m = (level <= (uint32_t) max_level) ? (m | subsys_mask) : (m & ~subsys_mask);
+        } while (__STREXW(m, mask) != 0U);
+    }
+}
+
+klog_level_t klog_filter_get(klog_subsys_t subsys)
+{
+    klog_level_t highest = KLOG_LEVEL_FAULT;
+
+    for (uint32_t level = KLOG_LEVEL_ERROR; level < KLOG_LEVEL_COUNT; level++)
+    {
+        if ((klog_filter.level_mask[level] & (1UL << subsys)) != 0U)
+        {
+            highest = (klog_level_t) level;
+        }
+    }
+    return highest;
+}
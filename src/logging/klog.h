@@ -11,7 +11,18 @@ extern "C"
 #endif
 
 #ifndef KLOG_BUFFER_SIZE
-#define KLOG_BUFFER_SIZE 2048 /* Must be power of 2 */
+#define KLOG_BUFFER_SIZE 2048 /* Must be power of 2, multiple of sizeof(klog_record_t) */
+#endif
+
+/* Pending records at which klog_write() wakes the flush task early */
+#ifndef KLOG_FLUSH_WATERMARK
+#define KLOG_FLUSH_WATERMARK ((KLOG_BUFFER_SIZE / 16U) / 2U)
+#endif
+
+/* Flight recorder: writes overwrite the oldest record instead of dropping,
+ * and the ring is recovered after a warm reset (see klog.c) */
+#ifndef KLOG_FLIGHT_RECORDER
+#define KLOG_FLIGHT_RECORDER 0
 #endif
 
 #ifndef KLOG_MIN_LEVEL
@@ -28,6 +39,81 @@ typedef enum
     KLOG_LEVEL_TRACE,
 } klog_level_t;
 
+#define KLOG_LEVEL_COUNT (KLOG_LEVEL_TRACE + 1)
+
+/* Runtime filter: KLOG() also tests a per-level subsystem mask (see below) */
+#ifndef KLOG_RUNTIME_FILTER
+#define KLOG_RUNTIME_FILTER 1
+#endif
+
+/* Levels enabled in every subsystem at boot; KLOG_MIN_LEVEL stays the ceiling */
+#ifndef KLOG_RUNTIME_LEVEL
+#define KLOG_RUNTIME_LEVEL KLOG_MIN_LEVEL
+#endif
+
+/**
+ * @brief Subsystems of the runtime filter, one per KEVT_* range in klog_events.h
+ *
+ * One bit each in klog_filter.level_mask[]. tools/klog_filter.py reads the
+ * names from here.
+ */
+typedef enum
+{
+    KLOG_SUBSYS_TASK = 0,       /* 0x0000 - 0x001F */
+    KLOG_SUBSYS_SCHEDULER,      /* 0x0020 - 0x003F */
+    KLOG_SUBSYS_SYNC,           /* 0x0040 - 0x005F: mutex, semaphore */
+    KLOG_SUBSYS_TIMER,          /* 0x0060 - 0x007F */
+    KLOG_SUBSYS_PORT,           /* 0x0080 - 0x009F */
+    KLOG_SUBSYS_FAULT,          /* 0x00A0 - 0x00CF */
+    KLOG_SUBSYS_QUEUE,          /* 0x00D0 - 0x00DF */
+    KLOG_SUBSYS_SCHED_INTERNAL, /* 0x00E0 - 0x00FF */
+    KLOG_SUBSYS_NOTIFY,         /* 0x0100 - 0x010F */
+    KLOG_SUBSYS_EVENT_GROUP,    /* 0x0110 - 0x011F */
+    KLOG_SUBSYS_MEMORY,         /* 0x0120 - 0x012F */
+    KLOG_SUBSYS_STREAM,         /* 0x0130 - 0x013F */
+    KLOG_SUBSYS_QUEUE_SET,      /* 0x0140 - 0x014F */
+    KLOG_SUBSYS_RWLOCK,         /* 0x0150 - 0x015F */
+    KLOG_SUBSYS_OTHER,          /* Any other ID */
+    KLOG_SUBSYS_COUNT,
+} klog_subsys_t;
+
+#define KLOG_SUBSYS_ALL ((1UL << KLOG_SUBSYS_COUNT) - 1UL)
+
+/* Folds to a constant for a constant ID, as every KLOG() call site has */
+#define KLOG_SUBSYS_OF(id)                                                                                             \
+    ((id) < 0x0020U   ? KLOG_SUBSYS_TASK                                                                             \
+     : (id) < 0x0040U ? KLOG_SUBSYS_SCHEDULER                                                                        \
+     : (id) < 0x0060U ? KLOG_SUBSYS_SYNC                                                                             \
+     : (id) < 0x0080U ? KLOG_SUBSYS_TIMER                                                                            \
+     : (id) < 0x00A0U ? KLOG_SUBSYS_PORT                                                                             \
+     : (id) < 0x00D0U ? KLOG_SUBSYS_FAULT                                                                            \
+     : (id) < 0x00E0U ? KLOG_SUBSYS_QUEUE                                                                            \
+     : (id) < 0x0100U ? KLOG_SUBSYS_SCHED_INTERNAL                                                                   \
+     : (id) < 0x0110U ? KLOG_SUBSYS_NOTIFY                                                                           \
+     : (id) < 0x0120U ? KLOG_SUBSYS_EVENT_GROUP                                                                      \
+     : (id) < 0x0130U ? KLOG_SUBSYS_MEMORY                                                                           \
+     : (id) < 0x0140U ? KLOG_SUBSYS_STREAM                                                                           \
+     : (id) < 0x0150U ? KLOG_SUBSYS_QUEUE_SET                                                                        \
+     : (id) < 0x0160U ? KLOG_SUBSYS_RWLOCK                                                                           \
+                      : KLOG_SUBSYS_OTHER)
+
+/**
+ * @brief Runtime filter state
+ *
+ * level_mask[level] has bit KLOG_SUBSYS_x set when that level is recorded
+ * for subsystem x. The magic lets a debugger find the block by scanning RAM
+ * and change the masks while the target runs (tools/klog_filter.py).
+ */
+#define KLOG_FILTER_MAGIC "KLOGFLT"
+
+typedef struct
+{
+    char     magic[8];
+    uint32_t level_mask[KLOG_LEVEL_COUNT];
+} klog_filter_t;
+
+extern volatile klog_filter_t klog_filter;
+
 /**
  * @brief Fixed-size binary log record (16 bytes)
  *
@@ -36,7 +122,7 @@ typedef enum
  */
 typedef struct __attribute__((packed))
 {
-    uint32_t timestamp_cycles; /* Raw DWT->CYCCNT */
+    uint32_t timestamp_cycles; /* Raw DWT->CYCCNT; KEVT_TIME_EPOCH gives the high word */
     uint16_t event_id;         /* log_event_id_t */
     uint8_t  level;            /* klog_level_t */
     uint8_t  cpu_context;      /* Current task ID or ISR number */
@@ -47,17 +133,54 @@ typedef struct __attribute__((packed))
 /* Safe to call before the scheduler is running. */
 void klog_init(void);
 
-/* ISR-safe. Disables interrupts ~10 cycles to write atomically.
- * Never blocks, never allocates. Drops silently on full buffer. */
+/* ISR-safe and lock-free: reserves a slot with LDREX/STREX, never masks
+ * interrupts, never blocks, never allocates. Drops on full buffer, or with
+ * KLOG_FLIGHT_RECORDER overwrites the oldest record. */
 void klog_write(klog_level_t level, uint16_t event_id, uint32_t arg0, uint32_t arg1);
 
+/* Single consumer only (log flush task). With KLOG_FLIGHT_RECORDER only the
+ * records recovered from before the last reset are drained. */
 uint32_t klog_drain(klog_record_t *out, uint32_t max_records);
 
-/* Records with level > KLOG_MIN_LEVEL produce zero code at compile time. */
+/* Records written but not yet drained (includes slots still being filled). */
+uint32_t klog_pending(void);
+
+/* Records dropped because the buffer was full, since klog_init(). With
+ * KLOG_FLIGHT_RECORDER: recovered records overwritten before being drained. */
+uint32_t klog_get_dropped(void);
+
+#if KLOG_FLIGHT_RECORDER
+/* Records of the previous run that klog_init() found intact. */
+uint32_t klog_get_recovered(void);
+
+/* Copy up to max_records of the newest records, oldest first, without
+ * consuming them. Any context; records being overwritten are skipped. */
+uint32_t klog_snapshot(klog_record_t *out, uint32_t max_records);
+#endif
+
+/* Enable levels up to max_level for the subsystems in subsys_mask (bits of
+ * klog_subsys_t, or KLOG_SUBSYS_ALL) and disable their levels above it.
+ * FAULT records are never filtered. Any context. */
+void klog_filter_set(uint32_t subsys_mask, klog_level_t max_level);
+
+/* Highest level enabled for subsys (KLOG_LEVEL_FAULT if none). */
+klog_level_t klog_filter_get(klog_subsys_t subsys);
+
+/* One load and one bit test; FAULT, and everything with KLOG_RUNTIME_FILTER 0, passes */
+#if KLOG_RUNTIME_FILTER
+#define KLOG_RUNTIME_ENABLED(level, event_id)                                                                          \
+    ((level) == KLOG_LEVEL_FAULT || (klog_filter.level_mask[(level)] & (1UL << KLOG_SUBSYS_OF(event_id))) != 0U)
+#else
+#define KLOG_RUNTIME_ENABLED(level, event_id) (1)
+#endif
+
+/* Records with level > KLOG_MIN_LEVEL produce zero code at compile time;
+ * the rest are tested against the runtime filter before klog_write() reads
+ * the clock or IPSR. */
 #define KLOG(level, event_id, a0, a1)                                                                                  \
     do                                                                                                                 \
     {                                                                                                                  \
-        if ((level) <= KLOG_MIN_LEVEL)                                                                                 \
+        if ((level) <= KLOG_MIN_LEVEL && KLOG_RUNTIME_ENABLED((level), (event_id)))                                    \
         {                                                                                                              \
             klog_write((level), (event_id), (a0), (a1));                                                               \
         }                                                                                                              \
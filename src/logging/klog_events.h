@@ -27,6 +27,10 @@ typedef enum
     KEVT_TASK_UNBLOCK,
     KEVT_TASK_DELETE,
     KEVT_TASK_IDLE_START,
+    KEVT_TASK_ADMISSION_FAIL,
+    KEVT_TASK_BUDGET_OVERRUN,
+    KEVT_TASK_SERVER_EXHAUSTED,
+    KEVT_TASK_SERVER_REPLENISH,
 
     /* Scheduler */
     KEVT_SCHEDULER_INIT = 0x0020,
@@ -50,12 +54,19 @@ typedef enum
     KEVT_SEM_TIMEOUT,
     KEVT_SEM_OVERFLOW,
     KEVT_SEM_WAKE,
+    KEVT_MUTEX_PIP_CHAIN,
+    KEVT_MUTEX_CEILING_VIOLATION,
 
     /* Timers */
     KEVT_TIMER_CREATE = 0x0060,
     KEVT_TIMER_START,
     KEVT_TIMER_STOP,
     KEVT_TIMER_PERIOD_CHANGE,
+    KEVT_DEFERRED_FULL,
+    KEVT_TIME_EPOCH,
+    KEVT_HRTIMER_FULL,
+    KEVT_HRTIMER_OVERRUN,
+    KEVT_KLOG_BOOT, /* Flight recorder: arg0 = records recovered, arg1 = first position of this run */
 
     /* Port / Hardware */
     KEVT_PORT_INIT = 0x0080,
@@ -88,6 +99,7 @@ typedef enum
     KEVT_QUEUE_WAKE_RECV,
     KEVT_QUEUE_WAKE_SEND,
     KEVT_QUEUE_RESET,
+    KEVT_QUEUE_OVERWRITE,
 
     /* Scheduler internals */
     KEVT_SCHED_TASK_READY = 0x00E0,
@@ -95,6 +107,7 @@ typedef enum
     KEVT_SCHED_TASK_DELAY_EXPIRED,
     KEVT_SCHED_TIME_SLICE,
     KEVT_SCHED_ROTATE,
+    KEVT_SCHED_STATS, /* arg0 = rtos_sched_stat_id_t, arg1 = value */
 
     /* Task Notification */
     KEVT_NOTIFY_SEND = 0x0100,
@@ -111,9 +124,32 @@ typedef enum
     KEVT_EG_BLOCK,
     KEVT_EG_TIMEOUT,
     KEVT_EG_WAKE,
+    KEVT_EG_SYNC,
 
     /* Memory */
     KEVT_STACK_ALLOC_FAIL = 0x0120,
+    KEVT_MEMPOOL_INIT,
+    KEVT_MEMPOOL_EMPTY,
+    KEVT_MEMPOOL_BLOCK,
+    KEVT_MEMPOOL_TIMEOUT,
+    KEVT_MEMPOOL_WAKE,
+
+    /* Stream / Message Buffer */
+    KEVT_SB_INIT = 0x0130,
+    KEVT_SB_BLOCK,
+    KEVT_SB_TIMEOUT,
+    KEVT_SB_WAKE,
+
+    /* Queue Set */
+    KEVT_QSET_BLOCK = 0x0140,
+    KEVT_QSET_TIMEOUT,
+    KEVT_QSET_WAKE,
+
+    /* Reader-Writer Lock */
+    KEVT_RWLOCK_INIT = 0x0150,
+    KEVT_RWLOCK_BLOCK,
+    KEVT_RWLOCK_TIMEOUT,
+    KEVT_RWLOCK_WAKE,
 
     /* ===== Profiling Events (ProfTrace) ===== */
 
@@ -125,6 +161,10 @@ typedef enum
     PEVT_USER_MARK,
     PEVT_ISR_ENTER,
     PEVT_ISR_EXIT,
+    PEVT_TASK_SWITCH_OUT,
+    PEVT_TASK_SWITCH_IN,
+    PEVT_TASK_BLOCK,
+    PEVT_TASK_UNBLOCK,
 } log_event_id_t;
 
 #ifdef __cplusplus
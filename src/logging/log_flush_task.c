@@ -1,12 +1,34 @@
 #include "log_flush_task.h"
 
 #include "VRTOS.h"
+#include "cobs.h"
+#include "config.h"
 #include "klog.h"
 #include "klog_events.h"
+#include "rtos_port.h"
+#include "rtt.h"
+#include "scheduler.h"
 #include "task.h"
 #include "uart_tx.h"
 #include "ulog.h"
 
+#include <string.h>
+
+#include "device.h" // IWYU pragma: keep
+
+/* The wake handler notifies this task */
+RTOS_ASSERT_KERNEL_IRQ_PRIORITY(LOG_FLUSH_WAKE_IRQ_PRIO);
+
+#if !KLOG_BINARY_STREAM
+static const char *sched_stat_name(uint32_t id)
+{
+    static const char *const names[RTOS_SCHED_STAT_COUNT] = {"switches",   "preempt",    "voluntary",
+                                                             "elided",     "tick_wakes", "susp_ticks",
+                                                             "dl_misses",  "ready",      "delayed"};
+
+    return (id < RTOS_SCHED_STAT_COUNT) ? names[id] : "?";
+}
+
 /* Output: [K/I] TaskCreate    id=1 prio=2  (T00)
  *         [K/D] IdleStart                  (T00)
  *         [K/T] SchedDelayed  id=3 wake=0x0042  (T03)
@@ -84,6 +106,22 @@ static void klog_format_record(const klog_record_t *r)
         case KEVT_TASK_IDLE_START:
             log_print("[K/%s] %-14s (%s)", lvl, "IdleStart", ctx);
             break;
+        case KEVT_TASK_ADMISSION_FAIL:
+            log_print("[K/%s] %-14s T=%lu C=%lu (%s)", lvl, "AdmitFail", (unsigned long) r->arg0,
+                      (unsigned long) r->arg1, ctx);
+            break;
+        case KEVT_TASK_BUDGET_OVERRUN:
+            log_print("[K/%s] %-14s %s C=%lu (%s)", lvl, "BudgetOverrun", rtos_task_get_name((uint8_t) r->arg0),
+                      (unsigned long) r->arg1, ctx);
+            break;
+        case KEVT_TASK_SERVER_EXHAUSTED:
+            log_print("[K/%s] %-14s %s prio=%lu (%s)", lvl, "ServerExhaust", rtos_task_get_name((uint8_t) r->arg0),
+                      (unsigned long) r->arg1, ctx);
+            break;
+        case KEVT_TASK_SERVER_REPLENISH:
+            log_print("[K/%s] %-14s %s prio=%lu (%s)", lvl, "ServerRefill", rtos_task_get_name((uint8_t) r->arg0),
+                      (unsigned long) r->arg1, ctx);
+            break;
 
         /* ---- Scheduler ---- */
         case KEVT_SCHEDULER_INIT:
@@ -111,6 +149,10 @@ static void klog_format_record(const klog_record_t *r)
         case KEVT_SCHED_ROTATE:
             log_print("[K/%s] %-14s (%s)", lvl, "SchedRotate", ctx);
             break;
+        case KEVT_SCHED_STATS:
+            log_print("[K/%s] %-14s %s=%lu (%s)", lvl, "SchedStats", sched_stat_name(r->arg0), (unsigned long) r->arg1,
+                      ctx);
+            break;
 
         /* ---- Mutex ---- */
         case KEVT_MUTEX_INIT:
@@ -144,6 +186,14 @@ static void klog_format_record(const klog_record_t *r)
         case KEVT_MUTEX_TIMEOUT:
             log_print("[K/%s] %-14s (%s)", lvl, "MtxTimeout", ctx);
             break;
+        case KEVT_MUTEX_PIP_CHAIN:
+            log_print("[K/%s] %-14s depth=%lu boosted=%lu (%s)", lvl, "MtxPIPChain", (unsigned long) r->arg0,
+                      (unsigned long) r->arg1, ctx);
+            break;
+        case KEVT_MUTEX_CEILING_VIOLATION:
+            log_print("[K/%s] %-14s task=%lu ceiling=%lu (%s)", lvl, "MtxCeiling!", (unsigned long) r->arg0,
+                      (unsigned long) r->arg1, ctx);
+            break;
 
         /* ---- Semaphore ---- */
         case KEVT_SEM_INIT:
@@ -183,6 +233,26 @@ static void klog_format_record(const klog_record_t *r)
             log_print("[K/%s] %-14s old=%lu new=%lu (%s)", lvl, "TimerPeriod", (unsigned long) r->arg0,
                       (unsigned long) r->arg1, ctx);
             break;
+        case KEVT_DEFERRED_FULL:
+            log_print("[K/%s] %-14s fn=0x%08lX len=%lu (%s)", lvl, "DeferredFull", (unsigned long) r->arg0,
+                      (unsigned long) r->arg1, ctx);
+            break;
+        case KEVT_TIME_EPOCH:
+            log_print("[K/%s] %-14s cyc=0x%08lX%08lX (%s)", lvl, "TimeEpoch", (unsigned long) r->arg1,
+                      (unsigned long) r->arg0, ctx);
+            break;
+        case KEVT_HRTIMER_FULL:
+            log_print("[K/%s] %-14s tmr=0x%08lX armed=%lu (%s)", lvl, "HrtimerFull", (unsigned long) r->arg0,
+                      (unsigned long) r->arg1, ctx);
+            break;
+        case KEVT_HRTIMER_OVERRUN:
+            log_print("[K/%s] %-14s tmr=0x%08lX overruns=%lu (%s)", lvl, "HrtimerOverrun", (unsigned long) r->arg0,
+                      (unsigned long) r->arg1, ctx);
+            break;
+        case KEVT_KLOG_BOOT:
+            log_print("[K/%s] %-14s recovered=%lu pos=%lu (%s)", lvl, "KlogBoot", (unsigned long) r->arg0,
+                      (unsigned long) r->arg1, ctx);
+            break;
 
         /* ---- Port ---- */
         case KEVT_PORT_INIT:
@@ -272,6 +342,9 @@ static void klog_format_record(const klog_record_t *r)
         case KEVT_QUEUE_RESET:
             log_print("[K/%s] %-14s (%s)", lvl, "QueueReset", ctx);
             break;
+        case KEVT_QUEUE_OVERWRITE:
+            log_print("[K/%s] %-14s cnt=%lu (%s)", lvl, "QueueOverwrite", (unsigned long) r->arg0, ctx);
+            break;
 
         /* ---- Event Group ---- */
         case KEVT_EG_INIT:
@@ -300,11 +373,76 @@ static void klog_format_record(const klog_record_t *r)
             log_print("[K/%s] %-14s %s bits=0x%08lX (%s)", lvl, "EGWake", rtos_task_get_name((uint8_t) r->arg0),
                       (unsigned long) r->arg1, ctx);
             break;
+        case KEVT_EG_SYNC:
+            log_print("[K/%s] %-14s set=0x%08lX wait=0x%08lX (%s)", lvl, "EGSync", (unsigned long) r->arg0,
+                      (unsigned long) r->arg1, ctx);
+            break;
 
         /* ---- Memory ---- */
         case KEVT_STACK_ALLOC_FAIL:
             log_print("[K/%s] %-14s size=%lu (%s)", lvl, "StackAllocFail!", (unsigned long) r->arg0, ctx);
             break;
+        case KEVT_MEMPOOL_INIT:
+            log_print("[K/%s] %-14s blk=%lu cnt=%lu (%s)", lvl, "PoolInit", (unsigned long) r->arg0,
+                      (unsigned long) r->arg1, ctx);
+            break;
+        case KEVT_MEMPOOL_EMPTY:
+            log_print("[K/%s] %-14s cnt=%lu (%s)", lvl, "PoolEmpty", (unsigned long) r->arg0, ctx);
+            break;
+        case KEVT_MEMPOOL_BLOCK:
+            log_print("[K/%s] %-14s %s tmo=%lu (%s)", lvl, "PoolBlock", rtos_task_get_name((uint8_t) r->arg0),
+                      (unsigned long) r->arg1, ctx);
+            break;
+        case KEVT_MEMPOOL_TIMEOUT:
+            log_print("[K/%s] %-14s %s (%s)", lvl, "PoolTimeout", rtos_task_get_name((uint8_t) r->arg0), ctx);
+            break;
+        case KEVT_MEMPOOL_WAKE:
+            log_print("[K/%s] %-14s %s (%s)", lvl, "PoolWake", rtos_task_get_name((uint8_t) r->arg0), ctx);
+            break;
+
+        /* ---- Stream / Message Buffer ---- */
+        case KEVT_SB_INIT:
+            log_print("[K/%s] %-14s size=%lu trig=%lu (%s)", lvl, "SBInit", (unsigned long) r->arg0,
+                      (unsigned long) r->arg1, ctx);
+            break;
+        case KEVT_SB_BLOCK:
+            log_print("[K/%s] %-14s %s tmo=%lu (%s)", lvl, "SBBlock", rtos_task_get_name((uint8_t) r->arg0),
+                      (unsigned long) r->arg1, ctx);
+            break;
+        case KEVT_SB_TIMEOUT:
+            log_print("[K/%s] %-14s %s (%s)", lvl, "SBTimeout", rtos_task_get_name((uint8_t) r->arg0), ctx);
+            break;
+        case KEVT_SB_WAKE:
+            log_print("[K/%s] %-14s %s %s (%s)", lvl, "SBWake", rtos_task_get_name((uint8_t) r->arg0),
+                      r->arg1 ? "reader" : "writer", ctx);
+            break;
+        case KEVT_QSET_BLOCK:
+            log_print("[K/%s] %-14s %s tmo=%lu (%s)", lvl, "QSetBlock", rtos_task_get_name((uint8_t) r->arg0),
+                      (unsigned long) r->arg1, ctx);
+            break;
+        case KEVT_QSET_TIMEOUT:
+            log_print("[K/%s] %-14s %s (%s)", lvl, "QSetTimeout", rtos_task_get_name((uint8_t) r->arg0), ctx);
+            break;
+        case KEVT_QSET_WAKE:
+            log_print("[K/%s] %-14s %s (%s)", lvl, "QSetWake", rtos_task_get_name((uint8_t) r->arg0), ctx);
+            break;
+
+        /* ---- Reader-Writer Lock ---- */
+        case KEVT_RWLOCK_INIT:
+            log_print("[K/%s] %-14s (%s)", lvl, "RWInit", ctx);
+            break;
+        case KEVT_RWLOCK_BLOCK:
+            log_print("[K/%s] %-14s %s tmo=%lu (%s)", lvl, "RWBlock", rtos_task_get_name((uint8_t) r->arg0),
+                      (unsigned long) r->arg1, ctx);
+            break;
+        case KEVT_RWLOCK_TIMEOUT:
+            log_print("[K/%s] %-14s %s %s (%s)", lvl, "RWTimeout", rtos_task_get_name((uint8_t) r->arg0),
+                      r->arg1 ? "writer" : "reader", ctx);
+            break;
+        case KEVT_RWLOCK_WAKE:
+            log_print("[K/%s] %-14s %s %s (%s)", lvl, "RWWake", rtos_task_get_name((uint8_t) r->arg0),
+                      r->arg1 ? "writer" : "reader", ctx);
+            break;
 
         /* ---- Profiling events (shouldn't appear in KLog, but handle gracefully) ---- */
         case PEVT_CTX_SWITCH:
@@ -315,6 +453,10 @@ static void klog_format_record(const klog_record_t *r)
         case PEVT_USER_MARK:
         case PEVT_ISR_ENTER:
         case PEVT_ISR_EXIT:
+        case PEVT_TASK_SWITCH_OUT:
+        case PEVT_TASK_SWITCH_IN:
+        case PEVT_TASK_BLOCK:
+        case PEVT_TASK_UNBLOCK:
             break;
 
         default:
@@ -324,29 +466,119 @@ static void klog_format_record(const klog_record_t *r)
     }
 }
 
-/* Drain batch size — how many records to pull per iteration */
-#define KLOG_FLUSH_BATCH 8
+#endif /* !KLOG_BINARY_STREAM */
+
+#if KLOG_BINARY_STREAM
+extern int _write(int file, char *ptr, int len);
+
+/* CRC-8 (poly 0x07, init 0x00) over the raw record — tools/klog_decoder.py mirrors it */
+static uint8_t klog_crc8(const uint8_t *data, uint32_t len)
+{
+    uint8_t crc = 0;
+    for (uint32_t i = 0; i < len; i++)
+    {
+        crc ^= data[i];
+        for (uint32_t b = 0; b < 8; b++)
+        {
+            crc = (uint8_t) ((crc & 0x80U) ? ((uint32_t) (crc << 1) ^ 0x07U) : (uint32_t) (crc << 1));
+        }
+    }
+    return crc;
+}
+
+/* Frame a batch of records: leading 0x00 so text never merges into a frame,
+ * then one COBS(record + crc8) + 0x00 per record. */
+static void klog_stream_records(const klog_record_t *records, uint32_t n)
+{
+    uint8_t frame[1 + COBS_MAX_ENCODED_SIZE(sizeof(klog_record_t) + 1U) + 1];
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        uint8_t raw[sizeof(klog_record_t) + 1U];
+        memcpy(raw, &records[i], sizeof(klog_record_t));
+        raw[sizeof(klog_record_t)] = klog_crc8(raw, sizeof(klog_record_t));
+
+        uint32_t len = 0;
+        if (i == 0)
+        {
+            frame[len++] = 0x00;
+        }
+        len += cobs_encode(raw, sizeof(raw), &frame[len]);
+        frame[len++] = 0x00;
 
-/* Flush period in milliseconds */
-#define KLOG_FLUSH_PERIOD_MS 100
+        _write(1, (char *) frame, (int) len);
+    }
+}
+#endif
 
 /* ULog drain chunk size */
 #define ULOG_FLUSH_CHUNK 128
 
+static rtos_task_handle_t log_flush_handle;
+
+void log_flush_request(void)
+{
+    NVIC_SetPendingIRQ(LOG_FLUSH_WAKE_IRQn);
+}
+
+/* Deferred half of log_flush_request() — see log_flush_task.h */
+void LOG_FLUSH_WAKE_IRQHandler(void)
+{
+    if (log_flush_handle != NULL)
+    {
+        rtos_task_notify_give(log_flush_handle);
+    }
+}
+
 void log_flush_task(void *param)
 {
     (void) param;
 
-    klog_record_t batch[KLOG_FLUSH_BATCH];
+#if LOG_BACKEND_RTT
+    /* KLog, ULog and ProfTrace write straight into RTT channels that the
+     * debugger drains — nothing to do here, so never wake up */
+    while (1)
+    {
+        rtos_task_suspend(NULL);
+    }
+#else
+    /* Static: a full batch would otherwise cost 256 bytes of this task's stack */
+    static klog_record_t batch[KLOG_FLUSH_BATCH_MAX];
+    uint32_t             reported_drops = 0;
+
+    log_flush_handle = rtos_task_get_current();
+    NVIC_SetPriority(LOG_FLUSH_WAKE_IRQn, LOG_FLUSH_WAKE_IRQ_PRIO);
+    NVIC_EnableIRQ(LOG_FLUSH_WAKE_IRQn);
 
     while (1)
     {
-        /* 1. Drain KLog — binary kernel records, decode to human-readable */
-        uint32_t n = klog_drain(batch, KLOG_FLUSH_BATCH);
+        /* 1. Drain KLog — batch sized to the fill level, until empty */
+        uint32_t pending;
+        while ((pending = klog_pending()) > 0)
+        {
+            uint32_t n = klog_drain(batch, (pending < KLOG_FLUSH_BATCH_MAX) ? pending : KLOG_FLUSH_BATCH_MAX);
+            if (n == 0)
+            {
+                break; /* Next slot still being filled by a preempted writer */
+            }
+
+#if KLOG_BINARY_STREAM
+            klog_stream_records(batch, n);
+#else
+            for (uint32_t i = 0; i < n; i++)
+            {
+                klog_format_record(&batch[i]);
+            }
+#endif
+        }
 
-        for (uint32_t i = 0; i < n; i++)
+        /* Report overflow so an undersized KLOG_BUFFER_SIZE is visible */
+        uint32_t drops = klog_get_dropped();
+        if (drops != reported_drops)
         {
-            klog_format_record(&batch[i]);
+            log_print("[K/W] %-14s lost=%lu total=%lu", "KlogDropped", (unsigned long) (drops - reported_drops),
+                      (unsigned long) drops);
+            reported_drops = drops;
         }
 
         /* 2. Drain ULog — pre-formatted strings, write directly to UART */
@@ -361,6 +593,8 @@ void log_flush_task(void *param)
             }
         }
 
-        rtos_delay_ms(KLOG_FLUSH_PERIOD_MS);
+        /* Sleep until a ring reaches its watermark; the timeout catches the rest */
+        rtos_task_notify_take(true, KLOG_FLUSH_PERIOD_MS / RTOS_TICK_PERIOD_MS);
     }
+#endif
 }
@@ -1,14 +1,67 @@
 #ifndef LOG_FLUSH_TASK_H
 #define LOG_FLUSH_TASK_H
 
+#include "config.h" /* board overrides of the defaults below */
+
 #ifdef __cplusplus
 extern "C"
 {
 #endif
 
+/*
+ * KLog output format:
+ *   0 = text, decoded on target ("[K/I] TaskCreate ...")
+ *   1 = binary, each record sent as COBS(record[16] + crc8) followed by a
+ *       0x00 delimiter; decode on the host with tools/klog_decoder.py --binary.
+ *       ULog text is still sent as-is between frames.
+ */
+#ifndef KLOG_BINARY_STREAM
+#define KLOG_BINARY_STREAM 0
+#endif
+
+/*
+ * Early wake-up: klog_write() and ulog() call log_flush_request() when their
+ * ring reaches KLOG_FLUSH_WATERMARK / ULOG_FLUSH_WATERMARK. The request pends
+ * an otherwise unused interrupt at the lowest priority; its handler notifies
+ * the flush task. Being masked by every kernel critical section, it only runs
+ * once the scheduler lists are consistent, so logging stays legal anywhere.
+ * A board without a spare line overrides both names in its rtos_config.h.
+ * KLOG_FLUSH_PERIOD_MS is the fallback for rings that never reach the mark.
+ */
+#ifndef LOG_FLUSH_WAKE_IRQn
+#define LOG_FLUSH_WAKE_IRQn       CEC_IRQn /* HDMI-CEC, unused on the Nucleo-F446RE */
+#define LOG_FLUSH_WAKE_IRQHandler CEC_IRQHandler
+#endif
+
+#ifndef LOG_FLUSH_WAKE_IRQ_PRIO
+#define LOG_FLUSH_WAKE_IRQ_PRIO (15U)
+#endif
+
+#ifndef KLOG_FLUSH_PERIOD_MS
+#define KLOG_FLUSH_PERIOD_MS (500U)
+#endif
+
+/* Largest KLog batch per drain pass; each pass takes min(pending, this) */
+#ifndef KLOG_FLUSH_BATCH_MAX
+#define KLOG_FLUSH_BATCH_MAX (16U)
+#endif
+
 /**
- * @brief RTOS task function that periodically drains the KLog ring buffer
- *        and outputs decoded, human-readable records to UART via printf.
+ * @brief Ask the flush task to run now
+ *
+ * ISR-safe and callable inside critical sections: only pends an interrupt.
+ * Requests made before the flush task starts are delivered when it does.
+ */
+void log_flush_request(void);
+
+/**
+ * @brief RTOS task function that drains the KLog ring buffer
+ *        and outputs decoded, human-readable records to UART via printf
+ *        (or binary frames, see KLOG_BINARY_STREAM). With LOG_BACKEND_RTT
+ *        the debugger reads the records instead and this task stays suspended.
+ *
+ * Sleeps on its task notification until log_flush_request() or
+ * KLOG_FLUSH_PERIOD_MS, then drains everything pending.
  *
  * Should be created at the lowest priority so it only runs when no other
  * task needs the CPU. Call klog_init() before starting this task.
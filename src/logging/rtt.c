@@ -0,0 +1,126 @@
+#include "rtt.h"
+
+#include "klog.h"
+#include "prof_trace.h"
+#include "ring_buffer.h"
+#include "rtos_port.h"
+#include "ulog.h"
+
+#include <stddef.h>
+
+#include "device.h" // IWYU pragma: keep
+
+#if LOG_BACKEND_RTT
+
+/*
+ * SEGGER RTT control block. The debugger finds it by scanning RAM for the
+ * acID string (or via the _SEGGER_RTT symbol), then polls each up-buffer:
+ * it reads [RdOff, WrOff) and writes RdOff back. The field layout must match
+ * SEGGER_RTT.h exactly.
+ *
+ * Each channel is backed by a ring_buffer_t over the same storage. Its
+ * masked head/tail with one slot kept free are RTT's WrOff/RdOff semantics,
+ * so a write pulls the host's RdOff into tail, writes through the ring
+ * buffer, and publishes head as WrOff.
+ */
+typedef struct
+{
+    const char       *sName;
+    char             *pBuffer;
+    uint32_t          SizeOfBuffer;
+    volatile uint32_t WrOff; /* Target writes */
+    volatile uint32_t RdOff; /* Host writes */
+    uint32_t          Flags; /* 0 = SKIP: drop when full, never block */
+} rtt_buffer_t;
+
+typedef struct
+{
+    char         acID[16];
+    int32_t      MaxNumUpBuffers;
+    int32_t      MaxNumDownBuffers;
+    rtt_buffer_t aUp[RTT_CHANNEL_COUNT];
+} rtt_control_block_t;
+
+rtt_control_block_t _SEGGER_RTT __attribute__((aligned(4)));
+
+static uint8_t rtt_terminal_buf[ULOG_BUFFER_SIZE] __attribute__((aligned(4)));
+static uint8_t rtt_klog_buf[KLOG_BUFFER_SIZE] __attribute__((aligned(4)));
+static uint8_t rtt_prof_buf[PROF_TRACE_BUFFER_SIZE] __attribute__((aligned(4)));
+
+static ring_buffer_t rtt_rb[RTT_CHANNEL_COUNT];
+static bool          rtt_ready;
+
+static void rtt_init_channel(rtt_channel_t channel, const char *name, uint8_t *buf, uint32_t size)
+{
+    ring_buffer_init(&rtt_rb[channel], buf, size);
+
+    rtt_buffer_t *up = &_SEGGER_RTT.aUp[channel];
+    up->sName        = name;
+    up->pBuffer      = (char *) buf;
+    up->SizeOfBuffer = size;
+    up->WrOff        = 0;
+    up->RdOff        = 0;
+    up->Flags        = 0;
+}
+
+void rtt_init(void)
+{
+    if (rtt_ready)
+    {
+        return;
+    }
+
+    rtt_init_channel(RTT_CHANNEL_TERMINAL, "Terminal", rtt_terminal_buf, sizeof(rtt_terminal_buf));
+    rtt_init_channel(RTT_CHANNEL_KLOG, "KLog", rtt_klog_buf, sizeof(rtt_klog_buf));
+    rtt_init_channel(RTT_CHANNEL_PROF, "ProfTrace", rtt_prof_buf, sizeof(rtt_prof_buf));
+
+    _SEGGER_RTT.MaxNumUpBuffers   = RTT_CHANNEL_COUNT;
+    _SEGGER_RTT.MaxNumDownBuffers = 0;
+
+    /* Write the ID last, and assemble it at run time so the host cannot
+     * match a copy in flash or a half-initialised block */
+    static const char id_tail[] = " RTT";
+    for (uint32_t i = 0; i < sizeof(id_tail); i++)
+    {
+        _SEGGER_RTT.acID[6 + i] = id_tail[i];
+    }
+    __DMB();
+    _SEGGER_RTT.acID[0] = 'S';
+    _SEGGER_RTT.acID[1] = 'E';
+    _SEGGER_RTT.acID[2] = 'G';
+    _SEGGER_RTT.acID[3] = 'G';
+    _SEGGER_RTT.acID[4] = 'E';
+    _SEGGER_RTT.acID[5] = 'R';
+    __DMB();
+
+    rtt_ready = true;
+}
+
+bool rtt_write(rtt_channel_t channel, const void *data, uint32_t len)
+{
+    if (!rtt_ready || channel >= RTT_CHANNEL_COUNT || data == NULL)
+    {
+        return false;
+    }
+
+    ring_buffer_t *rb = &rtt_rb[channel];
+    rtt_buffer_t  *up = &_SEGGER_RTT.aUp[channel];
+
+    /* BASEPRI, not PRIMASK: the zero-latency tier is never held off (and must not log here) */
+    uint32_t saved = rtos_port_enter_critical_from_isr();
+
+    rb->tail     = up->RdOff;
+    bool written = ring_buffer_write(rb, data, len);
+    if (written)
+    {
+        /* Data must land in RAM before the host can see the new WrOff */
+        __DMB();
+        up->WrOff = rb->head;
+    }
+
+    rtos_port_exit_critical_from_isr(saved);
+
+    return written;
+}
+
+#endif /* LOG_BACKEND_RTT */
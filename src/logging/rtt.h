@@ -0,0 +1,53 @@
+#ifndef RTT_H
+#define RTT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * Log backend:
+ *   0 = UART (uart_tx.c), records drained and sent by log_flush_task
+ *   1 = RTT, records written straight into a SEGGER RTT-compatible control
+ *       block (_SEGGER_RTT) that the debugger reads over SWD. No UART, no
+ *       target-side formatting, and log_flush_task has nothing to do.
+ *       Capture with tools/rtt_capture.py.
+ */
+#ifndef LOG_BACKEND_RTT
+#define LOG_BACKEND_RTT 0
+#endif
+
+/* Up-channel layout — tools/rtt_capture.py relies on these numbers */
+typedef enum
+{
+    RTT_CHANNEL_TERMINAL = 0, /* ULog lines and printf text */
+    RTT_CHANNEL_KLOG,         /* Raw klog_record_t, 16 bytes each */
+    RTT_CHANNEL_PROF,         /* Raw prof_record_t, 8 bytes each */
+    RTT_CHANNEL_COUNT
+} rtt_channel_t;
+
+/* Publishes the control block. Idempotent; every log module calls it from its init. */
+void rtt_init(void);
+
+/**
+ * @brief Append bytes to an up-channel
+ *
+ * ISR-safe (interrupts are masked for the copy). Never blocks: if the host
+ * has not read enough of the channel, the whole write is dropped.
+ *
+ * @param channel RTT_CHANNEL_*
+ * @param data    Source bytes
+ * @param len     Byte count
+ * @return true if written, false if dropped
+ */
+bool rtt_write(rtt_channel_t channel, const void *data, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RTT_H */
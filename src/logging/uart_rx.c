@@ -0,0 +1,294 @@
+#include "uart_rx.h"
+
+#include "config.h"
+#include "device.h" // IWYU pragma: keep
+#include "rtos_port.h"
+#include "rtt.h"
+#include "task.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifndef UART_RX_DMA_SIZE
+#define UART_RX_DMA_SIZE 256 /* Circular DMA ring, a multiple of 32 (cache lines) */
+#endif
+
+#if LOG_BACKEND_RTT
+
+/* USART2 is left unconfigured by the RTT backend */
+rtos_status_t uart_rx_init(rtos_stream_buffer_t *sb, rtos_task_handle_t notify_task)
+{
+    (void) sb;
+    (void) notify_task;
+    return RTOS_ERROR_INVALID_STATE;
+}
+
+void uart_rx_get_stats(uart_rx_stats_t *stats)
+{
+    if (stats != NULL)
+    {
+        *stats = (uart_rx_stats_t) {0};
+    }
+}
+
+void uart_rx_reset_stats(void) {}
+
+#else
+
+/* Written by the DMA only; rx_last is the next byte not yet handed on */
+static volatile uint8_t rx_ring[UART_RX_DMA_SIZE] RTOS_DMA_BUFFER_REGION __attribute__((aligned(32)));
+static uint32_t         rx_last;
+
+static rtos_stream_buffer_t *rx_sb;
+static rtos_task_handle_t    rx_notify;
+static uart_rx_stats_t       rx_stats;
+
+static void rx_push(uint32_t from, uint32_t len, bool *woken)
+{
+    uint32_t sent = 0;
+
+    (void) rtos_stream_buffer_send_from_isr(rx_sb, (const void *) &rx_ring[from], len, &sent, woken);
+    rx_stats.bytes   += sent;
+    rx_stats.dropped += len - sent;
+}
+
+/*
+ * Hand the bytes the DMA wrote since the last event to the stream buffer.
+ * pos is the DMA's next write index. Called from the RX ISRs only, all at
+ * one priority, so rx_last and the stats need no lock.
+ */
+static void rx_consume(uint32_t pos, bool *woken)
+{
+    if (pos == rx_last)
+    {
+        return; /* Idle after a half/full event that took everything */
+    }
+
+#if PORT_HAS_DCACHE
+    /* The CPU never writes the ring, so no line is dirty */
+    rtos_port_dcache_invalidate((void *) rx_ring, UART_RX_DMA_SIZE);
+#endif
+
+    uint32_t len;
+    if (pos > rx_last)
+    {
+        len = pos - rx_last;
+        rx_push(rx_last, len, woken);
+    }
+    else
+    {
+        /* Wrapped: the tail of the ring, then its start */
+        len = UART_RX_DMA_SIZE - rx_last + pos;
+        rx_push(rx_last, UART_RX_DMA_SIZE - rx_last, woken);
+        if (pos > 0)
+        {
+            rx_push(0, pos, woken);
+        }
+    }
+    rx_last = pos;
+
+    rx_stats.chunks++;
+    if (len > rx_stats.max_chunk)
+    {
+        rx_stats.max_chunk = len;
+    }
+
+    if (rx_notify != NULL)
+    {
+        (void) rtos_task_notify_give_from_isr(rx_notify, woken);
+    }
+}
+
+void uart_rx_get_stats(uart_rx_stats_t *stats)
+{
+    if (stats == NULL)
+    {
+        return;
+    }
+
+    uint32_t saved = rtos_port_enter_critical_from_isr();
+    *stats         = rx_stats;
+    rtos_port_exit_critical_from_isr(saved);
+}
+
+void uart_rx_reset_stats(void)
+{
+    uint32_t saved = rtos_port_enter_critical_from_isr();
+    rx_stats       = (uart_rx_stats_t) {0};
+    rtos_port_exit_critical_from_isr(saved);
+}
+
+#if defined(RTOS_TARGET_NATIVE)
+
+static uint32_t rx_host_pos; /* Where the "DMA" writes next */
+
+rtos_status_t uart_rx_init(rtos_stream_buffer_t *sb, rtos_task_handle_t notify_task)
+{
+    if (sb == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+    if (rx_sb != NULL)
+    {
+        return RTOS_ERROR_INVALID_STATE;
+    }
+
+    rx_host_pos = 0;
+    rx_last     = 0;
+    rx_notify   = notify_task;
+    rx_stats    = (uart_rx_stats_t) {0};
+    rx_sb       = sb;
+
+    return RTOS_SUCCESS;
+}
+
+void uart_rx_host_receive(const void *data, uint32_t len)
+{
+    uint32_t pos   = rx_host_pos;
+    bool     woken = false;
+
+    if (rx_sb == NULL || data == NULL)
+    {
+        return;
+    }
+
+    for (uint32_t i = 0; i < len; i++)
+    {
+        rx_ring[pos] = ((const uint8_t *) data)[i];
+        pos          = (pos + 1U) % UART_RX_DMA_SIZE;
+
+        /* Half-transfer and transfer-complete */
+        if (pos == UART_RX_DMA_SIZE / 2U || pos == 0U)
+        {
+            rx_consume(pos, &woken);
+        }
+    }
+
+    /* Idle line */
+    rx_host_pos = pos;
+    rx_consume(pos, &woken);
+
+    if (woken)
+    {
+        rtos_port_yield();
+    }
+}
+
+#else
+
+/* Same priority as the TX ISRs: both signal the kernel */
+#define UART_RX_IRQ_PRIO (14U)
+RTOS_ASSERT_KERNEL_IRQ_PRIORITY(UART_RX_IRQ_PRIO);
+
+static inline uint32_t rx_dma_pos(void)
+{
+    uint32_t pos = UART_RX_DMA_SIZE - DMA1_Stream5->NDTR;
+
+    /* NDTR reloads to the full size right after the last byte */
+    return (pos == UART_RX_DMA_SIZE) ? 0U : pos;
+}
+
+rtos_status_t uart_rx_init(rtos_stream_buffer_t *sb, rtos_task_handle_t notify_task)
+{
+    if (sb == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+    if (rx_sb != NULL || (USART2->CR1 & USART_CR1_RE) == 0U)
+    {
+        return RTOS_ERROR_INVALID_STATE; /* Started, or log_uart_init() not run */
+    }
+
+    rx_last   = 0;
+    rx_notify = notify_task;
+    rx_stats  = (uart_rx_stats_t) {0};
+    rx_sb     = sb;
+
+    __HAL_RCC_DMA1_CLK_ENABLE();
+
+    DMA1_Stream5->CR &= ~DMA_SxCR_EN;
+    while (DMA1_Stream5->CR & DMA_SxCR_EN)
+    {
+    }
+
+    /* Channel 4, peripheral-to-memory, byte transfers, memory increment,
+     * circular, half and full interrupts */
+    DMA1_Stream5->PAR  = (uint32_t) &USART2->DR;
+    DMA1_Stream5->M0AR = (uint32_t) rx_ring;
+    DMA1_Stream5->NDTR = UART_RX_DMA_SIZE;
+    DMA1_Stream5->CR   = DMA_SxCR_CHSEL_2 | DMA_SxCR_MINC | DMA_SxCR_CIRC | DMA_SxCR_HTIE | DMA_SxCR_TCIE;
+    DMA1_Stream5->FCR  = 0; /* Direct mode */
+    DMA1->HIFCR        = DMA_HIFCR_CTCIF5 | DMA_HIFCR_CHTIF5 | DMA_HIFCR_CTEIF5 | DMA_HIFCR_CDMEIF5 | DMA_HIFCR_CFEIF5;
+
+    /* Drop a stale byte or error from before the DMA owned the receiver */
+    (void) USART2->SR;
+    (void) USART2->DR;
+
+    HAL_NVIC_SetPriority(DMA1_Stream5_IRQn, UART_RX_IRQ_PRIO, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Stream5_IRQn);
+    HAL_NVIC_SetPriority(USART2_IRQn, UART_RX_IRQ_PRIO, 0);
+    HAL_NVIC_EnableIRQ(USART2_IRQn);
+
+    DMA1_Stream5->CR |= DMA_SxCR_EN;
+    USART2->CR3      |= USART_CR3_DMAR | USART_CR3_EIE;
+    USART2->CR1      |= USART_CR1_IDLEIE;
+
+    return RTOS_SUCCESS;
+}
+
+/* Half-transfer and transfer-complete: the ring filled to its middle or end */
+void DMA1_Stream5_IRQHandler(void)
+{
+    bool     woken = false;
+    uint32_t flags = DMA1->HISR & (DMA_HISR_HTIF5 | DMA_HISR_TCIF5);
+
+    if (flags != 0U)
+    {
+        DMA1->HIFCR = DMA_HIFCR_CHTIF5 | DMA_HIFCR_CTCIF5;
+        rx_consume(rx_dma_pos(), &woken);
+    }
+
+    if (woken)
+    {
+        rtos_port_yield();
+    }
+}
+
+void uart_rx_usart_isr(void)
+{
+    uint32_t sr = USART2->SR;
+
+    if (rx_sb == NULL || (sr & (USART_SR_IDLE | USART_SR_ORE | USART_SR_FE | USART_SR_NE)) == 0U)
+    {
+        return;
+    }
+
+    /* SR then DR clears IDLE and the error flags; with DMAR set the
+     * receive register is already empty when IDLE is flagged */
+    (void) USART2->DR;
+
+    if (sr & USART_SR_ORE)
+    {
+        rx_stats.overruns++;
+    }
+    if (sr & (USART_SR_FE | USART_SR_NE))
+    {
+        rx_stats.line_errors++;
+    }
+
+    if (sr & USART_SR_IDLE)
+    {
+        bool woken = false;
+
+        /* The DMA stream IRQ runs at this priority, so rx_last is stable */
+        rx_consume(rx_dma_pos(), &woken);
+        if (woken)
+        {
+            rtos_port_yield();
+        }
+    }
+}
+
+#endif /* RTOS_TARGET_NATIVE */
+
+#endif /* LOG_BACKEND_RTT */
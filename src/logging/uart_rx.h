@@ -0,0 +1,61 @@
+#ifndef UART_RX_H
+#define UART_RX_H
+
+#include "rtos_types.h"
+#include "stream_buffer.h"
+
+#include <stdint.h>
+
+/*
+ * USART2 receive path: DMA1 Stream5 fills a circular buffer with no CPU
+ * work per byte. The half-transfer, transfer-complete and USART idle-line
+ * interrupts each hand the bytes that arrived since the last one to a
+ * stream buffer as one chunk, and give the notify task one notification.
+ * A burst therefore costs about one interrupt per half buffer plus one
+ * when the line goes quiet.
+ *
+ * The ring must not lap the ISR: at 921600 baud the default 256-byte ring
+ * leaves 1.3 ms per half. Bytes the stream buffer has no room for are
+ * dropped and counted.
+ *
+ * Only the F446 UART backend has the hardware path; with LOG_BACKEND_RTT
+ * USART2 is unconfigured and uart_rx_init() fails. The POSIX build feeds
+ * the same chunk logic from uart_rx_host_receive().
+ */
+
+typedef struct
+{
+    uint32_t bytes;       /**< Bytes moved into the stream buffer */
+    uint32_t chunks;      /**< Idle, half and full events that carried data */
+    uint32_t dropped;     /**< Bytes lost to a full stream buffer */
+    uint32_t overruns;    /**< USART overrun errors (ORE): bytes the DMA missed */
+    uint32_t line_errors; /**< Framing and noise errors */
+    uint32_t max_chunk;   /**< Largest chunk seen */
+} uart_rx_stats_t;
+
+/**
+ * @brief Start receiving into a stream buffer (call after log_uart_init())
+ * @param sb Stream buffer the chunks go to; the ISR is its only writer
+ * @param notify_task Task given one notification per chunk, NULL = none
+ * @return RTOS_SUCCESS, RTOS_ERROR_INVALID_PARAM, or RTOS_ERROR_INVALID_STATE
+ *         (no UART backend, already started)
+ */
+rtos_status_t uart_rx_init(rtos_stream_buffer_t *sb, rtos_task_handle_t notify_task);
+
+void uart_rx_get_stats(uart_rx_stats_t *stats);
+void uart_rx_reset_stats(void);
+
+#if defined(RTOS_TARGET_NATIVE)
+/**
+ * @brief Host stand-in for the wire: write bytes into the DMA ring, raising
+ *        the half and full events as they are crossed, then the idle event
+ *
+ * Call from an emulated interrupt.
+ */
+void uart_rx_host_receive(const void *data, uint32_t len);
+#else
+/* USART2 idle-line and error handling, called from USART2_IRQHandler() */
+void uart_rx_usart_isr(void);
+#endif
+
+#endif /* UART_RX_H */
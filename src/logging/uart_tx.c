@@ -1,19 +1,105 @@
 #include "uart_tx.h"
 
-#include "stm32f4xx_hal.h" // IWYU pragma: keep
+#include "rtos_port.h"
+#include "rtt.h"
+#include "semaphore.h"
+#include "device.h" // IWYU pragma: keep
+#include "task.h"
+#include "uart_rx.h"
+
+#include <stdbool.h>
+
+#if defined(RTOS_TARGET_NATIVE)
+#include <unistd.h>
+#endif
 
 #ifndef UART_TX_BUF_SIZE
 #define UART_TX_BUF_SIZE 512 /* Must be power of 2 */
 #endif
 
+/* 1 = DMA1 Stream6 (USART2_TX, channel 4) sends contiguous chunks;
+ * 0 = fall back to one TXE interrupt per byte */
+#ifndef UART_TX_USE_DMA
+#define UART_TX_USE_DMA 1
+#endif
+
+log_level_t g_log_level = LOG_LEVEL_NONE;
+
+#if LOG_BACKEND_RTT
+
+/* printf goes to the RTT terminal channel; USART2 is left unconfigured */
+void log_uart_init(log_level_t level)
+{
+    rtt_init();
+    g_log_level = level;
+}
+
+/* Never blocks: text the host has no room for is dropped */
+int _write(int file, char *ptr, int len)
+{
+    (void) file;
+
+    if (len > 0)
+    {
+        rtt_write(RTT_CHANNEL_TERMINAL, ptr, (uint32_t) len);
+    }
+    return len;
+}
+
+/* Nothing is buffered on the target side */
+void uart_tx_flush(void) {}
+
+void uart_tx_write_polled(const char *data, uint32_t len)
+{
+    rtt_write(RTT_CHANNEL_TERMINAL, data, len);
+}
+
+#elif defined(RTOS_TARGET_NATIVE)
+
+/* POSIX simulation: printf goes straight to the host's stdout */
+void log_uart_init(log_level_t level)
+{
+    g_log_level = level;
+}
+
+/* Raw output from log_flush_task (ULog chunks, binary KLog frames), in order with printf */
+int _write(int file, char *ptr, int len)
+{
+    fflush(stdout);
+    return (int) write(file, ptr, (size_t) len);
+}
+
+void uart_tx_flush(void)
+{
+    fflush(stdout);
+}
+
+void uart_tx_write_polled(const char *data, uint32_t len)
+{
+    (void) write(1, data, len);
+}
+
+#else
+
 UART_HandleTypeDef g_huart2;
-log_level_t        g_log_level = LOG_LEVEL_NONE;
 
-/* SPSC TX ring buffer: _write() produces, USART2_IRQHandler consumes */
-static volatile uint8_t  tx_buf[UART_TX_BUF_SIZE];
+/* SPSC TX ring buffer: _write() produces, the TX ISR (TXE or DMA TC) consumes */
+static volatile uint8_t  tx_buf[UART_TX_BUF_SIZE] RTOS_DMA_BUFFER_REGION;
 static volatile uint32_t tx_head;
 static volatile uint32_t tx_tail;
 
+/* TX ISR priority: it signals tx_space_sem, so the kernel must be able to mask it */
+#define UART_TX_IRQ_PRIO (14U)
+RTOS_ASSERT_KERNEL_IRQ_PRIORITY(UART_TX_IRQ_PRIO);
+
+/* Writer blocks here while the ring is full (scheduler running, task context) */
+static rtos_semaphore_t tx_space_sem;
+static volatile bool    tx_writer_waiting;
+
+#if UART_TX_USE_DMA
+static volatile uint32_t tx_dma_len; /* Bytes in flight, 0 = DMA idle */
+#endif
+
 static inline uint32_t tx_count(void)
 {
     return (tx_head - tx_tail) & (UART_TX_BUF_SIZE - 1);
@@ -24,6 +110,84 @@ static inline uint32_t tx_free(void)
     return (UART_TX_BUF_SIZE - 1) - tx_count();
 }
 
+/* ISR side: wake a writer that blocked on a full ring */
+static inline void tx_wake_writer(void)
+{
+    if (tx_writer_waiting)
+    {
+        tx_writer_waiting = false;
+        rtos_semaphore_signal(&tx_space_sem);
+    }
+}
+
+#if UART_TX_USE_DMA
+/* Start DMA on the contiguous run at tx_tail. Call with the DMA idle and TC IRQ unable to fire. */
+static void tx_dma_start(void)
+{
+    uint32_t count = tx_count();
+    if (count == 0)
+    {
+        return;
+    }
+
+    uint32_t tail = tx_tail & (UART_TX_BUF_SIZE - 1);
+    uint32_t len  = UART_TX_BUF_SIZE - tail; /* Up to the wrap */
+    if (len > count)
+    {
+        len = count;
+    }
+
+#if PORT_HAS_DCACHE
+    /* The DMA reads memory, not the cache: write the chunk back first */
+    rtos_port_dcache_clean((const void *) &tx_buf[tail], len);
+#endif
+
+    tx_dma_len          = len;
+    DMA1_Stream6->M0AR  = (uint32_t) &tx_buf[tail];
+    DMA1_Stream6->NDTR  = len;
+    DMA1->HIFCR         = DMA_HIFCR_CTCIF6 | DMA_HIFCR_CHTIF6 | DMA_HIFCR_CTEIF6 | DMA_HIFCR_CDMEIF6 | DMA_HIFCR_CFEIF6;
+    DMA1_Stream6->CR   |= DMA_SxCR_EN;
+}
+
+static void tx_dma_init(void)
+{
+    __HAL_RCC_DMA1_CLK_ENABLE();
+
+    DMA1_Stream6->CR &= ~DMA_SxCR_EN;
+    while (DMA1_Stream6->CR & DMA_SxCR_EN)
+    {
+    }
+
+    /* Channel 4, memory-to-peripheral, byte transfers, memory increment, TC interrupt */
+    DMA1_Stream6->PAR = (uint32_t) &USART2->DR;
+    DMA1_Stream6->CR  = DMA_SxCR_CHSEL_2 | DMA_SxCR_DIR_0 | DMA_SxCR_MINC | DMA_SxCR_TCIE;
+    DMA1_Stream6->FCR = 0; /* Direct mode */
+
+    USART2->CR3 |= USART_CR3_DMAT;
+
+    tx_dma_len = 0;
+
+    HAL_NVIC_SetPriority(DMA1_Stream6_IRQn, UART_TX_IRQ_PRIO, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Stream6_IRQn);
+}
+
+/* Kick DMA if idle. Masks the TC IRQ so the ISR cannot race the idle check. */
+static void tx_kick(void)
+{
+    NVIC_DisableIRQ(DMA1_Stream6_IRQn);
+    if (tx_dma_len == 0)
+    {
+        tx_dma_start();
+    }
+    NVIC_EnableIRQ(DMA1_Stream6_IRQn);
+}
+#else
+static inline void tx_kick(void)
+{
+    USART2->CR1 |= USART_CR1_TXEIE;
+}
+#endif
+
 void log_uart_init(log_level_t level)
 {
     __HAL_RCC_USART2_CLK_ENABLE();
@@ -47,61 +211,128 @@ void log_uart_init(log_level_t level)
     g_huart2.Init.OverSampling = UART_OVERSAMPLING_16;
     HAL_UART_Init(&g_huart2);
 
-    tx_head = 0;
-    tx_tail = 0;
+    tx_head           = 0;
+    tx_tail           = 0;
+    tx_writer_waiting = false;
+    rtos_semaphore_init(&tx_space_sem, 0, 1);
 
-    HAL_NVIC_SetPriority(USART2_IRQn, 14, 0);
+#if UART_TX_USE_DMA
+    tx_dma_init();
+#else
+    HAL_NVIC_SetPriority(USART2_IRQn, UART_TX_IRQ_PRIO, 0);
     HAL_NVIC_EnableIRQ(USART2_IRQn);
+#endif
 
     g_log_level = level;
 }
 
-/* printf retarget — copies to TX ring buffer, spins if full.
- * Only the lowest-priority flush task calls this, so spinning
- * doesn't block higher-priority tasks. */
+/* A task may sleep on tx_space_sem; boot code, ISRs and critical sections must spin */
+static bool tx_can_block(void)
+{
+    return rtos_task_get_current() != NULL && __get_IPSR() == 0U && __get_PRIMASK() == 0U &&
+           __get_BASEPRI() == 0U;
+}
+
+/* printf retarget — copies to TX ring buffer. When full, a task blocks
+ * until the TX ISR frees space; pre-scheduler callers spin. */
 int _write(int file, char *ptr, int len)
 {
     (void) file;
 
-    for (int i = 0; i < len; i++)
+    int i = 0;
+    while (i < len)
     {
-        while (tx_free() == 0)
+        if (tx_free() == 0)
         {
-            USART2->CR1 |= USART_CR1_TXEIE;
+            tx_kick();
+
+            if (tx_can_block())
+            {
+                tx_writer_waiting = true;
+                if (tx_free() == 0) /* Re-check: the ISR may have drained meanwhile */
+                {
+                    rtos_semaphore_wait(&tx_space_sem, RTOS_SEM_MAX_WAIT);
+                }
+                tx_writer_waiting = false;
+            }
+            continue;
         }
 
-        tx_buf[tx_head & (UART_TX_BUF_SIZE - 1)] = (uint8_t) ptr[i];
-        tx_head++;
+        /* Copy as much as fits before touching the ISR again */
+        uint32_t room = tx_free();
+        while (room > 0 && i < len)
+        {
+            tx_buf[tx_head & (UART_TX_BUF_SIZE - 1)] = (uint8_t) ptr[i++];
+            tx_head++;
+            room--;
+        }
     }
 
-    USART2->CR1 |= USART_CR1_TXEIE;
+    tx_kick();
 
     return len;
 }
 
-/* TXE ISR — writes one byte from ring buffer per invocation.
- * Disables TXE interrupt when buffer is empty. */
+#if UART_TX_USE_DMA
+/* Transfer-complete ISR — retires the finished chunk and queues the next one. */
+void DMA1_Stream6_IRQHandler(void)
+{
+    if (DMA1->HISR & DMA_HISR_TCIF6)
+    {
+        DMA1->HIFCR = DMA_HIFCR_CTCIF6;
+
+        tx_tail   += tx_dma_len;
+        tx_dma_len = 0;
+
+        tx_dma_start();
+        tx_wake_writer();
+    }
+}
+#endif
+
+/* USART2 ISR — RX idle-line and error events go to uart_rx.c. Without TX
+ * DMA it also writes one byte from the ring buffer per TXE and disables
+ * TXE when the buffer is empty. */
 void USART2_IRQHandler(void)
 {
+    uart_rx_usart_isr();
+
+#if !UART_TX_USE_DMA
     if ((USART2->SR & USART_SR_TXE) && (USART2->CR1 & USART_CR1_TXEIE))
     {
         if (tx_head != tx_tail)
         {
             USART2->DR = tx_buf[tx_tail & (UART_TX_BUF_SIZE - 1)];
             tx_tail++;
+            tx_wake_writer();
         }
         else
         {
             USART2->CR1 &= ~USART_CR1_TXEIE;
         }
     }
+#endif
 }
 
 /* Blocking flush — drains TX buffer by polling.
  * Use during pre-scheduler boot, fault handlers, or before WFI. */
 void uart_tx_flush(void)
 {
+#if UART_TX_USE_DMA
+    /* Finish (and account for) any chunk in flight without relying on the ISR */
+    NVIC_DisableIRQ(DMA1_Stream6_IRQn);
+    if (tx_dma_len != 0)
+    {
+        while (DMA1_Stream6->CR & DMA_SxCR_EN)
+        {
+        }
+        DMA1->HIFCR = DMA_HIFCR_CTCIF6;
+        tx_tail    += tx_dma_len;
+        tx_dma_len  = 0;
+    }
+#else
     USART2->CR1 &= ~USART_CR1_TXEIE;
+#endif
 
     while (tx_head != tx_tail)
     {
@@ -115,4 +346,25 @@ void uart_tx_flush(void)
     while (!(USART2->SR & USART_SR_TC))
     {
     }
+
+#if UART_TX_USE_DMA
+    NVIC_EnableIRQ(DMA1_Stream6_IRQn);
+#endif
 }
+
+void uart_tx_write_polled(const char *data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++)
+    {
+        while (!(USART2->SR & USART_SR_TXE))
+        {
+        }
+        USART2->DR = (uint8_t) data[i];
+    }
+
+    while (!(USART2->SR & USART_SR_TC))
+    {
+    }
+}
+
+#endif /* LOG_BACKEND_RTT */
@@ -19,6 +19,10 @@ extern log_level_t g_log_level;
 void log_uart_init(log_level_t level);
 void uart_tx_flush(void);
 
+/* Blocking write that bypasses the TX ring: call uart_tx_flush() first.
+ * Works inside a critical section (test verdicts, fault reports). */
+void uart_tx_write_polled(const char *data, uint32_t len);
+
 /* Internal macro */
 #define log_printf(level, tag, msg, ...)                                                                               \
     do                                                                                                                 \
@@ -1,20 +1,243 @@
 #include "ulog.h"
 
+#include "log_flush_task.h"
 #include "ring_buffer.h"
 #include "rtos_port.h"
+#include "rtt.h"
 
 #include <stdarg.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <string.h>
 
-static uint8_t       ulog_buf[ULOG_BUFFER_SIZE];
+#define ULOG_PAD4(n) (((n) + 3U) & ~3U) /* Ring entries and copies are whole words */
+
+static ulog_level_t ulog_min_level;
+
+#if !LOG_BACKEND_RTT
+
+/* ========================= FORMAT SCANNER ================================= */
+
+/* Length modifiers that change how an argument is passed */
+typedef enum
+{
+    ULOG_LEN_INT = 0, /* none, h, hh (promoted to int) */
+    ULOG_LEN_LONG,    /* l */
+    ULOG_LEN_LLONG,   /* ll, 64-bit */
+    ULOG_LEN_SIZE,    /* z */
+} ulog_len_t;
+
+/* One conversion specification in a format string */
+typedef struct
+{
+    const char *start; /* The '%' */
+    const char *end;   /* One past the conversion character */
+    char        conv;  /* Conversion character, '%' for a literal percent */
+    ulog_len_t  len;
+    uint8_t     stars; /* '*' width/precision arguments before the value */
+} ulog_spec_t;
+
+/* Words a converted value occupies in a deferred record, 0 for "%%" */
+static uint32_t ulog_spec_words(const ulog_spec_t *spec)
+{
+    switch (spec->conv)
+    {
+        case '%':
+            return 0;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            return 2;
+        case 'd':
+        case 'i':
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+            return (spec->len == ULOG_LEN_LLONG) ? 2 : 1;
+        default:
+            return 1; /* c, s, p */
+    }
+}
+
+/**
+ * @brief Find the next conversion specification at or after p
+ * @return 1 if found, 0 at end of string, -1 if it uses something the
+ *         deferred path cannot carry (%n, j/t/L modifiers, unknown conversion)
+ */
+static int ulog_next_spec(const char *p, ulog_spec_t *spec)
+{
+    while (*p != '\0' && *p != '%')
+    {
+        p++;
+    }
+    if (*p == '\0')
+    {
+        return 0;
+    }
+
+    spec->start = p++;
+    spec->len   = ULOG_LEN_INT;
+    spec->stars = 0;
+
+    while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0')
+    {
+        p++;
+    }
+
+    /* Width, then precision */
+    for (int field = 0; field < 2; field++)
+    {
+        if (field == 1)
+        {
+            if (*p != '.')
+            {
+                break;
+            }
+            p++;
+        }
+        if (*p == '*')
+        {
+            spec->stars++;
+            p++;
+        }
+        while (*p >= '0' && *p <= '9')
+        {
+            p++;
+        }
+    }
+
+    if (*p == 'h')
+    {
+        p += (p[1] == 'h') ? 2 : 1;
+    }
+    else if (*p == 'l')
+    {
+        spec->len = (p[1] == 'l') ? ULOG_LEN_LLONG : ULOG_LEN_LONG;
+        p += (p[1] == 'l') ? 2 : 1;
+    }
+    else if (*p == 'z')
+    {
+        spec->len = ULOG_LEN_SIZE;
+        p++;
+    }
+
+    spec->conv = *p;
+    if (spec->conv == '\0' || strchr("%diouxXcspfFeEgGaA", spec->conv) == NULL)
+    {
+        return -1;
+    }
+
+    spec->end = p + 1;
+    return 1;
+}
+
+/* ========================= RING ENTRIES =================================== */
+
+/*
+ * The ring holds 4-byte-aligned entries: a header word followed by either
+ * the text of a formatted line (ulog) or the format-string pointer and the
+ * raw argument words (ulog_deferred). ulog_drain() turns both into text.
+ */
+#define ULOG_ENTRY_TEXT     (0U)
+#define ULOG_ENTRY_DEFERRED (1U)
+
+typedef struct
+{
+    uint16_t len;  /* Text bytes, or argument words */
+    uint8_t  kind; /* ULOG_ENTRY_* */
+    uint8_t  _pad;
+} ulog_entry_t;
+
+static uint8_t       ulog_buf[ULOG_BUFFER_SIZE] __attribute__((aligned(4)));
 static ring_buffer_t ulog_rb;
-static ulog_level_t  ulog_min_level;
+
+/* Consumer side: the line being handed out by ulog_drain() */
+static char     ulog_line[ULOG_PAD4(ULOG_LINE_MAX)] __attribute__((aligned(4)));
+static uint32_t ulog_line_len;
+static uint32_t ulog_line_pos;
+
+/* Append one entry; never blocks, drops the entry if the ring is full */
+static void ulog_push(uint8_t kind, uint16_t len, const void *payload, uint32_t payload_bytes)
+{
+    ulog_entry_t entry = {len, kind, 0};
+    uint32_t     total = sizeof(entry) + ULOG_PAD4(payload_bytes);
+
+    rtos_port_enter_critical();
+    uint32_t before  = ring_buffer_count(&ulog_rb);
+    bool     written = total <= ring_buffer_free(&ulog_rb);
+    if (written)
+    {
+        ring_buffer_write(&ulog_rb, &entry, sizeof(entry));
+        ring_buffer_write(&ulog_rb, payload, ULOG_PAD4(payload_bytes));
+    }
+    uint32_t after = ring_buffer_count(&ulog_rb);
+    rtos_port_exit_critical();
+
+    /* Wake the flush task once per crossing, or when an entry was dropped */
+    if ((before < ULOG_FLUSH_WATERMARK && after >= ULOG_FLUSH_WATERMARK) || !written)
+    {
+        log_flush_request();
+    }
+}
+
+#endif /* !LOG_BACKEND_RTT */
+
+/* Send a formatted line (CRLF included) to the active backend */
+static void ulog_emit_line(char *line, uint32_t len)
+{
+#if LOG_BACKEND_RTT
+    rtt_write(RTT_CHANNEL_TERMINAL, line, len);
+#else
+    ulog_push(ULOG_ENTRY_TEXT, (uint16_t) len, line, len);
+#endif
+}
+
+/* Terminate a formatted line of vsnprintf-style length n with CRLF */
+static uint32_t ulog_finish_line(char *line, int n)
+{
+    uint32_t len = (n < 0) ? 0U : (uint32_t) n;
+    if (len > ULOG_LINE_MAX - 3U)
+    {
+        len = ULOG_LINE_MAX - 3U;
+    }
+    line[len]      = '\r';
+    line[len + 1U] = '\n';
+    return len + 2U;
+}
+
+static void ulog_vformat_now(const char *fmt, va_list args)
+{
+    /* Format into stack-local scratch buffer — no malloc. Padded so the
+     * ring copy can round the length up to whole words. */
+    char scratch[ULOG_PAD4(ULOG_LINE_MAX)] __attribute__((aligned(4)));
+
+    int n = vsnprintf(scratch, ULOG_LINE_MAX - 2U, fmt, args);
+    if (n <= 0)
+    {
+        return;
+    }
+
+    ulog_emit_line(scratch, ulog_finish_line(scratch, n));
+}
+
+/* ========================= PUBLIC API ===================================== */
 
 void ulog_init(ulog_level_t level)
 {
+#if LOG_BACKEND_RTT
+    rtt_init();
+#else
     ring_buffer_init(&ulog_rb, ulog_buf, ULOG_BUFFER_SIZE);
+    ulog_line_len = 0;
+    ulog_line_pos = 0;
+#endif
     ulog_min_level = level;
 }
 
@@ -25,47 +248,289 @@ void ulog(ulog_level_t level, const char *fmt, ...)
         return;
     }
 
-    /* Format into stack-local scratch buffer — no malloc */
-    char    scratch[ULOG_LINE_MAX];
     va_list args;
-
     va_start(args, fmt);
-    int len = vsnprintf(scratch, sizeof(scratch) - 2, fmt, args);
+    ulog_vformat_now(fmt, args);
     va_end(args);
+}
 
-    if (len <= 0)
+void ulog_deferred(ulog_level_t level, const char *fmt, ...)
+{
+    if (level > ulog_min_level || fmt == NULL)
     {
         return;
     }
 
-    if ((uint32_t) len > sizeof(scratch) - 3)
+    va_list args;
+    va_start(args, fmt);
+
+#if !LOG_BACKEND_RTT
+    /* Record layout: fmt pointer, then the arguments as raw words */
+    uint32_t    record[1U + ULOG_DEFERRED_MAX_WORDS];
+    uint32_t    words = 0;
+    ulog_spec_t spec;
+    const char *p = fmt;
+    int         found;
+
+    record[0] = (uint32_t) (uintptr_t) fmt;
+
+    while ((found = ulog_next_spec(p, &spec)) > 0)
+    {
+        p = spec.end;
+
+        uint32_t need = spec.stars + ulog_spec_words(&spec);
+        if (words + need > ULOG_DEFERRED_MAX_WORDS)
+        {
+            found = -1;
+            break;
+        }
+
+        for (uint32_t i = 0; i < spec.stars; i++)
+        {
+            record[1U + words++] = (uint32_t) va_arg(args, int);
+        }
+
+        switch (ulog_spec_words(&spec))
+        {
+            case 0:
+                break;
+            case 2:
+            {
+                uint64_t raw;
+                if (spec.conv == 'd' || spec.conv == 'i' || spec.conv == 'u' || spec.conv == 'o' ||
+                    spec.conv == 'x' || spec.conv == 'X')
+                {
+                    raw = va_arg(args, unsigned long long);
+                }
+                else
+                {
+                    double value = va_arg(args, double);
+                    memcpy(&raw, &value, sizeof(raw));
+                }
+                memcpy(&record[1U + words], &raw, sizeof(raw));
+                words += 2U;
+                break;
+            }
+            default:
+                if (spec.conv == 's' || spec.conv == 'p')
+                {
+                    record[1U + words++] = (uint32_t) (uintptr_t) va_arg(args, const void *);
+                }
+                else if (spec.len == ULOG_LEN_LONG)
+                {
+                    record[1U + words++] = (uint32_t) va_arg(args, unsigned long);
+                }
+                else if (spec.len == ULOG_LEN_SIZE)
+                {
+                    record[1U + words++] = (uint32_t) va_arg(args, size_t);
+                }
+                else
+                {
+                    record[1U + words++] = (uint32_t) va_arg(args, unsigned int);
+                }
+                break;
+        }
+    }
+
+    if (found == 0)
     {
-        len = sizeof(scratch) - 3;
+        ulog_push(ULOG_ENTRY_DEFERRED, (uint16_t) words, record, (1U + words) * sizeof(uint32_t));
+        va_end(args);
+        return;
     }
-    scratch[len]     = '\r';
-    scratch[len + 1] = '\n';
-    len += 2;
+
+    /* Too many arguments or an unsupported conversion: format here instead */
+    va_end(args);
+    va_start(args, fmt);
+#endif
+
+    ulog_vformat_now(fmt, args);
+    va_end(args);
+}
+
+#if !LOG_BACKEND_RTT
+
+/* Format a deferred record into ulog_line, one conversion at a time */
+static uint32_t ulog_format_deferred(const char *fmt, const uint32_t *words, uint32_t nwords)
+{
+    const uint32_t cap = ULOG_LINE_MAX - 2U; /* Leave room for CRLF */
+    uint32_t       pos = 0;
+    uint32_t       w   = 0;
+    const char    *p   = fmt;
+    ulog_spec_t    spec;
+
+    while (pos < cap)
+    {
+        int         found   = ulog_next_spec(p, &spec);
+        const char *lit_end = (found > 0) ? spec.start : (p + strlen(p));
+
+        /* Literal text up to the next conversion */
+        uint32_t lit = (uint32_t) (lit_end - p);
+        if (lit > cap - pos)
+        {
+            lit = cap - pos;
+        }
+        memcpy(&ulog_line[pos], p, lit);
+        pos += lit;
+
+        if (found <= 0 || pos >= cap)
+        {
+            break;
+        }
+        p = spec.end;
+
+        if (w + spec.stars + ulog_spec_words(&spec) > nwords)
+        {
+            break; /* Record does not match the format — stop rather than read past it */
+        }
+
+        /* Rebuild the spec with '*' replaced by the recorded values */
+        char     one[24];
+        uint32_t n = 0;
+        for (const char *c = spec.start; c < spec.end && n < sizeof(one) - 12U; c++)
+        {
+            if (*c == '*')
+            {
+                n += (uint32_t) snprintf(&one[n], sizeof(one) - n, "%d", (int) words[w++]);
+            }
+            else
+            {
+                one[n++] = *c;
+            }
+        }
+        one[n] = '\0';
+
+        char    *dst  = &ulog_line[pos];
+        size_t   room = (size_t) (cap - pos) + 1U; /* snprintf counts the NUL */
+        int      out;
+        uint64_t raw;
+
+        switch (ulog_spec_words(&spec))
+        {
+            case 0:
+                out = snprintf(dst, room, "%%");
+                break;
+            case 2:
+                memcpy(&raw, &words[w], sizeof(raw));
+                w += 2U;
+                if (spec.conv == 'd' || spec.conv == 'i' || spec.conv == 'u' || spec.conv == 'o' ||
+                    spec.conv == 'x' || spec.conv == 'X')
+                {
+                    out = snprintf(dst, room, one, (unsigned long long) raw);
+                }
+                else
+                {
+                    double value;
+                    memcpy(&value, &raw, sizeof(value));
+                    out = snprintf(dst, room, one, value);
+                }
+                break;
+            default:
+                if (spec.conv == 's')
+                {
+                    const char *str = (const char *) (uintptr_t) words[w++];
+                    out             = snprintf(dst, room, one, (str != NULL) ? str : "(null)");
+                }
+                else if (spec.conv == 'p')
+                {
+                    out = snprintf(dst, room, one, (void *) (uintptr_t) words[w++]);
+                }
+                else if (spec.len == ULOG_LEN_LONG)
+                {
+                    out = snprintf(dst, room, one, (unsigned long) words[w++]);
+                }
+                else if (spec.len == ULOG_LEN_SIZE)
+                {
+                    out = snprintf(dst, room, one, (size_t) words[w++]);
+                }
+                else
+                {
+                    out = snprintf(dst, room, one, (unsigned int) words[w++]);
+                }
+                break;
+        }
+
+        if (out > 0)
+        {
+            pos += ((uint32_t) out < cap - pos) ? (uint32_t) out : (cap - pos);
+        }
+    }
+
+    return ulog_finish_line(ulog_line, (int) pos);
+}
+
+/* Pop the next entry into ulog_line; false if the ring is empty */
+static bool ulog_next_line(void)
+{
+    ulog_entry_t entry;
+    uint32_t     record[1U + ULOG_DEFERRED_MAX_WORDS];
 
     rtos_port_enter_critical();
-    ring_buffer_write(&ulog_rb, scratch, (uint32_t) len);
+    if (ring_buffer_read(&ulog_rb, &entry, sizeof(entry)) < sizeof(entry))
+    {
+        rtos_port_exit_critical();
+        return false;
+    }
+    if (entry.kind == ULOG_ENTRY_TEXT)
+    {
+        ring_buffer_read(&ulog_rb, ulog_line, ULOG_PAD4(entry.len));
+    }
+    else
+    {
+        ring_buffer_read(&ulog_rb, record, (1U + entry.len) * sizeof(uint32_t));
+    }
     rtos_port_exit_critical();
+
+    /* Formatting happens here, in the flush task, outside the critical section */
+    ulog_line_len = (entry.kind == ULOG_ENTRY_TEXT)
+                        ? entry.len
+                        : ulog_format_deferred((const char *) (uintptr_t) record[0], &record[1], entry.len);
+    ulog_line_pos = 0;
+    return true;
 }
 
+#endif /* !LOG_BACKEND_RTT */
+
 uint32_t ulog_drain(uint8_t *buf, uint32_t max_len)
 {
+#if LOG_BACKEND_RTT
+    (void) buf;
+    (void) max_len;
+    return 0; /* The debugger reads the RTT terminal channel directly */
+#else
     if (buf == NULL || max_len == 0)
     {
         return 0;
     }
 
-    rtos_port_enter_critical();
-    uint32_t bytes = ring_buffer_read(&ulog_rb, buf, max_len);
-    rtos_port_exit_critical();
+    uint32_t bytes = 0;
+
+    while (bytes < max_len)
+    {
+        if (ulog_line_pos == ulog_line_len && !ulog_next_line())
+        {
+            break;
+        }
+
+        uint32_t chunk = ulog_line_len - ulog_line_pos;
+        if (chunk > max_len - bytes)
+        {
+            chunk = max_len - bytes;
+        }
+        memcpy(&buf[bytes], &ulog_line[ulog_line_pos], chunk);
+        ulog_line_pos += chunk;
+        bytes         += chunk;
+    }
 
     return bytes;
+#endif
 }
 
 uint32_t ulog_pending(void)
 {
-    return ring_buffer_count(&ulog_rb);
+#if LOG_BACKEND_RTT
+    return 0;
+#else
+    return ring_buffer_count(&ulog_rb) + (ulog_line_len - ulog_line_pos);
+#endif
 }
@@ -12,10 +12,29 @@ extern "C"
 #define ULOG_BUFFER_SIZE 1024 /* Must be power of 2 */
 #endif
 
+/* Pending bytes at which ulog() wakes the flush task early */
+#ifndef ULOG_FLUSH_WATERMARK
+#define ULOG_FLUSH_WATERMARK (ULOG_BUFFER_SIZE / 2U)
+#endif
+
 #ifndef ULOG_LINE_MAX
 #define ULOG_LINE_MAX 128 /* Max formatted line length */
 #endif
 
+/*
+ * 1 = ulog_error/warn/info/debug() use ulog_deferred(): the caller stores the
+ *     format pointer and raw argument words, and the flush task formats.
+ * 0 = they call ulog(), which formats in the caller.
+ */
+#ifndef ULOG_DEFERRED_FORMAT
+#define ULOG_DEFERRED_FORMAT 0
+#endif
+
+/* Argument words one deferred record can carry (doubles and 64-bit ints take two) */
+#ifndef ULOG_DEFERRED_MAX_WORDS
+#define ULOG_DEFERRED_MAX_WORDS 8
+#endif
+
 typedef enum
 {
     ULOG_LEVEL_NONE = 0,
@@ -27,18 +46,28 @@ typedef enum
 
 void ulog_init(ulog_level_t level);
 
-/* NOT ISR-safe. Output is deferred to the flush task via ring buffer. */
+/* NOT ISR-safe. Formats in the caller; output is deferred to the flush task via ring buffer. */
 void ulog(ulog_level_t level, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
 
+/* NOT ISR-safe. Formats in the flush task: fmt and every %s argument must
+ * outlive the call (string literals, task names), since only the pointers
+ * are stored. Falls back to ulog() for %n, j/t/L modifiers, more than
+ * ULOG_DEFERRED_MAX_WORDS argument words, or with LOG_BACKEND_RTT. */
+void ulog_deferred(ulog_level_t level, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
 uint32_t ulog_drain(uint8_t *buf, uint32_t max_len);
 uint32_t ulog_pending(void);
 
+#if ULOG_DEFERRED_FORMAT
+#define ULOG_CALL ulog_deferred
+#else
+#define ULOG_CALL ulog
+#endif
 
-
-#define ulog_error(msg, ...) ulog(ULOG_LEVEL_ERROR, "[E] " msg, ##__VA_ARGS__)
-#define ulog_warn(msg, ...)  ulog(ULOG_LEVEL_WARN, "[W] " msg, ##__VA_ARGS__)
-#define ulog_info(msg, ...)  ulog(ULOG_LEVEL_INFO, "[I] " msg, ##__VA_ARGS__)
-#define ulog_debug(msg, ...) ulog(ULOG_LEVEL_DEBUG, "[D] " msg, ##__VA_ARGS__)
+#define ulog_error(msg, ...) ULOG_CALL(ULOG_LEVEL_ERROR, "[E] " msg, ##__VA_ARGS__)
+#define ulog_warn(msg, ...)  ULOG_CALL(ULOG_LEVEL_WARN, "[W] " msg, ##__VA_ARGS__)
+#define ulog_info(msg, ...)  ULOG_CALL(ULOG_LEVEL_INFO, "[I] " msg, ##__VA_ARGS__)
+#define ulog_debug(msg, ...) ULOG_CALL(ULOG_LEVEL_DEBUG, "[D] " msg, ##__VA_ARGS__)
 
 #ifdef __cplusplus
 }
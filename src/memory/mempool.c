@@ -0,0 +1,293 @@
+#include "mempool.h"
+
+#include "VRTOS.h"
+#include "klog.h"
+#include "rtos_port.h"
+#include "task.h"
+#include "task_priv.h"
+
+#include <stddef.h>
+
+/* Free blocks are linked through their first word */
+typedef struct mempool_free_block
+{
+    struct mempool_free_block *next;
+} mempool_free_block_t;
+
+static void mempool_remove_from_waiting_list(rtos_mempool_t *pool, rtos_tcb_t *task)
+{
+    if (task == NULL)
+    {
+        return;
+    }
+
+    rtos_wait_queue_remove(&pool->waiters, task);
+
+    task->blocked_on      = NULL;
+    task->blocked_on_type = RTOS_SYNC_TYPE_NONE;
+}
+
+static rtos_tcb_t *mempool_pop_highest_priority_waiter(rtos_mempool_t *pool)
+{
+    rtos_tcb_t *task = rtos_wait_queue_pop(&pool->waiters);
+    if (task == NULL)
+    {
+        return NULL;
+    }
+
+    task->blocked_on      = NULL;
+    task->blocked_on_type = RTOS_SYNC_TYPE_NONE;
+
+    return task;
+}
+
+void rtos_mempool_remove_task_from_wait(void *pool_ptr, rtos_tcb_t *task)
+{
+    mempool_remove_from_waiting_list((rtos_mempool_t *) pool_ptr, task);
+}
+
+/* Caller holds the critical section */
+static void *mempool_take(rtos_mempool_t *pool)
+{
+    mempool_free_block_t *block = (mempool_free_block_t *) pool->free_list;
+    if (block == NULL)
+    {
+        return NULL;
+    }
+
+    pool->free_list = block->next;
+    pool->free_count--;
+    if (pool->free_count < pool->min_free_count)
+    {
+        pool->min_free_count = pool->free_count;
+    }
+
+    return block;
+}
+
+/* Caller holds the critical section */
+static void mempool_put(rtos_mempool_t *pool, void *block)
+{
+    ((mempool_free_block_t *) block)->next = (mempool_free_block_t *) pool->free_list;
+    pool->free_list                        = block;
+    pool->free_count++;
+}
+
+static bool mempool_owns(const rtos_mempool_t *pool, const void *block)
+{
+    const uint8_t *p = (const uint8_t *) block;
+
+    if (p < pool->buffer || p >= pool->buffer + (pool->block_size * pool->block_count))
+    {
+        return false;
+    }
+
+    return ((size_t) (p - pool->buffer) % pool->block_size) == 0;
+}
+
+rtos_status_t rtos_mempool_init(rtos_mempool_t *pool, void *buffer, size_t block_size, uint32_t block_count)
+{
+    if (pool == NULL || buffer == NULL || block_size == 0 || block_count == 0 || ((uintptr_t) buffer & 7U) != 0)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    size_t stride = RTOS_MEMPOOL_BLOCK_SIZE(block_size);
+
+    rtos_port_enter_critical();
+
+    pool->buffer      = (uint8_t *) buffer;
+    pool->block_size  = stride;
+    pool->block_count = block_count;
+    pool->free_list   = NULL;
+    pool->free_count  = 0;
+    pool->fail_count  = 0;
+    rtos_wait_queue_init(&pool->waiters);
+
+    /* Push in reverse so the first allocation returns the lowest address */
+    for (uint32_t i = block_count; i > 0; i--)
+    {
+        mempool_put(pool, pool->buffer + ((size_t) (i - 1U) * stride));
+    }
+    pool->min_free_count = pool->free_count;
+
+    rtos_port_exit_critical();
+
+    KLOGD(KEVT_MEMPOOL_INIT, (uint32_t) stride, block_count);
+
+    return RTOS_SUCCESS;
+}
+
+void *rtos_mempool_alloc(rtos_mempool_t *pool, rtos_tick_t timeout_ticks)
+{
+    if (pool == NULL)
+    {
+        return NULL;
+    }
+
+    rtos_tick_t start    = rtos_get_tick_count();
+    bool        counted  = false;
+
+    while (1)
+    {
+        rtos_port_enter_critical();
+
+        /* Fast path: block available */
+        void *block = mempool_take(pool);
+        if (block != NULL)
+        {
+            rtos_port_exit_critical();
+            return block;
+        }
+
+        if (!counted)
+        {
+            pool->fail_count++;
+            counted = true;
+        }
+
+        if (timeout_ticks == 0)
+        {
+            rtos_port_exit_critical();
+            KLOGD(KEVT_MEMPOOL_EMPTY, pool->block_count, 0);
+            return NULL;
+        }
+
+        /* A woken waiter can lose the freed block to a higher-priority
+         * task or an ISR; it then waits again for what is left. */
+        rtos_tick_t remaining = RTOS_MAX_DELAY;
+        if (timeout_ticks != RTOS_MAX_DELAY)
+        {
+            rtos_tick_t elapsed = rtos_get_tick_count() - start;
+            if (elapsed >= timeout_ticks)
+            {
+                rtos_port_exit_critical();
+                return NULL;
+            }
+            remaining = timeout_ticks - elapsed;
+        }
+
+        rtos_tcb_t *current_task = rtos_task_get_current();
+        if (current_task == NULL)
+        {
+            rtos_port_exit_critical();
+            KLOGE(KEVT_NO_CURRENT_TASK, 0, 0);
+            return NULL;
+        }
+
+        KLOGD(KEVT_MEMPOOL_BLOCK, current_task->task_id, (uint32_t) remaining);
+
+        rtos_kernel_block_on(pool, RTOS_SYNC_TYPE_MEMPOOL, &pool->waiters, remaining);
+
+        /* --- Task resumes here after a free or timeout --- */
+
+        if (current_task->blocked_on == pool)
+        {
+            /* Still on waiting list = timeout occurred */
+            mempool_remove_from_waiting_list(pool, current_task);
+            rtos_port_exit_critical();
+            KLOGD(KEVT_MEMPOOL_TIMEOUT, current_task->task_id, 0);
+            return NULL;
+        }
+
+        rtos_port_exit_critical();
+    }
+}
+
+void *rtos_mempool_alloc_from_isr(rtos_mempool_t *pool)
+{
+    if (pool == NULL)
+    {
+        return NULL;
+    }
+
+    uint32_t saved = rtos_port_enter_critical_from_isr();
+
+    void *block = mempool_take(pool);
+    if (block == NULL)
+    {
+        pool->fail_count++;
+    }
+
+    rtos_port_exit_critical_from_isr(saved);
+
+    return block;
+}
+
+rtos_status_t rtos_mempool_free(rtos_mempool_t *pool, void *block)
+{
+    if (pool == NULL || !mempool_owns(pool, block))
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_port_enter_critical();
+
+    if (pool->free_count >= pool->block_count)
+    {
+        rtos_port_exit_critical();
+        return RTOS_ERROR_INVALID_STATE; /* More frees than allocations */
+    }
+
+    mempool_put(pool, block);
+    rtos_tcb_t *waiter = mempool_pop_highest_priority_waiter(pool);
+
+    rtos_port_exit_critical();
+
+    if (waiter != NULL)
+    {
+        KLOGD(KEVT_MEMPOOL_WAKE, waiter->task_id, 0);
+        rtos_kernel_task_unblock(waiter);
+    }
+
+    return RTOS_SUCCESS;
+}
+
+rtos_status_t rtos_mempool_free_from_isr(rtos_mempool_t *pool, void *block)
+{
+    if (pool == NULL || !mempool_owns(pool, block))
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    uint32_t saved = rtos_port_enter_critical_from_isr();
+
+    if (pool->free_count >= pool->block_count)
+    {
+        rtos_port_exit_critical_from_isr(saved);
+        return RTOS_ERROR_INVALID_STATE;
+    }
+
+    mempool_put(pool, block);
+    rtos_tcb_t *waiter = mempool_pop_highest_priority_waiter(pool);
+
+    rtos_port_exit_critical_from_isr(saved);
+
+    /* Unblock outside ISR critical section */
+    if (waiter != NULL)
+    {
+        rtos_kernel_task_unblock(waiter);
+    }
+
+    return RTOS_SUCCESS;
+}
+
+rtos_status_t rtos_mempool_get_stats(rtos_mempool_t *pool, rtos_mempool_stats_t *stats)
+{
+    if (pool == NULL || stats == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_port_enter_critical();
+
+    stats->block_size  = pool->block_size;
+    stats->block_count = pool->block_count;
+    stats->free_count  = pool->free_count;
+    stats->peak_used   = pool->block_count - pool->min_free_count;
+    stats->fail_count  = pool->fail_count;
+
+    rtos_port_exit_critical();
+
+    return RTOS_SUCCESS;
+}
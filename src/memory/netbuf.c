@@ -0,0 +1,315 @@
+/*******************************************************************************
+ * File: src/memory/netbuf.c
+ * Description: Chained packet buffers over a fixed-block pool
+ ******************************************************************************/
+
+#include "netbuf.h"
+
+#include "VRTOS.h"
+#include "rtos_port.h"
+
+#include <stddef.h>
+#include <string.h>
+
+/*
+ * A segment is one mempool block: the rtos_netbuf_t header, then seg_size
+ * data bytes. payload moves inside the data area as headers are pushed and
+ * pulled; len and tot_len follow it.
+ *
+ * refs changes under a critical section because the free path may run in
+ * an ISR (a DMA complete handler releasing a sent packet) while a task
+ * holds another reference to the same segment.
+ */
+
+static inline uint8_t *netbuf_data(rtos_netbuf_t *nb)
+{
+    return (uint8_t *) nb + RTOS_NETBUF_HEADER_SIZE;
+}
+
+rtos_status_t rtos_netbuf_pool_init(rtos_netbuf_pool_t *pool, void *storage, uint16_t seg_size, uint32_t count)
+{
+    if (pool == NULL || seg_size == 0U)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    pool->seg_size = seg_size;
+
+    return rtos_mempool_init(&pool->blocks, storage, RTOS_NETBUF_HEADER_SIZE + seg_size, count);
+}
+
+/* Build a chain segment by segment; from_isr picks the mempool entry point */
+static rtos_netbuf_t *netbuf_alloc(rtos_netbuf_pool_t *pool, uint16_t len, uint16_t reserve,
+                                   rtos_tick_t timeout_ticks, bool from_isr)
+{
+    if (pool == NULL || reserve >= pool->seg_size)
+    {
+        return NULL;
+    }
+
+    rtos_netbuf_t  *head = NULL;
+    rtos_netbuf_t **link = &head;
+    uint32_t        left = len;
+    uint16_t        room = (uint16_t) (pool->seg_size - reserve);
+
+    do
+    {
+        rtos_netbuf_t *nb = (rtos_netbuf_t *) (from_isr ? rtos_mempool_alloc_from_isr(&pool->blocks)
+                                                        : rtos_mempool_alloc(&pool->blocks, timeout_ticks));
+        if (nb == NULL)
+        {
+            if (from_isr)
+            {
+                (void) rtos_netbuf_free_from_isr(head);
+            }
+            else
+            {
+                (void) rtos_netbuf_free(head);
+            }
+            return NULL;
+        }
+
+        uint16_t seg_len = (left < room) ? (uint16_t) left : room;
+
+        nb->next    = NULL;
+        nb->payload = netbuf_data(nb) + (pool->seg_size - room);
+        nb->pool    = pool;
+        nb->len     = seg_len;
+        nb->tot_len = (uint16_t) left;
+        nb->refs    = 1U;
+
+        *link = nb;
+        link  = &nb->next;
+        left -= seg_len;
+        room = pool->seg_size;
+    } while (left > 0U);
+
+    return head;
+}
+
+rtos_netbuf_t *rtos_netbuf_alloc(rtos_netbuf_pool_t *pool, uint16_t len, uint16_t reserve, rtos_tick_t timeout_ticks)
+{
+    return netbuf_alloc(pool, len, reserve, timeout_ticks, false);
+}
+
+rtos_netbuf_t *rtos_netbuf_alloc_from_isr(rtos_netbuf_pool_t *pool, uint16_t len, uint16_t reserve)
+{
+    return netbuf_alloc(pool, len, reserve, 0U, true);
+}
+
+void rtos_netbuf_ref(rtos_netbuf_t *nb)
+{
+    if (nb == NULL)
+    {
+        return;
+    }
+
+    uint32_t saved = rtos_port_enter_critical_from_isr();
+    RTOS_ASSERT(nb->refs < UINT8_MAX);
+    nb->refs++;
+    rtos_port_exit_critical_from_isr(saved);
+}
+
+static uint32_t netbuf_free(rtos_netbuf_t *nb, bool from_isr)
+{
+    uint32_t freed = 0U;
+
+    while (nb != NULL)
+    {
+        rtos_netbuf_t *next = nb->next;
+        uint32_t       saved = rtos_port_enter_critical_from_isr();
+        uint8_t        refs  = (nb->refs > 0U) ? (uint8_t) (nb->refs - 1U) : 0U;
+
+        nb->refs = refs;
+        rtos_port_exit_critical_from_isr(saved);
+
+        if (refs != 0U)
+        {
+            /* Still in another chain, which owns the rest */
+            break;
+        }
+
+        if (from_isr)
+        {
+            (void) rtos_mempool_free_from_isr(&nb->pool->blocks, nb);
+        }
+        else
+        {
+            (void) rtos_mempool_free(&nb->pool->blocks, nb);
+        }
+        freed++;
+        nb = next;
+    }
+
+    return freed;
+}
+
+uint32_t rtos_netbuf_free(rtos_netbuf_t *nb)
+{
+    return netbuf_free(nb, false);
+}
+
+uint32_t rtos_netbuf_free_from_isr(rtos_netbuf_t *nb)
+{
+    return netbuf_free(nb, true);
+}
+
+void *rtos_netbuf_push(rtos_netbuf_t *nb, uint16_t n)
+{
+    if (nb == NULL || (uint32_t) (nb->payload - netbuf_data(nb)) < n || (uint32_t) nb->tot_len + n > UINT16_MAX)
+    {
+        return NULL;
+    }
+
+    nb->payload -= n;
+    nb->len = (uint16_t) (nb->len + n);
+    nb->tot_len = (uint16_t) (nb->tot_len + n);
+
+    return nb->payload;
+}
+
+void *rtos_netbuf_pull(rtos_netbuf_t *nb, uint16_t n)
+{
+    if (nb == NULL || nb->len < n)
+    {
+        return NULL;
+    }
+
+    nb->payload += n;
+    nb->len = (uint16_t) (nb->len - n);
+    nb->tot_len = (uint16_t) (nb->tot_len - n);
+
+    return nb->payload;
+}
+
+rtos_status_t rtos_netbuf_cat(rtos_netbuf_t *head, rtos_netbuf_t *tail)
+{
+    if (head == NULL || tail == NULL || (uint32_t) head->tot_len + tail->tot_len > UINT16_MAX)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_netbuf_t *nb = head;
+    for (;;)
+    {
+        nb->tot_len = (uint16_t) (nb->tot_len + tail->tot_len);
+        if (nb->next == NULL)
+        {
+            break;
+        }
+        nb = nb->next;
+    }
+    nb->next = tail;
+
+    return RTOS_SUCCESS;
+}
+
+uint32_t rtos_netbuf_count(const rtos_netbuf_t *nb)
+{
+    uint32_t count = 0U;
+
+    for (; nb != NULL; nb = nb->next)
+    {
+        count++;
+    }
+    return count;
+}
+
+/* Walk to the segment holding packet byte `offset`; *skip gets the offset inside it */
+static rtos_netbuf_t *netbuf_seek(const rtos_netbuf_t *nb, uint32_t offset, uint32_t *skip)
+{
+    while (nb != NULL && offset >= nb->len)
+    {
+        offset -= nb->len;
+        nb = nb->next;
+    }
+    *skip = offset;
+    return (rtos_netbuf_t *) nb;
+}
+
+uint32_t rtos_netbuf_copy_out(const rtos_netbuf_t *nb, uint32_t offset, void *dst, uint32_t len)
+{
+    uint32_t       skip;
+    uint32_t       copied = 0U;
+    rtos_netbuf_t *seg    = netbuf_seek(nb, offset, &skip);
+
+    if (dst == NULL)
+    {
+        return 0U;
+    }
+
+    for (; seg != NULL && copied < len; seg = seg->next)
+    {
+        uint32_t n = seg->len - skip;
+        if (n > len - copied)
+        {
+            n = len - copied;
+        }
+        memcpy((uint8_t *) dst + copied, seg->payload + skip, n);
+        copied += n;
+        skip = 0U;
+    }
+    return copied;
+}
+
+uint32_t rtos_netbuf_copy_in(rtos_netbuf_t *nb, uint32_t offset, const void *src, uint32_t len)
+{
+    uint32_t       skip;
+    uint32_t       copied = 0U;
+    rtos_netbuf_t *seg    = netbuf_seek(nb, offset, &skip);
+
+    if (src == NULL)
+    {
+        return 0U;
+    }
+
+    for (; seg != NULL && copied < len; seg = seg->next)
+    {
+        uint32_t n = seg->len - skip;
+        if (n > len - copied)
+        {
+            n = len - copied;
+        }
+        memcpy(seg->payload + skip, (const uint8_t *) src + copied, n);
+        copied += n;
+        skip = 0U;
+    }
+    return copied;
+}
+
+uint32_t rtos_netbuf_to_sg(const rtos_netbuf_t *nb, rtos_netbuf_sg_t *sg, uint32_t max_entries)
+{
+    uint32_t n = 0U;
+
+    if (sg == NULL)
+    {
+        return 0U;
+    }
+
+    for (; nb != NULL; nb = nb->next)
+    {
+        if (nb->len == 0U)
+        {
+            continue;
+        }
+        if (n == max_entries)
+        {
+            return 0U;
+        }
+        sg[n].addr = nb->payload;
+        sg[n].len  = nb->len;
+        n++;
+    }
+    return n;
+}
+
+void rtos_netbuf_clean_dcache(const rtos_netbuf_t *nb)
+{
+    for (; nb != NULL; nb = nb->next)
+    {
+        if (nb->len != 0U)
+        {
+            rtos_port_dcache_clean(nb->payload, nb->len);
+        }
+    }
+}
@@ -11,6 +11,9 @@ typedef uint32_t port_stack_t;
 /** Stack canary pattern for overflow detection. */
 #define PORT_STACK_CANARY_VALUE 0xC0DEC0DEU
 
+/** Pattern painted over a new task's stack for high-water measurement. */
+#define PORT_STACK_FILL_VALUE 0xA5A5A5A5U
+
 /* ======================== Contract Enforcement ============================ */
 
 /**
@@ -31,6 +34,22 @@ typedef uint32_t port_stack_t;
 #error "port_priv.h must define PORT_HAS_FPU (0 or 1)"
 #endif
 
+#ifndef PORT_HAS_DCACHE
+#error "port_priv.h must define PORT_HAS_DCACHE (0 or 1)"
+#endif
+
+#ifndef PORT_HAS_BLOCK_TRANSFER
+#error "port_priv.h must define PORT_HAS_BLOCK_TRANSFER (0 or 1)"
+#endif
+
+#ifndef PORT_NUM_CORES
+#error "port_priv.h must define PORT_NUM_CORES"
+#endif
+
+#if RTOS_SMP_CORES > PORT_NUM_CORES
+#error "RTOS_SMP_CORES exceeds the port's PORT_NUM_CORES"
+#endif
+
 #ifndef PORT_MAX_INTERRUPT_PRIORITY
 #error "port_priv.h must define PORT_MAX_INTERRUPT_PRIORITY"
 #endif
@@ -1,18 +1,137 @@
 #include "config.h"
+#include "hardware_env.h"
 #include "kernel_priv.h"
 #include "klog.h"
 #include "port_priv.h" /* chip-specific constants (must come first) */
+#include "prof_trace.h"
 #include "profiling.h"
 #define PORT_VERIFY_CONTRACT
 #include "port_common.h" /* contract checks + common types */
 #include "rtos_port.h"
+#include "task.h"
 #include "task_priv.h"
 #include "utils.h"
 
-#include "stm32f4xx.h" // IWYU pragma: keep
+#include "device.h" // IWYU pragma: keep
 
-static volatile uint32_t g_critical_nesting = 0;
-static volatile uint32_t g_critical_basepri = 0;
+/* Declared in port_critical.h; nesting is swapped per task by PendSV */
+volatile uint32_t g_critical_nesting = 0;
+uint32_t          g_critical_basepri = 0;
+
+#if RTOS_PROFILING_SYSTEM_ENABLED
+/* DWT timestamp of the previous SysTick, for jitter measurement */
+static uint32_t g_last_tick_cycle = 0;
+#endif
+
+#if PORT_HAS_FPU
+/* Nonzero while CP10/CP11 access is revoked for a RTOS_TASK_FLAG_NO_FPU task */
+static uint32_t g_fpu_access_off = 0;
+
+/**
+ * Apply the incoming task's FPU policy.  CPACR is only rewritten when the
+ * policy changes, so switches between tasks of the same kind cost a compare.
+ * With access revoked, any FP instruction faults (NOCP) instead of silently
+ * giving the task an extended frame.
+ */
+static inline void port_fpu_select(const rtos_tcb_t *task)
+{
+    uint32_t off = task->flags & RTOS_TASK_FLAG_NO_FPU;
+
+    if (off != g_fpu_access_off)
+    {
+        if (off != 0U)
+        {
+            SCB->CPACR &= ~PORT_CPACR_FPU_MASK;
+        }
+        else
+        {
+            SCB->CPACR |= PORT_CPACR_FPU_MASK;
+        }
+        __DSB();
+        __ISB();
+        g_fpu_access_off = off;
+    }
+}
+
+#endif
+
+#if RTOS_STACK_GUARD_MPU
+RTOS_STATIC_ASSERT(RTOS_STACK_GUARD_SIZE >= 32U && (RTOS_STACK_GUARD_SIZE & (RTOS_STACK_GUARD_SIZE - 1U)) == 0U,
+                   "RTOS_STACK_GUARD_SIZE must be a power of 2 >= 32 (ARMv7-M region rules)");
+RTOS_STATIC_ASSERT(RTOS_MINIMUM_TASK_STACK_SIZE > 2U * RTOS_STACK_GUARD_SIZE,
+                   "the guard is carved from each stack: raise RTOS_MINIMUM_TASK_STACK_SIZE");
+
+/* Guard RASR: enabled, AP = 000 (no access, privileged included), execute-never */
+#define PORT_GUARD_RASR                                                                                    \
+    (MPU_RASR_XN_Msk | ((uint32_t) (__builtin_ctz(RTOS_STACK_GUARD_SIZE) - 1) << MPU_RASR_SIZE_Pos) |      \
+     MPU_RASR_ENABLE_Msk)
+
+/**
+ * Move the guard region onto the incoming task's stack.  A region must be
+ * aligned to its size, so the guard starts at the first such boundary above
+ * the canary word and the canary stays readable by rtos_task_check_stack().
+ * The size and attributes never change, so a switch costs one RBAR store.
+ */
+static inline void port_stack_guard_select(const rtos_tcb_t *task)
+{
+    uint32_t guard = ALIGN_UP((uint32_t) task->stack_base + sizeof(uint32_t), RTOS_STACK_GUARD_SIZE);
+
+    MPU->RBAR = guard | MPU_RBAR_VALID_Msk | PORT_MPU_GUARD_REGION;
+    __DSB(); /* Exception return, or the ISB after it, synchronises the fetch side */
+}
+
+/**
+ * Tasks run privileged, so PRIVDEFENA keeps the default memory map for
+ * everything outside the guard; no other region is needed.
+ */
+static void port_stack_guard_start(const rtos_tcb_t *first)
+{
+    port_stack_guard_select(first);
+    MPU->RASR = PORT_GUARD_RASR;
+    MPU->CTRL = MPU_CTRL_PRIVDEFENA_Msk | MPU_CTRL_ENABLE_Msk;
+    SCB->SHCSR |= SCB_SHCSR_MEMFAULTENA_Msk;
+    __DSB();
+    __ISB();
+}
+
+/**
+ * Only the guard region is defined, so every MemManage fault is a stack
+ * overflow.  The MPU goes off first: a fault raised while stacking the
+ * exception frame leaves PSP inside the guard.  Logs the task and the
+ * faulting address (PSP when MMFAR is not valid), then halts.
+ */
+__attribute__((__noreturn__)) void MemManage_Handler(void)
+{
+    uint32_t cfsr = SCB->CFSR;
+    uint32_t addr = ((cfsr & SCB_CFSR_MMARVALID_Msk) != 0U) ? SCB->MMFAR : __get_PSP();
+
+    MPU->CTRL = 0;
+    __DSB();
+    __ISB();
+
+    const rtos_tcb_t *task = g_kernel.core[0].current_task;
+    KLOGF(KEVT_STACK_OVERFLOW, (task != NULL) ? task->task_id : RTOS_MAX_TASKS, addr);
+    KLOGF(KEVT_HARD_FAULT_SCB, cfsr, SCB->HFSR);
+
+    indicate_system_failure();
+}
+#endif /* RTOS_STACK_GUARD_MPU */
+
+#if PORT_HAS_FPU || RTOS_STACK_GUARD_MPU
+/* Called from PendSV in place of rtos_kernel_switch_context: the incoming
+ * task's FPU access and stack guard must be in place before its context
+ * (S16-S31 included) is restored. */
+__attribute__((used)) void port_switch_context(void)
+{
+    rtos_kernel_switch_context();
+#if PORT_HAS_FPU
+    port_fpu_select(g_kernel.core[0].current_task);
+#endif
+#if RTOS_STACK_GUARD_MPU
+    port_stack_guard_select(g_kernel.core[0].current_task);
+#endif
+}
+#endif
 
 rtos_status_t rtos_port_init(void)
 {
@@ -85,76 +204,37 @@ uint32_t *rtos_port_init_task_stack(uint32_t *stack_top, rtos_task_function_t ta
     *--stack_ptr = 0; /* R5 */
     *--stack_ptr = 0; /* R4 */
 
-    return stack_ptr;
-}
-
-void rtos_port_enter_critical(void)
-{
-    uint32_t basepri;
-
-    __asm volatile("MRS %0, BASEPRI                    \n" /* Read current BASEPRI */
-                   "MOV R1, %1                         \n" /* Load kernel priority */
-                   "MSR BASEPRI, R1                    \n" /* Set BASEPRI threshold */
-                   "DSB                                \n" /* Data sync barrier */
-                   "ISB                                \n" /* Instruction sync barrier */
-                   : "=r"(basepri)
-                   : "i"(PORT_MAX_INTERRUPT_PRIORITY)
-                   : "r1", "memory");
+    /* Critical-section nesting, restored into g_critical_nesting (popped as R3) */
+    *--stack_ptr = 0;
 
-    g_critical_nesting++;
-
-    if (g_critical_nesting == 1)
-    {
-        g_critical_basepri = basepri;
-    }
+    return stack_ptr;
 }
 
-void rtos_port_exit_critical(void)
+void rtos_port_yield(void)
 {
-    if (g_critical_nesting > 0)
-    {
-        g_critical_nesting--;
-
-        if (g_critical_nesting == 0)
-        {
-            __asm volatile("MSR BASEPRI, %0            \n"
-                           "DSB                        \n"
-                           "ISB                        \n"
-                           :
-                           : "r"(g_critical_basepri)
-                           : "memory");
-        }
-    }
-}
+    SCB->ICSR |= SCB_ICSR_PENDSVSET_Msk;
 
-uint32_t rtos_port_enter_critical_from_isr(void)
-{
-    uint32_t saved_basepri = __get_BASEPRI();
-    __set_BASEPRI(PORT_MAX_INTERRUPT_PRIORITY);
+    /* Memory barrier to ensure write completes */
     __DSB();
     __ISB();
-    return saved_basepri;
 }
 
-void rtos_port_exit_critical_from_isr(uint32_t saved_priority)
+/* No data cache on the M4: DMA and the CPU already agree */
+void rtos_port_dcache_clean(const void *addr, uint32_t size)
 {
-    __set_BASEPRI(saved_priority);
-    __DSB();
-    __ISB();
+    (void) addr;
+    (void) size;
 }
 
-void rtos_port_yield(void)
+void rtos_port_dcache_invalidate(void *addr, uint32_t size)
 {
-    SCB->ICSR |= SCB_ICSR_PENDSVSET_Msk;
-
-    /* Memory barrier to ensure write completes */
-    __DSB();
-    __ISB();
+    (void) addr;
+    (void) size;
 }
 
 __attribute__((__noreturn__)) void rtos_port_start_first_task(void)
 {
-    uint32_t psp_val = ALIGN_DOWN((uint32_t) g_kernel.next_task->stack_pointer, PORT_STACK_ALIGNMENT);
+    uint32_t psp_val = ALIGN_DOWN((uint32_t) g_kernel.core[0].next_task->stack_pointer, PORT_STACK_ALIGNMENT);
 
     /* Set PSP to point to saved registers (R4-R11, R14) */
     __set_PSP(psp_val);
@@ -170,6 +250,12 @@ __attribute__((__noreturn__)) void rtos_port_start_first_task(void)
     __asm volatile("MOV R0, #0       \n"
                    "MSR CONTROL, R0  \n"
                    "ISB              \n");
+
+    port_fpu_select(g_kernel.core[0].next_task);
+#endif
+
+#if RTOS_STACK_GUARD_MPU
+    port_stack_guard_start(g_kernel.core[0].next_task);
 #endif
 
     rtos_port_start_systick();
@@ -195,30 +281,197 @@ void SysTick_Handler(void)
 
 void rtos_port_systick_handler(void)
 {
+    PROF_TRACE_ISR_ENTER();
+
 #if RTOS_PROFILING_SYSTEM_ENABLED
-    static uint32_t last_tick_cycle = 0;
-    uint32_t        now             = DWT->CYCCNT;
+    uint32_t now = DWT->CYCCNT;
 
-    if (last_tick_cycle != 0)
+    if (g_last_tick_cycle != 0)
     {
         uint32_t expected   = SystemCoreClock / RTOS_TICK_RATE_HZ;
-        uint32_t actual     = now - last_tick_cycle;
+        uint32_t actual     = now - g_last_tick_cycle;
         int32_t  jitter     = (int32_t) (actual - expected);
         uint32_t abs_jitter = (jitter < 0) ? (uint32_t) (-jitter) : (uint32_t) jitter;
         rtos_profiling_record(&g_prof_tick_jitter, abs_jitter);
     }
-    last_tick_cycle = now;
+    g_last_tick_cycle = now;
 #endif
 
     rtos_kernel_tick_handler();
+
+    PROF_TRACE_ISR_EXIT();
+}
+
+#if RTOS_TICKLESS_IDLE
+
+/**
+ * Tickless idle using SysTick (runs in WFI sleep mode, so the core clock
+ * and SysTick keep running).  The 24-bit reload bounds a single sleep to
+ * SysTick_LOAD_RELOAD_Msk / cycles_per_tick ticks (~199 ticks at 84 MHz);
+ * longer idle periods simply sleep again.
+ */
+void rtos_port_suppress_ticks_and_sleep(rtos_tick_t expected_idle_ticks)
+{
+    const uint32_t cycles_per_tick = SystemCoreClock / RTOS_TICK_RATE_HZ;
+    const uint32_t max_idle_ticks  = SysTick_LOAD_RELOAD_Msk / cycles_per_tick;
+
+    if (expected_idle_ticks > max_idle_ticks)
+    {
+        expected_idle_ticks = max_idle_ticks;
+    }
+
+    /* Kernel-level interrupts stay masked until the tick count has been
+     * corrected below; the zero-latency tier keeps running throughout. */
+    rtos_port_enter_critical();
+
+    /* Stop SysTick; VAL holds the cycles left in the current tick. Reading
+     * CTRL here also clears COUNTFLAG for the check after wake-up. */
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+
+    uint32_t remaining = SysTick->VAL;
+    if (remaining == 0)
+    {
+        remaining = cycles_per_tick;
+    }
+
+    if (!rtos_kernel_confirm_sleep())
+    {
+        /* A task became ready since the idle task checked: resume the
+         * current tick period where it was stopped. */
+        SysTick->LOAD = remaining - 1U;
+        SysTick->VAL  = 0;
+        SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+        SysTick->LOAD = cycles_per_tick - 1U;
+        rtos_port_exit_critical();
+        return;
+    }
+
+    uint32_t reload = remaining + (cycles_per_tick * (expected_idle_ticks - 1U)) - 1U;
+
+    SysTick->LOAD = reload;
+    SysTick->VAL  = 0;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+
+#if RTOS_PROFILING_SYSTEM_ENABLED
+    uint32_t sleep_start = DWT->CYCCNT;
+#endif
+
+    /* A BASEPRI-masked interrupt cannot end WFI, so sleep with BASEPRI clear and
+     * PRIMASK set: any interrupt wakes the core but none is taken. PRIMASK is
+     * held only across the WFI; the critical tier runs as soon as we wake. */
+    __disable_irq();
+    __set_BASEPRI(0);
+    __DSB();
+    __WFI();
+    __set_BASEPRI(PORT_MAX_INTERRUPT_PRIORITY);
+    __enable_irq();
+    __ISB();
+
+    uint32_t    ctrl = SysTick->CTRL;
+    rtos_tick_t completed_ticks;
+
+    SysTick->CTRL = ctrl & ~SysTick_CTRL_ENABLE_Msk;
+
+    if ((ctrl & SysTick_CTRL_COUNTFLAG_Msk) != 0U)
+    {
+        /* Woken by the programmed deadline.  Its SysTick interrupt is pending
+         * and accounts for the final tick once BASEPRI is cleared. */
+        uint32_t late = reload - SysTick->VAL;
+
+        completed_ticks = expected_idle_ticks - 1U;
+        SysTick->LOAD   = (late < cycles_per_tick - 1U) ? (cycles_per_tick - 1U - late) : (cycles_per_tick - 1U);
+
+#if RTOS_PROFILING_SYSTEM_ENABLED
+        rtos_profiling_record(&g_prof_idle_wake_late, late);
+#endif
+    }
+    else
+    {
+        /* Woken early by another interrupt: count the whole ticks that
+         * elapsed and finish the partial one before the next SysTick. */
+        uint32_t elapsed = reload - SysTick->VAL;
+
+        completed_ticks = elapsed / cycles_per_tick;
+        SysTick->LOAD   = ((completed_ticks + 1U) * cycles_per_tick) - elapsed - 1U;
+    }
+
+    SysTick->VAL = 0;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+    SysTick->LOAD = cycles_per_tick - 1U;
+
+    rtos_kernel_step_tick(completed_ticks);
+
+#if RTOS_PROFILING_SYSTEM_ENABLED
+    rtos_profiling_record(&g_prof_idle_sleep, DWT->CYCCNT - sleep_start);
+    g_prof_idle_sleep_ticks += completed_ticks;
+    g_last_tick_cycle = 0; /* A stretched tick is not jitter */
+#endif
+
+    rtos_port_exit_critical();
+}
+
+#if RTOS_USE_LOW_POWER
+
+/**
+ * Stop / standby.  SysTick freezes with the core clock and resumes its
+ * current period afterwards, so the tick count only gains the whole ticks
+ * the board's wake-up timer measured.  The clocks are restored before
+ * PRIMASK drops, so no handler runs on the wake-up clock.  Standby wakes
+ * through reset and only returns here if it could not be entered.
+ */
+bool rtos_port_deep_sleep(rtos_power_mode_t mode, rtos_tick_t ticks)
+{
+    rtos_port_enter_critical();
+
+    if (!rtos_kernel_confirm_sleep())
+    {
+        rtos_port_exit_critical();
+        return true; /* A task became ready: no sleep needed */
+    }
+
+    if (!hardware_env_power_enter(mode, ticks))
+    {
+        rtos_port_exit_critical();
+        return false;
+    }
+
+    __disable_irq();
+    __set_BASEPRI(0);
+    __DSB();
+    __WFI();
+
+    uint32_t    wake_start  = DWT->CYCCNT;
+    rtos_tick_t slept       = hardware_env_power_exit(mode);
+    uint32_t    wake_cycles = DWT->CYCCNT - wake_start;
+
+    __set_BASEPRI(PORT_MAX_INTERRUPT_PRIORITY);
+    __enable_irq();
+    __ISB();
+
+    rtos_kernel_step_tick(slept);
+    rtos_kernel_power_record(mode, slept, wake_cycles);
+
+#if RTOS_PROFILING_SYSTEM_ENABLED
+    g_last_tick_cycle = 0; /* A frozen tick is not jitter */
+    g_prof_idle_sleep_ticks += slept;
+#endif
+
+    rtos_port_exit_critical();
+    return true;
 }
 
+#endif /* RTOS_USE_LOW_POWER */
+
+#endif /* RTOS_TICKLESS_IDLE */
+
 __attribute__((naked)) void SVC_Handler(void)
 {
     __asm volatile("LDR  R3, =g_kernel       \n" /* Get current TCB address */
                    "LDR  R1, [R3]            \n"
                    "LDR  R0, [R1]            \n" /* First item = stack pointer */
-                   "LDMIA R0!, {R4-R11, R14} \n" /* Restore R4-R11 + EXC_RETURN */
+                   "LDMIA R0!, {R3-R11, R14} \n" /* Restore nesting, R4-R11 + EXC_RETURN */
+                   "LDR  R1, =g_critical_nesting \n"
+                   "STR  R3, [R1]            \n" /* First task starts outside any section */
                    "MSR  PSP, R0             \n" /* Update PSP past restored regs */
                    "ISB                      \n"
                    "MOV  R0, #0              \n" /* Unmask interrupts (BASEPRI = 0) */
@@ -246,15 +499,19 @@ __attribute__((naked)) void PendSV_Handler(void)
         "LDR     R2, [R3]                   \n" /* R2 = current_task TCB */
 
 #if PORT_HAS_FPU
-        /* Conditionally save S16-S31 (callee-saved VFP regs) */
+        /* Conditionally save S16-S31 (callee-saved VFP regs).  The VSTM also
+         * triggers the deferred (LSPEN) save of S0-S15 into the hardware frame.
+         * Tasks that never touch the FPU always take the branch. */
         "TST     R14, #0x10                 \n" /* Bit 4: 0 = FPU frame */
         "BNE     1f                         \n"
         "VSTMDB  R0!, {S16-S31}             \n"
         "1:                                 \n"
 #endif
 
-        /* Save core registers + EXC_RETURN */
-        "STMDB   R0!, {R4-R11, R14}         \n"
+        /* Save critical nesting (as R3) + core registers + EXC_RETURN */
+        "LDR     R1, =g_critical_nesting    \n"
+        "LDR     R3, [R1]                   \n"
+        "STMDB   R0!, {R3-R11, R14}         \n"
 
         /* Store updated SP in current TCB */
         "STR     R0, [R2]                   \n"
@@ -264,17 +521,27 @@ __attribute__((naked)) void PendSV_Handler(void)
         "MSR     BASEPRI, R0                \n"
         "DSB                                \n"
         "ISB                                \n"
+#if PORT_HAS_FPU || RTOS_STACK_GUARD_MPU
+        "BL      port_switch_context        \n" /* Kernel switch + FPU access policy / stack guard */
+#else
         "BL      rtos_kernel_switch_context \n"
-        "MOV     R0, #0                     \n"
-        "MSR     BASEPRI, R0                \n"
+#endif
 
         /* Restore next task context */
         "LDR     R3, =g_kernel              \n"
         "LDR     R2, [R3]                   \n" /* R2 = (new) current_task */
         "LDR     R0, [R2]                   \n" /* R0 = stack_pointer */
 
-        /* Restore core registers + EXC_RETURN */
-        "LDMIA   R0!, {R4-R11, R14}         \n"
+        /* Restore critical nesting (as R3) + core registers + EXC_RETURN */
+        "LDMIA   R0!, {R3-R11, R14}         \n"
+        "LDR     R1, =g_critical_nesting    \n"
+        "STR     R3, [R1]                   \n"
+
+        /* Unmask, unless the incoming task was switched out inside a section */
+        "CMP     R3, #0                     \n"
+        "IT      NE                         \n"
+        "MOVNE   R3, %[max_prio]            \n"
+        "MSR     BASEPRI, R3                \n"
 
 #if PORT_HAS_FPU
         /* Conditionally restore S16-S31 */
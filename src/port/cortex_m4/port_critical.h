@@ -0,0 +1,109 @@
+#ifndef PORT_CRITICAL_H
+#define PORT_CRITICAL_H
+
+#include "port_priv.h"
+#include "rtos_assert.h"
+
+#include <stdint.h>
+
+/**
+ * Cortex-M4 critical sections, inlined into every kernel call through
+ * rtos_port.h.
+ *
+ * BASEPRI masks kernel-level and lower interrupts. A higher BASEPRI takes
+ * effect after the ISB; a lower one lets a pending interrupt in at the
+ * ISB. No DSB is needed: the core is single-issue in-order, and the
+ * "memory" clobber keeps the compiler from moving accesses across the
+ * MSR.
+ *
+ * g_critical_nesting belongs to the running task: PendSV saves it in the
+ * outgoing task's frame and reloads the incoming task's, together with
+ * the BASEPRI that nesting implies.
+ *
+ * Nothing here touches PRIMASK, so interrupts above
+ * PORT_MAX_INTERRUPT_PRIORITY (the zero-latency tier) are never delayed by
+ * the kernel. In exchange they must not call into it: with assertions on,
+ * the _from_isr entry checks the active interrupt's NVIC priority.
+ */
+
+extern volatile uint32_t g_critical_nesting; /**< Running task's nesting depth */
+extern uint32_t          g_critical_basepri; /**< BASEPRI to restore on the outermost exit */
+
+/* Single core: the kernel's per-core state is always entry 0 */
+static inline __attribute__((always_inline)) uint32_t rtos_port_get_core_id(void)
+{
+    return 0U;
+}
+
+static inline __attribute__((always_inline)) void rtos_port_enter_critical(void)
+{
+    uint32_t basepri;
+
+    __asm volatile("MRS %0, BASEPRI \n"
+                   "MSR BASEPRI, %1 \n"
+                   "ISB             \n"
+                   : "=&r"(basepri)
+                   : "r"(PORT_MAX_INTERRUPT_PRIORITY)
+                   : "memory");
+
+    if (g_critical_nesting++ == 0U)
+    {
+        g_critical_basepri = basepri;
+    }
+}
+
+static inline __attribute__((always_inline)) void rtos_port_exit_critical(void)
+{
+    if (g_critical_nesting > 0U && --g_critical_nesting == 0U)
+    {
+        __asm volatile("MSR BASEPRI, %0 \n"
+                       "ISB             \n"
+                       :
+                       : "r"(g_critical_basepri)
+                       : "memory");
+    }
+}
+
+#if RTOS_ASSERT_ENABLED
+static inline __attribute__((always_inline)) void port_assert_isr_priority(void)
+{
+    uint32_t ipsr;
+
+    __asm volatile("MRS %0, IPSR" : "=r"(ipsr));
+
+    /* System exceptions (IPSR < 16) run at kernel level or are fatal */
+    if (ipsr >= 16U)
+    {
+        RTOS_ASSERT(((const volatile uint8_t *) PORT_NVIC_IPR_BASE)[ipsr - 16U] >= PORT_MAX_INTERRUPT_PRIORITY);
+    }
+}
+#endif
+
+static inline __attribute__((always_inline)) uint32_t rtos_port_enter_critical_from_isr(void)
+{
+    uint32_t saved;
+
+#if RTOS_ASSERT_ENABLED
+    port_assert_isr_priority();
+#endif
+
+    __asm volatile("MRS %0, BASEPRI \n"
+                   "MSR BASEPRI, %1 \n"
+                   "ISB             \n"
+                   : "=&r"(saved)
+                   : "r"(PORT_MAX_INTERRUPT_PRIORITY)
+                   : "memory");
+
+    return saved;
+}
+
+static inline __attribute__((always_inline)) void rtos_port_exit_critical_from_isr(uint32_t saved_priority)
+{
+    __asm volatile("MSR BASEPRI, %0 \n"
+                   "ISB             \n"
+                   :
+                   : "r"(saved_priority)
+                   : "memory");
+}
+
+#endif /* PORT_CRITICAL_H */
@@ -17,6 +17,18 @@
 /** This port has a hardware single-precision FPU. */
 #define PORT_HAS_FPU 1
 
+/** CPACR CP10/CP11 full-access bits; cleared while a RTOS_TASK_FLAG_NO_FPU task runs. */
+#define PORT_CPACR_FPU_MASK (0xFU << 20)
+
+/** No data cache: DMA and the CPU always see the same memory. */
+#define PORT_HAS_DCACHE 0
+
+/** LDM/STM multi-word transfers: rtos_mem copies and fills move 8 words per burst. */
+#define PORT_HAS_BLOCK_TRANSFER 1
+
+/** Single core: rtos_port_get_core_id() is always 0. */
+#define PORT_NUM_CORES 1U
+
 /* ======================== Interrupt Priorities =========================== */
 
 /**
@@ -32,6 +44,18 @@
 /** BASEPRI threshold used to mask kernel-level and lower interrupts. */
 #define PORT_MAX_INTERRUPT_PRIORITY PORT_IRQ_PRIORITY_KERNEL
 
+/** NVIC_SetPriority() takes the priority right-shifted by this (4 implemented bits). */
+#define PORT_NVIC_PRIO_SHIFT 4U
+
+/** NVIC_IPR0: one priority byte per external interrupt, indexed by IRQ number. */
+#define PORT_NVIC_IPR_BASE 0xE000E400U
+
+/** True when NVIC priority nvic_prio is masked by the kernel, so its ISR may call _from_isr APIs. */
+#define PORT_IRQ_IS_KERNEL_SAFE(nvic_prio) (((uint32_t) (nvic_prio) << PORT_NVIC_PRIO_SHIFT) >= PORT_MAX_INTERRUPT_PRIORITY)
+
+/** MPU region reserved for the stack guard; the highest number wins where regions overlap. */
+#define PORT_MPU_GUARD_REGION 7U
+
 /** DWT Cycle Count Register address (Cortex-M debug unit). */
 #define PORT_DWT_CYCCNT_ADDR 0xE0001004
 
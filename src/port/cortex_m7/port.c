@@ -0,0 +1,618 @@
+#include "config.h"
+#include "hardware_env.h"
+#include "kernel_priv.h"
+#include "klog.h"
+#include "port_priv.h" /* chip-specific constants (must come first) */
+#include "prof_trace.h"
+#include "profiling.h"
+#define PORT_VERIFY_CONTRACT
+#include "port_common.h" /* contract checks + common types */
+#include "rtos_port.h"
+#include "task.h"
+#include "task_priv.h"
+#include "utils.h"
+
+#include "device.h" // IWYU pragma: keep
+
+/*
+ * Cortex-M7 port. Context switching matches the M4 port frame for frame;
+ * what differs is the memory system around it:
+ *
+ *   - FPv5-D16 double-precision FPU. PendSV saves D8-D15 (= S16-S31) for
+ *     tasks with an FPU frame; lazy stacking covers D0-D7 and FPSCR.
+ *   - PendSV and port_switch_context are RTOS_FAST_CODE, which the board
+ *     maps to ITCM (no flash wait states, no I-cache misses). Kernel data
+ *     lives in DTCM when the board's linker script puts .data/.bss there.
+ *   - D-cache maintenance for DMA buffers through rtos_port_dcache_*().
+ */
+
+/* Declared in port_critical.h; nesting is swapped per task by PendSV */
+volatile uint32_t g_critical_nesting = 0;
+uint32_t          g_critical_basepri = 0;
+
+#if RTOS_PROFILING_SYSTEM_ENABLED
+/* DWT timestamp of the previous SysTick, for jitter measurement */
+static uint32_t g_last_tick_cycle = 0;
+#endif
+
+#if PORT_HAS_FPU
+/* Nonzero while CP10/CP11 access is revoked for a RTOS_TASK_FLAG_NO_FPU task */
+static uint32_t g_fpu_access_off = 0;
+
+/**
+ * Apply the incoming task's FPU policy.  CPACR is only rewritten when the
+ * policy changes, so switches between tasks of the same kind cost a compare.
+ * With access revoked, any FP instruction faults (NOCP) instead of silently
+ * giving the task an extended frame.
+ */
+static inline void port_fpu_select(const rtos_tcb_t *task)
+{
+    uint32_t off = task->flags & RTOS_TASK_FLAG_NO_FPU;
+
+    if (off != g_fpu_access_off)
+    {
+        if (off != 0U)
+        {
+            SCB->CPACR &= ~PORT_CPACR_FPU_MASK;
+        }
+        else
+        {
+            SCB->CPACR |= PORT_CPACR_FPU_MASK;
+        }
+        __DSB();
+        __ISB();
+        g_fpu_access_off = off;
+    }
+}
+
+#endif
+
+#if RTOS_STACK_GUARD_MPU
+RTOS_STATIC_ASSERT(RTOS_STACK_GUARD_SIZE >= 32U && (RTOS_STACK_GUARD_SIZE & (RTOS_STACK_GUARD_SIZE - 1U)) == 0U,
+                   "RTOS_STACK_GUARD_SIZE must be a power of 2 >= 32 (ARMv7-M region rules)");
+RTOS_STATIC_ASSERT(RTOS_MINIMUM_TASK_STACK_SIZE > 2U * RTOS_STACK_GUARD_SIZE,
+                   "the guard is carved from each stack: raise RTOS_MINIMUM_TASK_STACK_SIZE");
+
+/* Guard RASR: enabled, AP = 000 (no access, privileged included), execute-never */
+#define PORT_GUARD_RASR                                                                                    \
+    (MPU_RASR_XN_Msk | ((uint32_t) (__builtin_ctz(RTOS_STACK_GUARD_SIZE) - 1) << MPU_RASR_SIZE_Pos) |      \
+     MPU_RASR_ENABLE_Msk)
+
+/**
+ * Move the guard region onto the incoming task's stack.  A region must be
+ * aligned to its size, so the guard starts at the first such boundary above
+ * the canary word and the canary stays readable by rtos_task_check_stack().
+ * The size and attributes never change, so a switch costs one RBAR store.
+ */
+static inline void port_stack_guard_select(const rtos_tcb_t *task)
+{
+    uint32_t guard = ALIGN_UP((uint32_t) task->stack_base + sizeof(uint32_t), RTOS_STACK_GUARD_SIZE);
+
+    MPU->RBAR = guard | MPU_RBAR_VALID_Msk | PORT_MPU_GUARD_REGION;
+    __DSB(); /* Exception return, or the ISB after it, synchronises the fetch side */
+}
+
+/**
+ * Tasks run privileged, so PRIVDEFENA keeps the default memory map for
+ * everything outside the guard; no other region is needed.
+ */
+static void port_stack_guard_start(const rtos_tcb_t *first)
+{
+    port_stack_guard_select(first);
+    MPU->RASR = PORT_GUARD_RASR;
+    MPU->CTRL = MPU_CTRL_PRIVDEFENA_Msk | MPU_CTRL_ENABLE_Msk;
+    SCB->SHCSR |= SCB_SHCSR_MEMFAULTENA_Msk;
+    __DSB();
+    __ISB();
+}
+
+/**
+ * Only the guard region is defined, so every MemManage fault is a stack
+ * overflow.  The MPU goes off first: a fault raised while stacking the
+ * exception frame leaves PSP inside the guard.  Logs the task and the
+ * faulting address (PSP when MMFAR is not valid), then halts.
+ */
+__attribute__((__noreturn__)) void MemManage_Handler(void)
+{
+    uint32_t cfsr = SCB->CFSR;
+    uint32_t addr = ((cfsr & SCB_CFSR_MMARVALID_Msk) != 0U) ? SCB->MMFAR : __get_PSP();
+
+    MPU->CTRL = 0;
+    __DSB();
+    __ISB();
+
+    const rtos_tcb_t *task = g_kernel.core[0].current_task;
+    KLOGF(KEVT_STACK_OVERFLOW, (task != NULL) ? task->task_id : RTOS_MAX_TASKS, addr);
+    KLOGF(KEVT_HARD_FAULT_SCB, cfsr, SCB->HFSR);
+
+    indicate_system_failure();
+}
+#endif /* RTOS_STACK_GUARD_MPU */
+
+#if RTOS_FAST_CODE_IN_ITCM
+/* Linker-script symbols: .itcm_text run range and its load address in flash */
+extern uint32_t _sitcm[];
+extern uint32_t _eitcm[];
+extern uint32_t _siitcm[];
+
+/**
+ * Copy the RTOS_FAST_CODE functions into ITCM. Runs as a constructor:
+ * after the startup code has set up .data/.bss, before main(), so the
+ * switch path is in place long before the first PendSV. ITCM is not
+ * cached, so no I-cache maintenance is needed.
+ */
+__attribute__((constructor)) static void port_itcm_load(void)
+{
+    const uint32_t *src = _siitcm;
+
+    for (uint32_t *dst = _sitcm; dst < _eitcm; dst++)
+    {
+        *dst = *src++;
+    }
+
+    __DSB();
+    __ISB();
+}
+#endif
+
+#if PORT_HAS_FPU || RTOS_STACK_GUARD_MPU
+/* Called from PendSV in place of rtos_kernel_switch_context: the incoming
+ * task's FPU access and stack guard must be in place before its context
+ * (D8-D15 included) is restored. */
+__attribute__((used)) RTOS_FAST_CODE void port_switch_context(void)
+{
+    rtos_kernel_switch_context();
+#if PORT_HAS_FPU
+    port_fpu_select(g_kernel.core[0].current_task);
+#endif
+#if RTOS_STACK_GUARD_MPU
+    port_stack_guard_select(g_kernel.core[0].current_task);
+#endif
+}
+#endif
+
+rtos_status_t rtos_port_init(void)
+{
+#if PORT_HAS_FPU
+    /**
+     * Enable lazy FPU context stacking.
+     * ASPEN: Automatic State Preservation ENable — hardware reserves FPU
+     *        stack space on exception entry when FPU was in use.
+     * LSPEN: Lazy State Preservation ENable — defer the actual save of
+     *        D0-D7/FPSCR until the ISR first touches the FPU.
+     */
+    FPU->FPCCR |= FPU_FPCCR_ASPEN_Msk | FPU_FPCCR_LSPEN_Msk;
+#endif
+
+    NVIC_SetPriority(PendSV_IRQn, PORT_IRQ_PRIORITY_PENDSV >> 4);  /* Lowest */
+    NVIC_SetPriority(SysTick_IRQn, PORT_IRQ_PRIORITY_KERNEL >> 4); /* Kernel level */
+
+    __set_BASEPRI(0);
+
+    g_critical_nesting = 0;
+    g_critical_basepri = 0;
+
+    KLOGI(KEVT_PORT_INIT, PORT_IRQ_PRIORITY_CRITICAL, PORT_IRQ_PRIORITY_PENDSV);
+
+    return RTOS_SUCCESS;
+}
+
+void rtos_port_start_systick(void)
+{
+    /* Calculate reload value for desired tick rate */
+    uint32_t reload_value = (SystemCoreClock / RTOS_TICK_RATE_HZ) - 1;
+
+    if (SysTick_Config(reload_value) != 0)
+    {
+        KLOGE(KEVT_SYSTICK_FAIL, reload_value, 0);
+        return;
+    }
+
+    NVIC_SetPriority(SysTick_IRQn, PORT_IRQ_PRIORITY_KERNEL >> 4);
+}
+
+uint32_t *rtos_port_init_task_stack(uint32_t *stack_top, rtos_task_function_t task_function, void *parameter)
+{
+    uint32_t *stack_ptr = (uint32_t *) ALIGN_DOWN((uint32_t) stack_top, PORT_STACK_ALIGNMENT);
+
+    /* Initial exception frame */
+    *--stack_ptr = PORT_INITIAL_XPSR;            /* xPSR (Thumb bit set) */
+    *--stack_ptr = (uint32_t) task_function | 1; /* PC (task entry point) */
+    *--stack_ptr = PORT_INITIAL_EXC_RETURN;      /* LR (EXC_RETURN to thread mode with PSP) */
+    *--stack_ptr = 0;                            /* R12 */
+    *--stack_ptr = 0;                            /* R3 */
+    *--stack_ptr = 0;                            /* R2 */
+    *--stack_ptr = 0;                            /* R1 */
+    *--stack_ptr = (uint32_t) parameter;         /* R0 (task parameter) */
+
+    /**
+     * EXC_RETURN value — saved/restored per-task so each task carries its
+     * own FPU-usage indication in bit 4.  Initial value = 0xFFFFFFFD:
+     * thread mode, PSP, no FPU frame.
+     */
+    *--stack_ptr = PORT_INITIAL_EXC_RETURN;
+
+    /* Manually-saved core registers (R4-R11) */
+    *--stack_ptr = 0; /* R11 */
+    *--stack_ptr = 0; /* R10 */
+    *--stack_ptr = 0; /* R9 */
+    *--stack_ptr = 0; /* R8 */
+    *--stack_ptr = 0; /* R7 */
+    *--stack_ptr = 0; /* R6 */
+    *--stack_ptr = 0; /* R5 */
+    *--stack_ptr = 0; /* R4 */
+
+    /* Critical-section nesting, restored into g_critical_nesting (popped as R3) */
+    *--stack_ptr = 0;
+
+    return stack_ptr;
+}
+
+void rtos_port_yield(void)
+{
+    SCB->ICSR |= SCB_ICSR_PENDSVSET_Msk;
+
+    /* Memory barrier to ensure write completes */
+    __DSB();
+    __ISB();
+}
+
+/* By-address maintenance is skipped while the D-cache is off (early boot) */
+void rtos_port_dcache_clean(const void *addr, uint32_t size)
+{
+    if ((SCB->CCR & SCB_CCR_DC_Msk) != 0U)
+    {
+        SCB_CleanDCache_by_Addr((uint32_t *) (uintptr_t) addr, (int32_t) size);
+    }
+}
+
+void rtos_port_dcache_invalidate(void *addr, uint32_t size)
+{
+    RTOS_ASSERT((((uintptr_t) addr | size) & (PORT_DCACHE_LINE_SIZE - 1U)) == 0U);
+
+    if ((SCB->CCR & SCB_CCR_DC_Msk) != 0U)
+    {
+        SCB_InvalidateDCache_by_Addr((uint32_t *) addr, (int32_t) size);
+    }
+}
+
+__attribute__((__noreturn__)) void rtos_port_start_first_task(void)
+{
+    uint32_t psp_val = ALIGN_DOWN((uint32_t) g_kernel.core[0].next_task->stack_pointer, PORT_STACK_ALIGNMENT);
+
+    /* Set PSP to point to saved registers (R4-R11, R14) */
+    __set_PSP(psp_val);
+    __DSB();
+    __ISB();
+
+#if PORT_HAS_FPU
+    /**
+     * Clear the FPCA bit in CONTROL register to prevent the SVC exception
+     * frame from including stale FPU state that may have been used before
+     * the scheduler was started.
+     */
+    __asm volatile("MOV R0, #0       \n"
+                   "MSR CONTROL, R0  \n"
+                   "ISB              \n");
+
+    port_fpu_select(g_kernel.core[0].next_task);
+#endif
+
+#if RTOS_STACK_GUARD_MPU
+    port_stack_guard_start(g_kernel.core[0].next_task);
+#endif
+
+    rtos_port_start_systick();
+
+#if RTOS_PROFILING_SYSTEM_ENABLED
+    rtos_profiling_init();
+#endif
+
+    __asm volatile("svc 0");
+
+    KLOGE(KEVT_ERROR_GENERIC, 0, 0);
+
+    /* Should never reach here */
+    while (1)
+    {
+    }
+}
+
+void SysTick_Handler(void)
+{
+    rtos_port_systick_handler();
+}
+
+void rtos_port_systick_handler(void)
+{
+    PROF_TRACE_ISR_ENTER();
+
+#if RTOS_PROFILING_SYSTEM_ENABLED
+    uint32_t now = DWT->CYCCNT;
+
+    if (g_last_tick_cycle != 0)
+    {
+        uint32_t expected   = SystemCoreClock / RTOS_TICK_RATE_HZ;
+        uint32_t actual     = now - g_last_tick_cycle;
+        int32_t  jitter     = (int32_t) (actual - expected);
+        uint32_t abs_jitter = (jitter < 0) ? (uint32_t) (-jitter) : (uint32_t) jitter;
+        rtos_profiling_record(&g_prof_tick_jitter, abs_jitter);
+    }
+    g_last_tick_cycle = now;
+#endif
+
+    rtos_kernel_tick_handler();
+
+    PROF_TRACE_ISR_EXIT();
+}
+
+#if RTOS_TICKLESS_IDLE
+
+/**
+ * Tickless idle using SysTick (runs in WFI sleep mode, so the core clock
+ * and SysTick keep running).  The 24-bit reload bounds a single sleep to
+ * SysTick_LOAD_RELOAD_Msk / cycles_per_tick ticks (~262 ticks at 64 MHz);
+ * longer idle periods simply sleep again.
+ */
+void rtos_port_suppress_ticks_and_sleep(rtos_tick_t expected_idle_ticks)
+{
+    const uint32_t cycles_per_tick = SystemCoreClock / RTOS_TICK_RATE_HZ;
+    const uint32_t max_idle_ticks  = SysTick_LOAD_RELOAD_Msk / cycles_per_tick;
+
+    if (expected_idle_ticks > max_idle_ticks)
+    {
+        expected_idle_ticks = max_idle_ticks;
+    }
+
+    /* Kernel-level interrupts stay masked until the tick count has been
+     * corrected below; the zero-latency tier keeps running throughout. */
+    rtos_port_enter_critical();
+
+    /* Stop SysTick; VAL holds the cycles left in the current tick. Reading
+     * CTRL here also clears COUNTFLAG for the check after wake-up. */
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+
+    uint32_t remaining = SysTick->VAL;
+    if (remaining == 0)
+    {
+        remaining = cycles_per_tick;
+    }
+
+    if (!rtos_kernel_confirm_sleep())
+    {
+        /* A task became ready since the idle task checked: resume the
+         * current tick period where it was stopped. */
+        SysTick->LOAD = remaining - 1U;
+        SysTick->VAL  = 0;
+        SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+        SysTick->LOAD = cycles_per_tick - 1U;
+        rtos_port_exit_critical();
+        return;
+    }
+
+    uint32_t reload = remaining + (cycles_per_tick * (expected_idle_ticks - 1U)) - 1U;
+
+    SysTick->LOAD = reload;
+    SysTick->VAL  = 0;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+
+#if RTOS_PROFILING_SYSTEM_ENABLED
+    uint32_t sleep_start = DWT->CYCCNT;
+#endif
+
+    /* A BASEPRI-masked interrupt cannot end WFI, so sleep with BASEPRI clear and
+     * PRIMASK set: any interrupt wakes the core but none is taken. PRIMASK is
+     * held only across the WFI; the critical tier runs as soon as we wake. */
+    __disable_irq();
+    __set_BASEPRI(0);
+    __DSB();
+    __WFI();
+    __set_BASEPRI(PORT_MAX_INTERRUPT_PRIORITY);
+    __enable_irq();
+    __ISB();
+
+    uint32_t    ctrl = SysTick->CTRL;
+    rtos_tick_t completed_ticks;
+
+    SysTick->CTRL = ctrl & ~SysTick_CTRL_ENABLE_Msk;
+
+    if ((ctrl & SysTick_CTRL_COUNTFLAG_Msk) != 0U)
+    {
+        /* Woken by the programmed deadline.  Its SysTick interrupt is pending
+         * and accounts for the final tick once BASEPRI is cleared. */
+        uint32_t late = reload - SysTick->VAL;
+
+        completed_ticks = expected_idle_ticks - 1U;
+        SysTick->LOAD   = (late < cycles_per_tick - 1U) ? (cycles_per_tick - 1U - late) : (cycles_per_tick - 1U);
+
+#if RTOS_PROFILING_SYSTEM_ENABLED
+        rtos_profiling_record(&g_prof_idle_wake_late, late);
+#endif
+    }
+    else
+    {
+        /* Woken early by another interrupt: count the whole ticks that
+         * elapsed and finish the partial one before the next SysTick. */
+        uint32_t elapsed = reload - SysTick->VAL;
+
+        completed_ticks = elapsed / cycles_per_tick;
+        SysTick->LOAD   = ((completed_ticks + 1U) * cycles_per_tick) - elapsed - 1U;
+    }
+
+    SysTick->VAL = 0;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+    SysTick->LOAD = cycles_per_tick - 1U;
+
+    rtos_kernel_step_tick(completed_ticks);
+
+#if RTOS_PROFILING_SYSTEM_ENABLED
+    rtos_profiling_record(&g_prof_idle_sleep, DWT->CYCCNT - sleep_start);
+    g_prof_idle_sleep_ticks += completed_ticks;
+    g_last_tick_cycle = 0; /* A stretched tick is not jitter */
+#endif
+
+    rtos_port_exit_critical();
+}
+
+#if RTOS_USE_LOW_POWER
+
+/**
+ * Stop / standby.  SysTick freezes with the core clock and resumes its
+ * current period afterwards, so the tick count only gains the whole ticks
+ * the board's wake-up timer measured.  The clocks are restored before
+ * PRIMASK drops, so no handler runs on the wake-up clock.  Standby wakes
+ * through reset and only returns here if it could not be entered.
+ */
+bool rtos_port_deep_sleep(rtos_power_mode_t mode, rtos_tick_t ticks)
+{
+    rtos_port_enter_critical();
+
+    if (!rtos_kernel_confirm_sleep())
+    {
+        rtos_port_exit_critical();
+        return true; /* A task became ready: no sleep needed */
+    }
+
+    if (!hardware_env_power_enter(mode, ticks))
+    {
+        rtos_port_exit_critical();
+        return false;
+    }
+
+    __disable_irq();
+    __set_BASEPRI(0);
+    __DSB();
+    __WFI();
+
+    uint32_t    wake_start  = DWT->CYCCNT;
+    rtos_tick_t slept       = hardware_env_power_exit(mode);
+    uint32_t    wake_cycles = DWT->CYCCNT - wake_start;
+
+    __set_BASEPRI(PORT_MAX_INTERRUPT_PRIORITY);
+    __enable_irq();
+    __ISB();
+
+    rtos_kernel_step_tick(slept);
+    rtos_kernel_power_record(mode, slept, wake_cycles);
+
+#if RTOS_PROFILING_SYSTEM_ENABLED
+    g_last_tick_cycle = 0; /* A frozen tick is not jitter */
+    g_prof_idle_sleep_ticks += slept;
+#endif
+
+    rtos_port_exit_critical();
+    return true;
+}
+
+#endif /* RTOS_USE_LOW_POWER */
+
+#endif /* RTOS_TICKLESS_IDLE */
+
+__attribute__((naked)) void SVC_Handler(void)
+{
+    __asm volatile("LDR  R3, =g_kernel       \n" /* Get current TCB address */
+                   "LDR  R1, [R3]            \n"
+                   "LDR  R0, [R1]            \n" /* First item = stack pointer */
+                   "LDMIA R0!, {R3-R11, R14} \n" /* Restore nesting, R4-R11 + EXC_RETURN */
+                   "LDR  R1, =g_critical_nesting \n"
+                   "STR  R3, [R1]            \n" /* First task starts outside any section */
+                   "MSR  PSP, R0             \n" /* Update PSP past restored regs */
+                   "ISB                      \n"
+                   "MOV  R0, #0              \n" /* Unmask interrupts (BASEPRI = 0) */
+                   "MSR  BASEPRI, R0         \n"
+                   "BX   R14                 \n" /* Return to thread mode */
+                   ::
+                       : "memory");
+}
+
+__attribute__((naked)) RTOS_FAST_CODE void PendSV_Handler(void)
+{
+    __asm volatile(
+#if RTOS_PROFILING_SYSTEM_ENABLED
+        /* Capture DWT->CYCCNT at entry and store in global */
+        "LDR     R1, =%[cyccnt_addr]        \n"
+        "LDR     R2, [R1]                   \n" /* R2 = start cycle count */
+        "LDR     R3, =g_pendsv_start_cycles \n"
+        "STR     R2, [R3]                   \n"
+#endif
+        "MRS     R0, PSP                    \n" /* Get current PSP */
+        "ISB                                \n"
+
+        /* Save current task context */
+        "LDR     R3, =g_kernel              \n"
+        "LDR     R2, [R3]                   \n" /* R2 = current_task TCB */
+
+#if PORT_HAS_FPU
+        /* Conditionally save D8-D15 (callee-saved VFP regs).  The VSTM also
+         * triggers the deferred (LSPEN) save of D0-D7 into the hardware frame.
+         * Tasks that never touch the FPU always take the branch. */
+        "TST     R14, #0x10                 \n" /* Bit 4: 0 = FPU frame */
+        "BNE     1f                         \n"
+        "VSTMDB  R0!, {D8-D15}              \n"
+        "1:                                 \n"
+#endif
+
+        /* Save critical nesting (as R3) + core registers + EXC_RETURN */
+        "LDR     R1, =g_critical_nesting    \n"
+        "LDR     R3, [R1]                   \n"
+        "STMDB   R0!, {R3-R11, R14}         \n"
+
+        /* Store updated SP in current TCB */
+        "STR     R0, [R2]                   \n"
+
+        /* Call scheduler under BASEPRI protection */
+        "MOV     R0, %[max_prio]            \n"
+        "MSR     BASEPRI, R0                \n"
+        "DSB                                \n"
+        "ISB                                \n"
+#if PORT_HAS_FPU || RTOS_STACK_GUARD_MPU
+        "BL      port_switch_context        \n" /* Kernel switch + FPU access policy / stack guard */
+#else
+        "BL      rtos_kernel_switch_context \n"
+#endif
+
+        /* Restore next task context */
+        "LDR     R3, =g_kernel              \n"
+        "LDR     R2, [R3]                   \n" /* R2 = (new) current_task */
+        "LDR     R0, [R2]                   \n" /* R0 = stack_pointer */
+
+        /* Restore critical nesting (as R3) + core registers + EXC_RETURN */
+        "LDMIA   R0!, {R3-R11, R14}         \n"
+        "LDR     R1, =g_critical_nesting    \n"
+        "STR     R3, [R1]                   \n"
+
+        /* Unmask, unless the incoming task was switched out inside a section */
+        "CMP     R3, #0                     \n"
+        "IT      NE                         \n"
+        "MOVNE   R3, %[max_prio]            \n"
+        "MSR     BASEPRI, R3                \n"
+
+#if PORT_HAS_FPU
+        /* Conditionally restore D8-D15 */
+        "TST     R14, #0x10                 \n"
+        "BNE     2f                         \n"
+        "VLDMIA  R0!, {D8-D15}              \n"
+        "2:                                 \n"
+#endif
+
+#if RTOS_PROFILING_SYSTEM_ENABLED
+        /* Compute full PendSV elapsed cycles and store */
+        "LDR     R1, =%[cyccnt_addr]        \n"
+        "LDR     R2, [R1]                   \n" /* R2 = end cycle count */
+        "LDR     R1, =g_pendsv_start_cycles \n"
+        "LDR     R3, [R1]                   \n" /* R3 = start cycle count */
+        "SUB     R2, R2, R3                 \n" /* R2 = elapsed */
+        "LDR     R1, =g_pendsv_cycles       \n"
+        "STR     R2, [R1]                   \n"
+#endif
+
+        "MSR     PSP, R0                    \n"
+        "ISB                                \n"
+        "BX      R14                        \n" /* Per-task EXC_RETURN */
+        :
+        : [max_prio] "i"(PORT_MAX_INTERRUPT_PRIORITY),
+#if RTOS_PROFILING_SYSTEM_ENABLED
+          [cyccnt_addr] "i"(PORT_DWT_CYCCNT_ADDR)
+#endif
+        : "memory");
+}
@@ -0,0 +1,81 @@
+#ifndef PORT_PRIV_H
+#define PORT_PRIV_H
+
+#include "config.h" // IWYU pragma: keep
+
+/* These macros are enforced by port_common.h's PORT_VERIFY_CONTRACT check. */
+
+/** Stack alignment requirement (AAPCS mandates 8-byte alignment). */
+#define PORT_STACK_ALIGNMENT 8
+
+/**
+ * Initial EXC_RETURN pushed onto every new task stack.
+ * 0xFFFFFFFD = return to Thread mode, use PSP, no FPU frame.
+ */
+#define PORT_INITIAL_EXC_RETURN 0xFFFFFFFD
+
+/**
+ * This port has a hardware double-precision FPU (FPv5-D16). D0-D15 alias
+ * S0-S31, so the lazily stacked and callee-saved sets match the M4's.
+ */
+#define PORT_HAS_FPU 1
+
+/** CPACR CP10/CP11 full-access bits; cleared while a RTOS_TASK_FLAG_NO_FPU task runs. */
+#define PORT_CPACR_FPU_MASK (0xFU << 20)
+
+/** Write-back data cache: DMA buffers in cached RAM need rtos_port_dcache_*(). */
+#define PORT_HAS_DCACHE 1
+
+/** LDM/STM multi-word transfers: rtos_mem copies and fills move 8 words per burst. */
+#define PORT_HAS_BLOCK_TRANSFER 1
+
+/** D-cache line size; buffers passed to rtos_port_dcache_invalidate() are aligned to it. */
+#define PORT_DCACHE_LINE_SIZE 32U
+
+/** Single core: rtos_port_get_core_id() is always 0. */
+#define PORT_NUM_CORES 1U
+
+/**
+ * ARM erratum 837070 (r0p1 cores, e.g. STM32F74x/F75x): raising BASEPRI may
+ * let one more interrupt in. Set to 1 on those parts to bracket the write
+ * with CPSID/CPSIE, at the cost of a few PRIMASK cycles on every entry.
+ * STM32H7 cores are r1p1 and leave it off.
+ */
+#ifndef PORT_CM7_ERRATUM_837070
+#define PORT_CM7_ERRATUM_837070 0
+#endif
+
+/* ======================== Interrupt Priorities =========================== */
+
+/**
+ * STM32 Cortex-M7 parts use 4-bit priority (16 levels) in the upper nibble
+ * of an 8-bit field. Lower numeric value = higher priority.
+ */
+#define PORT_IRQ_PRIORITY_CRITICAL (0x00) /**< Never masked (DMA, critical timers) */
+#define PORT_IRQ_PRIORITY_HIGH     (0x40) /**< Can preempt RTOS (UART RX, SPI) */
+#define PORT_IRQ_PRIORITY_KERNEL   (0x80) /**< SysTick */
+#define PORT_IRQ_PRIORITY_LOW      (0xC0) /**< Non-critical peripherals */
+#define PORT_IRQ_PRIORITY_PENDSV   (0xF0) /**< PendSV (lowest — late reschedule) */
+
+/** BASEPRI threshold used to mask kernel-level and lower interrupts. */
+#define PORT_MAX_INTERRUPT_PRIORITY PORT_IRQ_PRIORITY_KERNEL
+
+/** NVIC_SetPriority() takes the priority right-shifted by this (4 implemented bits). */
+#define PORT_NVIC_PRIO_SHIFT 4U
+
+/** NVIC_IPR0: one priority byte per external interrupt, indexed by IRQ number. */
+#define PORT_NVIC_IPR_BASE 0xE000E400U
+
+/** True when NVIC priority nvic_prio is masked by the kernel, so its ISR may call _from_isr APIs. */
+#define PORT_IRQ_IS_KERNEL_SAFE(nvic_prio) (((uint32_t) (nvic_prio) << PORT_NVIC_PRIO_SHIFT) >= PORT_MAX_INTERRUPT_PRIORITY)
+
+/** MPU region reserved for the stack guard; the highest number wins where regions overlap. */
+#define PORT_MPU_GUARD_REGION 15U /* 16-region MPU */
+
+/** DWT Cycle Count Register address (Cortex-M debug unit). */
+#define PORT_DWT_CYCCNT_ADDR 0xE0001004
+
+/** xPSR initial value (Thumb bit set). */
+#define PORT_INITIAL_XPSR 0x01000000
+
+#endif /* PORT_PRIV_H */
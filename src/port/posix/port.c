@@ -0,0 +1,620 @@
+#include "config.h"
+#include "hardware_env.h"
+#include "kernel_priv.h"
+#include "klog.h"
+#include "port_priv.h" /* chip-specific constants (must come first) */
+#include "prof_trace.h"
+#include "profiling.h"
+#define PORT_VERIFY_CONTRACT
+#include "port_common.h" /* contract checks + common types */
+#include "rtos_port.h"
+#include "task.h"
+#include "task_priv.h"
+#include "utils.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/time.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#include "device.h" // IWYU pragma: keep
+
+/*
+ * POSIX simulation port: the kernel runs unmodified in one host thread.
+ *
+ * Interrupts are emulated. SIGALRM is SysTick, NVIC_SetPendingIRQ() raises
+ * one of the SWIn lines and rtos_port_yield() pends PendSV. Each sets its
+ * bit in g_port_pending; port_dispatch() runs them lowest bit first, so
+ * PendSV comes last, whenever the kernel mask is down: straight from the
+ * signal handler, or at the outermost rtos_port_exit_critical().
+ *
+ * A task is a ucontext on a host stack. PendSV asks rtos_kernel_switch_context()
+ * for the next task and swapcontext()s to it, so every switched-out task
+ * sits inside port_dispatch() and carries on from there when resumed, as a
+ * Cortex-M task does from its PendSV frame.
+ *
+ * With RTOS_SMP_CORES = 2 the cores take turns on the host thread. Each
+ * keeps its running context, pending bits and exclusive monitor in
+ * g_port_cores[] while the other runs; the switch is one more pending bit,
+ * after PendSV, so it only happens outside every critical section and
+ * interrupt. SysTick goes to core 0 and offers the other core a turn, which
+ * gives the cores alternate ticks while both are busy; an idle core hands
+ * the thread over in __WFI(). A core keeps its monitor across the other's
+ * turn, as it would on silicon, and __STREXW offers the other core a turn
+ * before it stores, so a lock-free path that races between the cores can
+ * lose here too (port_posix_exclusive_window()).
+ */
+
+#if RTOS_TICKLESS_IDLE
+#error "the POSIX port has no tickless idle: build with RTOS_TICKLESS_IDLE=0"
+#endif
+
+#if RTOS_STACK_GUARD_MPU
+#error "the POSIX port has no MPU: build with RTOS_STACK_GUARD_MPU=0"
+#endif
+
+/* g_port_pending bits; SysTick, PendSV and the core switch cannot be disabled */
+#define PORT_PEND_SWI(n)  (1UL << (n))
+#define PORT_PEND_SYSTICK (1UL << 29)
+#define PORT_PEND_PENDSV  (1UL << 30)
+#define PORT_PEND_SWITCH  (1UL << 31)
+#define PORT_PEND_SYSTEM  (PORT_PEND_SYSTICK | PORT_PEND_PENDSV | PORT_PEND_SWITCH)
+
+/* IPSR values, numbered as on Cortex-M */
+#define PORT_EXC_PENDSV  14U
+#define PORT_EXC_SYSTICK 15U
+#define PORT_EXC_IRQ0    16U
+
+/** A task's host execution context. */
+typedef struct
+{
+    ucontext_t           uc;
+    rtos_task_function_t function;
+    void                *parameter;
+} port_context_t;
+
+#if RTOS_SMP_CORES > 1
+/** A simulated core's state while the other core has the host thread. */
+typedef struct
+{
+    port_context_t   *running;         /**< Its task; NULL while it boots */
+    volatile uint32_t pending;         /**< Interrupts pended for it meanwhile */
+    uintptr_t         exclusive_addr;  /**< Its exclusive monitor */
+    uint32_t          exclusive_value;
+    bool              started;         /**< Go when it next gets the thread */
+    volatile bool     waiting;         /**< In __WFI() with nothing pending */
+} port_core_t;
+#endif
+
+/* Declared in port_critical.h and device.h */
+volatile uint32_t  g_critical_nesting = 0;
+volatile uint32_t  g_port_pending     = 0;
+volatile uint32_t  g_port_active_irq  = 0;
+volatile uint32_t  g_port_primask     = 0;
+volatile uintptr_t g_port_exclusive_addr;
+uint32_t           g_port_exclusive_value;
+uint32_t           SystemCoreClock = RTOS_SYSTEM_CLOCK_HZ;
+DWT_Type           g_port_dwt;
+CoreDebug_Type     g_port_core_debug;
+
+/* Enabled SWIn lines (NVIC_EnableIRQ) */
+static volatile uint32_t g_port_irq_enabled = 0;
+
+/* Context executing now; NULL until the first task starts */
+static port_context_t *volatile g_port_running = NULL;
+
+static port_context_t g_port_contexts[PORT_POSIX_MAX_CONTEXTS];
+static uint8_t        g_port_stacks[PORT_POSIX_MAX_CONTEXTS][PORT_POSIX_TASK_STACK_SIZE] __attribute__((aligned(16)));
+
+#if RTOS_SMP_CORES > 1
+volatile uint32_t g_port_core = 0;
+
+static port_core_t g_port_cores[RTOS_SMP_CORES];
+
+/* Where a secondary core starts: rtos_kernel_start_core() on its own stack */
+static ucontext_t g_port_boot_uc[RTOS_SMP_CORES];
+static uint8_t    g_port_boot_stacks[RTOS_SMP_CORES][PORT_POSIX_TASK_STACK_SIZE] __attribute__((aligned(16)));
+#endif
+
+/* Handlers for the emulated lines, NULL unless the application defines them */
+extern void SWI0_IRQHandler(void) __attribute__((weak));
+extern void SWI1_IRQHandler(void) __attribute__((weak));
+extern void SWI2_IRQHandler(void) __attribute__((weak));
+extern void SWI3_IRQHandler(void) __attribute__((weak));
+extern void TIM5_IRQHandler(void) __attribute__((weak));
+
+static void (*const g_port_vectors[PORT_POSIX_NUM_IRQS])(void) = {
+    SWI0_IRQHandler,
+    SWI1_IRQHandler,
+    SWI2_IRQHandler,
+    SWI3_IRQHandler,
+    TIM5_IRQHandler,
+};
+
+#if RTOS_PROFILING_SYSTEM_ENABLED
+/* DWT timestamp of the previous SysTick, for jitter measurement */
+static uint32_t g_last_tick_cycle = 0;
+#endif
+
+/* PendSV: hand the CPU to the kernel's new current task */
+static void port_pendsv(void)
+{
+#if RTOS_PROFILING_SYSTEM_ENABLED
+    g_pendsv_start_cycles = DWT->CYCCNT;
+#endif
+
+    port_context_t *from = g_port_running;
+
+    rtos_kernel_switch_context();
+
+    port_context_t *to = (port_context_t *) rtos_kernel_this_core()->current_task->stack_pointer;
+
+    if (to != from)
+    {
+        g_port_running = to;
+        swapcontext(&from->uc, &to->uc);
+    }
+
+#if RTOS_PROFILING_SYSTEM_ENABLED
+    g_pendsv_cycles = DWT->CYCCNT - g_pendsv_start_cycles;
+#endif
+}
+
+#if RTOS_SMP_CORES > 1
+/* Next core with something to do, or the calling core if there is none */
+static uint32_t port_next_core(void)
+{
+    for (uint32_t i = 1; i < RTOS_SMP_CORES; i++)
+    {
+        uint32_t           c    = (g_port_core + i) % RTOS_SMP_CORES;
+        const port_core_t *core = &g_port_cores[c];
+
+        if (core->started && (!core->waiting || core->pending != 0U))
+        {
+            return c;
+        }
+    }
+
+    return g_port_core;
+}
+
+/**
+ * Hand the host thread to the next core with work; returns when a core hands
+ * it back. Signals are blocked while g_port_core and the state move, so a
+ * signal never pends for the wrong core.
+ */
+static void port_switch_core(void)
+{
+    uint32_t next = port_next_core();
+    if (next == g_port_core)
+    {
+        return;
+    }
+
+    sigset_t all;
+    sigset_t saved;
+    sigfillset(&all);
+    sigprocmask(SIG_BLOCK, &all, &saved);
+
+    port_core_t *from = &g_port_cores[g_port_core];
+    port_core_t *to   = &g_port_cores[next];
+
+    from->running         = g_port_running;
+    from->exclusive_addr  = g_port_exclusive_addr;
+    from->exclusive_value = g_port_exclusive_value;
+    __atomic_fetch_or(&from->pending, __atomic_exchange_n(&g_port_pending, 0U, __ATOMIC_SEQ_CST), __ATOMIC_SEQ_CST);
+
+    g_port_core            = next;
+    to->waiting            = false;
+    g_port_running         = to->running;
+    g_port_exclusive_addr  = to->exclusive_addr;
+    g_port_exclusive_value = to->exclusive_value;
+    g_port_pending         = __atomic_exchange_n(&to->pending, 0U, __ATOMIC_SEQ_CST);
+
+    swapcontext(&from->running->uc, (to->running != NULL) ? &to->running->uc : &g_port_boot_uc[next]);
+
+    sigprocmask(SIG_SETMASK, &saved, NULL);
+}
+#endif
+
+/**
+ * Run every pending, enabled interrupt, one at a time. Entered with the
+ * kernel mask down; a signal arriving between two interrupts finds
+ * g_port_active_irq clear and simply runs the loop itself.
+ */
+static void port_dispatch(void)
+{
+    while (1)
+    {
+        uint32_t pending = g_port_pending & (g_port_irq_enabled | PORT_PEND_SYSTEM);
+
+        if (g_port_running == NULL)
+        {
+            pending &= ~(PORT_PEND_PENDSV | PORT_PEND_SWITCH); /* No task to switch away from yet */
+        }
+        if (pending == 0U)
+        {
+            return;
+        }
+
+        uint32_t bit = pending & (~pending + 1U);
+        uint32_t n   = (uint32_t) __builtin_ctz(bit);
+
+        /* A signal between the read and here may have run it already */
+        if ((__atomic_fetch_and(&g_port_pending, ~bit, __ATOMIC_SEQ_CST) & bit) == 0U)
+        {
+            continue;
+        }
+
+#if RTOS_SMP_CORES > 1
+        /* Not an exception on this core: its monitor goes with it */
+        if (bit == PORT_PEND_SWITCH)
+        {
+            port_switch_core();
+            continue;
+        }
+#endif
+        g_port_exclusive_addr = 0U; /* Exception entry clears the exclusive monitor */
+
+        if (bit == PORT_PEND_PENDSV)
+        {
+            g_port_active_irq = PORT_EXC_PENDSV;
+            port_pendsv();
+        }
+        else if (bit == PORT_PEND_SYSTICK)
+        {
+            g_port_active_irq = PORT_EXC_SYSTICK;
+            rtos_port_systick_handler();
+        }
+        else if (g_port_vectors[n] != NULL)
+        {
+            g_port_active_irq = PORT_EXC_IRQ0 + n;
+            g_port_vectors[n]();
+        }
+
+        g_port_active_irq = 0U;
+    }
+}
+
+void port_posix_service_pending(void)
+{
+    if (g_port_active_irq == 0U && g_critical_nesting == 0U && g_port_primask == 0U)
+    {
+        port_dispatch();
+    }
+}
+
+static void port_pend(uint32_t bit)
+{
+    __atomic_fetch_or(&g_port_pending, bit, __ATOMIC_SEQ_CST);
+    port_posix_service_pending();
+}
+
+#if RTOS_SMP_CORES > 1
+/* Pend on a core; one without the host thread gets it at the next switch */
+static void port_pend_core(uint32_t core, uint32_t bit)
+{
+    if (core == g_port_core)
+    {
+        port_pend(bit);
+    }
+    else
+    {
+        __atomic_fetch_or(&g_port_cores[core].pending, bit, __ATOMIC_SEQ_CST);
+        port_pend(PORT_PEND_SWITCH);
+    }
+}
+#endif
+
+void port_posix_set_pending_irq(IRQn_Type irq)
+{
+    if (irq == PendSV_IRQn)
+    {
+        port_pend(PORT_PEND_PENDSV);
+    }
+    else if (irq == SysTick_IRQn)
+    {
+        port_pend(PORT_PEND_SYSTICK);
+    }
+    else if ((uint32_t) irq < PORT_POSIX_NUM_IRQS)
+    {
+        port_pend(PORT_PEND_SWI(irq));
+    }
+}
+
+void port_posix_enable_irq(IRQn_Type irq, uint32_t enable)
+{
+    if ((uint32_t) irq >= PORT_POSIX_NUM_IRQS)
+    {
+        return;
+    }
+
+    if (enable != 0U)
+    {
+        __atomic_fetch_or(&g_port_irq_enabled, PORT_PEND_SWI(irq), __ATOMIC_SEQ_CST);
+        port_posix_service_pending(); /* A line pended while disabled runs now */
+    }
+    else
+    {
+        __atomic_fetch_and(&g_port_irq_enabled, ~PORT_PEND_SWI(irq), __ATOMIC_SEQ_CST);
+    }
+}
+
+/* Any signal ends the wait. One arriving just before pause() is taken
+ * first; the wait then lasts until the next tick, as a late WFI would. */
+void port_posix_wait_for_interrupt(void)
+{
+#if RTOS_SMP_CORES > 1
+    /* Lend the thread to a core with work; it comes back with an interrupt */
+    g_port_cores[g_port_core].waiting = true;
+    if (port_next_core() != g_port_core)
+    {
+        port_pend(PORT_PEND_SWITCH);
+        g_port_cores[g_port_core].waiting = false;
+        return;
+    }
+    g_port_cores[g_port_core].waiting = false;
+#endif
+
+    pause();
+}
+
+static void port_sigalrm_handler(int signo)
+{
+    int saved_errno = errno;
+
+    (void) signo;
+#if RTOS_SMP_CORES > 1
+    port_pend_core(0U, PORT_PEND_SYSTICK);
+    port_pend(PORT_PEND_SWITCH);
+#else
+    port_pend(PORT_PEND_SYSTICK);
+#endif
+
+    errno = saved_errno;
+}
+
+/**
+ * Called by __STREXW before the store. With two cores the other one runs
+ * here, if it has work and is not inside a window of its own, as it could
+ * between the checks and the store on silicon: a lock-free path that is
+ * only safe on one core fails the SMP tests instead of waiting for a tick
+ * to land in its window.
+ */
+void port_posix_exclusive_window(void)
+{
+#if RTOS_SMP_CORES > 1
+    uint32_t next = port_next_core();
+
+    if (next != g_port_core && g_port_cores[next].exclusive_addr == 0U)
+    {
+        port_pend(PORT_PEND_SWITCH);
+    }
+#endif
+}
+
+/* First run of a task, entered from port_pendsv() through swapcontext() */
+static void port_task_entry(void)
+{
+    port_context_t *self = g_port_running;
+
+    /* Finish the PendSV that switched here, as the exception return would */
+    g_port_active_irq = 0U;
+    port_posix_service_pending();
+
+    self->function(self->parameter);
+
+    /* A task function must not return: there is no caller to go back to */
+    const rtos_tcb_t *task = rtos_kernel_this_core()->current_task;
+    KLOGF(KEVT_ERROR_GENERIC, (task != NULL) ? task->task_id : RTOS_MAX_TASKS, 0);
+    indicate_system_failure();
+}
+
+/* ctx is running on some core */
+static bool port_context_running(const port_context_t *ctx)
+{
+#if RTOS_SMP_CORES > 1
+    for (uint32_t c = 0; c < RTOS_SMP_CORES; c++)
+    {
+        if (c != g_port_core && g_port_cores[c].running == ctx)
+        {
+            return true;
+        }
+    }
+#endif
+
+    return ctx == g_port_running;
+}
+
+/**
+ * A host stack is free once no live task's stack_pointer refers to it and
+ * it is not running (a task that deleted itself runs until it switches
+ * out). Called with the critical section held by rtos_task_create().
+ */
+static port_context_t *port_context_alloc(void)
+{
+    for (uint32_t c = 0; c < PORT_POSIX_MAX_CONTEXTS; c++)
+    {
+        port_context_t *ctx  = &g_port_contexts[c];
+        bool            used = port_context_running(ctx);
+
+        for (uint32_t i = 0; i < RTOS_MAX_TASKS && !used; i++)
+        {
+            used = (g_task_cold_pool[i].task_function != NULL && g_task_pool[i].stack_pointer == (uint32_t *) ctx);
+        }
+
+        if (!used)
+        {
+            return ctx;
+        }
+    }
+
+    return NULL;
+}
+
+rtos_status_t rtos_port_init(void)
+{
+    struct sigaction action = {0};
+
+    action.sa_handler = port_sigalrm_handler;
+    action.sa_flags   = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+
+    if (sigaction(SIGALRM, &action, NULL) != 0)
+    {
+        return RTOS_ERROR_GENERAL;
+    }
+
+    g_critical_nesting = 0;
+    g_port_pending     = 0;
+    g_port_active_irq  = 0;
+    g_port_primask     = 0;
+
+#if RTOS_SMP_CORES > 1
+    g_port_core = 0;
+    memset(g_port_cores, 0, sizeof(g_port_cores));
+    g_port_cores[0].started = true;
+#endif
+
+    KLOGI(KEVT_PORT_INIT, PORT_IRQ_PRIORITY_CRITICAL, PORT_IRQ_PRIORITY_PENDSV);
+
+    return RTOS_SUCCESS;
+}
+
+void rtos_port_start_systick(void)
+{
+    struct itimerval timer = {0};
+
+    timer.it_interval.tv_usec = 1000000 / RTOS_TICK_RATE_HZ;
+    timer.it_value            = timer.it_interval;
+
+    if (setitimer(ITIMER_REAL, &timer, NULL) != 0)
+    {
+        KLOGE(KEVT_SYSTICK_FAIL, (uint32_t) timer.it_interval.tv_usec, (uint32_t) errno);
+    }
+}
+
+/**
+ * The task runs on a host stack from g_port_stacks, not on stack_top: the
+ * kernel's buffer only keeps the canary. Returns the host context, which
+ * the TCB stores as its stack_pointer.
+ */
+uint32_t *rtos_port_init_task_stack(uint32_t *stack_top, rtos_task_function_t task_function, void *parameter)
+{
+    (void) stack_top;
+
+    port_context_t *ctx = port_context_alloc();
+    if (ctx == NULL)
+    {
+        KLOGF(KEVT_ERROR_GENERIC, PORT_POSIX_MAX_CONTEXTS, 0);
+        indicate_system_failure();
+    }
+
+    getcontext(&ctx->uc);
+    ctx->uc.uc_stack.ss_sp   = g_port_stacks[ctx - g_port_contexts];
+    ctx->uc.uc_stack.ss_size = PORT_POSIX_TASK_STACK_SIZE;
+    ctx->uc.uc_link          = NULL;
+    sigemptyset(&ctx->uc.uc_sigmask); /* Starts with interrupts enabled */
+    ctx->function  = task_function;
+    ctx->parameter = parameter;
+    makecontext(&ctx->uc, port_task_entry, 0);
+
+    return (uint32_t *) ctx;
+}
+
+void rtos_port_yield(void)
+{
+    port_pend(PORT_PEND_PENDSV);
+}
+
+#if RTOS_SMP_CORES > 1
+void rtos_port_yield_core(uint32_t core)
+{
+    port_pend_core(core, PORT_PEND_PENDSV);
+}
+
+static void port_secondary_entry(void)
+{
+    rtos_kernel_start_core();
+}
+
+/* The cores start on their first turn, once core 0 runs its first task */
+void rtos_port_start_secondary_cores(void)
+{
+    for (uint32_t c = 1; c < RTOS_SMP_CORES; c++)
+    {
+        ucontext_t *uc = &g_port_boot_uc[c];
+
+        getcontext(uc);
+        uc->uc_stack.ss_sp   = g_port_boot_stacks[c];
+        uc->uc_stack.ss_size = PORT_POSIX_TASK_STACK_SIZE;
+        uc->uc_link          = NULL;
+        sigemptyset(&uc->uc_sigmask);
+        makecontext(uc, port_secondary_entry, 0);
+
+        g_port_cores[c].started = true;
+    }
+}
+#endif
+
+/* No data cache on the host */
+void rtos_port_dcache_clean(const void *addr, uint32_t size)
+{
+    (void) addr;
+    (void) size;
+}
+
+void rtos_port_dcache_invalidate(void *addr, uint32_t size)
+{
+    (void) addr;
+    (void) size;
+}
+
+__attribute__((__noreturn__)) void rtos_port_start_first_task(void)
+{
+    port_context_t *first = (port_context_t *) rtos_kernel_this_core()->next_task->stack_pointer;
+
+    /* Once, on core 0: SysTick and the cycle counter are shared */
+    if (rtos_port_get_core_id() == 0U)
+    {
+        rtos_port_start_systick();
+
+#if RTOS_PROFILING_SYSTEM_ENABLED
+        rtos_profiling_init();
+#endif
+    }
+
+    g_port_running = first;
+    setcontext(&first->uc);
+
+    KLOGE(KEVT_ERROR_GENERIC, 0, 0);
+
+    /* Should never reach here */
+    indicate_system_failure();
+}
+
+void rtos_port_systick_handler(void)
+{
+    PROF_TRACE_ISR_ENTER();
+
+#if RTOS_PROFILING_SYSTEM_ENABLED
+    uint32_t now = DWT->CYCCNT;
+
+    if (g_last_tick_cycle != 0)
+    {
+        uint32_t expected   = SystemCoreClock / RTOS_TICK_RATE_HZ;
+        uint32_t actual     = now - g_last_tick_cycle;
+        int32_t  jitter     = (int32_t) (actual - expected);
+        uint32_t abs_jitter = (jitter < 0) ? (uint32_t) (-jitter) : (uint32_t) jitter;
+        rtos_profiling_record(&g_prof_tick_jitter, abs_jitter);
+    }
+    g_last_tick_cycle = now;
+#endif
+
+    rtos_kernel_tick_handler();
+
+    PROF_TRACE_ISR_EXIT();
+}
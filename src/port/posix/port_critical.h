@@ -0,0 +1,90 @@
+#ifndef PORT_CRITICAL_H
+#define PORT_CRITICAL_H
+
+#include "port_priv.h"
+#include "rtos_assert.h"
+
+#include <stdint.h>
+
+/**
+ * POSIX simulation critical sections, inlined into every kernel call
+ * through rtos_port.h.
+ *
+ * Emulated interrupts (SysTick from SIGALRM, the SWIn lines, PendSV) are
+ * masked in software: while g_critical_nesting is nonzero they only set a
+ * bit in g_port_pending, and the outermost exit runs them. No system call
+ * on either path, so a section costs what it costs on the target: a few
+ * loads and stores.
+ *
+ * A context switch only ever happens at nesting 0 (PendSV runs last, once
+ * the section is left), so unlike the Cortex-M ports the depth needs no
+ * per-task save.
+ *
+ * With RTOS_SMP_CORES = 2 the nesting depth, the pending bits and the
+ * exclusive monitor belong to the core on the host thread; port.c swaps
+ * them with the core. Cores only trade places at nesting 0 outside any
+ * interrupt, so a section is never entered while the other core holds one
+ * and the kernel lock needs no spinlock: holding the host thread is holding
+ * the lock.
+ */
+
+extern volatile uint32_t g_critical_nesting; /**< Nesting depth; 0 at every switch */
+extern volatile uint32_t g_port_pending;     /**< Emulated interrupts waiting for the mask to drop */
+
+/** Compiler barrier: orders kernel accesses against the signal handler. */
+#define PORT_POSIX_BARRIER() __atomic_signal_fence(__ATOMIC_SEQ_CST)
+
+/** Run the pending emulated interrupts; no-op inside one. Defined in port.c. */
+void port_posix_service_pending(void);
+
+#if RTOS_SMP_CORES > 1
+extern volatile uint32_t g_port_core; /**< Simulated core on the host thread */
+#endif
+
+static inline __attribute__((always_inline)) uint32_t rtos_port_get_core_id(void)
+{
+#if RTOS_SMP_CORES > 1
+    return g_port_core;
+#else
+    return 0U;
+#endif
+}
+
+static inline __attribute__((always_inline)) void rtos_port_enter_critical(void)
+{
+    g_critical_nesting++;
+    PORT_POSIX_BARRIER();
+}
+
+static inline __attribute__((always_inline)) void rtos_port_exit_critical(void)
+{
+    PORT_POSIX_BARRIER();
+
+    if (g_critical_nesting > 0U && --g_critical_nesting == 0U && g_port_pending != 0U)
+    {
+        port_posix_service_pending();
+    }
+}
+
+static inline __attribute__((always_inline)) uint32_t rtos_port_enter_critical_from_isr(void)
+{
+    uint32_t saved = g_critical_nesting;
+
+    g_critical_nesting = saved + 1U;
+    PORT_POSIX_BARRIER();
+
+    return saved;
+}
+
+static inline __attribute__((always_inline)) void rtos_port_exit_critical_from_isr(uint32_t saved_priority)
+{
+    PORT_POSIX_BARRIER();
+    g_critical_nesting = saved_priority;
+
+    if (saved_priority == 0U && g_port_pending != 0U)
+    {
+        port_posix_service_pending();
+    }
+}
+
+#endif /* PORT_CRITICAL_H */
@@ -0,0 +1,68 @@
+#ifndef PORT_PRIV_H
+#define PORT_PRIV_H
+
+#include "config.h" // IWYU pragma: keep
+
+/* These macros are enforced by port_common.h's PORT_VERIFY_CONTRACT check. */
+
+/** Host ABI stack alignment (System V i386/x86-64: 16 bytes at a call). */
+#define PORT_STACK_ALIGNMENT 16
+
+/** No exception frame on the host: a task resumes through swapcontext(). */
+#define PORT_INITIAL_EXC_RETURN 0
+
+/** swapcontext() saves the FPU state of every task; RTOS_TASK_FLAG_NO_FPU has no effect. */
+#define PORT_HAS_FPU 0
+
+/** No data cache to maintain. */
+#define PORT_HAS_DCACHE 0
+
+/** No Arm block transfers; rtos_mem copies through the host C library. */
+#define PORT_HAS_BLOCK_TRANSFER 0
+
+/**
+ * Up to two simulated cores. They take turns on the one host thread
+ * (port.c), so RTOS_SMP_CORES = 2 runs the SMP kernel without host threads.
+ */
+#define PORT_NUM_CORES 2U
+
+/* ======================== Interrupt Priorities =========================== */
+
+/**
+ * Same encoding as the Cortex-M ports, so priority checks in shared code
+ * compile unchanged. The simulation has one interrupt level: every
+ * emulated line (SysTick, the SWIn lines) runs at kernel priority and is
+ * held off by every critical section. There is no zero-latency tier.
+ */
+#define PORT_IRQ_PRIORITY_CRITICAL (0x00)
+#define PORT_IRQ_PRIORITY_HIGH     (0x40)
+#define PORT_IRQ_PRIORITY_KERNEL   (0x80)
+#define PORT_IRQ_PRIORITY_LOW      (0xC0)
+#define PORT_IRQ_PRIORITY_PENDSV   (0xF0)
+
+#define PORT_MAX_INTERRUPT_PRIORITY PORT_IRQ_PRIORITY_KERNEL
+
+#define PORT_NVIC_PRIO_SHIFT 4U
+
+#define PORT_IRQ_IS_KERNEL_SAFE(nvic_prio) (((uint32_t) (nvic_prio) << PORT_NVIC_PRIO_SHIFT) >= PORT_MAX_INTERRUPT_PRIORITY)
+
+/** No status register to seed. */
+#define PORT_INITIAL_XPSR 0
+
+/* ======================== Host Resources ================================= */
+
+/**
+ * Host stack each task actually runs on. Signal frames and libc calls need
+ * far more than a target task, so the kernel's stack buffer only carries
+ * the canary and the fill pattern: watermarks always read as unused.
+ */
+#ifndef PORT_POSIX_TASK_STACK_SIZE
+#define PORT_POSIX_TASK_STACK_SIZE (64U * 1024U)
+#endif
+
+/** Host stacks available; a recycled kernel stack reuses its host stack. */
+#ifndef PORT_POSIX_MAX_CONTEXTS
+#define PORT_POSIX_MAX_CONTEXTS (2U * RTOS_MAX_TASKS)
+#endif
+
+#endif /* PORT_PRIV_H */
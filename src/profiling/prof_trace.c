@@ -1,35 +1,68 @@
 #include "prof_trace.h"
 
 #include "ring_buffer.h"
+#include "rtos_port.h"
+#include "rtt.h"
 
 #include <stddef.h>
 
-#include "stm32f4xx.h" // IWYU pragma: keep
+#include "device.h" // IWYU pragma: keep
 
-/* Buffer in .noinit — survives soft reset for post-mortem analysis */
-static volatile uint8_t prof_buf[PROF_TRACE_BUFFER_SIZE] __attribute__((section(".noinit")));
-static ring_buffer_t    prof_rb;
+#if LOG_BACKEND_RTT
 
+/* Records go straight to the RTT ProfTrace channel; the debugger is the consumer */
 void prof_trace_init(void)
 {
-    ring_buffer_init(&prof_rb, (uint8_t *) prof_buf, PROF_TRACE_BUFFER_SIZE);
+    rtt_init();
 }
 
 void prof_trace_emit(uint16_t event_id, uint8_t entity_id)
 {
     prof_record_t record;
-
     record.cyccnt    = DWT->CYCCNT;
     record.event_id  = event_id;
     record.entity_id = entity_id;
     record._pad      = 0;
 
-    uint32_t primask = __get_PRIMASK();
-    __disable_irq();
+    rtt_write(RTT_CHANNEL_PROF, &record, sizeof(record));
+}
 
-    ring_buffer_write(&prof_rb, &record, sizeof(record));
+uint32_t prof_trace_drain(prof_record_t *out, uint32_t max_records)
+{
+    (void) out;
+    (void) max_records;
+    return 0;
+}
+
+#else
+
+/* Buffer in .noinit — survives soft reset for post-mortem analysis */
+static volatile uint8_t prof_buf[PROF_TRACE_BUFFER_SIZE] __attribute__((section(".noinit"), aligned(4)));
+static ring_buffer_t    prof_rb;
 
-    __set_PRIMASK(primask);
+void prof_trace_init(void)
+{
+    ring_buffer_init(&prof_rb, (uint8_t *) prof_buf, PROF_TRACE_BUFFER_SIZE);
+}
+
+void prof_trace_emit(uint16_t event_id, uint8_t entity_id)
+{
+    uint32_t cyccnt = DWT->CYCCNT;
+
+    /* BASEPRI, not PRIMASK: emitters run at kernel level or below */
+    uint32_t saved = rtos_port_enter_critical_from_isr();
+
+    prof_record_t *record = (prof_record_t *) ring_buffer_reserve(&prof_rb, sizeof(prof_record_t));
+    if (record != NULL)
+    {
+        record->cyccnt    = cyccnt;
+        record->event_id  = event_id;
+        record->entity_id = entity_id;
+        record->_pad      = 0;
+        ring_buffer_commit(&prof_rb, sizeof(prof_record_t));
+    }
+
+    rtos_port_exit_critical_from_isr(saved);
 }
 
 uint32_t prof_trace_drain(prof_record_t *out, uint32_t max_records)
@@ -41,8 +74,7 @@ uint32_t prof_trace_drain(prof_record_t *out, uint32_t max_records)
 
     uint32_t count = 0;
 
-    uint32_t primask = __get_PRIMASK();
-    __disable_irq();
+    uint32_t saved = rtos_port_enter_critical_from_isr();
 
     while (count < max_records)
     {
@@ -54,7 +86,9 @@ uint32_t prof_trace_drain(prof_record_t *out, uint32_t max_records)
         count++;
     }
 
-    __set_PRIMASK(primask);
+    rtos_port_exit_critical_from_isr(saved);
 
     return count;
 }
+
+#endif /* LOG_BACKEND_RTT */
@@ -14,12 +14,27 @@ extern "C"
 #define PROF_TRACE_BUFFER_SIZE 512 /* Must be power of 2 */
 #endif
 
+/*
+ * Scheduling timeline. With RTOS_PROF_TRACE the kernel emits, entity first:
+ *
+ *   PEVT_TASK_SWITCH_OUT / _IN  task ID     every real switch, out then in, from PendSV
+ *   PEVT_TASK_BLOCK             task ID     blocked on a sync object (rtos_kernel_block_on)
+ *   PEVT_TASK_UNBLOCK           task ID     made ready: woken, resumed, delay or timeout expired
+ *   PEVT_ISR_ENTER / _EXIT      exception   SysTick, and handlers wrapped in PROF_TRACE_ISR_*
+ *
+ * tools/prof_trace_export.py turns a capture into Chrome / Perfetto trace
+ * JSON with one track per task and per exception number.
+ */
+#ifndef RTOS_PROF_TRACE
+#define RTOS_PROF_TRACE 0
+#endif
+
 /* Compact trace record (8 bytes): timestamp + event + entity, no level or extra args. */
 typedef struct __attribute__((packed))
 {
     uint32_t cyccnt;    /* Raw DWT->CYCCNT */
-    uint16_t event_id;  /* PEVT_* from log_event_ids.h */
-    uint8_t  entity_id; /* Task ID or ISR number */
+    uint16_t event_id;  /* PEVT_* from klog_events.h */
+    uint8_t  entity_id; /* Task ID or exception number */
     uint8_t  _pad;      /* Alignment padding */
 } prof_record_t;
 
@@ -30,6 +45,16 @@ void prof_trace_emit(uint16_t event_id, uint8_t entity_id);
 
 uint32_t prof_trace_drain(prof_record_t *out, uint32_t max_records);
 
+#if RTOS_PROF_TRACE
+#define PROF_TRACE(event_id, entity_id) prof_trace_emit((uint16_t) (event_id), (uint8_t) (entity_id))
+#else
+#define PROF_TRACE(event_id, entity_id) ((void) 0)
+#endif
+
+/* First and last statement of an interrupt handler; needs device.h for __get_IPSR() */
+#define PROF_TRACE_ISR_ENTER() PROF_TRACE(PEVT_ISR_ENTER, __get_IPSR())
+#define PROF_TRACE_ISR_EXIT()  PROF_TRACE(PEVT_ISR_EXIT, __get_IPSR())
+
 #ifdef __cplusplus
 }
 #endif
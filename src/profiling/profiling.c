@@ -1,11 +1,15 @@
 #include "profiling.h"
 
+#include "VRTOS.h"
+#include "power.h"
 #include "rtos_port.h"
+#include "task.h"
 #include "ulog.h"
 
 #include <stddef.h>
+#include <string.h>
 
-#include "stm32f4xx.h" // IWYU pragma: keep
+#include "device.h" // IWYU pragma: keep
 
 void rtos_profiling_init(void)
 {
@@ -39,12 +43,45 @@ void rtos_profiling_reset_stat(rtos_profile_stat_t *stat, const char *name)
     stat->count        = 0;
     stat->name         = name;
 
+    if (stat->histogram != NULL)
+    {
+        memset(stat->histogram, 0, sizeof(*stat->histogram));
+    }
+
     rtos_port_exit_critical();
 }
 
+#define HIST_SUB_MASK ((1U << RTOS_PROFILE_HIST_SUB_BITS) - 1U)
+
+/* Bucket for a value: exact below 2^SUB_BITS, then the top SUB_BITS bits
+ * after the leading one select a sub-bucket within its octave. */
+static inline uint32_t hist_index(uint32_t cycles)
+{
+    if (cycles <= HIST_SUB_MASK)
+    {
+        return cycles;
+    }
+
+    uint32_t shift = (31U - __CLZ(cycles)) - RTOS_PROFILE_HIST_SUB_BITS;
+    return ((shift + 1U) << RTOS_PROFILE_HIST_SUB_BITS) | ((cycles >> shift) & HIST_SUB_MASK);
+}
+
+/* Largest value that maps to bucket index */
+static uint32_t hist_upper(uint32_t index)
+{
+    if (index <= HIST_SUB_MASK)
+    {
+        return index;
+    }
+
+    uint32_t shift = (index >> RTOS_PROFILE_HIST_SUB_BITS) - 1U;
+    uint32_t lower = ((1U << RTOS_PROFILE_HIST_SUB_BITS) | (index & HIST_SUB_MASK)) << shift;
+    return lower + ((1U << shift) - 1U);
+}
+
 /* uint32_t subtraction naturally handles DWT_CYCCNT wraparound for
- * measurements under ~268s. total_cycles may overflow after many
- * samples — avg becomes inaccurate, but min/max remain valid. */
+ * measurements under ~268s. The histogram update is one CLZ and an
+ * increment, so attaching one keeps the record path O(1). */
 void rtos_profiling_record(rtos_profile_stat_t *stat, uint32_t cycles)
 {
     if (stat == NULL)
@@ -66,6 +103,11 @@ void rtos_profiling_record(rtos_profile_stat_t *stat, uint32_t cycles)
     stat->total_cycles += cycles;
     stat->count++;
 
+    if (stat->histogram != NULL)
+    {
+        stat->histogram->buckets[hist_index(cycles)]++;
+    }
+
     rtos_port_exit_critical();
 }
 
@@ -81,6 +123,69 @@ static uint32_t cycles_to_us(uint32_t cycles)
     return (cycles / (SystemCoreClock / 1000000U));
 }
 
+/* Percentile ranks in 0.01 % units */
+#define PCT_P50  5000U
+#define PCT_P99  9900U
+#define PCT_P999 9990U
+
+/* Fills p50/p99/p999 from the histogram; caller holds the critical section */
+static void hist_percentiles(const rtos_profile_stat_t *stat, rtos_profile_snapshot_t *out)
+{
+    out->p50_cycles  = 0;
+    out->p99_cycles  = 0;
+    out->p999_cycles = 0;
+
+    if (stat->histogram == NULL)
+    {
+        return;
+    }
+
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < RTOS_PROFILE_HIST_BUCKETS; i++)
+    {
+        total += stat->histogram->buckets[i];
+    }
+    if (total == 0)
+    {
+        return;
+    }
+
+    /* Smallest rank r with r >= total * p, i.e. nearest-rank percentile */
+    uint32_t rank_p50  = (uint32_t) (((uint64_t) total * PCT_P50 + 9999U) / 10000U);
+    uint32_t rank_p99  = (uint32_t) (((uint64_t) total * PCT_P99 + 9999U) / 10000U);
+    uint32_t rank_p999 = (uint32_t) (((uint64_t) total * PCT_P999 + 9999U) / 10000U);
+
+    uint32_t seen = 0;
+    for (uint32_t i = 0; i < RTOS_PROFILE_HIST_BUCKETS && out->p999_cycles == 0; i++)
+    {
+        if (stat->histogram->buckets[i] == 0)
+        {
+            continue;
+        }
+
+        seen += stat->histogram->buckets[i];
+
+        uint32_t upper = hist_upper(i);
+        if (upper > stat->max_cycles)
+        {
+            upper = stat->max_cycles;
+        }
+
+        if (out->p50_cycles == 0 && seen >= rank_p50)
+        {
+            out->p50_cycles = upper;
+        }
+        if (out->p99_cycles == 0 && seen >= rank_p99)
+        {
+            out->p99_cycles = upper;
+        }
+        if (seen >= rank_p999)
+        {
+            out->p999_cycles = upper;
+        }
+    }
+}
+
 void rtos_profiling_snapshot(const rtos_profile_stat_t *stat, rtos_profile_snapshot_t *out)
 {
     if (stat == NULL || out == NULL || stat->count == 0)
@@ -92,12 +197,15 @@ void rtos_profiling_snapshot(const rtos_profile_stat_t *stat, rtos_profile_snaps
 
     uint32_t min_cycles   = stat->min_cycles;
     uint32_t max_cycles   = stat->max_cycles;
-    uint32_t total_cycles = stat->total_cycles;
+    uint64_t total_cycles = stat->total_cycles;
     uint32_t count        = stat->count;
 
+    /* Walks every bucket; a report-path cost, never paid on record */
+    hist_percentiles(stat, out);
+
     rtos_port_exit_critical();
 
-    uint32_t avg_cycles = total_cycles / count;
+    uint32_t avg_cycles = (uint32_t) (total_cycles / count);
 
     out->min_cycles = min_cycles;
     out->max_cycles = max_cycles;
@@ -106,6 +214,9 @@ void rtos_profiling_snapshot(const rtos_profile_stat_t *stat, rtos_profile_snaps
     out->min_us     = cycles_to_us(min_cycles);
     out->max_us     = cycles_to_us(max_cycles);
     out->avg_us     = cycles_to_us(avg_cycles);
+    out->p50_us     = cycles_to_us(out->p50_cycles);
+    out->p99_us     = cycles_to_us(out->p99_cycles);
+    out->p999_us    = cycles_to_us(out->p999_cycles);
 }
 
 void rtos_profiling_print_stat(rtos_profile_stat_t *stat)
@@ -115,28 +226,24 @@ void rtos_profiling_print_stat(rtos_profile_stat_t *stat)
         return;
     }
 
-    /* Capture values atomically for consistent snapshot */
-    rtos_port_enter_critical();
+    const char             *name = stat->name != NULL ? stat->name : "unnamed";
+    rtos_profile_snapshot_t snap;
 
-    const char *name         = stat->name != NULL ? stat->name : "unnamed";
-    uint32_t    min_cycles   = stat->min_cycles;
-    uint32_t    max_cycles   = stat->max_cycles;
-    uint32_t    total_cycles = stat->total_cycles;
-    uint32_t    count        = stat->count;
-
-    rtos_port_exit_critical();
-
-    uint32_t avg_cycles = total_cycles / count;
-
-    /* Convert to microseconds for human-readable output */
-    uint32_t min_us = cycles_to_us(min_cycles);
-    uint32_t max_us = cycles_to_us(max_cycles);
-    uint32_t avg_us = cycles_to_us(avg_cycles);
+    /* Capture values atomically for consistent snapshot */
+    rtos_profiling_snapshot(stat, &snap);
 
     ulog_info("[%s]: Min=%lu cyc (%lu us), Max=%lu cyc (%lu us), "
               "Avg=%lu cyc (%lu us), Cnt=%lu",
-              name, (unsigned long) min_cycles, (unsigned long) min_us, (unsigned long) max_cycles,
-              (unsigned long) max_us, (unsigned long) avg_cycles, (unsigned long) avg_us, (unsigned long) count);
+              name, (unsigned long) snap.min_cycles, (unsigned long) snap.min_us, (unsigned long) snap.max_cycles,
+              (unsigned long) snap.max_us, (unsigned long) snap.avg_cycles, (unsigned long) snap.avg_us,
+              (unsigned long) snap.count);
+
+    if (stat->histogram != NULL)
+    {
+        ulog_info("[%s]: P50=%lu cyc (%lu us), P99=%lu cyc (%lu us), P99.9=%lu cyc (%lu us)", name,
+                  (unsigned long) snap.p50_cycles, (unsigned long) snap.p50_us, (unsigned long) snap.p99_cycles,
+                  (unsigned long) snap.p99_us, (unsigned long) snap.p999_cycles, (unsigned long) snap.p999_us);
+    }
 }
 
 #if RTOS_PROFILING_SYSTEM_ENABLED
@@ -150,6 +257,57 @@ void rtos_profiling_report_system_stats(void)
     rtos_profiling_print_stat(&g_prof_tick);
     rtos_profiling_print_stat(&g_prof_tick_jitter);
     rtos_profiling_print_stat(&g_prof_scheduling_latency);
+    rtos_profiling_print_stat(&g_prof_idle_sleep);
+    rtos_profiling_print_stat(&g_prof_idle_wake_late);
+    rtos_profiling_print_stat(&g_prof_pip_walk);
+
+    ulog_info("[Boot]: klog=%lu mem=%lu task=%lu sched=%lu port=%lu idle=%lu deferred=%lu defined=%lu cyc",
+              (unsigned long) g_prof_boot.klog_cycles, (unsigned long) g_prof_boot.memory_cycles,
+              (unsigned long) g_prof_boot.task_system_cycles, (unsigned long) g_prof_boot.scheduler_cycles,
+              (unsigned long) g_prof_boot.port_cycles, (unsigned long) g_prof_boot.idle_create_cycles,
+              (unsigned long) g_prof_boot.deferred_cycles, (unsigned long) g_prof_boot.defined_cycles);
+    ulog_info("[Boot]: rtos_init %lu cyc (%lu us), first task at %lu cyc (%lu us)",
+              (unsigned long) g_prof_boot.init_cycles,
+              (unsigned long) (g_prof_boot.init_cycles / (SystemCoreClock / 1000000U)),
+              (unsigned long) g_prof_boot.first_task_cycles,
+              (unsigned long) (g_prof_boot.first_task_cycles / (SystemCoreClock / 1000000U)));
+
+    uint32_t uptime_ticks = rtos_get_tick_count();
+    if (g_prof_idle_sleep_ticks != 0 && uptime_ticks != 0)
+    {
+        ulog_info("[IdleResidency]: %lu of %lu ticks asleep (%lu%%)", (unsigned long) g_prof_idle_sleep_ticks,
+                  (unsigned long) uptime_ticks,
+                  (unsigned long) (((uint64_t) g_prof_idle_sleep_ticks * 100U) / uptime_ticks));
+    }
+
+#if RTOS_USE_LOW_POWER
+    static const char *const mode_names[RTOS_POWER_MODE_COUNT] = {"sleep", "stop", "standby"};
+    rtos_power_stats_t       power;
+    if (rtos_power_get_stats(&power) == RTOS_SUCCESS)
+    {
+        for (uint32_t m = 0; m < RTOS_POWER_MODE_COUNT; m++)
+        {
+            ulog_info("[PowerResidency]: %-7s %lu entries, %lu ticks, worst wake %lu cyc", mode_names[m],
+                      (unsigned long) power.entries[m], (unsigned long) power.residency_ticks[m],
+                      (unsigned long) power.wake_latency_cycles[m]);
+        }
+        ulog_info("[PowerResidency]: %lu deep sleeps refused by the board", (unsigned long) power.refusals);
+    }
+#endif
+
+    rtos_task_runtime_t  tasks[RTOS_MAX_TASKS];
+    rtos_runtime_stats_t runtime;
+    if (rtos_task_get_runtime_stats(tasks, RTOS_MAX_TASKS, &runtime) == RTOS_SUCCESS)
+    {
+        for (uint8_t i = 0; i < runtime.task_count; i++)
+        {
+            ulog_info("[Runtime]: T%02u %-8s %3u.%u%% (%lu cyc in window)", (unsigned) tasks[i].task_id,
+                      tasks[i].name != NULL ? tasks[i].name : "?", (unsigned) (tasks[i].cpu_permille / 10U),
+                      (unsigned) (tasks[i].cpu_permille % 10U), (unsigned long) tasks[i].window_cycles);
+        }
+        ulog_info("[Runtime]: idle %u.%u%%", (unsigned) (runtime.idle_permille / 10U),
+                  (unsigned) (runtime.idle_permille % 10U));
+    }
 }
 
 void rtos_profiling_reset_system_stats(void)
@@ -160,14 +318,30 @@ void rtos_profiling_reset_system_stats(void)
     rtos_profiling_reset_stat(&g_prof_tick, "TickHandler");
     rtos_profiling_reset_stat(&g_prof_tick_jitter, "TickJitter");
     rtos_profiling_reset_stat(&g_prof_scheduling_latency, "SchedLatency");
+    rtos_profiling_reset_stat(&g_prof_idle_sleep, "IdleSleep");
+    rtos_profiling_reset_stat(&g_prof_idle_wake_late, "IdleWakeLate");
+    rtos_profiling_reset_stat(&g_prof_pip_walk, "PIPWalk");
+    g_prof_idle_sleep_ticks = 0;
 }
 
-rtos_profile_stat_t g_prof_context_switch     = {UINT32_MAX, 0, 0, 0, "ContextSwitch"};
-rtos_profile_stat_t g_prof_scheduler          = {UINT32_MAX, 0, 0, 0, "Scheduler"};
-rtos_profile_stat_t g_prof_tick               = {UINT32_MAX, 0, 0, 0, "TickHandler"};
-rtos_profile_stat_t g_prof_pendsv_full        = {UINT32_MAX, 0, 0, 0, "PendSV_Full"};
-rtos_profile_stat_t g_prof_tick_jitter        = {UINT32_MAX, 0, 0, 0, "TickJitter"};
-rtos_profile_stat_t g_prof_scheduling_latency = {UINT32_MAX, 0, 0, 0, "SchedLatency"};
+/* Tail latency matters for these; ~500 B of buckets each */
+static rtos_profile_hist_t g_hist_context_switch;
+static rtos_profile_hist_t g_hist_tick_jitter;
+static rtos_profile_hist_t g_hist_scheduling_latency;
+
+rtos_profile_stat_t g_prof_context_switch     = {UINT32_MAX, 0, 0, 0, "ContextSwitch", &g_hist_context_switch};
+rtos_profile_stat_t g_prof_scheduler          = {UINT32_MAX, 0, 0, 0, "Scheduler", NULL};
+rtos_profile_stat_t g_prof_tick               = {UINT32_MAX, 0, 0, 0, "TickHandler", NULL};
+rtos_profile_stat_t g_prof_pendsv_full        = {UINT32_MAX, 0, 0, 0, "PendSV_Full", NULL};
+rtos_profile_stat_t g_prof_tick_jitter        = {UINT32_MAX, 0, 0, 0, "TickJitter", &g_hist_tick_jitter};
+rtos_profile_stat_t g_prof_scheduling_latency = {UINT32_MAX, 0, 0, 0, "SchedLatency", &g_hist_scheduling_latency};
+rtos_profile_stat_t g_prof_idle_sleep         = {UINT32_MAX, 0, 0, 0, "IdleSleep", NULL};
+rtos_profile_stat_t g_prof_idle_wake_late     = {UINT32_MAX, 0, 0, 0, "IdleWakeLate", NULL};
+rtos_profile_stat_t g_prof_pip_walk           = {UINT32_MAX, 0, 0, 0, "PIPWalk", NULL};
+
+volatile uint32_t g_prof_idle_sleep_ticks = 0;
+
+rtos_boot_profile_t g_prof_boot;
 
 volatile uint32_t g_pendsv_cycles       = 0;
 volatile uint32_t g_pendsv_start_cycles = 0;
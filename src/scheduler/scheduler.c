@@ -1,16 +1,75 @@
 #include "scheduler.h"
 
-#include "cooperative.h"
+#include "VRTOS.h"
+#include "config.h"
+#include "kernel_priv.h"
 #include "klog.h"
-#include "preemptive_sp.h"
 #include "profiling.h"
-#include "round_robin.h"
+#include "task_priv.h"
+#include "timer_wheel.h"
 
 #include <string.h>
 
+#if RTOS_SCHEDULER_STATIC_DISPATCH
+
+/*
+ * Static dispatch: RTOS_SCHEDULER_TYPE is fixed at build time, so the
+ * selected backend is compiled into this unit and each wrapper calls its
+ * static operation directly.  The compiler inlines the backend into the
+ * wrapper and folds the instance NULL checks against &g_scheduler_instance;
+ * the vtable load, indirect call and initialized check all disappear.
+ */
+#define RTOS_SCHEDULER_BACKEND_UNIT
+
+#if (RTOS_SCHEDULER_TYPE_ID == RTOS_SCHED_ID_0)
+#include "preemptive_sp.c" // IWYU pragma: keep
+#define SCHEDULER_OP(op)      preemptive_sp_##op
+#define SCHEDULER_BACKEND     preemptive_sp_scheduler
+#elif (RTOS_SCHEDULER_TYPE_ID == RTOS_SCHED_ID_1)
+#include "cooperative.c" // IWYU pragma: keep
+#define SCHEDULER_OP(op)      cooperative_##op
+#define SCHEDULER_BACKEND     cooperative_scheduler
+#elif (RTOS_SCHEDULER_TYPE_ID == RTOS_SCHED_ID_2)
+#include "round_robin.c" // IWYU pragma: keep
+#define SCHEDULER_OP(op)      round_robin_##op
+#define SCHEDULER_BACKEND     round_robin_scheduler
+#elif (RTOS_SCHEDULER_TYPE_ID == RTOS_SCHED_ID_3)
+#include "edf.c" // IWYU pragma: keep
+#define SCHEDULER_OP(op)      edf_##op
+#define SCHEDULER_BACKEND     edf_scheduler
+#endif
+
+#define SCHEDULER_READY()        (true)
+#define SCHEDULER_HAS_OP(op)     (true)
+#define SCHEDULER_CALL(op, ...)  SCHEDULER_OP(op)(&g_scheduler_instance, ##__VA_ARGS__)
+
+#else /* !RTOS_SCHEDULER_STATIC_DISPATCH */
+
+#include "cooperative.h"
+#include "edf.h"
+#include "preemptive_sp.h"
+#include "round_robin.h"
+
+#define SCHEDULER_READY()        (g_scheduler_instance.initialized && g_scheduler_instance.vtable != NULL)
+#define SCHEDULER_HAS_OP(op)     (g_scheduler_instance.vtable->op != NULL)
+#define SCHEDULER_CALL(op, ...)  g_scheduler_instance.vtable->op(&g_scheduler_instance, ##__VA_ARGS__)
+
+#endif /* RTOS_SCHEDULER_STATIC_DISPATCH */
+
 rtos_scheduler_instance_t g_scheduler_instance = {
     .vtable = NULL, .type = RTOS_SCHEDULER_TYPE, .private_data = NULL, .initialized = false};
 
+#if RTOS_USE_TIMING_WHEEL
+/* Delayed tasks, shared by whichever scheduler backend is active */
+timer_wheel_t g_task_delay_wheel;
+#endif
+
+#if RTOS_SCHEDULER_STATS
+/* Counters and high-water marks; current lengths come from the backend */
+rtos_scheduler_stats_t g_scheduler_stats;
+#endif
+
+#if !RTOS_SCHEDULER_STATIC_DISPATCH
 /* Scheduler registry - add new schedulers here */
 static const struct
 {
@@ -18,9 +77,11 @@ static const struct
     const rtos_scheduler_t *vtable;
 } g_scheduler_registry[] = {{RTOS_SCHEDULER_PREEMPTIVE_SP, &preemptive_sp_scheduler},
                             {RTOS_SCHEDULER_COOPERATIVE, &cooperative_scheduler},
-                            {RTOS_SCHEDULER_ROUND_ROBIN, &round_robin_scheduler}};
+                            {RTOS_SCHEDULER_ROUND_ROBIN, &round_robin_scheduler},
+                            {RTOS_SCHEDULER_EDF, &edf_scheduler}};
 
 #define SCHEDULER_REGISTRY_SIZE (sizeof(g_scheduler_registry) / sizeof(g_scheduler_registry[0]))
+#endif
 
 static const rtos_scheduler_t *rtos_scheduler_find_interface(rtos_scheduler_type_t scheduler_type);
 
@@ -47,10 +108,13 @@ rtos_status_t rtos_scheduler_init(rtos_scheduler_type_t scheduler_type)
     g_scheduler_instance.private_data = NULL;
     g_scheduler_instance.initialized  = false; /* Will be set by interface init */
 
-    rtos_status_t status = interface->init(&g_scheduler_instance);
+    rtos_status_t status = SCHEDULER_CALL(init);
 
     if (status == RTOS_SUCCESS)
     {
+#if RTOS_SCHEDULER_STATS
+        memset(&g_scheduler_stats, 0, sizeof(g_scheduler_stats));
+#endif
         g_scheduler_instance.initialized = true;
         KLOGI(KEVT_SCHEDULER_INIT, (uint32_t) scheduler_type, 0);
     }
@@ -77,14 +141,14 @@ rtos_scheduler_type_t rtos_scheduler_get_type(void)
  */
 rtos_task_handle_t rtos_scheduler_get_next_task(void)
 {
-    if (!g_scheduler_instance.initialized || g_scheduler_instance.vtable == NULL)
+    if (!SCHEDULER_READY())
     {
         KLOGE(KEVT_SCHEDULER_NOT_INIT, 0, 0);
         return NULL;
     }
 
     RTOS_SYS_PROFILE_START(scheduler);
-    rtos_task_handle_t next = g_scheduler_instance.vtable->get_next_task(&g_scheduler_instance);
+    rtos_task_handle_t next = SCHEDULER_CALL(get_next_task);
     RTOS_SYS_PROFILE_END(scheduler, &g_prof_scheduler);
 
     return next;
@@ -95,12 +159,12 @@ rtos_task_handle_t rtos_scheduler_get_next_task(void)
  */
 bool rtos_scheduler_should_preempt(rtos_task_handle_t new_task)
 {
-    if (!g_scheduler_instance.initialized || g_scheduler_instance.vtable == NULL)
+    if (!SCHEDULER_READY())
     {
         return false;
     }
 
-    return g_scheduler_instance.vtable->should_preempt(&g_scheduler_instance, new_task);
+    return SCHEDULER_CALL(should_preempt, new_task);
 }
 
 /**
@@ -108,12 +172,25 @@ bool rtos_scheduler_should_preempt(rtos_task_handle_t new_task)
  */
 void rtos_scheduler_task_completed(rtos_task_handle_t completed_task)
 {
-    if (!g_scheduler_instance.initialized || g_scheduler_instance.vtable == NULL || completed_task == NULL)
+    if (!SCHEDULER_READY() || completed_task == NULL)
     {
         return;
     }
 
-    g_scheduler_instance.vtable->task_completed(&g_scheduler_instance, completed_task);
+    SCHEDULER_CALL(task_completed, completed_task);
+}
+
+/**
+ * @brief Check whether a switch would keep the running task
+ */
+bool rtos_scheduler_reselects_current(rtos_task_handle_t current)
+{
+    if (!SCHEDULER_READY() || !SCHEDULER_HAS_OP(reselects_current))
+    {
+        return false;
+    }
+
+    return SCHEDULER_CALL(reselects_current, current);
 }
 
 /**
@@ -121,12 +198,19 @@ void rtos_scheduler_task_completed(rtos_task_handle_t completed_task)
  */
 void rtos_scheduler_add_to_ready_list(rtos_task_handle_t task_handle)
 {
-    if (!g_scheduler_instance.initialized || g_scheduler_instance.vtable == NULL || task_handle == NULL)
+    if (!SCHEDULER_READY() || task_handle == NULL)
+    {
+        return;
+    }
+
+    /* Suspended: the ready lists stay as the suspending task sees them */
+    if (g_kernel.scheduler_suspended > 0)
     {
+        rtos_kernel_pend_ready(task_handle);
         return;
     }
 
-    g_scheduler_instance.vtable->add_to_ready_list(&g_scheduler_instance, task_handle);
+    SCHEDULER_CALL(add_to_ready_list, task_handle);
 }
 
 /**
@@ -134,12 +218,18 @@ void rtos_scheduler_add_to_ready_list(rtos_task_handle_t task_handle)
  */
 void rtos_scheduler_remove_from_ready_list(rtos_task_handle_t task_handle)
 {
-    if (!g_scheduler_instance.initialized || g_scheduler_instance.vtable == NULL || task_handle == NULL)
+    if (!SCHEDULER_READY() || task_handle == NULL)
+    {
+        return;
+    }
+
+    if ((task_handle->flags & RTOS_TASK_FLAG_PENDING_READY) != 0U)
     {
+        rtos_kernel_unpend_ready(task_handle);
         return;
     }
 
-    g_scheduler_instance.vtable->remove_from_ready_list(&g_scheduler_instance, task_handle);
+    SCHEDULER_CALL(remove_from_ready_list, task_handle);
 }
 
 /**
@@ -147,12 +237,12 @@ void rtos_scheduler_remove_from_ready_list(rtos_task_handle_t task_handle)
  */
 void rtos_scheduler_add_to_delayed_list(rtos_task_handle_t task_handle, rtos_tick_t delay_ticks)
 {
-    if (!g_scheduler_instance.initialized || g_scheduler_instance.vtable == NULL || task_handle == NULL)
+    if (!SCHEDULER_READY() || task_handle == NULL)
     {
         return;
     }
 
-    g_scheduler_instance.vtable->add_to_delayed_list(&g_scheduler_instance, task_handle, delay_ticks);
+    SCHEDULER_CALL(add_to_delayed_list, task_handle, delay_ticks);
 }
 
 /**
@@ -160,12 +250,12 @@ void rtos_scheduler_add_to_delayed_list(rtos_task_handle_t task_handle, rtos_tic
  */
 void rtos_scheduler_remove_from_delayed_list(rtos_task_handle_t task_handle)
 {
-    if (!g_scheduler_instance.initialized || g_scheduler_instance.vtable == NULL || task_handle == NULL)
+    if (!SCHEDULER_READY() || task_handle == NULL)
     {
         return;
     }
 
-    g_scheduler_instance.vtable->remove_from_delayed_list(&g_scheduler_instance, task_handle);
+    SCHEDULER_CALL(remove_from_delayed_list, task_handle);
 }
 
 /**
@@ -173,66 +263,138 @@ void rtos_scheduler_remove_from_delayed_list(rtos_task_handle_t task_handle)
  */
 void rtos_scheduler_update_delayed_tasks(void)
 {
-    if (!g_scheduler_instance.initialized || g_scheduler_instance.vtable == NULL)
+    if (!SCHEDULER_READY())
     {
         return;
     }
 
-    g_scheduler_instance.vtable->update_delayed_tasks(&g_scheduler_instance);
+    SCHEDULER_CALL(update_delayed_tasks);
+}
+
+/**
+ * @brief Get the earliest delayed-task wake tick via scheduler
+ */
+bool rtos_scheduler_get_next_wake_tick(rtos_tick_t *wake_tick)
+{
+    if (!SCHEDULER_READY() || wake_tick == NULL)
+    {
+        return false;
+    }
+
+    if (SCHEDULER_HAS_OP(get_next_wake_tick))
+    {
+        return SCHEDULER_CALL(get_next_wake_tick, wake_tick);
+    }
+
+    return false; /* Not supported */
 }
 
 /**
  * @brief Get scheduler statistics
  */
-size_t rtos_scheduler_get_statistics(void *stats_buffer, size_t buffer_size)
+rtos_status_t rtos_scheduler_get_statistics(rtos_scheduler_stats_t *stats)
 {
-    if (!g_scheduler_instance.initialized || g_scheduler_instance.vtable == NULL || stats_buffer == NULL ||
-        buffer_size == 0)
+    if (stats == NULL)
     {
-        return 0;
+        return RTOS_ERROR_INVALID_PARAM;
     }
 
-    if (g_scheduler_instance.vtable->get_statistics != NULL)
+    if (!SCHEDULER_READY())
     {
-        return g_scheduler_instance.vtable->get_statistics(&g_scheduler_instance, stats_buffer, buffer_size);
+        return RTOS_ERROR_INVALID_STATE;
     }
 
-    return 0; /* Statistics not supported */
+    rtos_port_enter_critical();
+
+#if RTOS_SCHEDULER_STATS
+    *stats = g_scheduler_stats;
+#else
+    memset(stats, 0, sizeof(*stats));
+#endif
+    stats->ready_count     = 0;
+    stats->delayed_count   = 0;
+    stats->deadline_misses = 0;
+    if (SCHEDULER_HAS_OP(get_statistics))
+    {
+        SCHEDULER_CALL(get_statistics, stats);
+    }
+    stats->current_tick = rtos_get_tick_count();
+
+    rtos_port_exit_critical();
+
+    return RTOS_SUCCESS;
 }
 
 /**
- * @brief Print scheduler debug information
+ * @brief Reset scheduler statistics
  */
-void rtos_scheduler_debug_print(void)
+void rtos_scheduler_reset_statistics(void)
 {
-    if (!g_scheduler_instance.initialized)
+#if RTOS_SCHEDULER_STATS
+    rtos_scheduler_stats_t now = {0};
+
+    if (!SCHEDULER_READY())
     {
-        KLOGI(KEVT_SCHEDULER_NOT_INIT, 0, 0);
         return;
     }
 
-    KLOGD(KEVT_SCHEDULER_INIT, (uint32_t) g_scheduler_instance.type, 0);
+    rtos_port_enter_critical();
+
+    if (SCHEDULER_HAS_OP(get_statistics))
+    {
+        SCHEDULER_CALL(get_statistics, &now);
+    }
+    memset(&g_scheduler_stats, 0, sizeof(g_scheduler_stats));
+    g_scheduler_stats.ready_high_water   = now.ready_count;
+    g_scheduler_stats.delayed_high_water = now.delayed_count;
 
-    uint8_t stats_buffer[128];
-    size_t  stats_size = rtos_scheduler_get_statistics(stats_buffer, sizeof(stats_buffer));
+    rtos_port_exit_critical();
+#endif
+}
 
-    if (stats_size > 0)
+/**
+ * @brief Log scheduler statistics as KEVT_SCHED_STATS records
+ */
+void rtos_scheduler_log_statistics(void)
+{
+    rtos_scheduler_stats_t stats;
+
+    if (rtos_scheduler_get_statistics(&stats) != RTOS_SUCCESS)
     {
-        KLOGD(KEVT_SCHEDULER_INIT, stats_size, 0);
-        for (size_t i = 0; i < stats_size; i += 16)
-        {
-            char  hex_line[64] = {0};
-            char *ptr          = hex_line;
-
-            for (size_t j = 0; j < 16 && (i + j) < stats_size; j++)
-            {
-                ptr += sprintf(ptr, "%02X ", stats_buffer[i + j]);
-            }
-            KLOGD(KEVT_SCHEDULER_INIT, i, 0);
-        }
+        return;
+    }
+
+    const uint32_t values[RTOS_SCHED_STAT_COUNT] = {
+        [RTOS_SCHED_STAT_CONTEXT_SWITCHES]   = stats.context_switches,
+        [RTOS_SCHED_STAT_PREEMPTIONS]        = stats.preemptions,
+        [RTOS_SCHED_STAT_VOLUNTARY_SWITCHES] = stats.voluntary_switches,
+        [RTOS_SCHED_STAT_ELIDED_SWITCHES]    = stats.elided_switches,
+        [RTOS_SCHED_STAT_TICK_WAKES]         = stats.tick_wakes,
+        [RTOS_SCHED_STAT_SUSPENDED_TICKS]    = stats.suspended_ticks,
+        [RTOS_SCHED_STAT_DEADLINE_MISSES]    = stats.deadline_misses,
+        [RTOS_SCHED_STAT_READY]              = ((uint32_t) stats.ready_high_water << 8) | stats.ready_count,
+        [RTOS_SCHED_STAT_DELAYED]            = ((uint32_t) stats.delayed_high_water << 8) | stats.delayed_count,
+    };
+
+    for (uint32_t i = 0; i < RTOS_SCHED_STAT_COUNT; i++)
+    {
+        KLOGI(KEVT_SCHED_STATS, i, values[i]);
+    }
+}
+
+/**
+ * @brief Print scheduler debug information
+ */
+void rtos_scheduler_debug_print(void)
+{
+    if (!g_scheduler_instance.initialized)
+    {
+        KLOGI(KEVT_SCHEDULER_NOT_INIT, 0, 0);
+        return;
     }
 
-    KLOGD(KEVT_SCHEDULER_INIT, 0, 0);
+    KLOGD(KEVT_SCHEDULER_INIT, (uint32_t) g_scheduler_instance.type, 0);
+    rtos_scheduler_log_statistics();
 }
 
 /**
@@ -240,6 +402,10 @@ void rtos_scheduler_debug_print(void)
  */
 static const rtos_scheduler_t *rtos_scheduler_find_interface(rtos_scheduler_type_t scheduler_type)
 {
+#if RTOS_SCHEDULER_STATIC_DISPATCH
+    /* Only the backend compiled in is available */
+    return (scheduler_type == RTOS_SCHEDULER_TYPE) ? &SCHEDULER_BACKEND : NULL;
+#else
     for (size_t i = 0; i < SCHEDULER_REGISTRY_SIZE; i++)
     {
         if (g_scheduler_registry[i].type == scheduler_type)
@@ -248,4 +414,5 @@ static const rtos_scheduler_t *rtos_scheduler_find_interface(rtos_scheduler_type
         }
     }
     return NULL;
+#endif
 }
\ No newline at end of file
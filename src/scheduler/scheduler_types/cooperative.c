@@ -1,12 +1,19 @@
 #include "cooperative.h"
 
 #include "VRTOS.h"
+#include "config.h"
+#include "kernel_priv.h"
 #include "klog.h"
+#include "prof_trace.h"
 #include "scheduler.h"
 #include "task_priv.h"
+#include "timer_wheel.h"
 
 #include <string.h>
 
+/* Static dispatch compiles the selected backend into scheduler.c instead */
+#if !RTOS_SCHEDULER_STATIC_DISPATCH || defined(RTOS_SCHEDULER_BACKEND_UNIT)
+
 cooperative_private_data_t g_cooperative_data = {
     .ready_list = NULL, .delayed_list = NULL, .ready_count = 0, .delayed_count = 0};
 
@@ -36,6 +43,7 @@ static void cooperative_add_to_ready_list_internal(rtos_task_handle_t task)
     }
 
     g_cooperative_data.ready_count++;
+    RTOS_SCHED_STAT_HIGH_WATER(ready_high_water, g_cooperative_data.ready_count);
 
     KLOGT(KEVT_SCHED_TASK_READY, task->task_id, g_cooperative_data.ready_count);
 }
@@ -47,6 +55,12 @@ static void cooperative_remove_from_ready_list_internal(rtos_task_handle_t task)
         return;
     }
 
+    /* Not linked into the ready list (e.g. idle task already running) */
+    if (task->prev == NULL && g_cooperative_data.ready_list != task)
+    {
+        return;
+    }
+
     if (task->prev != NULL)
     {
         task->prev->next = task->next;
@@ -81,6 +95,13 @@ static void cooperative_add_to_delayed_list_internal(rtos_task_handle_t task, rt
 
     task->delay_until = rtos_get_tick_count() + delay_ticks;
 
+#if RTOS_USE_TIMING_WHEEL
+    timer_wheel_insert(&g_task_delay_wheel, &task->delay_node, task->delay_until);
+    g_cooperative_data.delayed_count++;
+    RTOS_SCHED_STAT_HIGH_WATER(delayed_high_water, g_cooperative_data.delayed_count);
+
+    KLOGT(KEVT_SCHED_TASK_DELAYED, task->task_id, (uint32_t) task->delay_until);
+#else
     rtos_tcb_t **list_head = &g_cooperative_data.delayed_list;
 
     task->next = NULL;
@@ -90,6 +111,7 @@ static void cooperative_add_to_delayed_list_internal(rtos_task_handle_t task, rt
     {
         *list_head                       = task;
         g_cooperative_data.delayed_count = 1;
+        RTOS_SCHED_STAT_HIGH_WATER(delayed_high_water, g_cooperative_data.delayed_count);
         return;
     }
 
@@ -121,17 +143,38 @@ static void cooperative_add_to_delayed_list_internal(rtos_task_handle_t task, rt
     }
 
     g_cooperative_data.delayed_count++;
+    RTOS_SCHED_STAT_HIGH_WATER(delayed_high_water, g_cooperative_data.delayed_count);
 
     KLOGT(KEVT_SCHED_TASK_DELAYED, task->task_id, (uint32_t) task->delay_until);
+#endif
 }
 
 static void cooperative_remove_from_delayed_list_internal(rtos_task_handle_t task)
 {
+#if RTOS_USE_TIMING_WHEEL
+    if (task == NULL || !timer_wheel_node_is_filed(&task->delay_node))
+    {
+        return;
+    }
+
+    timer_wheel_remove(&g_task_delay_wheel, &task->delay_node);
+
+    if (g_cooperative_data.delayed_count > 0)
+    {
+        g_cooperative_data.delayed_count--;
+    }
+#else
     if (task == NULL || g_cooperative_data.delayed_list == NULL)
     {
         return;
     }
 
+    /* Not on the delayed list (blocked without timeout) */
+    if (task->prev == NULL && g_cooperative_data.delayed_list != task)
+    {
+        return;
+    }
+
     rtos_tcb_t **list_head = &g_cooperative_data.delayed_list;
 
     if (task->prev != NULL)
@@ -155,43 +198,62 @@ static void cooperative_remove_from_delayed_list_internal(rtos_task_handle_t tas
     {
         g_cooperative_data.delayed_count--;
     }
+#endif
 
     KLOGT(KEVT_SCHED_TASK_DELAYED, task->task_id, g_cooperative_data.delayed_count);
 }
 
-static void cooperative_update_delayed_tasks_internal(void)
+/* Unlink the next delayed task that is due at current_tick, or return NULL */
+static rtos_tcb_t *cooperative_pop_expired_delayed_internal(rtos_tick_t current_tick)
 {
-    rtos_tick_t current_tick = rtos_get_tick_count();
-    rtos_tcb_t *task         = g_cooperative_data.delayed_list;
+#if RTOS_USE_TIMING_WHEEL
+    timer_wheel_node_t *node = timer_wheel_pop_expired(&g_task_delay_wheel, current_tick);
+    if (node == NULL)
+    {
+        return NULL;
+    }
 
-    /* Check delayed tasks (list is time-sorted, so we can break early) */
-    while (task != NULL)
+    if (g_cooperative_data.delayed_count > 0)
     {
-        rtos_tcb_t *next_task = task->next;
+        g_cooperative_data.delayed_count--;
+    }
 
-        if ((int32_t)(current_tick - task->delay_until) >= 0)
-        {
-            cooperative_remove_from_delayed_list_internal(task);
-            task->state = RTOS_TASK_STATE_READY;
+    return TIMER_WHEEL_ENTRY(node, rtos_tcb_t, delay_node);
+#else
+    rtos_tcb_t *task = g_cooperative_data.delayed_list;
 
-#if RTOS_PROFILING_SYSTEM_ENABLED
-            if (task->priority > 0)
-            {
-                task->ready_timestamp = rtos_profiling_get_cycles();
-            }
+    /* List is time-sorted, so only the head can be due */
+    if (task == NULL || (int32_t)(current_tick - task->delay_until) < 0)
+    {
+        return NULL;
+    }
+
+    cooperative_remove_from_delayed_list_internal(task);
+    return task;
 #endif
+}
+
+static void cooperative_update_delayed_tasks_internal(void)
+{
+    rtos_tick_t current_tick = rtos_get_tick_count();
+    rtos_tcb_t *task;
 
-            cooperative_add_to_ready_list_internal(task);
+    while ((task = cooperative_pop_expired_delayed_internal(current_tick)) != NULL)
+    {
+        task->state = RTOS_TASK_STATE_READY;
 
-            KLOGT(KEVT_SCHED_TASK_DELAY_EXPIRED, task->task_id, 0);
-        }
-        else
+#if RTOS_PROFILING_SYSTEM_ENABLED
+        if (task->priority > 0)
         {
-            /* Tasks are sorted by delay_until, so we can break */
-            break;
+            task->ready_timestamp = rtos_profiling_get_cycles();
         }
+#endif
 
-        task = next_task;
+        cooperative_add_to_ready_list_internal(task);
+        RTOS_SCHED_STAT_INC(tick_wakes);
+        PROF_TRACE(PEVT_TASK_UNBLOCK, task->task_id);
+
+        KLOGT(KEVT_SCHED_TASK_DELAY_EXPIRED, task->task_id, 0);
     }
 }
 
@@ -212,6 +274,10 @@ static rtos_status_t cooperative_init(rtos_scheduler_instance_t *instance)
     g_cooperative_data.ready_count   = 0;
     g_cooperative_data.delayed_count = 0;
 
+#if RTOS_USE_TIMING_WHEEL
+    timer_wheel_init(&g_task_delay_wheel, rtos_get_tick_count());
+#endif
+
     instance->private_data = &g_cooperative_data;
 
     KLOGT(KEVT_SCHEDULER_INIT, 0, 0);
@@ -252,6 +318,17 @@ static void cooperative_task_completed(rtos_scheduler_instance_t *instance, rtos
     }
 }
 
+static bool cooperative_reselects_current(rtos_scheduler_instance_t *instance, rtos_task_handle_t current)
+{
+    if (instance == NULL || current == NULL)
+    {
+        return false;
+    }
+
+    /* Alone on the ready list, the rotation puts it straight back at the head */
+    return g_cooperative_data.ready_list == NULL;
+}
+
 /* ========= Cooperative List Management Interface Implementation ========= */
 
 static void cooperative_add_to_ready_list(rtos_scheduler_instance_t *instance, rtos_task_handle_t task_handle)
@@ -305,48 +382,51 @@ static void cooperative_update_delayed_tasks(rtos_scheduler_instance_t *instance
     cooperative_update_delayed_tasks_internal();
 }
 
-static size_t cooperative_get_statistics(rtos_scheduler_instance_t *instance, void *stats_buffer, size_t buffer_size)
+static bool cooperative_get_next_wake_tick(rtos_scheduler_instance_t *instance, rtos_tick_t *wake_tick)
 {
-    if (instance == NULL || stats_buffer == NULL || buffer_size == 0)
+    if (instance == NULL || wake_tick == NULL)
     {
-        return 0;
+        return false;
     }
 
-    /* Simple statistics structure for cooperative scheduler */
-    typedef struct
-    {
-        uint8_t     ready_count;
-        uint8_t     delayed_count;
-        rtos_tick_t current_tick;
-        rtos_tcb_t *current_ready_task;
-    } cooperative_stats_t;
-
-    if (buffer_size < sizeof(cooperative_stats_t))
+#if RTOS_USE_TIMING_WHEEL
+    return timer_wheel_next_expiry(&g_task_delay_wheel, wake_tick);
+#else
+    /* Delayed list is time-sorted: the head wakes first */
+    if (g_cooperative_data.delayed_list == NULL)
     {
-        return 0;
+        return false;
     }
 
-    cooperative_stats_t *stats = (cooperative_stats_t *) stats_buffer;
+    *wake_tick = g_cooperative_data.delayed_list->delay_until;
+    return true;
+#endif
+}
 
-    stats->ready_count        = g_cooperative_data.ready_count;
-    stats->delayed_count      = g_cooperative_data.delayed_count;
-    stats->current_tick       = rtos_get_tick_count();
-    stats->current_ready_task = g_cooperative_data.ready_list;
+static void cooperative_get_statistics(rtos_scheduler_instance_t *instance, rtos_scheduler_stats_t *stats)
+{
+    if (instance == NULL || stats == NULL)
+    {
+        return;
+    }
 
-    return sizeof(cooperative_stats_t);
+    stats->ready_count   = g_cooperative_data.ready_count;
+    stats->delayed_count = g_cooperative_data.delayed_count;
 }
 
 const rtos_scheduler_t cooperative_scheduler = {
-    .init           = cooperative_init,
-    .get_next_task  = cooperative_get_next_task,
-    .should_preempt = cooperative_should_preempt,
-    .task_completed = cooperative_task_completed,
+    .init              = cooperative_init,
+    .get_next_task     = cooperative_get_next_task,
+    .should_preempt    = cooperative_should_preempt,
+    .task_completed    = cooperative_task_completed,
+    .reselects_current = cooperative_reselects_current,
 
     .add_to_ready_list        = cooperative_add_to_ready_list,
     .remove_from_ready_list   = cooperative_remove_from_ready_list,
     .add_to_delayed_list      = cooperative_add_to_delayed_list,
     .remove_from_delayed_list = cooperative_remove_from_delayed_list,
     .update_delayed_tasks     = cooperative_update_delayed_tasks,
+    .get_next_wake_tick       = cooperative_get_next_wake_tick,
 
     .get_statistics = cooperative_get_statistics};
 
@@ -361,3 +441,5 @@ rtos_tcb_t *rtos_task_get_next_ready_cooperative(void)
 {
     return cooperative_get_next_ready();
 }
+
+#endif /* !RTOS_SCHEDULER_STATIC_DISPATCH || RTOS_SCHEDULER_BACKEND_UNIT */
@@ -0,0 +1,502 @@
+#include "edf.h"
+
+#include "VRTOS.h"
+#include "config.h"
+#include "kernel_priv.h"
+#include "klog.h"
+#include "prof_trace.h"
+#include "scheduler.h"
+#include "task_priv.h"
+#include "timer_wheel.h"
+
+#include <string.h>
+
+/* Static dispatch compiles the selected backend into scheduler.c instead */
+#if !RTOS_SCHEDULER_STATIC_DISPATCH || defined(RTOS_SCHEDULER_BACKEND_UNIT)
+
+edf_private_data_t g_edf_data = {.ready_heap = {NULL}, .delayed_list = NULL, .ready_count = 0, .delayed_count = 0};
+
+/*
+ * Ready set is a binary min-heap over rtos_tcb_t pointers: insert and remove
+ * are O(log n), the next task is ready_heap[0].  Each TCB keeps its 1-based
+ * slot in heap_index so removal needs no search, and heap_index == 0 lets
+ * remove() ignore tasks that are not queued (e.g. the running task).
+ *
+ * Ordering: periodic tasks by absolute deadline (wrap-safe), then aperiodic
+ * tasks by priority.  Aperiodic tasks (idle, log flush, anything created
+ * with rtos_task_create) therefore only run in the slack periodic tasks leave.
+ * Equal deadlines fall back to priority as well.
+ */
+static bool edf_before(const rtos_tcb_t *a, const rtos_tcb_t *b)
+{
+    bool a_periodic = (a->flags & RTOS_TASK_FLAG_PERIODIC) != 0U;
+    bool b_periodic = (b->flags & RTOS_TASK_FLAG_PERIODIC) != 0U;
+
+    if (a_periodic != b_periodic)
+    {
+        return a_periodic;
+    }
+
+    if (a_periodic)
+    {
+        int32_t diff = (int32_t) (a->deadline - b->deadline);
+        if (diff != 0)
+        {
+            return diff < 0;
+        }
+    }
+
+    if (a->priority != b->priority)
+    {
+        return a->priority > b->priority;
+    }
+
+    /* Equal-priority aperiodic tasks: anything beats the idle task, which
+     * never yields and would otherwise keep a priority-0 task waiting */
+    return b == rtos_task_get_idle_task();
+}
+
+static void edf_heap_place(uint8_t slot, rtos_tcb_t *task)
+{
+    g_edf_data.ready_heap[slot] = task;
+    task->heap_index            = (uint8_t) (slot + 1U);
+}
+
+static void edf_heap_sift_up(uint8_t slot)
+{
+    rtos_tcb_t *task = g_edf_data.ready_heap[slot];
+
+    while (slot > 0)
+    {
+        uint8_t     parent      = (uint8_t) ((slot - 1U) / 2U);
+        rtos_tcb_t *parent_task = g_edf_data.ready_heap[parent];
+
+        if (!edf_before(task, parent_task))
+        {
+            break;
+        }
+
+        edf_heap_place(slot, parent_task);
+        slot = parent;
+    }
+
+    edf_heap_place(slot, task);
+}
+
+static void edf_heap_sift_down(uint8_t slot)
+{
+    rtos_tcb_t *task  = g_edf_data.ready_heap[slot];
+    uint8_t     count = g_edf_data.ready_count;
+
+    while (1)
+    {
+        uint8_t child = (uint8_t) (2U * slot + 1U);
+        if (child >= count)
+        {
+            break;
+        }
+
+        if (child + 1U < count && edf_before(g_edf_data.ready_heap[child + 1U], g_edf_data.ready_heap[child]))
+        {
+            child++;
+        }
+
+        if (!edf_before(g_edf_data.ready_heap[child], task))
+        {
+            break;
+        }
+
+        edf_heap_place(slot, g_edf_data.ready_heap[child]);
+        slot = child;
+    }
+
+    edf_heap_place(slot, task);
+}
+
+static void edf_add_to_ready_list_internal(rtos_task_handle_t task)
+{
+    if (task == NULL || task->heap_index != 0 || g_edf_data.ready_count >= RTOS_MAX_TASKS)
+    {
+        return;
+    }
+
+    uint8_t slot                = g_edf_data.ready_count++;
+    g_edf_data.ready_heap[slot] = task;
+    edf_heap_sift_up(slot);
+    RTOS_SCHED_STAT_HIGH_WATER(ready_high_water, g_edf_data.ready_count);
+
+    KLOGT(KEVT_SCHED_TASK_READY, task->task_id, (uint32_t) task->deadline);
+}
+
+static void edf_remove_from_ready_list_internal(rtos_task_handle_t task)
+{
+    /* Not queued (e.g. idle task already running) */
+    if (task == NULL || task->heap_index == 0)
+    {
+        return;
+    }
+
+    uint8_t slot     = (uint8_t) (task->heap_index - 1U);
+    task->heap_index = 0;
+
+    uint8_t     last_slot            = --g_edf_data.ready_count;
+    rtos_tcb_t *last                 = g_edf_data.ready_heap[last_slot];
+    g_edf_data.ready_heap[last_slot] = NULL;
+
+    if (slot < g_edf_data.ready_count)
+    {
+        /* Refill the hole with the last leaf; it moves at most one way */
+        g_edf_data.ready_heap[slot] = last;
+        edf_heap_sift_down(slot);
+        edf_heap_sift_up((uint8_t) (last->heap_index - 1U));
+    }
+
+    KLOGT(KEVT_SCHED_TASK_READY, task->task_id, g_edf_data.ready_count);
+}
+
+static void edf_add_to_delayed_list_internal(rtos_task_handle_t task, rtos_tick_t delay_ticks)
+{
+    if (task == NULL)
+    {
+        return;
+    }
+
+    task->delay_until = rtos_get_tick_count() + delay_ticks;
+
+#if RTOS_USE_TIMING_WHEEL
+    timer_wheel_insert(&g_task_delay_wheel, &task->delay_node, task->delay_until);
+    g_edf_data.delayed_count++;
+    RTOS_SCHED_STAT_HIGH_WATER(delayed_high_water, g_edf_data.delayed_count);
+
+    KLOGT(KEVT_SCHED_TASK_DELAYED, task->task_id, (uint32_t) task->delay_until);
+#else
+    task->next = NULL;
+    task->prev = NULL;
+
+    rtos_tcb_t **list_head = &g_edf_data.delayed_list;
+
+    if (*list_head == NULL)
+    {
+        *list_head               = task;
+        g_edf_data.delayed_count = 1;
+        RTOS_SCHED_STAT_HIGH_WATER(delayed_high_water, g_edf_data.delayed_count);
+        return;
+    }
+
+    /* Find insertion point (sorted by delay_until - earliest first) */
+    rtos_tcb_t *current = *list_head;
+    rtos_tcb_t *prev    = NULL;
+
+    while (current != NULL && (int32_t) (current->delay_until - task->delay_until) <= 0)
+    {
+        prev    = current;
+        current = current->next;
+    }
+
+    task->next = current;
+    task->prev = prev;
+
+    if (prev == NULL)
+    {
+        *list_head = task;
+    }
+    else
+    {
+        prev->next = task;
+    }
+
+    if (current != NULL)
+    {
+        current->prev = task;
+    }
+
+    g_edf_data.delayed_count++;
+    RTOS_SCHED_STAT_HIGH_WATER(delayed_high_water, g_edf_data.delayed_count);
+
+    KLOGT(KEVT_SCHED_TASK_DELAYED, task->task_id, (uint32_t) task->delay_until);
+#endif
+}
+
+static void edf_remove_from_delayed_list_internal(rtos_task_handle_t task)
+{
+#if RTOS_USE_TIMING_WHEEL
+    if (task == NULL || !timer_wheel_node_is_filed(&task->delay_node))
+    {
+        return;
+    }
+
+    timer_wheel_remove(&g_task_delay_wheel, &task->delay_node);
+
+    if (g_edf_data.delayed_count > 0)
+    {
+        g_edf_data.delayed_count--;
+    }
+#else
+    if (task == NULL || g_edf_data.delayed_list == NULL)
+    {
+        return;
+    }
+
+    /* Not on the delayed list (blocked without timeout) */
+    if (task->prev == NULL && g_edf_data.delayed_list != task)
+    {
+        return;
+    }
+
+    if (task->prev != NULL)
+    {
+        task->prev->next = task->next;
+    }
+    else
+    {
+        /* Task is at head */
+        g_edf_data.delayed_list = task->next;
+    }
+
+    if (task->next != NULL)
+    {
+        task->next->prev = task->prev;
+    }
+
+    task->next = NULL;
+    task->prev = NULL;
+
+    if (g_edf_data.delayed_count > 0)
+    {
+        g_edf_data.delayed_count--;
+    }
+#endif
+
+    KLOGT(KEVT_SCHED_TASK_DELAYED, task->task_id, g_edf_data.delayed_count);
+}
+
+/* Unlink the next delayed task that is due at current_tick, or return NULL */
+static rtos_tcb_t *edf_pop_expired_delayed_internal(rtos_tick_t current_tick)
+{
+#if RTOS_USE_TIMING_WHEEL
+    timer_wheel_node_t *node = timer_wheel_pop_expired(&g_task_delay_wheel, current_tick);
+    if (node == NULL)
+    {
+        return NULL;
+    }
+
+    if (g_edf_data.delayed_count > 0)
+    {
+        g_edf_data.delayed_count--;
+    }
+
+    return TIMER_WHEEL_ENTRY(node, rtos_tcb_t, delay_node);
+#else
+    rtos_tcb_t *task = g_edf_data.delayed_list;
+
+    /* List is time-sorted, so only the head can be due */
+    if (task == NULL || (int32_t) (current_tick - task->delay_until) < 0)
+    {
+        return NULL;
+    }
+
+    edf_remove_from_delayed_list_internal(task);
+    return task;
+#endif
+}
+
+static void edf_update_delayed_tasks_internal(void)
+{
+    rtos_tick_t current_tick = rtos_get_tick_count();
+    rtos_tcb_t *task;
+
+    while ((task = edf_pop_expired_delayed_internal(current_tick)) != NULL)
+    {
+        task->state = RTOS_TASK_STATE_READY;
+
+#if RTOS_PROFILING_SYSTEM_ENABLED
+        if (task->priority > 0)
+        {
+            task->ready_timestamp = rtos_profiling_get_cycles();
+        }
+#endif
+
+        edf_add_to_ready_list_internal(task);
+        RTOS_SCHED_STAT_INC(tick_wakes);
+        PROF_TRACE(PEVT_TASK_UNBLOCK, task->task_id);
+
+        KLOGT(KEVT_SCHED_TASK_DELAY_EXPIRED, task->task_id, 0);
+    }
+}
+
+static rtos_status_t edf_init(rtos_scheduler_instance_t *instance)
+{
+    if (instance == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    memset(g_edf_data.ready_heap, 0, sizeof(g_edf_data.ready_heap));
+    g_edf_data.delayed_list  = NULL;
+    g_edf_data.ready_count   = 0;
+    g_edf_data.delayed_count = 0;
+
+#if RTOS_USE_TIMING_WHEEL
+    timer_wheel_init(&g_task_delay_wheel, rtos_get_tick_count());
+#endif
+
+    instance->private_data = &g_edf_data;
+
+    KLOGT(KEVT_SCHEDULER_INIT, 0, 0);
+    return RTOS_SUCCESS;
+}
+
+static rtos_task_handle_t edf_get_next_task(rtos_scheduler_instance_t *instance)
+{
+    if (instance == NULL || g_edf_data.ready_count == 0)
+    {
+        return NULL;
+    }
+
+    return g_edf_data.ready_heap[0];
+}
+
+static bool edf_should_preempt(rtos_scheduler_instance_t *instance, rtos_task_handle_t new_task)
+{
+    if (instance == NULL || new_task == NULL || g_kernel.core[0].current_task == NULL)
+    {
+        return false;
+    }
+
+    /* Preempt only for a strictly earlier deadline: equal deadlines never
+     * switch, which bounds preemptions to one per release */
+    return (new_task != g_kernel.core[0].current_task && edf_before(new_task, g_kernel.core[0].current_task));
+}
+
+static void edf_task_completed(rtos_scheduler_instance_t *instance, rtos_task_handle_t completed_task)
+{
+    if (instance == NULL || completed_task == NULL)
+    {
+        return;
+    }
+
+    /* no-op: jobs end in rtos_task_wait_for_next_period(), which moves the deadline */
+}
+
+static bool edf_reselects_current(rtos_scheduler_instance_t *instance, rtos_task_handle_t current)
+{
+    if (instance == NULL || current == NULL)
+    {
+        return false;
+    }
+
+    /* Pushed back, current sifts up to the root only past a strictly later one */
+    return g_edf_data.ready_count == 0 || edf_before(current, g_edf_data.ready_heap[0]);
+}
+
+static void edf_add_to_ready_list(rtos_scheduler_instance_t *instance, rtos_task_handle_t task_handle)
+{
+    if (instance == NULL || task_handle == NULL)
+    {
+        return;
+    }
+
+    edf_add_to_ready_list_internal(task_handle);
+}
+
+static void edf_remove_from_ready_list(rtos_scheduler_instance_t *instance, rtos_task_handle_t task_handle)
+{
+    if (instance == NULL || task_handle == NULL)
+    {
+        return;
+    }
+
+    edf_remove_from_ready_list_internal(task_handle);
+}
+
+static void edf_add_to_delayed_list(rtos_scheduler_instance_t *instance, rtos_task_handle_t task_handle,
+                                    rtos_tick_t delay_ticks)
+{
+    if (instance == NULL || task_handle == NULL)
+    {
+        return;
+    }
+
+    edf_add_to_delayed_list_internal(task_handle, delay_ticks);
+}
+
+static void edf_remove_from_delayed_list(rtos_scheduler_instance_t *instance, rtos_task_handle_t task_handle)
+{
+    if (instance == NULL || task_handle == NULL)
+    {
+        return;
+    }
+
+    edf_remove_from_delayed_list_internal(task_handle);
+}
+
+static void edf_update_delayed_tasks(rtos_scheduler_instance_t *instance)
+{
+    if (instance == NULL)
+    {
+        return;
+    }
+
+    edf_update_delayed_tasks_internal();
+}
+
+static bool edf_get_next_wake_tick(rtos_scheduler_instance_t *instance, rtos_tick_t *wake_tick)
+{
+    if (instance == NULL || wake_tick == NULL)
+    {
+        return false;
+    }
+
+#if RTOS_USE_TIMING_WHEEL
+    return timer_wheel_next_expiry(&g_task_delay_wheel, wake_tick);
+#else
+    /* Delayed list is time-sorted: the head wakes first */
+    if (g_edf_data.delayed_list == NULL)
+    {
+        return false;
+    }
+
+    *wake_tick = g_edf_data.delayed_list->delay_until;
+    return true;
+#endif
+}
+
+static void edf_get_statistics(rtos_scheduler_instance_t *instance, rtos_scheduler_stats_t *stats)
+{
+    if (instance == NULL || stats == NULL)
+    {
+        return;
+    }
+
+    stats->ready_count   = g_edf_data.ready_count;
+    stats->delayed_count = g_edf_data.delayed_count;
+
+    /* Misses are counted per task when a late job ends */
+    uint32_t misses = 0;
+    for (uint8_t i = 0; i < RTOS_MAX_TASKS; i++)
+    {
+        if (g_task_pool[i].cold->task_function != NULL)
+        {
+            misses += g_task_pool[i].cold->deadline_misses;
+        }
+    }
+    stats->deadline_misses = misses;
+}
+
+const rtos_scheduler_t edf_scheduler = {
+    .init              = edf_init,
+    .get_next_task     = edf_get_next_task,
+    .should_preempt    = edf_should_preempt,
+    .task_completed    = edf_task_completed,
+    .reselects_current = edf_reselects_current,
+
+    .add_to_ready_list        = edf_add_to_ready_list,
+    .remove_from_ready_list   = edf_remove_from_ready_list,
+    .add_to_delayed_list      = edf_add_to_delayed_list,
+    .remove_from_delayed_list = edf_remove_from_delayed_list,
+    .update_delayed_tasks     = edf_update_delayed_tasks,
+    .get_next_wake_tick       = edf_get_next_wake_tick,
+
+    .get_statistics = edf_get_statistics};
+
+#endif /* !RTOS_SCHEDULER_STATIC_DISPATCH || RTOS_SCHEDULER_BACKEND_UNIT */
@@ -0,0 +1,29 @@
+#ifndef RTOS_EDF_H
+#define RTOS_EDF_H
+
+#include "config.h"
+#include "scheduler.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+extern const rtos_scheduler_t edf_scheduler;
+
+typedef struct
+{
+    rtos_tcb_t *ready_heap[RTOS_MAX_TASKS]; /**< Binary min-heap, earliest deadline at [0] */
+    rtos_tcb_t *delayed_list;               /**< Time-sorted delayed list */
+    uint8_t     ready_count;                /**< Number of tasks in ready_heap */
+    uint8_t     delayed_count;              /**< Number of delayed tasks */
+} edf_private_data_t;
+
+/* Private data instance — defined in edf.c */
+extern edf_private_data_t g_edf_data;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RTOS_EDF_H */
@@ -1,19 +1,71 @@
 #include "preemptive_sp.h"
 
 #include "VRTOS.h"
+#include "config.h"
 #include "kernel_priv.h"
 #include "klog.h"
+#include "prof_trace.h"
 #include "scheduler.h"
 #include "task_priv.h"
+#include "timer_wheel.h"
 
 #include <string.h>
 
+/* Static dispatch compiles the selected backend into scheduler.c instead */
+#if !RTOS_SCHEDULER_STATIC_DISPATCH || defined(RTOS_SCHEDULER_BACKEND_UNIT)
+
 preemptive_sp_private_data_t g_preemptive_sp_data = {
-    .ready_lists = {NULL}, .delayed_list = NULL, .ready_priorities = 0};
+    .ready_lists = {NULL}, .delayed_list = NULL, .ready_count = 0, .delayed_count = 0};
+
+/*
+ * Ready lists are intrusive circular doubly-linked lists: ready_lists[p] is
+ * the head (next to run) and ready_lists[p]->prev is the tail.  Append,
+ * remove and head-to-tail rotation are O(1) regardless of how many tasks
+ * share a priority.  A task that is not linked into any ready list has
+ * next == NULL, which lets remove() ignore stray calls cheaply.
+ */
+#if RTOS_USE_PREEMPTION_THRESHOLD
+/*
+ * Preemption thresholds.  A task switched out while still runnable with a
+ * threshold above its priority was preempted by a task above the threshold;
+ * it is stacked on preempted[] so selection resumes it before any ready task
+ * at or below the threshold.  Each preemptor outranks the thresholds below
+ * it, so the innermost entry is the only one selection needs to look at.
+ * An entry leaves the stack with its task's ready-list link.
+ */
+static void preemptive_sp_push_preempted(rtos_tcb_t *task)
+{
+    if (task != rtos_kernel_this_core()->current_task || task->preempt_threshold <= task->priority ||
+        g_preemptive_sp_data.preempted_count >= RTOS_MAX_TASKS)
+    {
+        return;
+    }
+
+    g_preemptive_sp_data.preempted[g_preemptive_sp_data.preempted_count++] = task;
+}
+
+static void preemptive_sp_drop_preempted(rtos_tcb_t *task)
+{
+    uint8_t count = g_preemptive_sp_data.preempted_count;
+
+    for (uint8_t i = count; i > 0U; i--)
+    {
+        if (g_preemptive_sp_data.preempted[i - 1U] == task)
+        {
+            for (uint8_t j = i; j < count; j++)
+            {
+                g_preemptive_sp_data.preempted[j - 1U] = g_preemptive_sp_data.preempted[j];
+            }
+            g_preemptive_sp_data.preempted_count = (uint8_t) (count - 1U);
+            return;
+        }
+    }
+}
+#endif
 
 static void preemptive_sp_add_to_ready_list_internal(rtos_task_handle_t task)
 {
-    if (task == NULL || task->priority >= RTOS_MAX_TASK_PRIORITIES)
+    if (task == NULL || !RTOS_PRIORITY_IN_RANGE(task->priority))
     {
         return;
     }
@@ -22,31 +74,45 @@ static void preemptive_sp_add_to_ready_list_internal(rtos_task_handle_t task)
     rtos_tcb_t    **list_head = &g_preemptive_sp_data.ready_lists[priority];
 
     /* Add to end of priority list (FIFO within same priority) */
-    task->next = NULL;
-    task->prev = NULL;
-
     if (*list_head == NULL)
     {
+        task->next = task;
+        task->prev = task;
         *list_head = task;
-        g_preemptive_sp_data.ready_priorities |= (1U << priority);
+        rtos_prio_bitmap_set(&g_preemptive_sp_data.ready_priorities, priority);
     }
     else
     {
-        rtos_tcb_t *current = *list_head;
-        while (current->next != NULL)
+        rtos_tcb_t *head = *list_head;
+        rtos_tcb_t *tail = head->prev;
+
+        task->next = head;
+        task->prev = tail;
+        tail->next = task;
+        head->prev = task;
+
+        /* A boosted task switched out while runnable is inside a mutex
+         * section; it resumes ahead of its new peers (the ones a ceiling
+         * is meant to hold off) instead of queueing behind them */
+        if (task->priority > task->base_priority && task == rtos_kernel_this_core()->current_task)
         {
-            current = current->next;
+            *list_head = task;
         }
-        current->next = task;
-        task->prev    = current;
     }
 
+    g_preemptive_sp_data.ready_count++;
+    RTOS_SCHED_STAT_HIGH_WATER(ready_high_water, g_preemptive_sp_data.ready_count);
+
+#if RTOS_USE_PREEMPTION_THRESHOLD
+    preemptive_sp_push_preempted(task);
+#endif
+
     KLOGT(KEVT_SCHED_TASK_READY, task->task_id, priority);
 }
 
 static void preemptive_sp_remove_from_ready_list_internal(rtos_task_handle_t task)
 {
-    if (task == NULL || task->priority >= RTOS_MAX_TASK_PRIORITIES)
+    if (task == NULL || !RTOS_PRIORITY_IN_RANGE(task->priority))
     {
         return;
     }
@@ -54,28 +120,39 @@ static void preemptive_sp_remove_from_ready_list_internal(rtos_task_handle_t tas
     rtos_priority_t priority  = task->priority;
     rtos_tcb_t    **list_head = &g_preemptive_sp_data.ready_lists[priority];
 
-    if (task->prev != NULL)
+    /* Not linked into a ready list (e.g. idle task already running) */
+    if (task->next == NULL || *list_head == NULL)
     {
-        task->prev->next = task->next;
+        return;
     }
-    else
+
+    if (task->next == task)
     {
-        *list_head = task->next;
+        /* Last task at this priority */
+        *list_head = NULL;
+        rtos_prio_bitmap_clear(&g_preemptive_sp_data.ready_priorities, priority);
     }
-
-    if (task->next != NULL)
+    else
     {
+        task->prev->next = task->next;
         task->next->prev = task->prev;
-    }
 
-    /* Clear priority bit if no more tasks at this priority */
-    if (*list_head == NULL)
-    {
-        g_preemptive_sp_data.ready_priorities &= ~(1U << priority);
+        if (*list_head == task)
+        {
+            *list_head = task->next;
+        }
     }
 
     task->next = NULL;
     task->prev = NULL;
+    g_preemptive_sp_data.ready_count--;
+
+#if RTOS_USE_PREEMPTION_THRESHOLD
+    if (g_preemptive_sp_data.preempted_count != 0U)
+    {
+        preemptive_sp_drop_preempted(task);
+    }
+#endif
 
     KLOGT(KEVT_SCHED_TASK_READY, task->task_id, priority);
 }
@@ -87,7 +164,16 @@ static void preemptive_sp_add_to_delayed_list_internal(rtos_task_handle_t task,
         return;
     }
 
-    task->delay_until      = rtos_get_tick_count() + delay_ticks;
+    task->delay_until = rtos_get_tick_count() + delay_ticks;
+
+    g_preemptive_sp_data.delayed_count++;
+    RTOS_SCHED_STAT_HIGH_WATER(delayed_high_water, g_preemptive_sp_data.delayed_count);
+
+#if RTOS_USE_TIMING_WHEEL
+    timer_wheel_insert(&g_task_delay_wheel, &task->delay_node, task->delay_until);
+
+    KLOGT(KEVT_SCHED_TASK_DELAYED, task->task_id, (uint32_t) task->delay_until);
+#else
     rtos_tcb_t **list_head = &g_preemptive_sp_data.delayed_list;
 
     task->next = NULL;
@@ -126,10 +212,20 @@ static void preemptive_sp_add_to_delayed_list_internal(rtos_task_handle_t task,
     }
 
     KLOGT(KEVT_SCHED_TASK_DELAYED, task->task_id, (uint32_t) task->delay_until);
+#endif
 }
 
 static void preemptive_sp_remove_from_delayed_list_internal(rtos_task_handle_t task)
 {
+#if RTOS_USE_TIMING_WHEEL
+    if (task == NULL || !timer_wheel_node_is_filed(&task->delay_node))
+    {
+        return;
+    }
+
+    timer_wheel_remove(&g_task_delay_wheel, &task->delay_node);
+    g_preemptive_sp_data.delayed_count--;
+#else
     if (task == NULL)
     {
         return;
@@ -137,6 +233,11 @@ static void preemptive_sp_remove_from_delayed_list_internal(rtos_task_handle_t t
 
     rtos_tcb_t **list_head = &g_preemptive_sp_data.delayed_list;
 
+    if (task->prev != NULL || *list_head == task)
+    {
+        g_preemptive_sp_data.delayed_count--;
+    }
+
     if (task->prev != NULL)
     {
         task->prev->next = task->next;
@@ -153,65 +254,120 @@ static void preemptive_sp_remove_from_delayed_list_internal(rtos_task_handle_t t
 
     task->next = NULL;
     task->prev = NULL;
+#endif
 
     KLOGT(KEVT_SCHED_TASK_DELAYED, task->task_id, 0);
 }
 
-static void preemptive_sp_update_delayed_tasks_internal(void)
+/* Unlink the next delayed task that is due at current_tick, or return NULL */
+static rtos_tcb_t *preemptive_sp_pop_expired_delayed_internal(rtos_tick_t current_tick)
 {
-    rtos_tick_t current_tick = rtos_get_tick_count();
-    rtos_tcb_t *task         = g_preemptive_sp_data.delayed_list;
-
-    /* Check delayed tasks (list is time-sorted, so we can break early) */
-    while (task != NULL)
+#if RTOS_USE_TIMING_WHEEL
+    timer_wheel_node_t *node = timer_wheel_pop_expired(&g_task_delay_wheel, current_tick);
+    if (node == NULL)
     {
-        rtos_tcb_t *next_task = task->next;
+        return NULL;
+    }
 
-        if ((int32_t)(current_tick - task->delay_until) >= 0)
-        {
-            preemptive_sp_remove_from_delayed_list_internal(task);
-            task->state = RTOS_TASK_STATE_READY;
+    g_preemptive_sp_data.delayed_count--;
+    return TIMER_WHEEL_ENTRY(node, rtos_tcb_t, delay_node);
+#else
+    rtos_tcb_t *task = g_preemptive_sp_data.delayed_list;
 
-#if RTOS_PROFILING_SYSTEM_ENABLED
-            if (task->priority > 0)
-            {
-                task->ready_timestamp = rtos_profiling_get_cycles();
-            }
+    /* List is time-sorted, so only the head can be due */
+    if (task == NULL || (int32_t)(current_tick - task->delay_until) < 0)
+    {
+        return NULL;
+    }
+
+    preemptive_sp_remove_from_delayed_list_internal(task);
+    return task;
 #endif
+}
 
-            preemptive_sp_add_to_ready_list_internal(task);
+static void preemptive_sp_update_delayed_tasks_internal(void)
+{
+    rtos_tick_t current_tick = rtos_get_tick_count();
+    rtos_tcb_t *task;
 
-            KLOGT(KEVT_SCHED_TASK_DELAY_EXPIRED, task->task_id, 0);
-        }
-        else
+    while ((task = preemptive_sp_pop_expired_delayed_internal(current_tick)) != NULL)
+    {
+        task->state = RTOS_TASK_STATE_READY;
+
+#if RTOS_PROFILING_SYSTEM_ENABLED
+        if (task->priority > 0)
         {
-            /* Tasks are sorted by delay_until, so we can break */
-            break;
+            task->ready_timestamp = rtos_profiling_get_cycles();
         }
+#endif
 
-        task = next_task;
+        preemptive_sp_add_to_ready_list_internal(task);
+        RTOS_SCHED_STAT_INC(tick_wakes);
+        PROF_TRACE(PEVT_TASK_UNBLOCK, task->task_id);
+
+        KLOGT(KEVT_SCHED_TASK_DELAY_EXPIRED, task->task_id, 0);
     }
 }
 
 static rtos_task_handle_t preemptive_sp_get_highest_priority_ready(void)
 {
-    /* Use bitmask to quickly find highest priority with ready tasks */
-    if (g_preemptive_sp_data.ready_priorities == 0)
+    /* One CLZ per bitmap level finds the highest priority with ready tasks */
+    if (rtos_prio_bitmap_is_empty(&g_preemptive_sp_data.ready_priorities))
     {
         return NULL; /* No ready tasks */
     }
 
-    for (int8_t priority = RTOS_MAX_TASK_PRIORITIES - 1; priority >= 0; priority--)
+    rtos_tcb_t *highest =
+        g_preemptive_sp_data.ready_lists[rtos_prio_bitmap_highest(&g_preemptive_sp_data.ready_priorities)];
+
+#if RTOS_USE_PREEMPTION_THRESHOLD
+    if (g_preemptive_sp_data.preempted_count != 0U)
     {
-        if (g_preemptive_sp_data.ready_priorities & (1U << priority))
+        rtos_tcb_t *held = g_preemptive_sp_data.preempted[g_preemptive_sp_data.preempted_count - 1U];
+
+        if (highest->priority <= held->preempt_threshold)
         {
-            return g_preemptive_sp_data.ready_lists[priority];
+            return held;
         }
     }
+#endif
 
-    return NULL; /* Shouldn't reach here if bitmask is correct */
+    return highest;
 }
 
+#if RTOS_SMP_CORES > 1
+/*
+ * Highest-priority ready task core may run, FIFO within a priority. Tasks
+ * running on another core are off the ready lists already. Starts at the
+ * bitmap's highest priority and skips tasks pinned elsewhere, so the common
+ * case (head of the top list is eligible) costs the same as single-core.
+ */
+static rtos_task_handle_t preemptive_sp_get_highest_ready_on_core(uint32_t core)
+{
+    if (rtos_prio_bitmap_is_empty(&g_preemptive_sp_data.ready_priorities))
+    {
+        return NULL;
+    }
+
+    for (int32_t p = (int32_t) rtos_prio_bitmap_highest(&g_preemptive_sp_data.ready_priorities); p >= 0; p--)
+    {
+        rtos_tcb_t *head = g_preemptive_sp_data.ready_lists[p];
+        rtos_tcb_t *task = head;
+
+        while (task != NULL)
+        {
+            if (rtos_task_runs_on_core(task, core))
+            {
+                return task;
+            }
+            task = (task->next == head) ? NULL : task->next;
+        }
+    }
+
+    return NULL;
+}
+#endif
+
 static rtos_status_t preemptive_sp_init(rtos_scheduler_instance_t *instance)
 {
     if (instance == NULL)
@@ -220,8 +376,17 @@ static rtos_status_t preemptive_sp_init(rtos_scheduler_instance_t *instance)
     }
 
     memset(g_preemptive_sp_data.ready_lists, 0, sizeof(g_preemptive_sp_data.ready_lists));
-    g_preemptive_sp_data.delayed_list     = NULL;
-    g_preemptive_sp_data.ready_priorities = 0;
+    g_preemptive_sp_data.delayed_list  = NULL;
+    g_preemptive_sp_data.ready_count   = 0;
+    g_preemptive_sp_data.delayed_count = 0;
+#if RTOS_USE_PREEMPTION_THRESHOLD
+    g_preemptive_sp_data.preempted_count = 0;
+#endif
+    rtos_prio_bitmap_init(&g_preemptive_sp_data.ready_priorities);
+
+#if RTOS_USE_TIMING_WHEEL
+    timer_wheel_init(&g_task_delay_wheel, rtos_get_tick_count());
+#endif
 
     instance->private_data = &g_preemptive_sp_data;
 
@@ -236,18 +401,39 @@ static rtos_task_handle_t preemptive_sp_get_next_task(rtos_scheduler_instance_t
         return NULL;
     }
 
+#if RTOS_SMP_CORES > 1
+    return preemptive_sp_get_highest_ready_on_core(rtos_port_get_core_id());
+#else
     return preemptive_sp_get_highest_priority_ready();
+#endif
 }
 
 static bool preemptive_sp_should_preempt(rtos_scheduler_instance_t *instance, rtos_task_handle_t new_task)
 {
-    if (instance == NULL || new_task == NULL || g_kernel.current_task == NULL)
+    rtos_tcb_t *current = rtos_kernel_this_core()->current_task;
+
+    if (instance == NULL || new_task == NULL || current == NULL)
     {
         return false;
     }
 
+#if RTOS_SMP_CORES > 1
+    if (!rtos_task_runs_on_core(new_task, rtos_port_get_core_id()))
+    {
+        return false; /* The kernel offers it to the other core */
+    }
+#endif
+
+#if RTOS_USE_PREEMPTION_THRESHOLD
+    /* Preempt only above the running task's threshold */
+    rtos_priority_t ceiling =
+        (current->preempt_threshold > current->priority) ? current->preempt_threshold : current->priority;
+#else
+    rtos_priority_t ceiling = current->priority;
+#endif
+
     /* Preempt if new task has higher priority */
-    return (new_task != g_kernel.current_task && new_task->priority > g_kernel.current_task->priority);
+    return (new_task != current && new_task->priority > ceiling);
 }
 
 static void preemptive_sp_task_completed(rtos_scheduler_instance_t *instance, rtos_task_handle_t completed_task)
@@ -260,6 +446,37 @@ static void preemptive_sp_task_completed(rtos_scheduler_instance_t *instance, rt
     /* no-op: state management is handled by the kernel */
 }
 
+static bool preemptive_sp_reselects_current(rtos_scheduler_instance_t *instance, rtos_task_handle_t current)
+{
+    if (instance == NULL || current == NULL || !RTOS_PRIORITY_IN_RANGE(current->priority))
+    {
+        return false;
+    }
+
+#if RTOS_SMP_CORES > 1
+    /* Selection skips tasks pinned elsewhere; leave it to the full path */
+    return false;
+#else
+    if (rtos_prio_bitmap_is_empty(&g_preemptive_sp_data.ready_priorities))
+    {
+        return true;
+    }
+
+    rtos_priority_t top = (rtos_priority_t) rtos_prio_bitmap_highest(&g_preemptive_sp_data.ready_priorities);
+
+#if RTOS_USE_PREEMPTION_THRESHOLD
+    /* Re-queued, current would be the innermost preempted[] entry */
+    if (current->preempt_threshold > current->priority)
+    {
+        return top <= current->preempt_threshold;
+    }
+#endif
+
+    /* Re-queued at the tail of its priority, or at the head while boosted */
+    return top < current->priority || (top == current->priority && current->priority > current->base_priority);
+#endif
+}
+
 static void preemptive_sp_add_to_ready_list(rtos_scheduler_instance_t *instance, rtos_task_handle_t task_handle)
 {
     if (instance == NULL || task_handle == NULL)
@@ -311,61 +528,45 @@ static void preemptive_sp_update_delayed_tasks(rtos_scheduler_instance_t *instan
     preemptive_sp_update_delayed_tasks_internal();
 }
 
-static size_t preemptive_sp_get_statistics(rtos_scheduler_instance_t *instance, void *stats_buffer, size_t buffer_size)
+static bool preemptive_sp_get_next_wake_tick(rtos_scheduler_instance_t *instance, rtos_tick_t *wake_tick)
 {
-    if (instance == NULL || stats_buffer == NULL || buffer_size == 0)
+    if (instance == NULL || wake_tick == NULL)
     {
-        return 0;
+        return false;
     }
 
-    typedef struct
-    {
-        uint8_t     ready_priorities_mask;
-        uint8_t     num_ready_tasks;
-        uint8_t     num_delayed_tasks;
-        rtos_tick_t current_tick;
-    } preemptive_sp_stats_t;
-
-    if (buffer_size < sizeof(preemptive_sp_stats_t))
+#if RTOS_USE_TIMING_WHEEL
+    return timer_wheel_next_expiry(&g_task_delay_wheel, wake_tick);
+#else
+    /* Delayed list is time-sorted: the head wakes first */
+    if (g_preemptive_sp_data.delayed_list == NULL)
     {
-        return 0;
+        return false;
     }
 
-    preemptive_sp_stats_t *stats = (preemptive_sp_stats_t *) stats_buffer;
-
-    stats->ready_priorities_mask = g_preemptive_sp_data.ready_priorities;
-    stats->current_tick          = rtos_get_tick_count();
-
-    uint8_t ready_count = 0;
-    for (uint8_t i = 0; i < RTOS_MAX_TASK_PRIORITIES; i++)
-    {
-        rtos_tcb_t *task = g_preemptive_sp_data.ready_lists[i];
-        while (task != NULL)
-        {
-            ready_count++;
-            task = task->next;
-        }
-    }
-    stats->num_ready_tasks = ready_count;
+    *wake_tick = g_preemptive_sp_data.delayed_list->delay_until;
+    return true;
+#endif
+}
 
-    uint8_t     delayed_count = 0;
-    rtos_tcb_t *task          = g_preemptive_sp_data.delayed_list;
-    while (task != NULL)
+static void preemptive_sp_get_statistics(rtos_scheduler_instance_t *instance, rtos_scheduler_stats_t *stats)
+{
+    if (instance == NULL || stats == NULL)
     {
-        delayed_count++;
-        task = task->next;
+        return;
     }
-    stats->num_delayed_tasks = delayed_count;
 
-    return sizeof(preemptive_sp_stats_t);
+    stats->ready_count   = g_preemptive_sp_data.ready_count;
+    stats->delayed_count = g_preemptive_sp_data.delayed_count;
 }
 
 const rtos_scheduler_t preemptive_sp_scheduler = {
     /* Core scheduling functions */
-    .init           = preemptive_sp_init,
-    .get_next_task  = preemptive_sp_get_next_task,
-    .should_preempt = preemptive_sp_should_preempt,
-    .task_completed = preemptive_sp_task_completed,
+    .init              = preemptive_sp_init,
+    .get_next_task     = preemptive_sp_get_next_task,
+    .should_preempt    = preemptive_sp_should_preempt,
+    .task_completed    = preemptive_sp_task_completed,
+    .reselects_current = preemptive_sp_reselects_current,
 
     /* List management operations */
     .add_to_ready_list        = preemptive_sp_add_to_ready_list,
@@ -373,6 +574,7 @@ const rtos_scheduler_t preemptive_sp_scheduler = {
     .add_to_delayed_list      = preemptive_sp_add_to_delayed_list,
     .remove_from_delayed_list = preemptive_sp_remove_from_delayed_list,
     .update_delayed_tasks     = preemptive_sp_update_delayed_tasks,
+    .get_next_wake_tick       = preemptive_sp_get_next_wake_tick,
 
     /* Optional statistics */
     .get_statistics = preemptive_sp_get_statistics};
@@ -380,4 +582,13 @@ const rtos_scheduler_t preemptive_sp_scheduler = {
 rtos_tcb_t *rtos_task_get_highest_priority_ready(void)
 {
     return preemptive_sp_get_highest_priority_ready();
-}
\ No newline at end of file
+}
+
+#if RTOS_SMP_CORES > 1
+rtos_tcb_t *rtos_task_get_highest_ready_on_core(uint32_t core)
+{
+    return preemptive_sp_get_highest_ready_on_core(core);
+}
+#endif
+
+#endif /* !RTOS_SCHEDULER_STATIC_DISPATCH || RTOS_SCHEDULER_BACKEND_UNIT */
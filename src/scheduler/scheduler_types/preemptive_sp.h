@@ -2,6 +2,7 @@
 #define RTOS_PREEMPTIVE_SP_H
 
 #include "config.h"
+#include "prio_bitmap.h"
 #include "scheduler.h"
 
 #ifdef __cplusplus
@@ -13,14 +14,25 @@ extern const rtos_scheduler_t preemptive_sp_scheduler;
 
 typedef struct
 {
-    rtos_tcb_t *ready_lists[RTOS_MAX_TASK_PRIORITIES]; /**< Ready lists per priority */
-    rtos_tcb_t *delayed_list;                          /**< Time-sorted delayed list */
-    uint8_t     ready_priorities; /**< Bitmask of priorities with ready tasks */
+    rtos_tcb_t        *ready_lists[RTOS_MAX_TASK_PRIORITIES]; /**< Circular ready lists per priority (head; tail is head->prev) */
+    rtos_tcb_t        *delayed_list;     /**< Time-sorted delayed list */
+    rtos_prio_bitmap_t ready_priorities; /**< Priorities with ready tasks */
+    uint8_t            ready_count;      /**< Tasks on the ready lists */
+    uint8_t            delayed_count;    /**< Delayed tasks */
+#if RTOS_USE_PREEMPTION_THRESHOLD
+    rtos_tcb_t *preempted[RTOS_MAX_TASKS]; /**< Ready tasks preempted inside their threshold, innermost last */
+    uint8_t     preempted_count;           /**< Entries in preempted[] */
+#endif
 } preemptive_sp_private_data_t;
 
 /* Private data instance — defined in preemptive_sp.c */
 extern preemptive_sp_private_data_t g_preemptive_sp_data;
 
+#if RTOS_SMP_CORES > 1
+/* Highest-priority ready task core may run, NULL if none (kernel lock held) */
+rtos_tcb_t *rtos_task_get_highest_ready_on_core(uint32_t core);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
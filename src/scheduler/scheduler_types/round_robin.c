@@ -4,71 +4,91 @@
 #include "config.h"
 #include "kernel_priv.h"
 #include "klog.h"
+#include "prof_trace.h"
 #include "scheduler.h"
 #include "task_priv.h"
+#include "timer_wheel.h"
 
 #include <string.h>
 
-round_robin_private_data_t g_round_robin_data = {.ready_list      = NULL,
-                                                  .ready_list_tail = NULL,
-                                                  .delayed_list    = NULL,
-                                                  .current_task    = NULL,
-                                                  .slice_remaining = 0,
-                                                  .ready_count     = 0,
-                                                  .delayed_count   = 0};
+/* Static dispatch compiles the selected backend into scheduler.c instead */
+#if !RTOS_SCHEDULER_STATIC_DISPATCH || defined(RTOS_SCHEDULER_BACKEND_UNIT)
 
+round_robin_private_data_t g_round_robin_data = {
+    .ready_lists = {NULL}, .delayed_list = NULL, .ready_count = 0, .delayed_count = 0};
+
+/*
+ * Priority-banded round robin (SCHED_RR): one circular FIFO per priority,
+ * laid out like preemptive_sp's (ready_lists[p] is the head, head->prev the
+ * tail) with the same ready-priority bitmask.  The highest non-empty band
+ * always runs; within a band tasks take turns, each for its own quantum
+ * (rtos_tcb_cold_t.time_slice).  Append, remove and rotation are O(1).
+ */
 static void round_robin_add_to_ready_list_internal(rtos_task_handle_t task)
 {
-    if (task == NULL)
+    if (task == NULL || !RTOS_PRIORITY_IN_RANGE(task->priority))
     {
         return;
     }
 
-    task->next = NULL;
-    task->prev = NULL;
+    rtos_priority_t priority  = task->priority;
+    rtos_tcb_t    **list_head = &g_round_robin_data.ready_lists[priority];
 
-    if (g_round_robin_data.ready_list == NULL)
+    if (*list_head == NULL)
     {
-        g_round_robin_data.ready_list      = task;
-        g_round_robin_data.ready_list_tail = task;
+        task->next = task;
+        task->prev = task;
+        *list_head = task;
+        rtos_prio_bitmap_set(&g_round_robin_data.ready_priorities, priority);
     }
     else
     {
-        g_round_robin_data.ready_list_tail->next = task;
-        task->prev                               = g_round_robin_data.ready_list_tail;
-        g_round_robin_data.ready_list_tail       = task;
+        rtos_tcb_t *head = *list_head;
+        rtos_tcb_t *tail = head->prev;
+
+        task->next = head;
+        task->prev = tail;
+        tail->next = task;
+        head->prev = task;
     }
 
     g_round_robin_data.ready_count++;
+    RTOS_SCHED_STAT_HIGH_WATER(ready_high_water, g_round_robin_data.ready_count);
 
     KLOGT(KEVT_SCHED_TASK_READY, task->task_id, g_round_robin_data.ready_count);
 }
 
 static void round_robin_remove_from_ready_list_internal(rtos_task_handle_t task)
 {
-    if (task == NULL || g_round_robin_data.ready_list == NULL)
+    if (task == NULL || !RTOS_PRIORITY_IN_RANGE(task->priority))
     {
         return;
     }
 
-    if (task->prev != NULL)
-    {
-        task->prev->next = task->next;
-    }
-    else
+    rtos_priority_t priority  = task->priority;
+    rtos_tcb_t    **list_head = &g_round_robin_data.ready_lists[priority];
+
+    /* Not linked into a ready list (e.g. idle task already running) */
+    if (task->next == NULL || *list_head == NULL)
     {
-        /* Task is at head - update head pointer */
-        g_round_robin_data.ready_list = task->next;
+        return;
     }
 
-    if (task->next != NULL)
+    if (task->next == task)
     {
-        task->next->prev = task->prev;
+        /* Last task at this priority */
+        *list_head = NULL;
+        rtos_prio_bitmap_clear(&g_round_robin_data.ready_priorities, priority);
     }
     else
     {
-        /* Task is at tail - update tail pointer */
-        g_round_robin_data.ready_list_tail = task->prev;
+        task->prev->next = task->next;
+        task->next->prev = task->prev;
+
+        if (*list_head == task)
+        {
+            *list_head = task->next;
+        }
     }
 
     task->next = NULL;
@@ -82,6 +102,12 @@ static void round_robin_remove_from_ready_list_internal(rtos_task_handle_t task)
     KLOGT(KEVT_SCHED_TASK_READY, task->task_id, g_round_robin_data.ready_count);
 }
 
+/* Highest priority with a ready task; only valid when ready_priorities is not empty */
+static inline rtos_priority_t round_robin_highest_ready_priority(void)
+{
+    return (rtos_priority_t) rtos_prio_bitmap_highest(&g_round_robin_data.ready_priorities);
+}
+
 static void round_robin_add_to_delayed_list_internal(rtos_task_handle_t task, rtos_tick_t delay_ticks)
 {
     if (task == NULL)
@@ -91,6 +117,13 @@ static void round_robin_add_to_delayed_list_internal(rtos_task_handle_t task, rt
 
     task->delay_until = rtos_get_tick_count() + delay_ticks;
 
+#if RTOS_USE_TIMING_WHEEL
+    timer_wheel_insert(&g_task_delay_wheel, &task->delay_node, task->delay_until);
+    g_round_robin_data.delayed_count++;
+    RTOS_SCHED_STAT_HIGH_WATER(delayed_high_water, g_round_robin_data.delayed_count);
+
+    KLOGT(KEVT_SCHED_TASK_DELAYED, task->task_id, (uint32_t) task->delay_until);
+#else
     task->next = NULL;
     task->prev = NULL;
 
@@ -100,6 +133,7 @@ static void round_robin_add_to_delayed_list_internal(rtos_task_handle_t task, rt
     {
         *list_head                       = task;
         g_round_robin_data.delayed_count = 1;
+        RTOS_SCHED_STAT_HIGH_WATER(delayed_high_water, g_round_robin_data.delayed_count);
         return;
     }
 
@@ -131,17 +165,38 @@ static void round_robin_add_to_delayed_list_internal(rtos_task_handle_t task, rt
     }
 
     g_round_robin_data.delayed_count++;
+    RTOS_SCHED_STAT_HIGH_WATER(delayed_high_water, g_round_robin_data.delayed_count);
 
     KLOGT(KEVT_SCHED_TASK_DELAYED, task->task_id, (uint32_t) task->delay_until);
+#endif
 }
 
 static void round_robin_remove_from_delayed_list_internal(rtos_task_handle_t task)
 {
+#if RTOS_USE_TIMING_WHEEL
+    if (task == NULL || !timer_wheel_node_is_filed(&task->delay_node))
+    {
+        return;
+    }
+
+    timer_wheel_remove(&g_task_delay_wheel, &task->delay_node);
+
+    if (g_round_robin_data.delayed_count > 0)
+    {
+        g_round_robin_data.delayed_count--;
+    }
+#else
     if (task == NULL || g_round_robin_data.delayed_list == NULL)
     {
         return;
     }
 
+    /* Not on the delayed list (blocked without timeout) */
+    if (task->prev == NULL && g_round_robin_data.delayed_list != task)
+    {
+        return;
+    }
+
     rtos_tcb_t **list_head = &g_round_robin_data.delayed_list;
 
     if (task->prev != NULL)
@@ -166,49 +221,94 @@ static void round_robin_remove_from_delayed_list_internal(rtos_task_handle_t tas
     {
         g_round_robin_data.delayed_count--;
     }
+#endif
 
     KLOGT(KEVT_SCHED_TASK_DELAYED, task->task_id, g_round_robin_data.delayed_count);
 }
 
-static void round_robin_update_delayed_tasks_internal(void)
+/* Unlink the next delayed task that is due at current_tick, or return NULL */
+static rtos_tcb_t *round_robin_pop_expired_delayed_internal(rtos_tick_t current_tick)
 {
-    rtos_tick_t current_tick = rtos_get_tick_count();
-    rtos_tcb_t *task         = g_round_robin_data.delayed_list;
+#if RTOS_USE_TIMING_WHEEL
+    timer_wheel_node_t *node = timer_wheel_pop_expired(&g_task_delay_wheel, current_tick);
+    if (node == NULL)
+    {
+        return NULL;
+    }
 
-    /* Check delayed tasks (list is time-sorted, so we can break early) */
-    while (task != NULL)
+    if (g_round_robin_data.delayed_count > 0)
     {
-        rtos_tcb_t *next_task = task->next;
+        g_round_robin_data.delayed_count--;
+    }
 
-        if ((int32_t)(current_tick - task->delay_until) >= 0)
-        {
-            round_robin_remove_from_delayed_list_internal(task);
-            task->state = RTOS_TASK_STATE_READY;
+    return TIMER_WHEEL_ENTRY(node, rtos_tcb_t, delay_node);
+#else
+    rtos_tcb_t *task = g_round_robin_data.delayed_list;
 
-#if RTOS_PROFILING_SYSTEM_ENABLED
-            if (task->priority > 0)
-            {
-                task->ready_timestamp = rtos_profiling_get_cycles();
-            }
+    /* List is time-sorted, so only the head can be due */
+    if (task == NULL || (int32_t)(current_tick - task->delay_until) < 0)
+    {
+        return NULL;
+    }
+
+    round_robin_remove_from_delayed_list_internal(task);
+    return task;
 #endif
+}
+
+static void round_robin_update_delayed_tasks_internal(void)
+{
+    rtos_tick_t current_tick = rtos_get_tick_count();
+    rtos_tcb_t *task;
 
-            round_robin_add_to_ready_list_internal(task);
+    while ((task = round_robin_pop_expired_delayed_internal(current_tick)) != NULL)
+    {
+        task->state = RTOS_TASK_STATE_READY;
 
-            KLOGT(KEVT_SCHED_TASK_DELAY_EXPIRED, task->task_id, 0);
-        }
-        else
+#if RTOS_PROFILING_SYSTEM_ENABLED
+        if (task->priority > 0)
         {
-            /* Tasks are sorted by delay_until, so we can break */
-            break;
+            task->ready_timestamp = rtos_profiling_get_cycles();
         }
+#endif
 
-        task = next_task;
+        round_robin_add_to_ready_list_internal(task);
+        RTOS_SCHED_STAT_INC(tick_wakes);
+        PROF_TRACE(PEVT_TASK_UNBLOCK, task->task_id);
+
+        KLOGT(KEVT_SCHED_TASK_DELAY_EXPIRED, task->task_id, 0);
     }
 }
 
 static rtos_task_handle_t round_robin_get_next_ready(void)
 {
-    return g_round_robin_data.ready_list;
+    if (rtos_prio_bitmap_is_empty(&g_round_robin_data.ready_priorities))
+    {
+        return NULL;
+    }
+
+    return g_round_robin_data.ready_lists[round_robin_highest_ready_priority()];
+}
+
+/*
+ * Charge the running task one tick of its quantum.  When it runs out with no
+ * peer in its band there is nobody to rotate to, so the quantum restarts
+ * instead of leaving a zero that would hand the CPU to the next peer the
+ * moment it wakes.
+ */
+static void round_robin_charge_slice_internal(void)
+{
+    rtos_tcb_t *current = g_kernel.core[0].current_task;
+
+    if (current == NULL || current->state != RTOS_TASK_STATE_RUNNING || current->time_slice_remaining == 0)
+    {
+        return;
+    }
+
+    if (--current->time_slice_remaining == 0 && g_round_robin_data.ready_lists[current->priority] == NULL)
+    {
+        current->time_slice_remaining = current->cold->time_slice;
+    }
 }
 
 static rtos_status_t round_robin_init(rtos_scheduler_instance_t *instance)
@@ -218,13 +318,15 @@ static rtos_status_t round_robin_init(rtos_scheduler_instance_t *instance)
         return RTOS_ERROR_INVALID_PARAM;
     }
 
-    g_round_robin_data.ready_list      = NULL;
-    g_round_robin_data.ready_list_tail = NULL;
-    g_round_robin_data.delayed_list    = NULL;
-    g_round_robin_data.current_task    = NULL;
-    g_round_robin_data.slice_remaining = RTOS_TIME_SLICE_TICKS;
-    g_round_robin_data.ready_count     = 0;
-    g_round_robin_data.delayed_count   = 0;
+    memset(g_round_robin_data.ready_lists, 0, sizeof(g_round_robin_data.ready_lists));
+    g_round_robin_data.delayed_list  = NULL;
+    g_round_robin_data.ready_count   = 0;
+    g_round_robin_data.delayed_count = 0;
+    rtos_prio_bitmap_init(&g_round_robin_data.ready_priorities);
+
+#if RTOS_USE_TIMING_WHEEL
+    timer_wheel_init(&g_task_delay_wheel, rtos_get_tick_count());
+#endif
 
     instance->private_data = &g_round_robin_data;
 
@@ -239,51 +341,48 @@ static rtos_task_handle_t round_robin_get_next_task(rtos_scheduler_instance_t *i
         return NULL;
     }
 
-    rtos_task_handle_t next = round_robin_get_next_ready();
-
-    if (next != NULL)
-    {
-        g_round_robin_data.current_task = next;
-    }
-
-    return next;
+    return round_robin_get_next_ready();
 }
 
 /**
  * For round robin, preemption occurs when:
- * 1. A new task becomes ready (basic check)
- * 2. The current task's time slice has expired (handled via tick handler)
+ * 1. A higher-priority task becomes ready
+ * 2. The running task has used up its quantum and an equal-priority peer is
+ *    ready (the quantum is charged on the tick path, see update_delayed_tasks)
  */
 static bool round_robin_should_preempt(rtos_scheduler_instance_t *instance, rtos_task_handle_t new_task)
 {
-    if (instance == NULL)
+    if (instance == NULL || new_task == NULL || g_kernel.core[0].current_task == NULL)
     {
         return false;
     }
 
-    /* Only decrement the time slice on the tick path (current task still running).
-     * When a new task becomes ready, new_task != current_task — skip decrement
-     * to avoid depleting the slice faster than intended. */
-    if (new_task == g_kernel.current_task)
+    rtos_tcb_t *current = g_kernel.core[0].current_task;
+
+    if (new_task == current)
     {
-        if (g_round_robin_data.slice_remaining > 0)
-        {
-            g_round_robin_data.slice_remaining--;
-        }
+        return false;
+    }
 
-        if (g_round_robin_data.slice_remaining == 0 && g_round_robin_data.ready_count > 1)
-        {
-            KLOGT(KEVT_SCHED_TIME_SLICE, 0, 0);
-            return true;
-        }
+    if (new_task->priority > current->priority)
+    {
+        return true;
+    }
+
+    if (new_task->priority == current->priority && current->time_slice_remaining == 0)
+    {
+        KLOGT(KEVT_SCHED_TIME_SLICE, current->task_id, 0);
+        return true;
     }
 
     return false;
 }
 
 /**
- * When a task yields or its time slice expires, rotate it to the end
- * of the ready queue to give other tasks a turn.
+ * Called at every switch-out, after the kernel has appended a still-READY
+ * task to the tail of its band.  A task preempted by a higher priority goes
+ * back to the head with the rest of its quantum; one that yielded or used
+ * up its quantum stays at the tail with a fresh one.
  */
 static void round_robin_task_completed(rtos_scheduler_instance_t *instance, rtos_task_handle_t completed_task)
 {
@@ -292,18 +391,42 @@ static void round_robin_task_completed(rtos_scheduler_instance_t *instance, rtos
         return;
     }
 
-    /* Rotate to next task */
-    if (completed_task->state == RTOS_TASK_STATE_READY)
+    if (completed_task->state != RTOS_TASK_STATE_READY || !RTOS_PRIORITY_IN_RANGE(completed_task->priority))
+    {
+        /* Blocked, suspended or deleted: the next run starts a full quantum */
+        completed_task->time_slice_remaining = completed_task->cold->time_slice;
+        return;
+    }
+
+    if (completed_task->time_slice_remaining > 0 &&
+        round_robin_highest_ready_priority() > completed_task->priority)
     {
-        round_robin_remove_from_ready_list_internal(completed_task);
-        round_robin_add_to_ready_list_internal(completed_task);
+        /* It is the tail, so making it the head is an O(1) rotation back */
+        g_round_robin_data.ready_lists[completed_task->priority] = completed_task;
+        return;
+    }
+
+    completed_task->time_slice_remaining = completed_task->cold->time_slice;
 
-        /* Reset time slice for next task */
-        g_round_robin_data.slice_remaining = RTOS_TIME_SLICE_TICKS;
-        g_round_robin_data.current_task    = NULL;
+    KLOGT(KEVT_SCHED_ROTATE, completed_task->task_id, 0);
+}
+
+static bool round_robin_reselects_current(rtos_scheduler_instance_t *instance, rtos_task_handle_t current)
+{
+    if (instance == NULL || current == NULL || !RTOS_PRIORITY_IN_RANGE(current->priority))
+    {
+        return false;
+    }
 
-        KLOGT(KEVT_SCHED_ROTATE, completed_task->task_id, 0);
+    /* A peer at its priority takes the turn; otherwise it stays, on a fresh quantum as task_completed gives it */
+    if (!rtos_prio_bitmap_is_empty(&g_round_robin_data.ready_priorities) &&
+        round_robin_highest_ready_priority() >= current->priority)
+    {
+        return false;
     }
+
+    current->time_slice_remaining = current->cold->time_slice;
+    return true;
 }
 
 /* ========= Round Robin List Management Interface Implementation ========= */
@@ -349,6 +472,7 @@ static void round_robin_remove_from_delayed_list(rtos_scheduler_instance_t *inst
     round_robin_remove_from_delayed_list_internal(task_handle);
 }
 
+/* Called once per tick by the tick handler, so it also charges the quantum */
 static void round_robin_update_delayed_tasks(rtos_scheduler_instance_t *instance)
 {
     if (instance == NULL)
@@ -357,52 +481,54 @@ static void round_robin_update_delayed_tasks(rtos_scheduler_instance_t *instance
     }
 
     round_robin_update_delayed_tasks_internal();
+    round_robin_charge_slice_internal();
 }
 
-static size_t round_robin_get_statistics(rtos_scheduler_instance_t *instance, void *stats_buffer, size_t buffer_size)
+static bool round_robin_get_next_wake_tick(rtos_scheduler_instance_t *instance, rtos_tick_t *wake_tick)
 {
-    if (instance == NULL || stats_buffer == NULL || buffer_size == 0)
+    if (instance == NULL || wake_tick == NULL)
     {
-        return 0;
+        return false;
     }
 
-    /* Statistics structure for round robin scheduler */
-    typedef struct
-    {
-        uint8_t     ready_count;
-        uint8_t     delayed_count;
-        rtos_tick_t slice_remaining;
-        rtos_tick_t current_tick;
-        rtos_tcb_t *current_task;
-    } round_robin_stats_t;
-
-    if (buffer_size < sizeof(round_robin_stats_t))
+#if RTOS_USE_TIMING_WHEEL
+    return timer_wheel_next_expiry(&g_task_delay_wheel, wake_tick);
+#else
+    /* Delayed list is time-sorted: the head wakes first */
+    if (g_round_robin_data.delayed_list == NULL)
     {
-        return 0;
+        return false;
     }
 
-    round_robin_stats_t *stats = (round_robin_stats_t *) stats_buffer;
+    *wake_tick = g_round_robin_data.delayed_list->delay_until;
+    return true;
+#endif
+}
 
-    stats->ready_count     = g_round_robin_data.ready_count;
-    stats->delayed_count   = g_round_robin_data.delayed_count;
-    stats->slice_remaining = g_round_robin_data.slice_remaining;
-    stats->current_tick    = rtos_get_tick_count();
-    stats->current_task    = g_round_robin_data.current_task;
+static void round_robin_get_statistics(rtos_scheduler_instance_t *instance, rtos_scheduler_stats_t *stats)
+{
+    if (instance == NULL || stats == NULL)
+    {
+        return;
+    }
 
-    return sizeof(round_robin_stats_t);
+    stats->ready_count   = g_round_robin_data.ready_count;
+    stats->delayed_count = g_round_robin_data.delayed_count;
 }
 
 const rtos_scheduler_t round_robin_scheduler = {
-    .init           = round_robin_init,
-    .get_next_task  = round_robin_get_next_task,
-    .should_preempt = round_robin_should_preempt,
-    .task_completed = round_robin_task_completed,
+    .init              = round_robin_init,
+    .get_next_task     = round_robin_get_next_task,
+    .should_preempt    = round_robin_should_preempt,
+    .task_completed    = round_robin_task_completed,
+    .reselects_current = round_robin_reselects_current,
 
     .add_to_ready_list        = round_robin_add_to_ready_list,
     .remove_from_ready_list   = round_robin_remove_from_ready_list,
     .add_to_delayed_list      = round_robin_add_to_delayed_list,
     .remove_from_delayed_list = round_robin_remove_from_delayed_list,
     .update_delayed_tasks     = round_robin_update_delayed_tasks,
+    .get_next_wake_tick       = round_robin_get_next_wake_tick,
 
     .get_statistics = round_robin_get_statistics};
 
@@ -418,3 +544,5 @@ rtos_tcb_t *rtos_task_get_next_ready_round_robin(void)
 {
     return round_robin_get_next_ready();
 }
+
+#endif /* !RTOS_SCHEDULER_STATIC_DISPATCH || RTOS_SCHEDULER_BACKEND_UNIT */
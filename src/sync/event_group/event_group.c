@@ -6,11 +6,19 @@
 #include "event_group.h"
 
 #include "VRTOS.h"
+#include "config.h"
+
+#if RTOS_USE_EVENT_GROUPS
+
+#include "deferred.h"
 #include "klog.h"
 #include "rtos_port.h"
 #include "task.h"
 #include "task_priv.h"
 
+/* CMSIS for LDREX/STREX, DMB */
+#include "device.h" // IWYU pragma: keep
+
 /* =================== Static Helpers =================== */
 
 /**
@@ -29,148 +37,238 @@ static bool eg_condition_met(uint32_t current_bits, uint32_t wait_bits, uint8_t
 }
 
 /**
- * @brief Insert a task into the event group's priority-ordered waiting list
+ * @brief Record what a task is about to wait for (rtos_kernel_block_on() queues it)
  */
-static void eg_add_to_waiting_list(rtos_event_group_t *eg, rtos_tcb_t *task, uint32_t bits_to_wait, uint8_t wait_all,
-                                   uint8_t clear_on_exit)
+static void eg_set_wait_condition(rtos_event_group_t *eg, rtos_tcb_t *task, uint32_t bits_to_wait, uint8_t wait_all,
+                                  uint8_t clear_on_exit)
 {
-    task->next_waiting      = NULL;
-    task->blocked_on        = eg;
-    task->blocked_on_type   = RTOS_SYNC_TYPE_EVENT_GROUP;
-    task->event_wait_bits   = bits_to_wait;
-    task->event_wait_all    = wait_all;
-    task->event_clear_on_exit = clear_on_exit;
-
-    if (eg->waiting_list == NULL)
-    {
-        eg->waiting_list = task;
-        return;
-    }
-
-    /* Insert in priority order (highest priority at head) */
-    rtos_tcb_t *current = eg->waiting_list;
-    rtos_tcb_t *prev    = NULL;
+    task->cold->event_wait_bits     = bits_to_wait;
+    task->cold->event_wait_all      = wait_all;
+    task->cold->event_clear_on_exit = clear_on_exit;
 
-    while (current != NULL && current->priority >= task->priority)
-    {
-        prev    = current;
-        current = current->next_waiting;
-    }
-
-    if (prev == NULL)
-    {
-        task->next_waiting = eg->waiting_list;
-        eg->waiting_list   = task;
-    }
-    else
-    {
-        task->next_waiting = current;
-        prev->next_waiting = task;
-    }
+    eg->waited_bits |= bits_to_wait;
 }
 
 /**
- * @brief Remove a task from the event group's waiting list
+ * @brief Remove a task from the event group's wait queue
  */
 static void eg_remove_from_waiting_list(rtos_event_group_t *eg, rtos_tcb_t *task)
 {
-    if (eg->waiting_list == NULL || task == NULL)
+    if (task == NULL)
     {
         return;
     }
 
-    if (eg->waiting_list == task)
-    {
-        eg->waiting_list = task->next_waiting;
-    }
-    else
+    rtos_wait_queue_remove(&eg->waiters, task);
+
+    /* waited_bits may over-approximate; it is exact again once nobody waits */
+    if (rtos_wait_queue_is_empty(&eg->waiters))
     {
-        rtos_tcb_t *current = eg->waiting_list;
-        while (current->next_waiting != NULL && current->next_waiting != task)
-        {
-            current = current->next_waiting;
-        }
-        if (current->next_waiting == task)
-        {
-            current->next_waiting = task->next_waiting;
-        }
+        eg->waited_bits = 0;
     }
 
-    task->next_waiting    = NULL;
     task->blocked_on      = NULL;
     task->blocked_on_type = RTOS_SYNC_TYPE_NONE;
 }
 
 /**
- * @brief Core set_bits logic shared between task and ISR variants
+ * @brief Wake every waiter whose condition the current bits satisfy
  *
  * Must be called inside a critical section. Builds a wake list of tasks
- * whose conditions are satisfied, applies deferred clear-on-exit, and
- * returns the wake list head. Caller is responsible for calling
- * rtos_kernel_task_unblock() on each task in the wake list after
+ * whose conditions are satisfied, applies deferred clear-on-exit, rebuilds
+ * waited_bits from the waiters that remain, and returns the wake list head.
+ * Caller is responsible for unblocking each task in the wake list after
  * exiting the critical section.
+ *
+ * @param bits_to_clear Bits the caller consumes itself (rtos_event_group_sync),
+ *                      cleared in the same step as the waiters' clear-on-exit bits
  */
-static rtos_tcb_t *eg_set_bits_internal(rtos_event_group_t *eg, uint32_t bits_to_set)
+static rtos_tcb_t *eg_collect_waiters(rtos_event_group_t *eg, uint32_t bits_to_clear)
 {
-    eg->bits |= bits_to_set;
-
-    KLOGD(KEVT_EG_SET, bits_to_set, eg->bits);
-
-    rtos_tcb_t *wake_list     = NULL;
-    uint32_t    bits_to_clear = 0;
+    rtos_tcb_t *wake_list    = NULL;
+    uint32_t    still_waited = 0;
 
-    rtos_tcb_t *current = eg->waiting_list;
-    rtos_tcb_t *prev    = NULL;
+    rtos_tcb_t *current = rtos_wait_queue_peek(&eg->waiters);
 
     while (current != NULL)
     {
-        rtos_tcb_t *next           = current->next_waiting;
-        uint32_t    orig_wait_bits = current->event_wait_bits;
+        rtos_tcb_t *next           = rtos_wait_queue_next(&eg->waiters, current);
+        uint32_t    orig_wait_bits = current->cold->event_wait_bits;
 
-        if (eg_condition_met(eg->bits, orig_wait_bits, current->event_wait_all))
+        if (eg_condition_met(eg->bits, orig_wait_bits, current->cold->event_wait_all))
         {
             /* Save bits snapshot for bits_out return value */
-            current->event_wait_bits = eg->bits;
+            current->cold->event_wait_bits = eg->bits;
 
-            if (current->event_clear_on_exit)
+            if (current->cold->event_clear_on_exit)
             {
                 bits_to_clear |= orig_wait_bits;
             }
 
-            /* Remove from waiting list */
-            if (prev == NULL)
-            {
-                eg->waiting_list = next;
-            }
-            else
-            {
-                prev->next_waiting = next;
-            }
+            rtos_wait_queue_remove(&eg->waiters, current);
 
             current->blocked_on      = NULL;
             current->blocked_on_type = RTOS_SYNC_TYPE_NONE;
 
-            /* Chain onto wake list */
+            /* Chain onto wake list (next_waiting is free once dequeued) */
             current->next_waiting = wake_list;
             wake_list             = current;
 
             KLOGD(KEVT_EG_WAKE, current->task_id, eg->bits);
-            /* prev stays the same — we removed current */
         }
         else
         {
-            prev = current;
+            still_waited |= orig_wait_bits;
         }
 
         current = next;
     }
 
     /* Deferred clear: apply after all waiters have been checked */
-    eg->bits &= ~bits_to_clear;
+    eg->bits        &= ~bits_to_clear;
+    eg->waited_bits  = still_waited;
 
     return wake_list;
 }
 
+/**
+ * @brief Core set_bits logic shared between task and ISR variants
+ *
+ * Must be called inside a critical section. Bits no waiter asks for cannot
+ * satisfy anyone, so the waiter walk is skipped unless bits_to_set meets
+ * waited_bits. bits_to_clear is applied after the waiters are matched, as
+ * for eg_collect_waiters().
+ */
+static rtos_tcb_t *eg_set_bits_internal(rtos_event_group_t *eg, uint32_t bits_to_set, uint32_t bits_to_clear)
+{
+    eg->bits |= bits_to_set;
+
+    KLOGD(KEVT_EG_SET, bits_to_set, eg->bits);
+
+    if ((bits_to_set & eg->waited_bits) == 0U)
+    {
+        eg->bits &= ~bits_to_clear;
+        return NULL;
+    }
+
+    return eg_collect_waiters(eg, bits_to_clear);
+}
+
+/**
+ * @brief Unblock every task on a wake list (task context)
+ */
+static void eg_unblock_list(rtos_tcb_t *wake_list)
+{
+    while (wake_list != NULL)
+    {
+        rtos_tcb_t *task   = wake_list;
+        wake_list          = task->next_waiting;
+        task->next_waiting = NULL;
+        rtos_kernel_task_unblock(task);
+    }
+}
+
+/**
+ * @brief Make every task on a wake list ready without yielding
+ *
+ * For ISRs, which pend PendSV once at exit, and for rtos_event_group_sync(),
+ * which releases all participants before its single reschedule. Nests inside
+ * a caller's critical section.
+ *
+ * @return true if any woken task should preempt the current one
+ */
+static bool eg_ready_list(rtos_tcb_t *wake_list)
+{
+    bool preempt = false;
+
+    while (wake_list != NULL)
+    {
+        rtos_tcb_t *task   = wake_list;
+        wake_list          = task->next_waiting;
+        task->next_waiting = NULL;
+        if (rtos_kernel_task_unblock_from_isr(task))
+        {
+            preempt = true;
+        }
+    }
+
+    return preempt;
+}
+
+/*
+ * The deferred ISR path reads waited_bits without the kernel lock. That is
+ * only safe on one core, where masking interrupts keeps every waiter from
+ * queueing meanwhile; on two, the other core may be queueing one, so the
+ * SMP build walks the waiters under the lock as without the daemon.
+ */
+#if RTOS_USE_DEFERRED_WORK && RTOS_SMP_CORES == 1
+
+#define EG_BITS_WORD(eg)    ((volatile uint32_t *) &(eg)->bits)
+#define EG_PENDING_WORD(eg) ((volatile uint32_t *) &(eg)->wake_pending)
+
+/* OR bits in without masking interrupts; returns the new value */
+static uint32_t eg_atomic_set_bits(rtos_event_group_t *eg, uint32_t bits_to_set)
+{
+    uint32_t bits;
+    do
+    {
+        bits = __LDREXW(EG_BITS_WORD(eg)) | bits_to_set;
+    } while (__STREXW(bits, EG_BITS_WORD(eg)) != 0U);
+
+    return bits;
+}
+
+/* Claim the single outstanding deferred wake; false if one is queued */
+static bool eg_claim_wake(rtos_event_group_t *eg)
+{
+    do
+    {
+        if (__LDREXW(EG_PENDING_WORD(eg)) != 0U)
+        {
+            __CLREX();
+            return false;
+        }
+    } while (__STREXW(1U, EG_PENDING_WORD(eg)) != 0U);
+
+    return true;
+}
+
+/**
+ * @brief Walk the waiters inside an ISR (the daemon queue is full)
+ */
+static bool eg_wake_from_isr(rtos_event_group_t *eg)
+{
+    uint32_t saved = rtos_port_enter_critical_from_isr();
+
+    rtos_tcb_t *wake_list = eg_collect_waiters(eg, 0);
+
+    rtos_port_exit_critical_from_isr(saved);
+
+    return eg_ready_list(wake_list);
+}
+
+/**
+ * @brief Deferred half of set_bits_from_isr, run by the daemon
+ *
+ * Matches waiters against the bits as they stand now, which includes every
+ * bit ISRs set since the wake was posted.
+ */
+static void eg_deferred_wake(void *parameter)
+{
+    rtos_event_group_t *eg = (rtos_event_group_t *) parameter;
+
+    rtos_port_enter_critical();
+
+    eg->wake_pending      = 0;
+    rtos_tcb_t *wake_list = eg_collect_waiters(eg, 0);
+
+    rtos_port_exit_critical();
+
+    eg_unblock_list(wake_list);
+}
+
+#endif /* RTOS_USE_DEFERRED_WORK && RTOS_SMP_CORES == 1 */
+
 /* =================== Public API =================== */
 
 rtos_eg_status_t rtos_event_group_init(rtos_event_group_t *eg)
@@ -183,7 +281,9 @@ rtos_eg_status_t rtos_event_group_init(rtos_event_group_t *eg)
     rtos_port_enter_critical();
 
     eg->bits         = 0;
-    eg->waiting_list = NULL;
+    eg->waited_bits  = 0;
+    eg->wake_pending = 0;
+    rtos_wait_queue_init(&eg->waiters);
 
     rtos_port_exit_critical();
 
@@ -233,29 +333,14 @@ rtos_eg_status_t rtos_event_group_wait_bits(rtos_event_group_t *eg, uint32_t bit
         return RTOS_EG_ERR_INVALID;
     }
 
-    eg_add_to_waiting_list(eg, current_task, bits_to_wait, (uint8_t) wait_all, (uint8_t) clear_on_exit);
+    eg_set_wait_condition(eg, current_task, bits_to_wait, (uint8_t) wait_all, (uint8_t) clear_on_exit);
 
     KLOGD(KEVT_EG_BLOCK, current_task->task_id, (uint32_t) timeout_ticks);
 
-    if (timeout_ticks == RTOS_EG_MAX_WAIT)
-    {
-        /* Infinite wait — block without delay timeout */
-        current_task->state = RTOS_TASK_STATE_BLOCKED;
-        rtos_scheduler_remove_from_ready_list(current_task);
-        rtos_port_exit_critical();
-        rtos_yield();
-    }
-    else
-    {
-        /* Timed wait — use kernel block with delay */
-        rtos_port_exit_critical();
-        rtos_kernel_task_block(current_task, timeout_ticks);
-    }
+    rtos_kernel_block_on(eg, RTOS_SYNC_TYPE_EVENT_GROUP, &eg->waiters, timeout_ticks);
 
     /* --- Task resumes here after unblock or timeout --- */
 
-    rtos_port_enter_critical();
-
     /* Check if we were woken by set_bits (blocked_on cleared) or timeout */
     if (current_task->blocked_on == eg)
     {
@@ -269,7 +354,7 @@ rtos_eg_status_t rtos_event_group_wait_bits(rtos_event_group_t *eg, uint32_t bit
     /* Woken by set_bits — event_wait_bits holds the bits snapshot */
     if (bits_out != NULL)
     {
-        *bits_out = current_task->event_wait_bits;
+        *bits_out = current_task->cold->event_wait_bits;
     }
 
     rtos_port_exit_critical();
@@ -285,44 +370,155 @@ rtos_eg_status_t rtos_event_group_set_bits(rtos_event_group_t *eg, uint32_t bits
 
     rtos_port_enter_critical();
 
-    rtos_tcb_t *wake_list = eg_set_bits_internal(eg, bits_to_set);
+    rtos_tcb_t *wake_list = eg_set_bits_internal(eg, bits_to_set, 0);
 
     rtos_port_exit_critical();
 
     /* Unblock all woken tasks outside critical section */
-    while (wake_list != NULL)
-    {
-        rtos_tcb_t *task = wake_list;
-        wake_list        = task->next_waiting;
-        task->next_waiting = NULL;
-        rtos_kernel_task_unblock(task);
-    }
+    eg_unblock_list(wake_list);
 
     return RTOS_EG_OK;
 }
 
-rtos_eg_status_t rtos_event_group_set_bits_from_isr(rtos_event_group_t *eg, uint32_t bits_to_set)
+rtos_eg_status_t rtos_event_group_set_bits_from_isr(rtos_event_group_t *eg, uint32_t bits_to_set,
+                                                    bool *higher_priority_task_woken)
 {
     if (eg == NULL)
     {
         return RTOS_EG_ERR_INVALID;
     }
 
+    bool preempt = false;
+
+#if RTOS_USE_DEFERRED_WORK && RTOS_SMP_CORES == 1
+    uint32_t bits = eg_atomic_set_bits(eg, bits_to_set);
+
+    KLOGD(KEVT_EG_SET, bits_to_set, bits);
+
+    /*
+     * Waiters are only inserted and removed with kernel interrupts masked, so
+     * waited_bits cannot change under us. One queued wake covers any number
+     * of ISR calls before the daemon runs.
+     */
+    if ((bits_to_set & eg->waited_bits) == 0U || !eg_claim_wake(eg))
+    {
+        return RTOS_EG_OK;
+    }
+
+    if (rtos_deferred_post_from_isr(eg_deferred_wake, eg, &preempt) != RTOS_SUCCESS)
+    {
+        /* Daemon queue full: do the walk here rather than lose the wake */
+        eg->wake_pending = 0;
+        preempt          = eg_wake_from_isr(eg);
+    }
+#else
     uint32_t saved = rtos_port_enter_critical_from_isr();
 
-    rtos_tcb_t *wake_list = eg_set_bits_internal(eg, bits_to_set);
+    rtos_tcb_t *wake_list = eg_set_bits_internal(eg, bits_to_set, 0);
 
     rtos_port_exit_critical_from_isr(saved);
 
-    /* Unblock all woken tasks outside ISR critical section */
-    while (wake_list != NULL)
+    preempt = eg_ready_list(wake_list);
+#endif
+
+    if (preempt && higher_priority_task_woken != NULL)
     {
-        rtos_tcb_t *task = wake_list;
-        wake_list        = task->next_waiting;
-        task->next_waiting = NULL;
-        rtos_kernel_task_unblock(task);
+        *higher_priority_task_woken = true;
+    }
+
+    return RTOS_EG_OK;
+}
+
+rtos_eg_status_t rtos_event_group_sync(rtos_event_group_t *eg, uint32_t bits_to_set, uint32_t bits_to_wait,
+                                       uint32_t *bits_out, rtos_tick_t timeout_ticks)
+{
+    if (eg == NULL || bits_to_wait == 0)
+    {
+        return RTOS_EG_ERR_INVALID;
+    }
+
+    rtos_tcb_t *current_task = rtos_task_get_current();
+    if (current_task == NULL)
+    {
+        KLOGE(KEVT_NO_CURRENT_TASK, 0, 0);
+        return RTOS_EG_ERR_INVALID;
+    }
+
+    rtos_port_enter_critical();
+
+    KLOGD(KEVT_EG_SYNC, bits_to_set, bits_to_wait);
+
+    uint32_t bits = eg->bits | bits_to_set;
+
+    /*
+     * Last to arrive: release everyone and consume the barrier bits in one
+     * step. Always walk the waiters, without eg_set_bits_internal()'s
+     * waited_bits shortcut: the barrier may complete on bits an ISR set
+     * whose deferred wake has not run yet, and clearing them unseen would
+     * lose that wake.
+     */
+    if ((bits & bits_to_wait) == bits_to_wait)
+    {
+        eg->bits |= bits_to_set;
+        KLOGD(KEVT_EG_SET, bits_to_set, eg->bits);
+
+        rtos_tcb_t *wake_list = eg_collect_waiters(eg, bits_to_wait);
+        bool        preempt   = eg_ready_list(wake_list);
+
+        rtos_port_exit_critical();
+
+        if (bits_out != NULL)
+        {
+            *bits_out = bits;
+        }
+        if (preempt)
+        {
+            rtos_yield();
+        }
+        return RTOS_EG_OK;
+    }
+
+    /*
+     * Not complete yet: publish our bits, ready anyone they satisfy (an
+     * any-bit waiter, say) and block, all before the section is left, so
+     * the switch out of rtos_kernel_block_on() is the only reschedule.
+     */
+    rtos_tcb_t *wake_list = eg_set_bits_internal(eg, bits_to_set, 0);
+    bool        preempt   = eg_ready_list(wake_list);
+
+    if (timeout_ticks == RTOS_EG_NO_WAIT)
+    {
+        rtos_port_exit_critical();
+        if (preempt)
+        {
+            rtos_yield();
+        }
+        return RTOS_EG_ERR_TIMEOUT;
     }
 
+    eg_set_wait_condition(eg, current_task, bits_to_wait, 1U, 1U);
+
+    KLOGD(KEVT_EG_BLOCK, current_task->task_id, (uint32_t) timeout_ticks);
+
+    rtos_kernel_block_on(eg, RTOS_SYNC_TYPE_EVENT_GROUP, &eg->waiters, timeout_ticks);
+
+    /* --- Task resumes here after the last participant arrived, or timeout --- */
+
+    if (current_task->blocked_on == eg)
+    {
+        /* Our bits stay set: the barrier did not complete */
+        eg_remove_from_waiting_list(eg, current_task);
+        rtos_port_exit_critical();
+        KLOGD(KEVT_EG_TIMEOUT, current_task->task_id, 0);
+        return RTOS_EG_ERR_TIMEOUT;
+    }
+
+    if (bits_out != NULL)
+    {
+        *bits_out = current_task->cold->event_wait_bits;
+    }
+
+    rtos_port_exit_critical();
     return RTOS_EG_OK;
 }
 
@@ -364,3 +560,5 @@ void rtos_event_group_remove_task_from_wait(void *eg_ptr, rtos_tcb_t *task)
 {
     eg_remove_from_waiting_list((rtos_event_group_t *) eg_ptr, task);
 }
+
+#endif /* RTOS_USE_EVENT_GROUPS */
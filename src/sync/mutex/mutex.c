@@ -4,86 +4,37 @@
 #include "kernel_priv.h"
 #include "klog.h"
 #include "rtos_port.h"
+#include "rwlock.h"
 #include "scheduler.h"
 #include "task.h"
 #include "task_priv.h"
 
 #include <string.h>
 
-static void mutex_add_to_waiting_list(rtos_mutex_t *m, rtos_tcb_t *task)
-{
-    task->next_waiting    = NULL;
-    task->blocked_on      = m;
-    task->blocked_on_type = RTOS_SYNC_TYPE_MUTEX;
-
-    if (m->waiting_list == NULL)
-    {
-        m->waiting_list = task;
-        return;
-    }
-
-    /* Insert in priority order (highest priority at head) */
-    rtos_tcb_t *current = m->waiting_list;
-    rtos_tcb_t *prev    = NULL;
-
-    while (current != NULL && current->priority >= task->priority)
-    {
-        prev    = current;
-        current = current->next_waiting;
-    }
-
-    if (prev == NULL)
-    {
-        task->next_waiting = m->waiting_list;
-        m->waiting_list    = task;
-    }
-    else
-    {
-        task->next_waiting = current;
-        prev->next_waiting = task;
-    }
-}
+/* CMSIS for LDREX/STREX, DMB */
+#include "device.h" // IWYU pragma: keep
 
 static void mutex_remove_from_waiting_list(rtos_mutex_t *m, rtos_tcb_t *task)
 {
-    if (m->waiting_list == NULL || task == NULL)
+    if (task == NULL)
     {
         return;
     }
 
-    if (m->waiting_list == task)
-    {
-        m->waiting_list = task->next_waiting;
-    }
-    else
-    {
-        rtos_tcb_t *current = m->waiting_list;
-        while (current->next_waiting != NULL && current->next_waiting != task)
-        {
-            current = current->next_waiting;
-        }
-        if (current->next_waiting == task)
-        {
-            current->next_waiting = task->next_waiting;
-        }
-    }
+    rtos_wait_queue_remove(&m->waiters, task);
 
-    task->next_waiting    = NULL;
     task->blocked_on      = NULL;
     task->blocked_on_type = RTOS_SYNC_TYPE_NONE;
 }
 
 static rtos_tcb_t *mutex_pop_highest_priority_waiter(rtos_mutex_t *m)
 {
-    if (m->waiting_list == NULL)
+    rtos_tcb_t *task = rtos_wait_queue_pop(&m->waiters);
+    if (task == NULL)
     {
         return NULL;
     }
 
-    /* Head is always highest priority due to ordered insertion */
-    rtos_tcb_t *task      = m->waiting_list;
-    m->waiting_list       = task->next_waiting;
-    task->next_waiting    = NULL;
     task->blocked_on      = NULL;
     task->blocked_on_type = RTOS_SYNC_TYPE_NONE;
 
@@ -104,12 +55,21 @@ static void mutex_apply_priority_inheritance(rtos_mutex_t *m, rtos_tcb_t *waiter
     uint32_t       safety_ctr = 0;
     const uint32_t max_depth  = 16;
 
+    /* Chain cost, logged per walk: owners visited and owners boosted */
+    uint32_t depth   = 0;
+    uint32_t boosted = 0;
+
+    RTOS_SYS_PROFILE_START(pip_walk);
+
     while (target_task != NULL && safety_ctr < max_depth)
     {
+        depth++;
+
         /* If target has lower priority than current boost priority, boost it */
         if (target_task->priority < boost_prio)
         {
             KLOGD(KEVT_MUTEX_PIP_BOOST, target_task->task_id, boost_prio);
+            boosted++;
 
             /*
              * If the boosted task is currently in the READY list it is stored
@@ -144,6 +104,11 @@ static void mutex_apply_priority_inheritance(rtos_mutex_t *m, rtos_tcb_t *waiter
             target_task->blocked_on != NULL)
         {
             rtos_mutex_t *next_mutex = (rtos_mutex_t *) target_task->blocked_on;
+
+            /* A boosted waiter moves up in that mutex's wait queue too, so its
+             * owner inherits the boost when it recomputes its priority */
+            rtos_wait_queue_requeue(&next_mutex->waiters, target_task);
+
             current_task             = target_task;
             target_task              = next_mutex->owner;
         }
@@ -156,21 +121,39 @@ static void mutex_apply_priority_inheritance(rtos_mutex_t *m, rtos_tcb_t *waiter
         safety_ctr++;
     }
 
+    RTOS_SYS_PROFILE_END(pip_walk, &g_prof_pip_walk);
+
+    KLOGD(KEVT_MUTEX_PIP_CHAIN, depth, boosted);
+
     if (safety_ctr >= max_depth)
     {
         KLOGE(KEVT_MUTEX_DEADLOCK, safety_ctr, max_depth);
     }
 }
 
+/*
+ * Immediate priority ceiling: the owner runs at m's ceiling while it holds
+ * m.  The owner is running (lock) or blocked (hand-off), so it is on no
+ * ready list and the raise is a single write.
+ */
+static void mutex_raise_to_ceiling(rtos_mutex_t *m, rtos_tcb_t *owner)
+{
+    if (owner->priority < m->ceiling)
+    {
+        KLOGD(KEVT_MUTEX_PIP_BOOST, owner->task_id, m->ceiling);
+        owner->priority = m->ceiling;
+    }
+}
+
 static void mutex_remove_from_held_list(rtos_tcb_t *task, rtos_mutex_t *m)
 {
-    if (task->held_mutex_list == m)
+    if (task->cold->held_mutex_list == m)
     {
-        task->held_mutex_list = m->next_held;
+        task->cold->held_mutex_list = m->next_held;
     }
     else
     {
-        rtos_mutex_t *cur = task->held_mutex_list;
+        rtos_mutex_t *cur = task->cold->held_mutex_list;
         while (cur != NULL && cur->next_held != m)
         {
             cur = cur->next_held;
@@ -192,11 +175,27 @@ static void mutex_restore_priority(rtos_tcb_t *task)
 
     rtos_priority_t max_prio = task->base_priority;
 
-    for (rtos_mutex_t *m = task->held_mutex_list; m != NULL; m = m->next_held)
+    for (rtos_mutex_t *m = task->cold->held_mutex_list; m != NULL; m = m->next_held)
     {
-        if (m->waiting_list != NULL && m->waiting_list->priority > max_prio)
+        if (m->ceiling > max_prio)
         {
-            max_prio = m->waiting_list->priority;
+            max_prio = m->ceiling;
+        }
+
+        rtos_tcb_t *top = rtos_wait_queue_peek(&m->waiters);
+        if (top != NULL && top->priority > max_prio)
+        {
+            max_prio = top->priority;
+        }
+
+        /* Readers the writer holds off inherit through the write lock too */
+        if (m->rwlock_writer)
+        {
+            top = rtos_wait_queue_peek(&((rtos_rwlock_t *) m)->read_waiters);
+            if (top != NULL && top->priority > max_prio)
+            {
+                max_prio = top->priority;
+            }
         }
     }
 
@@ -207,6 +206,92 @@ static void mutex_restore_priority(rtos_tcb_t *task)
     }
 }
 
+/*
+ * Uncontended fast paths.  A free mutex is claimed, and a mutex nobody waits
+ * for is released, with LDREX/STREX on the owner word instead of the BASEPRI
+ * critical section.  Every slow-path caller that could change the mutex in
+ * between runs in another task, and the context switch to it clears the
+ * exclusive monitor, so the STREX fails and the caller falls back to the
+ * critical section.  ISRs never lock mutexes.
+ *
+ * That argument needs one core: a slow path on another core queues a waiter
+ * without touching the owner word or this core's monitor.  With
+ * RTOS_SMP_CORES > 1 both fast paths report "take the slow path".
+ */
+#if RTOS_SMP_CORES == 1
+#define MUTEX_OWNER_WORD(m) ((volatile uint32_t *) (uintptr_t) &(m)->owner)
+
+/* Claim a free mutex; false if it is owned */
+static bool mutex_try_claim(rtos_mutex_t *m, rtos_tcb_t *task)
+{
+    do
+    {
+        if (__LDREXW(MUTEX_OWNER_WORD(m)) != 0U)
+        {
+            __CLREX();
+            return false;
+        }
+    } while (__STREXW((uint32_t) (uintptr_t) task, MUTEX_OWNER_WORD(m)) != 0U);
+
+    /* Protected data is only touched after the claim */
+    __DMB();
+
+    m->lock_count               = 1;
+    m->next_held                = task->cold->held_mutex_list;
+    task->cold->held_mutex_list = m;
+
+    return true;
+}
+
+/*
+ * Release the last lock level when there is nothing for the slow path to do:
+ * no waiter to hand over to and no inherited priority to drop.  false means
+ * take the slow path; the mutex may already be off the held list, which the
+ * slow path tolerates.
+ */
+static bool mutex_try_release(rtos_mutex_t *m, rtos_tcb_t *task)
+{
+    if (m->lock_count != 1U || task->priority != task->base_priority)
+    {
+        return false;
+    }
+
+    /* Off our held list before a new owner can link it into theirs */
+    mutex_remove_from_held_list(task, m);
+
+    /* Protected data writes complete before the release */
+    __DMB();
+
+    do
+    {
+        if (__LDREXW(MUTEX_OWNER_WORD(m)) != (uint32_t) (uintptr_t) task ||
+            !rtos_wait_queue_is_empty(&m->waiters))
+        {
+            __CLREX();
+            return false;
+        }
+
+        m->lock_count = 0;
+    } while (__STREXW(0U, MUTEX_OWNER_WORD(m)) != 0U);
+
+    return true;
+}
+#else
+static inline bool mutex_try_claim(rtos_mutex_t *m, rtos_tcb_t *task)
+{
+    (void) m;
+    (void) task;
+    return false;
+}
+
+static inline bool mutex_try_release(rtos_mutex_t *m, rtos_tcb_t *task)
+{
+    (void) m;
+    (void) task;
+    return false;
+}
+#endif /* RTOS_SMP_CORES == 1 */
+
 /**
  * @brief Initialize a mutex
  */
@@ -219,10 +304,12 @@ rtos_mutex_status_t rtos_mutex_init(rtos_mutex_t *m)
 
     rtos_port_enter_critical();
 
-    m->owner        = NULL;
-    m->waiting_list = NULL;
-    m->next_held    = NULL;
-    m->lock_count   = 0;
+    m->owner         = NULL;
+    m->next_held     = NULL;
+    m->lock_count    = 0;
+    m->ceiling       = 0;
+    m->rwlock_writer = false;
+    rtos_wait_queue_init(&m->waiters);
 
     rtos_port_exit_critical();
 
@@ -230,6 +317,25 @@ rtos_mutex_status_t rtos_mutex_init(rtos_mutex_t *m)
     return RTOS_MUTEX_OK;
 }
 
+/**
+ * @brief Initialize a priority-ceiling mutex
+ */
+rtos_mutex_status_t rtos_mutex_init_ceiling(rtos_mutex_t *m, rtos_priority_t ceiling)
+{
+    if (ceiling == 0U || !RTOS_PRIORITY_IN_RANGE(ceiling))
+    {
+        return RTOS_MUTEX_ERR_INVALID;
+    }
+
+    rtos_mutex_status_t status = rtos_mutex_init(m);
+    if (status == RTOS_MUTEX_OK)
+    {
+        m->ceiling = ceiling;
+    }
+
+    return status;
+}
+
 /**
  * @brief Lock/acquire a mutex
  */
@@ -240,74 +346,76 @@ rtos_mutex_status_t rtos_mutex_lock(rtos_mutex_t *m, rtos_tick_t timeout_ticks)
         return RTOS_MUTEX_ERR_INVALID;
     }
 
-    rtos_port_enter_critical();
-
     rtos_tcb_t *current_task = rtos_task_get_current();
     if (current_task == NULL)
     {
-        rtos_port_exit_critical();
         KLOGE(KEVT_NO_CURRENT_TASK, 0, 0);
         return RTOS_MUTEX_ERR_INVALID;
     }
 
-    /* Fast path: mutex is free */
-    if (m->owner == NULL)
-    {
-        m->owner      = current_task;
-        m->lock_count = 1;
-        m->next_held  = current_task->held_mutex_list;
-        current_task->held_mutex_list = m;
-        rtos_port_exit_critical();
-        KLOGD(KEVT_MUTEX_LOCK, current_task->task_id, 0);
-        return RTOS_MUTEX_OK;
-    }
-
+    /* Recursive lock: only the owner itself touches lock_count, so re-entry
+     * needs no atomic; it passed the ceiling check on the first lock */
     if (m->owner == current_task)
     {
         if (m->lock_count < 255)
         {
             m->lock_count++;
-            rtos_port_exit_critical();
             KLOGD(KEVT_MUTEX_RECURSIVE, current_task->task_id, m->lock_count);
             return RTOS_MUTEX_OK;
         }
         else
         {
-            rtos_port_exit_critical();
             KLOGE(KEVT_MUTEX_MAX_RECURSION, current_task->task_id, 0);
             return RTOS_MUTEX_ERR_GENERAL;
         }
     }
 
-    if (timeout_ticks == RTOS_NO_WAIT)
+    /* The ceiling must cover every task that locks m */
+    if (m->ceiling != 0U && current_task->base_priority > m->ceiling)
     {
-        rtos_port_exit_critical();
-        return RTOS_MUTEX_ERR_TIMEOUT;
+        KLOGE(KEVT_MUTEX_CEILING_VIOLATION, current_task->task_id, m->ceiling);
+        return RTOS_MUTEX_ERR_INVALID;
     }
 
-    mutex_apply_priority_inheritance(m, current_task);
-    mutex_add_to_waiting_list(m, current_task);
+    /* Fast path: mutex is free, and no ceiling to raise the owner to */
+    if (current_task->priority >= m->ceiling && mutex_try_claim(m, current_task))
+    {
+        KLOGD(KEVT_MUTEX_LOCK, current_task->task_id, 0);
+        return RTOS_MUTEX_OK;
+    }
 
-    KLOGD(KEVT_MUTEX_BLOCK, current_task->task_id, (uint32_t) timeout_ticks);
+    rtos_port_enter_critical();
 
-    if (timeout_ticks == RTOS_MAX_WAIT)
+    /* Free (a ceiling mutex, released since the fast path looked, or no fast path) */
+    if (m->owner == NULL)
     {
-        /* Infinite wait - block without delay timeout */
-        current_task->state = RTOS_TASK_STATE_BLOCKED;
-        rtos_scheduler_remove_from_ready_list(current_task);
+        m->owner                            = current_task;
+        m->lock_count                       = 1;
+        m->next_held                        = current_task->cold->held_mutex_list;
+        current_task->cold->held_mutex_list = m;
+        mutex_raise_to_ceiling(m, current_task);
         rtos_port_exit_critical();
-        rtos_yield();
+        KLOGD(KEVT_MUTEX_LOCK, current_task->task_id, 0);
+        return RTOS_MUTEX_OK;
     }
-    else
+
+    if (timeout_ticks == RTOS_NO_WAIT)
     {
-        /* Timed wait - use kernel block with delay */
         rtos_port_exit_critical();
-        rtos_kernel_task_block(current_task, timeout_ticks);
+        return RTOS_MUTEX_ERR_TIMEOUT;
     }
 
-    /* --- Task resumes here after unblock or timeout --- */
+    /* The owner of a ceiling mutex already runs at the ceiling: nothing to walk */
+    if (m->ceiling == 0U)
+    {
+        mutex_apply_priority_inheritance(m, current_task);
+    }
 
-    rtos_port_enter_critical();
+    KLOGD(KEVT_MUTEX_BLOCK, current_task->task_id, (uint32_t) timeout_ticks);
+
+    rtos_kernel_block_on(m, RTOS_SYNC_TYPE_MUTEX, &m->waiters, timeout_ticks);
+
+    /* --- Task resumes here after unblock or timeout --- */
 
     /* Check if we were woken by unlock (blocked_on cleared) or timeout */
     if (current_task->blocked_on == m)
@@ -324,6 +432,18 @@ rtos_mutex_status_t rtos_mutex_lock(rtos_mutex_t *m, rtos_tick_t timeout_ticks)
     return RTOS_MUTEX_OK;
 }
 
+/**
+ * @brief Boost m's owner chain for a task that waits on m's behalf without
+ *        being queued on m (rwlock readers); caller holds the critical section
+ */
+void rtos_mutex_inherit_priority(rtos_mutex_t *m, rtos_tcb_t *waiter)
+{
+    if (m->owner != NULL && m->ceiling == 0U)
+    {
+        mutex_apply_priority_inheritance(m, waiter);
+    }
+}
+
 /**
  * @brief Unlock/release a mutex
  */
@@ -332,6 +452,16 @@ void rtos_mutex_remove_task_from_wait(void *mutex_ptr, rtos_tcb_t *task)
     mutex_remove_from_waiting_list((rtos_mutex_t *) mutex_ptr, task);
 }
 
+/**
+ * @brief Recompute a task's effective priority after its base_priority changed
+ *
+ * Caller holds the critical section and requeues the task if it is READY.
+ */
+void rtos_mutex_restore_task_priority(rtos_tcb_t *task)
+{
+    mutex_restore_priority(task);
+}
+
 rtos_mutex_status_t rtos_mutex_unlock(rtos_mutex_t *m)
 {
     if (m == NULL)
@@ -339,26 +469,32 @@ rtos_mutex_status_t rtos_mutex_unlock(rtos_mutex_t *m)
         return RTOS_MUTEX_ERR_INVALID;
     }
 
-    rtos_port_enter_critical();
-
     rtos_tcb_t *current_task = rtos_task_get_current();
+    rtos_tcb_t *owner        = m->owner;
 
     /* Only owner can unlock */
-    if (m->owner != current_task)
+    if (current_task == NULL || owner != current_task)
     {
-        rtos_port_exit_critical();
-        KLOGE(KEVT_MUTEX_UNLOCK, m->owner ? m->owner->task_id : 0xFF, current_task ? current_task->task_id : 0xFF);
+        KLOGE(KEVT_MUTEX_UNLOCK, owner ? owner->task_id : 0xFF, current_task ? current_task->task_id : 0xFF);
         return RTOS_MUTEX_ERR_INVALID;
     }
 
     if (m->lock_count > 1)
     {
         m->lock_count--;
-        rtos_port_exit_critical();
         KLOGD(KEVT_MUTEX_RECURSIVE, current_task->task_id, m->lock_count);
         return RTOS_MUTEX_OK;
     }
 
+    /* Fast path: no waiter and no inherited priority */
+    if (mutex_try_release(m, current_task))
+    {
+        KLOGD(KEVT_MUTEX_UNLOCK, current_task->task_id, 0);
+        return RTOS_MUTEX_OK;
+    }
+
+    rtos_port_enter_critical();
+
     /* Full unlock - remove from held list, then restore priority */
     mutex_remove_from_held_list(current_task, m);
     mutex_restore_priority(current_task);
@@ -377,23 +513,33 @@ rtos_mutex_status_t rtos_mutex_unlock(rtos_mutex_t *m)
     rtos_tcb_t *waiter = mutex_pop_highest_priority_waiter(m);
     if (waiter != NULL)
     {
-        m->owner      = waiter;
-        m->lock_count = 1;
-        m->next_held  = waiter->held_mutex_list;
-        waiter->held_mutex_list = m;
+        m->owner                      = waiter;
+        m->lock_count                 = 1;
+        m->next_held                  = waiter->cold->held_mutex_list;
+        waiter->cold->held_mutex_list = m;
+        mutex_raise_to_ceiling(m, waiter);
 
         KLOGD(KEVT_MUTEX_UNLOCK, waiter->task_id, 0);
 
         rtos_kernel_task_unblock(waiter);
-        rtos_port_exit_critical();
-        return RTOS_MUTEX_OK;
+    }
+    else
+    {
+        m->owner      = NULL;
+        m->lock_count = 0;
+
+        KLOGD(KEVT_MUTEX_UNLOCK, current_task->task_id, 0);
     }
 
-    m->owner      = NULL;
-    m->lock_count = 0;
+    /* Dropping a ceiling or an inherited priority may let a ready task outrank us */
+    bool preempt = rtos_scheduler_should_preempt(rtos_scheduler_get_next_task());
 
     rtos_port_exit_critical();
 
-    KLOGD(KEVT_MUTEX_UNLOCK, current_task->task_id, 0);
+    if (preempt)
+    {
+        rtos_yield();
+    }
+
     return RTOS_MUTEX_OK;
 }
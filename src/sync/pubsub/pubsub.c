@@ -0,0 +1,279 @@
+/*******************************************************************************
+ * File: src/sync/pubsub/pubsub.c
+ * Description: Topic-based publish/subscribe bus with zero-copy messages
+ ******************************************************************************/
+
+#include "pubsub.h"
+
+#include "VRTOS.h"
+#include "config.h"
+#include "rtos_port.h"
+
+#include <stddef.h>
+
+/*
+ * refs counts the subscriber queues holding a message, plus one for a
+ * publisher while it fans out. Without that hold a subscriber woken by the
+ * first push could release the message before the last push. Releases may
+ * come from ISRs, so refs only changes under a critical section.
+ *
+ * Subscribers are pushed at the head of the list and never unlinked, so a
+ * publisher walks it without a lock; a subscriber attached meanwhile just
+ * misses that message.
+ */
+
+static bool bus_topic_valid(uint16_t topic)
+{
+    return topic < RTOS_BUS_MAX_TOPICS;
+}
+
+static rtos_bus_msg_t *bus_msg_init(rtos_bus_t *bus, void *block, uint16_t topic)
+{
+    rtos_bus_msg_t *msg = (rtos_bus_msg_t *) block;
+
+    if (msg != NULL)
+    {
+        msg->bus   = bus;
+        msg->topic = topic;
+        msg->refs  = 0U;
+    }
+    return msg;
+}
+
+/* Drop one reference; true if it was the last */
+static bool bus_unref(rtos_bus_msg_t *msg)
+{
+    bool last;
+
+    rtos_port_enter_critical();
+    if (msg->refs > 0U)
+    {
+        msg->refs--;
+    }
+    last = (msg->refs == 0U);
+    rtos_port_exit_critical();
+
+    return last;
+}
+
+static bool bus_unref_from_isr(rtos_bus_msg_t *msg)
+{
+    bool     last;
+    uint32_t saved = rtos_port_enter_critical_from_isr();
+
+    if (msg->refs > 0U)
+    {
+        msg->refs--;
+    }
+    last = (msg->refs == 0U);
+    rtos_port_exit_critical_from_isr(saved);
+
+    return last;
+}
+
+rtos_status_t rtos_bus_init(rtos_bus_t *bus, rtos_mempool_t *pool)
+{
+    if (bus == NULL || pool == NULL || pool->block_size < sizeof(rtos_bus_msg_t))
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    bus->pool = pool;
+    bus->head = NULL;
+
+    return RTOS_SUCCESS;
+}
+
+size_t rtos_bus_payload_size(const rtos_bus_t *bus)
+{
+    if (bus == NULL || bus->pool == NULL)
+    {
+        return 0U;
+    }
+    return bus->pool->block_size - sizeof(rtos_bus_msg_t);
+}
+
+rtos_status_t rtos_bus_attach(rtos_bus_t *bus, rtos_bus_sub_t *sub, rtos_bus_msg_t **storage,
+                              uint32_t queue_length)
+{
+    if (bus == NULL || sub == NULL || storage == NULL || queue_length == 0U)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_status_t status =
+        rtos_queue_create_static(&sub->queue, &sub->queue_cb, storage, queue_length, sizeof(rtos_bus_msg_t *));
+    if (status != RTOS_SUCCESS)
+    {
+        return status;
+    }
+
+    sub->topics  = 0U;
+    sub->dropped = 0U;
+
+    rtos_port_enter_critical();
+    sub->next = bus->head;
+    bus->head = sub;
+    rtos_port_exit_critical();
+
+    return RTOS_SUCCESS;
+}
+
+rtos_status_t rtos_bus_subscribe(rtos_bus_sub_t *sub, uint16_t topic)
+{
+    if (sub == NULL || !bus_topic_valid(topic))
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_port_enter_critical();
+    sub->topics |= (1UL << topic);
+    rtos_port_exit_critical();
+
+    return RTOS_SUCCESS;
+}
+
+rtos_status_t rtos_bus_unsubscribe(rtos_bus_sub_t *sub, uint16_t topic)
+{
+    if (sub == NULL || !bus_topic_valid(topic))
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_port_enter_critical();
+    sub->topics &= (uint32_t) ~(1UL << topic);
+    rtos_port_exit_critical();
+
+    return RTOS_SUCCESS;
+}
+
+rtos_queue_handle_t rtos_bus_sub_queue(const rtos_bus_sub_t *sub)
+{
+    return (sub != NULL) ? sub->queue : NULL;
+}
+
+rtos_bus_msg_t *rtos_bus_alloc(rtos_bus_t *bus, uint16_t topic, rtos_tick_t timeout_ticks)
+{
+    if (bus == NULL || !bus_topic_valid(topic))
+    {
+        return NULL;
+    }
+    return bus_msg_init(bus, rtos_mempool_alloc(bus->pool, timeout_ticks), topic);
+}
+
+rtos_bus_msg_t *rtos_bus_alloc_from_isr(rtos_bus_t *bus, uint16_t topic)
+{
+    if (bus == NULL || !bus_topic_valid(topic))
+    {
+        return NULL;
+    }
+    return bus_msg_init(bus, rtos_mempool_alloc_from_isr(bus->pool), topic);
+}
+
+rtos_status_t rtos_bus_publish(rtos_bus_t *bus, rtos_bus_msg_t *msg, rtos_tick_t timeout_ticks)
+{
+    if (bus == NULL || msg == NULL || msg->bus != bus)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    uint32_t      mask   = 1UL << msg->topic;
+    rtos_status_t result = RTOS_SUCCESS;
+
+    /* The publisher's hold */
+    rtos_port_enter_critical();
+    msg->refs++;
+    rtos_port_exit_critical();
+
+    for (rtos_bus_sub_t *sub = bus->head; sub != NULL; sub = sub->next)
+    {
+        if ((sub->topics & mask) == 0U)
+        {
+            continue;
+        }
+
+        /* Counted before the push: the subscriber may run and release at once */
+        rtos_port_enter_critical();
+        msg->refs++;
+        rtos_port_exit_critical();
+
+        if (rtos_queue_send(sub->queue, &msg, timeout_ticks) != RTOS_SUCCESS)
+        {
+            /* Never the last reference while the hold is on */
+            rtos_port_enter_critical();
+            msg->refs--;
+            sub->dropped++;
+            rtos_port_exit_critical();
+            result = RTOS_ERROR_FULL;
+        }
+    }
+
+    rtos_bus_release(msg);
+
+    return result;
+}
+
+rtos_status_t rtos_bus_publish_from_isr(rtos_bus_t *bus, rtos_bus_msg_t *msg, bool *higher_priority_task_woken)
+{
+    if (bus == NULL || msg == NULL || msg->bus != bus)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    uint32_t      mask   = 1UL << msg->topic;
+    rtos_status_t result = RTOS_SUCCESS;
+    uint32_t      saved  = rtos_port_enter_critical_from_isr();
+
+    msg->refs++;
+    rtos_port_exit_critical_from_isr(saved);
+
+    for (rtos_bus_sub_t *sub = bus->head; sub != NULL; sub = sub->next)
+    {
+        if ((sub->topics & mask) == 0U)
+        {
+            continue;
+        }
+
+        saved = rtos_port_enter_critical_from_isr();
+        msg->refs++;
+        rtos_port_exit_critical_from_isr(saved);
+
+        if (rtos_queue_send_from_isr(sub->queue, &msg, higher_priority_task_woken) != RTOS_SUCCESS)
+        {
+            saved = rtos_port_enter_critical_from_isr();
+            msg->refs--;
+            sub->dropped++;
+            rtos_port_exit_critical_from_isr(saved);
+            result = RTOS_ERROR_FULL;
+        }
+    }
+
+    rtos_bus_release_from_isr(msg);
+
+    return result;
+}
+
+rtos_status_t rtos_bus_receive(rtos_bus_sub_t *sub, rtos_bus_msg_t **msg, rtos_tick_t timeout_ticks)
+{
+    if (sub == NULL || msg == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+    return rtos_queue_receive(sub->queue, msg, timeout_ticks);
+}
+
+void rtos_bus_release(rtos_bus_msg_t *msg)
+{
+    if (msg != NULL && bus_unref(msg))
+    {
+        (void) rtos_mempool_free(msg->bus->pool, msg);
+    }
+}
+
+void rtos_bus_release_from_isr(rtos_bus_msg_t *msg)
+{
+    if (msg != NULL && bus_unref_from_isr(msg))
+    {
+        (void) rtos_mempool_free_from_isr(msg->bus->pool, msg);
+    }
+}
@@ -5,72 +5,25 @@
 #include "klog.h"
 #include "memory.h"
 #include "queue_priv.h"
+#include "rtos_mem.h"
 #include "rtos_port.h"
 #include "scheduler.h"
 #include "task.h"
 #include "task_priv.h"
 
-#include <string.h>
+RTOS_STATIC_ASSERT(sizeof(rtos_queue_static_t) == sizeof(rtos_queue_t) &&
+                       _Alignof(rtos_queue_static_t) == _Alignof(rtos_queue_t),
+                   "rtos_queue_static_t must mirror rtos_queue_t");
 
-static void queue_add_to_waiting_list(rtos_tcb_t **list_head, rtos_tcb_t *task, void *queue)
+static void queue_remove_from_waiting_list(rtos_wait_queue_t *wq, rtos_tcb_t *task)
 {
-    task->next_waiting    = NULL;
-    task->blocked_on      = queue;
-    task->blocked_on_type = RTOS_SYNC_TYPE_QUEUE;
-
-    if (*list_head == NULL)
+    if (task == NULL || task->wait_queue != wq)
     {
-        *list_head = task;
         return;
     }
 
-    /* Insert in priority order (highest priority at head) */
-    rtos_tcb_t *current = *list_head;
-    rtos_tcb_t *prev    = NULL;
-
-    while (current != NULL && current->priority >= task->priority)
-    {
-        prev    = current;
-        current = current->next_waiting;
-    }
+    rtos_wait_queue_remove(wq, task);
 
-    if (prev == NULL)
-    {
-        task->next_waiting = *list_head;
-        *list_head         = task;
-    }
-    else
-    {
-        task->next_waiting = current;
-        prev->next_waiting = task;
-    }
-}
-
-static void queue_remove_from_waiting_list(rtos_tcb_t **list_head, rtos_tcb_t *task)
-{
-    if (*list_head == NULL || task == NULL)
-    {
-        return;
-    }
-
-    if (*list_head == task)
-    {
-        *list_head = task->next_waiting;
-    }
-    else
-    {
-        rtos_tcb_t *current = *list_head;
-        while (current->next_waiting != NULL && current->next_waiting != task)
-        {
-            current = current->next_waiting;
-        }
-        if (current->next_waiting == task)
-        {
-            current->next_waiting = task->next_waiting;
-        }
-    }
-
-    task->next_waiting    = NULL;
     task->blocked_on      = NULL;
     task->blocked_on_type = RTOS_SYNC_TYPE_NONE;
 }
@@ -78,48 +31,59 @@ static void queue_remove_from_waiting_list(rtos_tcb_t **list_head, rtos_tcb_t *t
 void rtos_queue_remove_task_from_wait(void *queue_ptr, rtos_tcb_t *task)
 {
     rtos_queue_t *q = (rtos_queue_t *) queue_ptr;
-    queue_remove_from_waiting_list(&q->sender_wait_list, task);
-    queue_remove_from_waiting_list(&q->receiver_wait_list, task);
+    queue_remove_from_waiting_list(&q->sender_waiters, task);
+    queue_remove_from_waiting_list(&q->receiver_waiters, task);
 }
 
-static rtos_tcb_t *queue_pop_highest_priority_waiter(rtos_tcb_t **list_head)
+static rtos_tcb_t *queue_pop_highest_priority_waiter(rtos_wait_queue_t *wq)
 {
-    if (*list_head == NULL)
+    rtos_tcb_t *task = rtos_wait_queue_pop(wq);
+    if (task == NULL)
     {
         return NULL;
     }
 
-    /* Head is always highest priority due to ordered insertion */
-    rtos_tcb_t *task      = *list_head;
-    *list_head            = task->next_waiting;
-    task->next_waiting    = NULL;
     task->blocked_on      = NULL;
     task->blocked_on_type = RTOS_SYNC_TYPE_NONE;
 
     return task;
 }
 
-static rtos_status_t rtos_queue_init(rtos_queue_t *queue, uint32_t item_count, uint32_t item_size)
+/* storage NULL = allocate item_count * item_size bytes from the heap */
+static rtos_status_t rtos_queue_init(rtos_queue_t *queue, void *storage, uint32_t item_count, uint32_t item_size)
 {
     if (queue == NULL || item_count == 0 || item_size == 0)
     {
         return RTOS_ERROR_INVALID_PARAM;
     }
 
-    queue->buffer = rtos_malloc(item_count * item_size);
+#if RTOS_FOOTPRINT_COMPACT
+    /* 16-bit lengths and sizes in the control block */
+    if (item_count > UINT16_MAX || item_size > UINT16_MAX)
+    {
+        KLOGE(KEVT_INVALID_PARAM, item_count, item_size);
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+#endif
+
+    queue->buffer = (storage != NULL) ? storage : rtos_malloc(item_count * item_size);
     if (queue->buffer == NULL)
     {
         KLOGE(KEVT_ALLOC_FAIL, 0, 0);
         return RTOS_ERROR_NO_MEMORY;
     }
 
-    queue->item_size          = item_size;
-    queue->length             = item_count;
-    queue->count              = 0;
-    queue->read_ptr           = queue->buffer;
-    queue->write_ptr          = queue->buffer;
-    queue->sender_wait_list   = NULL;
-    queue->receiver_wait_list = NULL;
+    queue->is_static      = (storage != NULL);
+    queue->item_size      = (rtos_queue_count_t) item_size;
+    queue->length         = (rtos_queue_count_t) item_count;
+    queue->count          = 0;
+    queue->read_index     = 0;
+    queue->write_index    = 0;
+    queue->write_reserved = false;
+    queue->read_reserved  = false;
+    queue->set            = NULL;
+    rtos_wait_queue_init(&queue->sender_waiters);
+    rtos_wait_queue_init(&queue->receiver_waiters);
 
     KLOGD(KEVT_QUEUE_INIT, item_count, item_size);
 
@@ -140,7 +104,7 @@ rtos_status_t rtos_queue_create(rtos_queue_handle_t *queue_handle, uint32_t item
         return RTOS_ERROR_NO_MEMORY;
     }
 
-    rtos_status_t status = rtos_queue_init(queue, item_count, item_size);
+    rtos_status_t status = rtos_queue_init(queue, NULL, item_count, item_size);
     if (status != RTOS_SUCCESS)
     {
         rtos_free(queue);
@@ -153,21 +117,56 @@ rtos_status_t rtos_queue_create(rtos_queue_handle_t *queue_handle, uint32_t item
     return RTOS_SUCCESS;
 }
 
-rtos_status_t rtos_queue_send(rtos_queue_handle_t queue_handle, const void *item_ptr, rtos_tick_t timeout_ticks)
+rtos_status_t rtos_queue_create_static(rtos_queue_handle_t *queue_handle, rtos_queue_static_t *queue_buffer,
+                                       void *storage, uint32_t item_count, uint32_t item_size)
 {
-    if (queue_handle == NULL || item_ptr == NULL)
+    if (queue_handle == NULL || queue_buffer == NULL || storage == NULL)
     {
         return RTOS_ERROR_INVALID_PARAM;
     }
 
-    rtos_queue_t *queue = (rtos_queue_t *) queue_handle;
+    rtos_queue_t *queue = (rtos_queue_t *) queue_buffer;
 
-    rtos_port_enter_critical();
+    rtos_status_t status = rtos_queue_init(queue, storage, item_count, item_size);
+    if (status != RTOS_SUCCESS)
+    {
+        return status;
+    }
+
+    *queue_handle = queue;
+    KLOGI(KEVT_QUEUE_CREATE, item_count, item_size);
+
+    return RTOS_SUCCESS;
+}
+
+/* Producers may write while a slot is free and no producer holds an acquired slot */
+static inline bool queue_can_write(const rtos_queue_t *queue)
+{
+    return (queue->count < queue->length) && !queue->write_reserved;
+}
+
+static inline uint8_t *queue_slot(const rtos_queue_t *queue, rtos_queue_count_t index)
+{
+    return queue->buffer + ((uint32_t) index * queue->item_size);
+}
 
+static inline rtos_queue_count_t queue_next_index(const rtos_queue_t *queue, rtos_queue_count_t index)
+{
+    index++;
+    return (index == queue->length) ? 0U : index; /* Wrap around */
+}
+
+/**
+ * Wait until the producer side can write. Must be called inside a critical
+ * section. Returns RTOS_SUCCESS with the critical section still held, or an
+ * error with it released.
+ */
+static rtos_status_t queue_wait_writable(rtos_queue_t *queue, rtos_tick_t timeout_ticks)
+{
     /* Fast path: Queue has space */
-    if (queue->count < queue->length)
+    if (queue_can_write(queue))
     {
-        goto copy_data;
+        return RTOS_SUCCESS;
     }
 
     if (timeout_ticks == 0)
@@ -177,7 +176,7 @@ rtos_status_t rtos_queue_send(rtos_queue_handle_t queue_handle, const void *item
         return RTOS_ERROR_FULL;
     }
 
-    rtos_tcb_t *current_task = g_kernel.current_task;
+    rtos_tcb_t *current_task = rtos_kernel_this_core()->current_task;
     if (current_task == NULL)
     {
         rtos_port_exit_critical();
@@ -185,34 +184,17 @@ rtos_status_t rtos_queue_send(rtos_queue_handle_t queue_handle, const void *item
         return RTOS_ERROR_INVALID_STATE;
     }
 
-    queue_add_to_waiting_list(&queue->sender_wait_list, current_task, queue);
-
     KLOGD(KEVT_QUEUE_SEND_BLOCK, current_task->task_id, (uint32_t) timeout_ticks);
 
-    if (timeout_ticks == RTOS_MAX_DELAY)
-    {
-        /* Infinite wait */
-        current_task->state = RTOS_TASK_STATE_BLOCKED;
-        rtos_scheduler_remove_from_ready_list(current_task);
-        rtos_port_exit_critical();
-        rtos_yield();
-    }
-    else
-    {
-        /* Timed wait */
-        rtos_port_exit_critical();
-        rtos_kernel_task_block(current_task, timeout_ticks);
-    }
+    rtos_kernel_block_on(queue, RTOS_SYNC_TYPE_QUEUE, &queue->sender_waiters, timeout_ticks);
 
     /* --- Task resumes here after unblock or timeout --- */
 
-    rtos_port_enter_critical();
-
-    /* Check if we were woken by receive (blocked_on cleared) or timeout */
+    /* Check if we were woken by receive/commit (blocked_on cleared) or timeout */
     if (current_task->blocked_on == queue)
     {
         /* Still blocked on queue = timeout occurred */
-        queue_remove_from_waiting_list(&queue->sender_wait_list, current_task);
+        queue_remove_from_waiting_list(&queue->sender_waiters, current_task);
         rtos_port_exit_critical();
 
         KLOGD(KEVT_QUEUE_SEND_TIMEOUT, current_task->task_id, 0);
@@ -220,7 +202,7 @@ rtos_status_t rtos_queue_send(rtos_queue_handle_t queue_handle, const void *item
     }
 
     /* Check again if queue has space (should always be true here) */
-    if (queue->count >= queue->length)
+    if (!queue_can_write(queue))
     {
         /* This shouldn't happen - defensive programming */
         rtos_port_exit_critical();
@@ -228,29 +210,125 @@ rtos_status_t rtos_queue_send(rtos_queue_handle_t queue_handle, const void *item
         return RTOS_ERROR_FULL;
     }
 
-copy_data:
-    memcpy(queue->write_ptr, item_ptr, queue->item_size);
+    return RTOS_SUCCESS;
+}
 
-    /* Advance write pointer (circular buffer) */
-    queue->write_ptr = (uint8_t *) queue->write_ptr + queue->item_size;
-    if ((uint8_t *) queue->write_ptr >= (uint8_t *) queue->buffer + (queue->length * queue->item_size))
+/**
+ * Wait until the consumer side can read. Same critical-section contract as
+ * queue_wait_writable().
+ */
+static rtos_status_t queue_wait_readable(rtos_queue_t *queue, rtos_tick_t timeout_ticks)
+{
+    /* Fast path: Queue has data */
+    if (queue_can_read(queue))
     {
-        queue->write_ptr = queue->buffer; /* Wrap around */
+        return RTOS_SUCCESS;
     }
 
+    if (timeout_ticks == 0)
+    {
+        rtos_port_exit_critical();
+        KLOGD(KEVT_QUEUE_RECV_EMPTY, 0, 0);
+        return RTOS_ERROR_EMPTY;
+    }
+
+    rtos_tcb_t *current_task = rtos_kernel_this_core()->current_task;
+    if (current_task == NULL)
+    {
+        rtos_port_exit_critical();
+        KLOGE(KEVT_NO_CURRENT_TASK, 0, 0);
+        return RTOS_ERROR_INVALID_STATE;
+    }
+
+    KLOGD(KEVT_QUEUE_RECV_BLOCK, current_task->task_id, (uint32_t) timeout_ticks);
+
+    rtos_kernel_block_on(queue, RTOS_SYNC_TYPE_QUEUE, &queue->receiver_waiters, timeout_ticks);
+
+    /* --- Task resumes here after unblock or timeout --- */
+
+    /* Check if we were woken by send/release (blocked_on cleared) or timeout */
+    if (current_task->blocked_on == queue)
+    {
+        /* Still blocked on queue = timeout occurred */
+        queue_remove_from_waiting_list(&queue->receiver_waiters, current_task);
+        rtos_port_exit_critical();
+
+        KLOGD(KEVT_QUEUE_RECV_TIMEOUT, current_task->task_id, 0);
+        return RTOS_ERROR_TIMEOUT;
+    }
+
+    /* Check again if queue has data (should always be true here) */
+    if (!queue_can_read(queue))
+    {
+        /* This shouldn't happen - defensive programming */
+        rtos_port_exit_critical();
+        KLOGE(KEVT_QUEUE_RECV_EMPTY, queue->count, queue->length);
+        return RTOS_ERROR_EMPTY;
+    }
+
+    return RTOS_SUCCESS;
+}
+
+/*
+ * Publish the slot at write_index and pop the highest-priority receiver, or a
+ * task blocked on the queue's set if no receiver waits on the queue itself.
+ * Caller holds the critical section and unblocks the returned task.
+ */
+static rtos_tcb_t *queue_publish_slot(rtos_queue_t *queue)
+{
+    queue->write_index = queue_next_index(queue, queue->write_index);
     queue->count++;
 
     KLOGD(KEVT_QUEUE_SEND, queue->count, 0);
 
-    rtos_tcb_t *waiting_receiver = queue_pop_highest_priority_waiter(&queue->receiver_wait_list);
+    rtos_tcb_t *waiting_receiver = queue_pop_highest_priority_waiter(&queue->receiver_waiters);
     if (waiting_receiver != NULL)
     {
         KLOGD(KEVT_QUEUE_WAKE_RECV, waiting_receiver->task_id, 0);
+        return waiting_receiver;
+    }
 
-        rtos_kernel_task_unblock(waiting_receiver);
-        rtos_port_exit_critical();
-        return RTOS_SUCCESS;
+    return (queue->set != NULL) ? rtos_queue_set_take_waiter(queue->set) : NULL;
+}
+
+/*
+ * Retire the item at read_index and pop the highest-priority sender.
+ * Caller holds the critical section and unblocks the returned task.
+ */
+static rtos_tcb_t *queue_retire_slot(rtos_queue_t *queue)
+{
+    queue->read_index = queue_next_index(queue, queue->read_index);
+    queue->count--;
+
+    KLOGD(KEVT_QUEUE_RECV, queue->count, 0);
+
+    rtos_tcb_t *waiting_sender = queue_pop_highest_priority_waiter(&queue->sender_waiters);
+    if (waiting_sender != NULL)
+    {
+        KLOGD(KEVT_QUEUE_WAKE_SEND, waiting_sender->task_id, 0);
     }
+    return waiting_sender;
+}
+
+rtos_status_t rtos_queue_send(rtos_queue_handle_t queue_handle, const void *item_ptr, rtos_tick_t timeout_ticks)
+{
+    if (queue_handle == NULL || item_ptr == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_queue_t *queue = (rtos_queue_t *) queue_handle;
+
+    rtos_port_enter_critical();
+
+    rtos_status_t status = queue_wait_writable(queue, timeout_ticks);
+    if (status != RTOS_SUCCESS)
+    {
+        return status;
+    }
+
+    rtos_mem_copy(queue_slot(queue, queue->write_index), item_ptr, queue->item_size);
+    rtos_kernel_task_unblock(queue_publish_slot(queue));
 
     rtos_port_exit_critical();
     return RTOS_SUCCESS;
@@ -267,92 +345,469 @@ rtos_status_t rtos_queue_receive(rtos_queue_handle_t queue_handle, void *buffer,
 
     rtos_port_enter_critical();
 
-    /* Fast path: Queue has data */
-    if (queue->count > 0)
+    rtos_status_t status = queue_wait_readable(queue, timeout_ticks);
+    if (status != RTOS_SUCCESS)
     {
-        goto copy_data;
+        return status;
     }
 
-    if (timeout_ticks == 0)
+    rtos_mem_copy(buffer, queue_slot(queue, queue->read_index), queue->item_size);
+    rtos_kernel_task_unblock(queue_retire_slot(queue));
+
+    rtos_port_exit_critical();
+    return RTOS_SUCCESS;
+}
+
+/* A length-1 queue holds the latest item; overwrite replaces it in place */
+static rtos_tcb_t *queue_overwrite_slot(rtos_queue_t *queue, const void *item_ptr)
+{
+    if (queue->count == 0U)
+    {
+        rtos_mem_copy(queue_slot(queue, queue->write_index), item_ptr, queue->item_size);
+        return queue_publish_slot(queue);
+    }
+
+    rtos_mem_copy(queue_slot(queue, queue->read_index), item_ptr, queue->item_size);
+    KLOGD(KEVT_QUEUE_OVERWRITE, queue->count, 0);
+    return NULL;
+}
+
+rtos_status_t rtos_queue_overwrite(rtos_queue_handle_t queue_handle, const void *item_ptr)
+{
+    rtos_queue_t *queue = (rtos_queue_t *) queue_handle;
+
+    if (queue == NULL || item_ptr == NULL || queue->length != 1U)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_port_enter_critical();
+
+    /* The only slot is being filled or read in place */
+    if (queue->write_reserved || queue->read_reserved)
     {
         rtos_port_exit_critical();
+        KLOGD(KEVT_QUEUE_SEND_FULL, 0, 0);
+        return RTOS_ERROR_FULL;
+    }
+
+    rtos_kernel_task_unblock(queue_overwrite_slot(queue, item_ptr));
+
+    rtos_port_exit_critical();
+    return RTOS_SUCCESS;
+}
+
+rtos_status_t rtos_queue_overwrite_from_isr(rtos_queue_handle_t queue_handle, const void *item_ptr,
+                                            bool *higher_priority_task_woken)
+{
+    rtos_queue_t *queue = (rtos_queue_t *) queue_handle;
+
+    if (queue == NULL || item_ptr == NULL || queue->length != 1U)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    uint32_t saved = rtos_port_enter_critical_from_isr();
+
+    if (queue->write_reserved || queue->read_reserved)
+    {
+        rtos_port_exit_critical_from_isr(saved);
+        KLOGD(KEVT_QUEUE_SEND_FULL, 0, 0);
+        return RTOS_ERROR_FULL;
+    }
+
+    rtos_tcb_t *waiter = queue_overwrite_slot(queue, item_ptr);
+
+    rtos_port_exit_critical_from_isr(saved);
+
+    /* Unblock outside ISR critical section; the yield is left to the caller */
+    if (rtos_kernel_task_unblock_from_isr(waiter) && higher_priority_task_woken != NULL)
+    {
+        *higher_priority_task_woken = true;
+    }
+
+    return RTOS_SUCCESS;
+}
+
+/*
+ * The item at read_index is still readable: wake the next receiver, or a task
+ * blocked on the queue's set. A publish wakes one reader; one that did not
+ * consume the item (peek, release of a reservation) passes the wake on.
+ * Caller holds the critical section.
+ */
+static void queue_pass_on_readable(rtos_queue_t *queue)
+{
+    rtos_tcb_t *waiting_receiver = queue_pop_highest_priority_waiter(&queue->receiver_waiters);
+    if (waiting_receiver != NULL)
+    {
+        KLOGD(KEVT_QUEUE_WAKE_RECV, waiting_receiver->task_id, 0);
+        rtos_kernel_task_unblock(waiting_receiver);
+    }
+    else if (queue->set != NULL)
+    {
+        rtos_kernel_task_unblock(rtos_queue_set_take_waiter(queue->set));
+    }
+}
+
+rtos_status_t rtos_queue_peek(rtos_queue_handle_t queue_handle, void *buffer, rtos_tick_t timeout_ticks)
+{
+    if (queue_handle == NULL || buffer == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_queue_t *queue = (rtos_queue_t *) queue_handle;
+
+    rtos_port_enter_critical();
+
+    rtos_status_t status = queue_wait_readable(queue, timeout_ticks);
+    if (status != RTOS_SUCCESS)
+    {
+        return status;
+    }
+
+    rtos_mem_copy(buffer, queue_slot(queue, queue->read_index), queue->item_size);
+    queue_pass_on_readable(queue);
+
+    rtos_port_exit_critical();
+    return RTOS_SUCCESS;
+}
+
+/*
+ * Copy n items between the ring at *index and a flat buffer in at most two
+ * rtos_mem_copy calls (before and after the wrap), then advance *index past them.
+ */
+static void queue_copy_run(rtos_queue_t *queue, rtos_queue_count_t *index, uint8_t *flat, uint32_t n, bool into_ring)
+{
+    uint8_t *pos   = queue_slot(queue, *index);
+    uint32_t tail  = queue->length - (uint32_t) *index;
+    size_t   bytes = (size_t) n * queue->item_size;
+    size_t   first = (size_t) ((tail < n) ? tail : n) * queue->item_size;
+
+    if (into_ring)
+    {
+        rtos_mem_copy(pos, flat, first);
+        rtos_mem_copy(queue->buffer, flat + first, bytes - first);
+    }
+    else
+    {
+        rtos_mem_copy(flat, pos, first);
+        rtos_mem_copy(flat + first, queue->buffer, bytes - first);
+    }
+
+    uint32_t next = (uint32_t) *index + n;
+    if (next >= queue->length)
+    {
+        next -= queue->length; /* Wrap around */
+    }
+    *index = (rtos_queue_count_t) next;
+}
+
+/*
+ * Pop and unblock up to max waiters from a list; returns how many.
+ * Caller holds the critical section.
+ */
+static uint32_t queue_wake_waiters(rtos_wait_queue_t *wq, uint32_t max, log_event_id_t evt)
+{
+    uint32_t woken = 0;
+
+    while (woken < max)
+    {
+        rtos_tcb_t *waiter = queue_pop_highest_priority_waiter(wq);
+        if (waiter == NULL)
+        {
+            break;
+        }
+        KLOGD(evt, waiter->task_id, 0);
+        rtos_kernel_task_unblock(waiter);
+        woken++;
+    }
+
+    return woken;
+}
+
+rtos_status_t rtos_queue_send_n(rtos_queue_handle_t queue_handle, const void *items, uint32_t item_count,
+                                uint32_t *items_sent, rtos_tick_t timeout_ticks)
+{
+    if (items_sent != NULL)
+    {
+        *items_sent = 0;
+    }
+
+    if (queue_handle == NULL || items == NULL || item_count == 0)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_queue_t *queue = (rtos_queue_t *) queue_handle;
+
+    rtos_port_enter_critical();
+
+    rtos_status_t status = queue_wait_writable(queue, timeout_ticks);
+    if (status != RTOS_SUCCESS)
+    {
+        return status;
+    }
+
+    uint32_t n = queue->length - queue->count;
+    if (n > item_count)
+    {
+        n = item_count;
+    }
+
+    queue_copy_run(queue, &queue->write_index, (uint8_t *) (uintptr_t) items, n, true);
+    queue->count += n;
+
+    KLOGD(KEVT_QUEUE_SEND, queue->count, n);
+
+    /* One pass: each new item can satisfy one blocked receiver; a set
+     * waiter gets the rest */
+    if (queue_wake_waiters(&queue->receiver_waiters, n, KEVT_QUEUE_WAKE_RECV) < n && queue->set != NULL)
+    {
+        rtos_kernel_task_unblock(rtos_queue_set_take_waiter(queue->set));
+    }
+
+    rtos_port_exit_critical();
+
+    if (items_sent != NULL)
+    {
+        *items_sent = n;
+    }
+    return RTOS_SUCCESS;
+}
+
+rtos_status_t rtos_queue_receive_n(rtos_queue_handle_t queue_handle, void *buffer, uint32_t max_items,
+                                   uint32_t *items_received, rtos_tick_t timeout_ticks)
+{
+    if (items_received != NULL)
+    {
+        *items_received = 0;
+    }
+
+    if (queue_handle == NULL || buffer == NULL || max_items == 0)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_queue_t *queue = (rtos_queue_t *) queue_handle;
+
+    rtos_port_enter_critical();
+
+    rtos_status_t status = queue_wait_readable(queue, timeout_ticks);
+    if (status != RTOS_SUCCESS)
+    {
+        return status;
+    }
+
+    uint32_t n = queue->count;
+    if (n > max_items)
+    {
+        n = max_items;
+    }
+
+    queue_copy_run(queue, &queue->read_index, (uint8_t *) buffer, n, false);
+    queue->count -= n;
+
+    KLOGD(KEVT_QUEUE_RECV, queue->count, n);
+
+    /* One pass: each freed slot can satisfy one blocked sender */
+    queue_wake_waiters(&queue->sender_waiters, n, KEVT_QUEUE_WAKE_SEND);
+
+    rtos_port_exit_critical();
+
+    if (items_received != NULL)
+    {
+        *items_received = n;
+    }
+    return RTOS_SUCCESS;
+}
+
+rtos_status_t rtos_queue_send_from_isr(rtos_queue_handle_t queue_handle, const void *item_ptr,
+                                       bool *higher_priority_task_woken)
+{
+    if (queue_handle == NULL || item_ptr == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_queue_t *queue = (rtos_queue_t *) queue_handle;
+
+    uint32_t saved = rtos_port_enter_critical_from_isr();
+
+    if (!queue_can_write(queue))
+    {
+        rtos_port_exit_critical_from_isr(saved);
+        KLOGD(KEVT_QUEUE_SEND_FULL, 0, 0);
+        return RTOS_ERROR_FULL;
+    }
+
+    rtos_mem_copy(queue_slot(queue, queue->write_index), item_ptr, queue->item_size);
+    rtos_tcb_t *waiter = queue_publish_slot(queue);
+
+    rtos_port_exit_critical_from_isr(saved);
+
+    /* Unblock outside ISR critical section; the yield is left to the caller */
+    if (rtos_kernel_task_unblock_from_isr(waiter) && higher_priority_task_woken != NULL)
+    {
+        *higher_priority_task_woken = true;
+    }
+
+    return RTOS_SUCCESS;
+}
+
+rtos_status_t rtos_queue_receive_from_isr(rtos_queue_handle_t queue_handle, void *buffer,
+                                          bool *higher_priority_task_woken)
+{
+    if (queue_handle == NULL || buffer == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_queue_t *queue = (rtos_queue_t *) queue_handle;
+
+    uint32_t saved = rtos_port_enter_critical_from_isr();
+
+    if (!queue_can_read(queue))
+    {
+        rtos_port_exit_critical_from_isr(saved);
         KLOGD(KEVT_QUEUE_RECV_EMPTY, 0, 0);
         return RTOS_ERROR_EMPTY;
     }
 
-    rtos_tcb_t *current_task = g_kernel.current_task;
-    if (current_task == NULL)
+    rtos_mem_copy(buffer, queue_slot(queue, queue->read_index), queue->item_size);
+    rtos_tcb_t *waiter = queue_retire_slot(queue);
+
+    rtos_port_exit_critical_from_isr(saved);
+
+    /* Unblock outside ISR critical section; the yield is left to the caller */
+    if (rtos_kernel_task_unblock_from_isr(waiter) && higher_priority_task_woken != NULL)
     {
-        rtos_port_exit_critical();
-        KLOGE(KEVT_NO_CURRENT_TASK, 0, 0);
-        return RTOS_ERROR_INVALID_STATE;
+        *higher_priority_task_woken = true;
     }
 
-    queue_add_to_waiting_list(&queue->receiver_wait_list, current_task, queue);
+    return RTOS_SUCCESS;
+}
 
-    KLOGD(KEVT_QUEUE_RECV_BLOCK, current_task->task_id, (uint32_t) timeout_ticks);
+rtos_status_t rtos_queue_send_acquire(rtos_queue_handle_t queue_handle, void **slot, rtos_tick_t timeout_ticks)
+{
+    if (queue_handle == NULL || slot == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_queue_t *queue = (rtos_queue_t *) queue_handle;
 
-    if (timeout_ticks == RTOS_MAX_DELAY)
+    rtos_port_enter_critical();
+
+    rtos_status_t status = queue_wait_writable(queue, timeout_ticks);
+    if (status != RTOS_SUCCESS)
     {
-        /* Infinite wait */
-        current_task->state = RTOS_TASK_STATE_BLOCKED;
-        rtos_scheduler_remove_from_ready_list(current_task);
-        rtos_port_exit_critical();
-        rtos_yield();
+        *slot = NULL;
+        return status;
     }
-    else
+
+    queue->write_reserved = true;
+    *slot                 = queue_slot(queue, queue->write_index);
+
+    rtos_port_exit_critical();
+    return RTOS_SUCCESS;
+}
+
+rtos_status_t rtos_queue_send_commit(rtos_queue_handle_t queue_handle)
+{
+    if (queue_handle == NULL)
     {
-        /* Timed wait */
-        rtos_port_exit_critical();
-        rtos_kernel_task_block(current_task, timeout_ticks);
+        return RTOS_ERROR_INVALID_PARAM;
     }
 
-    /* --- Task resumes here after unblock or timeout --- */
+    rtos_queue_t *queue = (rtos_queue_t *) queue_handle;
 
     rtos_port_enter_critical();
 
-    /* Check if we were woken by send (blocked_on cleared) or timeout */
-    if (current_task->blocked_on == queue)
+    if (!queue->write_reserved)
     {
-        /* Still blocked on queue = timeout occurred */
-        queue_remove_from_waiting_list(&queue->receiver_wait_list, current_task);
         rtos_port_exit_critical();
+        return RTOS_ERROR_INVALID_STATE;
+    }
 
-        KLOGD(KEVT_QUEUE_RECV_TIMEOUT, current_task->task_id, 0);
-        return RTOS_ERROR_TIMEOUT;
+#if PORT_HAS_DCACHE && RTOS_QUEUE_ZERO_COPY_CACHE_MAINT
+    /* Write the slot back so a DMA reader sees what the CPU put in it */
+    rtos_port_dcache_clean(queue_slot(queue, queue->write_index), queue->item_size);
+#endif
+
+    queue->write_reserved = false;
+    rtos_kernel_task_unblock(queue_publish_slot(queue));
+
+    /* A sender may have blocked on the reservation rather than on a full queue */
+    if (queue_can_write(queue))
+    {
+        rtos_tcb_t *waiting_sender = queue_pop_highest_priority_waiter(&queue->sender_waiters);
+        if (waiting_sender != NULL)
+        {
+            KLOGD(KEVT_QUEUE_WAKE_SEND, waiting_sender->task_id, 0);
+            rtos_kernel_task_unblock(waiting_sender);
+        }
     }
 
-    /* Check again if queue has data (should always be true here) */
-    if (queue->count == 0)
+    rtos_port_exit_critical();
+    return RTOS_SUCCESS;
+}
+
+rtos_status_t rtos_queue_receive_peek(rtos_queue_handle_t queue_handle, const void **item, rtos_tick_t timeout_ticks)
+{
+    if (queue_handle == NULL || item == NULL)
     {
-        /* This shouldn't happen - defensive programming */
-        rtos_port_exit_critical();
-        KLOGE(KEVT_QUEUE_RECV_EMPTY, queue->count, queue->length);
-        return RTOS_ERROR_EMPTY;
+        return RTOS_ERROR_INVALID_PARAM;
     }
 
-copy_data:
-    memcpy(buffer, queue->read_ptr, queue->item_size);
+    rtos_queue_t *queue = (rtos_queue_t *) queue_handle;
 
-    /* Advance read pointer (circular buffer) */
-    queue->read_ptr = (uint8_t *) queue->read_ptr + queue->item_size;
-    if ((uint8_t *) queue->read_ptr >= (uint8_t *) queue->buffer + (queue->length * queue->item_size))
+    rtos_port_enter_critical();
+
+    rtos_status_t status = queue_wait_readable(queue, timeout_ticks);
+    if (status != RTOS_SUCCESS)
     {
-        queue->read_ptr = queue->buffer; /* Wrap around */
+        *item = NULL;
+        return status;
     }
 
-    queue->count--;
+    queue->read_reserved = true;
+    *item                = queue_slot(queue, queue->read_index);
 
-    KLOGD(KEVT_QUEUE_RECV, queue->count, 0);
+    rtos_port_exit_critical();
 
-    rtos_tcb_t *waiting_sender = queue_pop_highest_priority_waiter(&queue->sender_wait_list);
-    if (waiting_sender != NULL)
+#if PORT_HAS_DCACHE && RTOS_QUEUE_ZERO_COPY_CACHE_MAINT
+    /* Drop stale lines so the CPU sees what a DMA writer put in the slot */
+    rtos_port_dcache_invalidate((void *) (uintptr_t) *item, queue->item_size);
+#endif
+
+    return RTOS_SUCCESS;
+}
+
+rtos_status_t rtos_queue_receive_release(rtos_queue_handle_t queue_handle)
+{
+    if (queue_handle == NULL)
     {
-        KLOGD(KEVT_QUEUE_WAKE_SEND, waiting_sender->task_id, 0);
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_queue_t *queue = (rtos_queue_t *) queue_handle;
 
-        rtos_kernel_task_unblock(waiting_sender);
+    rtos_port_enter_critical();
+
+    if (!queue->read_reserved)
+    {
         rtos_port_exit_critical();
-        return RTOS_SUCCESS;
+        return RTOS_ERROR_INVALID_STATE;
+    }
+
+    queue->read_reserved = false;
+    rtos_kernel_task_unblock(queue_retire_slot(queue));
+
+    /* A receiver may have blocked on the reservation rather than on an empty queue */
+    if (queue_can_read(queue))
+    {
+        queue_pass_on_readable(queue);
     }
 
     rtos_port_exit_critical();
@@ -435,14 +890,16 @@ rtos_status_t rtos_queue_reset(rtos_queue_handle_t queue_handle)
 
     rtos_port_enter_critical();
 
-    queue->count     = 0;
-    queue->read_ptr  = queue->buffer;
-    queue->write_ptr = queue->buffer;
+    queue->count          = 0;
+    queue->read_index     = 0;
+    queue->write_index    = 0;
+    queue->write_reserved = false; /* Outstanding commit/release now fail */
+    queue->read_reserved  = false;
 
     /* Wake all waiting senders since queue is now empty */
-    while (queue->sender_wait_list != NULL)
+    while (!rtos_wait_queue_is_empty(&queue->sender_waiters))
     {
-        rtos_tcb_t *sender = queue_pop_highest_priority_waiter(&queue->sender_wait_list);
+        rtos_tcb_t *sender = queue_pop_highest_priority_waiter(&queue->sender_waiters);
         if (sender != NULL)
         {
             KLOGD(KEVT_QUEUE_WAKE_SEND, sender->task_id, 0);
@@ -452,9 +909,9 @@ rtos_status_t rtos_queue_reset(rtos_queue_handle_t queue_handle)
 
     /* Also wake all waiting receivers — queue data is gone, let them
      * re-evaluate or time out rather than blocking forever. */
-    while (queue->receiver_wait_list != NULL)
+    while (!rtos_wait_queue_is_empty(&queue->receiver_waiters))
     {
-        rtos_tcb_t *receiver = queue_pop_highest_priority_waiter(&queue->receiver_wait_list);
+        rtos_tcb_t *receiver = queue_pop_highest_priority_waiter(&queue->receiver_waiters);
         if (receiver != NULL)
         {
             KLOGD(KEVT_QUEUE_WAKE_RECV, receiver->task_id, 0);
@@ -466,4 +923,40 @@ rtos_status_t rtos_queue_reset(rtos_queue_handle_t queue_handle)
 
     KLOGI(KEVT_QUEUE_RESET, 0, 0);
     return RTOS_SUCCESS;
-}
\ No newline at end of file
+}
+
+rtos_status_t rtos_queue_delete(rtos_queue_handle_t queue_handle)
+{
+    if (queue_handle == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_queue_t *queue = (rtos_queue_t *) queue_handle;
+
+    rtos_port_enter_critical();
+
+    if (!rtos_wait_queue_is_empty(&queue->sender_waiters) || !rtos_wait_queue_is_empty(&queue->receiver_waiters) ||
+        queue->write_reserved || queue->read_reserved || queue->set != NULL)
+    {
+        rtos_port_exit_critical();
+        return RTOS_ERROR_INVALID_STATE;
+    }
+
+    bool is_static = queue->is_static;
+
+    if (!is_static)
+    {
+        rtos_free(queue->buffer);
+    }
+    queue->buffer = NULL;
+
+    rtos_port_exit_critical();
+
+    if (!is_static)
+    {
+        rtos_free(queue);
+    }
+
+    return RTOS_SUCCESS;
+}
@@ -4,21 +4,34 @@
 #include "kernel_priv.h"
 #include "queue.h"
 #include "task.h"
+#include "wait_queue.h"
 
 /**
  * @brief Queue Control Block structure
  */
 typedef struct rtos_queue
 {
-    void    *buffer;    /**< Pointer to the start of the queue storage */
-    void    *read_ptr;  /**< Pointer to the next item to read */
-    void    *write_ptr; /**< Pointer to the next empty slot to write */
-    uint32_t item_size; /**< Size of each item in bytes */
-    uint32_t length;    /**< Queue length (number of items) */
-    uint32_t count;     /**< Current number of items in the queue */
+    uint8_t               *buffer; /**< Start of the queue storage */
+    struct rtos_queue_set *set;    /**< Queue set this queue belongs to, NULL = none */
 
-    rtos_tcb_t *sender_wait_list;   /**< List of tasks waiting to send (queue full) */
-    rtos_tcb_t *receiver_wait_list; /**< List of tasks waiting to receive (queue empty) */
+    rtos_queue_count_t item_size;   /**< Size of each item in bytes */
+    rtos_queue_count_t length;      /**< Queue length (number of items) */
+    rtos_queue_count_t count;       /**< Current number of items in the queue */
+    rtos_queue_count_t read_index;  /**< Slot of the next item to read */
+    rtos_queue_count_t write_index; /**< Next empty slot to write */
+
+    bool write_reserved; /**< Slot at write_index is held by send_acquire */
+    bool read_reserved;  /**< Item at read_index is held by receive_peek */
+    bool is_static;      /**< Control block and storage belong to the caller (create_static) */
+
+    rtos_wait_queue_t sender_waiters;   /**< Tasks waiting to send (queue full) */
+    rtos_wait_queue_t receiver_waiters; /**< Tasks waiting to receive (queue empty) */
 } rtos_queue_t;
 
+/* Consumers may read while an item is queued and no consumer holds a peeked item */
+static inline bool queue_can_read(const rtos_queue_t *queue)
+{
+    return (queue->count > 0) && !queue->read_reserved;
+}
+
 #endif /* QUEUE_PRIV_H */
@@ -0,0 +1,309 @@
+#include "queue_set.h"
+
+#include "VRTOS.h"
+#include "kernel_priv.h"
+#include "klog.h"
+#include "queue_priv.h"
+#include "rtos_port.h"
+#include "scheduler.h"
+#include "task.h"
+#include "task_priv.h"
+
+/*
+ * A set keeps no per-member state of its own. The selector scans the
+ * members under the critical section and blocks on set->waiters only if
+ * none is ready; a member that becomes ready with nobody blocked on it
+ * directly pops one set waiter, which scans again. The scan and the
+ * member update both run under the critical section, so no wake is lost.
+ */
+
+/* =================== Static Helpers =================== */
+
+static bool qset_member_ready(rtos_sync_type_t type, rtos_queue_set_member_t member, const rtos_tcb_t *task)
+{
+    switch (type)
+    {
+        case RTOS_SYNC_TYPE_QUEUE:
+            return queue_can_read((const rtos_queue_t *) member);
+        case RTOS_SYNC_TYPE_SEMAPHORE:
+            return ((const rtos_semaphore_t *) member)->count > 0U;
+        case RTOS_SYNC_TYPE_NOTIFICATION:
+            return task != NULL && task->cold->notification_pending[RTOS_TASK_NOTIFY_DEFAULT_INDEX] != 0U;
+        default:
+            return false;
+    }
+}
+
+/* First ready member in add order, NULL if none. Caller holds a critical section. */
+static rtos_queue_set_member_t qset_find_ready(const rtos_queue_set_t *set, const rtos_tcb_t *task)
+{
+    for (uint8_t i = 0; i < set->member_count; i++)
+    {
+        if (qset_member_ready((rtos_sync_type_t) set->member_types[i], set->members[i], task))
+        {
+            return set->members[i];
+        }
+    }
+
+    return NULL;
+}
+
+/* Index of member in set, or member_count if absent */
+static uint8_t qset_find(const rtos_queue_set_t *set, rtos_queue_set_member_t member)
+{
+    uint8_t i = 0;
+
+    while (i < set->member_count && set->members[i] != member)
+    {
+        i++;
+    }
+
+    return i;
+}
+
+/* Owner back-pointer of a queue or semaphore member, NULL for the notification */
+static struct rtos_queue_set **qset_owner(rtos_sync_type_t type, rtos_queue_set_member_t member)
+{
+    switch (type)
+    {
+        case RTOS_SYNC_TYPE_QUEUE:
+            return &((rtos_queue_t *) (uintptr_t) member)->set;
+        case RTOS_SYNC_TYPE_SEMAPHORE:
+            return &((rtos_semaphore_t *) (uintptr_t) member)->set;
+        default:
+            return NULL;
+    }
+}
+
+static rtos_status_t qset_add(rtos_queue_set_t *set, rtos_queue_set_member_t member, rtos_sync_type_t type)
+{
+    if (set == NULL || member == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    struct rtos_queue_set **owner = qset_owner(type, member);
+
+    rtos_port_enter_critical();
+
+    if ((owner != NULL) ? (*owner != NULL) : (qset_find(set, member) < set->member_count))
+    {
+        rtos_port_exit_critical();
+        return RTOS_ERROR_INVALID_STATE;
+    }
+
+    if (set->member_count >= RTOS_QUEUE_SET_MAX_MEMBERS)
+    {
+        rtos_port_exit_critical();
+        return RTOS_ERROR_FULL;
+    }
+
+    set->members[set->member_count]      = member;
+    set->member_types[set->member_count] = (uint8_t) type;
+    set->member_count++;
+
+    if (owner != NULL)
+    {
+        *owner = set;
+    }
+
+    /* A selector may be blocked while the new member already holds items */
+    rtos_tcb_t *waiter = NULL;
+    if (qset_member_ready(type, member, NULL))
+    {
+        waiter = rtos_queue_set_take_waiter(set);
+    }
+    rtos_kernel_task_unblock(waiter);
+
+    rtos_port_exit_critical();
+    return RTOS_SUCCESS;
+}
+
+/* =================== Wake Hooks / Task-Delete Cleanup =================== */
+
+rtos_tcb_t *rtos_queue_set_take_waiter(void *set_ptr)
+{
+    rtos_queue_set_t *set  = (rtos_queue_set_t *) set_ptr;
+    rtos_tcb_t       *task = rtos_wait_queue_pop(&set->waiters);
+
+    if (task == NULL)
+    {
+        return NULL;
+    }
+
+    task->blocked_on      = NULL;
+    task->blocked_on_type = RTOS_SYNC_TYPE_NONE;
+
+    KLOGD(KEVT_QSET_WAKE, task->task_id, 0);
+
+    return task;
+}
+
+bool rtos_queue_set_take_notified(void *set_ptr, rtos_tcb_t *task)
+{
+    rtos_queue_set_t *set = (rtos_queue_set_t *) set_ptr;
+
+    if (qset_find(set, RTOS_QUEUE_SET_NOTIFICATION) >= set->member_count)
+    {
+        return false;
+    }
+
+    rtos_queue_set_remove_task_from_wait(set, task);
+    KLOGD(KEVT_QSET_WAKE, task->task_id, 1);
+
+    return true;
+}
+
+void rtos_queue_set_remove_task_from_wait(void *set_ptr, rtos_tcb_t *task)
+{
+    rtos_queue_set_t *set = (rtos_queue_set_t *) set_ptr;
+
+    if (task == NULL || task->wait_queue != &set->waiters)
+    {
+        return;
+    }
+
+    rtos_wait_queue_remove(&set->waiters, task);
+
+    task->blocked_on      = NULL;
+    task->blocked_on_type = RTOS_SYNC_TYPE_NONE;
+}
+
+/* =================== Queue Set API =================== */
+
+rtos_status_t rtos_queue_set_init(rtos_queue_set_t *set)
+{
+    if (set == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_port_enter_critical();
+
+    set->member_count = 0;
+    rtos_wait_queue_init(&set->waiters);
+
+    rtos_port_exit_critical();
+
+    return RTOS_SUCCESS;
+}
+
+rtos_status_t rtos_queue_set_add_queue(rtos_queue_set_t *set, rtos_queue_handle_t queue)
+{
+    return qset_add(set, queue, RTOS_SYNC_TYPE_QUEUE);
+}
+
+rtos_status_t rtos_queue_set_add_semaphore(rtos_queue_set_t *set, rtos_semaphore_t *sem)
+{
+    return qset_add(set, sem, RTOS_SYNC_TYPE_SEMAPHORE);
+}
+
+rtos_status_t rtos_queue_set_add_notification(rtos_queue_set_t *set)
+{
+    return qset_add(set, RTOS_QUEUE_SET_NOTIFICATION, RTOS_SYNC_TYPE_NOTIFICATION);
+}
+
+rtos_status_t rtos_queue_set_remove(rtos_queue_set_t *set, rtos_queue_set_member_t member)
+{
+    if (set == NULL || member == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_port_enter_critical();
+
+    uint8_t i = qset_find(set, member);
+    if (i >= set->member_count)
+    {
+        rtos_port_exit_critical();
+        return RTOS_ERROR_INVALID_STATE;
+    }
+
+    struct rtos_queue_set **owner = qset_owner((rtos_sync_type_t) set->member_types[i], member);
+    if (owner != NULL)
+    {
+        *owner = NULL;
+    }
+
+    /* Keep the remaining members in add order */
+    set->member_count--;
+    for (; i < set->member_count; i++)
+    {
+        set->members[i]      = set->members[i + 1U];
+        set->member_types[i] = set->member_types[i + 1U];
+    }
+
+    rtos_port_exit_critical();
+    return RTOS_SUCCESS;
+}
+
+rtos_status_t rtos_queue_set_select(rtos_queue_set_t *set, rtos_queue_set_member_t *member,
+                                    rtos_tick_t timeout_ticks)
+{
+    if (member != NULL)
+    {
+        *member = NULL;
+    }
+
+    if (set == NULL || member == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_port_enter_critical();
+
+    rtos_tcb_t *current_task = rtos_task_get_current();
+    rtos_tick_t start        = rtos_get_tick_count();
+
+    while (1)
+    {
+        rtos_queue_set_member_t ready = qset_find_ready(set, current_task);
+        if (ready != NULL)
+        {
+            rtos_port_exit_critical();
+            *member = ready;
+            return RTOS_SUCCESS;
+        }
+
+        if (timeout_ticks == 0)
+        {
+            rtos_port_exit_critical();
+            return RTOS_ERROR_EMPTY;
+        }
+
+        if (current_task == NULL)
+        {
+            rtos_port_exit_critical();
+            KLOGE(KEVT_NO_CURRENT_TASK, 0, 0);
+            return RTOS_ERROR_INVALID_STATE;
+        }
+
+        /* Woken before, but another selector took the item: wait out the rest */
+        rtos_tick_t wait = timeout_ticks;
+        if (timeout_ticks != RTOS_MAX_DELAY)
+        {
+            rtos_tick_t elapsed = rtos_get_tick_count() - start;
+            if (elapsed >= timeout_ticks)
+            {
+                rtos_port_exit_critical();
+                return RTOS_ERROR_TIMEOUT;
+            }
+            wait = timeout_ticks - elapsed;
+        }
+
+        KLOGD(KEVT_QSET_BLOCK, current_task->task_id, (uint32_t) wait);
+
+        rtos_kernel_block_on(set, RTOS_SYNC_TYPE_QUEUE_SET, &set->waiters, wait);
+
+        /* --- Task resumes here after wake or timeout --- */
+
+        if (current_task->blocked_on == set)
+        {
+            /* Still on the wait list = timeout occurred */
+            rtos_queue_set_remove_task_from_wait(set, current_task);
+            rtos_port_exit_critical();
+            KLOGD(KEVT_QSET_TIMEOUT, current_task->task_id, 0);
+            return RTOS_ERROR_TIMEOUT;
+        }
+    }
+}
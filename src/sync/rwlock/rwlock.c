@@ -0,0 +1,347 @@
+#include "rwlock.h"
+
+#include "VRTOS.h"
+#include "klog.h"
+#include "rtos_port.h"
+#include "task.h"
+#include "task_priv.h"
+
+#include <stddef.h>
+
+/* CMSIS for LDREX/STREX, DMB */
+#include "device.h" // IWYU pragma: keep
+
+/*
+ * state holds the active reader count and RWLOCK_WRITER, which is set from
+ * the moment a writer owns write_lock until it lets readers back in.  While
+ * the bit is set readers queue on read_waiters; a writer hands over to the
+ * next writer with the bit still set, so readers arriving in between cannot
+ * slip in.  Slow paths change state inside the critical section; the read
+ * fast paths change it with LDREX/STREX and the switch to any task that
+ * could write it in between clears the exclusive monitor.
+ */
+#define RWLOCK_WRITER       (1UL << 31)
+#define RWLOCK_READERS_MASK (~RWLOCK_WRITER)
+
+/* Readers woken by a writer are counted in by the waker (hand-off) */
+static uint32_t rwlock_admit_readers(rtos_rwlock_t *rw)
+{
+    uint32_t    woken = 0;
+    rtos_tcb_t *task;
+
+    while ((task = rtos_wait_queue_pop(&rw->read_waiters)) != NULL)
+    {
+        task->blocked_on      = NULL;
+        task->blocked_on_type = RTOS_SYNC_TYPE_NONE;
+        rw->state++;
+        woken++;
+
+        KLOGD(KEVT_RWLOCK_WAKE, task->task_id, 0);
+        rtos_kernel_task_unblock(task);
+    }
+
+    return woken;
+}
+
+/**
+ * @brief Reopen the lock to readers (caller holds the critical section)
+ *
+ * Also called by rtos_task_delete() when it frees the write lock of a
+ * deleted writer.
+ */
+void rtos_rwlock_release_readers(rtos_rwlock_t *rw)
+{
+    rw->state &= RWLOCK_READERS_MASK;
+    rwlock_admit_readers(rw);
+}
+
+void rtos_rwlock_remove_task_from_wait(void *rw_ptr, rtos_tcb_t *task)
+{
+    rtos_rwlock_t *rw = (rtos_rwlock_t *) rw_ptr;
+
+    rtos_wait_queue_remove(&rw->read_waiters, task);
+    if (rw->drain_waiter == task)
+    {
+        rw->drain_waiter = NULL;
+    }
+
+    task->blocked_on      = NULL;
+    task->blocked_on_type = RTOS_SYNC_TYPE_NONE;
+}
+
+/* Add a reader while no writer holds the lock; false means take the slow path */
+static bool rwlock_try_read_lock(rtos_rwlock_t *rw)
+{
+    uint32_t state;
+    do
+    {
+        state = __LDREXW(&rw->state);
+        if ((state & RWLOCK_WRITER) != 0U)
+        {
+            __CLREX();
+            return false;
+        }
+    } while (__STREXW(state + 1U, &rw->state) != 0U);
+
+    /* Data the last writer published is read after the lock */
+    __DMB();
+    return true;
+}
+
+/* Drop a reader while no writer is waiting for it; false means take the slow path */
+static bool rwlock_try_read_unlock(rtos_rwlock_t *rw)
+{
+    /* Reads complete before a writer can see the count drop */
+    __DMB();
+
+    uint32_t state;
+    do
+    {
+        state = __LDREXW(&rw->state);
+        if ((state & RWLOCK_WRITER) != 0U || state == 0U)
+        {
+            __CLREX();
+            return false;
+        }
+    } while (__STREXW(state - 1U, &rw->state) != 0U);
+
+    return true;
+}
+
+rtos_status_t rtos_rwlock_init(rtos_rwlock_t *rw)
+{
+    if (rw == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_mutex_init(&rw->write_lock);
+
+    rtos_port_enter_critical();
+
+    rw->write_lock.rwlock_writer = true;
+    rw->state                    = 0;
+    rw->drain_waiter             = NULL;
+    rtos_wait_queue_init(&rw->read_waiters);
+
+    rtos_port_exit_critical();
+
+    KLOGD(KEVT_RWLOCK_INIT, 0, 0);
+
+    return RTOS_SUCCESS;
+}
+
+rtos_status_t rtos_rwlock_read_lock(rtos_rwlock_t *rw, rtos_tick_t timeout_ticks)
+{
+    if (rw == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    /* Fast path: no writer */
+    if (rwlock_try_read_lock(rw))
+    {
+        return RTOS_SUCCESS;
+    }
+
+    rtos_tcb_t *current_task = rtos_task_get_current();
+    if (current_task == NULL)
+    {
+        KLOGE(KEVT_NO_CURRENT_TASK, 0, 0);
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_port_enter_critical();
+
+    /* The writer may have left since the fast path looked */
+    if ((rw->state & RWLOCK_WRITER) == 0U)
+    {
+        rw->state++;
+        rtos_port_exit_critical();
+        return RTOS_SUCCESS;
+    }
+
+    if (timeout_ticks == RTOS_NO_WAIT)
+    {
+        rtos_port_exit_critical();
+        return RTOS_ERROR_TIMEOUT;
+    }
+
+    /* The writer runs at least at our priority until it lets us in */
+    rtos_mutex_inherit_priority(&rw->write_lock, current_task);
+
+    KLOGD(KEVT_RWLOCK_BLOCK, current_task->task_id, (uint32_t) timeout_ticks);
+
+    rtos_kernel_block_on(rw, RTOS_SYNC_TYPE_RWLOCK, &rw->read_waiters, timeout_ticks);
+
+    /* --- Task resumes here after a write unlock or timeout --- */
+
+    if (current_task->blocked_on == rw)
+    {
+        /* Still on waiting list = timeout occurred */
+        rtos_rwlock_remove_task_from_wait(rw, current_task);
+        rtos_port_exit_critical();
+        KLOGD(KEVT_RWLOCK_TIMEOUT, current_task->task_id, 0);
+        return RTOS_ERROR_TIMEOUT;
+    }
+
+    rtos_port_exit_critical();
+    return RTOS_SUCCESS;
+}
+
+rtos_status_t rtos_rwlock_read_unlock(rtos_rwlock_t *rw)
+{
+    if (rw == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    /* Fast path: no writer waiting for the readers */
+    if (rwlock_try_read_unlock(rw))
+    {
+        return RTOS_SUCCESS;
+    }
+
+    rtos_port_enter_critical();
+
+    if ((rw->state & RWLOCK_READERS_MASK) == 0U)
+    {
+        rtos_port_exit_critical();
+        return RTOS_ERROR_INVALID_STATE;
+    }
+
+    rw->state--;
+
+    /* The last reader out lets the draining writer in */
+    rtos_tcb_t *writer = rw->drain_waiter;
+    if ((rw->state & RWLOCK_READERS_MASK) == 0U && writer != NULL)
+    {
+        rw->drain_waiter        = NULL;
+        writer->blocked_on      = NULL;
+        writer->blocked_on_type = RTOS_SYNC_TYPE_NONE;
+
+        KLOGD(KEVT_RWLOCK_WAKE, writer->task_id, 1);
+        rtos_kernel_task_unblock(writer);
+    }
+
+    rtos_port_exit_critical();
+
+    return RTOS_SUCCESS;
+}
+
+rtos_status_t rtos_rwlock_write_lock(rtos_rwlock_t *rw, rtos_tick_t timeout_ticks)
+{
+    if (rw == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_tcb_t *current_task = rtos_task_get_current();
+    if (current_task == NULL)
+    {
+        KLOGE(KEVT_NO_CURRENT_TASK, 0, 0);
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    /* Nested write lock: the readers are already out */
+    if (rw->write_lock.owner == current_task)
+    {
+        return (rtos_status_t) rtos_mutex_lock(&rw->write_lock, RTOS_NO_WAIT);
+    }
+
+    rtos_tick_t         start  = rtos_get_tick_count();
+    rtos_mutex_status_t status = rtos_mutex_lock(&rw->write_lock, timeout_ticks);
+    if (status != RTOS_MUTEX_OK)
+    {
+        return (rtos_status_t) status;
+    }
+
+    rtos_port_enter_critical();
+
+    rw->state |= RWLOCK_WRITER;
+
+    if ((rw->state & RWLOCK_READERS_MASK) != 0U)
+    {
+        /* The readers inside finish; no new ones get in meanwhile */
+        rtos_tick_t remaining = RTOS_MAX_WAIT;
+        if (timeout_ticks != RTOS_MAX_WAIT)
+        {
+            rtos_tick_t elapsed = rtos_get_tick_count() - start;
+            remaining           = (elapsed < timeout_ticks) ? (timeout_ticks - elapsed) : 0U;
+        }
+
+        if (remaining != 0U)
+        {
+            rw->drain_waiter = current_task;
+
+            KLOGD(KEVT_RWLOCK_BLOCK, current_task->task_id, (uint32_t) remaining);
+
+            rtos_kernel_block_on(rw, RTOS_SYNC_TYPE_RWLOCK, NULL, remaining);
+
+            /* --- Task resumes here after the last reader left, or timeout --- */
+        }
+
+        if (remaining == 0U || current_task->blocked_on == rw)
+        {
+            /* Give up: readers that queued behind us get in, and the next writer waits its turn */
+            rtos_rwlock_remove_task_from_wait(rw, current_task);
+            rtos_rwlock_release_readers(rw);
+            rtos_port_exit_critical();
+
+            rtos_mutex_unlock(&rw->write_lock);
+
+            KLOGD(KEVT_RWLOCK_TIMEOUT, current_task->task_id, 1);
+            return RTOS_ERROR_TIMEOUT;
+        }
+    }
+
+    rtos_port_exit_critical();
+
+    /* Protected data is only written after the readers are out */
+    __DMB();
+
+    return RTOS_SUCCESS;
+}
+
+rtos_status_t rtos_rwlock_write_unlock(rtos_rwlock_t *rw)
+{
+    if (rw == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_tcb_t *current_task = rtos_task_get_current();
+    if (current_task == NULL || rw->write_lock.owner != current_task)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    if (rw->write_lock.lock_count > 1U)
+    {
+        return (rtos_status_t) rtos_mutex_unlock(&rw->write_lock);
+    }
+
+    /* Writes complete before a reader can get in */
+    __DMB();
+
+    rtos_port_enter_critical();
+
+    /* Writers go first unless a waiting reader outranks all of them */
+    rtos_tcb_t *next_writer = rtos_wait_queue_peek(&rw->write_lock.waiters);
+    rtos_tcb_t *next_reader = rtos_wait_queue_peek(&rw->read_waiters);
+
+    if (next_writer == NULL || (next_reader != NULL && next_reader->priority > next_writer->priority))
+    {
+        rtos_rwlock_release_readers(rw);
+    }
+
+    rtos_port_exit_critical();
+
+    /* Hands write_lock to next_writer, and drops anything we inherited */
+    return (rtos_status_t) rtos_mutex_unlock(&rw->write_lock);
+}
+
+uint32_t rtos_rwlock_get_reader_count(const rtos_rwlock_t *rw)
+{
+    return (rw != NULL) ? (rw->state & RWLOCK_READERS_MASK) : 0U;
+}
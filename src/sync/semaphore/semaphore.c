@@ -8,86 +8,117 @@
 
 #include <string.h>
 
-static void sem_add_to_waiting_list(rtos_semaphore_t *sem, rtos_tcb_t *task)
-{
-    task->next_waiting    = NULL;
-    task->blocked_on      = sem;
-    task->blocked_on_type = RTOS_SYNC_TYPE_SEMAPHORE;
-
-    if (sem->waiting_list == NULL)
-    {
-        sem->waiting_list = task;
-        return;
-    }
-
-    /* Insert in priority order (highest priority at head) */
-    rtos_tcb_t *current = sem->waiting_list;
-    rtos_tcb_t *prev    = NULL;
-
-    while (current != NULL && current->priority >= task->priority)
-    {
-        prev    = current;
-        current = current->next_waiting;
-    }
-
-    if (prev == NULL)
-    {
-        task->next_waiting = sem->waiting_list;
-        sem->waiting_list  = task;
-    }
-    else
-    {
-        task->next_waiting = current;
-        prev->next_waiting = task;
-    }
-}
+/* CMSIS for LDREX/STREX, DMB */
+#include "device.h" // IWYU pragma: keep
 
 static void sem_remove_from_waiting_list(rtos_semaphore_t *sem, rtos_tcb_t *task)
 {
-    if (sem->waiting_list == NULL || task == NULL)
+    if (task == NULL)
     {
         return;
     }
 
-    if (sem->waiting_list == task)
-    {
-        sem->waiting_list = task->next_waiting;
-    }
-    else
-    {
-        rtos_tcb_t *current = sem->waiting_list;
-        while (current->next_waiting != NULL && current->next_waiting != task)
-        {
-            current = current->next_waiting;
-        }
-        if (current->next_waiting == task)
-        {
-            current->next_waiting = task->next_waiting;
-        }
-    }
+    rtos_wait_queue_remove(&sem->waiters, task);
 
-    task->next_waiting    = NULL;
     task->blocked_on      = NULL;
     task->blocked_on_type = RTOS_SYNC_TYPE_NONE;
 }
 
 static rtos_tcb_t *sem_pop_highest_priority_waiter(rtos_semaphore_t *sem)
 {
-    if (sem->waiting_list == NULL)
+    rtos_tcb_t *task = rtos_wait_queue_pop(&sem->waiters);
+    if (task == NULL)
     {
         return NULL;
     }
 
-    /* Head is always highest priority due to ordered insertion */
-    rtos_tcb_t *task      = sem->waiting_list;
-    sem->waiting_list     = task->next_waiting;
-    task->next_waiting    = NULL;
     task->blocked_on      = NULL;
     task->blocked_on_type = RTOS_SYNC_TYPE_NONE;
 
     return task;
 }
 
+/*
+ * Fast paths without the critical section: count is changed with
+ * LDREX/STREX, and the give succeeds only while nobody waits, checked inside
+ * the same exclusive window.  Queue set members always give on the slow
+ * path, which may have to wake the set.  A waiter can only queue itself from another
+ * task, and the switch to it clears the exclusive monitor, as does any ISR
+ * that gives in between; the STREX then fails and the loop looks again.
+ * On two cores a waiter queues itself without clearing this core's monitor,
+ * so with RTOS_SMP_CORES > 1 every take and give uses the kernel lock.
+ */
+#define SEM_COUNT_WORD(sem) ((volatile uint32_t *) &(sem)->count)
+
+#if RTOS_FOOTPRINT_COMPACT
+/*
+ * count shares its word with max_count, which never changes after init:
+ * count is the low half on a little-endian core, so the word changes by 1
+ * exactly as count does.
+ */
+RTOS_STATIC_ASSERT(offsetof(rtos_semaphore_t, count) == 0U && offsetof(rtos_semaphore_t, max_count) == 2U &&
+                       __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+                   "count must be the low half of the semaphore's first word");
+#define SEM_WORD_COUNT(word)      ((word) & 0xFFFFU)
+#define SEM_AT_MAX(sem, count)    ((count) >= (((sem)->max_count != 0U) ? (sem)->max_count : UINT16_MAX))
+#else
+#define SEM_WORD_COUNT(word)      (word)
+#define SEM_AT_MAX(sem, count)    ((sem)->max_count != 0 && (count) >= (sem)->max_count)
+#endif
+
+#if RTOS_SMP_CORES == 1
+/* Decrement a non-zero count; false if it is zero */
+static bool sem_try_take(rtos_semaphore_t *sem)
+{
+    uint32_t word;
+    do
+    {
+        word = __LDREXW(SEM_COUNT_WORD(sem));
+        if (SEM_WORD_COUNT(word) == 0U)
+        {
+            __CLREX();
+            return false;
+        }
+    } while (__STREXW(word - 1U, SEM_COUNT_WORD(sem)) != 0U);
+
+    /* Data the giver published is read after the take */
+    __DMB();
+    return true;
+}
+
+/* Increment the count; false if a task waits, the count is at max_count, or sem is in a set */
+static bool sem_try_give(rtos_semaphore_t *sem)
+{
+    /* Data for the taker is written before the give */
+    __DMB();
+
+    uint32_t word;
+    do
+    {
+        word = __LDREXW(SEM_COUNT_WORD(sem));
+        if (!rtos_wait_queue_is_empty(&sem->waiters) || sem->set != NULL || SEM_AT_MAX(sem, SEM_WORD_COUNT(word)))
+        {
+            __CLREX();
+            return false;
+        }
+    } while (__STREXW(word + 1U, SEM_COUNT_WORD(sem)) != 0U);
+
+    return true;
+}
+#else
+static inline bool sem_try_take(rtos_semaphore_t *sem)
+{
+    (void) sem;
+    return false;
+}
+
+static inline bool sem_try_give(rtos_semaphore_t *sem)
+{
+    (void) sem;
+    return false;
+}
+#endif /* RTOS_SMP_CORES == 1 */
+
 void rtos_sem_remove_task_from_wait(void *sem_ptr, rtos_tcb_t *task)
 {
     sem_remove_from_waiting_list((rtos_semaphore_t *) sem_ptr, task);
@@ -105,11 +136,19 @@ rtos_sem_status_t rtos_semaphore_init(rtos_semaphore_t *sem, uint32_t initial_co
         return RTOS_SEM_ERR_INVALID;
     }
 
+#if RTOS_FOOTPRINT_COMPACT
+    if (initial_count > UINT16_MAX || max_count > UINT16_MAX)
+    {
+        return RTOS_SEM_ERR_INVALID;
+    }
+#endif
+
     rtos_port_enter_critical();
 
-    sem->count        = initial_count;
-    sem->max_count    = max_count;
-    sem->waiting_list = NULL;
+    sem->count     = (rtos_sem_count_t) initial_count;
+    sem->max_count = (rtos_sem_count_t) max_count;
+    sem->set       = NULL;
+    rtos_wait_queue_init(&sem->waiters);
 
     rtos_port_exit_critical();
 
@@ -125,9 +164,16 @@ rtos_sem_status_t rtos_semaphore_wait(rtos_semaphore_t *sem, rtos_tick_t timeout
         return RTOS_SEM_ERR_INVALID;
     }
 
+    /* Fast path: semaphore available */
+    if (sem_try_take(sem))
+    {
+        KLOGD(KEVT_SEM_ACQUIRE, sem->count, 0);
+        return RTOS_SEM_OK;
+    }
+
     rtos_port_enter_critical();
 
-    /* Fast path: semaphore available */
+    /* Given since the fast path looked, or no fast path */
     if (sem->count > 0)
     {
         sem->count--;
@@ -150,29 +196,12 @@ rtos_sem_status_t rtos_semaphore_wait(rtos_semaphore_t *sem, rtos_tick_t timeout
         return RTOS_SEM_ERR_INVALID;
     }
 
-    sem_add_to_waiting_list(sem, current_task);
-
     KLOGD(KEVT_SEM_BLOCK, current_task->task_id, (uint32_t) timeout_ticks);
 
-    if (timeout_ticks == RTOS_SEM_MAX_WAIT)
-    {
-        /* Infinite wait - block without delay timeout */
-        current_task->state = RTOS_TASK_STATE_BLOCKED;
-        rtos_scheduler_remove_from_ready_list(current_task);
-        rtos_port_exit_critical();
-        rtos_yield();
-    }
-    else
-    {
-        /* Timed wait - use kernel block with delay */
-        rtos_port_exit_critical();
-        rtos_kernel_task_block(current_task, timeout_ticks);
-    }
+    rtos_kernel_block_on(sem, RTOS_SYNC_TYPE_SEMAPHORE, &sem->waiters, timeout_ticks);
 
     /* --- Task resumes here after unblock or timeout --- */
 
-    rtos_port_enter_critical();
-
     /* Check if we were woken by signal (blocked_on cleared) or timeout */
     if (current_task->blocked_on == sem)
     {
@@ -195,6 +224,13 @@ rtos_sem_status_t rtos_semaphore_signal(rtos_semaphore_t *sem)
         return RTOS_SEM_ERR_INVALID;
     }
 
+    /* Fast path: nobody to wake */
+    if (sem_try_give(sem))
+    {
+        KLOGD(KEVT_SEM_SIGNAL, sem->count, 0);
+        return RTOS_SEM_OK;
+    }
+
     rtos_port_enter_critical();
 
     /* Check for waiting tasks first */
@@ -210,7 +246,7 @@ rtos_sem_status_t rtos_semaphore_signal(rtos_semaphore_t *sem)
     }
 
 
-    if (sem->max_count != 0 && sem->count >= sem->max_count)
+    if (SEM_AT_MAX(sem, sem->count))
     {
         rtos_port_exit_critical();
         KLOGE(KEVT_SEM_OVERFLOW, sem->count, sem->max_count);
@@ -218,12 +254,69 @@ rtos_sem_status_t rtos_semaphore_signal(rtos_semaphore_t *sem)
     }
 
     sem->count++;
+    if (sem->set != NULL)
+    {
+        rtos_kernel_task_unblock(rtos_queue_set_take_waiter(sem->set));
+    }
     rtos_port_exit_critical();
 
     KLOGD(KEVT_SEM_SIGNAL, sem->count, 0);
     return RTOS_SEM_OK;
 }
 
+rtos_sem_status_t rtos_semaphore_signal_from_isr(rtos_semaphore_t *sem, bool *higher_priority_task_woken)
+{
+    if (sem == NULL)
+    {
+        return RTOS_SEM_ERR_INVALID;
+    }
+
+    if (sem_try_give(sem))
+    {
+        KLOGD(KEVT_SEM_SIGNAL, sem->count, 0);
+        return RTOS_SEM_OK;
+    }
+
+    uint32_t saved = rtos_port_enter_critical_from_isr();
+
+    rtos_tcb_t *waiter = sem_pop_highest_priority_waiter(sem);
+    if (waiter == NULL)
+    {
+        /* The waiter timed out meanwhile, the count is at max, or sem is in a set */
+        if (SEM_AT_MAX(sem, sem->count))
+        {
+            rtos_port_exit_critical_from_isr(saved);
+            KLOGE(KEVT_SEM_OVERFLOW, sem->count, sem->max_count);
+            return RTOS_SEM_ERR_OVERFLOW;
+        }
+
+        sem->count++;
+
+        /* A queue set member wakes the set's waiter instead */
+        waiter = (sem->set != NULL) ? rtos_queue_set_take_waiter(sem->set) : NULL;
+        rtos_port_exit_critical_from_isr(saved);
+        KLOGD(KEVT_SEM_SIGNAL, sem->count, 0);
+
+        if (rtos_kernel_task_unblock_from_isr(waiter) && higher_priority_task_woken != NULL)
+        {
+            *higher_priority_task_woken = true;
+        }
+        return RTOS_SEM_OK;
+    }
+
+    rtos_port_exit_critical_from_isr(saved);
+
+    KLOGD(KEVT_SEM_WAKE, waiter->task_id, 0);
+
+    /* Unblock outside ISR critical section; the yield is left to the caller */
+    if (rtos_kernel_task_unblock_from_isr(waiter) && higher_priority_task_woken != NULL)
+    {
+        *higher_priority_task_woken = true;
+    }
+
+    return RTOS_SEM_OK;
+}
+
 rtos_sem_status_t rtos_semaphore_try_wait(rtos_semaphore_t *sem)
 {
     return rtos_semaphore_wait(sem, RTOS_SEM_NO_WAIT);
@@ -0,0 +1,104 @@
+/*******************************************************************************
+ * File: src/sync/snapshot/snapshot.c
+ * Description: Lock-free latest-value snapshot implementation
+ ******************************************************************************/
+
+#include "snapshot.h"
+
+#include <stddef.h>
+#include <string.h>
+
+/* CMSIS for DMB */
+#include "device.h" // IWYU pragma: keep
+
+/*
+ * Write k (k = 1, 2, ...) moves sequence from 2k-2 to 2k-1, fills slot
+ * k & 1, then moves it to 2k.  The published slot is (sequence >> 1) & 1
+ * whether or not a write is in progress, and the writer is never in it.
+ * Write k+2 is the first to reuse the slot a reader picked at write k, so
+ * the copy is only torn if sequence moved more than 2 past the last even
+ * value the reader saw.
+ */
+
+static inline uint8_t *snapshot_slot(const rtos_snapshot_t *snap, uint32_t write_index)
+{
+    return snap->slots + ((write_index & 1U) * snap->size);
+}
+
+rtos_status_t rtos_snapshot_init(rtos_snapshot_t *snap, void *storage, uint32_t size)
+{
+    if (snap == NULL || storage == NULL || size == 0U)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    snap->slots    = (uint8_t *) storage;
+    snap->size     = size;
+    snap->sequence = 0;
+    snap->written  = false;
+
+    return RTOS_SUCCESS;
+}
+
+rtos_status_t rtos_snapshot_write(rtos_snapshot_t *snap, const void *value)
+{
+    if (snap == NULL || value == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    uint32_t seq = snap->sequence;
+
+    snap->sequence = seq + 1U;
+    __DMB();
+
+    memcpy(snapshot_slot(snap, (seq >> 1) + 1U), value, snap->size);
+
+    /* The record is complete before readers are pointed at it */
+    __DMB();
+    snap->sequence = seq + 2U;
+
+    __DMB();
+    snap->written = true;
+
+    return RTOS_SUCCESS;
+}
+
+rtos_status_t rtos_snapshot_read(const rtos_snapshot_t *snap, void *value, uint32_t *version)
+{
+    if (snap == NULL || value == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    if (!snap->written)
+    {
+        return RTOS_ERROR_EMPTY;
+    }
+    __DMB();
+
+    uint32_t start;
+    uint32_t end;
+    do
+    {
+        start = snap->sequence;
+        __DMB();
+
+        memcpy(value, snapshot_slot(snap, start >> 1), snap->size);
+
+        __DMB();
+        end = snap->sequence;
+    } while ((end - (start & ~1U)) > 2U);
+
+    if (version != NULL)
+    {
+        *version = start >> 1;
+    }
+
+    return RTOS_SUCCESS;
+}
+
+uint32_t rtos_snapshot_version(const rtos_snapshot_t *snap)
+{
+    return (snap != NULL) ? (snap->sequence >> 1) : 0U;
+}
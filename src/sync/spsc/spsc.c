@@ -0,0 +1,191 @@
+/*******************************************************************************
+ * File: src/sync/spsc/spsc.c
+ * Description: Lock-free single-producer single-consumer channel
+ ******************************************************************************/
+
+#include "spsc.h"
+
+#include "VRTOS.h"
+#include "config.h"
+#include "rtos_mem.h"
+#include "task.h"
+
+#include <stddef.h>
+
+/* CMSIS for DMB */
+#include "device.h" // IWYU pragma: keep
+
+/*
+ * The producer writes the slot, then releases it by storing head; the
+ * consumer acquires it by loading head before reading the slot, and hands it
+ * back the same way through tail. One core sees its own program order (an
+ * ISR and the task it interrupted included), so only the compiler must be
+ * kept from reordering; cores sharing the channel need a DMB.
+ *
+ * Wakeup: the producer stores head, then loads tail. If tail had reached the
+ * old head the consumer drained the channel and may be about to block, so it
+ * is notified; otherwise it still has items to read and sees the new head
+ * before it checks for empty. The notification is a count, so one sent
+ * between the consumer's check and its block is not lost. A consumer that
+ * read the new item before the notification arrived wakes once for nothing
+ * and finds the channel empty.
+ */
+#if RTOS_SMP_CORES > 1
+#define SPSC_BARRIER() __DMB()
+#else
+#define SPSC_BARRIER() __asm__ volatile("" ::: "memory")
+#endif
+
+static inline uint8_t *spsc_slot(const rtos_spsc_t *ch, uint32_t index)
+{
+    return ch->storage + ((index & ch->mask) * ch->item_size);
+}
+
+/* Copy item in and publish it. Returns true if the consumer must be notified. */
+static bool spsc_push(rtos_spsc_t *ch, const void *item, rtos_status_t *status)
+{
+    uint32_t head = ch->head;
+
+    if (head - ch->tail > ch->mask)
+    {
+        *status = RTOS_ERROR_FULL;
+        return false;
+    }
+
+    /* The slot is free once tail has passed it */
+    SPSC_BARRIER();
+    rtos_mem_copy(spsc_slot(ch, head), item, ch->item_size);
+
+    SPSC_BARRIER();
+    ch->head = head + 1U;
+
+    *status = RTOS_SUCCESS;
+
+    SPSC_BARRIER();
+    return (ch->tail == head) && (ch->consumer != NULL);
+}
+
+static bool spsc_pop(rtos_spsc_t *ch, void *buffer)
+{
+    uint32_t tail = ch->tail;
+
+    if (ch->head == tail)
+    {
+        return false;
+    }
+
+    /* The slot is complete once head has passed it */
+    SPSC_BARRIER();
+    rtos_mem_copy(buffer, spsc_slot(ch, tail), ch->item_size);
+
+    SPSC_BARRIER();
+    ch->tail = tail + 1U;
+
+    return true;
+}
+
+rtos_status_t rtos_spsc_init(rtos_spsc_t *ch, void *storage, uint32_t item_size, uint32_t capacity,
+                             rtos_task_handle_t consumer, uint8_t notify_index)
+{
+    if (ch == NULL || storage == NULL || item_size == 0U || capacity == 0U || (capacity & (capacity - 1U)) != 0U ||
+        notify_index >= RTOS_TASK_NOTIFY_ARRAY_ENTRIES)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    ch->head         = 0;
+    ch->tail         = 0;
+    ch->storage      = (uint8_t *) storage;
+    ch->item_size    = item_size;
+    ch->mask         = capacity - 1U;
+    ch->consumer     = consumer;
+    ch->notify_index = notify_index;
+
+    return RTOS_SUCCESS;
+}
+
+rtos_status_t rtos_spsc_send(rtos_spsc_t *ch, const void *item)
+{
+    if (ch == NULL || item == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_status_t status;
+    if (spsc_push(ch, item, &status))
+    {
+        rtos_task_notify_give_indexed(ch->consumer, ch->notify_index);
+    }
+
+    return status;
+}
+
+rtos_status_t rtos_spsc_send_from_isr(rtos_spsc_t *ch, const void *item, bool *higher_priority_task_woken)
+{
+    if (ch == NULL || item == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_status_t status;
+    if (spsc_push(ch, item, &status))
+    {
+        rtos_task_notify_give_indexed_from_isr(ch->consumer, ch->notify_index, higher_priority_task_woken);
+    }
+
+    return status;
+}
+
+rtos_status_t rtos_spsc_receive(rtos_spsc_t *ch, void *buffer, rtos_tick_t timeout_ticks)
+{
+    if (ch == NULL || buffer == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    /* Fast path: an item is waiting */
+    if (spsc_pop(ch, buffer))
+    {
+        return RTOS_SUCCESS;
+    }
+
+    if (timeout_ticks == 0U)
+    {
+        return RTOS_ERROR_EMPTY;
+    }
+
+    if (ch->consumer == NULL || ch->consumer != rtos_task_get_current())
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_tick_t start = rtos_get_tick_count();
+
+    while (1)
+    {
+        rtos_tick_t remaining = RTOS_MAX_DELAY;
+        if (timeout_ticks != RTOS_MAX_DELAY)
+        {
+            rtos_tick_t elapsed = rtos_get_tick_count() - start;
+            remaining           = (elapsed < timeout_ticks) ? (timeout_ticks - elapsed) : 0U;
+        }
+
+        bool notified = (remaining != 0U) &&
+                        (rtos_task_notify_take_indexed(ch->notify_index, true, remaining) == RTOS_NOTIFY_OK);
+
+        if (spsc_pop(ch, buffer))
+        {
+            return RTOS_SUCCESS;
+        }
+
+        if (!notified)
+        {
+            return RTOS_ERROR_TIMEOUT;
+        }
+    }
+}
+
+uint32_t rtos_spsc_count(const rtos_spsc_t *ch)
+{
+    return (ch != NULL) ? (ch->head - ch->tail) : 0U;
+}
@@ -0,0 +1,601 @@
+/*******************************************************************************
+ * File: src/sync/stream_buffer/stream_buffer.c
+ * Description: Stream buffer and message buffer implementation
+ ******************************************************************************/
+
+#include "stream_buffer.h"
+
+#include "VRTOS.h"
+#include "klog.h"
+#include "rtos_port.h"
+#include "task.h"
+#include "task_priv.h"
+
+#include <stddef.h>
+
+/*
+ * Data moves lock-free: the writer only advances rb.head and the reader only
+ * rb.tail.  The critical section guards the blocked-task pointers alone.  A
+ * side registers itself as blocked, and re-checks the ring, inside the
+ * critical section, so the other side either sees the registration after
+ * moving its index or the blocker sees the moved index; no wake is lost.
+ */
+
+typedef uint16_t sb_msg_len_t;
+
+/* =================== Static Helpers =================== */
+
+static uint32_t sb_capacity(const rtos_stream_buffer_t *sb)
+{
+    return sb->rb.mask;
+}
+
+/* Caller holds a critical section. Returns the reader if it may now run. */
+static rtos_tcb_t *sb_take_reader(rtos_stream_buffer_t *sb)
+{
+    rtos_tcb_t *task = sb->reader;
+
+    if (task == NULL || ring_buffer_count(&sb->rb) < sb->trigger_level)
+    {
+        return NULL;
+    }
+
+    sb->reader            = NULL;
+    task->blocked_on      = NULL;
+    task->blocked_on_type = RTOS_SYNC_TYPE_NONE;
+
+    return task;
+}
+
+/* Caller holds a critical section. Returns the writer if it may now run. */
+static rtos_tcb_t *sb_take_writer(rtos_stream_buffer_t *sb)
+{
+    rtos_tcb_t *task = sb->writer;
+
+    if (task == NULL || ring_buffer_free(&sb->rb) < sb->writer_needs)
+    {
+        return NULL;
+    }
+
+    sb->writer            = NULL;
+    task->blocked_on      = NULL;
+    task->blocked_on_type = RTOS_SYNC_TYPE_NONE;
+
+    return task;
+}
+
+/* Wake the blocked reader or writer, if any and its condition holds */
+static void sb_wake(rtos_stream_buffer_t *sb, bool reader)
+{
+    rtos_port_enter_critical();
+    rtos_tcb_t *task = reader ? sb_take_reader(sb) : sb_take_writer(sb);
+    rtos_port_exit_critical();
+
+    if (task != NULL)
+    {
+        KLOGD(KEVT_SB_WAKE, task->task_id, reader ? 1U : 0U);
+        rtos_kernel_task_unblock(task);
+    }
+}
+
+/* ISR form of sb_wake(): no yield, accumulates into *woken */
+static void sb_wake_from_isr(rtos_stream_buffer_t *sb, bool reader, bool *woken)
+{
+    uint32_t    saved = rtos_port_enter_critical_from_isr();
+    rtos_tcb_t *task  = reader ? sb_take_reader(sb) : sb_take_writer(sb);
+    rtos_port_exit_critical_from_isr(saved);
+
+    if (task == NULL)
+    {
+        return;
+    }
+
+    KLOGD(KEVT_SB_WAKE, task->task_id, reader ? 1U : 0U);
+
+    if (rtos_kernel_task_unblock_from_isr(task) && woken != NULL)
+    {
+        *woken = true;
+    }
+}
+
+/**
+ * @brief Block the current task as reader (writer_needs == 0) or writer
+ *
+ * @return false on timeout; true once woken, or at once if the condition
+ *         became true before the task could block (caller retries)
+ */
+static bool sb_block(rtos_stream_buffer_t *sb, bool reader, uint32_t writer_needs, rtos_tick_t timeout_ticks)
+{
+    rtos_port_enter_critical();
+
+    /* Moved by the other side since the caller looked */
+    if (reader ? !ring_buffer_is_empty(&sb->rb) : (ring_buffer_free(&sb->rb) >= writer_needs))
+    {
+        rtos_port_exit_critical();
+        return true;
+    }
+
+    rtos_tcb_t *current_task = rtos_task_get_current();
+    if (current_task == NULL)
+    {
+        rtos_port_exit_critical();
+        KLOGE(KEVT_NO_CURRENT_TASK, 0, 0);
+        return false;
+    }
+
+    if (reader)
+    {
+        sb->reader = current_task;
+    }
+    else
+    {
+        sb->writer       = current_task;
+        sb->writer_needs = writer_needs;
+    }
+
+    KLOGD(KEVT_SB_BLOCK, current_task->task_id, (uint32_t) timeout_ticks);
+
+    rtos_kernel_block_on(sb, RTOS_SYNC_TYPE_STREAM_BUFFER, NULL, timeout_ticks);
+
+    /* --- Task resumes here after wake or timeout --- */
+
+    if (current_task->blocked_on == sb)
+    {
+        /* Still registered = timeout occurred */
+        rtos_stream_buffer_remove_task_from_wait(sb, current_task);
+        rtos_port_exit_critical();
+        KLOGD(KEVT_SB_TIMEOUT, current_task->task_id, 0);
+        return false;
+    }
+
+    rtos_port_exit_critical();
+    return true;
+}
+
+/* Lock-free write; returns bytes written (all or nothing for messages) */
+static uint32_t sb_write(rtos_stream_buffer_t *sb, const void *data, uint32_t len)
+{
+    if (sb->is_message)
+    {
+        sb_msg_len_t header = (sb_msg_len_t) len;
+        return ring_buffer_write_pair(&sb->rb, &header, sizeof(header), data, len) ? len : 0U;
+    }
+
+    uint32_t space = ring_buffer_free(&sb->rb);
+    uint32_t n     = (len < space) ? len : space;
+
+    if (n > 0U)
+    {
+        (void) ring_buffer_write(&sb->rb, data, n);
+    }
+
+    return n;
+}
+
+/* Length of the oldest message, 0 if none */
+static uint32_t sb_next_message(const rtos_stream_buffer_t *sb)
+{
+    sb_msg_len_t header = 0;
+
+    if (ring_buffer_peek(&sb->rb, &header, sizeof(header)) != sizeof(header))
+    {
+        return 0;
+    }
+
+    return header;
+}
+
+/*
+ * Lock-free read into *n. Messages come out whole; one longer than max_len
+ * stays queued and reports RTOS_ERROR_NO_MEMORY with its length in *n.
+ */
+static rtos_status_t sb_read(rtos_stream_buffer_t *sb, void *buffer, uint32_t max_len, uint32_t *n)
+{
+    if (!sb->is_message)
+    {
+        *n = ring_buffer_read(&sb->rb, buffer, max_len);
+        return RTOS_SUCCESS;
+    }
+
+    uint32_t len = sb_next_message(sb);
+    *n           = len;
+
+    if (len == 0U)
+    {
+        return RTOS_SUCCESS;
+    }
+    if (len > max_len)
+    {
+        return RTOS_ERROR_NO_MEMORY;
+    }
+
+    ring_buffer_skip(&sb->rb, sizeof(sb_msg_len_t));
+    (void) ring_buffer_read(&sb->rb, buffer, len);
+    return RTOS_SUCCESS;
+}
+
+static rtos_status_t sb_send(rtos_stream_buffer_t *sb, const void *data, uint32_t len, uint32_t *bytes_sent,
+                             rtos_tick_t timeout_ticks)
+{
+    /* Messages wait for room for the whole frame, streams for one byte */
+    uint32_t needs = sb->is_message ? (len + sizeof(sb_msg_len_t)) : 1U;
+
+    while (1)
+    {
+        uint32_t n = sb_write(sb, data, len);
+
+        if (n > 0U)
+        {
+            if (bytes_sent != NULL)
+            {
+                *bytes_sent = n;
+            }
+            if (sb->reader != NULL)
+            {
+                sb_wake(sb, true);
+            }
+            return RTOS_SUCCESS;
+        }
+
+        if (timeout_ticks == 0U)
+        {
+            return RTOS_ERROR_FULL;
+        }
+
+        if (!sb_block(sb, false, needs, timeout_ticks))
+        {
+            return RTOS_ERROR_TIMEOUT;
+        }
+        /* Woken with room: the next write cannot fail */
+    }
+}
+
+static rtos_status_t sb_receive(rtos_stream_buffer_t *sb, void *buffer, uint32_t max_len, uint32_t *received,
+                                rtos_tick_t timeout_ticks)
+{
+    bool blocked = false;
+
+    while (1)
+    {
+        uint32_t      n      = 0;
+        rtos_status_t status = sb_read(sb, buffer, max_len, &n);
+
+        if (received != NULL)
+        {
+            *received = n;
+        }
+
+        if (status != RTOS_SUCCESS)
+        {
+            return status;
+        }
+
+        if (n > 0U)
+        {
+            if (sb->writer != NULL)
+            {
+                sb_wake(sb, false);
+            }
+            return RTOS_SUCCESS;
+        }
+
+        if (blocked)
+        {
+            return RTOS_ERROR_TIMEOUT;
+        }
+
+        if (timeout_ticks == 0U)
+        {
+            return RTOS_ERROR_EMPTY;
+        }
+
+        /* Woken at the trigger level, or timed out: either way read once more
+         * and return whatever arrived */
+        (void) sb_block(sb, true, 0U, timeout_ticks);
+        blocked = true;
+    }
+}
+
+static rtos_status_t sb_send_from_isr(rtos_stream_buffer_t *sb, const void *data, uint32_t len,
+                                      uint32_t *bytes_sent, bool *higher_priority_task_woken)
+{
+    uint32_t n = sb_write(sb, data, len);
+
+    if (bytes_sent != NULL)
+    {
+        *bytes_sent = n;
+    }
+
+    if (n == 0U)
+    {
+        return RTOS_ERROR_FULL;
+    }
+
+    if (sb->reader != NULL)
+    {
+        sb_wake_from_isr(sb, true, higher_priority_task_woken);
+    }
+
+    return RTOS_SUCCESS;
+}
+
+static rtos_status_t sb_receive_from_isr(rtos_stream_buffer_t *sb, void *buffer, uint32_t max_len,
+                                         uint32_t *received, bool *higher_priority_task_woken)
+{
+    uint32_t      n      = 0;
+    rtos_status_t status = sb_read(sb, buffer, max_len, &n);
+
+    if (received != NULL)
+    {
+        *received = n;
+    }
+
+    if (status != RTOS_SUCCESS)
+    {
+        return status;
+    }
+
+    if (n == 0U)
+    {
+        return RTOS_ERROR_EMPTY;
+    }
+
+    if (sb->writer != NULL)
+    {
+        sb_wake_from_isr(sb, false, higher_priority_task_woken);
+    }
+
+    return RTOS_SUCCESS;
+}
+
+static rtos_status_t sb_init(rtos_stream_buffer_t *sb, uint8_t *storage, uint32_t size, uint32_t trigger_level,
+                             uint8_t is_message)
+{
+    ring_buffer_init(&sb->rb, storage, size);
+    sb->trigger_level = trigger_level;
+    sb->writer_needs  = 0;
+    sb->reader        = NULL;
+    sb->writer        = NULL;
+    sb->is_message    = is_message;
+
+    KLOGD(KEVT_SB_INIT, size, trigger_level);
+
+    return RTOS_SUCCESS;
+}
+
+static bool sb_size_valid(uint32_t size, uint32_t min_size)
+{
+    return size >= min_size && (size & (size - 1U)) == 0U;
+}
+
+/* =================== Task-Delete Cleanup =================== */
+
+void rtos_stream_buffer_remove_task_from_wait(void *sb_ptr, rtos_tcb_t *task)
+{
+    rtos_stream_buffer_t *sb = (rtos_stream_buffer_t *) sb_ptr;
+
+    if (task == NULL)
+    {
+        return;
+    }
+
+    if (sb->reader == task)
+    {
+        sb->reader = NULL;
+    }
+    if (sb->writer == task)
+    {
+        sb->writer = NULL;
+    }
+
+    task->blocked_on      = NULL;
+    task->blocked_on_type = RTOS_SYNC_TYPE_NONE;
+}
+
+/* =================== Stream Buffer API =================== */
+
+rtos_status_t rtos_stream_buffer_init(rtos_stream_buffer_t *sb, uint8_t *storage, uint32_t size,
+                                      uint32_t trigger_level)
+{
+    if (sb == NULL || storage == NULL || !sb_size_valid(size, 2U) || trigger_level >= size)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    return sb_init(sb, storage, size, (trigger_level == 0U) ? 1U : trigger_level, 0U);
+}
+
+rtos_status_t rtos_stream_buffer_send(rtos_stream_buffer_t *sb, const void *data, uint32_t len,
+                                      uint32_t *bytes_sent, rtos_tick_t timeout_ticks)
+{
+    if (bytes_sent != NULL)
+    {
+        *bytes_sent = 0;
+    }
+
+    if (sb == NULL || data == NULL || len == 0U || sb->is_message)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    return sb_send(sb, data, len, bytes_sent, timeout_ticks);
+}
+
+rtos_status_t rtos_stream_buffer_receive(rtos_stream_buffer_t *sb, void *buffer, uint32_t max_len,
+                                         uint32_t *bytes_received, rtos_tick_t timeout_ticks)
+{
+    if (bytes_received != NULL)
+    {
+        *bytes_received = 0;
+    }
+
+    if (sb == NULL || buffer == NULL || max_len == 0U || sb->is_message)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    return sb_receive(sb, buffer, max_len, bytes_received, timeout_ticks);
+}
+
+rtos_status_t rtos_stream_buffer_send_from_isr(rtos_stream_buffer_t *sb, const void *data, uint32_t len,
+                                               uint32_t *bytes_sent, bool *higher_priority_task_woken)
+{
+    if (bytes_sent != NULL)
+    {
+        *bytes_sent = 0;
+    }
+
+    if (sb == NULL || data == NULL || len == 0U || sb->is_message)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    return sb_send_from_isr(sb, data, len, bytes_sent, higher_priority_task_woken);
+}
+
+rtos_status_t rtos_stream_buffer_receive_from_isr(rtos_stream_buffer_t *sb, void *buffer, uint32_t max_len,
+                                                  uint32_t *bytes_received, bool *higher_priority_task_woken)
+{
+    if (bytes_received != NULL)
+    {
+        *bytes_received = 0;
+    }
+
+    if (sb == NULL || buffer == NULL || max_len == 0U || sb->is_message)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    return sb_receive_from_isr(sb, buffer, max_len, bytes_received, higher_priority_task_woken);
+}
+
+rtos_status_t rtos_stream_buffer_set_trigger_level(rtos_stream_buffer_t *sb, uint32_t trigger_level)
+{
+    if (sb == NULL || sb->is_message || trigger_level > sb_capacity(sb))
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_port_enter_critical();
+    sb->trigger_level = (trigger_level == 0U) ? 1U : trigger_level;
+    rtos_port_exit_critical();
+
+    /* A lower level may already be met */
+    if (sb->reader != NULL)
+    {
+        sb_wake(sb, true);
+    }
+
+    return RTOS_SUCCESS;
+}
+
+uint32_t rtos_stream_buffer_bytes_available(const rtos_stream_buffer_t *sb)
+{
+    return (sb == NULL) ? 0U : ring_buffer_count(&sb->rb);
+}
+
+uint32_t rtos_stream_buffer_spaces_available(const rtos_stream_buffer_t *sb)
+{
+    return (sb == NULL) ? 0U : ring_buffer_free(&sb->rb);
+}
+
+rtos_status_t rtos_stream_buffer_reset(rtos_stream_buffer_t *sb)
+{
+    if (sb == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_port_enter_critical();
+
+    if (sb->reader != NULL || sb->writer != NULL)
+    {
+        rtos_port_exit_critical();
+        return RTOS_ERROR_INVALID_STATE;
+    }
+
+    sb->rb.head = 0;
+    sb->rb.tail = 0;
+
+    rtos_port_exit_critical();
+
+    return RTOS_SUCCESS;
+}
+
+/* =================== Message Buffer API =================== */
+
+rtos_status_t rtos_message_buffer_init(rtos_message_buffer_t *mb, uint8_t *storage, uint32_t size)
+{
+    if (mb == NULL || storage == NULL || !sb_size_valid(size, 4U))
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    /* Messages are published whole, so any buffered byte means a message */
+    return sb_init(&mb->stream, storage, size, 1U, 1U);
+}
+
+static bool mb_length_valid(const rtos_message_buffer_t *mb, uint32_t len)
+{
+    return len > 0U && len <= (sb_msg_len_t) -1 &&
+           len <= RTOS_MESSAGE_BUFFER_MAX_MESSAGE(sb_capacity(&mb->stream) + 1U);
+}
+
+rtos_status_t rtos_message_buffer_send(rtos_message_buffer_t *mb, const void *message, uint32_t len,
+                                       rtos_tick_t timeout_ticks)
+{
+    if (mb == NULL || message == NULL || !mb_length_valid(mb, len))
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    return sb_send(&mb->stream, message, len, NULL, timeout_ticks);
+}
+
+rtos_status_t rtos_message_buffer_receive(rtos_message_buffer_t *mb, void *buffer, uint32_t buffer_size,
+                                          uint32_t *length, rtos_tick_t timeout_ticks)
+{
+    if (length != NULL)
+    {
+        *length = 0;
+    }
+
+    if (mb == NULL || buffer == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    return sb_receive(&mb->stream, buffer, buffer_size, length, timeout_ticks);
+}
+
+rtos_status_t rtos_message_buffer_send_from_isr(rtos_message_buffer_t *mb, const void *message, uint32_t len,
+                                                bool *higher_priority_task_woken)
+{
+    if (mb == NULL || message == NULL || !mb_length_valid(mb, len))
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    return sb_send_from_isr(&mb->stream, message, len, NULL, higher_priority_task_woken);
+}
+
+rtos_status_t rtos_message_buffer_receive_from_isr(rtos_message_buffer_t *mb, void *buffer, uint32_t buffer_size,
+                                                   uint32_t *length, bool *higher_priority_task_woken)
+{
+    if (length != NULL)
+    {
+        *length = 0;
+    }
+
+    if (mb == NULL || buffer == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    return sb_receive_from_isr(&mb->stream, buffer, buffer_size, length, higher_priority_task_woken);
+}
+
+uint32_t rtos_message_buffer_next_length(const rtos_message_buffer_t *mb)
+{
+    return (mb == NULL) ? 0U : sb_next_message(&mb->stream);
+}
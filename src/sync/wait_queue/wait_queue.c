@@ -0,0 +1,203 @@
+#include "wait_queue.h"
+
+#include "task_priv.h"
+
+#include <stddef.h>
+
+#if RTOS_FOOTPRINT_COMPACT
+
+void rtos_wait_queue_init(rtos_wait_queue_t *wq)
+{
+    wq->head = NULL;
+}
+
+void rtos_wait_queue_insert(rtos_wait_queue_t *wq, rtos_tcb_t *task)
+{
+    rtos_priority_t priority = task->priority;
+    rtos_tcb_t     *head     = wq->head;
+
+    task->wait_queue    = wq;
+    task->wait_priority = priority;
+
+    if (head == NULL)
+    {
+        task->next_waiting = task;
+        task->prev_waiting = task;
+        wq->head           = task;
+        return;
+    }
+
+    /* Behind every waiter of higher or equal priority (FIFO within a level) */
+    rtos_tcb_t *before = head;
+    do
+    {
+        if (before->wait_priority < priority)
+        {
+            break;
+        }
+        before = before->next_waiting;
+    } while (before != head);
+
+    task->next_waiting                 = before;
+    task->prev_waiting                 = before->prev_waiting;
+    before->prev_waiting->next_waiting = task;
+    before->prev_waiting               = task;
+
+    if (before == head && head->wait_priority < priority)
+    {
+        wq->head = task;
+    }
+}
+
+void rtos_wait_queue_remove(rtos_wait_queue_t *wq, rtos_tcb_t *task)
+{
+    if (task == NULL || task->wait_queue != wq)
+    {
+        return;
+    }
+
+    if (task->next_waiting == task)
+    {
+        wq->head = NULL;
+    }
+    else
+    {
+        task->prev_waiting->next_waiting = task->next_waiting;
+        task->next_waiting->prev_waiting = task->prev_waiting;
+
+        if (wq->head == task)
+        {
+            wq->head = task->next_waiting;
+        }
+    }
+
+    task->next_waiting = NULL;
+    task->prev_waiting = NULL;
+    task->wait_queue   = NULL;
+}
+
+rtos_tcb_t *rtos_wait_queue_peek(const rtos_wait_queue_t *wq)
+{
+    return wq->head;
+}
+
+rtos_tcb_t *rtos_wait_queue_next(const rtos_wait_queue_t *wq, const rtos_tcb_t *task)
+{
+    return (task->next_waiting != wq->head) ? task->next_waiting : NULL;
+}
+
+#else /* !RTOS_FOOTPRINT_COMPACT */
+
+void rtos_wait_queue_init(rtos_wait_queue_t *wq)
+{
+    for (uint32_t i = 0; i < RTOS_MAX_TASK_PRIORITIES; i++)
+    {
+        wq->heads[i] = NULL;
+    }
+    rtos_prio_bitmap_init(&wq->priorities);
+}
+
+void rtos_wait_queue_insert(rtos_wait_queue_t *wq, rtos_tcb_t *task)
+{
+    rtos_priority_t priority = task->priority;
+    rtos_tcb_t     *head     = wq->heads[priority];
+
+    task->wait_queue    = wq;
+    task->wait_priority = priority;
+
+    if (head == NULL)
+    {
+        task->next_waiting  = task;
+        task->prev_waiting  = task;
+        wq->heads[priority] = task;
+        rtos_prio_bitmap_set(&wq->priorities, priority);
+        return;
+    }
+
+    /* Append at the tail, which sits just behind the head */
+    task->next_waiting               = head;
+    task->prev_waiting               = head->prev_waiting;
+    head->prev_waiting->next_waiting = task;
+    head->prev_waiting               = task;
+}
+
+void rtos_wait_queue_remove(rtos_wait_queue_t *wq, rtos_tcb_t *task)
+{
+    if (task == NULL || task->wait_queue != wq)
+    {
+        return;
+    }
+
+    rtos_priority_t priority = task->wait_priority;
+
+    if (task->next_waiting == task)
+    {
+        wq->heads[priority] = NULL;
+        rtos_prio_bitmap_clear(&wq->priorities, priority);
+    }
+    else
+    {
+        task->prev_waiting->next_waiting = task->next_waiting;
+        task->next_waiting->prev_waiting = task->prev_waiting;
+
+        if (wq->heads[priority] == task)
+        {
+            wq->heads[priority] = task->next_waiting;
+        }
+    }
+
+    task->next_waiting = NULL;
+    task->prev_waiting = NULL;
+    task->wait_queue   = NULL;
+}
+
+rtos_tcb_t *rtos_wait_queue_peek(const rtos_wait_queue_t *wq)
+{
+    if (rtos_prio_bitmap_is_empty(&wq->priorities))
+    {
+        return NULL;
+    }
+
+    return wq->heads[rtos_prio_bitmap_highest(&wq->priorities)];
+}
+
+rtos_tcb_t *rtos_wait_queue_next(const rtos_wait_queue_t *wq, const rtos_tcb_t *task)
+{
+    rtos_priority_t priority = task->wait_priority;
+
+    if (task->next_waiting != wq->heads[priority])
+    {
+        return task->next_waiting;
+    }
+
+    /* End of this bucket: continue with the next lower non-empty one */
+    uint32_t lower = rtos_prio_bitmap_highest_below(&wq->priorities, priority);
+    if (lower == RTOS_PRIO_BITMAP_NONE)
+    {
+        return NULL;
+    }
+
+    return wq->heads[lower];
+}
+
+#endif /* RTOS_FOOTPRINT_COMPACT */
+
+rtos_tcb_t *rtos_wait_queue_pop(rtos_wait_queue_t *wq)
+{
+    rtos_tcb_t *task = rtos_wait_queue_peek(wq);
+
+    rtos_wait_queue_remove(wq, task);
+
+    return task;
+}
+
+void rtos_wait_queue_requeue(rtos_wait_queue_t *wq, rtos_tcb_t *task)
+{
+    if (task->wait_queue != wq || task->wait_priority == task->priority)
+    {
+        return;
+    }
+
+    rtos_wait_queue_remove(wq, task);
+    rtos_wait_queue_insert(wq, task);
+}
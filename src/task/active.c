@@ -0,0 +1,443 @@
+#include "active.h"
+
+#include "VRTOS.h"
+#include "rtos_assert.h"
+#include "rtos_port.h"
+
+#include <stddef.h>
+
+/*
+ * Active-object event loop and HSM dispatch.
+ *
+ * A dynamic event's refs counts the queues holding it plus any sender
+ * reference from rtos_ao_event_ref(). Posts may come from ISRs, so refs
+ * changes under a critical section; static events are never counted.
+ *
+ * The group task serves its objects round robin, one event each per pass,
+ * and passes repeat while any queue had one. The queue set is only used to
+ * sleep: selecting first would always return the earliest-added non-empty
+ * queue and starve the rest.
+ *
+ * Dispatch walks the hierarchy by sending RTOS_AO_SIG_EMPTY, to which every
+ * state answers with RTOS_AO_SUPER(parent); rtos_ao_top leaves temp NULL.
+ * This clobbers me->temp, so the walks keep targets in locals.
+ */
+
+static rtos_mempool_t *g_ao_pools[RTOS_AO_MAX_EVENT_POOLS];
+static uint8_t         g_ao_pool_count;
+
+static const rtos_ao_event_t g_ao_reserved[RTOS_AO_SIG_USER] = {
+    RTOS_AO_STATIC_EVENT(RTOS_AO_SIG_EMPTY),
+    RTOS_AO_STATIC_EVENT(RTOS_AO_SIG_ENTRY),
+    RTOS_AO_STATIC_EVENT(RTOS_AO_SIG_EXIT),
+    RTOS_AO_STATIC_EVENT(RTOS_AO_SIG_INIT),
+};
+
+/* ======================== Events ========================================= */
+
+static rtos_mempool_t *ao_pool_for(size_t size, uint8_t *pool_id)
+{
+    for (uint8_t i = 0U; i < g_ao_pool_count; i++)
+    {
+        if (size <= g_ao_pools[i]->block_size)
+        {
+            *pool_id = (uint8_t) (i + 1U);
+            return g_ao_pools[i];
+        }
+    }
+    return NULL;
+}
+
+static rtos_ao_event_t *ao_event_init(void *block, uint8_t pool_id, rtos_ao_signal_t sig)
+{
+    rtos_ao_event_t *e = (rtos_ao_event_t *) block;
+
+    if (e != NULL)
+    {
+        e->sig  = sig;
+        e->pool = pool_id;
+        e->refs = 0U;
+    }
+    return e;
+}
+
+rtos_status_t rtos_ao_pool_add(rtos_mempool_t *pool)
+{
+    if (pool == NULL || pool->block_size < sizeof(rtos_ao_event_t))
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_status_t status = RTOS_SUCCESS;
+
+    rtos_port_enter_critical();
+    if (g_ao_pool_count >= RTOS_AO_MAX_EVENT_POOLS)
+    {
+        status = RTOS_ERROR_FULL;
+    }
+    else if (g_ao_pool_count > 0U && pool->block_size < g_ao_pools[g_ao_pool_count - 1U]->block_size)
+    {
+        status = RTOS_ERROR_INVALID_PARAM;
+    }
+    else
+    {
+        g_ao_pools[g_ao_pool_count] = pool;
+        g_ao_pool_count++;
+    }
+    rtos_port_exit_critical();
+
+    return status;
+}
+
+rtos_ao_event_t *rtos_ao_event_new(size_t size, rtos_ao_signal_t sig)
+{
+    uint8_t         pool_id;
+    rtos_mempool_t *pool = ao_pool_for(size, &pool_id);
+
+    if (pool == NULL || size < sizeof(rtos_ao_event_t))
+    {
+        return NULL;
+    }
+    return ao_event_init(rtos_mempool_alloc(pool, 0U), pool_id, sig);
+}
+
+rtos_ao_event_t *rtos_ao_event_new_from_isr(size_t size, rtos_ao_signal_t sig)
+{
+    uint8_t         pool_id;
+    rtos_mempool_t *pool = ao_pool_for(size, &pool_id);
+
+    if (pool == NULL || size < sizeof(rtos_ao_event_t))
+    {
+        return NULL;
+    }
+    return ao_event_init(rtos_mempool_alloc_from_isr(pool), pool_id, sig);
+}
+
+void rtos_ao_event_ref(const rtos_ao_event_t *e)
+{
+    if (e == NULL || e->pool == 0U)
+    {
+        return;
+    }
+
+    rtos_ao_event_t *ev = (rtos_ao_event_t *) e;
+
+    rtos_port_enter_critical();
+    RTOS_ASSERT(ev->refs < UINT8_MAX);
+    ev->refs++;
+    rtos_port_exit_critical();
+}
+
+void rtos_ao_event_gc(const rtos_ao_event_t *e)
+{
+    if (e == NULL || e->pool == 0U)
+    {
+        return;
+    }
+
+    rtos_ao_event_t *ev   = (rtos_ao_event_t *) e;
+    bool             last = false;
+
+    rtos_port_enter_critical();
+    if (ev->refs > 0U)
+    {
+        ev->refs--;
+    }
+    last = (ev->refs == 0U);
+    rtos_port_exit_critical();
+
+    if (last)
+    {
+        (void) rtos_mempool_free(g_ao_pools[ev->pool - 1U], ev);
+    }
+}
+
+/* ======================== Hierarchical State Machine ===================== */
+
+rtos_ao_ret_t rtos_ao_top(rtos_ao_t *me, const rtos_ao_event_t *e)
+{
+    (void) me;
+    (void) e;
+    return RTOS_AO_RET_IGNORED;
+}
+
+static rtos_ao_ret_t ao_trig(rtos_ao_t *me, rtos_ao_state_t state, rtos_ao_signal_t sig)
+{
+    return state(me, &g_ao_reserved[sig]);
+}
+
+static rtos_ao_state_t ao_super(rtos_ao_t *me, rtos_ao_state_t state)
+{
+    me->temp = NULL;
+    (void) ao_trig(me, state, RTOS_AO_SIG_EMPTY);
+    return me->temp;
+}
+
+/* True if `ancestor` is `state` or one of its parents */
+static bool ao_contains(rtos_ao_t *me, rtos_ao_state_t ancestor, rtos_ao_state_t state)
+{
+    for (rtos_ao_state_t s = state; s != NULL; s = ao_super(me, s))
+    {
+        if (s == ancestor)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Enter every state below `ancestor` down to and including `target`, outermost first */
+static void ao_enter_from(rtos_ao_t *me, rtos_ao_state_t ancestor, rtos_ao_state_t target)
+{
+    rtos_ao_state_t path[RTOS_AO_MAX_NEST_DEPTH];
+    uint32_t        depth = 0U;
+
+    for (rtos_ao_state_t s = target; s != ancestor; s = ao_super(me, s))
+    {
+        RTOS_ASSERT(s != NULL && depth < RTOS_AO_MAX_NEST_DEPTH);
+        path[depth] = s;
+        depth++;
+    }
+
+    while (depth > 0U)
+    {
+        depth--;
+        (void) ao_trig(me, path[depth], RTOS_AO_SIG_ENTRY);
+    }
+}
+
+/* Follow initial transitions down from `state`; returns the new leaf */
+static rtos_ao_state_t ao_drill(rtos_ao_t *me, rtos_ao_state_t state)
+{
+    while (ao_trig(me, state, RTOS_AO_SIG_INIT) == RTOS_AO_RET_TRAN)
+    {
+        rtos_ao_state_t target = me->temp;
+
+        ao_enter_from(me, state, target);
+        state = target;
+    }
+    return state;
+}
+
+/* Exit from the leaf up to (excluding) `source`, transition to `target`, drill down */
+static void ao_transition(rtos_ao_t *me, rtos_ao_state_t source, rtos_ao_state_t target)
+{
+    rtos_ao_state_t s = me->state;
+
+    while (s != source)
+    {
+        (void) ao_trig(me, s, RTOS_AO_SIG_EXIT);
+        s = ao_super(me, s);
+    }
+
+    if (source == target)
+    {
+        (void) ao_trig(me, source, RTOS_AO_SIG_EXIT);
+        (void) ao_trig(me, source, RTOS_AO_SIG_ENTRY);
+    }
+    else
+    {
+        /* Exit up to the innermost state that contains the target */
+        while (!ao_contains(me, s, target))
+        {
+            (void) ao_trig(me, s, RTOS_AO_SIG_EXIT);
+            s = ao_super(me, s);
+        }
+        ao_enter_from(me, s, target);
+    }
+
+    me->state = ao_drill(me, target);
+}
+
+static void ao_dispatch(rtos_ao_t *me, const rtos_ao_event_t *e)
+{
+    rtos_ao_state_t s = me->state;
+    rtos_ao_ret_t   r = s(me, e);
+
+    while (r == RTOS_AO_RET_SUPER)
+    {
+        s = me->temp;
+        r = s(me, e);
+    }
+
+    if (r == RTOS_AO_RET_TRAN)
+    {
+        ao_transition(me, s, me->temp);
+    }
+}
+
+bool rtos_ao_is_in(rtos_ao_t *me, rtos_ao_state_t state)
+{
+    if (me == NULL || state == NULL)
+    {
+        return false;
+    }
+    return ao_contains(me, state, me->state);
+}
+
+/* ======================== Objects and Groups ============================= */
+
+rtos_status_t rtos_ao_group_init(rtos_ao_group_t *group)
+{
+    if (group == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    group->head = NULL;
+
+    return rtos_queue_set_init(&group->set);
+}
+
+rtos_status_t rtos_ao_start(rtos_ao_group_t *group, rtos_ao_t *me, rtos_ao_state_t initial,
+                            const rtos_ao_event_t **storage, uint32_t queue_length)
+{
+    if (group == NULL || me == NULL || initial == NULL || storage == NULL || queue_length == 0U)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_status_t status = rtos_queue_create_static(&me->queue, &me->queue_cb, (void *) storage, queue_length,
+                                                    sizeof(const rtos_ao_event_t *));
+    if (status != RTOS_SUCCESS)
+    {
+        return status;
+    }
+
+    status = rtos_queue_set_add_queue(&group->set, me->queue);
+    if (status != RTOS_SUCCESS)
+    {
+        return status;
+    }
+
+    me->group = group;
+    me->next  = NULL;
+    me->state = rtos_ao_top;
+    ao_enter_from(me, rtos_ao_top, initial);
+    me->state = ao_drill(me, initial);
+
+    rtos_port_enter_critical();
+    rtos_ao_t **link = &group->head;
+    while (*link != NULL)
+    {
+        link = &(*link)->next;
+    }
+    *link = me;
+    rtos_port_exit_critical();
+
+    return RTOS_SUCCESS;
+}
+
+rtos_status_t rtos_ao_post(rtos_ao_t *me, const rtos_ao_event_t *e, rtos_tick_t timeout_ticks)
+{
+    if (me == NULL || e == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_ao_event_t *ev = (rtos_ao_event_t *) e;
+
+    if (e->pool != 0U)
+    {
+        bool saturated;
+
+        rtos_port_enter_critical();
+        saturated = (ev->refs == UINT8_MAX);
+        if (!saturated)
+        {
+            ev->refs++;
+        }
+        rtos_port_exit_critical();
+
+        if (saturated)
+        {
+            return RTOS_ERROR_FULL;
+        }
+    }
+
+    rtos_status_t status = rtos_queue_send(me->queue, &e, timeout_ticks);
+    if (status != RTOS_SUCCESS)
+    {
+        rtos_ao_event_gc(e);
+    }
+    return status;
+}
+
+rtos_status_t rtos_ao_post_from_isr(rtos_ao_t *me, const rtos_ao_event_t *e, bool *higher_priority_task_woken)
+{
+    if (me == NULL || e == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_ao_event_t *ev   = (rtos_ao_event_t *) e;
+    bool             last = false;
+
+    if (e->pool != 0U)
+    {
+        bool     saturated;
+        uint32_t saved = rtos_port_enter_critical_from_isr();
+        saturated      = (ev->refs == UINT8_MAX);
+        if (!saturated)
+        {
+            ev->refs++;
+        }
+        rtos_port_exit_critical_from_isr(saved);
+
+        if (saturated)
+        {
+            return RTOS_ERROR_FULL;
+        }
+    }
+
+    rtos_status_t status = rtos_queue_send_from_isr(me->queue, &e, higher_priority_task_woken);
+    if (status != RTOS_SUCCESS && e->pool != 0U)
+    {
+        uint32_t saved = rtos_port_enter_critical_from_isr();
+        ev->refs--;
+        last = (ev->refs == 0U);
+        rtos_port_exit_critical_from_isr(saved);
+
+        if (last)
+        {
+            (void) rtos_mempool_free_from_isr(g_ao_pools[ev->pool - 1U], ev);
+        }
+    }
+    return status;
+}
+
+/* Dispatch one event of each object with one queued, in start order */
+static bool ao_group_pass(rtos_ao_group_t *group)
+{
+    bool progress = false;
+
+    for (rtos_ao_t *me = group->head; me != NULL; me = me->next)
+    {
+        const rtos_ao_event_t *e;
+
+        if (rtos_queue_receive(me->queue, &e, 0U) == RTOS_SUCCESS)
+        {
+            ao_dispatch(me, e);
+            rtos_ao_event_gc(e);
+            progress = true;
+        }
+    }
+
+    return progress;
+}
+
+__attribute__((__noreturn__)) void rtos_ao_group_task(void *param)
+{
+    rtos_ao_group_t *group = (rtos_ao_group_t *) param;
+
+    while (1)
+    {
+        if (ao_group_pass(group))
+        {
+            continue;
+        }
+
+        rtos_queue_set_member_t member;
+        (void) rtos_queue_set_select(&group->set, &member, RTOS_MAX_DELAY);
+    }
+}
@@ -0,0 +1,239 @@
+#include "coroutine.h"
+
+#include "VRTOS.h"
+#include "rtos_port.h"
+#include "task.h"
+
+#include <stddef.h>
+
+/*
+ * Coroutine run loop.
+ *
+ * A pass calls every linked coroutine once. A coroutine that yields, ends,
+ * or gets past a wait counts as progress, and progress earns another pass
+ * straight away, so a hand-off between two coroutines of the same loop
+ * needs no wakeup. After a pass without progress the task blocks in
+ * rtos_queue_set_select() on the watched members and its own notification,
+ * for at most the time to the earliest RTOS_CO_DELAY deadline.
+ *
+ * The set is level-triggered: a watched queue that holds an item no
+ * coroutine is waiting for would wake the loop again at once. When a wake
+ * by a member leads to a pass without progress, the next sleep is therefore
+ * a one-tick delay instead, so such a member is polled once per tick rather
+ * than spun on.
+ *
+ * The list is pushed at the head under a critical section by
+ * rtos_coroutine_start() from any task; only the loop unlinks.
+ */
+
+static void coroutine_unlink(rtos_coroutine_sched_t *sched, rtos_coroutine_t *co)
+{
+    rtos_port_enter_critical();
+
+    rtos_coroutine_t **link = &sched->head;
+    while (*link != NULL && *link != co)
+    {
+        link = &(*link)->next;
+    }
+    if (*link == co)
+    {
+        *link = co->next;
+    }
+    co->next = NULL;
+    co->flags &= (uint8_t) ~RTOS_COROUTINE_FLAG_LINKED;
+
+    rtos_port_exit_critical();
+}
+
+/* Run every coroutine once; *timeout gets the ticks to the earliest delay */
+static bool coroutine_run_pass(rtos_coroutine_sched_t *sched, rtos_tick_t *timeout)
+{
+    rtos_coroutine_t *co       = sched->head;
+    bool              progress = false;
+
+    *timeout = RTOS_MAX_DELAY;
+
+    while (co != NULL)
+    {
+        /* Read first: unlinking an ended coroutine clears its link */
+        rtos_coroutine_t *next = co->next;
+
+        co->flags &= (uint8_t) ~(RTOS_COROUTINE_FLAG_PROGRESS | RTOS_COROUTINE_FLAG_DELAYED);
+
+        rtos_coroutine_result_t result = co->function(co);
+
+        if (result == RTOS_COROUTINE_ENDED)
+        {
+            coroutine_unlink(sched, co);
+            progress = true;
+        }
+        else if (result == RTOS_COROUTINE_YIELDED || (co->flags & RTOS_COROUTINE_FLAG_PROGRESS) != 0U)
+        {
+            progress = true;
+        }
+        else if ((co->flags & RTOS_COROUTINE_FLAG_DELAYED) != 0U)
+        {
+            int32_t remaining = (int32_t) (co->wake_tick - rtos_get_tick_count());
+            if (remaining < 0)
+            {
+                remaining = 0;
+            }
+            if ((rtos_tick_t) remaining < *timeout)
+            {
+                *timeout = (rtos_tick_t) remaining;
+            }
+        }
+
+        co = next;
+    }
+
+    return progress;
+}
+
+rtos_status_t rtos_coroutine_sched_init(rtos_coroutine_sched_t *sched)
+{
+    if (sched == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    sched->head = NULL;
+    sched->task = NULL;
+
+    rtos_status_t status = rtos_queue_set_init(&sched->set);
+    if (status != RTOS_SUCCESS)
+    {
+        return status;
+    }
+
+    return rtos_queue_set_add_notification(&sched->set);
+}
+
+rtos_status_t rtos_coroutine_sched_watch_queue(rtos_coroutine_sched_t *sched, rtos_queue_handle_t queue)
+{
+    if (sched == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    return rtos_queue_set_add_queue(&sched->set, queue);
+}
+
+rtos_status_t rtos_coroutine_sched_watch_semaphore(rtos_coroutine_sched_t *sched, rtos_semaphore_t *sem)
+{
+    if (sched == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    return rtos_queue_set_add_semaphore(&sched->set, sem);
+}
+
+__attribute__((__noreturn__)) void rtos_coroutine_sched_task(void *param)
+{
+    rtos_coroutine_sched_t *sched   = (rtos_coroutine_sched_t *) param;
+    bool                    stalled = false;
+
+    sched->task = rtos_task_get_current();
+
+    while (1)
+    {
+        rtos_tick_t timeout;
+
+        if (coroutine_run_pass(sched, &timeout))
+        {
+            stalled = false;
+            continue;
+        }
+
+        if (stalled)
+        {
+            /* A member is ready that no coroutine takes: poll it per tick */
+            stalled = false;
+            rtos_delay_ticks(1U);
+            continue;
+        }
+
+        rtos_queue_set_member_t member;
+        if (rtos_queue_set_select(&sched->set, &member, timeout) == RTOS_SUCCESS)
+        {
+            if (member == RTOS_QUEUE_SET_NOTIFICATION)
+            {
+                rtos_task_notify_take(true, RTOS_NOTIFY_NO_WAIT);
+            }
+            else
+            {
+                stalled = true;
+            }
+        }
+    }
+}
+
+void rtos_coroutine_sched_wake(rtos_coroutine_sched_t *sched)
+{
+    if (sched != NULL && sched->task != NULL)
+    {
+        rtos_task_notify_give(sched->task);
+    }
+}
+
+void rtos_coroutine_sched_wake_from_isr(rtos_coroutine_sched_t *sched, bool *higher_priority_task_woken)
+{
+    bool woken = false;
+
+    if (sched != NULL && sched->task != NULL)
+    {
+        rtos_task_notify_give_from_isr(sched->task, &woken);
+    }
+
+    if (woken && higher_priority_task_woken != NULL)
+    {
+        *higher_priority_task_woken = true;
+    }
+}
+
+rtos_status_t rtos_coroutine_start(rtos_coroutine_sched_t *sched, rtos_coroutine_t *co, rtos_coroutine_fn_t function,
+                                   void *parameter)
+{
+    if (sched == NULL || co == NULL || function == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_port_enter_critical();
+
+    if ((co->flags & RTOS_COROUTINE_FLAG_LINKED) != 0U)
+    {
+        rtos_port_exit_critical();
+        return RTOS_ERROR_INVALID_STATE;
+    }
+
+    co->function  = function;
+    co->parameter = parameter;
+    co->wake_tick = 0;
+    co->resume    = 0U;
+    co->flags     = RTOS_COROUTINE_FLAG_LINKED;
+    co->next      = sched->head;
+    sched->head   = co;
+
+    rtos_port_exit_critical();
+
+    rtos_coroutine_sched_wake(sched);
+    return RTOS_SUCCESS;
+}
+
+bool rtos_coroutine_is_done(const rtos_coroutine_t *co)
+{
+    return co == NULL || (co->flags & RTOS_COROUTINE_FLAG_LINKED) == 0U;
+}
+
+bool rtos_coroutine_delay_expired(rtos_coroutine_t *co)
+{
+    if ((int32_t) (rtos_get_tick_count() - co->wake_tick) >= 0)
+    {
+        return true;
+    }
+
+    co->flags |= RTOS_COROUTINE_FLAG_DELAYED;
+    return false;
+}
@@ -6,6 +6,7 @@
 #include "memory.h"
 #include "mutex.h"
 #include "port_common.h"
+#include "rtos_mem.h"
 #include "rtos_port.h"
 #include "scheduler.h"
 #include "task_priv.h"
@@ -14,19 +15,83 @@
 #include <stdint.h>
 #include <string.h>
 
-rtos_tcb_t g_task_pool[RTOS_MAX_TASKS] = {0};
-uint8_t    g_task_count                = 0;
+#include "device.h" // IWYU pragma: keep
+
+rtos_tcb_t      g_task_pool[RTOS_MAX_TASKS] RTOS_TCB_POOL_REGION;
+rtos_tcb_cold_t g_task_cold_pool[RTOS_MAX_TASKS];
+uint8_t         g_task_count = 0;
+
+/* End marker for the slot-index lists below */
+#define TASK_SLOT_NONE (0xFFU)
+RTOS_STATIC_ASSERT(RTOS_MAX_TASKS < TASK_SLOT_NONE, "task slot lists use 8-bit indexes");
+RTOS_STATIC_ASSERT((RTOS_TASK_NAME_HASH_BUCKETS & (RTOS_TASK_NAME_HASH_BUCKETS - 1U)) == 0U,
+                   "RTOS_TASK_NAME_HASH_BUCKETS must be a power of 2");
+
+/*
+ * Slot lists, all linked by pool index through the cold TCB part, so task
+ * create, delete and name lookup never scan the pool:
+ * - free:    unused slots, popped by create (lowest ids first after init)
+ * - reclaim: self-deleted tasks whose stack the idle task has yet to free
+ * - names:   named live tasks, one chain per hash bucket
+ */
+static uint8_t          g_task_free_head    = TASK_SLOT_NONE;
+static volatile uint8_t g_task_reclaim_head = TASK_SLOT_NONE;
+static uint8_t          g_task_name_buckets[RTOS_TASK_NAME_HASH_BUCKETS];
+
+#if RTOS_ENABLE_STACK_WATERMARK
+/* Idle-task stack scan position: task slot, and word offset from its scan base */
+static uint8_t  g_stack_scan_slot = 0;
+static uint32_t g_stack_scan_word = 0;
+#endif
+
+#if RTOS_PROFILING_SYSTEM_ENABLED
+/* Runtime window: each slot's run_cycles at the start of the older and the
+ * newer period. Stats report [older, now]; once the newer period is a full
+ * window old it becomes the older one. */
+static uint64_t    g_runtime_base_old[RTOS_MAX_TASKS];
+static uint64_t    g_runtime_base_new[RTOS_MAX_TASKS];
+static rtos_tick_t g_runtime_mark_new = 0;
+
+#define RTOS_RUNTIME_WINDOW_TICKS                                                                                      \
+    ((RTOS_RUNTIME_WINDOW_MS / RTOS_TICK_PERIOD_MS) > 0 ? (RTOS_RUNTIME_WINDOW_MS / RTOS_TICK_PERIOD_MS) : 1)
+#endif
 
 /* Static function prototypes */
-static rtos_tcb_t *rtos_task_allocate_tcb(void);
-static uint32_t   *rtos_task_allocate_stack(rtos_stack_size_t size);
+static rtos_tcb_t   *rtos_task_allocate_tcb(void);
+static void          rtos_task_free_tcb(rtos_tcb_t *task);
+static uint32_t     *rtos_task_allocate_stack(rtos_stack_size_t size);
+static void          rtos_task_release(rtos_tcb_t *task);
+static void          rtos_task_reclaim_deleted(void);
+static uint32_t      rtos_task_name_hash(const char *name);
+static void          rtos_task_name_insert(rtos_tcb_t *task);
+static void          rtos_task_name_remove(rtos_tcb_t *task);
+#if RTOS_ENABLE_STACK_WATERMARK
+static uint32_t     *rtos_task_stack_scan_base(const rtos_tcb_t *task);
+static void          rtos_task_stack_paint(rtos_tcb_t *task);
+static void          rtos_task_stack_scan_step(void);
+#endif
+static rtos_status_t rtos_task_create_internal(rtos_task_function_t task_function, const char *name,
+                                               rtos_stack_size_t stack_size, void *parameter, rtos_priority_t priority,
+                                               uint8_t flags, rtos_period_t period, rtos_deadline_t relative_deadline,
+                                               rtos_tick_t wcet, uint32_t *stack_buffer,
+                                               rtos_task_handle_t *task_handle);
 
 /**
  * @brief Initialize the task management system
  */
 rtos_status_t rtos_task_init_system(void)
 {
-    memset(g_task_pool, 0, sizeof(g_task_pool));
+    /* The cold pool is .bss, zeroed at reset; the hot pool may sit in an
+     * uncleared region (RTOS_TCB_POOL_REGION) */
+    rtos_mem_zero(g_task_pool, sizeof(g_task_pool));
+    for (uint8_t i = 0; i < RTOS_MAX_TASKS; i++)
+    {
+        g_task_pool[i].cold           = &g_task_cold_pool[i];
+        g_task_cold_pool[i].next_free = (i + 1U < RTOS_MAX_TASKS) ? (uint8_t) (i + 1U) : TASK_SLOT_NONE;
+    }
+    g_task_free_head    = 0;
+    g_task_reclaim_head = TASK_SLOT_NONE;
+    memset(g_task_name_buckets, TASK_SLOT_NONE, sizeof(g_task_name_buckets));
     g_task_count = 0;
     KLOGD(KEVT_TASK_CREATE, RTOS_MAX_TASKS, RTOS_TOTAL_HEAP_SIZE);
 
@@ -38,6 +103,198 @@ rtos_status_t rtos_task_init_system(void)
  */
 rtos_status_t rtos_task_create(rtos_task_function_t task_function, const char *name, rtos_stack_size_t stack_size,
                                void *parameter, rtos_priority_t priority, rtos_task_handle_t *task_handle)
+{
+    return rtos_task_create_ex(task_function, name, stack_size, parameter, priority, RTOS_TASK_FLAG_NONE,
+                               task_handle);
+}
+
+/**
+ * @brief Create a new task with creation flags
+ */
+rtos_status_t rtos_task_create_ex(rtos_task_function_t task_function, const char *name, rtos_stack_size_t stack_size,
+                                  void *parameter, rtos_priority_t priority, uint8_t flags,
+                                  rtos_task_handle_t *task_handle)
+{
+    return rtos_task_create_internal(task_function, name, stack_size, parameter, priority, flags, 0, 0, 0, NULL,
+                                     task_handle);
+}
+
+/**
+ * @brief Create a task on a caller-provided stack
+ */
+rtos_status_t rtos_task_create_static(rtos_task_function_t task_function, const char *name, uint32_t *stack_buffer,
+                                      rtos_stack_size_t stack_size, void *parameter, rtos_priority_t priority,
+                                      uint8_t flags, rtos_task_handle_t *task_handle)
+{
+    /* The stack top must keep the AAPCS 8-byte alignment */
+    if (stack_buffer == NULL || ((uintptr_t) stack_buffer & 7U) != 0U || stack_size < RTOS_MINIMUM_TASK_STACK_SIZE)
+    {
+        KLOGE(KEVT_INVALID_PARAM, (uint32_t) stack_buffer, stack_size);
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    return rtos_task_create_internal(task_function, name, stack_size, parameter, priority, flags, 0, 0, 0,
+                                     stack_buffer, task_handle);
+}
+
+/**
+ * @brief Create a periodic task
+ */
+rtos_status_t rtos_task_create_periodic(rtos_task_function_t task_function, const char *name,
+                                        rtos_stack_size_t stack_size, void *parameter, rtos_priority_t priority,
+                                        rtos_period_t period, rtos_deadline_t relative_deadline, rtos_tick_t wcet,
+                                        rtos_task_handle_t *task_handle)
+{
+#if !RTOS_USE_PERIODIC_TASKS
+    (void) task_function;
+    (void) name;
+    (void) stack_size;
+    (void) parameter;
+    (void) priority;
+    (void) period;
+    (void) relative_deadline;
+    (void) wcet;
+    (void) task_handle;
+    return RTOS_ERROR_INVALID_STATE;
+#else
+    if (relative_deadline == 0)
+    {
+        relative_deadline = period; /* Implicit deadline */
+    }
+
+    if (period == 0 || relative_deadline > period)
+    {
+        KLOGE(KEVT_INVALID_PARAM, period, relative_deadline);
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    if (wcet > relative_deadline)
+    {
+        KLOGE(KEVT_INVALID_PARAM, wcet, relative_deadline);
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+#if RTOS_ADMISSION_CONTROL
+    /* Reads g_task_pool outside the critical section: the analysis is too
+     * long to run with interrupts masked */
+    if (wcet > 0 && rtos_task_admission_check(priority, period, relative_deadline, wcet) != RTOS_SUCCESS)
+    {
+#if RTOS_ADMISSION_CONTROL == RTOS_ADMISSION_REJECT
+        KLOGE(KEVT_TASK_ADMISSION_FAIL, period, wcet);
+        return RTOS_ERROR_NOT_SCHEDULABLE;
+#else
+        KLOGW(KEVT_TASK_ADMISSION_FAIL, period, wcet);
+#endif
+    }
+#endif
+
+    return rtos_task_create_internal(task_function, name, stack_size, parameter, priority, RTOS_TASK_FLAG_NONE, period,
+                                     relative_deadline, wcet, NULL, task_handle);
+#endif
+}
+
+/**
+ * @brief Set a task's round-robin quantum
+ */
+rtos_status_t rtos_task_set_time_slice(rtos_task_handle_t task_handle, rtos_tick_t ticks)
+{
+    if (task_handle == NULL)
+    {
+        KLOGE(KEVT_INVALID_PARAM, 0, ticks);
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    if (ticks == 0)
+    {
+        ticks = RTOS_TIME_SLICE_TICKS;
+    }
+
+#if RTOS_FOOTPRINT_COMPACT
+    if (ticks > UINT16_MAX)
+    {
+        KLOGE(KEVT_INVALID_PARAM, 0, ticks);
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+#endif
+
+    rtos_port_enter_critical();
+
+    task_handle->cold->time_slice = (rtos_quantum_t) ticks;
+
+    /* The running task finishes its current turn unless that is now too long */
+    if (task_handle != rtos_kernel_this_core()->current_task || task_handle->time_slice_remaining > ticks)
+    {
+        task_handle->time_slice_remaining = (rtos_quantum_t) ticks;
+    }
+
+    rtos_port_exit_critical();
+
+    return RTOS_SUCCESS;
+}
+
+/**
+ * @brief Set a task's preemption threshold
+ */
+rtos_status_t rtos_task_set_preemption_threshold(rtos_task_handle_t task_handle, rtos_priority_t threshold)
+{
+#if RTOS_USE_PREEMPTION_THRESHOLD
+    if (task_handle == NULL || !RTOS_PRIORITY_IN_RANGE(threshold) || threshold < task_handle->base_priority)
+    {
+        KLOGE(KEVT_INVALID_PARAM, 0, threshold);
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_port_enter_critical();
+
+    task_handle->preempt_threshold = threshold;
+
+    /* Lowering the running task's threshold may release a task it held off */
+    bool preempt = (g_kernel.state == RTOS_KERNEL_STATE_RUNNING) &&
+                   rtos_scheduler_should_preempt(rtos_scheduler_get_next_task());
+
+    rtos_port_exit_critical();
+
+    if (preempt)
+    {
+        rtos_yield();
+    }
+
+    return RTOS_SUCCESS;
+#else
+    (void) task_handle;
+    (void) threshold;
+    return RTOS_ERROR_INVALID_STATE;
+#endif
+}
+
+/**
+ * @brief Get a task's preemption threshold
+ */
+rtos_priority_t rtos_task_get_preemption_threshold(rtos_task_handle_t task_handle)
+{
+    if (task_handle == NULL)
+    {
+        return 0;
+    }
+
+#if RTOS_USE_PREEMPTION_THRESHOLD
+    return task_handle->preempt_threshold;
+#else
+    return task_handle->base_priority;
+#endif
+}
+
+/**
+ * @brief Create a task: shared body of the public create functions
+ *
+ * stack_buffer NULL allocates stack_size bytes from the heap; otherwise the
+ * caller's buffer is used (stack_size rounded down to 8) and never freed.
+ */
+static rtos_status_t rtos_task_create_internal(rtos_task_function_t task_function, const char *name,
+                                               rtos_stack_size_t stack_size, void *parameter, rtos_priority_t priority,
+                                               uint8_t flags, rtos_period_t period, rtos_deadline_t relative_deadline,
+                                               rtos_tick_t wcet, uint32_t *stack_buffer,
+                                               rtos_task_handle_t *task_handle)
 {
     if (task_function == NULL || task_handle == NULL)
     {
@@ -45,7 +302,13 @@ rtos_status_t rtos_task_create(rtos_task_function_t task_function, const char *n
         return RTOS_ERROR_INVALID_PARAM;
     }
 
-    if (priority >= RTOS_MAX_TASK_PRIORITIES)
+    if ((flags & ~(RTOS_TASK_FLAG_NO_FPU | RTOS_TASK_FLAG_CORES_VALID)) != 0U)
+    {
+        KLOGE(KEVT_INVALID_PARAM, flags, RTOS_TASK_FLAG_NO_FPU | RTOS_TASK_FLAG_CORES_VALID);
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    if (!RTOS_PRIORITY_IN_RANGE(priority))
     {
         KLOGE(KEVT_INVALID_PARAM, priority, RTOS_MAX_TASK_PRIORITIES - 1);
         return RTOS_ERROR_INVALID_PARAM;
@@ -57,17 +320,26 @@ rtos_status_t rtos_task_create(rtos_task_function_t task_function, const char *n
         return RTOS_ERROR_NO_MEMORY;
     }
 
-    if (stack_size == 0)
+    if (stack_buffer != NULL)
     {
-        stack_size = RTOS_DEFAULT_TASK_STACK_SIZE;
+        /* A caller buffer cannot grow: use the largest aligned size inside it */
+        ALIGN8_DOWN(stack_size);
+        flags |= RTOS_TASK_FLAG_STATIC_STACK;
     }
-
-    if (stack_size < RTOS_MINIMUM_TASK_STACK_SIZE)
+    else
     {
-        stack_size = RTOS_MINIMUM_TASK_STACK_SIZE;
-    }
+        if (stack_size == 0)
+        {
+            stack_size = RTOS_DEFAULT_TASK_STACK_SIZE;
+        }
 
-    ALIGN8_UP(stack_size);
+        if (stack_size < RTOS_MINIMUM_TASK_STACK_SIZE)
+        {
+            stack_size = RTOS_MINIMUM_TASK_STACK_SIZE;
+        }
+
+        ALIGN8_UP(stack_size);
+    }
 
     rtos_port_enter_critical();
 
@@ -79,10 +351,10 @@ rtos_status_t rtos_task_create(rtos_task_function_t task_function, const char *n
         return RTOS_ERROR_NO_MEMORY;
     }
 
-    uint32_t *stack_memory = rtos_task_allocate_stack(stack_size);
+    uint32_t *stack_memory = (stack_buffer != NULL) ? stack_buffer : rtos_task_allocate_stack(stack_size);
     if (stack_memory == NULL)
     {
-        new_task->task_function = NULL;
+        rtos_task_free_tcb(new_task);
         rtos_port_exit_critical();
         KLOGE(KEVT_STACK_ALLOC_FAIL, stack_size, 0);
         return RTOS_ERROR_NO_MEMORY;
@@ -93,60 +365,115 @@ rtos_status_t rtos_task_create(rtos_task_function_t task_function, const char *n
     *stack_memory = PORT_STACK_CANARY_VALUE;
 #endif
 
+    rtos_tcb_cold_t *cold = new_task->cold;
+
     new_task->task_id              = (uint8_t)(new_task - g_task_pool);
-    new_task->name                 = name;
-    new_task->task_function        = task_function;
-    new_task->parameter            = parameter;
     new_task->state                = RTOS_TASK_STATE_READY;
     new_task->priority             = priority;
     new_task->base_priority        = priority; /* Store original priority for inheritance */
+#if RTOS_USE_PREEMPTION_THRESHOLD
+    new_task->preempt_threshold = priority; /* = priority: no threshold */
+#endif
+    new_task->flags                = (uint8_t) (flags | ((period != 0) ? RTOS_TASK_FLAG_PERIODIC : 0U));
     new_task->stack_base           = stack_memory;
-    new_task->stack_size           = stack_size;
-    new_task->stack_top            = stack_memory;
     new_task->delay_until          = 0;
     new_task->time_slice_remaining = RTOS_TIME_SLICE_TICKS;
 
-    new_task->next             = NULL;
-    new_task->prev             = NULL;
-    new_task->next_waiting     = NULL;
-    new_task->blocked_on       = NULL;
-    new_task->blocked_on_type  = RTOS_SYNC_TYPE_NONE;
-    new_task->held_mutex_list  = NULL;
+    new_task->next            = NULL;
+    new_task->prev            = NULL;
+    new_task->next_waiting    = NULL;
+    new_task->prev_waiting    = NULL;
+    new_task->wait_queue      = NULL;
+    new_task->blocked_on      = NULL;
+    new_task->blocked_on_type = RTOS_SYNC_TYPE_NONE;
+
+    cold->name            = name;
+    cold->task_function   = task_function;
+    cold->parameter       = parameter;
+    cold->stack_size      = stack_size;
+    cold->stack_top       = stack_memory + (stack_size / sizeof(uint32_t));
+    cold->time_slice      = RTOS_TIME_SLICE_TICKS;
+    cold->held_mutex_list = NULL;
+
+    /* A recycled TCB must not carry notifications sent to its previous task */
+    for (uint32_t i = 0; i < RTOS_TASK_NOTIFY_ARRAY_ENTRIES; i++)
+    {
+        cold->notification_value[i]   = 0;
+        cold->notification_pending[i] = 0;
+    }
+
+#if RTOS_USE_PERIODIC_TASKS
+    /* First job is released now; its deadline orders the EDF ready heap */
+    cold->period            = period;
+    cold->relative_deadline = relative_deadline;
+    cold->release_tick      = rtos_get_tick_count();
+    new_task->deadline      = cold->release_tick + relative_deadline;
+    cold->deadline_misses   = 0;
+    cold->wcet              = wcet;
+    cold->budget_used       = 0;
+    cold->budget_overruns   = 0;
+#else
+    (void) relative_deadline;
+    (void) wcet;
+#endif
+#if RTOS_USE_EDF_SCHEDULING || !RTOS_SCHEDULER_STATIC_DISPATCH
+    new_task->heap_index = 0;
+#endif
+#if RTOS_USE_BUDGET_SERVER
+    cold->server_period = 0;
+#endif
+
+#if RTOS_PROFILING_SYSTEM_ENABLED
+    /* A reused slot starts a fresh runtime history */
+    new_task->run_cycles                  = 0;
+    g_runtime_base_old[new_task->task_id] = 0;
+    g_runtime_base_new[new_task->task_id] = 0;
+#endif
 
-    new_task->stack_pointer = rtos_port_init_task_stack(new_task->stack_top, task_function, parameter);
+#if RTOS_USE_TIMING_WHEEL
+    new_task->delay_node.next   = NULL;
+    new_task->delay_node.prev   = NULL;
+    new_task->delay_node.slot   = NULL;
+    new_task->delay_node.expiry = 0;
+#endif
+
+    if (name != NULL)
+    {
+        rtos_task_name_insert(new_task);
+    }
+
+#if RTOS_ENABLE_STACK_WATERMARK
+    rtos_task_stack_paint(new_task);
+#endif
+
+    new_task->stack_pointer = rtos_port_init_task_stack(cold->stack_top, task_function, parameter);
     rtos_scheduler_add_to_ready_list(new_task);
 
     g_task_count++;
     *task_handle = new_task;
 
+    /* A task created above its creator runs at once, not at the next tick */
+    bool preempt = (g_kernel.state == RTOS_KERNEL_STATE_RUNNING) &&
+                   rtos_scheduler_should_preempt(rtos_scheduler_get_next_task());
+
     rtos_port_exit_critical();
 
     KLOGI(KEVT_TASK_CREATE, new_task->task_id, priority);
 
+    if (preempt)
+    {
+        rtos_yield();
+    }
+
     return RTOS_SUCCESS;
 }
 
 /**
- * @brief Get the idle task
+ * @brief Get the calling core's idle task
  */
-static rtos_tcb_t *g_idle_task_cache = NULL;
-
 rtos_tcb_t *rtos_task_get_idle_task(void)
 {
-    if (g_idle_task_cache != NULL)
-    {
-        return g_idle_task_cache;
-    }
-
-    for (uint8_t i = 0; i < RTOS_MAX_TASKS; i++)
-    {
-        if (g_task_pool[i].task_function != NULL && g_task_pool[i].priority == RTOS_IDLE_TASK_PRIORITY)
-        {
-            g_idle_task_cache = &g_task_pool[i];
-            return g_idle_task_cache;
-        }
-    }
-    return NULL;
+    return rtos_kernel_this_core()->idle_task;
 }
 
 /**
@@ -154,7 +481,7 @@ rtos_tcb_t *rtos_task_get_idle_task(void)
  */
 rtos_task_handle_t rtos_task_get_current(void)
 {
-    return g_kernel.current_task;
+    return rtos_kernel_this_core()->current_task;
 }
 
 /**
@@ -164,18 +491,22 @@ rtos_task_handle_t rtos_task_get_current(void)
  */
 uint8_t rtos_get_current_task_id(void)
 {
-    if (g_kernel.current_task != NULL)
+    rtos_tcb_t *current = rtos_kernel_this_core()->current_task;
+
+    if (current != NULL)
     {
-        return g_kernel.current_task->task_id;
+        return current->task_id;
     }
     return 0xFF; /* No task running (pre-scheduler) */
 }
 
 const char *rtos_task_get_name(rtos_task_id_t task_id)
 {
-    if (task_id < g_task_count && g_task_pool[task_id].name != NULL)
+    /* Indexes the cold pool directly: safe before rtos_init() links the TCBs */
+    if (task_id < RTOS_MAX_TASKS && g_task_cold_pool[task_id].task_function != NULL &&
+        g_task_cold_pool[task_id].name != NULL)
     {
-        return g_task_pool[task_id].name;
+        return g_task_cold_pool[task_id].name;
     }
     return "?";
 }
@@ -215,7 +546,7 @@ rtos_task_handle_t rtos_task_get_by_id(rtos_task_id_t task_id)
     }
 
     rtos_tcb_t *task = &g_task_pool[task_id];
-    if (task->task_function == NULL)
+    if (task->cold->task_function == NULL)
     {
         return NULL; /* Task slot is empty */
     }
@@ -233,19 +564,26 @@ rtos_task_handle_t rtos_task_get_by_name(const char *name)
         return NULL;
     }
 
-    for (uint8_t i = 0; i < RTOS_MAX_TASKS; i++)
+    uint32_t    hash  = rtos_task_name_hash(name);
+    rtos_tcb_t *found = NULL;
+
+    rtos_port_enter_critical();
+
+    uint8_t i = g_task_name_buckets[hash & (RTOS_TASK_NAME_HASH_BUCKETS - 1U)];
+    while (i != TASK_SLOT_NONE)
     {
-        rtos_tcb_t *task = &g_task_pool[i];
-        if (task->task_function != NULL && task->name != NULL)
+        const rtos_tcb_cold_t *cold = &g_task_cold_pool[i];
+        if (cold->name_hash == hash && strcmp(cold->name, name) == 0)
         {
-            if (strcmp(task->name, name) == 0)
-            {
-                return task;
-            }
+            found = &g_task_pool[i];
+            break;
         }
+        i = cold->next_named;
     }
 
-    return NULL;
+    rtos_port_exit_critical();
+
+    return found;
 }
 
 /**
@@ -256,6 +594,95 @@ uint8_t rtos_task_get_count(void)
     return g_task_count;
 }
 
+/**
+ * @brief Get per-task CPU runtime over the sliding window
+ */
+rtos_status_t rtos_task_get_runtime_stats(rtos_task_runtime_t *tasks, uint8_t max_tasks, rtos_runtime_stats_t *stats)
+{
+    if (stats == NULL || (tasks == NULL && max_tasks != 0))
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    stats->task_count    = 0;
+    stats->window_cycles = 0;
+    stats->idle_permille = 0;
+
+#if RTOS_PROFILING_SYSTEM_ENABLED
+    uint64_t run[RTOS_MAX_TASKS];
+    uint64_t base[RTOS_MAX_TASKS];
+    bool     live[RTOS_MAX_TASKS];
+
+    /* run_cycles only moves at a context switch, so a snapshot needs switching
+     * held off, not interrupts; the 64-bit arithmetic runs after resuming */
+    rtos_scheduler_suspend();
+
+    rtos_port_enter_critical();
+    rtos_kernel_runtime_checkpoint();
+    rtos_port_exit_critical();
+
+    rtos_tick_t now  = g_kernel.tick_count;
+    bool        roll = (now - g_runtime_mark_new) >= RTOS_RUNTIME_WINDOW_TICKS;
+    if (roll)
+    {
+        g_runtime_mark_new = now;
+    }
+
+    for (uint8_t i = 0; i < RTOS_MAX_TASKS; i++)
+    {
+        if (roll)
+        {
+            g_runtime_base_old[i] = g_runtime_base_new[i];
+            g_runtime_base_new[i] = g_task_pool[i].run_cycles;
+        }
+        live[i] = (g_task_pool[i].cold->task_function != NULL);
+        run[i]  = g_task_pool[i].run_cycles;
+        base[i] = g_runtime_base_old[i];
+    }
+
+    rtos_scheduler_resume();
+
+    uint64_t window[RTOS_MAX_TASKS];
+    for (uint8_t i = 0; i < RTOS_MAX_TASKS; i++)
+    {
+        window[i] = (live[i] && run[i] >= base[i]) ? run[i] - base[i] : 0;
+        stats->window_cycles += window[i];
+    }
+
+    rtos_tcb_t *idle = rtos_task_get_idle_task();
+
+    for (uint8_t i = 0; i < RTOS_MAX_TASKS; i++)
+    {
+        if (!live[i])
+        {
+            continue;
+        }
+
+        uint16_t permille =
+            (stats->window_cycles != 0) ? (uint16_t) ((window[i] * 1000U) / stats->window_cycles) : 0;
+
+        if (idle != NULL && idle->task_id == i)
+        {
+            stats->idle_permille = permille;
+        }
+
+        if (stats->task_count < max_tasks)
+        {
+            rtos_task_runtime_t *entry = &tasks[stats->task_count++];
+            entry->task_id             = i;
+            entry->name                = g_task_pool[i].cold->name;
+            entry->total_cycles        = run[i];
+            entry->window_cycles       = window[i];
+            entry->cpu_permille        = permille;
+        }
+    }
+
+    return RTOS_SUCCESS;
+#else
+    return RTOS_ERROR_INVALID_STATE;
+#endif
+}
+
 /**
  * @brief Print task information for debugging
  */
@@ -266,7 +693,7 @@ void rtos_task_debug_print_all(void)
     for (uint8_t i = 0; i < RTOS_MAX_TASKS; i++)
     {
         rtos_tcb_t *task = &g_task_pool[i];
-        if (task->task_function != NULL)
+        if (task->cold->task_function != NULL)
         {
             KLOGD(KEVT_TASK_CREATE, task->task_id, (uint32_t) task->state);
         }
@@ -284,10 +711,29 @@ __attribute__((__noreturn__)) void rtos_task_idle_function(void *param)
 
     while (1)
     {
-        __asm volatile("wfi"); /* Wait for interrupt */
+        if (g_task_reclaim_head != TASK_SLOT_NONE)
+        {
+            rtos_task_reclaim_deleted();
+        }
 
-#if (RTOS_SCHEDULER_TYPE == RTOS_SCHEDULER_COOPERATIVE)
-        rtos_yield();
+#if RTOS_ENABLE_STACK_WATERMARK
+        rtos_task_stack_scan_step();
+#endif
+
+#if RTOS_TICKLESS_IDLE
+        rtos_kernel_idle_sleep(); /* Stop the tick until the next deadline */
+#else
+        __WFI(); /* Wait for interrupt */
+
+        /* A priority-0 peer (e.g. log flush) woken meanwhile does not preempt us */
+        rtos_port_enter_critical();
+        bool runnable = (rtos_scheduler_get_next_task() != NULL);
+        rtos_port_exit_critical();
+
+        if (runnable)
+        {
+            rtos_yield();
+        }
 #endif
     }
 }
@@ -317,7 +763,7 @@ bool rtos_task_check_stack(rtos_task_handle_t task_handle)
     for (uint8_t i = 0; i < RTOS_MAX_TASKS; i++)
     {
         rtos_tcb_t *task = &g_task_pool[i];
-        if (task->task_function != NULL && task->stack_base != NULL)
+        if (task->cold->task_function != NULL && task->stack_base != NULL)
         {
             if (*task->stack_base != PORT_STACK_CANARY_VALUE)
             {
@@ -333,6 +779,65 @@ bool rtos_task_check_stack(rtos_task_handle_t task_handle)
 #endif /* RTOS_ENABLE_STACK_OVERFLOW_CHECK */
 }
 
+/**
+ * @brief Get the bytes at the bottom of a task's stack it never used
+ */
+uint32_t rtos_task_get_stack_unused(rtos_task_handle_t task_handle)
+{
+#if RTOS_ENABLE_STACK_WATERMARK
+    if (task_handle == NULL)
+    {
+        return 0;
+    }
+    return task_handle->cold->stack_unused;
+#else
+    (void) task_handle;
+    return 0;
+#endif
+}
+
+/**
+ * @brief Get stack sizes and high-water marks of all tasks
+ */
+rtos_status_t rtos_task_get_memory_stats(rtos_task_memory_stats_t *stats)
+{
+    if (stats == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+
+    /* Only tasks create, delete and (the idle task) rescan, so holding off
+     * switching is enough; interrupts keep running through the walk */
+    rtos_scheduler_suspend();
+
+    for (uint8_t i = 0; i < RTOS_MAX_TASKS; i++)
+    {
+        const rtos_tcb_cold_t *cold = &g_task_cold_pool[i];
+        if (cold->task_function == NULL)
+        {
+            continue;
+        }
+
+        stats->per_task_stack_size[i] = cold->stack_size;
+#if RTOS_ENABLE_STACK_WATERMARK
+        stats->per_task_stack_unused[i] = cold->stack_unused;
+#endif
+        stats->total_stack_memory += stats->per_task_stack_size[i];
+        stats->free_stack_memory += stats->per_task_stack_unused[i];
+        stats->used_task_slots++;
+    }
+
+    rtos_scheduler_resume();
+
+    stats->used_stack_memory = stats->total_stack_memory - stats->free_stack_memory;
+    stats->total_task_slots  = RTOS_MAX_TASKS;
+    stats->free_task_slots   = (uint8_t) (RTOS_MAX_TASKS - stats->used_task_slots);
+
+    return RTOS_SUCCESS;
+}
+
 /**
  * @brief Suspend a task
  * @param task_handle Task to suspend (NULL = suspend current task)
@@ -342,7 +847,7 @@ rtos_status_t rtos_task_suspend(rtos_task_handle_t task_handle)
 {
     rtos_port_enter_critical();
 
-    rtos_tcb_t *task = (task_handle != NULL) ? task_handle : g_kernel.current_task;
+    rtos_tcb_t *task = (task_handle != NULL) ? task_handle : rtos_kernel_this_core()->current_task;
 
     if (task == NULL)
     {
@@ -370,13 +875,22 @@ rtos_status_t rtos_task_suspend(rtos_task_handle_t task_handle)
 
     KLOGD(KEVT_TASK_SUSPEND, task->task_id, 0);
 
-    if (task == g_kernel.current_task)
+    rtos_kernel_core_t *running = rtos_kernel_running_core(task);
+
+    if (running == rtos_kernel_this_core())
     {
         rtos_port_exit_critical();
         rtos_yield();
         return RTOS_SUCCESS;
     }
 
+#if RTOS_SMP_CORES > 1
+    if (running != NULL)
+    {
+        rtos_kernel_yield_core(running); /* Its own core switches it out */
+    }
+#endif
+
     rtos_port_exit_critical();
     return RTOS_SUCCESS;
 }
@@ -410,6 +924,120 @@ rtos_status_t rtos_task_resume(rtos_task_handle_t task_handle)
     return RTOS_SUCCESS;
 }
 
+/**
+ * @brief End the current job of a periodic task and wait for its next release
+ */
+rtos_status_t rtos_task_wait_for_next_period(void)
+{
+#if !RTOS_USE_PERIODIC_TASKS
+    return RTOS_ERROR_INVALID_STATE;
+#else
+    rtos_port_enter_critical();
+
+    rtos_tcb_t *task = rtos_kernel_this_core()->current_task;
+
+    if (task == NULL || task->cold->period == 0)
+    {
+        rtos_port_exit_critical();
+        KLOGE(KEVT_INVALID_PARAM, 0, 0);
+        return RTOS_ERROR_INVALID_STATE;
+    }
+
+    rtos_tick_t now    = rtos_get_tick_count();
+    bool        missed = (int32_t) (now - task->deadline) > 0;
+
+    if (missed)
+    {
+        task->cold->deadline_misses++;
+    }
+
+    /* Releases stay on the period grid: an overrunning task catches up with
+     * back-to-back jobs instead of drifting */
+    rtos_tcb_cold_t *cold = task->cold;
+
+    cold->release_tick += cold->period;
+    task->deadline    = cold->release_tick + cold->relative_deadline;
+    cold->budget_used = 0;
+
+    int32_t wait    = (int32_t) (cold->release_tick - now);
+    bool    preempt = false;
+
+    if (wait > 0)
+    {
+        RTOS_ASSERT(g_kernel.scheduler_suspended == 0);
+        task->state = RTOS_TASK_STATE_BLOCKED;
+        rtos_scheduler_add_to_delayed_list(task, (rtos_tick_t) wait);
+        preempt = true;
+    }
+    else
+    {
+        /* Next job already released; under EDF its later deadline may now
+         * lose to a ready task */
+        preempt = rtos_scheduler_should_preempt(rtos_scheduler_get_next_task());
+    }
+
+    rtos_port_exit_critical();
+
+    if (preempt)
+    {
+        rtos_yield();
+    }
+
+    return missed ? RTOS_ERROR_TIMEOUT : RTOS_SUCCESS;
+#endif
+}
+
+/**
+ * @brief Get the absolute deadline of a task's current job
+ */
+rtos_tick_t rtos_task_get_deadline(rtos_task_handle_t task_handle)
+{
+#if RTOS_USE_PERIODIC_TASKS
+    if (task_handle == NULL)
+    {
+        return 0;
+    }
+    return task_handle->deadline;
+#else
+    (void) task_handle;
+    return 0;
+#endif
+}
+
+/**
+ * @brief Get the number of jobs a periodic task completed late
+ */
+uint32_t rtos_task_get_deadline_misses(rtos_task_handle_t task_handle)
+{
+#if RTOS_USE_PERIODIC_TASKS
+    if (task_handle == NULL)
+    {
+        return 0;
+    }
+    return task_handle->cold->deadline_misses;
+#else
+    (void) task_handle;
+    return 0;
+#endif
+}
+
+/**
+ * @brief Get the number of jobs that ran past their WCET budget
+ */
+uint32_t rtos_task_get_budget_overruns(rtos_task_handle_t task_handle)
+{
+#if RTOS_USE_PERIODIC_TASKS
+    if (task_handle == NULL)
+    {
+        return 0;
+    }
+    return task_handle->cold->budget_overruns;
+#else
+    (void) task_handle;
+    return 0;
+#endif
+}
+
 /**
  * @brief Delete a task and remove it from all scheduler and sync-object lists.
  */
@@ -417,7 +1045,7 @@ rtos_status_t rtos_task_delete(rtos_task_handle_t task_handle)
 {
     rtos_port_enter_critical();
 
-    rtos_tcb_t *task = (task_handle != NULL) ? task_handle : g_kernel.current_task;
+    rtos_tcb_t *task = (task_handle != NULL) ? task_handle : rtos_kernel_this_core()->current_task;
 
     if (task == NULL)
     {
@@ -461,9 +1089,31 @@ rtos_status_t rtos_task_delete(rtos_task_handle_t task_handle)
                 case RTOS_SYNC_TYPE_NOTIFICATION:
                     /* Self-pointer sentinel — no external list, cleared below */
                     break;
+#if RTOS_USE_EVENT_GROUPS
                 case RTOS_SYNC_TYPE_EVENT_GROUP:
                     rtos_event_group_remove_task_from_wait(task->blocked_on, task);
                     break;
+#endif
+                case RTOS_SYNC_TYPE_MEMPOOL:
+                    rtos_mempool_remove_task_from_wait(task->blocked_on, task);
+                    break;
+                case RTOS_SYNC_TYPE_STREAM_BUFFER:
+                    rtos_stream_buffer_remove_task_from_wait(task->blocked_on, task);
+                    break;
+                case RTOS_SYNC_TYPE_QUEUE_SET:
+                    rtos_queue_set_remove_task_from_wait(task->blocked_on, task);
+                    break;
+                case RTOS_SYNC_TYPE_RWLOCK:
+                    rtos_rwlock_remove_task_from_wait(task->blocked_on, task);
+                    break;
+#if RTOS_USE_HRTIMER
+                case RTOS_SYNC_TYPE_HRTIMER:
+                    rtos_hrtimer_remove_task_from_wait(task->blocked_on, task);
+                    break;
+#endif
+                case RTOS_SYNC_TYPE_IO:
+                    rtos_io_remove_task_from_wait(task->blocked_on, task);
+                    break;
                 default:
                     break;
             }
@@ -478,26 +1128,24 @@ rtos_status_t rtos_task_delete(rtos_task_handle_t task_handle)
     /* S1: Force-release all mutexes held by this task to prevent permanent
      * deadlocks.  For each mutex, transfer ownership to the highest-priority
      * waiter (if any) or mark it free. */
-    while (task->held_mutex_list != NULL)
+    while (task->cold->held_mutex_list != NULL)
     {
-        rtos_mutex_t *m   = task->held_mutex_list;
-        task->held_mutex_list = m->next_held;
-        m->next_held          = NULL;
+        rtos_mutex_t *m             = task->cold->held_mutex_list;
+        task->cold->held_mutex_list = m->next_held;
+        m->next_held                = NULL;
 
         /* Try to hand off to the highest-priority waiter */
-        rtos_tcb_t *waiter = m->waiting_list;
+        rtos_tcb_t *waiter = rtos_wait_queue_pop(&m->waiters);
         if (waiter != NULL)
         {
-            /* Pop head (highest priority due to ordered insertion) */
-            m->waiting_list       = waiter->next_waiting;
-            waiter->next_waiting  = NULL;
             waiter->blocked_on    = NULL;
             waiter->blocked_on_type = RTOS_SYNC_TYPE_NONE;
 
             m->owner      = waiter;
             m->lock_count = 1;
-            m->next_held  = waiter->held_mutex_list;
-            waiter->held_mutex_list = m;
+            m->next_held  = waiter->cold->held_mutex_list;
+            waiter->cold->held_mutex_list = m;
+            rtos_mutex_restore_task_priority(waiter); /* Takes on m's ceiling, if any */
 
             /* Unblock the new owner (will be made READY) */
             rtos_scheduler_remove_from_delayed_list(waiter);
@@ -508,17 +1156,44 @@ rtos_status_t rtos_task_delete(rtos_task_handle_t task_handle)
         {
             m->owner      = NULL;
             m->lock_count = 0;
+
+            /* A deleted writer must not keep an rwlock's readers out */
+            if (m->rwlock_writer)
+            {
+                rtos_rwlock_release_readers((struct rtos_rwlock *) m);
+            }
         }
     }
 
-    task->state           = RTOS_TASK_STATE_DELETED;
+    task->state = RTOS_TASK_STATE_DELETED;
+
+    /* Unlisted now, so the name is free for a new task even before reclaim */
+    if (task->cold->name != NULL)
+    {
+        rtos_task_name_remove(task);
+    }
 
     KLOGI(KEVT_TASK_DELETE, task->task_id, 0);
 
-    bool is_self = (task == g_kernel.current_task);
+    rtos_kernel_core_t *running = rtos_kernel_running_core(task);
+    bool                is_self = (running != NULL && running == rtos_kernel_this_core());
     if (is_self)
     {
-        g_kernel.current_task = NULL;
+        /* PendSV still stacks this task's context on the way out, so its
+         * stack is handed back to the heap later by the idle task. */
+        running->current_task = NULL;
+        rtos_task_defer_release(task);
+    }
+#if RTOS_SMP_CORES > 1
+    else if (running != NULL)
+    {
+        /* Running on another core: its switch-out defers the release */
+        rtos_kernel_yield_core(running);
+    }
+#endif
+    else
+    {
+        rtos_task_release(task);
     }
 
     rtos_port_exit_critical();
@@ -532,22 +1207,99 @@ rtos_status_t rtos_task_delete(rtos_task_handle_t task_handle)
 }
 
 /**
- * @brief Allocate a TCB from the pool
+ * @brief Pop a TCB off the free list
+ *
+ * Caller holds the critical section.
  */
 static rtos_tcb_t *rtos_task_allocate_tcb(void)
 {
-    for (uint8_t i = 0; i < RTOS_MAX_TASKS; i++)
+    uint8_t i = g_task_free_head;
+
+    if (i == TASK_SLOT_NONE)
     {
-        if (g_task_pool[i].task_function == NULL)
+        return NULL;
+    }
+
+    g_task_free_head = g_task_cold_pool[i].next_free;
+    return &g_task_pool[i];
+}
+
+/**
+ * @brief Push a TCB back onto the free list
+ *
+ * task_function = NULL still marks the slot free for the pool scans that
+ * enumerate tasks. Caller holds the critical section.
+ */
+static void rtos_task_free_tcb(rtos_tcb_t *task)
+{
+    uint8_t i = (uint8_t) (task - g_task_pool);
+
+    task->cold->task_function = NULL;
+    task->cold->next_free     = g_task_free_head;
+    g_task_free_head          = i;
+}
+
+/**
+ * @brief FNV-1a hash of a task name
+ */
+static uint32_t rtos_task_name_hash(const char *name)
+{
+    uint32_t hash = 2166136261U;
+
+    while (*name != '\0')
+    {
+        hash ^= (uint8_t) *name++;
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief Add a named task to the head of its hash bucket
+ *
+ * A duplicate name shadows the older task, as the last one created is the
+ * first one found. Caller holds the critical section.
+ */
+static void rtos_task_name_insert(rtos_tcb_t *task)
+{
+    rtos_tcb_cold_t *cold = task->cold;
+
+    cold->name_hash = rtos_task_name_hash(cold->name);
+
+    uint8_t *bucket  = &g_task_name_buckets[cold->name_hash & (RTOS_TASK_NAME_HASH_BUCKETS - 1U)];
+    cold->next_named = *bucket;
+    *bucket          = task->task_id;
+}
+
+/**
+ * @brief Unlink a named task from its hash bucket
+ *
+ * Caller holds the critical section.
+ */
+static void rtos_task_name_remove(rtos_tcb_t *task)
+{
+    uint8_t *link = &g_task_name_buckets[task->cold->name_hash & (RTOS_TASK_NAME_HASH_BUCKETS - 1U)];
+
+    while (*link != TASK_SLOT_NONE)
+    {
+        if (*link == task->task_id)
         {
-            return &g_task_pool[i];
+            *link = task->cold->next_named;
+            break;
         }
+        link = &g_task_cold_pool[*link].next_named;
     }
-    return NULL;
+
+    task->cold->next_named = TASK_SLOT_NONE;
 }
 
 /**
  * @brief Allocate stack memory
+ *
+ * Returns the BASE (lowest address) of the block; the stack grows down from
+ * base + size.  rtos_malloc returns 8-byte aligned memory and size is already
+ * a multiple of 8, so the top is 8-byte aligned too.
  */
 static uint32_t *rtos_task_allocate_stack(rtos_stack_size_t size)
 {
@@ -559,15 +1311,144 @@ static uint32_t *rtos_task_allocate_stack(rtos_stack_size_t size)
         return NULL;
     }
 
-    /**
-     * Stack grows down on Cortex-M.
-     * Return the TOP of the stack block (highest address).
-     * rtos_malloc returns 8-byte aligned start address.
-     * size is assumed to be 8-byte aligned by rtos_malloc (if not, it aligns up).
-     * We just add size to get top.
-     */
-    uint8_t *stack_top = (uint8_t *) stack_block + size;
+    return (uint32_t *) stack_block;
+}
+
+/**
+ * @brief Free a deleted task's stack and return its TCB slot to the pool
+ *
+ * A caller-provided stack (rtos_task_create_static) is left to the caller.
+ * Caller holds the critical section. The TCB keeps RTOS_TASK_STATE_DELETED
+ * until the slot is reused, so stale handles read as deleted.
+ */
+static void rtos_task_release(rtos_tcb_t *task)
+{
+    if ((task->flags & RTOS_TASK_FLAG_STATIC_STACK) == 0U)
+    {
+        rtos_free(task->stack_base);
+    }
+
+    task->stack_base      = NULL;
+    task->cold->stack_top = NULL;
+    rtos_task_free_tcb(task);
+    g_task_count--;
+}
+
+#if RTOS_ENABLE_STACK_WATERMARK
+/**
+ * @brief Lowest stack word the high-water scan may read
+ *
+ * Skips the canary, and with the MPU guard the guard region too: the idle
+ * task scans its own stack while the guard sits on it.
+ */
+static uint32_t *rtos_task_stack_scan_base(const rtos_tcb_t *task)
+{
+#if RTOS_STACK_GUARD_MPU
+    uint32_t guard = ALIGN_UP((uint32_t) task->stack_base + sizeof(uint32_t), RTOS_STACK_GUARD_SIZE);
+    return (uint32_t *) (guard + RTOS_STACK_GUARD_SIZE);
+#else
+    return task->stack_base + 1;
+#endif
+}
+
+/**
+ * @brief Fill a new task's stack with the high-water pattern
+ *
+ * Runs before the initial frame is built at the top. Caller holds the
+ * critical section.
+ */
+static void rtos_task_stack_paint(rtos_tcb_t *task)
+{
+    uint32_t *base  = rtos_task_stack_scan_base(task);
+    uint32_t  words = (uint32_t) (task->cold->stack_top - base);
+
+    rtos_mem_fill_words(base, PORT_STACK_FILL_VALUE, words);
+
+    task->cold->stack_unused = (rtos_stack_size_t) (words * sizeof(uint32_t));
+
+    /* A reused slot must not inherit the scan position of its old task */
+    if (g_stack_scan_slot == task->task_id)
+    {
+        g_stack_scan_word = 0;
+    }
+}
+
+/**
+ * @brief Scan the next RTOS_STACK_SCAN_WORDS of one task's stack (idle task context)
+ *
+ * A pass walks up from the scan base through the bytes last found unused.
+ * The first overwritten word becomes the new mark; a pass that reaches the
+ * old mark leaves it. Either way the next pass takes the next slot. The
+ * mark only ever shrinks, so each pass is at most as long as the last.
+ */
+static void rtos_task_stack_scan_step(void)
+{
+    bool pass_done = true;
+
+    rtos_port_enter_critical();
+
+    rtos_tcb_t *task = &g_task_pool[g_stack_scan_slot];
+
+    if (task->cold->task_function != NULL && task->stack_base != NULL)
+    {
+        const uint32_t *base  = rtos_task_stack_scan_base(task);
+        uint32_t        known = task->cold->stack_unused / sizeof(uint32_t);
+        uint32_t        end   = g_stack_scan_word + RTOS_STACK_SCAN_WORDS;
+        uint32_t        i     = g_stack_scan_word;
 
-    /* Ensure 8-byte alignment of top (should be naturally aligned) */
-    return (uint32_t *) ALIGN8_DOWN_VALUE((uintptr_t) stack_top);
+        if (end > known)
+        {
+            end = known;
+        }
+
+        if (i < end)
+        {
+            i += rtos_mem_scan_words(&base[i], PORT_STACK_FILL_VALUE, end - i);
+        }
+
+        if (i < end)
+        {
+            task->cold->stack_unused = (rtos_stack_size_t) (i * sizeof(uint32_t));
+        }
+        else if (end < known)
+        {
+            g_stack_scan_word = end;
+            pass_done         = false;
+        }
+    }
+
+    if (pass_done)
+    {
+        g_stack_scan_word = 0;
+        g_stack_scan_slot = (uint8_t) ((g_stack_scan_slot + 1U) % RTOS_MAX_TASKS);
+    }
+
+    rtos_port_exit_critical();
+}
+#endif /* RTOS_ENABLE_STACK_WATERMARK */
+
+/**
+ * @brief Queue a deleted task whose stack is still in use for the idle task
+ */
+void rtos_task_defer_release(rtos_tcb_t *task)
+{
+    task->cold->next_free = g_task_reclaim_head;
+    g_task_reclaim_head   = task->task_id;
+}
+
+/**
+ * @brief Release self-deleted tasks (idle task context)
+ */
+static void rtos_task_reclaim_deleted(void)
+{
+    rtos_port_enter_critical();
+
+    while (g_task_reclaim_head != TASK_SLOT_NONE)
+    {
+        rtos_tcb_t *task    = &g_task_pool[g_task_reclaim_head];
+        g_task_reclaim_head = task->cold->next_free;
+        rtos_task_release(task);
+    }
+
+    rtos_port_exit_critical();
 }
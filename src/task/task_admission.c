@@ -0,0 +1,195 @@
+#include "VRTOS.h"
+#include "config.h"
+#include "klog.h"
+#include "task.h"
+#include "task_priv.h"
+
+#include <stdint.h>
+
+#if RTOS_ADMISSION_CONTROL
+
+/*
+ * Admission control for budgeted periodic tasks.
+ *
+ * Priority schedulers use response-time analysis: for each task i the
+ * recurrence
+ *
+ *   R = B_i + C_i + sum_{j != i, prio_j >= prio_i} ceil(R / T_j) * C_j
+ *
+ * is iterated from R = C_i until it reaches a fixed point (schedulable if
+ * R <= D_i) or exceeds D_i.  Equal priorities count as interference, which
+ * covers both FIFO (preemptive) and time-sliced (round-robin) ordering.
+ * B_i is 0 except under the cooperative scheduler, where a running job is
+ * never preempted and B_i is the longest lower-priority WCET.
+ *
+ * EDF uses the density test sum(C_i / D_i) <= 1, exact for implicit
+ * deadlines and sufficient for constrained ones.
+ */
+
+typedef struct
+{
+    rtos_priority_t priority;
+    rtos_period_t   period;
+    rtos_deadline_t deadline;
+    rtos_tick_t     wcet;
+} admission_task_t;
+
+/**
+ * @brief Collect the budgeted periodic tasks plus the candidate
+ * @return Number of entries written to set
+ */
+static uint8_t admission_collect(admission_task_t *set, const admission_task_t *candidate)
+{
+    uint8_t count = 0;
+
+    for (uint8_t i = 0; i < RTOS_MAX_TASKS; i++)
+    {
+        const rtos_tcb_t      *task = &g_task_pool[i];
+        const rtos_tcb_cold_t *cold = task->cold;
+
+        if (cold->task_function == NULL || task->state == RTOS_TASK_STATE_DELETED || cold->period == 0 ||
+            cold->wcet == 0)
+        {
+            continue;
+        }
+
+        set[count].priority = task->base_priority;
+        set[count].period   = cold->period;
+        set[count].deadline = cold->relative_deadline;
+        set[count].wcet     = cold->wcet;
+        count++;
+    }
+
+    set[count++] = *candidate;
+    return count;
+}
+
+#if RTOS_USE_EDF_SCHEDULING
+
+/**
+ * @brief Density test in Q32 fixed point
+ *
+ * Each term is truncated, so a set may be accepted up to count * 2^-32 above
+ * full load; exact rational sets such as three tasks at 1/3 still pass.
+ */
+static bool admission_schedulable(const admission_task_t *set, uint8_t count)
+{
+    uint64_t density = 0;
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        density += ((uint64_t) set[i].wcet << 32) / set[i].deadline;
+    }
+
+    return density <= ((uint64_t) 1 << 32);
+}
+
+#else
+
+/**
+ * @brief Iterate set[i]'s response time until it converges or passes the deadline
+ */
+static bool admission_meets_deadline(const admission_task_t *set, uint8_t count, uint8_t i)
+{
+    rtos_tick_t blocking = 0;
+
+#if RTOS_USE_COOPERATIVE_SCHEDULING
+    for (uint8_t j = 0; j < count; j++)
+    {
+        if (set[j].priority < set[i].priority && set[j].wcet > blocking)
+        {
+            blocking = set[j].wcet;
+        }
+    }
+#endif
+
+    uint64_t response = set[i].wcet;
+
+    while (1)
+    {
+        uint64_t next = (uint64_t) blocking + set[i].wcet;
+
+        for (uint8_t j = 0; j < count; j++)
+        {
+            if (j == i || set[j].priority < set[i].priority)
+            {
+                continue;
+            }
+
+            /* response <= deadline here, so it fits a tick */
+            rtos_tick_t r    = (rtos_tick_t) response;
+            rtos_tick_t jobs = r / set[j].period + ((r % set[j].period) != 0U);
+            next += (uint64_t) jobs * set[j].wcet;
+        }
+
+        if (next > set[i].deadline)
+        {
+            return false;
+        }
+
+        if (next == response)
+        {
+            return true;
+        }
+
+        response = next;
+    }
+}
+
+static bool admission_schedulable(const admission_task_t *set, uint8_t count)
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (!admission_meets_deadline(set, count, i))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+#endif /* RTOS_USE_EDF_SCHEDULING */
+
+/**
+ * @brief Check whether the budgeted task set stays schedulable with a new task
+ */
+rtos_status_t rtos_task_admission_check(rtos_priority_t priority, rtos_period_t period,
+                                        rtos_deadline_t relative_deadline, rtos_tick_t wcet)
+{
+    admission_task_t set[RTOS_MAX_TASKS + 1];
+
+    const admission_task_t candidate = {
+        .priority = priority,
+        .period   = period,
+        .deadline = relative_deadline,
+        .wcet     = wcet,
+    };
+
+    uint8_t count = admission_collect(set, &candidate);
+
+    return admission_schedulable(set, count) ? RTOS_SUCCESS : RTOS_ERROR_NOT_SCHEDULABLE;
+}
+
+/**
+ * @brief Charge one tick to the running task's job budget
+ *
+ * Called from the tick handler with the critical section held.  Ticks are
+ * charged to whichever task is current when SysTick fires, so time spent in
+ * ISRs lands on the interrupted task.  An overrun is counted once per job.
+ */
+void rtos_task_charge_budget(rtos_tcb_t *task)
+{
+    if (task == NULL || task->cold->wcet == 0 || task->cold->budget_used > task->cold->wcet)
+    {
+        return;
+    }
+
+    if (++task->cold->budget_used > task->cold->wcet)
+    {
+        task->cold->budget_overruns++;
+        KLOGW(KEVT_TASK_BUDGET_OVERRUN, task->task_id, task->cold->wcet);
+    }
+}
+
+#endif /* RTOS_ADMISSION_CONTROL */
@@ -1,19 +1,25 @@
 #include "VRTOS.h"
 #include "klog.h"
+#include "rtos_assert.h"
 #include "rtos_port.h"
 #include "scheduler.h"
 #include "task.h"
 #include "task_priv.h"
 
-rtos_notify_status_t rtos_task_notify(rtos_task_handle_t task, uint32_t value, rtos_notify_action_t action)
+RTOS_STATIC_ASSERT(RTOS_TASK_NOTIFY_ARRAY_ENTRIES >= 1U && RTOS_TASK_NOTIFY_ARRAY_ENTRIES <= 255U,
+                   "RTOS_TASK_NOTIFY_ARRAY_ENTRIES must be 1..255");
+
+/**
+ * @brief Apply a notify action and clear the target's notification sentinel
+ *
+ * Called inside a critical section (task or ISR flavour).
+ *
+ * @param wake Set to true if the target was blocked on this slot and must be
+ *        unblocked once the critical section is left
+ * @return false if the action is invalid (nothing is modified)
+ */
+static bool notify_apply(rtos_tcb_t *task, uint8_t index, uint32_t value, rtos_notify_action_t action, bool *wake)
 {
-    if (task == NULL)
-    {
-        return RTOS_NOTIFY_ERR_INVALID;
-    }
-
-    rtos_port_enter_critical();
-
     switch (action)
     {
         case RTOS_NOTIFY_ACTION_NONE:
@@ -21,141 +27,179 @@ rtos_notify_status_t rtos_task_notify(rtos_task_handle_t task, uint32_t value, r
             break;
 
         case RTOS_NOTIFY_ACTION_SET_BITS:
-            task->notification_value |= value;
+            task->cold->notification_value[index] |= value;
             break;
 
         case RTOS_NOTIFY_ACTION_INCREMENT:
-            task->notification_value++;
+            task->cold->notification_value[index]++;
             break;
 
         case RTOS_NOTIFY_ACTION_OVERWRITE:
-            task->notification_value = value;
+            task->cold->notification_value[index] = value;
             break;
 
         default:
-            rtos_port_exit_critical();
-            return RTOS_NOTIFY_ERR_INVALID;
+            return false;
     }
 
-    task->notification_pending = 1;
+    task->cold->notification_pending[index] = 1;
 
     KLOGD(KEVT_NOTIFY_SEND, task->task_id, (uint32_t) action);
 
-    /* If target task is blocked waiting for a notification, wake it */
-    if (task->state == RTOS_TASK_STATE_BLOCKED && task->blocked_on_type == RTOS_SYNC_TYPE_NOTIFICATION)
+    /* If target task is blocked waiting on this slot, wake it */
+    *wake = (task->state == RTOS_TASK_STATE_BLOCKED && task->blocked_on_type == RTOS_SYNC_TYPE_NOTIFICATION &&
+             task->cold->notify_wait_index == index);
+    if (*wake)
     {
         /* Clear the blocking sentinel */
         task->blocked_on      = NULL;
         task->blocked_on_type = RTOS_SYNC_TYPE_NONE;
 
-        KLOGD(KEVT_NOTIFY_WAKE, task->task_id, task->notification_value);
-
-        rtos_port_exit_critical();
-        rtos_kernel_task_unblock(task);
-        return RTOS_NOTIFY_OK;
+        KLOGD(KEVT_NOTIFY_WAKE, task->task_id, task->cold->notification_value[index]);
+    }
+    else if (task->state == RTOS_TASK_STATE_BLOCKED && task->blocked_on_type == RTOS_SYNC_TYPE_QUEUE_SET &&
+             index == RTOS_TASK_NOTIFY_DEFAULT_INDEX)
+    {
+        /* Selecting on a queue set that includes its notification */
+        *wake = rtos_queue_set_take_notified(task->blocked_on, task);
     }
 
-    rtos_port_exit_critical();
-    return RTOS_NOTIFY_OK;
+    return true;
 }
 
-rtos_notify_status_t rtos_task_notify_give(rtos_task_handle_t task)
+/**
+ * @brief Block the current task on one of its notification slots
+ *
+ * Entered inside the critical section, which is left before blocking and
+ * re-entered once the task resumes.
+ *
+ * @return true if woken by a notification, false on timeout
+ */
+static bool notify_block(rtos_tcb_t *current_task, uint8_t index, rtos_tick_t timeout_ticks)
 {
-    return rtos_task_notify(task, 0, RTOS_NOTIFY_ACTION_INCREMENT);
+    current_task->cold->notify_wait_index = index;
+
+    KLOGD(KEVT_NOTIFY_BLOCK, current_task->task_id, (uint32_t) timeout_ticks);
+
+    /*
+     * Block: use self-pointer as blocked_on sentinel.
+     * No separate kernel object exists, so the task's own address
+     * serves as the "object" we're blocked on.
+     */
+    rtos_kernel_block_on(current_task, RTOS_SYNC_TYPE_NOTIFICATION, NULL, timeout_ticks);
+
+    /* --- Task resumes here after unblock or timeout --- */
+
+    /* Check if we were woken by notify (blocked_on cleared) or timeout */
+    if (current_task->blocked_on == current_task)
+    {
+        /* Still has sentinel = timeout occurred */
+        current_task->blocked_on      = NULL;
+        current_task->blocked_on_type = RTOS_SYNC_TYPE_NONE;
+        KLOGD(KEVT_NOTIFY_TIMEOUT, current_task->task_id, 0);
+        return false;
+    }
+
+    return true;
 }
 
-rtos_notify_status_t rtos_task_notify_wait(uint32_t entry_clear_bits, uint32_t exit_clear_bits, uint32_t *value_out,
-                                           rtos_tick_t timeout_ticks)
+rtos_notify_status_t rtos_task_notify_indexed(rtos_task_handle_t task, uint8_t index, uint32_t value,
+                                              rtos_notify_action_t action)
 {
-    rtos_port_enter_critical();
-
-    rtos_tcb_t *current_task = rtos_task_get_current();
-    if (current_task == NULL)
+    if (task == NULL || index >= RTOS_TASK_NOTIFY_ARRAY_ENTRIES)
     {
-        rtos_port_exit_critical();
-        KLOGE(KEVT_NO_CURRENT_TASK, 0, 0);
         return RTOS_NOTIFY_ERR_INVALID;
     }
 
-    /* Clear entry bits before checking pending state */
-    current_task->notification_value &= ~entry_clear_bits;
+    bool wake = false;
 
-    KLOGD(KEVT_NOTIFY_WAIT, current_task->task_id, current_task->notification_value);
+    rtos_port_enter_critical();
+    bool valid = notify_apply(task, index, value, action, &wake);
+    rtos_port_exit_critical();
 
-    /* Fast path: notification already pending */
-    if (current_task->notification_pending)
+    if (!valid)
     {
-        if (value_out != NULL)
-        {
-            *value_out = current_task->notification_value;
-        }
-        current_task->notification_value &= ~exit_clear_bits;
-        current_task->notification_pending = 0;
-        rtos_port_exit_critical();
-        return RTOS_NOTIFY_OK;
+        return RTOS_NOTIFY_ERR_INVALID;
     }
 
-    /* No notification pending — check if we should wait */
-    if (timeout_ticks == RTOS_NOTIFY_NO_WAIT)
+    if (wake)
     {
-        rtos_port_exit_critical();
-        return RTOS_NOTIFY_ERR_TIMEOUT;
+        rtos_kernel_task_unblock(task);
     }
 
-    /*
-     * Block: use self-pointer as blocked_on sentinel.
-     * No separate kernel object exists, so the task's own address
-     * serves as the "object" we're blocked on.
-     */
-    current_task->blocked_on      = current_task;
-    current_task->blocked_on_type = RTOS_SYNC_TYPE_NOTIFICATION;
+    return RTOS_NOTIFY_OK;
+}
 
-    KLOGD(KEVT_NOTIFY_BLOCK, current_task->task_id, (uint32_t) timeout_ticks);
+rtos_notify_status_t rtos_task_notify(rtos_task_handle_t task, uint32_t value, rtos_notify_action_t action)
+{
+    return rtos_task_notify_indexed(task, RTOS_TASK_NOTIFY_DEFAULT_INDEX, value, action);
+}
 
-    if (timeout_ticks == RTOS_NOTIFY_MAX_WAIT)
-    {
-        /* Infinite wait - block without delay timeout */
-        current_task->state = RTOS_TASK_STATE_BLOCKED;
-        rtos_scheduler_remove_from_ready_list(current_task);
-        rtos_port_exit_critical();
-        rtos_yield();
-    }
-    else
+rtos_notify_status_t rtos_task_notify_give_indexed(rtos_task_handle_t task, uint8_t index)
+{
+    return rtos_task_notify_indexed(task, index, 0, RTOS_NOTIFY_ACTION_INCREMENT);
+}
+
+rtos_notify_status_t rtos_task_notify_give(rtos_task_handle_t task)
+{
+    return rtos_task_notify_indexed(task, RTOS_TASK_NOTIFY_DEFAULT_INDEX, 0, RTOS_NOTIFY_ACTION_INCREMENT);
+}
+
+rtos_notify_status_t rtos_task_notify_indexed_from_isr(rtos_task_handle_t task, uint8_t index, uint32_t value,
+                                                       rtos_notify_action_t action, bool *higher_priority_task_woken)
+{
+    if (task == NULL || index >= RTOS_TASK_NOTIFY_ARRAY_ENTRIES)
     {
-        /* Timed wait - use kernel block with delay */
-        rtos_port_exit_critical();
-        rtos_kernel_task_block(current_task, timeout_ticks);
+        return RTOS_NOTIFY_ERR_INVALID;
     }
 
-    /* --- Task resumes here after unblock or timeout --- */
+    bool wake = false;
 
-    rtos_port_enter_critical();
+    uint32_t saved = rtos_port_enter_critical_from_isr();
+    bool     valid = notify_apply(task, index, value, action, &wake);
+    rtos_port_exit_critical_from_isr(saved);
 
-    /* Check if we were woken by notify (blocked_on cleared) or timeout */
-    if (current_task->blocked_on == current_task)
+    if (!valid)
     {
-        /* Still has sentinel = timeout occurred */
-        current_task->blocked_on      = NULL;
-        current_task->blocked_on_type = RTOS_SYNC_TYPE_NONE;
-        rtos_port_exit_critical();
-        KLOGD(KEVT_NOTIFY_TIMEOUT, current_task->task_id, 0);
-        return RTOS_NOTIFY_ERR_TIMEOUT;
+        return RTOS_NOTIFY_ERR_INVALID;
     }
 
-    /* Woken by notification — read value, apply exit clear */
-    if (value_out != NULL)
+    /* Unblock outside ISR critical section; the yield is left to the caller */
+    if (wake && rtos_kernel_task_unblock_from_isr(task) && higher_priority_task_woken != NULL)
     {
-        *value_out = current_task->notification_value;
+        *higher_priority_task_woken = true;
     }
-    current_task->notification_value &= ~exit_clear_bits;
-    current_task->notification_pending = 0;
 
-    rtos_port_exit_critical();
     return RTOS_NOTIFY_OK;
 }
 
-rtos_notify_status_t rtos_task_notify_take(bool clear_on_exit, rtos_tick_t timeout_ticks)
+rtos_notify_status_t rtos_task_notify_from_isr(rtos_task_handle_t task, uint32_t value, rtos_notify_action_t action,
+                                               bool *higher_priority_task_woken)
+{
+    return rtos_task_notify_indexed_from_isr(task, RTOS_TASK_NOTIFY_DEFAULT_INDEX, value, action,
+                                             higher_priority_task_woken);
+}
+
+rtos_notify_status_t rtos_task_notify_give_indexed_from_isr(rtos_task_handle_t task, uint8_t index,
+                                                            bool *higher_priority_task_woken)
+{
+    return rtos_task_notify_indexed_from_isr(task, index, 0, RTOS_NOTIFY_ACTION_INCREMENT, higher_priority_task_woken);
+}
+
+rtos_notify_status_t rtos_task_notify_give_from_isr(rtos_task_handle_t task, bool *higher_priority_task_woken)
+{
+    return rtos_task_notify_indexed_from_isr(task, RTOS_TASK_NOTIFY_DEFAULT_INDEX, 0, RTOS_NOTIFY_ACTION_INCREMENT,
+                                             higher_priority_task_woken);
+}
+
+rtos_notify_status_t rtos_task_notify_wait_indexed(uint8_t index, uint32_t entry_clear_bits, uint32_t exit_clear_bits,
+                                                   uint32_t *value_out, rtos_tick_t timeout_ticks)
 {
+    if (index >= RTOS_TASK_NOTIFY_ARRAY_ENTRIES)
+    {
+        return RTOS_NOTIFY_ERR_INVALID;
+    }
+
     rtos_port_enter_critical();
 
     rtos_tcb_t *current_task = rtos_task_get_current();
@@ -166,72 +210,97 @@ rtos_notify_status_t rtos_task_notify_take(bool clear_on_exit, rtos_tick_t timeo
         return RTOS_NOTIFY_ERR_INVALID;
     }
 
-    /* Fast path: notification value > 0 */
-    if (current_task->notification_value > 0)
+    /* Clear entry bits before checking pending state */
+    current_task->cold->notification_value[index] &= ~entry_clear_bits;
+
+    KLOGD(KEVT_NOTIFY_WAIT, current_task->task_id, current_task->cold->notification_value[index]);
+
+    /* Block unless a notification is already pending */
+    if (!current_task->cold->notification_pending[index])
     {
-        if (clear_on_exit)
+        /* No notification pending — check if we should wait */
+        if (timeout_ticks == RTOS_NOTIFY_NO_WAIT)
         {
-            current_task->notification_value = 0;
+            rtos_port_exit_critical();
+            return RTOS_NOTIFY_ERR_TIMEOUT;
         }
-        else
+
+        if (!notify_block(current_task, index, timeout_ticks))
         {
-            current_task->notification_value--;
+            rtos_port_exit_critical();
+            return RTOS_NOTIFY_ERR_TIMEOUT;
         }
-        current_task->notification_pending = 0;
-        rtos_port_exit_critical();
-        return RTOS_NOTIFY_OK;
     }
 
-    /* Value is 0 — check if we should wait */
-    if (timeout_ticks == RTOS_NOTIFY_NO_WAIT)
+    /* Read value, apply exit clear */
+    if (value_out != NULL)
     {
-        rtos_port_exit_critical();
-        return RTOS_NOTIFY_ERR_TIMEOUT;
+        *value_out = current_task->cold->notification_value[index];
     }
+    current_task->cold->notification_value[index] &= ~exit_clear_bits;
+    current_task->cold->notification_pending[index] = 0;
 
-    /* Block: self-pointer sentinel */
-    current_task->blocked_on      = current_task;
-    current_task->blocked_on_type = RTOS_SYNC_TYPE_NOTIFICATION;
+    rtos_port_exit_critical();
+    return RTOS_NOTIFY_OK;
+}
 
-    KLOGD(KEVT_NOTIFY_BLOCK, current_task->task_id, (uint32_t) timeout_ticks);
+rtos_notify_status_t rtos_task_notify_wait(uint32_t entry_clear_bits, uint32_t exit_clear_bits, uint32_t *value_out,
+                                           rtos_tick_t timeout_ticks)
+{
+    return rtos_task_notify_wait_indexed(RTOS_TASK_NOTIFY_DEFAULT_INDEX, entry_clear_bits, exit_clear_bits, value_out,
+                                         timeout_ticks);
+}
 
-    if (timeout_ticks == RTOS_NOTIFY_MAX_WAIT)
-    {
-        current_task->state = RTOS_TASK_STATE_BLOCKED;
-        rtos_scheduler_remove_from_ready_list(current_task);
-        rtos_port_exit_critical();
-        rtos_yield();
-    }
-    else
+rtos_notify_status_t rtos_task_notify_take_indexed(uint8_t index, bool clear_on_exit, rtos_tick_t timeout_ticks)
+{
+    if (index >= RTOS_TASK_NOTIFY_ARRAY_ENTRIES)
     {
-        rtos_port_exit_critical();
-        rtos_kernel_task_block(current_task, timeout_ticks);
+        return RTOS_NOTIFY_ERR_INVALID;
     }
 
-    /* --- Task resumes here after unblock or timeout --- */
-
     rtos_port_enter_critical();
 
-    if (current_task->blocked_on == current_task)
+    rtos_tcb_t *current_task = rtos_task_get_current();
+    if (current_task == NULL)
     {
-        current_task->blocked_on      = NULL;
-        current_task->blocked_on_type = RTOS_SYNC_TYPE_NONE;
         rtos_port_exit_critical();
-        KLOGD(KEVT_NOTIFY_TIMEOUT, current_task->task_id, 0);
-        return RTOS_NOTIFY_ERR_TIMEOUT;
+        KLOGE(KEVT_NO_CURRENT_TASK, 0, 0);
+        return RTOS_NOTIFY_ERR_INVALID;
     }
 
-    /* Woken by notification — consume value */
+    /* Block unless the notification value is already > 0 */
+    if (current_task->cold->notification_value[index] == 0)
+    {
+        /* Value is 0 — check if we should wait */
+        if (timeout_ticks == RTOS_NOTIFY_NO_WAIT)
+        {
+            rtos_port_exit_critical();
+            return RTOS_NOTIFY_ERR_TIMEOUT;
+        }
+
+        if (!notify_block(current_task, index, timeout_ticks))
+        {
+            rtos_port_exit_critical();
+            return RTOS_NOTIFY_ERR_TIMEOUT;
+        }
+    }
+
+    /* Consume value */
     if (clear_on_exit)
     {
-        current_task->notification_value = 0;
+        current_task->cold->notification_value[index] = 0;
     }
     else
     {
-        current_task->notification_value--;
+        current_task->cold->notification_value[index]--;
     }
-    current_task->notification_pending = 0;
+    current_task->cold->notification_pending[index] = 0;
 
     rtos_port_exit_critical();
     return RTOS_NOTIFY_OK;
 }
+
+rtos_notify_status_t rtos_task_notify_take(bool clear_on_exit, rtos_tick_t timeout_ticks)
+{
+    return rtos_task_notify_take_indexed(RTOS_TASK_NOTIFY_DEFAULT_INDEX, clear_on_exit, timeout_ticks);
+}
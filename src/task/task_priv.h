@@ -5,103 +5,229 @@
 #include "profiling.h"
 #include "rtos_assert.h"
 #include "rtos_types.h"
+#include "scheduler.h"
+#include "task.h"
+#include "timer_wheel.h"
+#include "wait_queue.h"
+
+struct rtos_mutex;  /* forward declaration for held-mutex tracking */
+struct rtos_rwlock; /* forward declaration for rwlock writer release */
+
+/* Internal TCB flag: stack_base belongs to the caller (rtos_task_create_static), not the heap */
+#define RTOS_TASK_FLAG_STATIC_STACK (0x80U)
+/* Internal TCB flag: created with a period (rtos_task_create_periodic); read by the EDF heap order */
+#define RTOS_TASK_FLAG_PERIODIC (0x40U)
+/* Internal TCB flag: READY on g_kernel's pending-ready list, not the scheduler's (scheduler suspended) */
+#define RTOS_TASK_FLAG_PENDING_READY (0x20U)
+/* RTOS_TASK_FLAG_CORE() bits of the cores the kernel schedules on */
+#define RTOS_TASK_FLAG_CORES_VALID ((RTOS_TASK_FLAG_CORE(RTOS_SMP_CORES) - 1U) & RTOS_TASK_FLAG_CORE_MASK)
+
+/* RTOS_FOOTPRINT_COMPACT: enum fields stored in one byte, round-robin quanta in 16 bits */
+#if RTOS_FOOTPRINT_COMPACT
+#define RTOS_TCB_ENUM(type) uint8_t
+typedef uint16_t rtos_quantum_t;
+RTOS_STATIC_ASSERT(RTOS_TIME_SLICE_TICKS <= UINT16_MAX, "RTOS_TIME_SLICE_TICKS must fit a 16-bit quantum");
+#else
+#define RTOS_TCB_ENUM(type) type
+typedef rtos_tick_t rtos_quantum_t;
+#endif
 
-struct rtos_mutex; /* forward declaration for held-mutex tracking */
-
-/* Task Control Block */
-typedef struct rtos_task_control_block
+/*
+ * Task Control Block, split in two.
+ *
+ * rtos_tcb_t is the hot part: the fields PendSV, the ready/delay lists, the
+ * tick handler and the wait queues touch on every switch, block or wake.
+ * It is kept at 16 words on a 32-bit target (plus the optional timing-wheel
+ * link and profiling counters) so the pool for all RTOS_MAX_TASKS tasks is
+ * one small contiguous array, and may be placed on its own with
+ * RTOS_TCB_POOL_REGION.
+ *
+ * rtos_tcb_cold_t holds everything read only at creation, on a specific API
+ * call or once per job/quantum. Each TCB points at its own entry of
+ * g_task_cold_pool, at the same index; the link is set once at init and
+ * never changes.
+ */
+typedef struct rtos_tcb_cold
 {
-    /* Stack management */
-    uint32_t         *stack_pointer; /**< Current stack pointer */
-    uint32_t         *stack_base;    /**< Base of task stack */
-    uint32_t         *stack_top;     /**< Top of task stack */
-    rtos_stack_size_t stack_size;    /**< Stack size in bytes */
-
-    /* Task identification */
-    rtos_task_id_t task_id; /**< Unique task identifier */
-    const char    *name;    /**< Task name for debugging */
-
-    /* Task execution */
-    rtos_task_function_t task_function; /**< Task function pointer */
+    /* Task identification and entry */
+    const char          *name;          /**< Task name for debugging; used slots only */
+    rtos_task_function_t task_function; /**< Task function pointer; NULL = free slot */
     void                *parameter;     /**< Parameter for task function */
 
-    /* Task state */
-    rtos_task_state_t state;         /**< Current task state */
-    rtos_priority_t   priority;      /**< Task priority (may be boosted) */
-    rtos_priority_t   base_priority; /**< Original priority (for priority inheritance) */
-
-    /* Scheduling */
-    rtos_tick_t delay_until;          /**< Tick count until task ready */
-    rtos_tick_t time_slice_remaining; /**< Remaining time slice */
+    /* Slot lists in task.c, linked by pool index (0xFF = end) */
+    uint32_t name_hash;  /**< Hash of name, checked before strcmp in rtos_task_get_by_name() */
+    uint8_t  next_free;  /**< Next slot on the free or the reclaim list */
+    uint8_t  next_named; /**< Next named task in the same name-hash bucket */
 
-    /* List management */
-    struct rtos_task_control_block *next; /**< Next task in list */
-    struct rtos_task_control_block *prev; /**< Previous task in list */
+    /* Stack extent (stack_base, checked at each switch, is in the hot part) */
+    uint32_t         *stack_top;  /**< Top of task stack */
+    rtos_stack_size_t stack_size; /**< Stack size in bytes */
+#if RTOS_ENABLE_STACK_WATERMARK
+    rtos_stack_size_t stack_unused; /**< Bottom bytes still holding the fill pattern at the last idle scan */
+#endif
 
-    /* Synchronization support */
-    struct rtos_task_control_block *next_waiting;    /**< Next task in sync wait queue */
-    void                           *blocked_on;      /**< Sync object task is waiting on */
-    rtos_sync_type_t                blocked_on_type; /**< Type of sync object */
+    rtos_quantum_t time_slice; /**< Round-robin quantum in ticks, reloaded once per quantum */
+
+#if RTOS_USE_PERIODIC_TASKS
+    /* Periodic release (rtos_task_create_periodic); period == 0 for aperiodic tasks */
+    rtos_period_t   period;            /**< Release period in ticks */
+    rtos_deadline_t relative_deadline; /**< Deadline offset from each release */
+    rtos_tick_t     release_tick;      /**< Release tick of the current job */
+    uint32_t        deadline_misses;   /**< Jobs that completed after their deadline */
+    rtos_tick_t     wcet;              /**< Per-job budget in ticks, 0 = none */
+    rtos_tick_t     budget_used;       /**< Ticks charged to the current job */
+    uint32_t        budget_overruns;   /**< Jobs that exceeded wcet */
+#endif
+#if RTOS_USE_BUDGET_SERVER
+    /* Deferrable budget server (rtos_task_set_budget_server); server_period == 0 = none */
+    rtos_tick_t     server_budget;         /**< Foreground ticks per replenishment period */
+    rtos_tick_t     server_period;         /**< Replenishment period in ticks */
+    rtos_tick_t     server_remaining;      /**< Budget left in the current period */
+    rtos_tick_t     server_replenish_tick; /**< Tick of the next replenishment */
+    uint32_t        server_exhaustions;    /**< Periods in which the budget ran out */
+    rtos_priority_t server_priority;       /**< Foreground base priority */
+    rtos_priority_t server_background;     /**< Base priority while exhausted */
+#endif
 
     /* Mutex ownership tracking (for correct priority inheritance restoration) */
     struct rtos_mutex *held_mutex_list; /**< Singly-linked list of mutexes held by this task */
 
-    /* Task notification support */
-    uint32_t notification_value;   /**< Notification value (bitfield/counter) */
-    uint8_t  notification_pending; /**< 0 = not pending, 1 = pending */
+    /* Task notification support, one slot per index */
+    uint32_t notification_value[RTOS_TASK_NOTIFY_ARRAY_ENTRIES];   /**< Notification value (bitfield/counter) */
+    uint8_t  notification_pending[RTOS_TASK_NOTIFY_ARRAY_ENTRIES]; /**< 0 = not pending, 1 = pending */
+    uint8_t  notify_wait_index; /**< Slot waited on (valid only when blocked_on_type == NOTIFICATION) */
 
+#if RTOS_USE_EVENT_GROUPS
     /* Event group wait parameters (valid only when blocked_on_type == EVENT_GROUP) */
     uint32_t event_wait_bits;     /**< Bits this task is waiting for */
     uint8_t  event_wait_all;      /**< 1 = wait for ALL bits, 0 = wait for ANY */
     uint8_t  event_clear_on_exit; /**< 1 = clear waited bits on successful wake */
+#endif
+} rtos_tcb_cold_t;
+
+typedef struct rtos_task_control_block
+{
+    /* Context switch */
+    uint32_t *stack_pointer; /**< Current stack pointer (must stay first: PendSV reads offset 0) */
+    uint32_t *stack_base;    /**< Base of task stack, holds the overflow canary */
+
+    /* Ready / delay list links */
+    struct rtos_task_control_block *next; /**< Next task in list */
+    struct rtos_task_control_block *prev; /**< Previous task in list */
+
+    /* Task state */
+    RTOS_TCB_ENUM(rtos_task_state_t) state; /**< Current task state */
+    rtos_priority_t   priority;      /**< Task priority (may be boosted) */
+    rtos_priority_t   base_priority; /**< Original priority (for priority inheritance) */
+    uint8_t           flags;         /**< RTOS_TASK_FLAG_* from creation, plus internal flags above */
+    rtos_task_id_t    task_id;       /**< Unique task identifier = pool index */
+
+    /* Scheduling */
+    rtos_tick_t    delay_until;          /**< Tick count until task ready */
+    rtos_quantum_t time_slice_remaining; /**< Remaining time slice */
+#if RTOS_USE_PERIODIC_TASKS
+    rtos_tick_t deadline; /**< Absolute deadline of the current job (EDF heap key) */
+#endif
+#if RTOS_USE_TIMING_WHEEL
+    timer_wheel_node_t delay_node; /**< Link into g_task_delay_wheel while delayed */
+#endif
+
+    /* Synchronization support */
+    struct rtos_task_control_block *next_waiting;    /**< Next task in wait queue bucket */
+    struct rtos_task_control_block *prev_waiting;    /**< Previous task in wait queue bucket */
+    struct rtos_wait_queue         *wait_queue;      /**< Wait queue the task is linked in, NULL = none */
+    void                           *blocked_on;      /**< Sync object task is waiting on */
+    RTOS_TCB_ENUM(rtos_sync_type_t) blocked_on_type; /**< Type of sync object */
+    rtos_priority_t                 wait_priority;   /**< Bucket within wait_queue */
+#if RTOS_USE_PREEMPTION_THRESHOLD
+    rtos_priority_t preempt_threshold; /**< Only tasks above this preempt it while running (>= base_priority) */
+#endif
+#if RTOS_USE_EDF_SCHEDULING || !RTOS_SCHEDULER_STATIC_DISPATCH
+    uint8_t heap_index; /**< 1-based slot in the EDF ready heap, 0 = not queued */
+#endif
 
 #if RTOS_PROFILING_SYSTEM_ENABLED
     uint32_t ready_timestamp; /**< DWT cycle count when task became READY */
+    uint64_t run_cycles;      /**< DWT cycles spent running, charged at each switch-out */
 #endif
-} rtos_tcb_t;
+
+    rtos_tcb_cold_t *cold; /**< This task's entry in g_task_cold_pool */
+} __attribute__((aligned(8))) rtos_tcb_t;
 RTOS_STATIC_ASSERT(offsetof(rtos_tcb_t, stack_pointer) == 0, "stack_pointer must be first in TCB");
 
-// TODO: To be used by rtos_task_get_memory_stats
-/**
- * @brief Task memory usage statistics
- */
-typedef struct
+/* Hot-part budget on a 32-bit target; the wheel link and profiling counters come on top */
+#define RTOS_TCB_HOT_SIZE_MAX (64U + (RTOS_USE_TIMING_WHEEL ? 16U : 0U) + (RTOS_PROFILING_SYSTEM_ENABLED ? 16U : 0U))
+RTOS_STATIC_ASSERT(sizeof(void *) != 4U || sizeof(rtos_tcb_t) <= RTOS_TCB_HOT_SIZE_MAX,
+                   "hot TCB fields outgrew their budget; move the new field to rtos_tcb_cold_t");
+
+/* True if task's affinity lets it run on core (no RTOS_TASK_FLAG_CORE bit = any core) */
+static inline bool rtos_task_runs_on_core(const rtos_tcb_t *task, uint32_t core)
 {
-    uint32_t total_stack_memory;                    /**< Total stack memory available */
-    uint32_t used_stack_memory;                     /**< Stack memory currently used */
-    uint32_t free_stack_memory;                     /**< Stack memory available */
-    uint8_t  total_task_slots;                      /**< Total task slots */
-    uint8_t  used_task_slots;                       /**< Task slots currently used */
-    uint8_t  free_task_slots;                       /**< Task slots available */
-    uint32_t per_task_stack_size[RTOS_MAX_TASKS];   /**< Stack size per task */
-    uint32_t per_task_stack_unused[RTOS_MAX_TASKS]; /**< Unused stack per task */
-} rtos_task_memory_stats_t;
+    uint8_t affinity = task->flags & RTOS_TASK_FLAG_CORE_MASK;
+
+    return affinity == 0U || (affinity & RTOS_TASK_FLAG_CORE(core)) != 0U;
+}
 
 /* Task management variables */
-extern rtos_tcb_t g_task_pool[RTOS_MAX_TASKS]; /**< Pool of task control blocks */
-extern uint8_t    g_task_count;                /**< Current number of tasks */
+extern rtos_tcb_t      g_task_pool[RTOS_MAX_TASKS];      /**< Pool of task control blocks (hot parts) */
+extern rtos_tcb_cold_t g_task_cold_pool[RTOS_MAX_TASKS]; /**< Cold parts, same index as g_task_pool */
+extern uint8_t         g_task_count;                     /**< Current number of tasks */
 
 /* Internal task functions */
 rtos_status_t rtos_task_init_system(void);
 rtos_tcb_t   *rtos_task_get_idle_task(void);
 void          rtos_task_idle_function(void *param);
+void          rtos_task_defer_release(rtos_tcb_t *task); /* Critical section held */
 
 /* Extended task management functions */
 rtos_task_handle_t rtos_task_get_by_id(rtos_task_id_t task_id);
 rtos_task_handle_t rtos_task_get_by_name(const char *name);
 uint8_t            rtos_task_get_count(void);
-void               rtos_task_get_memory_stats(void); // TODO: Implement using rtos_task_memory_stats_t
 void               rtos_task_debug_print_all(void);
 
+/* Admission control (task_admission.c), RTOS_ADMISSION_CONTROL != 0 only */
+rtos_status_t rtos_task_admission_check(rtos_priority_t priority, rtos_period_t period,
+                                        rtos_deadline_t relative_deadline, rtos_tick_t wcet);
+void          rtos_task_charge_budget(rtos_tcb_t *task);
+
+/* Budget servers (task_server.c), RTOS_USE_BUDGET_SERVER only */
+void rtos_task_server_tick(rtos_tcb_t *current);
+
 /* Kernel helper functions for task state transitions */
 void rtos_kernel_task_ready(rtos_task_handle_t task);
-void rtos_kernel_task_block(rtos_task_handle_t task, rtos_tick_t delay_ticks);
+void rtos_kernel_block_on(void *object, rtos_sync_type_t type, rtos_wait_queue_t *wait_list,
+                          rtos_tick_t timeout_ticks); /* Critical section held, re-held on return */
 void rtos_kernel_task_unblock(rtos_task_handle_t task);
+bool rtos_kernel_task_unblock_from_isr(rtos_task_handle_t task);
 
 /* Sync-object wait-list removal helpers — called by rtos_task_delete() */
 void rtos_mutex_remove_task_from_wait(void *mutex_ptr, rtos_tcb_t *task);
 void rtos_sem_remove_task_from_wait(void *sem_ptr, rtos_tcb_t *task);
 void rtos_queue_remove_task_from_wait(void *queue_ptr, rtos_tcb_t *task);
 void rtos_event_group_remove_task_from_wait(void *eg_ptr, rtos_tcb_t *task);
+void rtos_mempool_remove_task_from_wait(void *pool_ptr, rtos_tcb_t *task);
+void rtos_stream_buffer_remove_task_from_wait(void *sb_ptr, rtos_tcb_t *task);
+void rtos_queue_set_remove_task_from_wait(void *set_ptr, rtos_tcb_t *task);
+void rtos_rwlock_remove_task_from_wait(void *rw_ptr, rtos_tcb_t *task);
+void rtos_hrtimer_remove_task_from_wait(void *timer_ptr, rtos_tcb_t *task);
+void rtos_io_remove_task_from_wait(void *req_ptr, rtos_tcb_t *task);
+
+/*
+ * Queue set wake hooks (queue_set.c), called inside a critical section by a
+ * member that became ready. take_waiter pops one task blocked on the set
+ * (NULL = none); take_notified unlinks task if the set includes its
+ * default notification slot.
+ */
+rtos_tcb_t *rtos_queue_set_take_waiter(void *set_ptr);
+bool        rtos_queue_set_take_notified(void *set_ptr, rtos_tcb_t *task);
+
+/* Effective priority = max(base_priority, held-mutex waiters and ceilings) — used when base_priority moves */
+void rtos_mutex_restore_task_priority(rtos_tcb_t *task);
+
+/* Mutex PIP for a task blocked elsewhere on the owner's behalf (rwlock readers) */
+void rtos_mutex_inherit_priority(struct rtos_mutex *m, rtos_tcb_t *waiter);
+
+/* Let the readers an rwlock writer held off in (rwlock.c; also on writer delete) */
+void rtos_rwlock_release_readers(struct rtos_rwlock *rw);
 
 #endif /* TASK_PRIV_H */
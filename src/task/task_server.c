@@ -0,0 +1,239 @@
+#include "VRTOS.h"
+#include "config.h"
+#include "kernel_priv.h"
+#include "klog.h"
+#include "rtos_port.h"
+#include "scheduler.h"
+#include "task.h"
+#include "task_priv.h"
+
+#include <stdint.h>
+
+#if RTOS_USE_BUDGET_SERVER && RTOS_SMP_CORES > 1
+#error "Budget servers charge one running task per tick: RTOS_USE_BUDGET_SERVER needs RTOS_SMP_CORES == 1"
+#endif
+
+/*
+ * Deferrable budget servers.
+ *
+ * A server task runs at its foreground priority while it has budget left.
+ * Every tick it is the running task costs one tick of budget; when the
+ * budget reaches zero its base priority drops to the background priority,
+ * so it only gets CPU time nothing above the background level wants.  Every
+ * server period the budget is refilled and the foreground priority comes
+ * back.  Unused budget is kept until the end of the period (deferrable
+ * server), so in a worst-case window a server can run two budgets back to
+ * back around a replenishment.
+ *
+ * Priority changes go through base_priority, so mutex inheritance still
+ * applies: an exhausted server holding a mutex keeps the priority of its
+ * highest waiter until it unlocks.
+ */
+
+#if RTOS_USE_BUDGET_SERVER
+
+RTOS_STATIC_ASSERT(RTOS_MAX_TASKS <= 32U, "g_server_mask holds one bit per task slot");
+
+/* Bit i set: g_task_pool[i] had a server configured.  Bits of deleted or
+ * reused slots are dropped by the next tick that sees server_period == 0. */
+static uint32_t g_server_mask = 0;
+
+/**
+ * @brief Move a task's base priority, keeping its mutex inheritance
+ *
+ * Caller holds the critical section.  The running task is not in a ready
+ * list; a READY task is requeued at its new priority.
+ */
+static void server_set_base_priority(rtos_tcb_t *task, rtos_priority_t base)
+{
+    if (task->base_priority == base)
+    {
+        return;
+    }
+
+    bool queued = (task->state == RTOS_TASK_STATE_READY);
+
+    if (queued)
+    {
+        rtos_scheduler_remove_from_ready_list(task);
+    }
+
+    task->base_priority = base;
+    rtos_mutex_restore_task_priority(task);
+
+    if (queued)
+    {
+        rtos_scheduler_add_to_ready_list(task);
+    }
+}
+
+/**
+ * @brief Charge the running server and refill due budgets
+ *
+ * Called from the tick handler with the critical section held, before the
+ * scheduler picks the next task, so a demotion or promotion takes effect on
+ * this tick.
+ */
+void rtos_task_server_tick(rtos_tcb_t *current)
+{
+    if (g_server_mask == 0)
+    {
+        return;
+    }
+
+    /* The tick that just elapsed belongs to the period before any refill */
+    if (current != NULL && current->cold->server_period != 0 && current->cold->server_remaining > 0)
+    {
+        rtos_tcb_cold_t *cold = current->cold;
+
+        if (--cold->server_remaining == 0)
+        {
+            cold->server_exhaustions++;
+            server_set_base_priority(current, cold->server_background);
+            KLOGD(KEVT_TASK_SERVER_EXHAUSTED, current->task_id, cold->server_background);
+        }
+    }
+
+    rtos_tick_t now     = rtos_get_tick_count();
+    uint32_t    pending = g_server_mask;
+
+    while (pending != 0)
+    {
+        uint32_t         i    = (uint32_t) __builtin_ctz(pending);
+        rtos_tcb_t      *task = &g_task_pool[i];
+        rtos_tcb_cold_t *cold = task->cold;
+
+        pending &= pending - 1U;
+
+        if (cold->task_function == NULL || task->state == RTOS_TASK_STATE_DELETED || cold->server_period == 0)
+        {
+            g_server_mask &= ~(1UL << i);
+            continue;
+        }
+
+        int32_t late = (int32_t) (now - cold->server_replenish_tick);
+        if (late < 0)
+        {
+            continue;
+        }
+
+        /* Stay on the period grid; skips periods missed during tickless idle */
+        cold->server_replenish_tick += ((rtos_tick_t) late / cold->server_period + 1U) * cold->server_period;
+
+        if (cold->server_remaining == 0)
+        {
+            server_set_base_priority(task, cold->server_priority);
+            KLOGD(KEVT_TASK_SERVER_REPLENISH, task->task_id, cold->server_priority);
+        }
+        cold->server_remaining = cold->server_budget;
+    }
+}
+
+#endif /* RTOS_USE_BUDGET_SERVER */
+
+/**
+ * @brief Attach, change or remove a task's budget server
+ */
+rtos_status_t rtos_task_set_budget_server(rtos_task_handle_t task_handle, rtos_tick_t budget, rtos_tick_t period,
+                                          rtos_priority_t background_priority)
+{
+#if RTOS_USE_BUDGET_SERVER
+    if (task_handle == NULL || budget > period || (budget != 0 && period == 0))
+    {
+        KLOGE(KEVT_INVALID_PARAM, budget, period);
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_port_enter_critical();
+
+    rtos_tcb_t      *task = task_handle;
+    rtos_tcb_cold_t *cold = task->cold;
+
+    if (cold->task_function == NULL || task->state == RTOS_TASK_STATE_DELETED || task == rtos_task_get_idle_task())
+    {
+        rtos_port_exit_critical();
+        KLOGE(KEVT_INVALID_PARAM, task->task_id, 0);
+        return RTOS_ERROR_INVALID_STATE;
+    }
+
+    rtos_priority_t foreground = (cold->server_period != 0) ? cold->server_priority : task->base_priority;
+
+    if (budget != 0 && background_priority >= foreground)
+    {
+        rtos_port_exit_critical();
+        KLOGE(KEVT_INVALID_PARAM, background_priority, foreground);
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    if (budget == 0)
+    {
+        cold->server_period = 0;
+    }
+    else
+    {
+        cold->server_budget         = budget;
+        cold->server_period         = period;
+        cold->server_remaining      = budget;
+        cold->server_replenish_tick = rtos_get_tick_count() + period;
+        cold->server_exhaustions    = 0;
+        cold->server_priority       = foreground;
+        cold->server_background     = background_priority;
+        g_server_mask |= 1UL << task->task_id;
+    }
+
+    /* Both branches start at the foreground priority */
+    server_set_base_priority(task, foreground);
+
+    bool preempt = (g_kernel.state == RTOS_KERNEL_STATE_RUNNING) &&
+                   rtos_scheduler_should_preempt(rtos_scheduler_get_next_task());
+
+    rtos_port_exit_critical();
+
+    if (preempt)
+    {
+        rtos_yield();
+    }
+
+    return RTOS_SUCCESS;
+#else
+    (void) task_handle;
+    (void) budget;
+    (void) period;
+    (void) background_priority;
+    return RTOS_ERROR_INVALID_STATE;
+#endif
+}
+
+/**
+ * @brief Get the budget left in a server task's current period
+ */
+rtos_tick_t rtos_task_get_server_budget(rtos_task_handle_t task_handle)
+{
+#if RTOS_USE_BUDGET_SERVER
+    if (task_handle == NULL || task_handle->cold->server_period == 0)
+    {
+        return 0;
+    }
+    return task_handle->cold->server_remaining;
+#else
+    (void) task_handle;
+    return 0;
+#endif
+}
+
+/**
+ * @brief Get the number of periods in which a server task ran out of budget
+ */
+uint32_t rtos_task_get_server_exhaustions(rtos_task_handle_t task_handle)
+{
+#if RTOS_USE_BUDGET_SERVER
+    if (task_handle == NULL || task_handle->cold->server_period == 0)
+    {
+        return 0;
+    }
+    return task_handle->cold->server_exhaustions;
+#else
+    (void) task_handle;
+    return 0;
+#endif
+}
@@ -0,0 +1,478 @@
+#include "workqueue.h"
+
+#include "VRTOS.h"
+#include "rtos_port.h"
+#include "task.h"
+
+#include <stddef.h>
+
+/*
+ * Worker lists are singly linked FIFOs, one per priority, changed only
+ * under the kernel critical section (which on SMP also takes the kernel
+ * spinlock), so owner and thieves need no lock-free deque: the critical
+ * section is already paid for by the notification that wakes a worker.
+ *
+ * A worker marks itself idle under the same critical section in which it
+ * found nothing to take, and a submission that picks an idle worker clears
+ * the flag, so two submissions in a row wake two different idle workers.
+ * A stale notification (its job was stolen) only costs one empty pass.
+ *
+ * The delayed list is changed by tasks and by the timer callback, which
+ * runs in the deferred daemon; a job whose due tick has passed is moved to
+ * a worker list there.
+ */
+
+/* ======================== Worker Lists ================================== */
+
+static void work_push_locked(rtos_worker_t *w, rtos_work_item_t *item)
+{
+    uint8_t prio = item->priority;
+
+    item->next = NULL;
+    if (w->tail[prio] != NULL)
+    {
+        w->tail[prio]->next = item;
+    }
+    else
+    {
+        w->head[prio] = item;
+    }
+    w->tail[prio] = item;
+    w->queued++;
+}
+
+static rtos_work_item_t *work_pop_locked(rtos_worker_t *w, uint8_t prio)
+{
+    rtos_work_item_t *item = w->head[prio];
+
+    if (item != NULL)
+    {
+        w->head[prio] = item->next;
+        if (w->head[prio] == NULL)
+        {
+            w->tail[prio] = NULL;
+        }
+        w->queued--;
+        item->state = RTOS_WORK_IDLE;
+        item->queue = NULL;
+    }
+    return item;
+}
+
+/* An idle worker if any (searched from the cursor), else the least loaded */
+static rtos_worker_t *work_pick_locked(rtos_workqueue_t *wq)
+{
+    rtos_worker_t *best = NULL;
+
+    for (uint8_t k = 0U; k < wq->count; k++)
+    {
+        rtos_worker_t *w = &wq->workers[(wq->cursor + k) % wq->count];
+
+        if (w->idle)
+        {
+            best = w;
+            break;
+        }
+        if (best == NULL || w->queued < best->queued)
+        {
+            best = w;
+        }
+    }
+
+    wq->cursor = (uint8_t) ((wq->cursor + 1U) % wq->count);
+    return best;
+}
+
+/* Link an unqueued item onto a worker; returns the worker task to notify */
+static rtos_task_handle_t work_queue_locked(rtos_workqueue_t *wq, rtos_work_item_t *item, uint8_t prio)
+{
+    rtos_worker_t *w = work_pick_locked(wq);
+
+    item->priority = prio;
+    item->queue    = wq;
+    item->worker   = (uint8_t) (w - wq->workers);
+    item->state    = RTOS_WORK_QUEUED;
+    work_push_locked(w, item);
+    w->idle = false;
+
+    return w->task;
+}
+
+/* Own high, stolen high, own low, stolen low; marks the worker idle if none */
+static rtos_work_item_t *work_take_locked(rtos_worker_t *self, bool *stolen)
+{
+    rtos_workqueue_t *wq    = self->queue;
+    uint8_t           index = (uint8_t) (self - wq->workers);
+
+    for (int prio = RTOS_WORK_PRIO_HIGH; prio >= RTOS_WORK_PRIO_LOW; prio--)
+    {
+        rtos_work_item_t *item = work_pop_locked(self, (uint8_t) prio);
+        if (item != NULL)
+        {
+            *stolen = false;
+            return item;
+        }
+
+#if RTOS_WORKQUEUE_STEALING
+        for (uint8_t k = 1U; k < wq->count; k++)
+        {
+            item = work_pop_locked(&wq->workers[(index + k) % wq->count], (uint8_t) prio);
+            if (item != NULL)
+            {
+                *stolen = true;
+                return item;
+            }
+        }
+#else
+        (void) index;
+#endif
+    }
+
+    self->idle = true;
+    return NULL;
+}
+
+__attribute__((__noreturn__)) static void work_worker_task(void *param)
+{
+    rtos_worker_t *self = (rtos_worker_t *) param;
+
+    for (;;)
+    {
+        bool stolen = false;
+
+        rtos_port_enter_critical();
+        self->idle             = false;
+        rtos_work_item_t *item = work_take_locked(self, &stolen);
+        if (item != NULL)
+        {
+            self->executed++;
+            if (stolen)
+            {
+                self->stolen++;
+            }
+        }
+        rtos_port_exit_critical();
+
+        if (item == NULL)
+        {
+            (void) rtos_task_notify_take(true, RTOS_MAX_DELAY);
+            continue;
+        }
+
+        /* The item is IDLE and unlinked: the job may resubmit or free it */
+        item->function(item);
+    }
+}
+
+/* ======================== Delayed Work ================================== */
+
+#if RTOS_USE_DEFERRED_WORK
+
+static rtos_status_t work_arm_timer(rtos_workqueue_t *wq, rtos_tick_t delay_ticks)
+{
+    rtos_status_t status = rtos_timer_change_period(wq->timer, delay_ticks);
+
+    if (status == RTOS_SUCCESS)
+    {
+        status = rtos_timer_start(wq->timer);
+    }
+    return status;
+}
+
+/* Deferred daemon: move every due job to a worker, re-arm for the next */
+static void work_timer_callback(void *timer_handle, void *param)
+{
+    rtos_workqueue_t *wq  = (rtos_workqueue_t *) param;
+    rtos_tick_t       now = rtos_get_tick_count();
+
+    (void) timer_handle;
+
+    for (;;)
+    {
+        rtos_task_handle_t task = NULL;
+        rtos_tick_t        wait = 0U;
+
+        rtos_port_enter_critical();
+        rtos_work_item_t *item = wq->delayed;
+        if (item != NULL && (int32_t) (item->due - now) <= 0)
+        {
+            wq->delayed = item->next;
+            task        = work_queue_locked(wq, item, item->priority);
+        }
+        else if (item != NULL)
+        {
+            wait = item->due - now;
+        }
+        rtos_port_exit_critical();
+
+        if (task != NULL)
+        {
+            (void) rtos_task_notify_give(task);
+            continue;
+        }
+        if (wait != 0U)
+        {
+            (void) work_arm_timer(wq, wait);
+        }
+        break;
+    }
+}
+
+#endif /* RTOS_USE_DEFERRED_WORK */
+
+/* ======================== Public API ==================================== */
+
+rtos_status_t rtos_workqueue_create(rtos_workqueue_t *wq, uint8_t count, uint32_t *const stacks[],
+                                    rtos_stack_size_t stack_size, rtos_priority_t priority)
+{
+    if (wq == NULL || stacks == NULL || count == 0U || count > RTOS_WORKQUEUE_MAX_WORKERS)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    *wq = (rtos_workqueue_t) {0};
+
+#if RTOS_USE_DEFERRED_WORK
+    rtos_status_t status = rtos_timer_create_static("workq", 1U, RTOS_TIMER_ONE_SHOT, work_timer_callback, wq,
+                                                    &wq->timer_storage, &wq->timer);
+    if (status != RTOS_SUCCESS)
+    {
+        return status;
+    }
+#endif
+
+    for (uint8_t i = 0U; i < count; i++)
+    {
+        wq->workers[i].queue = wq;
+    }
+
+    /* Workers created early may run and look for work on every list */
+    wq->count = count;
+
+    for (uint8_t i = 0U; i < count; i++)
+    {
+        uint8_t flags = RTOS_TASK_FLAG_NONE;
+#if RTOS_SMP_CORES > 1
+        flags = RTOS_TASK_FLAG_CORE(i % RTOS_SMP_CORES);
+#endif
+        rtos_task_handle_t task   = NULL;
+        rtos_status_t      result = rtos_task_create_static(work_worker_task, "worker", stacks[i], stack_size,
+                                                            &wq->workers[i], priority, flags, &task);
+        if (result != RTOS_SUCCESS)
+        {
+            rtos_port_enter_critical();
+            wq->count = i;
+            rtos_port_exit_critical();
+            return result;
+        }
+
+        rtos_port_enter_critical();
+        wq->workers[i].task = task;
+        rtos_port_exit_critical();
+    }
+
+    return RTOS_SUCCESS;
+}
+
+rtos_status_t rtos_work_init(rtos_work_item_t *item, rtos_work_function_t function, void *parameter)
+{
+    if (item == NULL || function == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+    if (item->state == RTOS_WORK_QUEUED || item->state == RTOS_WORK_DELAYED)
+    {
+        return RTOS_ERROR_INVALID_STATE;
+    }
+
+    item->next      = NULL;
+    item->function  = function;
+    item->parameter = parameter;
+    item->queue     = NULL;
+    item->due       = 0U;
+    item->worker    = 0U;
+    item->priority  = RTOS_WORK_PRIO_LOW;
+    item->state     = RTOS_WORK_IDLE;
+
+    return RTOS_SUCCESS;
+}
+
+rtos_status_t rtos_work_submit(rtos_workqueue_t *wq, rtos_work_item_t *item, rtos_work_priority_t priority)
+{
+    if (wq == NULL || item == NULL || item->function == NULL || priority > RTOS_WORK_PRIO_HIGH)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_task_handle_t task = NULL;
+
+    rtos_port_enter_critical();
+    if (item->state == RTOS_WORK_IDLE && wq->count > 0U)
+    {
+        task = work_queue_locked(wq, item, (uint8_t) priority);
+    }
+    rtos_port_exit_critical();
+
+    if (task == NULL)
+    {
+        return RTOS_ERROR_INVALID_STATE;
+    }
+
+    (void) rtos_task_notify_give(task);
+    return RTOS_SUCCESS;
+}
+
+rtos_status_t rtos_work_submit_from_isr(rtos_workqueue_t *wq, rtos_work_item_t *item, rtos_work_priority_t priority,
+                                        bool *higher_priority_task_woken)
+{
+    if (wq == NULL || item == NULL || item->function == NULL || priority > RTOS_WORK_PRIO_HIGH)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_task_handle_t task  = NULL;
+    uint32_t           saved = rtos_port_enter_critical_from_isr();
+    if (item->state == RTOS_WORK_IDLE && wq->count > 0U)
+    {
+        task = work_queue_locked(wq, item, (uint8_t) priority);
+    }
+    rtos_port_exit_critical_from_isr(saved);
+
+    if (task == NULL)
+    {
+        return RTOS_ERROR_INVALID_STATE;
+    }
+
+    (void) rtos_task_notify_give_from_isr(task, higher_priority_task_woken);
+    return RTOS_SUCCESS;
+}
+
+rtos_status_t rtos_work_submit_delayed(rtos_workqueue_t *wq, rtos_work_item_t *item, rtos_work_priority_t priority,
+                                       rtos_tick_t delay_ticks)
+{
+    if (delay_ticks == 0U)
+    {
+        return rtos_work_submit(wq, item, priority);
+    }
+    if (wq == NULL || item == NULL || item->function == NULL || priority > RTOS_WORK_PRIO_HIGH)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+#if !RTOS_USE_DEFERRED_WORK
+    return RTOS_ERROR_INVALID_STATE; /* No timer to move it to a worker */
+#else
+    bool earliest = false;
+
+    rtos_port_enter_critical();
+    if (item->state != RTOS_WORK_IDLE || wq->count == 0U)
+    {
+        rtos_port_exit_critical();
+        return RTOS_ERROR_INVALID_STATE;
+    }
+
+    item->due      = rtos_get_tick_count() + delay_ticks;
+    item->priority = (uint8_t) priority;
+    item->queue    = wq;
+    item->state    = RTOS_WORK_DELAYED;
+
+    /* After every job due no later, so equal due ticks keep their order */
+    rtos_work_item_t **link = &wq->delayed;
+    while (*link != NULL && (int32_t) ((*link)->due - item->due) <= 0)
+    {
+        link = &(*link)->next;
+    }
+    item->next = *link;
+    *link      = item;
+    earliest   = (wq->delayed == item);
+    rtos_port_exit_critical();
+
+    if (!earliest)
+    {
+        return RTOS_SUCCESS; /* The timer is armed for an earlier job */
+    }
+
+    rtos_status_t status = work_arm_timer(wq, delay_ticks);
+    if (status != RTOS_SUCCESS)
+    {
+        (void) rtos_work_cancel(item);
+    }
+    return status;
+#endif
+}
+
+rtos_status_t rtos_work_cancel(rtos_work_item_t *item)
+{
+    if (item == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_status_t status = RTOS_SUCCESS;
+
+    rtos_port_enter_critical();
+
+    rtos_workqueue_t *wq = item->queue;
+    if (item->state == RTOS_WORK_QUEUED)
+    {
+        rtos_worker_t     *w    = &wq->workers[item->worker];
+        rtos_work_item_t **link = &w->head[item->priority];
+        rtos_work_item_t  *prev = NULL;
+
+        while (*link != item)
+        {
+            prev = *link;
+            link = &(*link)->next;
+        }
+        *link = item->next;
+        if (w->tail[item->priority] == item)
+        {
+            w->tail[item->priority] = prev;
+        }
+        w->queued--;
+    }
+    else if (item->state == RTOS_WORK_DELAYED)
+    {
+        /* A timer armed for it finds nothing due and re-arms for the next */
+        rtos_work_item_t **link = &wq->delayed;
+        while (*link != item)
+        {
+            link = &(*link)->next;
+        }
+        *link = item->next;
+    }
+    else
+    {
+        status = RTOS_ERROR_INVALID_STATE;
+    }
+
+    if (status == RTOS_SUCCESS)
+    {
+        item->next  = NULL;
+        item->queue = NULL;
+        item->state = RTOS_WORK_IDLE;
+    }
+
+    rtos_port_exit_critical();
+    return status;
+}
+
+bool rtos_work_is_pending(const rtos_work_item_t *item)
+{
+    return item != NULL && item->state != RTOS_WORK_IDLE;
+}
+
+rtos_status_t rtos_workqueue_get_stats(const rtos_workqueue_t *wq, uint8_t worker, rtos_worker_stats_t *stats)
+{
+    if (wq == NULL || stats == NULL || worker >= wq->count)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_port_enter_critical();
+    stats->executed = wq->workers[worker].executed;
+    stats->stolen   = wq->workers[worker].stolen;
+    stats->queued   = wq->workers[worker].queued;
+    rtos_port_exit_critical();
+
+    return RTOS_SUCCESS;
+}
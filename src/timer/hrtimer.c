@@ -0,0 +1,429 @@
+/*******************************************************************************
+ * File: src/timer/hrtimer.c
+ * Description: Microsecond timers on a hardware output-compare, min-heap ordered
+ ******************************************************************************/
+
+#include "hrtimer.h"
+
+#include "VRTOS.h"
+#include "config.h"
+
+#if RTOS_USE_HRTIMER
+
+#include "deferred.h"
+#include "hardware_env.h"
+#include "kernel_priv.h"
+#include "klog.h"
+#include "rtos_port.h"
+#include "task.h"
+#include "task_priv.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* CMSIS for IPSR */
+#include "device.h" // IWYU pragma: keep
+
+RTOS_STATIC_ASSERT(RTOS_HRTIMER_MAX_TIMERS > 0U && RTOS_HRTIMER_MAX_TIMERS < 255U,
+                   "RTOS_HRTIMER_MAX_TIMERS must fit heap_index");
+
+/* The compare interrupt readies tasks and posts to the daemon */
+RTOS_ASSERT_KERNEL_IRQ_PRIORITY(RTOS_HRTIMER_IRQ_PRIO);
+
+#define HRTIMER_IDLE 0xFFU
+
+/* rtos_delay_us() wake-up: parameter is the task, no callback */
+#define HRTIMER_DISPATCH_WAKE 2U
+
+/*
+ * Armed timers, a binary min-heap on expiry: heap[0] is the next to fire
+ * and is what the compare register holds.  Each timer keeps its own index
+ * so stopping one is O(log n) without a search.  All of it is only touched
+ * inside the kernel critical section; the compare interrupt runs at kernel
+ * priority, so it is excluded the same way.
+ */
+static rtos_hrtimer_t *g_hrtimer_heap[RTOS_HRTIMER_MAX_TIMERS];
+static uint32_t        g_hrtimer_count;
+
+static inline bool hrtimer_before(const rtos_hrtimer_t *a, const rtos_hrtimer_t *b)
+{
+    return (int32_t) (a->expiry - b->expiry) < 0;
+}
+
+static inline void heap_place(rtos_hrtimer_t *timer, uint32_t index)
+{
+    g_hrtimer_heap[index] = timer;
+    timer->heap_index     = (uint8_t) index;
+}
+
+static void heap_sift_up(uint32_t index)
+{
+    rtos_hrtimer_t *timer = g_hrtimer_heap[index];
+
+    while (index > 0U)
+    {
+        uint32_t parent = (index - 1U) / 2U;
+        if (!hrtimer_before(timer, g_hrtimer_heap[parent]))
+        {
+            break;
+        }
+        heap_place(g_hrtimer_heap[parent], index);
+        index = parent;
+    }
+    heap_place(timer, index);
+}
+
+static void heap_sift_down(uint32_t index)
+{
+    rtos_hrtimer_t *timer = g_hrtimer_heap[index];
+
+    for (;;)
+    {
+        uint32_t child = (2U * index) + 1U;
+        if (child >= g_hrtimer_count)
+        {
+            break;
+        }
+        if (child + 1U < g_hrtimer_count && hrtimer_before(g_hrtimer_heap[child + 1U], g_hrtimer_heap[child]))
+        {
+            child++;
+        }
+        if (!hrtimer_before(g_hrtimer_heap[child], timer))
+        {
+            break;
+        }
+        heap_place(g_hrtimer_heap[child], index);
+        index = child;
+    }
+    heap_place(timer, index);
+}
+
+static void heap_remove(rtos_hrtimer_t *timer)
+{
+    uint32_t index = timer->heap_index;
+    uint32_t last  = --g_hrtimer_count;
+
+    timer->heap_index = HRTIMER_IDLE;
+
+    if (index != last)
+    {
+        /* The last entry fills the hole and moves whichever way it belongs */
+        heap_place(g_hrtimer_heap[last], index);
+        if (index > 0U && hrtimer_before(g_hrtimer_heap[index], g_hrtimer_heap[(index - 1U) / 2U]))
+        {
+            heap_sift_up(index);
+        }
+        else
+        {
+            heap_sift_down(index);
+        }
+    }
+}
+
+/* Point the compare at the earliest expiry, or stop it */
+static void hrtimer_program(void)
+{
+    if (g_hrtimer_count == 0U)
+    {
+        hardware_env_hrtimer_stop_compare();
+    }
+    else
+    {
+        hardware_env_hrtimer_set_compare(g_hrtimer_heap[0]->expiry);
+    }
+}
+
+static void hrtimer_disarm_locked(rtos_hrtimer_t *timer)
+{
+    if (timer->heap_index == HRTIMER_IDLE)
+    {
+        return;
+    }
+
+    bool was_first = (timer->heap_index == 0U);
+    heap_remove(timer);
+
+    if (was_first)
+    {
+        hrtimer_program();
+    }
+}
+
+static rtos_status_t hrtimer_arm_locked(rtos_hrtimer_t *timer, uint32_t delay_us, uint32_t period_us)
+{
+    hrtimer_disarm_locked(timer);
+
+    if (g_hrtimer_count >= RTOS_HRTIMER_MAX_TIMERS)
+    {
+        KLOGW(KEVT_HRTIMER_FULL, (uint32_t) (uintptr_t) timer, g_hrtimer_count);
+        return RTOS_ERROR_FULL;
+    }
+
+    timer->expiry = hardware_env_hrtimer_now() + delay_us;
+    timer->period = period_us;
+
+    heap_place(timer, g_hrtimer_count++);
+    heap_sift_up(timer->heap_index);
+
+    if (timer->heap_index == 0U)
+    {
+        hrtimer_program();
+    }
+    return RTOS_SUCCESS;
+}
+
+static bool hrtimer_valid_times(uint32_t delay_us, uint32_t period_us)
+{
+    return delay_us != 0U && delay_us <= RTOS_HRTIMER_MAX_DELAY_US && period_us <= RTOS_HRTIMER_MAX_DELAY_US;
+}
+
+#if RTOS_USE_DEFERRED_WORK
+static void hrtimer_daemon_run(void *parameter)
+{
+    rtos_hrtimer_t *timer = (rtos_hrtimer_t *) parameter;
+
+    timer->callback(timer, timer->parameter);
+}
+#endif
+
+/* Run an expired timer's callback here, or post it to the daemon (critical section dropped) */
+static void hrtimer_dispatch(rtos_hrtimer_t *timer, bool *woken)
+{
+#if RTOS_USE_DEFERRED_WORK
+    if (timer->dispatch == RTOS_HRTIMER_DISPATCH_DAEMON)
+    {
+        (void) rtos_deferred_post_from_isr(hrtimer_daemon_run, timer, woken);
+        return;
+    }
+#else
+    (void) woken;
+#endif
+    timer->callback(timer, timer->parameter);
+}
+
+void rtos_hrtimer_init_system(void)
+{
+    g_hrtimer_count = 0;
+    hardware_env_hrtimer_init();
+}
+
+rtos_status_t rtos_hrtimer_init(rtos_hrtimer_t *timer, rtos_hrtimer_callback_t callback, void *parameter,
+                                rtos_hrtimer_dispatch_t dispatch)
+{
+    if (timer == NULL || callback == NULL ||
+        (dispatch != RTOS_HRTIMER_DISPATCH_ISR && dispatch != RTOS_HRTIMER_DISPATCH_DAEMON))
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+#if !RTOS_USE_DEFERRED_WORK
+    if (dispatch == RTOS_HRTIMER_DISPATCH_DAEMON)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+#endif
+
+    timer->expiry     = 0;
+    timer->period     = 0;
+    timer->callback   = callback;
+    timer->parameter  = parameter;
+    timer->overruns   = 0;
+    timer->heap_index = HRTIMER_IDLE;
+    timer->dispatch   = (uint8_t) dispatch;
+
+    return RTOS_SUCCESS;
+}
+
+rtos_status_t rtos_hrtimer_start(rtos_hrtimer_t *timer, uint32_t delay_us, uint32_t period_us)
+{
+    if (timer == NULL || !hrtimer_valid_times(delay_us, period_us))
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_port_enter_critical();
+    rtos_status_t status = hrtimer_arm_locked(timer, delay_us, period_us);
+    rtos_port_exit_critical();
+
+    return status;
+}
+
+rtos_status_t rtos_hrtimer_start_from_isr(rtos_hrtimer_t *timer, uint32_t delay_us, uint32_t period_us)
+{
+    if (timer == NULL || !hrtimer_valid_times(delay_us, period_us))
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    uint32_t      saved  = rtos_port_enter_critical_from_isr();
+    rtos_status_t status = hrtimer_arm_locked(timer, delay_us, period_us);
+    rtos_port_exit_critical_from_isr(saved);
+
+    return status;
+}
+
+rtos_status_t rtos_hrtimer_stop(rtos_hrtimer_t *timer)
+{
+    if (timer == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_port_enter_critical();
+    hrtimer_disarm_locked(timer);
+    rtos_port_exit_critical();
+
+    return RTOS_SUCCESS;
+}
+
+rtos_status_t rtos_hrtimer_stop_from_isr(rtos_hrtimer_t *timer)
+{
+    if (timer == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    uint32_t saved = rtos_port_enter_critical_from_isr();
+    hrtimer_disarm_locked(timer);
+    rtos_port_exit_critical_from_isr(saved);
+
+    return RTOS_SUCCESS;
+}
+
+bool rtos_hrtimer_is_active(const rtos_hrtimer_t *timer)
+{
+    return timer != NULL && timer->heap_index != HRTIMER_IDLE;
+}
+
+uint32_t rtos_hrtimer_now(void)
+{
+    return hardware_env_hrtimer_now();
+}
+
+/* Deletion of a task blocked in rtos_delay_us(): its timer lives on that task's stack */
+void rtos_hrtimer_remove_task_from_wait(void *timer_ptr, rtos_tcb_t *task)
+{
+    hrtimer_disarm_locked((rtos_hrtimer_t *) timer_ptr);
+
+    task->blocked_on      = NULL;
+    task->blocked_on_type = RTOS_SYNC_TYPE_NONE;
+}
+
+/*
+ * Pops every timer whose expiry the counter has reached, re-arms periodic
+ * ones a period on, and runs or posts its callback with the critical
+ * section dropped, so callbacks may re-arm timers.  The counter is read
+ * again after each callback, so a timer that fell due meanwhile fires in
+ * the same interrupt instead of waiting for the compare to catch up.
+ */
+void rtos_hrtimer_isr(void)
+{
+    bool     woken = false;
+    uint32_t saved = rtos_port_enter_critical_from_isr();
+    uint32_t now   = hardware_env_hrtimer_now();
+
+    while (g_hrtimer_count > 0U && (int32_t) (g_hrtimer_heap[0]->expiry - now) <= 0)
+    {
+        rtos_hrtimer_t *timer = g_hrtimer_heap[0];
+        heap_remove(timer);
+
+        if (timer->period != 0U)
+        {
+            timer->expiry += timer->period;
+            if ((int32_t) (timer->expiry - now) <= 0)
+            {
+                timer->overruns++;
+                timer->expiry = now + timer->period;
+                KLOGW(KEVT_HRTIMER_OVERRUN, (uint32_t) (uintptr_t) timer, timer->overruns);
+            }
+            heap_place(timer, g_hrtimer_count++);
+            heap_sift_up(timer->heap_index);
+        }
+
+        if (timer->dispatch == HRTIMER_DISPATCH_WAKE)
+        {
+            /* Still waiting unless it was resumed meanwhile; the timer is on its stack */
+            rtos_tcb_t *task = (rtos_tcb_t *) timer->parameter;
+            if (task->blocked_on != timer)
+            {
+                task = NULL;
+            }
+            else
+            {
+                task->blocked_on      = NULL;
+                task->blocked_on_type = RTOS_SYNC_TYPE_NONE;
+            }
+            rtos_port_exit_critical_from_isr(saved);
+
+            /* Unblock outside ISR critical section */
+            if (rtos_kernel_task_unblock_from_isr(task))
+            {
+                woken = true;
+            }
+        }
+        else
+        {
+            rtos_port_exit_critical_from_isr(saved);
+            hrtimer_dispatch(timer, &woken);
+        }
+
+        saved = rtos_port_enter_critical_from_isr();
+        now   = hardware_env_hrtimer_now();
+    }
+
+    hrtimer_program();
+    rtos_port_exit_critical_from_isr(saved);
+
+    if (woken)
+    {
+        rtos_port_yield();
+    }
+}
+
+rtos_status_t rtos_delay_us(uint32_t us)
+{
+    if (us == 0U)
+    {
+        return RTOS_SUCCESS;
+    }
+    if (us > RTOS_HRTIMER_MAX_DELAY_US)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_tcb_t *current_task = rtos_task_get_current();
+    if (current_task == NULL || __get_IPSR() != 0U)
+    {
+        return RTOS_ERROR_INVALID_STATE;
+    }
+
+    rtos_hrtimer_t wake = {
+        .callback   = NULL,
+        .parameter  = current_task,
+        .heap_index = HRTIMER_IDLE,
+        .dispatch   = HRTIMER_DISPATCH_WAKE,
+    };
+
+    rtos_port_enter_critical();
+
+    rtos_status_t status = hrtimer_arm_locked(&wake, us, 0);
+    if (status != RTOS_SUCCESS)
+    {
+        rtos_port_exit_critical();
+        return status;
+    }
+
+    rtos_kernel_block_on(&wake, RTOS_SYNC_TYPE_HRTIMER, NULL, RTOS_MAX_DELAY);
+
+    /* --- Task resumes here after the compare interrupt, or a resume --- */
+
+    if (current_task->blocked_on == &wake)
+    {
+        rtos_hrtimer_remove_task_from_wait(&wake, current_task);
+    }
+
+    rtos_port_exit_critical();
+
+    return RTOS_SUCCESS;
+}
+
+#endif /* RTOS_USE_HRTIMER */
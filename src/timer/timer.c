@@ -1,13 +1,49 @@
 #include "timer.h"
 
 #include "VRTOS.h"
+#include "deferred.h"
+#include "kernel_priv.h"
 #include "klog.h"
 #include "memory.h"
+#include "rtos_assert.h"
 #include "rtos_port.h"
 #include "timer_priv.h"
 
 #include <stddef.h>
 
+RTOS_STATIC_ASSERT(sizeof(rtos_timer_static_t) >= sizeof(rtos_timer_t) &&
+                       _Alignof(rtos_timer_static_t) >= _Alignof(rtos_timer_t),
+                   "RTOS_TIMER_STATIC_WORDS too small for rtos_timer_t");
+
+static void timer_init(rtos_timer_t *timer, const char *name, rtos_tick_t period_ticks, rtos_timer_mode_t mode,
+                       rtos_timer_callback_t callback, void *parameter, bool is_static)
+{
+    timer->name        = name;
+    timer->period      = period_ticks;
+    timer->deadline    = 0;
+    timer->expiry_time = 0;
+    timer->slack       = 0;
+    timer->mode        = mode;
+    timer->callback    = callback;
+    timer->parameter   = parameter;
+    timer->active      = false;
+    timer->is_static   = is_static;
+    timer->next        = NULL;
+
+#if RTOS_USE_DEFERRED_WORK
+    timer->command_tick = 0;
+#endif
+
+#if RTOS_USE_TIMING_WHEEL
+    timer->wheel_node.next   = NULL;
+    timer->wheel_node.prev   = NULL;
+    timer->wheel_node.slot   = NULL;
+    timer->wheel_node.expiry = 0;
+#endif
+
+    KLOGI(KEVT_TIMER_CREATE, (uint32_t) period_ticks, 0);
+}
+
 rtos_status_t rtos_timer_create(const char *name, rtos_tick_t period_ticks, rtos_timer_mode_t mode,
                                 rtos_timer_callback_t callback, void *parameter, rtos_timer_handle_t *timer_handle)
 {
@@ -23,21 +59,172 @@ rtos_status_t rtos_timer_create(const char *name, rtos_tick_t period_ticks, rtos
         return RTOS_ERROR_NO_MEMORY;
     }
 
-    timer->name        = name;
-    timer->period      = period_ticks;
-    timer->expiry_time = 0;
-    timer->mode        = mode;
-    timer->callback    = callback;
-    timer->parameter   = parameter;
-    timer->active      = false;
-    timer->next        = NULL;
+    timer_init(timer, name, period_ticks, mode, callback, parameter, false);
+    *timer_handle = timer;
+
+    return RTOS_SUCCESS;
+}
+
+rtos_status_t rtos_timer_create_static(const char *name, rtos_tick_t period_ticks, rtos_timer_mode_t mode,
+                                       rtos_timer_callback_t callback, void *parameter,
+                                       rtos_timer_static_t *timer_buffer, rtos_timer_handle_t *timer_handle)
+{
+    if (timer_handle == NULL || timer_buffer == NULL || callback == NULL || period_ticks == 0)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_timer_t *timer = (rtos_timer_t *) timer_buffer;
 
+    timer_init(timer, name, period_ticks, mode, callback, parameter, true);
     *timer_handle = timer;
-    KLOGI(KEVT_TIMER_CREATE, (uint32_t) period_ticks, 0);
 
     return RTOS_SUCCESS;
 }
 
+rtos_status_t rtos_timer_set_slack(rtos_timer_handle_t timer_handle, rtos_tick_t slack_ticks)
+{
+    if (timer_handle == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    /* Single word store, read when the timer is next armed */
+    timer_handle->slack = slack_ticks;
+    return RTOS_SUCCESS;
+}
+
+#if RTOS_USE_DEFERRED_WORK
+
+/*
+ * Command queue.  With the deferred daemon the active set is only changed
+ * by the daemon: the API records the call tick in the timer and posts a
+ * command through the deferred queue, so callers never mask interrupts.
+ * Commands run in posting order; the daemon preempts a lower-priority
+ * caller, so they normally apply before the call returns.  Two commands on
+ * one timer still in flight share the later call tick.
+ */
+
+/* (Re)start from the call tick; also the tail of change_period */
+static void timer_arm_from(rtos_timer_t *timer, rtos_tick_t base_tick)
+{
+    uint32_t saved_priority = rtos_port_enter_critical_from_isr();
+
+    if (timer->active)
+    {
+        timer_remove_active_list(timer);
+    }
+
+    timer->deadline = base_tick + timer->period;
+    timer->active   = true;
+    timer_insert_active_list(timer);
+
+    rtos_port_exit_critical_from_isr(saved_priority);
+}
+
+static void timer_disarm(rtos_timer_t *timer)
+{
+    uint32_t saved_priority = rtos_port_enter_critical_from_isr();
+
+    if (timer->active)
+    {
+        timer_remove_active_list(timer);
+        timer->active = false;
+    }
+
+    rtos_port_exit_critical_from_isr(saved_priority);
+}
+
+static void timer_cmd_start(void *parameter)
+{
+    rtos_timer_t *timer = (rtos_timer_t *) parameter;
+
+    timer_arm_from(timer, timer->command_tick);
+    KLOGD(KEVT_TIMER_START, (uint32_t) timer->expiry_time, 0);
+}
+
+static void timer_cmd_stop(void *parameter)
+{
+    timer_disarm((rtos_timer_t *) parameter);
+}
+
+static void timer_cmd_restart_if_active(void *parameter)
+{
+    rtos_timer_t *timer = (rtos_timer_t *) parameter;
+
+    if (timer->active)
+    {
+        timer_arm_from(timer, timer->command_tick);
+    }
+}
+
+static void timer_cmd_delete(void *parameter)
+{
+    rtos_timer_t *timer = (rtos_timer_t *) parameter;
+
+    timer_disarm(timer);
+    if (!timer->is_static)
+    {
+        rtos_free(timer);
+    }
+}
+
+static rtos_status_t timer_post_command(rtos_timer_t *timer, rtos_deferred_fn_t command)
+{
+    timer->command_tick = rtos_get_tick_count();
+    return rtos_deferred_post_any(command, timer);
+}
+
+rtos_status_t rtos_timer_start(rtos_timer_handle_t timer_handle)
+{
+    if (timer_handle == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    return timer_post_command((rtos_timer_t *) timer_handle, timer_cmd_start);
+}
+
+rtos_status_t rtos_timer_stop(rtos_timer_handle_t timer_handle)
+{
+    if (timer_handle == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    KLOGD(KEVT_TIMER_STOP, 0, 0);
+    return timer_post_command((rtos_timer_t *) timer_handle, timer_cmd_stop);
+}
+
+rtos_status_t rtos_timer_change_period(rtos_timer_handle_t timer_handle, rtos_tick_t new_period_ticks)
+{
+    if (timer_handle == NULL || new_period_ticks == 0)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    rtos_timer_t *timer = (rtos_timer_t *) timer_handle;
+
+    /* Single word store; the daemon reads it when it next arms the timer */
+    timer->period = new_period_ticks;
+
+    KLOGD(KEVT_TIMER_PERIOD_CHANGE, (uint32_t) new_period_ticks, 0);
+    return timer_post_command(timer, timer_cmd_restart_if_active);
+}
+
+rtos_status_t rtos_timer_delete(rtos_timer_handle_t timer_handle)
+{
+    if (timer_handle == NULL)
+    {
+        return RTOS_ERROR_INVALID_PARAM;
+    }
+
+    /* Freed by the daemon after any command still queued for this timer */
+    return timer_post_command((rtos_timer_t *) timer_handle, timer_cmd_delete);
+}
+
+#else
+
 rtos_status_t rtos_timer_start(rtos_timer_handle_t timer_handle)
 {
     if (timer_handle == NULL)
@@ -57,7 +244,7 @@ rtos_status_t rtos_timer_start(rtos_timer_handle_t timer_handle)
 
     /* Set expiration */
     rtos_tick_t current_tick = rtos_get_tick_count();
-    timer->expiry_time       = current_tick + timer->period;
+    timer->deadline          = current_tick + timer->period;
 
     /**
      * Note: Tick wraparound is handled correctly by signed comparison in
@@ -120,7 +307,7 @@ rtos_status_t rtos_timer_change_period(rtos_timer_handle_t timer_handle, rtos_ti
         timer_remove_active_list(timer);
 
         rtos_tick_t current_tick = rtos_get_tick_count();
-        timer->expiry_time       = current_tick + timer->period;
+        timer->deadline          = current_tick + timer->period;
 
         timer_insert_active_list(timer);
     }
@@ -138,7 +325,12 @@ rtos_status_t rtos_timer_delete(rtos_timer_handle_t timer_handle)
     }
 
     rtos_timer_stop(timer_handle);
-    rtos_free(timer_handle);
+    if (!timer_handle->is_static)
+    {
+        rtos_free(timer_handle);
+    }
 
     return RTOS_SUCCESS;
 }
+
+#endif /* RTOS_USE_DEFERRED_WORK */
@@ -1,4 +1,5 @@
 #include "VRTOS.h"
+#include "kernel_priv.h"
 #include "rtos_port.h"
 #include "timer.h"
 #include "timer_priv.h"
@@ -8,6 +9,89 @@
 /* Global list head */
 rtos_timer_t *g_active_timers = NULL;
 
+#if RTOS_USE_DEFERRED_WORK
+
+/*
+ * Earliest expiry SysTick watches, so it can spot a due timer in constant
+ * time with either backend.  Inserts only move it earlier; a stop leaves it
+ * early, which costs one spurious daemon wakeup that recomputes it.
+ */
+static volatile bool        g_timer_due_armed = false;
+static volatile rtos_tick_t g_timer_due_tick  = 0;
+
+static void timer_arm_due(rtos_tick_t expiry)
+{
+    if (!g_timer_due_armed || (int32_t) (expiry - g_timer_due_tick) < 0)
+    {
+        g_timer_due_tick  = expiry;
+        g_timer_due_armed = true;
+    }
+}
+
+#else
+
+static inline void timer_arm_due(rtos_tick_t expiry)
+{
+    (void) expiry;
+}
+
+#endif /* RTOS_USE_DEFERRED_WORK */
+
+/* Slack usable now: an auto-reload timer must still fire before its next deadline */
+static rtos_tick_t timer_slack(const rtos_timer_t *timer)
+{
+    if (timer->mode == RTOS_TIMER_AUTO_RELOAD && timer->slack >= timer->period)
+    {
+        return timer->period - 1U;
+    }
+    return timer->slack;
+}
+
+#if RTOS_USE_TIMING_WHEEL
+
+/* Wheel of active timers (zero-initialised: empty, starting at tick 0) */
+timer_wheel_t g_timer_wheel;
+
+void timer_insert_active_list(rtos_timer_t *timer)
+{
+    rtos_tick_t slack = timer_slack(timer);
+    rtos_tick_t batch = 0;
+
+    timer->expiry_time = timer->deadline;
+    if (slack != 0U && timer_wheel_find_expiry(&g_timer_wheel, timer->deadline, slack, &batch))
+    {
+        timer->expiry_time = batch;
+    }
+
+    timer_wheel_insert(&g_timer_wheel, &timer->wheel_node, timer->expiry_time);
+    timer_arm_due(timer->expiry_time);
+}
+
+void timer_remove_active_list(rtos_timer_t *timer)
+{
+    if (timer == NULL)
+    {
+        return;
+    }
+
+    timer_wheel_remove(&g_timer_wheel, &timer->wheel_node);
+}
+
+bool timer_get_next_expiry(rtos_tick_t *expiry)
+{
+    return timer_wheel_next_expiry(&g_timer_wheel, expiry);
+}
+
+/* Pop the next due timer; timer_run_expired() holds the critical section */
+static rtos_timer_t *timer_pop_expired(rtos_tick_t current_tick)
+{
+    timer_wheel_node_t *node = timer_wheel_pop_expired(&g_timer_wheel, current_tick);
+
+    return (node != NULL) ? TIMER_WHEEL_ENTRY(node, rtos_timer_t, wheel_node) : NULL;
+}
+
+#else
+
 /**
  * Helper to comparison time with wraparound handling
  * Returns true if t1 is "before" t2
@@ -19,36 +103,32 @@ static bool time_before(rtos_tick_t t1, rtos_tick_t t2)
 
 void timer_insert_active_list(rtos_timer_t *timer)
 {
-    if (g_active_timers == NULL)
+    rtos_timer_t **link = &g_active_timers;
+
+    /* Skip timers that fire before the deadline */
+    while (*link != NULL && time_before((*link)->expiry_time, timer->deadline))
     {
-        g_active_timers = timer;
-        timer->next     = NULL;
-        return;
+        link = &(*link)->next;
     }
 
-    /* Check if we should be at head */
-    if (time_before(timer->expiry_time, g_active_timers->expiry_time))
+    /* The list is sorted, so the first expiry inside the slack window is the earliest one */
+    rtos_tick_t slack  = timer_slack(timer);
+    timer->expiry_time = timer->deadline;
+    if (*link != NULL && (rtos_tick_t) ((*link)->expiry_time - timer->deadline) <= slack)
     {
-        timer->next     = g_active_timers;
-        g_active_timers = timer;
-        return;
+        timer->expiry_time = (*link)->expiry_time;
     }
 
-    /* Find insertion point */
-    rtos_timer_t *current = g_active_timers;
-    while (current->next != NULL)
+    /* Insert after timers with the same expiry */
+    while (*link != NULL && !time_before(timer->expiry_time, (*link)->expiry_time))
     {
-        if (time_before(timer->expiry_time, current->next->expiry_time))
-        {
-            /* Insert before next */
-            break;
-        }
-        current = current->next;
+        link = &(*link)->next;
     }
 
-    /* Insert after current */
-    timer->next   = current->next;
-    current->next = timer;
+    timer->next = *link;
+    *link       = timer;
+
+    timer_arm_due(timer->expiry_time);
 }
 
 void timer_remove_active_list(rtos_timer_t *timer)
@@ -78,72 +158,121 @@ void timer_remove_active_list(rtos_timer_t *timer)
     }
 }
 
-/* Called from SysTick ISR — uses ISR-safe critical sections. */
-void rtos_timer_tick(void)
+bool timer_get_next_expiry(rtos_tick_t *expiry)
 {
-    uint32_t saved_priority = rtos_port_enter_critical_from_isr();
-
-    if (g_active_timers == NULL)
+    if (g_active_timers == NULL || expiry == NULL)
     {
-        rtos_port_exit_critical_from_isr(saved_priority);
-        return;
+        return false;
     }
 
-    rtos_tick_t current_tick = rtos_get_tick_count();
+    *expiry = g_active_timers->expiry_time;
+    return true;
+}
+
+/* Pop the head timer if it has expired (list is sorted by expiry) */
+static rtos_timer_t *timer_pop_expired(rtos_tick_t current_tick)
+{
+    rtos_timer_t *expired = g_active_timers;
 
-    /* Process all expired timers */
-    /* Note: Since list is sorted, we just check head until not expired */
-    while (g_active_timers != NULL)
+    /* Check if expired (expiry <= current) using signed comparison for wraparound */
+    if (expired == NULL || (int32_t) (expired->expiry_time - current_tick) > 0)
     {
-        /* Check if expired (expiry <= current) using signed comparison for wraparound */
-        if ((int32_t) (g_active_timers->expiry_time - current_tick) <= 0)
-        {
-            rtos_timer_t *expired = g_active_timers;
+        return NULL;
+    }
 
-            /* Remove from list */
-            g_active_timers = expired->next;
-            expired->next   = NULL; /* Detach */
+    g_active_timers = expired->next;
+    expired->next   = NULL; /* Detach */
 
-            /* Execute callback outside critical section for reduced latency */
-            rtos_port_exit_critical_from_isr(saved_priority);
+    return expired;
+}
 
-            if (expired->callback != NULL)
-            {
-                expired->callback((void *) expired, expired->parameter);
-            }
+#endif /* RTOS_USE_TIMING_WHEEL */
+
+/*
+ * Run every due callback and re-arm auto-reload timers.  Uses the ISR-safe
+ * critical section (BASEPRI save/restore), which is also valid in a task.
+ */
+static void timer_run_expired(void)
+{
+    uint32_t saved_priority = rtos_port_enter_critical_from_isr();
 
-            /* Re-enter critical section for list manipulation */
-            saved_priority = rtos_port_enter_critical_from_isr();
+    rtos_tick_t   current_tick = rtos_get_tick_count();
+    rtos_timer_t *expired;
 
-            /* Handle Auto-Reload */
-            if (expired->mode == RTOS_TIMER_AUTO_RELOAD)
-            {
-                /**
-                 * Calculate next expiry using expiry_time + period to avoid drift.
-                 * If callback took longer than one period, catch up by advancing
-                 * expiry_time until it's in the future to prevent repeated fires.
-                 */
-                rtos_tick_t now = rtos_get_tick_count();
-                do
-                {
-                    expired->expiry_time += expired->period;
-                } while ((int32_t) (expired->expiry_time - now) <= 0);
-
-                /* Re-insert into sorted active list */
-                timer_insert_active_list(expired);
-            }
-            else
+    /* Process all expired timers; each backend only looks at due entries
+     * (head of the sorted list, or the current wheel slot). */
+    while ((expired = timer_pop_expired(current_tick)) != NULL)
+    {
+        /* Execute callback outside critical section for reduced latency */
+        rtos_port_exit_critical_from_isr(saved_priority);
+
+        if (expired->callback != NULL)
+        {
+            expired->callback((void *) expired, expired->parameter);
+        }
+
+        /* Re-enter critical section for list manipulation */
+        saved_priority = rtos_port_enter_critical_from_isr();
+
+        /* Handle Auto-Reload */
+        if (expired->mode == RTOS_TIMER_AUTO_RELOAD)
+        {
+            /**
+             * Calculate next expiry using deadline + period to avoid drift
+             * (also from slack: a batched expiry only delays this firing).
+             * If callback took longer than one period, catch up by advancing
+             * deadline until it's in the future to prevent repeated fires.
+             */
+            rtos_tick_t now = rtos_get_tick_count();
+            do
             {
-                /* One-shot: mark inactive */
-                expired->active = false;
-            }
+                expired->deadline += expired->period;
+            } while ((int32_t) (expired->deadline - now) <= 0);
+
+            /* Re-insert into sorted active list */
+            timer_insert_active_list(expired);
         }
         else
         {
-            /* Head not expired, so nothing else is (sorted list) */
-            break;
+            /* One-shot: mark inactive */
+            expired->active = false;
+        }
+    }
+
+    rtos_port_exit_critical_from_isr(saved_priority);
+}
+
+/* Called from SysTick ISR */
+void rtos_timer_tick(void)
+{
+#if RTOS_USE_DEFERRED_WORK
+    /* Constant time however many timers are due: the daemon runs them */
+    if (g_timer_due_armed && (int32_t) (rtos_get_tick_count() - g_timer_due_tick) >= 0)
+    {
+        if (rtos_deferred_wake_from_isr())
+        {
+            rtos_port_yield();
         }
     }
+#else
+    timer_run_expired();
+#endif
+}
+
+#if RTOS_USE_DEFERRED_WORK
+
+void timer_service_expired(void)
+{
+    timer_run_expired();
+
+    uint32_t    saved_priority = rtos_port_enter_critical_from_isr();
+    rtos_tick_t next           = 0;
+
+    /* Recompute from the active set, dropping the estimate left by stops */
+    g_timer_due_armed = timer_get_next_expiry(&next);
+    g_timer_due_tick  = next;
 
     rtos_port_exit_critical_from_isr(saved_priority);
 }
+
+#endif /* RTOS_USE_DEFERRED_WORK */
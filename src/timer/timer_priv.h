@@ -1,7 +1,9 @@
 #ifndef TIMER_PRIV_H
 #define TIMER_PRIV_H
 
+#include "config.h"
 #include "timer.h"
+#include "timer_wheel.h"
 
 #include <stdbool.h>
 
@@ -11,22 +13,43 @@ struct rtos_timer
 {
     const char           *name;
     rtos_tick_t           period;
-    rtos_tick_t           expiry_time; /* Absolute tick count for next expiry */
+    rtos_tick_t           deadline;    /* Nominal expiry: start + period, then + period each reload */
+    rtos_tick_t           expiry_time; /* Absolute tick it fires at: deadline, or a batch within slack */
+    rtos_tick_t           slack;       /* Ticks it may fire late to share an expiry (rtos_timer_set_slack) */
     rtos_timer_mode_t     mode;
     rtos_timer_callback_t callback;
     void                 *parameter;
     bool                  active;
+    bool                  is_static; /* Storage belongs to the caller (create_static) */
 
     struct rtos_timer *next; /* Next timer in active list */
+
+#if RTOS_USE_DEFERRED_WORK
+    rtos_tick_t command_tick; /* Tick of the latest start/change_period call */
+#endif
+
+#if RTOS_USE_TIMING_WHEEL
+    timer_wheel_node_t wheel_node; /* Link into g_timer_wheel */
+#endif
 };
 
-/* Global pointer to the list of active timers (sorted by expiry) */
+/* Global pointer to the list of active timers (sorted by expiry).
+ * Stays NULL when RTOS_USE_TIMING_WHEEL is enabled; see g_timer_wheel. */
 extern rtos_timer_t *g_active_timers;
 
-/* Internal helper to insert into sorted list */
+/* Internal helper to insert into sorted list (or file into the wheel); sets
+ * expiry_time from deadline, coalesced with an earlier-armed timer within slack */
 void timer_insert_active_list(rtos_timer_t *timer);
 
 /* Internal helper to remove from active list */
 void timer_remove_active_list(rtos_timer_t *timer);
 
+/* Earliest active expiry tick; false if no timer is active (tickless idle) */
+bool timer_get_next_expiry(rtos_tick_t *expiry);
+
+#if RTOS_USE_DEFERRED_WORK
+/* Deferred daemon: run due callbacks and re-arm the SysTick due check */
+void timer_service_expired(void);
+#endif
+
 #endif /* TIMER_PRIV_H */
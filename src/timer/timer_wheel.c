@@ -0,0 +1,281 @@
+#include "timer_wheel.h"
+
+#if RTOS_USE_TIMING_WHEEL
+
+#include <string.h>
+
+/* Ticks covered by levels [0, level] */
+#define WHEEL_LEVEL_SPAN(level) (1UL << (RTOS_TIMING_WHEEL_SLOT_BITS * ((level) + 1U)))
+#define WHEEL_TOTAL_SPAN        WHEEL_LEVEL_SPAN(RTOS_TIMING_WHEEL_LEVELS - 1U)
+
+static void wheel_slot_append(timer_wheel_node_t **slot, timer_wheel_node_t *node)
+{
+    if (*slot == NULL)
+    {
+        node->next = node;
+        node->prev = node;
+        *slot      = node;
+    }
+    else
+    {
+        timer_wheel_node_t *head = *slot;
+        timer_wheel_node_t *tail = head->prev;
+
+        node->next = head;
+        node->prev = tail;
+        tail->next = node;
+        head->prev = node;
+    }
+
+    node->slot = slot;
+}
+
+static void wheel_slot_unlink(timer_wheel_node_t *node)
+{
+    timer_wheel_node_t **slot = node->slot;
+
+    if (node->next == node)
+    {
+        *slot = NULL;
+    }
+    else
+    {
+        node->prev->next = node->next;
+        node->next->prev = node->prev;
+
+        if (*slot == node)
+        {
+            *slot = node->next;
+        }
+    }
+
+    node->next = NULL;
+    node->prev = NULL;
+    node->slot = NULL;
+}
+
+static timer_wheel_node_t **wheel_select_slot(timer_wheel_t *wheel, rtos_tick_t expiry)
+{
+    int32_t delta = (int32_t) (expiry - wheel->now);
+
+    if (delta <= 0)
+    {
+        return &wheel->slots[0][wheel->now & RTOS_TIMING_WHEEL_MASK];
+    }
+
+    for (uint32_t level = 0; level < RTOS_TIMING_WHEEL_LEVELS; level++)
+    {
+        if ((uint32_t) delta < WHEEL_LEVEL_SPAN(level))
+        {
+            uint32_t index = (expiry >> (RTOS_TIMING_WHEEL_SLOT_BITS * level)) & RTOS_TIMING_WHEEL_MASK;
+            return &wheel->slots[level][index];
+        }
+    }
+
+    /* Beyond the wheel span: park at the far edge of the top level.
+     * The real expiry is kept in the node and re-evaluated on cascade. */
+    rtos_tick_t parked = wheel->now + (rtos_tick_t) (WHEEL_TOTAL_SPAN - 1U);
+    uint32_t    top    = RTOS_TIMING_WHEEL_LEVELS - 1U;
+    uint32_t    index  = (parked >> (RTOS_TIMING_WHEEL_SLOT_BITS * top)) & RTOS_TIMING_WHEEL_MASK;
+
+    return &wheel->slots[top][index];
+}
+
+/* Re-file every entry of one higher-level slot relative to wheel->now */
+static void wheel_cascade(timer_wheel_t *wheel, uint32_t level, uint32_t index)
+{
+    timer_wheel_node_t *node = wheel->slots[level][index];
+
+    wheel->slots[level][index] = NULL;
+
+    while (node != NULL)
+    {
+        timer_wheel_node_t *next = (node->next == node) ? NULL : node->next;
+
+        /* Slot head was cleared above; detach by hand so the walk stays valid */
+        node->prev->next = node->next;
+        node->next->prev = node->prev;
+
+        wheel_slot_append(wheel_select_slot(wheel, node->expiry), node);
+        node = next;
+    }
+}
+
+void timer_wheel_init(timer_wheel_t *wheel, rtos_tick_t now)
+{
+    if (wheel == NULL)
+    {
+        return;
+    }
+
+    memset(wheel->slots, 0, sizeof(wheel->slots));
+    wheel->now   = now;
+    wheel->count = 0;
+}
+
+void timer_wheel_insert(timer_wheel_t *wheel, timer_wheel_node_t *node, rtos_tick_t expiry)
+{
+    if (wheel == NULL || node == NULL)
+    {
+        return;
+    }
+
+    if (node->slot != NULL)
+    {
+        timer_wheel_remove(wheel, node);
+    }
+
+    node->expiry = expiry;
+    wheel_slot_append(wheel_select_slot(wheel, expiry), node);
+    wheel->count++;
+}
+
+void timer_wheel_remove(timer_wheel_t *wheel, timer_wheel_node_t *node)
+{
+    if (wheel == NULL || node == NULL || node->slot == NULL)
+    {
+        return;
+    }
+
+    wheel_slot_unlink(node);
+    wheel->count--;
+}
+
+timer_wheel_node_t *timer_wheel_pop_expired(timer_wheel_t *wheel, rtos_tick_t now)
+{
+    if (wheel == NULL)
+    {
+        return NULL;
+    }
+
+    while (1)
+    {
+        /* Every entry in the current level-0 slot is due at wheel->now */
+        timer_wheel_node_t *head = wheel->slots[0][wheel->now & RTOS_TIMING_WHEEL_MASK];
+        if (head != NULL)
+        {
+            wheel_slot_unlink(head);
+            wheel->count--;
+            return head;
+        }
+
+        if ((int32_t) (now - wheel->now) <= 0)
+        {
+            return NULL;
+        }
+
+        wheel->now++;
+
+        if (wheel->count == 0)
+        {
+            /* Nothing filed: skip straight to now, no slot can be populated */
+            wheel->now = now;
+            continue;
+        }
+
+        /* Crossing a level boundary cascades the next slot of each level above */
+        uint32_t index = wheel->now & RTOS_TIMING_WHEEL_MASK;
+        for (uint32_t level = 1; level < RTOS_TIMING_WHEEL_LEVELS && index == 0; level++)
+        {
+            index = (wheel->now >> (RTOS_TIMING_WHEEL_SLOT_BITS * level)) & RTOS_TIMING_WHEEL_MASK;
+            wheel_cascade(wheel, level, index);
+        }
+    }
+}
+
+bool timer_wheel_next_expiry(const timer_wheel_t *wheel, rtos_tick_t *expiry)
+{
+    if (wheel == NULL || expiry == NULL || wheel->count == 0)
+    {
+        return false;
+    }
+
+    bool        found    = false;
+    rtos_tick_t earliest = 0;
+
+    for (uint32_t level = 0; level < RTOS_TIMING_WHEEL_LEVELS; level++)
+    {
+        uint32_t current = (wheel->now >> (RTOS_TIMING_WHEEL_SLOT_BITS * level)) & RTOS_TIMING_WHEEL_MASK;
+
+        /* Level 0 starts at the current slot; higher levels at the next one,
+         * since their current slot holds entries a full revolution away */
+        uint32_t first = (level == 0U) ? 0U : 1U;
+
+        for (uint32_t offset = first; offset < first + RTOS_TIMING_WHEEL_SLOTS; offset++)
+        {
+            const timer_wheel_node_t *head = wheel->slots[level][(current + offset) & RTOS_TIMING_WHEEL_MASK];
+            if (head == NULL)
+            {
+                continue;
+            }
+
+            const timer_wheel_node_t *node = head;
+            do
+            {
+                if (!found || (int32_t) (node->expiry - earliest) < 0)
+                {
+                    earliest = node->expiry;
+                    found    = true;
+                }
+                node = node->next;
+            } while (node != head);
+
+            /* Slots of a lower level are visited in expiry order, so the first
+             * non-empty one holds its minimum.  The top level also holds parked
+             * entries beyond the wheel span, so every slot there is checked. */
+            if (level < RTOS_TIMING_WHEEL_LEVELS - 1U)
+            {
+                break;
+            }
+        }
+    }
+
+    *expiry = earliest;
+    return found;
+}
+
+bool timer_wheel_find_expiry(const timer_wheel_t *wheel, rtos_tick_t from, rtos_tick_t window, rtos_tick_t *expiry)
+{
+    if (wheel == NULL || expiry == NULL || wheel->count == 0)
+    {
+        return false;
+    }
+
+    bool     found = false;
+    uint32_t best  = 0; /* Offset of the best match from 'from' */
+
+    for (uint32_t level = 0; level < RTOS_TIMING_WHEEL_LEVELS; level++)
+    {
+        uint32_t shift = RTOS_TIMING_WHEEL_SLOT_BITS * level;
+        uint32_t first = from >> shift;
+        uint32_t count = (((rtos_tick_t) (from + window)) >> shift) - first + 1U;
+
+        if (count > RTOS_TIMING_WHEEL_SLOTS)
+        {
+            count = RTOS_TIMING_WHEEL_SLOTS;
+        }
+
+        /* A slot also holds entries a revolution away; the offset check drops them */
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const timer_wheel_node_t *head = wheel->slots[level][(first + i) & RTOS_TIMING_WHEEL_MASK];
+            const timer_wheel_node_t *node = head;
+
+            while (node != NULL)
+            {
+                uint32_t offset = (rtos_tick_t) (node->expiry - from);
+                if (offset <= window && (!found || offset < best))
+                {
+                    best  = offset;
+                    found = true;
+                }
+                node = (node->next == head) ? NULL : node->next;
+            }
+        }
+    }
+
+    *expiry = from + best;
+    return found;
+}
+
+#endif /* RTOS_USE_TIMING_WHEEL */
@@ -0,0 +1,111 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include "config.h"
+#include "rtos_assert.h"
+#include "rtos_types.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Hierarchical timing wheel (enabled with RTOS_USE_TIMING_WHEEL).
+ *
+ * Level 0 has one slot per tick; every higher level has slots that are
+ * RTOS_TIMING_WHEEL_SLOTS times wider than the level below.  An entry is
+ * filed by its absolute expiry tick, so insert and remove are O(1).  When
+ * the wheel crosses a level boundary the matching higher-level slot is
+ * cascaded down.  Delays longer than the wheel span park in the top level
+ * and are re-filed each time that slot cascades.
+ */
+
+#define RTOS_TIMING_WHEEL_SLOTS (1U << RTOS_TIMING_WHEEL_SLOT_BITS)
+#define RTOS_TIMING_WHEEL_MASK  (RTOS_TIMING_WHEEL_SLOTS - 1U)
+
+RTOS_STATIC_ASSERT(RTOS_TIMING_WHEEL_LEVELS >= 1U, "timing wheel needs at least one level");
+RTOS_STATIC_ASSERT((RTOS_TIMING_WHEEL_SLOT_BITS * RTOS_TIMING_WHEEL_LEVELS) < 31U,
+                   "timing wheel span must fit in a signed tick delta");
+
+/* Intrusive wheel link — embed in the object being timed */
+typedef struct timer_wheel_node
+{
+    struct timer_wheel_node  *next;   /**< Next entry in slot (circular) */
+    struct timer_wheel_node  *prev;   /**< Previous entry in slot (circular; head->prev is tail) */
+    struct timer_wheel_node **slot;   /**< Slot head this entry is filed under, NULL when idle */
+    rtos_tick_t               expiry; /**< Absolute expiry tick */
+} timer_wheel_node_t;
+
+typedef struct
+{
+    timer_wheel_node_t *slots[RTOS_TIMING_WHEEL_LEVELS][RTOS_TIMING_WHEEL_SLOTS];
+    rtos_tick_t         now;   /**< Tick whose level-0 slot is current */
+    uint32_t            count; /**< Entries currently filed */
+} timer_wheel_t;
+
+/* Recover the containing object from an embedded wheel node */
+#define TIMER_WHEEL_ENTRY(node_ptr, type, member) ((type *) ((uint8_t *) (node_ptr) - offsetof(type, member)))
+
+/* Wheel holding delayed tasks — defined in scheduler.c */
+extern timer_wheel_t g_task_delay_wheel;
+
+/* Wheel holding active software timers — defined in timer_list.c */
+extern timer_wheel_t g_timer_wheel;
+
+/**
+ * @brief Reset a wheel to empty, starting at the given tick
+ */
+void timer_wheel_init(timer_wheel_t *wheel, rtos_tick_t now);
+
+/**
+ * @brief File a node to expire at an absolute tick (O(1))
+ *
+ * Entries whose expiry is not in the future are filed in the current slot
+ * and returned by the next timer_wheel_pop_expired() call.
+ * Caller must hold the appropriate critical section.
+ */
+void timer_wheel_insert(timer_wheel_t *wheel, timer_wheel_node_t *node, rtos_tick_t expiry);
+
+/**
+ * @brief Remove a filed node (O(1)); no-op if the node is not filed
+ */
+void timer_wheel_remove(timer_wheel_t *wheel, timer_wheel_node_t *node);
+
+/**
+ * @brief Advance the wheel up to @p now and unlink one due entry
+ *
+ * Call repeatedly until it returns NULL.  Returning entries one at a time
+ * lets the caller drop its critical section between entries (timer
+ * callbacks) without holding a detached batch that a callback could modify.
+ *
+ * @return Due node, already removed from the wheel, or NULL
+ */
+timer_wheel_node_t *timer_wheel_pop_expired(timer_wheel_t *wheel, rtos_tick_t now);
+
+/**
+ * @brief Find the earliest filed expiry
+ *
+ * Walks the first non-empty slot of each lower level and every slot of the
+ * top level, so the cost is bounded by the slot count plus those entries.
+ *
+ * @param expiry Receives the earliest expiry tick
+ * @return true if the wheel holds at least one entry
+ */
+bool timer_wheel_next_expiry(const timer_wheel_t *wheel, rtos_tick_t *expiry);
+
+/**
+ * @brief Find the earliest filed expiry in [from, from + window]
+ *
+ * Visits only the slots of each level that overlap the window, plus their
+ * entries; entries parked beyond the wheel span are not considered.
+ *
+ * @param expiry Receives the expiry tick found
+ * @return true if an entry expires inside the window
+ */
+bool timer_wheel_find_expiry(const timer_wheel_t *wheel, rtos_tick_t from, rtos_tick_t window, rtos_tick_t *expiry);
+
+static inline bool timer_wheel_node_is_filed(const timer_wheel_node_t *node)
+{
+    return node->slot != NULL;
+}
+
+#endif /* TIMER_WHEEL_H */
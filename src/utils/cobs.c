@@ -0,0 +1,33 @@
+#include "cobs.h"
+
+uint32_t cobs_encode(const uint8_t *src, uint32_t len, uint8_t *dst)
+{
+    uint32_t code_idx = 0; /* Where the current block's length code goes */
+    uint32_t out      = 1;
+    uint8_t  code     = 1;
+
+    for (uint32_t i = 0; i < len; i++)
+    {
+        if (src[i] == 0U)
+        {
+            dst[code_idx] = code;
+            code_idx      = out++;
+            code          = 1;
+        }
+        else
+        {
+            dst[out++] = src[i];
+            code++;
+
+            if (code == 0xFFU) /* Block full: 254 data bytes */
+            {
+                dst[code_idx] = code;
+                code_idx      = out++;
+                code          = 1;
+            }
+        }
+    }
+
+    dst[code_idx] = code;
+    return out;
+}
@@ -0,0 +1,31 @@
+#ifndef COBS_H
+#define COBS_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** Worst-case encoded size of len bytes (excluding the 0x00 delimiter) */
+#define COBS_MAX_ENCODED_SIZE(len) ((len) + ((len) / 254U) + 1U)
+
+/**
+ * @brief Consistent Overhead Byte Stuffing encode
+ *
+ * The output contains no 0x00 bytes, so frames can be delimited by 0x00 on
+ * a byte stream. The delimiter is not written.
+ *
+ * @param src Source bytes
+ * @param len Source length
+ * @param dst Output, at least COBS_MAX_ENCODED_SIZE(len) bytes
+ * @return Encoded length
+ */
+uint32_t cobs_encode(const uint8_t *src, uint32_t len, uint8_t *dst);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* COBS_H */
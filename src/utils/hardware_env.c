@@ -1,12 +1,128 @@
 #include "hardware_env.h"
 
+#include "config.h"
+#include "hrtimer.h"
 #include "klog.h"
-#include "stm32f4xx_hal.h" // IWYU pragma: keep
+#include "device.h" // IWYU pragma: keep
 
+#if defined(RTOS_TARGET_NATIVE)
+
+/* POSIX simulation: no LED, and a failure ends the process so a test run
+ * fails instead of hanging */
+#include <stdio.h>
+#include <stdlib.h>
+
+void led_toggle(void) {}
+
+void led_set(bool on)
+{
+    (void) on;
+}
+
+__attribute__((__noreturn__)) void indicate_system_failure(void)
+{
+    fflush(stdout);
+    fputs("[FATAL] system failure\n", stderr);
+    abort();
+}
+
+__attribute__((__noreturn__)) void Error_Handler(void)
+{
+    indicate_system_failure();
+}
+
+void hardware_env_config(void)
+{
+    /* Line-buffered even into a pipe, so the test runner sees each line as it is logged */
+    setvbuf(stdout, NULL, _IOLBF, 0);
+}
+
+#if RTOS_USE_HRTIMER
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+
+/* The counter is CLOCK_MONOTONIC in us; a one-shot host timer raises TIM5 through SIGUSR1 */
+static timer_t g_hrtimer_host;
+
+static void hrtimer_host_signal(int signo)
+{
+    int saved_errno = errno;
+
+    (void) signo;
+    NVIC_SetPendingIRQ(TIM5_IRQn);
+
+    errno = saved_errno;
+}
+
+void hardware_env_hrtimer_init(void)
+{
+    struct sigaction action = {0};
+    struct sigevent  event  = {0};
+
+    action.sa_handler = hrtimer_host_signal;
+    action.sa_flags   = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+
+    event.sigev_notify = SIGEV_SIGNAL;
+    event.sigev_signo  = SIGUSR1;
+
+    if (sigaction(SIGUSR1, &action, NULL) != 0 || timer_create(CLOCK_MONOTONIC, &event, &g_hrtimer_host) != 0)
+    {
+        indicate_system_failure();
+    }
+    NVIC_EnableIRQ(TIM5_IRQn);
+}
+
+uint32_t hardware_env_hrtimer_now(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t) (((uint64_t) now.tv_sec * 1000000ULL) + ((uint64_t) now.tv_nsec / 1000U));
+}
+
+void hardware_env_hrtimer_set_compare(uint32_t when)
+{
+    int32_t delta = (int32_t) (when - hardware_env_hrtimer_now());
+
+    if (delta <= 0)
+    {
+        NVIC_SetPendingIRQ(TIM5_IRQn);
+        return;
+    }
+
+    struct itimerspec spec = {0};
+    spec.it_value.tv_sec   = delta / 1000000;
+    spec.it_value.tv_nsec  = (long) (delta % 1000000) * 1000L;
+    (void) timer_settime(g_hrtimer_host, 0, &spec, NULL);
+}
+
+void hardware_env_hrtimer_stop_compare(void)
+{
+    struct itimerspec spec = {0};
+    (void) timer_settime(g_hrtimer_host, 0, &spec, NULL);
+}
+
+void TIM5_IRQHandler(void)
+{
+    rtos_hrtimer_isr();
+}
+#endif /* RTOS_USE_HRTIMER */
+
+#else /* Nucleo boards */
+
+#if defined(RTOS_TARGET_STM32H743ZI)
+/* LED Configuration for STM32H743ZI Nucleo */
+#define LED_PORT     GPIOB
+#define LED_PIN      0 /* PB0 - User LED (LD1) */
+#define LED_PIN_MASK (1U << LED_PIN)
+#else
 /* LED Configuration for STM32F446RE Nucleo */
 #define LED_PORT     GPIOA
 #define LED_PIN      5 /* PA5 - User LED (LD2) */
 #define LED_PIN_MASK (1U << LED_PIN)
+#endif
 
 void led_toggle(void)
 {
@@ -55,11 +171,102 @@ __attribute__((__noreturn__)) void Error_Handler(void)
     indicate_system_failure();
 }
 
+#if defined(RTOS_TARGET_STM32H743ZI)
+
 static void SystemClock_Config(void)
 {
     RCC_OscInitTypeDef RCC_OscInitStruct = {0};
     RCC_ClkInitTypeDef RCC_ClkInitStruct = {0};
 
+    /* LDO supply, lowest voltage scale: enough for the 64 MHz HSI */
+    HAL_PWREx_ConfigSupply(PWR_LDO_SUPPLY);
+    __HAL_PWR_VOLTAGESCALING_CONFIG(PWR_REGULATOR_VOLTAGE_SCALE3);
+    while (!__HAL_PWR_GET_FLAG(PWR_FLAG_VOSRDY))
+    {
+    }
+
+    /* Initialize the RCC Oscillators */
+    RCC_OscInitStruct.OscillatorType      = RCC_OSCILLATORTYPE_HSI;
+    RCC_OscInitStruct.HSIState            = RCC_HSI_DIV1;
+    RCC_OscInitStruct.HSICalibrationValue = RCC_HSICALIBRATION_DEFAULT;
+    RCC_OscInitStruct.PLL.PLLState        = RCC_PLL_NONE;
+    if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK)
+    {
+        Error_Handler();
+    }
+
+    /* Every bus at the core clock, so TIM/DWT cycles compare directly */
+    RCC_ClkInitStruct.ClockType = RCC_CLOCKTYPE_HCLK | RCC_CLOCKTYPE_SYSCLK | RCC_CLOCKTYPE_PCLK1 |
+                                  RCC_CLOCKTYPE_PCLK2 | RCC_CLOCKTYPE_D3PCLK1 | RCC_CLOCKTYPE_D1PCLK1;
+    RCC_ClkInitStruct.SYSCLKSource   = RCC_SYSCLKSOURCE_HSI;
+    RCC_ClkInitStruct.SYSCLKDivider  = RCC_SYSCLK_DIV1;
+    RCC_ClkInitStruct.AHBCLKDivider  = RCC_HCLK_DIV1;
+    RCC_ClkInitStruct.APB3CLKDivider = RCC_APB3_DIV1;
+    RCC_ClkInitStruct.APB1CLKDivider = RCC_APB1_DIV1;
+    RCC_ClkInitStruct.APB2CLKDivider = RCC_APB2_DIV1;
+    RCC_ClkInitStruct.APB4CLKDivider = RCC_APB4_DIV1;
+
+    if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_1) != HAL_OK)
+    {
+        Error_Handler();
+    }
+}
+
+static void MX_GPIO_Init(void)
+{
+    GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+    __HAL_RCC_GPIOB_CLK_ENABLE();
+
+    HAL_GPIO_WritePin(GPIOB, GPIO_PIN_0, GPIO_PIN_RESET);
+
+    GPIO_InitStruct.Pin   = GPIO_PIN_0;
+    GPIO_InitStruct.Mode  = GPIO_MODE_OUTPUT_PP;
+    GPIO_InitStruct.Pull  = GPIO_NOPULL;
+    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+    HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
+}
+
+void hardware_env_config(void)
+{
+    SCB->VTOR = FLASH_BANK1_BASE;
+
+    /* I-cache for flash, D-cache for AXI SRAM (DTCM is never cached);
+     * DMA buffers stay coherent through rtos_port_dcache_*() */
+    SCB_EnableICache();
+    SCB_EnableDCache();
+
+    SystemClock_Config();
+    MX_GPIO_Init();
+    __enable_irq();
+}
+
+#if RTOS_USE_LOW_POWER
+
+/* No wake-up timer is set up on this board yet: idle stays in the sleep mode */
+bool hardware_env_power_enter(rtos_power_mode_t mode, rtos_tick_t ticks)
+{
+    (void) mode;
+    (void) ticks;
+    return false;
+}
+
+rtos_tick_t hardware_env_power_exit(rtos_power_mode_t mode)
+{
+    (void) mode;
+    return 0;
+}
+
+#endif /* RTOS_USE_LOW_POWER */
+
+#else /* STM32F446RE */
+
+#define BOARD_SYSCLK_SOURCE RCC_SYSCLKSOURCE_HSI
+
+static void SystemClock_OscConfig(void)
+{
+    RCC_OscInitTypeDef RCC_OscInitStruct = {0};
+
     /* Configure the main internal regulator output voltage */
     __HAL_RCC_PWR_CLK_ENABLE();
     __HAL_PWR_VOLTAGESCALING_CONFIG(PWR_REGULATOR_VOLTAGE_SCALE3);
@@ -73,10 +280,17 @@ static void SystemClock_Config(void)
     {
         Error_Handler();
     }
+}
+
+static void SystemClock_Config(void)
+{
+    RCC_ClkInitTypeDef RCC_ClkInitStruct = {0};
+
+    SystemClock_OscConfig();
 
     /* Initialize the CPU, AHB and APB buses clocks */
     RCC_ClkInitStruct.ClockType = RCC_CLOCKTYPE_HCLK | RCC_CLOCKTYPE_SYSCLK | RCC_CLOCKTYPE_PCLK1 | RCC_CLOCKTYPE_PCLK2;
-    RCC_ClkInitStruct.SYSCLKSource   = RCC_SYSCLKSOURCE_HSI;
+    RCC_ClkInitStruct.SYSCLKSource   = BOARD_SYSCLK_SOURCE;
     RCC_ClkInitStruct.AHBCLKDivider  = RCC_SYSCLK_DIV1;
     RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV1;
     RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV1;
@@ -87,6 +301,19 @@ static void SystemClock_Config(void)
     }
 }
 
+#if RTOS_USE_LOW_POWER
+/* Clocks back after stop, without HAL_RCC_ClockConfig(): its HAL_InitTick()
+ * would reprogram SysTick under the kernel */
+static void SystemClock_Restore(void)
+{
+    SystemClock_OscConfig();
+    MODIFY_REG(RCC->CFGR, RCC_CFGR_SW, BOARD_SYSCLK_SOURCE);
+    while ((RCC->CFGR & RCC_CFGR_SWS) != (BOARD_SYSCLK_SOURCE << RCC_CFGR_SWS_Pos))
+    {
+    }
+}
+#endif
+
 static void MX_GPIO_Init(void)
 {
     GPIO_InitTypeDef GPIO_InitStruct = {0};
@@ -103,14 +330,253 @@ static void MX_GPIO_Init(void)
     HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
 }
 
+#if RTOS_USE_LOW_POWER
+
+/*
+ * Stop / standby wake-up: the RTC wake-up timer on the 32.768 kHz LSE.
+ *
+ * The wake-up counter runs at RTCCLK/16 (2048 Hz, 65536 counts: 32 s at
+ * most per sleep).  The calendar is kept at PREDIV_A = 0, PREDIV_S = 32767,
+ * so the sub-second register counts down at the full LSE rate and the time
+ * actually slept is read from it (with shadow registers bypassed) rather
+ * than assumed from the timer.  The part of a tick left over is carried
+ * into the next sleep.
+ */
+#define RTC_UNITS_PER_SECOND 32768U
+#define RTC_UNITS_PER_WAKEUP 16U
+#define RTC_WAKEUP_MAX       65536U
+#define RTC_UNITS_PER_DAY    (86400U * RTC_UNITS_PER_SECOND)
+#define RTC_EXTI_LINE        (1UL << 22) /* EXTI 22: RTC wake-up event */
+
+static bool     g_rtc_ready;
+static uint32_t g_rtc_sleep_start;
+static uint32_t g_rtc_carry_units;
+
+static void rtc_wakeup_init(void)
+{
+    uint32_t spins = SystemCoreClock;
+
+    __HAL_RCC_PWR_CLK_ENABLE();
+    PWR->CR |= PWR_CR_DBP;
+
+    RCC->BDCR |= RCC_BDCR_LSEON;
+    while ((RCC->BDCR & RCC_BDCR_LSERDY) == 0U)
+    {
+        if (--spins == 0U)
+        {
+            return; /* No crystal fitted: deep sleep stays refused */
+        }
+    }
+    RCC->BDCR = (RCC->BDCR & ~RCC_BDCR_RTCSEL) | RCC_BDCR_RTCSEL_0 | RCC_BDCR_RTCEN;
+
+    RTC->WPR = 0xCAU;
+    RTC->WPR = 0x53U;
+
+    RTC->ISR |= RTC_ISR_INIT;
+    while ((RTC->ISR & RTC_ISR_INITF) == 0U)
+    {
+    }
+    RTC->PRER = 32767U; /* Two writes: synchronous first, then asynchronous */
+    RTC->PRER = 32767U;
+    RTC->CR |= RTC_CR_BYPSHAD;
+    RTC->ISR &= ~RTC_ISR_INIT;
+
+    RTC->CR &= ~RTC_CR_WUTE;
+    while ((RTC->ISR & RTC_ISR_WUTWF) == 0U)
+    {
+    }
+    RTC->CR = (RTC->CR & ~RTC_CR_WUCKSEL) | RTC_CR_WUTIE; /* WUCKSEL = RTCCLK/16 */
+
+    RTC->WPR = 0xFFU;
+
+    EXTI->IMR |= RTC_EXTI_LINE;
+    EXTI->RTSR |= RTC_EXTI_LINE;
+    NVIC_SetPriority(RTC_WKUP_IRQn, 0xFFU);
+    NVIC_EnableIRQ(RTC_WKUP_IRQn);
+
+    g_rtc_ready = true;
+}
+
+/* Time of day in LSE periods (wraps daily) */
+static uint32_t rtc_now_units(void)
+{
+    uint32_t ssr;
+    uint32_t tr;
+
+    /* Shadows are bypassed: re-read until the pair is consistent */
+    do
+    {
+        ssr = RTC->SSR;
+        tr  = RTC->TR;
+    } while (ssr != RTC->SSR);
+
+    uint32_t hours   = ((tr >> 20) & 0x3U) * 10U + ((tr >> 16) & 0xFU);
+    uint32_t minutes = ((tr >> 12) & 0x7U) * 10U + ((tr >> 8) & 0xFU);
+    uint32_t seconds = ((tr >> 4) & 0x7U) * 10U + (tr & 0xFU);
+
+    return ((hours * 3600U + minutes * 60U + seconds) * RTC_UNITS_PER_SECOND) + (32767U - ssr);
+}
+
+bool hardware_env_power_enter(rtos_power_mode_t mode, rtos_tick_t ticks)
+{
+    if (!g_rtc_ready)
+    {
+        return false;
+    }
+
+    /* Stop would cut the last byte off a console transmission */
+    if ((RCC->APB1ENR & RCC_APB1ENR_USART2EN) != 0U && (USART2->CR1 & USART_CR1_UE) != 0U &&
+        (USART2->SR & USART_SR_TC) == 0U)
+    {
+        return false;
+    }
+
+    uint32_t counts = RTC_WAKEUP_MAX;
+    if (ticks != RTOS_MAX_DELAY)
+    {
+        uint64_t units = ((uint64_t) ticks * RTC_UNITS_PER_SECOND) / RTOS_TICK_RATE_HZ;
+        counts         = (uint32_t) (units / RTC_UNITS_PER_WAKEUP);
+        if (counts > RTC_WAKEUP_MAX)
+        {
+            counts = RTC_WAKEUP_MAX;
+        }
+        else if (counts == 0U)
+        {
+            counts = 1U;
+        }
+    }
+
+    RTC->WPR = 0xCAU;
+    RTC->WPR = 0x53U;
+    RTC->CR &= ~RTC_CR_WUTE;
+    while ((RTC->ISR & RTC_ISR_WUTWF) == 0U)
+    {
+    }
+    RTC->WUTR = counts - 1U;
+    RTC->ISR  = ~(RTC_ISR_WUTF | RTC_ISR_INIT) | (RTC->ISR & RTC_ISR_INIT);
+    RTC->CR |= RTC_CR_WUTE;
+    RTC->WPR = 0xFFU;
+    EXTI->PR = RTC_EXTI_LINE;
+
+    if (mode == RTOS_POWER_MODE_STANDBY)
+    {
+        PWR->CR |= PWR_CR_CWUF | PWR_CR_PDDS;
+    }
+    else
+    {
+        PWR->CR = (PWR->CR & ~PWR_CR_PDDS) | PWR_CR_LPDS;
+    }
+
+    SCB->SCR |= SCB_SCR_SLEEPDEEP_Msk;
+    g_rtc_sleep_start = rtc_now_units();
+    return true;
+}
+
+rtos_tick_t hardware_env_power_exit(rtos_power_mode_t mode)
+{
+    (void) mode;
+
+    SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+    PWR->CR &= ~PWR_CR_PDDS;
+
+    /* Stop leaves the core on HSI with the bus dividers kept; this also
+     * covers a later board clock that needs its oscillator restarted */
+    SystemClock_Restore();
+
+    uint32_t now     = rtc_now_units();
+    uint32_t elapsed = (now >= g_rtc_sleep_start) ? (now - g_rtc_sleep_start)
+                                                  : (now + RTC_UNITS_PER_DAY - g_rtc_sleep_start);
+    uint64_t units   = (uint64_t) elapsed * RTOS_TICK_RATE_HZ + g_rtc_carry_units;
+    rtos_tick_t slept = (rtos_tick_t) (units / RTC_UNITS_PER_SECOND);
+    g_rtc_carry_units = (uint32_t) (units % RTC_UNITS_PER_SECOND);
+
+    RTC->WPR = 0xCAU;
+    RTC->WPR = 0x53U;
+    RTC->CR &= ~RTC_CR_WUTE;
+    RTC->ISR = ~(RTC_ISR_WUTF | RTC_ISR_INIT) | (RTC->ISR & RTC_ISR_INIT);
+    RTC->WPR = 0xFFU;
+    EXTI->PR = RTC_EXTI_LINE;
+    NVIC_ClearPendingIRQ(RTC_WKUP_IRQn);
+
+    return slept;
+}
+
+/* Only reached if the wake-up came after an early exit re-enabled interrupts */
+void RTC_WKUP_IRQHandler(void)
+{
+    RTC->ISR = ~(RTC_ISR_WUTF | RTC_ISR_INIT) | (RTC->ISR & RTC_ISR_INIT);
+    EXTI->PR = RTC_EXTI_LINE;
+}
+
+#endif /* RTOS_USE_LOW_POWER */
+
 void hardware_env_config(void)
 {
     SCB->VTOR = FLASH_BASE;
     SystemClock_Config();
     MX_GPIO_Init();
+#if RTOS_USE_LOW_POWER
+    rtc_wakeup_init();
+#endif
     __enable_irq();
 }
 
+#endif /* RTOS_TARGET_STM32H743ZI */
+
+#if RTOS_USE_HRTIMER
+/*
+ * TIM5 is 32 bits wide on both boards and clocked from APB1, which runs
+ * undivided, so the prescaler takes it straight to 1 MHz.  CC1 is the
+ * compare; no output pin is used.
+ */
+void hardware_env_hrtimer_init(void)
+{
+    __HAL_RCC_TIM5_CLK_ENABLE();
+
+    TIM5->CR1   = 0;
+    TIM5->DIER  = 0;
+    TIM5->CCMR1 = 0;
+    TIM5->PSC   = (SystemCoreClock / 1000000U) - 1U;
+    TIM5->ARR   = 0xFFFFFFFFU;
+    TIM5->EGR   = TIM_EGR_UG; /* Load the prescaler */
+    TIM5->SR    = 0;
+    TIM5->CR1   = TIM_CR1_CEN;
+
+    NVIC_SetPriority(TIM5_IRQn, RTOS_HRTIMER_IRQ_PRIO);
+    NVIC_EnableIRQ(TIM5_IRQn);
+}
+
+uint32_t hardware_env_hrtimer_now(void)
+{
+    return TIM5->CNT;
+}
+
+void hardware_env_hrtimer_set_compare(uint32_t when)
+{
+    TIM5->CCR1 = when;
+    TIM5->SR   = (uint32_t) ~TIM_SR_CC1IF;
+    TIM5->DIER |= TIM_DIER_CC1IE;
+
+    /* Already passed: the counter would only match again after a full wrap */
+    if ((int32_t) (when - TIM5->CNT) <= 0)
+    {
+        TIM5->EGR = TIM_EGR_CC1G;
+    }
+}
+
+void hardware_env_hrtimer_stop_compare(void)
+{
+    TIM5->DIER &= (uint32_t) ~TIM_DIER_CC1IE;
+    TIM5->SR = (uint32_t) ~TIM_SR_CC1IF;
+}
+
+void TIM5_IRQHandler(void)
+{
+    TIM5->SR = (uint32_t) ~TIM_SR_CC1IF;
+    rtos_hrtimer_isr();
+}
+#endif /* RTOS_USE_HRTIMER */
+
 __attribute__((naked)) void HardFault_Handler(void)
 {
     __asm volatile("TST LR, #4              \n"
@@ -151,3 +617,5 @@ __attribute__((__noreturn__)) void HardFault_Handler_C(uint32_t *stack_frame)
 
     indicate_system_failure();
 }
+
+#endif /* RTOS_TARGET_NATIVE */
@@ -1,6 +1,10 @@
 #ifndef HARDWARE_ENV_H
 #define HARDWARE_ENV_H
 
+#include "config.h"
+#include "power.h"
+#include "rtos_types.h"
+
 #include <stdbool.h>
 #include <stdint.h>
 
@@ -36,6 +40,52 @@ void led_set(bool on);
  */
 __attribute__((__noreturn__)) void indicate_system_failure(void);
 
+/**
+ * @brief Prepare a deep sleep (RTOS_USE_LOW_POWER, idle task, kernel interrupts masked)
+ *
+ * Arms the board's wake-up timer to fire within ticks (RTOS_MAX_DELAY: its
+ * longest period) and selects mode for the port's next WFI.
+ *
+ * @return false if the mode cannot be entered now (no wake-up timer,
+ *         peripheral still busy); nothing is changed then
+ */
+bool hardware_env_power_enter(rtos_power_mode_t mode, rtos_tick_t ticks);
+
+/**
+ * @brief Undo hardware_env_power_enter() after the WFI, clocks first
+ * @return Whole ticks slept, from the wake-up timer's clock
+ */
+rtos_tick_t hardware_env_power_exit(rtos_power_mode_t mode);
+
+#if RTOS_USE_HRTIMER
+/**
+ * @brief Start the high-resolution timer's counter (rtos_init)
+ *
+ * A free-running 32-bit counter at 1 MHz with one compare channel, whose
+ * interrupt (RTOS_HRTIMER_IRQ_PRIO) calls rtos_hrtimer_isr().  The compare
+ * stays disabled until the first hardware_env_hrtimer_set_compare().
+ */
+void hardware_env_hrtimer_init(void);
+
+/**
+ * @brief Current counter value in microseconds
+ */
+uint32_t hardware_env_hrtimer_now(void);
+
+/**
+ * @brief Raise the compare interrupt when the counter reaches when
+ *
+ * Replaces any earlier compare.  A when that is not ahead of the counter
+ * raises it at once, so an expiry cannot be missed by arming it late.
+ */
+void hardware_env_hrtimer_set_compare(uint32_t when);
+
+/**
+ * @brief Disable the compare interrupt (no timer armed)
+ */
+void hardware_env_hrtimer_stop_compare(void);
+#endif /* RTOS_USE_HRTIMER */
+
 /**
  * @brief HAL error handler
  *
@@ -0,0 +1,127 @@
+#ifndef PRIO_BITMAP_H
+#define PRIO_BITMAP_H
+
+#include "config.h"
+#include "rtos_assert.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Priority bitmap: one bit per priority level, highest set bit in O(1)
+ *
+ * Sized at compile time by RTOS_MAX_TASK_PRIORITIES. Up to 32 levels it is a
+ * single word; above that it is a group word over leaf words (bit w of
+ * group set = leaf[w] non-empty), so a lookup is one CLZ per level either
+ * way. Used by the ready lists and the wait queues.
+ *
+ * Not thread-safe: callers hold the critical section of the list it indexes.
+ */
+#define RTOS_PRIO_BITMAP_WORDS ((RTOS_MAX_TASK_PRIORITIES + 31U) / 32U)
+
+/** Returned by rtos_prio_bitmap_highest_below() when no lower bit is set */
+#define RTOS_PRIO_BITMAP_NONE (0xFFFFFFFFU)
+
+RTOS_STATIC_ASSERT(RTOS_MAX_TASK_PRIORITIES >= 1U && RTOS_MAX_TASK_PRIORITIES <= 256U,
+                   "RTOS_MAX_TASK_PRIORITIES must fit rtos_priority_t (1..256)");
+
+typedef struct
+{
+#if RTOS_PRIO_BITMAP_WORDS > 1U
+    uint32_t group; /**< Bit w set = leaf[w] != 0 (first: also the emptiness word) */
+#endif
+    uint32_t leaf[RTOS_PRIO_BITMAP_WORDS]; /**< Bit p % 32 of leaf[p / 32] = priority p */
+} rtos_prio_bitmap_t;
+
+static inline uint32_t prio_bitmap_msb(uint32_t word)
+{
+    return 31U - (uint32_t) __builtin_clz(word);
+}
+
+static inline void rtos_prio_bitmap_init(rtos_prio_bitmap_t *bm)
+{
+#if RTOS_PRIO_BITMAP_WORDS > 1U
+    bm->group = 0;
+#endif
+    for (uint32_t w = 0; w < RTOS_PRIO_BITMAP_WORDS; w++)
+    {
+        bm->leaf[w] = 0;
+    }
+}
+
+static inline void rtos_prio_bitmap_set(rtos_prio_bitmap_t *bm, uint32_t prio)
+{
+    bm->leaf[prio >> 5] |= 1U << (prio & 31U);
+#if RTOS_PRIO_BITMAP_WORDS > 1U
+    bm->group |= 1U << (prio >> 5);
+#endif
+}
+
+static inline void rtos_prio_bitmap_clear(rtos_prio_bitmap_t *bm, uint32_t prio)
+{
+    bm->leaf[prio >> 5] &= ~(1U << (prio & 31U));
+#if RTOS_PRIO_BITMAP_WORDS > 1U
+    if (bm->leaf[prio >> 5] == 0U)
+    {
+        bm->group &= ~(1U << (prio >> 5));
+    }
+#endif
+}
+
+/*
+ * One word read, so lock-free fast paths may test it outside the critical
+ * section (through a volatile pointer, as the LDREX/STREX loops do).
+ */
+static inline bool rtos_prio_bitmap_is_empty(const volatile rtos_prio_bitmap_t *bm)
+{
+#if RTOS_PRIO_BITMAP_WORDS > 1U
+    return bm->group == 0U;
+#else
+    return bm->leaf[0] == 0U;
+#endif
+}
+
+/* Highest set priority; only valid when the bitmap is not empty */
+static inline uint32_t rtos_prio_bitmap_highest(const rtos_prio_bitmap_t *bm)
+{
+#if RTOS_PRIO_BITMAP_WORDS > 1U
+    uint32_t w = prio_bitmap_msb(bm->group);
+    return (w << 5) | prio_bitmap_msb(bm->leaf[w]);
+#else
+    return prio_bitmap_msb(bm->leaf[0]);
+#endif
+}
+
+/* Highest set priority strictly below prio, or RTOS_PRIO_BITMAP_NONE */
+static inline uint32_t rtos_prio_bitmap_highest_below(const rtos_prio_bitmap_t *bm, uint32_t prio)
+{
+    uint32_t w     = prio >> 5;
+    uint32_t lower = bm->leaf[w] & ((1U << (prio & 31U)) - 1U);
+
+    if (lower != 0U)
+    {
+        return (w << 5) | prio_bitmap_msb(lower);
+    }
+
+#if RTOS_PRIO_BITMAP_WORDS > 1U
+    uint32_t groups = bm->group & ((1U << w) - 1U);
+    if (groups != 0U)
+    {
+        w = prio_bitmap_msb(groups);
+        return (w << 5) | prio_bitmap_msb(bm->leaf[w]);
+    }
+#endif
+
+    return RTOS_PRIO_BITMAP_NONE;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PRIO_BITMAP_H */
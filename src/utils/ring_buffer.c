@@ -1,5 +1,9 @@
 #include "ring_buffer.h"
 
+#include "rtos_mem.h"
+
+#include <stddef.h>
+
 void ring_buffer_init(ring_buffer_t *rb, uint8_t *buf, uint32_t size)
 {
     rb->buf  = buf;
@@ -8,6 +12,41 @@ void ring_buffer_init(ring_buffer_t *rb, uint8_t *buf, uint32_t size)
     rb->tail = 0;
 }
 
+/* Single-core SPSC: the data must be in place before the index that publishes it moves */
+#define RB_PUBLISH_BARRIER() __asm__ volatile("" ::: "memory")
+
+/* Copy len bytes in at position pos, split across the wrap if needed */
+static void rb_copy_in(ring_buffer_t *rb, uint32_t pos, const uint8_t *src, uint32_t len)
+{
+    uint32_t first = (rb->mask + 1U) - pos; /* Bytes before the wrap */
+
+    if (len <= first)
+    {
+        rtos_mem_copy(&rb->buf[pos], src, len);
+    }
+    else
+    {
+        rtos_mem_copy(&rb->buf[pos], src, first);
+        rtos_mem_copy(rb->buf, src + first, len - first);
+    }
+}
+
+/* Copy len bytes out from position pos, split across the wrap if needed */
+static void rb_copy_out(const ring_buffer_t *rb, uint32_t pos, uint8_t *dst, uint32_t len)
+{
+    uint32_t first = (rb->mask + 1U) - pos; /* Bytes before the wrap */
+
+    if (len <= first)
+    {
+        rtos_mem_copy(dst, &rb->buf[pos], len);
+    }
+    else
+    {
+        rtos_mem_copy(dst, &rb->buf[pos], first);
+        rtos_mem_copy(dst + first, rb->buf, len - first);
+    }
+}
+
 bool ring_buffer_write(ring_buffer_t *rb, const void *data, uint32_t len)
 {
     uint32_t free_space = ring_buffer_free(rb);
@@ -16,33 +55,75 @@ bool ring_buffer_write(ring_buffer_t *rb, const void *data, uint32_t len)
         return false; /* Drop the record — never block */
     }
 
-    const uint8_t *src  = (const uint8_t *) data;
-    uint32_t       head = rb->head;
+    uint32_t head = rb->head;
+
+    rb_copy_in(rb, head, (const uint8_t *) data, len);
+
+    RB_PUBLISH_BARRIER();
+    rb->head = (head + len) & rb->mask;
+    return true;
+}
 
-    for (uint32_t i = 0; i < len; i++)
+bool ring_buffer_write_pair(ring_buffer_t *rb, const void *first, uint32_t first_len, const void *second,
+                            uint32_t second_len)
+{
+    if (first_len + second_len > ring_buffer_free(rb))
     {
-        rb->buf[(head + i) & rb->mask] = src[i];
+        return false;
     }
 
-    rb->head = (head + len) & rb->mask;
+    uint32_t head = rb->head;
+
+    rb_copy_in(rb, head, (const uint8_t *) first, first_len);
+    rb_copy_in(rb, (head + first_len) & rb->mask, (const uint8_t *) second, second_len);
+
+    RB_PUBLISH_BARRIER();
+    rb->head = (head + first_len + second_len) & rb->mask;
     return true;
 }
 
 uint32_t ring_buffer_read(ring_buffer_t *rb, void *data, uint32_t max_len)
+{
+    uint32_t to_read = ring_buffer_peek(rb, data, max_len);
+
+    RB_PUBLISH_BARRIER();
+    rb->tail = (rb->tail + to_read) & rb->mask;
+    return to_read;
+}
+
+uint32_t ring_buffer_peek(const ring_buffer_t *rb, void *data, uint32_t max_len)
 {
     uint32_t available = ring_buffer_count(rb);
     uint32_t to_read   = (max_len < available) ? max_len : available;
 
-    uint8_t *dst  = (uint8_t *) data;
-    uint32_t tail = rb->tail;
+    rb_copy_out(rb, rb->tail, (uint8_t *) data, to_read);
+
+    return to_read;
+}
 
-    for (uint32_t i = 0; i < to_read; i++)
+void ring_buffer_skip(ring_buffer_t *rb, uint32_t len)
+{
+    uint32_t available = ring_buffer_count(rb);
+
+    rb->tail = (rb->tail + ((len < available) ? len : available)) & rb->mask;
+}
+
+void *ring_buffer_reserve(ring_buffer_t *rb, uint32_t len)
+{
+    uint32_t head = rb->head;
+
+    if (len > ring_buffer_free(rb) || len > (rb->mask + 1U) - head)
     {
-        dst[i] = rb->buf[(tail + i) & rb->mask];
+        return NULL; /* No room, or the region would straddle the wrap */
     }
 
-    rb->tail = (tail + to_read) & rb->mask;
-    return to_read;
+    return &rb->buf[head];
+}
+
+void ring_buffer_commit(ring_buffer_t *rb, uint32_t len)
+{
+    RB_PUBLISH_BARRIER();
+    rb->head = (rb->head + len) & rb->mask;
 }
 
 bool ring_buffer_is_empty(const ring_buffer_t *rb)
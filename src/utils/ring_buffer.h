@@ -15,9 +15,14 @@ extern "C"
  * Power-of-2 sized circular buffer. The caller is responsible for providing
  * storage and ensuring the size is a power of 2. The buffer supports fixed-size
  * record writes (for binary logging) and variable-length byte writes.
+ * Reads and writes copy at most two contiguous segments with rtos_mem_copy(),
+ * so with 4-byte aligned storage word-multiple records move as whole words.
  *
- * Thread-safety is the caller's responsibility:
- * - For ISR-safe use (KLog, ProfTrace): wrap calls with __disable_irq()/__enable_irq()
+ * With one producer and one consumer on a single core the buffer needs no
+ * lock: each side moves only its own index, after its data is in place.
+ * Any other sharing is the caller's responsibility:
+ * - For ISR-safe use (ProfTrace, RTT): wrap calls with rtos_port_enter/exit_critical_from_isr()
+ *   (KLog uses its own lock-free ring, see klog.c)
  * - For task-context use (ULog): protect with a mutex
  */
 typedef struct
@@ -45,6 +50,17 @@ void ring_buffer_init(ring_buffer_t *rb, uint8_t *buf, uint32_t size);
  */
 bool ring_buffer_write(ring_buffer_t *rb, const void *data, uint32_t len);
 
+/**
+ * @brief Write two pieces of data as one record
+ *
+ * Both are copied before the write index moves, so a reader never sees the
+ * first piece without the second (e.g. a length prefix and its payload).
+ *
+ * @return true if written, false if the pair does not fit (nothing is written)
+ */
+bool ring_buffer_write_pair(ring_buffer_t *rb, const void *first, uint32_t first_len, const void *second,
+                            uint32_t second_len);
+
 /**
  * @brief Read data from the ring buffer
  * @param rb      Ring buffer
@@ -54,6 +70,38 @@ bool ring_buffer_write(ring_buffer_t *rb, const void *data, uint32_t len);
  */
 uint32_t ring_buffer_read(ring_buffer_t *rb, void *data, uint32_t max_len);
 
+/**
+ * @brief Copy data out without consuming it
+ * @return Number of bytes copied
+ */
+uint32_t ring_buffer_peek(const ring_buffer_t *rb, void *data, uint32_t max_len);
+
+/**
+ * @brief Consume up to len bytes without copying them
+ */
+void ring_buffer_skip(ring_buffer_t *rb, uint32_t len);
+
+/**
+ * @brief Reserve contiguous space at the write position to build a record in place
+ *
+ * Nothing becomes visible to the reader until ring_buffer_commit(). Regions
+ * never straddle the wrap, so a reserve can fail with space left when the
+ * record size does not divide the buffer size; power-of-2 record sizes
+ * written only through reserve/commit or fixed-size writes always fit.
+ *
+ * @param rb  Ring buffer
+ * @param len Bytes to reserve
+ * @return Pointer into the buffer, or NULL if space is insufficient (drop the record)
+ */
+void *ring_buffer_reserve(ring_buffer_t *rb, uint32_t len);
+
+/**
+ * @brief Publish a region returned by ring_buffer_reserve()
+ * @param rb  Ring buffer
+ * @param len Same length as passed to ring_buffer_reserve()
+ */
+void ring_buffer_commit(ring_buffer_t *rb, uint32_t len);
+
 /**
  * @brief Check if the ring buffer is empty
  * @param rb Ring buffer
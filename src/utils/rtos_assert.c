@@ -4,13 +4,14 @@
 
 #include <stddef.h>
 #include <stdint.h>
-#include <stm32f4xx_hal.h>
 
-/* Include CMSIS core for ARM intrinsics */
-#if defined(__GNUC__)
-#include "core_cm4.h"
+#if defined(RTOS_TARGET_NATIVE)
+#include <stdio.h>
+#include <stdlib.h>
 #endif
 
+#include "device.h" // IWYU pragma: keep
+
 #if RTOS_ASSERT_ENABLED
 
 /**
@@ -27,6 +28,11 @@
  */
 void rtos_assert_failed(const char *file, uint32_t line, const char *func, const char *expr)
 {
+#if defined(RTOS_TARGET_NATIVE)
+    /* Host simulation: report and stop, so a test run fails instead of hanging */
+    fprintf(stderr, "[ASSERT] %s:%lu %s(): %s\n", file, (unsigned long) line, func, expr);
+    abort();
+#else
 /* Disable interrupts to prevent further issues */
 #if defined(__GNUC__)
     __disable_irq();
@@ -71,6 +77,7 @@ void rtos_assert_failed(const char *file, uint32_t line, const char *func, const
         __asm volatile("nop");
 #endif
     }
+#endif /* RTOS_TARGET_NATIVE */
 }
 
 #endif /* RTOS_ASSERT_ENABLED */
\ No newline at end of file
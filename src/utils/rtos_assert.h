@@ -61,6 +61,10 @@ void rtos_assert_failed(const char *file, uint32_t line, const char *func, const
  * @param expr Expression to evaluate at compile time
  * @param msg Error message
  */
+#ifdef __cplusplus
+#define RTOS_STATIC_ASSERT(expr, msg) static_assert(expr, msg)
+#else
 #define RTOS_STATIC_ASSERT(expr, msg) _Static_assert(expr, msg)
+#endif
 
 #endif /* RTOS_ASSERT_H */
\ No newline at end of file
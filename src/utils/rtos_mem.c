@@ -0,0 +1,96 @@
+#include "rtos_mem.h"
+
+#include "port_priv.h"
+
+/*
+ * The burst loops move 8 words per iteration through r2-r5 (two 4-register
+ * LDM/STM pairs). Clobbering those registers keeps the compiler from
+ * placing the pointer and count operands there; the pointers come back
+ * advanced past the block, so the C tail finishes the last 0-7 words.
+ * Ports without block transfers are hosted, where the C library's
+ * memcpy/memset are already vectorised, so they get those instead.
+ */
+
+void rtos_mem_copy_words(rtos_mem_word_t *dst, const rtos_mem_word_t *src, uint32_t words)
+{
+#if PORT_HAS_BLOCK_TRANSFER
+    uint32_t blocks = words >> 3;
+    if (blocks != 0U)
+    {
+        __asm__ volatile("1:\n\t"
+                         "ldmia %[s]!, {r2, r3, r4, r5}\n\t"
+                         "stmia %[d]!, {r2, r3, r4, r5}\n\t"
+                         "ldmia %[s]!, {r2, r3, r4, r5}\n\t"
+                         "stmia %[d]!, {r2, r3, r4, r5}\n\t"
+                         "subs %[n], %[n], #1\n\t"
+                         "bne 1b"
+                         : [d] "+r"(dst), [s] "+r"(src), [n] "+r"(blocks)
+                         :
+                         : "r2", "r3", "r4", "r5", "cc", "memory");
+        words &= 7U;
+    }
+
+    for (; words > 0U; words--)
+    {
+        *dst++ = *src++;
+    }
+#else
+    memcpy(dst, src, (size_t) words * sizeof(rtos_mem_word_t));
+#endif
+}
+
+void rtos_mem_fill_words(rtos_mem_word_t *dst, uint32_t value, uint32_t words)
+{
+#if PORT_HAS_BLOCK_TRANSFER
+    uint32_t blocks = words >> 3;
+    if (blocks != 0U)
+    {
+        __asm__ volatile("mov r2, %[v]\n\t"
+                         "mov r3, %[v]\n\t"
+                         "mov r4, %[v]\n\t"
+                         "mov r5, %[v]\n"
+                         "1:\n\t"
+                         "stmia %[d]!, {r2, r3, r4, r5}\n\t"
+                         "stmia %[d]!, {r2, r3, r4, r5}\n\t"
+                         "subs %[n], %[n], #1\n\t"
+                         "bne 1b"
+                         : [d] "+r"(dst), [n] "+r"(blocks)
+                         : [v] "r"(value)
+                         : "r2", "r3", "r4", "r5", "cc", "memory");
+        words &= 7U;
+    }
+#else
+    /* memset() stores a byte pattern: zero and the stack paint are one */
+    if (value == (value & 0xFFU) * 0x01010101U)
+    {
+        memset(dst, (int) (value & 0xFFU), (size_t) words * sizeof(rtos_mem_word_t));
+        return;
+    }
+#endif
+
+    for (; words > 0U; words--)
+    {
+        *dst++ = value;
+    }
+}
+
+uint32_t rtos_mem_scan_words(const rtos_mem_word_t *src, uint32_t value, uint32_t words)
+{
+    uint32_t i = 0;
+
+    /* One test per 4 words; painted stack is the long, all-equal case */
+    for (; i + 4U <= words; i += 4U)
+    {
+        if (((src[i] ^ value) | (src[i + 1U] ^ value) | (src[i + 2U] ^ value) | (src[i + 3U] ^ value)) != 0U)
+        {
+            break;
+        }
+    }
+
+    while (i < words && src[i] == value)
+    {
+        i++;
+    }
+
+    return i;
+}
@@ -0,0 +1,96 @@
+#ifndef RTOS_MEM_H
+#define RTOS_MEM_H
+
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @file rtos_mem.h
+ * @brief Kernel copy, fill and scan routines for word-aligned data
+ *
+ * Queue slots, ring-buffer records, heap and TCB control blocks and task
+ * stacks are word-aligned and almost always a whole number of words, the
+ * case newlib-nano's size-optimised memcpy/memset handle a byte at a time.
+ * These routines take that case with word accesses (LDM/STM bursts of 8
+ * words where the port has them, PORT_HAS_BLOCK_TRANSFER) and hand
+ * anything unaligned, and long copies on hosted ports, to the C library.
+ * Buffers must not overlap.
+ */
+
+/* 32-bit word that may alias item structs and byte storage */
+typedef uint32_t __attribute__((__may_alias__)) rtos_mem_word_t;
+
+/** Copy words 32-bit words; both pointers word-aligned */
+void rtos_mem_copy_words(rtos_mem_word_t *dst, const rtos_mem_word_t *src, uint32_t words);
+
+/** Store value into words 32-bit words at a word-aligned dst */
+void rtos_mem_fill_words(rtos_mem_word_t *dst, uint32_t value, uint32_t words);
+
+/**
+ * @brief Find the first word that differs from value
+ *
+ * @return Index of the first word != value, or words if all match
+ */
+uint32_t rtos_mem_scan_words(const rtos_mem_word_t *src, uint32_t value, uint32_t words);
+
+/**
+ * @brief memcpy() for kernel payloads
+ *
+ * 4-, 8- and 16-byte aligned items (words, pairs, small structs) are moved
+ * inline without a call; other aligned word multiples go through
+ * rtos_mem_copy_words(), everything else through memcpy().
+ */
+static inline void rtos_mem_copy(void *dst, const void *src, uint32_t len)
+{
+    if ((((uintptr_t) dst | (uintptr_t) src | len) & 3U) != 0U)
+    {
+        memcpy(dst, src, len);
+        return;
+    }
+
+    rtos_mem_word_t       *d = (rtos_mem_word_t *) dst;
+    const rtos_mem_word_t *s = (const rtos_mem_word_t *) src;
+
+    switch (len)
+    {
+        case 4U:
+            d[0] = s[0];
+            break;
+        case 8U:
+            d[0] = s[0];
+            d[1] = s[1];
+            break;
+        case 16U:
+            d[0] = s[0];
+            d[1] = s[1];
+            d[2] = s[2];
+            d[3] = s[3];
+            break;
+        default:
+            rtos_mem_copy_words(d, s, len >> 2);
+            break;
+    }
+}
+
+/** memset(dst, 0, len) that takes the word path when dst and len are aligned */
+static inline void rtos_mem_zero(void *dst, uint32_t len)
+{
+    if ((((uintptr_t) dst | len) & 3U) != 0U)
+    {
+        memset(dst, 0, len);
+        return;
+    }
+
+    rtos_mem_fill_words((rtos_mem_word_t *) dst, 0U, len >> 2);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RTOS_MEM_H */
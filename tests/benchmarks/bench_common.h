@@ -45,6 +45,7 @@
  *
  * Wraps rtos_profiling_print_stat() which outputs:
  *   <name> | count=N | min=Xcy(Yus) max=Xcy(Yus) avg=Xcy(Yus)
+ *   <name> | P50/P99/P99.9 when the stat has a histogram
  *
  * @param stat_ptr  Pointer to rtos_profile_stat_t to report
  */
@@ -55,11 +56,16 @@
 /**
  * @brief Static initializer for a profiling stat structure.
  *
- * Sets min to UINT32_MAX (sentinel for "no measurement yet"), all others 0.
+ * Sets min to UINT32_MAX (sentinel for "no measurement yet"), all others 0,
+ * and attaches a zeroed histogram (a file-scope compound literal, so it has
+ * static storage) so bench_report() also prints P50/P99/P99.9.
  *
  * @param label  String name for the stat (stored in stat->name)
  */
-#define BENCH_STAT_INIT(label) \
-    { .min_cycles = UINT32_MAX, .max_cycles = 0U, .total_cycles = 0U, .count = 0U, .name = (label) }
+#define BENCH_STAT_INIT(label)                                                                                         \
+    {                                                                                                                  \
+        .min_cycles = UINT32_MAX, .max_cycles = 0U, .total_cycles = 0U, .count = 0U, .name = (label),                  \
+        .histogram = &(rtos_profile_hist_t){{0}}                                                                       \
+    }
 
 #endif /* BENCH_COMMON_H */
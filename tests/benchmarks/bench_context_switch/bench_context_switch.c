@@ -19,18 +19,38 @@
  *
  * SCENARIO
  * --------
- * Two tasks (BenchA and BenchB) at identical priority call rtos_yield() in a
- * tight loop.  Each yield triggers exactly one context switch (A→B or B→A).
- * After BENCH_ITERATIONS yields per task, both tasks suspend themselves.
- * A lower-priority ResultTask wakes up, snapshots g_prof_context_switch, and
- * prints the statistics.
+ * n tasks (Bench0..Bench<n-1>) at identical priority call rtos_yield() in a
+ * tight loop.  Each yield triggers exactly one context switch to the next
+ * task in the priority's ready list.  After BENCH_ITERATIONS yields per
+ * task, every bench task suspends itself.  A lower-priority ResultTask
+ * wakes up, snapshots g_prof_context_switch, deletes the bench tasks and
+ * moves on to the next n.
+ *
+ * ELIDED SWITCHES
+ * ---------------
+ * ResultTask then yields BENCH_ITERATIONS times with nothing else ready at
+ * or above its priority.  Each of those yields would pick ResultTask again,
+ * so the kernel drops it before pending PendSV.  The report gives both
+ * counts from rtos_scheduler_get_statistics(): real switches since the
+ * reset (the measured yields plus the few hand-overs around them) and
+ * elided ones (ResultTask's yields), with the cost of one elided yield.
+ *
+ * SAME-PRIORITY SCALING
+ * ---------------------
+ * n runs from 2 to BENCH_CTX_TASKS, doubling, then the end: one [SWITCH]
+ * line per point.  The default build has BENCH_CTX_TASKS=2, a single point;
+ * bench_context_switch_n sweeps n = 2, 4, 8, 16.  The preemptive_sp ready
+ * lists are circular with O(1) append and remove, so the per-switch cost
+ * must stay flat as the number of tasks sharing a priority grows; a cost
+ * that rises with n points to a list walk on the yield path.  The full
+ * bench_report() after the sweep is the largest n.
  *
  * WARMUP
  * ------
  * Before the measured phase, each task calls rtos_yield() BENCH_WARMUP times.
- * After warmup, BenchA resets all system stats (atomic, inside critical section)
- * and both tasks enter the measured phase.  The reset in BenchA is safe because
- * BenchA runs to completion of the reset before yielding to BenchB (equal
+ * After warmup, Bench0 resets all system stats (atomic, inside critical section)
+ * and all tasks enter the measured phase.  The reset in Bench0 is safe because
+ * Bench0 runs to completion of the reset before yielding to the next task (equal
  * priority, preemptive_sp scheduler will not preempt without a yield).
  *
  * SCHEDULER
@@ -41,21 +61,43 @@
  * BUILD
  * -----
  *   pio run -e bench_context_switch -t upload
+ *   pio run -e bench_context_switch_n -t upload
  *
  * EXPECTED OUTPUT (at 180 MHz, STM32F446RE)
  *   [BENCH] ===== context_switch =====
+ *   [SWITCH] n=2  count=...  min=47 avg=52 max=63
+ *   [SWITCH] n=4  count=...  min=47 avg=52 max=63   (bench_context_switch_n)
+ *   ...
  *   context_switch | count=2000 | min=47cy(0us) max=63cy(0us) avg=52cy(0us)
  ******************************************************************************/
 
 #include "VRTOS.h"
 #include "bench_common.h"
+#include "device.h" /* IWYU pragma: keep */
 #include "hardware_env.h"
 #include "profiling.h"
+#include "rtos_assert.h"
+#include "scheduler.h"
 #include "semaphore.h"
-#include "stm32f4xx_hal.h" /* IWYU pragma: keep */
 #include "uart_tx.h"
 #include "ulog.h"
 
+/* ========================= CONFIGURATION ================================== */
+
+/**
+ * Largest number of equal-priority tasks yielding to each other; the sweep
+ * ends there. Overridable: -D BENCH_CTX_TASKS=16 (bounded by RTOS_MAX_TASKS
+ * and heap size; ResultTask, LogFlush, Idle and the deferred daemon also
+ * need a slot).
+ */
+#ifndef BENCH_CTX_TASKS
+#define BENCH_CTX_TASKS (2U)
+#endif
+
+RTOS_STATIC_ASSERT(BENCH_CTX_TASKS >= 2U, "bench_context_switch needs at least two tasks to switch between");
+RTOS_STATIC_ASSERT(BENCH_CTX_TASKS + 3U + RTOS_USE_DEFERRED_WORK <= RTOS_MAX_TASKS,
+                   "BENCH_CTX_TASKS exceeds RTOS_MAX_TASKS");
+
 /* ========================= SYNCHRONIZATION ================================ */
 
 /** Set to 1 by the startup timer callback to ungate benchmark tasks. */
@@ -65,51 +107,73 @@ static volatile uint32_t g_test_started = 0;
 static rtos_semaphore_t g_done_sem;
 
 /**
- * Flag written by BenchA to signal that warmup is complete and stats have
- * been reset.  BenchB polls this before entering its measured loop so that
- * it does not record iterations before BenchA's reset.
+ * Flag written by Bench0 to signal that warmup is complete and stats have
+ * been reset.  The other bench tasks poll this before entering their measured
+ * loop so that they do not record iterations before Bench0's reset.
  */
 static volatile uint32_t g_warmup_done = 0;
 
+/** Bench tasks of the current point; deleted before the next one. */
+static rtos_task_handle_t g_bench_handles[BENCH_CTX_TASKS];
+
+static const char *const g_bench_names[] = {"Bench0",  "Bench1",  "Bench2",  "Bench3",  "Bench4",  "Bench5",
+                                            "Bench6",  "Bench7",  "Bench8",  "Bench9",  "Bench10", "Bench11",
+                                            "Bench12", "Bench13", "Bench14", "Bench15"};
+
+RTOS_STATIC_ASSERT(BENCH_CTX_TASKS <= sizeof(g_bench_names) / sizeof(g_bench_names[0]),
+                   "extend g_bench_names for more bench tasks");
+
 /* ========================= TASK FUNCTIONS ================================= */
 
 /**
- * @brief BenchA — primary yield task (runs first at equal priority)
+ * @brief BenchTask — yield task, n instances per point
  *
- * Responsibilities:
+ * Bench0 (param == 0) is the leader:
  *  1. Wait for startup gate.
  *  2. Run BENCH_WARMUP yields (discarded).
  *  3. Reset system profiling stats atomically.
- *  4. Signal BenchB to enter measured phase.
+ *  4. Signal the other bench tasks to enter the measured phase.
  *  5. Run BENCH_ITERATIONS yields (measured by kernel).
  *  6. Signal g_done_sem and suspend.
+ *
+ * The other instances yield until g_warmup_done is set, then run steps 5–6.
  */
-void BenchA(void *param)
+void BenchTask(void *param)
 {
-    (void)param;
-
-    TEST_WAIT_FOR_START(g_test_started);
+    uint32_t index = (uint32_t)(uintptr_t)param;
 
-    /* --- Warmup phase (results discarded) --- */
-    for (uint32_t i = 0; i < BENCH_WARMUP; i++)
+    if (index == 0U)
     {
-        rtos_yield();
+        /* --- Warmup phase (results discarded) --- */
+        for (uint32_t i = 0; i < BENCH_WARMUP; i++)
+        {
+            rtos_yield();
+        }
+
+        /*
+         * Reset all system profiling stats to clear warmup noise.
+         * Bench0 runs this without yielding first, so it completes atomically
+         * before any other bench task can enter its measured loop.
+         */
+        rtos_profiling_reset_system_stats();
+        rtos_scheduler_reset_statistics();
+
+        /* Signal the followers: warmup is done, measured phase begins now. */
+        g_warmup_done = 1;
+    }
+    else
+    {
+        /* Wait until Bench0 has completed warmup and reset stats. */
+        while (!g_warmup_done)
+        {
+            rtos_yield();
+        }
     }
-
-    /*
-     * Reset all system profiling stats to clear warmup noise.
-     * BenchA runs this without yielding first, so it completes atomically
-     * before BenchB can enter its measured loop.
-     */
-    rtos_profiling_reset_system_stats();
-
-    /* Signal BenchB: warmup is done, measured phase begins now. */
-    g_warmup_done = 1;
 
     /* --- Measured phase --- */
     for (uint32_t i = 0; i < BENCH_ITERATIONS; i++)
     {
-        rtos_yield(); /* triggers A→B or B→A context switch */
+        rtos_yield(); /* triggers a switch to the next equal-priority task */
     }
 
     rtos_semaphore_signal(&g_done_sem);
@@ -117,38 +181,67 @@ void BenchA(void *param)
 }
 
 /**
- * @brief BenchB — secondary yield task (mirrors BenchA)
+ * @brief Create n bench tasks, wait for their measured yields, delete them
  *
- * Waits for g_warmup_done before entering its measured loop so that it
- * does not record spurious context switches from warmup.
+ * The tasks are created with the scheduler suspended so that all n are in
+ * the ready list, Bench0 first, before any of them runs.
  */
-void BenchB(void *param)
+static bool run_point(uint32_t n)
 {
-    (void)param;
+    g_warmup_done = 0;
 
-    TEST_WAIT_FOR_START(g_test_started);
+    rtos_scheduler_suspend();
+    for (uint32_t i = 0; i < n; i++)
+    {
+        if (rtos_task_create(BenchTask, g_bench_names[i], RTOS_DEFAULT_TASK_STACK_SIZE, (void *)(uintptr_t)i, 3,
+                             &g_bench_handles[i]) != RTOS_SUCCESS)
+        {
+            for (uint32_t j = 0; j < i; j++)
+            {
+                (void)rtos_task_delete(g_bench_handles[j]);
+            }
+            (void)rtos_scheduler_resume();
+            ulog_error("[BENCH] Bench%lu: create failed", (unsigned long)i);
+            return false;
+        }
+    }
+    (void)rtos_scheduler_resume();
 
-    /* Wait until BenchA has completed warmup and reset stats. */
-    while (!g_warmup_done)
+    /* Block until every bench task has finished. */
+    for (uint32_t i = 0; i < n; i++)
     {
-        rtos_yield();
+        rtos_semaphore_wait(&g_done_sem, RTOS_MAX_DELAY);
     }
 
-    /* --- Measured phase --- */
-    for (uint32_t i = 0; i < BENCH_ITERATIONS; i++)
+    /*
+     * g_prof_context_switch is updated by the kernel in PendSV_Handler.
+     * It reflects the full save+restore cost of the context switch, measured
+     * in assembly with minimal observer effect.
+     */
+    rtos_profile_snapshot_t snap;
+    rtos_profiling_snapshot(&g_prof_context_switch, &snap);
+    ulog_info("[SWITCH] n=%-2lu count=%lu  min=%lu avg=%lu max=%lu", (unsigned long)n, (unsigned long)snap.count,
+              (unsigned long)snap.min_cycles, (unsigned long)snap.avg_cycles, (unsigned long)snap.max_cycles);
+
+    for (uint32_t i = 0; i < n; i++)
     {
-        rtos_yield();
+        (void)rtos_task_delete(g_bench_handles[i]);
     }
+    return true;
+}
 
-    rtos_semaphore_signal(&g_done_sem);
-    rtos_task_suspend(NULL);
+/** 2, 4, 8, ... then max */
+static uint32_t next_count(uint32_t n, uint32_t max)
+{
+    return (n < max && 2U * n > max) ? max : 2U * n;
 }
 
 /**
- * @brief ResultTask — prints statistics after both bench tasks finish
+ * @brief ResultTask — runs the sweep and prints the statistics
  *
- * Runs at priority 1 (below bench tasks).  Waits on g_done_sem twice
- * (once per bench task), then snapshots and prints g_prof_context_switch.
+ * Runs at priority 1 (below bench tasks).  For each n it spawns the bench
+ * tasks, waits on g_done_sem once per bench task, then snapshots and prints
+ * g_prof_context_switch.
  */
 void ResultTask(void *param)
 {
@@ -156,22 +249,41 @@ void ResultTask(void *param)
 
     TEST_WAIT_FOR_START(g_test_started);
 
-    /* Block until both BenchA and BenchB have finished. */
-    rtos_semaphore_wait(&g_done_sem, RTOS_MAX_DELAY);
-    rtos_semaphore_wait(&g_done_sem, RTOS_MAX_DELAY);
-
     bench_header("context_switch");
 
-    /*
-     * g_prof_context_switch is updated by the kernel in PendSV_Handler.
-     * It reflects the full save+restore cost of the context switch, measured
-     * in assembly with minimal observer effect.
-     */
+    uint32_t last = 0;
+    for (uint32_t n = 2U; n <= BENCH_CTX_TASKS; n = next_count(n, BENCH_CTX_TASKS))
+    {
+        if (!run_point(n))
+        {
+            break;
+        }
+        last = n;
+        rtos_delay_ms(50);
+    }
+
+    /* Full stat (with percentiles) of the largest point */
     bench_report(&g_prof_context_switch);
 
-    ulog_info("[BENCH] Done. Total measured switches: %lu",
+    ulog_info("[BENCH] Done. Tasks at equal priority: %u  Total measured switches: %lu", (unsigned)last,
               (unsigned long)g_prof_context_switch.count);
 
+    /* Alone above LogFlush: every yield is elided before PendSV */
+    uint32_t start = rtos_profiling_get_cycles();
+    for (uint32_t i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        rtos_yield();
+    }
+    uint32_t elided_cycles = rtos_profiling_get_cycles() - start;
+
+    rtos_scheduler_stats_t stats;
+    if (rtos_scheduler_get_statistics(&stats) == RTOS_SUCCESS)
+    {
+        ulog_info("[BENCH] Switches: real=%lu elided=%lu  Elided yield: avg=%lucy",
+                  (unsigned long)stats.context_switches, (unsigned long)stats.elided_switches,
+                  (unsigned long)(elided_cycles / BENCH_ITERATIONS));
+    }
+
     rtos_task_suspend(NULL);
 }
 
@@ -198,22 +310,22 @@ int main(void)
 
     ulog_init(ULOG_LEVEL_INFO);
     ulog_info("[BENCH] Context Switch Benchmark — " __DATE__ " " __TIME__);
-    ulog_info("[BENCH] Iterations: %u  Warmup: %u", BENCH_ITERATIONS, BENCH_WARMUP);
+    ulog_info("[BENCH] Iterations: %u  Warmup: %u  Tasks: 2..%u", BENCH_ITERATIONS, BENCH_WARMUP,
+              (unsigned)BENCH_CTX_TASKS);
 
-    /* Binary semaphore used as a 2-count release gate. */
-    rtos_semaphore_init(&g_done_sem, 0, 2);
+    /* Counting semaphore used as an n-count release gate, one point at a time. */
+    rtos_semaphore_init(&g_done_sem, 0, BENCH_CTX_TASKS);
 
     rtos_task_handle_t handle;
     rtos_timer_handle_t startup_timer;
 
     /*
      * Task priority layout:
-     *   BenchA / BenchB  (3) — equal priority, yield to each other
-     *   ResultTask       (1) — prints results after bench tasks suspend
-     *   LogFlush         (0) — drains ulog ring buffer to UART
+     *   Bench0..Bench<n-1> (3) — equal priority, yield to each other;
+     *                            created per point by ResultTask
+     *   ResultTask         (1) — runs the sweep, prints results
+     *   LogFlush           (0) — drains ulog ring buffer to UART
      */
-    rtos_task_create(BenchA,      "BenchA",   RTOS_DEFAULT_TASK_STACK_SIZE, NULL, 3, &handle);
-    rtos_task_create(BenchB,      "BenchB",   RTOS_DEFAULT_TASK_STACK_SIZE, NULL, 3, &handle);
     rtos_task_create(ResultTask,  "Result",   RTOS_DEFAULT_TASK_STACK_SIZE, NULL, 1, &handle);
 
     test_create_log_flush_task(&handle);
@@ -0,0 +1,153 @@
+/*******************************************************************************
+ * File: tests/benchmarks/bench_footprint/bench_footprint.c
+ * Description: Kernel Object Size Report (default vs. RTOS_FOOTPRINT_COMPACT)
+ * Author: Student
+ * Date: 2025
+ *
+ * WHAT IS MEASURED
+ * ----------------
+ * Nothing is timed. The benchmark prints sizeof() of every kernel control
+ * block an application allocates, plus the static task pool, as built with
+ * the configuration of the environment:
+ *
+ *   1. Per-task RAM: hot TCB, cold TCB, and both pools for RTOS_MAX_TASKS
+ *   2. Synchronisation objects: wait queue, queue control block, semaphore,
+ *      mutex, rwlock, event group (when compiled in)
+ *   3. Other objects: mempool, stream/message buffer, software timer
+ *
+ * Build the bench_footprint and bench_footprint_compact environments and
+ * diff the two reports to see what RTOS_FOOTPRINT_COMPACT saves; task
+ * stacks are not included (they are sized per task by the application).
+ *
+ * SCENARIO
+ * --------
+ *   BenchTask (priority 2):
+ *     Prints the configuration and the size table once, then suspends.
+ *
+ * BUILD
+ * -----
+ *   pio run -e bench_footprint -t upload
+ *   pio run -e bench_footprint_compact -t upload
+ *
+ * EXPECTED OUTPUT (STM32F446RE, RTOS_MAX_TASKS = 8)
+ *   [BENCH] ===== footprint =====
+ *   [BENCH] rtos_tcb_t              .. bytes
+ *   [BENCH] rtos_tcb_cold_t         .. bytes
+ *   [BENCH] task pool (8 tasks)     .. bytes
+ *   ...
+ *   (compact: smaller TCB halves, one-pointer wait queues, 16-bit queue
+ *   and semaphore counts)
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "bench_common.h"
+#include "device.h" /* IWYU pragma: keep */
+#include "event_group.h"
+#include "hardware_env.h"
+#include "mempool.h"
+#include "mutex.h"
+#include "queue.h"
+#include "rwlock.h"
+#include "semaphore.h"
+#include "stream_buffer.h"
+#include "task_priv.h" /* rtos_tcb_t, rtos_tcb_cold_t - sizes of the pool entries */
+#include "timer.h"
+#include "uart_tx.h"
+#include "ulog.h"
+#include "wait_queue.h"
+
+/* ========================= SHARED STATE =================================== */
+
+static volatile uint32_t g_test_started = 0;
+
+/* ========================= TASK FUNCTIONS ================================= */
+
+static void report_size(const char *name, uint32_t bytes)
+{
+    ulog_info("[BENCH] %-24s %5lu bytes", name, (unsigned long) bytes);
+}
+
+/**
+ * @brief BenchTask — prints the configuration and the size table
+ */
+void BenchTask(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+
+    bench_header("footprint");
+    ulog_info("[BENCH] RTOS_FOOTPRINT_COMPACT=%u  RTOS_MAX_TASKS=%u  RTOS_MAX_TASK_PRIORITIES=%u",
+              (unsigned) RTOS_FOOTPRINT_COMPACT, (unsigned) RTOS_MAX_TASKS, (unsigned) RTOS_MAX_TASK_PRIORITIES);
+    ulog_info("[BENCH] RTOS_USE_PERIODIC_TASKS=%u  RTOS_USE_EVENT_GROUPS=%u", (unsigned) RTOS_USE_PERIODIC_TASKS,
+              (unsigned) RTOS_USE_EVENT_GROUPS);
+    rtos_delay_ms(50);
+
+    report_size("rtos_tcb_t", sizeof(rtos_tcb_t));
+    report_size("rtos_tcb_cold_t", sizeof(rtos_tcb_cold_t));
+    report_size("per task (hot + cold)", sizeof(rtos_tcb_t) + sizeof(rtos_tcb_cold_t));
+    report_size("task pool (all tasks)", RTOS_MAX_TASKS * (sizeof(rtos_tcb_t) + sizeof(rtos_tcb_cold_t)));
+    rtos_delay_ms(50);
+
+    report_size("rtos_wait_queue_t", sizeof(rtos_wait_queue_t));
+    report_size("rtos_queue_static_t", sizeof(rtos_queue_static_t));
+    report_size("rtos_semaphore_t", sizeof(rtos_semaphore_t));
+    report_size("rtos_mutex_t", sizeof(rtos_mutex_t));
+    report_size("rtos_rwlock_t", sizeof(rtos_rwlock_t));
+#if RTOS_USE_EVENT_GROUPS
+    report_size("rtos_event_group_t", sizeof(rtos_event_group_t));
+#endif
+    rtos_delay_ms(50);
+
+    report_size("rtos_mempool_t", sizeof(rtos_mempool_t));
+    report_size("rtos_stream_buffer_t", sizeof(rtos_stream_buffer_t));
+    report_size("rtos_message_buffer_t", sizeof(rtos_message_buffer_t));
+    report_size("rtos_timer_static_t", sizeof(rtos_timer_static_t));
+    rtos_delay_ms(50);
+
+    ulog_info("[BENCH] Done.");
+
+    rtos_task_suspend(NULL);
+}
+
+/* ========================= STARTUP TIMER ================================== */
+
+static void startup_cb(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_started = 1;
+    ulog_info("[BENCH] Startup hold complete — starting footprint report");
+}
+
+/* ========================= MAIN =========================================== */
+
+int main(void)
+{
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_INFO);
+
+    rtos_init();
+    rtos_profiling_init();
+
+    ulog_init(ULOG_LEVEL_INFO);
+    ulog_info("[BENCH] Kernel Footprint Report — " __DATE__ " " __TIME__);
+
+    rtos_task_handle_t  handle;
+    rtos_timer_handle_t startup_timer;
+
+    /*
+     * Task priority layout:
+     *   BenchTask (2) — prints the report
+     *   LogFlush  (0) — drains ulog ring buffer to UART
+     */
+    rtos_task_create(BenchTask, "Bench", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, 2, &handle);
+
+    test_create_log_flush_task(&handle);
+    test_create_startup_timer(startup_cb, NULL, &startup_timer);
+
+    rtos_start_scheduler();
+
+    while (1) {}
+    return 0;
+}
@@ -0,0 +1,261 @@
+/*******************************************************************************
+ * File: tests/benchmarks/bench_fpu_context/bench_fpu_context.c
+ * Description: Lazy FPU Context Switch Cost Benchmark
+ * Author: Student
+ * Date: 2025
+ *
+ * WHAT IS MEASURED
+ * ----------------
+ * The cost of a yield-driven context switch for each combination of
+ * outgoing and incoming task kind:
+ *
+ *   int    — never touches the FPU; basic frame, EXC_RETURN bit 4 set
+ *   fpu    — runs an FP operation before every yield, so CONTROL.FPCA is set,
+ *            the hardware reserves an extended frame (S0-S15 + FPSCR, saved
+ *            lazily because LSPEN is on) and PendSV saves S16-S31
+ *   nofpu  — integer task created with RTOS_TASK_FLAG_NO_FPU; FPU access is
+ *            revoked while it runs, which costs a CPACR write when switching
+ *            to or from an fpu task
+ *
+ * Each sample is the DWT delta from the outgoing task's stamp right before
+ * rtos_yield() to the incoming task's stamp right after its own rtos_yield()
+ * returns.  The yield call overhead is common to every combination, so the
+ * differences between stats are the FPU save/restore cost.
+ *
+ * SCENARIO
+ * --------
+ * ResultTask runs one phase per pair of task kinds.  Each phase creates two
+ * equal-priority tasks that yield to each other BENCH_WARMUP +
+ * BENCH_ITERATIONS times, waits for both, deletes them and moves on.  Each
+ * task records into the stat for "partner kind -> own kind".  The pair
+ * waits on g_go_sem until both exist, so neither yields to itself alone.
+ *
+ *   Phase  Task A  Task B  Stats
+ *   1      int     int     int->int
+ *   2      int     fpu     fpu->int, int->fpu
+ *   3      fpu     fpu     fpu->fpu
+ *   4      nofpu   fpu     fpu->nofpu, nofpu->fpu
+ *   5      nofpu   nofpu   nofpu->nofpu
+ *
+ * BUILD
+ * -----
+ *   pio run -e bench_fpu_context -t upload
+ *
+ * EXPECTED OUTPUT
+ *   [BENCH] ===== fpu_context =====
+ *   [int->int]: Min=..., Max=..., Avg=..., Cnt=1000
+ *   [int->int]: P50=..., P99=..., P99.9=...
+ *   ...
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "bench_common.h"
+#include "device.h" /* IWYU pragma: keep */
+#include "hardware_env.h"
+#include "profiling.h"
+#include "rtos_port.h"
+#include "semaphore.h"
+#include "task.h"
+#include "uart_tx.h"
+#include "ulog.h"
+
+/* ========================= CONFIGURATION ================================== */
+
+#define PAIR_PRIORITY   (3U)
+#define RESULT_PRIORITY (1U)
+
+typedef enum
+{
+    KIND_INT,
+    KIND_FPU,
+    KIND_NOFPU,
+    KIND_COUNT
+} task_kind_t;
+
+/* ========================= SHARED STATE =================================== */
+
+/** Set to 1 by the startup timer callback to ungate ResultTask. */
+static volatile uint32_t g_test_started = 0;
+
+/** Releases both pair tasks together once both exist. */
+static rtos_semaphore_t g_go_sem;
+
+/** Each pair task signals once when its loop finishes. */
+static rtos_semaphore_t g_done_sem;
+
+/** Outgoing task's DWT stamp just before rtos_yield(). */
+static volatile uint32_t g_yield_cycles = 0;
+
+/** Set when the first task of a pair leaves its loop: its partner's last
+ *  resume is then not a partner-to-partner switch and is not recorded. */
+static volatile uint32_t g_pair_finished = 0;
+
+/** Work for fpu tasks; volatile so the FP op is never optimised out. */
+static volatile float g_fpu_work = 1.0f;
+
+/* ========================= PROFILING STATS ================================ */
+
+static rtos_profile_stat_t g_stat_int_int     = BENCH_STAT_INIT("int->int");
+static rtos_profile_stat_t g_stat_int_fpu     = BENCH_STAT_INIT("int->fpu");
+static rtos_profile_stat_t g_stat_fpu_int     = BENCH_STAT_INIT("fpu->int");
+static rtos_profile_stat_t g_stat_fpu_fpu     = BENCH_STAT_INIT("fpu->fpu");
+static rtos_profile_stat_t g_stat_nofpu_fpu   = BENCH_STAT_INIT("nofpu->fpu");
+static rtos_profile_stat_t g_stat_fpu_nofpu   = BENCH_STAT_INIT("fpu->nofpu");
+static rtos_profile_stat_t g_stat_nofpu_nofpu = BENCH_STAT_INIT("nofpu->nofpu");
+
+/** [outgoing][incoming]; NULL for combinations no phase produces. */
+static rtos_profile_stat_t *const g_stats[KIND_COUNT][KIND_COUNT] = {
+    [KIND_INT]   = {[KIND_INT] = &g_stat_int_int, [KIND_FPU] = &g_stat_int_fpu},
+    [KIND_FPU]   = {[KIND_INT] = &g_stat_fpu_int, [KIND_FPU] = &g_stat_fpu_fpu, [KIND_NOFPU] = &g_stat_fpu_nofpu},
+    [KIND_NOFPU] = {[KIND_FPU] = &g_stat_nofpu_fpu, [KIND_NOFPU] = &g_stat_nofpu_nofpu},
+};
+
+typedef struct
+{
+    task_kind_t          kind;
+    rtos_profile_stat_t *switch_in; /**< Stat for "partner -> this task" */
+} pair_task_cfg_t;
+
+static const task_kind_t g_phases[][2] = {
+    {KIND_INT, KIND_INT}, {KIND_INT, KIND_FPU}, {KIND_FPU, KIND_FPU}, {KIND_NOFPU, KIND_FPU}, {KIND_NOFPU, KIND_NOFPU},
+};
+
+/* ========================= TASK FUNCTIONS ================================= */
+
+/**
+ * @brief PairTask — yields to its equal-priority partner
+ */
+void PairTask(void *param)
+{
+    const pair_task_cfg_t *cfg = (const pair_task_cfg_t *) param;
+
+    rtos_semaphore_wait(&g_go_sem, RTOS_SEM_MAX_WAIT);
+
+    for (uint32_t i = 0; i < BENCH_WARMUP + BENCH_ITERATIONS; i++)
+    {
+        if (cfg->kind == KIND_FPU)
+        {
+            g_fpu_work = g_fpu_work * 1.0001f + 0.5f; /* Sets FPCA: extended frame on switch-out */
+        }
+
+        g_yield_cycles = rtos_profiling_get_cycles();
+        rtos_yield();
+        uint32_t now = rtos_profiling_get_cycles();
+
+        if (i >= BENCH_WARMUP && !g_pair_finished)
+        {
+            rtos_profiling_record(cfg->switch_in, now - g_yield_cycles);
+        }
+    }
+
+    g_pair_finished = 1;
+    rtos_semaphore_signal(&g_done_sem);
+    rtos_task_suspend(NULL);
+}
+
+/**
+ * @brief ResultTask — runs every phase, then prints all stats
+ */
+void ResultTask(void *param)
+{
+    (void) param;
+
+    static pair_task_cfg_t cfg[2];
+
+    TEST_WAIT_FOR_START(g_test_started);
+
+    for (uint32_t p = 0; p < sizeof(g_phases) / sizeof(g_phases[0]); p++)
+    {
+        rtos_task_handle_t handles[2];
+
+        task_kind_t a = g_phases[p][0];
+        task_kind_t b = g_phases[p][1];
+
+        cfg[0].kind      = a;
+        cfg[0].switch_in = g_stats[b][a];
+        cfg[1].kind      = b;
+        cfg[1].switch_in = g_stats[a][b];
+
+        g_pair_finished = 0;
+
+        for (uint32_t t = 0; t < 2; t++)
+        {
+            uint8_t flags = (cfg[t].kind == KIND_NOFPU) ? RTOS_TASK_FLAG_NO_FPU : RTOS_TASK_FLAG_NONE;
+            rtos_task_create_ex(PairTask, t == 0 ? "PairA" : "PairB", RTOS_DEFAULT_TASK_STACK_SIZE, &cfg[t],
+                                PAIR_PRIORITY, flags, &handles[t]);
+        }
+
+        /* Both signals inside one critical section: PendSV stays masked until
+         * both tasks are ready, so neither starts yielding to itself alone */
+        rtos_port_enter_critical();
+        rtos_semaphore_signal(&g_go_sem);
+        rtos_semaphore_signal(&g_go_sem);
+        rtos_port_exit_critical();
+
+        rtos_semaphore_wait(&g_done_sem, RTOS_SEM_MAX_WAIT);
+        rtos_semaphore_wait(&g_done_sem, RTOS_SEM_MAX_WAIT);
+
+        rtos_task_delete(handles[0]);
+        rtos_task_delete(handles[1]);
+    }
+
+    bench_header("fpu_context");
+    bench_report(&g_stat_int_int);
+    bench_report(&g_stat_int_fpu);
+    bench_report(&g_stat_fpu_int);
+    bench_report(&g_stat_fpu_fpu);
+    bench_report(&g_stat_fpu_nofpu);
+    bench_report(&g_stat_nofpu_fpu);
+    bench_report(&g_stat_nofpu_nofpu);
+
+    ulog_info("[BENCH] Done.");
+
+    rtos_task_suspend(NULL);
+}
+
+/* ========================= STARTUP TIMER ================================== */
+
+static void startup_cb(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_started = 1;
+    ulog_info("[BENCH] Startup hold complete — starting FPU context benchmark");
+}
+
+/* ========================= MAIN =========================================== */
+
+int main(void)
+{
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_INFO);
+
+    rtos_init();
+    rtos_profiling_init();
+
+    ulog_init(ULOG_LEVEL_INFO);
+    ulog_info("[BENCH] FPU Context Switch Benchmark — " __DATE__ " " __TIME__);
+    ulog_info("[BENCH] Iterations: %u  Warmup: %u", BENCH_ITERATIONS, BENCH_WARMUP);
+
+    rtos_semaphore_init(&g_go_sem, 0, 2);
+    rtos_semaphore_init(&g_done_sem, 0, 2);
+
+    rtos_task_handle_t  handle;
+    rtos_timer_handle_t startup_timer;
+
+    /*
+     * Task priority layout:
+     *   PairA/PairB (3) — created per phase, yield to each other
+     *   ResultTask  (1) — drives the phases, prints results
+     *   LogFlush    (0) — drains ulog to UART
+     */
+    rtos_task_create(ResultTask, "Result", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, RESULT_PRIORITY, &handle);
+
+    test_create_log_flush_task(&handle);
+    test_create_startup_timer(startup_cb, NULL, &startup_timer);
+
+    rtos_start_scheduler();
+
+    while (1) {}
+    return 0;
+}
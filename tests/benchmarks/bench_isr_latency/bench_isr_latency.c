@@ -0,0 +1,307 @@
+/*******************************************************************************
+ * File: tests/benchmarks/bench_isr_latency/bench_isr_latency.c
+ * Description: Interrupt-to-Task Wakeup Latency Benchmark
+ * Author: Student
+ * Date: 2025
+ *
+ * WHAT IS MEASURED
+ * ----------------
+ * The path from a hardware interrupt to the first line of the task it wakes:
+ *
+ *   Trigger writes NVIC->STIR          (software-triggered interrupt)
+ *     -> BENCH_IRQn handler entry      DWT stamp g_isr_cycles
+ *     -> notify / semaphore signal     wakes Waiter
+ *     -> PendSV context switch
+ *     -> Waiter's first line           DWT stamp, latency = stamp - g_isr_cycles
+ *
+ * Three stats are reported:
+ *
+ *   isr_entry        STIR write to the first line of the handler (hardware
+ *                    exception entry, stacking, vector fetch); sampled
+ *                    during the notify rounds
+ *   isr_notify_wake  handler entry to Waiter running, woken by
+ *                    rtos_task_notify_give_from_isr()
+ *   isr_sem_wake     handler entry to Waiter running, woken by
+ *                    rtos_semaphore_signal_from_isr()
+ *
+ * SCHEDULER TYPES
+ * ---------------
+ * The same source builds as bench_isr_latency (preemptive_sp),
+ * bench_isr_latency_rr and bench_isr_latency_coop.  After pending the
+ * interrupt Trigger blocks on g_done_sem, which Waiter signals once it has
+ * recorded its sample, so every type runs the same sequence.  Under the
+ * preemptive schedulers Waiter preempts at ISR exit.  Under the cooperative
+ * scheduler it runs when Trigger blocks, so the figure also includes
+ * Trigger's path into rtos_semaphore_wait() — that is the wakeup latency an
+ * application actually sees with that policy.
+ *
+ * BUILD
+ * -----
+ *   pio run -e bench_isr_latency -t upload
+ *   pio run -e bench_isr_latency_rr -t upload
+ *   pio run -e bench_isr_latency_coop -t upload
+ *
+ * EXPECTED OUTPUT
+ *   [BENCH] ===== isr_entry =====
+ *   [isr_entry]: Min=..., Max=..., Avg=..., Cnt=1000
+ *   [isr_entry]: P50=..., P99=..., P99.9=...
+ *   [BENCH] ===== isr_notify_wake =====
+ *   ...
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "bench_common.h"
+#include "device.h" /* IWYU pragma: keep */
+#include "hardware_env.h"
+#include "profiling.h"
+#include "rtos_port.h"
+#include "semaphore.h"
+#include "task.h"
+#include "uart_tx.h"
+#include "ulog.h"
+
+/* ========================= PARAMETERS ===================================== */
+
+/* Spare peripheral interrupt, unused on the Nucleo-F446RE */
+#define BENCH_IRQn         SPI4_IRQn
+#define BENCH_IRQHandler   SPI4_IRQHandler
+#define BENCH_IRQ_PRIO     (10U) /* Masked by the kernel (BASEPRI), above the log IRQs */
+
+#define WAITER_PRIORITY  (4U)
+#define TRIGGER_PRIORITY (2U)
+#define RESULT_PRIORITY  (1U)
+
+/* ========================= SHARED STATE =================================== */
+
+typedef enum
+{
+    WAKE_NOTIFY,
+    WAKE_SEMAPHORE
+} wake_mode_t;
+
+/** Startup gate: set to 1 by the startup timer. */
+static volatile uint32_t g_test_started = 0;
+
+/** Primitive the handler uses to wake Waiter. */
+static volatile wake_mode_t g_mode = WAKE_NOTIFY;
+
+/** 0 during warmup: Waiter and Trigger discard their samples. */
+static volatile uint32_t g_recording = 0;
+
+/** DWT stamps: just before the STIR write, and at handler entry. */
+static volatile uint32_t g_pend_cycles = 0;
+static volatile uint32_t g_isr_cycles  = 0;
+
+static rtos_task_handle_t g_waiter_handle = NULL;
+
+/** Semaphore under test (binary, starts empty). */
+static rtos_semaphore_t g_wake_sem;
+
+/** Waiter -> Trigger: sample recorded, next round may start. */
+static rtos_semaphore_t g_done_sem;
+
+/** Trigger -> ResultTask: all rounds finished. */
+static rtos_semaphore_t g_all_done_sem;
+
+/* ========================= PROFILING STATS ================================ */
+
+static rtos_profile_stat_t g_stat_entry  = BENCH_STAT_INIT("isr_entry");
+static rtos_profile_stat_t g_stat_notify = BENCH_STAT_INIT("isr_notify_wake");
+static rtos_profile_stat_t g_stat_sem    = BENCH_STAT_INIT("isr_sem_wake");
+
+/* ========================= INTERRUPT HANDLER ============================== */
+
+void BENCH_IRQHandler(void)
+{
+    /* First statement: the stamp every wake latency is measured from */
+    g_isr_cycles = rtos_profiling_get_cycles();
+
+    bool woken = false;
+
+    if (g_mode == WAKE_NOTIFY)
+    {
+        rtos_task_notify_give_from_isr(g_waiter_handle, &woken);
+    }
+    else
+    {
+        rtos_semaphore_signal_from_isr(&g_wake_sem, &woken);
+    }
+
+    /* One PendSV at exit, however many tasks the handler woke */
+    if (woken)
+    {
+        rtos_port_yield();
+    }
+}
+
+/* ========================= TASK FUNCTIONS ================================= */
+
+/**
+ * @brief Waiter — high-priority task woken by the interrupt
+ *
+ * Blocks on the primitive selected by g_mode, reads DWT as its first action
+ * after waking, then releases Trigger for the next round.
+ */
+void Waiter(void *param)
+{
+    (void) param;
+
+    while (1)
+    {
+        rtos_profile_stat_t *stat;
+
+        if (g_mode == WAKE_NOTIFY)
+        {
+            rtos_task_notify_take(true, RTOS_NOTIFY_MAX_WAIT);
+            stat = &g_stat_notify;
+        }
+        else
+        {
+            rtos_semaphore_wait(&g_wake_sem, RTOS_SEM_MAX_WAIT);
+            stat = &g_stat_sem;
+        }
+
+        uint32_t wake_cycles = rtos_profiling_get_cycles();
+
+        if (g_recording)
+        {
+            rtos_profiling_record(stat, wake_cycles - g_isr_cycles);
+        }
+
+        rtos_semaphore_signal(&g_done_sem);
+    }
+}
+
+/**
+ * @brief Run warmup plus measured rounds for one wake primitive
+ */
+static void run_rounds(wake_mode_t mode)
+{
+    g_mode = mode;
+
+    for (uint32_t i = 0; i < BENCH_WARMUP + BENCH_ITERATIONS; i++)
+    {
+        g_recording = (i >= BENCH_WARMUP) ? 1U : 0U;
+
+        g_pend_cycles = rtos_profiling_get_cycles();
+        NVIC->STIR    = (uint32_t) BENCH_IRQn;
+        __DSB();
+        __ISB();
+
+        /* Waiter has run (preemptive) or runs now (cooperative) */
+        rtos_semaphore_wait(&g_done_sem, RTOS_SEM_MAX_WAIT);
+
+        if (g_recording && mode == WAKE_NOTIFY)
+        {
+            rtos_profiling_record(&g_stat_entry, g_isr_cycles - g_pend_cycles);
+        }
+    }
+}
+
+/**
+ * @brief Trigger — pends the interrupt once per round
+ *
+ * Waiter is switched to the semaphore between the two phases while it is
+ * parked on the notification: the last notification round leaves Waiter
+ * blocked in notify_take, so one extra wake lets it loop round onto the
+ * semaphore before the first semaphore interrupt.
+ */
+void Trigger(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+
+    run_rounds(WAKE_NOTIFY);
+
+    /* Move Waiter from notify_take to semaphore_wait */
+    g_recording = 0;
+    g_mode      = WAKE_SEMAPHORE;
+    rtos_task_notify_give(g_waiter_handle);
+    rtos_semaphore_wait(&g_done_sem, RTOS_SEM_MAX_WAIT);
+
+    run_rounds(WAKE_SEMAPHORE);
+
+    rtos_semaphore_signal(&g_all_done_sem);
+    rtos_task_suspend(NULL);
+}
+
+/**
+ * @brief ResultTask — prints all three stats once Trigger finishes
+ */
+void ResultTask(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+
+    rtos_semaphore_wait(&g_all_done_sem, RTOS_SEM_MAX_WAIT);
+
+    bench_header("isr_entry");
+    bench_report(&g_stat_entry);
+
+    bench_header("isr_notify_wake");
+    bench_report(&g_stat_notify);
+
+    bench_header("isr_sem_wake");
+    bench_report(&g_stat_sem);
+
+    ulog_info("[BENCH] Done. Scheduler type: %u", (unsigned) RTOS_SCHEDULER_TYPE);
+
+    rtos_task_suspend(NULL);
+}
+
+/* ========================= STARTUP TIMER ================================== */
+
+static void startup_cb(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_started = 1;
+    ulog_info("[BENCH] Startup hold complete — starting ISR latency benchmark");
+}
+
+/* ========================= MAIN =========================================== */
+
+int main(void)
+{
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_INFO);
+
+    rtos_init();
+    rtos_profiling_init();
+
+    ulog_init(ULOG_LEVEL_INFO);
+    ulog_info("[BENCH] ISR-to-Task Latency Benchmark — " __DATE__ " " __TIME__);
+    ulog_info("[BENCH] Iterations: %u  Warmup: %u  Scheduler: %u", BENCH_ITERATIONS, BENCH_WARMUP,
+              (unsigned) RTOS_SCHEDULER_TYPE);
+
+    rtos_semaphore_init(&g_wake_sem, 0, 1);
+    rtos_semaphore_init(&g_done_sem, 0, 1);
+    rtos_semaphore_init(&g_all_done_sem, 0, 1);
+
+    rtos_task_handle_t  handle;
+    rtos_timer_handle_t startup_timer;
+
+    /*
+     * Task priority layout:
+     *   Waiter     (4) — woken from the interrupt
+     *   Trigger    (2) — pends the interrupt
+     *   ResultTask (1) — prints results
+     *   LogFlush   (0) — drains ulog to UART
+     */
+    rtos_task_create(Waiter, "Waiter", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, WAITER_PRIORITY, &g_waiter_handle);
+    rtos_task_create(Trigger, "Trigger", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TRIGGER_PRIORITY, &handle);
+    rtos_task_create(ResultTask, "Result", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, RESULT_PRIORITY, &handle);
+
+    test_create_log_flush_task(&handle);
+    test_create_startup_timer(startup_cb, NULL, &startup_timer);
+
+    NVIC_SetPriority(BENCH_IRQn, BENCH_IRQ_PRIO);
+    NVIC_EnableIRQ(BENCH_IRQn);
+
+    rtos_start_scheduler();
+
+    while (1) {}
+    return 0;
+}
@@ -0,0 +1,599 @@
+/*******************************************************************************
+ * File: tests/benchmarks/bench_memory/bench_memory.c
+ * Description: Allocator Trace Replay, Fragmentation and Largest-Block Benchmark
+ * Author: Student
+ * Date: 2025
+ *
+ * WHAT IS MEASURED
+ * ----------------
+ * One pseudo-random allocation trace, replayed through three allocators
+ * that each get the same BENCH_MEM_BUDGET bytes:
+ *
+ *   heap  rtos_malloc() / rtos_free() (TLSF), with the rest of the heap
+ *         taken by ballast so exactly the budget is free
+ *   pool  three rtos_mempool_t, one per request class, each block sized
+ *         for the largest request of its class
+ *   bump  a pointer bumped through the budget, never reused: the
+ *         allocator rtos_malloc() replaced, kept here as the floor for
+ *         allocation cost and to show when it would have run out
+ *
+ * For each allocator:
+ *
+ *   Mem<A>Alloc / Mem<A>Free  cycles per successful call (bump has no free)
+ *   [MEM] <a> op=...          every BENCH_MEM_SAMPLE_OPS operations: live
+ *                             blocks, bytes held, largest allocatable
+ *                             block, waste and external fragmentation
+ *   [MEM] <a> summary         failed allocations, the first one, the worst
+ *                             waste and fragmentation and the smallest
+ *                             largest-block seen
+ *
+ * waste is bytes held beyond what was requested (headers, size-class
+ * rounding, pool block slack, bump space freed but not reclaimable), as a
+ * share of bytes held.  ext is 1 - largest / free: free memory that cannot
+ * be had in one piece.  For the pools, largest is the biggest block class
+ * with a free block.
+ *
+ * SCENARIO
+ * --------
+ *   BenchTask (priority 2):
+ *     Replays BENCH_MEM_OPS operations.  Each one first frees the blocks
+ *     whose lifetime ran out, then allocates one block of a random class:
+ *
+ *       stack  512-2048 B, long-lived   (task create / delete)
+ *       queue  64-576 B, medium-lived   (queue control + storage)
+ *       msg    16-256 B, short-lived    (variable-size messages)
+ *
+ *     Slots per class bound what is live.  A failed allocation still
+ *     takes its slot, so the trace is the same for every allocator.
+ *
+ * BUILD
+ * -----
+ *   pio run -e bench_memory -t upload
+ *
+ * EXPECTED OUTPUT
+ *   [BENCH] ===== memory_heap =====
+ *   [MEM] heap  op=250  live=.. held=.. largest=.. waste=..% ext=..%
+ *   ...
+ *   [MEM] heap  summary: fails=.. first_fail=.. worst_waste=..% worst_ext=..% min_largest=..
+ *   [MemHeapAlloc]: Min=..., Max=..., Avg=..., Cnt=...
+ *   ...   then memory_pool and memory_bump
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "bench_common.h"
+#include "device.h" /* IWYU pragma: keep */
+#include "hardware_env.h"
+#include "memory.h"
+#include "mempool.h"
+#include "profiling.h"
+#include "uart_tx.h"
+#include "ulog.h"
+
+#include <string.h>
+
+/* ========================= CONFIGURATION ================================== */
+
+#ifndef BENCH_MEM_OPS
+#define BENCH_MEM_OPS (4000U)
+#endif
+
+#ifndef BENCH_MEM_SAMPLE_OPS
+#define BENCH_MEM_SAMPLE_OPS (250U)
+#endif
+
+#ifndef BENCH_MEM_SEED
+#define BENCH_MEM_SEED (0x2545F491U)
+#endif
+
+#define MEM_SAMPLES (BENCH_MEM_OPS / BENCH_MEM_SAMPLE_OPS)
+
+typedef enum
+{
+    CLASS_STACK,
+    CLASS_QUEUE,
+    CLASS_MSG,
+    CLASS_COUNT
+} mem_class_id_t;
+
+typedef struct
+{
+    const char *name;
+    uint32_t    slots;    /* Most blocks of the class live at once */
+    uint32_t    weight;   /* Share of allocations, out of 100 */
+    uint32_t    min_size; /* Request sizes: min_size + n * step, up to max_size */
+    uint32_t    max_size;
+    uint32_t    step;
+    uint32_t    min_life; /* Lifetime in operations */
+    uint32_t    max_life;
+} mem_class_t;
+
+#define STACK_SLOTS (4U)
+#define QUEUE_SLOTS (8U)
+#define MSG_SLOTS   (40U)
+#define MEM_SLOTS   (STACK_SLOTS + QUEUE_SLOTS + MSG_SLOTS)
+
+static const mem_class_t g_classes[CLASS_COUNT] = {
+    [CLASS_STACK] = {"stack", STACK_SLOTS, 2U, 512U, 2048U, 512U, 300U, 600U},
+    [CLASS_QUEUE] = {"queue", QUEUE_SLOTS, 8U, 64U, 576U, 16U, 50U, 200U},
+    [CLASS_MSG]   = {"msg", MSG_SLOTS, 90U, 16U, 256U, 8U, 1U, 40U},
+};
+
+/* Every allocator gets what the pools need for the full slot count */
+#define STACK_POOL_BYTES RTOS_MEMPOOL_BUFFER_SIZE(2048U, STACK_SLOTS)
+#define QUEUE_POOL_BYTES RTOS_MEMPOOL_BUFFER_SIZE(576U, QUEUE_SLOTS)
+#define MSG_POOL_BYTES   RTOS_MEMPOOL_BUFFER_SIZE(256U, MSG_SLOTS)
+#define BENCH_MEM_BUDGET (STACK_POOL_BYTES + QUEUE_POOL_BYTES + MSG_POOL_BYTES)
+
+/* Heap ballast is taken in pieces small enough not to be rounded up */
+#define BALLAST_PIECE (120U)
+
+/* Lets LogFlush drain one allocator's lines before the next */
+#define FLUSH_MS (50U)
+
+/* ========================= ALLOCATORS ===================================== */
+
+typedef struct
+{
+    size_t held;    /* Bytes the allocator has given out or lost, headers included */
+    size_t free;    /* Bytes it could still hand out */
+    size_t largest; /* Largest single request it could still satisfy */
+} mem_usage_t;
+
+typedef struct
+{
+    const char          *name;
+    void                 (*reset)(void);
+    void                *(*alloc)(mem_class_id_t cls, size_t size);
+    void                 (*release)(mem_class_id_t cls, void *ptr);
+    void                 (*usage)(mem_usage_t *out);
+    rtos_profile_stat_t *alloc_stat;
+    rtos_profile_stat_t *free_stat;
+} mem_allocator_t;
+
+/* Pools and bump share one buffer; they are replayed one after the other */
+static uint8_t g_arena[BENCH_MEM_BUDGET] __attribute__((aligned(8)));
+
+static size_t g_heap_base_free; /* Heap free bytes with only the ballast held */
+
+static rtos_mempool_t g_pools[CLASS_COUNT];
+
+static size_t g_bump_top;
+
+static void heap_reset(void)
+{
+}
+
+static void *heap_alloc(mem_class_id_t cls, size_t size)
+{
+    (void) cls;
+    return rtos_malloc(size);
+}
+
+static void heap_release(mem_class_id_t cls, void *ptr)
+{
+    (void) cls;
+    rtos_free(ptr);
+}
+
+static void heap_usage(mem_usage_t *out)
+{
+    rtos_memory_stats_t stats;
+
+    rtos_memory_get_stats(&stats);
+    out->held    = g_heap_base_free - stats.free_bytes;
+    out->free    = stats.free_bytes;
+    out->largest = stats.largest_free_block;
+}
+
+static void pool_reset(void)
+{
+    rtos_mempool_init(&g_pools[CLASS_STACK], &g_arena[0], 2048U, STACK_SLOTS);
+    rtos_mempool_init(&g_pools[CLASS_QUEUE], &g_arena[STACK_POOL_BYTES], 576U, QUEUE_SLOTS);
+    rtos_mempool_init(&g_pools[CLASS_MSG], &g_arena[STACK_POOL_BYTES + QUEUE_POOL_BYTES], 256U, MSG_SLOTS);
+}
+
+static void *pool_alloc(mem_class_id_t cls, size_t size)
+{
+    (void) size;
+    return rtos_mempool_alloc(&g_pools[cls], 0);
+}
+
+static void pool_release(mem_class_id_t cls, void *ptr)
+{
+    rtos_mempool_free(&g_pools[cls], ptr);
+}
+
+static void pool_usage(mem_usage_t *out)
+{
+    out->held    = 0;
+    out->free    = 0;
+    out->largest = 0;
+
+    for (uint32_t c = 0; c < CLASS_COUNT; c++)
+    {
+        const rtos_mempool_t *pool = &g_pools[c];
+
+        out->held += (pool->block_count - pool->free_count) * pool->block_size;
+        out->free += pool->free_count * pool->block_size;
+        if (pool->free_count != 0U && pool->block_size > out->largest)
+        {
+            out->largest = pool->block_size;
+        }
+    }
+}
+
+static void bump_reset(void)
+{
+    g_bump_top = 0;
+}
+
+static void *bump_alloc(mem_class_id_t cls, size_t size)
+{
+    size_t aligned = (size + 7U) & ~(size_t) 7U;
+
+    (void) cls;
+    if (aligned > BENCH_MEM_BUDGET - g_bump_top)
+    {
+        return NULL;
+    }
+
+    void *ptr = &g_arena[g_bump_top];
+    g_bump_top += aligned;
+    return ptr;
+}
+
+static void bump_release(mem_class_id_t cls, void *ptr)
+{
+    (void) cls;
+    (void) ptr;
+}
+
+static void bump_usage(mem_usage_t *out)
+{
+    out->held    = g_bump_top;
+    out->free    = BENCH_MEM_BUDGET - g_bump_top;
+    out->largest = out->free;
+}
+
+/* ========================= PROFILING STATS ================================ */
+
+static rtos_profile_stat_t g_stat_heap_alloc = BENCH_STAT_INIT("MemHeapAlloc");
+static rtos_profile_stat_t g_stat_heap_free  = BENCH_STAT_INIT("MemHeapFree");
+static rtos_profile_stat_t g_stat_pool_alloc = BENCH_STAT_INIT("MemPoolAlloc");
+static rtos_profile_stat_t g_stat_pool_free  = BENCH_STAT_INIT("MemPoolFree");
+static rtos_profile_stat_t g_stat_bump_alloc = BENCH_STAT_INIT("MemBumpAlloc");
+
+static const mem_allocator_t g_allocators[] = {
+    {"heap", heap_reset, heap_alloc, heap_release, heap_usage, &g_stat_heap_alloc, &g_stat_heap_free},
+    {"pool", pool_reset, pool_alloc, pool_release, pool_usage, &g_stat_pool_alloc, &g_stat_pool_free},
+    {"bump", bump_reset, bump_alloc, bump_release, bump_usage, &g_stat_bump_alloc, NULL},
+};
+
+#define MEM_ALLOCATORS (sizeof(g_allocators) / sizeof(g_allocators[0]))
+
+/* ========================= TRACE REPLAY =================================== */
+
+typedef struct
+{
+    mem_class_id_t cls;
+    uint32_t       life; /* Operations left; 0 = slot empty */
+    size_t         size;
+    void          *ptr;  /* NULL while live if the allocation failed */
+} mem_slot_t;
+
+typedef struct
+{
+    uint32_t op;
+    uint32_t live;
+    size_t   held;
+    size_t   largest;
+    uint32_t waste_pct;
+    uint32_t ext_pct;
+} mem_sample_t;
+
+static volatile uint32_t g_test_started = 0;
+
+static mem_slot_t   g_slots[MEM_SLOTS];
+static mem_sample_t g_samples[MEM_SAMPLES];
+static uint32_t     g_rng;
+
+static uint32_t g_fails;
+static uint32_t g_first_fail;
+static uint32_t g_worst_waste;
+static uint32_t g_worst_ext;
+static size_t   g_min_largest;
+static size_t   g_requested; /* Bytes of live successful requests */
+
+static uint32_t rng_next(void)
+{
+    /* xorshift32: the same trace for every allocator */
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return g_rng;
+}
+
+static uint32_t rng_range(uint32_t lo, uint32_t hi)
+{
+    return lo + rng_next() % (hi - lo + 1U);
+}
+
+static mem_class_id_t pick_class(void)
+{
+    uint32_t roll = rng_next() % 100U;
+
+    for (uint32_t c = 0; c < CLASS_COUNT; c++)
+    {
+        if (roll < g_classes[c].weight)
+        {
+            return (mem_class_id_t) c;
+        }
+        roll -= g_classes[c].weight;
+    }
+    return CLASS_MSG;
+}
+
+/* First slot of the class, in the class's range of g_slots */
+static uint32_t class_first_slot(mem_class_id_t cls)
+{
+    uint32_t first = 0;
+
+    for (uint32_t c = 0; c < (uint32_t) cls; c++)
+    {
+        first += g_classes[c].slots;
+    }
+    return first;
+}
+
+static void release_slot(const mem_allocator_t *a, mem_slot_t *slot)
+{
+    if (slot->ptr != NULL)
+    {
+        uint32_t t0 = rtos_profiling_get_cycles();
+        a->release(slot->cls, slot->ptr);
+        uint32_t cycles = rtos_profiling_get_cycles() - t0;
+
+        if (a->free_stat != NULL)
+        {
+            rtos_profiling_record(a->free_stat, cycles);
+        }
+        g_requested -= slot->size;
+        slot->ptr = NULL;
+    }
+    slot->life = 0;
+}
+
+static void take_sample(const mem_allocator_t *a, uint32_t op, uint32_t live, mem_sample_t *sample)
+{
+    mem_usage_t usage;
+
+    a->usage(&usage);
+
+    uint32_t waste = (usage.held != 0U) ? (uint32_t) (((usage.held - g_requested) * 100U) / usage.held) : 0U;
+    uint32_t ext   = (usage.free != 0U) ? (uint32_t) (100U - (usage.largest * 100U) / usage.free) : 0U;
+
+    if (waste > g_worst_waste)
+    {
+        g_worst_waste = waste;
+    }
+    if (ext > g_worst_ext)
+    {
+        g_worst_ext = ext;
+    }
+    if (usage.largest < g_min_largest)
+    {
+        g_min_largest = usage.largest;
+    }
+
+    if (sample != NULL)
+    {
+        sample->op        = op;
+        sample->live      = live;
+        sample->held      = usage.held;
+        sample->largest   = usage.largest;
+        sample->waste_pct = waste;
+        sample->ext_pct   = ext;
+    }
+}
+
+static void replay(const mem_allocator_t *a)
+{
+    memset(g_slots, 0, sizeof(g_slots));
+    g_rng         = BENCH_MEM_SEED;
+    g_fails       = 0;
+    g_first_fail  = 0;
+    g_worst_waste = 0;
+    g_worst_ext   = 0;
+    g_min_largest = SIZE_MAX;
+    g_requested   = 0;
+
+    a->reset();
+
+    for (uint32_t op = 1; op <= BENCH_MEM_OPS; op++)
+    {
+        uint32_t live = 0;
+
+        /* Frees due this operation, in slot order */
+        for (uint32_t i = 0; i < MEM_SLOTS; i++)
+        {
+            if (g_slots[i].life != 0U && --g_slots[i].life == 0U)
+            {
+                release_slot(a, &g_slots[i]);
+            }
+            live += (g_slots[i].ptr != NULL) ? 1U : 0U;
+        }
+
+        mem_class_id_t     cls   = pick_class();
+        const mem_class_t *spec  = &g_classes[cls];
+        uint32_t           steps = (spec->max_size - spec->min_size) / spec->step;
+        size_t             size  = spec->min_size + rng_range(0U, steps) * spec->step;
+        uint32_t           life  = rng_range(spec->min_life, spec->max_life);
+        uint32_t           first = class_first_slot(cls);
+
+        for (uint32_t i = first; i < first + spec->slots; i++)
+        {
+            mem_slot_t *slot = &g_slots[i];
+            if (slot->life != 0U)
+            {
+                continue;
+            }
+
+            uint32_t t0     = rtos_profiling_get_cycles();
+            void    *ptr    = a->alloc(cls, size);
+            uint32_t cycles = rtos_profiling_get_cycles() - t0;
+
+            slot->cls  = cls;
+            slot->life = life;
+            slot->size = size;
+            slot->ptr  = ptr;
+
+            if (ptr == NULL)
+            {
+                g_fails++;
+                g_first_fail = (g_first_fail == 0U) ? op : g_first_fail;
+            }
+            else
+            {
+                rtos_profiling_record(a->alloc_stat, cycles);
+                g_requested += size;
+                live++;
+            }
+            break;
+        }
+
+        bool sampled = (op % BENCH_MEM_SAMPLE_OPS) == 0U;
+        take_sample(a, op, live, sampled ? &g_samples[op / BENCH_MEM_SAMPLE_OPS - 1U] : NULL);
+    }
+
+    /* Return everything, so the heap is back to the ballast for the next run */
+    for (uint32_t i = 0; i < MEM_SLOTS; i++)
+    {
+        if (g_slots[i].life != 0U)
+        {
+            release_slot(a, &g_slots[i]);
+        }
+    }
+}
+
+static void report(const mem_allocator_t *a)
+{
+    for (uint32_t s = 0; s < MEM_SAMPLES; s++)
+    {
+        const mem_sample_t *sample = &g_samples[s];
+        ulog_info("[MEM] %s  op=%-4lu live=%-2lu held=%-5lu largest=%-5lu waste=%lu%% ext=%lu%%", a->name,
+                  (unsigned long) sample->op, (unsigned long) sample->live, (unsigned long) sample->held,
+                  (unsigned long) sample->largest, (unsigned long) sample->waste_pct,
+                  (unsigned long) sample->ext_pct);
+        if ((s & 3U) == 3U)
+        {
+            rtos_delay_ms(FLUSH_MS);
+        }
+    }
+
+    ulog_info("[MEM] %s  summary: fails=%lu first_fail=%lu worst_waste=%lu%% worst_ext=%lu%% min_largest=%lu",
+              a->name, (unsigned long) g_fails, (unsigned long) g_first_fail, (unsigned long) g_worst_waste,
+              (unsigned long) g_worst_ext, (unsigned long) g_min_largest);
+    bench_report(a->alloc_stat);
+    if (a->free_stat != NULL)
+    {
+        bench_report(a->free_stat);
+    }
+    rtos_delay_ms(FLUSH_MS);
+}
+
+/* Hold the heap down to the budget, so it competes on equal terms */
+static bool heap_take_ballast(void)
+{
+    rtos_memory_stats_t stats;
+
+    rtos_memory_get_stats(&stats);
+    while (stats.free_bytes >= BENCH_MEM_BUDGET + 2U * BALLAST_PIECE)
+    {
+        if (rtos_malloc(BALLAST_PIECE) == NULL)
+        {
+            break;
+        }
+        rtos_memory_get_stats(&stats);
+    }
+
+    g_heap_base_free = stats.free_bytes;
+    return stats.free_bytes >= BENCH_MEM_BUDGET;
+}
+
+/* ========================= TASK FUNCTIONS ================================= */
+
+/**
+ * @brief BenchTask — replays the trace through each allocator and reports
+ */
+void BenchTask(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+
+    if (!heap_take_ballast())
+    {
+        ulog_error("[BENCH] Heap has %lu B free, needs %lu B: raise RTOS_TOTAL_HEAP_SIZE",
+                   (unsigned long) g_heap_base_free, (unsigned long) BENCH_MEM_BUDGET);
+    }
+    ulog_info("[BENCH] Budget %lu B, heap free after ballast %lu B", (unsigned long) BENCH_MEM_BUDGET,
+              (unsigned long) g_heap_base_free);
+
+    for (uint32_t i = 0; i < MEM_ALLOCATORS; i++)
+    {
+        const mem_allocator_t *a = &g_allocators[i];
+
+        replay(a);
+
+        /* bench_header() takes a literal */
+        ulog_info("[BENCH] ===== memory_%s =====", a->name);
+        report(a);
+    }
+
+    ulog_info("[BENCH] Done. Ops: %u  Seed: 0x%08lx", BENCH_MEM_OPS, (unsigned long) BENCH_MEM_SEED);
+
+    rtos_task_suspend(NULL);
+}
+
+/* ========================= STARTUP TIMER ================================== */
+
+static void startup_cb(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_started = 1;
+    ulog_info("[BENCH] Startup hold complete — starting allocator benchmark");
+}
+
+/* ========================= MAIN =========================================== */
+
+int main(void)
+{
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_INFO);
+
+    rtos_init();
+    rtos_profiling_init();
+
+    ulog_init(ULOG_LEVEL_INFO);
+    ulog_info("[BENCH] Allocator Trace Benchmark — " __DATE__ " " __TIME__);
+    ulog_info("[BENCH] Ops: %u  Sample every: %u  Allocators: heap/pool/bump", BENCH_MEM_OPS, BENCH_MEM_SAMPLE_OPS);
+
+    rtos_task_handle_t  handle;
+    rtos_timer_handle_t startup_timer;
+
+    /*
+     * Task priority layout:
+     *   BenchTask (2) — replays the trace
+     *   LogFlush  (0) — drains ulog ring buffer to UART
+     */
+    rtos_task_create(BenchTask, "Bench", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, 2, &handle);
+
+    test_create_log_flush_task(&handle);
+    test_create_startup_timer(startup_cb, NULL, &startup_timer);
+
+    rtos_start_scheduler();
+
+    while (1) {}
+    return 0;
+}
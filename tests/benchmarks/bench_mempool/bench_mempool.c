@@ -0,0 +1,236 @@
+/*******************************************************************************
+ * File: tests/benchmarks/bench_mempool/bench_mempool.c
+ * Description: Fixed-Block Pool vs. Heap Allocation Benchmark
+ * Author: Student
+ * Date: 2025
+ *
+ * WHAT IS MEASURED
+ * ----------------
+ * Cycle cost of a single allocate and a single free of a BENCH_BLOCK_SIZE
+ * message payload through:
+ *
+ *   1. rtos_mempool_alloc(pool, 0) / rtos_mempool_free()
+ *   2. rtos_mempool_alloc_from_isr() / rtos_mempool_free_from_isr()
+ *      (called from task context — measures the ISR-path cost only)
+ *   3. rtos_malloc() / rtos_free()
+ *
+ * Each call is bracketed by RTOS_USER_PROFILE_START/END (DWT cycle counter).
+ *
+ * SCENARIO
+ * --------
+ *   BenchTask (priority 2):
+ *     Holds BENCH_LIVE_BLOCKS allocations from each allocator so both
+ *     operate on a partly used pool/heap, then for each iteration
+ *     allocates and immediately frees one more block, cycling the size
+ *     of the held heap blocks so the TLSF free lists are not trivially
+ *     a single block.
+ *
+ *   The pool is sized BENCH_LIVE_BLOCKS + 1, so every measured alloc
+ *   also takes the last free block (worst case for the free list).
+ *
+ * BUILD
+ * -----
+ *   pio run -e bench_mempool -t upload
+ *
+ * EXPECTED OUTPUT (at 180 MHz, STM32F446RE)
+ *   [BENCH] ===== mempool_vs_malloc =====
+ *   [PoolAlloc]: Min=.. cyc, Max=.. cyc ...   (constant, tens of cycles)
+ *   [HeapAlloc]: Min=.. cyc, Max=.. cyc ...   (bounded, 2-4x pool)
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "bench_common.h"
+#include "device.h" /* IWYU pragma: keep */
+#include "hardware_env.h"
+#include "memory.h"
+#include "mempool.h"
+#include "profiling.h"
+#include "uart_tx.h"
+#include "ulog.h"
+
+/* ========================= CONFIGURATION ================================== */
+
+#ifndef BENCH_BLOCK_SIZE
+#define BENCH_BLOCK_SIZE (32U)
+#endif
+
+#ifndef BENCH_LIVE_BLOCKS
+#define BENCH_LIVE_BLOCKS (15U)
+#endif
+
+/* ========================= SHARED STATE =================================== */
+
+static volatile uint32_t g_test_started = 0;
+
+static rtos_mempool_t g_pool;
+static uint8_t        g_pool_storage[RTOS_MEMPOOL_BUFFER_SIZE(BENCH_BLOCK_SIZE, BENCH_LIVE_BLOCKS + 1U)]
+    __attribute__((aligned(8)));
+
+/* ========================= PROFILING STATS ================================ */
+
+static rtos_profile_stat_t g_stat_pool_alloc     = BENCH_STAT_INIT("PoolAlloc");
+static rtos_profile_stat_t g_stat_pool_free      = BENCH_STAT_INIT("PoolFree");
+static rtos_profile_stat_t g_stat_pool_isr_alloc = BENCH_STAT_INIT("PoolAllocISR");
+static rtos_profile_stat_t g_stat_pool_isr_free  = BENCH_STAT_INIT("PoolFreeISR");
+static rtos_profile_stat_t g_stat_heap_alloc     = BENCH_STAT_INIT("HeapAlloc");
+static rtos_profile_stat_t g_stat_heap_free      = BENCH_STAT_INIT("HeapFree");
+
+/* ========================= TASK FUNCTIONS ================================= */
+
+static void bench_pool_once(bool record)
+{
+    RTOS_USER_PROFILE_START(alloc);
+    void *block = rtos_mempool_alloc(&g_pool, 0);
+    if (record)
+    {
+        RTOS_USER_PROFILE_END(alloc, &g_stat_pool_alloc);
+    }
+
+    RTOS_USER_PROFILE_START(release);
+    rtos_mempool_free(&g_pool, block);
+    if (record)
+    {
+        RTOS_USER_PROFILE_END(release, &g_stat_pool_free);
+    }
+
+    RTOS_USER_PROFILE_START(isr_alloc);
+    block = rtos_mempool_alloc_from_isr(&g_pool);
+    if (record)
+    {
+        RTOS_USER_PROFILE_END(isr_alloc, &g_stat_pool_isr_alloc);
+    }
+
+    RTOS_USER_PROFILE_START(isr_release);
+    rtos_mempool_free_from_isr(&g_pool, block);
+    if (record)
+    {
+        RTOS_USER_PROFILE_END(isr_release, &g_stat_pool_isr_free);
+    }
+}
+
+static void bench_heap_once(bool record)
+{
+    RTOS_USER_PROFILE_START(alloc);
+    void *block = rtos_malloc(BENCH_BLOCK_SIZE);
+    if (record)
+    {
+        RTOS_USER_PROFILE_END(alloc, &g_stat_heap_alloc);
+    }
+
+    RTOS_USER_PROFILE_START(release);
+    rtos_free(block);
+    if (record)
+    {
+        RTOS_USER_PROFILE_END(release, &g_stat_heap_free);
+    }
+}
+
+/**
+ * @brief BenchTask — runs warmup, then the measured alloc/free pairs
+ */
+void BenchTask(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+
+    void *pool_live[BENCH_LIVE_BLOCKS];
+    void *heap_live[BENCH_LIVE_BLOCKS];
+
+    for (uint32_t i = 0; i < BENCH_LIVE_BLOCKS; i++)
+    {
+        pool_live[i] = rtos_mempool_alloc(&g_pool, 0);
+        heap_live[i] = rtos_malloc(BENCH_BLOCK_SIZE + (i * 8U));
+    }
+
+    for (uint32_t i = 0; i < BENCH_WARMUP; i++)
+    {
+        bench_pool_once(false);
+        bench_heap_once(false);
+    }
+
+    for (uint32_t i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        bench_pool_once(true);
+        bench_heap_once(true);
+
+        /* Re-size one held heap block so the free lists keep changing */
+        uint32_t slot   = i % BENCH_LIVE_BLOCKS;
+        rtos_free(heap_live[slot]);
+        heap_live[slot] = rtos_malloc(BENCH_BLOCK_SIZE + ((i % 7U) * 24U));
+    }
+
+    bench_header("mempool_vs_malloc");
+    bench_report(&g_stat_pool_alloc);
+    bench_report(&g_stat_pool_free);
+    bench_report(&g_stat_pool_isr_alloc);
+    bench_report(&g_stat_pool_isr_free);
+    bench_report(&g_stat_heap_alloc);
+    bench_report(&g_stat_heap_free);
+
+    rtos_mempool_stats_t pool_stats;
+    rtos_mempool_get_stats(&g_pool, &pool_stats);
+    ulog_info("[BENCH] pool: blocks=%lu peak_used=%lu fails=%lu", (unsigned long) pool_stats.block_count,
+              (unsigned long) pool_stats.peak_used, (unsigned long) pool_stats.fail_count);
+
+    rtos_memory_stats_t heap_stats;
+    rtos_memory_get_stats(&heap_stats);
+    ulog_info("[BENCH] heap: free=%lu largest=%lu peak_used=%lu", (unsigned long) heap_stats.free_bytes,
+              (unsigned long) heap_stats.largest_free_block, (unsigned long) heap_stats.peak_used_bytes);
+
+    for (uint32_t i = 0; i < BENCH_LIVE_BLOCKS; i++)
+    {
+        rtos_mempool_free(&g_pool, pool_live[i]);
+        rtos_free(heap_live[i]);
+    }
+
+    ulog_info("[BENCH] Done.");
+
+    rtos_task_suspend(NULL);
+}
+
+/* ========================= STARTUP TIMER ================================== */
+
+static void startup_cb(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_started = 1;
+    ulog_info("[BENCH] Startup hold complete — starting mempool benchmark");
+}
+
+/* ========================= MAIN =========================================== */
+
+int main(void)
+{
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_INFO);
+
+    rtos_init();
+    rtos_profiling_init();
+
+    ulog_init(ULOG_LEVEL_INFO);
+    ulog_info("[BENCH] Mempool vs. Heap Benchmark — " __DATE__ " " __TIME__);
+    ulog_info("[BENCH] Iterations: %u  Warmup: %u  Block: %u B  Live: %u", BENCH_ITERATIONS, BENCH_WARMUP,
+              BENCH_BLOCK_SIZE, BENCH_LIVE_BLOCKS);
+
+    rtos_mempool_init(&g_pool, g_pool_storage, BENCH_BLOCK_SIZE, BENCH_LIVE_BLOCKS + 1U);
+
+    rtos_task_handle_t  handle;
+    rtos_timer_handle_t startup_timer;
+
+    /*
+     * Task priority layout:
+     *   BenchTask (2) — runs the measurements
+     *   LogFlush  (0) — drains ulog ring buffer to UART
+     */
+    rtos_task_create(BenchTask, "Bench", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, 2, &handle);
+
+    test_create_log_flush_task(&handle);
+    test_create_startup_timer(startup_cb, NULL, &startup_timer);
+
+    rtos_start_scheduler();
+
+    while (1) {}
+    return 0;
+}
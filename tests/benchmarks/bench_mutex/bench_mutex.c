@@ -11,7 +11,8 @@
  * Phase 1 — Uncontended acquire+release:
  *   A single task acquires and immediately releases a mutex in a tight loop.
  *   Measures the raw software overhead of the lock/unlock path with no
- *   blocking or context switches.
+ *   blocking or context switches.  Both calls take the LDREX/STREX fast
+ *   path and never enter the BASEPRI critical section.
  *
  *   Measurement window:
  *     RTOS_USER_PROFILE_START(mu)
@@ -47,11 +48,11 @@
 
 #include "VRTOS.h"
 #include "bench_common.h"
+#include "device.h" /* IWYU pragma: keep */
 #include "hardware_env.h"
 #include "mutex.h"
 #include "profiling.h"
 #include "semaphore.h"
-#include "stm32f4xx_hal.h" /* IWYU pragma: keep */
 #include "uart_tx.h"
 #include "ulog.h"
 
@@ -38,7 +38,37 @@
  *     6. Loops back to receive (re-blocks on empty queue)
  *
  * After BENCH_ITERATIONS messages, Consumer signals g_done_sem.
- * ResultTask wakes, prints g_stat_queue_latency, and suspends.
+ * ResultTask wakes, runs the byte-stream comparison below, prints all
+ * stats, and suspends.
+ *
+ * BYTE STREAMS: QUEUE VS STREAM / MESSAGE BUFFER
+ * ----------------------------------------------
+ * Cycles per byte to move a BYTE_CHUNK-byte packet through each primitive
+ * and back out, on objects nobody blocks on (no context switch included):
+ *
+ *   byte_queue    BYTE_CHUNK x rtos_queue_send() + rtos_queue_receive()
+ *                 on a queue with item_size 1 (the pattern being replaced)
+ *   byte_stream   BYTE_CHUNK x 1-byte rtos_stream_buffer_send() (as a UART
+ *                 RX ISR writes) + one rtos_stream_buffer_receive()
+ *   byte_message  one rtos_message_buffer_send() + receive of the packet
+ *
+ * ITEMS: QUEUE VS SPSC CHANNEL
+ * ----------------------------
+ * Cycles per item to move ITEM_BATCH uint32_t samples in and back out:
+ *
+ *   item_queue    rtos_queue_send() + rtos_queue_receive() per item; each
+ *                 call takes the kernel critical section
+ *   item_spsc     rtos_spsc_send() + rtos_spsc_receive() per item; index
+ *                 updates only, plus one notification of ResultTask (the
+ *                 consumer) for the send into the empty channel
+ *
+ * TYPED C++ QUEUES (bench_queue_typed.cpp)
+ * ----------------------------------------
+ * Same batches through vrtos::Queue (include/vrtos.hpp) next to the raw
+ * calls: item_typed (uint32_t, the copying calls like item_queue), and a
+ * 32-byte frame through rtos_queue_send/receive (frame_queue), typed
+ * send/receive with an inlined fixed-size copy (frame_typed), and
+ * emplace/consume building and reading it in the slot (frame_emplace).
  *
  * WHY CONSUMER IS HIGHER PRIORITY
  * ---------------------------------
@@ -54,18 +84,28 @@
  * EXPECTED OUTPUT (at 180 MHz, STM32F446RE)
  *   [BENCH] ===== queue_delivery_latency =====
  *   queue_delivery_latency | count=1000 | min=83cy(0us) max=127cy(1us) avg=91cy(1us)
+ *   [BENCH] ===== byte_queue (cycles per byte) =====
+ *   ...                     (byte_stream and byte_message several times cheaper)
+ *   [BENCH] ===== item_queue (cycles per item) =====
+ *   ...                     (item_spsc a few dozen cycles per item)
+ *   ...                     (frame_typed below frame_queue, frame_emplace lowest)
  ******************************************************************************/
 
 #include "VRTOS.h"
 #include "bench_common.h"
+#include "bench_queue_typed.h"
+#include "device.h" /* IWYU pragma: keep */
 #include "hardware_env.h"
 #include "profiling.h"
 #include "queue.h"
 #include "semaphore.h"
-#include "stm32f4xx_hal.h" /* IWYU pragma: keep */
+#include "spsc.h"
+#include "stream_buffer.h"
 #include "uart_tx.h"
 #include "ulog.h"
 
+#include <string.h>
+
 /* ========================= SHARED STATE =================================== */
 
 /** Message queue: holds up to 4 uint32_t timestamps (deep enough to never block producer). */
@@ -77,11 +117,50 @@ static volatile uint32_t g_test_started = 0;
 /** Signalled by Consumer when all BENCH_ITERATIONS messages have been processed. */
 static rtos_semaphore_t g_done_sem;
 
+/** Packet size for the byte-stream comparison. */
+#define BYTE_CHUNK        (16U)
+#define BYTE_STORAGE_SIZE (64U) /* Power of 2, several packets deep */
+
+static rtos_queue_handle_t   g_byte_queue;
+static rtos_stream_buffer_t  g_stream;
+static rtos_message_buffer_t g_message;
+
+static uint8_t g_stream_storage[BYTE_STORAGE_SIZE] __attribute__((aligned(4)));
+static uint8_t g_message_storage[BYTE_STORAGE_SIZE] __attribute__((aligned(4)));
+
+/** ResultTask pause between report blocks, so LogFlush can empty the ulog ring. */
+#define LOG_DRAIN_MS (100U)
+
+/** Batch size for the item comparison (also the capacity of both objects). */
+#define ITEM_BATCH (8U)
+
+static rtos_queue_handle_t g_item_queue;
+static rtos_spsc_t         g_item_spsc;
+static uint32_t            g_item_spsc_storage[ITEM_BATCH];
+
+/** Packets whose bytes came back wrong (must stay 0). */
+static uint32_t g_byte_errors = 0;
+
 /* ========================= PROFILING STAT ================================= */
 
 /** One-way message delivery latency (Producer DWT capture → Consumer DWT read on wake). */
 static rtos_profile_stat_t g_stat_queue_latency = BENCH_STAT_INIT("queue_delivery_latency");
 
+/** Cycles per byte for one BYTE_CHUNK packet in and out. */
+static rtos_profile_stat_t g_stat_byte_queue   = BENCH_STAT_INIT("byte_queue");
+static rtos_profile_stat_t g_stat_byte_stream  = BENCH_STAT_INIT("byte_stream");
+static rtos_profile_stat_t g_stat_byte_message = BENCH_STAT_INIT("byte_message");
+
+/** Cycles per item for one ITEM_BATCH batch in and out. */
+static rtos_profile_stat_t g_stat_item_queue = BENCH_STAT_INIT("item_queue");
+static rtos_profile_stat_t g_stat_item_spsc  = BENCH_STAT_INIT("item_spsc");
+
+/** Cycles per item through vrtos::Queue and the raw calls it is compared with. */
+static rtos_profile_stat_t g_stat_item_typed    = BENCH_STAT_INIT("item_typed");
+static rtos_profile_stat_t g_stat_frame_queue   = BENCH_STAT_INIT("frame_queue");
+static rtos_profile_stat_t g_stat_frame_typed   = BENCH_STAT_INIT("frame_typed");
+static rtos_profile_stat_t g_stat_frame_emplace = BENCH_STAT_INIT("frame_emplace");
+
 /* ========================= TASK FUNCTIONS ================================= */
 
 /**
@@ -168,7 +247,143 @@ void ConsumerTask(void *param)
 }
 
 /**
- * @brief ResultTask — prints delivery latency statistics
+ * @brief Time one packet through each byte primitive, round-robin
+ */
+static void run_byte_comparison(void)
+{
+    uint8_t tx[BYTE_CHUNK];
+    uint8_t rx[BYTE_CHUNK];
+
+    for (uint32_t i = 0; i < BENCH_WARMUP + BENCH_ITERATIONS; i++)
+    {
+        bool     record = (i >= BENCH_WARMUP);
+        uint32_t len    = 0;
+
+        for (uint32_t b = 0; b < BYTE_CHUNK; b++)
+        {
+            tx[b] = (uint8_t) (i + b);
+        }
+
+        /* --- Queue, one byte per call --- */
+        uint32_t t0 = rtos_profiling_get_cycles();
+        for (uint32_t b = 0; b < BYTE_CHUNK; b++)
+        {
+            rtos_queue_send(g_byte_queue, &tx[b], 0);
+        }
+        for (uint32_t b = 0; b < BYTE_CHUNK; b++)
+        {
+            rtos_queue_receive(g_byte_queue, &rx[b], 0);
+        }
+        uint32_t cycles = rtos_profiling_get_cycles() - t0;
+        if (record)
+        {
+            rtos_profiling_record(&g_stat_byte_queue, cycles / BYTE_CHUNK);
+        }
+        if (memcmp(tx, rx, BYTE_CHUNK) != 0)
+        {
+            g_byte_errors++;
+        }
+
+        /* --- Stream buffer, bytes in one at a time, read as a span --- */
+        t0 = rtos_profiling_get_cycles();
+        for (uint32_t b = 0; b < BYTE_CHUNK; b++)
+        {
+            rtos_stream_buffer_send(&g_stream, &tx[b], 1, NULL, 0);
+        }
+        rtos_stream_buffer_receive(&g_stream, rx, BYTE_CHUNK, &len, 0);
+        cycles = rtos_profiling_get_cycles() - t0;
+        if (record)
+        {
+            rtos_profiling_record(&g_stat_byte_stream, cycles / BYTE_CHUNK);
+        }
+        if (len != BYTE_CHUNK || memcmp(tx, rx, BYTE_CHUNK) != 0)
+        {
+            g_byte_errors++;
+        }
+
+        /* --- Message buffer, whole packet --- */
+        t0 = rtos_profiling_get_cycles();
+        rtos_message_buffer_send(&g_message, tx, BYTE_CHUNK, 0);
+        rtos_message_buffer_receive(&g_message, rx, BYTE_CHUNK, &len, 0);
+        cycles = rtos_profiling_get_cycles() - t0;
+        if (record)
+        {
+            rtos_profiling_record(&g_stat_byte_message, cycles / BYTE_CHUNK);
+        }
+        if (len != BYTE_CHUNK || memcmp(tx, rx, BYTE_CHUNK) != 0)
+        {
+            g_byte_errors++;
+        }
+    }
+}
+
+/**
+ * @brief Time one batch of word items through a queue and an SPSC channel
+ */
+static void run_item_comparison(void)
+{
+    uint32_t tx[ITEM_BATCH];
+    uint32_t rx[ITEM_BATCH];
+
+    rtos_spsc_init(&g_item_spsc, g_item_spsc_storage, sizeof(uint32_t), ITEM_BATCH, rtos_task_get_current(),
+                   RTOS_TASK_NOTIFY_DEFAULT_INDEX);
+
+    for (uint32_t i = 0; i < BENCH_WARMUP + BENCH_ITERATIONS; i++)
+    {
+        bool record = (i >= BENCH_WARMUP);
+
+        for (uint32_t n = 0; n < ITEM_BATCH; n++)
+        {
+            tx[n] = i * ITEM_BATCH + n;
+        }
+
+        /* --- Queue --- */
+        uint32_t t0 = rtos_profiling_get_cycles();
+        for (uint32_t n = 0; n < ITEM_BATCH; n++)
+        {
+            rtos_queue_send(g_item_queue, &tx[n], 0);
+        }
+        for (uint32_t n = 0; n < ITEM_BATCH; n++)
+        {
+            rtos_queue_receive(g_item_queue, &rx[n], 0);
+        }
+        uint32_t cycles = rtos_profiling_get_cycles() - t0;
+        if (record)
+        {
+            rtos_profiling_record(&g_stat_item_queue, cycles / ITEM_BATCH);
+        }
+        if (memcmp(tx, rx, sizeof(tx)) != 0)
+        {
+            g_byte_errors++;
+        }
+
+        /* --- SPSC channel --- */
+        t0 = rtos_profiling_get_cycles();
+        for (uint32_t n = 0; n < ITEM_BATCH; n++)
+        {
+            rtos_spsc_send(&g_item_spsc, &tx[n]);
+        }
+        for (uint32_t n = 0; n < ITEM_BATCH; n++)
+        {
+            rtos_spsc_receive(&g_item_spsc, &rx[n], 0);
+        }
+        cycles = rtos_profiling_get_cycles() - t0;
+        if (record)
+        {
+            rtos_profiling_record(&g_stat_item_spsc, cycles / ITEM_BATCH);
+        }
+        if (memcmp(tx, rx, sizeof(tx)) != 0)
+        {
+            g_byte_errors++;
+        }
+
+        /* Drop the notification the first send gave us */
+        rtos_task_notify_take_indexed(RTOS_TASK_NOTIFY_DEFAULT_INDEX, true, 0);
+    }
+}
+
+/**
+ * @brief ResultTask — prints delivery latency and byte-stream statistics
  */
 void ResultTask(void *param)
 {
@@ -178,9 +393,55 @@ void ResultTask(void *param)
 
     rtos_semaphore_wait(&g_done_sem, RTOS_MAX_DELAY);
 
+    /* Producer and Consumer are suspended: nothing else touches the byte objects */
+    run_byte_comparison();
+    run_item_comparison();
+
+    const bench_queue_typed_stats_t typed_stats = {
+        .item_typed    = &g_stat_item_typed,
+        .frame_queue   = &g_stat_frame_queue,
+        .frame_typed   = &g_stat_frame_typed,
+        .frame_emplace = &g_stat_frame_emplace,
+    };
+    uint32_t typed_errors = bench_queue_typed_run(&typed_stats, BENCH_WARMUP, BENCH_ITERATIONS);
+
     bench_header("queue_delivery_latency");
     bench_report(&g_stat_queue_latency);
 
+    bench_header("byte_queue (cycles per byte)");
+    bench_report(&g_stat_byte_queue);
+
+    bench_header("byte_stream (cycles per byte)");
+    bench_report(&g_stat_byte_stream);
+
+    bench_header("byte_message (cycles per byte)");
+    bench_report(&g_stat_byte_message);
+
+    /* Let LogFlush drain the ulog ring before the next block of lines */
+    rtos_delay_ms(LOG_DRAIN_MS);
+
+    bench_header("item_queue (cycles per item)");
+    bench_report(&g_stat_item_queue);
+
+    bench_header("item_spsc (cycles per item)");
+    bench_report(&g_stat_item_spsc);
+
+    bench_header("item_typed (cycles per item)");
+    bench_report(&g_stat_item_typed);
+
+    rtos_delay_ms(LOG_DRAIN_MS);
+
+    bench_header("frame_queue (cycles per item)");
+    bench_report(&g_stat_frame_queue);
+
+    bench_header("frame_typed (cycles per item)");
+    bench_report(&g_stat_frame_typed);
+
+    bench_header("frame_emplace (cycles per item)");
+    bench_report(&g_stat_frame_emplace);
+
+    ulog_info("[BENCH] Packets corrupted: %lu", (unsigned long) g_byte_errors);
+    ulog_info("[BENCH] Typed items corrupted: %lu", (unsigned long) typed_errors);
     ulog_info("[BENCH] Done.");
 
     rtos_task_suspend(NULL);
@@ -211,6 +472,10 @@ int main(void)
     ulog_info("[BENCH] Iterations: %u  Warmup: %u", BENCH_ITERATIONS, BENCH_WARMUP);
 
     rtos_queue_create(&g_queue, 4, sizeof(uint32_t));
+    rtos_queue_create(&g_byte_queue, BYTE_CHUNK, 1);
+    rtos_queue_create(&g_item_queue, ITEM_BATCH, sizeof(uint32_t));
+    rtos_stream_buffer_init(&g_stream, g_stream_storage, BYTE_STORAGE_SIZE, 1);
+    rtos_message_buffer_init(&g_message, g_message_storage, BYTE_STORAGE_SIZE);
     rtos_semaphore_init(&g_done_sem, 0, 1);
 
     rtos_task_handle_t handle;
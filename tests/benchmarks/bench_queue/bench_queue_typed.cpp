@@ -0,0 +1,189 @@
+/*******************************************************************************
+ * File: tests/benchmarks/bench_queue/bench_queue_typed.cpp
+ * Description: vrtos::Queue half of the queue benchmark
+ *
+ * Per-item cost of the typed C++ queue (include/vrtos.hpp) next to the raw
+ * C calls, on objects nobody blocks on, BENCH_QUEUE_TYPED_BATCH items in
+ * and back out per sample:
+ *
+ *   item_typed     Queue<uint32_t, N>::send/receive; compare with the
+ *                  item_queue row of bench_queue.c (same calls underneath)
+ *   frame_queue    rtos_queue_send/receive of a 32-byte frame: two memcpy
+ *                  calls of a run-time length per item
+ *   frame_typed    Queue<frame, N>::send/receive: slot acquire/commit with
+ *                  an inlined fixed-size copy each way
+ *   frame_emplace  Queue<frame, N>::emplace/consume: the frame is built in
+ *                  its slot and read there, no copy at all (the timed work
+ *                  includes building it and summing its payload)
+ ******************************************************************************/
+
+#include "bench_queue_typed.h"
+
+#include "profiling.h"
+#include "queue.h"
+#include "vrtos.hpp"
+
+#include <string.h>
+
+namespace
+{
+    /** A DMA-descriptor-sized record: sequence number plus 28 payload bytes */
+    struct frame
+    {
+        uint32_t seq;
+        uint32_t data[7];
+
+        frame() = default;
+
+        explicit frame(uint32_t s) : seq(s)
+        {
+            for (uint32_t k = 0; k < 7U; k++)
+            {
+                data[k] = s + k;
+            }
+        }
+
+        uint32_t sum() const
+        {
+            uint32_t total = seq;
+            for (uint32_t k = 0; k < 7U; k++)
+            {
+                total += data[k];
+            }
+            return total;
+        }
+    };
+
+    static_assert(sizeof(frame) == 32U, "frame must stay 32 bytes");
+
+    const uint32_t batch = BENCH_QUEUE_TYPED_BATCH;
+
+    vrtos::Queue<uint32_t, batch> g_item_typed;
+    vrtos::Queue<frame, batch>    g_frame_typed;
+
+    static_assert(!vrtos::Queue<uint32_t, batch>::in_place, "word items should take the copying calls");
+    static_assert(vrtos::Queue<frame, batch>::in_place, "frames should take the in-place path");
+
+    rtos_queue_handle_t g_frame_queue;
+    rtos_queue_static_t g_frame_queue_control;
+    frame               g_frame_queue_storage[batch];
+
+    /** Expected frame(s).sum() */
+    uint32_t frame_sum(uint32_t s)
+    {
+        return 8U * s + 21U;
+    }
+} // namespace
+
+uint32_t bench_queue_typed_run(const bench_queue_typed_stats_t *stats, uint32_t warmup, uint32_t iterations)
+{
+    if (g_item_typed.create() != RTOS_SUCCESS || g_frame_typed.create() != RTOS_SUCCESS ||
+        rtos_queue_create_static(&g_frame_queue, &g_frame_queue_control, g_frame_queue_storage, batch,
+                                 sizeof(frame)) != RTOS_SUCCESS)
+    {
+        return UINT32_MAX;
+    }
+
+    uint32_t errors = 0;
+    uint32_t item_tx[batch];
+    uint32_t item_rx[batch];
+    frame    frame_tx[batch];
+    frame    frame_rx[batch];
+
+    for (uint32_t i = 0; i < warmup + iterations; i++)
+    {
+        bool record = (i >= warmup);
+
+        for (uint32_t n = 0; n < batch; n++)
+        {
+            item_tx[n]  = i * batch + n;
+            frame_tx[n] = frame(i * batch + n);
+        }
+
+        /* --- Typed word queue --- */
+        uint32_t t0 = rtos_profiling_get_cycles();
+        for (uint32_t n = 0; n < batch; n++)
+        {
+            g_item_typed.send(item_tx[n], 0);
+        }
+        for (uint32_t n = 0; n < batch; n++)
+        {
+            g_item_typed.receive(item_rx[n], 0);
+        }
+        uint32_t cycles = rtos_profiling_get_cycles() - t0;
+        if (record)
+        {
+            rtos_profiling_record(stats->item_typed, cycles / batch);
+        }
+        if (memcmp(item_tx, item_rx, sizeof(item_tx)) != 0)
+        {
+            errors++;
+        }
+
+        /* --- Raw frame queue --- */
+        t0 = rtos_profiling_get_cycles();
+        for (uint32_t n = 0; n < batch; n++)
+        {
+            rtos_queue_send(g_frame_queue, &frame_tx[n], 0);
+        }
+        for (uint32_t n = 0; n < batch; n++)
+        {
+            rtos_queue_receive(g_frame_queue, &frame_rx[n], 0);
+        }
+        cycles = rtos_profiling_get_cycles() - t0;
+        if (record)
+        {
+            rtos_profiling_record(stats->frame_queue, cycles / batch);
+        }
+        if (memcmp(frame_tx, frame_rx, sizeof(frame_tx)) != 0)
+        {
+            errors++;
+        }
+
+        /* --- Typed frame queue, copying in and out --- */
+        t0 = rtos_profiling_get_cycles();
+        for (uint32_t n = 0; n < batch; n++)
+        {
+            g_frame_typed.send(frame_tx[n], 0);
+        }
+        for (uint32_t n = 0; n < batch; n++)
+        {
+            g_frame_typed.receive(frame_rx[n], 0);
+        }
+        cycles = rtos_profiling_get_cycles() - t0;
+        if (record)
+        {
+            rtos_profiling_record(stats->frame_typed, cycles / batch);
+        }
+        if (memcmp(frame_tx, frame_rx, sizeof(frame_tx)) != 0)
+        {
+            errors++;
+        }
+
+        /* --- Typed frame queue, built and read in the slot --- */
+        uint32_t sums[batch];
+        t0 = rtos_profiling_get_cycles();
+        for (uint32_t n = 0; n < batch; n++)
+        {
+            g_frame_typed.emplace(0, i * batch + n);
+        }
+        for (uint32_t n = 0; n < batch; n++)
+        {
+            g_frame_typed.consume([&sums, n](const frame &f) { sums[n] = f.sum(); }, 0);
+        }
+        cycles = rtos_profiling_get_cycles() - t0;
+        if (record)
+        {
+            rtos_profiling_record(stats->frame_emplace, cycles / batch);
+        }
+        for (uint32_t n = 0; n < batch; n++)
+        {
+            if (sums[n] != frame_sum(i * batch + n))
+            {
+                errors++;
+            }
+        }
+    }
+
+    return errors;
+}
@@ -0,0 +1,45 @@
+/*
+ * C entry point of bench_queue_typed.cpp, the vrtos::Queue half of
+ * bench_queue. Kept in C++ so the typed wrappers are compiled as an
+ * application would use them.
+ */
+
+#ifndef BENCH_QUEUE_TYPED_H
+#define BENCH_QUEUE_TYPED_H
+
+#include "profiling.h"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** Stats filled by bench_queue_typed_run(), cycles per item */
+typedef struct
+{
+    rtos_profile_stat_t *item_typed;    /**< vrtos::Queue<uint32_t, N> send + receive */
+    rtos_profile_stat_t *frame_queue;   /**< rtos_queue_send/receive of a frame */
+    rtos_profile_stat_t *frame_typed;   /**< vrtos::Queue<frame, N> send + receive */
+    rtos_profile_stat_t *frame_emplace; /**< vrtos::Queue<frame, N> emplace + consume */
+} bench_queue_typed_stats_t;
+
+/** Items per timed batch (and queue capacity), the same as ITEM_BATCH */
+#define BENCH_QUEUE_TYPED_BATCH (8U)
+
+/**
+ * @brief Create the queues and time warmup + iterations batches of items
+ *
+ * Runs in the caller's task; nothing may block on the queues meanwhile.
+ *
+ * @return Items that came back wrong (must be 0), or UINT32_MAX if a
+ *         queue could not be created
+ */
+uint32_t bench_queue_typed_run(const bench_queue_typed_stats_t *stats, uint32_t warmup, uint32_t iterations);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BENCH_QUEUE_TYPED_H */
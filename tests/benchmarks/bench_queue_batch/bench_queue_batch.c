@@ -0,0 +1,221 @@
+/*******************************************************************************
+ * File: tests/benchmarks/bench_queue_batch/bench_queue_batch.c
+ * Description: Batch vs. Per-Item Queue Transfer Benchmark
+ * Author: Student
+ * Date: 2025
+ *
+ * WHAT IS MEASURED
+ * ----------------
+ * Per-item cycle cost of moving a batch of B uint32_t samples through a
+ * queue and back, for B = 1, 4, 16 and 64:
+ *
+ *   Loop<B>  — B x rtos_queue_send() then B x rtos_queue_receive()
+ *   Batch<B> — one rtos_queue_send_n() then one rtos_queue_receive_n()
+ *
+ * Each round trip is timed with the DWT cycle counter and recorded as
+ * cycles / B, so the rows are directly comparable.
+ *
+ * SCENARIO
+ * --------
+ *   BenchTask (priority 2):
+ *     Uses non-blocking calls on a queue nobody else waits on, so no
+ *     context switch is included. The queue has BENCH_QUEUE_LEN slots and
+ *     is stepped by one extra item per batch, so successive batches start
+ *     at different ring offsets and many of the larger ones straddle the
+ *     wrap.
+ *     Received samples are checked against what was sent.
+ *
+ * BUILD
+ * -----
+ *   pio run -e bench_queue_batch -t upload
+ *
+ * EXPECTED OUTPUT (at 180 MHz, STM32F446RE)
+ *   [BENCH] ===== queue_batch (cycles per item) =====
+ *   [Loop1]: ...  [Batch1]: ...     (about equal)
+ *   [Loop64]: ... [Batch64]: ...    (batch several times cheaper per item)
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "bench_common.h"
+#include "device.h" /* IWYU pragma: keep */
+#include "hardware_env.h"
+#include "profiling.h"
+#include "queue.h"
+#include "uart_tx.h"
+#include "ulog.h"
+
+/* ========================= CONFIGURATION ================================== */
+
+#define BENCH_BATCH_SIZES (4U)
+#define BENCH_MAX_BATCH   (64U)
+#define BENCH_QUEUE_LEN   (BENCH_MAX_BATCH + 3U)
+
+static const uint32_t g_batch_sizes[BENCH_BATCH_SIZES] = {1U, 4U, 16U, 64U};
+
+/* ========================= SHARED STATE =================================== */
+
+static volatile uint32_t g_test_started = 0;
+
+static rtos_queue_handle_t g_queue;
+
+static uint32_t g_tx[BENCH_MAX_BATCH];
+static uint32_t g_rx[BENCH_MAX_BATCH];
+static uint32_t g_errors = 0;
+
+/* ========================= PROFILING STATS ================================ */
+
+static rtos_profile_stat_t g_stat_loop[BENCH_BATCH_SIZES] = {
+    BENCH_STAT_INIT("Loop1"), BENCH_STAT_INIT("Loop4"), BENCH_STAT_INIT("Loop16"), BENCH_STAT_INIT("Loop64")};
+static rtos_profile_stat_t g_stat_batch[BENCH_BATCH_SIZES] = {
+    BENCH_STAT_INIT("Batch1"), BENCH_STAT_INIT("Batch4"), BENCH_STAT_INIT("Batch16"), BENCH_STAT_INIT("Batch64")};
+
+/* ========================= TASK FUNCTIONS ================================= */
+
+static void bench_fill(uint32_t n, uint32_t seed)
+{
+    for (uint32_t i = 0; i < n; i++)
+    {
+        g_tx[i] = seed + i;
+    }
+}
+
+static void bench_check(uint32_t n)
+{
+    for (uint32_t i = 0; i < n; i++)
+    {
+        if (g_rx[i] != g_tx[i])
+        {
+            g_errors++;
+        }
+    }
+}
+
+static void bench_loop_once(uint32_t n, rtos_profile_stat_t *stat)
+{
+    uint32_t t0 = rtos_profiling_get_cycles();
+    for (uint32_t i = 0; i < n; i++)
+    {
+        rtos_queue_send(g_queue, &g_tx[i], 0);
+    }
+    for (uint32_t i = 0; i < n; i++)
+    {
+        rtos_queue_receive(g_queue, &g_rx[i], 0);
+    }
+    uint32_t cycles = rtos_profiling_get_cycles() - t0;
+
+    if (stat != NULL)
+    {
+        rtos_profiling_record(stat, cycles / n);
+    }
+}
+
+static void bench_batch_once(uint32_t n, rtos_profile_stat_t *stat)
+{
+    uint32_t sent     = 0;
+    uint32_t received = 0;
+
+    uint32_t t0 = rtos_profiling_get_cycles();
+    rtos_queue_send_n(g_queue, g_tx, n, &sent, 0);
+    rtos_queue_receive_n(g_queue, g_rx, n, &received, 0);
+    uint32_t cycles = rtos_profiling_get_cycles() - t0;
+
+    if (sent != n || received != n)
+    {
+        g_errors++;
+    }
+    if (stat != NULL)
+    {
+        rtos_profiling_record(stat, cycles / n);
+    }
+}
+
+/**
+ * @brief BenchTask — runs warmup, then the measured round trips
+ */
+void BenchTask(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+
+    uint32_t spare = 0;
+
+    for (uint32_t i = 0; i < BENCH_WARMUP + BENCH_ITERATIONS; i++)
+    {
+        bool record = (i >= BENCH_WARMUP);
+
+        for (uint32_t b = 0; b < BENCH_BATCH_SIZES; b++)
+        {
+            uint32_t n = g_batch_sizes[b];
+
+            /* Step the (empty) ring by one slot so batch start offsets vary */
+            rtos_queue_send(g_queue, &spare, 0);
+            rtos_queue_receive(g_queue, &spare, 0);
+
+            bench_fill(n, i * 1000U);
+
+            bench_loop_once(n, record ? &g_stat_loop[b] : NULL);
+            bench_check(n);
+
+            bench_batch_once(n, record ? &g_stat_batch[b] : NULL);
+            bench_check(n);
+        }
+    }
+
+    bench_header("queue_batch (cycles per item)");
+    for (uint32_t b = 0; b < BENCH_BATCH_SIZES; b++)
+    {
+        bench_report(&g_stat_loop[b]);
+        bench_report(&g_stat_batch[b]);
+    }
+
+    ulog_info("[BENCH] queue_len=%u  errors=%lu", BENCH_QUEUE_LEN, (unsigned long) g_errors);
+    ulog_info("[BENCH] Done.");
+
+    rtos_task_suspend(NULL);
+}
+
+/* ========================= STARTUP TIMER ================================== */
+
+static void startup_cb(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_started = 1;
+    ulog_info("[BENCH] Startup hold complete — starting batch queue benchmark");
+}
+
+/* ========================= MAIN =========================================== */
+
+int main(void)
+{
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_INFO);
+
+    rtos_init();
+    rtos_profiling_init();
+
+    ulog_init(ULOG_LEVEL_INFO);
+    ulog_info("[BENCH] Batch vs. Per-Item Queue Benchmark — " __DATE__ " " __TIME__);
+    ulog_info("[BENCH] Iterations: %u  Warmup: %u  Batches: 1/4/16/64", BENCH_ITERATIONS, BENCH_WARMUP);
+
+    rtos_queue_create(&g_queue, BENCH_QUEUE_LEN, sizeof(uint32_t));
+
+    rtos_task_handle_t  handle;
+    rtos_timer_handle_t startup_timer;
+
+    /*
+     * Task priority layout:
+     *   BenchTask (2) — runs the measurements
+     *   LogFlush  (0) — drains ulog ring buffer to UART
+     */
+    rtos_task_create(BenchTask, "Bench", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, 2, &handle);
+
+    test_create_log_flush_task(&handle);
+    test_create_startup_timer(startup_cb, NULL, &startup_timer);
+
+    rtos_start_scheduler();
+
+    while (1) {}
+    return 0;
+}
@@ -0,0 +1,214 @@
+/*******************************************************************************
+ * File: tests/benchmarks/bench_queue_zero_copy/bench_queue_zero_copy.c
+ * Description: Copying vs. Zero-Copy Queue Transfer Benchmark
+ * Author: Student
+ * Date: 2025
+ *
+ * WHAT IS MEASURED
+ * ----------------
+ * Cycle cost of moving one BENCH_FRAME_SIZE-byte frame through a queue:
+ *
+ *   1. rtos_queue_send() + rtos_queue_receive()
+ *      (two memcpy of the frame, both under the queue critical section)
+ *   2. rtos_queue_send_acquire() + rtos_queue_send_commit() +
+ *      rtos_queue_receive_peek() + rtos_queue_receive_release()
+ *      (frame filled and read in place, no copy)
+ *
+ * The copying transfer is bracketed by RTOS_USER_PROFILE_START/END; the
+ * zero-copy transfer sums three DWT spans so that filling the slot and
+ * reading it back stay outside the measurement, as they do for the copy.
+ *
+ * SCENARIO
+ * --------
+ *   BenchTask (priority 2):
+ *     Uses non-blocking calls on a queue nobody else waits on, so no
+ *     context switch is included — the numbers isolate the copy cost.
+ *     Every received frame is checked against the sequence number that
+ *     was written, so a broken zero-copy path shows up as errors.
+ *
+ * BUILD
+ * -----
+ *   pio run -e bench_queue_zero_copy -t upload
+ *
+ * EXPECTED OUTPUT (at 180 MHz, STM32F446RE)
+ *   [BENCH] ===== queue_zero_copy =====
+ *   [QueueCopy]: Min=.. cyc, Max=.. cyc ...      (grows with frame size)
+ *   [QueueZeroCopy]: Min=.. cyc, Max=.. cyc ...  (independent of frame size)
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "bench_common.h"
+#include "device.h" /* IWYU pragma: keep */
+#include "hardware_env.h"
+#include "profiling.h"
+#include "queue.h"
+#include "uart_tx.h"
+#include "ulog.h"
+
+#include <string.h>
+
+/* ========================= CONFIGURATION ================================== */
+
+#ifndef BENCH_FRAME_SIZE
+#define BENCH_FRAME_SIZE (256U)
+#endif
+
+#define BENCH_QUEUE_DEPTH (4U)
+
+typedef struct
+{
+    uint32_t seq;
+    uint8_t  payload[BENCH_FRAME_SIZE - sizeof(uint32_t)];
+} bench_frame_t;
+
+/* ========================= SHARED STATE =================================== */
+
+static volatile uint32_t g_test_started = 0;
+
+static rtos_queue_handle_t g_queue;
+
+static uint32_t g_errors = 0;
+
+/* ========================= PROFILING STATS ================================ */
+
+static rtos_profile_stat_t g_stat_copy      = BENCH_STAT_INIT("QueueCopy");
+static rtos_profile_stat_t g_stat_zero_copy = BENCH_STAT_INIT("QueueZeroCopy");
+
+/* ========================= TASK FUNCTIONS ================================= */
+
+static void bench_fill(bench_frame_t *frame, uint32_t seq)
+{
+    frame->seq = seq;
+    memset(frame->payload, (int) (seq & 0xFFU), sizeof(frame->payload));
+}
+
+static void bench_check(const bench_frame_t *frame, uint32_t seq)
+{
+    if (frame->seq != seq || frame->payload[sizeof(frame->payload) - 1U] != (uint8_t) (seq & 0xFFU))
+    {
+        g_errors++;
+    }
+}
+
+static void bench_copy_once(uint32_t seq, bool record)
+{
+    static bench_frame_t tx;
+    static bench_frame_t rx;
+
+    bench_fill(&tx, seq);
+
+    RTOS_USER_PROFILE_START(xfer);
+    rtos_queue_send(g_queue, &tx, 0);
+    rtos_queue_receive(g_queue, &rx, 0);
+    if (record)
+    {
+        RTOS_USER_PROFILE_END(xfer, &g_stat_copy);
+    }
+
+    bench_check(&rx, seq);
+}
+
+static void bench_zero_copy_once(uint32_t seq, bool record)
+{
+    bench_frame_t       *slot = NULL;
+    const bench_frame_t *item = NULL;
+
+    /* Three timed spans summed into one sample; fill/check are excluded */
+    uint32_t t0 = rtos_profiling_get_cycles();
+    rtos_queue_send_acquire(g_queue, (void **) &slot, 0);
+    uint32_t cycles = rtos_profiling_get_cycles() - t0;
+
+    bench_fill(slot, seq);
+
+    t0 = rtos_profiling_get_cycles();
+    rtos_queue_send_commit(g_queue);
+    rtos_queue_receive_peek(g_queue, (const void **) &item, 0);
+    cycles += rtos_profiling_get_cycles() - t0;
+
+    bench_check(item, seq);
+
+    t0 = rtos_profiling_get_cycles();
+    rtos_queue_receive_release(g_queue);
+    cycles += rtos_profiling_get_cycles() - t0;
+
+    if (record)
+    {
+        rtos_profiling_record(&g_stat_zero_copy, cycles);
+    }
+}
+
+/**
+ * @brief BenchTask — runs warmup, then the measured transfers
+ */
+void BenchTask(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+
+    for (uint32_t i = 0; i < BENCH_WARMUP; i++)
+    {
+        bench_copy_once(i, false);
+        bench_zero_copy_once(i, false);
+    }
+
+    for (uint32_t i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        bench_copy_once(i, true);
+        bench_zero_copy_once(i, true);
+    }
+
+    bench_header("queue_zero_copy");
+    bench_report(&g_stat_copy);
+    bench_report(&g_stat_zero_copy);
+
+    ulog_info("[BENCH] frame=%u B  errors=%lu", BENCH_FRAME_SIZE, (unsigned long) g_errors);
+    ulog_info("[BENCH] Done.");
+
+    rtos_task_suspend(NULL);
+}
+
+/* ========================= STARTUP TIMER ================================== */
+
+static void startup_cb(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_started = 1;
+    ulog_info("[BENCH] Startup hold complete — starting zero-copy queue benchmark");
+}
+
+/* ========================= MAIN =========================================== */
+
+int main(void)
+{
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_INFO);
+
+    rtos_init();
+    rtos_profiling_init();
+
+    ulog_init(ULOG_LEVEL_INFO);
+    ulog_info("[BENCH] Copying vs. Zero-Copy Queue Benchmark — " __DATE__ " " __TIME__);
+    ulog_info("[BENCH] Iterations: %u  Warmup: %u  Frame: %u B", BENCH_ITERATIONS, BENCH_WARMUP, BENCH_FRAME_SIZE);
+
+    rtos_queue_create(&g_queue, BENCH_QUEUE_DEPTH, sizeof(bench_frame_t));
+
+    rtos_task_handle_t  handle;
+    rtos_timer_handle_t startup_timer;
+
+    /*
+     * Task priority layout:
+     *   BenchTask (2) — runs the measurements
+     *   LogFlush  (0) — drains ulog ring buffer to UART
+     */
+    rtos_task_create(BenchTask, "Bench", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, 2, &handle);
+
+    test_create_log_flush_task(&handle);
+    test_create_startup_timer(startup_cb, NULL, &startup_timer);
+
+    rtos_start_scheduler();
+
+    while (1) {}
+    return 0;
+}
@@ -0,0 +1,272 @@
+/*******************************************************************************
+ * File: tests/benchmarks/bench_rtos_mem/bench_rtos_mem.c
+ * Description: Kernel Memory Routines vs. newlib Benchmark
+ * Author: Student
+ * Date: 2025
+ *
+ * WHAT IS MEASURED
+ * ----------------
+ * Cycle cost of the rtos_mem routines (src/utils/rtos_mem.h) next to what
+ * the kernel used before, on word-aligned buffers:
+ *
+ *   1. Copy<N>     memcpy() vs. rtos_mem_copy() of N = 4, 16, 64, 256 and
+ *                  1024 bytes: queue items, ring-buffer records, frames.
+ *                  N is read at run time, as a queue's item size is, so
+ *                  neither call is expanded inline by the compiler.
+ *   2. Fill1024    memset() vs. rtos_mem_fill_words() of 1 KB (rtos_memory_init,
+ *                  stack painting at task creation)
+ *   3. Scan1024    the watermark word loop vs. rtos_mem_scan_words() over
+ *                  1 KB of painted stack (idle-task high-water scan)
+ *
+ * Each sample times BENCH_MEM_REPEAT calls and records the mean, so the
+ * DWT read overhead does not swamp the small sizes. Copies are checked
+ * against the source after timing.
+ *
+ * SCENARIO
+ * --------
+ *   BenchTask (priority 2):
+ *     Runs all cases back to back on static buffers; nothing else runs.
+ *
+ * BUILD
+ * -----
+ *   pio run -e bench_rtos_mem -t upload
+ *
+ * EXPECTED OUTPUT (at 180 MHz, STM32F446RE, newlib-nano)
+ *   [BENCH] ===== rtos_mem vs newlib (cycles per call) =====
+ *   [Memcpy4]:  ...  [MemCopy4]:  ...   (inline word move, no call)
+ *   [Memcpy1024]: ... [MemCopy1024]: ... (byte loop vs. 8-word LDM/STM bursts)
+ *   [Memset1024]: ... [FillWords1024]: ...
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "bench_common.h"
+#include "device.h" /* IWYU pragma: keep */
+#include "hardware_env.h"
+#include "port_common.h"
+#include "port_priv.h" /* PORT_HAS_BLOCK_TRANSFER */
+#include "profiling.h"
+#include "rtos_mem.h"
+#include "uart_tx.h"
+#include "ulog.h"
+
+#include <string.h>
+
+/* ========================= CONFIGURATION ================================== */
+
+#define BENCH_MEM_SIZES  (5U)
+#define BENCH_MEM_BYTES  (1024U)
+#define BENCH_MEM_WORDS  (BENCH_MEM_BYTES / sizeof(uint32_t))
+#define BENCH_MEM_REPEAT (8U)
+
+/*
+ * volatile, and re-read on every call: the sizes reach the calls as run-time
+ * values, and the compiler cannot merge the repeated identical calls
+ */
+static volatile uint32_t g_sizes[BENCH_MEM_SIZES] = {4U, 16U, 64U, 256U, BENCH_MEM_BYTES};
+
+/* ========================= SHARED STATE =================================== */
+
+static volatile uint32_t g_test_started = 0;
+
+static uint32_t g_src[BENCH_MEM_WORDS];
+static uint32_t g_dst[BENCH_MEM_WORDS];
+static uint32_t g_errors = 0;
+
+/* Keeps the scan results live */
+static volatile uint32_t g_sink;
+
+/* ========================= PROFILING STATS ================================ */
+
+static rtos_profile_stat_t g_stat_memcpy[BENCH_MEM_SIZES] = {
+    BENCH_STAT_INIT("Memcpy4"), BENCH_STAT_INIT("Memcpy16"), BENCH_STAT_INIT("Memcpy64"),
+    BENCH_STAT_INIT("Memcpy256"), BENCH_STAT_INIT("Memcpy1024")};
+static rtos_profile_stat_t g_stat_copy[BENCH_MEM_SIZES] = {
+    BENCH_STAT_INIT("MemCopy4"), BENCH_STAT_INIT("MemCopy16"), BENCH_STAT_INIT("MemCopy64"),
+    BENCH_STAT_INIT("MemCopy256"), BENCH_STAT_INIT("MemCopy1024")};
+
+static rtos_profile_stat_t g_stat_memset     = BENCH_STAT_INIT("Memset1024");
+static rtos_profile_stat_t g_stat_fill       = BENCH_STAT_INIT("FillWords1024");
+static rtos_profile_stat_t g_stat_scan_loop  = BENCH_STAT_INIT("ScanLoop1024");
+static rtos_profile_stat_t g_stat_scan_words = BENCH_STAT_INIT("ScanWords1024");
+
+/* ========================= TASK FUNCTIONS ================================= */
+
+static void bench_record(rtos_profile_stat_t *stat, uint32_t t0, bool record)
+{
+    uint32_t cycles = rtos_profiling_get_cycles() - t0;
+    if (record)
+    {
+        rtos_profiling_record(stat, cycles / BENCH_MEM_REPEAT);
+    }
+}
+
+static void bench_check(uint32_t len)
+{
+    if (memcmp(g_dst, g_src, len) != 0)
+    {
+        g_errors++;
+    }
+}
+
+static void bench_copies(uint32_t seed, bool record)
+{
+    for (uint32_t w = 0; w < BENCH_MEM_WORDS; w++)
+    {
+        g_src[w] = seed + w;
+    }
+
+    for (uint32_t s = 0; s < BENCH_MEM_SIZES; s++)
+    {
+        uint32_t len = g_sizes[s];
+
+        memset(g_dst, 0, sizeof(g_dst));
+        uint32_t t0 = rtos_profiling_get_cycles();
+        for (uint32_t r = 0; r < BENCH_MEM_REPEAT; r++)
+        {
+            memcpy(g_dst, g_src, g_sizes[s]);
+        }
+        bench_record(&g_stat_memcpy[s], t0, record);
+        bench_check(len);
+
+        memset(g_dst, 0, sizeof(g_dst));
+        t0 = rtos_profiling_get_cycles();
+        for (uint32_t r = 0; r < BENCH_MEM_REPEAT; r++)
+        {
+            rtos_mem_copy(g_dst, g_src, g_sizes[s]);
+        }
+        bench_record(&g_stat_copy[s], t0, record);
+        bench_check(len);
+    }
+}
+
+/* The watermark scan before rtos_mem_scan_words() */
+static uint32_t bench_scan_loop(const uint32_t *base, uint32_t words)
+{
+    uint32_t i = 0;
+    while (i < words && base[i] == PORT_STACK_FILL_VALUE)
+    {
+        i++;
+    }
+    return i;
+}
+
+static void bench_fill_scan(bool record)
+{
+    uint32_t t0 = rtos_profiling_get_cycles();
+    for (uint32_t r = 0; r < BENCH_MEM_REPEAT; r++)
+    {
+        memset(g_dst, 0xA5, g_sizes[BENCH_MEM_SIZES - 1U]);
+    }
+    bench_record(&g_stat_memset, t0, record);
+
+    t0 = rtos_profiling_get_cycles();
+    for (uint32_t r = 0; r < BENCH_MEM_REPEAT; r++)
+    {
+        rtos_mem_fill_words(g_dst, PORT_STACK_FILL_VALUE, g_sizes[BENCH_MEM_SIZES - 1U] / sizeof(uint32_t));
+    }
+    bench_record(&g_stat_fill, t0, record);
+
+    /* A painted stack whose top 32 words were used, as the scan first sees it */
+    g_dst[BENCH_MEM_WORDS - 32U] = 0U;
+
+    t0 = rtos_profiling_get_cycles();
+    for (uint32_t r = 0; r < BENCH_MEM_REPEAT; r++)
+    {
+        g_sink = bench_scan_loop(g_dst, BENCH_MEM_WORDS);
+    }
+    bench_record(&g_stat_scan_loop, t0, record);
+
+    t0 = rtos_profiling_get_cycles();
+    for (uint32_t r = 0; r < BENCH_MEM_REPEAT; r++)
+    {
+        g_sink = rtos_mem_scan_words(g_dst, PORT_STACK_FILL_VALUE, BENCH_MEM_WORDS);
+    }
+    bench_record(&g_stat_scan_words, t0, record);
+
+    if (g_sink != BENCH_MEM_WORDS - 32U)
+    {
+        g_errors++;
+    }
+}
+
+/**
+ * @brief BenchTask — runs warmup, then the measured calls
+ */
+void BenchTask(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+
+    for (uint32_t i = 0; i < BENCH_WARMUP + BENCH_ITERATIONS; i++)
+    {
+        bool record = (i >= BENCH_WARMUP);
+
+        bench_copies(i, record);
+        bench_fill_scan(record);
+    }
+
+    bench_header("rtos_mem vs newlib (cycles per call)");
+    for (uint32_t s = 0; s < BENCH_MEM_SIZES; s++)
+    {
+        bench_report(&g_stat_memcpy[s]);
+        bench_report(&g_stat_copy[s]);
+        rtos_delay_ms(50);
+    }
+
+    bench_report(&g_stat_memset);
+    bench_report(&g_stat_fill);
+    rtos_delay_ms(50);
+    bench_report(&g_stat_scan_loop);
+    bench_report(&g_stat_scan_words);
+    rtos_delay_ms(50);
+
+    ulog_info("[BENCH] block_transfer=%u  errors=%lu", (unsigned) PORT_HAS_BLOCK_TRANSFER, (unsigned long) g_errors);
+    ulog_info("[BENCH] Done.");
+
+    rtos_task_suspend(NULL);
+}
+
+/* ========================= STARTUP TIMER ================================== */
+
+static void startup_cb(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_started = 1;
+    ulog_info("[BENCH] Startup hold complete — starting rtos_mem benchmark");
+}
+
+/* ========================= MAIN =========================================== */
+
+int main(void)
+{
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_INFO);
+
+    rtos_init();
+    rtos_profiling_init();
+
+    ulog_init(ULOG_LEVEL_INFO);
+    ulog_info("[BENCH] Kernel Memory Routines vs. newlib Benchmark — " __DATE__ " " __TIME__);
+    ulog_info("[BENCH] Iterations: %u  Warmup: %u  Calls per sample: %u", BENCH_ITERATIONS, BENCH_WARMUP,
+              BENCH_MEM_REPEAT);
+
+    rtos_task_handle_t  handle;
+    rtos_timer_handle_t startup_timer;
+
+    /*
+     * Task priority layout:
+     *   BenchTask (2) — runs the measurements
+     *   LogFlush  (0) — drains ulog ring buffer to UART
+     */
+    rtos_task_create(BenchTask, "Bench", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, 2, &handle);
+
+    test_create_log_flush_task(&handle);
+    test_create_startup_timer(startup_cb, NULL, &startup_timer);
+
+    rtos_start_scheduler();
+
+    while (1) {}
+    return 0;
+}
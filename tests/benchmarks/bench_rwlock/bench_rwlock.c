@@ -0,0 +1,352 @@
+/*******************************************************************************
+ * File: tests/benchmarks/bench_rwlock/bench_rwlock.c
+ * Description: Reader-Writer Lock vs. Mutex Read Throughput Benchmark
+ * Author: Student
+ * Date: 2025
+ *
+ * WHAT IS MEASURED
+ * ----------------
+ * Phase 1 — Uncontended cost:
+ *   BenchTask alone takes and releases the read lock, the write lock and a
+ *   plain mutex in a tight loop. The read lock and the mutex both take
+ *   their LDREX/STREX fast paths.
+ *
+ * Phase 2 — Read throughput under contention:
+ *   BENCH_READERS reader tasks share a config block, first behind a mutex,
+ *   then behind an rwlock, for BENCH_WINDOW_MS each. Every reader calls
+ *   rtos_yield() inside its read section, which stands in for being
+ *   preempted mid-read. Behind the mutex each such switch lands on a
+ *   reader that blocks; behind the rwlock the next reader just gets in.
+ *   Reported: reads completed per window, the reader lock-acquire latency
+ *   and the writer's acquire latency (which includes waiting for readers).
+ *
+ * SCENARIO
+ * --------
+ *   Writer    (priority 4) — rewrites the config every BENCH_WRITE_PERIOD_MS
+ *   BenchTask (priority 3) — phase 1, then switches the phase 2 windows
+ *   Reader0.. (priority 2) — read the config, counting reads and torn reads
+ *
+ * BUILD
+ * -----
+ *   pio run -e bench_rwlock -t upload
+ *
+ * EXPECTED OUTPUT
+ *   [BENCH] ===== rwlock_read_throughput =====
+ *   [BENCH] mutex:  reads=.. torn=0 writes=..
+ *   [BENCH] rwlock: reads=.. torn=0 writes=..   (several times the mutex count)
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "bench_common.h"
+#include "device.h" /* IWYU pragma: keep */
+#include "hardware_env.h"
+#include "mutex.h"
+#include "profiling.h"
+#include "rwlock.h"
+#include "uart_tx.h"
+#include "ulog.h"
+
+/* ========================= CONFIGURATION ================================== */
+
+#ifndef BENCH_READERS
+#define BENCH_READERS (4U)
+#endif
+
+#ifndef BENCH_WINDOW_MS
+#define BENCH_WINDOW_MS (500U)
+#endif
+
+#ifndef BENCH_WRITE_PERIOD_MS
+#define BENCH_WRITE_PERIOD_MS (10U)
+#endif
+
+#define BENCH_CONFIG_WORDS (8U)
+
+enum
+{
+    PHASE_IDLE = 0,
+    PHASE_MUTEX,
+    PHASE_RWLOCK,
+    PHASE_DONE
+};
+
+/* ========================= SHARED STATE =================================== */
+
+static volatile uint32_t g_test_started = 0;
+static volatile uint32_t g_phase        = PHASE_IDLE;
+
+static rtos_mutex_t  g_mutex;
+static rtos_rwlock_t g_rwlock;
+
+/* Every word equals version when the block is consistent */
+static volatile uint32_t g_config[BENCH_CONFIG_WORDS];
+
+static volatile uint32_t g_reads[BENCH_READERS];
+static volatile uint32_t g_torn;
+static volatile uint32_t g_writes;
+
+/* ========================= PROFILING STATS ================================ */
+
+static rtos_profile_stat_t g_stat_read_unc      = BENCH_STAT_INIT("RWReadUncontended");
+static rtos_profile_stat_t g_stat_write_unc     = BENCH_STAT_INIT("RWWriteUncontended");
+static rtos_profile_stat_t g_stat_mutex_unc     = BENCH_STAT_INIT("MutexUncontended");
+static rtos_profile_stat_t g_stat_mutex_read    = BENCH_STAT_INIT("MutexReadAcquire");
+static rtos_profile_stat_t g_stat_mutex_write   = BENCH_STAT_INIT("MutexWriteAcquire");
+static rtos_profile_stat_t g_stat_rwlock_read   = BENCH_STAT_INIT("RWReadAcquire");
+static rtos_profile_stat_t g_stat_rwlock_write  = BENCH_STAT_INIT("RWWriteAcquire");
+
+/* ========================= HELPERS ======================================== */
+
+static void read_config(void)
+{
+    uint32_t first = g_config[0];
+
+    for (uint32_t i = 1; i < BENCH_CONFIG_WORDS; i++)
+    {
+        if (g_config[i] != first)
+        {
+            g_torn++;
+            return;
+        }
+    }
+}
+
+static void write_config(void)
+{
+    uint32_t version = g_config[0] + 1U;
+
+    for (uint32_t i = 0; i < BENCH_CONFIG_WORDS; i++)
+    {
+        g_config[i] = version;
+    }
+    g_writes++;
+}
+
+static uint32_t total_reads(void)
+{
+    uint32_t total = 0;
+
+    for (uint32_t i = 0; i < BENCH_READERS; i++)
+    {
+        total += g_reads[i];
+    }
+    return total;
+}
+
+/* ========================= TASK FUNCTIONS ================================= */
+
+static void ReaderTask(void *param)
+{
+    uint32_t id = (uint32_t) (uintptr_t) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+
+    while (g_phase != PHASE_DONE)
+    {
+        uint32_t phase = g_phase;
+
+        if (phase == PHASE_MUTEX)
+        {
+            RTOS_USER_PROFILE_START(acq);
+            rtos_mutex_lock(&g_mutex, RTOS_MAX_WAIT);
+            RTOS_USER_PROFILE_END(acq, &g_stat_mutex_read);
+
+            read_config();
+            rtos_yield();
+            rtos_mutex_unlock(&g_mutex);
+            g_reads[id]++;
+        }
+        else if (phase == PHASE_RWLOCK)
+        {
+            RTOS_USER_PROFILE_START(acq);
+            rtos_rwlock_read_lock(&g_rwlock, RTOS_MAX_WAIT);
+            RTOS_USER_PROFILE_END(acq, &g_stat_rwlock_read);
+
+            read_config();
+            rtos_yield();
+            rtos_rwlock_read_unlock(&g_rwlock);
+            g_reads[id]++;
+        }
+        else
+        {
+            rtos_delay_ms(1);
+        }
+    }
+
+    rtos_task_suspend(NULL);
+}
+
+static void WriterTask(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+
+    while (g_phase != PHASE_DONE)
+    {
+        rtos_delay_ms(BENCH_WRITE_PERIOD_MS);
+
+        uint32_t phase = g_phase;
+
+        if (phase == PHASE_MUTEX)
+        {
+            RTOS_USER_PROFILE_START(acq);
+            rtos_mutex_lock(&g_mutex, RTOS_MAX_WAIT);
+            RTOS_USER_PROFILE_END(acq, &g_stat_mutex_write);
+
+            write_config();
+            rtos_mutex_unlock(&g_mutex);
+        }
+        else if (phase == PHASE_RWLOCK)
+        {
+            RTOS_USER_PROFILE_START(acq);
+            rtos_rwlock_write_lock(&g_rwlock, RTOS_MAX_WAIT);
+            RTOS_USER_PROFILE_END(acq, &g_stat_rwlock_write);
+
+            write_config();
+            rtos_rwlock_write_unlock(&g_rwlock);
+        }
+    }
+
+    rtos_task_suspend(NULL);
+}
+
+/* Run one contended window; returns the reads completed in it */
+static uint32_t run_window(uint32_t phase, uint32_t *torn, uint32_t *writes)
+{
+    for (uint32_t i = 0; i < BENCH_READERS; i++)
+    {
+        g_reads[i] = 0;
+    }
+    g_torn   = 0;
+    g_writes = 0;
+
+    g_phase = phase;
+    rtos_delay_ms(BENCH_WINDOW_MS);
+    g_phase = PHASE_IDLE;
+
+    /* Let readers inside a section leave it before the next window */
+    rtos_delay_ms(BENCH_WRITE_PERIOD_MS);
+
+    *torn   = g_torn;
+    *writes = g_writes;
+    return total_reads();
+}
+
+/**
+ * @brief BenchTask — uncontended loops, then the two contended windows
+ */
+void BenchTask(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+
+    for (uint32_t i = 0; i < BENCH_WARMUP + BENCH_ITERATIONS; i++)
+    {
+        bool record = (i >= BENCH_WARMUP);
+
+        RTOS_USER_PROFILE_START(rd);
+        rtos_rwlock_read_lock(&g_rwlock, RTOS_MAX_WAIT);
+        rtos_rwlock_read_unlock(&g_rwlock);
+        if (record)
+        {
+            RTOS_USER_PROFILE_END(rd, &g_stat_read_unc);
+        }
+
+        RTOS_USER_PROFILE_START(wr);
+        rtos_rwlock_write_lock(&g_rwlock, RTOS_MAX_WAIT);
+        rtos_rwlock_write_unlock(&g_rwlock);
+        if (record)
+        {
+            RTOS_USER_PROFILE_END(wr, &g_stat_write_unc);
+        }
+
+        RTOS_USER_PROFILE_START(mu);
+        rtos_mutex_lock(&g_mutex, RTOS_MAX_WAIT);
+        rtos_mutex_unlock(&g_mutex);
+        if (record)
+        {
+            RTOS_USER_PROFILE_END(mu, &g_stat_mutex_unc);
+        }
+    }
+
+    bench_header("rwlock_uncontended");
+    bench_report(&g_stat_read_unc);
+    bench_report(&g_stat_write_unc);
+    bench_report(&g_stat_mutex_unc);
+
+    uint32_t torn_mutex, writes_mutex, torn_rwlock, writes_rwlock;
+    uint32_t reads_mutex  = run_window(PHASE_MUTEX, &torn_mutex, &writes_mutex);
+    uint32_t reads_rwlock = run_window(PHASE_RWLOCK, &torn_rwlock, &writes_rwlock);
+    g_phase               = PHASE_DONE;
+
+    bench_header("rwlock_read_throughput");
+    ulog_info("[BENCH] readers=%u window=%u ms write_period=%u ms", BENCH_READERS, BENCH_WINDOW_MS,
+              BENCH_WRITE_PERIOD_MS);
+    ulog_info("[BENCH] mutex:  reads=%lu torn=%lu writes=%lu", (unsigned long) reads_mutex,
+              (unsigned long) torn_mutex, (unsigned long) writes_mutex);
+    ulog_info("[BENCH] rwlock: reads=%lu torn=%lu writes=%lu", (unsigned long) reads_rwlock,
+              (unsigned long) torn_rwlock, (unsigned long) writes_rwlock);
+    bench_report(&g_stat_mutex_read);
+    bench_report(&g_stat_rwlock_read);
+    bench_report(&g_stat_mutex_write);
+    bench_report(&g_stat_rwlock_write);
+
+    ulog_info("[BENCH] Done.");
+
+    rtos_task_suspend(NULL);
+}
+
+/* ========================= STARTUP TIMER ================================== */
+
+static void startup_cb(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_started = 1;
+    ulog_info("[BENCH] Startup hold complete — starting rwlock benchmark");
+}
+
+/* ========================= MAIN =========================================== */
+
+int main(void)
+{
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_INFO);
+
+    rtos_init();
+    rtos_profiling_init();
+
+    ulog_init(ULOG_LEVEL_INFO);
+    ulog_info("[BENCH] RWLock Benchmark — " __DATE__ " " __TIME__);
+    ulog_info("[BENCH] Iterations: %u  Warmup: %u  Readers: %u", BENCH_ITERATIONS, BENCH_WARMUP, BENCH_READERS);
+
+    rtos_mutex_init(&g_mutex);
+    rtos_rwlock_init(&g_rwlock);
+
+    rtos_task_handle_t  handle;
+    rtos_timer_handle_t startup_timer;
+
+    /*
+     * Task priority layout:
+     *   Writer    (4) — periodic config update, sleeps between writes
+     *   BenchTask (3) — runs phase 1, sleeps through each phase 2 window
+     *   Reader0.. (2) — contend for the config block during phase 2
+     *   LogFlush  (0) — drains ulog ring buffer to UART
+     */
+    rtos_task_create(WriterTask, "Writer", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, 4, &handle);
+    rtos_task_create(BenchTask, "Bench", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, 3, &handle);
+    for (uint32_t i = 0; i < BENCH_READERS; i++)
+    {
+        rtos_task_create(ReaderTask, "Reader", RTOS_DEFAULT_TASK_STACK_SIZE, (void *) (uintptr_t) i, 2, &handle);
+    }
+
+    test_create_log_flush_task(&handle);
+    test_create_startup_timer(startup_cb, NULL, &startup_timer);
+
+    rtos_start_scheduler();
+
+    while (1) {}
+    return 0;
+}
@@ -0,0 +1,436 @@
+/*******************************************************************************
+ * File: tests/benchmarks/bench_sched_scaling/bench_sched_scaling.c
+ * Description: Scheduler Scalability Benchmark
+ * Author: Student
+ * Date: 2025
+ *
+ * WHAT IS MEASURED
+ * ----------------
+ * How the kernel's per-event costs grow with the number of tasks, the
+ * number of tasks sharing a priority and the number of tasks in the delayed
+ * list.  Each point of a sweep spawns its own worker tasks, runs for a fixed
+ * number of ticks and reports, as avg and max cycles:
+ *
+ *   tick    SysTick handler (g_prof_tick)
+ *   pick    rtos_scheduler_get_next_task() (g_prof_scheduler)
+ *   switch  context switch (g_prof_context_switch)
+ *   wake    READY to running for the Waker (g_prof_scheduling_latency)
+ *   block   Waker calls rtos_task_notify_take() with a timeout to the next
+ *           task running: the delayed-list insert plus the switch away
+ *
+ * A flat row means O(1) in that parameter; a tail walk or a sorted insert
+ * shows up as a line.
+ *
+ * SCENARIO
+ * --------
+ * Each point has n workers at WORKER_PRIORITY: s of them yield in a tight
+ * loop, d sleep with timeouts far in the future (so they stay in the
+ * delayed list, none ever due), and the rest block forever on their
+ * notification (no list at all, like most tasks of a real system).  The
+ * Waker, one priority above, blocks with a timeout later than every
+ * sleeper's, so its insert walks the whole delayed list.  The first yielder
+ * to run afterwards closes the block sample, and on the next tick it
+ * notifies the Waker: one wake and one block per tick.
+ *
+ * Three sweeps, n from 2 to BENCH_SCALE_WORKERS (doubling, then the end):
+ *
+ *   tasks    n tasks, s = 2, d = 0      the rest blocked
+ *   shared   n tasks, s = n, d = 0      all yielding at one priority
+ *   delayed  n tasks, s = 2, d = n - 2  the rest in the delayed list
+ *
+ * BENCH_SCALE_WORKERS is what RTOS_MAX_TASKS leaves after Controller,
+ * Waker, LogFlush, Idle and the deferred daemon.  Workers are deleted after
+ * each point, so the task count really changes.
+ *
+ * SCHEDULER TYPES
+ * ---------------
+ * The same source builds as bench_sched_scaling (preemptive_sp),
+ * bench_sched_scaling_rr and bench_sched_scaling_coop.  Under the
+ * cooperative scheduler the Waker, made ready by a yielder, runs after
+ * every other ready task has had its turn (one FIFO ready list), so its
+ * wake figure grows with s by design, and the ready-list append walks to
+ * the tail.  Idle is one of those tasks and waits in WFI for the next
+ * interrupt, which puts the cooperative wake figure near one tick.
+ *
+ * Adding -D RTOS_USE_TIMING_WHEEL=1 to a build replaces the sorted delayed
+ * list with the timing wheel, which takes the walk out of block.
+ *
+ * BUILD
+ * -----
+ *   pio run -e bench_sched_scaling -t upload
+ *   pio run -e bench_sched_scaling_rr -t upload
+ *   pio run -e bench_sched_scaling_coop -t upload
+ *
+ * EXPECTED OUTPUT
+ *   [BENCH] ===== sched_scaling =====
+ *   [SCALE] tasks   n=2  s=2  d=0  avg: tick=... pick=... switch=... wake=... block=...
+ *   [SCALE] tasks   n=2  s=2  d=0  max: tick=... pick=... switch=... wake=... block=...
+ *   ...
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "bench_common.h"
+#include "device.h" /* IWYU pragma: keep */
+#include "hardware_env.h"
+#include "profiling.h"
+#include "rtos_assert.h"
+#include "rtos_port.h"
+#include "semaphore.h"
+#include "task.h"
+#include "uart_tx.h"
+#include "ulog.h"
+
+#include <string.h>
+
+/* ========================= PARAMETERS ===================================== */
+
+#define CONTROLLER_PRIORITY (5U)
+#define WAKER_PRIORITY      (4U)
+#define WORKER_PRIORITY     (3U)
+
+/* Controller, Waker, LogFlush and Idle, plus the deferred daemon */
+#define BENCH_SCALE_SYSTEM_TASKS (4U + RTOS_USE_DEFERRED_WORK)
+
+#ifndef BENCH_SCALE_WORKERS
+#define BENCH_SCALE_WORKERS (RTOS_MAX_TASKS - BENCH_SCALE_SYSTEM_TASKS)
+#endif
+
+/* Workers only yield or block; -D BENCH_SCALE_STACK_SIZE=... if that changes */
+#ifndef BENCH_SCALE_STACK_SIZE
+#define BENCH_SCALE_STACK_SIZE (512U)
+#endif
+
+/* Ticks per point: warmup (stats then reset), then measured */
+#ifndef BENCH_SCALE_WARMUP_TICKS
+#define BENCH_SCALE_WARMUP_TICKS (20U)
+#endif
+
+#ifndef BENCH_SCALE_TICKS
+#define BENCH_SCALE_TICKS (200U)
+#endif
+
+/* Sleepers are never due within a point; the Waker's timeout is later still */
+#define SLEEP_TICKS   (60000U)
+#define WAKER_TIMEOUT (2U * SLEEP_TICKS)
+
+/* Lets LogFlush drain a point's lines before the next one */
+#define FLUSH_MS (50U)
+
+RTOS_STATIC_ASSERT(RTOS_PROFILING_SYSTEM_ENABLED, "bench_sched_scaling reads the kernel's system stats");
+RTOS_STATIC_ASSERT(BENCH_SCALE_WORKERS >= 2U && BENCH_SCALE_WORKERS + BENCH_SCALE_SYSTEM_TASKS <= RTOS_MAX_TASKS,
+                   "bench_sched_scaling needs RTOS_MAX_TASKS room for at least two workers");
+RTOS_STATIC_ASSERT(BENCH_SCALE_WORKERS <= 99U, "worker names have two digits");
+
+/* ========================= SHARED STATE =================================== */
+
+typedef enum
+{
+    ROLE_YIELD,
+    ROLE_SLEEP,
+    ROLE_PARK
+} worker_role_t;
+
+typedef struct
+{
+    rtos_profile_snapshot_t tick;
+    rtos_profile_snapshot_t pick;
+    rtos_profile_snapshot_t ctx_switch;
+    rtos_profile_snapshot_t wake;
+    rtos_profile_snapshot_t block;
+} point_result_t;
+
+/** Startup gate: set to 1 by the startup timer. */
+static volatile uint32_t g_test_started = 0;
+
+/** Set by the Waker after the last measured tick: yielders leave their loop. */
+static volatile uint32_t g_stop = 0;
+
+/** DWT stamp just before the Waker blocks; 0 once a yielder has taken it. */
+static volatile uint32_t g_block_stamp = 0;
+
+/** The Waker is blocked, since g_park_tick; the next yielder on a later tick wakes it. */
+static volatile bool        g_waker_parked = false;
+static volatile rtos_tick_t g_park_tick    = 0;
+
+static worker_role_t      g_roles[BENCH_SCALE_WORKERS];
+static rtos_task_handle_t g_workers[BENCH_SCALE_WORKERS];
+static char               g_worker_names[BENCH_SCALE_WORKERS][4];
+
+static rtos_task_handle_t g_waker_handle = NULL;
+
+/** Controller -> Waker: a point's workers exist, start measuring. */
+static rtos_semaphore_t g_waker_go;
+
+/** Waker -> Controller: the point is measured. */
+static rtos_semaphore_t g_point_done;
+
+/** Workers -> Controller: one signal each once it is blocked for good. */
+static rtos_semaphore_t g_parked;
+
+static point_result_t g_result;
+
+/* ========================= PROFILING STATS ================================ */
+
+static rtos_profile_stat_t g_stat_block = BENCH_STAT_INIT("block");
+
+/* ========================= TASK FUNCTIONS ================================= */
+
+/**
+ * @brief Close a pending block sample; wake the Waker once per tick
+ *
+ * Called by a yielder each time it gets the CPU back.
+ */
+static void check_waker(void)
+{
+    rtos_tick_t tick = rtos_get_tick_count();
+    bool        wake = false;
+
+    /* Clock read after the stamp: a time slice between the two would
+     * otherwise pair an old reading with a newer stamp */
+    rtos_port_enter_critical();
+    uint32_t stamp = g_block_stamp;
+    uint32_t now   = rtos_profiling_get_cycles();
+    g_block_stamp  = 0;
+    if (stamp != 0U)
+    {
+        g_waker_parked = true;
+        g_park_tick    = tick;
+    }
+    else if (g_waker_parked && tick != g_park_tick)
+    {
+        g_waker_parked = false;
+        wake           = true;
+    }
+    rtos_port_exit_critical();
+
+    if (stamp != 0U)
+    {
+        rtos_profiling_record(&g_stat_block, now - stamp);
+    }
+    if (wake)
+    {
+        rtos_task_notify_give(g_waker_handle);
+    }
+}
+
+/**
+ * @brief Worker — one of a point's n tasks, in the role the Controller gave it
+ */
+void Worker(void *param)
+{
+    uint32_t index = (uint32_t) (uintptr_t) param;
+
+    if (g_roles[index] == ROLE_YIELD)
+    {
+        while (!g_stop)
+        {
+            rtos_yield();
+            check_waker();
+        }
+    }
+    else if (g_roles[index] == ROLE_SLEEP)
+    {
+        /* Distinct deadlines: each insert lands behind the earlier sleepers */
+        (void) rtos_task_notify_take(true, SLEEP_TICKS + index);
+    }
+
+    rtos_semaphore_signal(&g_parked);
+    while (1)
+    {
+        (void) rtos_task_notify_take(true, RTOS_NOTIFY_MAX_WAIT);
+    }
+}
+
+static void snapshot_point(void)
+{
+    memset(&g_result, 0, sizeof(g_result));
+
+    rtos_profiling_snapshot(&g_prof_tick, &g_result.tick);
+    rtos_profiling_snapshot(&g_prof_scheduler, &g_result.pick);
+    rtos_profiling_snapshot(&g_prof_context_switch, &g_result.ctx_switch);
+    rtos_profiling_snapshot(&g_prof_scheduling_latency, &g_result.wake);
+    rtos_profiling_snapshot(&g_stat_block, &g_result.block);
+}
+
+/**
+ * @brief Waker — blocks behind the delayed list, woken once per tick
+ *
+ * Resets the stats after the warmup wakes and snapshots them after the
+ * measured ones, before anything else runs.
+ */
+void Waker(void *param)
+{
+    (void) param;
+
+    while (1)
+    {
+        rtos_semaphore_wait(&g_waker_go, RTOS_SEM_MAX_WAIT);
+
+        for (uint32_t i = 0; i < BENCH_SCALE_WARMUP_TICKS + BENCH_SCALE_TICKS; i++)
+        {
+            if (i == BENCH_SCALE_WARMUP_TICKS)
+            {
+                rtos_port_enter_critical();
+                rtos_profiling_reset_system_stats();
+                rtos_profiling_reset_stat(&g_stat_block, "block");
+                rtos_port_exit_critical();
+            }
+
+            g_block_stamp = rtos_profiling_get_cycles();
+            (void) rtos_task_notify_take(true, WAKER_TIMEOUT);
+        }
+
+        snapshot_point();
+        g_stop = 1;
+        rtos_semaphore_signal(&g_point_done);
+    }
+}
+
+static void report_point(const char *sweep, uint32_t n, uint32_t s, uint32_t d)
+{
+    ulog_info("[SCALE] %-7s n=%-2lu s=%-2lu d=%-2lu avg: tick=%lu pick=%lu switch=%lu wake=%lu block=%lu", sweep,
+              (unsigned long) n, (unsigned long) s, (unsigned long) d, (unsigned long) g_result.tick.avg_cycles,
+              (unsigned long) g_result.pick.avg_cycles, (unsigned long) g_result.ctx_switch.avg_cycles,
+              (unsigned long) g_result.wake.avg_cycles, (unsigned long) g_result.block.avg_cycles);
+    ulog_info("[SCALE] %-7s n=%-2lu s=%-2lu d=%-2lu max: tick=%lu pick=%lu switch=%lu wake=%lu block=%lu", sweep,
+              (unsigned long) n, (unsigned long) s, (unsigned long) d, (unsigned long) g_result.tick.max_cycles,
+              (unsigned long) g_result.pick.max_cycles, (unsigned long) g_result.ctx_switch.max_cycles,
+              (unsigned long) g_result.wake.max_cycles, (unsigned long) g_result.block.max_cycles);
+}
+
+/**
+ * @brief Spawn n workers (s yielding, d sleeping, the rest blocked), measure, delete them
+ */
+static void run_point(const char *sweep, uint32_t n, uint32_t s, uint32_t d)
+{
+    g_stop         = 0;
+    g_block_stamp  = 0;
+    g_waker_parked = false;
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        g_roles[i] = (i < s) ? ROLE_YIELD : (i < s + d) ? ROLE_SLEEP : ROLE_PARK;
+        if (rtos_task_create(Worker, g_worker_names[i], BENCH_SCALE_STACK_SIZE, (void *) (uintptr_t) i,
+                             WORKER_PRIORITY, &g_workers[i]) != RTOS_SUCCESS)
+        {
+            ulog_error("[BENCH] Worker %lu: create failed", (unsigned long) i);
+            return;
+        }
+    }
+
+    rtos_semaphore_signal(&g_waker_go);
+    rtos_semaphore_wait(&g_point_done, RTOS_SEM_MAX_WAIT);
+
+    /* Sleepers leave the delayed list; yielders have seen g_stop */
+    for (uint32_t i = s; i < s + d; i++)
+    {
+        rtos_task_notify_give(g_workers[i]);
+    }
+    for (uint32_t i = 0; i < n; i++)
+    {
+        rtos_semaphore_wait(&g_parked, RTOS_SEM_MAX_WAIT);
+    }
+    for (uint32_t i = 0; i < n; i++)
+    {
+        (void) rtos_task_delete(g_workers[i]);
+    }
+
+    report_point(sweep, n, s, d);
+    rtos_delay_ms(FLUSH_MS);
+}
+
+/** 2, 4, 8, ... then max */
+static uint32_t next_count(uint32_t n, uint32_t max)
+{
+    return (n < max && 2U * n > max) ? max : 2U * n;
+}
+
+/**
+ * @brief Controller — runs the three sweeps
+ */
+void Controller(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+
+    bench_header("sched_scaling");
+
+    for (uint32_t n = 2U; n <= BENCH_SCALE_WORKERS; n = next_count(n, BENCH_SCALE_WORKERS))
+    {
+        run_point("tasks", n, 2U, 0U);
+    }
+    for (uint32_t n = 2U; n <= BENCH_SCALE_WORKERS; n = next_count(n, BENCH_SCALE_WORKERS))
+    {
+        run_point("shared", n, n, 0U);
+    }
+    for (uint32_t n = 2U; n <= BENCH_SCALE_WORKERS; n = next_count(n, BENCH_SCALE_WORKERS))
+    {
+        run_point("delayed", n, 2U, n - 2U);
+    }
+
+    ulog_info("[BENCH] Done. Scheduler type: %u  Workers: %u  Ticks per point: %u", (unsigned) RTOS_SCHEDULER_TYPE,
+              (unsigned) BENCH_SCALE_WORKERS, (unsigned) BENCH_SCALE_TICKS);
+
+    rtos_task_suspend(NULL);
+}
+
+/* ========================= STARTUP TIMER ================================== */
+
+static void startup_cb(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_started = 1;
+    ulog_info("[BENCH] Startup hold complete — starting scheduler scaling benchmark");
+}
+
+/* ========================= MAIN =========================================== */
+
+int main(void)
+{
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_INFO);
+
+    rtos_init();
+    rtos_profiling_init();
+
+    ulog_init(ULOG_LEVEL_INFO);
+    ulog_info("[BENCH] Scheduler Scaling Benchmark — " __DATE__ " " __TIME__);
+    ulog_info("[BENCH] Workers: up to %u  Ticks per point: %u (+%u warmup)  Scheduler: %u",
+              (unsigned) BENCH_SCALE_WORKERS, (unsigned) BENCH_SCALE_TICKS, (unsigned) BENCH_SCALE_WARMUP_TICKS,
+              (unsigned) RTOS_SCHEDULER_TYPE);
+
+    for (uint32_t i = 0; i < BENCH_SCALE_WORKERS; i++)
+    {
+        g_worker_names[i][0] = 'W';
+        g_worker_names[i][1] = (char) ('0' + i / 10U);
+        g_worker_names[i][2] = (char) ('0' + i % 10U);
+        g_worker_names[i][3] = '\0';
+    }
+
+    rtos_semaphore_init(&g_waker_go, 0, 1);
+    rtos_semaphore_init(&g_point_done, 0, 1);
+    rtos_semaphore_init(&g_parked, 0, BENCH_SCALE_WORKERS);
+
+    rtos_task_handle_t  handle;
+    rtos_timer_handle_t startup_timer;
+
+    /*
+     * Task priority layout:
+     *   Controller (5) — spawns each point's workers, prints results
+     *   Waker      (4) — blocks behind the delayed list, woken every tick
+     *   Workers    (3) — yield, sleep or stay blocked, per point
+     *   LogFlush   (0) — drains ulog to UART
+     */
+    rtos_task_create(Controller, "Control", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, CONTROLLER_PRIORITY, &handle);
+    rtos_task_create(Waker, "Waker", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, WAKER_PRIORITY, &g_waker_handle);
+
+    test_create_log_flush_task(&handle);
+    test_create_startup_timer(startup_cb, NULL, &startup_timer);
+
+    rtos_start_scheduler();
+
+    while (1) {}
+    return 0;
+}
@@ -21,6 +21,30 @@
  *     rtos_semaphore_wait(&g_sem, 0) -- count: 1 → 0  (non-blocking, instant)
  *     RTOS_USER_PROFILE_END(sem, &g_stat_uncontended)
  *
+ * Phase 1b — ISR give (single task + software interrupt):
+ *   BenchTask pends BENCH_IRQn; the handler times
+ *   rtos_semaphore_signal_from_isr() on the empty semaphore (count 0 → 1,
+ *   no waiter, so the LDREX/STREX fast path) and BenchTask takes the count
+ *   back with a non-blocking wait.
+ *
+ *   Measurement window (inside the handler):
+ *     RTOS_USER_PROFILE_START(isr)
+ *     rtos_semaphore_signal_from_isr(&g_sem, &woken)
+ *     RTOS_USER_PROFILE_END(isr, &g_stat_isr_give)
+ *
+ * Phase 1c — Critical section (single task):
+ *   An rtos_port_enter_critical()/rtos_port_exit_critical() pair, and the
+ *   same pair nested one level deeper.  The uncontended semaphore paths
+ *   above take the LDREX/STREX fast path and no critical section, so this
+ *   is where the cost of the inlined BASEPRI sequence (port_critical.h)
+ *   shows; every blocking or waking call (Phase 2) pays it at least once.
+ *
+ *   Measurement window:
+ *     RTOS_USER_PROFILE_START(crit)
+ *     rtos_port_enter_critical() [ rtos_port_enter_critical()
+ *     rtos_port_exit_critical() ]  rtos_port_exit_critical()
+ *     RTOS_USER_PROFILE_END(crit, &g_stat_critical[_nested])
+ *
  * Phase 2 — Contended wake latency (two tasks):
  *   SemHigh (priority 4) — blocks waiting for a signal.
  *   SemLow  (priority 2) — signals the semaphore periodically.
@@ -37,7 +61,7 @@
  *
  * SEQUENCING
  * ----------
- * BenchTask runs Phase 1 entirely, then signals g_phase2_sem to release
+ * BenchTask runs Phases 1, 1b and 1c entirely, then signals g_phase2_sem to release
  * SemHigh and SemLow.  ResultTask waits on g_all_done_sem (signalled twice:
  * once by BenchTask for Phase 1, once by SemHigh for Phase 2).
  *
@@ -48,19 +72,31 @@
  * EXPECTED OUTPUT (at 180 MHz, STM32F446RE)
  *   [BENCH] ===== semaphore_uncontended =====
  *   semaphore_uncontended | count=1000 | min=8cy(0us) max=14cy(0us) avg=10cy(0us)
+ *   [BENCH] ===== semaphore_isr_give =====
+ *   ...
+ *   [BENCH] ===== critical_section =====
+ *   ...
  *   [BENCH] ===== semaphore_wake_latency =====
  *   semaphore_wake_latency | count=1000 | min=53cy(0us) max=71cy(0us) avg=58cy(0us)
  ******************************************************************************/
 
 #include "VRTOS.h"
 #include "bench_common.h"
+#include "device.h" /* IWYU pragma: keep */
 #include "hardware_env.h"
 #include "profiling.h"
+#include "rtos_port.h"
 #include "semaphore.h"
-#include "stm32f4xx_hal.h" /* IWYU pragma: keep */
 #include "uart_tx.h"
 #include "ulog.h"
 
+/* ========================= PARAMETERS ===================================== */
+
+/* Spare peripheral interrupt, unused on the Nucleo-F446RE */
+#define BENCH_IRQn       SPI4_IRQn
+#define BENCH_IRQHandler SPI4_IRQHandler
+#define BENCH_IRQ_PRIO   (10U) /* Masked by the kernel (BASEPRI), above the log IRQs */
+
 /* ========================= SHARED STATE =================================== */
 
 /** Semaphore under test (binary, initial count 0, max count 1). */
@@ -80,6 +116,16 @@ static rtos_semaphore_t g_all_done_sem;
 /** Phase 1: signal+wait round-trip with no blocking. */
 static rtos_profile_stat_t g_stat_uncontended = BENCH_STAT_INIT("semaphore_uncontended");
 
+/** Phase 1b: rtos_semaphore_signal_from_isr() with no waiter. */
+static rtos_profile_stat_t g_stat_isr_give = BENCH_STAT_INIT("semaphore_isr_give");
+
+/** Phase 1c: enter+exit critical, outermost and nested one level. */
+static rtos_profile_stat_t g_stat_critical        = BENCH_STAT_INIT("critical_section");
+static rtos_profile_stat_t g_stat_critical_nested = BENCH_STAT_INIT("critical_section_nested");
+
+/** 0 during warmup: the handler discards its samples. */
+static volatile uint32_t g_isr_recording = 0;
+
 /** Phase 2: cycles from SemLow's signal call to SemHigh resuming. */
 static rtos_profile_stat_t g_stat_contended = BENCH_STAT_INIT("semaphore_wake_latency");
 
@@ -89,6 +135,17 @@ static rtos_profile_stat_t g_stat_contended = BENCH_STAT_INIT("semaphore_wake_la
  */
 static volatile uint32_t g_signal_cycles = 0;
 
+/* ========================= INTERRUPT HANDLER ============================== */
+
+void BENCH_IRQHandler(void)
+{
+    bool woken = false;
+
+    RTOS_USER_PROFILE_START(isr);
+    rtos_semaphore_signal_from_isr(&g_sem, &woken); /* count: 0 → 1, nobody waits */
+    RTOS_USER_PROFILE_END(isr, g_isr_recording ? &g_stat_isr_give : NULL);
+}
+
 /* ========================= TASK FUNCTIONS ================================= */
 
 /**
@@ -116,6 +173,36 @@ void BenchTask(void *param)
         RTOS_USER_PROFILE_END(sem, &g_stat_uncontended);
     }
 
+    /* --- Phase 1b: give from ISR, take back from task --- */
+    for (uint32_t i = 0; i < BENCH_WARMUP + BENCH_ITERATIONS; i++)
+    {
+        g_isr_recording = (i >= BENCH_WARMUP) ? 1U : 0U;
+
+        NVIC->STIR = (uint32_t) BENCH_IRQn;
+        __DSB();
+        __ISB();
+
+        rtos_semaphore_wait(&g_sem, RTOS_SEM_NO_WAIT); /* count: 1 → 0 (no block) */
+    }
+
+    /* --- Phase 1c: critical section enter/exit, outermost and nested --- */
+    for (uint32_t i = 0; i < BENCH_WARMUP + BENCH_ITERATIONS; i++)
+    {
+        bool record = (i >= BENCH_WARMUP);
+
+        RTOS_USER_PROFILE_START(crit);
+        rtos_port_enter_critical();
+        rtos_port_exit_critical();
+        RTOS_USER_PROFILE_END(crit, record ? &g_stat_critical : NULL);
+
+        rtos_port_enter_critical();
+        RTOS_USER_PROFILE_START(nested);
+        rtos_port_enter_critical();
+        rtos_port_exit_critical();
+        RTOS_USER_PROFILE_END(nested, record ? &g_stat_critical_nested : NULL);
+        rtos_port_exit_critical();
+    }
+
     /* Gate Phase 2 tasks. */
     rtos_semaphore_signal(&g_phase2_sem);
     rtos_semaphore_signal(&g_phase2_sem);
@@ -203,6 +290,13 @@ void ResultTask(void *param)
     bench_header("semaphore_uncontended");
     bench_report(&g_stat_uncontended);
 
+    bench_header("semaphore_isr_give");
+    bench_report(&g_stat_isr_give);
+
+    bench_header("critical_section");
+    bench_report(&g_stat_critical);
+    bench_report(&g_stat_critical_nested);
+
     bench_header("semaphore_wake_latency");
     bench_report(&g_stat_contended);
 
@@ -258,6 +352,9 @@ int main(void)
     test_create_log_flush_task(&handle);
     test_create_startup_timer(startup_cb, NULL, &startup_timer);
 
+    NVIC_SetPriority(BENCH_IRQn, BENCH_IRQ_PRIO);
+    NVIC_EnableIRQ(BENCH_IRQn);
+
     printf("[DBG] About to start scheduler\r\n");
 
     rtos_start_scheduler();
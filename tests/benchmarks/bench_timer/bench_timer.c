@@ -0,0 +1,413 @@
+/*******************************************************************************
+ * File: tests/benchmarks/bench_timer/bench_timer.c
+ * Description: Software Timer API Cost, Expiry Cost and Dispatch Jitter Benchmark
+ * Author: Student
+ * Date: 2025
+ *
+ * WHAT IS MEASURED
+ * ----------------
+ * API cost, from BenchTask, with n = 1, 4, 16 and 64 timers active (the
+ * probe plus n-1 background timers, auto-reload and one-shot alternately,
+ * with mixed periods):
+ *
+ *   TimerStart<n>   rtos_timer_start() on the inactive probe
+ *   TimerChange<n>  rtos_timer_change_period() on the active probe
+ *   TimerStop<n>    rtos_timer_stop() on the active probe
+ *
+ * The probe's period is longer than any background timer's, so a sorted
+ * active list is walked to its end on every insert.  With the deferred
+ * daemon (RTOS_USE_DEFERRED_WORK=1) each call posts a command that the
+ * daemon applies before the call returns, so the figure is the whole round
+ * trip a task sees.
+ *
+ * Expiry cost and jitter, with k = 1, 4, 16 and 64 timers armed to expire
+ * on the same tick, BENCH_TIMER_ROUNDS times each:
+ *
+ *   TimerTick<k>    worst SysTick handler (g_prof_tick) in the round, which
+ *                   is the expiry tick: rtos_timer_tick() runs the k
+ *                   callbacks there without the daemon, and only wakes the
+ *                   daemon with it
+ *   TimerLate<k>    every callback's entry, measured from the ideal expiry
+ *                   (the tick edge rtos_time_now_ns() counts from); its
+ *                   spread is the dispatch jitter
+ *   TimerBatch<k>   the last callback of each round, from the same edge:
+ *                   the time to dispatch the whole batch
+ *
+ * SCENARIO
+ * --------
+ *   BenchTask (priority 2):
+ *     Runs below the deferred daemon and owns every timer.  To make k
+ *     timers share an expiry it gives each one the period left to the
+ *     round's target tick and starts it, re-arming any timer whose call
+ *     straddled a tick.  It then sleeps past the target and waits for the
+ *     k callbacks.  Auto-reload timers fire once per round; a re-fire
+ *     before they are stopped is ignored.
+ *
+ * CONFIGURATIONS
+ * --------------
+ * The same source builds as bench_timer (deferred daemon, sorted list),
+ * bench_timer_wheel (RTOS_USE_TIMING_WHEEL=1) and bench_timer_isr
+ * (RTOS_USE_DEFERRED_WORK=0, callbacks in SysTick), the before and after
+ * of either change.  The wheel makes the Start/Change/Stop rows flat in n;
+ * the daemon moves the k-dependent cost out of TimerTick.
+ *
+ * BUILD
+ * -----
+ *   pio run -e bench_timer -t upload
+ *   pio run -e bench_timer_wheel -t upload
+ *   pio run -e bench_timer_isr -t upload
+ *
+ * EXPECTED OUTPUT
+ *   [BENCH] ===== timer_api =====
+ *   [TimerStart1]: Min=..., Max=..., Avg=..., Cnt=1000
+ *   ...
+ *   [BENCH] ===== timer_expiry =====
+ *   [TimerTick1]: ...  [TimerLate1]: ...  [TimerBatch1]: ...
+ *   ...
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "bench_common.h"
+#include "device.h" /* IWYU pragma: keep */
+#include "hardware_env.h"
+#include "profiling.h"
+#include "rtos_assert.h"
+#include "rtos_port.h"
+#include "rtos_time.h"
+#include "task.h"
+#include "timer.h"
+#include "uart_tx.h"
+#include "ulog.h"
+
+/* ========================= CONFIGURATION ================================== */
+
+#define BENCH_PRIORITY (2U)
+
+#define BENCH_TIMER_SIZES (4U)
+#define BENCH_MAX_TIMERS  (64U)
+
+static const uint32_t g_timer_counts[BENCH_TIMER_SIZES] = {1U, 4U, 16U, 64U};
+
+/* Rounds per batch size in the expiry section */
+#ifndef BENCH_TIMER_ROUNDS
+#define BENCH_TIMER_ROUNDS (50U)
+#endif
+
+/* Background timers never expire during the API section; the probe sorts last */
+#define BACKGROUND_PERIOD (20000U)
+#define BACKGROUND_STEP   (97U)
+#define PROBE_PERIOD      (BACKGROUND_PERIOD + BENCH_MAX_TIMERS * BACKGROUND_STEP)
+
+/* Ticks from a round's start to its target: 4 plus one per timer to arm */
+#define LEAD_TICKS(k) (4U + (k))
+
+/* Polls of one tick for a round's callbacks before it is counted as lost */
+#define ROUND_TIMEOUT_TICKS (100U)
+
+/* Lets LogFlush drain one section before the next */
+#define FLUSH_MS (50U)
+
+#define NS_PER_TICK (1000000000ULL / RTOS_TICK_RATE_HZ)
+
+RTOS_STATIC_ASSERT(RTOS_PROFILING_SYSTEM_ENABLED, "bench_timer reads the kernel's tick handler stat");
+RTOS_STATIC_ASSERT(!RTOS_USE_DEFERRED_WORK || BENCH_PRIORITY < RTOS_DEFERRED_TASK_PRIORITY,
+                   "bench_timer runs below the deferred daemon");
+
+/* ========================= SHARED STATE =================================== */
+
+static volatile uint32_t g_test_started = 0;
+
+static rtos_timer_static_t g_timer_storage[BENCH_MAX_TIMERS];
+static rtos_timer_handle_t g_timers[BENCH_MAX_TIMERS];
+
+/* Per round: set by BenchTask before the target, read by the callbacks */
+static volatile bool     g_armed[BENCH_MAX_TIMERS];
+static volatile uint32_t g_fired;
+static uint32_t          g_batch;
+static uint32_t          g_size_index;
+static uint64_t          g_target_ns;
+
+static uint32_t g_rearmed = 0;
+static uint32_t g_lost    = 0;
+
+/* ========================= PROFILING STATS ================================ */
+
+static rtos_profile_stat_t g_stat_start[BENCH_TIMER_SIZES] = {
+    BENCH_STAT_INIT("TimerStart1"), BENCH_STAT_INIT("TimerStart4"), BENCH_STAT_INIT("TimerStart16"),
+    BENCH_STAT_INIT("TimerStart64")};
+static rtos_profile_stat_t g_stat_change[BENCH_TIMER_SIZES] = {
+    BENCH_STAT_INIT("TimerChange1"), BENCH_STAT_INIT("TimerChange4"), BENCH_STAT_INIT("TimerChange16"),
+    BENCH_STAT_INIT("TimerChange64")};
+static rtos_profile_stat_t g_stat_stop[BENCH_TIMER_SIZES] = {
+    BENCH_STAT_INIT("TimerStop1"), BENCH_STAT_INIT("TimerStop4"), BENCH_STAT_INIT("TimerStop16"),
+    BENCH_STAT_INIT("TimerStop64")};
+
+static rtos_profile_stat_t g_stat_tick[BENCH_TIMER_SIZES] = {
+    BENCH_STAT_INIT("TimerTick1"), BENCH_STAT_INIT("TimerTick4"), BENCH_STAT_INIT("TimerTick16"),
+    BENCH_STAT_INIT("TimerTick64")};
+static rtos_profile_stat_t g_stat_late[BENCH_TIMER_SIZES] = {
+    BENCH_STAT_INIT("TimerLate1"), BENCH_STAT_INIT("TimerLate4"), BENCH_STAT_INIT("TimerLate16"),
+    BENCH_STAT_INIT("TimerLate64")};
+static rtos_profile_stat_t g_stat_batch[BENCH_TIMER_SIZES] = {
+    BENCH_STAT_INIT("TimerBatch1"), BENCH_STAT_INIT("TimerBatch4"), BENCH_STAT_INIT("TimerBatch16"),
+    BENCH_STAT_INIT("TimerBatch64")};
+
+/* ========================= TIMER CALLBACKS ================================ */
+
+static uint32_t ns_to_cycles(uint64_t ns)
+{
+    return (uint32_t) ((ns * SystemCoreClock) / 1000000000ULL);
+}
+
+/* Daemon task, or SysTick with RTOS_USE_DEFERRED_WORK=0 */
+static void expiry_cb(void *timer_handle, void *param)
+{
+    uint32_t index = (uint32_t) (uintptr_t) param;
+    uint64_t now   = rtos_time_now_ns();
+
+    (void) timer_handle;
+
+    if (!g_armed[index])
+    {
+        return;
+    }
+    g_armed[index] = false;
+
+    uint32_t late = (now > g_target_ns) ? ns_to_cycles(now - g_target_ns) : 0U;
+    rtos_profiling_record(&g_stat_late[g_size_index], late);
+
+    if (++g_fired == g_batch)
+    {
+        rtos_profiling_record(&g_stat_batch[g_size_index], late);
+    }
+}
+
+/* ========================= TASK FUNCTIONS ================================= */
+
+static void stop_timers(uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        g_armed[i] = false;
+        rtos_timer_stop(g_timers[i]);
+    }
+}
+
+static void bench_api(uint32_t s, bool record)
+{
+    uint32_t            n     = g_timer_counts[s];
+    rtos_timer_handle_t probe = g_timers[0];
+
+    /* Timers 1..n-1 are the background; the probe is timer 0 */
+    for (uint32_t i = 1; i < n; i++)
+    {
+        rtos_timer_change_period(g_timers[i], BACKGROUND_PERIOD + i * BACKGROUND_STEP);
+        rtos_timer_start(g_timers[i]);
+    }
+
+    for (uint32_t i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        /* Alternate between two periods that both sort behind the background */
+        rtos_tick_t period = PROBE_PERIOD + (i & 1U);
+
+        uint32_t t0 = rtos_profiling_get_cycles();
+        rtos_timer_start(probe);
+        uint32_t t1 = rtos_profiling_get_cycles();
+        rtos_timer_change_period(probe, period);
+        uint32_t t2 = rtos_profiling_get_cycles();
+        rtos_timer_stop(probe);
+        uint32_t t3 = rtos_profiling_get_cycles();
+
+        if (record)
+        {
+            rtos_profiling_record(&g_stat_start[s], t1 - t0);
+            rtos_profiling_record(&g_stat_change[s], t2 - t1);
+            rtos_profiling_record(&g_stat_stop[s], t3 - t2);
+        }
+    }
+
+    stop_timers(n);
+}
+
+/* Arm timer i to expire on target; false if the target has already come */
+static bool arm_for(uint32_t i, rtos_tick_t target)
+{
+    while (1)
+    {
+        rtos_tick_t before = rtos_get_tick_count();
+        if ((int32_t) (target - before) < 1)
+        {
+            return false;
+        }
+
+        g_armed[i] = true;
+        rtos_timer_change_period(g_timers[i], target - before);
+        rtos_timer_start(g_timers[i]);
+
+        /* The start read the tick in between: unchanged means it used before */
+        if (rtos_get_tick_count() == before)
+        {
+            return true;
+        }
+        g_armed[i] = false;
+        rtos_timer_stop(g_timers[i]);
+        g_rearmed++;
+    }
+}
+
+static void bench_round(uint32_t s, bool record)
+{
+    uint32_t k = g_timer_counts[s];
+
+    /* Start just after a tick edge with the whole lead ahead */
+    rtos_delay_ticks(1);
+
+    uint64_t    base   = rtos_get_tick_count64();
+    rtos_tick_t target = (rtos_tick_t) (base + LEAD_TICKS(k));
+
+    g_fired      = 0;
+    g_batch      = k;
+    g_size_index = s;
+    g_target_ns  = (base + LEAD_TICKS(k)) * NS_PER_TICK;
+
+    for (uint32_t i = 0; i < k; i++)
+    {
+        if (!arm_for(i, target))
+        {
+            stop_timers(k);
+            g_lost++;
+            return;
+        }
+    }
+
+    /* The expiry tick is the worst one the handler sees this round */
+    rtos_port_enter_critical();
+    rtos_profiling_reset_stat(&g_prof_tick, "TickHandler");
+    rtos_port_exit_critical();
+
+    rtos_delay_ticks((rtos_tick_t) (target - rtos_get_tick_count()) + 1U);
+    for (uint32_t t = 0; g_fired < k && t < ROUND_TIMEOUT_TICKS; t++)
+    {
+        rtos_delay_ticks(1);
+    }
+
+    rtos_profile_snapshot_t tick;
+    rtos_profiling_snapshot(&g_prof_tick, &tick);
+
+    if (g_fired < k)
+    {
+        g_lost++;
+    }
+    else if (record)
+    {
+        rtos_profiling_record(&g_stat_tick[s], tick.max_cycles);
+    }
+
+    stop_timers(k);
+}
+
+/**
+ * @brief BenchTask — API section, then expiry section, then the report
+ */
+void BenchTask(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+
+    for (uint32_t s = 0; s < BENCH_TIMER_SIZES; s++)
+    {
+        bench_api(s, false);
+        bench_api(s, true);
+    }
+
+    for (uint32_t s = 0; s < BENCH_TIMER_SIZES; s++)
+    {
+        /* Callbacks record only in measured rounds */
+        bench_round(s, false);
+        rtos_profiling_reset_stat(&g_stat_late[s], g_stat_late[s].name);
+        rtos_profiling_reset_stat(&g_stat_batch[s], g_stat_batch[s].name);
+
+        for (uint32_t r = 0; r < BENCH_TIMER_ROUNDS; r++)
+        {
+            bench_round(s, true);
+        }
+    }
+
+    bench_header("timer_api");
+    for (uint32_t s = 0; s < BENCH_TIMER_SIZES; s++)
+    {
+        bench_report(&g_stat_start[s]);
+        bench_report(&g_stat_change[s]);
+        bench_report(&g_stat_stop[s]);
+        rtos_delay_ms(FLUSH_MS);
+    }
+
+    bench_header("timer_expiry");
+    for (uint32_t s = 0; s < BENCH_TIMER_SIZES; s++)
+    {
+        bench_report(&g_stat_tick[s]);
+        bench_report(&g_stat_late[s]);
+        bench_report(&g_stat_batch[s]);
+        rtos_delay_ms(FLUSH_MS);
+    }
+
+    ulog_info("[BENCH] rearmed=%lu  lost_rounds=%lu", (unsigned long) g_rearmed, (unsigned long) g_lost);
+    ulog_info("[BENCH] Done. Deferred daemon: %u  Timing wheel: %u", (unsigned) RTOS_USE_DEFERRED_WORK,
+              (unsigned) RTOS_USE_TIMING_WHEEL);
+
+    rtos_task_suspend(NULL);
+}
+
+/* ========================= STARTUP TIMER ================================== */
+
+static void startup_cb(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_started = 1;
+    ulog_info("[BENCH] Startup hold complete — starting timer benchmark");
+}
+
+/* ========================= MAIN =========================================== */
+
+int main(void)
+{
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_INFO);
+
+    rtos_init();
+    rtos_profiling_init();
+
+    ulog_init(ULOG_LEVEL_INFO);
+    ulog_info("[BENCH] Software Timer Benchmark — " __DATE__ " " __TIME__);
+    ulog_info("[BENCH] Iterations: %u  Rounds: %u  Timers: 1/4/16/64", BENCH_ITERATIONS, BENCH_TIMER_ROUNDS);
+
+    /* Auto-reload and one-shot alternately; periods are set per use */
+    for (uint32_t i = 0; i < BENCH_MAX_TIMERS; i++)
+    {
+        rtos_timer_mode_t mode = (i & 1U) ? RTOS_TIMER_ONE_SHOT : RTOS_TIMER_AUTO_RELOAD;
+
+        rtos_timer_create_static("Bench", PROBE_PERIOD, mode, expiry_cb, (void *) (uintptr_t) i, &g_timer_storage[i],
+                                 &g_timers[i]);
+    }
+
+    rtos_task_handle_t  handle;
+    rtos_timer_handle_t startup_timer;
+
+    /*
+     * Task priority layout:
+     *   Deferred  (max) — applies timer commands, runs callbacks
+     *   BenchTask (2)   — owns the timers, runs the measurements
+     *   LogFlush  (0)   — drains ulog ring buffer to UART
+     */
+    rtos_task_create(BenchTask, "Bench", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, BENCH_PRIORITY, &handle);
+
+    test_create_log_flush_task(&handle);
+    test_create_startup_timer(startup_cb, NULL, &startup_timer);
+
+    rtos_start_scheduler();
+
+    while (1) {}
+    return 0;
+}
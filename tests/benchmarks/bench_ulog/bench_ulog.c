@@ -0,0 +1,183 @@
+/*******************************************************************************
+ * File: tests/benchmarks/bench_ulog/bench_ulog.c
+ * Description: Immediate vs. Deferred-Format ULog Benchmark
+ * Author: Student
+ * Date: 2025
+ *
+ * WHAT IS MEASURED
+ * ----------------
+ * Cycle cost, in the calling task, of one log line through:
+ *
+ *   1. ulog()          — vsnprintf in the caller, text copied to the ring
+ *   2. ulog_deferred() — format pointer + raw argument words copied to the
+ *                        ring, no formatting in the caller
+ *   3. ulog_deferred() with no arguments (fixed message)
+ *
+ * and, on the consumer side, the cost of ulog_drain() for one line of each
+ * kind — where the deferred formatting cost moves to (the flush task).
+ *
+ * Each call is bracketed by RTOS_USER_PROFILE_START/END (DWT cycle counter).
+ *
+ * SCENARIO
+ * --------
+ *   BenchTask (priority 2):
+ *     Logs the same 3-argument line both ways each iteration and drains the
+ *     ring itself into a discard buffer, so every measured call finds the
+ *     ring empty and never takes the drop path. LogFlush (priority 0) does
+ *     not run until the report is printed.
+ *
+ * BUILD
+ * -----
+ *   pio run -e bench_ulog -t upload
+ *
+ * EXPECTED OUTPUT (at 180 MHz, STM32F446RE)
+ *   [BENCH] ===== ulog_immediate_vs_deferred =====
+ *   [UlogFormat]:   Min=.. cyc ...   (thousands: vsnprintf)
+ *   [UlogDeferred]: Min=.. cyc ...   (a few hundred: format scan + copy)
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "bench_common.h"
+#include "device.h" /* IWYU pragma: keep */
+#include "hardware_env.h"
+#include "log_flush_task.h"
+#include "profiling.h"
+#include "uart_tx.h"
+#include "ulog.h"
+
+/* ========================= SHARED STATE =================================== */
+
+static volatile uint32_t g_test_started = 0;
+
+/* Measured lines go here instead of the UART */
+static uint8_t g_sink[ULOG_LINE_MAX];
+
+/* ========================= PROFILING STATS ================================ */
+
+static rtos_profile_stat_t g_stat_format       = BENCH_STAT_INIT("UlogFormat");
+static rtos_profile_stat_t g_stat_deferred     = BENCH_STAT_INIT("UlogDeferred");
+static rtos_profile_stat_t g_stat_deferred_0   = BENCH_STAT_INIT("UlogDeferred0");
+static rtos_profile_stat_t g_stat_drain_text   = BENCH_STAT_INIT("DrainText");
+static rtos_profile_stat_t g_stat_drain_format = BENCH_STAT_INIT("DrainDeferred");
+
+/* ========================= TASK FUNCTIONS ================================= */
+
+static void bench_drain(rtos_profile_stat_t *stat, bool record)
+{
+    RTOS_USER_PROFILE_START(drain);
+    while (ulog_drain(g_sink, sizeof(g_sink)) > 0)
+    {
+    }
+    if (record)
+    {
+        RTOS_USER_PROFILE_END(drain, stat);
+    }
+}
+
+static void bench_once(uint32_t i, bool record)
+{
+    RTOS_USER_PROFILE_START(format);
+    ulog(ULOG_LEVEL_INFO, "[I] [SENSOR] id=%lu value=%lu status=%u", (unsigned long) i, (unsigned long) (i * 7U),
+         (unsigned) (i & 3U));
+    if (record)
+    {
+        RTOS_USER_PROFILE_END(format, &g_stat_format);
+    }
+    bench_drain(&g_stat_drain_text, record);
+
+    RTOS_USER_PROFILE_START(deferred);
+    ulog_deferred(ULOG_LEVEL_INFO, "[I] [SENSOR] id=%lu value=%lu status=%u", (unsigned long) i,
+                  (unsigned long) (i * 7U), (unsigned) (i & 3U));
+    if (record)
+    {
+        RTOS_USER_PROFILE_END(deferred, &g_stat_deferred);
+    }
+    bench_drain(&g_stat_drain_format, record);
+
+    RTOS_USER_PROFILE_START(deferred_0);
+    ulog_deferred(ULOG_LEVEL_INFO, "[I] [SENSOR] heartbeat");
+    if (record)
+    {
+        RTOS_USER_PROFILE_END(deferred_0, &g_stat_deferred_0);
+    }
+    bench_drain(NULL, false);
+}
+
+/**
+ * @brief BenchTask — runs warmup, then the measured log calls
+ */
+void BenchTask(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+
+    /* Let the flush task print the startup messages before the ring is ours */
+    log_flush_request();
+    rtos_delay_ms(100);
+
+    for (uint32_t i = 0; i < BENCH_WARMUP; i++)
+    {
+        bench_once(i, false);
+    }
+
+    for (uint32_t i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        bench_once(i, true);
+    }
+
+    bench_header("ulog_immediate_vs_deferred");
+    bench_report(&g_stat_format);
+    bench_report(&g_stat_deferred);
+    bench_report(&g_stat_deferred_0);
+    bench_report(&g_stat_drain_text);
+    bench_report(&g_stat_drain_format);
+
+    ulog_info("[BENCH] Done.");
+
+    rtos_task_suspend(NULL);
+}
+
+/* ========================= STARTUP TIMER ================================== */
+
+static void startup_cb(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_started = 1;
+    ulog_info("[BENCH] Startup hold complete — starting ulog benchmark");
+}
+
+/* ========================= MAIN =========================================== */
+
+int main(void)
+{
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_INFO);
+
+    rtos_init();
+    rtos_profiling_init();
+
+    ulog_init(ULOG_LEVEL_INFO);
+    ulog_info("[BENCH] ULog Immediate vs. Deferred Benchmark — " __DATE__ " " __TIME__);
+    ulog_info("[BENCH] Iterations: %u  Warmup: %u  Max deferred words: %u", BENCH_ITERATIONS, BENCH_WARMUP,
+              ULOG_DEFERRED_MAX_WORDS);
+
+    rtos_task_handle_t  handle;
+    rtos_timer_handle_t startup_timer;
+
+    /*
+     * Task priority layout:
+     *   BenchTask (2) — runs the measurements
+     *   LogFlush  (0) — drains ulog ring buffer to UART
+     */
+    rtos_task_create(BenchTask, "Bench", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, 2, &handle);
+
+    test_create_log_flush_task(&handle);
+    test_create_startup_timer(startup_cb, NULL, &startup_timer);
+
+    rtos_start_scheduler();
+
+    while (1) {}
+    return 0;
+}
@@ -0,0 +1,298 @@
+/*******************************************************************************
+ * File: tests/benchmarks/bench_zero_latency/bench_zero_latency.c
+ * Description: Zero-Latency Interrupt Tier Benchmark
+ * Author: Student
+ * Date: 2025
+ *
+ * WHAT IS MEASURED
+ * ----------------
+ * Entry latency of a hardware interrupt while the kernel is busy, for the
+ * two interrupt tiers:
+ *
+ *   zero_latency_irq   TIM2 at PORT_IRQ_PRIORITY_CRITICAL, above the
+ *                      kernel's BASEPRI threshold: never masked
+ *   kernel_tier_irq    TIM5 at NVIC priority 10, below the threshold:
+ *                      held off by every kernel critical section
+ *
+ * Each timer free-runs at the core clock (16 MHz HSI, APB1 prescaler 1)
+ * and raises its update interrupt when the counter wraps to 0. The first
+ * statement of the handler reads CNT, so the sample is the number of
+ * cycles from the update event to the handler's first line.
+ *
+ * Meanwhile two load tasks ping-pong on semaphores and hammer a mutex and
+ * a queue, so context switches, PendSV, SysTick and critical sections run
+ * continuously. The periods (1601 and 1999 cycles) are prime, so the
+ * interrupts drift across every kernel path.
+ *
+ * EXPECTED RESULT
+ * ---------------
+ * zero_latency_irq Max stays at its Min (hardware exception entry plus the
+ * CNT read): the kernel never masks that tier. kernel_tier_irq Max grows
+ * by the longest kernel critical section.
+ *
+ * The handlers call no kernel API (the critical tier must not), not even
+ * rtos_profiling_record(): they store raw samples, which ResultTask
+ * records once the load has been stopped.
+ *
+ * BUILD
+ * -----
+ *   pio run -e bench_zero_latency -t upload
+ *
+ * EXPECTED OUTPUT
+ *   [BENCH] ===== zero_latency_irq =====
+ *   [zero_latency_irq]: Min=..., Max=..., Avg=..., Cnt=1000
+ *   [BENCH] ===== kernel_tier_irq =====
+ *   ...
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "bench_common.h"
+#include "device.h" /* IWYU pragma: keep */
+#include "hardware_env.h"
+#include "mutex.h"
+#include "profiling.h"
+#include "queue.h"
+#include "rtos_port.h"
+#include "semaphore.h"
+#include "task.h"
+#include "uart_tx.h"
+#include "ulog.h"
+
+/* ========================= PARAMETERS ===================================== */
+
+#define CRITICAL_TIM        TIM2
+#define CRITICAL_IRQn       TIM2_IRQn
+#define CRITICAL_IRQHandler TIM2_IRQHandler
+#define CRITICAL_IRQ_PRIO   (PORT_IRQ_PRIORITY_CRITICAL >> PORT_NVIC_PRIO_SHIFT)
+#define CRITICAL_PERIOD     (1601U)
+
+#define KERNEL_TIM        TIM5
+#define KERNEL_IRQn       TIM5_IRQn
+#define KERNEL_IRQHandler TIM5_IRQHandler
+#define KERNEL_IRQ_PRIO   (10U) /* Masked by the kernel (BASEPRI) */
+#define KERNEL_PERIOD     (1999U)
+
+#if RTOS_USE_HRTIMER
+#error "bench_zero_latency drives TIM5, which the high-resolution timer owns: build with RTOS_USE_HRTIMER=0"
+#endif
+
+RTOS_STATIC_ASSERT(!PORT_IRQ_IS_KERNEL_SAFE(CRITICAL_IRQ_PRIO), "critical tier must sit above the kernel mask");
+RTOS_ASSERT_KERNEL_IRQ_PRIORITY(KERNEL_IRQ_PRIO);
+
+#define RESULT_PRIORITY (4U)
+#define LOAD_PRIORITY   (3U)
+
+/* ========================= SHARED STATE =================================== */
+
+/** Startup gate: set to 1 by the startup timer. */
+static volatile uint32_t g_test_started = 0;
+
+/** Raw samples of one tier, written only by its handler. */
+typedef struct
+{
+    volatile uint32_t seen;  /**< Interrupts taken, warmup included */
+    volatile uint32_t count; /**< Samples stored */
+    uint32_t          samples[BENCH_ITERATIONS];
+} tier_samples_t;
+
+static tier_samples_t g_critical_samples;
+static tier_samples_t g_kernel_samples;
+
+static rtos_semaphore_t    g_ping_sem;
+static rtos_semaphore_t    g_pong_sem;
+static rtos_mutex_t        g_load_mutex;
+static rtos_queue_handle_t g_load_queue;
+
+static rtos_task_handle_t g_ping_handle = NULL;
+static rtos_task_handle_t g_pong_handle = NULL;
+
+/* ========================= PROFILING STATS ================================ */
+
+static rtos_profile_stat_t g_stat_critical = BENCH_STAT_INIT("zero_latency_irq");
+static rtos_profile_stat_t g_stat_kernel   = BENCH_STAT_INIT("kernel_tier_irq");
+
+/* ========================= INTERRUPT HANDLERS ============================= */
+
+static inline void tier_store(tier_samples_t *tier, uint32_t latency)
+{
+    if (tier->seen++ >= BENCH_WARMUP && tier->count < BENCH_ITERATIONS)
+    {
+        tier->samples[tier->count++] = latency;
+    }
+}
+
+void CRITICAL_IRQHandler(void)
+{
+    /* First statement: cycles since the update event */
+    uint32_t latency = CRITICAL_TIM->CNT;
+
+    CRITICAL_TIM->SR = (uint32_t) ~TIM_SR_UIF;
+    tier_store(&g_critical_samples, latency);
+}
+
+void KERNEL_IRQHandler(void)
+{
+    uint32_t latency = KERNEL_TIM->CNT;
+
+    KERNEL_TIM->SR = (uint32_t) ~TIM_SR_UIF;
+    tier_store(&g_kernel_samples, latency);
+}
+
+/* ========================= TASK FUNCTIONS ================================= */
+
+/**
+ * @brief LoadPing — signals Pong and waits for it, forever
+ */
+void LoadPing(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+
+    while (1)
+    {
+        rtos_semaphore_signal(&g_ping_sem);
+        rtos_semaphore_wait(&g_pong_sem, RTOS_SEM_MAX_WAIT);
+    }
+}
+
+/**
+ * @brief LoadPong — mutex and queue round trip per ping
+ */
+void LoadPong(void *param)
+{
+    (void) param;
+
+    uint32_t item = 0;
+
+    while (1)
+    {
+        rtos_semaphore_wait(&g_ping_sem, RTOS_SEM_MAX_WAIT);
+
+        rtos_mutex_lock(&g_load_mutex, RTOS_MAX_DELAY);
+        rtos_queue_send(g_load_queue, &item, 0);
+        rtos_queue_receive(g_load_queue, &item, 0);
+        rtos_mutex_unlock(&g_load_mutex);
+        item++;
+
+        rtos_semaphore_signal(&g_pong_sem);
+    }
+}
+
+static void tier_timer_start(TIM_TypeDef *tim, uint32_t period, IRQn_Type irq, uint32_t prio)
+{
+    tim->CR1  = 0;
+    tim->PSC  = 0;
+    tim->ARR  = period - 1U;
+    tim->EGR  = TIM_EGR_UG; /* Load PSC/ARR now; sets UIF, cleared below */
+    tim->SR   = 0;
+    tim->DIER = TIM_DIER_UIE;
+
+    NVIC_SetPriority(irq, prio);
+    NVIC_EnableIRQ(irq);
+
+    tim->CR1 = TIM_CR1_CEN;
+}
+
+static void tier_report(tier_samples_t *tier, rtos_profile_stat_t *stat)
+{
+    for (uint32_t i = 0; i < tier->count; i++)
+    {
+        rtos_profiling_record(stat, tier->samples[i]);
+    }
+}
+
+/**
+ * @brief ResultTask — starts the timers, waits for both tiers, reports
+ */
+void ResultTask(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+
+    RCC->APB1ENR |= RCC_APB1ENR_TIM2EN | RCC_APB1ENR_TIM5EN;
+    (void) RCC->APB1ENR; /* Clock running before the first register write */
+
+    tier_timer_start(CRITICAL_TIM, CRITICAL_PERIOD, CRITICAL_IRQn, CRITICAL_IRQ_PRIO);
+    tier_timer_start(KERNEL_TIM, KERNEL_PERIOD, KERNEL_IRQn, KERNEL_IRQ_PRIO);
+
+    while (g_critical_samples.count < BENCH_ITERATIONS || g_kernel_samples.count < BENCH_ITERATIONS)
+    {
+        rtos_delay_ms(10);
+    }
+
+    NVIC_DisableIRQ(CRITICAL_IRQn);
+    NVIC_DisableIRQ(KERNEL_IRQn);
+    CRITICAL_TIM->CR1 = 0;
+    KERNEL_TIM->CR1   = 0;
+
+    /* Let LogFlush run */
+    rtos_task_suspend(g_ping_handle);
+    rtos_task_suspend(g_pong_handle);
+
+    tier_report(&g_critical_samples, &g_stat_critical);
+    tier_report(&g_kernel_samples, &g_stat_kernel);
+
+    bench_header("zero_latency_irq");
+    bench_report(&g_stat_critical);
+
+    bench_header("kernel_tier_irq");
+    bench_report(&g_stat_kernel);
+
+    ulog_info("[BENCH] Done. Scheduler type: %u", (unsigned) RTOS_SCHEDULER_TYPE);
+
+    rtos_task_suspend(NULL);
+}
+
+/* ========================= STARTUP TIMER ================================== */
+
+static void startup_cb(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_started = 1;
+    ulog_info("[BENCH] Startup hold complete — starting zero-latency benchmark");
+}
+
+/* ========================= MAIN =========================================== */
+
+int main(void)
+{
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_INFO);
+
+    rtos_init();
+    rtos_profiling_init();
+
+    ulog_init(ULOG_LEVEL_INFO);
+    ulog_info("[BENCH] Zero-Latency Interrupt Benchmark — " __DATE__ " " __TIME__);
+    ulog_info("[BENCH] Iterations: %u  Warmup: %u", BENCH_ITERATIONS, BENCH_WARMUP);
+
+    rtos_semaphore_init(&g_ping_sem, 0, 1);
+    rtos_semaphore_init(&g_pong_sem, 0, 1);
+    rtos_mutex_init(&g_load_mutex);
+    rtos_queue_create(&g_load_queue, 4, sizeof(uint32_t));
+
+    rtos_task_handle_t  handle;
+    rtos_timer_handle_t startup_timer;
+
+    /*
+     * Task priority layout:
+     *   ResultTask (4) — polls the sample counts, reports
+     *   LoadPing   (3) — kernel load, semaphore ping-pong
+     *   LoadPong   (3) — kernel load, mutex + queue round trip
+     *   LogFlush   (0) — drains ulog to UART once the load is suspended
+     */
+    rtos_task_create(ResultTask, "Result", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, RESULT_PRIORITY, &handle);
+    rtos_task_create(LoadPing, "Ping", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, LOAD_PRIORITY, &g_ping_handle);
+    rtos_task_create(LoadPong, "Pong", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, LOAD_PRIORITY, &g_pong_handle);
+
+    test_create_log_flush_task(&handle);
+    test_create_startup_timer(startup_cb, NULL, &startup_timer);
+
+    rtos_start_scheduler();
+
+    while (1) {}
+    return 0;
+}
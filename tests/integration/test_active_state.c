@@ -0,0 +1,674 @@
+/*******************************************************************************
+ * File: tests/integration/test_active_state.c
+ * Description: Active Objects - Event Pool, Zero-Copy Post & HSM Invariant Test
+ * Author: Student
+ * Date: 2025
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "active.h"
+#include "config.h"
+#include "device.h" // IWYU pragma: keep
+#include "hardware_env.h"
+#include "mempool.h"
+#include "rtos_port.h"
+#include "task.h"
+#include "test_common.h"
+#include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
+#include "timer.h"
+#include "uart_tx.h"
+
+#include <string.h>
+
+/**
+ * @file test_active_state.c
+ * @brief Active Object Framework Test (cooperative scheduler)
+ *
+ * SCENARIO
+ * --------
+ * Three tasks plus log flush:
+ *
+ *   Group      (priority 3) — rtos_ao_group_task() running three active
+ *                             objects on its one stack
+ *   Controller (priority 2) — posts events, checks the invariants
+ *   Monitor    (priority 1) — emits final verdict
+ *
+ * Objects: Machine (hierarchical state machine, below), Counter and Peer
+ * (flat, record each event they handle). Events come from two pools of
+ * SMALL_BLOCKS and LARGE_BLOCKS blocks.
+ *
+ *   top
+ *    └─ s          INIT -> s1; C: -> s1
+ *        ├─ s1     INIT -> s11; A: -> s1 (self)
+ *        │   └─ s11  B: -> s2; D: -> s; FWD: re-post to Counter
+ *        └─ s2     INIT -> s21
+ *            └─ s21
+ *
+ * Under the cooperative scheduler the Group task runs only once the
+ * Controller blocks, so each check sees all posts of a step queued and,
+ * after a delay, all of them handled.
+ *
+ * INVARIANTS
+ * ----------
+ * INV-AO1  The initial transition enters s, s1, s11 in order in
+ *          rtos_ao_start(); is_in() holds for the leaf and its parents
+ * INV-AO2  A self-transition exits and re-enters the state and drills
+ *          down its initial transition again
+ * INV-AO3  A transition exits up to the least common ancestor of source
+ *          and target and enters down to the target; one to a substate
+ *          or a superstate of the source does not exit that state
+ * INV-AO4  An event no state handles changes nothing
+ * INV-AO5  rtos_ao_event_new() takes the smallest pool that fits, and
+ *          fails for oversized events and an empty pool
+ * INV-AO6  A post queues the event pointer itself: the handler sees the
+ *          address that was posted, also when re-posted by a handler
+ * INV-AO7  refs counts the queues holding an event plus a sender
+ *          reference; the last release returns the block to its pool
+ * INV-AO8  A post to a full queue fails and frees a new event; static
+ *          events are never counted or freed
+ * INV-AO9  Objects of one group are served one event each in turn, in
+ *          the Group task, which is blocked while all queues are empty
+ * INV-AO10 An ISR allocates and posts an event with the _from_isr calls
+ */
+
+/* =================== Test Parameters =================== */
+
+#define TASK_GROUP_PRIORITY (3U)
+#define TASK_CTRL_PRIORITY  (2U)
+#define TASK_MON_PRIORITY   (1U)
+
+#define SETTLE_MS        (20U)
+#define MONITOR_POLL_MS  (20U)
+#define IDLE_SPIN_MS     (1000U)
+#define TEST_DURATION_MS (2000U)
+
+#define TEST_IRQn     TEST_SPARE_IRQn
+#define TEST_IRQ_PRIO (14U) /* Below the kernel BASEPRI threshold */
+
+#define QUEUE_LENGTH  (8U)
+#define SMALL_BLOCKS  (16U)
+#define LARGE_BLOCKS  (2U)
+#define LARGE_PAYLOAD (24U)
+#define FAIR_ROUNDS   (6U)
+#define TRACE_LENGTH  (64U)
+#define ORDER_LENGTH  (32U)
+
+/* Signals */
+enum
+{
+    SIG_A = RTOS_AO_SIG_USER,
+    SIG_B,
+    SIG_C,
+    SIG_D,
+    SIG_E,
+    SIG_FWD,
+    SIG_DATA,
+    SIG_ISR,
+    SIG_STATIC
+};
+
+/* TEST_ASSERT, ASSERT_STATE, g_fail_count are in test_common.h */
+
+/* =================== Events and Objects =================== */
+
+typedef struct
+{
+    rtos_ao_event_t super;
+    uint32_t        seq;
+} data_evt_t;
+
+typedef struct
+{
+    rtos_ao_event_t super;
+    uint8_t         payload[LARGE_PAYLOAD];
+} large_evt_t;
+
+typedef struct
+{
+    rtos_ao_t super;
+    char      id;
+} recorder_t;
+
+static rtos_ao_group_t g_group;
+static rtos_ao_t       g_machine;
+static recorder_t      g_counter;
+static recorder_t      g_peer;
+
+static const rtos_ao_event_t *g_machine_queue[QUEUE_LENGTH];
+static const rtos_ao_event_t *g_counter_queue[QUEUE_LENGTH];
+static const rtos_ao_event_t *g_peer_queue[QUEUE_LENGTH];
+
+static rtos_mempool_t g_small_pool;
+static rtos_mempool_t g_large_pool;
+static uint64_t       g_small_storage[RTOS_MEMPOOL_BUFFER_SIZE(sizeof(data_evt_t), SMALL_BLOCKS) / 8U];
+static uint64_t       g_large_storage[RTOS_MEMPOOL_BUFFER_SIZE(sizeof(large_evt_t), LARGE_BLOCKS) / 8U];
+
+static const rtos_ao_event_t g_static_evt = RTOS_AO_STATIC_EVENT(SIG_STATIC);
+
+/* =================== Shared State =================== */
+
+static volatile bool g_test_started  = false;
+static volatile bool g_test_complete = false;
+
+static rtos_task_handle_t  g_handle_group = NULL;
+static rtos_timer_handle_t g_test_timer;
+
+/* Machine's entry / exit trace, e.g. "+s+s1+s11" */
+static char g_trace[TRACE_LENGTH];
+
+/* Counter / Peer: handling order ("CPCP..."), last event seen */
+static char                   g_order[ORDER_LENGTH];
+static volatile uint32_t      g_order_len       = 0;
+static const rtos_ao_event_t *g_last_event      = NULL;
+static volatile uint32_t      g_last_refs       = 0;
+static volatile uint32_t      g_seq_errors      = 0;
+static volatile uint32_t      g_wrong_task      = 0;
+static volatile uint32_t      g_isr_handled     = 0;
+static volatile uint32_t      g_static_handled  = 0;
+static volatile uint32_t      g_counter_seq     = 0;
+static volatile uint32_t      g_forwarded       = 0;
+static volatile rtos_status_t g_isr_post_status = RTOS_ERROR_GENERAL;
+
+static rtos_status_t g_pool_order_status = RTOS_SUCCESS;
+
+/* =================== Helpers =================== */
+
+static void trace(const char *step)
+{
+    strncat(g_trace, step, TRACE_LENGTH - strlen(g_trace) - 1U);
+}
+
+static uint32_t pool_free(rtos_mempool_t *pool)
+{
+    rtos_mempool_stats_t stats;
+    rtos_mempool_get_stats(pool, &stats);
+    return stats.free_count;
+}
+
+static bool trace_is(const char *expected)
+{
+    bool same = (strcmp(g_trace, expected) == 0);
+    if (!same)
+    {
+        log_error("trace \"%s\", expected \"%s\"", g_trace, expected);
+    }
+    g_trace[0] = '\0';
+    return same;
+}
+
+/* =================== Interrupt Handler =================== */
+
+void TEST_SPARE_IRQHandler(void)
+{
+    bool             woken = false;
+    rtos_ao_event_t *e     = rtos_ao_event_new_from_isr(sizeof(data_evt_t), SIG_ISR);
+
+    g_isr_post_status = (e != NULL) ? rtos_ao_post_from_isr(&g_counter.super, e, &woken) : RTOS_ERROR_EMPTY;
+
+    if (woken)
+    {
+        rtos_port_yield();
+    }
+}
+
+/* =================== State Handlers =================== */
+
+static rtos_ao_ret_t machine_s(rtos_ao_t *me, const rtos_ao_event_t *e);
+static rtos_ao_ret_t machine_s1(rtos_ao_t *me, const rtos_ao_event_t *e);
+static rtos_ao_ret_t machine_s11(rtos_ao_t *me, const rtos_ao_event_t *e);
+static rtos_ao_ret_t machine_s2(rtos_ao_t *me, const rtos_ao_event_t *e);
+static rtos_ao_ret_t machine_s21(rtos_ao_t *me, const rtos_ao_event_t *e);
+
+static rtos_ao_ret_t machine_s(rtos_ao_t *me, const rtos_ao_event_t *e)
+{
+    switch (e->sig)
+    {
+    case RTOS_AO_SIG_ENTRY:
+        trace("+s");
+        return RTOS_AO_HANDLED();
+    case RTOS_AO_SIG_EXIT:
+        trace("-s");
+        return RTOS_AO_HANDLED();
+    case RTOS_AO_SIG_INIT:
+        return RTOS_AO_TRAN(me, machine_s1);
+    case SIG_C:
+        return RTOS_AO_TRAN(me, machine_s1);
+    default:
+        return RTOS_AO_SUPER(me, rtos_ao_top);
+    }
+}
+
+static rtos_ao_ret_t machine_s1(rtos_ao_t *me, const rtos_ao_event_t *e)
+{
+    switch (e->sig)
+    {
+    case RTOS_AO_SIG_ENTRY:
+        trace("+s1");
+        return RTOS_AO_HANDLED();
+    case RTOS_AO_SIG_EXIT:
+        trace("-s1");
+        return RTOS_AO_HANDLED();
+    case RTOS_AO_SIG_INIT:
+        return RTOS_AO_TRAN(me, machine_s11);
+    case SIG_A:
+        return RTOS_AO_TRAN(me, machine_s1);
+    default:
+        return RTOS_AO_SUPER(me, machine_s);
+    }
+}
+
+static rtos_ao_ret_t machine_s11(rtos_ao_t *me, const rtos_ao_event_t *e)
+{
+    switch (e->sig)
+    {
+    case RTOS_AO_SIG_ENTRY:
+        trace("+s11");
+        return RTOS_AO_HANDLED();
+    case RTOS_AO_SIG_EXIT:
+        trace("-s11");
+        return RTOS_AO_HANDLED();
+    case SIG_B:
+        return RTOS_AO_TRAN(me, machine_s2);
+    case SIG_D:
+        return RTOS_AO_TRAN(me, machine_s);
+    case SIG_FWD:
+        /* Zero-copy hand-off to another object of the same group */
+        rtos_ao_post(&g_counter.super, e, 0U);
+        g_forwarded++;
+        return RTOS_AO_HANDLED();
+    default:
+        return RTOS_AO_SUPER(me, machine_s1);
+    }
+}
+
+static rtos_ao_ret_t machine_s2(rtos_ao_t *me, const rtos_ao_event_t *e)
+{
+    switch (e->sig)
+    {
+    case RTOS_AO_SIG_ENTRY:
+        trace("+s2");
+        return RTOS_AO_HANDLED();
+    case RTOS_AO_SIG_EXIT:
+        trace("-s2");
+        return RTOS_AO_HANDLED();
+    case RTOS_AO_SIG_INIT:
+        return RTOS_AO_TRAN(me, machine_s21);
+    default:
+        return RTOS_AO_SUPER(me, machine_s);
+    }
+}
+
+static rtos_ao_ret_t machine_s21(rtos_ao_t *me, const rtos_ao_event_t *e)
+{
+    switch (e->sig)
+    {
+    case RTOS_AO_SIG_ENTRY:
+        trace("+s21");
+        return RTOS_AO_HANDLED();
+    case RTOS_AO_SIG_EXIT:
+        trace("-s21");
+        return RTOS_AO_HANDLED();
+    default:
+        return RTOS_AO_SUPER(me, machine_s2);
+    }
+}
+
+/* Counter and Peer share this flat handler */
+static rtos_ao_ret_t recorder_active(rtos_ao_t *me, const rtos_ao_event_t *e)
+{
+    recorder_t *rec = (recorder_t *) me;
+
+    if (e->sig < RTOS_AO_SIG_USER)
+    {
+        return RTOS_AO_SUPER(me, rtos_ao_top);
+    }
+
+    if (rtos_task_get_current() != g_handle_group)
+    {
+        g_wrong_task++;
+    }
+
+    g_last_event = e;
+    g_last_refs  = e->refs;
+
+    switch (e->sig)
+    {
+    case SIG_DATA:
+        if (g_order_len < ORDER_LENGTH - 1U)
+        {
+            g_order[g_order_len] = rec->id;
+            g_order_len++;
+        }
+        if (rec == &g_counter && ((const data_evt_t *) e)->seq != g_counter_seq++)
+        {
+            g_seq_errors++;
+        }
+        break;
+    case SIG_ISR:
+        g_isr_handled++;
+        break;
+    case SIG_STATIC:
+        g_static_handled++;
+        break;
+    default:
+        break;
+    }
+    return RTOS_AO_HANDLED();
+}
+
+/* =================== Task Implementations =================== */
+
+static void check_hsm(void)
+{
+    static const rtos_ao_event_t evt_a = RTOS_AO_STATIC_EVENT(SIG_A);
+    static const rtos_ao_event_t evt_b = RTOS_AO_STATIC_EVENT(SIG_B);
+    static const rtos_ao_event_t evt_c = RTOS_AO_STATIC_EVENT(SIG_C);
+    static const rtos_ao_event_t evt_d = RTOS_AO_STATIC_EVENT(SIG_D);
+    static const rtos_ao_event_t evt_e = RTOS_AO_STATIC_EVENT(SIG_E);
+
+    /* INV-AO1: rtos_ao_start() ran before the scheduler */
+    TEST_ASSERT(trace_is("+s+s1+s11"), "INV-AO1:InitialEntryOrder");
+    TEST_ASSERT(rtos_ao_is_in(&g_machine, machine_s11) && rtos_ao_is_in(&g_machine, machine_s1) &&
+                    rtos_ao_is_in(&g_machine, machine_s) && rtos_ao_is_in(&g_machine, rtos_ao_top),
+                "INV-AO1:InLeafAndParents");
+    TEST_ASSERT(!rtos_ao_is_in(&g_machine, machine_s2), "INV-AO1:NotInSibling");
+
+    /* INV-AO2 */
+    rtos_ao_post(&g_machine, &evt_a, 0U);
+    rtos_delay_ms(SETTLE_MS);
+    TEST_ASSERT(trace_is("-s11-s1+s1+s11"), "INV-AO2:SelfTransition");
+
+    /* INV-AO3: across siblings, exits to the common parent s */
+    rtos_ao_post(&g_machine, &evt_b, 0U);
+    rtos_delay_ms(SETTLE_MS);
+    TEST_ASSERT(trace_is("-s11-s1+s2+s21"), "INV-AO3:SiblingTransition");
+    TEST_ASSERT(rtos_ao_is_in(&g_machine, machine_s21), "INV-AO3:InTarget");
+
+    /* Handled by s from s21: exit to s, enter its substate s1 */
+    rtos_ao_post(&g_machine, &evt_c, 0U);
+    rtos_delay_ms(SETTLE_MS);
+    TEST_ASSERT(trace_is("-s21-s2+s1+s11"), "INV-AO3:ToSubstate");
+
+    /* To the superstate s: s is neither exited nor entered, its init drills down */
+    rtos_ao_post(&g_machine, &evt_d, 0U);
+    rtos_delay_ms(SETTLE_MS);
+    TEST_ASSERT(trace_is("-s11-s1+s1+s11"), "INV-AO3:ToSuperstate");
+
+    /* INV-AO4 */
+    rtos_ao_post(&g_machine, &evt_e, 0U);
+    rtos_delay_ms(SETTLE_MS);
+    TEST_ASSERT(trace_is(""), "INV-AO4:UnhandledNoTrace");
+    TEST_ASSERT(rtos_ao_is_in(&g_machine, machine_s11), "INV-AO4:StateKept");
+}
+
+static void check_pools(void)
+{
+    /* INV-AO5 */
+    TEST_ASSERT(g_pool_order_status == RTOS_ERROR_INVALID_PARAM, "INV-AO5:PoolOrderChecked");
+
+    rtos_ao_event_t *small = rtos_ao_event_new(sizeof(data_evt_t), SIG_DATA);
+    large_evt_t     *large = RTOS_AO_EVENT_NEW(large_evt_t, SIG_DATA);
+
+    TEST_ASSERT(small != NULL && small->pool == 1U && small->sig == SIG_DATA && small->refs == 0U,
+                "INV-AO5:SmallFromFirstPool");
+    TEST_ASSERT(large != NULL && large->super.pool == 2U, "INV-AO5:LargeFromSecondPool");
+    TEST_ASSERT(rtos_ao_event_new(sizeof(large_evt_t) + 64U, SIG_DATA) == NULL, "INV-AO5:OversizedFails");
+    TEST_ASSERT(rtos_ao_event_new(sizeof(rtos_ao_event_t) - 1U, SIG_DATA) == NULL, "INV-AO5:UndersizedFails");
+
+    rtos_ao_event_t *second = rtos_ao_event_new(sizeof(large_evt_t), SIG_DATA);
+    TEST_ASSERT(second != NULL && rtos_ao_event_new(sizeof(large_evt_t), SIG_DATA) == NULL,
+                "INV-AO5:EmptyPoolFails");
+
+    /* INV-AO7: never-posted events go straight back */
+    rtos_ao_event_gc(small);
+    rtos_ao_event_gc(&large->super);
+    rtos_ao_event_gc(second);
+    TEST_ASSERT(pool_free(&g_small_pool) == SMALL_BLOCKS && pool_free(&g_large_pool) == LARGE_BLOCKS,
+                "INV-AO7:UnpostedFreed");
+}
+
+static void check_zero_copy(void)
+{
+    /* INV-AO6 / INV-AO7: one event, sender reference, two receivers */
+    data_evt_t *e = RTOS_AO_EVENT_NEW(data_evt_t, SIG_DATA);
+    e->seq        = g_counter_seq;
+
+    rtos_ao_event_ref(&e->super);
+    rtos_ao_post(&g_counter.super, &e->super, 0U);
+    rtos_ao_post(&g_peer.super, &e->super, 0U);
+    TEST_ASSERT(e->super.refs == 3U, "INV-AO7:RefsPerQueuePlusSender");
+    rtos_ao_event_gc(&e->super);
+    TEST_ASSERT(e->super.refs == 2U && pool_free(&g_small_pool) == SMALL_BLOCKS - 1U, "INV-AO7:HeldByQueues");
+
+    rtos_delay_ms(SETTLE_MS);
+    TEST_ASSERT(g_last_event == &e->super, "INV-AO6:SamePointer");
+    TEST_ASSERT(g_last_refs == 1U, "INV-AO7:LastHandlerHoldsOne");
+    TEST_ASSERT(pool_free(&g_small_pool) == SMALL_BLOCKS, "INV-AO7:FreedAfterLast");
+
+    /* INV-AO6: Machine's s11 re-posts the event it handles to Counter */
+    rtos_ao_event_t *fwd = rtos_ao_event_new(sizeof(rtos_ao_event_t), SIG_FWD);
+    rtos_ao_post(&g_machine, fwd, 0U);
+    rtos_delay_ms(SETTLE_MS);
+    TEST_ASSERT(g_forwarded == 1U && g_last_event == fwd, "INV-AO6:ForwardedPointer");
+    TEST_ASSERT(pool_free(&g_small_pool) == SMALL_BLOCKS, "INV-AO7:ForwardedFreedOnce");
+}
+
+static void check_full_and_static(void)
+{
+    /* INV-AO8: fill Counter's queue with the static event */
+    uint32_t posted = 0;
+    while (rtos_ao_post(&g_counter.super, &g_static_evt, 0U) == RTOS_SUCCESS)
+    {
+        posted++;
+    }
+    TEST_ASSERT(posted == QUEUE_LENGTH && g_static_evt.refs == 0U, "INV-AO8:StaticNotCounted");
+
+    rtos_ao_event_t *e = rtos_ao_event_new(sizeof(data_evt_t), SIG_DATA);
+    TEST_ASSERT(e != NULL && rtos_ao_post(&g_counter.super, e, 0U) != RTOS_SUCCESS, "INV-AO8:PostToFullFails");
+    TEST_ASSERT(pool_free(&g_small_pool) == SMALL_BLOCKS, "INV-AO8:FailedPostFreed");
+
+    rtos_delay_ms(SETTLE_MS);
+    TEST_ASSERT(g_static_handled == QUEUE_LENGTH, "INV-AO8:StaticHandled");
+}
+
+static void check_fairness(void)
+{
+    /* INV-AO9: Counter's queue is filled first, yet Peer is served in turn */
+    g_order_len = 0;
+    for (uint32_t i = 0; i < FAIR_ROUNDS; i++)
+    {
+        data_evt_t *e = RTOS_AO_EVENT_NEW(data_evt_t, SIG_DATA);
+        e->seq        = g_counter_seq + i;
+        rtos_ao_post(&g_counter.super, &e->super, 0U);
+    }
+    for (uint32_t i = 0; i < FAIR_ROUNDS; i++)
+    {
+        data_evt_t *e = RTOS_AO_EVENT_NEW(data_evt_t, SIG_DATA);
+        e->seq        = 0;
+        rtos_ao_post(&g_peer.super, &e->super, 0U);
+    }
+    rtos_delay_ms(SETTLE_MS);
+
+    bool alternating = (g_order_len == 2U * FAIR_ROUNDS);
+    for (uint32_t i = 1U; alternating && i < g_order_len; i++)
+    {
+        alternating = (g_order[i] != g_order[i - 1U]);
+    }
+    g_order[g_order_len] = '\0';
+    if (!alternating)
+    {
+        log_error("order \"%s\"", g_order);
+    }
+
+    TEST_ASSERT(alternating, "INV-AO9:RoundRobin");
+    TEST_ASSERT(g_seq_errors == 0U, "INV-AO9:QueueOrder");
+    TEST_ASSERT(g_wrong_task == 0U, "INV-AO9:InGroupTask");
+    TEST_ASSERT(pool_free(&g_small_pool) == SMALL_BLOCKS, "INV-AO7:AllReturned");
+    ASSERT_STATE(g_handle_group, RTOS_TASK_STATE_BLOCKED, "INV-AO9:GroupBlockedWhenIdle");
+}
+
+static void check_isr(void)
+{
+    /* INV-AO10 */
+    NVIC_SetPendingIRQ(TEST_IRQn);
+    __DSB();
+    __ISB();
+    rtos_delay_ms(SETTLE_MS);
+
+    TEST_ASSERT(g_isr_post_status == RTOS_SUCCESS, "INV-AO10:IsrPosted");
+    TEST_ASSERT(g_isr_handled == 1U, "INV-AO10:IsrEventHandled");
+    TEST_ASSERT(pool_free(&g_small_pool) == SMALL_BLOCKS, "INV-AO10:IsrEventFreed");
+}
+
+/*
+ * Controller (priority 2).
+ *
+ * Every rtos_delay_ms() lets the Group task drain the queues; the checks
+ * after it see the result.
+ */
+static void ctrl_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Controller");
+
+    rtos_delay_ms(SETTLE_MS);
+    ASSERT_STATE(g_handle_group, RTOS_TASK_STATE_BLOCKED, "INV-AO9:GroupBlocked");
+
+    check_hsm();
+    check_pools();
+    check_zero_copy();
+    check_full_and_static();
+    check_fairness();
+    check_isr();
+
+    test_log_task("END", "Controller");
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+/*
+ * Monitor task (priority 1).
+ * Emits the final PASS/FAIL verdict.
+ */
+static void monitor_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Monitor");
+
+    while (!g_test_complete)
+    {
+        rtos_delay_ms(MONITOR_POLL_MS);
+    }
+
+    /* Final verdict */
+    TEST_EMIT_VERDICT();
+
+    test_log_task("END", "Monitor");
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+/* =================== Timer Callbacks =================== */
+
+static void startup_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    g_test_started = true;
+    test_log_framework("BEGIN", "ActiveState");
+    rtos_timer_handle_t *p = (rtos_timer_handle_t *) param;
+    rtos_timer_start(*p);
+}
+
+static void test_timeout_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_complete = true;
+    test_log_framework("TIMEOUT", "ActiveState");
+}
+
+/* =================== Main =================== */
+
+__attribute__((__noreturn__)) int main(void)
+{
+    rtos_status_t       status;
+    rtos_timer_handle_t startup_timer;
+
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_ALL);
+
+    log_info("Active Object Framework Test");
+    log_info("Priorities: Group=%u Ctrl=%u Mon=%u", TASK_GROUP_PRIORITY, TASK_CTRL_PRIORITY, TASK_MON_PRIORITY);
+    log_info("Invariants: AO1(initial) AO2(self) AO3(lca) AO4(unhandled) AO5(pools)");
+    log_info("            AO6(zero_copy) AO7(refs) AO8(full_static) AO9(fair) AO10(isr)");
+
+    status = rtos_init();
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("RTOS init failed: %d", status);
+        indicate_system_failure();
+    }
+
+    g_counter.id = 'C';
+    g_peer.id    = 'P';
+
+    if (rtos_mempool_init(&g_small_pool, g_small_storage, sizeof(data_evt_t), SMALL_BLOCKS) != RTOS_SUCCESS ||
+        rtos_mempool_init(&g_large_pool, g_large_storage, sizeof(large_evt_t), LARGE_BLOCKS) != RTOS_SUCCESS ||
+        rtos_ao_pool_add(&g_small_pool) != RTOS_SUCCESS || rtos_ao_pool_add(&g_large_pool) != RTOS_SUCCESS ||
+        rtos_ao_group_init(&g_group) != RTOS_SUCCESS ||
+        rtos_ao_start(&g_group, &g_machine, machine_s, g_machine_queue, QUEUE_LENGTH) != RTOS_SUCCESS ||
+        rtos_ao_start(&g_group, &g_counter.super, recorder_active, g_counter_queue, QUEUE_LENGTH) != RTOS_SUCCESS ||
+        rtos_ao_start(&g_group, &g_peer.super, recorder_active, g_peer_queue, QUEUE_LENGTH) != RTOS_SUCCESS)
+    {
+        log_error("Active object setup failed");
+        indicate_system_failure();
+    }
+
+    /* Pools must be added in increasing block size */
+    g_pool_order_status = rtos_ao_pool_add(&g_small_pool);
+
+    NVIC_SetPriority(TEST_IRQn, TEST_IRQ_PRIO);
+    NVIC_EnableIRQ(TEST_IRQn);
+
+    status = test_create_startup_timer(startup_timer_callback, &g_test_timer, &startup_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Startup timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_timer_create("TestTimer", TEST_DURATION_MS, RTOS_TIMER_ONE_SHOT, test_timeout_callback, NULL,
+                               &g_test_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Test timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t handle;
+    if (rtos_task_create(rtos_ao_group_task, "Group", RTOS_DEFAULT_TASK_STACK_SIZE, &g_group, TASK_GROUP_PRIORITY,
+                         &g_handle_group) != RTOS_SUCCESS ||
+        rtos_task_create(ctrl_task_func, "Controller", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_CTRL_PRIORITY,
+                         &handle) != RTOS_SUCCESS ||
+        rtos_task_create(monitor_task_func, "Monitor", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_MON_PRIORITY,
+                         &handle) != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t flush_handle;
+    test_create_log_flush_task(&flush_handle);
+
+    log_info("Starting scheduler...");
+    status = rtos_start_scheduler();
+
+    indicate_system_failure();
+}
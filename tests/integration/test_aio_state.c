@@ -0,0 +1,404 @@
+/*******************************************************************************
+ * File: tests/integration/test_aio_state.c
+ * Description: Asynchronous I/O Requests - Completion Delivery Invariant Test
+ * Author: Student
+ * Date: 2025
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "aio.h"
+#include "config.h"
+#include "device.h" // IWYU pragma: keep
+#include "hardware_env.h"
+#include "rtos_port.h"
+#include "task.h"
+#include "test_common.h"
+#include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
+#include "timer.h"
+#include "uart_tx.h"
+
+/**
+ * @file test_aio_state.c
+ * @brief Asynchronous I/O Request Test
+ *
+ * SCENARIO
+ * --------
+ * Three tasks plus log flush; the spare interrupt plays the DMA
+ * transfer-complete ISR of a driver with several transfers in flight:
+ *
+ *   Collector  (priority 3) — notify task of the "bulk" requests, counts
+ *                             one notification per completion
+ *   Controller (priority 2) — submits, computes while transfers run,
+ *                             checks invariants
+ *   Monitor    (priority 1) — emits final verdict
+ *
+ * INVARIANTS
+ * ----------
+ * INV-IO1  rtos_io_wait() returns the driver's status once the ISR
+ *          completes the request; transferred is recorded
+ * INV-IO2  Callbacks run in the deferred daemon, not the ISR or the
+ *          submitter, in completion order across requests in flight
+ * INV-IO3  The notify task gets one notification per completion
+ * INV-IO4  Polling sees a request in flight until delivery, while the
+ *          submitter keeps computing
+ * INV-IO5  A wait past its timeout returns RTOS_ERROR_TIMEOUT and the
+ *          request still completes later
+ * INV-IO6  A callback that resubmits its request chains transfers; the
+ *          waiter returns after the last one
+ * INV-IO7  Double submit, completing an idle request and waiting on a
+ *          never-submitted one are rejected
+ */
+
+/* =================== Test Parameters =================== */
+
+#define TASK_COLLECTOR_PRIORITY (3U)
+#define TASK_CTRL_PRIORITY      (2U)
+#define TASK_MON_PRIORITY       (1U)
+
+#define SETTLE_MS        (20U)
+#define MONITOR_POLL_MS  (20U)
+#define IDLE_SPIN_MS     (1000U)
+#define TEST_DURATION_MS (2000U)
+#define WAIT_TICKS       (50U)
+
+#define TEST_IRQn     TEST_SPARE_IRQn
+#define TEST_IRQ_PRIO (14U) /* Below the kernel BASEPRI threshold */
+
+#define BULK_COUNT  (3U)
+#define CHAIN_HOPS  (4U)
+#define MAX_TRACE   (16U)
+
+/* TEST_ASSERT, ASSERT_STATE, g_fail_count are in test_common.h */
+
+/* =================== Shared State =================== */
+
+static volatile bool g_test_started  = false;
+static volatile bool g_test_complete = false;
+
+static rtos_timer_handle_t g_test_timer;
+static rtos_task_handle_t  g_collector;
+static rtos_task_handle_t  g_controller;
+
+/* "DMA": requests the next interrupt completes, in this order */
+static rtos_io_request_t *volatile g_dma_batch[BULK_COUNT];
+static volatile uint32_t           g_dma_batch_len = 0;
+
+static rtos_io_request_t g_single;
+static rtos_io_request_t g_bulk[BULK_COUNT];
+static rtos_io_request_t g_slow;
+static rtos_io_request_t g_chain;
+static rtos_io_request_t g_idle;
+
+/* Callback trace */
+static volatile uint32_t g_trace[MAX_TRACE];
+static volatile uint32_t g_trace_len       = 0;
+static volatile uint32_t g_cb_wrong_ctx    = 0;
+static volatile uint32_t g_notifications   = 0;
+static volatile uint32_t g_chain_hops      = 0;
+static volatile rtos_status_t g_chain_resubmit = RTOS_SUCCESS;
+
+/* =================== Helpers =================== */
+
+/* Queue requests for the "DMA" and raise its transfer-complete interrupt */
+static void dma_complete(rtos_io_request_t *const *reqs, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        g_dma_batch[i] = reqs[i];
+    }
+    g_dma_batch_len = count;
+
+    NVIC_SetPendingIRQ(TEST_IRQn);
+    __DSB();
+    __ISB();
+}
+
+static void settle(void)
+{
+    rtos_delay_ms(2U);
+}
+
+/* =================== Interrupt Handler =================== */
+
+void TEST_SPARE_IRQHandler(void)
+{
+    bool woken = false;
+
+    for (uint32_t i = 0; i < g_dma_batch_len; i++)
+    {
+        rtos_io_request_t *req = g_dma_batch[i];
+        (void) rtos_io_complete_from_isr(req, RTOS_SUCCESS, (uint32_t) (uintptr_t) req->context, &woken);
+    }
+    g_dma_batch_len = 0;
+
+    if (woken)
+    {
+        rtos_port_yield();
+    }
+}
+
+/* =================== Callbacks =================== */
+
+static void trace_callback(rtos_io_request_t *req)
+{
+    rtos_task_handle_t self = rtos_task_get_current();
+
+    if (__get_IPSR() != 0U || self == g_controller || self == g_collector)
+    {
+        g_cb_wrong_ctx++;
+    }
+    if (g_trace_len < MAX_TRACE)
+    {
+        g_trace[g_trace_len++] = (uint32_t) (uintptr_t) req->context;
+    }
+}
+
+/* Resubmits until CHAIN_HOPS transfers are done, as a scatter list would */
+static void chain_callback(rtos_io_request_t *req)
+{
+    g_chain_hops++;
+    if (g_chain_hops < CHAIN_HOPS)
+    {
+        g_chain_resubmit = rtos_io_submit(req);
+        if (g_chain_resubmit == RTOS_SUCCESS)
+        {
+            rtos_io_request_t *self = req;
+            dma_complete(&self, 1U);
+        }
+    }
+}
+
+/* =================== Task Implementations =================== */
+
+static void collector_task_func(void *param)
+{
+    (void) param;
+
+    while (1)
+    {
+        if (rtos_task_notify_take(false, RTOS_MAX_DELAY) == RTOS_NOTIFY_OK)
+        {
+            g_notifications++;
+        }
+    }
+}
+
+static void check_single(void)
+{
+    /* INV-IO1 / INV-IO4 */
+    rtos_io_request_t *req = &g_single;
+
+    TEST_ASSERT(rtos_io_init(req, trace_callback, (void *) 100U, NULL) == RTOS_SUCCESS, "INV-IO1:Init");
+    TEST_ASSERT(rtos_io_submit(req) == RTOS_SUCCESS, "INV-IO1:Submitted");
+    TEST_ASSERT(!rtos_io_is_done(req), "INV-IO4:InFlight");
+
+    /* Overlap: computation while the transfer is in flight */
+    volatile uint32_t work = 0;
+    for (uint32_t i = 0; i < 1000U; i++)
+    {
+        work += i;
+    }
+    TEST_ASSERT(!rtos_io_is_done(req) && work == 499500U, "INV-IO4:ComputedMeanwhile");
+
+    dma_complete(&req, 1U);
+    TEST_ASSERT(rtos_io_wait(req, WAIT_TICKS) == RTOS_SUCCESS, "INV-IO1:WaitReturnsStatus");
+    TEST_ASSERT(rtos_io_is_done(req) && req->transferred == 100U, "INV-IO1:TransferredRecorded");
+    TEST_ASSERT(g_trace_len == 1U && g_cb_wrong_ctx == 0U, "INV-IO2:CallbackInDaemon");
+}
+
+static void check_bulk(void)
+{
+    /* INV-IO2 / INV-IO3: three in flight, completed in the order 2, 0, 1 */
+    for (uint32_t i = 0; i < BULK_COUNT; i++)
+    {
+        (void) rtos_io_init(&g_bulk[i], trace_callback, (void *) (uintptr_t) i, g_collector);
+        TEST_ASSERT(rtos_io_submit(&g_bulk[i]) == RTOS_SUCCESS, "INV-IO2:Submitted");
+    }
+
+    rtos_io_request_t *order[BULK_COUNT] = {&g_bulk[2], &g_bulk[0], &g_bulk[1]};
+    g_trace_len                          = 0;
+    dma_complete(order, BULK_COUNT);
+    settle();
+
+    TEST_ASSERT(g_trace_len == BULK_COUNT && g_trace[0] == 2U && g_trace[1] == 0U && g_trace[2] == 1U,
+                "INV-IO2:CompletionOrder");
+    TEST_ASSERT(g_cb_wrong_ctx == 0U, "INV-IO2:AllInDaemon");
+    TEST_ASSERT(g_notifications == BULK_COUNT, "INV-IO3:OnePerCompletion");
+    TEST_ASSERT(rtos_io_is_done(&g_bulk[0]) && rtos_io_is_done(&g_bulk[1]) && rtos_io_is_done(&g_bulk[2]),
+                "INV-IO4:AllDone");
+}
+
+static void check_timeout(void)
+{
+    /* INV-IO5 */
+    rtos_io_request_t *req = &g_slow;
+
+    (void) rtos_io_init(req, NULL, (void *) 7U, NULL);
+    (void) rtos_io_submit(req);
+    TEST_ASSERT(rtos_io_wait(req, 0U) == RTOS_ERROR_TIMEOUT, "INV-IO5:NoWaitTimesOut");
+    TEST_ASSERT(rtos_io_wait(req, 5U) == RTOS_ERROR_TIMEOUT, "INV-IO5:TimedOut");
+    TEST_ASSERT(req->waiter == NULL && !rtos_io_is_done(req), "INV-IO5:StillInFlight");
+
+    dma_complete(&req, 1U);
+    TEST_ASSERT(rtos_io_wait(req, WAIT_TICKS) == RTOS_SUCCESS && req->transferred == 7U, "INV-IO5:CompletesLater");
+}
+
+static void check_chain(void)
+{
+    /* INV-IO6 */
+    rtos_io_request_t *req = &g_chain;
+
+    (void) rtos_io_init(req, chain_callback, (void *) 1U, NULL);
+    (void) rtos_io_submit(req);
+    dma_complete(&req, 1U);
+
+    TEST_ASSERT(rtos_io_wait(req, WAIT_TICKS) == RTOS_SUCCESS, "INV-IO6:WaitReturns");
+    TEST_ASSERT(g_chain_hops == CHAIN_HOPS && g_chain_resubmit == RTOS_SUCCESS, "INV-IO6:AllHopsBeforeWake");
+}
+
+static void check_params(void)
+{
+    /* INV-IO7 */
+    (void) rtos_io_init(&g_idle, NULL, NULL, NULL);
+    TEST_ASSERT(rtos_io_wait(&g_idle, 0U) == RTOS_ERROR_INVALID_STATE, "INV-IO7:WaitNeverSubmitted");
+    TEST_ASSERT(rtos_io_complete(&g_idle, RTOS_SUCCESS, 0U) == RTOS_ERROR_INVALID_STATE, "INV-IO7:CompleteIdle");
+
+    TEST_ASSERT(rtos_io_submit(&g_idle) == RTOS_SUCCESS, "INV-IO7:Submit");
+    TEST_ASSERT(rtos_io_submit(&g_idle) == RTOS_ERROR_INVALID_STATE, "INV-IO7:DoubleSubmit");
+    TEST_ASSERT(rtos_io_init(&g_idle, NULL, NULL, NULL) == RTOS_ERROR_INVALID_STATE, "INV-IO7:InitInFlight");
+
+    /* Task-context completion, e.g. a driver that fails to start */
+    TEST_ASSERT(rtos_io_complete(&g_idle, RTOS_ERROR_GENERAL, 0U) == RTOS_SUCCESS, "INV-IO7:CompleteTask");
+    TEST_ASSERT(rtos_io_wait(&g_idle, WAIT_TICKS) == RTOS_ERROR_GENERAL, "INV-IO7:ErrorDelivered");
+    TEST_ASSERT(rtos_io_submit(NULL) == RTOS_ERROR_INVALID_PARAM, "INV-IO7:NullSubmit");
+}
+
+/*
+ * Controller (priority 2).
+ */
+static void ctrl_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Controller");
+
+    rtos_delay_ms(SETTLE_MS);
+
+    check_single();
+    check_bulk();
+    check_timeout();
+    check_chain();
+    check_params();
+
+    test_log_task("END", "Controller");
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+/*
+ * Monitor task (priority 1).
+ * Emits the final PASS/FAIL verdict.
+ */
+static void monitor_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Monitor");
+
+    while (!g_test_complete)
+    {
+        rtos_delay_ms(MONITOR_POLL_MS);
+    }
+
+    /* Final verdict */
+    TEST_EMIT_VERDICT();
+
+    test_log_task("END", "Monitor");
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+/* =================== Timer Callbacks =================== */
+
+static void startup_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    g_test_started = true;
+    test_log_framework("BEGIN", "AioState");
+    rtos_timer_handle_t *p = (rtos_timer_handle_t *) param;
+    rtos_timer_start(*p);
+}
+
+static void test_timeout_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_complete = true;
+    test_log_framework("TIMEOUT", "AioState");
+}
+
+/* =================== Main =================== */
+
+__attribute__((__noreturn__)) int main(void)
+{
+    rtos_status_t       status;
+    rtos_timer_handle_t startup_timer;
+
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_ALL);
+
+    log_info("Asynchronous I/O Request Test");
+    log_info("Priorities: Collector=%u Ctrl=%u Mon=%u", TASK_COLLECTOR_PRIORITY, TASK_CTRL_PRIORITY,
+             TASK_MON_PRIORITY);
+    log_info("Invariants: IO1(wait) IO2(daemon_order) IO3(notify) IO4(poll) IO5(timeout) IO6(chain) IO7(params)");
+
+    status = rtos_init();
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("RTOS init failed: %d", status);
+        indicate_system_failure();
+    }
+
+    NVIC_SetPriority(TEST_IRQn, TEST_IRQ_PRIO);
+    NVIC_EnableIRQ(TEST_IRQn);
+
+    status = test_create_startup_timer(startup_timer_callback, &g_test_timer, &startup_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Startup timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_timer_create("TestTimer", TEST_DURATION_MS, RTOS_TIMER_ONE_SHOT, test_timeout_callback, NULL,
+                               &g_test_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Test timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t handle;
+    if (rtos_task_create(collector_task_func, "Collector", RTOS_DEFAULT_TASK_STACK_SIZE, NULL,
+                         TASK_COLLECTOR_PRIORITY, &g_collector) != RTOS_SUCCESS ||
+        rtos_task_create(ctrl_task_func, "Controller", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_CTRL_PRIORITY,
+                         &g_controller) != RTOS_SUCCESS ||
+        rtos_task_create(monitor_task_func, "Monitor", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_MON_PRIORITY,
+                         &handle) != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t flush_handle;
+    test_create_log_flush_task(&flush_handle);
+
+    log_info("Starting scheduler...");
+    status = rtos_start_scheduler();
+
+    indicate_system_failure();
+}
@@ -0,0 +1,477 @@
+/*******************************************************************************
+ * File: tests/integration/test_coroutine_state.c
+ * Description: Stackless Coroutines - Shared-Stack Run Loop Invariant Test
+ * Author: Student
+ * Date: 2025
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "config.h"
+#include "coroutine.h"
+#include "device.h" // IWYU pragma: keep
+#include "hardware_env.h"
+#include "queue.h"
+#include "rtos_port.h"
+#include "semaphore.h"
+#include "task.h"
+#include "test_common.h"
+#include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
+#include "timer.h"
+#include "uart_tx.h"
+
+/**
+ * @file test_coroutine_state.c
+ * @brief Coroutine Run Loop Test (cooperative scheduler)
+ *
+ * SCENARIO
+ * --------
+ * Three tasks plus log flush:
+ *
+ *   Coro       (priority 3) — rtos_coroutine_sched_task() running seven
+ *                             coroutines on its one stack
+ *   Controller (priority 2) — feeds events, checks the invariants
+ *   Monitor    (priority 1) — emits final verdict
+ *
+ * Coroutines: Consumer (queue A), SemTaker (semaphore), Ticker (delay,
+ * ends after TICKER_ROUNDS), Ping / Pong (hand-off through RTOS_CO_AWAIT),
+ * Flag (woken by a software timer, then by TEST_IRQn), Late (takes queue B
+ * only once released).
+ *
+ * INVARIANTS
+ * ----------
+ * INV-CR1  With every coroutine waiting, the Coro task is BLOCKED
+ * INV-CR2  Items sent to a watched queue resume Consumer, in send order
+ * INV-CR3  Each semaphore signal resumes SemTaker exactly once
+ * INV-CR4  RTOS_CO_DELAY waits at least its ticks; Ticker ends after
+ *          TICKER_ROUNDS, is then done, and can be started again
+ * INV-CR5  Ping / Pong complete PINGPONG_ROUNDS hand-offs with no wakeup
+ * INV-CR6  A timer callback's rtos_coroutine_sched_wake() and an ISR's
+ *          _wake_from_isr() resume a coroutine awaiting a plain flag
+ * INV-CR7  An item nobody waits for in a watched queue does not starve
+ *          the Controller; it is taken once Late is released
+ * INV-CR8  Starting a linked coroutine -> RTOS_ERROR_INVALID_STATE;
+ *          a control block is at most COROUTINE_MAX_BYTES
+ */
+
+/* =================== Test Parameters =================== */
+
+#define TASK_CORO_PRIORITY (3U)
+#define TASK_CTRL_PRIORITY (2U)
+#define TASK_MON_PRIORITY  (1U)
+
+#define SETTLE_MS        (50U)
+#define MONITOR_POLL_MS  (20U)
+#define IDLE_SPIN_MS     (1000U)
+#define TEST_DURATION_MS (3000U)
+#define FLAG_TIMER_MS    (20U)
+
+#define TEST_IRQn     TEST_SPARE_IRQn
+#define TEST_IRQ_PRIO (14U) /* Below the kernel BASEPRI threshold */
+
+#define QUEUE_LENGTH        (4U)
+#define ITEM_BASE           (0x40U)
+#define TICKER_PERIOD_TICKS (10U)
+#define TICKER_ROUNDS       (3U)
+#define PINGPONG_ROUNDS     (100U)
+#define COROUTINE_MAX_BYTES (32U)
+
+/* TEST_ASSERT, ASSERT_STATE, g_fail_count are in test_common.h */
+
+/* =================== Shared State =================== */
+
+static volatile bool g_test_started  = false;
+static volatile bool g_test_complete = false;
+
+static rtos_task_handle_t g_handle_coro = NULL;
+
+static rtos_coroutine_sched_t g_sched;
+static rtos_queue_handle_t    g_queue_a;
+static rtos_queue_handle_t    g_queue_b;
+static rtos_semaphore_t       g_sem;
+
+static rtos_coroutine_t g_co_consumer;
+static rtos_coroutine_t g_co_sem;
+static rtos_coroutine_t g_co_ticker;
+static rtos_coroutine_t g_co_ping;
+static rtos_coroutine_t g_co_pong;
+static rtos_coroutine_t g_co_flag;
+static rtos_coroutine_t g_co_late;
+
+/* Coroutine state lives here: locals do not survive a wait */
+static volatile uint32_t g_consumed      = 0;
+static volatile uint32_t g_order_errors  = 0;
+static uint32_t          g_consumer_item = 0;
+
+static volatile uint32_t g_sem_taken = 0;
+
+static volatile uint32_t g_ticker_rounds = 0;
+static volatile uint32_t g_ticker_short  = 0; /**< Delays that ended early */
+static rtos_tick_t       g_ticker_start  = 0;
+
+static volatile bool     g_ping_turn     = true;
+static volatile uint32_t g_pingpong      = 0;
+static volatile uint32_t g_pingpong_goal = 0;
+
+static volatile bool     g_flag      = false;
+static volatile uint32_t g_flag_seen = 0;
+
+static volatile bool     g_late_release = false;
+static volatile uint32_t g_late_taken   = 0;
+static uint32_t          g_late_item    = 0;
+
+static rtos_timer_handle_t g_test_timer;
+static rtos_timer_handle_t g_flag_timer;
+
+/* =================== Interrupt Handler =================== */
+
+void TEST_SPARE_IRQHandler(void)
+{
+    bool woken = false;
+
+    g_flag = true;
+    rtos_coroutine_sched_wake_from_isr(&g_sched, &woken);
+
+    if (woken)
+    {
+        rtos_port_yield();
+    }
+}
+
+/* =================== Coroutines =================== */
+
+static rtos_coroutine_result_t consumer_co(rtos_coroutine_t *co)
+{
+    RTOS_CO_BEGIN(co);
+    for (;;)
+    {
+        RTOS_CO_QUEUE_RECEIVE(co, g_queue_a, &g_consumer_item);
+        if (g_consumer_item != ITEM_BASE + g_consumed)
+        {
+            g_order_errors++;
+        }
+        g_consumed++;
+    }
+    RTOS_CO_END(co);
+}
+
+static rtos_coroutine_result_t sem_co(rtos_coroutine_t *co)
+{
+    RTOS_CO_BEGIN(co);
+    for (;;)
+    {
+        RTOS_CO_SEMAPHORE_TAKE(co, &g_sem);
+        g_sem_taken++;
+    }
+    RTOS_CO_END(co);
+}
+
+static rtos_coroutine_result_t ticker_co(rtos_coroutine_t *co)
+{
+    RTOS_CO_BEGIN(co);
+    while (g_ticker_rounds < TICKER_ROUNDS)
+    {
+        g_ticker_start = rtos_get_tick_count();
+        RTOS_CO_DELAY(co, TICKER_PERIOD_TICKS);
+        if (rtos_get_tick_count() - g_ticker_start < TICKER_PERIOD_TICKS)
+        {
+            g_ticker_short++;
+        }
+        g_ticker_rounds++;
+    }
+    RTOS_CO_END(co);
+}
+
+static rtos_coroutine_result_t ping_co(rtos_coroutine_t *co)
+{
+    RTOS_CO_BEGIN(co);
+    for (;;)
+    {
+        RTOS_CO_AWAIT(co, g_ping_turn && g_pingpong < g_pingpong_goal);
+        g_ping_turn = false;
+    }
+    RTOS_CO_END(co);
+}
+
+static rtos_coroutine_result_t pong_co(rtos_coroutine_t *co)
+{
+    RTOS_CO_BEGIN(co);
+    for (;;)
+    {
+        RTOS_CO_AWAIT(co, !g_ping_turn);
+        g_pingpong++;
+        g_ping_turn = true;
+    }
+    RTOS_CO_END(co);
+}
+
+static rtos_coroutine_result_t flag_co(rtos_coroutine_t *co)
+{
+    RTOS_CO_BEGIN(co);
+    for (;;)
+    {
+        RTOS_CO_AWAIT(co, g_flag);
+        g_flag = false;
+        g_flag_seen++;
+    }
+    RTOS_CO_END(co);
+}
+
+static rtos_coroutine_result_t late_co(rtos_coroutine_t *co)
+{
+    RTOS_CO_BEGIN(co);
+    RTOS_CO_AWAIT(co, g_late_release);
+    for (;;)
+    {
+        RTOS_CO_QUEUE_RECEIVE(co, g_queue_b, &g_late_item);
+        g_late_taken++;
+    }
+    RTOS_CO_END(co);
+}
+
+/* =================== Task Implementations =================== */
+
+/*
+ * Controller (priority 2).
+ *
+ * Every rtos_delay_ms() lets the Coro task run its coroutines to a wait;
+ * the checks after it see the result.
+ */
+static void ctrl_task_func(void *param)
+{
+    (void) param;
+    uint32_t item;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Controller");
+
+    rtos_delay_ms(SETTLE_MS);
+
+    /* INV-CR1 */
+    ASSERT_STATE(g_handle_coro, RTOS_TASK_STATE_BLOCKED, "INV-CR1:CoroBlocked");
+
+    /* INV-CR4: Ticker ran from the first pass */
+    TEST_ASSERT(g_ticker_rounds == TICKER_ROUNDS, "INV-CR4:TickerRounds");
+    TEST_ASSERT(g_ticker_short == 0, "INV-CR4:DelayNotShort");
+    TEST_ASSERT(rtos_coroutine_is_done(&g_co_ticker), "INV-CR4:TickerDone");
+
+    /* INV-CR2 */
+    for (uint32_t i = 0; i < QUEUE_LENGTH; i++)
+    {
+        item = ITEM_BASE + i;
+        rtos_queue_send(g_queue_a, &item, 0);
+    }
+    rtos_delay_ms(SETTLE_MS);
+    TEST_ASSERT(g_consumed == QUEUE_LENGTH, "INV-CR2:AllConsumed");
+    TEST_ASSERT(g_order_errors == 0, "INV-CR2:InOrder");
+    ASSERT_STATE(g_handle_coro, RTOS_TASK_STATE_BLOCKED, "INV-CR2:CoroBlockedAgain");
+
+    /* INV-CR3 */
+    rtos_semaphore_signal(&g_sem);
+    rtos_semaphore_signal(&g_sem);
+    rtos_delay_ms(SETTLE_MS);
+    TEST_ASSERT(g_sem_taken == 2, "INV-CR3:TakenPerSignal");
+    TEST_ASSERT(rtos_semaphore_get_count(&g_sem) == 0, "INV-CR3:CountDrained");
+
+    /* INV-CR5: the goal is raised without a wakeup; Flag's wake below runs them */
+    g_pingpong_goal = PINGPONG_ROUNDS;
+
+    /* INV-CR6: software timer */
+    rtos_timer_start(g_flag_timer);
+    rtos_delay_ms(FLAG_TIMER_MS + SETTLE_MS);
+    TEST_ASSERT(g_flag_seen == 1, "INV-CR6:TimerWake");
+    TEST_ASSERT(g_pingpong == PINGPONG_ROUNDS, "INV-CR5:HandOffsDone");
+
+    /* INV-CR6: interrupt */
+    NVIC_SetPendingIRQ(TEST_IRQn);
+    __DSB();
+    __ISB();
+    rtos_delay_ms(SETTLE_MS);
+    TEST_ASSERT(g_flag_seen == 2, "INV-CR6:IsrWake");
+
+    /* INV-CR7: Late is not receiving yet; the item stays in queue B */
+    item = ITEM_BASE;
+    rtos_queue_send(g_queue_b, &item, 0);
+    rtos_tick_t before = rtos_get_tick_count();
+    rtos_delay_ms(SETTLE_MS);
+    TEST_ASSERT(rtos_get_tick_count() - before < 2U * SETTLE_MS, "INV-CR7:ControllerNotStarved");
+    TEST_ASSERT(g_late_taken == 0 && rtos_queue_messages_waiting(g_queue_b) == 1, "INV-CR7:ItemWaits");
+
+    g_late_release = true;
+    rtos_coroutine_sched_wake(&g_sched);
+    rtos_delay_ms(SETTLE_MS);
+    TEST_ASSERT(g_late_taken == 1 && g_late_item == ITEM_BASE, "INV-CR7:TakenOnRelease");
+    ASSERT_STATE(g_handle_coro, RTOS_TASK_STATE_BLOCKED, "INV-CR7:CoroBlocked");
+
+    /* INV-CR4: restart after the end */
+    g_ticker_rounds = 0;
+    TEST_ASSERT(rtos_coroutine_start(&g_sched, &g_co_ticker, ticker_co, NULL) == RTOS_SUCCESS, "INV-CR4:Restart");
+    rtos_delay_ms(SETTLE_MS);
+    TEST_ASSERT(g_ticker_rounds == TICKER_ROUNDS && rtos_coroutine_is_done(&g_co_ticker), "INV-CR4:RestartDone");
+
+    /* INV-CR8 */
+    TEST_ASSERT(rtos_coroutine_start(&g_sched, &g_co_consumer, consumer_co, NULL) == RTOS_ERROR_INVALID_STATE,
+                "INV-CR8:StartLinked");
+    TEST_ASSERT(sizeof(rtos_coroutine_t) <= COROUTINE_MAX_BYTES, "INV-CR8:ControlBlockSize");
+
+    test_log_task("END", "Controller");
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+/*
+ * Monitor task (priority 1).
+ * Emits the final PASS/FAIL verdict.
+ */
+static void monitor_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Monitor");
+
+    while (!g_test_complete)
+    {
+        rtos_delay_ms(MONITOR_POLL_MS);
+    }
+
+    /* Final verdict */
+    TEST_EMIT_VERDICT();
+
+    test_log_task("END", "Monitor");
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+/* =================== Timer Callbacks =================== */
+
+static void startup_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    g_test_started = true;
+    test_log_framework("BEGIN", "CoroutineState");
+    rtos_timer_handle_t *p = (rtos_timer_handle_t *) param;
+    rtos_timer_start(*p);
+}
+
+static void test_timeout_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_complete = true;
+    test_log_framework("TIMEOUT", "CoroutineState");
+}
+
+static void flag_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_flag = true;
+    rtos_coroutine_sched_wake(&g_sched);
+}
+
+/* =================== Main =================== */
+
+__attribute__((__noreturn__)) int main(void)
+{
+    rtos_status_t       status;
+    rtos_timer_handle_t startup_timer;
+
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_ALL);
+
+    log_info("Coroutine Run Loop Test");
+    log_info("Priorities: Coro=%u Ctrl=%u Mon=%u", TASK_CORO_PRIORITY, TASK_CTRL_PRIORITY, TASK_MON_PRIORITY);
+    log_info("Invariants: CR1(blocked) CR2(queue) CR3(sem) CR4(delay_end) CR5(hand_off)");
+    log_info("            CR6(wake) CR7(unclaimed_member) CR8(linked_size)");
+
+    status = rtos_init();
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("RTOS init failed: %d", status);
+        indicate_system_failure();
+    }
+
+    if (rtos_queue_create(&g_queue_a, QUEUE_LENGTH, sizeof(uint32_t)) != RTOS_SUCCESS ||
+        rtos_queue_create(&g_queue_b, QUEUE_LENGTH, sizeof(uint32_t)) != RTOS_SUCCESS ||
+        rtos_semaphore_init(&g_sem, 0, 0) != RTOS_SEM_OK || rtos_coroutine_sched_init(&g_sched) != RTOS_SUCCESS ||
+        rtos_coroutine_sched_watch_queue(&g_sched, g_queue_a) != RTOS_SUCCESS ||
+        rtos_coroutine_sched_watch_queue(&g_sched, g_queue_b) != RTOS_SUCCESS ||
+        rtos_coroutine_sched_watch_semaphore(&g_sched, &g_sem) != RTOS_SUCCESS)
+    {
+        log_error("Coroutine scheduler setup failed");
+        indicate_system_failure();
+    }
+
+    if (rtos_coroutine_start(&g_sched, &g_co_consumer, consumer_co, NULL) != RTOS_SUCCESS ||
+        rtos_coroutine_start(&g_sched, &g_co_sem, sem_co, NULL) != RTOS_SUCCESS ||
+        rtos_coroutine_start(&g_sched, &g_co_ticker, ticker_co, NULL) != RTOS_SUCCESS ||
+        rtos_coroutine_start(&g_sched, &g_co_ping, ping_co, NULL) != RTOS_SUCCESS ||
+        rtos_coroutine_start(&g_sched, &g_co_pong, pong_co, NULL) != RTOS_SUCCESS ||
+        rtos_coroutine_start(&g_sched, &g_co_flag, flag_co, NULL) != RTOS_SUCCESS ||
+        rtos_coroutine_start(&g_sched, &g_co_late, late_co, NULL) != RTOS_SUCCESS)
+    {
+        log_error("Coroutine start failed");
+        indicate_system_failure();
+    }
+
+    status = test_create_startup_timer(startup_timer_callback, &g_test_timer, &startup_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Startup timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_timer_create("TestTimer", TEST_DURATION_MS, RTOS_TIMER_ONE_SHOT, test_timeout_callback, NULL,
+                               &g_test_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Test timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_timer_create("FlagTimer", FLAG_TIMER_MS, RTOS_TIMER_ONE_SHOT, flag_timer_callback, NULL,
+                               &g_flag_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Flag timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_task_create(rtos_coroutine_sched_task, "Coro", RTOS_DEFAULT_TASK_STACK_SIZE, &g_sched,
+                              TASK_CORO_PRIORITY, &g_handle_coro);
+    if (status != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t ctrl_handle;
+    status = rtos_task_create(ctrl_task_func, "Ctrl", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_CTRL_PRIORITY,
+                              &ctrl_handle);
+    if (status != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t monitor_handle;
+    status = rtos_task_create(monitor_task_func, "Mon", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_MON_PRIORITY,
+                              &monitor_handle);
+    if (status != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t flush_handle;
+    test_create_log_flush_task(&flush_handle);
+
+    NVIC_SetPriority(TEST_IRQn, TEST_IRQ_PRIO);
+    NVIC_EnableIRQ(TEST_IRQn);
+
+    log_info("Starting scheduler...");
+    status = rtos_start_scheduler();
+
+    indicate_system_failure();
+}
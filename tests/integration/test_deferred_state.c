@@ -0,0 +1,335 @@
+/*******************************************************************************
+ * File: tests/integration/test_deferred_state.c
+ * Description: Deferred Work Daemon - ISR Hand-off & Timer Context Test
+ * Author: Student
+ * Date: 2025
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "config.h"
+#include "deferred.h"
+#include "device.h" // IWYU pragma: keep
+#include "hardware_env.h"
+#include "rtos_assert.h"
+#include "rtos_port.h"
+#include "task.h"
+#include "test_common.h"
+#include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
+#include "timer.h"
+#include "uart_tx.h"
+
+/**
+ * @file test_deferred_state.c
+ * @brief Deferred Work Daemon Invariant Test (RTOS_USE_DEFERRED_WORK)
+ *
+ * SCENARIO
+ * --------
+ * A spare peripheral interrupt (TEST_IRQn) is pended in software by the
+ * Trigger task. Its handler posts a burst of numbered work items with
+ * rtos_deferred_post_from_isr() and yields once at exit. A group of
+ * one-shot timers is started so that they all expire on the same tick.
+ *
+ *   Daemon   (RTOS_DEFERRED_TASK_PRIORITY) — runs work items and timers
+ *   Trigger  (priority 2)                  — pends the IRQ, checks results
+ *
+ * INVARIANTS
+ * ----------
+ * INV-D1  No work item runs inside the handler.
+ * INV-D2  The woken flag is set and the whole burst runs at ISR exit,
+ *         before Trigger resumes, in posting order.
+ * INV-D3  Work items and timer callbacks run in thread mode, in the daemon
+ *         (priority RTOS_DEFERRED_TASK_PRIORITY).
+ * INV-D4  A post beyond RTOS_DEFERRED_QUEUE_LENGTH pending items returns
+ *         RTOS_ERROR_FULL and counts one overflow; the queue then recovers.
+ * INV-D5  TIMER_GROUP timers expiring on one tick all fire on that tick.
+ * INV-D6  rtos_deferred_post() from a lower-priority task runs the item
+ *         before the call returns.
+ * INV-D7  Timer commands apply in call order: a stop right after a start
+ *         cancels it, and change_period re-arms from the call tick.
+ */
+
+/* =================== Test Parameters =================== */
+
+#define TASK_TRIGGER_PRIORITY (2U)
+
+#define TEST_IRQn        TEST_SPARE_IRQn
+#define TEST_IRQ_PRIO    (14U) /* Below the kernel BASEPRI threshold */
+#define BURST_LEN        (8U)
+#define TIMER_GROUP      (4U)
+#define TIMER_PERIOD     (10U)
+#define SCENARIO_CYCLES  (20U)
+#define SETTLE_MS        (5U)
+#define TEST_DURATION_MS (6000U)
+
+RTOS_STATIC_ASSERT(BURST_LEN < RTOS_DEFERRED_QUEUE_LENGTH, "burst must fit the deferred queue");
+
+/* =================== Shared State =================== */
+
+static volatile bool g_test_started  = false;
+static volatile bool g_test_complete = false;
+
+static rtos_timer_handle_t g_test_timer;
+static rtos_timer_handle_t g_group_timers[TIMER_GROUP];
+
+typedef enum
+{
+    ISR_MODE_BURST,
+    ISR_MODE_FLOOD
+} isr_mode_t;
+
+static volatile isr_mode_t g_isr_mode;
+static volatile uint32_t   g_isr_seq = 0; /* Next sequence number the ISR posts */
+
+/* Handler results, checked by Trigger */
+static volatile rtos_status_t g_isr_last_status;
+static volatile bool          g_isr_woken;
+static volatile uint32_t      g_isr_ran_at_exit;
+
+static volatile uint32_t g_ran            = 0;
+static volatile uint32_t g_expected_seq   = 0;
+static volatile uint32_t g_order_errors   = 0;
+static volatile uint32_t g_context_errors = 0;
+
+static volatile uint32_t    g_timer_fired = 0;
+static volatile rtos_tick_t g_timer_ticks[TIMER_GROUP];
+
+/* =================== Helpers =================== */
+
+/* INV-D3: thread mode, daemon priority */
+static void check_daemon_context(void)
+{
+    if (__get_IPSR() != 0U || rtos_task_get_priority(rtos_task_get_current()) != RTOS_DEFERRED_TASK_PRIORITY)
+    {
+        g_context_errors++;
+    }
+}
+
+static void deferred_work(void *parameter)
+{
+    uint32_t seq = (uint32_t) (uintptr_t) parameter;
+
+    check_daemon_context();
+
+    if (seq != g_expected_seq)
+    {
+        g_order_errors++;
+    }
+    g_expected_seq = seq + 1U;
+    g_ran++;
+}
+
+static void group_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    uint32_t index = (uint32_t) (uintptr_t) param;
+
+    check_daemon_context();
+    g_timer_ticks[index] = rtos_get_tick_count();
+    g_timer_fired++;
+}
+
+/* =================== Interrupt Handler =================== */
+
+void TEST_SPARE_IRQHandler(void)
+{
+    bool     woken = false;
+    uint32_t count = (g_isr_mode == ISR_MODE_BURST) ? BURST_LEN : RTOS_DEFERRED_QUEUE_LENGTH + 1U;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        g_isr_last_status = rtos_deferred_post_from_isr(deferred_work, (void *) (uintptr_t) g_isr_seq, &woken);
+        if (g_isr_last_status == RTOS_SUCCESS)
+        {
+            g_isr_seq++;
+        }
+    }
+
+    g_isr_woken       = woken;
+    g_isr_ran_at_exit = g_ran;
+
+    if (woken)
+    {
+        rtos_port_yield();
+    }
+}
+
+/* =================== Task Implementations =================== */
+
+/* Pend the IRQ and return once the handler and the daemon have both run */
+static void trigger_irq(isr_mode_t mode)
+{
+    g_isr_mode = mode;
+    NVIC_SetPendingIRQ(TEST_IRQn);
+    __DSB();
+    __ISB();
+}
+
+static void trigger_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Trigger");
+
+    for (uint32_t cycle = 0; cycle < SCENARIO_CYCLES && !g_test_complete; cycle++)
+    {
+        rtos_delay_ms(SETTLE_MS);
+
+        /* --- ISR burst --- */
+        uint32_t ran_before = g_ran;
+        trigger_irq(ISR_MODE_BURST);
+
+        TEST_ASSERT(g_isr_ran_at_exit == ran_before, "INV-D1:NoWorkInISR");
+        TEST_ASSERT(g_isr_woken, "INV-D2:WokenSet");
+        TEST_ASSERT(g_ran == ran_before + BURST_LEN, "INV-D2:RanAtISRExit");
+
+        /* --- Timer group: all started on one tick, so all due on one tick --- */
+        uint32_t fired_before = g_timer_fired;
+        rtos_port_enter_critical();
+        for (uint32_t i = 0; i < TIMER_GROUP; i++)
+        {
+            rtos_timer_start(g_group_timers[i]);
+        }
+        rtos_port_exit_critical();
+
+        rtos_delay_ms(2U * TIMER_PERIOD);
+
+        TEST_ASSERT(g_timer_fired == fired_before + TIMER_GROUP, "INV-D5:AllFired");
+        for (uint32_t i = 1; i < TIMER_GROUP; i++)
+        {
+            TEST_ASSERT(g_timer_ticks[i] == g_timer_ticks[0], "INV-D5:SameTick");
+        }
+
+        /* --- Task post --- */
+        ran_before = g_ran;
+        TEST_ASSERT(rtos_deferred_post(deferred_work, (void *) (uintptr_t) g_isr_seq) == RTOS_SUCCESS,
+                    "INV-D6:PostOk");
+        g_isr_seq++;
+        TEST_ASSERT(g_ran == ran_before + 1U, "INV-D6:RanBeforeReturn");
+    }
+
+    /* --- Flood: one more post than the queue holds, all from one handler --- */
+    uint32_t overflows_before = rtos_deferred_get_overflows();
+    uint32_t ran_before       = g_ran;
+    trigger_irq(ISR_MODE_FLOOD);
+
+    TEST_ASSERT(g_isr_last_status == RTOS_ERROR_FULL, "INV-D4:FullFromISR");
+    TEST_ASSERT(rtos_deferred_get_overflows() == overflows_before + 1U, "INV-D4:OverflowCounted");
+    TEST_ASSERT(g_ran == ran_before + RTOS_DEFERRED_QUEUE_LENGTH, "INV-D4:QueuedItemsRan");
+
+    ran_before = g_ran;
+    trigger_irq(ISR_MODE_BURST);
+    TEST_ASSERT(g_ran == ran_before + BURST_LEN, "INV-D4:Recovered");
+
+    /* --- Timer command queue --- */
+    uint32_t fired_before = g_timer_fired;
+    rtos_timer_start(g_group_timers[0]);
+    rtos_timer_stop(g_group_timers[0]);
+    rtos_delay_ms(2U * TIMER_PERIOD);
+    TEST_ASSERT(g_timer_fired == fired_before, "INV-D7:StopCancelsStart");
+
+    rtos_timer_start(g_group_timers[0]);
+    rtos_tick_t changed_at = rtos_get_tick_count();
+    rtos_timer_change_period(g_group_timers[0], 3U * TIMER_PERIOD);
+    rtos_delay_ms(4U * TIMER_PERIOD);
+    TEST_ASSERT(g_timer_fired == fired_before + 1U, "INV-D7:ChangedTimerFired");
+    TEST_ASSERT(g_timer_ticks[0] - changed_at - 3U * TIMER_PERIOD <= 1U, "INV-D7:ChangePeriodFromCall");
+
+    TEST_ASSERT(g_order_errors == 0, "INV-D2:PostingOrder");
+    TEST_ASSERT(g_context_errors == 0, "INV-D3:DaemonContext");
+
+    TEST_EMIT_VERDICT();
+
+    test_log_task("END", "Trigger");
+    while (1)
+    {
+        rtos_delay_ms(1000);
+    }
+}
+
+/* =================== Timer Callbacks =================== */
+
+static void startup_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    g_test_started = true;
+    test_log_framework("BEGIN", "Deferred");
+    rtos_timer_handle_t *p = (rtos_timer_handle_t *) param;
+    rtos_timer_start(*p);
+}
+
+static void test_timeout_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_complete = true;
+    test_log_framework("TIMEOUT", "Deferred");
+}
+
+/* =================== Main =================== */
+
+__attribute__((__noreturn__)) int main(void)
+{
+    rtos_status_t       status;
+    rtos_timer_handle_t startup_timer;
+
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_ALL);
+
+    log_info("Deferred Work Daemon Test");
+    log_info("Daemon prio=%u queue=%u  Burst: %u  Timers: %u", RTOS_DEFERRED_TASK_PRIORITY,
+             RTOS_DEFERRED_QUEUE_LENGTH, BURST_LEN, TIMER_GROUP);
+    log_info("Invariants: D1(not in ISR) D2(at exit) D3(context) D4(full) D5(timers) D6(post) D7(commands)");
+
+    status = rtos_init();
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("RTOS init failed: %d", status);
+        indicate_system_failure();
+    }
+
+    for (uint32_t i = 0; i < TIMER_GROUP; i++)
+    {
+        status = rtos_timer_create("Group", TIMER_PERIOD, RTOS_TIMER_ONE_SHOT, group_timer_callback,
+                                   (void *) (uintptr_t) i, &g_group_timers[i]);
+        if (status != RTOS_SUCCESS)
+        {
+            log_error("Group timer failed: %d", status);
+            indicate_system_failure();
+        }
+    }
+
+    NVIC_SetPriority(TEST_IRQn, TEST_IRQ_PRIO);
+    NVIC_EnableIRQ(TEST_IRQn);
+
+    status = test_create_startup_timer(startup_timer_callback, &g_test_timer, &startup_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Startup timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_timer_create("TestTimer", TEST_DURATION_MS, RTOS_TIMER_ONE_SHOT, test_timeout_callback, NULL,
+                               &g_test_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Test timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t trigger_handle;
+    status = rtos_task_create(trigger_task_func, "Trigger", RTOS_DEFAULT_TASK_STACK_SIZE, NULL,
+                              TASK_TRIGGER_PRIORITY, &trigger_handle);
+    if (status != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t flush_handle;
+    test_create_log_flush_task(&flush_handle);
+
+    log_info("Starting scheduler...");
+    status = rtos_start_scheduler();
+
+    indicate_system_failure();
+}
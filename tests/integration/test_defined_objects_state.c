@@ -0,0 +1,301 @@
+/*******************************************************************************
+ * File: tests/integration/test_defined_objects_state.c
+ * Description: Statically Defined Tasks and Queues - Boot Creation Invariant Test
+ * Author: Student
+ * Date: 2025
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "config.h"
+#include "device.h" // IWYU pragma: keep
+#include "hardware_env.h"
+#include "memory.h"
+#include "queue.h"
+#include "rtos_define.h"
+#include "rtos_port.h"
+#include "task.h"
+#include "task_priv.h"
+#include "test_common.h"
+#include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
+#include "timer.h"
+#include "uart_tx.h"
+
+#include <string.h>
+
+/**
+ * @file test_defined_objects_state.c
+ * @brief Defined Objects Test
+ *
+ * SCENARIO
+ * --------
+ * The consumer, the controller and their queue are defined at file scope
+ * with RTOS_TASK_DEFINE(_EX) / RTOS_QUEUE_DEFINE; main() only creates the
+ * monitor and log flush at runtime:
+ *
+ *   Consumer   (priority 3, defined) — receives from the defined queue
+ *   Controller (priority 2, defined) — sends, checks invariants
+ *   Monitor    (priority 1, runtime) — emits final verdict
+ *
+ * INVARIANTS
+ * ----------
+ * INV-DO1  rtos_init() creates every defined object without the heap;
+ *          handles are valid before the scheduler starts
+ * INV-DO2  Queues exist before tasks: the consumer's first receive, at
+ *          its first instruction, succeeds
+ * INV-DO3  A defined task has its handle's name, priority, parameter and
+ *          stack size, and runs on the stack reserved by its definition
+ *          (the host port runs tasks on its own stacks)
+ * INV-DO4  Stacks and queue items sit in .rtos_objects (target link map)
+ * INV-DO5  A defined queue carries items end to end, and defined tasks
+ *          coexist with runtime-created ones
+ */
+
+/* =================== Test Parameters =================== */
+
+#define TASK_CONSUMER_PRIORITY (3U)
+#define TASK_CTRL_PRIORITY     (2U)
+#define TASK_MON_PRIORITY      (1U)
+
+#define SETTLE_MS        (20U)
+#define MONITOR_POLL_MS  (20U)
+#define IDLE_SPIN_MS     (1000U)
+#define TEST_DURATION_MS (1000U)
+
+#define QUEUE_LENGTH   (4U)
+#define ITEMS          (3U)
+#define CONSUMER_STACK (1024U)
+#define CONSUMER_ARG   (0x5AU)
+
+/* TEST_ASSERT, ASSERT_STATE, g_fail_count are in test_common.h */
+
+/* =================== Shared State =================== */
+
+static volatile bool g_test_started  = false;
+static volatile bool g_test_complete = false;
+
+static rtos_timer_handle_t g_test_timer;
+
+static volatile uint32_t      g_init_allocs     = 0xFFFFFFFFU;
+static volatile bool          g_handles_at_init = false;
+static volatile rtos_status_t g_first_receive   = RTOS_ERROR_GENERAL;
+static volatile uintptr_t     g_consumer_param  = 0;
+static volatile uintptr_t     g_consumer_sp     = 0;
+static volatile uint32_t      g_received[ITEMS];
+static volatile uint32_t      g_received_count = 0;
+
+static uint32_t g_consumer_arg = CONSUMER_ARG;
+
+static void consumer_task_func(void *param);
+static void ctrl_task_func(void *param);
+
+/* =================== Defined Objects =================== */
+
+RTOS_QUEUE_DEFINE(g_item_queue, sizeof(uint32_t), QUEUE_LENGTH);
+RTOS_TASK_DEFINE_EX(g_consumer, consumer_task_func, CONSUMER_STACK, TASK_CONSUMER_PRIORITY, &g_consumer_arg,
+                    RTOS_TASK_FLAG_NONE);
+RTOS_TASK_DEFINE(g_controller, ctrl_task_func, RTOS_DEFAULT_TASK_STACK_SIZE, TASK_CTRL_PRIORITY);
+
+#if !defined(RTOS_TARGET_NATIVE)
+extern uint8_t _srtos_objects[];
+extern uint8_t _ertos_objects[];
+#endif
+
+/* =================== Task Implementations =================== */
+
+/*
+ * Consumer (priority 3, defined).
+ * Runs first of all application tasks: the queue must already exist.
+ */
+static void consumer_task_func(void *param)
+{
+    uint32_t item  = 0;
+    uint32_t local = 0;
+
+    g_consumer_param = (uintptr_t) param;
+    g_consumer_sp    = (uintptr_t) &local;
+
+    g_first_receive = rtos_queue_receive(g_item_queue, &item, RTOS_MAX_DELAY);
+    for (;;)
+    {
+        if (g_received_count < ITEMS)
+        {
+            g_received[g_received_count++] = item;
+        }
+        (void) rtos_queue_receive(g_item_queue, &item, RTOS_MAX_DELAY);
+    }
+}
+
+static void check_creation(void)
+{
+    /* INV-DO1 */
+    TEST_ASSERT(g_handles_at_init, "INV-DO1:HandlesAfterInit");
+    TEST_ASSERT(g_init_allocs == 0U, "INV-DO1:NoHeap");
+
+    /* INV-DO3 */
+    rtos_tcb_t *tcb = g_consumer;
+    TEST_ASSERT(strcmp(rtos_task_get_name(tcb->task_id), "g_consumer") == 0, "INV-DO3:Name");
+    TEST_ASSERT(rtos_task_get_priority(g_consumer) == TASK_CONSUMER_PRIORITY, "INV-DO3:Priority");
+    TEST_ASSERT(g_consumer_param == (uintptr_t) &g_consumer_arg, "INV-DO3:Parameter");
+
+    rtos_task_memory_stats_t stats;
+    (void) rtos_task_get_memory_stats(&stats);
+    TEST_ASSERT(stats.per_task_stack_size[tcb->task_id] == CONSUMER_STACK, "INV-DO3:StackSize");
+
+    TEST_ASSERT(tcb->stack_base == g_consumer_stack, "INV-DO3:DefinedStack");
+
+#if !defined(RTOS_TARGET_NATIVE)
+    /* The host port runs tasks on its own ucontext stacks */
+    uintptr_t lo = (uintptr_t) g_consumer_stack;
+    uintptr_t hi = lo + sizeof(g_consumer_stack);
+    TEST_ASSERT(g_consumer_sp > lo && g_consumer_sp < hi, "INV-DO3:RunsOnDefinedStack");
+
+    /* INV-DO4 */
+    TEST_ASSERT((uint8_t *) g_consumer_stack >= _srtos_objects &&
+                    (uint8_t *) g_consumer_stack + sizeof(g_consumer_stack) <= _ertos_objects,
+                "INV-DO4:StackInSection");
+    TEST_ASSERT((uint8_t *) g_item_queue_storage >= _srtos_objects &&
+                    (uint8_t *) g_item_queue_storage + sizeof(g_item_queue_storage) <= _ertos_objects,
+                "INV-DO4:ItemsInSection");
+#endif
+}
+
+static void check_queue(void)
+{
+    /* INV-DO2 / INV-DO5 */
+    for (uint32_t i = 0; i < ITEMS; i++)
+    {
+        uint32_t item = 100U + i;
+        TEST_ASSERT(rtos_queue_send(g_item_queue, &item, 0U) == RTOS_SUCCESS, "INV-DO5:Sent");
+    }
+
+    rtos_delay_ms(2U);
+
+    TEST_ASSERT(g_first_receive == RTOS_SUCCESS, "INV-DO2:QueueBeforeTask");
+    TEST_ASSERT(g_received_count == ITEMS && g_received[0] == 100U && g_received[1] == 101U && g_received[2] == 102U,
+                "INV-DO5:ItemsInOrder");
+}
+
+/*
+ * Controller (priority 2, defined).
+ */
+static void ctrl_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Controller");
+
+    rtos_delay_ms(SETTLE_MS);
+
+    check_creation();
+    check_queue();
+
+    test_log_task("END", "Controller");
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+/*
+ * Monitor task (priority 1, created at runtime).
+ * Emits the final PASS/FAIL verdict.
+ */
+static void monitor_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Monitor");
+
+    while (!g_test_complete)
+    {
+        rtos_delay_ms(MONITOR_POLL_MS);
+    }
+
+    /* Final verdict */
+    TEST_EMIT_VERDICT();
+
+    test_log_task("END", "Monitor");
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+/* =================== Timer Callbacks =================== */
+
+static void startup_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    g_test_started = true;
+    test_log_framework("BEGIN", "DefinedObjectsState");
+    rtos_timer_handle_t *p = (rtos_timer_handle_t *) param;
+    rtos_timer_start(*p);
+}
+
+static void test_timeout_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_complete = true;
+    test_log_framework("TIMEOUT", "DefinedObjectsState");
+}
+
+/* =================== Main =================== */
+
+__attribute__((__noreturn__)) int main(void)
+{
+    rtos_status_t       status;
+    rtos_timer_handle_t startup_timer;
+    rtos_memory_stats_t stats;
+
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_ALL);
+
+    log_info("Defined Objects Test");
+    log_info("Priorities: Consumer=%u Ctrl=%u Mon=%u", TASK_CONSUMER_PRIORITY, TASK_CTRL_PRIORITY,
+             TASK_MON_PRIORITY);
+    log_info("Invariants: DO1(created) DO2(queue_first) DO3(attributes) DO4(section) DO5(end_to_end)");
+
+    status = rtos_init();
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("RTOS init failed: %d", status);
+        indicate_system_failure();
+    }
+
+    rtos_memory_get_stats(&stats);
+    g_init_allocs     = stats.alloc_count;
+    g_handles_at_init = g_item_queue != NULL && g_consumer != NULL && g_controller != NULL;
+
+    status = test_create_startup_timer(startup_timer_callback, &g_test_timer, &startup_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Startup timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_timer_create("TestTimer", TEST_DURATION_MS, RTOS_TIMER_ONE_SHOT, test_timeout_callback, NULL,
+                               &g_test_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Test timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t handle;
+    if (rtos_task_create(monitor_task_func, "Monitor", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_MON_PRIORITY,
+                         &handle) != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t flush_handle;
+    test_create_log_flush_task(&flush_handle);
+
+    log_info("Starting scheduler...");
+    status = rtos_start_scheduler();
+
+    indicate_system_failure();
+}
@@ -7,9 +7,10 @@
 
 #include "VRTOS.h"
 #include "config.h"
+#include "device.h" // IWYU pragma: keep
 #include "event_group.h"
 #include "hardware_env.h"
-#include "stm32f4xx_hal.h" // IWYU pragma: keep
+#include "rtos_port.h"
 #include "task.h"
 #include "test_common.h"
 #include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
@@ -39,6 +40,21 @@
  * INV-EG6  Timed-out wait returns RTOS_EG_ERR_TIMEOUT; task is not
  *          BLOCKED afterward.
  * INV-EG7  get_bits returns current bits without blocking.
+ * INV-EG8  set_bits_from_isr() (TEST_IRQn pended by the Setter) on a bit nobody
+ *          waits for sets it without requesting a yield.
+ * INV-EG9  set_bits_from_isr() on WaiterAll's bits wakes it (via the
+ *          deferred daemon) before the Setter resumes.
+ * INV-EG10 rtos_event_group_sync(): participants that arrive early are
+ *          BLOCKED with their own bit set.
+ * INV-EG11 The last participant does not block; every early one is released
+ *          and has run (higher priority) by the time its sync() returns, and
+ *          each sees all barrier bits in bits_out.
+ * INV-EG12 The barrier bits are clear once the barrier completes.
+ * INV-EG13 A sync() that times out returns RTOS_EG_ERR_TIMEOUT and leaves
+ *          the caller's bit set.
+ * INV-EG14 A sync() that sets nothing and completes on a bit an ISR set,
+ *          whose deferred wake has not run yet, still releases the task
+ *          waiting for that bit before consuming it.
  */
 
 /* =================== Test Parameters =================== */
@@ -53,9 +69,21 @@
 #define TIMEOUT_TEST_MS  (30U)
 #define TEST_DURATION_MS (5000U)
 
+#define TEST_IRQn     TEST_SPARE_IRQn
+#define TEST_IRQ_PRIO (14U) /* Below the kernel BASEPRI threshold */
+
 #define EG_BIT_0 (0x01U)
 #define EG_BIT_1 (0x02U)
 #define EG_BIT_2 (0x04U)
+#define EG_BIT_3 (0x08U) /**< INV-EG8: no task waits for it */
+
+/* INV-EG10..13: one barrier bit per participant */
+#define EG_SYNC_ANY    (0x10U)
+#define EG_SYNC_ALL    (0x20U)
+#define EG_SYNC_SET    (0x40U)
+#define EG_SYNC_BITS   (EG_SYNC_ANY | EG_SYNC_ALL | EG_SYNC_SET)
+#define EG_SYNC_SIGNAL (SCENARIO_CYCLES + 2U) /**< g_cycle_signal value that starts the barrier */
+#define EG_PEND_SIGNAL (EG_SYNC_SIGNAL + 1U)  /**< INV-EG14: WaiterAny waits for BIT_2 */
 
 /* =================== Shared State =================== */
 
@@ -74,8 +102,28 @@ static volatile uint32_t g_all_done      = 0;
 static volatile uint32_t g_any_woke_count = 0;
 static volatile uint32_t g_all_woke_count = 0;
 
+static volatile uint32_t g_sync_released = 0; /* Early participants back from sync() */
+
 static rtos_timer_handle_t g_test_timer;
 
+static volatile uint32_t g_isr_bits  = 0; /* Bits the handler sets */
+static volatile bool     g_isr_woken = false;
+
+/* =================== Interrupt Handler =================== */
+
+void TEST_SPARE_IRQHandler(void)
+{
+    bool woken = false;
+
+    rtos_event_group_set_bits_from_isr(&g_eg, g_isr_bits, &woken);
+    g_isr_woken = woken;
+
+    if (woken)
+    {
+        rtos_port_yield();
+    }
+}
+
 /* =================== Task Implementations =================== */
 
 /**
@@ -162,6 +210,73 @@ static void setter_task_func(void *param)
     uint32_t read_bits = rtos_event_group_get_bits(&g_eg);
     TEST_ASSERT((read_bits & EG_BIT_2) != 0, "INV-EG7:GetBitsReturnsSet");
 
+    /* INV-EG8: ISR sets a bit nobody waits for — no wake work at all */
+    g_isr_bits = EG_BIT_3;
+    NVIC_SetPendingIRQ(TEST_IRQn);
+    __DSB();
+    __ISB();
+    TEST_ASSERT(!g_isr_woken, "INV-EG8:NoWokenWithoutWaiter");
+    TEST_ASSERT((rtos_event_group_get_bits(&g_eg) & EG_BIT_3) != 0, "INV-EG8:IsrBitSet");
+
+    /* INV-EG9: one more WaiterAll wait, satisfied from the ISR */
+    rtos_event_group_clear_bits(&g_eg, 0xFFFFFFFF);
+    g_all_done     = 0;
+    g_cycle_signal = SCENARIO_CYCLES + 1U;
+    rtos_delay_ms(SETTLE_MS);
+    ASSERT_STATE(g_handle_all, RTOS_TASK_STATE_BLOCKED, "INV-EG9:AllBlocked");
+
+    g_isr_bits = EG_BIT_0 | EG_BIT_1;
+    NVIC_SetPendingIRQ(TEST_IRQn);
+    __DSB();
+    __ISB();
+    TEST_ASSERT(g_isr_woken, "INV-EG9:WokenSetOnWake");
+    TEST_ASSERT(g_all_done == 1, "INV-EG9:AllRanBeforeSetter");
+    TEST_ASSERT((rtos_event_group_get_bits(&g_eg) & (EG_BIT_0 | EG_BIT_1)) == 0, "INV-EG9:ClearOnExit");
+
+    /* INV-EG10: both waiters reach the barrier first and block there */
+    rtos_event_group_clear_bits(&g_eg, 0xFFFFFFFF);
+    g_cycle_signal = EG_SYNC_SIGNAL;
+    rtos_delay_ms(SETTLE_MS);
+    ASSERT_STATE(g_handle_any, RTOS_TASK_STATE_BLOCKED, "INV-EG10:AnyBlocked");
+    ASSERT_STATE(g_handle_all, RTOS_TASK_STATE_BLOCKED, "INV-EG10:AllBlocked");
+    TEST_ASSERT(rtos_event_group_get_bits(&g_eg) == (EG_SYNC_ANY | EG_SYNC_ALL), "INV-EG10:EarlyBitsSet");
+
+    /* INV-EG11/12: the Setter arrives last and releases both */
+    uint32_t sync_bits = 0;
+    s = rtos_event_group_sync(&g_eg, EG_SYNC_SET, EG_SYNC_BITS, &sync_bits, RTOS_EG_MAX_WAIT);
+    TEST_ASSERT(s == RTOS_EG_OK, "INV-EG11:LastArrivalOK");
+    TEST_ASSERT((sync_bits & EG_SYNC_BITS) == EG_SYNC_BITS, "INV-EG11:LastBitsOut");
+    TEST_ASSERT(g_sync_released == 2U, "INV-EG11:AllReleased");
+    TEST_ASSERT((rtos_event_group_get_bits(&g_eg) & EG_SYNC_BITS) == 0, "INV-EG12:BitsCleared");
+
+    /* INV-EG13: nobody else arrives this time */
+    s = rtos_event_group_sync(&g_eg, EG_SYNC_SET, EG_SYNC_BITS, NULL, TIMEOUT_TEST_MS);
+    TEST_ASSERT(s == RTOS_EG_ERR_TIMEOUT, "INV-EG13:TimeoutReturnCode");
+    TEST_ASSERT(rtos_event_group_get_bits(&g_eg) == EG_SYNC_SET, "INV-EG13:OwnBitStays");
+
+    /*
+     * INV-EG14: with the scheduler suspended the ISR's wake stays queued for
+     * the daemon, so the sync() below completes on BIT_2 while WaiterAny is
+     * still blocked on it
+     */
+    rtos_event_group_clear_bits(&g_eg, 0xFFFFFFFF);
+    g_any_done     = 0;
+    g_cycle_signal = EG_PEND_SIGNAL;
+    rtos_delay_ms(SETTLE_MS);
+    ASSERT_STATE(g_handle_any, RTOS_TASK_STATE_BLOCKED, "INV-EG14:AnyBlocked");
+
+    rtos_scheduler_suspend();
+    g_isr_bits = EG_BIT_2;
+    NVIC_SetPendingIRQ(TEST_IRQn);
+    __DSB();
+    __ISB();
+    s = rtos_event_group_sync(&g_eg, 0U, EG_BIT_2, NULL, RTOS_EG_NO_WAIT);
+    (void) rtos_scheduler_resume();
+
+    TEST_ASSERT(s == RTOS_EG_OK, "INV-EG14:SyncOK");
+    TEST_ASSERT(g_any_done == 1, "INV-EG14:IsrWakeNotLost");
+    TEST_ASSERT((rtos_event_group_get_bits(&g_eg) & EG_BIT_2) == 0, "INV-EG14:BitConsumed");
+
     test_log_task("END", "Setter");
     while (1)
     {
@@ -169,6 +284,28 @@ static void setter_task_func(void *param)
     }
 }
 
+/**
+ * INV-EG10/11: wait for the barrier phase, then arrive with own_bit
+ */
+static void sync_participant(uint32_t own_bit, const char *tag)
+{
+    while (g_cycle_signal < EG_SYNC_SIGNAL && !g_test_complete)
+    {
+        rtos_delay_ms(5);
+    }
+    if (g_test_complete)
+    {
+        return;
+    }
+
+    uint32_t         bits_out = 0;
+    rtos_eg_status_t s        = rtos_event_group_sync(&g_eg, own_bit, EG_SYNC_BITS, &bits_out, RTOS_EG_MAX_WAIT);
+
+    TEST_ASSERT(s == RTOS_EG_OK, tag);
+    TEST_ASSERT((bits_out & EG_SYNC_BITS) == EG_SYNC_BITS, "INV-EG11:EarlyBitsOut");
+    g_sync_released++;
+}
+
 /**
  * WaiterAny (priority 3).
  *
@@ -203,6 +340,19 @@ static void waiter_any_func(void *param)
         g_any_done = 1;
     }
 
+    sync_participant(EG_SYNC_ANY, "INV-EG11:AnyReleasedOK");
+
+    /* INV-EG14: released by the ISR's BIT_2, which a sync() then consumes */
+    while (g_cycle_signal < EG_PEND_SIGNAL && !g_test_complete)
+    {
+        rtos_delay_ms(5);
+    }
+    if (!g_test_complete)
+    {
+        rtos_event_group_wait_bits(&g_eg, EG_BIT_2, false, false, NULL, RTOS_EG_MAX_WAIT);
+        g_any_done = 1;
+    }
+
     test_log_task("END", "WaiterAny");
     while (1)
     {
@@ -244,6 +394,19 @@ static void waiter_all_func(void *param)
         g_all_done = 1;
     }
 
+    /* INV-EG9: one more wait, satisfied from the ISR */
+    while (g_cycle_signal <= SCENARIO_CYCLES && !g_test_complete)
+    {
+        rtos_delay_ms(5);
+    }
+    if (!g_test_complete)
+    {
+        rtos_event_group_wait_bits(&g_eg, EG_BIT_0 | EG_BIT_1, true, true, NULL, RTOS_EG_MAX_WAIT);
+        g_all_done = 1;
+    }
+
+    sync_participant(EG_SYNC_ALL, "INV-EG11:AllReleasedOK");
+
     test_log_task("END", "WaiterAll");
     while (1)
     {
@@ -312,6 +475,7 @@ __attribute__((__noreturn__)) int main(void)
              TASK_MON_PRIORITY);
     log_info("Cycles: %u  Settle: %ums", SCENARIO_CYCLES, SETTLE_MS);
     log_info("Invariants: EG1(block) EG2(any) EG3(all) EG4(multi-wake) EG5(clear) EG6(timeout) EG7(get_bits)");
+    log_info("            EG8(isr_unwaited) EG9(isr_deferred_wake) EG10-14(sync barrier)");
 
     status = rtos_init();
     if (status != RTOS_SUCCESS)
@@ -376,6 +540,9 @@ __attribute__((__noreturn__)) int main(void)
     rtos_task_handle_t flush_handle;
     test_create_log_flush_task(&flush_handle);
 
+    NVIC_SetPriority(TEST_IRQn, TEST_IRQ_PRIO);
+    NVIC_EnableIRQ(TEST_IRQn);
+
     log_info("Starting scheduler...");
     status = rtos_start_scheduler();
 
@@ -0,0 +1,440 @@
+/*******************************************************************************
+ * File: tests/integration/test_hrtimer_state.c
+ * Description: High-Resolution Timers - Ordering, Period & Delay Invariant Test
+ * Author: Student
+ * Date: 2025
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "config.h"
+#include "device.h" // IWYU pragma: keep
+#include "hardware_env.h"
+#include "hrtimer.h"
+#include "rtos_port.h"
+#include "task.h"
+#include "test_common.h"
+#include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
+#include "timer.h"
+#include "uart_tx.h"
+
+/**
+ * @file test_hrtimer_state.c
+ * @brief High-Resolution Timer Ordering, Period & Delay Invariant Test
+ *
+ * SCENARIO
+ * --------
+ * Control (priority 2) runs each phase and checks it; Spinner (priority 1)
+ * counts in a loop while Control sleeps in rtos_delay_us().
+ *
+ * Phase 1 — Ordering: ORDER_COUNT one-shots armed out of order fire in
+ *           expiry order, each no earlier than its delay.
+ * Phase 2 — Periodic: one timer with PERIOD_US fires PERIOD_FIRES times and
+ *           stops itself from its callback.
+ * Phase 3 — Stop: a timer stopped before expiry never fires.
+ * Phase 4 — Re-arm: a one-shot re-arms itself from its ISR callback.
+ * Phase 5 — Daemon: a RTOS_HRTIMER_DISPATCH_DAEMON callback runs in a task.
+ * Phase 6 — rtos_delay_us(): sub-tick delays block Control, let Spinner run
+ *           and end no earlier than asked.
+ * Phase 7 — Errors: bad arguments and a full heap are rejected.
+ *
+ * INVARIANTS
+ * ----------
+ * INV-H1  Timers fire in expiry order, whatever order they were armed in.
+ * INV-H2  No timer fires before its expiry.
+ * INV-H3  A periodic timer fires every period from its first expiry without
+ *         accumulating drift, and stops once stopped from its callback.
+ * INV-H4  A stopped timer never fires and is not active.
+ * INV-H5  rtos_hrtimer_start_from_isr() re-arms a timer from its callback.
+ * INV-H6  Daemon callbacks run in task context, ISR callbacks in the IRQ.
+ * INV-H7  rtos_delay_us() sleeps at least the requested time, within a
+ *         tick of it, while a lower priority task runs.
+ * INV-H8  Invalid arguments return RTOS_ERROR_INVALID_PARAM, and arming
+ *         more than RTOS_HRTIMER_MAX_TIMERS returns RTOS_ERROR_FULL.
+ */
+
+/* =================== Test Parameters =================== */
+
+#define TASK_CONTROL_PRIORITY (2U)
+#define TASK_SPINNER_PRIORITY (1U)
+
+#define ORDER_COUNT      (5U)
+#define ORDER_STEP_US    (700U)
+#define PERIOD_US        (500U)
+#define PERIOD_FIRES     (20U)
+#define STOP_DELAY_US    (2000U)
+#define REARM_US         (300U)
+#define REARM_FIRES      (5U)
+#define SETTLE_MS        (20U)
+#define LATE_SLACK_US    (1000U) /* One tick: a sub-tick timer must not wait for SysTick */
+#define TEST_DURATION_MS (6000U)
+
+static const uint32_t g_delays_us[] = {150U, 400U, 850U};
+
+/* =================== Shared State =================== */
+
+static volatile bool g_test_started  = false;
+static volatile bool g_test_complete = false;
+static volatile bool g_spinning      = false;
+
+static rtos_timer_handle_t g_test_timer;
+
+static volatile uint32_t g_spin_count = 0;
+
+/* Phase 1 */
+static rtos_hrtimer_t    g_order_timers[ORDER_COUNT];
+static volatile uint32_t g_order_fired[ORDER_COUNT];
+static volatile uint32_t g_order_done    = 0;
+static volatile uint32_t g_order_at[ORDER_COUNT];
+
+/* Phase 2 */
+static rtos_hrtimer_t    g_periodic;
+static volatile uint32_t g_periodic_at[PERIOD_FIRES];
+static volatile uint32_t g_periodic_count = 0;
+
+/* Phase 3 */
+static rtos_hrtimer_t    g_stopped;
+static volatile uint32_t g_stopped_count = 0;
+
+/* Phase 4 */
+static rtos_hrtimer_t    g_rearm;
+static volatile uint32_t g_rearm_count  = 0;
+static volatile uint32_t g_rearm_errors = 0;
+
+/* Phase 5 */
+static rtos_hrtimer_t    g_daemon;
+static rtos_hrtimer_t    g_isr_ctx;
+static volatile uint32_t g_daemon_count = 0;
+static volatile uint32_t g_daemon_ipsr  = 0xFFFFFFFFU;
+static volatile uint32_t g_isr_ipsr     = 0;
+
+/* =================== Timer Callbacks =================== */
+
+static void order_callback(rtos_hrtimer_t *timer, void *parameter)
+{
+    (void) timer;
+    uint32_t slot = g_order_done++;
+    if (slot < ORDER_COUNT)
+    {
+        g_order_fired[slot] = (uint32_t) (uintptr_t) parameter;
+        g_order_at[slot]    = rtos_hrtimer_now();
+    }
+}
+
+static void periodic_callback(rtos_hrtimer_t *timer, void *parameter)
+{
+    (void) parameter;
+    if (g_periodic_count < PERIOD_FIRES)
+    {
+        g_periodic_at[g_periodic_count] = rtos_hrtimer_now();
+    }
+    if (++g_periodic_count >= PERIOD_FIRES)
+    {
+        (void) rtos_hrtimer_stop_from_isr(timer);
+    }
+}
+
+static void stopped_callback(rtos_hrtimer_t *timer, void *parameter)
+{
+    (void) timer;
+    (void) parameter;
+    g_stopped_count++;
+}
+
+static void rearm_callback(rtos_hrtimer_t *timer, void *parameter)
+{
+    (void) parameter;
+    if (++g_rearm_count < REARM_FIRES && rtos_hrtimer_start_from_isr(timer, REARM_US, 0) != RTOS_SUCCESS)
+    {
+        g_rearm_errors++;
+    }
+}
+
+static void daemon_callback(rtos_hrtimer_t *timer, void *parameter)
+{
+    (void) timer;
+    (void) parameter;
+    g_daemon_ipsr = __get_IPSR();
+    g_daemon_count++;
+}
+
+static void isr_ctx_callback(rtos_hrtimer_t *timer, void *parameter)
+{
+    (void) timer;
+    (void) parameter;
+    g_isr_ipsr = __get_IPSR();
+}
+
+/* =================== Phases =================== */
+
+static void check_ordering(void)
+{
+    /* Armed out of order: expiry ranks 2, 4, 0, 3, 1 */
+    static const uint32_t rank[ORDER_COUNT] = {2U, 4U, 0U, 3U, 1U};
+
+    uint32_t start = rtos_hrtimer_now();
+    for (uint32_t i = 0; i < ORDER_COUNT; i++)
+    {
+        rtos_hrtimer_init(&g_order_timers[i], order_callback, (void *) (uintptr_t) rank[i], RTOS_HRTIMER_DISPATCH_ISR);
+        rtos_hrtimer_start(&g_order_timers[i], (rank[i] + 1U) * ORDER_STEP_US, 0);
+    }
+    rtos_delay_ms(SETTLE_MS);
+
+    bool in_order = (g_order_done == ORDER_COUNT);
+    bool on_time  = in_order;
+    for (uint32_t i = 0; i < ORDER_COUNT && in_order; i++)
+    {
+        in_order       = in_order && (g_order_fired[i] == i);
+        uint32_t after = g_order_at[i] - start;
+        on_time = on_time && after >= (i + 1U) * ORDER_STEP_US && after < ((i + 1U) * ORDER_STEP_US) + LATE_SLACK_US;
+    }
+
+    TEST_ASSERT(g_order_done == ORDER_COUNT, "T-SETUP:OrderAllFired");
+    TEST_ASSERT(in_order, "INV-H1:FiredInExpiryOrder");
+    TEST_ASSERT(on_time, "INV-H2:OrderNotEarly");
+}
+
+static void check_periodic(void)
+{
+    rtos_hrtimer_init(&g_periodic, periodic_callback, NULL, RTOS_HRTIMER_DISPATCH_ISR);
+
+    uint32_t start = rtos_hrtimer_now();
+    rtos_hrtimer_start(&g_periodic, PERIOD_US, PERIOD_US);
+    rtos_delay_ms(((PERIOD_FIRES * PERIOD_US) / 1000U) + SETTLE_MS);
+
+    bool not_early = (g_periodic_count == PERIOD_FIRES);
+    for (uint32_t i = 0; i < PERIOD_FIRES && not_early; i++)
+    {
+        not_early = (g_periodic_at[i] - start) >= (i + 1U) * PERIOD_US;
+    }
+
+    /* Expiries step from the previous expiry, not from when the callback ran */
+    uint32_t last = g_periodic_at[PERIOD_FIRES - 1U] - start;
+
+    TEST_ASSERT(g_periodic_count == PERIOD_FIRES, "INV-H3:FiredEveryPeriodThenStopped");
+    TEST_ASSERT(!rtos_hrtimer_is_active(&g_periodic), "INV-H3:StoppedFromCallback");
+    TEST_ASSERT(not_early, "INV-H2:PeriodicNotEarly");
+    TEST_ASSERT(g_periodic.overruns > 0U || last < (PERIOD_FIRES * PERIOD_US) + LATE_SLACK_US, "INV-H3:NoDrift");
+}
+
+static void check_stop(void)
+{
+    rtos_hrtimer_init(&g_stopped, stopped_callback, NULL, RTOS_HRTIMER_DISPATCH_ISR);
+
+    TEST_ASSERT(rtos_hrtimer_stop(&g_stopped) == RTOS_SUCCESS, "INV-H4:StopIdleOk");
+    rtos_hrtimer_start(&g_stopped, STOP_DELAY_US, 0);
+    TEST_ASSERT(rtos_hrtimer_is_active(&g_stopped), "INV-H4:ActiveWhenArmed");
+    rtos_hrtimer_stop(&g_stopped);
+    TEST_ASSERT(!rtos_hrtimer_is_active(&g_stopped), "INV-H4:InactiveWhenStopped");
+
+    rtos_delay_ms((STOP_DELAY_US / 1000U) + SETTLE_MS);
+    TEST_ASSERT(g_stopped_count == 0U, "INV-H4:StoppedNeverFires");
+}
+
+static void check_rearm(void)
+{
+    rtos_hrtimer_init(&g_rearm, rearm_callback, NULL, RTOS_HRTIMER_DISPATCH_ISR);
+    rtos_hrtimer_start(&g_rearm, REARM_US, 0);
+    rtos_delay_ms(SETTLE_MS);
+
+    TEST_ASSERT(g_rearm_count == REARM_FIRES && g_rearm_errors == 0U, "INV-H5:RearmedFromCallback");
+    TEST_ASSERT(!rtos_hrtimer_is_active(&g_rearm), "INV-H5:OneShotIdleAfter");
+}
+
+static void check_dispatch(void)
+{
+    rtos_hrtimer_init(&g_isr_ctx, isr_ctx_callback, NULL, RTOS_HRTIMER_DISPATCH_ISR);
+    TEST_ASSERT(rtos_hrtimer_init(&g_daemon, daemon_callback, NULL, RTOS_HRTIMER_DISPATCH_DAEMON) == RTOS_SUCCESS,
+                "INV-H6:DaemonInitOk");
+
+    rtos_hrtimer_start(&g_isr_ctx, REARM_US, 0);
+    rtos_hrtimer_start(&g_daemon, REARM_US, 0);
+    rtos_delay_ms(SETTLE_MS);
+
+    TEST_ASSERT(g_daemon_count == 1U && g_daemon_ipsr == 0U, "INV-H6:DaemonInTask");
+    TEST_ASSERT(g_isr_ipsr != 0U, "INV-H6:IsrInInterrupt");
+}
+
+static void check_delay_us(void)
+{
+    bool long_enough = true;
+    bool within_tick = true;
+    bool spinner_ran = true;
+
+    g_spinning = true;
+    for (uint32_t i = 0; i < sizeof(g_delays_us) / sizeof(g_delays_us[0]); i++)
+    {
+        uint32_t spins = g_spin_count;
+        uint32_t start = rtos_hrtimer_now();
+
+        TEST_ASSERT(rtos_delay_us(g_delays_us[i]) == RTOS_SUCCESS, "INV-H7:DelayOk");
+        uint32_t elapsed = rtos_hrtimer_now() - start;
+
+        long_enough = long_enough && elapsed >= g_delays_us[i];
+        within_tick = within_tick && elapsed < g_delays_us[i] + LATE_SLACK_US;
+        spinner_ran = spinner_ran && g_spin_count != spins;
+    }
+    g_spinning = false;
+
+    TEST_ASSERT(rtos_delay_us(0) == RTOS_SUCCESS, "INV-H7:ZeroDelayReturns");
+    TEST_ASSERT(long_enough, "INV-H7:DelayNotShort");
+    TEST_ASSERT(within_tick, "INV-H7:DelayWithinTick");
+    TEST_ASSERT(spinner_ran, "INV-H7:LowerPriorityRanMeanwhile");
+}
+
+static void check_errors(void)
+{
+    static rtos_hrtimer_t fill[RTOS_HRTIMER_MAX_TIMERS + 1U];
+    rtos_hrtimer_t        t;
+
+    TEST_ASSERT(rtos_hrtimer_init(&t, NULL, NULL, RTOS_HRTIMER_DISPATCH_ISR) == RTOS_ERROR_INVALID_PARAM,
+                "INV-H8:NullCallback");
+    rtos_hrtimer_init(&t, stopped_callback, NULL, RTOS_HRTIMER_DISPATCH_ISR);
+    TEST_ASSERT(rtos_hrtimer_start(&t, 0, 0) == RTOS_ERROR_INVALID_PARAM, "INV-H8:ZeroDelay");
+    TEST_ASSERT(rtos_hrtimer_start(&t, RTOS_HRTIMER_MAX_DELAY_US + 1U, 0) == RTOS_ERROR_INVALID_PARAM,
+                "INV-H8:DelayTooLong");
+    TEST_ASSERT(rtos_hrtimer_start(&t, 1000U, RTOS_HRTIMER_MAX_DELAY_US + 1U) == RTOS_ERROR_INVALID_PARAM,
+                "INV-H8:PeriodTooLong");
+    TEST_ASSERT(rtos_delay_us(RTOS_HRTIMER_MAX_DELAY_US + 1U) == RTOS_ERROR_INVALID_PARAM, "INV-H8:DelayUsTooLong");
+
+    bool armed = true;
+    for (uint32_t i = 0; i < RTOS_HRTIMER_MAX_TIMERS; i++)
+    {
+        rtos_hrtimer_init(&fill[i], stopped_callback, NULL, RTOS_HRTIMER_DISPATCH_ISR);
+        armed = armed && rtos_hrtimer_start(&fill[i], 1000000U, 0) == RTOS_SUCCESS;
+    }
+    rtos_hrtimer_init(&fill[RTOS_HRTIMER_MAX_TIMERS], stopped_callback, NULL, RTOS_HRTIMER_DISPATCH_ISR);
+
+    TEST_ASSERT(armed, "T-SETUP:FilledHeap");
+    TEST_ASSERT(rtos_hrtimer_start(&fill[RTOS_HRTIMER_MAX_TIMERS], 1000U, 0) == RTOS_ERROR_FULL, "INV-H8:HeapFull");
+    TEST_ASSERT(rtos_delay_us(100U) == RTOS_ERROR_FULL, "INV-H8:DelayUsHeapFull");
+
+    /* Re-arming an armed timer reuses its slot */
+    TEST_ASSERT(rtos_hrtimer_start(&fill[0], 2000000U, 0) == RTOS_SUCCESS, "INV-H8:RearmArmedWhenFull");
+
+    for (uint32_t i = 0; i < RTOS_HRTIMER_MAX_TIMERS; i++)
+    {
+        rtos_hrtimer_stop(&fill[i]);
+    }
+    TEST_ASSERT(g_stopped_count == 0U, "INV-H4:FilledNeverFired");
+}
+
+/* =================== Task Implementations =================== */
+
+static void spinner_task_func(void *param)
+{
+    (void) param;
+
+    while (1)
+    {
+        if (g_spinning)
+        {
+            g_spin_count++;
+        }
+        else
+        {
+            rtos_delay_ticks(1);
+        }
+    }
+}
+
+static void control_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Control");
+
+    check_ordering();
+    check_periodic();
+    check_stop();
+    check_rearm();
+    check_dispatch();
+    check_delay_us();
+    check_errors();
+
+    log_info("Hrtimer periodic last=%lu us overruns=%lu spins=%lu",
+             (unsigned long) (g_periodic_at[PERIOD_FIRES - 1U] - g_periodic_at[0]), (unsigned long) g_periodic.overruns,
+             (unsigned long) g_spin_count);
+
+    TEST_EMIT_VERDICT();
+
+    test_log_task("END", "Control");
+    while (1)
+    {
+        rtos_delay_ms(1000);
+    }
+}
+
+/* =================== Timer Callbacks =================== */
+
+static void startup_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    g_test_started = true;
+    test_log_framework("BEGIN", "Hrtimer");
+    rtos_timer_handle_t *p = (rtos_timer_handle_t *) param;
+    rtos_timer_start(*p);
+}
+
+static void test_timeout_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_complete = true;
+    test_log_framework("TIMEOUT", "Hrtimer");
+}
+
+/* =================== Main =================== */
+
+__attribute__((__noreturn__)) int main(void)
+{
+    rtos_status_t       status;
+    rtos_timer_handle_t startup_timer;
+
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_ALL);
+
+    log_info("High-Resolution Timer Ordering, Period & Delay Test");
+    log_info("Control=%u Spinner=%u  max timers=%u", TASK_CONTROL_PRIORITY, TASK_SPINNER_PRIORITY,
+             (unsigned) RTOS_HRTIMER_MAX_TIMERS);
+    log_info("Invariants: H1(order) H2(not early) H3(period) H4(stop) H5(rearm) H6(dispatch) H7(delay_us) H8(errors)");
+
+    status = rtos_init();
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("RTOS init failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = test_create_startup_timer(startup_timer_callback, &g_test_timer, &startup_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Startup timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_timer_create("TestTimer", TEST_DURATION_MS, RTOS_TIMER_ONE_SHOT, test_timeout_callback, NULL,
+                               &g_test_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Test timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t handle;
+    if (rtos_task_create(spinner_task_func, "Spinner", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_SPINNER_PRIORITY,
+                         &handle) != RTOS_SUCCESS ||
+        rtos_task_create(control_task_func, "Control", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_CONTROL_PRIORITY,
+                         &handle) != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t flush_handle;
+    test_create_log_flush_task(&flush_handle);
+
+    log_info("Starting scheduler...");
+    status = rtos_start_scheduler();
+
+    indicate_system_failure();
+}
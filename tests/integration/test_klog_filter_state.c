@@ -0,0 +1,295 @@
+/*******************************************************************************
+ * File: tests/integration/test_klog_filter_state.c
+ * Description: KLog Runtime Subsystem / Level Filter - State Invariant Test
+ * Author: Student
+ * Date: 2025
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "config.h"
+#include "device.h" // IWYU pragma: keep
+#include "hardware_env.h"
+#include "klog.h"
+#include "queue.h"
+#include "rtos_port.h"
+#include "task.h"
+#include "task_priv.h"
+#include "test_common.h"
+#include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
+#include "timer.h"
+#include "uart_tx.h"
+
+#include <string.h>
+
+/**
+ * @file test_klog_filter_state.c
+ * @brief KLog Runtime Filter Test
+ *
+ * SCENARIO
+ * --------
+ * The controller changes the runtime filter and counts what reaches the
+ * ring (klog_pending()) for records it writes itself, inside a critical
+ * section so nothing else writes, and for records the kernel writes on
+ * its behalf. The flush task, at priority 0, does not drain in between:
+ *
+ *   Controller (priority 2) — sets masks, logs, checks invariants
+ *   Monitor    (priority 1) — emits final verdict
+ *
+ * INVARIANTS
+ * ----------
+ * INV-KF1  Event IDs map to the subsystem of their klog_events.h range, at
+ *          compile time
+ * INV-KF2  At boot every subsystem is at KLOG_RUNTIME_LEVEL and the filter
+ *          block carries its magic
+ * INV-KF3  A record passes exactly when its level is enabled for its
+ *          subsystem; raising one subsystem leaves the others alone
+ * INV-KF4  FAULT records pass with every level disabled
+ * INV-KF5  The kernel's own records follow the same masks
+ */
+
+/* =================== Test Parameters =================== */
+
+#define TASK_CTRL_PRIORITY (2U)
+#define TASK_MON_PRIORITY  (1U)
+
+#define SETTLE_MS        (20U)
+#define MONITOR_POLL_MS  (20U)
+#define IDLE_SPIN_MS     (1000U)
+#define TEST_DURATION_MS (1000U)
+
+#define BIT(subsys) (1UL << (subsys))
+
+/* INV-KF1: both ends of some ranges, and an ID outside all of them */
+RTOS_STATIC_ASSERT(KLOG_SUBSYS_OF(KEVT_TASK_CREATE) == KLOG_SUBSYS_TASK, "task range");
+RTOS_STATIC_ASSERT(KLOG_SUBSYS_OF(KEVT_TASK_SERVER_REPLENISH) == KLOG_SUBSYS_TASK, "task range end");
+RTOS_STATIC_ASSERT(KLOG_SUBSYS_OF(KEVT_SCHEDULER_INIT) == KLOG_SUBSYS_SCHEDULER, "scheduler range");
+RTOS_STATIC_ASSERT(KLOG_SUBSYS_OF(KEVT_MUTEX_INIT) == KLOG_SUBSYS_SYNC, "sync range");
+RTOS_STATIC_ASSERT(KLOG_SUBSYS_OF(KEVT_MUTEX_CEILING_VIOLATION) == KLOG_SUBSYS_SYNC, "sync range end");
+RTOS_STATIC_ASSERT(KLOG_SUBSYS_OF(KEVT_HARD_FAULT) == KLOG_SUBSYS_FAULT, "fault range");
+RTOS_STATIC_ASSERT(KLOG_SUBSYS_OF(KEVT_QUEUE_OVERWRITE) == KLOG_SUBSYS_QUEUE, "queue range end");
+RTOS_STATIC_ASSERT(KLOG_SUBSYS_OF(KEVT_SCHED_STATS) == KLOG_SUBSYS_SCHED_INTERNAL, "sched range");
+RTOS_STATIC_ASSERT(KLOG_SUBSYS_OF(KEVT_RWLOCK_WAKE) == KLOG_SUBSYS_RWLOCK, "rwlock range end");
+RTOS_STATIC_ASSERT(KLOG_SUBSYS_OF(PEVT_CTX_SWITCH) == KLOG_SUBSYS_OTHER, "outside the KEVT ranges");
+RTOS_STATIC_ASSERT(KLOG_MIN_LEVEL >= KLOG_LEVEL_INFO, "test_klog_filter_state logs at INFO");
+
+/* TEST_ASSERT, ASSERT_STATE, g_fail_count are in test_common.h */
+
+/* =================== Shared State =================== */
+
+static volatile bool g_test_started  = false;
+static volatile bool g_test_complete = false;
+
+static rtos_timer_handle_t g_test_timer;
+
+/* =================== Task Implementations =================== */
+
+static void idle_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+}
+
+static void check_boot_levels(void)
+{
+    /* INV-KF2 */
+    bool at_boot_level = true;
+    for (uint32_t s = 0; s < KLOG_SUBSYS_COUNT; s++)
+    {
+        at_boot_level = at_boot_level && klog_filter_get((klog_subsys_t) s) == KLOG_RUNTIME_LEVEL;
+    }
+    TEST_ASSERT(at_boot_level, "INV-KF2:BootLevel");
+    TEST_ASSERT(memcmp((const void *) klog_filter.magic, KLOG_FILTER_MAGIC, sizeof(KLOG_FILTER_MAGIC)) == 0,
+                "INV-KF2:Magic");
+}
+
+static void check_own_records(void)
+{
+    uint32_t base;
+    uint32_t warn;
+    uint32_t info_queue;
+    uint32_t info_sync;
+    uint32_t info_queue_again;
+    uint32_t error;
+    uint32_t fault;
+
+    /* INV-KF3 / INV-KF4: nothing else writes inside the critical section. The
+     * first record may carry a KEVT_TIME_EPOCH ahead of it, so one goes first */
+    rtos_port_enter_critical();
+    KLOGF(KEVT_ERROR_GENERIC, 0U, 0U);
+    klog_filter_set(KLOG_SUBSYS_ALL, KLOG_LEVEL_WARN);
+    base = klog_pending();
+
+    KLOGW(KEVT_QUEUE_RESET, 1U, 0U);
+    warn = klog_pending();
+    KLOGI(KEVT_QUEUE_RESET, 2U, 0U);
+    info_queue = klog_pending();
+
+    klog_filter_set(BIT(KLOG_SUBSYS_SYNC), KLOG_LEVEL_INFO);
+    KLOGI(KEVT_MUTEX_INIT, 3U, 0U);
+    info_sync = klog_pending();
+    KLOGI(KEVT_QUEUE_RESET, 4U, 0U);
+    info_queue_again = klog_pending();
+
+    klog_filter_set(KLOG_SUBSYS_ALL, KLOG_LEVEL_FAULT);
+    KLOGE(KEVT_ERROR_GENERIC, 5U, 0U);
+    error = klog_pending();
+    KLOGF(KEVT_ERROR_GENERIC, 6U, 0U);
+    fault = klog_pending();
+    rtos_port_exit_critical();
+
+    TEST_ASSERT(warn == base + 1U, "INV-KF3:EnabledLevelPasses");
+    TEST_ASSERT(info_queue == warn, "INV-KF3:DisabledLevelFiltered");
+    TEST_ASSERT(info_sync == info_queue + 1U, "INV-KF3:RaisedSubsystemPasses");
+    TEST_ASSERT(info_queue_again == info_sync, "INV-KF3:OthersUnchanged");
+    TEST_ASSERT(klog_filter_get(KLOG_SUBSYS_QUEUE) == KLOG_LEVEL_FAULT && error == info_queue_again,
+                "INV-KF4:AllDisabled");
+    TEST_ASSERT(fault == error + 1U, "INV-KF4:FaultPasses");
+}
+
+static void check_kernel_records(void)
+{
+    /* INV-KF5: KEVT_QUEUE_CREATE and KEVT_TIMER_CREATE are INFO */
+    rtos_queue_handle_t queue;
+    rtos_timer_handle_t timer;
+
+    klog_filter_set(KLOG_SUBSYS_ALL, KLOG_LEVEL_WARN);
+    klog_filter_set(BIT(KLOG_SUBSYS_QUEUE), KLOG_LEVEL_INFO);
+    TEST_ASSERT(klog_filter_get(KLOG_SUBSYS_QUEUE) == KLOG_LEVEL_INFO &&
+                    klog_filter_get(KLOG_SUBSYS_TIMER) == KLOG_LEVEL_WARN,
+                "INV-KF5:Levels");
+
+    uint32_t before = klog_pending();
+    TEST_ASSERT(rtos_queue_create(&queue, 2U, sizeof(uint32_t)) == RTOS_SUCCESS, "INV-KF5:QueueCreated");
+    uint32_t after_queue = klog_pending();
+    TEST_ASSERT(rtos_timer_create("KfTimer", 10U, RTOS_TIMER_ONE_SHOT, idle_timer_callback, NULL, &timer) ==
+                    RTOS_SUCCESS,
+                "INV-KF5:TimerCreated");
+    uint32_t after_timer = klog_pending();
+
+    TEST_ASSERT(after_queue > before, "INV-KF5:EnabledKernelRecord");
+    TEST_ASSERT(after_timer == after_queue, "INV-KF5:FilteredKernelRecord");
+
+    klog_filter_set(KLOG_SUBSYS_ALL, KLOG_RUNTIME_LEVEL);
+}
+
+/*
+ * Controller (priority 2).
+ */
+static void ctrl_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Controller");
+
+    rtos_delay_ms(SETTLE_MS);
+
+    check_boot_levels();
+    check_own_records();
+    check_kernel_records();
+
+    test_log_task("END", "Controller");
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+/*
+ * Monitor task (priority 1).
+ * Emits the final PASS/FAIL verdict.
+ */
+static void monitor_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Monitor");
+
+    while (!g_test_complete)
+    {
+        rtos_delay_ms(MONITOR_POLL_MS);
+    }
+
+    /* Final verdict */
+    TEST_EMIT_VERDICT();
+
+    test_log_task("END", "Monitor");
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+/* =================== Timer Callbacks =================== */
+
+static void startup_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    g_test_started = true;
+    test_log_framework("BEGIN", "KlogFilterState");
+    rtos_timer_handle_t *p = (rtos_timer_handle_t *) param;
+    rtos_timer_start(*p);
+}
+
+static void test_timeout_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_complete = true;
+    test_log_framework("TIMEOUT", "KlogFilterState");
+}
+
+/* =================== Main =================== */
+
+__attribute__((__noreturn__)) int main(void)
+{
+    rtos_status_t       status;
+    rtos_timer_handle_t startup_timer;
+    rtos_task_handle_t  handle;
+
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_ALL);
+
+    log_info("KLog Runtime Filter Test");
+    log_info("Priorities: Ctrl=%u Mon=%u", TASK_CTRL_PRIORITY, TASK_MON_PRIORITY);
+    log_info("Invariants: KF1(ranges) KF2(boot) KF3(masks) KF4(fault) KF5(kernel)");
+
+    status = rtos_init();
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("RTOS init failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = test_create_startup_timer(startup_timer_callback, &g_test_timer, &startup_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Startup timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_timer_create("TestTimer", TEST_DURATION_MS, RTOS_TIMER_ONE_SHOT, test_timeout_callback, NULL,
+                               &g_test_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Test timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    if (rtos_task_create(ctrl_task_func, "Controller", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_CTRL_PRIORITY,
+                         &handle) != RTOS_SUCCESS ||
+        rtos_task_create(monitor_task_func, "Monitor", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_MON_PRIORITY,
+                         &handle) != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t flush_handle;
+    test_create_log_flush_task(&flush_handle);
+
+    log_info("Starting scheduler...");
+    status = rtos_start_scheduler();
+
+    indicate_system_failure();
+}
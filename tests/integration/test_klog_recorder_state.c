@@ -0,0 +1,302 @@
+/*******************************************************************************
+ * File: tests/integration/test_klog_recorder_state.c
+ * Description: KLog Flight Recorder - Overwrite and Warm-Reset Recovery Invariant Test
+ * Author: Student
+ * Date: 2025
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "config.h"
+#include "device.h" // IWYU pragma: keep
+#include "hardware_env.h"
+#include "klog.h"
+#include "log_flush_task.h"
+#include "rtos_port.h"
+#include "task.h"
+#include "task_priv.h"
+#include "test_common.h"
+#include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
+#include "timer.h"
+#include "uart_tx.h"
+#include "ulog.h"
+
+/**
+ * @file test_klog_recorder_state.c
+ * @brief KLog Flight Recorder Test
+ *
+ * SCENARIO
+ * --------
+ * Built with KLOG_FLIGHT_RECORDER=1. The controller is the only KLog
+ * consumer until its checks are done: it drains what the boot recovered,
+ * writes three rings' worth of marker records, then calls klog_init()
+ * again with the ring memory untouched, which is what a warm reset does,
+ * and drains the recovered ring itself. The log flush task is created last,
+ * for the verdict:
+ *
+ *   Controller (priority 2) — writes, re-inits, drains, checks invariants
+ *   Monitor    (priority 1) — emits final verdict
+ *
+ * INVARIANTS
+ * ----------
+ * INV-KR1  Records from before the boot are drained first; afterwards
+ *          klog_pending() is 0
+ * INV-KR2  A full ring overwrites its oldest record: nothing is dropped,
+ *          nothing is handed to the flush task, and klog_snapshot() returns
+ *          the newest records in write order
+ * INV-KR3  After a re-init the ring is recovered whole; the drain returns it
+ *          oldest first, minus the records klog_init() itself wrote over
+ *          (KEVT_KLOG_BOOT, and KEVT_TIME_EPOCH unless the clock's high word
+ *          is 0), which are counted as dropped
+ * INV-KR4  The re-init writes one KEVT_KLOG_BOOT carrying the recovered
+ *          count, and records of the new run are not pending
+ */
+
+/* =================== Test Parameters =================== */
+
+#define TASK_CTRL_PRIORITY (2U)
+#define TASK_MON_PRIORITY  (1U)
+
+#define SETTLE_MS        (20U)
+#define MONITOR_POLL_MS  (20U)
+#define IDLE_SPIN_MS     (1000U)
+#define TEST_DURATION_MS (1000U)
+
+#define SLOTS     (KLOG_BUFFER_SIZE / sizeof(klog_record_t))
+#define WRITES    (3U * SLOTS)
+#define EVT_MARK  (0x7F00U) /* Not a KEVT_*: only this test writes it */
+#define MARK_TAG  (0xF1A6U)
+#define POST_MARK (0xFFFFFFFFU)
+
+RTOS_STATIC_ASSERT(KLOG_FLIGHT_RECORDER, "test_klog_recorder_state needs -D KLOG_FLIGHT_RECORDER=1");
+
+/* TEST_ASSERT, ASSERT_STATE, g_fail_count are in test_common.h */
+
+/* =================== Shared State =================== */
+
+static volatile bool g_test_started  = false;
+static volatile bool g_test_complete = false;
+
+static rtos_timer_handle_t g_test_timer;
+
+static klog_record_t g_records[SLOTS];
+
+/* =================== Task Implementations =================== */
+
+static uint32_t drain_all(void)
+{
+    uint32_t count = 0;
+    uint32_t n;
+
+    while ((n = klog_drain(g_records, SLOTS)) > 0U)
+    {
+        count += n;
+    }
+    return count;
+}
+
+/* Marker records in g_records[0..count) carry consecutive arg0 values from first */
+static bool marks_in_order(uint32_t count, uint32_t first)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (g_records[i].event_id != EVT_MARK || g_records[i].arg1 != MARK_TAG || g_records[i].arg0 != first + i)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void check_boot_drain(void)
+{
+    /* INV-KR1: whatever the RAM held at boot, it goes out first */
+    (void) drain_all();
+    TEST_ASSERT(klog_pending() == 0U, "INV-KR1:BootRingDrained");
+}
+
+static void check_overwrite(void)
+{
+    uint32_t dropped = klog_get_dropped();
+
+    /* INV-KR2: no other writer between the marks and the snapshot */
+    rtos_port_enter_critical();
+    for (uint32_t i = 0; i < WRITES; i++)
+    {
+        klog_write(KLOG_LEVEL_INFO, EVT_MARK, i, MARK_TAG);
+    }
+    uint32_t n = klog_snapshot(g_records, SLOTS);
+    rtos_port_exit_critical();
+
+    TEST_ASSERT(klog_get_dropped() == dropped, "INV-KR2:NothingDropped");
+    TEST_ASSERT(klog_pending() == 0U, "INV-KR2:NotHandedToFlush");
+    TEST_ASSERT(n == SLOTS, "INV-KR2:SnapshotFull");
+    TEST_ASSERT(marks_in_order(n, WRITES - SLOTS), "INV-KR2:NewestInOrder");
+}
+
+static void check_recovery(void)
+{
+    uint32_t recovered;
+    uint32_t pending;
+    uint32_t dropped;
+    uint32_t drained;
+
+    /* INV-KR3: re-init over the untouched ring, as after a watchdog reset */
+    rtos_port_enter_critical();
+    klog_init();
+    recovered = klog_get_recovered();
+    pending   = klog_pending();
+    drained   = drain_all();
+    dropped   = klog_get_dropped();
+    rtos_port_exit_critical();
+
+    TEST_ASSERT(recovered == SLOTS, "INV-KR3:RingRecovered");
+    TEST_ASSERT(pending == SLOTS, "INV-KR3:RecoveredPending");
+    TEST_ASSERT(dropped >= 1U && dropped <= 2U, "INV-KR3:OldestReplacedByInit");
+    TEST_ASSERT(drained + dropped == SLOTS, "INV-KR3:ReplacementCounted");
+
+    /* drain_all() leaves its last batch in g_records */
+    TEST_ASSERT(marks_in_order(drained, WRITES - drained), "INV-KR3:OldestFirst");
+
+    /* INV-KR4: the new run so far is [TimeEpoch,] KlogBoot, mark */
+    rtos_port_enter_critical();
+    klog_write(KLOG_LEVEL_INFO, EVT_MARK, POST_MARK, MARK_TAG);
+    uint32_t n = klog_snapshot(g_records, dropped + 1U);
+    rtos_port_exit_critical();
+
+    TEST_ASSERT(n == dropped + 1U && g_records[n - 2U].event_id == KEVT_KLOG_BOOT &&
+                    g_records[n - 2U].arg0 == SLOTS,
+                "INV-KR4:BootRecord");
+    TEST_ASSERT(n == dropped + 1U && g_records[n - 1U].event_id == EVT_MARK && g_records[n - 1U].arg0 == POST_MARK,
+                "INV-KR4:NewRunRecorded");
+    TEST_ASSERT(klog_pending() == 0U, "INV-KR4:NewRunNotPending");
+}
+
+/*
+ * Controller (priority 2).
+ */
+static void ctrl_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Controller");
+
+    rtos_delay_ms(SETTLE_MS);
+
+    check_boot_drain();
+    check_overwrite();
+    check_recovery();
+
+    /* Checks done: the flush task may now be the consumer */
+    rtos_task_handle_t flush_handle;
+    if (rtos_task_create(log_flush_task, "LogFlush", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, 0, &flush_handle) !=
+        RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    test_log_task("END", "Controller");
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+/*
+ * Monitor task (priority 1).
+ * Emits the final PASS/FAIL verdict.
+ */
+static void monitor_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Monitor");
+
+    while (!g_test_complete)
+    {
+        rtos_delay_ms(MONITOR_POLL_MS);
+    }
+
+    /* Final verdict */
+    TEST_EMIT_VERDICT();
+
+    test_log_task("END", "Monitor");
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+/* =================== Timer Callbacks =================== */
+
+static void startup_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    g_test_started = true;
+    test_log_framework("BEGIN", "KlogRecorderState");
+    rtos_timer_handle_t *p = (rtos_timer_handle_t *) param;
+    rtos_timer_start(*p);
+}
+
+static void test_timeout_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_complete = true;
+    test_log_framework("TIMEOUT", "KlogRecorderState");
+}
+
+/* =================== Main =================== */
+
+__attribute__((__noreturn__)) int main(void)
+{
+    rtos_status_t       status;
+    rtos_timer_handle_t startup_timer;
+    rtos_task_handle_t  handle;
+
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_ALL);
+
+    log_info("KLog Flight Recorder Test");
+    log_info("Priorities: Ctrl=%u Mon=%u, %u slots", TASK_CTRL_PRIORITY, TASK_MON_PRIORITY, (unsigned) SLOTS);
+    log_info("Invariants: KR1(boot_drain) KR2(overwrite) KR3(recovery) KR4(boot_record)");
+
+    status = rtos_init();
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("RTOS init failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = test_create_startup_timer(startup_timer_callback, &g_test_timer, &startup_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Startup timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_timer_create("TestTimer", TEST_DURATION_MS, RTOS_TIMER_ONE_SHOT, test_timeout_callback, NULL,
+                               &g_test_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Test timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    if (rtos_task_create(ctrl_task_func, "Controller", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_CTRL_PRIORITY,
+                         &handle) != RTOS_SUCCESS ||
+        rtos_task_create(monitor_task_func, "Monitor", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_MON_PRIORITY,
+                         &handle) != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    /* The flush task is created by the controller once it stops consuming KLog */
+    ulog_init(ULOG_LEVEL_INFO);
+
+    log_info("Starting scheduler...");
+    status = rtos_start_scheduler();
+
+    indicate_system_failure();
+}
@@ -0,0 +1,450 @@
+/*******************************************************************************
+ * File: tests/integration/test_mailbox_state.c
+ * Description: Mailbox Queue & Snapshot - Latest-Value Channel Invariant Test
+ * Author: Student
+ * Date: 2025
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "config.h"
+#include "device.h" // IWYU pragma: keep
+#include "hardware_env.h"
+#include "queue.h"
+#include "rtos_port.h"
+#include "semaphore.h"
+#include "snapshot.h"
+#include "task.h"
+#include "test_common.h"
+#include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
+#include "timer.h"
+#include "uart_tx.h"
+
+/**
+ * @file test_mailbox_state.c
+ * @brief Mailbox Queue & Snapshot Invariant Test
+ *
+ * SCENARIO
+ * --------
+ * Phase 1 (SCENARIO_CYCLES cycles) — a length-1 queue used as a mailbox.
+ * Two peekers block in rtos_queue_peek() on the empty mailbox; Control
+ * overwrites it twice, then pends TEST_IRQn, whose handler overwrites it
+ * once more and writes the ISR snapshot. Control receives the survivor.
+ *
+ *   PeekerA (priority 5) — peeks the mailbox, then waits on its semaphore
+ *   PeekerB (priority 4) — same
+ *
+ * Phase 2 (STRESS_MS) — a snapshot of RECORD_WORDS words, every word set
+ * to the write number, stress-read around one writer task:
+ *
+ *   HighReader (priority 3) — reads once a tick, preempting the writer
+ *   Writer     (priority 2) — writes bursts of WRITE_BURST, then sleeps a tick
+ *   Control    (priority 1) — reads in a loop, preempted by the writer
+ *
+ * INVARIANTS
+ * ----------
+ * INV-MB1  Overwrite replaces the queued item (task and ISR): the mailbox
+ *          holds one item, and receive returns the last one written.
+ * INV-MB2  Overwrite rejects queues longer than 1 (RTOS_ERROR_INVALID_PARAM)
+ *          and a slot held by receive_peek (RTOS_ERROR_FULL).
+ * INV-MB3  Overwrite into an empty mailbox wakes a blocked reader, which
+ *          runs before overwrite returns.
+ * INV-MB4  Peek copies without removing, and one publish wakes every
+ *          blocked peeker.
+ * INV-MB5  A snapshot reads RTOS_ERROR_EMPTY until its first write.
+ * INV-MB6  A snapshot written from an ISR reads back the latest value, with
+ *          the version counting the writes.
+ * INV-MB7  Snapshot reads are never torn and the contents match the
+ *          version, preempting or preempted by the writer.
+ * INV-MB8  Versions seen by each reader never go backwards.
+ */
+
+/* =================== Test Parameters =================== */
+
+#define TASK_PEEKER_A_PRIORITY    (5U)
+#define TASK_PEEKER_B_PRIORITY    (4U)
+#define TASK_HIGH_READER_PRIORITY (3U)
+#define TASK_WRITER_PRIORITY      (2U)
+#define TASK_CONTROL_PRIORITY     (1U)
+
+#define TEST_IRQn        TEST_SPARE_IRQn
+#define TEST_IRQ_PRIO    (14U) /* Below the kernel BASEPRI threshold */
+#define RECORD_WORDS     (16U)
+#define WRITE_BURST      (64U)
+#define SCENARIO_CYCLES  (20U)
+#define STRESS_MS        (1000U)
+#define SETTLE_MS        (5U)
+#define TEST_DURATION_MS (6000U)
+
+/* =================== Shared State =================== */
+
+typedef struct
+{
+    uint32_t word[RECORD_WORDS];
+} record_t;
+
+static volatile bool g_test_started  = false;
+static volatile bool g_test_complete = false;
+
+static rtos_timer_handle_t g_test_timer;
+
+static rtos_queue_handle_t g_mailbox = NULL;
+static rtos_queue_handle_t g_queue2  = NULL;
+static rtos_semaphore_t    g_sem_peeker_a;
+static rtos_semaphore_t    g_sem_peeker_b;
+
+static rtos_task_handle_t g_handle_peeker_a = NULL;
+static rtos_task_handle_t g_handle_peeker_b = NULL;
+
+static rtos_snapshot_t g_snap_isr;
+static rtos_snapshot_t g_snap_task;
+static record_t        g_snap_isr_storage[2];
+static record_t        g_snap_task_storage[2];
+
+/* Peeker results, checked by Control */
+static volatile uint32_t g_peek_a_value = 0;
+static volatile uint32_t g_peek_b_value = 0;
+static volatile uint32_t g_peek_a_count = 0;
+static volatile uint32_t g_peek_b_count = 0;
+
+/* ISR input and result */
+static volatile uint32_t      g_isr_value = 0;
+static volatile rtos_status_t g_isr_status;
+static volatile bool          g_isr_woken;
+
+/* Phase 2 */
+static volatile bool     g_stress        = false;
+static volatile uint32_t g_writes        = 0;
+static volatile uint32_t g_high_reads    = 0;
+static volatile uint32_t g_torn          = 0;
+static volatile uint32_t g_version_drops = 0;
+
+/* =================== Helpers =================== */
+
+static void fill_record(record_t *rec, uint32_t value)
+{
+    for (uint32_t i = 0; i < RECORD_WORDS; i++)
+    {
+        rec->word[i] = value;
+    }
+}
+
+/* Read g_snap_task once and check it against the reader's last version */
+static void check_task_snapshot(uint32_t *last_version)
+{
+    record_t rec;
+    uint32_t version = 0;
+
+    if (rtos_snapshot_read(&g_snap_task, &rec, &version) != RTOS_SUCCESS)
+    {
+        return;
+    }
+
+    for (uint32_t i = 0; i < RECORD_WORDS; i++)
+    {
+        if (rec.word[i] != version)
+        {
+            g_torn++;
+            break;
+        }
+    }
+
+    if (version < *last_version)
+    {
+        g_version_drops++;
+    }
+    *last_version = version;
+}
+
+/* =================== Interrupt Handler =================== */
+
+void TEST_SPARE_IRQHandler(void)
+{
+    bool     woken = false;
+    uint32_t value = g_isr_value;
+    record_t rec;
+
+    g_isr_status = rtos_queue_overwrite_from_isr(g_mailbox, &value, &woken);
+
+    fill_record(&rec, value);
+    rtos_snapshot_write(&g_snap_isr, &rec);
+
+    g_isr_woken = woken;
+
+    if (woken)
+    {
+        rtos_port_yield();
+    }
+}
+
+/* =================== Task Implementations =================== */
+
+static void peeker_a_task_func(void *param)
+{
+    (void) param;
+
+    while (1)
+    {
+        uint32_t value = 0;
+        if (rtos_queue_peek(g_mailbox, &value, RTOS_MAX_DELAY) == RTOS_SUCCESS)
+        {
+            g_peek_a_value = value;
+            g_peek_a_count++;
+        }
+        rtos_semaphore_wait(&g_sem_peeker_a, RTOS_SEM_MAX_WAIT);
+    }
+}
+
+static void peeker_b_task_func(void *param)
+{
+    (void) param;
+
+    while (1)
+    {
+        uint32_t value = 0;
+        if (rtos_queue_peek(g_mailbox, &value, RTOS_MAX_DELAY) == RTOS_SUCCESS)
+        {
+            g_peek_b_value = value;
+            g_peek_b_count++;
+        }
+        rtos_semaphore_wait(&g_sem_peeker_b, RTOS_SEM_MAX_WAIT);
+    }
+}
+
+static void high_reader_task_func(void *param)
+{
+    (void) param;
+    uint32_t last_version = 0;
+
+    while (1)
+    {
+        rtos_delay_ticks(1);
+        if (g_stress)
+        {
+            check_task_snapshot(&last_version);
+            g_high_reads++;
+        }
+    }
+}
+
+static void writer_task_func(void *param)
+{
+    (void) param;
+    record_t rec;
+
+    while (1)
+    {
+        rtos_delay_ticks(1);
+        for (uint32_t i = 0; i < WRITE_BURST && g_stress; i++)
+        {
+            /* Write n carries n in every word, so a reader can tell a torn copy */
+            fill_record(&rec, g_writes + 1U);
+            rtos_snapshot_write(&g_snap_task, &rec);
+            g_writes++;
+        }
+    }
+}
+
+static void run_mailbox_cycle(uint32_t cycle)
+{
+    uint32_t base        = (cycle + 1U) * 10U;
+    uint32_t a_before    = g_peek_a_count;
+    uint32_t b_before    = g_peek_b_count;
+    uint32_t value       = base;
+    uint32_t received    = 0;
+    record_t rec         = {0};
+    uint32_t version     = 0;
+    bool     record_same = true;
+
+    ASSERT_STATE(g_handle_peeker_a, RTOS_TASK_STATE_BLOCKED, "MB-SETUP:PeekerABlocked");
+    ASSERT_STATE(g_handle_peeker_b, RTOS_TASK_STATE_BLOCKED, "MB-SETUP:PeekerBBlocked");
+
+    /* Both peekers outrank Control and run before overwrite returns */
+    TEST_ASSERT(rtos_queue_overwrite(g_mailbox, &value) == RTOS_SUCCESS, "INV-MB3:OverwriteEmpty");
+    TEST_ASSERT(g_peek_a_count == a_before + 1U && g_peek_a_value == base, "INV-MB3:PeekerAWoken");
+    TEST_ASSERT(g_peek_b_count == b_before + 1U && g_peek_b_value == base, "INV-MB4:PeekerBWoken");
+    TEST_ASSERT(rtos_queue_messages_waiting(g_mailbox) == 1U, "INV-MB4:PeekKeepsItem");
+
+    value = base + 1U;
+    TEST_ASSERT(rtos_queue_overwrite(g_mailbox, &value) == RTOS_SUCCESS, "INV-MB1:OverwriteFull");
+    TEST_ASSERT(rtos_queue_messages_waiting(g_mailbox) == 1U, "INV-MB1:StillOneItem");
+
+    g_isr_value = base + 2U;
+    NVIC_SetPendingIRQ(TEST_IRQn);
+    __DSB();
+    __ISB();
+
+    TEST_ASSERT(g_isr_status == RTOS_SUCCESS && !g_isr_woken, "INV-MB1:OverwriteFromISR");
+    TEST_ASSERT(rtos_queue_peek(g_mailbox, &received, 0) == RTOS_SUCCESS && received == base + 2U,
+                "INV-MB4:PeekLatest");
+    TEST_ASSERT(rtos_queue_receive(g_mailbox, &received, 0) == RTOS_SUCCESS && received == base + 2U,
+                "INV-MB1:ReceiveLatest");
+    TEST_ASSERT(rtos_queue_is_empty(g_mailbox), "INV-MB1:EmptyAfterReceive");
+
+    TEST_ASSERT(rtos_snapshot_read(&g_snap_isr, &rec, &version) == RTOS_SUCCESS, "INV-MB6:ReadISRSnapshot");
+    for (uint32_t i = 0; i < RECORD_WORDS; i++)
+    {
+        record_same = record_same && (rec.word[i] == base + 2U);
+    }
+    TEST_ASSERT(record_same, "INV-MB6:LatestValue");
+    TEST_ASSERT(version == cycle + 1U && rtos_snapshot_version(&g_snap_isr) == version, "INV-MB6:VersionCounts");
+
+    /* Peekers go back to blocking on the empty mailbox */
+    rtos_semaphore_signal(&g_sem_peeker_a);
+    rtos_semaphore_signal(&g_sem_peeker_b);
+}
+
+static void control_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Control");
+
+    /* --- Parameter and state checks --- */
+    uint32_t    value = 0;
+    const void *held  = NULL;
+    record_t    rec;
+
+    TEST_ASSERT(rtos_queue_overwrite(g_queue2, &value) == RTOS_ERROR_INVALID_PARAM, "INV-MB2:LengthTwoRejected");
+    TEST_ASSERT(rtos_snapshot_read(&g_snap_isr, &rec, NULL) == RTOS_ERROR_EMPTY, "INV-MB5:EmptyBeforeWrite");
+
+    /* --- Phase 1: mailbox --- */
+    uint32_t cycle = 0;
+    for (; cycle < SCENARIO_CYCLES && !g_test_complete; cycle++)
+    {
+        rtos_delay_ms(SETTLE_MS);
+        run_mailbox_cycle(cycle);
+    }
+
+    /* A peeked mailbox item is read in place and cannot be overwritten */
+    rtos_delay_ms(SETTLE_MS);
+    value = 1;
+    rtos_queue_overwrite(g_mailbox, &value);
+    TEST_ASSERT(rtos_queue_receive_peek(g_mailbox, &held, 0) == RTOS_SUCCESS, "MB-SETUP:MailboxPeeked");
+    TEST_ASSERT(rtos_queue_overwrite(g_mailbox, &value) == RTOS_ERROR_FULL, "INV-MB2:HeldSlotRejected");
+    rtos_queue_receive_release(g_mailbox);
+
+    /* --- Phase 2: snapshot stress --- */
+    uint32_t    last_version = 0;
+    uint32_t    low_reads    = 0;
+    rtos_tick_t start        = rtos_get_tick_count();
+
+    g_stress = true;
+    while ((rtos_tick_t) (rtos_get_tick_count() - start) < (STRESS_MS / RTOS_TICK_PERIOD_MS) && !g_test_complete)
+    {
+        check_task_snapshot(&last_version);
+        low_reads++;
+    }
+    g_stress = false;
+    rtos_delay_ms(SETTLE_MS);
+
+    TEST_ASSERT(g_writes > 0U && g_high_reads > 0U && low_reads > 0U, "MB-SETUP:StressRan");
+    TEST_ASSERT(g_torn == 0U, "INV-MB7:NoTornReads");
+    TEST_ASSERT(g_version_drops == 0U, "INV-MB8:VersionMonotonic");
+    TEST_ASSERT(rtos_snapshot_version(&g_snap_task) == g_writes, "INV-MB7:VersionMatchesWrites");
+
+    log_info("Mailbox cycles=%u  snapshot writes=%u high reads=%u low reads=%u", (unsigned) cycle,
+             (unsigned) g_writes, (unsigned) g_high_reads, (unsigned) low_reads);
+
+    TEST_EMIT_VERDICT();
+
+    test_log_task("END", "Control");
+    while (1)
+    {
+        rtos_delay_ms(1000);
+    }
+}
+
+/* =================== Timer Callbacks =================== */
+
+static void startup_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    g_test_started = true;
+    test_log_framework("BEGIN", "Mailbox");
+    rtos_timer_handle_t *p = (rtos_timer_handle_t *) param;
+    rtos_timer_start(*p);
+}
+
+static void test_timeout_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_complete = true;
+    test_log_framework("TIMEOUT", "Mailbox");
+}
+
+/* =================== Main =================== */
+
+__attribute__((__noreturn__)) int main(void)
+{
+    rtos_status_t       status;
+    rtos_timer_handle_t startup_timer;
+
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_ALL);
+
+    log_info("Mailbox Queue & Snapshot Test");
+    log_info("PeekerA=%u PeekerB=%u HighReader=%u Writer=%u Control=%u", TASK_PEEKER_A_PRIORITY,
+             TASK_PEEKER_B_PRIORITY, TASK_HIGH_READER_PRIORITY, TASK_WRITER_PRIORITY, TASK_CONTROL_PRIORITY);
+    log_info("Invariants: MB1(overwrite) MB2(params) MB3(wake) MB4(peek) MB5(empty) MB6(ISR) MB7(torn) MB8(version)");
+
+    status = rtos_init();
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("RTOS init failed: %d", status);
+        indicate_system_failure();
+    }
+
+    if (rtos_queue_create(&g_mailbox, 1, sizeof(uint32_t)) != RTOS_SUCCESS ||
+        rtos_queue_create(&g_queue2, 2, sizeof(uint32_t)) != RTOS_SUCCESS ||
+        rtos_semaphore_init(&g_sem_peeker_a, 0, 1) != RTOS_SEM_OK ||
+        rtos_semaphore_init(&g_sem_peeker_b, 0, 1) != RTOS_SEM_OK ||
+        rtos_snapshot_init(&g_snap_isr, g_snap_isr_storage, sizeof(record_t)) != RTOS_SUCCESS ||
+        rtos_snapshot_init(&g_snap_task, g_snap_task_storage, sizeof(record_t)) != RTOS_SUCCESS)
+    {
+        log_error("Object init failed");
+        indicate_system_failure();
+    }
+
+    NVIC_SetPriority(TEST_IRQn, TEST_IRQ_PRIO);
+    NVIC_EnableIRQ(TEST_IRQn);
+
+    status = test_create_startup_timer(startup_timer_callback, &g_test_timer, &startup_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Startup timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_timer_create("TestTimer", TEST_DURATION_MS, RTOS_TIMER_ONE_SHOT, test_timeout_callback, NULL,
+                               &g_test_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Test timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t handle;
+    if (rtos_task_create(peeker_a_task_func, "PeekerA", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_PEEKER_A_PRIORITY,
+                         &g_handle_peeker_a) != RTOS_SUCCESS ||
+        rtos_task_create(peeker_b_task_func, "PeekerB", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_PEEKER_B_PRIORITY,
+                         &g_handle_peeker_b) != RTOS_SUCCESS ||
+        rtos_task_create(high_reader_task_func, "HighReader", RTOS_DEFAULT_TASK_STACK_SIZE, NULL,
+                         TASK_HIGH_READER_PRIORITY, &handle) != RTOS_SUCCESS ||
+        rtos_task_create(writer_task_func, "Writer", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_WRITER_PRIORITY,
+                         &handle) != RTOS_SUCCESS ||
+        rtos_task_create(control_task_func, "Control", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_CONTROL_PRIORITY,
+                         &handle) != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t flush_handle;
+    test_create_log_flush_task(&flush_handle);
+
+    log_info("Starting scheduler...");
+    status = rtos_start_scheduler();
+
+    indicate_system_failure();
+}
@@ -0,0 +1,245 @@
+/*******************************************************************************
+ * File: tests/integration/test_memory_heap.c
+ * Description: Heap Allocator - Reuse & Coalescing Invariant Test
+ * Author: Student
+ * Date: 2025
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "config.h"
+#include "device.h" // IWYU pragma: keep
+#include "hardware_env.h"
+#include "memory.h"
+#include "queue.h"
+#include "task.h"
+#include "test_common.h"
+#include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
+#include "timer.h"
+#include "uart_tx.h"
+
+/**
+ * @file test_memory_heap.c
+ * @brief Heap Allocator Reuse & Coalescing Invariant Test
+ *
+ * SCENARIO
+ * --------
+ * One Churn task (priority 2) runs CHURN_CYCLES cycles. Each cycle it:
+ *
+ *   1. Creates a Worker task (priority 3) that either returns to Churn
+ *      and is deleted by it, or deletes itself (alternating cycles).
+ *   2. Creates and deletes a queue.
+ *   3. Allocates a set of variable-size blocks, frees them in an
+ *      interleaved order so neighbours must be merged.
+ *
+ * Between cycles Churn sleeps so the idle task reclaims self-deleted
+ * Worker stacks. With the old bump allocator the heap is exhausted
+ * after a handful of cycles.
+ *
+ * INVARIANTS
+ * ----------
+ * INV-H1  Every allocation in the scenario succeeds (no leak starves it).
+ * INV-H2  After each cycle, free_bytes returns to the baseline value.
+ * INV-H3  After each cycle, largest_free_block returns to the baseline
+ *         (freed neighbours were coalesced, not fragmented).
+ * INV-H4  largest_free_block <= free_bytes <= total_bytes.
+ * INV-H5  Returned pointers are 8-byte aligned.
+ * INV-H6  peak_used_bytes never decreases.
+ */
+
+/* =================== Test Parameters =================== */
+
+#define TASK_CHURN_PRIORITY  (2U)
+#define TASK_WORKER_PRIORITY (3U)
+
+#define CHURN_CYCLES     (50U)
+#define BLOCKS_PER_CYCLE (8U)
+#define RECLAIM_MS       (10U)
+#define TEST_DURATION_MS (8000U)
+
+/* =================== Shared State =================== */
+
+static volatile bool g_test_started  = false;
+static volatile bool g_test_complete = false;
+
+static rtos_timer_handle_t g_test_timer;
+
+static volatile uint32_t g_worker_runs = 0;
+
+/* Sizes chosen to straddle several TLSF size classes */
+static const size_t g_block_sizes[BLOCKS_PER_CYCLE] = {24, 200, 64, 520, 8, 1000, 132, 48};
+
+/* =================== Task Implementations =================== */
+
+/*
+ * Worker (priority 3): runs immediately on creation. Odd runs delete
+ * themselves, exercising the idle-task reclaim path.
+ */
+static void worker_task_func(void *param)
+{
+    uint32_t run = (uint32_t) (uintptr_t) param;
+
+    g_worker_runs++;
+
+    if ((run & 1U) != 0U)
+    {
+        rtos_task_delete(NULL); /* Never returns */
+    }
+
+    while (1)
+    {
+        rtos_delay_ms(1000);
+    }
+}
+
+static void churn_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Churn");
+
+    rtos_memory_stats_t baseline;
+    rtos_memory_get_stats(&baseline);
+
+    size_t last_peak = baseline.peak_used_bytes;
+
+    for (uint32_t cycle = 0; cycle < CHURN_CYCLES && !g_test_complete; cycle++)
+    {
+        /* 1. Task create/delete */
+        rtos_task_handle_t worker = NULL;
+        rtos_status_t      s      = rtos_task_create(worker_task_func, "Work", RTOS_DEFAULT_TASK_STACK_SIZE,
+                                                     (void *) (uintptr_t) cycle, TASK_WORKER_PRIORITY, &worker);
+        TEST_ASSERT(s == RTOS_SUCCESS, "INV-H1:TaskCreate");
+        rtos_delay_ms(1); /* Let Worker run (and possibly delete itself) */
+
+        if (s == RTOS_SUCCESS && (cycle & 1U) == 0U)
+        {
+            s = rtos_task_delete(worker);
+            TEST_ASSERT(s == RTOS_SUCCESS, "H-CHURN:TaskDelete");
+        }
+
+        /* 2. Queue create/delete */
+        rtos_queue_handle_t queue = NULL;
+        s                         = rtos_queue_create(&queue, 16, sizeof(uint32_t));
+        TEST_ASSERT(s == RTOS_SUCCESS, "INV-H1:QueueCreate");
+        if (s == RTOS_SUCCESS)
+        {
+            s = rtos_queue_delete(queue);
+            TEST_ASSERT(s == RTOS_SUCCESS, "H-CHURN:QueueDelete");
+        }
+
+        /* 3. Variable-size blocks, freed evens first then odds */
+        void *blocks[BLOCKS_PER_CYCLE];
+        for (uint32_t i = 0; i < BLOCKS_PER_CYCLE; i++)
+        {
+            blocks[i] = rtos_malloc(g_block_sizes[i]);
+            TEST_ASSERT(blocks[i] != NULL, "INV-H1:Malloc");
+            TEST_ASSERT(((uintptr_t) blocks[i] & 7U) == 0U, "INV-H5:Aligned");
+        }
+
+        rtos_memory_stats_t stats;
+        rtos_memory_get_stats(&stats);
+        TEST_ASSERT(stats.peak_used_bytes >= last_peak, "INV-H6:PeakMonotonic");
+        last_peak = stats.peak_used_bytes;
+
+        for (uint32_t i = 0; i < BLOCKS_PER_CYCLE; i += 2)
+        {
+            rtos_free(blocks[i]);
+        }
+        for (uint32_t i = 1; i < BLOCKS_PER_CYCLE; i += 2)
+        {
+            rtos_free(blocks[i]);
+        }
+
+        /* Let the idle task release a self-deleted Worker */
+        rtos_delay_ms(RECLAIM_MS);
+
+        rtos_memory_get_stats(&stats);
+        TEST_ASSERT(stats.free_bytes == baseline.free_bytes, "INV-H2:FreeBytesRestored");
+        TEST_ASSERT(stats.largest_free_block == baseline.largest_free_block, "INV-H3:Coalesced");
+        TEST_ASSERT(stats.largest_free_block <= stats.free_bytes && stats.free_bytes <= stats.total_bytes,
+                    "INV-H4:StatsBounds");
+    }
+
+    TEST_ASSERT(g_worker_runs == CHURN_CYCLES, "H-CHURN:AllWorkersRan");
+
+    TEST_EMIT_VERDICT();
+
+    test_log_task("END", "Churn");
+    while (1)
+    {
+        rtos_delay_ms(1000);
+    }
+}
+
+/* =================== Timer Callbacks =================== */
+
+static void startup_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    g_test_started = true;
+    test_log_framework("BEGIN", "MemoryHeap");
+    rtos_timer_handle_t *p = (rtos_timer_handle_t *) param;
+    rtos_timer_start(*p);
+}
+
+static void test_timeout_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_complete = true;
+    test_log_framework("TIMEOUT", "MemoryHeap");
+}
+
+/* =================== Main =================== */
+
+__attribute__((__noreturn__)) int main(void)
+{
+    rtos_status_t       status;
+    rtos_timer_handle_t startup_timer;
+
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_ALL);
+
+    log_info("Heap Allocator Reuse & Coalescing Test");
+    log_info("Cycles: %u  Blocks/cycle: %u  Heap: %u", CHURN_CYCLES, BLOCKS_PER_CYCLE, RTOS_TOTAL_HEAP_SIZE);
+    log_info("Invariants: H1(no exhaustion) H2(free restored) H3(coalesced) H4(bounds) H5(align) H6(peak)");
+
+    status = rtos_init();
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("RTOS init failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = test_create_startup_timer(startup_timer_callback, &g_test_timer, &startup_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Startup timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_timer_create("TestTimer", TEST_DURATION_MS, RTOS_TIMER_ONE_SHOT, test_timeout_callback, NULL,
+                               &g_test_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Test timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t churn_handle;
+    status = rtos_task_create(churn_task_func, "Churn", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_CHURN_PRIORITY,
+                              &churn_handle);
+    if (status != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t flush_handle;
+    test_create_log_flush_task(&flush_handle);
+
+    log_info("Starting scheduler...");
+    status = rtos_start_scheduler();
+
+    indicate_system_failure();
+}
@@ -0,0 +1,272 @@
+/*******************************************************************************
+ * File: tests/integration/test_mempool_state.c
+ * Description: Memory Pool - Blocking Alloc & Accounting Invariant Test
+ * Author: Student
+ * Date: 2025
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "config.h"
+#include "device.h" // IWYU pragma: keep
+#include "hardware_env.h"
+#include "mempool.h"
+#include "task.h"
+#include "test_common.h"
+#include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
+#include "timer.h"
+#include "uart_tx.h"
+
+/**
+ * @file test_mempool_state.c
+ * @brief Memory Pool Blocking Alloc & Accounting Invariant Test
+ *
+ * SCENARIO
+ * --------
+ * Pool of POOL_BLOCKS blocks. Two tasks:
+ *
+ *   Waiter (priority 3) — allocates with RTOS_MAX_DELAY and with a
+ *                         finite timeout while the pool is exhausted
+ *   Holder (priority 2) — drains the pool, then frees blocks one at a
+ *                         time to release the Waiter
+ *
+ * Each of SCENARIO_CYCLES cycles, Holder takes every block and signals
+ * Waiter, which then blocks on an empty pool. Holder checks the Waiter
+ * is BLOCKED, frees one block, and the Waiter (higher priority) must
+ * receive exactly that block. The Waiter then tries a timed allocation
+ * that must time out, and returns its block.
+ *
+ * INVARIANTS
+ * ----------
+ * INV-P1  Non-blocking alloc on an empty pool returns NULL immediately.
+ * INV-P2  A task allocating with a timeout on an empty pool is BLOCKED.
+ * INV-P3  Freeing a block wakes the highest-priority waiter with it.
+ * INV-P4  A timed alloc returns NULL after roughly timeout_ticks.
+ * INV-P5  Freeing a pointer not owned by the pool is rejected.
+ * INV-P6  free_count + blocks in use == block_count; peak_used == block_count.
+ */
+
+/* =================== Test Parameters =================== */
+
+#define TASK_WAITER_PRIORITY (3U)
+#define TASK_HOLDER_PRIORITY (2U)
+
+#define POOL_BLOCKS      (4U)
+#define POOL_BLOCK_SIZE  (24U)
+#define WAIT_TIMEOUT     (20U)
+#define SCENARIO_CYCLES  (10U)
+#define SETTLE_MS        (10U)
+#define TEST_DURATION_MS (6000U)
+
+/* =================== Shared State =================== */
+
+static volatile bool g_test_started  = false;
+static volatile bool g_test_complete = false;
+
+static rtos_timer_handle_t g_test_timer;
+
+static rtos_mempool_t g_pool;
+static uint8_t        g_pool_storage[RTOS_MEMPOOL_BUFFER_SIZE(POOL_BLOCK_SIZE, POOL_BLOCKS)] __attribute__((aligned(8)));
+
+static rtos_task_handle_t g_handle_waiter = NULL;
+
+static volatile uint32_t g_wait_signal   = 0;
+static volatile uint32_t g_waiter_done   = 0;
+static void *volatile    g_freed_block   = NULL;
+static void *volatile    g_waiter_block  = NULL;
+
+/* =================== Task Implementations =================== */
+
+static void waiter_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Waiter");
+
+    uint32_t last_signal = 0;
+
+    for (uint32_t cycle = 0; cycle < SCENARIO_CYCLES && !g_test_complete; cycle++)
+    {
+        while (g_wait_signal <= last_signal)
+        {
+            rtos_delay_ms(2);
+        }
+        last_signal = g_wait_signal;
+
+        /* INV-P1: non-blocking alloc on empty pool */
+        TEST_ASSERT(rtos_mempool_alloc(&g_pool, 0) == NULL, "INV-P1:EmptyNoWait");
+
+        /* Blocks until Holder frees (INV-P2 checked by Holder) */
+        void *block    = rtos_mempool_alloc(&g_pool, RTOS_MAX_DELAY);
+        g_waiter_block = block;
+
+        /* INV-P4: pool is empty again, timed alloc must time out */
+        rtos_tick_t start = rtos_get_tick_count();
+        void       *none  = rtos_mempool_alloc(&g_pool, WAIT_TIMEOUT);
+        rtos_tick_t took  = rtos_get_tick_count() - start;
+        TEST_ASSERT(none == NULL, "INV-P4:TimedAllocNull");
+        TEST_ASSERT(took >= WAIT_TIMEOUT && took <= WAIT_TIMEOUT + 2U, "INV-P4:TimeoutDuration");
+
+        rtos_status_t s = rtos_mempool_free(&g_pool, block);
+        TEST_ASSERT(s == RTOS_SUCCESS, "P-WAIT:FreeOK");
+
+        g_waiter_done = cycle + 1;
+    }
+
+    test_log_task("END", "Waiter");
+    while (1)
+    {
+        rtos_delay_ms(1000);
+    }
+}
+
+static void holder_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Holder");
+
+    void *held[POOL_BLOCKS];
+
+    for (uint32_t cycle = 0; cycle < SCENARIO_CYCLES && !g_test_complete; cycle++)
+    {
+        for (uint32_t i = 0; i < POOL_BLOCKS; i++)
+        {
+            held[i] = rtos_mempool_alloc(&g_pool, 0);
+            TEST_ASSERT(held[i] != NULL, "P-HOLD:DrainOK");
+        }
+
+        /* Let Waiter run and block on the empty pool */
+        g_wait_signal = cycle + 1;
+        rtos_delay_ms(SETTLE_MS);
+
+        /* INV-P2 */
+        ASSERT_STATE(g_handle_waiter, RTOS_TASK_STATE_BLOCKED, "INV-P2:WaiterBlocked");
+
+        /* INV-P3: Waiter preempts us on free and must get this block */
+        g_freed_block = held[0];
+        rtos_mempool_free(&g_pool, held[0]);
+        TEST_ASSERT(g_waiter_block == g_freed_block, "INV-P3:HandedToWaiter");
+
+        /* INV-P5 */
+        uint32_t      bogus = 0;
+        rtos_status_t s     = rtos_mempool_free(&g_pool, &bogus);
+        TEST_ASSERT(s == RTOS_ERROR_INVALID_PARAM, "INV-P5:ForeignFreeRejected");
+        s = rtos_mempool_free(&g_pool, (uint8_t *) held[1] + 1);
+        TEST_ASSERT(s == RTOS_ERROR_INVALID_PARAM, "INV-P5:MisalignedFreeRejected");
+
+        while (g_waiter_done <= cycle)
+        {
+            rtos_delay_ms(5);
+        }
+
+        rtos_mempool_stats_t stats;
+        rtos_mempool_get_stats(&g_pool, &stats);
+        TEST_ASSERT(stats.free_count == 1U, "INV-P6:FreeCount");
+        TEST_ASSERT(stats.peak_used == POOL_BLOCKS, "INV-P6:PeakUsed");
+
+        for (uint32_t i = 1; i < POOL_BLOCKS; i++)
+        {
+            rtos_mempool_free(&g_pool, held[i]);
+        }
+
+        rtos_mempool_get_stats(&g_pool, &stats);
+        TEST_ASSERT(stats.free_count == POOL_BLOCKS, "INV-P6:AllReturned");
+    }
+
+    TEST_EMIT_VERDICT();
+
+    test_log_task("END", "Holder");
+    while (1)
+    {
+        rtos_delay_ms(1000);
+    }
+}
+
+/* =================== Timer Callbacks =================== */
+
+static void startup_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    g_test_started = true;
+    test_log_framework("BEGIN", "MempoolState");
+    rtos_timer_handle_t *p = (rtos_timer_handle_t *) param;
+    rtos_timer_start(*p);
+}
+
+static void test_timeout_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_complete = true;
+    test_log_framework("TIMEOUT", "MempoolState");
+}
+
+/* =================== Main =================== */
+
+__attribute__((__noreturn__)) int main(void)
+{
+    rtos_status_t       status;
+    rtos_timer_handle_t startup_timer;
+
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_ALL);
+
+    log_info("Memory Pool Blocking Alloc & Accounting Test");
+    log_info("Priorities: Waiter=%u Holder=%u", TASK_WAITER_PRIORITY, TASK_HOLDER_PRIORITY);
+    log_info("Blocks: %u x %u B  Cycles: %u", POOL_BLOCKS, POOL_BLOCK_SIZE, SCENARIO_CYCLES);
+    log_info("Invariants: P1(no-wait) P2(block) P3(handoff) P4(timeout) P5(foreign) P6(accounting)");
+
+    status = rtos_init();
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("RTOS init failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_mempool_init(&g_pool, g_pool_storage, POOL_BLOCK_SIZE, POOL_BLOCKS);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Mempool init failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = test_create_startup_timer(startup_timer_callback, &g_test_timer, &startup_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Startup timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_timer_create("TestTimer", TEST_DURATION_MS, RTOS_TIMER_ONE_SHOT, test_timeout_callback, NULL,
+                               &g_test_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Test timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_task_create(waiter_task_func, "Waiter", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_WAITER_PRIORITY,
+                              &g_handle_waiter);
+    if (status != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t holder_handle;
+    status = rtos_task_create(holder_task_func, "Holder", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_HOLDER_PRIORITY,
+                              &holder_handle);
+    if (status != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t flush_handle;
+    test_create_log_flush_task(&flush_handle);
+
+    log_info("Starting scheduler...");
+    status = rtos_start_scheduler();
+
+    indicate_system_failure();
+}
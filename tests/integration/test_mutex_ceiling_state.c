@@ -0,0 +1,267 @@
+/*******************************************************************************
+ * File: tests/integration/test_mutex_ceiling_state.c
+ * Description: Mutex - Priority Ceiling Protocol Invariant Test
+ * Author: Student
+ * Date: 2025
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "config.h"
+#include "device.h" // IWYU pragma: keep
+#include "hardware_env.h"
+#include "mutex.h"
+#include "semaphore.h"
+#include "task.h"
+#include "test_common.h"
+#include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
+#include "timer.h"
+#include "uart_tx.h"
+
+/**
+ * @file test_mutex_ceiling_state.c
+ * @brief Priority Ceiling Mutex Invariant Test
+ *
+ * SCENARIO
+ * --------
+ * Two ceiling mutexes A and B (ceiling 3) are locked by Control in the
+ * order A then B and by Mid in the order B then A. Inheritance mutexes
+ * locked in opposite orders can deadlock; ceiling mutexes cannot, because
+ * Mid never runs while Control holds either one.
+ *
+ *   High    (priority 5) — above the ceiling; logs 'H', tries to lock A
+ *   Mid     (priority 3) — at the ceiling; locks B then A, logs 'M'
+ *   Control (priority 1) — locks A then B, wakes the others, checks
+ *
+ * INVARIANTS
+ * ----------
+ * INV-PC1  Locking a ceiling mutex raises the owner to the ceiling at once;
+ *          the last unlock restores its base priority.
+ * INV-PC2  A task at or below the ceiling does not preempt the owner, not
+ *          even across ticks.
+ * INV-PC3  A task above the ceiling still preempts the owner.
+ * INV-PC4  The unlock that drops the ceiling lets the held-off task run
+ *          before it returns.
+ * INV-PC5  Nested ceiling mutexes keep the owner at the highest ceiling it
+ *          still holds.
+ * INV-PC6  Locking from above the ceiling and invalid ceilings fail with
+ *          RTOS_MUTEX_ERR_INVALID.
+ * INV-PC7  Opposite lock orders complete every cycle (no deadlock).
+ */
+
+/* =================== Test Parameters =================== */
+
+#define TASK_HIGH_PRIORITY    (5U)
+#define TASK_MID_PRIORITY     (3U)
+#define TASK_CONTROL_PRIORITY (1U)
+#define MUTEX_CEILING         (3U)
+
+#define SPIN_TICKS       (3U)
+#define SCENARIO_CYCLES  (20U)
+#define SETTLE_MS        (5U)
+#define TEST_DURATION_MS (6000U)
+
+/* =================== Shared State =================== */
+
+static volatile bool g_test_started  = false;
+static volatile bool g_test_complete = false;
+
+static rtos_timer_handle_t g_test_timer;
+
+static rtos_mutex_t     g_mutex_a;
+static rtos_mutex_t     g_mutex_b;
+static rtos_semaphore_t g_sem_mid;
+static rtos_semaphore_t g_sem_high;
+
+/* Run log: 'H' / 'M' per wake, in run order */
+static volatile char     g_order[2];
+static volatile uint32_t g_order_len = 0;
+
+static volatile uint32_t g_mid_cycles = 0;
+
+/* =================== Helpers =================== */
+
+static void spin_ticks(rtos_tick_t ticks)
+{
+    rtos_tick_t start = rtos_get_tick_count();
+    while ((rtos_tick_t) (rtos_get_tick_count() - start) < ticks)
+    {
+    }
+}
+
+static void log_run(char id)
+{
+    if (g_order_len < sizeof(g_order))
+    {
+        g_order[g_order_len] = id;
+    }
+    g_order_len++;
+}
+
+/* =================== Task Implementations =================== */
+
+static void high_task_func(void *param)
+{
+    (void) param;
+
+    while (1)
+    {
+        if (rtos_semaphore_wait(&g_sem_high, RTOS_SEM_MAX_WAIT) == RTOS_SEM_OK)
+        {
+            log_run('H');
+            TEST_ASSERT(rtos_mutex_lock(&g_mutex_a, RTOS_NO_WAIT) == RTOS_MUTEX_ERR_INVALID,
+                        "INV-PC6:LockAboveCeiling");
+        }
+    }
+}
+
+static void mid_task_func(void *param)
+{
+    (void) param;
+
+    while (1)
+    {
+        if (rtos_semaphore_wait(&g_sem_mid, RTOS_SEM_MAX_WAIT) == RTOS_SEM_OK)
+        {
+            /* Opposite order to Control */
+            TEST_ASSERT(rtos_mutex_lock(&g_mutex_b, RTOS_NO_WAIT) == RTOS_MUTEX_OK, "INV-PC7:MidLockB");
+            TEST_ASSERT(rtos_mutex_lock(&g_mutex_a, RTOS_NO_WAIT) == RTOS_MUTEX_OK, "INV-PC7:MidLockA");
+            log_run('M');
+            rtos_mutex_unlock(&g_mutex_a);
+            rtos_mutex_unlock(&g_mutex_b);
+            g_mid_cycles++;
+        }
+    }
+}
+
+static void control_task_func(void *param)
+{
+    (void) param;
+    rtos_task_handle_t self = rtos_task_get_current();
+    rtos_mutex_t       bad;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Control");
+
+    TEST_ASSERT(rtos_mutex_init_ceiling(&bad, 0) == RTOS_MUTEX_ERR_INVALID, "INV-PC6:ZeroCeiling");
+    TEST_ASSERT(rtos_mutex_init_ceiling(&bad, RTOS_MAX_TASK_PRIORITIES) == RTOS_MUTEX_ERR_INVALID,
+                "INV-PC6:CeilingOutOfRange");
+
+    uint32_t cycle = 0;
+    for (; cycle < SCENARIO_CYCLES && !g_test_complete; cycle++)
+    {
+        rtos_delay_ms(SETTLE_MS);
+        g_order_len = 0;
+
+        TEST_ASSERT(rtos_mutex_lock(&g_mutex_a, RTOS_MAX_WAIT) == RTOS_MUTEX_OK, "INV-PC7:ControlLockA");
+        TEST_ASSERT(rtos_task_get_priority(self) == MUTEX_CEILING, "INV-PC1:RaisedOnLock");
+
+        rtos_semaphore_signal(&g_sem_mid);
+        spin_ticks(SPIN_TICKS);
+        TEST_ASSERT(g_order_len == 0, "INV-PC2:MidHeld");
+
+        rtos_semaphore_signal(&g_sem_high);
+        TEST_ASSERT(g_order_len == 1U && g_order[0] == 'H', "INV-PC3:HighPreempted");
+
+        TEST_ASSERT(rtos_mutex_lock(&g_mutex_b, RTOS_MAX_WAIT) == RTOS_MUTEX_OK, "INV-PC7:ControlLockB");
+        rtos_mutex_unlock(&g_mutex_b);
+        TEST_ASSERT(rtos_task_get_priority(self) == MUTEX_CEILING, "INV-PC5:StillHoldsA");
+        TEST_ASSERT(g_order_len == 1U, "INV-PC5:MidStillHeld");
+
+        rtos_mutex_unlock(&g_mutex_a);
+        TEST_ASSERT(g_order_len == 2U && g_order[1] == 'M', "INV-PC4:MidRanAtUnlock");
+        TEST_ASSERT(rtos_task_get_priority(self) == TASK_CONTROL_PRIORITY, "INV-PC1:RestoredOnUnlock");
+    }
+
+    TEST_ASSERT(g_mid_cycles == cycle, "INV-PC7:AllCyclesCompleted");
+
+    TEST_EMIT_VERDICT();
+
+    test_log_task("END", "Control");
+    while (1)
+    {
+        rtos_delay_ms(1000);
+    }
+}
+
+/* =================== Timer Callbacks =================== */
+
+static void startup_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    g_test_started = true;
+    test_log_framework("BEGIN", "MutexCeiling");
+    rtos_timer_handle_t *p = (rtos_timer_handle_t *) param;
+    rtos_timer_start(*p);
+}
+
+static void test_timeout_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_complete = true;
+    test_log_framework("TIMEOUT", "MutexCeiling");
+}
+
+/* =================== Main =================== */
+
+__attribute__((__noreturn__)) int main(void)
+{
+    rtos_status_t       status;
+    rtos_timer_handle_t startup_timer;
+
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_ALL);
+
+    log_info("Priority Ceiling Mutex Test");
+    log_info("High prio=%u  Mid prio=%u  Control prio=%u  ceiling=%u", TASK_HIGH_PRIORITY, TASK_MID_PRIORITY,
+             TASK_CONTROL_PRIORITY, MUTEX_CEILING);
+    log_info("Invariants: PC1(raise) PC2(held) PC3(above) PC4(unlock) PC5(nest) PC6(params) PC7(order)");
+
+    status = rtos_init();
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("RTOS init failed: %d", status);
+        indicate_system_failure();
+    }
+
+    if (rtos_mutex_init_ceiling(&g_mutex_a, MUTEX_CEILING) != RTOS_MUTEX_OK ||
+        rtos_mutex_init_ceiling(&g_mutex_b, MUTEX_CEILING) != RTOS_MUTEX_OK ||
+        rtos_semaphore_init(&g_sem_mid, 0, 1) != RTOS_SEM_OK || rtos_semaphore_init(&g_sem_high, 0, 1) != RTOS_SEM_OK)
+    {
+        indicate_system_failure();
+    }
+
+    status = test_create_startup_timer(startup_timer_callback, &g_test_timer, &startup_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Startup timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_timer_create("TestTimer", TEST_DURATION_MS, RTOS_TIMER_ONE_SHOT, test_timeout_callback, NULL,
+                               &g_test_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Test timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t handle;
+    if (rtos_task_create(high_task_func, "High", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_HIGH_PRIORITY, &handle) !=
+            RTOS_SUCCESS ||
+        rtos_task_create(mid_task_func, "Mid", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_MID_PRIORITY, &handle) !=
+            RTOS_SUCCESS ||
+        rtos_task_create(control_task_func, "Control", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_CONTROL_PRIORITY,
+                         &handle) != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t flush_handle;
+    test_create_log_flush_task(&flush_handle);
+
+    log_info("Starting scheduler...");
+    status = rtos_start_scheduler();
+
+    indicate_system_failure();
+}
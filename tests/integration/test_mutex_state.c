@@ -7,9 +7,9 @@
 
 #include "VRTOS.h"
 #include "config.h"
+#include "device.h" // IWYU pragma: keep
 #include "hardware_env.h"
 #include "mutex.h"
-#include "stm32f4xx_hal.h" // IWYU pragma: keep
 #include "task.h"
 #include "task_priv.h" /* rtos_tcb_t - needed to read base_priority directly */
 #include "test_common.h"
@@ -0,0 +1,449 @@
+/*******************************************************************************
+ * File: tests/integration/test_netbuf_state.c
+ * Description: Chained Packet Buffers - Segmentation, Header Room & Scatter-Gather Test
+ * Author: Student
+ * Date: 2025
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "config.h"
+#include "device.h" // IWYU pragma: keep
+#include "hardware_env.h"
+#include "netbuf.h"
+#include "queue.h"
+#include "rtos_port.h"
+#include "task.h"
+#include "test_common.h"
+#include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
+#include "timer.h"
+#include "uart_tx.h"
+
+#include <string.h>
+
+/**
+ * @file test_netbuf_state.c
+ * @brief Chained Packet Buffer Test
+ *
+ * SCENARIO
+ * --------
+ * Three tasks plus log flush:
+ *
+ *   Driver     (priority 3) — takes chain heads from a TX queue through the
+ *                             zero-copy peek/release calls, "transmits"
+ *                             each one by copying its scatter-gather
+ *                             entries into a wire buffer, frees it
+ *   Controller (priority 2) — builds packets, checks invariants
+ *   Monitor    (priority 1) — emits final verdict
+ *
+ * INVARIANTS
+ * ----------
+ * INV-NB1  A packet spans ceil((len + reserve) / seg_size) segments; the
+ *          first keeps `reserve` bytes of header room, tot_len is correct
+ *          along the chain
+ * INV-NB2  push claims header room in place and fails past it; pull hides
+ *          a header; tot_len follows both
+ * INV-NB3  copy_in / copy_out round-trip across segment boundaries
+ * INV-NB4  to_sg gives one entry per non-empty segment, addresses and
+ *          lengths matching the chain, and 0 if the array is too short
+ * INV-NB5  cat links a header chain in front of a payload chain; one
+ *          payload can sit behind two headers and is freed only with the
+ *          last chain
+ * INV-NB6  A failed allocation leaves no segment allocated
+ * INV-NB7  An ISR allocates and frees with the _from_isr calls
+ * INV-NB8  A chain head travels through zero-copy queue slots and the
+ *          receiver sees the packet bytes without a copy
+ */
+
+/* =================== Test Parameters =================== */
+
+#define TASK_DRIVER_PRIORITY (3U)
+#define TASK_CTRL_PRIORITY   (2U)
+#define TASK_MON_PRIORITY    (1U)
+
+#define SETTLE_MS        (20U)
+#define MONITOR_POLL_MS  (20U)
+#define IDLE_SPIN_MS     (1000U)
+#define TEST_DURATION_MS (2000U)
+
+#define TEST_IRQn     TEST_SPARE_IRQn
+#define TEST_IRQ_PRIO (14U) /* Below the kernel BASEPRI threshold */
+
+#define SEG_SIZE     (64U)
+#define POOL_SEGS    (8U)
+#define RESERVE      (16U)
+#define PAYLOAD_LEN  (150U) /* 48 + 64 + 38 */
+#define HDR_LEN      (12U)
+#define QUEUE_LENGTH (2U)
+#define MAX_SG       (POOL_SEGS)
+
+/* TEST_ASSERT, ASSERT_STATE, g_fail_count are in test_common.h */
+
+/* =================== Shared State =================== */
+
+static volatile bool g_test_started  = false;
+static volatile bool g_test_complete = false;
+
+static rtos_timer_handle_t g_test_timer;
+
+static rtos_netbuf_pool_t g_pool;
+static uint64_t           g_pool_storage[RTOS_NETBUF_POOL_BUFFER_SIZE(SEG_SIZE, POOL_SEGS) / 8U];
+
+static rtos_queue_handle_t g_tx_queue;
+static rtos_queue_static_t g_tx_queue_cb;
+static rtos_netbuf_t      *g_tx_storage[QUEUE_LENGTH];
+
+/* Driver results */
+static uint8_t                      g_wire[POOL_SEGS * SEG_SIZE];
+static volatile uint32_t            g_wire_len  = 0;
+static volatile uint32_t            g_sent      = 0;
+static volatile uint32_t            g_sg_count  = 0;
+static const rtos_netbuf_t *volatile g_seen_head = NULL;
+
+/* ISR results */
+static volatile uint32_t g_isr_segs  = 0;
+static volatile uint32_t g_isr_freed = 0;
+
+/* =================== Helpers =================== */
+
+static uint32_t pool_free(void)
+{
+    rtos_mempool_stats_t stats;
+    rtos_mempool_get_stats(&g_pool.blocks, &stats);
+    return stats.free_count;
+}
+
+static void fill_pattern(uint8_t *buf, uint32_t len, uint8_t seed)
+{
+    for (uint32_t i = 0; i < len; i++)
+    {
+        buf[i] = (uint8_t) (seed + i);
+    }
+}
+
+static bool check_pattern(const uint8_t *buf, uint32_t len, uint8_t seed)
+{
+    for (uint32_t i = 0; i < len; i++)
+    {
+        if (buf[i] != (uint8_t) (seed + i))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* True if every segment's tot_len is its len plus the rest of the chain */
+static bool tot_len_ok(const rtos_netbuf_t *nb)
+{
+    for (; nb != NULL; nb = nb->next)
+    {
+        uint32_t rest = (nb->next != NULL) ? nb->next->tot_len : 0U;
+        if (nb->tot_len != nb->len + rest)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* =================== Interrupt Handler =================== */
+
+void TEST_SPARE_IRQHandler(void)
+{
+    rtos_netbuf_t *nb = rtos_netbuf_alloc_from_isr(&g_pool, PAYLOAD_LEN, RESERVE);
+
+    if (nb != NULL)
+    {
+        g_isr_segs  = rtos_netbuf_count(nb);
+        g_isr_freed = rtos_netbuf_free_from_isr(nb);
+    }
+}
+
+/* =================== Task Implementations =================== */
+
+/*
+ * Driver (priority 3).
+ * Plays a DMA driver: one "transfer" per scatter-gather entry.
+ */
+static void driver_task_func(void *param)
+{
+    (void) param;
+
+    while (1)
+    {
+        const void *slot;
+        if (rtos_queue_receive_peek(g_tx_queue, &slot, RTOS_MAX_DELAY) != RTOS_SUCCESS)
+        {
+            continue;
+        }
+
+        rtos_netbuf_t   *pkt = *(rtos_netbuf_t *const *) slot;
+        rtos_netbuf_sg_t sg[MAX_SG];
+        uint32_t         n   = rtos_netbuf_to_sg(pkt, sg, MAX_SG);
+        uint32_t         len = 0;
+
+        rtos_netbuf_clean_dcache(pkt);
+        for (uint32_t i = 0; i < n; i++)
+        {
+            memcpy(&g_wire[len], sg[i].addr, sg[i].len);
+            len += sg[i].len;
+        }
+
+        g_seen_head = pkt;
+        g_sg_count  = n;
+        g_wire_len  = len;
+        rtos_queue_receive_release(g_tx_queue);
+
+        (void) rtos_netbuf_free(pkt);
+        g_sent++;
+    }
+}
+
+static void check_alloc(void)
+{
+    /* INV-NB1 */
+    rtos_netbuf_t *nb = rtos_netbuf_alloc(&g_pool, PAYLOAD_LEN, RESERVE, 0U);
+    TEST_ASSERT(nb != NULL && rtos_netbuf_count(nb) == 3U, "INV-NB1:SegmentCount");
+    TEST_ASSERT(pool_free() == POOL_SEGS - 3U, "INV-NB1:PoolCharged");
+    TEST_ASSERT(nb->len == SEG_SIZE - RESERVE && nb->next->len == SEG_SIZE && nb->next->next->len == 38U,
+                "INV-NB1:SegmentLengths");
+    TEST_ASSERT(nb->tot_len == PAYLOAD_LEN && tot_len_ok(nb), "INV-NB1:TotLen");
+    TEST_ASSERT(nb->refs == 1U && nb->next->refs == 1U, "INV-NB1:OneRefEach");
+    TEST_ASSERT(((uintptr_t) nb->next->payload & 7U) == 0U, "INV-NB1:DataAligned");
+
+    /* INV-NB2 */
+    uint8_t *payload = nb->payload;
+    uint8_t *hdr     = (uint8_t *) rtos_netbuf_push(nb, HDR_LEN);
+    TEST_ASSERT(hdr == payload - HDR_LEN, "INV-NB2:PushInPlace");
+    TEST_ASSERT(nb->len == SEG_SIZE - RESERVE + HDR_LEN && nb->tot_len == PAYLOAD_LEN + HDR_LEN && tot_len_ok(nb),
+                "INV-NB2:PushLengths");
+    TEST_ASSERT(rtos_netbuf_push(nb, RESERVE - HDR_LEN + 1U) == NULL, "INV-NB2:PushPastRoom");
+    TEST_ASSERT(rtos_netbuf_push(nb, RESERVE - HDR_LEN) != NULL, "INV-NB2:PushAllRoom");
+    TEST_ASSERT(rtos_netbuf_pull(nb, RESERVE) == payload && nb->tot_len == PAYLOAD_LEN, "INV-NB2:Pull");
+    TEST_ASSERT(rtos_netbuf_pull(nb, SEG_SIZE) == NULL, "INV-NB2:PullPastSegment");
+
+    /* INV-NB3 */
+    uint8_t src[PAYLOAD_LEN];
+    uint8_t dst[PAYLOAD_LEN];
+    fill_pattern(src, sizeof(src), 0x20U);
+    memset(dst, 0, sizeof(dst));
+    TEST_ASSERT(rtos_netbuf_copy_in(nb, 0U, src, sizeof(src)) == PAYLOAD_LEN, "INV-NB3:CopyIn");
+    TEST_ASSERT(rtos_netbuf_copy_out(nb, 0U, dst, sizeof(dst)) == PAYLOAD_LEN && check_pattern(dst, PAYLOAD_LEN, 0x20U),
+                "INV-NB3:RoundTrip");
+    TEST_ASSERT(rtos_netbuf_copy_out(nb, 100U, dst, sizeof(dst)) == PAYLOAD_LEN - 100U &&
+                    check_pattern(dst, PAYLOAD_LEN - 100U, (uint8_t) (0x20U + 100U)),
+                "INV-NB3:OffsetAcrossSegments");
+
+    /* INV-NB4 */
+    rtos_netbuf_sg_t sg[MAX_SG];
+    TEST_ASSERT(rtos_netbuf_to_sg(nb, sg, MAX_SG) == 3U, "INV-NB4:EntryPerSegment");
+    TEST_ASSERT(sg[0].addr == nb->payload && sg[0].len == nb->len && sg[1].addr == nb->next->payload &&
+                    sg[2].len == nb->next->next->len,
+                "INV-NB4:EntriesMatchChain");
+    TEST_ASSERT(rtos_netbuf_to_sg(nb, sg, 2U) == 0U, "INV-NB4:TooFewEntries");
+
+    TEST_ASSERT(rtos_netbuf_free(nb) == 3U && pool_free() == POOL_SEGS, "INV-NB1:FreedAll");
+}
+
+static void check_chains(void)
+{
+    /* INV-NB5: one payload behind two headers */
+    rtos_netbuf_t *payload = rtos_netbuf_alloc(&g_pool, 100U, 0U, 0U);
+    rtos_netbuf_t *hdr_a   = rtos_netbuf_alloc(&g_pool, HDR_LEN, RESERVE, 0U);
+    rtos_netbuf_t *hdr_b   = rtos_netbuf_alloc(&g_pool, HDR_LEN, RESERVE, 0U);
+    TEST_ASSERT(payload != NULL && hdr_a != NULL && hdr_b != NULL && pool_free() == POOL_SEGS - 4U,
+                "INV-NB5:Allocated");
+
+    rtos_netbuf_ref(payload);
+    TEST_ASSERT(rtos_netbuf_cat(hdr_a, payload) == RTOS_SUCCESS && rtos_netbuf_cat(hdr_b, payload) == RTOS_SUCCESS,
+                "INV-NB5:Cat");
+    TEST_ASSERT(hdr_a->tot_len == HDR_LEN + 100U && tot_len_ok(hdr_a) && rtos_netbuf_count(hdr_b) == 3U,
+                "INV-NB5:ChainLengths");
+    TEST_ASSERT(payload->refs == 2U, "INV-NB5:SharedRefs");
+
+    TEST_ASSERT(rtos_netbuf_free(hdr_a) == 1U && pool_free() == POOL_SEGS - 3U, "INV-NB5:FirstFreeKeepsPayload");
+    TEST_ASSERT(rtos_netbuf_free(hdr_b) == 3U && pool_free() == POOL_SEGS, "INV-NB5:LastFreeTakesPayload");
+
+    TEST_ASSERT(rtos_netbuf_cat(NULL, payload) == RTOS_ERROR_INVALID_PARAM, "INV-NB5:CatNull");
+
+    /* INV-NB6 */
+    rtos_netbuf_t *hold = rtos_netbuf_alloc(&g_pool, 5U * SEG_SIZE, 0U, 0U);
+    TEST_ASSERT(hold != NULL && pool_free() == POOL_SEGS - 5U, "INV-NB6:Held");
+    TEST_ASSERT(rtos_netbuf_alloc(&g_pool, 4U * SEG_SIZE, 0U, 0U) == NULL, "INV-NB6:TooBig");
+    TEST_ASSERT(pool_free() == POOL_SEGS - 5U, "INV-NB6:NoPartialChain");
+    TEST_ASSERT(rtos_netbuf_alloc(&g_pool, 8U, SEG_SIZE, 0U) == NULL, "INV-NB6:ReserveTooBig");
+    (void) rtos_netbuf_free(hold);
+    TEST_ASSERT(pool_free() == POOL_SEGS, "INV-NB6:Returned");
+}
+
+static void check_isr(void)
+{
+    /* INV-NB7 */
+    NVIC_SetPendingIRQ(TEST_IRQn);
+    __DSB();
+    __ISB();
+    rtos_delay_ms(SETTLE_MS);
+
+    TEST_ASSERT(g_isr_segs == 3U && g_isr_freed == 3U, "INV-NB7:IsrAllocFree");
+    TEST_ASSERT(pool_free() == POOL_SEGS, "INV-NB7:Returned");
+}
+
+static void check_queue(void)
+{
+    /* INV-NB8 */
+    rtos_netbuf_t *pkt = rtos_netbuf_alloc(&g_pool, PAYLOAD_LEN, RESERVE, 0U);
+    uint8_t        src[PAYLOAD_LEN];
+
+    fill_pattern(src, sizeof(src), 0x55U);
+    (void) rtos_netbuf_copy_in(pkt, 0U, src, sizeof(src));
+    fill_pattern((uint8_t *) rtos_netbuf_push(pkt, HDR_LEN), HDR_LEN, 0xA0U);
+
+    void *slot;
+    TEST_ASSERT(rtos_queue_send_acquire(g_tx_queue, &slot, 0U) == RTOS_SUCCESS, "INV-NB8:SlotAcquired");
+    *(rtos_netbuf_t **) slot = pkt;
+    TEST_ASSERT(rtos_queue_send_commit(g_tx_queue) == RTOS_SUCCESS, "INV-NB8:Committed");
+
+    /* The driver outranks us and has sent it by now */
+    TEST_ASSERT(g_sent == 1U && g_seen_head == pkt, "INV-NB8:HeadDelivered");
+    TEST_ASSERT(g_sg_count == 3U && g_wire_len == PAYLOAD_LEN + HDR_LEN, "INV-NB8:SgTransfers");
+    TEST_ASSERT(check_pattern(g_wire, HDR_LEN, 0xA0U) && check_pattern(&g_wire[HDR_LEN], PAYLOAD_LEN, 0x55U),
+                "INV-NB8:WireBytes");
+    TEST_ASSERT(pool_free() == POOL_SEGS, "INV-NB8:DriverFreed");
+}
+
+/*
+ * Controller (priority 2).
+ */
+static void ctrl_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Controller");
+
+    rtos_delay_ms(SETTLE_MS);
+
+    check_alloc();
+    check_chains();
+    check_isr();
+    check_queue();
+
+    test_log_task("END", "Controller");
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+/*
+ * Monitor task (priority 1).
+ * Emits the final PASS/FAIL verdict.
+ */
+static void monitor_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Monitor");
+
+    while (!g_test_complete)
+    {
+        rtos_delay_ms(MONITOR_POLL_MS);
+    }
+
+    /* Final verdict */
+    TEST_EMIT_VERDICT();
+
+    test_log_task("END", "Monitor");
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+/* =================== Timer Callbacks =================== */
+
+static void startup_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    g_test_started = true;
+    test_log_framework("BEGIN", "NetbufState");
+    rtos_timer_handle_t *p = (rtos_timer_handle_t *) param;
+    rtos_timer_start(*p);
+}
+
+static void test_timeout_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_complete = true;
+    test_log_framework("TIMEOUT", "NetbufState");
+}
+
+/* =================== Main =================== */
+
+__attribute__((__noreturn__)) int main(void)
+{
+    rtos_status_t       status;
+    rtos_timer_handle_t startup_timer;
+
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_ALL);
+
+    log_info("Chained Packet Buffer Test");
+    log_info("Priorities: Driver=%u Ctrl=%u Mon=%u", TASK_DRIVER_PRIORITY, TASK_CTRL_PRIORITY, TASK_MON_PRIORITY);
+    log_info("Invariants: NB1(alloc) NB2(push_pull) NB3(copy) NB4(sg) NB5(cat_share) NB6(no_partial) NB7(isr) "
+             "NB8(queue)");
+
+    status = rtos_init();
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("RTOS init failed: %d", status);
+        indicate_system_failure();
+    }
+
+    if (rtos_netbuf_pool_init(&g_pool, g_pool_storage, SEG_SIZE, POOL_SEGS) != RTOS_SUCCESS ||
+        rtos_queue_create_static(&g_tx_queue, &g_tx_queue_cb, g_tx_storage, QUEUE_LENGTH, sizeof(rtos_netbuf_t *)) !=
+            RTOS_SUCCESS)
+    {
+        log_error("Netbuf setup failed");
+        indicate_system_failure();
+    }
+
+    NVIC_SetPriority(TEST_IRQn, TEST_IRQ_PRIO);
+    NVIC_EnableIRQ(TEST_IRQn);
+
+    status = test_create_startup_timer(startup_timer_callback, &g_test_timer, &startup_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Startup timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_timer_create("TestTimer", TEST_DURATION_MS, RTOS_TIMER_ONE_SHOT, test_timeout_callback, NULL,
+                               &g_test_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Test timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t handle;
+    if (rtos_task_create(driver_task_func, "Driver", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_DRIVER_PRIORITY,
+                         &handle) != RTOS_SUCCESS ||
+        rtos_task_create(ctrl_task_func, "Controller", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_CTRL_PRIORITY,
+                         &handle) != RTOS_SUCCESS ||
+        rtos_task_create(monitor_task_func, "Monitor", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_MON_PRIORITY,
+                         &handle) != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t flush_handle;
+    test_create_log_flush_task(&flush_handle);
+
+    log_info("Starting scheduler...");
+    status = rtos_start_scheduler();
+
+    indicate_system_failure();
+}
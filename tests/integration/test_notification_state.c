@@ -7,8 +7,9 @@
 
 #include "VRTOS.h"
 #include "config.h"
+#include "device.h" // IWYU pragma: keep
 #include "hardware_env.h"
-#include "stm32f4xx_hal.h" // IWYU pragma: keep
+#include "rtos_port.h"
 #include "task.h"
 #include "test_common.h"
 #include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
@@ -36,6 +37,8 @@
  * INV-N5  notify_give / notify_take works as counting semaphore
  * INV-N6  Timed-out wait returns RTOS_NOTIFY_ERR_TIMEOUT
  * INV-N7  exit_clear_bits applied after value is read
+ * INV-N8  notify_give_from_isr() (TEST_IRQn pended by the Notifier): two gives in
+ *         one handler wake Waiter with a single yield at ISR exit
  */
 
 /* =================== Test Parameters =================== */
@@ -51,6 +54,9 @@
 #define TIMEOUT_TEST_MS  (30U)
 #define TEST_DURATION_MS (5000U)
 
+#define TEST_IRQn     TEST_SPARE_IRQn
+#define TEST_IRQ_PRIO (14U) /* Below the kernel BASEPRI threshold */
+
 /* Test data — notification values and expected results */
 #define TEST_SET_BITS_VALUE  (0x0FU)       /**< INV-N2: bits to OR in */
 #define TEST_INCREMENT_COUNT (3U)          /**< INV-N3: number of increments */
@@ -58,6 +64,7 @@
 #define TEST_GIVE_COUNT      (3U)          /**< INV-N5: number of give/take rounds */
 #define TEST_EXIT_SEND_BITS  (0x07U)       /**< INV-N7: bits to set (bits 0,1,2) */
 #define TEST_EXIT_CLEAR_MASK (0x01U)       /**< INV-N7: bit 0 cleared on exit */
+#define TEST_ISR_GIVE_COUNT  (2U)          /**< INV-N8: gives per interrupt */
 
 /* TEST_ASSERT, ASSERT_STATE, g_fail_count are in test_common.h */
 
@@ -81,6 +88,27 @@ static volatile uint32_t g_received_value = 0;
 
 static rtos_timer_handle_t g_test_timer;
 
+static volatile bool g_isr_woken = false;
+
+/* =================== Interrupt Handler =================== */
+
+void TEST_SPARE_IRQHandler(void)
+{
+    bool woken = false;
+
+    /* Both gives are batched into the one yield below */
+    for (uint32_t i = 0; i < TEST_ISR_GIVE_COUNT; i++)
+    {
+        rtos_task_notify_give_from_isr(g_handle_waiter, &woken);
+    }
+    g_isr_woken = woken;
+
+    if (woken)
+    {
+        rtos_port_yield();
+    }
+}
+
 /* =================== Task Implementations =================== */
 
 /*
@@ -179,6 +207,21 @@ static void waiter_task_func(void *param)
         g_waiter_done    = 1;
     }
 
+    /* --- Phase 7: INV-N8 (give from ISR) — phase 6 is Notifier-only --- */
+    while (g_phase < 7 && !g_test_complete)
+    {
+        rtos_delay_ms(POLL_MS);
+    }
+    g_waiter_done = 0;
+
+    {
+        uint32_t val = 0;
+        /* Entry clear drops the bits phase 5 left behind */
+        rtos_task_notify_wait(RTOS_NOTIFY_CLEAR_ALL, RTOS_NOTIFY_CLEAR_ALL, &val, RTOS_NOTIFY_MAX_WAIT);
+        g_received_value = val;
+        g_waiter_done    = 1;
+    }
+
     test_log_task("END", "Waiter");
     while (1)
     {
@@ -323,6 +366,26 @@ static void notifier_task_func(void *param)
     TEST_ASSERT(s == RTOS_NOTIFY_ERR_TIMEOUT, "INV-N6:TimeoutReturnCode");
     TEST_ASSERT(rtos_task_get_state(g_handle_notifier) != RTOS_TASK_STATE_BLOCKED, "INV-N6:NotBlockedAfterTimeout");
 
+    /* =========================================================
+     * Phase 7: INV-N8 — give from ISR
+     *
+     * The first give unblocks Waiter, the second only increments;
+     * Waiter outranks us, so it must have run by the time the
+     * handler returns.
+     * ========================================================= */
+    g_phase = 7;
+    rtos_delay_ms(SETTLE_MS);
+
+    ASSERT_STATE(g_handle_waiter, RTOS_TASK_STATE_BLOCKED, "INV-N8:WaiterBlocked");
+
+    NVIC_SetPendingIRQ(TEST_IRQn);
+    __DSB();
+    __ISB();
+
+    TEST_ASSERT(g_isr_woken, "INV-N8:WokenSetOnWake");
+    TEST_ASSERT(g_waiter_done == 1, "INV-N8:WaiterRanAtIsrExit");
+    TEST_ASSERT(g_received_value == TEST_ISR_GIVE_COUNT, "INV-N8:BothGivesCounted");
+
     test_log_task("END", "Notifier");
     while (1)
     {
@@ -388,7 +451,8 @@ __attribute__((__noreturn__)) int main(void)
     log_info("Notification State & Action Invariant Test");
     log_info("Priorities: Notifier=%u Waiter=%u Mon=%u", TASK_NOTIFIER_PRIORITY, TASK_WAITER_PRIORITY,
              TASK_MON_PRIORITY);
-    log_info("Invariants: N1(block) N2(set_bits) N3(increment) N4(overwrite) N5(give/take) N6(timeout) N7(exit_clear)");
+    log_info("Invariants: N1(block) N2(set_bits) N3(increment) N4(overwrite) N5(give/take) N6(timeout)");
+    log_info("            N7(exit_clear) N8(isr_give)");
 
     status = rtos_init();
     if (status != RTOS_SUCCESS)
@@ -438,6 +502,9 @@ __attribute__((__noreturn__)) int main(void)
     rtos_task_handle_t flush_handle;
     test_create_log_flush_task(&flush_handle);
 
+    NVIC_SetPriority(TEST_IRQn, TEST_IRQ_PRIO);
+    NVIC_EnableIRQ(TEST_IRQn);
+
     log_info("Starting scheduler...");
     status = rtos_start_scheduler();
 
@@ -0,0 +1,365 @@
+/*******************************************************************************
+ * File: tests/integration/test_notify_indexed_state.c
+ * Description: Indexed Task Notification - Slot Isolation Invariant Test
+ * Author: Student
+ * Date: 2025
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "config.h"
+#include "device.h" // IWYU pragma: keep
+#include "hardware_env.h"
+#include "rtos_port.h"
+#include "task.h"
+#include "test_common.h"
+#include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
+#include "timer.h"
+#include "uart_tx.h"
+
+/**
+ * @file test_notify_indexed_state.c
+ * @brief Indexed Task Notification Slot Isolation Test
+ *
+ * Built with RTOS_TASK_NOTIFY_ARRAY_ENTRIES=3 (see platformio.ini).
+ *
+ * SCENARIO
+ * --------
+ * Three tasks plus log flush:
+ *
+ *   Controller (priority 2) — notifies Waiter's slots, checks its own slots
+ *   Waiter     (priority 4) — blocks on one slot at a time
+ *   Monitor    (priority 1) — emits final verdict
+ *
+ * INVARIANTS
+ * ----------
+ * INV-NI1  A notification on slot 1 leaves a task blocked on slot 0 BLOCKED
+ * INV-NI2  A notification on slot 0 wakes it with slot 0's value only
+ * INV-NI3  The slot 1 notification stays pending for a later wait on slot 1
+ * INV-NI4  index >= RTOS_TASK_NOTIFY_ARRAY_ENTRIES -> RTOS_NOTIFY_ERR_INVALID
+ * INV-NI5  give/take counts are kept per slot
+ * INV-NI6  give_indexed_from_isr() (TEST_IRQn) wakes a task blocked on that slot
+ */
+
+/* =================== Test Parameters =================== */
+
+#define TASK_CTRL_PRIORITY   (2U)
+#define TASK_WAITER_PRIORITY (4U)
+#define TASK_MON_PRIORITY    (1U)
+
+#define SETTLE_MS        (50U)
+#define POLL_MS          (5U)
+#define MONITOR_POLL_MS  (20U)
+#define IDLE_SPIN_MS     (1000U)
+#define TEST_DURATION_MS (3000U)
+
+#define TEST_IRQn     TEST_SPARE_IRQn
+#define TEST_IRQ_PRIO (14U) /* Below the kernel BASEPRI threshold */
+
+#define SLOT_WAKE  (0U) /**< Waiter blocks here in phase 1 */
+#define SLOT_OTHER (1U) /**< Notified while Waiter is blocked on SLOT_WAKE */
+#define SLOT_ISR   (2U) /**< Given from the interrupt in phase 2 */
+
+#define TEST_WAKE_VALUE  (0x5AU)
+#define TEST_OTHER_VALUE (0xA5U)
+#define TEST_GIVE_COUNT  (2U) /**< INV-NI5: gives on SLOT_ISR of the Controller */
+
+/* TEST_ASSERT, ASSERT_STATE, g_fail_count are in test_common.h */
+
+/* =================== Shared State =================== */
+
+static volatile bool g_test_started  = false;
+static volatile bool g_test_complete = false;
+
+static rtos_task_handle_t g_handle_ctrl   = NULL;
+static rtos_task_handle_t g_handle_waiter = NULL;
+
+/*
+ * Synchronisation flags.
+ * volatile uint32_t to avoid torn reads on Cortex-M.
+ */
+static volatile uint32_t g_phase       = 0;
+static volatile uint32_t g_waiter_done = 0;
+
+static volatile uint32_t             g_wake_value   = 0;
+static volatile uint32_t             g_other_value  = 0;
+static volatile rtos_notify_status_t g_other_status = RTOS_NOTIFY_ERR_INVALID;
+
+static volatile bool g_isr_woken = false;
+
+static rtos_timer_handle_t g_test_timer;
+
+/* =================== Interrupt Handler =================== */
+
+void TEST_SPARE_IRQHandler(void)
+{
+    bool woken = false;
+
+    rtos_task_notify_give_indexed_from_isr(g_handle_waiter, SLOT_ISR, &woken);
+    g_isr_woken = woken;
+
+    if (woken)
+    {
+        rtos_port_yield();
+    }
+}
+
+/* =================== Task Implementations =================== */
+
+/*
+ * Waiter (priority 4).
+ *
+ * Phase 1: blocks on SLOT_WAKE, then drains SLOT_OTHER without waiting.
+ * Phase 2: blocks on SLOT_ISR until the interrupt gives it.
+ */
+static void waiter_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Waiter");
+
+    /* --- Phase 1: INV-NI1..NI3 --- */
+    while (g_phase < 1 && !g_test_complete)
+    {
+        rtos_delay_ms(POLL_MS);
+    }
+
+    {
+        uint32_t val = 0;
+        rtos_task_notify_wait_indexed(SLOT_WAKE, RTOS_NOTIFY_CLEAR_NONE, RTOS_NOTIFY_CLEAR_ALL, &val,
+                                      RTOS_NOTIFY_MAX_WAIT);
+        g_wake_value = val;
+
+        val            = 0;
+        g_other_status = rtos_task_notify_wait_indexed(SLOT_OTHER, RTOS_NOTIFY_CLEAR_NONE, RTOS_NOTIFY_CLEAR_ALL,
+                                                       &val, RTOS_NOTIFY_NO_WAIT);
+        g_other_value  = val;
+        g_waiter_done  = 1;
+    }
+
+    /* --- Phase 2: INV-NI6 --- */
+    while (g_phase < 2 && !g_test_complete)
+    {
+        rtos_delay_ms(POLL_MS);
+    }
+    g_waiter_done = 0;
+
+    rtos_task_notify_take_indexed(SLOT_ISR, true, RTOS_NOTIFY_MAX_WAIT);
+    g_waiter_done = 1;
+
+    test_log_task("END", "Waiter");
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+/*
+ * Controller (priority 2).
+ *
+ * Drives Waiter through both phases and checks the invariants; INV-NI4 and
+ * INV-NI5 run on its own slots between the phases.
+ */
+static void ctrl_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Controller");
+
+    /* =========================================================
+     * Phase 1: INV-NI1..NI3 — slot isolation
+     * ========================================================= */
+    g_phase = 1;
+    rtos_delay_ms(SETTLE_MS);
+
+    ASSERT_STATE(g_handle_waiter, RTOS_TASK_STATE_BLOCKED, "INV-NI1:WaiterBlocked");
+
+    /* INV-NI1: a different slot must not wake it */
+    rtos_task_notify_indexed(g_handle_waiter, SLOT_OTHER, TEST_OTHER_VALUE, RTOS_NOTIFY_ACTION_SET_BITS);
+    ASSERT_STATE(g_handle_waiter, RTOS_TASK_STATE_BLOCKED, "INV-NI1:OtherSlotNoWake");
+
+    /* INV-NI2: its own slot does; Waiter preempts us here */
+    rtos_task_notify_indexed(g_handle_waiter, SLOT_WAKE, TEST_WAKE_VALUE, RTOS_NOTIFY_ACTION_OVERWRITE);
+
+    while (!g_waiter_done)
+    {
+        rtos_delay_ms(POLL_MS);
+    }
+
+    TEST_ASSERT(g_wake_value == TEST_WAKE_VALUE, "INV-NI2:WakeSlotValue");
+
+    /* INV-NI3: the slot 1 notification was kept for the later wait */
+    TEST_ASSERT(g_other_status == RTOS_NOTIFY_OK, "INV-NI3:OtherSlotPending");
+    TEST_ASSERT(g_other_value == TEST_OTHER_VALUE, "INV-NI3:OtherSlotValue");
+
+    /* =========================================================
+     * INV-NI4 — out-of-range index
+     * ========================================================= */
+    const uint8_t bad_index = (uint8_t) RTOS_TASK_NOTIFY_ARRAY_ENTRIES;
+
+    TEST_ASSERT(rtos_task_notify_indexed(g_handle_waiter, bad_index, 0, RTOS_NOTIFY_ACTION_NONE) ==
+                    RTOS_NOTIFY_ERR_INVALID,
+                "INV-NI4:NotifyBadIndex");
+    TEST_ASSERT(rtos_task_notify_wait_indexed(bad_index, 0, 0, NULL, RTOS_NOTIFY_NO_WAIT) == RTOS_NOTIFY_ERR_INVALID,
+                "INV-NI4:WaitBadIndex");
+    TEST_ASSERT(rtos_task_notify_take_indexed(bad_index, true, RTOS_NOTIFY_NO_WAIT) == RTOS_NOTIFY_ERR_INVALID,
+                "INV-NI4:TakeBadIndex");
+
+    /* =========================================================
+     * INV-NI5 — per-slot counting on our own slots
+     * ========================================================= */
+    for (uint32_t i = 0; i < TEST_GIVE_COUNT; i++)
+    {
+        rtos_task_notify_give_indexed(g_handle_ctrl, SLOT_ISR);
+    }
+    rtos_task_notify_give_indexed(g_handle_ctrl, SLOT_WAKE);
+
+    for (uint32_t i = 0; i < TEST_GIVE_COUNT; i++)
+    {
+        TEST_ASSERT(rtos_task_notify_take_indexed(SLOT_ISR, false, RTOS_NOTIFY_NO_WAIT) == RTOS_NOTIFY_OK,
+                    "INV-NI5:TakeGiven");
+    }
+    TEST_ASSERT(rtos_task_notify_take_indexed(SLOT_ISR, false, RTOS_NOTIFY_NO_WAIT) == RTOS_NOTIFY_ERR_TIMEOUT,
+                "INV-NI5:SlotDrained");
+    TEST_ASSERT(rtos_task_notify_take_indexed(SLOT_OTHER, false, RTOS_NOTIFY_NO_WAIT) == RTOS_NOTIFY_ERR_TIMEOUT,
+                "INV-NI5:UntouchedSlotEmpty");
+    TEST_ASSERT(rtos_task_notify_take(true, RTOS_NOTIFY_NO_WAIT) == RTOS_NOTIFY_OK, "INV-NI5:DefaultSlotKept");
+
+    /* =========================================================
+     * Phase 2: INV-NI6 — give from ISR on SLOT_ISR
+     * ========================================================= */
+    g_phase = 2;
+    rtos_delay_ms(SETTLE_MS);
+
+    ASSERT_STATE(g_handle_waiter, RTOS_TASK_STATE_BLOCKED, "INV-NI6:WaiterBlocked");
+
+    NVIC_SetPendingIRQ(TEST_IRQn);
+    __DSB();
+    __ISB();
+
+    TEST_ASSERT(g_isr_woken, "INV-NI6:WokenSetOnWake");
+    TEST_ASSERT(g_waiter_done == 1, "INV-NI6:WaiterRanAtIsrExit");
+
+    test_log_task("END", "Controller");
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+/*
+ * Monitor task (priority 1).
+ * Emits the final PASS/FAIL verdict.
+ */
+static void monitor_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Monitor");
+
+    while (!g_test_complete)
+    {
+        rtos_delay_ms(MONITOR_POLL_MS);
+    }
+
+    /* Final verdict */
+    TEST_EMIT_VERDICT();
+
+    test_log_task("END", "Monitor");
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+/* =================== Timer Callbacks =================== */
+
+static void startup_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    g_test_started = true;
+    test_log_framework("BEGIN", "NotifyIndexedState");
+    rtos_timer_handle_t *p = (rtos_timer_handle_t *) param;
+    rtos_timer_start(*p);
+}
+
+static void test_timeout_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_complete = true;
+    test_log_framework("TIMEOUT", "NotifyIndexedState");
+}
+
+/* =================== Main =================== */
+
+__attribute__((__noreturn__)) int main(void)
+{
+    rtos_status_t       status;
+    rtos_timer_handle_t startup_timer;
+
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_ALL);
+
+    log_info("Indexed Notification Slot Isolation Test (%u slots)", (unsigned) RTOS_TASK_NOTIFY_ARRAY_ENTRIES);
+    log_info("Priorities: Ctrl=%u Waiter=%u Mon=%u", TASK_CTRL_PRIORITY, TASK_WAITER_PRIORITY, TASK_MON_PRIORITY);
+    log_info("Invariants: NI1(no_cross_wake) NI2(wake_value) NI3(pending_kept) NI4(bad_index) NI5(counts)");
+    log_info("            NI6(isr_give)");
+
+    status = rtos_init();
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("RTOS init failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = test_create_startup_timer(startup_timer_callback, &g_test_timer, &startup_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Startup timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_timer_create("TestTimer", TEST_DURATION_MS, RTOS_TIMER_ONE_SHOT, test_timeout_callback, NULL,
+                               &g_test_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Test timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_task_create(ctrl_task_func, "Ctrl", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_CTRL_PRIORITY,
+                              &g_handle_ctrl);
+    if (status != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    status = rtos_task_create(waiter_task_func, "Wait", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_WAITER_PRIORITY,
+                              &g_handle_waiter);
+    if (status != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t monitor_handle;
+    status = rtos_task_create(monitor_task_func, "Mon", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_MON_PRIORITY,
+                              &monitor_handle);
+    if (status != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t flush_handle;
+    test_create_log_flush_task(&flush_handle);
+
+    NVIC_SetPriority(TEST_IRQn, TEST_IRQ_PRIO);
+    NVIC_EnableIRQ(TEST_IRQn);
+
+    log_info("Starting scheduler...");
+    status = rtos_start_scheduler();
+
+    indicate_system_failure();
+}
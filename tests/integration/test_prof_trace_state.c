@@ -0,0 +1,360 @@
+/*******************************************************************************
+ * File: tests/integration/test_prof_trace_state.c
+ * Description: ProfTrace Scheduling Timeline Events - State Invariant Test
+ * Author: Student
+ * Date: 2025
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "config.h"
+#include "device.h" // IWYU pragma: keep
+#include "hardware_env.h"
+#include "prof_trace.h"
+#include "rtos_port.h"
+#include "semaphore.h"
+#include "task.h"
+#include "task_priv.h"
+#include "test_common.h"
+#include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
+#include "timer.h"
+#include "uart_tx.h"
+
+/**
+ * @file test_prof_trace_state.c
+ * @brief ProfTrace Timeline Test
+ *
+ * SCENARIO
+ * --------
+ * Built with RTOS_PROF_TRACE=1. The controller empties the trace buffer,
+ * wakes the worker through a semaphore a few times, sleeps across some
+ * ticks, then drains the capture and checks the timeline it describes:
+ *
+ *   Worker     (priority 3) — waits on the semaphore, counts each wake
+ *   Controller (priority 2) — signals, sleeps, checks invariants
+ *   Monitor    (priority 1) — emits final verdict
+ *
+ * INVARIANTS
+ * ----------
+ * INV-PT1  Every SWITCH_OUT is directly followed by the SWITCH_IN of a
+ *          different task, and the task switched in is the next one out
+ * INV-PT2  A semaphore wait emits BLOCK for the waiter before it is
+ *          switched out; each signal emits its UNBLOCK before its SWITCH_IN
+ * INV-PT3  An expired delay emits UNBLOCK before the sleeper is switched in
+ * INV-PT4  SysTick emits ISR_ENTER / ISR_EXIT pairs, unnested, carrying its
+ *          exception number
+ * INV-PT5  Timestamps never run backwards
+ */
+
+/* =================== Test Parameters =================== */
+
+#define TASK_WORKER_PRIORITY (3U)
+#define TASK_CTRL_PRIORITY   (2U)
+#define TASK_MON_PRIORITY    (1U)
+
+#define SETTLE_MS        (20U)
+#define MONITOR_POLL_MS  (20U)
+#define IDLE_SPIN_MS     (1000U)
+#define TEST_DURATION_MS (1000U)
+
+#define SIGNALS     (4U)
+#define SLEEP_MS    (3U)
+#define MAX_RECORDS (PROF_TRACE_BUFFER_SIZE / sizeof(prof_record_t))
+#define EXC_SYSTICK (15U)
+
+RTOS_STATIC_ASSERT(RTOS_PROF_TRACE, "test_prof_trace_state needs -D RTOS_PROF_TRACE=1");
+
+/* TEST_ASSERT, ASSERT_STATE, g_fail_count are in test_common.h */
+
+/* =================== Shared State =================== */
+
+static volatile bool g_test_started  = false;
+static volatile bool g_test_complete = false;
+
+static rtos_timer_handle_t g_test_timer;
+static rtos_task_handle_t  g_worker;
+static rtos_task_handle_t  g_controller;
+static rtos_semaphore_t    g_sem;
+
+static volatile uint32_t g_wakes = 0;
+
+static prof_record_t g_records[MAX_RECORDS];
+
+/* =================== Task Implementations =================== */
+
+/*
+ * Worker (priority 3).
+ * Every wait is a sync block; every signal a preemption of the controller.
+ */
+static void worker_task_func(void *param)
+{
+    (void) param;
+
+    for (;;)
+    {
+        (void) rtos_semaphore_wait(&g_sem, RTOS_MAX_DELAY);
+        g_wakes++;
+    }
+}
+
+static uint32_t drain_all(void)
+{
+    uint32_t count = 0;
+    uint32_t n;
+
+    while (count < MAX_RECORDS && (n = prof_trace_drain(&g_records[count], MAX_RECORDS - count)) > 0U)
+    {
+        count += n;
+    }
+    return count;
+}
+
+static void check_switches(uint32_t count)
+{
+    /* INV-PT1 */
+    int32_t last_in = -1;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (g_records[i].event_id != PEVT_TASK_SWITCH_OUT)
+        {
+            continue;
+        }
+
+        TEST_ASSERT(i + 1U < count && g_records[i + 1U].event_id == PEVT_TASK_SWITCH_IN, "INV-PT1:OutThenIn");
+        TEST_ASSERT(i + 1U >= count || g_records[i + 1U].entity_id != g_records[i].entity_id, "INV-PT1:OtherTask");
+        TEST_ASSERT(last_in < 0 || (uint8_t) last_in == g_records[i].entity_id, "INV-PT1:InIsNextOut");
+        if (i + 1U < count)
+        {
+            last_in = g_records[i + 1U].entity_id;
+        }
+    }
+}
+
+static void check_block_unblock(uint32_t count)
+{
+    uint8_t worker = g_worker->task_id;
+    uint8_t ctrl   = g_controller->task_id;
+
+    /* INV-PT2 */
+    uint32_t blocks   = 0;
+    uint32_t wakes    = 0;
+    bool     blocking = false;
+    bool     ready    = false;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (g_records[i].entity_id != worker || g_records[i].event_id == PEVT_ISR_ENTER ||
+            g_records[i].event_id == PEVT_ISR_EXIT)
+        {
+            continue;
+        }
+        TEST_ASSERT(!blocking || g_records[i].event_id == PEVT_TASK_SWITCH_OUT, "INV-PT2:BlockThenOut");
+        blocking = false;
+
+        if (g_records[i].event_id == PEVT_TASK_BLOCK)
+        {
+            blocks++;
+            blocking = true;
+        }
+        else if (g_records[i].event_id == PEVT_TASK_UNBLOCK)
+        {
+            wakes++;
+            ready = true;
+        }
+        else if (g_records[i].event_id == PEVT_TASK_SWITCH_IN)
+        {
+            TEST_ASSERT(ready, "INV-PT2:UnblockBeforeIn");
+            ready = false;
+        }
+    }
+    TEST_ASSERT(blocks >= SIGNALS, "INV-PT2:BlockPerWait");
+    TEST_ASSERT(wakes >= SIGNALS, "INV-PT2:UnblockPerSignal");
+
+    /* INV-PT3: the controller's own sleep */
+    bool woke = false;
+    bool back = false;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (g_records[i].entity_id == ctrl && g_records[i].event_id == PEVT_TASK_UNBLOCK)
+        {
+            woke = true;
+        }
+        else if (woke && g_records[i].entity_id == ctrl && g_records[i].event_id == PEVT_TASK_SWITCH_IN)
+        {
+            back = true;
+        }
+    }
+    TEST_ASSERT(woke && back, "INV-PT3:DelayWakeThenIn");
+}
+
+static void check_isrs(uint32_t count)
+{
+    /* INV-PT4 */
+    uint32_t entries = 0;
+    bool     inside  = false;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (g_records[i].event_id == PEVT_ISR_ENTER)
+        {
+            TEST_ASSERT(!inside, "INV-PT4:Unnested");
+            TEST_ASSERT(g_records[i].entity_id == EXC_SYSTICK, "INV-PT4:ExceptionNumber");
+            inside = true;
+            entries++;
+        }
+        else if (g_records[i].event_id == PEVT_ISR_EXIT)
+        {
+            TEST_ASSERT(inside || entries == 0U, "INV-PT4:Paired");
+            inside = false;
+        }
+    }
+    TEST_ASSERT(entries >= SLEEP_MS - 1U, "INV-PT4:TickTraced");
+}
+
+static void check_timestamps(uint32_t count)
+{
+    /* INV-PT5 */
+    for (uint32_t i = 1; i < count; i++)
+    {
+        TEST_ASSERT((int32_t) (g_records[i].cyccnt - g_records[i - 1U].cyccnt) >= 0, "INV-PT5:Monotonic");
+    }
+}
+
+/*
+ * Controller (priority 2).
+ */
+static void ctrl_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Controller");
+
+    rtos_delay_ms(SETTLE_MS);
+
+    /* Start from an empty buffer */
+    (void) drain_all();
+
+    for (uint32_t i = 0; i < SIGNALS; i++)
+    {
+        (void) rtos_semaphore_signal(&g_sem);
+    }
+    rtos_delay_ms(SLEEP_MS);
+
+    uint32_t count = drain_all();
+    TEST_ASSERT(count > 0U && count < MAX_RECORDS, "INV-PT1:Captured");
+    TEST_ASSERT(g_wakes == SIGNALS, "INV-PT2:WorkerRan");
+
+    check_switches(count);
+    check_block_unblock(count);
+    check_isrs(count);
+    check_timestamps(count);
+
+    test_log_task("END", "Controller");
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+/*
+ * Monitor task (priority 1).
+ * Emits the final PASS/FAIL verdict.
+ */
+static void monitor_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Monitor");
+
+    while (!g_test_complete)
+    {
+        rtos_delay_ms(MONITOR_POLL_MS);
+    }
+
+    /* Final verdict */
+    TEST_EMIT_VERDICT();
+
+    test_log_task("END", "Monitor");
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+/* =================== Timer Callbacks =================== */
+
+static void startup_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    g_test_started = true;
+    test_log_framework("BEGIN", "ProfTraceState");
+    rtos_timer_handle_t *p = (rtos_timer_handle_t *) param;
+    rtos_timer_start(*p);
+}
+
+static void test_timeout_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_complete = true;
+    test_log_framework("TIMEOUT", "ProfTraceState");
+}
+
+/* =================== Main =================== */
+
+__attribute__((__noreturn__)) int main(void)
+{
+    rtos_status_t       status;
+    rtos_timer_handle_t startup_timer;
+    rtos_task_handle_t  handle;
+
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_ALL);
+
+    log_info("ProfTrace Timeline Test");
+    log_info("Priorities: Worker=%u Ctrl=%u Mon=%u", TASK_WORKER_PRIORITY, TASK_CTRL_PRIORITY, TASK_MON_PRIORITY);
+    log_info("Invariants: PT1(switch) PT2(sync) PT3(delay) PT4(isr) PT5(time)");
+
+    status = rtos_init();
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("RTOS init failed: %d", status);
+        indicate_system_failure();
+    }
+
+    (void) rtos_semaphore_init(&g_sem, 0U, SIGNALS);
+
+    status = test_create_startup_timer(startup_timer_callback, &g_test_timer, &startup_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Startup timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_timer_create("TestTimer", TEST_DURATION_MS, RTOS_TIMER_ONE_SHOT, test_timeout_callback, NULL,
+                               &g_test_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Test timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    if (rtos_task_create(worker_task_func, "Worker", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_WORKER_PRIORITY,
+                         &g_worker) != RTOS_SUCCESS ||
+        rtos_task_create(ctrl_task_func, "Controller", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_CTRL_PRIORITY,
+                         &g_controller) != RTOS_SUCCESS ||
+        rtos_task_create(monitor_task_func, "Monitor", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_MON_PRIORITY,
+                         &handle) != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t flush_handle;
+    test_create_log_flush_task(&flush_handle);
+
+    log_info("Starting scheduler...");
+    status = rtos_start_scheduler();
+
+    indicate_system_failure();
+}
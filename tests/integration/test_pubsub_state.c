@@ -0,0 +1,478 @@
+/*******************************************************************************
+ * File: tests/integration/test_pubsub_state.c
+ * Description: Publish/Subscribe Bus - Zero-Copy Fan-Out & Refcount Invariant Test
+ * Author: Student
+ * Date: 2025
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "config.h"
+#include "device.h" // IWYU pragma: keep
+#include "hardware_env.h"
+#include "mempool.h"
+#include "pubsub.h"
+#include "rtos_port.h"
+#include "task.h"
+#include "test_common.h"
+#include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
+#include "timer.h"
+#include "uart_tx.h"
+
+#include <string.h>
+
+/**
+ * @file test_pubsub_state.c
+ * @brief Publish/Subscribe Bus Test
+ *
+ * SCENARIO
+ * --------
+ * Four tasks plus log flush:
+ *
+ *   ConsumerA  (priority 3) — subscriber A: FRAME and STATUS
+ *   ConsumerB  (priority 3) — subscriber B: FRAME
+ *   Controller (priority 2) — publishes, drains subscriber C (FRAME) and
+ *                             D (FRAME, short queue), checks invariants
+ *   Monitor    (priority 1) — emits final verdict
+ *
+ * Consumers preempt the Controller at the push to their queue, so they
+ * release a message while the publisher is still fanning it out.
+ *
+ * INVARIANTS
+ * ----------
+ * INV-PS1  Every subscriber of a topic receives the published pointer
+ *          itself, with the payload as written; others receive nothing
+ * INV-PS2  The block stays allocated until the last subscriber releases
+ *          it, then returns to the pool
+ * INV-PS3  A message published to a topic nobody subscribes to is freed
+ *          by the publish
+ * INV-PS4  A full subscriber queue drops the message (RTOS_ERROR_FULL,
+ *          dropped counted) while the others still get it, in order
+ * INV-PS5  After unsubscribe a subscriber gets no new messages
+ * INV-PS6  An ISR allocates and publishes with the _from_isr calls
+ * INV-PS7  Bad topics and a message of another bus are rejected
+ */
+
+/* =================== Test Parameters =================== */
+
+#define TASK_CONSUMER_PRIORITY (3U)
+#define TASK_CTRL_PRIORITY     (2U)
+#define TASK_MON_PRIORITY      (1U)
+
+#define SETTLE_MS        (20U)
+#define MONITOR_POLL_MS  (20U)
+#define IDLE_SPIN_MS     (1000U)
+#define TEST_DURATION_MS (2000U)
+
+#define TEST_IRQn     TEST_SPARE_IRQn
+#define TEST_IRQ_PRIO (14U) /* Below the kernel BASEPRI threshold */
+
+#define FRAME_BYTES  (256U)
+#define POOL_BLOCKS  (6U)
+#define QUEUE_LENGTH (4U)
+#define SHORT_LENGTH (2U)
+#define BURST        (3U)
+
+#define TOPIC_FRAME  (3U)
+#define TOPIC_STATUS (7U)
+#define TOPIC_IDLE   (9U)
+
+/* TEST_ASSERT, ASSERT_STATE, g_fail_count are in test_common.h */
+
+/* =================== Shared State =================== */
+
+typedef struct
+{
+    uint32_t seq;
+    uint8_t  bytes[FRAME_BYTES - sizeof(uint32_t)];
+} frame_t;
+
+static volatile bool g_test_started  = false;
+static volatile bool g_test_complete = false;
+
+static rtos_timer_handle_t g_test_timer;
+
+static rtos_mempool_t g_pool;
+static uint64_t       g_pool_storage[RTOS_MEMPOOL_BUFFER_SIZE(RTOS_BUS_BLOCK_SIZE(FRAME_BYTES), POOL_BLOCKS) / 8U];
+static rtos_bus_t     g_bus;
+
+static rtos_mempool_t g_other_pool;
+static uint64_t       g_other_storage[RTOS_MEMPOOL_BUFFER_SIZE(RTOS_BUS_BLOCK_SIZE(8U), 1U) / 8U];
+static rtos_bus_t     g_other_bus;
+
+static rtos_bus_sub_t  g_sub[4]; /* A, B, C, D */
+static rtos_bus_msg_t *g_sub_storage[3][QUEUE_LENGTH];
+static rtos_bus_msg_t *g_short_storage[SHORT_LENGTH];
+
+/* Per consumer task (A, B) */
+static const rtos_bus_msg_t *volatile g_last[2];
+static volatile uint32_t g_frames[2];
+static volatile uint32_t g_status[2];
+static volatile uint32_t g_isr_frames[2];
+static volatile uint32_t g_next_seq[2];
+static volatile uint32_t g_bad_data = 0;
+
+static volatile uint32_t      g_seq = 0;
+static volatile rtos_status_t g_isr_status = RTOS_ERROR_GENERAL;
+static const rtos_bus_msg_t *volatile g_isr_msg = NULL;
+
+/* =================== Helpers =================== */
+
+static uint32_t pool_free(void)
+{
+    rtos_mempool_stats_t stats;
+    rtos_mempool_get_stats(&g_pool, &stats);
+    return stats.free_count;
+}
+
+static void fill_frame(rtos_bus_msg_t *msg, uint32_t seq)
+{
+    frame_t *f = (frame_t *) RTOS_BUS_MSG_DATA(msg);
+    f->seq     = seq;
+    memset(f->bytes, (int) (seq & 0xFFU), sizeof(f->bytes));
+}
+
+static bool frame_ok(const rtos_bus_msg_t *msg)
+{
+    const frame_t *f = (const frame_t *) RTOS_BUS_MSG_DATA(msg);
+    uint8_t        b = (uint8_t) (f->seq & 0xFFU);
+    return f->bytes[0] == b && f->bytes[sizeof(f->bytes) - 1U] == b;
+}
+
+/* Allocate, fill and publish one frame; returns the message pointer */
+static rtos_bus_msg_t *publish_frame(rtos_status_t *status)
+{
+    rtos_bus_msg_t *msg = rtos_bus_alloc(&g_bus, TOPIC_FRAME, 0U);
+    if (msg == NULL)
+    {
+        *status = RTOS_ERROR_NO_MEMORY;
+        return NULL;
+    }
+    fill_frame(msg, g_seq);
+    g_seq++;
+    *status = rtos_bus_publish(&g_bus, msg, 0U);
+    return msg;
+}
+
+/* Take one message from a polled subscriber; true if it is `expected` */
+static bool drain_one(rtos_bus_sub_t *sub, const rtos_bus_msg_t *expected)
+{
+    rtos_bus_msg_t *msg;
+    if (rtos_bus_receive(sub, &msg, 0U) != RTOS_SUCCESS)
+    {
+        return false;
+    }
+    bool same = (msg == expected) && frame_ok(msg);
+    rtos_bus_release(msg);
+    return same;
+}
+
+/* =================== Interrupt Handler =================== */
+
+void TEST_SPARE_IRQHandler(void)
+{
+    bool            woken = false;
+    rtos_bus_msg_t *msg   = rtos_bus_alloc_from_isr(&g_bus, TOPIC_FRAME);
+
+    if (msg != NULL)
+    {
+        fill_frame(msg, g_seq);
+        g_seq++;
+        g_isr_msg    = msg;
+        g_isr_status = rtos_bus_publish_from_isr(&g_bus, msg, &woken);
+    }
+
+    if (woken)
+    {
+        rtos_port_yield();
+    }
+}
+
+/* =================== Task Implementations =================== */
+
+static void consumer_task_func(void *param)
+{
+    uint32_t        id  = (uint32_t) (uintptr_t) param;
+    rtos_bus_sub_t *sub = &g_sub[id];
+
+    while (1)
+    {
+        rtos_bus_msg_t *msg;
+        if (rtos_bus_receive(sub, &msg, RTOS_MAX_DELAY) != RTOS_SUCCESS)
+        {
+            continue;
+        }
+
+        g_last[id] = msg;
+        if (msg->topic == TOPIC_STATUS)
+        {
+            g_status[id]++;
+        }
+        else
+        {
+            const frame_t *f = (const frame_t *) RTOS_BUS_MSG_DATA(msg);
+            if (!frame_ok(msg) || f->seq < g_next_seq[id])
+            {
+                g_bad_data++;
+            }
+            g_next_seq[id] = f->seq + 1U;
+            g_frames[id]++;
+            if (msg == g_isr_msg)
+            {
+                g_isr_frames[id]++;
+            }
+        }
+        rtos_bus_release(msg);
+    }
+}
+
+static void check_fan_out(void)
+{
+    rtos_status_t status;
+
+    /* INV-PS1 / INV-PS2 */
+    rtos_bus_msg_t *msg = publish_frame(&status);
+    TEST_ASSERT(status == RTOS_SUCCESS, "INV-PS1:Published");
+    TEST_ASSERT(g_last[0] == msg && g_last[1] == msg, "INV-PS1:TasksGetSamePointer");
+    TEST_ASSERT(g_frames[0] == 1U && g_frames[1] == 1U && g_bad_data == 0U, "INV-PS1:PayloadAsWritten");
+    TEST_ASSERT(msg->refs == 2U && pool_free() == POOL_BLOCKS - 1U, "INV-PS2:HeldByUndrained");
+
+    TEST_ASSERT(drain_one(&g_sub[2], msg), "INV-PS1:PolledGetsSamePointer");
+    TEST_ASSERT(pool_free() == POOL_BLOCKS - 1U, "INV-PS2:StillHeldByLast");
+    TEST_ASSERT(drain_one(&g_sub[3], msg), "INV-PS1:LastGetsSamePointer");
+    TEST_ASSERT(pool_free() == POOL_BLOCKS, "INV-PS2:FreedAfterLast");
+
+    /* Only A subscribes to STATUS */
+    msg = rtos_bus_alloc(&g_bus, TOPIC_STATUS, 0U);
+    TEST_ASSERT(rtos_bus_publish(&g_bus, msg, 0U) == RTOS_SUCCESS, "INV-PS1:StatusPublished");
+    TEST_ASSERT(g_status[0] == 1U && g_status[1] == 0U, "INV-PS1:OnlySubscriberGetsTopic");
+    TEST_ASSERT(rtos_queue_messages_waiting(rtos_bus_sub_queue(&g_sub[2])) == 0U &&
+                    rtos_queue_messages_waiting(rtos_bus_sub_queue(&g_sub[3])) == 0U,
+                "INV-PS1:OthersGetNothing");
+    TEST_ASSERT(pool_free() == POOL_BLOCKS, "INV-PS2:StatusFreed");
+
+    /* INV-PS3 */
+    msg = rtos_bus_alloc(&g_bus, TOPIC_IDLE, 0U);
+    TEST_ASSERT(msg != NULL && pool_free() == POOL_BLOCKS - 1U, "INV-PS3:Allocated");
+    TEST_ASSERT(rtos_bus_publish(&g_bus, msg, 0U) == RTOS_SUCCESS, "INV-PS3:Published");
+    TEST_ASSERT(pool_free() == POOL_BLOCKS, "INV-PS3:FreedByPublish");
+}
+
+static void check_full_queue(void)
+{
+    rtos_status_t   status[BURST];
+    rtos_bus_msg_t *msgs[BURST];
+    uint32_t        frames_before = g_frames[0];
+
+    /* INV-PS4: D holds SHORT_LENGTH, C is drained as we go */
+    for (uint32_t i = 0; i < BURST; i++)
+    {
+        msgs[i] = publish_frame(&status[i]);
+        TEST_ASSERT(drain_one(&g_sub[2], msgs[i]), "INV-PS4:OthersStillGetIt");
+    }
+
+    TEST_ASSERT(status[0] == RTOS_SUCCESS && status[1] == RTOS_SUCCESS, "INV-PS4:FitsInQueue");
+    TEST_ASSERT(status[BURST - 1U] == RTOS_ERROR_FULL, "INV-PS4:FullReported");
+    TEST_ASSERT(g_sub[3].dropped == 1U, "INV-PS4:DropCounted");
+    TEST_ASSERT(g_frames[0] == frames_before + BURST && g_frames[1] == frames_before + BURST,
+                "INV-PS4:TasksGotAll");
+    TEST_ASSERT(g_bad_data == 0U, "INV-PS4:InOrder");
+    TEST_ASSERT(pool_free() == POOL_BLOCKS - SHORT_LENGTH, "INV-PS4:DroppedFreed");
+
+    TEST_ASSERT(drain_one(&g_sub[3], msgs[0]) && drain_one(&g_sub[3], msgs[1]), "INV-PS4:QueuedInOrder");
+    TEST_ASSERT(pool_free() == POOL_BLOCKS, "INV-PS4:AllReturned");
+}
+
+static void check_unsubscribe(void)
+{
+    rtos_status_t status;
+
+    /* INV-PS5 */
+    TEST_ASSERT(rtos_bus_unsubscribe(&g_sub[3], TOPIC_FRAME) == RTOS_SUCCESS, "INV-PS5:Unsubscribed");
+    rtos_bus_msg_t *msg = publish_frame(&status);
+    TEST_ASSERT(status == RTOS_SUCCESS && drain_one(&g_sub[2], msg), "INV-PS5:OthersGetIt");
+    TEST_ASSERT(rtos_queue_messages_waiting(rtos_bus_sub_queue(&g_sub[3])) == 0U, "INV-PS5:NothingQueued");
+    TEST_ASSERT(pool_free() == POOL_BLOCKS, "INV-PS5:Freed");
+}
+
+static void check_isr(void)
+{
+    /* INV-PS6 */
+    NVIC_SetPendingIRQ(TEST_IRQn);
+    __DSB();
+    __ISB();
+    rtos_delay_ms(SETTLE_MS);
+
+    TEST_ASSERT(g_isr_status == RTOS_SUCCESS, "INV-PS6:IsrPublished");
+    TEST_ASSERT(g_isr_frames[0] == 1U && g_isr_frames[1] == 1U, "INV-PS6:TasksGotIt");
+    TEST_ASSERT(drain_one(&g_sub[2], (const rtos_bus_msg_t *) g_isr_msg), "INV-PS6:PolledGotIt");
+    TEST_ASSERT(pool_free() == POOL_BLOCKS, "INV-PS6:Freed");
+}
+
+static void check_params(void)
+{
+    /* INV-PS7 */
+    TEST_ASSERT(rtos_bus_subscribe(&g_sub[0], RTOS_BUS_MAX_TOPICS) == RTOS_ERROR_INVALID_PARAM,
+                "INV-PS7:SubscribeBadTopic");
+    TEST_ASSERT(rtos_bus_alloc(&g_bus, RTOS_BUS_MAX_TOPICS, 0U) == NULL, "INV-PS7:AllocBadTopic");
+    TEST_ASSERT(rtos_bus_payload_size(&g_bus) >= FRAME_BYTES, "INV-PS7:PayloadSize");
+
+    rtos_bus_msg_t *other = rtos_bus_alloc(&g_other_bus, TOPIC_FRAME, 0U);
+    TEST_ASSERT(rtos_bus_publish(&g_bus, other, 0U) == RTOS_ERROR_INVALID_PARAM, "INV-PS7:ForeignMessage");
+    rtos_bus_release(other);
+}
+
+/*
+ * Controller (priority 2).
+ * Consumers outrank it, so each publish returns after they handled it.
+ */
+static void ctrl_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Controller");
+
+    rtos_delay_ms(SETTLE_MS);
+
+    check_fan_out();
+    check_full_queue();
+    check_unsubscribe();
+    check_isr();
+    check_params();
+
+    test_log_task("END", "Controller");
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+/*
+ * Monitor task (priority 1).
+ * Emits the final PASS/FAIL verdict.
+ */
+static void monitor_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Monitor");
+
+    while (!g_test_complete)
+    {
+        rtos_delay_ms(MONITOR_POLL_MS);
+    }
+
+    /* Final verdict */
+    TEST_EMIT_VERDICT();
+
+    test_log_task("END", "Monitor");
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+/* =================== Timer Callbacks =================== */
+
+static void startup_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    g_test_started = true;
+    test_log_framework("BEGIN", "PubSubState");
+    rtos_timer_handle_t *p = (rtos_timer_handle_t *) param;
+    rtos_timer_start(*p);
+}
+
+static void test_timeout_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_complete = true;
+    test_log_framework("TIMEOUT", "PubSubState");
+}
+
+/* =================== Main =================== */
+
+__attribute__((__noreturn__)) int main(void)
+{
+    rtos_status_t       status;
+    rtos_timer_handle_t startup_timer;
+
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_ALL);
+
+    log_info("Publish/Subscribe Bus Test");
+    log_info("Priorities: Consumers=%u Ctrl=%u Mon=%u", TASK_CONSUMER_PRIORITY, TASK_CTRL_PRIORITY,
+             TASK_MON_PRIORITY);
+    log_info("Invariants: PS1(fan_out) PS2(last_frees) PS3(no_sub) PS4(full) PS5(unsub) PS6(isr) PS7(params)");
+
+    status = rtos_init();
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("RTOS init failed: %d", status);
+        indicate_system_failure();
+    }
+
+    if (rtos_mempool_init(&g_pool, g_pool_storage, RTOS_BUS_BLOCK_SIZE(FRAME_BYTES), POOL_BLOCKS) != RTOS_SUCCESS ||
+        rtos_mempool_init(&g_other_pool, g_other_storage, RTOS_BUS_BLOCK_SIZE(8U), 1U) != RTOS_SUCCESS ||
+        rtos_bus_init(&g_bus, &g_pool) != RTOS_SUCCESS || rtos_bus_init(&g_other_bus, &g_other_pool) != RTOS_SUCCESS)
+    {
+        log_error("Bus setup failed");
+        indicate_system_failure();
+    }
+
+    for (uint32_t i = 0; i < 3U; i++)
+    {
+        if (rtos_bus_attach(&g_bus, &g_sub[i], g_sub_storage[i], QUEUE_LENGTH) != RTOS_SUCCESS ||
+            rtos_bus_subscribe(&g_sub[i], TOPIC_FRAME) != RTOS_SUCCESS)
+        {
+            indicate_system_failure();
+        }
+    }
+    if (rtos_bus_attach(&g_bus, &g_sub[3], g_short_storage, SHORT_LENGTH) != RTOS_SUCCESS ||
+        rtos_bus_subscribe(&g_sub[3], TOPIC_FRAME) != RTOS_SUCCESS ||
+        rtos_bus_subscribe(&g_sub[0], TOPIC_STATUS) != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    NVIC_SetPriority(TEST_IRQn, TEST_IRQ_PRIO);
+    NVIC_EnableIRQ(TEST_IRQn);
+
+    status = test_create_startup_timer(startup_timer_callback, &g_test_timer, &startup_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Startup timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_timer_create("TestTimer", TEST_DURATION_MS, RTOS_TIMER_ONE_SHOT, test_timeout_callback, NULL,
+                               &g_test_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Test timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t handle;
+    if (rtos_task_create(consumer_task_func, "ConsA", RTOS_DEFAULT_TASK_STACK_SIZE, (void *) 0U,
+                         TASK_CONSUMER_PRIORITY, &handle) != RTOS_SUCCESS ||
+        rtos_task_create(consumer_task_func, "ConsB", RTOS_DEFAULT_TASK_STACK_SIZE, (void *) 1U,
+                         TASK_CONSUMER_PRIORITY, &handle) != RTOS_SUCCESS ||
+        rtos_task_create(ctrl_task_func, "Controller", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_CTRL_PRIORITY,
+                         &handle) != RTOS_SUCCESS ||
+        rtos_task_create(monitor_task_func, "Monitor", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_MON_PRIORITY,
+                         &handle) != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t flush_handle;
+    test_create_log_flush_task(&flush_handle);
+
+    log_info("Starting scheduler...");
+    status = rtos_start_scheduler();
+
+    indicate_system_failure();
+}
@@ -0,0 +1,345 @@
+/*******************************************************************************
+ * File: tests/integration/test_queue_isr_state.c
+ * Description: Queue ISR API - Non-Blocking & Deferred Yield Invariant Test
+ * Author: Student
+ * Date: 2025
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "config.h"
+#include "device.h" // IWYU pragma: keep
+#include "hardware_env.h"
+#include "queue.h"
+#include "rtos_port.h"
+#include "task.h"
+#include "test_common.h"
+#include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
+#include "timer.h"
+#include "uart_tx.h"
+
+/**
+ * @file test_queue_isr_state.c
+ * @brief Queue ISR API Non-Blocking & Deferred Yield Invariant Test
+ *
+ * SCENARIO
+ * --------
+ * A spare peripheral interrupt (TEST_IRQn, not used by the board code) is
+ * pended in software by the Trigger task and runs one of two bursts:
+ *
+ *   SEND burst — rtos_queue_send_from_isr() BURST_LEN + 1 items into
+ *                queue A (capacity BURST_LEN) while Consumer is blocked
+ *                on it; the last send finds the queue full.
+ *   RECV burst — rtos_queue_receive_from_isr() twice from queue B
+ *                (capacity 1, kept full by Sender, which is blocked on it);
+ *                the second receive finds the queue empty.
+ *
+ * Each handler passes one woken flag to every call and issues a single
+ * rtos_port_yield() at exit.
+ *
+ *   Sender   (priority 4) — blocks sending to full queue B
+ *   Consumer (priority 3) — blocks receiving from queue A, checks order
+ *   Trigger  (priority 2) — pends the interrupt and checks the results
+ *
+ * INVARIANTS
+ * ----------
+ * INV-I1  send_from_isr on a full queue returns RTOS_ERROR_FULL.
+ * INV-I2  The woken flag is set when a higher-priority task was waiting,
+ *         and left clear by a call that wakes nobody.
+ * INV-I3  No context switch happens inside the handler: the woken
+ *         Consumer has not run by the end of the burst.
+ * INV-I4  The woken task runs at ISR exit, before Trigger resumes, and
+ *         receives the burst in FIFO order.
+ * INV-I5  receive_from_isr returns the oldest item and wakes a blocked
+ *         sender; on an empty queue it returns RTOS_ERROR_EMPTY.
+ */
+
+/* =================== Test Parameters =================== */
+
+#define TASK_SENDER_PRIORITY   (4U)
+#define TASK_CONSUMER_PRIORITY (3U)
+#define TASK_TRIGGER_PRIORITY  (2U)
+
+#define TEST_IRQn        TEST_SPARE_IRQn
+#define TEST_IRQ_PRIO    (14U) /* Below the kernel BASEPRI threshold */
+#define BURST_LEN        (4U)
+#define SCENARIO_CYCLES  (20U)
+#define SETTLE_MS        (5U)
+#define TEST_DURATION_MS (6000U)
+
+/* =================== Shared State =================== */
+
+static volatile bool g_test_started  = false;
+static volatile bool g_test_complete = false;
+
+static rtos_timer_handle_t g_test_timer;
+
+static rtos_queue_handle_t g_queue_a = NULL;
+static rtos_queue_handle_t g_queue_b = NULL;
+
+static rtos_task_handle_t g_handle_sender   = NULL;
+static rtos_task_handle_t g_handle_consumer = NULL;
+
+typedef enum
+{
+    ISR_MODE_SEND,
+    ISR_MODE_RECV
+} isr_mode_t;
+
+static volatile isr_mode_t g_isr_mode;
+static volatile uint32_t   g_isr_seq = 0; /* Next sequence number the ISR sends */
+
+/* Handler results, checked by Trigger */
+static volatile rtos_status_t g_isr_last_status;
+static volatile bool          g_isr_woken;
+static volatile bool          g_isr_woken_idle;
+static volatile uint32_t      g_isr_item;
+static volatile uint32_t      g_isr_consumed_at_exit;
+
+static volatile uint32_t g_consumed     = 0;
+static volatile uint32_t g_order_errors = 0;
+static volatile uint32_t g_sender_sent  = 0;
+
+/* =================== Interrupt Handler =================== */
+
+void TEST_SPARE_IRQHandler(void)
+{
+    bool woken = false;
+
+    if (g_isr_mode == ISR_MODE_SEND)
+    {
+        for (uint32_t i = 0; i < BURST_LEN; i++)
+        {
+            uint32_t seq = g_isr_seq++;
+            rtos_queue_send_from_isr(g_queue_a, &seq, &woken);
+        }
+
+        uint32_t extra    = g_isr_seq;
+        g_isr_last_status = rtos_queue_send_from_isr(g_queue_a, &extra, &woken);
+    }
+    else
+    {
+        uint32_t item = 0;
+        rtos_queue_receive_from_isr(g_queue_b, &item, &woken);
+        g_isr_item = item;
+
+        bool woken_idle   = false;
+        g_isr_last_status = rtos_queue_receive_from_isr(g_queue_b, &item, &woken_idle);
+        g_isr_woken_idle  = woken_idle;
+    }
+
+    g_isr_woken            = woken;
+    g_isr_consumed_at_exit = g_consumed;
+
+    if (woken)
+    {
+        rtos_port_yield();
+    }
+}
+
+/* =================== Task Implementations =================== */
+
+static void sender_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Sender");
+
+    for (uint32_t seq = 0; !g_test_complete; seq++)
+    {
+        /* Queue B holds one item: the first send fills it, later ones block until a RECV burst */
+        rtos_queue_send(g_queue_b, &seq, RTOS_MAX_DELAY);
+        g_sender_sent = seq + 1;
+    }
+
+    test_log_task("END", "Sender");
+    while (1)
+    {
+        rtos_delay_ms(1000);
+    }
+}
+
+static void consumer_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Consumer");
+
+    uint32_t expected = 0;
+
+    while (!g_test_complete)
+    {
+        uint32_t item = 0;
+        if (rtos_queue_receive(g_queue_a, &item, RTOS_MAX_DELAY) == RTOS_SUCCESS)
+        {
+            if (item != expected)
+            {
+                g_order_errors++;
+            }
+            expected = item + 1;
+            g_consumed++;
+        }
+    }
+
+    test_log_task("END", "Consumer");
+    while (1)
+    {
+        rtos_delay_ms(1000);
+    }
+}
+
+static void trigger_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Trigger");
+
+    for (uint32_t cycle = 0; cycle < SCENARIO_CYCLES && !g_test_complete; cycle++)
+    {
+        rtos_delay_ms(SETTLE_MS);
+
+        /* --- SEND burst --- */
+        ASSERT_STATE(g_handle_consumer, RTOS_TASK_STATE_BLOCKED, "I-SETUP:ConsumerBlocked");
+
+        uint32_t consumed_before = g_consumed;
+        g_isr_mode               = ISR_MODE_SEND;
+        NVIC_SetPendingIRQ(TEST_IRQn);
+        __DSB();
+        __ISB();
+
+        /* Consumer (priority 3) ran at ISR exit and drained the queue */
+        TEST_ASSERT(g_isr_last_status == RTOS_ERROR_FULL, "INV-I1:FullFromISR");
+        TEST_ASSERT(g_isr_woken, "INV-I2:WokenSetOnWake");
+        TEST_ASSERT(g_isr_consumed_at_exit == consumed_before, "INV-I3:NoSwitchInISR");
+        TEST_ASSERT(g_consumed == consumed_before + BURST_LEN, "INV-I4:RanAtISRExit");
+        TEST_ASSERT(g_order_errors == 0, "INV-I4:FIFO");
+        TEST_ASSERT(rtos_queue_is_empty(g_queue_a), "I-SEND:Drained");
+
+        /* --- RECV burst --- */
+        ASSERT_STATE(g_handle_sender, RTOS_TASK_STATE_BLOCKED, "I-SETUP:SenderBlocked");
+
+        uint32_t expected_item = g_sender_sent - 1U; /* Sender's last successful send */
+        uint32_t sent_before   = g_sender_sent;
+        g_isr_mode             = ISR_MODE_RECV;
+        NVIC_SetPendingIRQ(TEST_IRQn);
+        __DSB();
+        __ISB();
+
+        TEST_ASSERT(g_isr_item == expected_item, "INV-I5:OldestItem");
+        TEST_ASSERT(g_isr_last_status == RTOS_ERROR_EMPTY, "INV-I5:EmptyFromISR");
+        TEST_ASSERT(g_isr_woken, "INV-I2:WokenSetOnWake");
+        TEST_ASSERT(!g_isr_woken_idle, "INV-I2:WokenClearNoWaiter");
+
+        /* Sender (priority 4) ran at ISR exit, refilled queue B and re-blocked */
+        TEST_ASSERT(g_sender_sent == sent_before + 1U, "INV-I5:SenderWoken");
+        TEST_ASSERT(rtos_queue_messages_waiting(g_queue_b) == 1U, "I-RECV:Refilled");
+    }
+
+    TEST_EMIT_VERDICT();
+
+    test_log_task("END", "Trigger");
+    while (1)
+    {
+        rtos_delay_ms(1000);
+    }
+}
+
+/* =================== Timer Callbacks =================== */
+
+static void startup_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    g_test_started = true;
+    test_log_framework("BEGIN", "QueueISR");
+    rtos_timer_handle_t *p = (rtos_timer_handle_t *) param;
+    rtos_timer_start(*p);
+}
+
+static void test_timeout_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_complete = true;
+    test_log_framework("TIMEOUT", "QueueISR");
+}
+
+/* =================== Main =================== */
+
+__attribute__((__noreturn__)) int main(void)
+{
+    rtos_status_t       status;
+    rtos_timer_handle_t startup_timer;
+
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_ALL);
+
+    log_info("Queue ISR API Non-Blocking & Deferred Yield Test");
+    log_info("Priorities: Sender=%u Consumer=%u Trigger=%u", TASK_SENDER_PRIORITY, TASK_CONSUMER_PRIORITY,
+             TASK_TRIGGER_PRIORITY);
+    log_info("Burst: %u  Cycles: %u", BURST_LEN, SCENARIO_CYCLES);
+    log_info("Invariants: I1(full) I2(woken flag) I3(no switch in ISR) I4(yield at exit) I5(recv)");
+
+    status = rtos_init();
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("RTOS init failed: %d", status);
+        indicate_system_failure();
+    }
+
+    if (rtos_queue_create(&g_queue_a, BURST_LEN, sizeof(uint32_t)) != RTOS_SUCCESS ||
+        rtos_queue_create(&g_queue_b, 1, sizeof(uint32_t)) != RTOS_SUCCESS)
+    {
+        log_error("Queue create failed");
+        indicate_system_failure();
+    }
+
+    NVIC_SetPriority(TEST_IRQn, TEST_IRQ_PRIO);
+    NVIC_EnableIRQ(TEST_IRQn);
+
+    status = test_create_startup_timer(startup_timer_callback, &g_test_timer, &startup_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Startup timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_timer_create("TestTimer", TEST_DURATION_MS, RTOS_TIMER_ONE_SHOT, test_timeout_callback, NULL,
+                               &g_test_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Test timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_task_create(sender_task_func, "Sender", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_SENDER_PRIORITY,
+                              &g_handle_sender);
+    if (status != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    status = rtos_task_create(consumer_task_func, "Consumer", RTOS_DEFAULT_TASK_STACK_SIZE, NULL,
+                              TASK_CONSUMER_PRIORITY, &g_handle_consumer);
+    if (status != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t trigger_handle;
+    status = rtos_task_create(trigger_task_func, "Trigger", RTOS_DEFAULT_TASK_STACK_SIZE, NULL,
+                              TASK_TRIGGER_PRIORITY, &trigger_handle);
+    if (status != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t flush_handle;
+    test_create_log_flush_task(&flush_handle);
+
+    log_info("Starting scheduler...");
+    status = rtos_start_scheduler();
+
+    indicate_system_failure();
+}
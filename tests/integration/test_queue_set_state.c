@@ -0,0 +1,419 @@
+/*******************************************************************************
+ * File: tests/integration/test_queue_set_state.c
+ * Description: Queue Set - Multi-Object Wait Invariant Test
+ * Author: Student
+ * Date: 2025
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "config.h"
+#include "device.h" // IWYU pragma: keep
+#include "hardware_env.h"
+#include "queue.h"
+#include "queue_set.h"
+#include "rtos_port.h"
+#include "semaphore.h"
+#include "task.h"
+#include "test_common.h"
+#include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
+#include "timer.h"
+#include "uart_tx.h"
+
+/**
+ * @file test_queue_set_state.c
+ * @brief Queue Set Multi-Object Wait Test
+ *
+ * SCENARIO
+ * --------
+ * Four tasks plus log flush:
+ *
+ *   Gateway    (priority 4) — selects on {queue A, queue B, semaphore,
+ *                             own notification} forever and takes the member
+ *   DirectRx   (priority 3) — blocks on queue A itself, once
+ *   Controller (priority 2) — makes members ready, checks the invariants
+ *   Monitor    (priority 1) — emits final verdict
+ *
+ * INVARIANTS
+ * ----------
+ * INV-QS1  A task blocked in select on members with nothing ready is BLOCKED
+ * INV-QS2  An item for a task blocked on the queue itself goes to that task;
+ *          the set waiter stays BLOCKED
+ * INV-QS3  A send to queue B wakes Gateway with member == queue B
+ * INV-QS4  A semaphore signal wakes it with member == the semaphore
+ * INV-QS5  A notification wakes it with member == RTOS_QUEUE_SET_NOTIFICATION
+ * INV-QS6  signal_from_isr() (TEST_IRQn) on the semaphore wakes it and sets
+ *          *higher_priority_task_woken
+ * INV-QS7  With several members ready, select returns the first one added
+ * INV-QS8  select: no wait -> RTOS_ERROR_EMPTY; timed -> RTOS_ERROR_TIMEOUT
+ * INV-QS9  Adding a member twice, or deleting a member queue,
+ *          -> RTOS_ERROR_INVALID_STATE
+ */
+
+/* =================== Test Parameters =================== */
+
+#define TASK_GATEWAY_PRIORITY (4U)
+#define TASK_DIRECT_PRIORITY  (3U)
+#define TASK_CTRL_PRIORITY    (2U)
+#define TASK_MON_PRIORITY     (1U)
+
+#define SETTLE_MS        (50U)
+#define MONITOR_POLL_MS  (20U)
+#define IDLE_SPIN_MS     (1000U)
+#define TEST_DURATION_MS (3000U)
+#define TIMEOUT_TICKS    (10U)
+
+#define TEST_IRQn     TEST_SPARE_IRQn
+#define TEST_IRQ_PRIO (14U) /* Below the kernel BASEPRI threshold */
+
+#define QUEUE_LENGTH (4U)
+#define ITEM_DIRECT  (0x11U)
+#define ITEM_B       (0x22U)
+
+/* TEST_ASSERT, ASSERT_STATE, g_fail_count are in test_common.h */
+
+/* =================== Shared State =================== */
+
+static volatile bool g_test_started  = false;
+static volatile bool g_test_complete = false;
+
+static rtos_task_handle_t g_handle_gateway = NULL;
+static rtos_task_handle_t g_handle_direct  = NULL;
+
+static rtos_queue_handle_t g_queue_a;
+static rtos_queue_handle_t g_queue_b;
+static rtos_semaphore_t    g_sem;
+static rtos_queue_set_t    g_set;
+
+/*
+ * Synchronisation flags.
+ * volatile uint32_t to avoid torn reads on Cortex-M.
+ */
+static volatile uint32_t                g_events      = 0; /**< Members taken by Gateway */
+static volatile rtos_queue_set_member_t g_last_member = NULL;
+static volatile uint32_t                g_last_item   = 0;
+static volatile uint32_t                g_direct_item = 0;
+
+static volatile bool g_isr_woken = false;
+
+static rtos_timer_handle_t g_test_timer;
+
+/* =================== Interrupt Handler =================== */
+
+void TEST_SPARE_IRQHandler(void)
+{
+    bool woken = false;
+
+    rtos_semaphore_signal_from_isr(&g_sem, &woken);
+    g_isr_woken = woken;
+
+    if (woken)
+    {
+        rtos_port_yield();
+    }
+}
+
+/* =================== Task Implementations =================== */
+
+/*
+ * Gateway (priority 4).
+ * Selects on the set and takes from whichever member is ready.
+ */
+static void gateway_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Gateway");
+
+    while (1)
+    {
+        rtos_queue_set_member_t member;
+        uint32_t                item = 0;
+
+        if (rtos_queue_set_select(&g_set, &member, RTOS_MAX_DELAY) != RTOS_SUCCESS)
+        {
+            continue;
+        }
+
+        if (member == g_queue_a)
+        {
+            rtos_queue_receive(g_queue_a, &item, 0);
+        }
+        else if (member == g_queue_b)
+        {
+            rtos_queue_receive(g_queue_b, &item, 0);
+        }
+        else if (member == &g_sem)
+        {
+            rtos_semaphore_try_wait(&g_sem);
+        }
+        else if (member == RTOS_QUEUE_SET_NOTIFICATION)
+        {
+            rtos_task_notify_take(true, RTOS_NOTIFY_NO_WAIT);
+        }
+
+        g_last_item   = item;
+        g_last_member = member;
+        g_events++;
+    }
+}
+
+/*
+ * DirectRx (priority 3).
+ * Receives one item from queue A directly, then idles.
+ */
+static void direct_task_func(void *param)
+{
+    (void) param;
+    uint32_t item = 0;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "DirectRx");
+
+    rtos_queue_receive(g_queue_a, &item, RTOS_MAX_DELAY);
+    g_direct_item = item;
+
+    test_log_task("END", "DirectRx");
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+/*
+ * Controller (priority 2).
+ *
+ * Each member update below wakes a higher-priority task, which runs to
+ * completion before the call returns. INV-QS7..QS9 use a second set that
+ * nobody selects on.
+ */
+static void ctrl_task_func(void *param)
+{
+    (void) param;
+    uint32_t item;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Controller");
+
+    rtos_delay_ms(SETTLE_MS);
+
+    /* INV-QS1 */
+    ASSERT_STATE(g_handle_gateway, RTOS_TASK_STATE_BLOCKED, "INV-QS1:GatewayBlocked");
+    ASSERT_STATE(g_handle_direct, RTOS_TASK_STATE_BLOCKED, "INV-QS1:DirectBlocked");
+
+    /* INV-QS2: DirectRx is blocked on queue A itself */
+    item = ITEM_DIRECT;
+    rtos_queue_send(g_queue_a, &item, 0);
+    TEST_ASSERT(g_direct_item == ITEM_DIRECT, "INV-QS2:DirectGotItem");
+    TEST_ASSERT(g_events == 0, "INV-QS2:SetNotWoken");
+    ASSERT_STATE(g_handle_gateway, RTOS_TASK_STATE_BLOCKED, "INV-QS2:GatewayStillBlocked");
+
+    /* INV-QS3 */
+    item = ITEM_B;
+    rtos_queue_send(g_queue_b, &item, 0);
+    TEST_ASSERT(g_events == 1, "INV-QS3:GatewayWoken");
+    TEST_ASSERT(g_last_member == g_queue_b, "INV-QS3:MemberIsQueueB");
+    TEST_ASSERT(g_last_item == ITEM_B, "INV-QS3:ItemTaken");
+
+    /* INV-QS4 */
+    rtos_semaphore_signal(&g_sem);
+    TEST_ASSERT(g_events == 2, "INV-QS4:GatewayWoken");
+    TEST_ASSERT(g_last_member == &g_sem, "INV-QS4:MemberIsSemaphore");
+    TEST_ASSERT(rtos_semaphore_get_count(&g_sem) == 0, "INV-QS4:SemaphoreTaken");
+
+    /* INV-QS5 */
+    rtos_task_notify_give(g_handle_gateway);
+    TEST_ASSERT(g_events == 3, "INV-QS5:GatewayWoken");
+    TEST_ASSERT(g_last_member == RTOS_QUEUE_SET_NOTIFICATION, "INV-QS5:MemberIsNotification");
+
+    /* INV-QS6 */
+    NVIC_SetPendingIRQ(TEST_IRQn);
+    __DSB();
+    __ISB();
+
+    TEST_ASSERT(g_isr_woken, "INV-QS6:WokenSetOnWake");
+    TEST_ASSERT(g_events == 4, "INV-QS6:GatewayRanAtIsrExit");
+    TEST_ASSERT(g_last_member == &g_sem, "INV-QS6:MemberIsSemaphore");
+
+    /* =========================================================
+     * INV-QS7..QS9 — a second set on its own queues
+     * ========================================================= */
+    rtos_queue_set_t        local_set;
+    rtos_queue_handle_t     q_first;
+    rtos_queue_handle_t     q_second;
+    rtos_queue_set_member_t member;
+
+    /* Setup failures (e.g. a heap too small) report here, not as select failures */
+    TEST_ASSERT(rtos_queue_create(&q_first, QUEUE_LENGTH, sizeof(uint32_t)) == RTOS_SUCCESS, "INV-QS7:CreateFirst");
+    TEST_ASSERT(rtos_queue_create(&q_second, QUEUE_LENGTH, sizeof(uint32_t)) == RTOS_SUCCESS, "INV-QS7:CreateSecond");
+    TEST_ASSERT(rtos_queue_set_init(&local_set) == RTOS_SUCCESS, "INV-QS7:SetInit");
+    TEST_ASSERT(rtos_queue_set_add_queue(&local_set, q_first) == RTOS_SUCCESS, "INV-QS7:AddFirst");
+    TEST_ASSERT(rtos_queue_set_add_queue(&local_set, q_second) == RTOS_SUCCESS, "INV-QS7:AddSecond");
+
+    /* INV-QS8 */
+    TEST_ASSERT(rtos_queue_set_select(&local_set, &member, 0) == RTOS_ERROR_EMPTY, "INV-QS8:NoWaitEmpty");
+    TEST_ASSERT(rtos_queue_set_select(&local_set, &member, TIMEOUT_TICKS) == RTOS_ERROR_TIMEOUT,
+                "INV-QS8:TimedOut");
+    TEST_ASSERT(member == NULL, "INV-QS8:NoMember");
+
+    /* INV-QS7: second queue filled first, first queue still wins */
+    item = 1;
+    rtos_queue_send(q_second, &item, 0);
+    rtos_queue_send(q_first, &item, 0);
+    TEST_ASSERT(rtos_queue_set_select(&local_set, &member, 0) == RTOS_SUCCESS && member == q_first,
+                "INV-QS7:AddOrderWins");
+    rtos_queue_receive(q_first, &item, 0);
+    TEST_ASSERT(rtos_queue_set_select(&local_set, &member, 0) == RTOS_SUCCESS && member == q_second,
+                "INV-QS7:NextReady");
+    rtos_queue_receive(q_second, &item, 0);
+
+    /* INV-QS9 */
+    TEST_ASSERT(rtos_queue_set_add_queue(&local_set, q_first) == RTOS_ERROR_INVALID_STATE, "INV-QS9:AddTwice");
+    TEST_ASSERT(rtos_queue_set_add_queue(&g_set, q_first) == RTOS_ERROR_INVALID_STATE, "INV-QS9:AddToSecondSet");
+    TEST_ASSERT(rtos_queue_delete(q_first) == RTOS_ERROR_INVALID_STATE, "INV-QS9:DeleteMember");
+    TEST_ASSERT(rtos_queue_set_remove(&local_set, q_first) == RTOS_SUCCESS, "INV-QS9:Remove");
+    TEST_ASSERT(rtos_queue_delete(q_first) == RTOS_SUCCESS, "INV-QS9:DeleteAfterRemove");
+
+    test_log_task("END", "Controller");
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+/*
+ * Monitor task (priority 1).
+ * Emits the final PASS/FAIL verdict.
+ */
+static void monitor_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Monitor");
+
+    while (!g_test_complete)
+    {
+        rtos_delay_ms(MONITOR_POLL_MS);
+    }
+
+    /* Final verdict */
+    TEST_EMIT_VERDICT();
+
+    test_log_task("END", "Monitor");
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+/* =================== Timer Callbacks =================== */
+
+static void startup_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    g_test_started = true;
+    test_log_framework("BEGIN", "QueueSetState");
+    rtos_timer_handle_t *p = (rtos_timer_handle_t *) param;
+    rtos_timer_start(*p);
+}
+
+static void test_timeout_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_complete = true;
+    test_log_framework("TIMEOUT", "QueueSetState");
+}
+
+/* =================== Main =================== */
+
+__attribute__((__noreturn__)) int main(void)
+{
+    rtos_status_t       status;
+    rtos_timer_handle_t startup_timer;
+
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_ALL);
+
+    log_info("Queue Set Multi-Object Wait Test");
+    log_info("Priorities: Gateway=%u Direct=%u Ctrl=%u Mon=%u", TASK_GATEWAY_PRIORITY, TASK_DIRECT_PRIORITY,
+             TASK_CTRL_PRIORITY, TASK_MON_PRIORITY);
+    log_info("Invariants: QS1(blocked) QS2(direct_first) QS3(queue) QS4(sem) QS5(notify) QS6(isr)");
+    log_info("            QS7(add_order) QS8(empty_timeout) QS9(membership)");
+
+    status = rtos_init();
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("RTOS init failed: %d", status);
+        indicate_system_failure();
+    }
+
+    if (rtos_queue_create(&g_queue_a, QUEUE_LENGTH, sizeof(uint32_t)) != RTOS_SUCCESS ||
+        rtos_queue_create(&g_queue_b, QUEUE_LENGTH, sizeof(uint32_t)) != RTOS_SUCCESS ||
+        rtos_semaphore_init(&g_sem, 0, 0) != RTOS_SEM_OK || rtos_queue_set_init(&g_set) != RTOS_SUCCESS ||
+        rtos_queue_set_add_queue(&g_set, g_queue_a) != RTOS_SUCCESS ||
+        rtos_queue_set_add_queue(&g_set, g_queue_b) != RTOS_SUCCESS ||
+        rtos_queue_set_add_semaphore(&g_set, &g_sem) != RTOS_SUCCESS ||
+        rtos_queue_set_add_notification(&g_set) != RTOS_SUCCESS)
+    {
+        log_error("Queue set setup failed");
+        indicate_system_failure();
+    }
+
+    status = test_create_startup_timer(startup_timer_callback, &g_test_timer, &startup_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Startup timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_timer_create("TestTimer", TEST_DURATION_MS, RTOS_TIMER_ONE_SHOT, test_timeout_callback, NULL,
+                               &g_test_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Test timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_task_create(gateway_task_func, "Gate", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_GATEWAY_PRIORITY,
+                              &g_handle_gateway);
+    if (status != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    status = rtos_task_create(direct_task_func, "Direct", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_DIRECT_PRIORITY,
+                              &g_handle_direct);
+    if (status != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t ctrl_handle;
+    status = rtos_task_create(ctrl_task_func, "Ctrl", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_CTRL_PRIORITY,
+                              &ctrl_handle);
+    if (status != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t monitor_handle;
+    status = rtos_task_create(monitor_task_func, "Mon", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_MON_PRIORITY,
+                              &monitor_handle);
+    if (status != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t flush_handle;
+    test_create_log_flush_task(&flush_handle);
+
+    NVIC_SetPriority(TEST_IRQn, TEST_IRQ_PRIO);
+    NVIC_EnableIRQ(TEST_IRQn);
+
+    log_info("Starting scheduler...");
+    status = rtos_start_scheduler();
+
+    indicate_system_failure();
+}
@@ -7,9 +7,9 @@
 
 #include "VRTOS.h"
 #include "config.h"
+#include "device.h" // IWYU pragma: keep
 #include "hardware_env.h"
 #include "queue.h"
-#include "stm32f4xx_hal.h" // IWYU pragma: keep
 #include "task.h"
 #include "test_common.h"
 #include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
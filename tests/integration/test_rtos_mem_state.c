@@ -0,0 +1,406 @@
+/*******************************************************************************
+ * File: tests/integration/test_rtos_mem_state.c
+ * Description: Kernel Memory Routines - Equivalence with memcpy/memset Test
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "config.h"
+#include "device.h" // IWYU pragma: keep
+#include "hardware_env.h"
+#include "port_common.h"
+#include "port_priv.h" /* PORT_HAS_BLOCK_TRANSFER */
+#include "rtos_mem.h"
+#include "task.h"
+#include "test_common.h"
+#include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
+#include "timer.h"
+#include "uart_tx.h"
+
+#include <string.h>
+
+/**
+ * @file test_rtos_mem_state.c
+ * @brief rtos_mem Routines vs. memcpy/memset Equivalence Test
+ *
+ * SCENARIO
+ * --------
+ * One Checker task (priority 2) runs every routine of src/utils/rtos_mem.h
+ * on static buffers and compares the whole buffer with the same operation
+ * done by memcpy()/memset() on a twin buffer. The bytes around the target
+ * range hold a guard pattern, so a store past the head or tail shows up as
+ * a difference.
+ *
+ *   rtos_mem_copy / rtos_mem_zero:  destination and source offsets 0..3
+ *     (unaligned heads), every length 0..SWEEP_MAX_LEN (unaligned tails),
+ *     plus LONG_LENS
+ *   rtos_mem_copy_words / fill_words / scan_words:  every word count
+ *     0..SWEEP_MAX_WORDS plus LONG_WORDS, starting one word into the
+ *     buffer; fill with zero, the stack paint and a non-byte pattern; scan
+ *     with the mismatch at every index, and none
+ *
+ * Lengths are counted in three classes, each reported on its own: 0-3
+ * (tail only), 4-15 (the inline and short word cases) and 16 or more (the
+ * LDM/STM bursts on ports with PORT_HAS_BLOCK_TRANSFER, the C library on
+ * hosted ones). Word routines count words.
+ *
+ * INVARIANTS
+ * ----------
+ * INV-MEM1  rtos_mem_copy() leaves the buffer exactly as memcpy() does.
+ * INV-MEM2  rtos_mem_zero() leaves the buffer exactly as memset(0) does.
+ * INV-MEM3  rtos_mem_copy_words() matches memcpy() of words * 4 bytes.
+ * INV-MEM4  rtos_mem_fill_words() matches memset() for byte patterns and
+ *           a word loop otherwise.
+ * INV-MEM5  rtos_mem_scan_words() returns the first differing index, or
+ *           the word count when every word matches.
+ */
+
+/* =================== Test Parameters =================== */
+
+#define TASK_CHECK_PRIORITY (2U)
+
+#define SWEEP_MAX_LEN    (72U) /* bytes: 0..71 cover every class and tail */
+#define SWEEP_MAX_WORDS  (40U) /* words: past five 8-word bursts */
+#define MEM_BUF_BYTES    (1100U)
+#define MEM_BUF_WORDS    (MEM_BUF_BYTES / sizeof(uint32_t))
+#define MEM_GUARD_BYTE   (0xE7U)
+#define TEST_DURATION_MS (8000U)
+
+/* Longest copy + 3-byte offset + 1 guard word stays inside MEM_BUF_BYTES */
+static const uint32_t g_long_lens[]  = {100U, 255U, 256U, 257U, 1024U, 1027U};
+static const uint32_t g_long_words[] = {63U, 64U, 65U, 256U};
+
+static const uint32_t g_fill_values[] = {0U, PORT_STACK_FILL_VALUE, 0x01234567U};
+
+#define LONG_LEN_COUNT   (sizeof(g_long_lens) / sizeof(g_long_lens[0]))
+#define LONG_WORDS_COUNT (sizeof(g_long_words) / sizeof(g_long_words[0]))
+#define FILL_VALUE_COUNT (sizeof(g_fill_values) / sizeof(g_fill_values[0]))
+
+/* =================== Shared State =================== */
+
+static volatile bool g_test_started  = false;
+static volatile bool g_test_complete = false;
+
+static rtos_timer_handle_t g_test_timer;
+
+static uint32_t g_src[MEM_BUF_WORDS];
+static uint32_t g_dst[MEM_BUF_WORDS]; /* rtos_mem result */
+static uint32_t g_ref[MEM_BUF_WORDS]; /* memcpy/memset result */
+
+enum
+{
+    LEN_TAIL,  /* 0-3 */
+    LEN_SHORT, /* 4-15 */
+    LEN_LONG,  /* 16+ */
+    LEN_CLASSES
+};
+
+/* Mismatching runs per routine and length class (g_runs: runs made) */
+static uint32_t g_copy_bad[LEN_CLASSES];
+static uint32_t g_zero_bad[LEN_CLASSES];
+static uint32_t g_copy_words_bad[LEN_CLASSES];
+static uint32_t g_fill_bad[LEN_CLASSES];
+static uint32_t g_scan_bad[LEN_CLASSES];
+static uint32_t g_runs[LEN_CLASSES];
+
+/* =================== Helpers =================== */
+
+static uint32_t len_class(uint32_t len)
+{
+    if (len < 4U)
+    {
+        return LEN_TAIL;
+    }
+    return (len < 16U) ? LEN_SHORT : LEN_LONG;
+}
+
+static void fill_pattern(uint32_t *buf, uint32_t seed)
+{
+    uint8_t *b = (uint8_t *) buf;
+    for (uint32_t i = 0; i < MEM_BUF_BYTES; i++)
+    {
+        b[i] = (uint8_t) (seed + i * 7U);
+    }
+}
+
+/* Both result buffers to the guard, the source to a pattern */
+static void reset_buffers(uint32_t seed)
+{
+    fill_pattern(g_src, seed);
+    memset(g_dst, MEM_GUARD_BYTE, sizeof(g_dst));
+    memset(g_ref, MEM_GUARD_BYTE, sizeof(g_ref));
+}
+
+static bool buffers_match(void)
+{
+    return memcmp(g_dst, g_ref, sizeof(g_dst)) == 0;
+}
+
+/* =================== Byte Routines =================== */
+
+static void check_copy(uint32_t len)
+{
+    for (uint32_t doff = 0; doff < 4U; doff++)
+    {
+        for (uint32_t soff = 0; soff < 4U; soff++)
+        {
+            reset_buffers(len + soff);
+
+            const uint8_t *src = (const uint8_t *) g_src + soff;
+            memcpy((uint8_t *) g_ref + sizeof(uint32_t) + doff, src, len);
+            rtos_mem_copy((uint8_t *) g_dst + sizeof(uint32_t) + doff, src, len);
+
+            if (!buffers_match())
+            {
+                g_copy_bad[len_class(len)]++;
+            }
+        }
+    }
+}
+
+static void check_zero(uint32_t len)
+{
+    for (uint32_t off = 0; off < 4U; off++)
+    {
+        fill_pattern(g_dst, len);
+        fill_pattern(g_ref, len);
+
+        memset((uint8_t *) g_ref + sizeof(uint32_t) + off, 0, len);
+        rtos_mem_zero((uint8_t *) g_dst + sizeof(uint32_t) + off, len);
+
+        if (!buffers_match())
+        {
+            g_zero_bad[len_class(len)]++;
+        }
+    }
+}
+
+static void check_bytes(uint32_t len)
+{
+    g_runs[len_class(len)]++;
+    check_copy(len);
+    check_zero(len);
+}
+
+/* =================== Word Routines =================== */
+
+static void check_copy_words(uint32_t words)
+{
+    reset_buffers(words);
+
+    memcpy(&g_ref[1], g_src, words * sizeof(uint32_t));
+    rtos_mem_copy_words(&g_dst[1], g_src, words);
+
+    if (!buffers_match())
+    {
+        g_copy_words_bad[len_class(words)]++;
+    }
+}
+
+static void check_fill_words(uint32_t words)
+{
+    for (uint32_t v = 0; v < FILL_VALUE_COUNT; v++)
+    {
+        uint32_t value = g_fill_values[v];
+
+        memset(g_dst, MEM_GUARD_BYTE, sizeof(g_dst));
+        memset(g_ref, MEM_GUARD_BYTE, sizeof(g_ref));
+
+        if (value == (value & 0xFFU) * 0x01010101U)
+        {
+            memset(&g_ref[1], (int) (value & 0xFFU), words * sizeof(uint32_t));
+        }
+        else
+        {
+            for (uint32_t i = 0; i < words; i++)
+            {
+                g_ref[1U + i] = value;
+            }
+        }
+        rtos_mem_fill_words(&g_dst[1], value, words);
+
+        if (!buffers_match())
+        {
+            g_fill_bad[len_class(words)]++;
+        }
+    }
+}
+
+static void check_scan_words(uint32_t words)
+{
+    /* Painted, with a painted word past the end that the scan must not count */
+    for (uint32_t i = 0; i < MEM_BUF_WORDS; i++)
+    {
+        g_dst[i] = PORT_STACK_FILL_VALUE;
+    }
+
+    /* mismatch == words: every word matches */
+    for (uint32_t mismatch = 0; mismatch <= words; mismatch++)
+    {
+        if (mismatch < words)
+        {
+            g_dst[1U + mismatch] = PORT_STACK_FILL_VALUE ^ 0x80000000U; /* one bit, top byte */
+        }
+
+        if (rtos_mem_scan_words(&g_dst[1], PORT_STACK_FILL_VALUE, words) != mismatch)
+        {
+            g_scan_bad[len_class(words)]++;
+        }
+
+        if (mismatch < words)
+        {
+            g_dst[1U + mismatch] = PORT_STACK_FILL_VALUE;
+        }
+    }
+}
+
+static void check_words(uint32_t words)
+{
+    check_copy_words(words);
+    check_fill_words(words);
+    check_scan_words(words);
+}
+
+/* =================== Task Implementations =================== */
+
+static void checker_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Checker");
+
+    for (uint32_t len = 0; len < SWEEP_MAX_LEN && !g_test_complete; len++)
+    {
+        check_bytes(len);
+    }
+    for (uint32_t i = 0; i < LONG_LEN_COUNT; i++)
+    {
+        check_bytes(g_long_lens[i]);
+    }
+
+    for (uint32_t words = 0; words <= SWEEP_MAX_WORDS && !g_test_complete; words++)
+    {
+        check_words(words);
+    }
+    for (uint32_t i = 0; i < LONG_WORDS_COUNT; i++)
+    {
+        check_words(g_long_words[i]);
+    }
+
+    log_info("Byte runs: tail=%lu short=%lu long=%lu  bad copy=%lu/%lu/%lu zero=%lu/%lu/%lu",
+             (unsigned long) g_runs[LEN_TAIL], (unsigned long) g_runs[LEN_SHORT], (unsigned long) g_runs[LEN_LONG],
+             (unsigned long) g_copy_bad[LEN_TAIL], (unsigned long) g_copy_bad[LEN_SHORT],
+             (unsigned long) g_copy_bad[LEN_LONG], (unsigned long) g_zero_bad[LEN_TAIL],
+             (unsigned long) g_zero_bad[LEN_SHORT], (unsigned long) g_zero_bad[LEN_LONG]);
+
+    /* Every class actually ran */
+    TEST_ASSERT(g_runs[LEN_TAIL] == 4U && g_runs[LEN_SHORT] == 12U &&
+                    g_runs[LEN_LONG] == SWEEP_MAX_LEN - 16U + LONG_LEN_COUNT,
+                "MEM-SWEEP:AllLengths");
+
+    /* INV-MEM1 */
+    TEST_ASSERT(g_copy_bad[LEN_TAIL] == 0U, "INV-MEM1:Copy0to3");
+    TEST_ASSERT(g_copy_bad[LEN_SHORT] == 0U, "INV-MEM1:Copy4to15");
+    TEST_ASSERT(g_copy_bad[LEN_LONG] == 0U, "INV-MEM1:Copy16up");
+
+    /* INV-MEM2 */
+    TEST_ASSERT(g_zero_bad[LEN_TAIL] == 0U, "INV-MEM2:Zero0to3");
+    TEST_ASSERT(g_zero_bad[LEN_SHORT] == 0U, "INV-MEM2:Zero4to15");
+    TEST_ASSERT(g_zero_bad[LEN_LONG] == 0U, "INV-MEM2:Zero16up");
+
+    /* INV-MEM3 */
+    TEST_ASSERT(g_copy_words_bad[LEN_TAIL] == 0U, "INV-MEM3:CopyWords0to3");
+    TEST_ASSERT(g_copy_words_bad[LEN_SHORT] == 0U, "INV-MEM3:CopyWords4to15");
+    TEST_ASSERT(g_copy_words_bad[LEN_LONG] == 0U, "INV-MEM3:CopyWords16up");
+
+    /* INV-MEM4 */
+    TEST_ASSERT(g_fill_bad[LEN_TAIL] == 0U, "INV-MEM4:FillWords0to3");
+    TEST_ASSERT(g_fill_bad[LEN_SHORT] == 0U, "INV-MEM4:FillWords4to15");
+    TEST_ASSERT(g_fill_bad[LEN_LONG] == 0U, "INV-MEM4:FillWords16up");
+
+    /* INV-MEM5 */
+    TEST_ASSERT(g_scan_bad[LEN_TAIL] == 0U, "INV-MEM5:ScanWords0to3");
+    TEST_ASSERT(g_scan_bad[LEN_SHORT] == 0U, "INV-MEM5:ScanWords4to15");
+    TEST_ASSERT(g_scan_bad[LEN_LONG] == 0U, "INV-MEM5:ScanWords16up");
+
+    TEST_EMIT_VERDICT();
+
+    test_log_task("END", "Checker");
+    while (1)
+    {
+        rtos_delay_ms(1000);
+    }
+}
+
+/* =================== Timer Callbacks =================== */
+
+static void startup_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    g_test_started = true;
+    test_log_framework("BEGIN", "RtosMem");
+    rtos_timer_handle_t *p = (rtos_timer_handle_t *) param;
+    rtos_timer_start(*p);
+}
+
+static void test_timeout_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_complete = true;
+    test_log_framework("TIMEOUT", "RtosMem");
+}
+
+/* =================== Main =================== */
+
+__attribute__((__noreturn__)) int main(void)
+{
+    rtos_status_t       status;
+    rtos_timer_handle_t startup_timer;
+
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_ALL);
+
+    log_info("Kernel Memory Routines vs. memcpy/memset Test");
+    log_info("Byte lengths: 0..%u + %u long  Words: 0..%u + %u long  block_transfer=%u", SWEEP_MAX_LEN - 1U,
+             (unsigned) LONG_LEN_COUNT, SWEEP_MAX_WORDS, (unsigned) LONG_WORDS_COUNT, (unsigned) PORT_HAS_BLOCK_TRANSFER);
+    log_info("Invariants: MEM1(copy) MEM2(zero) MEM3(copy_words) MEM4(fill_words) MEM5(scan_words)");
+
+    status = rtos_init();
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("RTOS init failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = test_create_startup_timer(startup_timer_callback, &g_test_timer, &startup_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Startup timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_timer_create("TestTimer", TEST_DURATION_MS, RTOS_TIMER_ONE_SHOT, test_timeout_callback, NULL,
+                               &g_test_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Test timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t checker_handle;
+    status = rtos_task_create(checker_task_func, "Check", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_CHECK_PRIORITY,
+                              &checker_handle);
+    if (status != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t flush_handle;
+    test_create_log_flush_task(&flush_handle);
+
+    log_info("Starting scheduler...");
+    status = rtos_start_scheduler();
+
+    indicate_system_failure();
+}
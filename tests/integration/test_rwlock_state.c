@@ -0,0 +1,316 @@
+/*******************************************************************************
+ * File: tests/integration/test_rwlock_state.c
+ * Description: Reader-Writer Lock - Sharing, Writer Priority and PIP Test
+ * Author: Student
+ * Date: 2025
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "config.h"
+#include "device.h" // IWYU pragma: keep
+#include "hardware_env.h"
+#include "rwlock.h"
+#include "semaphore.h"
+#include "task.h"
+#include "test_common.h"
+#include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
+#include "timer.h"
+#include "uart_tx.h"
+
+/**
+ * @file test_rwlock_state.c
+ * @brief Reader-Writer Lock Invariant Test
+ *
+ * SCENARIO
+ * --------
+ * Two readers take the read lock and hold it until Control releases them
+ * one by one; a writer arrives in between. Control then write-locks while
+ * a higher-priority reader arrives, and write-locks with a timeout while a
+ * reader holds the lock.
+ *
+ *   HighReader        (priority 5) — read-locks behind Control's write lock
+ *   Writer            (priority 4) — write-locks behind the two readers
+ *   ReaderA, ReaderB  (priority 3) — read-lock, hold, unlock on release
+ *   Control           (priority 2) — releases, checks
+ *
+ * Run log: 'a' / 'b' per reader unlock, 'W' per write, 'H' per high read.
+ *
+ * INVARIANTS
+ * ----------
+ * INV-RW1  Readers hold the lock at the same time.
+ * INV-RW2  A writer runs with no reader inside.
+ * INV-RW3  Once a writer waits, new readers are refused; it runs at the
+ *          unlock of the last reader that was inside.
+ * INV-RW4  A reader blocked by a writer raises the writer to its priority
+ *          until the write unlock, which lets it in before returning.
+ * INV-RW5  A write lock that times out on readers reopens the lock to
+ *          readers.
+ * INV-RW6  The write lock nests; unlocks by non-owners and read unlocks
+ *          without a reader are rejected.
+ */
+
+/* =================== Test Parameters =================== */
+
+#define TASK_HIGH_PRIORITY    (5U)
+#define TASK_WRITER_PRIORITY  (4U)
+#define TASK_READER_PRIORITY  (3U)
+#define TASK_CONTROL_PRIORITY (2U)
+
+#define WRITE_TIMEOUT_TICKS (2U)
+#define SCENARIO_CYCLES     (20U)
+#define SETTLE_MS           (5U)
+#define TEST_DURATION_MS    (6000U)
+
+/* =================== Shared State =================== */
+
+static volatile bool g_test_started  = false;
+static volatile bool g_test_complete = false;
+
+static rtos_timer_handle_t g_test_timer;
+
+static rtos_rwlock_t g_rwlock;
+
+typedef struct
+{
+    rtos_semaphore_t go;
+    rtos_semaphore_t hold;
+    char             id;
+} reader_t;
+
+static reader_t         g_reader_a = {.id = 'a'};
+static reader_t         g_reader_b = {.id = 'b'};
+static rtos_semaphore_t g_sem_writer;
+static rtos_semaphore_t g_sem_high;
+
+/* Run log, in run order */
+static volatile char     g_order[4];
+static volatile uint32_t g_order_len = 0;
+
+static volatile uint32_t g_readers_in_write = 0;
+
+/* =================== Helpers =================== */
+
+static void log_run(char id)
+{
+    if (g_order_len < sizeof(g_order))
+    {
+        g_order[g_order_len] = id;
+    }
+    g_order_len++;
+}
+
+/* =================== Task Implementations =================== */
+
+static void reader_task_func(void *param)
+{
+    reader_t *r = (reader_t *) param;
+
+    while (1)
+    {
+        if (rtos_semaphore_wait(&r->go, RTOS_SEM_MAX_WAIT) == RTOS_SEM_OK)
+        {
+            TEST_ASSERT(rtos_rwlock_read_lock(&g_rwlock, RTOS_MAX_WAIT) == RTOS_SUCCESS, "INV-RW1:ReadLock");
+            rtos_semaphore_wait(&r->hold, RTOS_SEM_MAX_WAIT);
+            rtos_rwlock_read_unlock(&g_rwlock);
+            log_run(r->id);
+        }
+    }
+}
+
+static void writer_task_func(void *param)
+{
+    (void) param;
+
+    while (1)
+    {
+        if (rtos_semaphore_wait(&g_sem_writer, RTOS_SEM_MAX_WAIT) == RTOS_SEM_OK)
+        {
+            TEST_ASSERT(rtos_rwlock_write_lock(&g_rwlock, RTOS_MAX_WAIT) == RTOS_SUCCESS, "INV-RW2:WriteLock");
+            g_readers_in_write += rtos_rwlock_get_reader_count(&g_rwlock);
+            log_run('W');
+            rtos_rwlock_write_unlock(&g_rwlock);
+        }
+    }
+}
+
+static void high_task_func(void *param)
+{
+    (void) param;
+
+    while (1)
+    {
+        if (rtos_semaphore_wait(&g_sem_high, RTOS_SEM_MAX_WAIT) == RTOS_SEM_OK)
+        {
+            TEST_ASSERT(rtos_rwlock_read_lock(&g_rwlock, RTOS_MAX_WAIT) == RTOS_SUCCESS, "INV-RW4:HighReadLock");
+            log_run('H');
+            rtos_rwlock_read_unlock(&g_rwlock);
+        }
+    }
+}
+
+static void control_task_func(void *param)
+{
+    (void) param;
+    rtos_task_handle_t self = rtos_task_get_current();
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Control");
+
+    /* --- Parameters and ownership (once) --- */
+    TEST_ASSERT(rtos_rwlock_init(NULL) == RTOS_ERROR_INVALID_PARAM, "INV-RW6:InitNull");
+    TEST_ASSERT(rtos_rwlock_read_unlock(&g_rwlock) == RTOS_ERROR_INVALID_STATE, "INV-RW6:ReadUnlockUnheld");
+    TEST_ASSERT(rtos_rwlock_write_unlock(&g_rwlock) == RTOS_ERROR_INVALID_PARAM, "INV-RW6:WriteUnlockUnowned");
+
+    TEST_ASSERT(rtos_rwlock_write_lock(&g_rwlock, RTOS_NO_WAIT) == RTOS_SUCCESS, "INV-RW6:WriteLock");
+    TEST_ASSERT(rtos_rwlock_write_lock(&g_rwlock, RTOS_NO_WAIT) == RTOS_SUCCESS, "INV-RW6:WriteLockNested");
+    TEST_ASSERT(rtos_rwlock_write_unlock(&g_rwlock) == RTOS_SUCCESS, "INV-RW6:InnerUnlock");
+    TEST_ASSERT(rtos_rwlock_read_lock(&g_rwlock, RTOS_NO_WAIT) == RTOS_ERROR_TIMEOUT, "INV-RW6:StillWriteLocked");
+    TEST_ASSERT(rtos_rwlock_write_unlock(&g_rwlock) == RTOS_SUCCESS, "INV-RW6:OuterUnlock");
+    TEST_ASSERT(rtos_rwlock_read_lock(&g_rwlock, RTOS_NO_WAIT) == RTOS_SUCCESS, "INV-RW6:Reopened");
+    rtos_rwlock_read_unlock(&g_rwlock);
+
+    for (uint32_t cycle = 0; cycle < SCENARIO_CYCLES && !g_test_complete; cycle++)
+    {
+        rtos_delay_ms(SETTLE_MS);
+
+        /* --- Shared readers, a writer behind them --- */
+        g_order_len = 0;
+
+        rtos_semaphore_signal(&g_reader_a.go);
+        rtos_semaphore_signal(&g_reader_b.go);
+        TEST_ASSERT(rtos_rwlock_get_reader_count(&g_rwlock) == 2U, "INV-RW1:BothInside");
+
+        rtos_semaphore_signal(&g_sem_writer);
+        TEST_ASSERT(g_order_len == 0, "INV-RW3:WriterWaits");
+        TEST_ASSERT(rtos_rwlock_read_lock(&g_rwlock, RTOS_NO_WAIT) == RTOS_ERROR_TIMEOUT, "INV-RW3:NewReaderRefused");
+
+        rtos_semaphore_signal(&g_reader_a.hold);
+        TEST_ASSERT(g_order_len == 1U && g_order[0] == 'a', "INV-RW3:WriterWaitsForLast");
+
+        rtos_semaphore_signal(&g_reader_b.hold);
+        TEST_ASSERT(g_order_len == 3U && g_order[1] == 'W' && g_order[2] == 'b', "INV-RW3:WriterAtLastUnlock");
+        TEST_ASSERT(g_readers_in_write == 0, "INV-RW2:NoReaderInWrite");
+
+        /* --- A high reader behind Control's write lock --- */
+        g_order_len = 0;
+
+        TEST_ASSERT(rtos_rwlock_write_lock(&g_rwlock, RTOS_MAX_WAIT) == RTOS_SUCCESS, "INV-RW4:ControlWriteLock");
+        rtos_semaphore_signal(&g_sem_high);
+        TEST_ASSERT(g_order_len == 0, "INV-RW4:HighBlocked");
+        TEST_ASSERT(rtos_task_get_priority(self) == TASK_HIGH_PRIORITY, "INV-RW4:WriterInherits");
+
+        rtos_rwlock_write_unlock(&g_rwlock);
+        TEST_ASSERT(g_order_len == 1U && g_order[0] == 'H', "INV-RW4:HighRanAtUnlock");
+        TEST_ASSERT(rtos_task_get_priority(self) == TASK_CONTROL_PRIORITY, "INV-RW4:Restored");
+
+        /* --- A write lock that times out on a reader --- */
+        g_order_len = 0;
+
+        rtos_semaphore_signal(&g_reader_a.go);
+        TEST_ASSERT(rtos_rwlock_write_lock(&g_rwlock, WRITE_TIMEOUT_TICKS) == RTOS_ERROR_TIMEOUT,
+                    "INV-RW5:WriteTimesOut");
+        TEST_ASSERT(rtos_rwlock_read_lock(&g_rwlock, RTOS_NO_WAIT) == RTOS_SUCCESS, "INV-RW5:ReadersReadmitted");
+        TEST_ASSERT(rtos_rwlock_get_reader_count(&g_rwlock) == 2U, "INV-RW5:SharedAgain");
+        rtos_rwlock_read_unlock(&g_rwlock);
+
+        rtos_semaphore_signal(&g_reader_a.hold);
+        TEST_ASSERT(g_order_len == 1U && rtos_rwlock_get_reader_count(&g_rwlock) == 0, "INV-RW5:ReaderLeft");
+    }
+
+    TEST_EMIT_VERDICT();
+
+    test_log_task("END", "Control");
+    while (1)
+    {
+        rtos_delay_ms(1000);
+    }
+}
+
+/* =================== Timer Callbacks =================== */
+
+static void startup_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    g_test_started = true;
+    test_log_framework("BEGIN", "RWLock");
+    rtos_timer_handle_t *p = (rtos_timer_handle_t *) param;
+    rtos_timer_start(*p);
+}
+
+static void test_timeout_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_complete = true;
+    test_log_framework("TIMEOUT", "RWLock");
+}
+
+/* =================== Main =================== */
+
+__attribute__((__noreturn__)) int main(void)
+{
+    rtos_status_t       status;
+    rtos_timer_handle_t startup_timer;
+
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_ALL);
+
+    log_info("Reader-Writer Lock Test");
+    log_info("High prio=%u  Writer prio=%u  Readers prio=%u  Control prio=%u", TASK_HIGH_PRIORITY,
+             TASK_WRITER_PRIORITY, TASK_READER_PRIORITY, TASK_CONTROL_PRIORITY);
+    log_info("Invariants: RW1(shared) RW2(exclusive) RW3(writer first) RW4(pip) RW5(timeout) RW6(params)");
+
+    status = rtos_init();
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("RTOS init failed: %d", status);
+        indicate_system_failure();
+    }
+
+    if (rtos_rwlock_init(&g_rwlock) != RTOS_SUCCESS || rtos_semaphore_init(&g_reader_a.go, 0, 1) != RTOS_SEM_OK ||
+        rtos_semaphore_init(&g_reader_a.hold, 0, 1) != RTOS_SEM_OK ||
+        rtos_semaphore_init(&g_reader_b.go, 0, 1) != RTOS_SEM_OK ||
+        rtos_semaphore_init(&g_reader_b.hold, 0, 1) != RTOS_SEM_OK ||
+        rtos_semaphore_init(&g_sem_writer, 0, 1) != RTOS_SEM_OK || rtos_semaphore_init(&g_sem_high, 0, 1) != RTOS_SEM_OK)
+    {
+        indicate_system_failure();
+    }
+
+    status = test_create_startup_timer(startup_timer_callback, &g_test_timer, &startup_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Startup timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_timer_create("TestTimer", TEST_DURATION_MS, RTOS_TIMER_ONE_SHOT, test_timeout_callback, NULL,
+                               &g_test_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Test timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t handle;
+    if (rtos_task_create(high_task_func, "High", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_HIGH_PRIORITY, &handle) !=
+            RTOS_SUCCESS ||
+        rtos_task_create(writer_task_func, "Writer", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_WRITER_PRIORITY,
+                         &handle) != RTOS_SUCCESS ||
+        rtos_task_create(reader_task_func, "ReaderA", RTOS_DEFAULT_TASK_STACK_SIZE, &g_reader_a, TASK_READER_PRIORITY,
+                         &handle) != RTOS_SUCCESS ||
+        rtos_task_create(reader_task_func, "ReaderB", RTOS_DEFAULT_TASK_STACK_SIZE, &g_reader_b, TASK_READER_PRIORITY,
+                         &handle) != RTOS_SUCCESS ||
+        rtos_task_create(control_task_func, "Control", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_CONTROL_PRIORITY,
+                         &handle) != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t flush_handle;
+    test_create_log_flush_task(&flush_handle);
+
+    log_info("Starting scheduler...");
+    status = rtos_start_scheduler();
+
+    indicate_system_failure();
+}
@@ -0,0 +1,406 @@
+/*******************************************************************************
+ * File: tests/integration/test_sched_stats_state.c
+ * Description: Scheduler Statistics Counters - State Invariant Test
+ * Author: Student
+ * Date: 2025
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "config.h"
+#include "device.h" // IWYU pragma: keep
+#include "hardware_env.h"
+#include "klog.h"
+#include "rtos_port.h"
+#include "scheduler.h"
+#include "task.h"
+#include "test_common.h"
+#include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
+#include "timer.h"
+#include "uart_tx.h"
+
+/**
+ * @file test_sched_stats_state.c
+ * @brief Scheduler Statistics Test
+ *
+ * SCENARIO
+ * --------
+ * Three workers wait for a notification and then run the controller's
+ * command: return at once, sleep 1 ms ten times, or sleep 50 ms. The
+ * controller drives them and reads rtos_scheduler_get_statistics():
+ *
+ *   Worker[0..2] (priority 3) — notified, run the command, block again
+ *   Controller   (priority 2) — issues commands, checks invariants
+ *   Monitor      (priority 1) — emits final verdict
+ *
+ * INVARIANTS
+ * ----------
+ * INV-SS1  After rtos_scheduler_reset_statistics() the counters read 0 and
+ *          the high-water marks equal the current lengths; NULL is rejected
+ * INV-SS2  Waking a higher-priority task preempts the caller: each give
+ *          adds a preemption (controller stays ready) and a voluntary
+ *          switch (worker blocks again)
+ * INV-SS3  Every expired delay is a tick wake
+ * INV-SS4  Three tasks sleeping at once raise the delayed high-water mark
+ *          to 3; three tasks made ready by one resume raise the ready mark
+ * INV-SS5  Ticks that arrive with the scheduler suspended are counted
+ * INV-SS6  context_switches == preemptions + voluntary_switches
+ * INV-SS7  rtos_scheduler_log_statistics() writes one KLog record per field
+ * INV-SS8  A yield with no ready task at or above the caller's priority is
+ *          elided: counted in elided_switches, no context switch
+ */
+
+/* =================== Test Parameters =================== */
+
+#define TASK_WORKER_PRIORITY (3U)
+#define TASK_CTRL_PRIORITY   (2U)
+#define TASK_MON_PRIORITY    (1U)
+
+#define SETTLE_MS        (20U)
+#define MONITOR_POLL_MS  (20U)
+#define IDLE_SPIN_MS     (1000U)
+#define TEST_DURATION_MS (2000U)
+
+#define WORKERS       (3U)
+#define GIVES         (8U)
+#define SHORT_SLEEPS  (10U)
+#define LONG_SLEEP_MS (50U)
+#define SUSPEND_TICKS (5U)
+#define YIELDS        (8U)
+
+typedef enum
+{
+    CMD_RETURN = 0,
+    CMD_SHORT_SLEEPS,
+    CMD_LONG_SLEEP
+} worker_cmd_t;
+
+/* TEST_ASSERT, ASSERT_STATE, g_fail_count are in test_common.h */
+
+/* =================== Shared State =================== */
+
+static volatile bool g_test_started  = false;
+static volatile bool g_test_complete = false;
+
+static rtos_timer_handle_t g_test_timer;
+static rtos_task_handle_t  g_workers[WORKERS];
+
+static volatile worker_cmd_t g_cmd[WORKERS];
+static volatile uint32_t     g_done[WORKERS];
+
+/* =================== Task Implementations =================== */
+
+/*
+ * Worker (priority 3).
+ * Blocks on its notification, runs the command, counts it done.
+ */
+static void worker_task_func(void *param)
+{
+    uint32_t id = (uint32_t) (uintptr_t) param;
+
+    for (;;)
+    {
+        (void) rtos_task_notify_take(true, RTOS_MAX_DELAY);
+
+        switch (g_cmd[id])
+        {
+            case CMD_SHORT_SLEEPS:
+                for (uint32_t i = 0; i < SHORT_SLEEPS; i++)
+                {
+                    rtos_delay_ms(1U);
+                }
+                break;
+            case CMD_LONG_SLEEP:
+                rtos_delay_ms(LONG_SLEEP_MS);
+                break;
+            default:
+                break;
+        }
+        g_done[id]++;
+    }
+}
+
+static void read_stats(rtos_scheduler_stats_t *stats)
+{
+    TEST_ASSERT(rtos_scheduler_get_statistics(stats) == RTOS_SUCCESS, "INV-SS1:Read");
+    /* INV-SS6 */
+    TEST_ASSERT(stats->context_switches == stats->preemptions + stats->voluntary_switches, "INV-SS6:SwitchSplit");
+}
+
+static void check_reset(void)
+{
+    rtos_scheduler_stats_t stats;
+
+    /* INV-SS1: nothing may switch between the reset and the read */
+    rtos_port_enter_critical();
+    rtos_scheduler_reset_statistics();
+    TEST_ASSERT(rtos_scheduler_get_statistics(&stats) == RTOS_SUCCESS, "INV-SS1:Read");
+    rtos_port_exit_critical();
+
+    TEST_ASSERT(stats.context_switches == 0U && stats.preemptions == 0U && stats.voluntary_switches == 0U &&
+                    stats.tick_wakes == 0U && stats.suspended_ticks == 0U,
+                "INV-SS1:CountersZero");
+    TEST_ASSERT(stats.ready_high_water == stats.ready_count && stats.delayed_high_water == stats.delayed_count,
+                "INV-SS1:HighWaterIsCurrent");
+    TEST_ASSERT(rtos_scheduler_get_statistics(NULL) == RTOS_ERROR_INVALID_PARAM, "INV-SS1:NullRejected");
+}
+
+static void check_preemptions(void)
+{
+    rtos_scheduler_stats_t before;
+    rtos_scheduler_stats_t after;
+
+    /* INV-SS2 */
+    g_cmd[0]       = CMD_RETURN;
+    uint32_t done0 = g_done[0];
+    read_stats(&before);
+    for (uint32_t i = 0; i < GIVES; i++)
+    {
+        (void) rtos_task_notify_give(g_workers[0]);
+    }
+    read_stats(&after);
+
+    TEST_ASSERT(g_done[0] == done0 + GIVES, "INV-SS2:WorkerRanEachTime");
+    TEST_ASSERT(after.preemptions - before.preemptions >= GIVES, "INV-SS2:Preemptions");
+    TEST_ASSERT(after.voluntary_switches - before.voluntary_switches >= GIVES, "INV-SS2:VoluntarySwitches");
+}
+
+static void check_tick_wakes(void)
+{
+    rtos_scheduler_stats_t before;
+    rtos_scheduler_stats_t after;
+
+    /* INV-SS3 */
+    g_cmd[0]       = CMD_SHORT_SLEEPS;
+    uint32_t done0 = g_done[0];
+    read_stats(&before);
+    (void) rtos_task_notify_give(g_workers[0]);
+    rtos_delay_ms(SHORT_SLEEPS * 3U);
+    read_stats(&after);
+
+    TEST_ASSERT(g_done[0] == done0 + 1U, "INV-SS3:SleepsDone");
+    TEST_ASSERT(after.tick_wakes - before.tick_wakes >= SHORT_SLEEPS + 1U, "INV-SS3:TickWakes");
+}
+
+static void check_high_water(void)
+{
+    rtos_scheduler_stats_t stats;
+
+    /* INV-SS4: delayed */
+    rtos_scheduler_reset_statistics();
+    for (uint32_t i = 0; i < WORKERS; i++)
+    {
+        g_cmd[i] = CMD_LONG_SLEEP;
+        (void) rtos_task_notify_give(g_workers[i]);
+    }
+    rtos_delay_ms(LONG_SLEEP_MS / 5U);
+    read_stats(&stats);
+
+    TEST_ASSERT(stats.delayed_count >= WORKERS, "INV-SS4:DelayedNow");
+    TEST_ASSERT(stats.delayed_high_water >= stats.delayed_count, "INV-SS4:DelayedHighWater");
+
+    rtos_delay_ms(LONG_SLEEP_MS * 2U);
+
+    /* INV-SS4: ready, all three queued by the one resume */
+    rtos_scheduler_reset_statistics();
+    read_stats(&stats);
+    uint8_t ready_before = stats.ready_high_water;
+
+    rtos_scheduler_suspend();
+    for (uint32_t i = 0; i < WORKERS; i++)
+    {
+        g_cmd[i] = CMD_RETURN;
+        (void) rtos_task_notify_give(g_workers[i]);
+    }
+    (void) rtos_scheduler_resume();
+    read_stats(&stats);
+
+    TEST_ASSERT(stats.ready_high_water >= WORKERS && stats.ready_high_water >= ready_before, "INV-SS4:ReadyHighWater");
+}
+
+static void check_suspended_ticks(void)
+{
+    rtos_scheduler_stats_t before;
+    rtos_scheduler_stats_t after;
+
+    /* INV-SS5 */
+    read_stats(&before);
+    rtos_scheduler_suspend();
+    rtos_tick_t start = rtos_get_tick_count();
+    while (rtos_get_tick_count() - start < SUSPEND_TICKS)
+    {
+    }
+    (void) rtos_scheduler_resume();
+    read_stats(&after);
+
+    TEST_ASSERT(after.suspended_ticks - before.suspended_ticks >= SUSPEND_TICKS - 1U, "INV-SS5:SuspendedTicks");
+}
+
+static void check_elided_yields(void)
+{
+    rtos_scheduler_stats_t before;
+    rtos_scheduler_stats_t after;
+
+    /* INV-SS8: the workers are blocked and every other task is below the controller */
+    read_stats(&before);
+    for (uint32_t i = 0; i < YIELDS; i++)
+    {
+        rtos_yield();
+    }
+    read_stats(&after);
+
+    TEST_ASSERT(after.elided_switches - before.elided_switches >= YIELDS, "INV-SS8:YieldElided");
+    TEST_ASSERT(after.context_switches - before.context_switches < YIELDS, "INV-SS8:NoSwitch");
+}
+
+static void check_log_export(void)
+{
+    /* INV-SS7: the controller outranks the log flush task, so nothing drains meanwhile;
+     * a time-epoch record may precede the first one */
+    uint32_t pending = klog_pending();
+    uint32_t dropped = klog_get_dropped();
+
+    rtos_scheduler_log_statistics();
+
+    TEST_ASSERT(klog_pending() - pending >= RTOS_SCHED_STAT_COUNT || klog_get_dropped() != dropped,
+                "INV-SS7:OneRecordPerField");
+}
+
+/*
+ * Controller (priority 2).
+ */
+static void ctrl_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Controller");
+
+    rtos_delay_ms(SETTLE_MS);
+
+    check_reset();
+    check_preemptions();
+    check_tick_wakes();
+    check_high_water();
+    check_suspended_ticks();
+    check_elided_yields();
+    check_log_export();
+
+    test_log_task("END", "Controller");
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+/*
+ * Monitor task (priority 1).
+ * Emits the final PASS/FAIL verdict.
+ */
+static void monitor_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Monitor");
+
+    while (!g_test_complete)
+    {
+        rtos_delay_ms(MONITOR_POLL_MS);
+    }
+
+    /* Final verdict */
+    TEST_EMIT_VERDICT();
+
+    test_log_task("END", "Monitor");
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+/* =================== Timer Callbacks =================== */
+
+static void startup_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    g_test_started = true;
+    test_log_framework("BEGIN", "SchedStatsState");
+    rtos_timer_handle_t *p = (rtos_timer_handle_t *) param;
+    rtos_timer_start(*p);
+}
+
+static void test_timeout_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_complete = true;
+    test_log_framework("TIMEOUT", "SchedStatsState");
+}
+
+/* =================== Main =================== */
+
+__attribute__((__noreturn__)) int main(void)
+{
+    rtos_status_t       status;
+    rtos_timer_handle_t startup_timer;
+    rtos_task_handle_t  handle;
+
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_ALL);
+
+    log_info("Scheduler Statistics Test");
+    log_info("Priorities: Workers=%u Ctrl=%u Mon=%u", TASK_WORKER_PRIORITY, TASK_CTRL_PRIORITY, TASK_MON_PRIORITY);
+    log_info("Invariants: SS1(reset) SS2(preempt) SS3(tick_wake) SS4(high_water) SS5(suspend) SS6(split) SS7(log)"
+             " SS8(elided)");
+
+    status = rtos_init();
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("RTOS init failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = test_create_startup_timer(startup_timer_callback, &g_test_timer, &startup_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Startup timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_timer_create("TestTimer", TEST_DURATION_MS, RTOS_TIMER_ONE_SHOT, test_timeout_callback, NULL,
+                               &g_test_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Test timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    for (uint32_t i = 0; i < WORKERS; i++)
+    {
+        if (rtos_task_create(worker_task_func, "Worker", RTOS_DEFAULT_TASK_STACK_SIZE, (void *) (uintptr_t) i,
+                             TASK_WORKER_PRIORITY, &g_workers[i]) != RTOS_SUCCESS)
+        {
+            indicate_system_failure();
+        }
+    }
+
+    if (rtos_task_create(ctrl_task_func, "Controller", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_CTRL_PRIORITY,
+                         &handle) != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    if (rtos_task_create(monitor_task_func, "Monitor", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_MON_PRIORITY,
+                         &handle) != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t flush_handle;
+    test_create_log_flush_task(&flush_handle);
+
+    log_info("Starting scheduler...");
+    status = rtos_start_scheduler();
+
+    indicate_system_failure();
+}
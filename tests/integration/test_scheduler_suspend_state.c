@@ -0,0 +1,318 @@
+/*******************************************************************************
+ * File: tests/integration/test_scheduler_suspend_state.c
+ * Description: Scheduler Suspend/Resume - Pending-Ready List Test
+ * Author: Student
+ * Date: 2025
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "config.h"
+#include "device.h" // IWYU pragma: keep
+#include "hardware_env.h"
+#include "rtos_assert.h"
+#include "rtos_port.h"
+#include "semaphore.h"
+#include "task.h"
+#include "test_common.h"
+#include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
+#include "timer.h"
+#include "uart_tx.h"
+
+/**
+ * @file test_scheduler_suspend_state.c
+ * @brief Scheduler Suspension Invariant Test
+ *
+ * SCENARIO
+ * --------
+ * Control suspends the scheduler and, while suspended, pends a spare
+ * peripheral interrupt (TEST_IRQn) whose handler gives the semaphores two
+ * higher-priority waiters block on. It also spins across ticks while a
+ * higher-priority sleeper's delay expires.
+ *
+ *   WaiterA, WaiterB (priority 3) — take their semaphore, log the order
+ *   Sleeper          (priority 3) — delays SLEEP_TICKS, counts wakeups
+ *   Control          (priority 2) — suspends, triggers, resumes, checks
+ *
+ * INVARIANTS
+ * ----------
+ * INV-SS1  Interrupts run while the scheduler is suspended: the handler
+ *          runs as soon as it is pended, and the tick count still advances.
+ * INV-SS2  No task made ready while suspended runs before the resume, though
+ *          it outranks Control (ISR wakeups and expired delays alike).
+ * INV-SS3  The outermost resume runs every pending task before it returns,
+ *          in the order they were made ready.
+ * INV-SS4  Suspension nests: an inner resume leaves the scheduler suspended.
+ * INV-SS5  A delay that expired while suspended ends on resume.
+ * INV-SS6  A pending task suspended before the resume stays off the ready
+ *          lists and runs only after rtos_task_resume().
+ * INV-SS7  rtos_scheduler_resume() without a suspend is RTOS_ERROR_INVALID_STATE.
+ */
+
+/* =================== Test Parameters =================== */
+
+#define TASK_WAITER_PRIORITY  (3U)
+#define TASK_CONTROL_PRIORITY (2U)
+
+#define TEST_IRQn        TEST_SPARE_IRQn
+#define TEST_IRQ_PRIO    (14U) /* Below the kernel BASEPRI threshold */
+#define SPIN_TICKS       (5U)
+#define SLEEP_TICKS      (2U)
+#define SCENARIO_CYCLES  (20U)
+#define SETTLE_MS        (5U)
+#define TEST_DURATION_MS (6000U)
+
+/* =================== Shared State =================== */
+
+static volatile bool g_test_started  = false;
+static volatile bool g_test_complete = false;
+
+static rtos_timer_handle_t g_test_timer;
+
+static rtos_semaphore_t g_sem_a;
+static rtos_semaphore_t g_sem_b;
+
+static rtos_task_handle_t g_waiter_b;
+
+static volatile uint32_t g_isr_count = 0;
+static volatile bool     g_isr_give_b;
+
+/* Wake log: 'A' / 'B' per waiter run, in run order */
+static volatile char     g_order[2];
+static volatile uint32_t g_order_len = 0;
+
+static volatile uint32_t g_sleeper_wakes = 0;
+
+/* =================== Helpers =================== */
+
+static void spin_ticks(rtos_tick_t ticks)
+{
+    rtos_tick_t start = rtos_get_tick_count();
+    while ((rtos_tick_t) (rtos_get_tick_count() - start) < ticks)
+    {
+    }
+}
+
+static void log_run(char id)
+{
+    if (g_order_len < sizeof(g_order))
+    {
+        g_order[g_order_len] = id;
+    }
+    g_order_len++;
+}
+
+/* =================== Interrupt Handler =================== */
+
+void TEST_SPARE_IRQHandler(void)
+{
+    bool woken = false;
+
+    rtos_semaphore_signal_from_isr(&g_sem_a, &woken);
+    if (g_isr_give_b)
+    {
+        rtos_semaphore_signal_from_isr(&g_sem_b, &woken);
+    }
+    g_isr_count++;
+
+    if (woken)
+    {
+        rtos_port_yield();
+    }
+}
+
+static void trigger_irq(bool give_b)
+{
+    g_isr_give_b = give_b;
+    NVIC_SetPendingIRQ(TEST_IRQn);
+    __DSB();
+    __ISB();
+}
+
+/* =================== Task Implementations =================== */
+
+static void waiter_a_task_func(void *param)
+{
+    (void) param;
+
+    while (1)
+    {
+        if (rtos_semaphore_wait(&g_sem_a, RTOS_SEM_MAX_WAIT) == RTOS_SEM_OK)
+        {
+            log_run('A');
+        }
+    }
+}
+
+static void waiter_b_task_func(void *param)
+{
+    (void) param;
+
+    while (1)
+    {
+        if (rtos_semaphore_wait(&g_sem_b, RTOS_SEM_MAX_WAIT) == RTOS_SEM_OK)
+        {
+            log_run('B');
+        }
+    }
+}
+
+static void sleeper_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+
+    while (1)
+    {
+        rtos_delay_ticks(SLEEP_TICKS);
+        g_sleeper_wakes++;
+    }
+}
+
+static void control_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Control");
+
+    TEST_ASSERT(rtos_scheduler_resume() == RTOS_ERROR_INVALID_STATE, "INV-SS7:ResumeUnsuspended");
+
+    for (uint32_t cycle = 0; cycle < SCENARIO_CYCLES && !g_test_complete; cycle++)
+    {
+        rtos_delay_ms(SETTLE_MS);
+
+        /* --- ISR wakeups while suspended --- */
+        g_order_len          = 0;
+        uint32_t isr_before  = g_isr_count;
+        uint32_t wake_before = g_sleeper_wakes;
+
+        rtos_scheduler_suspend();
+
+        rtos_tick_t tick_before = rtos_get_tick_count();
+        trigger_irq(true);
+        TEST_ASSERT(g_isr_count == isr_before + 1U, "INV-SS1:HandlerRan");
+
+        spin_ticks(SPIN_TICKS); /* Sleeper's delay expires in here */
+        TEST_ASSERT(rtos_get_tick_count() - tick_before >= SPIN_TICKS, "INV-SS1:TickAdvanced");
+        TEST_ASSERT(g_order_len == 0, "INV-SS2:WaitersHeld");
+        TEST_ASSERT(g_sleeper_wakes == wake_before, "INV-SS2:SleeperHeld");
+
+        /* --- Nesting --- */
+        rtos_scheduler_suspend();
+        TEST_ASSERT(rtos_scheduler_resume() == RTOS_SUCCESS, "INV-SS4:InnerResume");
+        TEST_ASSERT(g_order_len == 0, "INV-SS4:StillSuspended");
+
+        TEST_ASSERT(rtos_scheduler_resume() == RTOS_SUCCESS, "INV-SS3:Resume");
+        TEST_ASSERT(g_order_len == 2U, "INV-SS3:AllRanAtResume");
+        TEST_ASSERT(g_order[0] == 'A' && g_order[1] == 'B', "INV-SS3:ReadyOrder");
+        TEST_ASSERT(g_sleeper_wakes == wake_before + 1U, "INV-SS5:DelayEndedAtResume");
+
+        /* --- A pending task suspended before the resume --- */
+        g_order_len = 0;
+        rtos_scheduler_suspend();
+        trigger_irq(true);
+        TEST_ASSERT(rtos_task_suspend(g_waiter_b) == RTOS_SUCCESS, "INV-SS6:SuspendPending");
+        rtos_scheduler_resume();
+
+        TEST_ASSERT(g_order_len == 1U && g_order[0] == 'A', "INV-SS6:OnlyAran");
+        TEST_ASSERT(rtos_task_get_state(g_waiter_b) == RTOS_TASK_STATE_SUSPENDED, "INV-SS6:StaysSuspended");
+
+        TEST_ASSERT(rtos_task_resume(g_waiter_b) == RTOS_SUCCESS, "INV-SS6:ResumeTask");
+        TEST_ASSERT(g_order_len == 2U && g_order[1] == 'B', "INV-SS6:RanAfterTaskResume");
+    }
+
+    TEST_EMIT_VERDICT();
+
+    test_log_task("END", "Control");
+    while (1)
+    {
+        rtos_delay_ms(1000);
+    }
+}
+
+/* =================== Timer Callbacks =================== */
+
+static void startup_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    g_test_started = true;
+    test_log_framework("BEGIN", "SchedSuspend");
+    rtos_timer_handle_t *p = (rtos_timer_handle_t *) param;
+    rtos_timer_start(*p);
+}
+
+static void test_timeout_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_complete = true;
+    test_log_framework("TIMEOUT", "SchedSuspend");
+}
+
+/* =================== Main =================== */
+
+__attribute__((__noreturn__)) int main(void)
+{
+    rtos_status_t       status;
+    rtos_timer_handle_t startup_timer;
+
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_ALL);
+
+    log_info("Scheduler Suspend/Resume Test");
+    log_info("Waiters prio=%u  Control prio=%u  Spin: %u ticks", TASK_WAITER_PRIORITY, TASK_CONTROL_PRIORITY,
+             SPIN_TICKS);
+    log_info("Invariants: SS1(irqs) SS2(held) SS3(resume) SS4(nest) SS5(delay) SS6(suspend) SS7(state)");
+
+    status = rtos_init();
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("RTOS init failed: %d", status);
+        indicate_system_failure();
+    }
+
+    if (rtos_semaphore_init(&g_sem_a, 0, 1) != RTOS_SEM_OK || rtos_semaphore_init(&g_sem_b, 0, 1) != RTOS_SEM_OK)
+    {
+        indicate_system_failure();
+    }
+
+    NVIC_SetPriority(TEST_IRQn, TEST_IRQ_PRIO);
+    NVIC_EnableIRQ(TEST_IRQn);
+
+    status = test_create_startup_timer(startup_timer_callback, &g_test_timer, &startup_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Startup timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_timer_create("TestTimer", TEST_DURATION_MS, RTOS_TIMER_ONE_SHOT, test_timeout_callback, NULL,
+                               &g_test_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Test timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t handle;
+    if (rtos_task_create(waiter_a_task_func, "WaiterA", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_WAITER_PRIORITY,
+                         &handle) != RTOS_SUCCESS ||
+        rtos_task_create(waiter_b_task_func, "WaiterB", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_WAITER_PRIORITY,
+                         &g_waiter_b) != RTOS_SUCCESS ||
+        rtos_task_create(sleeper_task_func, "Sleeper", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_WAITER_PRIORITY,
+                         &handle) != RTOS_SUCCESS ||
+        rtos_task_create(control_task_func, "Control", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_CONTROL_PRIORITY,
+                         &handle) != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t flush_handle;
+    test_create_log_flush_task(&flush_handle);
+
+    log_info("Starting scheduler...");
+    status = rtos_start_scheduler();
+
+    indicate_system_failure();
+}
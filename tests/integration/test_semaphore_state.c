@@ -7,9 +7,10 @@
 
 #include "VRTOS.h"
 #include "config.h"
+#include "device.h" // IWYU pragma: keep
 #include "hardware_env.h"
+#include "rtos_port.h"
 #include "semaphore.h"
-#include "stm32f4xx_hal.h" // IWYU pragma: keep
 #include "task.h"
 #include "test_common.h"
 #include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
@@ -39,6 +40,10 @@
  * INV-S4  A timed-out wait returns RTOS_SEM_ERR_TIMEOUT; task is not
  *         BLOCKED afterward.
  * INV-S5  Count never exceeds max_count.
+ * INV-S6  rtos_semaphore_signal_from_isr() (TEST_IRQn pended by the Signaller)
+ *         raises the count with no waiter and leaves the woken flag clear;
+ *         with WaiterHigh blocked it sets the flag and WaiterHigh runs at
+ *         ISR exit.
  */
 
 /* =================== Test Parameters =================== */
@@ -54,6 +59,9 @@
 #define TIMEOUT_TEST_MS  (30U)
 #define TEST_DURATION_MS (5000U)
 
+#define TEST_IRQn     TEST_SPARE_IRQn
+#define TEST_IRQ_PRIO (14U) /* Below the kernel BASEPRI threshold */
+
 /* TEST_ASSERT, ASSERT_STATE, g_fail_count are in test_common.h */
 
 /* =================== Shared State =================== */
@@ -79,6 +87,25 @@ static volatile uint32_t g_low_acquired   = 0;
 
 static rtos_timer_handle_t g_test_timer;
 
+static volatile bool              g_isr_woken      = false;
+static volatile rtos_sem_status_t g_isr_status     = RTOS_SEM_OK;
+static volatile uint32_t          g_high_isr_woken = 0;
+
+/* =================== Interrupt Handler =================== */
+
+void TEST_SPARE_IRQHandler(void)
+{
+    bool woken = false;
+
+    g_isr_status = rtos_semaphore_signal_from_isr(&g_sem, &woken);
+    g_isr_woken  = woken;
+
+    if (woken)
+    {
+        rtos_port_yield();
+    }
+}
+
 /* =================== Task Implementations =================== */
 
 /*
@@ -141,6 +168,27 @@ static void signaller_task_func(void *param)
     TEST_ASSERT(s == RTOS_SEM_ERR_TIMEOUT, "INV-S4:TimeoutReturnCode");
     TEST_ASSERT(rtos_task_get_state(g_handle_sig) != RTOS_TASK_STATE_BLOCKED, "INV-S4:NotBlockedAfterTimeout");
 
+    /* INV-S6: ISR give with nobody waiting */
+    NVIC_SetPendingIRQ(TEST_IRQn);
+    __DSB();
+    __ISB();
+    TEST_ASSERT(g_isr_status == RTOS_SEM_OK, "INV-S6:IsrGiveStatus");
+    TEST_ASSERT(!g_isr_woken, "INV-S6:NoWokenWithoutWaiter");
+    TEST_ASSERT(rtos_semaphore_get_count(&g_sem) == 1, "INV-S6:IsrGiveCounts");
+    TEST_ASSERT(rtos_semaphore_wait(&g_sem, RTOS_SEM_NO_WAIT) == RTOS_SEM_OK, "INV-S6:TakeIsrGive");
+
+    /* INV-S6: ISR give wakes the blocked WaiterHigh at ISR exit */
+    g_contend_signal = SCENARIO_CYCLES + 1U;
+    rtos_delay_ms(SETTLE_MS);
+    ASSERT_STATE(g_handle_high, RTOS_TASK_STATE_BLOCKED, "INV-S6:HighBlocked");
+
+    NVIC_SetPendingIRQ(TEST_IRQn);
+    __DSB();
+    __ISB();
+    TEST_ASSERT(g_isr_woken, "INV-S6:WokenSetOnWake");
+    TEST_ASSERT(g_high_isr_woken == 1, "INV-S6:HighRanAtIsrExit");
+    TEST_ASSERT(rtos_semaphore_get_count(&g_sem) == 0, "INV-S6:CountStays0");
+
     test_log_task("END", "Signaller");
     while (1)
     {
@@ -178,6 +226,14 @@ static void waiter_high_func(void *param)
         g_high_done = 1;
     }
 
+    /* INV-S6: one more wait, satisfied from the ISR */
+    while (g_contend_signal <= last_signal)
+    {
+        rtos_delay_ms(5);
+    }
+    rtos_semaphore_wait(&g_sem, RTOS_SEM_MAX_WAIT);
+    g_high_isr_woken = 1;
+
     test_log_task("END", "WaiterHigh");
     while (1)
     {
@@ -291,7 +347,7 @@ __attribute__((__noreturn__)) int main(void)
     log_info("Priorities: Sig=%u Low=%u High=%u Mon=%u", TASK_SIG_PRIORITY, TASK_LOW_PRIORITY, TASK_HIGH_PRIORITY,
              TASK_MON_PRIORITY);
     log_info("Cycles: %u  SignalPeriod: %ums  Settle: %ums", SCENARIO_CYCLES, SIGNAL_PERIOD_MS, SETTLE_MS);
-    log_info("Invariants: S1(block) S2(count) S3(priority order) S4(timeout) S5(bounds)");
+    log_info("Invariants: S1(block) S2(count) S3(priority order) S4(timeout) S5(bounds) S6(ISR give)");
 
     status = rtos_init();
     if (status != RTOS_SUCCESS)
@@ -356,6 +412,9 @@ __attribute__((__noreturn__)) int main(void)
     rtos_task_handle_t flush_handle;
     test_create_log_flush_task(&flush_handle);
 
+    NVIC_SetPriority(TEST_IRQn, TEST_IRQ_PRIO);
+    NVIC_EnableIRQ(TEST_IRQn);
+
     log_info("Starting scheduler...");
     status = rtos_start_scheduler();
 
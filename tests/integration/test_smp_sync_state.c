@@ -0,0 +1,404 @@
+/*******************************************************************************
+ * File: tests/integration/test_smp_sync_state.c
+ * Description: SMP - Cross-Core Mutex, Semaphore & Event Group Invariant Test
+ * Author: Student
+ * Date: 2025
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "config.h"
+#include "device.h" // IWYU pragma: keep
+#include "event_group.h"
+#include "hardware_env.h"
+#include "mutex.h"
+#include "rtos_port.h"
+#include "semaphore.h"
+#include "task.h"
+#include "test_common.h"
+#include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
+#include "timer.h"
+#include "uart_tx.h"
+
+#if RTOS_SMP_CORES != 2
+#error "test_smp_sync_state needs RTOS_SMP_CORES = 2 (native_test_smp_sync_state)"
+#endif
+
+/**
+ * @file test_smp_sync_state.c
+ * @brief Cross-Core Synchronisation Invariant Test
+ *
+ * Every wakeup here crosses cores: the task that releases runs on one core,
+ * the task it wakes is pinned to the other. With RTOS_SMP_CORES = 2 the
+ * mutex, semaphore and event group lock-free fast paths are compiled out,
+ * so this checks the locked paths that replace them, and the IPI that
+ * hands each woken task to its core.
+ *
+ * SCENARIO
+ * --------
+ *   Worker0 (priority 2, core 0) — mutex rounds; gives Ping and waits Pong;
+ *                                   raises TEST_IRQn to set EG bits
+ *   Worker1 (priority 2, core 1) — mutex rounds; waits Ping and gives Pong;
+ *                                   waits the EG bits
+ *   Control (priority 1)         — starts each phase and checks
+ *
+ * Phase 1 — both workers lock the shared mutex ROUNDS times. Every other
+ * round holds it across a tick, so the other core finds it held and blocks;
+ * the rest hold it briefly, so one core locks while the other releases.
+ * Phase 2 — ROUNDS Ping/Pong handoffs on two binary semaphores.
+ * Phase 3 — ROUNDS event-group handoffs set from TEST_IRQn on core 0.
+ *
+ * INVARIANTS
+ * ----------
+ * INV-SMP1  A task pinned to a core only ever runs there.
+ * INV-SMP2  The mutex excludes across cores: no increment of the shared
+ *           counter made under it is lost.
+ * INV-SMP3  A release on one core wakes the waiter on the other: no lock,
+ *           take or wait_bits times out.
+ * INV-SMP4  Every round completes on both cores.
+ */
+
+/* =================== Test Parameters =================== */
+
+#define TASK_WORKER_PRIORITY  (2U)
+#define TASK_CONTROL_PRIORITY (1U)
+
+#define TEST_IRQn        TEST_SPARE_IRQn
+#define TEST_IRQ_PRIO    (14U) /* Below the kernel BASEPRI threshold */
+#define ROUNDS           (50U)
+#define WAIT_TICKS       (100U) /* Far above any handoff; reached only by a lost wakeup */
+#define SHORT_SPIN       (2000U)
+#define EG_ROUND_BIT     (1U << 0)
+#define PHASE_TIMEOUT_MS (3000U)
+#define TEST_DURATION_MS (15000U)
+
+/* =================== Shared State =================== */
+
+typedef enum
+{
+    PHASE_IDLE = 0,
+    PHASE_MUTEX,
+    PHASE_SEM,
+    PHASE_EG
+} smp_phase_t;
+
+static volatile bool g_test_started  = false;
+static volatile bool g_test_complete = false;
+
+static rtos_timer_handle_t g_test_timer;
+
+static rtos_mutex_t       g_mutex;
+static rtos_semaphore_t   g_ping;
+static rtos_semaphore_t   g_pong;
+static rtos_event_group_t g_eg;
+
+static rtos_task_handle_t g_worker[RTOS_SMP_CORES];
+
+static volatile smp_phase_t g_phase = PHASE_IDLE;
+static volatile uint32_t    g_done[RTOS_SMP_CORES];
+
+/* Checked by Control after each phase */
+static volatile uint32_t g_counter     = 0;
+static volatile uint32_t g_contended   = 0;
+static volatile uint32_t g_timeouts    = 0;
+static volatile uint32_t g_wrong_core  = 0;
+static volatile uint32_t g_isr_status  = RTOS_EG_OK;
+static volatile uint32_t g_rounds[RTOS_SMP_CORES];
+
+/* =================== Interrupt Handler =================== */
+
+void TEST_SPARE_IRQHandler(void)
+{
+    bool woken = false;
+
+    g_isr_status = rtos_event_group_set_bits_from_isr(&g_eg, EG_ROUND_BIT, &woken);
+    if (woken)
+    {
+        rtos_port_yield();
+    }
+}
+
+/* =================== Helpers =================== */
+
+static void check_core(uint32_t core)
+{
+    if (rtos_port_get_core_id() != core)
+    {
+        g_wrong_core++;
+    }
+}
+
+/* Busy until the next tick: the other core gets its turn meanwhile */
+static void spin_one_tick(void)
+{
+    rtos_tick_t start = rtos_get_tick_count();
+    while (rtos_get_tick_count() == start) {}
+}
+
+/* Busy for a moment: still running, not waiting, when the other core releases */
+static void spin_short(void)
+{
+    for (volatile uint32_t i = 0; i < SHORT_SPIN; i++) {}
+}
+
+static void mutex_rounds(uint32_t core)
+{
+    for (uint32_t r = 0; r < ROUNDS; r++)
+    {
+        if (rtos_mutex_lock(&g_mutex, WAIT_TICKS) != RTOS_MUTEX_OK)
+        {
+            g_timeouts++;
+            continue;
+        }
+        check_core(core);
+
+        /* Read-modify-write, on odd rounds across a tick: a second owner would lose one */
+        uint32_t value = g_counter;
+        if ((r & 1U) != 0U)
+        {
+            spin_one_tick();
+            if (rtos_task_get_state(g_worker[1U - core]) == RTOS_TASK_STATE_BLOCKED)
+            {
+                g_contended++;
+            }
+        }
+        g_counter = value + 1U;
+
+        rtos_mutex_unlock(&g_mutex);
+        g_rounds[core]++;
+
+        /* Even rounds: lock again while the other core may be releasing */
+        spin_short();
+    }
+}
+
+static void sem_rounds(uint32_t core)
+{
+    rtos_semaphore_t *give = (core == 0U) ? &g_ping : &g_pong;
+    rtos_semaphore_t *take = (core == 0U) ? &g_pong : &g_ping;
+
+    for (uint32_t r = 0; r < ROUNDS; r++)
+    {
+        if (core == 0U)
+        {
+            rtos_semaphore_signal(give);
+        }
+        if (rtos_semaphore_wait(take, WAIT_TICKS) != RTOS_SEM_OK)
+        {
+            g_timeouts++;
+            break;
+        }
+        check_core(core);
+        if (core == 1U)
+        {
+            rtos_semaphore_signal(give);
+        }
+        g_rounds[core]++;
+    }
+}
+
+static void eg_rounds(uint32_t core)
+{
+    for (uint32_t r = 0; r < ROUNDS; r++)
+    {
+        if (core == 0U)
+        {
+            NVIC_SetPendingIRQ(TEST_IRQn);
+            __DSB();
+            __ISB();
+            if (rtos_semaphore_wait(&g_pong, WAIT_TICKS) != RTOS_SEM_OK)
+            {
+                g_timeouts++;
+                break;
+            }
+        }
+        else
+        {
+            if (rtos_event_group_wait_bits(&g_eg, EG_ROUND_BIT, true, true, NULL, WAIT_TICKS) != RTOS_EG_OK)
+            {
+                g_timeouts++;
+                break;
+            }
+            rtos_semaphore_signal(&g_pong);
+        }
+        check_core(core);
+        g_rounds[core]++;
+    }
+}
+
+/* =================== Task Implementations =================== */
+
+static void worker_task_func(void *param)
+{
+    uint32_t    core = (uint32_t) (uintptr_t) param;
+    smp_phase_t seen = PHASE_IDLE;
+
+    while (1)
+    {
+        while (g_phase == seen)
+        {
+            rtos_delay_ticks(1);
+        }
+        seen = g_phase;
+        check_core(core);
+
+        if (seen == PHASE_MUTEX)
+        {
+            mutex_rounds(core);
+        }
+        else if (seen == PHASE_SEM)
+        {
+            sem_rounds(core);
+        }
+        else if (seen == PHASE_EG)
+        {
+            eg_rounds(core);
+        }
+        g_done[core]++;
+    }
+}
+
+/* Start a phase on both workers and wait until both have finished it */
+static bool run_phase(smp_phase_t phase)
+{
+    uint32_t done0 = g_done[0];
+    uint32_t done1 = g_done[1];
+
+    g_rounds[0] = 0;
+    g_rounds[1] = 0;
+    g_phase     = phase;
+
+    for (uint32_t waited = 0; (g_done[0] == done0 || g_done[1] == done1) && waited < PHASE_TIMEOUT_MS; waited += 10U)
+    {
+        rtos_delay_ms(10);
+    }
+
+    return g_done[0] != done0 && g_done[1] != done1;
+}
+
+static void control_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Control");
+
+    /* --- Phase 1: mutex --- */
+    TEST_ASSERT(run_phase(PHASE_MUTEX), "INV-SMP4:MutexPhaseDone");
+    TEST_ASSERT(g_timeouts == 0U, "INV-SMP3:MutexNoTimeout");
+    TEST_ASSERT(g_rounds[0] == ROUNDS && g_rounds[1] == ROUNDS, "INV-SMP4:MutexRounds");
+    TEST_ASSERT(g_counter == 2U * ROUNDS, "INV-SMP2:NoLostIncrement");
+    TEST_ASSERT(g_contended > 0U, "SMP-SETUP:MutexContended");
+    TEST_ASSERT(g_mutex.owner == NULL, "INV-SMP2:MutexFreeAfter");
+
+    /* --- Phase 2: semaphores --- */
+    TEST_ASSERT(run_phase(PHASE_SEM), "INV-SMP4:SemPhaseDone");
+    TEST_ASSERT(g_timeouts == 0U, "INV-SMP3:SemNoTimeout");
+    TEST_ASSERT(g_rounds[0] == ROUNDS && g_rounds[1] == ROUNDS, "INV-SMP4:SemRounds");
+    TEST_ASSERT(rtos_semaphore_get_count(&g_ping) == 0 && rtos_semaphore_get_count(&g_pong) == 0,
+                "INV-SMP4:SemDrained");
+
+    /* --- Phase 3: event group set from an ISR --- */
+    TEST_ASSERT(run_phase(PHASE_EG), "INV-SMP4:EgPhaseDone");
+    TEST_ASSERT(g_timeouts == 0U, "INV-SMP3:EgNoTimeout");
+    TEST_ASSERT(g_isr_status == RTOS_EG_OK, "INV-SMP3:EgIsrStatus");
+    TEST_ASSERT(g_rounds[0] == ROUNDS && g_rounds[1] == ROUNDS, "INV-SMP4:EgRounds");
+    TEST_ASSERT(rtos_event_group_get_bits(&g_eg) == 0U, "INV-SMP4:EgCleared");
+
+    TEST_ASSERT(g_wrong_core == 0U, "INV-SMP1:PinnedToCore");
+
+    log_info("SMP counter=%u  contended=%u  timeouts=%u", (unsigned) g_counter, (unsigned) g_contended,
+             (unsigned) g_timeouts);
+
+    TEST_EMIT_VERDICT();
+
+    test_log_task("END", "Control");
+    while (1)
+    {
+        rtos_delay_ms(1000);
+    }
+}
+
+/* =================== Timer Callbacks =================== */
+
+static void startup_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    g_test_started = true;
+    test_log_framework("BEGIN", "SmpSync");
+    rtos_timer_handle_t *p = (rtos_timer_handle_t *) param;
+    rtos_timer_start(*p);
+}
+
+static void test_timeout_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_complete = true;
+    test_log_framework("TIMEOUT", "SmpSync");
+}
+
+/* =================== Main =================== */
+
+__attribute__((__noreturn__)) int main(void)
+{
+    rtos_status_t       status;
+    rtos_timer_handle_t startup_timer;
+
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_ALL);
+
+    log_info("SMP Cross-Core Synchronisation Test");
+    log_info("Worker0=%u (core 0) Worker1=%u (core 1) Control=%u  rounds=%u", TASK_WORKER_PRIORITY,
+             TASK_WORKER_PRIORITY, TASK_CONTROL_PRIORITY, ROUNDS);
+    log_info("Invariants: SMP1(pinning) SMP2(exclusion) SMP3(no lost wakeup) SMP4(rounds)");
+
+    status = rtos_init();
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("RTOS init failed: %d", status);
+        indicate_system_failure();
+    }
+
+    NVIC_SetPriority(TEST_IRQn, TEST_IRQ_PRIO);
+    NVIC_EnableIRQ(TEST_IRQn);
+
+    status = test_create_startup_timer(startup_timer_callback, &g_test_timer, &startup_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Startup timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_timer_create("TestTimer", TEST_DURATION_MS, RTOS_TIMER_ONE_SHOT, test_timeout_callback, NULL,
+                               &g_test_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Test timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    if (rtos_mutex_init(&g_mutex) != RTOS_MUTEX_OK || rtos_semaphore_init(&g_ping, 0, 1) != RTOS_SEM_OK ||
+        rtos_semaphore_init(&g_pong, 0, 1) != RTOS_SEM_OK || rtos_event_group_init(&g_eg) != RTOS_EG_OK)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t handle;
+    if (rtos_task_create_ex(worker_task_func, "Worker0", RTOS_DEFAULT_TASK_STACK_SIZE, (void *) 0U,
+                            TASK_WORKER_PRIORITY, RTOS_TASK_FLAG_CORE(0), &g_worker[0]) != RTOS_SUCCESS ||
+        rtos_task_create_ex(worker_task_func, "Worker1", RTOS_DEFAULT_TASK_STACK_SIZE, (void *) 1U,
+                            TASK_WORKER_PRIORITY, RTOS_TASK_FLAG_CORE(1), &g_worker[1]) != RTOS_SUCCESS ||
+        rtos_task_create(control_task_func, "Control", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_CONTROL_PRIORITY,
+                         &handle) != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t flush_handle;
+    test_create_log_flush_task(&flush_handle);
+
+    log_info("Starting scheduler...");
+    status = rtos_start_scheduler();
+
+    indicate_system_failure();
+}
@@ -0,0 +1,399 @@
+/*******************************************************************************
+ * File: tests/integration/test_spsc_state.c
+ * Description: SPSC Channel - Lock-Free Ordering & Wakeup Invariant Test
+ * Author: Student
+ * Date: 2025
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "config.h"
+#include "device.h" // IWYU pragma: keep
+#include "hardware_env.h"
+#include "rtos_port.h"
+#include "spsc.h"
+#include "task.h"
+#include "test_common.h"
+#include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
+#include "timer.h"
+#include "uart_tx.h"
+
+/**
+ * @file test_spsc_state.c
+ * @brief SPSC Channel Ordering & Wakeup Invariant Test
+ *
+ * SCENARIO
+ * --------
+ * Phase 1 — Control owns a polled channel (it is the consumer) that
+ * TEST_IRQn fills with send_from_isr() bursts, and counts the pending
+ * notifications after each burst; it then wakes Consumer through the
+ * stream channel from below its priority.
+ *
+ * Phase 2 (STRESS_MS each) — the stream channel carries sequence numbers
+ * from a producer first below, then above the consumer:
+ *
+ *   ProducerHigh (priority 4) — sends CAPACITY + 1 per tick (overflows)
+ *   Consumer     (priority 3) — blocks in receive, checks the sequence
+ *   ProducerLow  (priority 2) — sends 2 * CAPACITY per tick (never fills)
+ *   Control      (priority 1) — drives the phases and checks
+ *
+ * INVARIANTS
+ * ----------
+ * INV-SP1  Items arrive in send order, none lost, with the producer above or
+ *          below the consumer.
+ * INV-SP2  All CAPACITY slots hold an item; a send into a full channel
+ *          returns RTOS_ERROR_FULL and stores nothing.
+ * INV-SP3  Only a send into an empty channel notifies the consumer: one
+ *          notification per burst into an empty channel, none into a
+ *          non-empty one.
+ * INV-SP4  A blocked consumer that outranks the producer runs inside the
+ *          send that wakes it.
+ * INV-SP5  receive on an empty channel returns RTOS_ERROR_EMPTY without
+ *          waiting and RTOS_ERROR_TIMEOUT after the timeout.
+ * INV-SP6  Bad capacities and blocking receives by a task other than the
+ *          consumer return RTOS_ERROR_INVALID_PARAM.
+ */
+
+/* =================== Test Parameters =================== */
+
+#define TASK_PRODUCER_HIGH_PRIORITY (4U)
+#define TASK_CONSUMER_PRIORITY      (3U)
+#define TASK_PRODUCER_LOW_PRIORITY  (2U)
+#define TASK_CONTROL_PRIORITY       (1U)
+
+#define TEST_IRQn        TEST_SPARE_IRQn
+#define TEST_IRQ_PRIO    (14U) /* Below the kernel BASEPRI threshold */
+#define CAPACITY         (8U)
+#define ISR_BURST        (3U)
+#define TIMEOUT_TICKS    (5U)
+#define SCENARIO_CYCLES  (20U)
+#define STRESS_MS        (500U)
+#define SETTLE_MS        (5U)
+#define TEST_DURATION_MS (6000U)
+
+/* =================== Shared State =================== */
+
+typedef enum
+{
+    PHASE_IDLE = 0,
+    PHASE_LOW,
+    PHASE_HIGH
+} stress_phase_t;
+
+static volatile bool g_test_started  = false;
+static volatile bool g_test_complete = false;
+
+static rtos_timer_handle_t g_test_timer;
+
+static rtos_spsc_t g_poll;   /* Consumer: Control, producer: TEST_IRQn */
+static rtos_spsc_t g_stream; /* Consumer: Consumer, producer: Control, then ProducerLow/High */
+static uint32_t    g_poll_storage[CAPACITY];
+static uint32_t    g_stream_storage[CAPACITY];
+
+static rtos_task_handle_t g_handle_consumer = NULL;
+
+/* ISR burst */
+static volatile uint32_t g_isr_next = 0;
+static volatile uint32_t g_isr_full = 0;
+
+/* Consumer */
+static volatile uint32_t g_received     = 0;
+static volatile uint32_t g_last_item    = 0;
+static volatile uint32_t g_order_errors = 0;
+
+/* Producers */
+static volatile stress_phase_t g_phase      = PHASE_IDLE;
+static volatile uint32_t       g_next_seq   = 0;
+static volatile uint32_t       g_full_count = 0;
+
+/* =================== Interrupt Handler =================== */
+
+void TEST_SPARE_IRQHandler(void)
+{
+    bool woken = false;
+
+    for (uint32_t i = 0; i < ISR_BURST; i++)
+    {
+        uint32_t item = g_isr_next;
+        if (rtos_spsc_send_from_isr(&g_poll, &item, &woken) == RTOS_SUCCESS)
+        {
+            g_isr_next = item + 1U;
+        }
+        else
+        {
+            g_isr_full++;
+        }
+    }
+
+    if (woken)
+    {
+        rtos_port_yield();
+    }
+}
+
+/* =================== Helpers =================== */
+
+static uint32_t pending_notifications(void)
+{
+    uint32_t n = 0;
+    while (rtos_task_notify_take_indexed(RTOS_TASK_NOTIFY_DEFAULT_INDEX, false, 0) == RTOS_NOTIFY_OK)
+    {
+        n++;
+    }
+    return n;
+}
+
+static void fire_isr(void)
+{
+    NVIC_SetPendingIRQ(TEST_IRQn);
+    __DSB();
+    __ISB();
+}
+
+/* Send the next sequence number; false if the channel is full */
+static bool send_next(void)
+{
+    uint32_t seq = g_next_seq;
+    if (rtos_spsc_send(&g_stream, &seq) != RTOS_SUCCESS)
+    {
+        g_full_count++;
+        return false;
+    }
+    g_next_seq = seq + 1U;
+    return true;
+}
+
+/* =================== Task Implementations =================== */
+
+static void consumer_task_func(void *param)
+{
+    (void) param;
+
+    while (1)
+    {
+        uint32_t item = 0;
+        if (rtos_spsc_receive(&g_stream, &item, RTOS_MAX_DELAY) == RTOS_SUCCESS)
+        {
+            if (g_received != 0U && item != g_last_item + 1U)
+            {
+                g_order_errors++;
+            }
+            g_last_item = item;
+            g_received++;
+        }
+    }
+}
+
+static void producer_low_task_func(void *param)
+{
+    (void) param;
+
+    while (1)
+    {
+        rtos_delay_ticks(1);
+        for (uint32_t i = 0; i < 2U * CAPACITY && g_phase == PHASE_LOW; i++)
+        {
+            send_next();
+        }
+    }
+}
+
+static void producer_high_task_func(void *param)
+{
+    (void) param;
+
+    while (1)
+    {
+        rtos_delay_ticks(1);
+        for (uint32_t i = 0; i < CAPACITY + 1U && g_phase == PHASE_HIGH; i++)
+        {
+            send_next();
+        }
+    }
+}
+
+static void run_poll_cycle(void)
+{
+    uint32_t first = g_isr_next;
+    uint32_t item  = 0;
+    bool     fifo  = true;
+
+    /* Burst into an empty channel: one notification, then bursts behind it: none */
+    fire_isr();
+    TEST_ASSERT(rtos_spsc_count(&g_poll) == ISR_BURST, "INV-SP1:BurstQueued");
+    TEST_ASSERT(pending_notifications() == 1U, "INV-SP3:OneNotifyWhenEmpty");
+
+    fire_isr();
+    TEST_ASSERT(pending_notifications() == 0U, "INV-SP3:NoNotifyWhenNonEmpty");
+
+    /* Third burst overflows: CAPACITY items stored, the rest rejected */
+    uint32_t full_before = g_isr_full;
+    fire_isr();
+    TEST_ASSERT(rtos_spsc_count(&g_poll) == CAPACITY, "INV-SP2:AllSlotsUsed");
+    TEST_ASSERT(g_isr_full - full_before == (3U * ISR_BURST) - CAPACITY, "INV-SP2:FullRejected");
+
+    for (uint32_t i = 0; i < CAPACITY; i++)
+    {
+        fifo = fifo && (rtos_spsc_receive(&g_poll, &item, 0) == RTOS_SUCCESS) && (item == first + i);
+    }
+    TEST_ASSERT(fifo, "INV-SP1:PollFIFO");
+    TEST_ASSERT(rtos_spsc_receive(&g_poll, &item, 0) == RTOS_ERROR_EMPTY, "INV-SP5:EmptyNoWait");
+    TEST_ASSERT(pending_notifications() == 0U, "INV-SP3:NoNotifyWhileNonEmpty");
+
+    /* Consumer outranks Control and runs before the send returns */
+    uint32_t received_before = g_received;
+    ASSERT_STATE(g_handle_consumer, RTOS_TASK_STATE_BLOCKED, "SP-SETUP:ConsumerBlocked");
+    send_next();
+    TEST_ASSERT(g_received == received_before + 1U, "INV-SP4:ConsumerRanInSend");
+}
+
+static void control_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Control");
+
+    rtos_spsc_t bad;
+    uint32_t    item = 0;
+
+    TEST_ASSERT(rtos_spsc_init(&bad, g_poll_storage, sizeof(uint32_t), 6, NULL, 0) == RTOS_ERROR_INVALID_PARAM,
+                "INV-SP6:CapacityNotPowerOf2");
+    TEST_ASSERT(rtos_spsc_init(&bad, g_poll_storage, sizeof(uint32_t), 0, NULL, 0) == RTOS_ERROR_INVALID_PARAM,
+                "INV-SP6:ZeroCapacity");
+    TEST_ASSERT(rtos_spsc_receive(&g_stream, &item, TIMEOUT_TICKS) == RTOS_ERROR_INVALID_PARAM,
+                "INV-SP6:NotTheConsumer");
+
+    /* --- Phase 1 --- */
+    rtos_spsc_init(&g_poll, g_poll_storage, sizeof(uint32_t), CAPACITY, rtos_task_get_current(),
+                   RTOS_TASK_NOTIFY_DEFAULT_INDEX);
+
+    rtos_tick_t start = rtos_get_tick_count();
+    TEST_ASSERT(rtos_spsc_receive(&g_poll, &item, TIMEOUT_TICKS) == RTOS_ERROR_TIMEOUT, "INV-SP5:Timeout");
+    TEST_ASSERT((rtos_tick_t) (rtos_get_tick_count() - start) >= TIMEOUT_TICKS, "INV-SP5:WaitedFullTimeout");
+
+    uint32_t cycle = 0;
+    for (; cycle < SCENARIO_CYCLES && !g_test_complete; cycle++)
+    {
+        rtos_delay_ms(SETTLE_MS);
+        run_poll_cycle();
+    }
+
+    /* --- Phase 2 --- */
+    g_phase = PHASE_LOW;
+    rtos_delay_ms(STRESS_MS);
+    g_phase = PHASE_IDLE;
+    rtos_delay_ms(SETTLE_MS);
+
+    uint32_t low_sent = g_next_seq;
+    TEST_ASSERT(g_received == low_sent, "INV-SP1:NoLossProducerBelow");
+
+    uint32_t full_before = g_full_count;
+    g_phase              = PHASE_HIGH;
+    rtos_delay_ms(STRESS_MS);
+    g_phase = PHASE_IDLE;
+    rtos_delay_ms(SETTLE_MS);
+
+    TEST_ASSERT(g_next_seq > low_sent, "SP-SETUP:HighProducerRan");
+    TEST_ASSERT(g_full_count > full_before, "INV-SP2:HighProducerOverflowed");
+    TEST_ASSERT(g_received == g_next_seq, "INV-SP1:NoLossProducerAbove");
+    TEST_ASSERT(g_order_errors == 0U, "INV-SP1:StreamFIFO");
+    TEST_ASSERT(rtos_spsc_count(&g_stream) == 0U, "INV-SP1:Drained");
+
+    log_info("SPSC cycles=%u  streamed=%u  full=%u", (unsigned) cycle, (unsigned) g_received,
+             (unsigned) g_full_count);
+
+    TEST_EMIT_VERDICT();
+
+    test_log_task("END", "Control");
+    while (1)
+    {
+        rtos_delay_ms(1000);
+    }
+}
+
+/* =================== Timer Callbacks =================== */
+
+static void startup_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    g_test_started = true;
+    test_log_framework("BEGIN", "SPSC");
+    rtos_timer_handle_t *p = (rtos_timer_handle_t *) param;
+    rtos_timer_start(*p);
+}
+
+static void test_timeout_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_complete = true;
+    test_log_framework("TIMEOUT", "SPSC");
+}
+
+/* =================== Main =================== */
+
+__attribute__((__noreturn__)) int main(void)
+{
+    rtos_status_t       status;
+    rtos_timer_handle_t startup_timer;
+
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_ALL);
+
+    log_info("SPSC Channel Ordering & Wakeup Test");
+    log_info("ProducerHigh=%u Consumer=%u ProducerLow=%u Control=%u  capacity=%u", TASK_PRODUCER_HIGH_PRIORITY,
+             TASK_CONSUMER_PRIORITY, TASK_PRODUCER_LOW_PRIORITY, TASK_CONTROL_PRIORITY, CAPACITY);
+    log_info("Invariants: SP1(FIFO) SP2(full) SP3(notify on empty) SP4(wake) SP5(empty/timeout) SP6(params)");
+
+    status = rtos_init();
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("RTOS init failed: %d", status);
+        indicate_system_failure();
+    }
+
+    NVIC_SetPriority(TEST_IRQn, TEST_IRQ_PRIO);
+    NVIC_EnableIRQ(TEST_IRQn);
+
+    status = test_create_startup_timer(startup_timer_callback, &g_test_timer, &startup_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Startup timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_timer_create("TestTimer", TEST_DURATION_MS, RTOS_TIMER_ONE_SHOT, test_timeout_callback, NULL,
+                               &g_test_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Test timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t handle;
+    if (rtos_task_create(consumer_task_func, "Consumer", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_CONSUMER_PRIORITY,
+                         &g_handle_consumer) != RTOS_SUCCESS ||
+        rtos_task_create(producer_high_task_func, "ProdHigh", RTOS_DEFAULT_TASK_STACK_SIZE, NULL,
+                         TASK_PRODUCER_HIGH_PRIORITY, &handle) != RTOS_SUCCESS ||
+        rtos_task_create(producer_low_task_func, "ProdLow", RTOS_DEFAULT_TASK_STACK_SIZE, NULL,
+                         TASK_PRODUCER_LOW_PRIORITY, &handle) != RTOS_SUCCESS ||
+        rtos_task_create(control_task_func, "Control", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_CONTROL_PRIORITY,
+                         &handle) != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    if (rtos_spsc_init(&g_stream, g_stream_storage, sizeof(uint32_t), CAPACITY, g_handle_consumer,
+                       RTOS_TASK_NOTIFY_DEFAULT_INDEX) != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t flush_handle;
+    test_create_log_flush_task(&flush_handle);
+
+    log_info("Starting scheduler...");
+    status = rtos_start_scheduler();
+
+    indicate_system_failure();
+}
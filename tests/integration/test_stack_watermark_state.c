@@ -0,0 +1,306 @@
+/*******************************************************************************
+ * File: tests/integration/test_stack_watermark_state.c
+ * Description: Stack High-Water Mark - Idle-Scan Measurement Invariant Test
+ * Author: Student
+ * Date: 2025
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "config.h"
+#include "device.h" // IWYU pragma: keep
+#include "hardware_env.h"
+#include "rtos_port.h"
+#include "semaphore.h"
+#include "task.h"
+#include "task_priv.h" /* rtos_tcb_t - needed to index the per-slot stats by task_id */
+#include "test_common.h"
+#include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
+#include "timer.h"
+#include "uart_tx.h"
+
+/**
+ * @file test_stack_watermark_state.c
+ * @brief Stack High-Water Mark Test
+ *
+ * SCENARIO
+ * --------
+ * Two tasks plus log flush; Controller creates two workers with equal stacks:
+ *
+ *   Controller (priority 2) — creates the workers, reads the marks
+ *   Deep       (priority 3) — writes DEEP_BYTES of locals, later DEEPER_BYTES
+ *   Shallow    (priority 3) — only blocks
+ *   Monitor    (priority 1) — emits final verdict
+ *
+ * INVARIANTS
+ * ----------
+ * INV-SW1  A new stack reads as unused (painted size) until the idle task scans it
+ * INV-SW2  After idle time, Deep's unused bytes are at most its size minus DEEP_BYTES
+ * INV-SW3  Shallow keeps more unused stack than Deep
+ * INV-SW4  Deeper use lowers the mark; further idle scans never raise it
+ * INV-SW5  rtos_task_get_memory_stats() totals and slot counts are consistent
+ * INV-SW6  A task created in a reused slot starts from the painted size again
+ * INV-SW7  NULL stats -> RTOS_ERROR_INVALID_PARAM, NULL handle -> 0 unused
+ */
+
+/* =================== Test Parameters =================== */
+
+#define TASK_CTRL_PRIORITY   (2U)
+#define TASK_WORKER_PRIORITY (3U)
+#define TASK_MON_PRIORITY    (1U)
+
+#define SCAN_SETTLE_MS   (300U) /* > one idle sweep over all slots */
+#define MONITOR_POLL_MS  (20U)
+#define IDLE_SPIN_MS     (1000U)
+#define TEST_DURATION_MS (4000U)
+
+#define WORKER_STACK_SIZE (1024U)
+#define DEEP_BYTES        (384U)
+#define DEEPER_BYTES      (640U)
+
+/* TEST_ASSERT, ASSERT_STATE, g_fail_count are in test_common.h */
+
+/* =================== Shared State =================== */
+
+static volatile bool g_test_started  = false;
+static volatile bool g_test_complete = false;
+
+static rtos_semaphore_t g_deeper_sem;
+
+static rtos_timer_handle_t g_test_timer;
+
+/* =================== Task Implementations =================== */
+
+/* Write bytes of locals so the stack is really used to that depth */
+static __attribute__((noinline)) void touch_stack(uint32_t bytes)
+{
+    volatile uint8_t buf[DEEPER_BYTES];
+
+    for (uint32_t i = 0; i < bytes && i < sizeof(buf); i++)
+    {
+        buf[i] = (uint8_t) i;
+    }
+}
+
+/*
+ * Deep (priority 3).
+ * Uses DEEP_BYTES, then DEEPER_BYTES once the Controller gives the semaphore.
+ */
+static void deep_task_func(void *param)
+{
+    (void) param;
+
+    touch_stack(DEEP_BYTES);
+    rtos_semaphore_wait(&g_deeper_sem, RTOS_MAX_DELAY);
+    touch_stack(DEEPER_BYTES);
+
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+/* Shallow (priority 3): uses next to no stack */
+static void shallow_task_func(void *param)
+{
+    (void) param;
+
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+/*
+ * Controller (priority 2).
+ * Creates the workers, lets the idle task scan, and checks the marks.
+ */
+static void ctrl_task_func(void *param)
+{
+    (void) param;
+    rtos_task_handle_t       deep;
+    rtos_task_handle_t       shallow;
+    rtos_task_memory_stats_t stats;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Controller");
+
+    rtos_semaphore_init(&g_deeper_sem, 0, 1);
+
+    TEST_ASSERT(rtos_task_create(deep_task_func, "Deep", WORKER_STACK_SIZE, NULL, TASK_WORKER_PRIORITY, &deep) ==
+                    RTOS_SUCCESS,
+                "INV-SW1:DeepCreated");
+    TEST_ASSERT(rtos_task_create(shallow_task_func, "Shallow", WORKER_STACK_SIZE, NULL, TASK_WORKER_PRIORITY,
+                                 &shallow) == RTOS_SUCCESS,
+                "INV-SW1:ShallowCreated");
+
+    /* INV-SW1: both have run, but the idle task has not scanned them yet */
+    uint32_t painted = rtos_task_get_stack_unused(shallow);
+    TEST_ASSERT(painted > WORKER_STACK_SIZE - 2U * RTOS_STACK_GUARD_SIZE - sizeof(uint32_t) &&
+                    painted < WORKER_STACK_SIZE,
+                "INV-SW1:PaintedSize");
+    TEST_ASSERT(rtos_task_get_stack_unused(deep) == painted, "INV-SW1:DeepNotScannedYet");
+
+    /* INV-SW2 */
+    rtos_delay_ms(SCAN_SETTLE_MS);
+    uint32_t deep_unused = rtos_task_get_stack_unused(deep);
+    TEST_ASSERT(deep_unused <= WORKER_STACK_SIZE - DEEP_BYTES, "INV-SW2:DeepMeasured");
+    TEST_ASSERT(deep_unused > WORKER_STACK_SIZE - DEEPER_BYTES, "INV-SW2:DeepNotOverstated");
+
+    /* INV-SW3 */
+    uint32_t shallow_unused = rtos_task_get_stack_unused(shallow);
+    TEST_ASSERT(shallow_unused > deep_unused, "INV-SW3:ShallowHasMore");
+    TEST_ASSERT(shallow_unused < painted, "INV-SW3:ShallowFrameSeen");
+
+    /* INV-SW4 */
+    rtos_semaphore_signal(&g_deeper_sem);
+    rtos_delay_ms(SCAN_SETTLE_MS);
+    uint32_t deeper_unused = rtos_task_get_stack_unused(deep);
+    TEST_ASSERT(deeper_unused <= WORKER_STACK_SIZE - DEEPER_BYTES, "INV-SW4:DeeperMeasured");
+    rtos_delay_ms(SCAN_SETTLE_MS);
+    TEST_ASSERT(rtos_task_get_stack_unused(deep) == deeper_unused, "INV-SW4:MarkNeverRises");
+
+    /* INV-SW5 */
+    TEST_ASSERT(rtos_task_get_memory_stats(&stats) == RTOS_SUCCESS, "INV-SW5:StatsOk");
+    TEST_ASSERT(stats.total_task_slots == RTOS_MAX_TASKS, "INV-SW5:TotalSlots");
+    TEST_ASSERT(stats.used_task_slots + stats.free_task_slots == RTOS_MAX_TASKS, "INV-SW5:SlotsAddUp");
+    TEST_ASSERT(stats.per_task_stack_size[deep->task_id] == WORKER_STACK_SIZE, "INV-SW5:DeepSize");
+    TEST_ASSERT(stats.per_task_stack_unused[deep->task_id] == deeper_unused, "INV-SW5:DeepUnused");
+    TEST_ASSERT(stats.used_stack_memory == stats.total_stack_memory - stats.free_stack_memory, "INV-SW5:UsedAddsUp");
+
+    uint32_t total = 0;
+    uint8_t  used  = 0;
+    for (uint8_t i = 0; i < RTOS_MAX_TASKS; i++)
+    {
+        total += stats.per_task_stack_size[i];
+        used += (stats.per_task_stack_size[i] != 0U) ? 1U : 0U;
+    }
+    TEST_ASSERT(total == stats.total_stack_memory, "INV-SW5:TotalAddsUp");
+    TEST_ASSERT(used == stats.used_task_slots, "INV-SW5:UsedSlots");
+
+    /* INV-SW6: the free list hands Deep's slot straight back */
+    rtos_task_id_t deep_id = deep->task_id;
+    rtos_task_delete(deep);
+    TEST_ASSERT(rtos_task_create(shallow_task_func, "Reused", WORKER_STACK_SIZE, NULL, TASK_WORKER_PRIORITY, &deep) ==
+                    RTOS_SUCCESS,
+                "INV-SW6:Recreated");
+    TEST_ASSERT(deep->task_id == deep_id, "INV-SW6:SameSlot");
+    TEST_ASSERT(rtos_task_get_stack_unused(deep) == painted, "INV-SW6:MarkReset");
+
+    /* INV-SW7 */
+    TEST_ASSERT(rtos_task_get_memory_stats(NULL) == RTOS_ERROR_INVALID_PARAM, "INV-SW7:NullStats");
+    TEST_ASSERT(rtos_task_get_stack_unused(NULL) == 0U, "INV-SW7:NullHandle");
+
+    test_log_task("END", "Controller");
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+/*
+ * Monitor task (priority 1).
+ * Emits the final PASS/FAIL verdict.
+ */
+static void monitor_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Monitor");
+
+    while (!g_test_complete)
+    {
+        rtos_delay_ms(MONITOR_POLL_MS);
+    }
+
+    /* Final verdict */
+    TEST_EMIT_VERDICT();
+
+    test_log_task("END", "Monitor");
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+/* =================== Timer Callbacks =================== */
+
+static void startup_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    g_test_started = true;
+    test_log_framework("BEGIN", "StackWatermarkState");
+    rtos_timer_handle_t *p = (rtos_timer_handle_t *) param;
+    rtos_timer_start(*p);
+}
+
+static void test_timeout_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_complete = true;
+    test_log_framework("TIMEOUT", "StackWatermarkState");
+}
+
+/* =================== Main =================== */
+
+__attribute__((__noreturn__)) int main(void)
+{
+    rtos_status_t       status;
+    rtos_timer_handle_t startup_timer;
+
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_ALL);
+
+    log_info("Stack High-Water Mark Test");
+    log_info("Priorities: Ctrl=%u Deep=%u Shallow=%u Mon=%u", TASK_CTRL_PRIORITY, TASK_WORKER_PRIORITY,
+             TASK_WORKER_PRIORITY, TASK_MON_PRIORITY);
+    log_info("Invariants: SW1(painted) SW2(measured) SW3(shallow) SW4(monotonic)");
+    log_info("            SW5(stats) SW6(slot_reuse) SW7(bad_params)");
+
+    status = rtos_init();
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("RTOS init failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = test_create_startup_timer(startup_timer_callback, &g_test_timer, &startup_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Startup timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_timer_create("TestTimer", TEST_DURATION_MS, RTOS_TIMER_ONE_SHOT, test_timeout_callback, NULL,
+                               &g_test_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Test timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t ctrl_handle;
+    status = rtos_task_create(ctrl_task_func, "Ctrl", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_CTRL_PRIORITY,
+                              &ctrl_handle);
+    if (status != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t monitor_handle;
+    status = rtos_task_create(monitor_task_func, "Mon", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_MON_PRIORITY,
+                              &monitor_handle);
+    if (status != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t flush_handle;
+    test_create_log_flush_task(&flush_handle);
+
+    log_info("Starting scheduler...");
+    status = rtos_start_scheduler();
+
+    indicate_system_failure();
+}
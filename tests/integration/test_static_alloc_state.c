@@ -0,0 +1,322 @@
+/*******************************************************************************
+ * File: tests/integration/test_static_alloc_state.c
+ * Description: Static Allocation - Heap-Free Kernel Object Invariant Test
+ * Author: Student
+ * Date: 2025
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "config.h"
+#include "device.h" // IWYU pragma: keep
+#include "hardware_env.h"
+#include "memory.h"
+#include "queue.h"
+#include "rtos_port.h"
+#include "task.h"
+#include "test_common.h"
+#include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
+#include "timer.h"
+#include "uart_tx.h"
+
+/**
+ * @file test_static_alloc_state.c
+ * @brief Static Allocation Test
+ *
+ * SCENARIO
+ * --------
+ * Two tasks plus log flush; Controller creates a third on a static stack:
+ *
+ *   Controller (priority 2) — creates static objects, checks the invariants
+ *   Worker     (priority 3) — static stack; receives from the static queue
+ *   Monitor    (priority 1) — emits final verdict
+ *
+ * INVARIANTS
+ * ----------
+ * INV-SA1  rtos_init() makes no heap allocation (idle and daemon stacks are static)
+ * INV-SA2  _create_static for a task, a queue and a timer makes no heap allocation
+ * INV-SA3  The static task runs and receives through the static queue
+ * INV-SA4  The static timer fires
+ * INV-SA5  Deleting static objects frees nothing on the heap
+ * INV-SA6  A deleted task's static stack can host a new task
+ * INV-SA7  Misaligned or undersized stacks, NULL storage -> RTOS_ERROR_INVALID_PARAM
+ * INV-SA8  Affinity to a core the kernel does not schedule on -> RTOS_ERROR_INVALID_PARAM;
+ *          RTOS_TASK_FLAG_CORE(0) is accepted and the task runs
+ */
+
+/* =================== Test Parameters =================== */
+
+#define TASK_CTRL_PRIORITY   (2U)
+#define TASK_WORKER_PRIORITY (3U)
+#define TASK_MON_PRIORITY    (1U)
+
+#define SETTLE_MS        (50U)
+#define MONITOR_POLL_MS  (20U)
+#define IDLE_SPIN_MS     (1000U)
+#define TEST_DURATION_MS (3000U)
+
+#define WORKER_STACK_SIZE (512U)
+#define QUEUE_LENGTH      (4U)
+#define TIMER_TICKS       (10U)
+#define TEST_ITEM         (0xC0FFEEU)
+
+/* TEST_ASSERT, ASSERT_STATE, g_fail_count are in test_common.h */
+
+/* =================== Shared State =================== */
+
+static volatile bool g_test_started  = false;
+static volatile bool g_test_complete = false;
+
+static uint32_t            g_worker_stack[WORKER_STACK_SIZE / sizeof(uint32_t)] __attribute__((aligned(8)));
+static rtos_queue_static_t g_queue_cb;
+static uint32_t            g_queue_storage[QUEUE_LENGTH];
+static rtos_timer_static_t g_timer_cb;
+
+static rtos_queue_handle_t g_queue;
+
+/*
+ * Synchronisation flags.
+ * volatile uint32_t to avoid torn reads on Cortex-M.
+ */
+static volatile uint32_t g_init_allocs = 0xFFFFFFFFU; /**< Heap allocations made by rtos_init() */
+static volatile uint32_t g_worker_item = 0;
+static volatile uint32_t g_timer_fired = 0;
+static volatile uint32_t g_worker_runs = 0;
+
+static rtos_timer_handle_t g_test_timer;
+
+/* =================== Task Implementations =================== */
+
+/*
+ * Worker (priority 3, static stack).
+ * Receives one item from the static queue, then idles.
+ */
+static void worker_task_func(void *param)
+{
+    (void) param;
+    uint32_t item = 0;
+
+    g_worker_runs++;
+    rtos_queue_receive(g_queue, &item, RTOS_MAX_DELAY);
+    g_worker_item = item;
+
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+static void static_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_timer_fired++;
+}
+
+/*
+ * Controller (priority 2).
+ * Creates, uses and deletes the static objects.
+ */
+static void ctrl_task_func(void *param)
+{
+    (void) param;
+    rtos_memory_stats_t before;
+    rtos_memory_stats_t after;
+    rtos_task_handle_t  worker;
+    rtos_timer_handle_t timer;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Controller");
+
+    /* INV-SA1 */
+    TEST_ASSERT(g_init_allocs == 0, "INV-SA1:InitNoHeap");
+
+    /* INV-SA2 */
+    rtos_memory_get_stats(&before);
+
+    TEST_ASSERT(rtos_queue_create_static(&g_queue, &g_queue_cb, g_queue_storage, QUEUE_LENGTH, sizeof(uint32_t)) ==
+                    RTOS_SUCCESS,
+                "INV-SA2:QueueCreated");
+    TEST_ASSERT(rtos_timer_create_static("Static", TIMER_TICKS, RTOS_TIMER_ONE_SHOT, static_timer_callback, NULL,
+                                         &g_timer_cb, &timer) == RTOS_SUCCESS,
+                "INV-SA2:TimerCreated");
+    TEST_ASSERT(rtos_task_create_static(worker_task_func, "Worker", g_worker_stack, sizeof(g_worker_stack), NULL,
+                                        TASK_WORKER_PRIORITY, RTOS_TASK_FLAG_NONE, &worker) == RTOS_SUCCESS,
+                "INV-SA2:TaskCreated");
+
+    rtos_memory_get_stats(&after);
+    TEST_ASSERT(after.alloc_count == before.alloc_count, "INV-SA2:NoHeapAlloc");
+
+    /* INV-SA3: Worker preempted us at creation and now waits on the queue */
+    TEST_ASSERT(g_worker_runs == 1, "INV-SA3:WorkerRan");
+    ASSERT_STATE(worker, RTOS_TASK_STATE_BLOCKED, "INV-SA3:WorkerBlocked");
+
+    uint32_t item = TEST_ITEM;
+    rtos_queue_send(g_queue, &item, 0);
+    TEST_ASSERT(g_worker_item == TEST_ITEM, "INV-SA3:ItemReceived");
+
+    /* INV-SA4 */
+    rtos_timer_start(timer);
+    rtos_delay_ms(SETTLE_MS);
+    TEST_ASSERT(g_timer_fired == 1, "INV-SA4:TimerFired");
+
+    /* INV-SA5 */
+    TEST_ASSERT(rtos_task_delete(worker) == RTOS_SUCCESS, "INV-SA5:TaskDeleted");
+    TEST_ASSERT(rtos_queue_delete(g_queue) == RTOS_SUCCESS, "INV-SA5:QueueDeleted");
+    TEST_ASSERT(rtos_timer_delete(timer) == RTOS_SUCCESS, "INV-SA5:TimerDeleted");
+    rtos_delay_ms(SETTLE_MS);
+
+    rtos_memory_get_stats(&after);
+    TEST_ASSERT(after.free_count == before.free_count, "INV-SA5:NoHeapFree");
+    TEST_ASSERT(after.free_bytes == before.free_bytes, "INV-SA5:FreeBytesUnchanged");
+
+    /* INV-SA6: same stack, same queue storage, new task */
+    rtos_queue_create_static(&g_queue, &g_queue_cb, g_queue_storage, QUEUE_LENGTH, sizeof(uint32_t));
+    TEST_ASSERT(rtos_task_create_static(worker_task_func, "Worker2", g_worker_stack, sizeof(g_worker_stack), NULL,
+                                        TASK_WORKER_PRIORITY, RTOS_TASK_FLAG_NONE, &worker) == RTOS_SUCCESS,
+                "INV-SA6:StackReused");
+    TEST_ASSERT(g_worker_runs == 2, "INV-SA6:SecondWorkerRan");
+    rtos_task_delete(worker);
+
+    /* INV-SA7 */
+    rtos_task_handle_t bad;
+    uint32_t          *misaligned = (uint32_t *) ((uint8_t *) g_worker_stack + sizeof(uint32_t));
+
+    TEST_ASSERT(rtos_task_create_static(worker_task_func, "Bad", misaligned, sizeof(g_worker_stack) - 8U, NULL,
+                                        TASK_WORKER_PRIORITY, RTOS_TASK_FLAG_NONE, &bad) == RTOS_ERROR_INVALID_PARAM,
+                "INV-SA7:MisalignedStack");
+    TEST_ASSERT(rtos_task_create_static(worker_task_func, "Bad", g_worker_stack, RTOS_MINIMUM_TASK_STACK_SIZE - 8U,
+                                        NULL, TASK_WORKER_PRIORITY, RTOS_TASK_FLAG_NONE,
+                                        &bad) == RTOS_ERROR_INVALID_PARAM,
+                "INV-SA7:StackTooSmall");
+    TEST_ASSERT(rtos_queue_create_static(&g_queue, &g_queue_cb, NULL, QUEUE_LENGTH, sizeof(uint32_t)) ==
+                    RTOS_ERROR_INVALID_PARAM,
+                "INV-SA7:NullStorage");
+
+    /* INV-SA8 */
+    TEST_ASSERT(rtos_task_create_static(worker_task_func, "Bad", g_worker_stack, sizeof(g_worker_stack), NULL,
+                                        TASK_WORKER_PRIORITY, RTOS_TASK_FLAG_CORE(RTOS_SMP_CORES),
+                                        &bad) == RTOS_ERROR_INVALID_PARAM,
+                "INV-SA8:AbsentCoreRejected");
+    TEST_ASSERT(rtos_task_create_static(worker_task_func, "Pinned", g_worker_stack, sizeof(g_worker_stack), NULL,
+                                        TASK_WORKER_PRIORITY, RTOS_TASK_FLAG_CORE(0), &worker) == RTOS_SUCCESS,
+                "INV-SA8:Core0Accepted");
+    TEST_ASSERT(g_worker_runs == 3, "INV-SA8:PinnedWorkerRan");
+    rtos_task_delete(worker);
+
+    test_log_task("END", "Controller");
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+/*
+ * Monitor task (priority 1).
+ * Emits the final PASS/FAIL verdict.
+ */
+static void monitor_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Monitor");
+
+    while (!g_test_complete)
+    {
+        rtos_delay_ms(MONITOR_POLL_MS);
+    }
+
+    /* Final verdict */
+    TEST_EMIT_VERDICT();
+
+    test_log_task("END", "Monitor");
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+/* =================== Timer Callbacks =================== */
+
+static void startup_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    g_test_started = true;
+    test_log_framework("BEGIN", "StaticAllocState");
+    rtos_timer_handle_t *p = (rtos_timer_handle_t *) param;
+    rtos_timer_start(*p);
+}
+
+static void test_timeout_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_complete = true;
+    test_log_framework("TIMEOUT", "StaticAllocState");
+}
+
+/* =================== Main =================== */
+
+__attribute__((__noreturn__)) int main(void)
+{
+    rtos_status_t       status;
+    rtos_timer_handle_t startup_timer;
+    rtos_memory_stats_t stats;
+
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_ALL);
+
+    log_info("Static Allocation Test");
+    log_info("Priorities: Ctrl=%u Worker=%u Mon=%u", TASK_CTRL_PRIORITY, TASK_WORKER_PRIORITY, TASK_MON_PRIORITY);
+    log_info("Invariants: SA1(init_no_heap) SA2(create_no_heap) SA3(task_queue) SA4(timer)");
+    log_info("            SA5(delete_no_free) SA6(stack_reuse) SA7(bad_params)");
+
+    status = rtos_init();
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("RTOS init failed: %d", status);
+        indicate_system_failure();
+    }
+
+    rtos_memory_get_stats(&stats);
+    g_init_allocs = stats.alloc_count;
+
+    status = test_create_startup_timer(startup_timer_callback, &g_test_timer, &startup_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Startup timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_timer_create("TestTimer", TEST_DURATION_MS, RTOS_TIMER_ONE_SHOT, test_timeout_callback, NULL,
+                               &g_test_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Test timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t ctrl_handle;
+    status = rtos_task_create(ctrl_task_func, "Ctrl", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_CTRL_PRIORITY,
+                              &ctrl_handle);
+    if (status != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t monitor_handle;
+    status = rtos_task_create(monitor_task_func, "Mon", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_MON_PRIORITY,
+                              &monitor_handle);
+    if (status != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t flush_handle;
+    test_create_log_flush_task(&flush_handle);
+
+    log_info("Starting scheduler...");
+    status = rtos_start_scheduler();
+
+    indicate_system_failure();
+}
@@ -0,0 +1,391 @@
+/*******************************************************************************
+ * File: tests/integration/test_stream_buffer_state.c
+ * Description: Stream / Message Buffer - Trigger, Framing and ISR Invariant Test
+ * Author: Student
+ * Date: 2025
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "config.h"
+#include "device.h" // IWYU pragma: keep
+#include "hardware_env.h"
+#include "rtos_port.h"
+#include "stream_buffer.h"
+#include "task.h"
+#include "test_common.h"
+#include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
+#include "timer.h"
+#include "uart_tx.h"
+
+#include <string.h>
+
+/**
+ * @file test_stream_buffer_state.c
+ * @brief Stream / Message Buffer Invariant Test
+ *
+ * SCENARIO
+ * --------
+ * Three tasks plus log flush:
+ *
+ *   Controller (priority 2) — writes, checks the invariants
+ *   Reader     (priority 4) — blocks on the stream, then the message buffer
+ *   Monitor    (priority 1) — emits final verdict
+ *
+ * INVARIANTS
+ * ----------
+ * INV-SB1  A reader blocked below the trigger level stays BLOCKED
+ * INV-SB2  The write reaching the trigger level wakes it with those bytes
+ * INV-SB3  Receive with a timeout on an empty stream -> RTOS_ERROR_TIMEOUT;
+ *          send with no wait on a full one -> RTOS_ERROR_FULL
+ * INV-SB4  Message boundaries are kept: two sends come back as two receives
+ * INV-SB5  A message larger than the receive buffer -> RTOS_ERROR_NO_MEMORY,
+ *          and it stays queued
+ * INV-SB6  message_buffer_send_from_isr() (TEST_IRQn) wakes the blocked Reader
+ *          and sets *higher_priority_task_woken
+ * INV-SB7  Bad parameters -> RTOS_ERROR_INVALID_PARAM
+ */
+
+/* =================== Test Parameters =================== */
+
+#define TASK_CTRL_PRIORITY   (2U)
+#define TASK_READER_PRIORITY (4U)
+#define TASK_MON_PRIORITY    (1U)
+
+#define SETTLE_MS        (50U)
+#define POLL_MS          (5U)
+#define MONITOR_POLL_MS  (20U)
+#define IDLE_SPIN_MS     (1000U)
+#define TEST_DURATION_MS (3000U)
+#define TIMEOUT_TICKS    (10U)
+
+#define TEST_IRQn     TEST_SPARE_IRQn
+#define TEST_IRQ_PRIO (14U) /* Below the kernel BASEPRI threshold */
+
+#define STORAGE_SIZE  (16U) /* Power of 2; holds 15 bytes */
+#define TRIGGER_LEVEL (4U)
+
+/* TEST_ASSERT, ASSERT_STATE, g_fail_count are in test_common.h */
+
+/* =================== Shared State =================== */
+
+static volatile bool g_test_started  = false;
+static volatile bool g_test_complete = false;
+
+static rtos_task_handle_t g_handle_reader = NULL;
+
+static rtos_stream_buffer_t  g_stream;
+static rtos_message_buffer_t g_message;
+
+static uint8_t g_stream_storage[STORAGE_SIZE] __attribute__((aligned(4)));
+static uint8_t g_message_storage[STORAGE_SIZE] __attribute__((aligned(4)));
+
+static const uint8_t g_isr_msg[] = {0xDE, 0xAD, 0xBE, 0xEF, 0x01};
+
+/*
+ * Synchronisation flags.
+ * volatile uint32_t to avoid torn reads on Cortex-M.
+ */
+static volatile uint32_t g_phase       = 0;
+static volatile uint32_t g_reader_done = 0;
+static volatile uint32_t g_reader_len  = 0;
+static volatile bool     g_reader_ok   = false;
+
+static volatile bool g_isr_woken = false;
+
+static rtos_timer_handle_t g_test_timer;
+
+/* =================== Interrupt Handler =================== */
+
+void TEST_SPARE_IRQHandler(void)
+{
+    bool woken = false;
+
+    rtos_message_buffer_send_from_isr(&g_message, g_isr_msg, sizeof(g_isr_msg), &woken);
+    g_isr_woken = woken;
+
+    if (woken)
+    {
+        rtos_port_yield();
+    }
+}
+
+/* =================== Task Implementations =================== */
+
+/*
+ * Reader (priority 4).
+ *
+ * Phase 1: blocks on the stream until TRIGGER_LEVEL bytes arrive.
+ * Phase 2: blocks on the message buffer until the interrupt writes to it.
+ */
+static void reader_task_func(void *param)
+{
+    (void) param;
+    uint8_t  buf[STORAGE_SIZE];
+    uint32_t n = 0;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Reader");
+
+    /* --- Phase 1: INV-SB1/SB2 --- */
+    while (g_phase < 1 && !g_test_complete)
+    {
+        rtos_delay_ms(POLL_MS);
+    }
+
+    g_reader_ok   = (rtos_stream_buffer_receive(&g_stream, buf, sizeof(buf), &n, RTOS_MAX_DELAY) == RTOS_SUCCESS);
+    g_reader_len  = n;
+    g_reader_done = 1;
+
+    /* --- Phase 2: INV-SB6 --- */
+    while (g_phase < 2 && !g_test_complete)
+    {
+        rtos_delay_ms(POLL_MS);
+    }
+    g_reader_done = 0;
+
+    g_reader_ok = (rtos_message_buffer_receive(&g_message, buf, sizeof(buf), &n, RTOS_MAX_DELAY) == RTOS_SUCCESS) &&
+                  (n == sizeof(g_isr_msg)) && (memcmp(buf, g_isr_msg, sizeof(g_isr_msg)) == 0);
+    g_reader_len  = n;
+    g_reader_done = 1;
+
+    test_log_task("END", "Reader");
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+/*
+ * Controller (priority 2).
+ *
+ * Drives Reader through both phases; INV-SB3..SB5 and SB7 run on buffers
+ * nobody is blocked on, between the phases.
+ */
+static void ctrl_task_func(void *param)
+{
+    (void) param;
+    uint8_t  buf[STORAGE_SIZE];
+    uint32_t n = 0;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Controller");
+
+    /* =========================================================
+     * Phase 1: INV-SB1/SB2 — trigger level
+     * ========================================================= */
+    g_phase = 1;
+    rtos_delay_ms(SETTLE_MS);
+
+    ASSERT_STATE(g_handle_reader, RTOS_TASK_STATE_BLOCKED, "INV-SB1:ReaderBlocked");
+
+    for (uint8_t i = 0; i < TRIGGER_LEVEL - 1U; i++)
+    {
+        rtos_stream_buffer_send(&g_stream, &i, 1, NULL, 0);
+    }
+    ASSERT_STATE(g_handle_reader, RTOS_TASK_STATE_BLOCKED, "INV-SB1:BelowTriggerNoWake");
+
+    /* The byte reaching the trigger level; Reader preempts us here */
+    uint8_t last = TRIGGER_LEVEL - 1U;
+    rtos_stream_buffer_send(&g_stream, &last, 1, NULL, 0);
+
+    TEST_ASSERT(g_reader_done == 1, "INV-SB2:WokenAtTrigger");
+    TEST_ASSERT(g_reader_ok && g_reader_len == TRIGGER_LEVEL, "INV-SB2:TriggerBytes");
+
+    /* =========================================================
+     * INV-SB3 — timeout and full
+     * ========================================================= */
+    TEST_ASSERT(rtos_stream_buffer_receive(&g_stream, buf, sizeof(buf), &n, TIMEOUT_TICKS) == RTOS_ERROR_TIMEOUT,
+                "INV-SB3:ReceiveTimeout");
+    TEST_ASSERT(n == 0, "INV-SB3:TimeoutNoBytes");
+
+    memset(buf, 0x55, sizeof(buf));
+    rtos_stream_buffer_send(&g_stream, buf, sizeof(buf), &n, 0);
+    TEST_ASSERT(n == STORAGE_SIZE - 1U, "INV-SB3:PartialFill");
+    TEST_ASSERT(rtos_stream_buffer_send(&g_stream, buf, 1, NULL, 0) == RTOS_ERROR_FULL, "INV-SB3:SendFull");
+    TEST_ASSERT(rtos_stream_buffer_reset(&g_stream) == RTOS_SUCCESS, "INV-SB3:Reset");
+
+    /* =========================================================
+     * INV-SB4/SB5 — message framing
+     * ========================================================= */
+    static const uint8_t msg_a[] = {1, 2, 3};
+    static const uint8_t msg_b[] = {4, 5, 6, 7, 8};
+
+    rtos_message_buffer_send(&g_message, msg_a, sizeof(msg_a), 0);
+    rtos_message_buffer_send(&g_message, msg_b, sizeof(msg_b), 0);
+
+    TEST_ASSERT(rtos_message_buffer_receive(&g_message, buf, sizeof(buf), &n, 0) == RTOS_SUCCESS &&
+                    n == sizeof(msg_a) && memcmp(buf, msg_a, sizeof(msg_a)) == 0,
+                "INV-SB4:FirstMessage");
+
+    /* INV-SB5: msg_b does not fit in 2 bytes and must survive the attempt */
+    TEST_ASSERT(rtos_message_buffer_receive(&g_message, buf, 2, &n, 0) == RTOS_ERROR_NO_MEMORY,
+                "INV-SB5:TooSmallBuffer");
+    TEST_ASSERT(n == sizeof(msg_b), "INV-SB5:LengthReported");
+    TEST_ASSERT(rtos_message_buffer_next_length(&g_message) == sizeof(msg_b), "INV-SB5:MessageKept");
+
+    TEST_ASSERT(rtos_message_buffer_receive(&g_message, buf, sizeof(buf), &n, 0) == RTOS_SUCCESS &&
+                    n == sizeof(msg_b) && memcmp(buf, msg_b, sizeof(msg_b)) == 0,
+                "INV-SB4:SecondMessage");
+    TEST_ASSERT(rtos_message_buffer_receive(&g_message, buf, sizeof(buf), &n, 0) == RTOS_ERROR_EMPTY,
+                "INV-SB4:Drained");
+
+    /* =========================================================
+     * INV-SB7 — bad parameters
+     * ========================================================= */
+    rtos_stream_buffer_t bad;
+    TEST_ASSERT(rtos_stream_buffer_init(&bad, buf, 12U, 1U) == RTOS_ERROR_INVALID_PARAM, "INV-SB7:SizeNotPow2");
+    TEST_ASSERT(rtos_stream_buffer_init(&bad, buf, STORAGE_SIZE, STORAGE_SIZE) == RTOS_ERROR_INVALID_PARAM,
+                "INV-SB7:TriggerTooHigh");
+    TEST_ASSERT(rtos_message_buffer_send(&g_message, buf, RTOS_MESSAGE_BUFFER_MAX_MESSAGE(STORAGE_SIZE) + 1U, 0) ==
+                    RTOS_ERROR_INVALID_PARAM,
+                "INV-SB7:MessageTooLong");
+    TEST_ASSERT(rtos_stream_buffer_send((rtos_stream_buffer_t *) &g_message, buf, 1, NULL, 0) ==
+                    RTOS_ERROR_INVALID_PARAM,
+                "INV-SB7:StreamCallOnMessage");
+
+    /* =========================================================
+     * Phase 2: INV-SB6 — message written from the ISR
+     * ========================================================= */
+    g_phase = 2;
+    rtos_delay_ms(SETTLE_MS);
+
+    ASSERT_STATE(g_handle_reader, RTOS_TASK_STATE_BLOCKED, "INV-SB6:ReaderBlocked");
+
+    NVIC_SetPendingIRQ(TEST_IRQn);
+    __DSB();
+    __ISB();
+
+    TEST_ASSERT(g_isr_woken, "INV-SB6:WokenSetOnWake");
+    TEST_ASSERT(g_reader_done == 1, "INV-SB6:ReaderRanAtIsrExit");
+    TEST_ASSERT(g_reader_ok, "INV-SB6:IsrMessageIntact");
+
+    test_log_task("END", "Controller");
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+/*
+ * Monitor task (priority 1).
+ * Emits the final PASS/FAIL verdict.
+ */
+static void monitor_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Monitor");
+
+    while (!g_test_complete)
+    {
+        rtos_delay_ms(MONITOR_POLL_MS);
+    }
+
+    /* Final verdict */
+    TEST_EMIT_VERDICT();
+
+    test_log_task("END", "Monitor");
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+/* =================== Timer Callbacks =================== */
+
+static void startup_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    g_test_started = true;
+    test_log_framework("BEGIN", "StreamBufferState");
+    rtos_timer_handle_t *p = (rtos_timer_handle_t *) param;
+    rtos_timer_start(*p);
+}
+
+static void test_timeout_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_complete = true;
+    test_log_framework("TIMEOUT", "StreamBufferState");
+}
+
+/* =================== Main =================== */
+
+__attribute__((__noreturn__)) int main(void)
+{
+    rtos_status_t       status;
+    rtos_timer_handle_t startup_timer;
+
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_ALL);
+
+    log_info("Stream / Message Buffer Invariant Test");
+    log_info("Priorities: Ctrl=%u Reader=%u Mon=%u", TASK_CTRL_PRIORITY, TASK_READER_PRIORITY, TASK_MON_PRIORITY);
+    log_info("Invariants: SB1(below_trigger) SB2(trigger_wake) SB3(timeout_full) SB4(framing)");
+    log_info("            SB5(too_small) SB6(isr_send) SB7(bad_params)");
+
+    status = rtos_init();
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("RTOS init failed: %d", status);
+        indicate_system_failure();
+    }
+
+    if (rtos_stream_buffer_init(&g_stream, g_stream_storage, STORAGE_SIZE, TRIGGER_LEVEL) != RTOS_SUCCESS ||
+        rtos_message_buffer_init(&g_message, g_message_storage, STORAGE_SIZE) != RTOS_SUCCESS)
+    {
+        log_error("Buffer init failed");
+        indicate_system_failure();
+    }
+
+    status = test_create_startup_timer(startup_timer_callback, &g_test_timer, &startup_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Startup timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_timer_create("TestTimer", TEST_DURATION_MS, RTOS_TIMER_ONE_SHOT, test_timeout_callback, NULL,
+                               &g_test_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Test timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t ctrl_handle;
+    status = rtos_task_create(ctrl_task_func, "Ctrl", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_CTRL_PRIORITY,
+                              &ctrl_handle);
+    if (status != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    status = rtos_task_create(reader_task_func, "Read", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_READER_PRIORITY,
+                              &g_handle_reader);
+    if (status != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t monitor_handle;
+    status = rtos_task_create(monitor_task_func, "Mon", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_MON_PRIORITY,
+                              &monitor_handle);
+    if (status != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t flush_handle;
+    test_create_log_flush_task(&flush_handle);
+
+    NVIC_SetPriority(TEST_IRQn, TEST_IRQ_PRIO);
+    NVIC_EnableIRQ(TEST_IRQn);
+
+    log_info("Starting scheduler...");
+    status = rtos_start_scheduler();
+
+    indicate_system_failure();
+}
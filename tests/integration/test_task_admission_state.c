@@ -0,0 +1,278 @@
+/*******************************************************************************
+ * File: tests/integration/test_task_admission_state.c
+ * Description: Admission Control - Response-Time Analysis & Budget Test
+ * Author: Student
+ * Date: 2025
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "config.h"
+#include "device.h" // IWYU pragma: keep
+#include "hardware_env.h"
+#include "task.h"
+#include "test_common.h"
+#include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
+#include "timer.h"
+#include "uart_tx.h"
+
+/**
+ * @file test_task_admission_state.c
+ * @brief Admission Control Invariant Test (RTOS_ADMISSION_REJECT)
+ *
+ * SCENARIO
+ * --------
+ * Controller (priority 5, aperiodic) builds a budgeted task set with
+ * rtos_task_create_periodic() and probes admission with candidates that do
+ * not fit:
+ *
+ *   Task   Prio  Period  WCET  Work  Outcome
+ *   TaskA  3     100     30    20    admitted
+ *   TaskB  2     200     60    40    admitted
+ *   CandC  1     300     100   -     rejected: U = 0.93, but R_C = 310 > 300
+ *   CandD  4     100     45    -     rejected: fits itself, pushes R_B to 210
+ *
+ * TaskA and TaskB then run; after a quiet phase Controller asks TaskA to
+ * overrun a single job (45 ticks of work against a 30-tick budget).
+ *
+ * INVARIANTS
+ * ----------
+ * INV-A1  Schedulable tasks are admitted (RTOS_SUCCESS).
+ * INV-A2  A candidate whose own response time exceeds its deadline is
+ *         rejected with RTOS_ERROR_NOT_SCHEDULABLE, even below U = 1.
+ * INV-A3  A candidate that makes an existing lower-priority task miss is
+ *         rejected with RTOS_ERROR_NOT_SCHEDULABLE.
+ * INV-A4  wcet > relative_deadline is RTOS_ERROR_INVALID_PARAM.
+ * INV-A5  Jobs that stay within budget record no overruns.
+ * INV-A6  One overrunning job records exactly one overrun, on that task only,
+ *         and causes no deadline misses.
+ */
+
+/* =================== Test Parameters =================== */
+
+#define TASK_CONTROLLER_PRIORITY (5U)
+#define TASK_A_PRIORITY          (3U)
+#define TASK_B_PRIORITY          (2U)
+
+#define TASK_A_PERIOD  (100U)
+#define TASK_A_WCET    (30U)
+#define TASK_A_WORK    (20U)
+#define TASK_A_OVERRUN (45U)
+#define TASK_B_PERIOD  (200U)
+#define TASK_B_WCET    (60U)
+#define TASK_B_WORK    (40U)
+
+#define QUIET_PHASE_MS   (1000U)
+#define OVERRUN_PHASE_MS (500U)
+#define TEST_DURATION_MS (5000U)
+
+/* =================== Shared State =================== */
+
+static volatile bool g_test_started  = false;
+static volatile bool g_test_complete = false;
+
+static rtos_timer_handle_t g_test_timer;
+
+static rtos_task_handle_t g_handle_a = NULL;
+static rtos_task_handle_t g_handle_b = NULL;
+
+/** Set by Controller; TaskA runs its next job long and clears it */
+static volatile uint32_t g_overrun_request = 0;
+
+/* =================== Helpers =================== */
+
+/* Spin until this task has seen `ticks` consecutive tick increments */
+static void consume_ticks(uint32_t ticks)
+{
+    uint32_t    consumed = 0;
+    rtos_tick_t last     = rtos_get_tick_count();
+
+    while (consumed < ticks)
+    {
+        rtos_tick_t now = rtos_get_tick_count();
+        if (now != last)
+        {
+            if (now - last == 1U)
+            {
+                consumed++;
+            }
+            last = now;
+        }
+    }
+}
+
+/* =================== Task Implementations =================== */
+
+static void task_a_func(void *param)
+{
+    (void) param;
+
+    while (1)
+    {
+        uint32_t work = TASK_A_WORK;
+
+        if (g_overrun_request)
+        {
+            g_overrun_request = 0;
+            work              = TASK_A_OVERRUN;
+        }
+
+        consume_ticks(work);
+        rtos_task_wait_for_next_period();
+    }
+}
+
+static void task_b_func(void *param)
+{
+    (void) param;
+
+    while (1)
+    {
+        consume_ticks(TASK_B_WORK);
+        rtos_task_wait_for_next_period();
+    }
+}
+
+/* Never runs: admission is expected to refuse every task that uses it */
+static void candidate_task_func(void *param)
+{
+    (void) param;
+
+    while (1)
+    {
+        rtos_delay_ms(1000);
+    }
+}
+
+/*
+ * Controller task (priority 5) — drives every admission decision, then the
+ * budget phases, and emits the verdict.
+ */
+static void controller_task_func(void *param)
+{
+    (void) param;
+
+    rtos_task_handle_t candidate;
+    rtos_status_t      status;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Controller");
+
+    /* INV-A1: schedulable set is admitted */
+    status = rtos_task_create_periodic(task_a_func, "TaskA", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_A_PRIORITY,
+                                       TASK_A_PERIOD, 0, TASK_A_WCET, &g_handle_a);
+    TEST_ASSERT(status == RTOS_SUCCESS, "INV-A1:AdmitA");
+
+    status = rtos_task_create_periodic(task_b_func, "TaskB", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_B_PRIORITY,
+                                       TASK_B_PERIOD, 0, TASK_B_WCET, &g_handle_b);
+    TEST_ASSERT(status == RTOS_SUCCESS, "INV-A1:AdmitB");
+
+    /* INV-A2: R_C = 100 + 3*30 + 2*60 = 310 > 300 */
+    status = rtos_task_create_periodic(candidate_task_func, "CandC", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, 1U, 300U, 0,
+                                       100U, &candidate);
+    TEST_ASSERT(status == RTOS_ERROR_NOT_SCHEDULABLE, "INV-A2:RejectOwnMiss");
+
+    /* INV-A3: R_B = 60 + 2*30 + 2*45 = 210 > 200 */
+    status = rtos_task_create_periodic(candidate_task_func, "CandD", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, 4U, 100U, 0,
+                                       45U, &candidate);
+    TEST_ASSERT(status == RTOS_ERROR_NOT_SCHEDULABLE, "INV-A3:RejectVictimMiss");
+
+    /* INV-A4 */
+    status = rtos_task_create_periodic(candidate_task_func, "CandE", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, 1U, 100U, 50U,
+                                       60U, &candidate);
+    TEST_ASSERT(status == RTOS_ERROR_INVALID_PARAM, "INV-A4:WcetAboveDeadline");
+
+    /* INV-A5: in-budget jobs */
+    rtos_delay_ms(QUIET_PHASE_MS);
+    TEST_ASSERT(rtos_task_get_budget_overruns(g_handle_a) == 0, "INV-A5:NoOverrunA");
+    TEST_ASSERT(rtos_task_get_budget_overruns(g_handle_b) == 0, "INV-A5:NoOverrunB");
+
+    /* INV-A6: one long job of TaskA */
+    g_overrun_request = 1;
+    rtos_delay_ms(OVERRUN_PHASE_MS);
+    TEST_ASSERT(g_overrun_request == 0, "INV-A6:OverrunJobRan");
+    TEST_ASSERT(rtos_task_get_budget_overruns(g_handle_a) == 1, "INV-A6:OneOverrunA");
+    TEST_ASSERT(rtos_task_get_budget_overruns(g_handle_b) == 0, "INV-A6:NoOverrunB");
+    TEST_ASSERT(rtos_task_get_deadline_misses(g_handle_a) == 0, "INV-A6:NoMissA");
+    TEST_ASSERT(rtos_task_get_deadline_misses(g_handle_b) == 0, "INV-A6:NoMissB");
+
+    /* Final verdict */
+    TEST_EMIT_VERDICT();
+
+    test_log_task("END", "Controller");
+    while (1)
+    {
+        rtos_delay_ms(1000);
+    }
+}
+
+/* =================== Timer Callbacks =================== */
+
+static void startup_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    g_test_started = true;
+    test_log_framework("BEGIN", "TaskAdmission");
+    rtos_timer_handle_t *p = (rtos_timer_handle_t *) param;
+    rtos_timer_start(*p);
+}
+
+static void test_timeout_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_complete = true;
+    test_log_framework("TIMEOUT", "TaskAdmission");
+}
+
+/* =================== Main =================== */
+
+__attribute__((__noreturn__)) int main(void)
+{
+    rtos_status_t       status;
+    rtos_timer_handle_t startup_timer;
+
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_ALL);
+
+    log_info("Task Admission Control Test");
+    log_info("TaskA: T=%u C=%u  TaskB: T=%u C=%u", TASK_A_PERIOD, TASK_A_WCET, TASK_B_PERIOD, TASK_B_WCET);
+    log_info("Invariants: A1(admit) A2(own miss) A3(victim miss) A4(param) A5(in budget) A6(overrun)");
+
+    status = rtos_init();
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("RTOS init failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = test_create_startup_timer(startup_timer_callback, &g_test_timer, &startup_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Startup timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_timer_create("TestTimer", TEST_DURATION_MS, RTOS_TIMER_ONE_SHOT, test_timeout_callback, NULL,
+                               &g_test_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Test timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t controller_handle;
+    status = rtos_task_create(controller_task_func, "Ctrl", RTOS_DEFAULT_TASK_STACK_SIZE, NULL,
+                              TASK_CONTROLLER_PRIORITY, &controller_handle);
+    if (status != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t flush_handle;
+    test_create_log_flush_task(&flush_handle);
+
+    log_info("Starting scheduler...");
+    status = rtos_start_scheduler();
+
+    indicate_system_failure();
+}
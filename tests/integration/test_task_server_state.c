@@ -0,0 +1,265 @@
+/*******************************************************************************
+ * File: tests/integration/test_task_server_state.c
+ * Description: Budget Server - Overload Containment Invariant Test
+ * Author: Student
+ * Date: 2025
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "config.h"
+#include "device.h" // IWYU pragma: keep
+#include "hardware_env.h"
+#include "rtos_port.h"
+#include "task.h"
+#include "test_common.h"
+#include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
+#include "timer.h"
+#include "uart_tx.h"
+
+/**
+ * @file test_task_server_state.c
+ * @brief Budget Server Overload Containment Test (RTOS_USE_BUDGET_SERVER)
+ *
+ * SCENARIO
+ * --------
+ * Hog simulates an aperiodic handler under a packet flood: it never blocks.
+ * It sits above Victim, so without a server Victim would never run.
+ *
+ *   Monitor (priority 5) — samples server state, emits the verdict
+ *   Hog     (priority 4) — spins forever; server: 20 ticks / 100, background 1
+ *   Victim  (priority 3) — 5 ms delay loop, counts iterations
+ *   LogFlush(priority 2) — also above Hog's background priority
+ *
+ * INVARIANTS
+ * ----------
+ * INV-S1  Victim makes progress in every 100 ms window.
+ * INV-S2  Hog exhausts its budget once per period: after N periods the
+ *         exhaustion count is within N +/- 1.
+ * INV-S3  Hog's priority is the foreground one while budget remains and the
+ *         background one while it is exhausted (sampled atomically).
+ * INV-S4  Hog still runs while exhausted, in the time left below priority 2.
+ * INV-S5  Removing the server restores the foreground priority.
+ */
+
+/* =================== Test Parameters =================== */
+
+#define TASK_MON_PRIORITY    (5U)
+#define TASK_HOG_PRIORITY    (4U)
+#define TASK_VICTIM_PRIORITY (3U)
+#define TASK_FLUSH_PRIORITY  (2U)
+#define HOG_BG_PRIORITY      (1U)
+
+#define SERVER_BUDGET_TICKS (20U)
+#define SERVER_PERIOD_TICKS (100U)
+
+#define VICTIM_DELAY_MS  (5U)
+#define SAMPLE_MS        (10U)
+#define WINDOW_SAMPLES   (10U) /* 100 ms */
+#define TEST_WINDOWS     (20U)
+#define TEST_DURATION_MS (5000U)
+
+/* =================== Shared State =================== */
+
+static volatile bool g_test_started  = false;
+static volatile bool g_test_complete = false;
+
+static rtos_timer_handle_t g_test_timer;
+
+static rtos_task_handle_t g_handle_hog = NULL;
+
+static volatile uint32_t g_victim_runs      = 0;
+static volatile uint32_t g_hog_bg_spins     = 0; /* Hog loop iterations at background priority */
+static volatile uint32_t g_state_violations = 0;
+
+/* =================== Task Implementations =================== */
+
+static void hog_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+
+    while (1)
+    {
+        if (rtos_task_get_priority(g_handle_hog) == HOG_BG_PRIORITY)
+        {
+            g_hog_bg_spins++;
+        }
+    }
+}
+
+static void victim_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+
+    while (1)
+    {
+        g_victim_runs++;
+        rtos_delay_ms(VICTIM_DELAY_MS);
+    }
+}
+
+/* INV-S3: priority must match the budget state */
+static void check_server_state(void)
+{
+    rtos_port_enter_critical();
+
+    rtos_tick_t     remaining = rtos_task_get_server_budget(g_handle_hog);
+    rtos_priority_t prio      = rtos_task_get_priority(g_handle_hog);
+
+    rtos_port_exit_critical();
+
+    if (prio != (remaining > 0 ? TASK_HOG_PRIORITY : HOG_BG_PRIORITY))
+    {
+        g_state_violations++;
+    }
+}
+
+static void monitor_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Monitor");
+
+    /* Let Hog reach its first exhaustion so windows start in steady state */
+    rtos_delay_ms(SERVER_PERIOD_TICKS);
+
+    uint32_t    exhaustions_start = rtos_task_get_server_exhaustions(g_handle_hog);
+    rtos_tick_t tick_start        = rtos_get_tick_count();
+
+    for (uint32_t w = 0; w < TEST_WINDOWS && !g_test_complete; w++)
+    {
+        uint32_t runs_before = g_victim_runs;
+
+        for (uint32_t s = 0; s < WINDOW_SAMPLES; s++)
+        {
+            rtos_delay_ms(SAMPLE_MS);
+            check_server_state();
+        }
+
+        /* INV-S1 */
+        TEST_ASSERT(g_victim_runs != runs_before, "INV-S1:VictimProgress");
+    }
+
+    uint32_t periods     = (rtos_get_tick_count() - tick_start) / SERVER_PERIOD_TICKS;
+    uint32_t exhaustions = rtos_task_get_server_exhaustions(g_handle_hog) - exhaustions_start;
+
+    TEST_ASSERT(exhaustions + 1U >= periods && exhaustions <= periods + 1U, "INV-S2:OneExhaustionPerPeriod");
+    TEST_ASSERT(g_state_violations == 0, "INV-S3:PriorityMatchesBudget");
+    TEST_ASSERT(g_hog_bg_spins > 0, "INV-S4:BackgroundProgress");
+
+    /* INV-S5: Hog is back at 4 for good, so park it right after the check */
+    TEST_ASSERT(rtos_task_set_budget_server(g_handle_hog, 0, 0, 0) == RTOS_SUCCESS, "INV-S5:RemoveServer");
+    TEST_ASSERT(rtos_task_get_priority(g_handle_hog) == TASK_HOG_PRIORITY, "INV-S5:ForegroundRestored");
+    rtos_task_suspend(g_handle_hog);
+
+    /* Final verdict */
+    TEST_EMIT_VERDICT();
+
+    test_log_task("END", "Monitor");
+    while (1)
+    {
+        rtos_delay_ms(1000);
+    }
+}
+
+/* =================== Timer Callbacks =================== */
+
+static void startup_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    g_test_started = true;
+    test_log_framework("BEGIN", "TaskServer");
+    rtos_timer_handle_t *p = (rtos_timer_handle_t *) param;
+    rtos_timer_start(*p);
+}
+
+static void test_timeout_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_complete = true;
+    test_log_framework("TIMEOUT", "TaskServer");
+}
+
+/* =================== Main =================== */
+
+__attribute__((__noreturn__)) int main(void)
+{
+    rtos_status_t       status;
+    rtos_timer_handle_t startup_timer;
+
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_ALL);
+
+    log_info("Budget Server Test");
+    log_info("Hog: prio=%u budget=%u/%u bg=%u  Victim: prio=%u", TASK_HOG_PRIORITY, SERVER_BUDGET_TICKS,
+             SERVER_PERIOD_TICKS, HOG_BG_PRIORITY, TASK_VICTIM_PRIORITY);
+    log_info("Invariants: S1(victim) S2(exhaustions) S3(priority) S4(background) S5(remove)");
+
+    status = rtos_init();
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("RTOS init failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = test_create_startup_timer(startup_timer_callback, &g_test_timer, &startup_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Startup timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_timer_create("TestTimer", TEST_DURATION_MS, RTOS_TIMER_ONE_SHOT, test_timeout_callback, NULL,
+                               &g_test_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Test timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_task_create(hog_task_func, "Hog", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_HOG_PRIORITY,
+                              &g_handle_hog);
+    if (status != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    status = rtos_task_set_budget_server(g_handle_hog, SERVER_BUDGET_TICKS, SERVER_PERIOD_TICKS, HOG_BG_PRIORITY);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Budget server failed: %d", status);
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t victim_handle;
+    status = rtos_task_create(victim_task_func, "Victim", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_VICTIM_PRIORITY,
+                              &victim_handle);
+    if (status != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t monitor_handle;
+    status = rtos_task_create(monitor_task_func, "Mon", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_MON_PRIORITY,
+                              &monitor_handle);
+    if (status != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    /* Flush above Hog's background priority so the log drains under the flood */
+    rtos_task_handle_t flush_handle;
+    ulog_init(ULOG_LEVEL_INFO);
+    rtos_task_create(log_flush_task, "LogFlush", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_FLUSH_PRIORITY,
+                     &flush_handle);
+
+    log_info("Starting scheduler...");
+    status = rtos_start_scheduler();
+
+    indicate_system_failure();
+}
@@ -0,0 +1,348 @@
+/*******************************************************************************
+ * File: tests/integration/test_time64_state.c
+ * Description: 64-bit Time Base - Monotonicity & Wrap Invariant Test
+ * Author: Student
+ * Date: 2025
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "config.h"
+#include "device.h" // IWYU pragma: keep
+#include "hardware_env.h"
+#include "rtos_port.h"
+#include "rtos_time.h"
+#include "task.h"
+#include "test_common.h"
+#include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
+#include "timer.h"
+#include "uart_tx.h"
+
+/**
+ * @file test_time64_state.c
+ * @brief 64-bit Time Base Monotonicity & Wrap Invariant Test
+ *
+ * SCENARIO
+ * --------
+ * Phase 1 — Control checks the 64-bit values against the 32-bit tick and
+ * cycle counters they extend, and against a timed delay.
+ *
+ * Phase 2 (SAMPLE_MS) — Sampler (priority 2) reads all three time bases in
+ * a loop and pends TEST_IRQn between two reads; the handler, in the
+ * zero-latency tier above the kernel mask, reads them too.  The phase is
+ * long enough for CYCCNT to wrap when the core clock exceeds about
+ * 2^32 / SAMPLE_MS per millisecond (the POSIX port's 1 GHz emulated clock
+ * wraps every 4.3 s).
+ *
+ *   Sampler (priority 2) — samples, pends the IRQ, delays a tick every
+ *                          SAMPLES_PER_TICK samples
+ *   Control (priority 1) — drives the phases and checks
+ *
+ * INVARIANTS
+ * ----------
+ * INV-T1  The low word of rtos_time_cycles64() is DWT->CYCCNT.
+ * INV-T2  The low word of rtos_get_tick_count64() is rtos_get_tick_count().
+ * INV-T3  rtos_time_cycles64(), rtos_time_now_ns() and
+ *         rtos_get_tick_count64() never go backwards, in a task or in an
+ *         ISR that interrupts it, including across a CYCCNT wrap.
+ * INV-T4  rtos_time_now_ns() lies within the current tick.
+ * INV-T5  Time measured across a delay matches the delay, in cycles
+ *         (via rtos_time_cycles_to_ns()) and in nanoseconds.
+ */
+
+/* =================== Test Parameters =================== */
+
+#define TASK_SAMPLER_PRIORITY (2U)
+#define TASK_CONTROL_PRIORITY (1U)
+
+#define TEST_IRQn        TEST_SPARE_IRQn
+#define TEST_IRQ_PRIO    (4U) /* Zero-latency tier: above the kernel mask */
+#define SAMPLES_PER_TICK (64U)
+#define DELAY_MS         (100U)
+#define SAMPLE_MS        (5000U)
+#define SETTLE_MS        (5U)
+#define TEST_DURATION_MS (8000U)
+
+#define NS_PER_TICK (1000000000ULL / RTOS_TICK_RATE_HZ)
+
+/* =================== Shared State =================== */
+
+static volatile bool g_test_started  = false;
+static volatile bool g_test_complete = false;
+static volatile bool g_sampling      = false;
+
+static rtos_timer_handle_t g_test_timer;
+
+/* Written by the handler, read by Sampler around the pend */
+static volatile uint64_t g_isr_cycles = 0;
+static volatile uint64_t g_isr_ns     = 0;
+static volatile uint64_t g_isr_ticks  = 0;
+
+/* Sampler results */
+static volatile uint32_t g_samples          = 0;
+static volatile uint32_t g_isr_samples      = 0;
+static volatile uint32_t g_backwards_cycles = 0;
+static volatile uint32_t g_backwards_ns     = 0;
+static volatile uint32_t g_backwards_ticks  = 0;
+static volatile uint32_t g_isr_out_of_order = 0;
+static volatile uint64_t g_first_cycles     = 0;
+static volatile uint64_t g_last_cycles      = 0;
+
+/* =================== Interrupt Handler =================== */
+
+void TEST_SPARE_IRQHandler(void)
+{
+    g_isr_cycles = rtos_time_cycles64();
+    g_isr_ns     = rtos_time_now_ns();
+    g_isr_ticks  = rtos_get_tick_count64();
+    g_isr_samples++;
+}
+
+/* =================== Helpers =================== */
+
+static void fire_isr(void)
+{
+    NVIC_SetPendingIRQ(TEST_IRQn);
+    __DSB();
+    __ISB();
+}
+
+/* True if value lies in the modular range [from, to] of CYCCNT */
+static bool cyccnt_between(uint32_t from, uint32_t value, uint32_t to)
+{
+    return (uint32_t) (value - from) <= (uint32_t) (to - from);
+}
+
+/* =================== Task Implementations =================== */
+
+static void sampler_task_func(void *param)
+{
+    (void) param;
+
+    uint64_t prev_cycles = 0;
+    uint64_t prev_ns     = 0;
+    uint64_t prev_ticks  = 0;
+    uint32_t n           = 0;
+
+    while (1)
+    {
+        if (!g_sampling)
+        {
+            rtos_delay_ticks(1);
+            continue;
+        }
+
+        uint64_t cycles = rtos_time_cycles64();
+        uint64_t ns     = rtos_time_now_ns();
+        uint64_t ticks  = rtos_get_tick_count64();
+
+        if (g_samples == 0U)
+        {
+            g_first_cycles = cycles;
+        }
+        else
+        {
+            g_backwards_cycles += (cycles < prev_cycles) ? 1U : 0U;
+            g_backwards_ns += (ns < prev_ns) ? 1U : 0U;
+            g_backwards_ticks += (ticks < prev_ticks) ? 1U : 0U;
+        }
+
+        /* The handler runs between this sample and the next */
+        fire_isr();
+
+        uint64_t after_cycles = rtos_time_cycles64();
+        uint64_t after_ns     = rtos_time_now_ns();
+        uint64_t after_ticks  = rtos_get_tick_count64();
+
+        if (g_isr_cycles < cycles || g_isr_cycles > after_cycles || g_isr_ns < ns || g_isr_ns > after_ns ||
+            g_isr_ticks < ticks || g_isr_ticks > after_ticks)
+        {
+            g_isr_out_of_order++;
+        }
+
+        prev_cycles   = after_cycles;
+        prev_ns       = after_ns;
+        prev_ticks    = after_ticks;
+        g_last_cycles = after_cycles;
+        g_samples++;
+
+        if (++n % SAMPLES_PER_TICK == 0U)
+        {
+            rtos_delay_ticks(1);
+        }
+    }
+}
+
+static void check_against_counters(void)
+{
+    bool low_is_cyccnt = true;
+    bool low_is_tick   = true;
+    bool within_tick   = true;
+
+    for (uint32_t i = 0; i < 100U; i++)
+    {
+        rtos_port_enter_critical();
+
+        uint32_t    before = DWT->CYCCNT;
+        uint64_t    cycles = rtos_time_cycles64();
+        uint32_t    after  = DWT->CYCCNT;
+        rtos_tick_t tick   = rtos_get_tick_count();
+        uint64_t    tick64 = rtos_get_tick_count64();
+        uint64_t    ns     = rtos_time_now_ns();
+
+        rtos_port_exit_critical();
+
+        low_is_cyccnt = low_is_cyccnt && cyccnt_between(before, (uint32_t) cycles, after);
+        low_is_tick   = low_is_tick && ((uint32_t) tick64 == tick);
+        within_tick   = within_tick && (ns >= tick64 * NS_PER_TICK) && (ns < (tick64 + 1U) * NS_PER_TICK);
+
+        rtos_delay_ticks(1);
+    }
+
+    TEST_ASSERT(low_is_cyccnt, "INV-T1:LowWordIsCYCCNT");
+    TEST_ASSERT(low_is_tick, "INV-T2:LowWordIsTickCount");
+    TEST_ASSERT(within_tick, "INV-T4:NsWithinTick");
+}
+
+static void check_delay(void)
+{
+    uint64_t cycles_start = rtos_time_cycles64();
+    uint64_t ns_start     = rtos_time_now_ns();
+    uint64_t ticks_start  = rtos_get_tick_count64();
+
+    rtos_delay_ms(DELAY_MS);
+
+    uint64_t cycles_ns = rtos_time_cycles_to_ns(rtos_time_cycles64() - cycles_start);
+    uint64_t ns        = rtos_time_now_ns() - ns_start;
+    uint64_t ticks     = rtos_get_tick_count64() - ticks_start;
+
+    /* The delay ends on a tick boundary, up to a tick after DELAY_MS */
+    uint64_t low  = ((uint64_t) DELAY_MS * 1000000ULL) - NS_PER_TICK;
+    uint64_t high = ((uint64_t) DELAY_MS * 1000000ULL) + (2U * NS_PER_TICK);
+
+    TEST_ASSERT(ticks >= DELAY_MS / RTOS_TICK_PERIOD_MS, "INV-T5:TicksCoverDelay");
+    TEST_ASSERT(ns >= low && ns <= high, "INV-T5:NsMatchesDelay");
+    TEST_ASSERT(cycles_ns >= low && cycles_ns <= high, "INV-T5:CyclesMatchDelay");
+    TEST_ASSERT(rtos_time_cycles_to_ns(SystemCoreClock) == 1000000000ULL, "INV-T5:OneSecondOfCycles");
+}
+
+static void control_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Control");
+
+    /* --- Phase 1 --- */
+    check_against_counters();
+    check_delay();
+
+    /* --- Phase 2 --- */
+    g_sampling = true;
+    rtos_delay_ms(SAMPLE_MS);
+    g_sampling = false;
+    rtos_delay_ms(SETTLE_MS);
+
+    uint64_t span = g_last_cycles - g_first_cycles;
+
+    TEST_ASSERT(g_samples > 0U && g_isr_samples > 0U, "T-SETUP:Sampled");
+    TEST_ASSERT(g_backwards_cycles == 0U, "INV-T3:CyclesMonotonic");
+    TEST_ASSERT(g_backwards_ns == 0U, "INV-T3:NsMonotonic");
+    TEST_ASSERT(g_backwards_ticks == 0U, "INV-T3:TicksMonotonic");
+    TEST_ASSERT(g_isr_out_of_order == 0U, "INV-T3:IsrSampleOrdered");
+
+    /* A phase longer than one CYCCNT period must have crossed a wrap */
+    if ((uint64_t) SystemCoreClock * SAMPLE_MS / 1000U > (1ULL << 32))
+    {
+        TEST_ASSERT((g_last_cycles >> 32) != (g_first_cycles >> 32), "INV-T3:CrossedWrap");
+        TEST_ASSERT(span > (1ULL << 32), "INV-T3:SpanPastWrap");
+    }
+
+    log_info("Time64 samples=%u isr=%u span=%lu ms wraps=%u", (unsigned) g_samples, (unsigned) g_isr_samples,
+             (unsigned long) (rtos_time_cycles_to_ns(span) / 1000000ULL),
+             (unsigned) ((g_last_cycles >> 32) - (g_first_cycles >> 32)));
+
+    TEST_EMIT_VERDICT();
+
+    test_log_task("END", "Control");
+    while (1)
+    {
+        rtos_delay_ms(1000);
+    }
+}
+
+/* =================== Timer Callbacks =================== */
+
+static void startup_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    g_test_started = true;
+    test_log_framework("BEGIN", "Time64");
+    rtos_timer_handle_t *p = (rtos_timer_handle_t *) param;
+    rtos_timer_start(*p);
+}
+
+static void test_timeout_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_complete = true;
+    test_log_framework("TIMEOUT", "Time64");
+}
+
+/* =================== Main =================== */
+
+__attribute__((__noreturn__)) int main(void)
+{
+    rtos_status_t       status;
+    rtos_timer_handle_t startup_timer;
+
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_ALL);
+
+    log_info("64-bit Time Base Monotonicity & Wrap Test");
+    log_info("Sampler=%u Control=%u  core=%lu Hz  sample=%u ms", TASK_SAMPLER_PRIORITY, TASK_CONTROL_PRIORITY,
+             (unsigned long) SystemCoreClock, SAMPLE_MS);
+    log_info("Invariants: T1(cycles low word) T2(tick low word) T3(monotonic) T4(ns in tick) T5(delay)");
+
+    status = rtos_init();
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("RTOS init failed: %d", status);
+        indicate_system_failure();
+    }
+
+    NVIC_SetPriority(TEST_IRQn, TEST_IRQ_PRIO);
+    NVIC_EnableIRQ(TEST_IRQn);
+
+    status = test_create_startup_timer(startup_timer_callback, &g_test_timer, &startup_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Startup timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_timer_create("TestTimer", TEST_DURATION_MS, RTOS_TIMER_ONE_SHOT, test_timeout_callback, NULL,
+                               &g_test_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Test timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t handle;
+    if (rtos_task_create(sampler_task_func, "Sampler", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_SAMPLER_PRIORITY,
+                         &handle) != RTOS_SUCCESS ||
+        rtos_task_create(control_task_func, "Control", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_CONTROL_PRIORITY,
+                         &handle) != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t flush_handle;
+    test_create_log_flush_task(&flush_handle);
+
+    log_info("Starting scheduler...");
+    status = rtos_start_scheduler();
+
+    indicate_system_failure();
+}
@@ -0,0 +1,372 @@
+/*******************************************************************************
+ * File: tests/integration/test_timer_slack_state.c
+ * Description: Timer Slack - Expiry Coalescing Invariant Test
+ * Author: Student
+ * Date: 2025
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "config.h"
+#include "hardware_env.h"
+#include "task.h"
+#include "test_common.h"
+#include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
+#include "timer.h"
+#include "uart_tx.h"
+
+/**
+ * @file test_timer_slack_state.c
+ * @brief Timer Slack Expiry Coalescing Invariant Test
+ *
+ * SCENARIO
+ * --------
+ * Three auto-reload timers with unrelated periods (10, 14 and 22 ticks) run
+ * for PHASE_TICKS, started in one tick.  Every callback records the tick it
+ * ran in against the timer's nominal deadline (start + n * period), and
+ * counts the distinct ticks in which any timer fired (wake-ups).
+ *
+ * Phase 1 — No slack: each timer fires at its deadline.
+ * Phase 2 — Each timer gets slack (4, 6 and 9 ticks) and joins whichever
+ *           of the others' expiries falls inside its window.
+ * Phase 3 — One-shots: with slack and another expiry inside the window a
+ *           one-shot fires with it; with no expiry in the window it fires
+ *           at its deadline; slack beyond an auto-reload period is capped.
+ *
+ *   Control (priority 1) — drives the phases and checks
+ *
+ * INVARIANTS
+ * ----------
+ * INV-S1  A timer never fires before its deadline.
+ * INV-S2  A timer never fires more than its slack after its deadline
+ *         (exactly at it with no slack).
+ * INV-S3  Deadlines step by the period: lateness does not accumulate, so
+ *         each timer fires once per period over the phase.
+ * INV-S4  Slack reduces the number of wake-ups.
+ * INV-S5  A one-shot with slack joins an expiry inside its window, and
+ *         fires at its deadline when there is none.
+ * INV-S6  Slack of an auto-reload timer is capped below its period, so it
+ *         never skips a period.
+ */
+
+/* =================== Test Parameters =================== */
+
+#define TASK_CONTROL_PRIORITY (1U)
+
+#define NUM_TIMERS       (3U)
+#define PHASE_TICKS      (770U) /* lcm(10, 14, 22) */
+#define PHASE_TAIL       (9U) /* Largest slack: the last batch fires, the next deadline does not */
+#define SETTLE_TICKS     (30U)
+#define ANCHOR_PERIOD    (50U)
+#define ONESHOT_PERIOD   (46U)
+#define ONESHOT_SLACK    (6U)
+#define LONE_PERIOD      (23U)
+#define CAPPED_PERIOD    (4U)
+#define CAPPED_TICKS     (200U)
+#define TEST_DURATION_MS (8000U)
+
+static const rtos_tick_t g_periods[NUM_TIMERS] = {10U, 14U, 22U};
+static const rtos_tick_t g_slacks[NUM_TIMERS]  = {4U, 6U, 9U};
+
+/* =================== Shared State =================== */
+
+static volatile bool g_test_started  = false;
+static volatile bool g_test_complete = false;
+
+static rtos_timer_handle_t g_test_timer;
+
+typedef struct
+{
+    rtos_tick_t period;
+    rtos_tick_t slack;     /* Expected bound for this phase */
+    rtos_tick_t nominal;   /* Next deadline */
+    uint32_t    fires;
+    uint32_t    early;     /* Fired before the deadline */
+    uint32_t    late;      /* Fired more than slack after it */
+    rtos_tick_t last_fire; /* Tick of the latest firing */
+} timer_track_t;
+
+static rtos_timer_handle_t    g_timers[NUM_TIMERS];
+static volatile timer_track_t g_track[NUM_TIMERS];
+static volatile uint32_t      g_wakeups   = 0;
+static volatile rtos_tick_t   g_last_wake = 0;
+
+/* Phase 3 */
+static rtos_timer_handle_t    g_anchor;
+static rtos_timer_handle_t    g_oneshot;
+static rtos_timer_handle_t    g_lone;
+static rtos_timer_handle_t    g_capped;
+static volatile rtos_tick_t   g_anchor_tick  = 0;
+static volatile rtos_tick_t   g_oneshot_tick = 0;
+static volatile rtos_tick_t   g_lone_tick    = 0;
+static volatile uint32_t      g_capped_fires = 0;
+static volatile uint32_t      g_capped_late  = 0;
+static volatile rtos_tick_t   g_capped_nominal;
+
+/* =================== Timer Callbacks =================== */
+
+static void record_fire(volatile timer_track_t *t)
+{
+    rtos_tick_t now = rtos_get_tick_count();
+
+    if ((int32_t) (now - t->nominal) < 0)
+    {
+        t->early++;
+    }
+    else if ((rtos_tick_t) (now - t->nominal) > t->slack)
+    {
+        t->late++;
+    }
+
+    t->nominal += t->period;
+    t->last_fire = now;
+    t->fires++;
+
+    if (g_wakeups == 0U || now != g_last_wake)
+    {
+        g_last_wake = now;
+        g_wakeups++;
+    }
+}
+
+static void periodic_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    record_fire(&g_track[(uint32_t) (uintptr_t) param]);
+}
+
+static void stamp_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    *(volatile rtos_tick_t *) param = rtos_get_tick_count();
+}
+
+static void capped_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+
+    rtos_tick_t now = rtos_get_tick_count();
+    if ((rtos_tick_t) (now - g_capped_nominal) >= CAPPED_PERIOD)
+    {
+        g_capped_late++;
+    }
+    g_capped_nominal += CAPPED_PERIOD;
+    g_capped_fires++;
+}
+
+/* =================== Helpers =================== */
+
+/* Start every phase timer in one tick, so they share a start for the deadlines */
+static void run_phase(bool with_slack)
+{
+    for (uint32_t i = 0; i < NUM_TIMERS; i++)
+    {
+        rtos_timer_set_slack(g_timers[i], with_slack ? g_slacks[i] : 0U);
+    }
+
+    rtos_tick_t start;
+    do
+    {
+        for (uint32_t i = 0; i < NUM_TIMERS; i++)
+        {
+            rtos_timer_stop(g_timers[i]);
+        }
+        rtos_delay_ticks(1);
+
+        start     = rtos_get_tick_count();
+        g_wakeups = 0;
+        for (uint32_t i = 0; i < NUM_TIMERS; i++)
+        {
+            g_track[i].period  = g_periods[i];
+            g_track[i].slack   = with_slack ? g_slacks[i] : 0U;
+            g_track[i].nominal = start + g_periods[i];
+            g_track[i].fires   = 0;
+            g_track[i].early   = 0;
+            g_track[i].late    = 0;
+            rtos_timer_start(g_timers[i]);
+        }
+    } while (rtos_get_tick_count() != start);
+
+    /* Every timer's last deadline is PHASE_TICKS; its next one is a period later */
+    rtos_delay_until(&start, PHASE_TICKS + PHASE_TAIL);
+
+    for (uint32_t i = 0; i < NUM_TIMERS; i++)
+    {
+        rtos_timer_stop(g_timers[i]);
+    }
+    rtos_delay_ticks(SETTLE_TICKS);
+}
+
+static void check_phase(const char *early_name, const char *late_name, const char *period_name)
+{
+    bool none_early = true;
+    bool none_late  = true;
+    bool per_period = true;
+
+    for (uint32_t i = 0; i < NUM_TIMERS; i++)
+    {
+        none_early = none_early && g_track[i].early == 0U;
+        none_late  = none_late && g_track[i].late == 0U;
+        per_period = per_period && g_track[i].fires == PHASE_TICKS / g_periods[i];
+    }
+
+    TEST_ASSERT(none_early, early_name);
+    TEST_ASSERT(none_late, late_name);
+    TEST_ASSERT(per_period, period_name);
+}
+
+/* =================== Task Implementations =================== */
+
+static void control_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Control");
+
+    /* --- Phase 1 --- */
+    run_phase(false);
+    check_phase("INV-S1:NoSlackNotEarly", "INV-S2:NoSlackOnDeadline", "INV-S3:NoSlackOncePerPeriod");
+    uint32_t wakeups_exact = g_wakeups;
+
+    /* --- Phase 2 --- */
+    run_phase(true);
+    check_phase("INV-S1:SlackNotEarly", "INV-S2:SlackWithinBound", "INV-S3:SlackOncePerPeriod");
+    uint32_t wakeups_slack = g_wakeups;
+
+    TEST_ASSERT(wakeups_slack < wakeups_exact, "INV-S4:FewerWakeups");
+
+    /* --- Phase 3 --- */
+    rtos_delay_ticks(1);
+    rtos_tick_t start = rtos_get_tick_count();
+    rtos_timer_set_slack(g_oneshot, ONESHOT_SLACK);
+    rtos_timer_set_slack(g_lone, ONESHOT_SLACK);
+    rtos_timer_start(g_anchor);
+    rtos_timer_start(g_oneshot);
+    rtos_timer_start(g_lone);
+    bool same_tick = (rtos_get_tick_count() == start);
+    rtos_delay_ticks(ANCHOR_PERIOD + SETTLE_TICKS);
+
+    if (same_tick)
+    {
+        TEST_ASSERT(g_oneshot_tick == g_anchor_tick && g_anchor_tick == start + ANCHOR_PERIOD,
+                    "INV-S5:OneShotJoinsBatch");
+        TEST_ASSERT(g_lone_tick == start + LONE_PERIOD, "INV-S5:LoneOneShotOnDeadline");
+    }
+
+    rtos_timer_set_slack(g_capped, 100U);
+    rtos_delay_ticks(1);
+    g_capped_nominal = rtos_get_tick_count() + CAPPED_PERIOD;
+    rtos_timer_start(g_capped);
+    rtos_delay_ticks(CAPPED_TICKS);
+    rtos_timer_stop(g_capped);
+
+    TEST_ASSERT(g_capped_late == 0U && g_capped_fires >= (CAPPED_TICKS / CAPPED_PERIOD) - 1U,
+                "INV-S6:SlackCappedBelowPeriod");
+
+    log_info("Slack wakeups exact=%u slack=%u  one-shot=%ld lone=%ld capped=%u", (unsigned) wakeups_exact,
+             (unsigned) wakeups_slack, (long) (g_oneshot_tick - start), (long) (g_lone_tick - start),
+             (unsigned) g_capped_fires);
+
+    TEST_EMIT_VERDICT();
+
+    test_log_task("END", "Control");
+    while (1)
+    {
+        rtos_delay_ms(1000);
+    }
+}
+
+/* =================== Timer Callbacks =================== */
+
+static void startup_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    g_test_started = true;
+    test_log_framework("BEGIN", "TimerSlack");
+    rtos_timer_handle_t *p = (rtos_timer_handle_t *) param;
+    rtos_timer_start(*p);
+}
+
+static void test_timeout_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_complete = true;
+    test_log_framework("TIMEOUT", "TimerSlack");
+}
+
+/* =================== Main =================== */
+
+__attribute__((__noreturn__)) int main(void)
+{
+    rtos_status_t       status;
+    rtos_timer_handle_t startup_timer;
+
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_ALL);
+
+    log_info("Timer Slack Expiry Coalescing Test");
+    log_info("Periods %u/%u/%u ticks, slack %u/%u/%u", (unsigned) g_periods[0], (unsigned) g_periods[1],
+             (unsigned) g_periods[2], (unsigned) g_slacks[0], (unsigned) g_slacks[1], (unsigned) g_slacks[2]);
+    log_info("Invariants: S1(not early) S2(within slack) S3(no drift) S4(fewer wakeups) S5(one-shot) S6(cap)");
+
+    status = rtos_init();
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("RTOS init failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = test_create_startup_timer(startup_timer_callback, &g_test_timer, &startup_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Startup timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_timer_create("TestTimer", TEST_DURATION_MS, RTOS_TIMER_ONE_SHOT, test_timeout_callback, NULL,
+                               &g_test_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Test timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    for (uint32_t i = 0; i < NUM_TIMERS; i++)
+    {
+        if (rtos_timer_create("Periodic", g_periods[i], RTOS_TIMER_AUTO_RELOAD, periodic_callback,
+                              (void *) (uintptr_t) i, &g_timers[i]) != RTOS_SUCCESS)
+        {
+            indicate_system_failure();
+        }
+    }
+
+    if (rtos_timer_create("Anchor", ANCHOR_PERIOD, RTOS_TIMER_ONE_SHOT, stamp_callback, (void *) &g_anchor_tick,
+                          &g_anchor) != RTOS_SUCCESS ||
+        rtos_timer_create("OneShot", ONESHOT_PERIOD, RTOS_TIMER_ONE_SHOT, stamp_callback, (void *) &g_oneshot_tick,
+                          &g_oneshot) != RTOS_SUCCESS ||
+        rtos_timer_create("Lone", LONE_PERIOD, RTOS_TIMER_ONE_SHOT, stamp_callback, (void *) &g_lone_tick,
+                          &g_lone) != RTOS_SUCCESS ||
+        rtos_timer_create("Capped", CAPPED_PERIOD, RTOS_TIMER_AUTO_RELOAD, capped_callback, NULL, &g_capped) !=
+            RTOS_SUCCESS ||
+        rtos_timer_set_slack(NULL, 1U) != RTOS_ERROR_INVALID_PARAM)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t handle;
+    if (rtos_task_create(control_task_func, "Control", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_CONTROL_PRIORITY,
+                         &handle) != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t flush_handle;
+    test_create_log_flush_task(&flush_handle);
+
+    log_info("Starting scheduler...");
+    status = rtos_start_scheduler();
+
+    indicate_system_failure();
+}
@@ -0,0 +1,365 @@
+/*******************************************************************************
+ * File: tests/integration/test_uart_rx_state.c
+ * Description: UART RX DMA Path - Chunking, Notification & Loss Accounting Test
+ * Author: Student
+ * Date: 2025
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "config.h"
+#include "device.h" // IWYU pragma: keep
+#include "hardware_env.h"
+#include "rtos_port.h"
+#include "stream_buffer.h"
+#include "task.h"
+#include "test_common.h"
+#include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
+#include "timer.h"
+#include "uart_rx.h"
+#include "uart_tx.h"
+
+#if !defined(RTOS_TARGET_NATIVE)
+#error "test_uart_rx_state needs the POSIX build: the host stand-in plays the wire"
+#endif
+
+/**
+ * @file test_uart_rx_state.c
+ * @brief UART RX DMA Path Test (POSIX build)
+ *
+ * The wire is uart_rx_host_receive(), called from the spare interrupt: it
+ * writes a burst into the DMA ring and raises the half, full and idle
+ * events the target's DMA stream and USART would.
+ *
+ * SCENARIO
+ * --------
+ * Three tasks plus log flush:
+ *
+ *   Parser     (priority 3) — takes one notification per chunk and drains
+ *                             the stream buffer, checking byte order
+ *   Controller (priority 2) — sends bursts, checks invariants
+ *   Monitor    (priority 1) — emits final verdict
+ *
+ * INVARIANTS
+ * ----------
+ * INV-UR1  A burst shorter than half the ring is one chunk with one
+ *          notification, bytes intact
+ * INV-UR2  A longer burst is cut at the half and full marks: every chunk
+ *          is at most half the ring and one notification each
+ * INV-UR3  Sustained bursts arrive whole and in order, none dropped
+ * INV-UR4  With the reader stalled, bytes past the stream buffer's space
+ *          are dropped and counted; bytes + dropped = bytes sent
+ * INV-UR5  init rejects NULL and a second start
+ */
+
+/* =================== Test Parameters =================== */
+
+#define TASK_PARSER_PRIORITY (3U)
+#define TASK_CTRL_PRIORITY   (2U)
+#define TASK_MON_PRIORITY    (1U)
+
+#define SETTLE_MS        (20U)
+#define BURST_SETTLE_MS  (2U)
+#define MONITOR_POLL_MS  (20U)
+#define IDLE_SPIN_MS     (1000U)
+#define TEST_DURATION_MS (3000U)
+
+#define TEST_IRQn     TEST_SPARE_IRQn
+#define TEST_IRQ_PRIO (14U) /* Below the kernel BASEPRI threshold */
+
+#define RING_SIZE     (256U) /* UART_RX_DMA_SIZE default */
+#define SB_SIZE       (512U)
+#define SHORT_BURST   (40U)
+#define LONG_BURST    (300U)
+#define SUSTAIN_BURST (200U)
+#define SUSTAIN_COUNT (100U)
+
+/* TEST_ASSERT, ASSERT_STATE, g_fail_count are in test_common.h */
+
+/* =================== Shared State =================== */
+
+static volatile bool g_test_started  = false;
+static volatile bool g_test_complete = false;
+
+static rtos_timer_handle_t g_test_timer;
+
+static uint8_t              g_sb_storage[SB_SIZE] __attribute__((aligned(4)));
+static rtos_stream_buffer_t g_sb;
+static rtos_task_handle_t   g_parser;
+
+/* Wire side: the next burst and the running byte pattern */
+static volatile uint32_t g_burst_len = 0;
+static uint8_t           g_wire_seq  = 0;
+static uint32_t          g_wire_sent = 0;
+
+/* Parser side */
+static volatile bool     g_parser_stalled = false;
+static volatile uint32_t g_notifications  = 0;
+static volatile uint32_t g_parsed         = 0;
+static volatile uint32_t g_out_of_order   = 0;
+static uint8_t           g_expect_seq     = 0;
+
+/* =================== Helpers =================== */
+
+static uart_rx_stats_t stats(void)
+{
+    uart_rx_stats_t s;
+    uart_rx_get_stats(&s);
+    return s;
+}
+
+/* Put one burst on the "wire" and let the parser run */
+static void send_burst(uint32_t len)
+{
+    g_burst_len = len;
+    NVIC_SetPendingIRQ(TEST_IRQn);
+    __DSB();
+    __ISB();
+    rtos_delay_ms(BURST_SETTLE_MS);
+}
+
+/* =================== Interrupt Handler =================== */
+
+void TEST_SPARE_IRQHandler(void)
+{
+    uint8_t  burst[LONG_BURST];
+    uint32_t len = g_burst_len;
+
+    for (uint32_t i = 0; i < len; i++)
+    {
+        burst[i] = g_wire_seq++;
+    }
+    g_wire_sent += len;
+
+    uart_rx_host_receive(burst, len);
+}
+
+/* =================== Task Implementations =================== */
+
+static void parser_task_func(void *param)
+{
+    (void) param;
+
+    while (1)
+    {
+        if (rtos_task_notify_take(false, RTOS_MAX_DELAY) != RTOS_NOTIFY_OK)
+        {
+            continue;
+        }
+        g_notifications++;
+
+        uint8_t  buf[64];
+        uint32_t n;
+        while (!g_parser_stalled && rtos_stream_buffer_receive(&g_sb, buf, sizeof(buf), &n, 0U) == RTOS_SUCCESS)
+        {
+            for (uint32_t i = 0; i < n; i++)
+            {
+                if (buf[i] != g_expect_seq)
+                {
+                    g_out_of_order++;
+                }
+                g_expect_seq = (uint8_t) (buf[i] + 1U);
+            }
+            g_parsed += n;
+        }
+    }
+}
+
+static void check_chunks(void)
+{
+    /* INV-UR1 */
+    send_burst(SHORT_BURST);
+    uart_rx_stats_t s = stats();
+    TEST_ASSERT(s.chunks == 1U && g_notifications == 1U, "INV-UR1:OneChunkOneNotification");
+    TEST_ASSERT(s.bytes == SHORT_BURST && g_parsed == SHORT_BURST && g_out_of_order == 0U, "INV-UR1:BytesIntact");
+
+    /* INV-UR2: 40 + 300 crosses the half (128) and full (256) marks */
+    uart_rx_reset_stats();
+    g_notifications = 0;
+    send_burst(LONG_BURST);
+    s = stats();
+    TEST_ASSERT(s.chunks == 3U && g_notifications == 3U, "INV-UR2:CutAtHalfAndFull");
+    TEST_ASSERT(s.max_chunk <= RING_SIZE / 2U, "INV-UR2:ChunksFitHalfRing");
+    TEST_ASSERT(s.bytes == LONG_BURST && g_parsed == SHORT_BURST + LONG_BURST && g_out_of_order == 0U,
+                "INV-UR2:BytesIntact");
+}
+
+static void check_sustained(void)
+{
+    /* INV-UR3 */
+    uint32_t parsed_before = g_parsed;
+
+    uart_rx_reset_stats();
+    for (uint32_t i = 0; i < SUSTAIN_COUNT; i++)
+    {
+        send_burst(SUSTAIN_BURST);
+    }
+
+    uart_rx_stats_t s = stats();
+    TEST_ASSERT(s.bytes == SUSTAIN_BURST * SUSTAIN_COUNT && s.dropped == 0U, "INV-UR3:NoLoss");
+    TEST_ASSERT(g_parsed - parsed_before == SUSTAIN_BURST * SUSTAIN_COUNT, "INV-UR3:AllParsed");
+    TEST_ASSERT(g_out_of_order == 0U, "INV-UR3:InOrder");
+}
+
+static void check_overflow(void)
+{
+    /* INV-UR4: the stream buffer holds SB_SIZE - 1 bytes */
+    uint32_t sent_before = g_wire_sent;
+
+    uart_rx_reset_stats();
+    g_parser_stalled = true;
+    send_burst(LONG_BURST);
+    send_burst(LONG_BURST);
+
+    uart_rx_stats_t s = stats();
+    TEST_ASSERT(s.bytes == SB_SIZE - 1U, "INV-UR4:FilledBuffer");
+    TEST_ASSERT(s.dropped == 2U * LONG_BURST - (SB_SIZE - 1U), "INV-UR4:DropCounted");
+    TEST_ASSERT(s.bytes + s.dropped == g_wire_sent - sent_before, "INV-UR4:Accounted");
+
+    /* The kept bytes are the oldest, still in order */
+    g_parser_stalled = false;
+    rtos_task_notify_give(g_parser);
+    rtos_delay_ms(BURST_SETTLE_MS);
+    TEST_ASSERT(rtos_stream_buffer_bytes_available(&g_sb) == 0U && g_out_of_order == 0U, "INV-UR4:Drained");
+}
+
+static void check_params(void)
+{
+    /* INV-UR5 */
+    TEST_ASSERT(uart_rx_init(NULL, NULL) == RTOS_ERROR_INVALID_PARAM, "INV-UR5:NullBuffer");
+    TEST_ASSERT(uart_rx_init(&g_sb, NULL) == RTOS_ERROR_INVALID_STATE, "INV-UR5:AlreadyStarted");
+}
+
+/*
+ * Controller (priority 2).
+ */
+static void ctrl_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Controller");
+
+    rtos_delay_ms(SETTLE_MS);
+
+    check_chunks();
+    check_sustained();
+    check_overflow();
+    check_params();
+
+    test_log_task("END", "Controller");
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+/*
+ * Monitor task (priority 1).
+ * Emits the final PASS/FAIL verdict.
+ */
+static void monitor_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Monitor");
+
+    while (!g_test_complete)
+    {
+        rtos_delay_ms(MONITOR_POLL_MS);
+    }
+
+    /* Final verdict */
+    TEST_EMIT_VERDICT();
+
+    test_log_task("END", "Monitor");
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+/* =================== Timer Callbacks =================== */
+
+static void startup_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    g_test_started = true;
+    test_log_framework("BEGIN", "UartRxState");
+    rtos_timer_handle_t *p = (rtos_timer_handle_t *) param;
+    rtos_timer_start(*p);
+}
+
+static void test_timeout_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_complete = true;
+    test_log_framework("TIMEOUT", "UartRxState");
+}
+
+/* =================== Main =================== */
+
+__attribute__((__noreturn__)) int main(void)
+{
+    rtos_status_t       status;
+    rtos_timer_handle_t startup_timer;
+
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_ALL);
+
+    log_info("UART RX DMA Path Test");
+    log_info("Priorities: Parser=%u Ctrl=%u Mon=%u", TASK_PARSER_PRIORITY, TASK_CTRL_PRIORITY, TASK_MON_PRIORITY);
+    log_info("Invariants: UR1(short) UR2(half_full) UR3(sustained) UR4(overflow) UR5(params)");
+
+    status = rtos_init();
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("RTOS init failed: %d", status);
+        indicate_system_failure();
+    }
+
+    if (rtos_task_create(parser_task_func, "Parser", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_PARSER_PRIORITY,
+                         &g_parser) != RTOS_SUCCESS ||
+        rtos_stream_buffer_init(&g_sb, g_sb_storage, SB_SIZE, 1U) != RTOS_SUCCESS ||
+        uart_rx_init(&g_sb, g_parser) != RTOS_SUCCESS)
+    {
+        log_error("UART RX setup failed");
+        indicate_system_failure();
+    }
+
+    NVIC_SetPriority(TEST_IRQn, TEST_IRQ_PRIO);
+    NVIC_EnableIRQ(TEST_IRQn);
+
+    status = test_create_startup_timer(startup_timer_callback, &g_test_timer, &startup_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Startup timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_timer_create("TestTimer", TEST_DURATION_MS, RTOS_TIMER_ONE_SHOT, test_timeout_callback, NULL,
+                               &g_test_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Test timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t handle;
+    if (rtos_task_create(ctrl_task_func, "Controller", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_CTRL_PRIORITY,
+                         &handle) != RTOS_SUCCESS ||
+        rtos_task_create(monitor_task_func, "Monitor", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_MON_PRIORITY,
+                         &handle) != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t flush_handle;
+    test_create_log_flush_task(&flush_handle);
+
+    log_info("Starting scheduler...");
+    status = rtos_start_scheduler();
+
+    indicate_system_failure();
+}
@@ -0,0 +1,482 @@
+/*******************************************************************************
+ * File: tests/integration/test_wait_queue_state.c
+ * Description: Priority Wait Queue - Wake Order & Requeue Invariant Test
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "config.h"
+#include "device.h" // IWYU pragma: keep
+#include "event_group.h"
+#include "hardware_env.h"
+#include "mutex.h"
+#include "semaphore.h"
+#include "task.h"
+#include "test_common.h"
+#include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
+#include "timer.h"
+#include "uart_tx.h"
+
+/**
+ * @file test_wait_queue_state.c
+ * @brief Priority Wait Queue Wake Order & Requeue Invariant Test
+ *
+ * SCENARIO
+ * --------
+ * Phase 1 — semaphore (count 0), SIGNAL_CYCLES cycles.  Each waiter
+ * suspends itself between waits; the Controller resumes them one by one, so
+ * each blocks at once and the arrival order is fixed:
+ *
+ *   W5  (priority 5), W4 (priority 4)
+ *   W3a (priority 3) — waits first in its band
+ *   Timed (priority 3) — waits second with a short timeout
+ *   W3b (priority 3) — waits third
+ *   W2  (priority 2) — waits through every cycle, signalled at the end
+ *   Controller (priority 1) — signals once per untimed waiter
+ *
+ * Phase 2 — mutexes M1, M2, each task resumed in turn by the Controller:
+ *
+ *   Holder (priority 2) — locks M1, suspends, then unlocks M1
+ *   Early  (priority 3) — blocks on M1
+ *   Chain  (priority 3) — locks M2, blocks on M1 behind Early
+ *   Top    (priority 5) — blocks on M2, boosting Chain and Holder to 5
+ *
+ * Phase 3 — event group, the Phase 1 waiters except Timed resumed in turn:
+ *
+ *   W5, W3a, W2 wait for EVENT_A; W4, W3b wait for EVENT_B
+ *   Controller sets EVENT_A, then EVENT_B; each set walks every waiter
+ *
+ * The priorities above are levels 1..5 times WQ_PRIO_STEP. With more than
+ * 32 levels the step puts them in different words of the priority bitmap, so
+ * pop and the event group walk cross the group word (native_test_*_prio64,
+ * native_test_*_prio256).
+ *
+ * INVARIANTS
+ * ----------
+ * INV-W1  Signals wake waiters highest priority first, and W3a before W3b.
+ * INV-W2  The Timed waiter times out from the middle of its band without
+ *         disturbing the order of the others.
+ * INV-W3  Priority inheritance reaches the end of the chain (Holder = 5).
+ * INV-W4  The boosted Chain task moves ahead of Early in M1's wait queue,
+ *         so it is handed M1 first.
+ * INV-W5  Every task is back at its base priority afterwards.
+ * INV-W6  One set_bits wakes exactly the waiters of that bit, in every
+ *         priority band: W5, W3a and W2, then W4 and W3b.
+ */
+
+/* =================== Test Parameters =================== */
+
+#if RTOS_MAX_TASK_PRIORITIES >= 192U
+#define WQ_PRIO_STEP (32U) /* one bitmap word per level */
+#elif RTOS_MAX_TASK_PRIORITIES > 32U
+#define WQ_PRIO_STEP (RTOS_MAX_TASK_PRIORITIES / 8U) /* levels 4 and 5 in the second word */
+#else
+#define WQ_PRIO_STEP (1U)
+#endif
+
+#define WQ_PRIO(level) ((rtos_priority_t) ((level) * WQ_PRIO_STEP))
+
+#define TASK_CTRL_PRIORITY WQ_PRIO(1U)
+
+#define SIGNAL_CYCLES    (5U)
+#define CYCLE_WAKES      (4U) /* W5, W4, W3a, W3b */
+#define SETTLE_MS        (40U)
+#define TIMED_WAIT_MS    (10U)
+#define POLL_MS          (10U)
+#define TEST_DURATION_MS (6000U)
+
+#define WAITER_ORDER_LEN (SIGNAL_CYCLES * CYCLE_WAKES + 1U)
+
+#define EVENT_A (1U << 0)
+#define EVENT_B (1U << 1)
+
+/* =================== Shared State =================== */
+
+static volatile bool g_test_started  = false;
+static volatile bool g_test_complete = false;
+
+static rtos_timer_handle_t g_test_timer;
+
+static rtos_semaphore_t g_sem;
+static rtos_mutex_t     g_m1;
+static rtos_mutex_t     g_m2;
+
+static rtos_event_group_t g_eg;
+
+typedef struct
+{
+    char            tag;      /* Recorded in g_wake_order */
+    rtos_priority_t priority; /* Task priority */
+    rtos_tick_t     timeout;  /* Wait timeout in ticks */
+    uint32_t        event;    /* Phase 3 bit, 0 = sits it out */
+} waiter_cfg_t;
+
+/* Resume order within a cycle; W2 (last) is resumed in the first cycle only */
+enum
+{
+    WAITER_W5,
+    WAITER_W4,
+    WAITER_W3A,
+    WAITER_TIMED,
+    WAITER_W3B,
+    WAITER_W2,
+    WAITER_COUNT
+};
+
+static const waiter_cfg_t g_waiter_cfg[WAITER_COUNT] = {
+    [WAITER_W5]    = {'5', WQ_PRIO(5U), RTOS_SEM_MAX_WAIT, EVENT_A},
+    [WAITER_W4]    = {'4', WQ_PRIO(4U), RTOS_SEM_MAX_WAIT, EVENT_B},
+    [WAITER_W3A]   = {'a', WQ_PRIO(3U), RTOS_SEM_MAX_WAIT, EVENT_A},
+    [WAITER_TIMED] = {'t', WQ_PRIO(3U), TIMED_WAIT_MS / RTOS_TICK_PERIOD_MS, 0U},
+    [WAITER_W3B]   = {'b', WQ_PRIO(3U), RTOS_SEM_MAX_WAIT, EVENT_B},
+    [WAITER_W2]    = {'2', WQ_PRIO(2U), RTOS_SEM_MAX_WAIT, EVENT_A},
+};
+
+static rtos_task_handle_t g_handle_waiter[WAITER_COUNT];
+
+static char              g_wake_order[WAITER_ORDER_LEN + 1U];
+static volatile uint32_t g_wake_count    = 0;
+static volatile uint32_t g_timed_timeout = 0;
+static volatile uint32_t g_timed_woken   = 0;
+
+static volatile bool     g_event_phase = false;
+static volatile uint32_t g_event_woken = 0; /* Bit i = g_waiter_cfg[i] woken */
+
+static rtos_task_handle_t g_handle_holder = NULL;
+static rtos_task_handle_t g_handle_early  = NULL;
+static rtos_task_handle_t g_handle_chain  = NULL;
+static rtos_task_handle_t g_handle_top    = NULL;
+
+static char              g_m1_order[3];
+static volatile uint32_t g_m1_count = 0;
+
+/* =================== Task Implementations =================== */
+
+static void waiter_task_func(void *param)
+{
+    const waiter_cfg_t *cfg = (const waiter_cfg_t *) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+
+    while (1)
+    {
+        /* The Controller resumes us when it is our turn to wait */
+        rtos_task_suspend(NULL);
+
+        if (g_event_phase)
+        {
+            if (cfg->event != 0U &&
+                rtos_event_group_wait_bits(&g_eg, cfg->event, false, true, NULL, RTOS_EG_MAX_WAIT) == RTOS_EG_OK)
+            {
+                g_event_woken |= 1U << (uint32_t) (cfg - g_waiter_cfg);
+            }
+            continue;
+        }
+
+        rtos_sem_status_t s = rtos_semaphore_wait(&g_sem, cfg->timeout);
+
+        if (cfg->timeout != RTOS_SEM_MAX_WAIT)
+        {
+            /* INV-W2: the timed waiter is never signalled */
+            if (s == RTOS_SEM_ERR_TIMEOUT)
+            {
+                g_timed_timeout++;
+            }
+            else
+            {
+                g_timed_woken++;
+            }
+        }
+        else if (s == RTOS_SEM_OK && g_wake_count < WAITER_ORDER_LEN)
+        {
+            g_wake_order[g_wake_count] = cfg->tag;
+            g_wake_count++;
+        }
+    }
+}
+
+static void m1_record(char tag)
+{
+    if (g_m1_count < sizeof(g_m1_order))
+    {
+        g_m1_order[g_m1_count] = tag;
+        g_m1_count++;
+    }
+}
+
+static void holder_task_func(void *param)
+{
+    (void) param;
+
+    rtos_task_suspend(NULL);
+
+    rtos_mutex_lock(&g_m1, RTOS_MAX_WAIT);
+    m1_record('H');
+    rtos_task_suspend(NULL);
+    rtos_mutex_unlock(&g_m1);
+
+    while (1)
+    {
+        rtos_delay_ms(1000);
+    }
+}
+
+static void early_task_func(void *param)
+{
+    (void) param;
+
+    rtos_task_suspend(NULL);
+
+    rtos_mutex_lock(&g_m1, RTOS_MAX_WAIT);
+    m1_record('E');
+    rtos_mutex_unlock(&g_m1);
+
+    while (1)
+    {
+        rtos_delay_ms(1000);
+    }
+}
+
+static void chain_task_func(void *param)
+{
+    (void) param;
+
+    rtos_task_suspend(NULL);
+
+    rtos_mutex_lock(&g_m2, RTOS_MAX_WAIT);
+    rtos_mutex_lock(&g_m1, RTOS_MAX_WAIT);
+    m1_record('C');
+    rtos_mutex_unlock(&g_m1);
+    rtos_mutex_unlock(&g_m2);
+
+    while (1)
+    {
+        rtos_delay_ms(1000);
+    }
+}
+
+static void top_task_func(void *param)
+{
+    (void) param;
+
+    rtos_task_suspend(NULL);
+
+    rtos_mutex_lock(&g_m2, RTOS_MAX_WAIT);
+    rtos_mutex_unlock(&g_m2);
+
+    while (1)
+    {
+        rtos_delay_ms(1000);
+    }
+}
+
+static void controller_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Controller");
+
+    /* Every waiter parks itself before the first cycle */
+    for (uint32_t i = 0; i < WAITER_COUNT; i++)
+    {
+        while (rtos_task_get_state(g_handle_waiter[i]) != RTOS_TASK_STATE_SUSPENDED)
+        {
+            rtos_delay_ms(POLL_MS);
+        }
+    }
+
+    /* ---- Phase 1: semaphore wake order ---- */
+    for (uint32_t c = 0; c < SIGNAL_CYCLES && !g_test_complete; c++)
+    {
+        uint32_t base = g_wake_count;
+        uint32_t last = (c == 0) ? WAITER_COUNT : WAITER_W2;
+
+        /* Each resumed waiter preempts us and blocks before the next resume */
+        for (uint32_t i = 0; i < last; i++)
+        {
+            rtos_task_resume(g_handle_waiter[i]);
+        }
+
+        /* Let the timed waiter expire out of the middle of band 3 */
+        rtos_delay_ms(SETTLE_MS);
+
+        /* Each waiter preempts us as soon as it is signalled */
+        for (uint32_t i = 0; i < CYCLE_WAKES; i++)
+        {
+            rtos_semaphore_signal(&g_sem);
+        }
+
+        TEST_ASSERT(g_wake_count - base == CYCLE_WAKES, "INV-W1:AllWoken");
+        TEST_ASSERT(g_wake_order[base] == '5' && g_wake_order[base + 1U] == '4', "INV-W1:PriorityOrder");
+        TEST_ASSERT(g_wake_order[base + 2U] == 'a' && g_wake_order[base + 3U] == 'b', "INV-W1:FifoInBand");
+        TEST_ASSERT(g_timed_timeout == c + 1U, "INV-W2:TimedOut");
+        TEST_ASSERT(rtos_semaphore_get_count(&g_sem) == 0, "INV-W2:NoSpareCount");
+    }
+
+    /* W2 is last; it wakes on one more signal */
+    rtos_semaphore_signal(&g_sem);
+    TEST_ASSERT(g_wake_order[g_wake_count - 1U] == '2', "INV-W1:LowestLast");
+    TEST_ASSERT(g_timed_woken == 0, "INV-W2:TimedNeverWoken");
+
+    g_wake_order[g_wake_count] = '\0';
+    log_info("Wake order: %s", g_wake_order);
+
+    /* ---- Phase 2: requeue on priority inheritance ---- */
+    while (rtos_task_get_state(g_handle_holder) != RTOS_TASK_STATE_SUSPENDED ||
+           rtos_task_get_state(g_handle_top) != RTOS_TASK_STATE_SUSPENDED)
+    {
+        rtos_delay_ms(POLL_MS);
+    }
+
+    rtos_task_resume(g_handle_holder); /* locks M1, suspends */
+    rtos_task_resume(g_handle_early);  /* blocks on M1 */
+    rtos_task_resume(g_handle_chain);  /* locks M2, blocks on M1 behind Early */
+    rtos_task_resume(g_handle_top);    /* blocks on M2 */
+
+    /* INV-W3 */
+    TEST_ASSERT(rtos_task_get_priority(g_handle_chain) == WQ_PRIO(5U), "INV-W3:ChainBoosted");
+    TEST_ASSERT(rtos_task_get_priority(g_handle_holder) == WQ_PRIO(5U), "INV-W3:HolderBoosted");
+
+    rtos_task_resume(g_handle_holder); /* unlocks M1 */
+    rtos_delay_ms(SETTLE_MS);
+
+    /* INV-W4 */
+    TEST_ASSERT(g_m1_count == 3U, "INV-W4:AllAcquired");
+    TEST_ASSERT(g_m1_order[0] == 'H', "INV-W4:HolderFirst");
+    TEST_ASSERT(g_m1_order[1] == 'C' && g_m1_order[2] == 'E', "INV-W4:BoostedFirst");
+
+    /* INV-W5 */
+    TEST_ASSERT(rtos_task_get_priority(g_handle_holder) == WQ_PRIO(2U), "INV-W5:HolderRestored");
+    TEST_ASSERT(rtos_task_get_priority(g_handle_chain) == WQ_PRIO(3U), "INV-W5:ChainRestored");
+
+    /* ---- Phase 3: event group walk across the priority bands ---- */
+    g_event_phase = true;
+    for (uint32_t i = 0; i < WAITER_COUNT; i++)
+    {
+        while (rtos_task_get_state(g_handle_waiter[i]) != RTOS_TASK_STATE_SUSPENDED)
+        {
+            rtos_delay_ms(POLL_MS);
+        }
+        if (g_waiter_cfg[i].event != 0U)
+        {
+            rtos_task_resume(g_handle_waiter[i]); /* blocks in wait_bits */
+        }
+    }
+
+    /* Each woken waiter preempts us before set_bits returns */
+    const uint32_t woken_a = (1U << WAITER_W5) | (1U << WAITER_W3A) | (1U << WAITER_W2);
+    const uint32_t woken_b = (1U << WAITER_W4) | (1U << WAITER_W3B);
+
+    rtos_event_group_set_bits(&g_eg, EVENT_A);
+    TEST_ASSERT(g_event_woken == woken_a, "INV-W6:EventAWaiters");
+    rtos_event_group_set_bits(&g_eg, EVENT_B);
+    TEST_ASSERT(g_event_woken == (woken_a | woken_b), "INV-W6:EventBWaiters");
+    TEST_ASSERT(rtos_event_group_get_bits(&g_eg) == 0U, "INV-W6:BitsCleared");
+
+    /* Final verdict */
+    TEST_EMIT_VERDICT();
+
+    test_log_task("END", "Controller");
+    while (1)
+    {
+        rtos_delay_ms(1000);
+    }
+}
+
+/* =================== Timer Callbacks =================== */
+
+static void startup_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    g_test_started = true;
+    test_log_framework("BEGIN", "WaitQueueState");
+    rtos_timer_handle_t *p = (rtos_timer_handle_t *) param;
+    rtos_timer_start(*p);
+}
+
+static void test_timeout_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_complete = true;
+    test_log_framework("TIMEOUT", "WaitQueueState");
+}
+
+/* =================== Main =================== */
+
+static void create_or_fail(rtos_task_function_t fn, const char *name, const void *param, rtos_priority_t priority,
+                           rtos_task_handle_t *handle)
+{
+    rtos_task_handle_t local;
+    rtos_status_t      status = rtos_task_create(fn, name, RTOS_DEFAULT_TASK_STACK_SIZE, (void *) (uintptr_t) param,
+                                                 priority, handle != NULL ? handle : &local);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Task %s create failed: %d", name, status);
+        indicate_system_failure();
+    }
+}
+
+__attribute__((__noreturn__)) int main(void)
+{
+    rtos_status_t       status;
+    rtos_timer_handle_t startup_timer;
+
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_ALL);
+
+    log_info("Priority Wait Queue - Wake Order & Requeue Test");
+    log_info("Cycles: %u  Waiters: %u  Settle: %ums  Levels: %u (step %u)", SIGNAL_CYCLES, WAITER_COUNT, SETTLE_MS,
+             (unsigned) RTOS_MAX_TASK_PRIORITIES, (unsigned) WQ_PRIO_STEP);
+    log_info("Invariants: W1(order) W2(timeout) W3(PIP) W4(requeue) W5(restore) W6(event walk)");
+
+    status = rtos_init();
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("RTOS init failed: %d", status);
+        indicate_system_failure();
+    }
+
+    if (rtos_semaphore_init(&g_sem, 0, 0) != RTOS_SEM_OK || rtos_mutex_init(&g_m1) != RTOS_MUTEX_OK ||
+        rtos_mutex_init(&g_m2) != RTOS_MUTEX_OK || rtos_event_group_init(&g_eg) != RTOS_EG_OK)
+    {
+        log_error("Sync object init failed");
+        indicate_system_failure();
+    }
+
+    status = test_create_startup_timer(startup_timer_callback, &g_test_timer, &startup_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Startup timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_timer_create("TestTimer", TEST_DURATION_MS, RTOS_TIMER_ONE_SHOT, test_timeout_callback, NULL,
+                               &g_test_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Test timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    static const char *const names[WAITER_COUNT] = {"W5", "W4", "W3a", "Timed", "W3b", "W2"};
+    for (uint32_t i = 0; i < WAITER_COUNT; i++)
+    {
+        create_or_fail(waiter_task_func, names[i], &g_waiter_cfg[i], g_waiter_cfg[i].priority, &g_handle_waiter[i]);
+    }
+
+    create_or_fail(holder_task_func, "Holder", NULL, WQ_PRIO(2U), &g_handle_holder);
+    create_or_fail(early_task_func, "Early", NULL, WQ_PRIO(3U), &g_handle_early);
+    create_or_fail(chain_task_func, "Chain", NULL, WQ_PRIO(3U), &g_handle_chain);
+    create_or_fail(top_task_func, "Top", NULL, WQ_PRIO(5U), &g_handle_top);
+
+    create_or_fail(controller_task_func, "Ctrl", NULL, TASK_CTRL_PRIORITY, NULL);
+
+    rtos_task_handle_t flush_handle;
+    test_create_log_flush_task(&flush_handle);
+
+    log_info("Starting scheduler...");
+    status = rtos_start_scheduler();
+
+    indicate_system_failure();
+}
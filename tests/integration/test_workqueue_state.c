@@ -0,0 +1,457 @@
+/*******************************************************************************
+ * File: tests/integration/test_workqueue_state.c
+ * Description: Work Queues - Worker Pool Dispatch Invariant Test
+ * Author: Student
+ * Date: 2025
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "config.h"
+#include "device.h" // IWYU pragma: keep
+#include "hardware_env.h"
+#include "rtos_port.h"
+#include "semaphore.h"
+#include "task.h"
+#include "test_common.h"
+#include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
+#include "timer.h"
+#include "uart_tx.h"
+#include "workqueue.h"
+
+/**
+ * @file test_workqueue_state.c
+ * @brief Work Queue Test
+ *
+ * SCENARIO
+ * --------
+ * A two-worker work queue plus three tasks and log flush; the spare
+ * interrupt submits a job as a driver's ISR would:
+ *
+ *   Workers    (priority 3) — the work queue's pool, static stacks
+ *   Controller (priority 2) — submits jobs, checks invariants
+ *   Monitor    (priority 1) — emits final verdict
+ *
+ * "Gate" jobs block their worker on a semaphore, so the controller can
+ * queue jobs behind busy workers and release one worker at a time.
+ *
+ * INVARIANTS
+ * ----------
+ * INV-WQ1  A submitted job runs in a worker task with its parameter and
+ *          leaves the item idle
+ * INV-WQ2  Jobs submitted while workers are idle go to different workers
+ * INV-WQ3  A freed worker runs queued high priority jobs before low ones,
+ *          whichever worker they were queued on
+ * INV-WQ4  A worker with nothing queued steals jobs queued on a blocked
+ *          worker; the steals are counted
+ * INV-WQ5  Delayed jobs run no earlier than their delay, in due order
+ * INV-WQ6  A cancelled job (queued or delayed) never runs, and cancelling
+ *          an idle job is rejected
+ * INV-WQ7  A job may resubmit itself; a job submitted from an ISR runs
+ * INV-WQ8  Double submit and bad parameters are rejected
+ */
+
+/* =================== Test Parameters =================== */
+
+#define TASK_WORKER_PRIORITY (3U)
+#define TASK_CTRL_PRIORITY   (2U)
+#define TASK_MON_PRIORITY    (1U)
+
+#define SETTLE_MS        (20U)
+#define MONITOR_POLL_MS  (20U)
+#define IDLE_SPIN_MS     (1000U)
+#define TEST_DURATION_MS (2000U)
+
+#define TEST_IRQn     TEST_SPARE_IRQn
+#define TEST_IRQ_PRIO (14U) /* Below the kernel BASEPRI threshold */
+
+#define WORKERS           (2U)
+#define WORKER_STACK_SIZE (1024U)
+#define DELAY_SHORT       (10U)
+#define DELAY_LONG        (25U)
+#define CHAIN_HOPS        (5U)
+#define MAX_TRACE         (16U)
+
+/* TEST_ASSERT, ASSERT_STATE, g_fail_count are in test_common.h */
+
+/* =================== Shared State =================== */
+
+static volatile bool g_test_started  = false;
+static volatile bool g_test_complete = false;
+
+static rtos_timer_handle_t g_test_timer;
+
+static rtos_workqueue_t g_wq;
+static uint32_t         g_stack0[WORKER_STACK_SIZE / sizeof(uint32_t)] __attribute__((aligned(8)));
+static uint32_t         g_stack1[WORKER_STACK_SIZE / sizeof(uint32_t)] __attribute__((aligned(8)));
+static uint32_t *const  g_stacks[WORKERS] = {g_stack0, g_stack1};
+
+static rtos_semaphore_t g_gate;
+
+static rtos_work_item_t g_job[6];
+static rtos_work_item_t g_gate_job[WORKERS];
+static rtos_work_item_t g_chain_job;
+static rtos_work_item_t g_isr_job;
+
+/* Job trace: parameter of each job as it starts, and its worker */
+static volatile uint32_t           g_trace[MAX_TRACE];
+static rtos_task_handle_t volatile g_trace_task[MAX_TRACE];
+static volatile rtos_tick_t        g_trace_tick[MAX_TRACE];
+static volatile uint32_t           g_trace_len    = 0;
+static volatile uint32_t           g_not_worker   = 0;
+static volatile uint32_t           g_still_queued = 0;
+static volatile uint32_t           g_chain_hops   = 0;
+static volatile rtos_status_t      g_chain_status = RTOS_SUCCESS;
+
+/* =================== Helpers =================== */
+
+static bool is_worker(rtos_task_handle_t task)
+{
+    for (uint32_t i = 0; i < WORKERS; i++)
+    {
+        if (g_wq.workers[i].task == task)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint32_t total_stolen(void)
+{
+    uint32_t            total = 0;
+    rtos_worker_stats_t stats;
+
+    for (uint8_t i = 0; i < WORKERS; i++)
+    {
+        (void) rtos_workqueue_get_stats(&g_wq, i, &stats);
+        total += stats.stolen;
+    }
+    return total;
+}
+
+static void trace_reset(void)
+{
+    g_trace_len = 0;
+}
+
+/* =================== Jobs =================== */
+
+static void trace_job(rtos_work_item_t *item)
+{
+    rtos_task_handle_t self = rtos_task_get_current();
+
+    if (!is_worker(self))
+    {
+        g_not_worker++;
+    }
+    if (rtos_work_is_pending(item))
+    {
+        g_still_queued++;
+    }
+    if (g_trace_len < MAX_TRACE)
+    {
+        g_trace[g_trace_len]      = (uint32_t) (uintptr_t) item->parameter;
+        g_trace_task[g_trace_len] = self;
+        g_trace_tick[g_trace_len] = rtos_get_tick_count();
+        g_trace_len++;
+    }
+}
+
+/* Holds its worker until the controller gives the gate */
+static void gate_job(rtos_work_item_t *item)
+{
+    trace_job(item);
+    (void) rtos_semaphore_wait(&g_gate, RTOS_SEM_MAX_WAIT);
+}
+
+static void chain_job(rtos_work_item_t *item)
+{
+    g_chain_hops++;
+    if (g_chain_hops < CHAIN_HOPS)
+    {
+        g_chain_status = rtos_work_submit(&g_wq, item, RTOS_WORK_PRIO_LOW);
+    }
+}
+
+/* =================== Interrupt Handler =================== */
+
+void TEST_SPARE_IRQHandler(void)
+{
+    bool woken = false;
+
+    (void) rtos_work_submit_from_isr(&g_wq, &g_isr_job, RTOS_WORK_PRIO_HIGH, &woken);
+    if (woken)
+    {
+        rtos_port_yield();
+    }
+}
+
+/* =================== Task Implementations =================== */
+
+static void check_dispatch(void)
+{
+    /* INV-WQ1 */
+    (void) rtos_work_init(&g_job[0], trace_job, (void *) 10U);
+    trace_reset();
+    TEST_ASSERT(rtos_work_submit(&g_wq, &g_job[0], RTOS_WORK_PRIO_LOW) == RTOS_SUCCESS, "INV-WQ1:Submitted");
+
+    /* Workers outrank the controller: the job ran before submit returned */
+    TEST_ASSERT(g_trace_len == 1U && g_trace[0] == 10U, "INV-WQ1:RanWithParameter");
+    TEST_ASSERT(g_not_worker == 0U && g_still_queued == 0U, "INV-WQ1:InWorkerAndIdle");
+    TEST_ASSERT(!rtos_work_is_pending(&g_job[0]), "INV-WQ1:NotPendingAfter");
+
+    /* INV-WQ2: two gate jobs occupy both workers */
+    trace_reset();
+    for (uint32_t i = 0; i < WORKERS; i++)
+    {
+        (void) rtos_work_init(&g_gate_job[i], gate_job, (void *) (uintptr_t) (20U + i));
+        TEST_ASSERT(rtos_work_submit(&g_wq, &g_gate_job[i], RTOS_WORK_PRIO_LOW) == RTOS_SUCCESS,
+                    "INV-WQ2:GateSubmitted");
+    }
+    TEST_ASSERT(g_trace_len == WORKERS && g_trace_task[0] != g_trace_task[1], "INV-WQ2:DifferentWorkers");
+}
+
+static void check_priority_and_stealing(void)
+{
+    /* Both workers are held by gate jobs: queue low, low, high */
+    uint32_t stolen_before = total_stolen();
+
+    (void) rtos_work_init(&g_job[1], trace_job, (void *) 1U);
+    (void) rtos_work_init(&g_job[2], trace_job, (void *) 2U);
+    (void) rtos_work_init(&g_job[3], trace_job, (void *) 3U);
+    (void) rtos_work_init(&g_job[4], trace_job, (void *) 4U);
+
+    trace_reset();
+    (void) rtos_work_submit(&g_wq, &g_job[1], RTOS_WORK_PRIO_LOW);
+    (void) rtos_work_submit(&g_wq, &g_job[2], RTOS_WORK_PRIO_LOW);
+    (void) rtos_work_submit(&g_wq, &g_job[3], RTOS_WORK_PRIO_HIGH);
+    TEST_ASSERT(g_trace_len == 0U, "INV-WQ3:QueuedBehindBusy");
+    TEST_ASSERT(g_job[1].worker != g_job[2].worker, "INV-WQ3:SpreadOverWorkers");
+
+    /* INV-WQ6: cancel a queued job */
+    (void) rtos_work_submit(&g_wq, &g_job[4], RTOS_WORK_PRIO_HIGH);
+    TEST_ASSERT(rtos_work_cancel(&g_job[4]) == RTOS_SUCCESS, "INV-WQ6:CancelQueued");
+    TEST_ASSERT(!rtos_work_is_pending(&g_job[4]), "INV-WQ6:CancelledIdle");
+    TEST_ASSERT(rtos_work_cancel(&g_job[4]) == RTOS_ERROR_INVALID_STATE, "INV-WQ6:CancelIdleRejected");
+
+    /* Free one worker: it runs every job while the other stays blocked */
+    (void) rtos_semaphore_signal(&g_gate);
+    rtos_delay_ms(2U);
+
+    TEST_ASSERT(g_trace_len == 3U && g_trace[0] == 3U, "INV-WQ3:HighBeforeLow");
+    TEST_ASSERT(g_trace_task[0] == g_trace_task[1] && g_trace_task[1] == g_trace_task[2], "INV-WQ4:OneWorkerRanAll");
+    TEST_ASSERT(total_stolen() > stolen_before, "INV-WQ4:StealCounted");
+
+    (void) rtos_semaphore_signal(&g_gate);
+    rtos_delay_ms(2U);
+    TEST_ASSERT(g_trace_len == 3U, "INV-WQ6:CancelledNeverRan");
+}
+
+static void check_delayed(void)
+{
+    /* INV-WQ5: submitted long first, short second */
+    (void) rtos_work_init(&g_job[4], trace_job, (void *) 4U);
+    (void) rtos_work_init(&g_job[5], trace_job, (void *) 5U);
+    (void) rtos_work_init(&g_job[2], trace_job, (void *) 2U);
+
+    trace_reset();
+    rtos_tick_t start = rtos_get_tick_count();
+    TEST_ASSERT(rtos_work_submit_delayed(&g_wq, &g_job[4], RTOS_WORK_PRIO_LOW, DELAY_LONG) == RTOS_SUCCESS,
+                "INV-WQ5:SubmitLong");
+    TEST_ASSERT(rtos_work_submit_delayed(&g_wq, &g_job[5], RTOS_WORK_PRIO_LOW, DELAY_SHORT) == RTOS_SUCCESS,
+                "INV-WQ5:SubmitShort");
+    TEST_ASSERT(rtos_work_submit_delayed(&g_wq, &g_job[2], RTOS_WORK_PRIO_LOW, DELAY_SHORT) == RTOS_SUCCESS,
+                "INV-WQ6:SubmitToCancel");
+    TEST_ASSERT(rtos_work_is_pending(&g_job[4]) && g_trace_len == 0U, "INV-WQ5:Pending");
+    TEST_ASSERT(rtos_work_cancel(&g_job[2]) == RTOS_SUCCESS, "INV-WQ6:CancelDelayed");
+
+    rtos_delay_ms(DELAY_LONG + 10U);
+
+    TEST_ASSERT(g_trace_len == 2U && g_trace[0] == 5U && g_trace[1] == 4U, "INV-WQ5:DueOrder");
+    TEST_ASSERT((rtos_tick_t) (g_trace_tick[0] - start) >= DELAY_SHORT, "INV-WQ5:ShortNotEarly");
+    TEST_ASSERT((rtos_tick_t) (g_trace_tick[1] - start) >= DELAY_LONG, "INV-WQ5:LongNotEarly");
+    TEST_ASSERT(!rtos_work_is_pending(&g_job[2]), "INV-WQ6:CancelledDelayedNeverRan");
+}
+
+static void check_chain_and_isr(void)
+{
+    /* INV-WQ7 */
+    (void) rtos_work_init(&g_chain_job, chain_job, NULL);
+    TEST_ASSERT(rtos_work_submit(&g_wq, &g_chain_job, RTOS_WORK_PRIO_LOW) == RTOS_SUCCESS, "INV-WQ7:ChainSubmit");
+    rtos_delay_ms(2U);
+    TEST_ASSERT(g_chain_hops == CHAIN_HOPS && g_chain_status == RTOS_SUCCESS, "INV-WQ7:Resubmitted");
+
+    (void) rtos_work_init(&g_isr_job, trace_job, (void *) 99U);
+    trace_reset();
+    NVIC_SetPendingIRQ(TEST_IRQn);
+    __DSB();
+    __ISB();
+    rtos_delay_ms(2U);
+    TEST_ASSERT(g_trace_len == 1U && g_trace[0] == 99U, "INV-WQ7:IsrSubmitRan");
+    TEST_ASSERT(g_not_worker == 0U, "INV-WQ7:AllInWorkers");
+}
+
+static void check_params(void)
+{
+    /* INV-WQ8: a gate job holds a worker so a second submit finds it queued */
+    (void) rtos_work_init(&g_gate_job[0], gate_job, (void *) 20U);
+    (void) rtos_work_init(&g_gate_job[1], gate_job, (void *) 21U);
+    (void) rtos_work_submit(&g_wq, &g_gate_job[0], RTOS_WORK_PRIO_LOW);
+    (void) rtos_work_submit(&g_wq, &g_gate_job[1], RTOS_WORK_PRIO_LOW);
+
+    (void) rtos_work_init(&g_job[0], trace_job, (void *) 10U);
+    TEST_ASSERT(rtos_work_submit(&g_wq, &g_job[0], RTOS_WORK_PRIO_LOW) == RTOS_SUCCESS, "INV-WQ8:Submit");
+    TEST_ASSERT(rtos_work_submit(&g_wq, &g_job[0], RTOS_WORK_PRIO_HIGH) == RTOS_ERROR_INVALID_STATE,
+                "INV-WQ8:DoubleSubmit");
+    TEST_ASSERT(rtos_work_submit_delayed(&g_wq, &g_job[0], RTOS_WORK_PRIO_LOW, 5U) == RTOS_ERROR_INVALID_STATE,
+                "INV-WQ8:DelayQueued");
+    TEST_ASSERT(rtos_work_init(&g_job[0], trace_job, NULL) == RTOS_ERROR_INVALID_STATE, "INV-WQ8:InitQueued");
+    TEST_ASSERT(rtos_work_cancel(&g_job[0]) == RTOS_SUCCESS, "INV-WQ8:Cancel");
+
+    TEST_ASSERT(rtos_work_submit(NULL, &g_job[0], RTOS_WORK_PRIO_LOW) == RTOS_ERROR_INVALID_PARAM,
+                "INV-WQ8:NullQueue");
+    TEST_ASSERT(rtos_work_init(&g_job[0], NULL, NULL) == RTOS_ERROR_INVALID_PARAM, "INV-WQ8:NullFunction");
+    TEST_ASSERT(rtos_workqueue_create(&g_wq, 0U, g_stacks, WORKER_STACK_SIZE, TASK_WORKER_PRIORITY) ==
+                    RTOS_ERROR_INVALID_PARAM,
+                "INV-WQ8:ZeroWorkers");
+    TEST_ASSERT(rtos_workqueue_get_stats(&g_wq, WORKERS, &(rtos_worker_stats_t) {0}) == RTOS_ERROR_INVALID_PARAM,
+                "INV-WQ8:StatsRange");
+
+    (void) rtos_semaphore_signal(&g_gate);
+    (void) rtos_semaphore_signal(&g_gate);
+}
+
+/*
+ * Controller (priority 2).
+ */
+static void ctrl_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Controller");
+
+    rtos_delay_ms(SETTLE_MS);
+
+    check_dispatch();
+    check_priority_and_stealing();
+    check_delayed();
+    check_chain_and_isr();
+    check_params();
+
+    test_log_task("END", "Controller");
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+/*
+ * Monitor task (priority 1).
+ * Emits the final PASS/FAIL verdict.
+ */
+static void monitor_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Monitor");
+
+    while (!g_test_complete)
+    {
+        rtos_delay_ms(MONITOR_POLL_MS);
+    }
+
+    /* Final verdict */
+    TEST_EMIT_VERDICT();
+
+    test_log_task("END", "Monitor");
+    while (1)
+    {
+        rtos_delay_ms(IDLE_SPIN_MS);
+    }
+}
+
+/* =================== Timer Callbacks =================== */
+
+static void startup_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    g_test_started = true;
+    test_log_framework("BEGIN", "WorkqueueState");
+    rtos_timer_handle_t *p = (rtos_timer_handle_t *) param;
+    rtos_timer_start(*p);
+}
+
+static void test_timeout_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_complete = true;
+    test_log_framework("TIMEOUT", "WorkqueueState");
+}
+
+/* =================== Main =================== */
+
+__attribute__((__noreturn__)) int main(void)
+{
+    rtos_status_t       status;
+    rtos_timer_handle_t startup_timer;
+
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_ALL);
+
+    log_info("Work Queue Test");
+    log_info("Priorities: Workers=%u Ctrl=%u Mon=%u", TASK_WORKER_PRIORITY, TASK_CTRL_PRIORITY, TASK_MON_PRIORITY);
+    log_info("Invariants: WQ1(dispatch) WQ2(spread) WQ3(priority) WQ4(steal) WQ5(delayed) WQ6(cancel)");
+    log_info("            WQ7(resubmit_isr) WQ8(params)");
+
+    status = rtos_init();
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("RTOS init failed: %d", status);
+        indicate_system_failure();
+    }
+
+    NVIC_SetPriority(TEST_IRQn, TEST_IRQ_PRIO);
+    NVIC_EnableIRQ(TEST_IRQn);
+
+    if (rtos_semaphore_init(&g_gate, 0U, 0U) != RTOS_SEM_OK ||
+        rtos_workqueue_create(&g_wq, WORKERS, g_stacks, WORKER_STACK_SIZE, TASK_WORKER_PRIORITY) != RTOS_SUCCESS)
+    {
+        log_error("Work queue setup failed");
+        indicate_system_failure();
+    }
+
+    status = test_create_startup_timer(startup_timer_callback, &g_test_timer, &startup_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Startup timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_timer_create("TestTimer", TEST_DURATION_MS, RTOS_TIMER_ONE_SHOT, test_timeout_callback, NULL,
+                               &g_test_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Test timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t handle;
+    if (rtos_task_create(ctrl_task_func, "Controller", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_CTRL_PRIORITY,
+                         &handle) != RTOS_SUCCESS ||
+        rtos_task_create(monitor_task_func, "Monitor", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_MON_PRIORITY,
+                         &handle) != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t flush_handle;
+    test_create_log_flush_task(&flush_handle);
+
+    log_info("Starting scheduler...");
+    status = rtos_start_scheduler();
+
+    indicate_system_failure();
+}
@@ -0,0 +1,312 @@
+/*******************************************************************************
+ * File: tests/scheduler/edf/test_scheduler_edf_state.c
+ * Description: EDF Scheduler - Deadline Ordering & Miss Accounting Test
+ * Author: Student
+ * Date: 2025
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "config.h"
+#include "device.h" // IWYU pragma: keep
+#include "edf.h"
+#include "hardware_env.h"
+#include "scheduler.h"
+#include "task.h"
+#include "test_common.h"
+#include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
+#include "timer.h"
+#include "uart_tx.h"
+
+/**
+ * @file test_scheduler_edf_state.c
+ * @brief EDF Scheduler Deadline Ordering & Miss Accounting Test
+ *
+ * Three periodic tasks with implicit deadlines and a total utilisation of
+ * 0.85 (above the 0.78 rate-monotonic bound for three tasks, below EDF's 1.0):
+ *
+ *   Task   Period  Work   U
+ *   TaskA  40      16     0.40
+ *   TaskB  60      18     0.30
+ *   TaskC  120     18     0.15
+ *
+ * Work is counted in ticks the task itself observed running, so preemption
+ * does not shorten a job.  The periodic tasks are created at runtime by the
+ * Setup task once the startup hold ends, so their first release is "now".
+ *
+ * INV-EDF1 (Deadline order)
+ *   At the start of every job no READY task has an earlier deadline than the
+ *   running one.  Checked inside a critical section; violations are counted
+ *   and asserted once at the end to keep per-job logging out of the budget.
+ *
+ * INV-EDF2 (No misses)
+ *   Every rtos_task_wait_for_next_period() returns RTOS_SUCCESS and every
+ *   task's rtos_task_get_deadline_misses() is 0.
+ *
+ * INV-EDF3 (Statistics)
+ *   rtos_scheduler_get_statistics() succeeds and reports zero deadline
+ *   misses.
+ *
+ * INV-EDF4 (Periodic release)
+ *   Each task completes at least (elapsed / period) - 1 jobs.
+ */
+
+/* =================== Task Configuration =================== */
+
+#define PERIODIC_TASKS   (3U)
+#define SETUP_PRIORITY   (3U) /* Aperiodic: only runs in slack under EDF */
+#define MONITOR_PRIORITY (2U)
+#define FLUSH_PRIORITY   (1U)
+
+#define TEST_DURATION_MS (3000U)
+
+typedef struct
+{
+    const char        *name;
+    rtos_period_t      period;     /**< Ticks */
+    uint32_t           work_ticks; /**< CPU ticks consumed per job */
+    rtos_task_handle_t handle;
+    volatile uint32_t  jobs; /**< Completed jobs */
+    volatile uint32_t  late; /**< wait_for_next_period() returned TIMEOUT */
+} edf_task_cfg_t;
+
+/* =================== Shared State =================== */
+
+static volatile bool g_test_started  = false;
+static volatile bool g_test_complete = false;
+
+static rtos_timer_handle_t g_test_timer;
+
+static edf_task_cfg_t g_tasks[PERIODIC_TASKS] = {
+    {.name = "TaskA", .period = 40, .work_ticks = 16},
+    {.name = "TaskB", .period = 60, .work_ticks = 18},
+    {.name = "TaskC", .period = 120, .work_ticks = 18},
+};
+
+static volatile uint32_t    g_order_violations = 0;
+static volatile rtos_tick_t g_release_tick     = 0;
+static volatile rtos_tick_t g_complete_tick    = 0;
+
+/* =================== Helpers =================== */
+
+/*
+ * Spin until this task has seen `ticks` consecutive tick increments.  A jump
+ * of more than one tick means we were preempted, and that interval is not
+ * counted, so the job's CPU demand stays fixed regardless of interference.
+ */
+static void consume_ticks(uint32_t ticks)
+{
+    uint32_t    consumed = 0;
+    rtos_tick_t last     = rtos_get_tick_count();
+
+    while (consumed < ticks)
+    {
+        rtos_tick_t now = rtos_get_tick_count();
+        if (now != last)
+        {
+            if (now - last == 1U)
+            {
+                consumed++;
+            }
+            last = now;
+        }
+    }
+}
+
+/* INV-EDF1: the running job must hold the earliest deadline among ready tasks */
+static void check_deadline_order(void)
+{
+    rtos_port_enter_critical();
+
+    rtos_task_handle_t self = rtos_task_get_current();
+    rtos_tick_t        mine = rtos_task_get_deadline(self);
+
+    for (uint32_t i = 0; i < PERIODIC_TASKS; i++)
+    {
+        rtos_task_handle_t other = g_tasks[i].handle;
+
+        if (other == NULL || other == self || rtos_task_get_state(other) != RTOS_TASK_STATE_READY)
+        {
+            continue;
+        }
+
+        if ((int32_t) (rtos_task_get_deadline(other) - mine) < 0)
+        {
+            g_order_violations++;
+        }
+    }
+
+    rtos_port_exit_critical();
+}
+
+/* =================== Task Implementations =================== */
+
+static void periodic_task_func(void *param)
+{
+    edf_task_cfg_t *cfg = (edf_task_cfg_t *) param;
+
+    test_log_task("START", cfg->name);
+
+    while (!g_test_complete)
+    {
+        check_deadline_order();
+        consume_ticks(cfg->work_ticks);
+        cfg->jobs++;
+
+        if (rtos_task_wait_for_next_period() == RTOS_ERROR_TIMEOUT)
+        {
+            cfg->late++;
+        }
+    }
+
+    test_log_task("END", cfg->name);
+    while (1)
+    {
+        rtos_delay_ms(1000);
+    }
+}
+
+/*
+ * Setup task — creates the periodic tasks once the startup hold ends, so
+ * the first release of each lines up with the start of the measurement.
+ */
+static void setup_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+
+    g_release_tick = rtos_get_tick_count();
+
+    for (uint32_t i = 0; i < PERIODIC_TASKS; i++)
+    {
+        rtos_status_t status = rtos_task_create_periodic(periodic_task_func, g_tasks[i].name,
+                                                         RTOS_DEFAULT_TASK_STACK_SIZE, &g_tasks[i], 2U,
+                                                         g_tasks[i].period, 0, 0, &g_tasks[i].handle);
+        TEST_ASSERT(status == RTOS_SUCCESS, "Setup:CreatePeriodic");
+    }
+
+    rtos_task_suspend(NULL);
+}
+
+/*
+ * Monitor task — aperiodic, so it only runs in slack.  Waits for the test
+ * timeout, then checks every invariant and emits the verdict.
+ */
+static void monitor_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Monitor");
+
+    while (!g_test_complete)
+    {
+        rtos_delay_ms(50);
+    }
+
+    /* Let every task finish its last job and leave its loop */
+    rtos_delay_ms(200);
+
+    TEST_ASSERT(g_order_violations == 0, "INV-EDF1:DeadlineOrder");
+
+    rtos_tick_t elapsed = g_complete_tick - g_release_tick;
+
+    for (uint32_t i = 0; i < PERIODIC_TASKS; i++)
+    {
+        TEST_ASSERT(g_tasks[i].late == 0, "INV-EDF2:NoLateJobs");
+        TEST_ASSERT(rtos_task_get_deadline_misses(g_tasks[i].handle) == 0, "INV-EDF2:MissCounterZero");
+        TEST_ASSERT(g_tasks[i].jobs + 1U >= elapsed / g_tasks[i].period, "INV-EDF4:PeriodicRelease");
+    }
+
+    rtos_scheduler_stats_t stats;
+
+    TEST_ASSERT(rtos_scheduler_get_statistics(&stats) == RTOS_SUCCESS, "INV-EDF3:Stats");
+    TEST_ASSERT(stats.deadline_misses == 0, "INV-EDF3:StatsNoMisses");
+
+    /* Final verdict */
+    TEST_EMIT_VERDICT();
+
+    test_log_task("END", "Monitor");
+    while (1)
+    {
+        rtos_delay_ms(1000);
+    }
+}
+
+/* =================== Timer Callbacks =================== */
+
+static void startup_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    g_test_started = true;
+    test_log_framework("BEGIN", "EdfState");
+    rtos_timer_handle_t *p_test_timer = (rtos_timer_handle_t *) param;
+    rtos_timer_start(*p_test_timer);
+}
+
+static void test_timeout_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_complete_tick = rtos_get_tick_count();
+    g_test_complete = true;
+    test_log_framework("TIMEOUT", "EdfState");
+}
+
+/* =================== Main =================== */
+
+__attribute__((__noreturn__)) int main(void)
+{
+    rtos_status_t       status;
+    rtos_timer_handle_t startup_timer;
+
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_ALL);
+
+    log_info("EDF Scheduler - Deadline Ordering Test");
+    log_info("Periods: A=%u B=%u C=%u  Work: A=%u B=%u C=%u", (unsigned) g_tasks[0].period,
+             (unsigned) g_tasks[1].period, (unsigned) g_tasks[2].period, (unsigned) g_tasks[0].work_ticks,
+             (unsigned) g_tasks[1].work_ticks, (unsigned) g_tasks[2].work_ticks);
+    log_info("Invariants: EDF1(order) EDF2(no misses) EDF3(stats) EDF4(release)");
+
+    status = rtos_init();
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("RTOS init failed: %d", status);
+        indicate_system_failure();
+    }
+
+    /* Startup hold timer */
+    status = test_create_startup_timer(startup_timer_callback, &g_test_timer, &startup_timer);
+    if (status != RTOS_SUCCESS)
+        indicate_system_failure();
+
+    /* Test duration timer */
+    status = rtos_timer_create("TestTimer", TEST_DURATION_MS, RTOS_TIMER_ONE_SHOT, test_timeout_callback, NULL,
+                               &g_test_timer);
+    if (status != RTOS_SUCCESS)
+        indicate_system_failure();
+
+    rtos_task_handle_t setup_handle;
+    status = rtos_task_create(setup_task_func, "Setup", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, SETUP_PRIORITY,
+                              &setup_handle);
+    if (status != RTOS_SUCCESS)
+        indicate_system_failure();
+
+    rtos_task_handle_t monitor_handle;
+    status = rtos_task_create(monitor_task_func, "Mon", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, MONITOR_PRIORITY,
+                              &monitor_handle);
+    if (status != RTOS_SUCCESS)
+        indicate_system_failure();
+
+    /* Flush task is aperiodic too: it drains the log in the 15 % slack */
+    rtos_task_handle_t flush_handle;
+    ulog_init(ULOG_LEVEL_INFO);
+    rtos_task_create(log_flush_task, "LogFlush", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, FLUSH_PRIORITY, &flush_handle);
+
+    log_info("Starting scheduler...");
+    status = rtos_start_scheduler();
+
+    /* Should never reach here */
+    indicate_system_failure();
+}
@@ -0,0 +1,295 @@
+/*******************************************************************************
+ * File: tests/scheduler/preemptive/test_scheduler_threshold_state.c
+ * Description: Preemption Threshold Test
+ * Author: Student
+ * Date: 2025
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "config.h"
+#include "device.h" // IWYU pragma: keep
+#include "hardware_env.h"
+#include "rtos_port.h"
+#include "semaphore.h"
+#include "task.h"
+#include "test_common.h"
+#include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
+#include "timer.h"
+#include "uart_tx.h"
+
+/**
+ * @file test_scheduler_threshold_state.c
+ * @brief Preemption Threshold Invariant Test (RTOS_USE_PREEMPTION_THRESHOLD)
+ *
+ * SCENARIO
+ * --------
+ * Control runs with a threshold between Mid's and High's priority and pends
+ * a spare peripheral interrupt (TEST_IRQn) whose handler gives the
+ * semaphores Mid and High block on.
+ *
+ *   High    (priority 5) — above the threshold, logs 'H' per wake
+ *   Mid     (priority 3) — within the threshold, logs 'M' per wake
+ *   Control (priority 2, threshold 4) — triggers, spins, checks
+ *
+ * INVARIANTS
+ * ----------
+ * INV-PT1  A task at or below the running task's threshold does not preempt
+ *          it, across ticks.
+ * INV-PT2  A task above the threshold preempts at once.
+ * INV-PT3  A task preempted inside its threshold resumes before the held
+ *          task once the preemptor blocks.
+ * INV-PT4  The held task runs as soon as the threshold task blocks.
+ * INV-PT5  Lowering the threshold releases the held task before the call
+ *          returns.
+ * INV-PT6  Invalid thresholds (NULL task, below base priority, out of range)
+ *          are RTOS_ERROR_INVALID_PARAM; the getter reads back the value.
+ */
+
+/* =================== Test Parameters =================== */
+
+#define TASK_HIGH_PRIORITY    (5U)
+#define TASK_MID_PRIORITY     (3U)
+#define TASK_CONTROL_PRIORITY (2U)
+#define CONTROL_THRESHOLD     (4U)
+
+#define TEST_IRQn        TEST_SPARE_IRQn
+#define TEST_IRQ_PRIO    (14U) /* Below the kernel BASEPRI threshold */
+#define GIVE_MID         (1U << 0)
+#define GIVE_HIGH        (1U << 1)
+#define SPIN_TICKS       (3U)
+#define SCENARIO_CYCLES  (20U)
+#define SETTLE_MS        (5U)
+#define TEST_DURATION_MS (6000U)
+
+/* =================== Shared State =================== */
+
+static volatile bool g_test_started  = false;
+static volatile bool g_test_complete = false;
+
+static rtos_timer_handle_t g_test_timer;
+
+static rtos_semaphore_t g_sem_mid;
+static rtos_semaphore_t g_sem_high;
+
+static volatile uint32_t g_isr_give;
+
+/* Run log: 'H' / 'M' per wake, in run order */
+static volatile char     g_order[2];
+static volatile uint32_t g_order_len = 0;
+
+/* =================== Helpers =================== */
+
+static void spin_ticks(rtos_tick_t ticks)
+{
+    rtos_tick_t start = rtos_get_tick_count();
+    while ((rtos_tick_t) (rtos_get_tick_count() - start) < ticks)
+    {
+    }
+}
+
+static void log_run(char id)
+{
+    if (g_order_len < sizeof(g_order))
+    {
+        g_order[g_order_len] = id;
+    }
+    g_order_len++;
+}
+
+/* =================== Interrupt Handler =================== */
+
+void TEST_SPARE_IRQHandler(void)
+{
+    bool woken = false;
+
+    if (g_isr_give & GIVE_MID)
+    {
+        rtos_semaphore_signal_from_isr(&g_sem_mid, &woken);
+    }
+    if (g_isr_give & GIVE_HIGH)
+    {
+        rtos_semaphore_signal_from_isr(&g_sem_high, &woken);
+    }
+
+    if (woken)
+    {
+        rtos_port_yield();
+    }
+}
+
+static void trigger_irq(uint32_t give)
+{
+    g_isr_give = give;
+    NVIC_SetPendingIRQ(TEST_IRQn);
+    __DSB();
+    __ISB();
+}
+
+/* =================== Task Implementations =================== */
+
+static void high_task_func(void *param)
+{
+    (void) param;
+
+    while (1)
+    {
+        if (rtos_semaphore_wait(&g_sem_high, RTOS_SEM_MAX_WAIT) == RTOS_SEM_OK)
+        {
+            log_run('H');
+        }
+    }
+}
+
+static void mid_task_func(void *param)
+{
+    (void) param;
+
+    while (1)
+    {
+        if (rtos_semaphore_wait(&g_sem_mid, RTOS_SEM_MAX_WAIT) == RTOS_SEM_OK)
+        {
+            log_run('M');
+        }
+    }
+}
+
+static void control_task_func(void *param)
+{
+    (void) param;
+    rtos_task_handle_t self = rtos_task_get_current();
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Control");
+
+    TEST_ASSERT(rtos_task_set_preemption_threshold(NULL, CONTROL_THRESHOLD) == RTOS_ERROR_INVALID_PARAM,
+                "INV-PT6:NullTask");
+    TEST_ASSERT(rtos_task_set_preemption_threshold(self, TASK_CONTROL_PRIORITY - 1U) == RTOS_ERROR_INVALID_PARAM,
+                "INV-PT6:BelowBase");
+    TEST_ASSERT(rtos_task_set_preemption_threshold(self, RTOS_MAX_TASK_PRIORITIES) == RTOS_ERROR_INVALID_PARAM,
+                "INV-PT6:OutOfRange");
+    TEST_ASSERT(rtos_task_get_preemption_threshold(self) == TASK_CONTROL_PRIORITY, "INV-PT6:DefaultIsBase");
+    TEST_ASSERT(rtos_task_set_preemption_threshold(self, CONTROL_THRESHOLD) == RTOS_SUCCESS, "INV-PT6:Set");
+    TEST_ASSERT(rtos_task_get_preemption_threshold(self) == CONTROL_THRESHOLD, "INV-PT6:ReadBack");
+
+    for (uint32_t cycle = 0; cycle < SCENARIO_CYCLES && !g_test_complete; cycle++)
+    {
+        rtos_delay_ms(SETTLE_MS);
+
+        /* --- Held, then preempted from above, then released by blocking --- */
+        g_order_len = 0;
+
+        trigger_irq(GIVE_MID);
+        spin_ticks(SPIN_TICKS);
+        TEST_ASSERT(g_order_len == 0, "INV-PT1:MidHeld");
+
+        trigger_irq(GIVE_HIGH);
+        TEST_ASSERT(g_order_len >= 1U && g_order[0] == 'H', "INV-PT2:HighPreempted");
+        TEST_ASSERT(g_order_len == 1U, "INV-PT3:ResumedBeforeMid");
+
+        rtos_delay_ms(SETTLE_MS);
+        TEST_ASSERT(g_order_len == 2U && g_order[1] == 'M', "INV-PT4:MidRanOnBlock");
+
+        /* --- Lowering the threshold --- */
+        g_order_len = 0;
+
+        trigger_irq(GIVE_MID);
+        TEST_ASSERT(g_order_len == 0, "INV-PT1:MidHeldAgain");
+
+        rtos_task_set_preemption_threshold(self, TASK_CONTROL_PRIORITY);
+        TEST_ASSERT(g_order_len == 1U && g_order[0] == 'M', "INV-PT5:LoweredReleases");
+
+        rtos_task_set_preemption_threshold(self, CONTROL_THRESHOLD);
+    }
+
+    TEST_EMIT_VERDICT();
+
+    test_log_task("END", "Control");
+    while (1)
+    {
+        rtos_delay_ms(1000);
+    }
+}
+
+/* =================== Timer Callbacks =================== */
+
+static void startup_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    g_test_started = true;
+    test_log_framework("BEGIN", "Threshold");
+    rtos_timer_handle_t *p = (rtos_timer_handle_t *) param;
+    rtos_timer_start(*p);
+}
+
+static void test_timeout_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_complete = true;
+    test_log_framework("TIMEOUT", "Threshold");
+}
+
+/* =================== Main =================== */
+
+__attribute__((__noreturn__)) int main(void)
+{
+    rtos_status_t       status;
+    rtos_timer_handle_t startup_timer;
+
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_ALL);
+
+    log_info("Preemption Threshold Test");
+    log_info("High prio=%u  Mid prio=%u  Control prio=%u threshold=%u", TASK_HIGH_PRIORITY, TASK_MID_PRIORITY,
+             TASK_CONTROL_PRIORITY, CONTROL_THRESHOLD);
+    log_info("Invariants: PT1(held) PT2(above) PT3(resume) PT4(block) PT5(lower) PT6(params)");
+
+    status = rtos_init();
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("RTOS init failed: %d", status);
+        indicate_system_failure();
+    }
+
+    if (rtos_semaphore_init(&g_sem_mid, 0, 1) != RTOS_SEM_OK || rtos_semaphore_init(&g_sem_high, 0, 1) != RTOS_SEM_OK)
+    {
+        indicate_system_failure();
+    }
+
+    NVIC_SetPriority(TEST_IRQn, TEST_IRQ_PRIO);
+    NVIC_EnableIRQ(TEST_IRQn);
+
+    status = test_create_startup_timer(startup_timer_callback, &g_test_timer, &startup_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Startup timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_timer_create("TestTimer", TEST_DURATION_MS, RTOS_TIMER_ONE_SHOT, test_timeout_callback, NULL,
+                               &g_test_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Test timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t handle;
+    if (rtos_task_create(high_task_func, "High", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_HIGH_PRIORITY, &handle) !=
+            RTOS_SUCCESS ||
+        rtos_task_create(mid_task_func, "Mid", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_MID_PRIORITY, &handle) !=
+            RTOS_SUCCESS ||
+        rtos_task_create(control_task_func, "Control", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_CONTROL_PRIORITY,
+                         &handle) != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t flush_handle;
+    test_create_log_flush_task(&flush_handle);
+
+    log_info("Starting scheduler...");
+    status = rtos_start_scheduler();
+
+    indicate_system_failure();
+}
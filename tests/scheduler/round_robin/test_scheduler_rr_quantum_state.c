@@ -0,0 +1,328 @@
+/*******************************************************************************
+ * File: tests/scheduler/round_robin/test_scheduler_rr_quantum_state.c
+ * Description: Round-Robin Scheduler - Per-Task Quantum & Priority Band Test
+ ******************************************************************************/
+
+#include "VRTOS.h"
+#include "config.h"
+#include "device.h" // IWYU pragma: keep
+#include "hardware_env.h"
+#include "task.h"
+#include "test_common.h"
+#include "test_log.h" /* thread-safe ulog overrides for test_log_task/framework */
+#include "timer.h"
+#include "uart_tx.h"
+
+/**
+ * @file test_scheduler_rr_quantum_state.c
+ * @brief Round-Robin Per-Task Quantum & Priority Band Invariant Test
+ *
+ * SCENARIO
+ * --------
+ *   Monitor    (priority 5) — samples every 100 ms, emits the verdict
+ *   Sensor     (priority 4) — 10 ms periodic, records release latency
+ *   LogFlush   (priority 3)
+ *   Batch      (priority 2) — spins forever, quantum 20 ticks
+ *   Interactive(priority 2) — spins forever, quantum 2 ticks
+ *   Background (priority 1) — spins forever, counts iterations
+ *
+ * Batch and Interactive each count the ticks they see one at a time; a
+ * jump of more than one tick means they were switched out, which ends a
+ * run.  Preemption from above only shortens runs, so the upper bounds hold.
+ *
+ * INVARIANTS
+ * ----------
+ * INV-Q1  Batch never runs longer than its quantum (+1 tick of phase).
+ * INV-Q2  Interactive never runs longer than its quantum (+1 tick).
+ * INV-Q3  Batch gets longer runs and a larger CPU share than Interactive.
+ * INV-Q4  Sensor is released within one tick of every period, whatever the
+ *         quanta in the band below it.
+ * INV-Q5  Background gets no CPU while band 2 is busy, and runs once the
+ *         band is suspended.
+ */
+
+/* =================== Test Parameters =================== */
+
+#define TASK_MON_PRIORITY        (5U)
+#define TASK_SENSOR_PRIORITY     (4U)
+#define TASK_FLUSH_PRIORITY      (3U)
+#define TASK_BAND_PRIORITY       (2U)
+#define TASK_BACKGROUND_PRIORITY (1U)
+
+#define BATCH_QUANTUM       (20U)
+#define INTERACTIVE_QUANTUM (2U)
+
+#define SENSOR_PERIOD_MS   (10U)
+#define SAMPLE_MS          (100U)
+#define TEST_SAMPLES       (30U)
+#define BACKGROUND_WAIT_MS (50U)
+#define TEST_DURATION_MS   (5000U)
+
+/* =================== Shared State =================== */
+
+static volatile bool g_test_started  = false;
+static volatile bool g_test_complete = false;
+
+static rtos_timer_handle_t g_test_timer;
+
+static rtos_task_handle_t g_handle_batch       = NULL;
+static rtos_task_handle_t g_handle_interactive = NULL;
+
+typedef struct
+{
+    volatile uint32_t max_run;   /* Longest uninterrupted run, ticks */
+    volatile uint32_t cpu_ticks; /* Ticks observed while running */
+} run_stats_t;
+
+static run_stats_t g_batch_stats;
+static run_stats_t g_interactive_stats;
+
+static volatile uint32_t g_sensor_max_latency = 0;
+static volatile uint32_t g_background_spins   = 0;
+
+/* =================== Task Implementations =================== */
+
+/*
+ * Spin forever, splitting time into runs. A run is a stretch of single-tick
+ * increments; its length counts the ticks that started and ended inside it
+ * plus the partial tick at each end, hence the +1 in the bounds.
+ */
+static void spin_and_measure(run_stats_t *stats)
+{
+    rtos_tick_t last = rtos_get_tick_count();
+    uint32_t    run  = 0;
+
+    while (1)
+    {
+        rtos_tick_t now = rtos_get_tick_count();
+
+        if (now == last)
+        {
+            continue;
+        }
+
+        if (now - last == 1U)
+        {
+            run++;
+            stats->cpu_ticks++;
+            if (run > stats->max_run)
+            {
+                stats->max_run = run;
+            }
+        }
+        else
+        {
+            run = 0;
+        }
+        last = now;
+    }
+}
+
+static void batch_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    spin_and_measure(&g_batch_stats);
+}
+
+static void interactive_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    spin_and_measure(&g_interactive_stats);
+}
+
+static void sensor_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+
+    rtos_tick_t last_wake = rtos_get_tick_count();
+
+    while (!g_test_complete)
+    {
+        rtos_delay_until(&last_wake, SENSOR_PERIOD_MS / RTOS_TICK_PERIOD_MS);
+
+        uint32_t latency = rtos_get_tick_count() - last_wake;
+        if (latency > g_sensor_max_latency)
+        {
+            g_sensor_max_latency = latency;
+        }
+    }
+
+    while (1)
+    {
+        rtos_delay_ms(1000);
+    }
+}
+
+static void background_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+
+    while (1)
+    {
+        g_background_spins++;
+    }
+}
+
+static void monitor_task_func(void *param)
+{
+    (void) param;
+
+    TEST_WAIT_FOR_START(g_test_started);
+    test_log_task("START", "Monitor");
+
+    for (uint32_t s = 0; s < TEST_SAMPLES && !g_test_complete; s++)
+    {
+        rtos_delay_ms(SAMPLE_MS);
+    }
+
+    /* Freeze the band before reading its counters */
+    uint32_t background_before = g_background_spins;
+    rtos_task_suspend(g_handle_batch);
+    rtos_task_suspend(g_handle_interactive);
+
+    /* INV-Q1, INV-Q2 */
+    TEST_ASSERT(g_batch_stats.max_run <= BATCH_QUANTUM + 1U, "INV-Q1:BatchQuantum");
+    TEST_ASSERT(g_interactive_stats.max_run <= INTERACTIVE_QUANTUM + 1U, "INV-Q2:InteractiveQuantum");
+
+    /* INV-Q3: 20:2 quanta give Batch about 90 % of the band */
+    TEST_ASSERT(g_batch_stats.max_run > INTERACTIVE_QUANTUM + 1U, "INV-Q3:BatchLongerRuns");
+    TEST_ASSERT(g_batch_stats.cpu_ticks > 4U * g_interactive_stats.cpu_ticks, "INV-Q3:BatchLargerShare");
+    TEST_ASSERT(g_interactive_stats.cpu_ticks > 0, "INV-Q3:InteractiveProgress");
+
+    /* INV-Q4 */
+    TEST_ASSERT(g_sensor_max_latency <= 1U, "INV-Q4:SensorLatency");
+
+    /* INV-Q5 */
+    TEST_ASSERT(background_before == 0, "INV-Q5:BackgroundStarved");
+    rtos_delay_ms(BACKGROUND_WAIT_MS);
+    TEST_ASSERT(g_background_spins > 0, "INV-Q5:BackgroundRunsAfterBand");
+
+    log_info("Batch: max_run=%u cpu=%u  Interactive: max_run=%u cpu=%u  Sensor latency=%u",
+             (unsigned) g_batch_stats.max_run, (unsigned) g_batch_stats.cpu_ticks,
+             (unsigned) g_interactive_stats.max_run, (unsigned) g_interactive_stats.cpu_ticks,
+             (unsigned) g_sensor_max_latency);
+
+    /* Final verdict */
+    TEST_EMIT_VERDICT();
+
+    test_log_task("END", "Monitor");
+    while (1)
+    {
+        rtos_delay_ms(1000);
+    }
+}
+
+/* =================== Timer Callbacks =================== */
+
+static void startup_timer_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    g_test_started = true;
+    test_log_framework("BEGIN", "RoundRobinQuantum");
+    rtos_timer_handle_t *p = (rtos_timer_handle_t *) param;
+    rtos_timer_start(*p);
+}
+
+static void test_timeout_callback(void *timer_handle, void *param)
+{
+    (void) timer_handle;
+    (void) param;
+    g_test_complete = true;
+    test_log_framework("TIMEOUT", "RoundRobinQuantum");
+}
+
+/* =================== Main =================== */
+
+__attribute__((__noreturn__)) int main(void)
+{
+    rtos_status_t       status;
+    rtos_timer_handle_t startup_timer;
+
+    hardware_env_config();
+    log_uart_init(LOG_LEVEL_ALL);
+
+    log_info("Round-Robin Scheduler - Quantum & Priority Band Test");
+    log_info("Band %u: Batch quantum=%u Interactive quantum=%u", TASK_BAND_PRIORITY, BATCH_QUANTUM,
+             INTERACTIVE_QUANTUM);
+    log_info("Invariants: Q1(batch) Q2(interactive) Q3(share) Q4(latency) Q5(bands)");
+
+    status = rtos_init();
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("RTOS init failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = test_create_startup_timer(startup_timer_callback, &g_test_timer, &startup_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Startup timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_timer_create("TestTimer", TEST_DURATION_MS, RTOS_TIMER_ONE_SHOT, test_timeout_callback, NULL,
+                               &g_test_timer);
+    if (status != RTOS_SUCCESS)
+    {
+        log_error("Test timer failed: %d", status);
+        indicate_system_failure();
+    }
+
+    status = rtos_task_create(batch_task_func, "Batch", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_BAND_PRIORITY,
+                              &g_handle_batch);
+    if (status != RTOS_SUCCESS || rtos_task_set_time_slice(g_handle_batch, BATCH_QUANTUM) != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    status = rtos_task_create(interactive_task_func, "Inter", RTOS_DEFAULT_TASK_STACK_SIZE, NULL,
+                              TASK_BAND_PRIORITY, &g_handle_interactive);
+    if (status != RTOS_SUCCESS ||
+        rtos_task_set_time_slice(g_handle_interactive, INTERACTIVE_QUANTUM) != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t background_handle;
+    status = rtos_task_create(background_task_func, "Backgr", RTOS_DEFAULT_TASK_STACK_SIZE, NULL,
+                              TASK_BACKGROUND_PRIORITY, &background_handle);
+    if (status != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t sensor_handle;
+    status = rtos_task_create(sensor_task_func, "Sensor", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_SENSOR_PRIORITY,
+                              &sensor_handle);
+    if (status != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    rtos_task_handle_t monitor_handle;
+    status = rtos_task_create(monitor_task_func, "Mon", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_MON_PRIORITY,
+                              &monitor_handle);
+    if (status != RTOS_SUCCESS)
+    {
+        indicate_system_failure();
+    }
+
+    /* Flush above the spinning band so the log drains */
+    rtos_task_handle_t flush_handle;
+    ulog_init(ULOG_LEVEL_INFO);
+    rtos_task_create(log_flush_task, "LogFlush", RTOS_DEFAULT_TASK_STACK_SIZE, NULL, TASK_FLUSH_PRIORITY,
+                     &flush_handle);
+
+    log_info("Starting scheduler...");
+    status = rtos_start_scheduler();
+
+    indicate_system_failure();
+}
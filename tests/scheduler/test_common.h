@@ -3,6 +3,7 @@
 
 #include "VRTOS.h"          // IWYU pragma: keep (rtos_delay_ms, RTOS_DEFAULT_TASK_STACK_SIZE)
 #include "log_flush_task.h" // log_flush_task
+#include "rtos_port.h"      // rtos_port_enter_critical, rtos_port_exit_critical
 #include "task.h"           // rtos_task_create
 #include "timer.h"          // rtos_timer_handle_t, rtos_timer_create, rtos_timer_start
 #include "ulog.h"           // ulog_init
@@ -58,9 +59,10 @@ static volatile uint32_t g_fail_count = 0;
 /**
  * @brief Emit the final RESULT PASS / RESULT FAIL:<N> verdict line.
  *
- * The verdict is written DIRECTLY to the UART data register by
- * polling, bypassing both the ulog ring buffer AND the interrupt-
- * driven _write() TX ring buffer.
+ * The verdict is written by uart_tx_write_polled(), which polls the
+ * UART data register (or writes the RTT / host backend directly),
+ * bypassing both the ulog ring buffer AND the interrupt-driven
+ * _write() TX ring buffer.
  *
  * Why: _write() spin-waits for the TXE ISR to drain its buffer.
  * If called with interrupts disabled, or concurrently with the
@@ -90,29 +92,19 @@ static volatile uint32_t g_fail_count = 0;
         }                                                                                                                    \
         if (_vlen > 0 && _vlen < (int) sizeof(_vline))                                                                       \
         {                                                                                                                    \
-            /*                                                                                                            \
-             * Enter critical section to prevent preemption: the flush                                                    \
-             * task may be mid-_write() and we must not touch the TX                                                      \
-             * ring buffer (which _write uses).                                                                           \
-             *                                                                                                            \
-             * uart_tx_flush() drains any pending TX buffer data by                                                       \
-             * polling DR directly (works with IRQs disabled).                                                            \
-             *                                                                                                            \
-             * Then we write the verdict byte-by-byte to USART2->DR,                                                     \
-             * bypassing the TX ring buffer entirely.                                                                     \
-             */ \
+            /*                                                                                                               \
+             * Enter critical section to prevent preemption: the flush                                                       \
+             * task may be mid-_write() and we must not touch the TX                                                         \
+             * ring buffer (which _write uses).                                                                              \
+             *                                                                                                               \
+             * uart_tx_flush() drains any pending TX buffer data by                                                          \
+             * polling (works with IRQs disabled), then                                                                      \
+             * uart_tx_write_polled() sends the verdict bypassing the                                                        \
+             * TX ring buffer entirely.                                                                                      \
+             */                                                                                                              \
             rtos_port_enter_critical();                                                                                      \
             uart_tx_flush();                                                                                                 \
-            for (int _vi = 0; _vi < _vlen; _vi++)                                                                            \
-            {                                                                                                                \
-                while (!(USART2->SR & USART_SR_TXE))                                                                         \
-                {                                                                                                            \
-                }                                                                                                            \
-                USART2->DR = (uint8_t) _vline[_vi];                                                                          \
-            }                                                                                                                \
-            while (!(USART2->SR & USART_SR_TC))                                                                              \
-            {                                                                                                                \
-            }                                                                                                                \
+            uart_tx_write_polled(_vline, (uint32_t) _vlen);                                                                  \
             rtos_port_exit_critical();                                                                                       \
         }                                                                                                                    \
     } while (0)
@@ -126,6 +118,17 @@ static volatile uint32_t g_fail_count = 0;
  */
 #define TEST_STARTUP_HOLD_MS (2000U)
 
+/**
+ * @brief Spare interrupt line the ISR tests pend in software
+ *
+ * Not used by the board code. A board without SPI4 overrides both
+ * names in its rtos_config.h.
+ */
+#ifndef TEST_SPARE_IRQn
+#define TEST_SPARE_IRQn       SPI4_IRQn
+#define TEST_SPARE_IRQHandler SPI4_IRQHandler
+#endif
+
 /**
  * @brief Poll-wait macro for test tasks
  *
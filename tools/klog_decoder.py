@@ -14,21 +14,26 @@ human-readable lines like:
     [K/I] 00345678 T02 TaskCreate       0x00000001 0x00000003
 
 This script captures those lines, optionally filters them, adds host
-timestamps, and saves to a log file. It can also be extended to decode
-raw binary KLog records for SWO/RTT capture.
+timestamps, and saves to a log file.
+
+With --binary the target is built with -D KLOG_BINARY_STREAM=1 and sends
+each 16-byte record as COBS(record + crc8) followed by 0x00. Event names
+are taken from src/logging/klog_events.h, so the decoded lines match the
+format above, with 64-bit cycle timestamps rebuilt from TimeEpoch records.
+ULog text between frames is passed through unchanged.
 """
 
 import argparse
 import datetime
 import os
 import re
+import struct
 import sys
 
 try:
     import serial
 except ImportError:
-    print("ERROR: pyserial not installed. Run: pip install pyserial")
-    sys.exit(1)
+    serial = None  # Checked in main(); rtt_capture.py imports the decoders without it
 
 
 # Regex to match KLog flush task output lines
@@ -37,6 +42,106 @@ KLOG_LINE_RE = re.compile(
 )
 
 
+DEFAULT_EVENTS_H = os.path.abspath(
+    os.path.join(os.path.dirname(__file__), "..", "src", "logging", "klog_events.h"))
+
+# klog_record_t: timestamp_cycles, event_id, level, cpu_context, arg0, arg1 (packed, little-endian)
+KLOG_RECORD = struct.Struct("<IHBBII")
+LEVEL_CHARS = "FEWIDT"
+
+ENUM_ENTRY_RE = re.compile(r"^\s*([A-Z][A-Z0-9_]*)\s*(?:=\s*(0x[0-9A-Fa-f]+|\d+))?\s*,")
+
+
+def load_event_names(path):
+    """Map event ID -> name (KEVT_TASK_CREATE -> TaskCreate) from the C enum."""
+    names = {}
+    value = -1
+    with open(path) as f:
+        for line in f:
+            m = ENUM_ENTRY_RE.match(line.split("//")[0])
+            if not m:
+                continue
+            ident, explicit = m.groups()
+            value = int(explicit, 0) if explicit else value + 1
+            short = ident.split("_", 1)[1] if "_" in ident else ident
+            names[value] = "".join(part.capitalize() for part in short.split("_"))
+    return names
+
+
+def cobs_decode(data):
+    """Decode one COBS frame (without the 0x00 delimiter); None if malformed."""
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data) + 1:
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def crc8(data):
+    """CRC-8, poly 0x07, init 0x00 — matches klog_crc8() on target."""
+    crc = 0
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+class Timeline:
+    """Extends 32-bit record timestamps to the target's 64-bit cycle count.
+
+    A TimeEpoch record (arg0 = low word, arg1 = high word) sets the count
+    outright; any other timestamp is taken as the nearest value to the last
+    one seen, which holds as long as records are less than 2^31 cycles apart.
+    """
+
+    def __init__(self):
+        self.last = None
+
+    def epoch(self, low, high):
+        self.last = (high << 32) | low
+
+    def extend(self, cycles):
+        if self.last is None:
+            self.last = cycles
+        else:
+            delta = ((cycles - self.last + (1 << 31)) & 0xFFFFFFFF) - (1 << 31)
+            self.last += delta
+        return self.last
+
+
+def format_record(raw, event_names, timeline=None):
+    """Return (level char, text line) for one raw 16-byte klog_record_t.
+
+    With a timeline the timestamp is printed as the full 64-bit cycle count.
+    """
+    cycles, event_id, level, ctx, arg0, arg1 = KLOG_RECORD.unpack(raw)
+    lvl = LEVEL_CHARS[level] if level < len(LEVEL_CHARS) else "?"
+    ctx_str = "ISR" if ctx >= 0xF0 else f"T{ctx:02d}"
+    name = event_names.get(event_id, f"Evt0x{event_id:04X}")
+    if timeline is None:
+        stamp = f"{cycles:08X}"
+    else:
+        if name == "TimeEpoch":
+            timeline.epoch(arg0, arg1)
+        stamp = f"{timeline.extend(cycles):016X}"
+    return lvl, f"[K/{lvl}] {stamp} {ctx_str} {name:<16} 0x{arg0:08X} 0x{arg1:08X}"
+
+
+def decode_record(chunk, event_names, timeline=None):
+    """Return (level char, text line) for a binary frame, or None if chunk is not a valid frame."""
+    raw = cobs_decode(chunk)
+    if raw is None or len(raw) != KLOG_RECORD.size + 1 or crc8(raw[:-1]) != raw[-1]:
+        return None
+    return format_record(raw[:-1], event_names, timeline)
+
+
 def parse_args():
     parser = argparse.ArgumentParser(description="KLog serial decoder")
     parser.add_argument("--port", default="COM3", help="Serial port (default: COM3)")
@@ -45,6 +150,10 @@ def parse_args():
     parser.add_argument("--output", default=default_out, help="Output directory (default: logs/klogs/)")
     parser.add_argument("--filter-level", default=None, choices=["F", "E", "W", "I", "D", "T"],
                         help="Minimum level to display (default: show all)")
+    parser.add_argument("--binary", action="store_true",
+                        help="Decode COBS-framed binary records (target built with KLOG_BINARY_STREAM=1)")
+    parser.add_argument("--events", default=DEFAULT_EVENTS_H,
+                        help="Path to klog_events.h for event names (default: src/logging/klog_events.h)")
     return parser.parse_args()
 
 
@@ -57,9 +166,54 @@ def should_display(level_char, min_level):
     return LEVEL_ORDER.get(level_char, 99) <= LEVEL_ORDER.get(min_level, 99)
 
 
+def emit(logfile, line):
+    host_ts = datetime.datetime.now().strftime("%H:%M:%S.%f")[:-3]
+    display = f"[{host_ts}] {line}"
+    print(display)
+    logfile.write(display + "\n")
+
+
+def capture_binary(ser, logfile, event_names, min_level):
+    """Split the stream on 0x00; valid frames are records, anything else is ULog text."""
+    klog_count = 0
+    other_count = 0
+    pending = bytearray()
+    timeline = Timeline()
+    while True:
+        data = ser.read(ser.in_waiting or 1)
+        if not data:
+            continue
+        pending += data
+        while True:
+            end = pending.find(b"\x00")
+            if end < 0:
+                break
+            chunk = bytes(pending[:end])
+            del pending[:end + 1]
+            if not chunk:
+                continue
+
+            decoded = decode_record(chunk, event_names, timeline)
+            if decoded is not None:
+                level, line = decoded
+                klog_count += 1
+                if should_display(level, min_level):
+                    emit(logfile, line)
+            else:
+                for text in chunk.decode("ascii", errors="replace").splitlines():
+                    if text.strip():
+                        other_count += 1
+                        emit(logfile, text.rstrip())
+        logfile.flush()
+
+
 def main():
     args = parse_args()
 
+    if serial is None:
+        print("ERROR: pyserial not installed. Run: pip install pyserial")
+        sys.exit(1)
+
     # Create output directory
     os.makedirs(args.output, exist_ok=True)
 
@@ -80,6 +234,20 @@ def main():
     klog_count = 0
     other_count = 0
 
+    if args.binary:
+        event_names = load_event_names(args.events)
+        try:
+            with open(log_path, "w") as logfile:
+                logfile.write(f"# KLog binary capture started at {ts}\n")
+                logfile.write(f"# Port: {args.port} Baud: {args.baud}\n")
+                logfile.write("#\n")
+                klog_count, other_count = capture_binary(ser, logfile, event_names, args.filter_level)
+        except KeyboardInterrupt:
+            print(f"\n\nCapture stopped. Log saved to: {log_path}")
+        finally:
+            ser.close()
+        return
+
     try:
         with open(log_path, "w") as logfile:
             logfile.write(f"# KLog capture started at {ts}\n")
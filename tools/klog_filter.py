@@ -0,0 +1,189 @@
+#!/usr/bin/env python3
+"""
+klog_filter.py — Show and change the KLog runtime filter of a running target.
+
+With KLOG_RUNTIME_FILTER=1 (the default) every KLOG() call site checks a
+per-level subsystem mask in RAM (klog_filter, src/logging/klog.c) before it
+writes anything. The block starts with the "KLOGFLT" magic, so this script
+finds it by scanning RAM over SWD, the same way rtt_capture.py finds the
+RTT control block, and edits the masks while the target keeps running:
+
+    python klog_filter.py                      # show the current levels
+    python klog_filter.py sync=trace           # DEBUG and TRACE for mutex/semaphore
+    python klog_filter.py all=warn queue=info  # quiet everything but queues
+
+Settings apply left to right. Levels are fault, error, warn, info, debug,
+trace (or F E W I D T); FAULT records are never filtered. Levels above the
+build's KLOG_MIN_LEVEL have no code on the target, whatever the mask says.
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+try:
+    from pyocd.core.helpers import ConnectHelper
+except ImportError:
+    ConnectHelper = None
+
+FILTER_MAGIC = b"KLOGFLT\x00"
+LEVEL_NAMES = ["fault", "error", "warn", "info", "debug", "trace"]
+LEVEL_CHARS = "FEWIDT"
+MASK_OFFSET = len(FILTER_MAGIC)
+
+DEFAULT_KLOG_H = os.path.abspath(os.path.join(os.path.dirname(__file__), "..", "src", "logging", "klog.h"))
+
+SUBSYS_RE = re.compile(r"^\s*KLOG_SUBSYS_([A-Z][A-Z0-9_]*)\s*(?:=\s*(0x[0-9A-Fa-f]+|\d+))?\s*,")
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(description="KLog runtime filter over SWD (KLOG_RUNTIME_FILTER=1)")
+    parser.add_argument("settings", nargs="*", metavar="SUBSYS=LEVEL",
+                        help="Highest level to record for a subsystem, or all= for every subsystem")
+    parser.add_argument("--target", default="stm32f446retx", help="pyOCD target type (default: stm32f446retx)")
+    parser.add_argument("--probe", default=None, help="Probe unique ID (default: first probe found)")
+    parser.add_argument("--address", default=None, type=lambda v: int(v, 0),
+                        help="klog_filter address (default: scan RAM for the magic)")
+    parser.add_argument("--ram-start", default=0x20000000, type=lambda v: int(v, 0),
+                        help="RAM scan start (default: 0x20000000)")
+    parser.add_argument("--ram-size", default=0x20000, type=lambda v: int(v, 0),
+                        help="RAM scan length (default: 0x20000, 128 KB)")
+    parser.add_argument("--klog-h", default=DEFAULT_KLOG_H,
+                        help="Path to klog.h for subsystem names (default: src/logging/klog.h)")
+    return parser.parse_args()
+
+
+def load_subsystems(path):
+    """Map lower-case name -> bit from the klog_subsys_t enum, without COUNT."""
+    subsystems = {}
+    value = -1
+    with open(path) as f:
+        for line in f:
+            m = SUBSYS_RE.match(line.split("/*")[0])
+            if not m:
+                continue
+            name, explicit = m.groups()
+            value = int(explicit, 0) if explicit else value + 1
+            if name != "COUNT":
+                subsystems[name.lower()] = value
+    return subsystems
+
+
+def parse_level(text):
+    text = text.lower()
+    if text in LEVEL_NAMES:
+        return LEVEL_NAMES.index(text)
+    if len(text) == 1 and text.upper() in LEVEL_CHARS:
+        return LEVEL_CHARS.index(text.upper())
+    raise ValueError(f"unknown level '{text}' (expected one of {', '.join(LEVEL_NAMES)})")
+
+
+def parse_settings(settings, subsystems):
+    """[(bit mask, level)] in command-line order."""
+    every = 0
+    for bit in subsystems.values():
+        every |= 1 << bit
+    changes = []
+    for entry in settings:
+        name, sep, level = entry.partition("=")
+        if not sep:
+            raise ValueError(f"'{entry}' is not SUBSYS=LEVEL")
+        name = name.lower()
+        if name == "all":
+            mask = every
+        elif name in subsystems:
+            mask = 1 << subsystems[name]
+        else:
+            raise ValueError(f"unknown subsystem '{name}' (expected all or one of {', '.join(subsystems)})")
+        changes.append((mask, parse_level(level)))
+    return changes
+
+
+def find_filter(target, start, size):
+    """Scan RAM in 4 KB chunks (overlapping by the magic length) for the filter block."""
+    chunk = 4096
+    addr = start
+    while addr < start + size:
+        length = min(chunk + len(FILTER_MAGIC), start + size - addr)
+        data = bytes(target.read_memory_block8(addr, length))
+        idx = data.find(FILTER_MAGIC)
+        # klog_filter is word-aligned; a stray copy of the string need not be
+        while idx >= 0 and (addr + idx) % 4 != 0:
+            idx = data.find(FILTER_MAGIC, idx + 1)
+        if idx >= 0:
+            return addr + idx
+        addr += chunk
+    return None
+
+
+def read_masks(target, addr):
+    raw = bytes(target.read_memory_block8(addr + MASK_OFFSET, 4 * len(LEVEL_NAMES)))
+    return list(struct.unpack(f"<{len(LEVEL_NAMES)}I", raw))
+
+
+def apply_change(target, addr, mask, max_level):
+    """Same effect as klog_filter_set(mask, max_level), one word per level.
+
+    The kernel only reads these words, apart from a klog_filter_set() call on
+    the target, so a read-modify-write from the debugger is enough.
+    """
+    for level in range(1, len(LEVEL_NAMES)):
+        word_addr = addr + MASK_OFFSET + 4 * level
+        word = target.read32(word_addr)
+        word = word | mask if level <= max_level else word & ~mask & 0xFFFFFFFF
+        target.write32(word_addr, word)
+
+
+def show(masks, subsystems):
+    print(f"{'Subsystem':<16} Level")
+    for name, bit in sorted(subsystems.items(), key=lambda kv: kv[1]):
+        level = 0
+        for lvl in range(1, len(LEVEL_NAMES)):
+            if masks[lvl] & (1 << bit):
+                level = lvl
+        print(f"{name:<16} {LEVEL_NAMES[level]}")
+
+
+def main():
+    args = parse_args()
+
+    subsystems = load_subsystems(args.klog_h)
+    if not subsystems:
+        print(f"ERROR: no KLOG_SUBSYS_* entries in {args.klog_h}")
+        return 1
+    try:
+        changes = parse_settings(args.settings, subsystems)
+    except ValueError as e:
+        print(f"ERROR: {e}")
+        return 1
+
+    if ConnectHelper is None:
+        print("ERROR: pyocd not installed. Run: pip install pyocd")
+        return 1
+
+    session = ConnectHelper.session_with_chosen_probe(unique_id=args.probe, target_override=args.target,
+                                                      connect_mode="attach")
+    if session is None:
+        print("ERROR: no debug probe found")
+        return 1
+
+    with session:
+        target = session.target
+        addr = args.address
+        if addr is None:
+            addr = find_filter(target, args.ram_start, args.ram_size)
+        if addr is None:
+            print("ERROR: klog_filter not found. Is the target built with KLOG_RUNTIME_FILTER=1 and running?")
+            return 1
+
+        print(f"klog_filter at 0x{addr:08X}")
+        for mask, level in changes:
+            apply_change(target, addr, mask, level)
+        show(read_masks(target, addr), subsystems)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
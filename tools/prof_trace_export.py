@@ -0,0 +1,266 @@
+#!/usr/bin/env python3
+"""
+prof_trace_export.py — ProfTrace capture to Chrome / Perfetto trace JSON.
+
+The target is built with -D RTOS_PROF_TRACE=1 and the kernel writes 8-byte
+prof_record_t records (src/profiling/prof_trace.h) for every context switch,
+sync block, wake-up and SysTick entry/exit. Capture them raw, for example
+with rtt_capture.py --prof-raw trace.bin, or by writing what
+prof_trace_drain() returns to any byte channel, then:
+
+    python prof_trace_export.py trace.bin -o trace.json --clock-hz 16000000 \\
+        --task-name 2=Worker --task-name 3=Controller
+
+Open trace.json in https://ui.perfetto.dev or chrome://tracing. There is one
+track per task and one per exception number:
+
+    Running     SWITCH_IN .. SWITCH_OUT
+    Blocked     SWITCH_OUT .. UNBLOCK, after a BLOCK on a sync object
+    Waiting     SWITCH_OUT .. UNBLOCK otherwise (delay, suspend)
+    Ready       UNBLOCK .. SWITCH_IN: the scheduling latency, with a flow
+                arrow from whatever made the task ready
+    Preempted   SWITCH_OUT .. SWITCH_IN while the task stayed ready
+
+The longest Ready intervals are printed with their waker and what ran in
+the meantime, which is where g_prof_scheduling_latency outliers come from.
+"""
+
+import argparse
+import json
+import os
+import struct
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from klog_decoder import DEFAULT_EVENTS_H, load_event_names  # noqa: E402
+
+# prof_record_t: cyccnt, event_id, entity_id, _pad (packed, little-endian)
+PROF_RECORD = struct.Struct("<IHBB")
+
+PID_TASKS = 1
+PID_ISRS = 2
+
+EXCEPTION_NAMES = {2: "NMI", 3: "HardFault", 11: "SVCall", 14: "PendSV", 15: "SysTick"}
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(description="ProfTrace capture to Chrome / Perfetto trace JSON")
+    parser.add_argument("capture", help="Raw prof_record_t capture (8 bytes per record)")
+    parser.add_argument("-o", "--output", default=None, help="Trace JSON to write (default: <capture>.json)")
+    parser.add_argument("--clock-hz", default=16000000, type=float,
+                        help="DWT->CYCCNT rate (default: 16000000; 1e9 for the native port)")
+    parser.add_argument("--task-name", action="append", default=[], metavar="ID=NAME",
+                        help="Name a task track (repeatable)")
+    parser.add_argument("--top", default=5, type=int, help="Longest Ready intervals to report (default: 5)")
+    parser.add_argument("--events", default=DEFAULT_EVENTS_H,
+                        help="Path to klog_events.h for event IDs (default: src/logging/klog_events.h)")
+    return parser.parse_args()
+
+
+def read_records(path):
+    """(cycles, event_id, entity) per record, with CYCCNT unwrapped to 64 bits."""
+    with open(path, "rb") as f:
+        data = f.read()
+    records = []
+    elapsed = 0
+    previous = None
+    for offset in range(0, len(data) - PROF_RECORD.size + 1, PROF_RECORD.size):
+        cyccnt, event_id, entity, _ = PROF_RECORD.unpack_from(data, offset)
+        if previous is not None:
+            elapsed += (cyccnt - previous) & 0xFFFFFFFF
+        previous = cyccnt
+        records.append((elapsed, event_id, entity))
+    return records
+
+
+def isr_name(number):
+    return EXCEPTION_NAMES.get(number, f"IRQ{number - 16}" if number >= 16 else f"Exception {number}")
+
+
+class Timeline:
+    """Walks the records in order and builds the per-task state intervals."""
+
+    def __init__(self, ids, task_names, clock_hz):
+        self.ids = ids
+        self.task_names = task_names
+        self.scale = 1e6 / clock_hz  # cycles -> microseconds
+        self.events = []
+        self.tasks = set()
+        self.isrs = set()
+        self.state = {}      # task -> (state name, start cycles, args)
+        self.blocking = set()
+        self.running = None
+        self.isr_stack = []
+        self.ready_intervals = []
+        self.flow_id = 0
+
+    def task_label(self, task):
+        return self.task_names.get(task, f"Task {task}")
+
+    def us(self, cycles):
+        return cycles * self.scale
+
+    def close(self, task, now):
+        """End the open interval of task at now; returns it."""
+        interval = self.state.pop(task, None)
+        if interval is None:
+            return None
+        name, start, args = interval
+        self.events.append({"name": name, "ph": "X", "pid": PID_TASKS, "tid": task, "ts": self.us(start),
+                            "dur": self.us(now - start), "args": args})
+        return name, start, args
+
+    def open(self, task, name, now, args=None):
+        self.state[task] = (name, now, args or {})
+
+    def waker(self):
+        if self.isr_stack:
+            return "isr", self.isr_stack[-1]
+        if self.running is not None:
+            return "task", self.running
+        return None, None
+
+    def on_switch_out(self, task, now):
+        self.tasks.add(task)
+        self.close(task, now)
+        if task in self.blocking:
+            self.open(task, "Blocked", now)
+        else:
+            self.open(task, "Waiting", now)  # relabelled Preempted if it is switched in without a wake
+        self.blocking.discard(task)
+        if self.running == task:
+            self.running = None
+
+    def on_switch_in(self, task, now):
+        self.tasks.add(task)
+        interval = self.state.get(task)
+        if interval is not None and interval[0] == "Waiting":
+            self.state[task] = ("Preempted", interval[1], interval[2])
+        closed = self.close(task, now)
+        if closed is not None and closed[0] == "Ready":
+            self.ready_intervals.append((now - closed[1], task, closed[1], now, closed[2]))
+            flow = closed[2].get("flow")
+            if flow is not None:
+                self.events.append({"name": "wake", "cat": "wake", "ph": "f", "bp": "e", "id": flow,
+                                    "pid": PID_TASKS, "tid": task, "ts": self.us(closed[1])})
+        self.open(task, "Running", now)
+        self.running = task
+
+    def on_unblock(self, task, now):
+        self.tasks.add(task)
+        self.close(task, now)
+        kind, who = self.waker()
+        args = {}
+        if kind is not None:
+            self.flow_id += 1
+            args = {"woken_by": isr_name(who) if kind == "isr" else self.task_label(who), "flow": self.flow_id}
+            self.events.append({"name": "wake", "cat": "wake", "ph": "s", "id": self.flow_id,
+                                "pid": PID_ISRS if kind == "isr" else PID_TASKS, "tid": who, "ts": self.us(now)})
+        self.open(task, "Ready", now, args)
+
+    def on_isr_enter(self, number, now):
+        self.isrs.add(number)
+        self.isr_stack.append(number)
+        self.events.append({"name": isr_name(number), "ph": "B", "pid": PID_ISRS, "tid": number,
+                            "ts": self.us(now)})
+
+    def on_isr_exit(self, number, now):
+        self.isrs.add(number)
+        if number in self.isr_stack:
+            self.isr_stack.remove(number)
+            self.events.append({"name": isr_name(number), "ph": "E", "pid": PID_ISRS, "tid": number,
+                                "ts": self.us(now)})
+
+    def run(self, records):
+        handlers = {
+            self.ids["TaskSwitchOut"]: self.on_switch_out,
+            self.ids["TaskSwitchIn"]: self.on_switch_in,
+            self.ids["TaskUnblock"]: self.on_unblock,
+            self.ids["IsrEnter"]: self.on_isr_enter,
+            self.ids["IsrExit"]: self.on_isr_exit,
+        }
+        block = self.ids["TaskBlock"]
+        for now, event_id, entity in records:
+            if event_id == block:
+                self.tasks.add(entity)
+                self.blocking.add(entity)
+            elif event_id in handlers:
+                handlers[event_id](entity, now)
+        end = records[-1][0] if records else 0
+        for task in list(self.state):
+            self.close(task, end)
+
+    def metadata(self):
+        meta = [{"name": "process_name", "ph": "M", "pid": PID_TASKS, "args": {"name": "Tasks"}},
+                {"name": "process_name", "ph": "M", "pid": PID_ISRS, "args": {"name": "ISRs"}}]
+        for task in sorted(self.tasks):
+            meta.append({"name": "thread_name", "ph": "M", "pid": PID_TASKS, "tid": task,
+                         "args": {"name": self.task_label(task)}})
+        for number in sorted(self.isrs):
+            meta.append({"name": "thread_name", "ph": "M", "pid": PID_ISRS, "tid": number,
+                         "args": {"name": isr_name(number)}})
+        return meta
+
+
+def ran_during(timeline, start, end):
+    """Microseconds each task ran inside [start, end) cycles."""
+    lo, hi = timeline.us(start), timeline.us(end)
+    share = {}
+    for event in timeline.events:
+        if event.get("ph") == "X" and event["name"] == "Running":
+            label = timeline.task_label(event["tid"])
+            overlap = min(hi, event["ts"] + event["dur"]) - max(lo, event["ts"])
+            if overlap > 0:
+                share[label] = share.get(label, 0.0) + overlap
+    return share
+
+
+def report_latency(timeline, top):
+    if top <= 0 or not timeline.ready_intervals:
+        return
+    print(f"Longest Ready intervals (wake to switch-in), top {top}:")
+    for cycles, task, start, end, args in sorted(timeline.ready_intervals, reverse=True)[:top]:
+        waker = args.get("woken_by", "?")
+        share = ran_during(timeline, start, end)
+        others = ", ".join(f"{name} {us:.1f}us" for name, us in sorted(share.items(), key=lambda kv: -kv[1]))
+        print(f"  {timeline.task_label(task):<16} {timeline.us(cycles):9.1f}us  woken by {waker:<12} "
+              f"ran meanwhile: {others or 'nothing (switch path only)'}")
+
+
+def main():
+    args = parse_args()
+
+    names = load_event_names(args.events)
+    ids = {name: value for value, name in names.items()}
+    missing = [n for n in ("TaskSwitchOut", "TaskSwitchIn", "TaskBlock", "TaskUnblock", "IsrEnter", "IsrExit")
+               if n not in ids]
+    if missing:
+        print(f"ERROR: {args.events} lacks {', '.join(missing)}")
+        return 1
+
+    task_names = {}
+    for entry in args.task_name:
+        task, _, name = entry.partition("=")
+        task_names[int(task, 0)] = name
+
+    records = read_records(args.capture)
+    if not records:
+        print(f"ERROR: no records in {args.capture}")
+        return 1
+
+    timeline = Timeline(ids, task_names, args.clock_hz)
+    timeline.run(records)
+
+    output = args.output or os.path.splitext(args.capture)[0] + ".json"
+    for event in timeline.events:
+        event.get("args", {}).pop("flow", None)
+    with open(output, "w") as f:
+        json.dump({"traceEvents": timeline.metadata() + timeline.events, "displayTimeUnit": "ns"}, f)
+
+    print(f"{len(records)} records, {len(timeline.tasks)} tasks, {len(timeline.isrs)} ISRs -> {output}")
+    report_latency(timeline, args.top)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,231 @@
+#!/usr/bin/env python3
+"""
+rtt_capture.py — Host-side capture for the RTT log backend.
+
+The target is built with -D LOG_BACKEND_RTT=1. KLog, ULog and ProfTrace
+then write straight into a SEGGER RTT-compatible control block in RAM
+(src/logging/rtt.c) and nothing goes out over the UART. This script
+attaches over SWD with pyOCD, finds the control block, and drains the
+up-channels while the target keeps running:
+
+    0  Terminal   ULog lines and printf text
+    1  KLog       raw klog_record_t (16 bytes), decoded here
+    2  ProfTrace  raw prof_record_t (8 bytes), decoded here
+
+Usage:
+    python rtt_capture.py [--target stm32f446retx] [--output logs/klogs/]
+
+KLog lines use the same format as klog_decoder.py:
+
+    [K/I] 00345678 T02 TaskCreate       0x00000001 0x00000003
+    [P]   00345A10 T03 TaskSwitchIn
+    [P]   00345B24 E15 IsrEnter
+
+With --prof-raw FILE the ProfTrace records are also saved unmodified, for
+prof_trace_export.py to turn into a Perfetto / chrome://tracing timeline.
+
+Any RTT viewer (J-Link RTT Viewer, OpenOCD "rtt" commands) can also read
+channel 0 as a plain terminal.
+"""
+
+import argparse
+import datetime
+import os
+import struct
+import sys
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from klog_decoder import (DEFAULT_EVENTS_H, KLOG_RECORD, Timeline, emit, format_record,  # noqa: E402
+                          load_event_names, should_display)
+
+try:
+    from pyocd.core.helpers import ConnectHelper
+except ImportError:
+    ConnectHelper = None
+
+RTT_ID = b"SEGGER RTT\x00"
+
+# SEGGER_RTT_CB header: acID[16], MaxNumUpBuffers, MaxNumDownBuffers
+RTT_CB_HEADER = struct.Struct("<16sii")
+# SEGGER_RTT_BUFFER_UP: sName, pBuffer, SizeOfBuffer, WrOff, RdOff, Flags
+RTT_BUFFER = struct.Struct("<IIIIII")
+RDOFF_OFFSET = 16
+
+CHANNEL_TERMINAL = 0
+CHANNEL_KLOG = 1
+CHANNEL_PROF = 2
+
+# prof_record_t: cyccnt, event_id, entity_id, _pad (packed, little-endian)
+PROF_RECORD = struct.Struct("<IHBB")
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(description="RTT log capture (LOG_BACKEND_RTT=1)")
+    parser.add_argument("--target", default="stm32f446retx", help="pyOCD target type (default: stm32f446retx)")
+    parser.add_argument("--probe", default=None, help="Probe unique ID (default: first probe found)")
+    parser.add_argument("--address", default=None, type=lambda v: int(v, 0),
+                        help="_SEGGER_RTT address (default: scan RAM for the ID string)")
+    parser.add_argument("--ram-start", default=0x20000000, type=lambda v: int(v, 0),
+                        help="RAM scan start (default: 0x20000000)")
+    parser.add_argument("--ram-size", default=0x20000, type=lambda v: int(v, 0),
+                        help="RAM scan length (default: 0x20000, 128 KB)")
+    parser.add_argument("--poll-ms", default=10, type=int, help="Channel poll period (default: 10 ms)")
+    default_out = os.path.abspath(os.path.join(os.path.dirname(__file__), "..", "logs", "klogs"))
+    parser.add_argument("--output", default=default_out, help="Output directory (default: logs/klogs/)")
+    parser.add_argument("--filter-level", default=None, choices=["F", "E", "W", "I", "D", "T"],
+                        help="Minimum KLog level to display (default: show all)")
+    parser.add_argument("--no-prof", action="store_true", help="Drain the ProfTrace channel but do not print it")
+    parser.add_argument("--prof-raw", default=None, metavar="FILE",
+                        help="Also save raw ProfTrace records to FILE (input of prof_trace_export.py)")
+    parser.add_argument("--events", default=DEFAULT_EVENTS_H,
+                        help="Path to klog_events.h for event names (default: src/logging/klog_events.h)")
+    return parser.parse_args()
+
+
+def find_control_block(target, start, size):
+    """Scan RAM in 4 KB chunks (overlapping by the ID length) for the RTT ID."""
+    chunk = 4096
+    addr = start
+    while addr < start + size:
+        length = min(chunk + len(RTT_ID), start + size - addr)
+        data = bytes(target.read_memory_block8(addr, length))
+        idx = data.find(RTT_ID)
+        if idx >= 0:
+            return addr + idx
+        addr += chunk
+    return None
+
+
+class UpChannel:
+    """One RTT up-buffer; the host owns RdOff."""
+
+    def __init__(self, target, desc_addr):
+        self.target = target
+        self.desc_addr = desc_addr
+        _, self.buf_addr, self.size, _, self.rd_off, _ = RTT_BUFFER.unpack(
+            bytes(target.read_memory_block8(desc_addr, RTT_BUFFER.size)))
+
+    def read(self):
+        wr_off = self.target.read32(self.desc_addr + 12)
+        if wr_off == self.rd_off or wr_off >= self.size:
+            return b""
+
+        if wr_off > self.rd_off:
+            data = bytes(self.target.read_memory_block8(self.buf_addr + self.rd_off, wr_off - self.rd_off))
+        else:
+            data = bytes(self.target.read_memory_block8(self.buf_addr + self.rd_off, self.size - self.rd_off))
+            if wr_off:
+                data += bytes(self.target.read_memory_block8(self.buf_addr, wr_off))
+
+        self.rd_off = wr_off
+        self.target.write32(self.desc_addr + RDOFF_OFFSET, wr_off)
+        return data
+
+
+def take_records(pending, record_size):
+    """Split whole records off the front of pending (bytearray)."""
+    count = len(pending) // record_size
+    records = [bytes(pending[i * record_size:(i + 1) * record_size]) for i in range(count)]
+    del pending[:count * record_size]
+    return records
+
+
+def capture(target, cb_addr, logfile, event_names, args, counts, prof_raw=None):
+    """Poll the up-channels until interrupted; counts is updated in place."""
+    _, max_up, _ = RTT_CB_HEADER.unpack(bytes(target.read_memory_block8(cb_addr, RTT_CB_HEADER.size)))
+    if max_up <= CHANNEL_PROF:
+        print(f"ERROR: control block has {max_up} up-channels, expected {CHANNEL_PROF + 1}")
+        return
+
+    channels = [UpChannel(target, cb_addr + RTT_CB_HEADER.size + i * RTT_BUFFER.size)
+                for i in range(CHANNEL_PROF + 1)]
+    pending = [bytearray() for _ in channels]
+    timeline = Timeline()
+
+    while True:
+        for ch, up in enumerate(channels):
+            pending[ch] += up.read()
+
+        text = pending[CHANNEL_TERMINAL]
+        while b"\n" in text:
+            line, _, rest = bytes(text).partition(b"\n")
+            text[:] = rest
+            line = line.decode("ascii", errors="replace").rstrip()
+            if line:
+                counts["text"] += 1
+                emit(logfile, line)
+
+        for raw in take_records(pending[CHANNEL_KLOG], KLOG_RECORD.size):
+            level, line = format_record(raw, event_names, timeline)
+            counts["klog"] += 1
+            if should_display(level, args.filter_level):
+                emit(logfile, line)
+
+        for raw in take_records(pending[CHANNEL_PROF], PROF_RECORD.size):
+            cyccnt, event_id, entity, _ = PROF_RECORD.unpack(raw)
+            counts["prof"] += 1
+            if prof_raw is not None:
+                prof_raw.write(raw)
+            if not args.no_prof:
+                name = event_names.get(event_id, f"Evt0x{event_id:04X}")
+                # ISR events carry the exception number, all others a task ID
+                entity_str = f"E{entity:02d}" if name.startswith("Isr") else f"T{entity:02d}"
+                emit(logfile, f"[P]   {cyccnt:08X} {entity_str} {name}")
+
+        logfile.flush()
+        time.sleep(args.poll_ms / 1000.0)
+
+
+def main():
+    args = parse_args()
+
+    if ConnectHelper is None:
+        print("ERROR: pyocd not installed. Run: pip install pyocd")
+        sys.exit(1)
+
+    event_names = load_event_names(args.events)
+
+    os.makedirs(args.output, exist_ok=True)
+    ts = datetime.datetime.now().strftime("%Y%m%d_%H%M%S")
+    log_path = os.path.join(args.output, f"rtt_{ts}.log")
+
+    session = ConnectHelper.session_with_chosen_probe(unique_id=args.probe, target_override=args.target,
+                                                      connect_mode="attach")
+    if session is None:
+        print("ERROR: no debug probe found")
+        sys.exit(1)
+
+    with session:
+        target = session.target
+        cb_addr = args.address
+        if cb_addr is None:
+            cb_addr = find_control_block(target, args.ram_start, args.ram_size)
+        if cb_addr is None:
+            print("ERROR: RTT control block not found. Is the target built with LOG_BACKEND_RTT=1 and running?")
+            sys.exit(1)
+
+        print(f"RTT control block at 0x{cb_addr:08X}")
+        print(f"Logging to: {log_path}")
+        print("Press Ctrl+C to stop\n")
+
+        counts = {"klog": 0, "prof": 0, "text": 0}
+        prof_raw = open(args.prof_raw, "wb") if args.prof_raw else None
+        try:
+            with open(log_path, "w") as logfile:
+                logfile.write(f"# RTT capture started at {ts}\n")
+                logfile.write(f"# Control block: 0x{cb_addr:08X}\n")
+                logfile.write("#\n")
+                capture(target, cb_addr, logfile, event_names, args, counts, prof_raw)
+        except KeyboardInterrupt:
+            print(f"\n\nCapture stopped. KLog records: {counts['klog']}, ProfTrace records: {counts['prof']}, "
+                  f"Text lines: {counts['text']}")
+            print(f"Log saved to: {log_path}")
+        finally:
+            if prof_raw is not None:
+                prof_raw.close()
+                print(f"Raw ProfTrace saved to: {args.prof_raw}")
+
+
+if __name__ == "__main__":
+    main()
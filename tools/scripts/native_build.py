@@ -0,0 +1,14 @@
+# /*******************************************************************************
+#  * File: tools/scripts/native_build.py
+#  * Description: Link flags for the POSIX simulation (native_* environments)
+#  ******************************************************************************/
+
+# PlatformIO extra script: runs inside SCons with the build environment.
+#
+# The kernel stores pointers in 32-bit words (ulog format records, the
+# mutex owner word), so the simulation is built as a 32-bit host program.
+# build_flags only reach the compiler; the linker needs -m32 as well.
+
+Import("env")  # noqa: F821 (provided by SCons)
+
+env.Append(LINKFLAGS=["-m32"])  # noqa: F821
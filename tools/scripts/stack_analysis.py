@@ -0,0 +1,263 @@
+# /*******************************************************************************
+#  * File: tools/scripts/stack_analysis.py
+#  * Description: Build-time worst-case stack analysis of every task entry
+#  ******************************************************************************/
+
+#!/usr/bin/env python3
+"""
+Worst-case stack usage of each task, from the compiler and the linked ELF.
+
+As a PlatformIO extra script it adds -fstack-usage to every compile and runs
+after the ELF is linked; it can also be run by hand on a finished build:
+
+    python3 tools/scripts/stack_analysis.py .pio/build/<env>/firmware.elf
+
+Inputs:
+- the .su files gcc writes next to each object (per-function frame size)
+- the call graph, from the disassembly of the ELF (bl / b / call / jmp to
+  a symbol), so inlining, tail calls and gc-sections are already applied
+- the task entries: the first argument of rtos_task_create / _static /
+  _edf and the function of RTOS_TASK_DEFINE(_EX), found in the sources
+  that produced the .su files, kept if the function is in the ELF
+
+Output: rtos_stack_sizes.h in the build directory, which the script puts on
+the include path of the env, with per entry
+
+    RTOS_STACK_USAGE_<entry>  deepest call chain, bytes
+    RTOS_STACK_SIZE_<entry>   usage + context frame + canary, 8-aligned
+
+and, for an entry whose bound is not known, RTOS_STACK_UNBOUNDED_<entry>
+with the reason: recursion, a dynamic (alloca / VLA) frame, a call through
+a pointer, or a callee without stack data (assembly, prebuilt libraries).
+Those are still printed, but as lower bounds.
+
+The frame overhead is what the Cortex-M port places on a task stack when it
+is switched out: the hardware exception frame (8 words, 26 with the FPU
+state, plus an alignment word), then PendSV's R3-R11 + EXC_RETURN (10
+words) and S16-S31 (16 words) for tasks that used the FPU. ISRs run on MSP
+and add nothing past the first frame. The host port keeps contexts in
+ucontext_t and runs tasks on its own stacks, so it reports no overhead.
+"""
+
+import os
+import re
+import subprocess
+import sys
+
+HEADER_NAME = "rtos_stack_sizes.h"
+
+# Bytes a switched-out task holds on its own stack (Cortex-M port)
+HW_FRAME = 8 * 4
+HW_FRAME_FPU = 26 * 4
+HW_FRAME_ALIGN = 4
+SW_FRAME = 10 * 4
+SW_FRAME_FPU = 16 * 4
+CANARY = 4
+
+SYMBOL_RE = re.compile(r"^([0-9a-f]+) <([^>]+)>:$")
+# ARM: bl/blx/b(cond)(.w/.n). x86: call/jmp/j(cond). Target in another function.
+DIRECT_RE = re.compile(r"\s(?:bl|blx|b[a-z]{0,2}(?:\.[wn])?|call[lq]?|jmp[lq]?|j[a-z]{1,3})\s+[0-9a-f]+ <([^>+]+)>")
+INDIRECT_RE = re.compile(r"\s(?:blx|bx)\s+(r\d+|ip|lr)\b|\s(?:call|jmp)[lq]?\s+\*")
+TASK_CREATE_RE = re.compile(r"\brtos_task_create(?:_static|_edf)?\s*\(\s*(\w+)\s*,")
+TASK_DEFINE_RE = re.compile(r"\bRTOS_TASK_DEFINE(?:_EX)?\s*\(\s*\w+\s*,\s*(\w+)\s*,")
+
+
+def read_stack_usage(build_dir):
+    """Map function -> (frame bytes, dynamic) and return the source files seen."""
+    frames = {}
+    sources = set()
+    for root, dirs, files in os.walk(build_dir):
+        for file in files:
+            if not file.endswith(".su"):
+                continue
+            with open(os.path.join(root, file)) as f:
+                for line in f:
+                    fields = line.rstrip("\n").split("\t")
+                    if len(fields) != 3:
+                        continue
+                    location, size, kind = fields
+                    parts = location.rsplit(":", 3)
+                    if len(parts) != 4:
+                        continue
+                    source, name = parts[0], parts[3]
+                    sources.add(source)
+                    # Same static name in two files: keep the larger frame
+                    prev = frames.get(name, (0, False))
+                    frames[name] = (max(prev[0], int(size)), prev[1] or kind == "dynamic")
+    return frames, sources
+
+
+def read_call_graph(elf_file, objdump):
+    """Map function -> (set of direct callees, has indirect calls), from the ELF."""
+    output = subprocess.check_output([objdump, "-d", "--no-show-raw-insn", elf_file],
+                                     stderr=subprocess.DEVNULL).decode(errors="replace")
+    graph = {}
+    current = None
+    for line in output.splitlines():
+        match = SYMBOL_RE.match(line)
+        if match:
+            current = match.group(2)
+            graph.setdefault(current, (set(), [False]))
+            continue
+        if current is None:
+            continue
+        match = DIRECT_RE.search(line)
+        if match:
+            callee = match.group(1).split("@")[0]
+            if callee != current:
+                graph[current][0].add(callee)
+        elif INDIRECT_RE.search(line) and not re.search(r"\bbx\s+lr\b", line):
+            graph[current][1][0] = True
+    return {name: (callees, flag[0]) for name, (callees, flag) in graph.items()}
+
+
+def find_task_entries(sources, graph):
+    """Task entry functions named in the compiled sources and present in the ELF."""
+    entries = set()
+    for source in sources:
+        if not os.path.exists(source):
+            continue
+        with open(source, errors="replace") as f:
+            text = f.read()
+        for regex in (TASK_CREATE_RE, TASK_DEFINE_RE):
+            entries.update(name for name in regex.findall(text) if name in graph)
+    return sorted(entries)
+
+
+def worst_case(entry, frames, graph):
+    """Deepest stack from entry and the reasons it may be unbounded."""
+    memo = {}
+    reasons = set()
+
+    def visit(name, path):
+        if name in path:
+            reasons.add(f"recursion through {name}")
+            return 0
+        if name in memo:
+            return memo[name]
+        # gcc names clones foo.constprop in .su and foo.constprop.0 in the ELF
+        key = name if name in frames else re.sub(r"\.\d+$", "", name)
+        frame, dynamic = frames.get(key, (0, False))
+        if key not in frames:
+            reasons.add(f"no stack data for {name}")
+        if dynamic:
+            reasons.add(f"dynamic frame in {name}")
+        callees, indirect = graph.get(name, (set(), False))
+        if indirect:
+            reasons.add(f"indirect call in {name}")
+        path.add(name)
+        deepest = max((visit(callee, path) for callee in callees), default=0)
+        path.discard(name)
+        memo[name] = frame + deepest
+        return memo[name]
+
+    return visit(entry, set()), sorted(reasons)
+
+
+def frame_overhead(is_arm):
+    if not is_arm:
+        return 0, 0
+    basic = HW_FRAME + HW_FRAME_ALIGN + SW_FRAME
+    return basic, HW_FRAME_FPU + HW_FRAME_ALIGN + SW_FRAME + SW_FRAME_FPU
+
+
+def write_header(path, elf_file, results, overhead, overhead_fpu):
+    lines = [
+        "/* Generated by tools/scripts/stack_analysis.py from " + os.path.basename(elf_file) + ", do not edit */",
+        "",
+        "#ifndef RTOS_STACK_SIZES_H",
+        "#define RTOS_STACK_SIZES_H",
+        "",
+        f"#define RTOS_STACK_FRAME_OVERHEAD     ({overhead}U) /**< Switched-out task, no FPU state */",
+        f"#define RTOS_STACK_FRAME_OVERHEAD_FPU ({overhead_fpu}U) /**< Switched-out task that used the FPU */",
+    ]
+    for entry, usage, reasons in results:
+        size = (usage + overhead_fpu + CANARY + 7) // 8 * 8
+        lines.append("")
+        lines.append(f"#define RTOS_STACK_USAGE_{entry} ({usage}U)")
+        lines.append(f"#define RTOS_STACK_SIZE_{entry} ({size}U)")
+        if reasons:
+            more = f", +{len(reasons) - 2} more" if len(reasons) > 2 else ""
+            lines.append(f"#define RTOS_STACK_UNBOUNDED_{entry} (1U) /* {'; '.join(reasons[:2])}{more} */")
+    lines += ["", "#endif /* RTOS_STACK_SIZES_H */", ""]
+
+    os.makedirs(os.path.dirname(path) or ".", exist_ok=True)
+    text = "\n".join(lines)
+    # Rewriting an unchanged header would rebuild every file that includes it
+    if os.path.exists(path):
+        with open(path) as f:
+            if f.read() == text:
+                return
+    with open(path, "w") as f:
+        f.write(text)
+
+
+def analyze(elf_file, build_dir, objdump, header_path):
+    """Run the analysis; returns 0, or 1 if the inputs are missing."""
+    print("=== Stack Analysis ===")
+
+    frames, sources = read_stack_usage(build_dir)
+    if not frames:
+        print("Warning: no .su files; build with -fstack-usage")
+        return 1
+    try:
+        graph = read_call_graph(elf_file, objdump)
+    except (OSError, subprocess.CalledProcessError) as e:
+        print(f"Stack analysis failed: {e}")
+        return 1
+
+    is_arm = "arm" in os.path.basename(objdump) or any(name == "PendSV_Handler" for name in graph)
+    overhead, overhead_fpu = frame_overhead(is_arm)
+
+    results = []
+    for entry in find_task_entries(sources, graph):
+        usage, reasons = worst_case(entry, frames, graph)
+        results.append((entry, usage, reasons))
+
+    print(f"{'Task entry':<32} {'Usage':>6} {'Size':>6}")
+    for entry, usage, reasons in results:
+        size = (usage + overhead_fpu + CANARY + 7) // 8 * 8
+        mark = " (lower bound)" if reasons else ""
+        print(f"{entry:<32} {usage:>6} {size:>6}{mark}")
+        for reason in reasons:
+            print(f"    {reason}")
+    print(f"Frame overhead: {overhead} bytes, {overhead_fpu} with FPU state")
+
+    write_header(header_path, elf_file, results, overhead, overhead_fpu)
+    print(f"Stack sizes written to: {header_path}")
+    return 0
+
+
+def find_objdump(env):
+    objcopy = env.subst("$OBJCOPY") if "OBJCOPY" in env else ""
+    if objcopy.endswith("objcopy"):
+        return objcopy[: -len("objcopy")] + "objdump"
+    return "objdump"
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(f"usage: {sys.argv[0]} <firmware.elf> [objdump]")
+        return 1
+    elf_file = sys.argv[1]
+    build_dir = os.path.dirname(elf_file) or "."
+    objdump = sys.argv[2] if len(sys.argv) > 2 else "arm-none-eabi-objdump"
+    return analyze(elf_file, build_dir, objdump, os.path.join(build_dir, HEADER_NAME))
+
+
+try:
+    Import("env")  # noqa: F821 (provided by SCons)
+except NameError:
+    env = None
+
+if env is not None:
+    build_dir = env.subst("$BUILD_DIR")
+    env.Append(CCFLAGS=["-fstack-usage"], CPPPATH=[build_dir])
+
+    def stack_analysis_action(source, target, env):
+        elf_file = str(target[0])
+        analyze(elf_file, build_dir, find_objdump(env), os.path.join(build_dir, HEADER_NAME))
+
+    env.AddPostAction("$BUILD_DIR/${PROGNAME}$PROGSUFFIX", stack_analysis_action)
+elif __name__ == "__main__":
+    sys.exit(main())
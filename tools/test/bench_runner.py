@@ -0,0 +1,317 @@
+#!/usr/bin/env python3
+"""
+VRTOS Benchmark Runner
+
+Flashes every bench_* environment in platformio.ini, captures its serial
+output, extracts the profiling stats and compares them against a checked-in
+baseline.
+
+Each benchmark prints its stats through rtos_profiling_print_stat():
+
+    [mutex_uncontended]: Min=216 cyc (13 us), Max=898 cyc (56 us), Avg=229 cyc (14 us), Cnt=100
+    [mutex_uncontended]: P50=224 cyc (14 us), P99=255 cyc (15 us), P99.9=895 cyc (55 us)
+
+and finishes with a "[BENCH] Done." line. Results are written per commit to
+logs/bench/<commit>/results.json and results.csv.
+
+Usage:
+    python bench_runner.py                              # run all bench envs, compare
+    python bench_runner.py bench_mutex bench_queue      # run a subset
+    python bench_runner.py --from-logs logs/bench/abc1234   # re-parse captures, no hardware
+    python bench_runner.py --update-baseline            # accept current results
+    python bench_runner.py --threshold avg=5 --threshold p99=15
+
+Exit status is 1 if any stat regressed past its threshold or a bench failed.
+"""
+
+import argparse
+import csv
+import json
+import os
+import re
+import subprocess
+import sys
+import time
+
+from datetime import datetime
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from test_runner import find_platformio, upload_firmware  # noqa: E402
+
+PROJECT_DIR = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+DEFAULT_BASELINE = os.path.join(PROJECT_DIR, "tests", "benchmarks", "baseline.json")
+DEFAULT_OUTPUT_DIR = os.path.join("logs", "bench")
+DEFAULT_BENCH_TIMEOUT_SEC = 60
+
+# Default regression thresholds in percent over baseline; min is never compared
+DEFAULT_THRESHOLDS = {"avg": 10.0, "p50": 10.0, "p99": 20.0, "p999": 30.0, "max": 50.0}
+METRICS = ["min", "max", "avg", "count", "p50", "p99", "p999"]
+
+ENV_PATTERN = re.compile(r'^\[env:(bench_\w+)\]', re.MULTILINE)
+STAT_PATTERN = re.compile(
+    r'\[(?P<name>[^\]]+)\]: Min=(?P<min>\d+) cyc \(\d+ us\), Max=(?P<max>\d+) cyc \(\d+ us\), '
+    r'Avg=(?P<avg>\d+) cyc \(\d+ us\), Cnt=(?P<count>\d+)')
+PCT_PATTERN = re.compile(
+    r'\[(?P<name>[^\]]+)\]: P50=(?P<p50>\d+) cyc \(\d+ us\), P99=(?P<p99>\d+) cyc \(\d+ us\), '
+    r'P99\.9=(?P<p999>\d+) cyc \(\d+ us\)')
+DONE_MARKER = "[BENCH] Done"
+
+
+# =================== Discovery ===================
+
+def discover_bench_envs(project_dir: str) -> list[str]:
+    """Return every [env:bench_*] section in platformio.ini, in file order."""
+    with open(os.path.join(project_dir, "platformio.ini"), 'r', encoding='utf-8') as f:
+        return ENV_PATTERN.findall(f.read())
+
+
+def git_revision(project_dir: str) -> str:
+    """Short commit hash, with -dirty if the tree has local changes."""
+    try:
+        rev = subprocess.run(["git", "rev-parse", "--short", "HEAD"], cwd=project_dir,
+                             capture_output=True, text=True).stdout.strip()
+        dirty = subprocess.run(["git", "status", "--porcelain", "--untracked-files=no"], cwd=project_dir,
+                               capture_output=True, text=True).stdout.strip()
+    except FileNotFoundError:
+        return "unknown"
+    if not rev:
+        return "unknown"
+    return f"{rev}-dirty" if dirty else rev
+
+
+# =================== Capture ===================
+
+def capture_bench(pio_path: str, project_dir: str, environment: str, timeout_sec: int,
+                  output_file: str) -> bool:
+    """Capture serial output until the bench prints its Done line or times out."""
+    print(f"[*] Capturing {environment} (max {timeout_sec} seconds)...")
+    cmd = [pio_path, "device", "monitor", "--environment", environment]
+
+    try:
+        process = subprocess.Popen(cmd, cwd=project_dir, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                                   text=True)
+    except Exception as e:
+        print(f"[!] Capture error: {e}")
+        return False
+
+    output_lines = []
+    done = False
+    start_time = time.time()
+
+    while time.time() - start_time < timeout_sec:
+        if process.poll() is not None:
+            break
+        line = process.stdout.readline()
+        if not line:
+            continue
+        output_lines.append(line)
+        print(line, end='')
+        if DONE_MARKER in line:
+            done = True
+            break
+
+    process.terminate()
+    try:
+        process.wait(timeout=2)
+    except subprocess.TimeoutExpired:
+        process.kill()
+
+    with open(output_file, 'w', encoding='utf-8') as f:
+        f.writelines(output_lines)
+
+    if not done:
+        print(f"[!] {environment}: no '{DONE_MARKER}' line within {timeout_sec}s")
+    return done
+
+
+# =================== Parsing ===================
+
+def parse_bench_log(path: str) -> dict:
+    """Return {stat_name: {metric: value}} for every stat printed in a capture."""
+    stats = {}
+    with open(path, 'r', encoding='utf-8', errors='replace') as f:
+        for line in f:
+            match = STAT_PATTERN.search(line)
+            if match:
+                entry = stats.setdefault(match.group('name'), {})
+                entry.update({k: int(match.group(k)) for k in ("min", "max", "avg", "count")})
+                continue
+            match = PCT_PATTERN.search(line)
+            if match:
+                entry = stats.setdefault(match.group('name'), {})
+                entry.update({k: int(match.group(k)) for k in ("p50", "p99", "p999")})
+    return stats
+
+
+def write_results(results: dict, revision: str, out_dir: str):
+    """Write results.json and a flat results.csv into out_dir."""
+    os.makedirs(out_dir, exist_ok=True)
+
+    with open(os.path.join(out_dir, "results.json"), 'w', encoding='utf-8') as f:
+        json.dump({"revision": revision, "timestamp": datetime.now().isoformat(timespec='seconds'),
+                   "results": results}, f, indent=2, sort_keys=True)
+
+    with open(os.path.join(out_dir, "results.csv"), 'w', newline='', encoding='utf-8') as f:
+        writer = csv.writer(f)
+        writer.writerow(["revision", "env", "stat"] + METRICS)
+        for env in sorted(results):
+            for stat in sorted(results[env]):
+                values = results[env][stat]
+                writer.writerow([revision, env, stat] + [values.get(m, "") for m in METRICS])
+
+
+# =================== Baseline Comparison ===================
+
+def load_baseline(path: str) -> dict:
+    if not os.path.exists(path):
+        return {"thresholds": dict(DEFAULT_THRESHOLDS), "overrides": {}, "results": {}}
+    with open(path, 'r', encoding='utf-8') as f:
+        return json.load(f)
+
+
+def threshold_for(baseline: dict, cli_thresholds: dict, env: str, stat: str, metric: str):
+    """CLI beats a per-stat override, which beats the baseline default."""
+    if metric in cli_thresholds:
+        return cli_thresholds[metric]
+    override = baseline.get("overrides", {}).get(f"{env}:{stat}", {})
+    if metric in override:
+        return override[metric]
+    return baseline.get("thresholds", DEFAULT_THRESHOLDS).get(metric)
+
+
+def compare(results: dict, baseline: dict, cli_thresholds: dict) -> tuple[bool, str]:
+    """Compare results against baseline; return (ok, report)."""
+    lines = ["=" * 72, "BENCHMARK COMPARISON", "=" * 72]
+    lines.append(f"{'env':<24} {'stat':<24} {'metric':<6} {'base':>8} {'now':>8} {'delta':>8}")
+    ok = True
+    base_results = baseline.get("results", {})
+
+    for env in sorted(results):
+        for stat in sorted(results[env]):
+            base = base_results.get(env, {}).get(stat)
+            if base is None:
+                lines.append(f"{env:<24} {stat:<24} (new, no baseline)")
+                continue
+            for metric, now in sorted(results[env][stat].items()):
+                limit = threshold_for(baseline, cli_thresholds, env, stat, metric)
+                if limit is None or metric not in base or base[metric] <= 0:
+                    continue
+                delta = (now - base[metric]) * 100.0 / base[metric]
+                flag = ""
+                if delta > limit:
+                    flag = f"  REGRESSION (> {limit:g}%)"
+                    ok = False
+                lines.append(f"{env:<24} {stat:<24} {metric:<6} {base[metric]:>8} {now:>8} {delta:>+7.1f}%{flag}")
+
+    for env in sorted(base_results):
+        for stat in sorted(base_results[env]):
+            if env in results and stat not in results[env]:
+                lines.append(f"{env:<24} {stat:<24} MISSING from this run")
+                ok = False
+
+    lines.append("=" * 72)
+    lines.append(f"Result: {'PASS' if ok else 'FAIL'}")
+    return ok, "\n".join(lines)
+
+
+def update_baseline(path: str, baseline: dict, results: dict, revision: str):
+    """Merge results into the baseline, keeping thresholds and overrides."""
+    baseline.setdefault("thresholds", dict(DEFAULT_THRESHOLDS))
+    baseline.setdefault("overrides", {})
+    baseline.setdefault("results", {})
+    for env, stats in results.items():
+        baseline["results"][env] = stats
+    baseline["revision"] = revision
+    with open(path, 'w', encoding='utf-8') as f:
+        json.dump(baseline, f, indent=2, sort_keys=True)
+        f.write("\n")
+    print(f"[+] Baseline updated: {path}")
+
+
+def parse_threshold(text: str) -> tuple[str, float]:
+    metric, _, pct = text.partition('=')
+    if metric not in METRICS or not pct:
+        raise argparse.ArgumentTypeError(f"expected METRIC=PCT with METRIC in {METRICS}, got '{text}'")
+    return metric, float(pct)
+
+
+# =================== Main ===================
+
+def main():
+    parser = argparse.ArgumentParser(description="VRTOS Benchmark Runner - run bench envs and check for regressions")
+    parser.add_argument("envs", nargs="*", help="Bench environments to run (default: every [env:bench_*])")
+    parser.add_argument("--baseline", default=DEFAULT_BASELINE, help="Baseline JSON (default: tests/benchmarks/baseline.json)")
+    parser.add_argument("--threshold", action="append", type=parse_threshold, default=[],
+                        help="Override a regression threshold, e.g. avg=5 (percent); repeatable")
+    parser.add_argument("--update-baseline", action="store_true", help="Write this run's results into the baseline")
+    parser.add_argument("--from-logs", default=None, help="Parse <dir>/<env>.txt captures instead of flashing")
+    parser.add_argument("--timeout", type=int, default=DEFAULT_BENCH_TIMEOUT_SEC,
+                        help=f"Per-bench capture timeout in seconds (default: {DEFAULT_BENCH_TIMEOUT_SEC})")
+    parser.add_argument("--output-dir", default=DEFAULT_OUTPUT_DIR, help="Output directory")
+    parser.add_argument("--pio-path", default=None, help="Path to PlatformIO executable")
+    args = parser.parse_args()
+
+    envs = args.envs or discover_bench_envs(PROJECT_DIR)
+    revision = git_revision(PROJECT_DIR)
+    out_dir = os.path.join(PROJECT_DIR, args.output_dir, revision)
+    os.makedirs(out_dir, exist_ok=True)
+
+    pio_path = None
+    if args.from_logs is None:
+        pio_path = args.pio_path or find_platformio()
+        if not pio_path:
+            print("[!] Could not find PlatformIO. Please specify --pio-path")
+            sys.exit(1)
+
+    results = {}
+    failed = []
+
+    for env in envs:
+        print("=" * 50)
+        print(f"VRTOS BENCH: {env}")
+        print("=" * 50)
+
+        if args.from_logs is not None:
+            log_file = os.path.join(args.from_logs, f"{env}.txt")
+            if not os.path.exists(log_file):
+                print(f"[!] No capture at {log_file}")
+                failed.append(env)
+                continue
+        else:
+            log_file = os.path.join(out_dir, f"{env}.txt")
+            if not upload_firmware(pio_path, PROJECT_DIR, env):
+                failed.append(env)
+                continue
+            time.sleep(1)
+            if not capture_bench(pio_path, PROJECT_DIR, env, args.timeout, log_file):
+                failed.append(env)
+
+        stats = parse_bench_log(log_file)
+        if not stats:
+            print(f"[!] {env}: no stats found")
+            if env not in failed:
+                failed.append(env)
+            continue
+        results[env] = stats
+        print(f"[+] {env}: {len(stats)} stats")
+
+    write_results(results, revision, out_dir)
+    print(f"\n[+] Results saved to: {out_dir}")
+
+    baseline = load_baseline(args.baseline)
+    if args.update_baseline:
+        update_baseline(args.baseline, baseline, results, revision)
+        ok = True
+    else:
+        ok, report = compare(results, baseline, dict(args.threshold))
+        print(report)
+
+    if failed:
+        print(f"[!] Failed benches: {', '.join(failed)}")
+        ok = False
+
+    sys.exit(0 if ok else 1)
+
+
+if __name__ == "__main__":
+    main()
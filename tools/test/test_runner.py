@@ -8,6 +8,10 @@ Usage:
     python test_runner.py test_scheduler_rr
     python test_runner.py test_scheduler_preemptive --duration 15
     python test_runner.py test_scheduler_cooperative --skip-analysis
+    python test_runner.py native_test_mutex_state
+
+native_* environments build the POSIX simulation and run it on the host
+instead of flashing a board.
 """
 
 import argparse
@@ -142,6 +146,11 @@ def analyze_verdict(entries: list[dict]) -> tuple[bool, str]:
 
 # =================== PlatformIO Interface ===================
 
+def is_native(environment: str) -> bool:
+    """True for the host (POSIX simulation) environments."""
+    return environment.startswith("native_")
+
+
 def find_platformio():
     """Find PlatformIO executable."""
     if os.path.exists(DEFAULT_PIO_PATH):
@@ -156,9 +165,11 @@ def find_platformio():
 
 
 def upload_firmware(pio_path: str, project_dir: str, environment: str) -> bool:
-    """Upload firmware to device."""
+    """Upload firmware to device (native: build the host executable)."""
     print(f"[*] Building and uploading: {environment}")
     cmd = [pio_path, "run", "--target", "upload", "--environment", environment]
+    if is_native(environment):
+        cmd = [pio_path, "run", "--environment", environment]
     
     try:
         result = subprocess.run(cmd, cwd=project_dir, capture_output=True, text=True, timeout=120)
@@ -177,9 +188,11 @@ def upload_firmware(pio_path: str, project_dir: str, environment: str) -> bool:
 
 def capture_serial(pio_path: str, project_dir: str, environment: str, 
                    duration_sec: int, output_file: str) -> bool:
-    """Capture serial output for specified duration or until TIMEOUT event."""
+    """Capture serial output (native: stdout) for specified duration or until TIMEOUT event."""
     print(f"[*] Capturing serial output (max {duration_sec} seconds)...")
     cmd = [pio_path, "device", "monitor", "--environment", environment]
+    if is_native(environment):
+        cmd = [pio_path, "run", "--target", "exec", "--environment", environment]
     
     try:
         process = subprocess.Popen(